@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/c/c_api_experimental.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "absl/strings/substitute.h"
 #include "tensorflow/c/c_api.h"
 #include "tensorflow/c/c_api_internal.h"
@@ -27,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/shape_inference.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -1171,3 +1175,94 @@ void TF_ImportGraphDefOptionsSetValidateColocationConstraints(
     TF_ImportGraphDefOptions* opts, unsigned char enable) {
   opts->opts.validate_colocation_constraints = enable;
 }
+
+TF_Tensor* TF_NewTensorNoCopy(TF_DataType dtype, const int64_t* dims,
+                              int num_dims, void* data, size_t len,
+                              void (*deallocator)(void* data, size_t len,
+                                                  void* arg),
+                              void* deallocator_arg, TF_Status* status) {
+  if (dtype == TF_STRING || dtype == TF_RESOURCE) {
+    status->status = InvalidArgument(
+        "TF_NewTensorNoCopy does not support ",
+        tensorflow::DataTypeString(static_cast<tensorflow::DataType>(dtype)),
+        " tensors, which are always converted when fed to a session");
+    return nullptr;
+  }
+  if (reinterpret_cast<intptr_t>(data) % TF_TensorDefaultAlignment() != 0) {
+    status->status = InvalidArgument(
+        "TF_NewTensorNoCopy requires data aligned to ",
+        TF_TensorDefaultAlignment(), " bytes");
+    return nullptr;
+  }
+  // Checked here rather than by TF_NewTensor, which would release `data`.
+  size_t num_bytes = TF_DataTypeSize(dtype);
+  for (int i = 0; i < num_dims; ++i) num_bytes *= dims[i];
+  if (len < num_bytes) {
+    status->status = InvalidArgument("TF_NewTensorNoCopy: ", len,
+                                     " bytes are too few for the shape, which "
+                                     "needs ",
+                                     num_bytes);
+    return nullptr;
+  }
+  status->status = tensorflow::Status::OK();
+  // Aligned numeric data is wrapped as is by TF_NewTensor.
+  return TF_NewTensor(dtype, dims, num_dims, data, len, deallocator,
+                      deallocator_arg);
+}
+
+size_t TF_TensorDefaultAlignment() {
+  return std::max(1, EIGEN_MAX_ALIGN_BYTES);
+}
+
+namespace {
+// Checks that `fetched` can be written into the caller-provided `dst`.
+tensorflow::Status ValidateOutputBuffer(int index, const TF_Tensor* fetched,
+                                        const TF_Tensor* dst) {
+  const TF_DataType dtype = TF_TensorType(fetched);
+  if (dtype == TF_STRING || dtype == TF_RESOURCE) {
+    return InvalidArgument(
+        "Output ", index, " has type ",
+        tensorflow::DataTypeString(static_cast<tensorflow::DataType>(dtype)),
+        ", which cannot be written to a caller buffer");
+  }
+  bool same_shape = TF_NumDims(fetched) == TF_NumDims(dst);
+  for (int d = 0; same_shape && d < TF_NumDims(fetched); ++d) {
+    same_shape = TF_Dim(fetched, d) == TF_Dim(dst, d);
+  }
+  if (TF_TensorType(dst) != dtype || !same_shape) {
+    return InvalidArgument("Output ", index, " does not match its buffer: ",
+                           fetched->tensor.DebugString(), " vs. ",
+                           dst->tensor.DebugString());
+  }
+  return tensorflow::Status::OK();
+}
+}  // namespace
+
+void TF_SessionRunWithOutputBuffers(
+    TF_Session* session, const TF_Buffer* run_options, const TF_Output* inputs,
+    TF_Tensor* const* input_values, int ninputs, const TF_Output* outputs,
+    TF_Tensor** output_values, int noutputs,
+    const TF_Operation* const* target_opers, int ntargets,
+    TF_Buffer* run_metadata, TF_Status* status) {
+  // TF_SessionRun hands back tensors that share the session's output
+  // buffers, so the only copy is the one into the caller's memory.
+  std::vector<TF_Tensor*> fetched(noutputs, nullptr);
+  TF_SessionRun(session, run_options, inputs, input_values, ninputs, outputs,
+                fetched.data(), noutputs, target_opers, ntargets, run_metadata,
+                status);
+  for (int i = 0; i < noutputs && status->status.ok(); ++i) {
+    if (output_values[i] == nullptr) continue;
+    status->status = ValidateOutputBuffer(i, fetched[i], output_values[i]);
+    if (status->status.ok() && TF_TensorByteSize(fetched[i]) > 0) {
+      std::memcpy(TF_TensorData(output_values[i]), TF_TensorData(fetched[i]),
+                  TF_TensorByteSize(fetched[i]));
+    }
+  }
+  for (int i = 0; i < noutputs; ++i) {
+    if (status->status.ok() && output_values[i] == nullptr) {
+      output_values[i] = fetched[i];
+    } else if (fetched[i] != nullptr) {
+      TF_DeleteTensor(fetched[i]);
+    }
+  }
+}
@@ -403,6 +403,47 @@ TF_CAPI_EXPORT extern void
 TF_ImportGraphDefOptionsSetValidateColocationConstraints(
     TF_ImportGraphDefOptions* opts, unsigned char enable);
 
+// Like `TF_NewTensor`, but guarantees that `data` itself backs the returned
+// tensor. `TF_NewTensor` silently copies numeric data that is not aligned to
+// `TF_TensorDefaultAlignment()` bytes; this function instead fails with
+// TF_INVALID_ARGUMENT, returns nullptr and leaves `data` (and the call to
+// `deallocator`) to the caller. TF_STRING and TF_RESOURCE tensors are also
+// rejected, since they are always converted when fed to a session.
+//
+// On success the tensor is fed to `TF_SessionRun` without any copy, and
+// `deallocator(data, len, deallocator_arg)` runs once the runtime drops its
+// last reference to the buffer.
+TF_CAPI_EXPORT extern TF_Tensor* TF_NewTensorNoCopy(
+    TF_DataType dtype, const int64_t* dims, int num_dims, void* data,
+    size_t len, void (*deallocator)(void* data, size_t len, void* arg),
+    void* deallocator_arg, TF_Status* status);
+
+// Returns the alignment, in bytes, that `TF_NewTensorNoCopy` requires of its
+// `data` argument.
+TF_CAPI_EXPORT extern size_t TF_TensorDefaultAlignment();
+
+// Like `TF_SessionRun`, but lets the caller provide the memory that outputs
+// are written to. On entry, a non-null `output_values[i]` is a tensor owned
+// by the caller whose type and shape match those of the i-th fetch; the
+// fetched value is written into its buffer and `output_values[i]` is left
+// unchanged. A null `output_values[i]` is filled with a newly allocated
+// tensor, exactly as `TF_SessionRun` does.
+//
+// This lets serving frontends reuse the same output buffers across requests
+// (e.g. memory owned by a Java direct ByteBuffer or a Go slice wrapped with
+// `TF_NewTensorNoCopy`) instead of allocating a `TF_Tensor` per fetch and
+// copying out of it. TF_STRING and TF_RESOURCE fetches cannot be written to
+// caller buffers and must be passed as null.
+//
+// On error, the contents of caller-provided buffers are unspecified and any
+// `output_values[i]` that was null on entry is left null.
+TF_CAPI_EXPORT extern void TF_SessionRunWithOutputBuffers(
+    TF_Session* session, const TF_Buffer* run_options, const TF_Output* inputs,
+    TF_Tensor* const* input_values, int ninputs, const TF_Output* outputs,
+    TF_Tensor** output_values, int noutputs,
+    const TF_Operation* const* target_opers, int ntargets,
+    TF_Buffer* run_metadata, TF_Status* status);
+
 #ifdef __cplusplus
 } /* end extern "C" */
 #endif
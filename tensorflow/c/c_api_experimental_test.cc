@@ -227,6 +227,115 @@ TEST(CAPI_EXPERIMENTAL, SymbolicTensor) {
   TF_DeleteStatus(status);
 }
 
+void CountingDeallocator(void* data, size_t len, void* arg) {
+  ++*static_cast<int*>(arg);
+}
+
+TEST(CAPI_EXPERIMENTAL, NewTensorNoCopy) {
+  TF_Status* status = TF_NewStatus();
+  alignas(64) float values[5] = {1, 2, 3, 4, 5};
+  ASSERT_LE(TF_TensorDefaultAlignment(), 64);
+  int num_deallocations = 0;
+  const int64_t dims[] = {4};
+
+  TF_Tensor* tensor =
+      TF_NewTensorNoCopy(TF_FLOAT, dims, 1, values, 4 * sizeof(float),
+                         &CountingDeallocator, &num_deallocations, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  EXPECT_EQ(values, TF_TensorData(tensor));
+  TF_DeleteTensor(tensor);
+  EXPECT_EQ(1, num_deallocations);
+
+  if (TF_TensorDefaultAlignment() > 1) {
+    // Misaligned data is rejected and left to the caller.
+    tensor = TF_NewTensorNoCopy(TF_FLOAT, dims, 1, values + 1,
+                                4 * sizeof(float), &CountingDeallocator,
+                                &num_deallocations, status);
+    EXPECT_EQ(TF_INVALID_ARGUMENT, TF_GetCode(status));
+    EXPECT_EQ(nullptr, tensor);
+  }
+  tensor = TF_NewTensorNoCopy(TF_FLOAT, dims, 1, values, 3 * sizeof(float),
+                              &CountingDeallocator, &num_deallocations, status);
+  EXPECT_EQ(TF_INVALID_ARGUMENT, TF_GetCode(status));
+  EXPECT_EQ(nullptr, tensor);
+  tensor = TF_NewTensorNoCopy(TF_STRING, dims, 1, values, 4 * sizeof(float),
+                              &CountingDeallocator, &num_deallocations, status);
+  EXPECT_EQ(TF_INVALID_ARGUMENT, TF_GetCode(status));
+  EXPECT_EQ(nullptr, tensor);
+  EXPECT_EQ(1, num_deallocations);
+
+  TF_DeleteStatus(status);
+}
+
+TEST(CAPI_EXPERIMENTAL, SessionRunWithOutputBuffers) {
+  TF_Status* status = TF_NewStatus();
+  TF_Graph* graph = TF_NewGraph();
+  TF_Operation* feed = Placeholder(graph, status, "feed", TF_FLOAT, {4});
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TF_Operation* neg = Neg(feed, graph, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TF_SessionOptions* opts = TF_NewSessionOptions();
+  TF_Session* session = TF_NewSession(graph, opts, status);
+  TF_DeleteSessionOptions(opts);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+
+  alignas(64) float input_values[4] = {1, 2, 3, 4};
+  alignas(64) float output_values[4] = {0, 0, 0, 0};
+  int num_deallocations = 0;
+  const int64_t dims[] = {4};
+  TF_Tensor* input = TF_NewTensorNoCopy(
+      TF_FLOAT, dims, 1, input_values, sizeof(input_values),
+      &CountingDeallocator, &num_deallocations, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TF_Tensor* output_buffer = TF_NewTensorNoCopy(
+      TF_FLOAT, dims, 1, output_values, sizeof(output_values),
+      &CountingDeallocator, &num_deallocations, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+
+  // The first fetch goes to the caller's buffer, the second is allocated.
+  TF_Output inputs[] = {{feed, 0}};
+  TF_Output outputs[] = {{neg, 0}, {neg, 0}};
+  TF_Tensor* outputs_values[] = {output_buffer, nullptr};
+  for (int run = 0; run < 2; ++run) {
+    TF_SessionRunWithOutputBuffers(session, nullptr, inputs, &input, 1,
+                                   outputs, outputs_values, 2, nullptr, 0,
+                                   nullptr, status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    EXPECT_EQ(output_buffer, outputs_values[0]);
+    ASSERT_NE(nullptr, outputs_values[1]);
+    const float* allocated =
+        static_cast<const float*>(TF_TensorData(outputs_values[1]));
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_EQ(-input_values[i], output_values[i]);
+      EXPECT_EQ(-input_values[i], allocated[i]);
+    }
+    TF_DeleteTensor(outputs_values[1]);
+    outputs_values[1] = nullptr;
+    input_values[0] += 10;
+  }
+
+  // A buffer whose shape differs from the fetch is rejected.
+  const int64_t wrong_dims[] = {2, 2};
+  TF_Tensor* wrong_buffer =
+      TF_AllocateTensor(TF_FLOAT, wrong_dims, 2, sizeof(output_values));
+  outputs_values[0] = wrong_buffer;
+  TF_SessionRunWithOutputBuffers(session, nullptr, inputs, &input, 1, outputs,
+                                 outputs_values, 2, nullptr, 0, nullptr,
+                                 status);
+  EXPECT_EQ(TF_INVALID_ARGUMENT, TF_GetCode(status));
+  EXPECT_EQ(wrong_buffer, outputs_values[0]);
+  EXPECT_EQ(nullptr, outputs_values[1]);
+  TF_DeleteTensor(wrong_buffer);
+
+  TF_CloseSession(session, status);
+  TF_DeleteSession(session, status);
+  TF_DeleteTensor(input);
+  TF_DeleteTensor(output_buffer);
+  EXPECT_EQ(2, num_deallocations);
+  TF_DeleteGraph(graph);
+  TF_DeleteStatus(status);
+}
+
 class AddEagerOpToGraphTest : public ::testing::Test {
  protected:
   AddEagerOpToGraphTest()
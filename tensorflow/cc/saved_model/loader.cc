@@ -15,10 +15,15 @@ limitations under the License.
 
 #include "tensorflow/cc/saved_model/loader.h"
 
+#include <deque>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "tensorflow/cc/saved_model/constants.h"
 #include "tensorflow/cc/saved_model/reader.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/graph/tensor_id.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/monitoring/sampler.h"
@@ -276,16 +281,134 @@ Status ReadSavedModelDebugInfoIfPresent(
   return Status::OK();
 }
 
+// Adds the names of the nodes producing the tensors described by `info` to
+// `node_names`.
+void AddTensorInfoNodes(const TensorInfo& info,
+                        std::vector<string>* node_names) {
+  switch (info.encoding_case()) {
+    case TensorInfo::kName:
+      node_names->push_back(string(ParseTensorName(info.name()).node()));
+      break;
+    case TensorInfo::kCooSparse:
+      for (const string& name : {info.coo_sparse().values_tensor_name(),
+                                 info.coo_sparse().indices_tensor_name(),
+                                 info.coo_sparse().dense_shape_tensor_name()}) {
+        node_names->push_back(string(ParseTensorName(name).node()));
+      }
+      break;
+    case TensorInfo::kCompositeTensor:
+      for (const TensorInfo& component : info.composite_tensor().components()) {
+        AddTensorInfoNodes(component, node_names);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+// Removes from `meta_graph_def` the signatures that are not in
+// `signature_keys`, the nodes that are needed neither by the remaining
+// signatures nor to restore the variables and run the init op, and the
+// functions that the remaining nodes cannot call.
+Status PruneMetaGraphForSignatures(
+    const string& export_dir, const std::unordered_set<string>& signature_keys,
+    MetaGraphDef* meta_graph_def) {
+  auto* signatures = meta_graph_def->mutable_signature_def();
+  for (const string& key : signature_keys) {
+    if (signatures->find(key) == signatures->end()) {
+      return errors::NotFound("Signature ", key, " not found in SavedModel ",
+                              export_dir);
+    }
+  }
+  for (auto it = signatures->begin(); it != signatures->end();) {
+    if (signature_keys.count(it->first) == 0 &&
+        it->first != kSavedModelInitOpSignatureKey) {
+      it = signatures->erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  std::vector<string> roots;
+  for (const auto& signature : *signatures) {
+    for (const auto& input : signature.second.inputs()) {
+      AddTensorInfoNodes(input.second, &roots);
+    }
+    for (const auto& output : signature.second.outputs()) {
+      AddTensorInfoNodes(output.second, &roots);
+    }
+  }
+  const SaverDef& saver_def = meta_graph_def->saver_def();
+  for (const string& name :
+       {saver_def.restore_op_name(), saver_def.filename_tensor_name()}) {
+    if (!name.empty()) roots.push_back(string(ParseTensorName(name).node()));
+  }
+  string init_op_name;
+  TF_RETURN_IF_ERROR(GetInitOp(export_dir, *meta_graph_def, &init_op_name));
+  if (!init_op_name.empty()) {
+    roots.push_back(string(ParseTensorName(init_op_name).node()));
+  }
+  std::vector<AssetFileDef> asset_file_defs;
+  TF_RETURN_IF_ERROR(GetAssetFileDefs(*meta_graph_def, &asset_file_defs));
+  for (const AssetFileDef& asset : asset_file_defs) {
+    AddTensorInfoNodes(asset.tensor_info(), &roots);
+  }
+
+  GraphDef* graph_def = meta_graph_def->mutable_graph_def();
+  std::unordered_map<string, const NodeDef*> nodes_by_name;
+  for (const NodeDef& node : graph_def->node()) {
+    nodes_by_name[node.name()] = &node;
+  }
+  std::unordered_set<string> reachable;
+  std::deque<string> queue(roots.begin(), roots.end());
+  while (!queue.empty()) {
+    string name = std::move(queue.front());
+    queue.pop_front();
+    const auto node_it = nodes_by_name.find(name);
+    if (node_it == nodes_by_name.end() || !reachable.insert(name).second) {
+      continue;
+    }
+    for (const string& input : node_it->second->input()) {
+      queue.push_back(string(ParseTensorName(input).node()));
+    }
+  }
+
+  GraphDef pruned_graph;
+  *pruned_graph.mutable_versions() = graph_def->versions();
+  for (NodeDef& node : *graph_def->mutable_node()) {
+    if (reachable.count(node.name()) > 0) {
+      pruned_graph.add_node()->Swap(&node);
+    }
+  }
+  const FunctionLibraryDefinition flib(OpRegistry::Global(),
+                                       graph_def->library());
+  *pruned_graph.mutable_library() =
+      flib.ReachableDefinitions(pruned_graph).ToProto();
+  VLOG(1) << "Pruned SavedModel graph for signatures { "
+          << absl::StrJoin(signature_keys, " ") << " } from "
+          << graph_def->node_size() << " to " << pruned_graph.node_size()
+          << " nodes and from " << graph_def->library().function_size()
+          << " to " << pruned_graph.library().function_size()
+          << " functions.";
+  graph_def->Swap(&pruned_graph);
+  return Status::OK();
+}
+
 Status LoadSavedModelInternal(const SessionOptions& session_options,
                               const RunOptions& run_options,
                               const string& export_dir,
                               const std::unordered_set<string>& tags,
+                              const std::unordered_set<string>& signature_keys,
                               SavedModelBundle* const bundle) {
   const uint64 read_start_microseconds = Env::Default()->NowMicros();
   TF_RETURN_IF_ERROR(ReadMetaGraphDefFromSavedModel(export_dir, tags,
                                                     &bundle->meta_graph_def));
   TF_RETURN_IF_ERROR(
       ReadSavedModelDebugInfoIfPresent(export_dir, &bundle->debug_info));
+  if (!signature_keys.empty()) {
+    TF_RETURN_IF_ERROR(PruneMetaGraphForSignatures(
+        export_dir, signature_keys, &bundle->meta_graph_def));
+  }
   TF_RETURN_IF_ERROR(LoadMetaGraphIntoSession(
       bundle->meta_graph_def, session_options, &bundle->session));
 
@@ -325,10 +448,19 @@ Status LoadSavedModel(const SessionOptions& session_options,
                       const RunOptions& run_options, const string& export_dir,
                       const std::unordered_set<string>& tags,
                       SavedModelBundle* const bundle) {
+  return LoadSavedModel(session_options, run_options, export_dir, tags,
+                        /*signature_keys=*/{}, bundle);
+}
+
+Status LoadSavedModel(const SessionOptions& session_options,
+                      const RunOptions& run_options, const string& export_dir,
+                      const std::unordered_set<string>& tags,
+                      const std::unordered_set<string>& signature_keys,
+                      SavedModelBundle* const bundle) {
   // TODO(robson): Add tests for the counters.
   const uint64 start_microseconds = Env::Default()->NowMicros();
-  const Status status = LoadSavedModelInternal(session_options, run_options,
-                                               export_dir, tags, bundle);
+  const Status status = LoadSavedModelInternal(
+      session_options, run_options, export_dir, tags, signature_keys, bundle);
   auto log_and_count = [&](const string& status_str) {
     LOG(INFO) << "SavedModel load for tags { " << absl::StrJoin(tags, " ")
               << " }; Status: " << status_str << ": " << status << ". Took "
@@ -458,6 +590,15 @@ Status LoadSavedModel(const SessionOptions& session_options,
                       const RunOptions& run_options, const string& export_dir,
                       const std::unordered_set<string>& tags,
                       SavedModelBundleLite* const bundle) {
+  return LoadSavedModel(session_options, run_options, export_dir, tags,
+                        /*signature_keys=*/{}, bundle);
+}
+
+Status LoadSavedModel(const SessionOptions& session_options,
+                      const RunOptions& run_options, const string& export_dir,
+                      const std::unordered_set<string>& tags,
+                      const std::unordered_set<string>& signature_keys,
+                      SavedModelBundleLite* const bundle) {
   SavedModelBundle legacy_bundle;
   SessionOptions rewritten_options(session_options);
   // We disallow calls to Session::Extend() on the returned session, so we can
@@ -472,7 +613,7 @@ Status LoadSavedModel(const SessionOptions& session_options,
   // TODO(mrry): Consider specializing the session creation to reduce peak
   // RAM consumption by using `Session::Create(GraphDef&&)`.
   TF_RETURN_IF_ERROR(LoadSavedModel(rewritten_options, run_options, export_dir,
-                                    tags, &legacy_bundle));
+                                    tags, signature_keys, &legacy_bundle));
   *bundle = SavedModelBundleLite(
       absl::make_unique<LiteSessionWrapper>(std::move(legacy_bundle.session)),
       std::move(*legacy_bundle.meta_graph_def.mutable_signature_def()));
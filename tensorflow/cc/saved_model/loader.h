@@ -101,6 +101,12 @@ class SavedModelBundleLite : public SavedModelBundleInterface {
 /// the set of tags used at SavedModel build time. Stores a SavedModel bundle in
 /// *bundle with a session and the requested MetaGraphDef, if found.
 ///
+/// Variables are restored into memory before this returns, unless the
+/// TF_RESTORE_V2_MEMORY_MAP environment variable is set to true: variables
+/// then alias the memory-mapped checkpoint where possible, and their pages are
+/// read on first access. AlignSavedModelVariables() in mapped_variables.h
+/// prepares existing SavedModels so that all fixed-size variables can.
+///
 /// NOTE: Prefer the overload that takes a SavedModelBundleLite* in new code.
 Status LoadSavedModel(const SessionOptions& session_options,
                       const RunOptions& run_options, const string& export_dir,
@@ -119,6 +125,26 @@ Status LoadSavedModel(const SessionOptions& session_options,
                       const std::unordered_set<string>& tags,
                       SavedModelBundleLite* const bundle);
 
+/// Loads a SavedModel like the overloads above, but only keeps the signatures
+/// whose keys are in `signature_keys` (plus the init op signature, if any).
+/// Before the session is created, the graph is pruned to the nodes needed to
+/// compute those signatures, restore the variables and run the init op, and
+/// the function library is pruned to the functions these nodes can call.
+/// Returns NotFound if a requested signature does not exist. An empty
+/// `signature_keys` set loads all signatures without pruning.
+Status LoadSavedModel(const SessionOptions& session_options,
+                      const RunOptions& run_options, const string& export_dir,
+                      const std::unordered_set<string>& tags,
+                      const std::unordered_set<string>& signature_keys,
+                      SavedModelBundle* const bundle);
+
+/// Overload of the above that creates a SavedModelBundleLite.
+Status LoadSavedModel(const SessionOptions& session_options,
+                      const RunOptions& run_options, const string& export_dir,
+                      const std::unordered_set<string>& tags,
+                      const std::unordered_set<string>& signature_keys,
+                      SavedModelBundleLite* const bundle);
+
 /// Checks whether the provided directory could contain a SavedModel. Note that
 /// the method does not load any data by itself. If the method returns `false`,
 /// the export directory definitely does not contain a SavedModel. If the method
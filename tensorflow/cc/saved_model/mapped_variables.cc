@@ -0,0 +1,60 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/saved_model/mapped_variables.h"
+
+#include <vector>
+
+#include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/tensor_bundle/naming.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+
+Status AlignSavedModelVariables(const string& export_dir, int data_alignment) {
+  Env* env = Env::Default();
+  const string variables_directory =
+      io::JoinPath(export_dir, kSavedModelVariablesDirectory);
+  const string prefix =
+      io::JoinPath(variables_directory, kSavedModelVariablesFilename);
+  if (!env->FileExists(MetaFilename(prefix)).ok()) {
+    LOG(INFO) << "The SavedModel at " << export_dir
+              << " has no variables to align.";
+    return Status::OK();
+  }
+
+  // Writes the aligned bundle next to the variables, then replaces them.
+  const string aligned_prefix = strings::StrCat(prefix, "_aligned_tmp");
+  TF_RETURN_IF_ERROR(AlignBundle(env, prefix, aligned_prefix, data_alignment));
+  std::vector<string> data_files;
+  TF_RETURN_IF_ERROR(
+      env->GetMatchingPaths(strings::StrCat(prefix, ".data-*"), &data_files));
+  for (const string& data_file : data_files) {
+    TF_RETURN_IF_ERROR(env->DeleteFile(data_file));
+  }
+  TF_RETURN_IF_ERROR(env->RenameFile(DataFilename(aligned_prefix, 0, 1),
+                                     DataFilename(prefix, 0, 1)));
+  TF_RETURN_IF_ERROR(
+      env->RenameFile(MetaFilename(aligned_prefix), MetaFilename(prefix)));
+  LOG(INFO) << "Aligned the variables of the SavedModel at " << export_dir
+            << " to " << data_alignment << " bytes.";
+  return Status::OK();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,49 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+/// Packaging of SavedModel variables for memory-mapped loading.
+
+#ifndef TENSORFLOW_CC_SAVED_MODEL_MAPPED_VARIABLES_H_
+#define TENSORFLOW_CC_SAVED_MODEL_MAPPED_VARIABLES_H_
+
+#include <string>
+
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+
+/// The alignment of the variables written by AlignSavedModelVariables by
+/// default: the page size of most platforms.
+constexpr int kSavedModelVariablesPageAlignment = 4096;
+
+/// Rewrites the variables of the SavedModel in `export_dir` in place, as a
+/// single data file in which each tensor starts at a multiple of
+/// `data_alignment` bytes. The SavedModel stays compatible with every loader.
+///
+/// With TF_RESTORE_V2_MEMORY_MAP set to true, LoadSavedModel then restores
+/// all fixed-size variables of the rewritten SavedModel as read-only tensors
+/// aliasing the memory-mapped data file, instead of only the ones that happen
+/// to be aligned. Loading takes no time per byte of weights, and the serving
+/// processes of a host share the weights through the page cache.
+///
+/// The rewrite is not atomic: the SavedModel must not be loaded while it
+/// runs. Returns OK without changes if the SavedModel has no variables.
+Status AlignSavedModelVariables(
+    const string& export_dir,
+    int data_alignment = kSavedModelVariablesPageAlignment);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CC_SAVED_MODEL_MAPPED_VARIABLES_H_
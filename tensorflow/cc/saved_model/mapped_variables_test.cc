@@ -0,0 +1,92 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/saved_model/mapped_variables.h"
+
+#include <vector>
+
+#include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/tensor_bundle/naming.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns the prefix of the variables of the SavedModel in `export_dir`.
+string VariablesPrefix(const string& export_dir) {
+  return io::JoinPath(export_dir, kSavedModelVariablesDirectory,
+                      kSavedModelVariablesFilename);
+}
+
+TEST(MappedVariablesTest, AlignsShardedVariables) {
+  const string export_dir =
+      io::JoinPath(testing::TmpDir(), "aligns_sharded_variables");
+  const string prefix = VariablesPrefix(export_dir);
+  // Writes the variables in two shards, like a distributed Saver.
+  const Tensor weights = test::AsTensor<float>({1, 2, 3, 4}, {2, 2});
+  const Tensor bias = test::AsTensor<int64>({5, 6});
+  {
+    BundleWriter writer(Env::Default(), strings::StrCat(prefix, "_shard0"));
+    TF_ASSERT_OK(writer.Add("weights", weights));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter writer(Env::Default(), strings::StrCat(prefix, "_shard1"));
+    TF_ASSERT_OK(writer.Add("bias", bias));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  TF_ASSERT_OK(MergeBundles(Env::Default(),
+                            {strings::StrCat(prefix, "_shard0"),
+                             strings::StrCat(prefix, "_shard1")},
+                            prefix));
+  TF_ASSERT_OK(Env::Default()->FileExists(DataFilename(prefix, 1, 2)));
+
+  TF_ASSERT_OK(AlignSavedModelVariables(export_dir));
+
+  std::vector<string> data_files;
+  TF_ASSERT_OK(Env::Default()->GetMatchingPaths(
+      strings::StrCat(prefix, ".data-*"), &data_files));
+  EXPECT_EQ(data_files, std::vector<string>({DataFilename(prefix, 0, 1)}));
+  BundleReader reader(Env::Default(), prefix);
+  TF_ASSERT_OK(reader.status());
+  Tensor val(DT_FLOAT, TensorShape({2, 2}));
+  TF_ASSERT_OK(reader.Lookup("weights", &val));
+  test::ExpectTensorEqual<float>(val, weights);
+  Tensor mapped_bias;
+  bool mapped = false;
+  TF_ASSERT_OK(reader.LookupMapped("bias", &mapped_bias, &mapped));
+  // Filesystems without memory-mapping support leave the tensor alone.
+  if (mapped) {
+    test::ExpectTensorEqual<int64>(mapped_bias, bias);
+  }
+}
+
+TEST(MappedVariablesTest, NoVariables) {
+  const string export_dir = io::JoinPath(testing::TmpDir(), "no_variables");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(export_dir));
+  TF_EXPECT_OK(AlignSavedModelVariables(export_dir));
+  EXPECT_FALSE(
+      Env::Default()->FileExists(MetaFilename(VariablesPrefix(export_dir)))
+          .ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -242,6 +242,48 @@ TEST_F(LoaderTest, SavedModelInitOpV2Format) {
   CheckSavedModelBundle(export_dir, bundle);
 }
 
+TEST_F(LoaderTest, PruneToSignatures) {
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  for (const char* test_data : {kTestDataSharded, kTestDataInitOpV2}) {
+    SavedModelBundle bundle;
+    const string export_dir =
+        io::JoinPath(testing::TensorFlowSrcRoot(), test_data);
+    TF_ASSERT_OK(LoadSavedModel(session_options, run_options, export_dir,
+                                {kSavedModelTagServe}, {"regress_x_to_y"},
+                                &bundle));
+    CheckSavedModelBundle(export_dir, bundle);
+
+    // Only the requested signature and the init op signature (if any) are
+    // kept.
+    for (const auto& signature : bundle.GetSignatures()) {
+      EXPECT_TRUE(signature.first == "regress_x_to_y" ||
+                  signature.first == kSavedModelInitOpSignatureKey)
+          << signature.first;
+    }
+    // The nodes only needed by other signatures are removed.
+    for (const NodeDef& node : bundle.meta_graph_def.graph_def().node()) {
+      EXPECT_NE(node.name(), "y3");
+    }
+  }
+}
+
+TEST_F(LoaderTest, PruneToMissingSignature) {
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  Status st = LoadSavedModel(session_options, run_options, export_dir,
+                             {kSavedModelTagServe}, {"missing_signature"},
+                             &bundle);
+  EXPECT_EQ(st.code(), error::NOT_FOUND);
+  EXPECT_TRUE(absl::StrContains(st.error_message(), "missing_signature"))
+      << st.error_message();
+}
+
 TEST_F(LoaderTest, SavedModelV2DebugInfo) {
   SavedModelBundle bundle;
   SessionOptions session_options;
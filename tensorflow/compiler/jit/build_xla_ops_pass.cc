@@ -15,9 +15,13 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/build_xla_ops_pass.h"
 
+#include <limits>
+#include <map>
+
 #include "absl/algorithm/container.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
 #include "tensorflow/cc/framework/ops.h"
 #include "tensorflow/cc/framework/scope_internal.h"
 #include "tensorflow/cc/ops/array_ops.h"
@@ -25,6 +29,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/control_flow_ops.h"
 #include "tensorflow/cc/ops/functional_ops.h"
 #include "tensorflow/cc/ops/logging_ops.h"
+#include "tensorflow/cc/ops/math_ops.h"
 #include "tensorflow/compiler/jit/defs.h"
 #include "tensorflow/compiler/jit/device_util.h"
 #include "tensorflow/compiler/jit/encapsulate_subgraphs_pass.h"
@@ -62,6 +67,13 @@ struct DebuggingOpts {
   bool check_output_numerics;
 };
 
+struct ShapeBucketingOpts {
+  // Increasing sizes to which the inputs of XLA clusters are padded along
+  // `dim`.  Empty if shape bucketing is disabled.
+  std::vector<int> boundaries;
+  int dim = 0;
+};
+
 void MoveOutgoingEdges(Graph* g, Node* old_node, Node* new_node) {
   std::vector<const Edge*> out_edges(old_node->out_edges().begin(),
                                      old_node->out_edges().end());
@@ -460,11 +472,179 @@ Status PredicateInt32Inputs(const Scope& root, Node* n,
   return Status::OK();
 }
 
+bool CanBucket(DataType dtype) {
+  return DataTypeIsFloating(dtype) || DataTypeIsInteger(dtype) ||
+         dtype == DT_BOOL;
+}
+
+// The size of a tensor along the bucketed dimension.
+struct BucketedDimSize {
+  Output rank;
+  // Whether the rank of the tensor is large enough for it to be bucketed.
+  Output has_dim;
+  // The size of the bucketed dimension, or zero if `has_dim` is false.
+  Output size;
+};
+
+BucketedDimSize ComputeBucketedDimSize(const Scope& s, Output input,
+                                       const ShapeBucketingOpts& opts) {
+  BucketedDimSize result;
+  Output shape = ops::Shape(s.WithOpName("shape"), input);
+  result.rank = ops::Size(s.WithOpName("rank"), shape);
+  result.has_dim =
+      ops::Greater(s.WithOpName("has_dim"), result.rank, opts.dim);
+
+  // Padding the shape with zeros keeps the lookup of the bucketed dimension
+  // valid for tensors of a smaller rank.
+  Tensor zeros(DT_INT32, TensorShape({opts.dim + 1}));
+  zeros.flat<int32>().setZero();
+  Output padded_shape = ops::Concat(
+      s.WithOpName("padded_shape"),
+      {shape, ops::Const(s.WithOpName("zeros"), Input::Initializer(zeros))},
+      /*axis=*/0);
+  result.size = ops::Gather(s.WithOpName("size"), padded_shape, opts.dim);
+  return result;
+}
+
+// The bucket of a tensor, and how to pad the tensor to it.
+struct Bucket {
+  BucketedDimSize dim_size;
+  // The smallest bucket boundary that is not smaller than the size of the
+  // bucketed dimension, or that size itself if it is larger than all
+  // boundaries.
+  Output size;
+  // Paddings for a Pad op that pads the tensor to the bucket.
+  Output paddings;
+};
+
+Bucket ComputeBucket(const Scope& s, Output input,
+                     const ShapeBucketingOpts& opts) {
+  Bucket result;
+  result.dim_size = ComputeBucketedDimSize(s, input, opts);
+  const Output& dim_size = result.dim_size.size;
+
+  Tensor boundaries(DT_INT32, TensorShape({static_cast<int64>(
+                                  opts.boundaries.size())}));
+  absl::c_copy(opts.boundaries, boundaries.flat<int32>().data());
+  Output boundaries_op =
+      ops::Const(s.WithOpName("boundaries"), Input::Initializer(boundaries));
+  Output no_bucket =
+      ops::Const(s.WithOpName("no_bucket"), std::numeric_limits<int32>::max());
+  Output smallest_fitting_boundary = ops::Min(
+      s.WithOpName("smallest_fitting_boundary"),
+      ops::SelectV2(s.WithOpName("fitting_boundaries"),
+                    ops::GreaterEqual(s.WithOpName("fits"), boundaries_op,
+                                      dim_size),
+                    boundaries_op, no_bucket),
+      /*axis=*/0);
+  result.size = ops::SelectV2(
+      s.WithOpName("bucket_size"),
+      ops::Equal(s.WithOpName("too_large"), smallest_fitting_boundary,
+                 no_bucket),
+      dim_size, smallest_fitting_boundary);
+
+  // The paddings are a [rank, 2] matrix that is zero except for the padding
+  // after the bucketed dimension.
+  const Output& rank = result.dim_size.rank;
+  Output positions = ops::Range(s.WithOpName("padding_positions"), 0,
+                                ops::Multiply(s.WithOpName("num_paddings"),
+                                              rank, 2),
+                                1);
+  Output flat_paddings = ops::SelectV2(
+      s.WithOpName("flat_paddings"),
+      ops::Equal(s.WithOpName("is_bucketed_padding"), positions,
+                 2 * opts.dim + 1),
+      ops::Sub(s.WithOpName("padding"), result.size, dim_size), 0);
+  result.paddings =
+      ops::Reshape(s.WithOpName("paddings"), flat_paddings,
+                   ops::Stack(s.WithOpName("paddings_shape"), {rank, 2}));
+  return result;
+}
+
+// Pads the non-constant inputs of the cluster `n` to their buckets along the
+// bucketed dimension, and slices the outputs of `n` whose size along that
+// dimension is the bucket of the first padded input back to the size of that
+// input.
+Status BucketClusterShapes(const Scope& s, const ShapeBucketingOpts& opts,
+                           Graph* g, Node* n, XlaClusterInfo* cluster_info) {
+  const int num_constant_inputs = cluster_info->constant_inputs.size();
+  absl::optional<Bucket> reference;
+  for (int i = 0; i < cluster_info->non_constant_inputs.size(); ++i) {
+    Output input = cluster_info->non_constant_inputs[i];
+    if (!CanBucket(input.type())) continue;
+    Scope scope = s.NewSubScope(absl::StrCat("bucket_input_", i));
+    Bucket bucket = ComputeBucket(scope, input, opts);
+    Output padded = ops::Pad(scope.WithOpName("pad"), input, bucket.paddings);
+    TF_RETURN_IF_ERROR(scope.status());
+    TF_RETURN_IF_ERROR(
+        g->UpdateEdge(padded.node(), 0, n, num_constant_inputs + i));
+    cluster_info->non_constant_inputs[i] = padded;
+    if (!reference) reference = bucket;
+  }
+  if (!reference) return Status::OK();
+
+  std::vector<const Edge*> out_edges(n->out_edges().begin(),
+                                     n->out_edges().end());
+  std::map<int, Output> sliced_outputs;
+  for (const Edge* e : out_edges) {
+    if (e->IsControlEdge() || !CanBucket(n->output_type(e->src_output()))) {
+      continue;
+    }
+    auto it = sliced_outputs.find(e->src_output());
+    if (it == sliced_outputs.end()) {
+      Scope scope =
+          s.NewSubScope(absl::StrCat("bucket_output_", e->src_output()));
+      Output output(n, e->src_output());
+      BucketedDimSize dim_size = ComputeBucketedDimSize(scope, output, opts);
+      Output is_padded = ops::LogicalAnd(
+          scope.WithOpName("is_padded"),
+          ops::LogicalAnd(scope.WithOpName("both_have_dim"),
+                          reference->dim_size.has_dim, dim_size.has_dim),
+          ops::Equal(scope.WithOpName("has_reference_bucket_size"),
+                     dim_size.size, reference->size));
+      Output positions = ops::Range(scope.WithOpName("slice_positions"), 0,
+                                    dim_size.rank, 1);
+      Output slice_sizes = ops::SelectV2(
+          scope.WithOpName("slice_sizes"),
+          ops::LogicalAnd(scope.WithOpName("is_sliced_dim"), is_padded,
+                          ops::Equal(scope.WithOpName("is_bucketed_dim"),
+                                     positions, opts.dim)),
+          reference->dim_size.size, -1);
+      Output sliced = ops::Slice(
+          scope.WithOpName("slice"), output,
+          ops::ZerosLike(scope.WithOpName("slice_begin"), positions),
+          slice_sizes);
+      TF_RETURN_IF_ERROR(scope.status());
+      it = sliced_outputs.emplace(e->src_output(), sliced).first;
+    }
+    TF_RETURN_IF_ERROR(
+        g->UpdateEdge(it->second.node(), 0, e->dst(), e->dst_input()));
+  }
+  return Status::OK();
+}
+
+Status ParseShapeBucketBoundaries(const string& flag,
+                                  std::vector<int>* boundaries) {
+  for (absl::string_view boundary :
+       absl::StrSplit(flag, ',', absl::SkipWhitespace())) {
+    int value;
+    if (!absl::SimpleAtoi(boundary, &value) || value <= 0 ||
+        (!boundaries->empty() && value <= boundaries->back())) {
+      return errors::InvalidArgument(
+          "Invalid --tf_xla_shape_bucket_boundaries: ", flag,
+          ". Expected a comma-separated list of increasing positive sizes.");
+    }
+    boundaries->push_back(value);
+  }
+  return Status::OK();
+}
+
 Status ReplaceNodeWithXlaCompileAndXlaRun(
     jit::DeviceInfoCache* device_info_cache,
     const GraphOptimizationPassOptions& options,
     const FunctionLibraryDefinition& flib_def, bool lazy_compilation_enabled,
-    const DebuggingOpts& debugging_opts, Graph* g, Node* n) {
+    const DebuggingOpts& debugging_opts,
+    const ShapeBucketingOpts& shape_bucketing_opts, Graph* g, Node* n) {
   XlaClusterInfo cluster_info;
   TF_RETURN_IF_ERROR(GetXlaClusterInfo(n, &cluster_info));
 
@@ -488,6 +668,11 @@ Status ReplaceNodeWithXlaCompileAndXlaRun(
                    .WithDevice(n->requested_device())
                    .WithAssignedDevice(device_name_str);
 
+  if (!shape_bucketing_opts.boundaries.empty()) {
+    TF_RETURN_IF_ERROR(
+        BucketClusterShapes(root, shape_bucketing_opts, g, n, &cluster_info));
+  }
+
   ops::_XlaCompile xla_compile(root.WithOpName("xla_compile"),
                                /*constants=*/cluster_info.constant_inputs,
                                /*args=*/cluster_info.non_constant_inputs,
@@ -601,10 +786,25 @@ Status BuildXlaOpsPass::Run(const GraphOptimizationPassOptions& options) {
   VLOG(1) << "check_input_numerics = " << debugging_opts.check_input_numerics;
   VLOG(1) << "check_output_numerics = " << debugging_opts.check_output_numerics;
 
+  ShapeBucketingOpts shape_bucketing_opts;
+  if (shape_bucket_boundaries_) {
+    shape_bucketing_opts.boundaries = *shape_bucket_boundaries_;
+  } else {
+    TF_RETURN_IF_ERROR(ParseShapeBucketBoundaries(
+        flags.tf_xla_shape_bucket_boundaries,
+        &shape_bucketing_opts.boundaries));
+  }
+  shape_bucketing_opts.dim = flags.tf_xla_shape_bucket_dim;
+  if (shape_bucketing_opts.dim < 0) {
+    return errors::InvalidArgument("Invalid --tf_xla_shape_bucket_dim: ",
+                                   shape_bucketing_opts.dim);
+  }
+
   for (Node* n : xla_compiled_kernels) {
     TF_RETURN_IF_ERROR(ReplaceNodeWithXlaCompileAndXlaRun(
         &device_info_cache, options, *options.flib_def,
-        lazy_compilation_enabled, debugging_opts, graph, n));
+        lazy_compilation_enabled, debugging_opts, shape_bucketing_opts, graph,
+        n));
   }
 
   if (VLOG_IS_ON(1)) {
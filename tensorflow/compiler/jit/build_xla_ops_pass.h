@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_BUILD_XLA_OPS_PASS_H_
 #define TENSORFLOW_COMPILER_JIT_BUILD_XLA_OPS_PASS_H_
 
+#include <vector>
+
 #include "absl/types/optional.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -29,14 +31,20 @@ class BuildXlaOpsPass : public GraphOptimizationPass {
   // If enable_lazy_compilation is not nullopt then *enable_lazy_compilation
   // overrides --tf_xla_enable_lazy_compilation flag in deciding whether lazy
   // compilation is enabled.
+  //
+  // If shape_bucket_boundaries is not nullopt then *shape_bucket_boundaries
+  // overrides the --tf_xla_shape_bucket_boundaries flag.
   explicit BuildXlaOpsPass(
-      absl::optional<bool> enable_lazy_compilation = absl::nullopt)
-      : enable_lazy_compilation_(enable_lazy_compilation) {}
+      absl::optional<bool> enable_lazy_compilation = absl::nullopt,
+      absl::optional<std::vector<int>> shape_bucket_boundaries = absl::nullopt)
+      : enable_lazy_compilation_(enable_lazy_compilation),
+        shape_bucket_boundaries_(std::move(shape_bucket_boundaries)) {}
 
   Status Run(const GraphOptimizationPassOptions& options) override;
 
  private:
   absl::optional<bool> enable_lazy_compilation_;
+  absl::optional<std::vector<int>> shape_bucket_boundaries_;
 };
 
 }  // namespace tensorflow
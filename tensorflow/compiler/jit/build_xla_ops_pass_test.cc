@@ -50,13 +50,16 @@ using ::tensorflow::testing::FindNodeByName;
 using ::tensorflow::testing::matchers::Attr;
 using ::tensorflow::testing::matchers::CtrlDeps;
 using ::tensorflow::testing::matchers::Inputs;
+using ::tensorflow::testing::matchers::Name;
 using ::tensorflow::testing::matchers::NodeWith;
 using ::tensorflow::testing::matchers::Op;
 using ::tensorflow::testing::matchers::Out;
 using ::testing::_;
 
 Status BuildXlaOps(const Scope& s, const FunctionDefLibrary& fdef_lib,
-                   std::unique_ptr<Graph>* result) {
+                   std::unique_ptr<Graph>* result,
+                   absl::optional<std::vector<int>> shape_bucket_boundaries =
+                       absl::nullopt) {
   auto graph = absl::make_unique<Graph>(OpRegistry::Global());
   TF_RETURN_IF_ERROR(s.ToGraph(graph.get()));
   FunctionLibraryDefinition flib_def(graph->op_registry(), fdef_lib);
@@ -78,7 +81,8 @@ Status BuildXlaOps(const Scope& s, const FunctionDefLibrary& fdef_lib,
       wrapper.CreateGraphOptimizationPassOptions(&graph);
   opt_options.flib_def = &flib_def;
 
-  BuildXlaOpsPass pass(/*enable_lazy_compilation=*/true);
+  BuildXlaOpsPass pass(/*enable_lazy_compilation=*/true,
+                       std::move(shape_bucket_boundaries));
   TF_RETURN_IF_ERROR(pass.Run(opt_options));
   VLOG(3) << graph->ToGraphDefDebug().DebugString();
   *result = std::move(graph);
@@ -141,6 +145,17 @@ FunctionDefLibrary CreateFunctionDefLibWithInt32Input(const string& name) {
   return fdef_lib;
 }
 
+FunctionDefLibrary CreateFunctionDefLibWithFloatInput(const string& name) {
+  FunctionDefLibrary fdef_lib;
+  FunctionDef func = FunctionDefHelper::Create(
+      /*function_name=*/name, /*in_def=*/{"in: float"},
+      /*out_def=*/{"out: float"},
+      /*attr_def=*/{}, /*node_def=*/{{{"out"}, "Identity", {"in"}}},
+      /*ret_def=*/{{"out", "out:output:0"}});
+  *fdef_lib.add_function() = std::move(func);
+  return fdef_lib;
+}
+
 TEST_F(BuildXlaOpsTest, ControlDepsPreserved) {
   const char* kXlaDeviceName = "/job:worker/replica:0/task:0/device:XLA_CPU:0";
   Scope root = Scope::NewRootScope().WithDevice(kXlaDeviceName).ExitOnError();
@@ -268,6 +283,49 @@ TEST_F(BuildXlaOpsTest, NoExtraMergeForEdgeToSink) {
                                            NodeWith(Op("NoOp")))));
 }
 
+TEST_F(BuildXlaOpsTest, ShapeBucketing) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+
+  FunctionDefLibrary fdef_lib =
+      CreateFunctionDefLibWithFloatInput("cluster_float");
+  TF_ASSERT_OK(root.graph()->AddFunctionLibrary(fdef_lib));
+
+  Node* call;
+  TF_ASSERT_OK(
+      MakeXlaCompiledKernel(root.graph(), "cluster_float", "C", &call));
+  call->AddAttr(kXlaHasReferenceVarsAttr, false);
+
+  Output input = ops::Placeholder(root.WithOpName("input"), DT_FLOAT);
+  root.graph()->AddEdge(input.node(), 0, call, 0);
+  TF_ASSERT_OK(root.DoShapeInference(call));
+  Output consumer = ops::Identity(root.WithOpName("consumer"), Output(call));
+
+  std::unique_ptr<Graph> graph;
+  TF_ASSERT_OK(BuildXlaOps(root, fdef_lib, &graph,
+                           /*shape_bucket_boundaries=*/{{8, 16, 32}}));
+
+  // Both the XLA compiled and the TF version of the cluster see the padded
+  // input, and the consumer sees the merged output sliced back.
+  auto pad = NodeWith(Op("Pad"), Inputs(Out(NodeWith(Name("input"))), _));
+  auto xla_compile = NodeWith(Op("_XlaCompile"), Inputs(Out(pad)));
+  auto tf_call = NodeWith(Op("PartitionedCall"), Inputs(Out(pad)));
+  auto merge = NodeWith(Op("_XlaMerge"), Inputs(Out(tf_call), _));
+  auto slice = NodeWith(Op("Slice"), Inputs(Out(merge), _, _));
+
+  Node* consumer_new = FindNodeByName(graph.get(), consumer.node()->name());
+  ASSERT_NE(consumer_new, nullptr);
+  EXPECT_THAT(consumer_new, NodeWith(Inputs(Out(slice))));
+
+  bool found_xla_compile = false;
+  for (Node* n : graph->op_nodes()) {
+    if (n->type_string() == "_XlaCompile") {
+      EXPECT_THAT(n, xla_compile);
+      found_xla_compile = true;
+    }
+  }
+  EXPECT_TRUE(found_xla_compile);
+}
+
 #ifdef GOOGLE_CUDA
 // This tests a rewrite that only makes sense and is active in a CUDA-enabled
 // build.  Specifically we check that we insert an IdentityN op to avoid extra
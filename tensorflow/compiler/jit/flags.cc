@@ -108,6 +108,8 @@ void AllocateAndParseFlags() {
   build_ops_flags->tf_xla_check_cluster_input_numerics = false;
   build_ops_flags->tf_xla_check_cluster_output_numerics = false;
   build_ops_flags->tf_xla_disable_constant_folding = false;
+  build_ops_flags->tf_xla_shape_bucket_boundaries = "";
+  build_ops_flags->tf_xla_shape_bucket_dim = 0;
 
   mark_for_compilation_flags = new MarkForCompilationPassFlags;
   mark_for_compilation_flags->xla_auto_jit_flag.optimization_level_single_gpu =
@@ -130,6 +132,8 @@ void AllocateAndParseFlags() {
 
   ops_flags = new XlaOpsCommonFlags;
   ops_flags->tf_xla_always_defer_compilation = false;
+  ops_flags->tf_xla_async_compilation = false;
+  ops_flags->tf_xla_persistent_cache_dir = "";
 
   jitter_flags = new IntroduceFloatingPointJitterPassFlags;
   jitter_flags->jitter_amount = 1e-5;
@@ -154,6 +158,16 @@ void AllocateAndParseFlags() {
             &build_ops_flags->tf_xla_check_cluster_output_numerics,
             "If true then insert CheckNumerics nodes to to check all cluster "
             "outputs."),
+       Flag("tf_xla_shape_bucket_boundaries",
+            &build_ops_flags->tf_xla_shape_bucket_boundaries,
+            "If non-empty, a comma-separated list of increasing sizes. Inputs "
+            "of XLA clusters are padded along tf_xla_shape_bucket_dim to the "
+            "smallest of these sizes that fits them, and outputs are sliced "
+            "back. Only correct for clusters whose slices along that "
+            "dimension are independent."),
+       Flag("tf_xla_shape_bucket_dim",
+            &build_ops_flags->tf_xla_shape_bucket_dim,
+            "The dimension padded by tf_xla_shape_bucket_boundaries."),
 
        Flag("tf_xla_compile_on_demand", &device_flags->tf_xla_compile_on_demand,
             "Switch a device into 'on-demand' mode, where instead of "
@@ -161,6 +175,14 @@ void AllocateAndParseFlags() {
 
        Flag("tf_xla_always_defer_compilation",
             &ops_flags->tf_xla_always_defer_compilation, ""),
+       Flag("tf_xla_async_compilation",
+            &ops_flags->tf_xla_async_compilation,
+            "If true, compile clusters on a background thread and run them "
+            "without XLA until the compilation has finished."),
+       Flag("tf_xla_persistent_cache_dir",
+            &ops_flags->tf_xla_persistent_cache_dir,
+            "If non-empty, persist the XLA computations compiled by "
+            "_XlaCompile in this directory and reuse them across processes."),
 
        Flag("tf_introduce_floating_point_jitter_to_tensors",
             setter_for_jitter_tensor_names, "",
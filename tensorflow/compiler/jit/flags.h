@@ -91,6 +91,16 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile always refuses to compile the cluster, which means the
   // XLA clusters always run in the TF executor.  Defaults to false.
   bool tf_xla_always_defer_compilation;
+
+  // If true, _XlaCompile compiles clusters that are not marked must-compile on
+  // a background thread, and runs them in the TF executor until their
+  // compilation has finished.  Defaults to false.
+  bool tf_xla_async_compilation;
+
+  // If non-empty, the XLA compilation caches of the _XlaCompile kernels persist
+  // the results of lowering clusters to XLA in this directory, and later
+  // processes reuse them instead of lowering the clusters again.
+  string tf_xla_persistent_cache_dir;
 };
 
 // Flags for the build_xla_ops pass.
@@ -114,6 +124,18 @@ struct BuildXlaOpsPassFlags {
   // Disables all constant folding. The primary use for this is for testing to
   // guarantee that tests are run on XLA and not on TF's CPU implementation.
   bool tf_xla_disable_constant_folding;
+
+  // If non-empty, a comma-separated list of increasing sizes.  Inputs to XLA
+  // clusters are padded with zeros along dimension tf_xla_shape_bucket_dim to
+  // the smallest of these sizes that fits them, and the cluster outputs are
+  // sliced back, which bounds the number of shapes each cluster is compiled
+  // for.  This is only correct for clusters in which the slices along that
+  // dimension don't affect each other, e.g. the batch dimension of most
+  // inference graphs.
+  string tf_xla_shape_bucket_boundaries;
+
+  // The dimension padded by tf_xla_shape_bucket_boundaries.  Defaults to 0.
+  int32 tf_xla_shape_bucket_dim;
 };
 
 // Flags for the IntroduceFloatingPointJitter pass.
@@ -219,7 +219,8 @@ static Status BuildCompilationCache(OpKernelContext* ctx,
   if (platform_info.xla_device_metadata()) {
     *cache = new XlaCompilationCache(
         platform_info.xla_device_metadata()->client(),
-        platform_info.xla_device_metadata()->jit_device_type());
+        platform_info.xla_device_metadata()->jit_device_type(),
+        GetXlaOpsCommonFlags().tf_xla_persistent_cache_dir);
     return Status::OK();
   }
 
@@ -265,15 +266,16 @@ static Status BuildCompilationCache(OpKernelContext* ctx,
                                    platform_info.device_type().type());
   }
   *cache = new XlaCompilationCache(
-      client.ValueOrDie(), DeviceType(registration->compilation_device_name));
+      client.ValueOrDie(), DeviceType(registration->compilation_device_name),
+      GetXlaOpsCommonFlags().tf_xla_persistent_cache_dir);
   return Status::OK();
 }
 
 static Status CompileToLocalExecutable(
     OpKernelContext* ctx, const NameAttrList& function, bool has_ref_vars,
     const XlaPlatformInfo& platform_info, absl::Span<const int> resources,
-    absl::Span<const int> constants, bool lazy, xla::LocalClient** client,
-    std::map<int, OptionalTensor>* variables,
+    absl::Span<const int> constants, bool lazy, bool alias_resource_update,
+    xla::LocalClient** client, std::map<int, OptionalTensor>* variables,
     const XlaCompiler::CompilationResult** kernel,
     xla::LocalExecutable** executable) {
   // We store information about the JIT-compiled XLA computation
@@ -334,13 +336,22 @@ static Status CompileToLocalExecutable(
   // Optimization: where possible, have the computation return a naked array
   // rather than a one-element tuple.
   compile_options.always_return_tuple = false;
+  // Variable updates can only be written in place when the caller donates the
+  // variables' buffers, which XLA devices don't support.
+  compile_options.alias_resource_update =
+      alias_resource_update && !platform_info.is_on_xla_device();
 
   std::vector<XlaCompiler::Argument> args;
   TF_RETURN_IF_ERROR(XlaComputationLaunchContext::BuildXlaCompilerArguments(
       constant_args, *variables, ctx, &args));
-  return cache->Compile(options, function, args, compile_options,
-                        lazy ? XlaCompilationCache::CompileMode::kLazy
-                             : XlaCompilationCache::CompileMode::kStrict,
+  XlaCompilationCache::CompileMode compile_mode =
+      XlaCompilationCache::CompileMode::kStrict;
+  if (lazy) {
+    compile_mode = GetXlaOpsCommonFlags().tf_xla_async_compilation
+                       ? XlaCompilationCache::CompileMode::kAsync
+                       : XlaCompilationCache::CompileMode::kLazy;
+  }
+  return cache->Compile(options, function, args, compile_options, compile_mode,
                         kernel, executable);
 }
 
@@ -356,7 +367,8 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
   {
     Status s = CompileToLocalExecutable(
         ctx, function_, /*has_ref_vars=*/true, platform_info_, resources_,
-        constants_, /*lazy=*/false, &client, &variables, &kernel, &executable);
+        constants_, /*lazy=*/false, /*alias_resource_update=*/true, &client,
+        &variables, &kernel, &executable);
     if (!s.ok() && (platform_info_.device_type().type_string() == DEVICE_CPU ||
                     platform_info_.device_type().type_string() == DEVICE_GPU)) {
       // Suggest auto jit if the failure was with GPU or CPU.
@@ -379,6 +391,17 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
       client, allocator,
       /*allocate_xla_tensors=*/platform_info_.is_on_xla_device(),
       platform_info_.UseMultipleStreams());
+  const xla::HloInputOutputAliasConfig& input_output_alias =
+      executable->executable()->module().input_output_alias_config();
+  // Holds the locks of the variables written by the computation until the
+  // updates are written back, as donated buffers are updated in place.
+  std::vector<VariableInfo> resource_update_variables;
+  if (!platform_info_.is_on_xla_device()) {
+    OP_REQUIRES_OK(ctx, launch_context.DonateResourceVariables(
+                            ctx, kernel, /*missing_ctx_input_prefix=*/0,
+                            input_output_alias, &variables,
+                            &resource_update_variables));
+  }
   launch_context.PopulateInputs(ctx, kernel, variables,
                                 /*missing_ctx_input_prefix=*/0);
 
@@ -403,12 +426,11 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
   auto elapsed = env->NowMicros() - start_time;
   VLOG(2) << "Elapsed time: " << elapsed << "us";
 
-  const xla::HloInputOutputAliasConfig& input_output_alias =
-      executable->executable()->module().input_output_alias_config();
   OP_REQUIRES_OK(
       ctx, launch_context.PopulateOutputs(
                ctx, kernel, run_result.ConsumeValueOrDie(),
-               /*missing_ctx_input_prefix=*/0, input_output_alias, variables));
+               /*missing_ctx_input_prefix=*/0, input_output_alias, variables,
+               absl::MakeSpan(resource_update_variables)));
   VLOG(1) << "Done";
 }
 
@@ -502,7 +524,8 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
   } else {
     Status status = CompileToLocalExecutable(
         ctx, function_, has_ref_vars_, platform_info_, resources_, constants_,
-        /*lazy=*/!must_compile_, &client, &variables, &kernel, &executable);
+        /*lazy=*/!must_compile_, /*alias_resource_update=*/false, &client,
+        &variables, &kernel, &executable);
     if (must_compile_ || status.code() != error::UNIMPLEMENTED) {
       OP_REQUIRES_OK(ctx, status);
     }
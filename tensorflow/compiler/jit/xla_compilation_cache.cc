@@ -15,9 +15,11 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/xla_compilation_cache.h"
 
+#include <algorithm>
 #include <numeric>
 
 #include "absl/base/call_once.h"
+#include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/compiler/jit/xla_activity.pb.h"
@@ -26,17 +28,23 @@ limitations under the License.
 #include "tensorflow/compiler/tf2xla/type_util.h"
 #include "tensorflow/compiler/tf2xla/xla_context.h"
 #include "tensorflow/compiler/xla/client/client_library.h"
+#include "tensorflow/compiler/xla/debug_options_flags.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/graph_optimizer.h"
 #include "tensorflow/core/common_runtime/metrics.h"
 #include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/dump_graph.h"
@@ -44,12 +52,33 @@ limitations under the License.
 namespace tensorflow {
 
 constexpr int64 XlaCompilationCache::kDefaultCompilationThreshold;
+constexpr int XlaCompilationCache::kNumAsyncCompilerThreads;
 
 XlaCompilationCache::XlaCompilationCache(xla::LocalClient* client,
-                                         DeviceType device_type)
-    : client_(client), device_type_(std::move(device_type)) {}
+                                         DeviceType device_type,
+                                         string persistent_cache_dir)
+    : client_(client),
+      device_type_(std::move(device_type)),
+      persistent_cache_dir_(std::move(persistent_cache_dir)) {
+  if (!persistent_cache_dir_.empty()) {
+    // Results of different TensorFlow versions, platforms or XLA flags are
+    // never reused.
+    string serialized_flags;
+    SerializeToStringDeterministic(xla::GetDebugOptionsFromFlags(),
+                                   &serialized_flags);
+    compiler_fingerprint_ = Fingerprint64(absl::StrCat(
+        TF_VERSION_STRING, ";", tf_git_version(), ";",
+        device_type_.type_string(), ";", client_->platform()->Name(), ";",
+        serialized_flags));
+  }
+}
 
 XlaCompilationCache::~XlaCompilationCache() {
+  // Wait for the background compilations, which refer to the cache entries.
+  {
+    mutex_lock lock(async_compiler_mu_);
+    async_compiler_threads_.reset();
+  }
   // Ensure any use of our programs have completed by waiting for all stream
   // executors to complete.
   for (auto* executor : client_->backend().stream_executors()) {
@@ -86,6 +115,25 @@ string XlaCompilationCache::Signature::HumanString() const {
   return result;
 }
 
+string XlaCompilationCache::Signature::Serialize() const {
+  string result = absl::StrCat(name.size(), ":", name, ";", arg_shapes.size(),
+                               ";", arg_values.size());
+  for (const auto& a : arg_shapes) {
+    absl::StrAppend(&result, ";", static_cast<int>(a.first), "[",
+                    absl::StrJoin(a.second, ","), "]");
+  }
+  // tensor_data() is not a stable representation of string tensors, so the
+  // values are serialized as TensorProtos.
+  for (const auto& v : arg_values) {
+    TensorProto proto;
+    v.AsProtoTensorContent(&proto);
+    string serialized;
+    SerializeToStringDeterministic(proto, &serialized);
+    absl::StrAppend(&result, ";", serialized.size(), ":", serialized);
+  }
+  return result;
+}
+
 bool XlaCompilationCache::Signature::operator==(const Signature& other) const {
   if (name != other.name) return false;
   if (arg_shapes != other.arg_shapes) return false;
@@ -144,6 +192,168 @@ XlaCompilationCache::BuildSignature(
   return std::move(signature);
 }
 
+Status XlaCompilationCache::CompilationResultToProto(
+    const XlaCompiler::CompilationResult& result,
+    XlaCompilationResultProto* proto) {
+  if (result.computation == nullptr) {
+    return errors::InvalidArgument("Compilation result has no XLA computation");
+  }
+  proto->Clear();
+  for (int index : result.input_mapping) {
+    proto->add_input_mapping(index);
+  }
+  for (const xla::Shape& shape : result.xla_input_shapes) {
+    *proto->add_xla_input_shapes() = shape.ToProto();
+  }
+  *proto->mutable_xla_output_shape() = result.xla_output_shape.ToProto();
+  for (const XlaCompiler::OutputDescription& output : result.outputs) {
+    XlaCompilationResultProto::OutputDescription* output_proto =
+        proto->add_outputs();
+    output_proto->set_type(output.type);
+    output.shape.AsProto(output_proto->mutable_shape());
+    output_proto->set_is_constant(output.is_constant);
+    if (output.is_constant) {
+      output.constant_value.AsProtoTensorContent(
+          output_proto->mutable_constant_value());
+    }
+    output_proto->set_input_index(output.input_index);
+    output_proto->set_is_tensor_list(output.is_tensor_list);
+  }
+  *proto->mutable_host_compute_metadata() = result.host_compute_metadata;
+  for (const XlaCompiler::ResourceUpdate& update : result.resource_updates) {
+    XlaCompilationResultProto::ResourceUpdate* update_proto =
+        proto->add_resource_updates();
+    update_proto->set_input_index(update.input_index);
+    update_proto->set_type(update.type);
+    update.shape.AsProto(update_proto->mutable_shape());
+    update_proto->set_modified(update.modified);
+    for (const string& gradient : update.tensor_array_gradients_accessed) {
+      update_proto->add_tensor_array_gradients_accessed(gradient);
+    }
+  }
+  *proto->mutable_computation() = result.computation->proto();
+  return Status::OK();
+}
+
+Status XlaCompilationCache::CompilationResultFromProto(
+    const XlaCompilationResultProto& proto,
+    XlaCompiler::CompilationResult* result) {
+  *result = XlaCompiler::CompilationResult();
+  result->input_mapping.assign(proto.input_mapping().begin(),
+                               proto.input_mapping().end());
+  for (const xla::ShapeProto& shape : proto.xla_input_shapes()) {
+    result->xla_input_shapes.emplace_back(shape);
+  }
+  result->xla_output_shape = xla::Shape(proto.xla_output_shape());
+  for (const auto& output_proto : proto.outputs()) {
+    XlaCompiler::OutputDescription output;
+    output.type = output_proto.type();
+    TF_RETURN_IF_ERROR(TensorShape::IsValidShape(output_proto.shape()));
+    output.shape = TensorShape(output_proto.shape());
+    output.is_constant = output_proto.is_constant();
+    if (output.is_constant &&
+        !output.constant_value.FromProto(output_proto.constant_value())) {
+      return errors::DataLoss("Invalid constant value for output ",
+                              result->outputs.size());
+    }
+    output.input_index = output_proto.input_index();
+    output.is_tensor_list = output_proto.is_tensor_list();
+    result->outputs.push_back(std::move(output));
+  }
+  result->host_compute_metadata = proto.host_compute_metadata();
+  for (const auto& update_proto : proto.resource_updates()) {
+    XlaCompiler::ResourceUpdate update;
+    update.input_index = update_proto.input_index();
+    update.type = update_proto.type();
+    TF_RETURN_IF_ERROR(TensorShape::IsValidShape(update_proto.shape()));
+    update.shape = TensorShape(update_proto.shape());
+    update.modified = update_proto.modified();
+    update.tensor_array_gradients_accessed.insert(
+        update_proto.tensor_array_gradients_accessed().begin(),
+        update_proto.tensor_array_gradients_accessed().end());
+    result->resource_updates.push_back(std::move(update));
+  }
+  result->computation =
+      std::make_shared<xla::XlaComputation>(proto.computation());
+  return Status::OK();
+}
+
+string XlaCompilationCache::PersistentCacheFilename(
+    const XlaCompiler::Options& options, const NameAttrList& function,
+    const string& serialized_signature) const {
+  uint64 key = FingerprintCat64(compiler_fingerprint_,
+                                Fingerprint64(serialized_signature));
+  // Clusters of different graphs may have the same name, so the functions
+  // being compiled are part of the key as well.
+  const FunctionDef* fdef =
+      options.flib_def ? options.flib_def->Find(function.name()) : nullptr;
+  if (fdef != nullptr) {
+    // The fingerprints are cached by the library, so a cluster's functions
+    // are only fingerprinted once.
+    std::vector<string> names =
+        options.flib_def->ReachableDefinitions(*fdef).ListFunctionNames();
+    names.push_back(function.name());
+    std::vector<uint64> function_fingerprints;
+    function_fingerprints.reserve(names.size());
+    for (const string& name : names) {
+      function_fingerprints.push_back(options.flib_def->Fingerprint(name));
+    }
+    std::sort(function_fingerprints.begin(), function_fingerprints.end());
+    for (const uint64 function_fingerprint : function_fingerprints) {
+      key = FingerprintCat64(key, function_fingerprint);
+    }
+  }
+  return io::JoinPath(persistent_cache_dir_,
+                      strings::StrCat(strings::Hex(key, strings::kZeroPad16),
+                                      ".xla_cache.pb"));
+}
+
+bool XlaCompilationCache::ReadFromPersistentCache(
+    const string& filename, const string& serialized_signature,
+    XlaCompiler::CompilationResult* result) {
+  Env* env = Env::Default();
+  if (!env->FileExists(filename).ok()) return false;
+  XlaCompilationCacheEntryProto entry;
+  Status status = ReadBinaryProto(env, filename, &entry);
+  if (status.ok() && entry.signature() != serialized_signature) {
+    status = errors::FailedPrecondition("signature mismatch");
+  }
+  if (status.ok()) {
+    status = CompilationResultFromProto(entry.compilation_result(), result);
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Ignoring unusable XLA compilation cache entry "
+                 << filename << ": " << status;
+    *result = XlaCompiler::CompilationResult();
+    return false;
+  }
+  return true;
+}
+
+// The entry is first written to a temporary file and then renamed, so that
+// concurrent readers (e.g. other replicas sharing the cache directory) never
+// see a partially written entry.
+Status XlaCompilationCache::WriteToPersistentCache(
+    const string& filename, const string& serialized_signature,
+    const XlaCompiler::CompilationResult& result) {
+  XlaCompilationCacheEntryProto entry;
+  entry.set_signature(serialized_signature);
+  TF_RETURN_IF_ERROR(
+      CompilationResultToProto(result, entry.mutable_compilation_result()));
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(persistent_cache_dir_));
+  const string tmp_filename =
+      strings::StrCat(filename, ".tmp", random::New64());
+  Status status = WriteBinaryProto(env, tmp_filename, entry);
+  if (status.ok()) {
+    status = env->RenameFile(tmp_filename, filename);
+  }
+  if (!status.ok()) {
+    env->DeleteFile(tmp_filename).IgnoreError();
+  }
+  return status;
+}
+
 Status XlaCompilationCache::BuildExecutable(
     const XlaCompiler::Options& options,
     const XlaCompiler::CompilationResult& result,
@@ -180,16 +390,33 @@ Status XlaCompilationCache::Compile(
     const XlaCompiler::CompilationResult** out_compilation_result,
     xla::LocalExecutable** out_executable) {
   absl::optional<int64> compile_threshold;
-  if (compile_mode == CompileMode::kLazy) {
+  if (compile_mode == CompileMode::kLazy ||
+      compile_mode == CompileMode::kAsync) {
     compile_threshold = kDefaultCompilationThreshold;
   }
+  if (compile_mode == CompileMode::kAsync) {
+    // The compilation may outlive this call, so it works on copies of the
+    // arguments.
+    auto compile_fn = [compile_options, function,
+                       args = std::vector<XlaCompiler::Argument>(args.begin(),
+                                                                 args.end())](
+                          XlaCompiler* compiler,
+                          XlaCompiler::CompilationResult* result) {
+      return compiler->CompileFunction(compile_options, function, args, result);
+    };
+    return CompileImpl(options, function, args, compile_fn,
+                       /*compile_threshold=*/compile_threshold,
+                       /*asynchronous=*/true, out_compilation_result,
+                       out_executable);
+  }
   auto compile_fn = [&](XlaCompiler* compiler,
                         XlaCompiler::CompilationResult* result) {
     return compiler->CompileFunction(compile_options, function, args, result);
   };
   return CompileImpl(options, function, args, compile_fn,
                      /*compile_threshold=*/compile_threshold,
-                     out_compilation_result, out_executable);
+                     /*asynchronous=*/false, out_compilation_result,
+                     out_executable);
 }
 
 static bool ShouldBeMegamorphic(int64 compile_count, int64 execution_count) {
@@ -228,7 +455,8 @@ Status XlaCompilationCache::CompileSingleOp(
   };
   return CompileImpl(options, name, args, compile_op,
                      /*compile_threshold=*/absl::nullopt,
-                     out_compilation_result, out_executable);
+                     /*asynchronous=*/false, out_compilation_result,
+                     out_executable);
 }
 
 namespace {
@@ -245,12 +473,123 @@ void LogOnceXlaCompiledFirstCluster() {
 }
 }  // namespace
 
+Status XlaCompilationCache::CompileStrict(
+    Entry* entry, const XlaCompiler::Options& options,
+    const Signature& signature, const NameAttrList& function,
+    const CompileFn& compile_fn) {
+  tensorflow::Env* env = tensorflow::Env::Default();
+  const uint64 compile_start_us = env->NowMicros();
+  // Do the actual JIT compilation without holding the lock (it can take
+  // a long time.)
+
+  entry->compiled = true;
+
+  string serialized_signature;
+  string persistent_cache_filename;
+  bool found_in_persistent_cache = false;
+  if (!persistent_cache_dir_.empty()) {
+    serialized_signature = signature.Serialize();
+    persistent_cache_filename =
+        PersistentCacheFilename(options, function, serialized_signature);
+    found_in_persistent_cache = ReadFromPersistentCache(
+        persistent_cache_filename, serialized_signature,
+        &entry->compilation_result);
+    VLOG_IF(1, found_in_persistent_cache)
+        << "Found " << function.name() << " in the persistent cache: "
+        << persistent_cache_filename;
+  }
+  if (!found_in_persistent_cache) {
+    XlaCompiler compiler(options);
+    entry->compilation_status =
+        compile_fn(&compiler, &entry->compilation_result);
+    TF_RETURN_IF_ERROR(entry->compilation_status);
+  }
+  CHECK_EQ(entry->executable.get(), nullptr);
+  entry->compilation_status =
+      BuildExecutable(options, entry->compilation_result, &entry->executable);
+  if (!persistent_cache_dir_.empty() && !found_in_persistent_cache &&
+      entry->compilation_status.ok()) {
+    const Status status = WriteToPersistentCache(
+        persistent_cache_filename, serialized_signature,
+        entry->compilation_result);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to persist the XLA compilation of "
+                   << function.name() << ": " << status;
+    }
+  }
+
+  const uint64 compile_end_us = env->NowMicros();
+  const uint64 compile_time_us = compile_end_us - compile_start_us;
+  metrics::UpdateXlaCompilationTime(compile_time_us);
+  {
+    mutex_lock lock(cluster_compile_stats_mu_);
+    auto it = cluster_compile_stats_.find(function.name());
+    it->second.compile_count++;
+    it->second.cumulative_compile_time_us += compile_time_us;
+    LogOnceXlaCompiledFirstCluster();
+    VLOG(1) << "compiled " << function.name() << " "
+            << it->second.compile_count << " times, compile time: "
+            << compile_time_us
+            << " us, cumulative: " << it->second.cumulative_compile_time_us
+            << " us ("
+            << tensorflow::strings::HumanReadableElapsedTime(compile_time_us /
+                                                             1.0e6)
+            << " / "
+            << tensorflow::strings::HumanReadableElapsedTime(
+                   it->second.cumulative_compile_time_us / 1.0e6)
+            << ")";
+
+    XlaJitCompilationActivity jit_compilation_activity;
+    jit_compilation_activity.set_cluster_name(function.name());
+    jit_compilation_activity.set_compile_count(it->second.compile_count);
+    jit_compilation_activity.set_compile_time_us(compile_time_us);
+    jit_compilation_activity.set_cumulative_compile_time_us(
+        it->second.cumulative_compile_time_us);
+
+    TF_RETURN_IF_ERROR(
+        BroadcastXlaActivity(std::move(jit_compilation_activity)));
+  }
+  return Status::OK();
+}
+
+void XlaCompilationCache::CompileAsynchronously(
+    Entry* entry, const XlaCompiler::Options& options,
+    const Signature& signature, const NameAttrList& function,
+    const CompileFn& compile_fn) {
+  XlaCompiler::Options async_options = options;
+  // The device allocator is owned by the caller and may not outlive this call.
+  // Without one, XLA uses the default allocator of the backend.
+  async_options.device_allocator = nullptr;
+
+  mutex_lock lock(async_compiler_mu_);
+  if (!async_compiler_threads_) {
+    async_compiler_threads_ = absl::make_unique<thread::ThreadPool>(
+        Env::Default(), "xla_async_compiler", kNumAsyncCompilerThreads);
+  }
+  async_compiler_threads_->Schedule([this, entry, async_options, signature,
+                                     function, compile_fn]() {
+    Entry result;
+    mutex_lock result_lock(result.mu);
+    const Status status =
+        CompileStrict(&result, async_options, signature, function, compile_fn);
+
+    mutex_lock entry_lock(entry->mu);
+    entry->compiling_asynchronously = false;
+    // A strict compilation of the same signature may have finished first, and
+    // its executable may be in use.
+    if (entry->compiled) return;
+    entry->compiled = true;
+    entry->compilation_status =
+        status.ok() ? result.compilation_status : status;
+    entry->compilation_result = std::move(result.compilation_result);
+    entry->executable = std::move(result.executable);
+  });
+}
+
 Status XlaCompilationCache::CompileImpl(
     const XlaCompiler::Options& options, const NameAttrList& function,
-    absl::Span<const XlaCompiler::Argument> args,
-    const std::function<Status(XlaCompiler* compiler,
-                               XlaCompiler::CompilationResult*)>& compile_fn,
-    absl::optional<int64> compile_threshold,
+    absl::Span<const XlaCompiler::Argument> args, const CompileFn& compile_fn,
+    absl::optional<int64> compile_threshold, bool asynchronous,
     const XlaCompiler::CompilationResult** out_compilation_result,
     xla::LocalExecutable** out_executable) {
   DCHECK_NE(out_executable, nullptr);
@@ -360,52 +699,20 @@ Status XlaCompilationCache::CompileImpl(
       return Status::OK();
     }
 
-    tensorflow::Env* env = tensorflow::Env::Default();
-    const uint64 compile_start_us = env->NowMicros();
-    // Do the actual JIT compilation without holding the lock (it can take
-    // a long time.)
-
-    XlaCompiler compiler(options);
-    entry->compiled = true;
-
-    entry->compilation_status =
-        compile_fn(&compiler, &entry->compilation_result);
-    TF_RETURN_IF_ERROR(entry->compilation_status);
-    CHECK_EQ(entry->executable.get(), nullptr);
-    entry->compilation_status =
-        BuildExecutable(options, entry->compilation_result, &entry->executable);
-
-    const uint64 compile_end_us = env->NowMicros();
-    const uint64 compile_time_us = compile_end_us - compile_start_us;
-    metrics::UpdateXlaCompilationTime(compile_time_us);
-    {
-      mutex_lock lock(cluster_compile_stats_mu_);
-      auto it = cluster_compile_stats_.find(function.name());
-      it->second.compile_count++;
-      it->second.cumulative_compile_time_us += compile_time_us;
-      LogOnceXlaCompiledFirstCluster();
-      VLOG(1) << "compiled " << function.name() << " "
-              << it->second.compile_count
-              << " times, compile time: " << compile_time_us
-              << " us, cumulative: " << it->second.cumulative_compile_time_us
-              << " us ("
-              << tensorflow::strings::HumanReadableElapsedTime(compile_time_us /
-                                                               1.0e6)
-              << " / "
-              << tensorflow::strings::HumanReadableElapsedTime(
-                     it->second.cumulative_compile_time_us / 1.0e6)
-              << ")";
-
-      XlaJitCompilationActivity jit_compilation_activity;
-      jit_compilation_activity.set_cluster_name(function.name());
-      jit_compilation_activity.set_compile_count(it->second.compile_count);
-      jit_compilation_activity.set_compile_time_us(compile_time_us);
-      jit_compilation_activity.set_cumulative_compile_time_us(
-          it->second.cumulative_compile_time_us);
-
-      TF_RETURN_IF_ERROR(
-          BroadcastXlaActivity(std::move(jit_compilation_activity)));
+    if (asynchronous) {
+      if (!entry->compiling_asynchronously) {
+        entry->compiling_asynchronously = true;
+        CompileAsynchronously(entry, options, signature, function, compile_fn);
+      }
+      VLOG(2) << "Compiling asynchronously for signature: "
+              << signature.HumanString();
+      *out_compilation_result = nullptr;
+      *out_executable = nullptr;
+      return Status::OK();
     }
+
+    TF_RETURN_IF_ERROR(
+        CompileStrict(entry, options, signature, function, compile_fn));
   }
   TF_RETURN_IF_ERROR(entry->compilation_status);
   *out_compilation_result = &entry->compilation_result;
@@ -20,6 +20,7 @@ limitations under the License.
 #include "absl/container/inlined_vector.h"
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
+#include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "tensorflow/compiler/tf2xla/xla_context.h"
 #include "tensorflow/compiler/xla/client/local_client.h"
@@ -42,14 +43,23 @@ namespace tensorflow {
 //
 // Currently no cache eviction policy is implemented and the cache grows without
 // bound.
+//
+// If `persistent_cache_dir` is non-empty, the results of the Tensorflow to XLA
+// lowering are also stored in that directory, keyed by the signature, the
+// functions being compiled and a fingerprint of the compiler version and
+// flags, and are reused by later processes instead of lowering the graph
+// again. The executables themselves are not persisted and are always rebuilt
+// from the cached XLA computations.
 class XlaCompilationCache : public ResourceBase {
  public:
-  XlaCompilationCache(xla::LocalClient* client, DeviceType device_type);
+  XlaCompilationCache(xla::LocalClient* client, DeviceType device_type,
+                      string persistent_cache_dir = "");
   ~XlaCompilationCache() override;
 
   enum class CompileMode {
     kLazy,
     kStrict,
+    kAsync,
   };
 
   // Compiles a function into a XlaCompiler::CompilationResult that can be used
@@ -62,7 +72,14 @@ class XlaCompilationCache : public ResourceBase {
   // heuristics, the compilation cache may decide not to compile the cluster at
   // this time.  In this case it returns null into both `out_compilation_result`
   // and `out_executable`.  If `compile_mode` is `kStrict` then the compilation
-  // cache always attempts the compilation on a cache miss.
+  // cache always attempts the compilation on a cache miss.  If `compile_mode`
+  // is `kAsync` then the cache behaves like `kLazy`, except that instead of
+  // compiling the cluster it starts compiling it on a background thread and
+  // returns null until the compilation has finished, so that the caller can
+  // keep running the cluster without XLA in the meantime.  In this mode
+  // `options` must not refer to state that is destroyed before the cache, with
+  // the exception of `options.device_allocator`, which background compilations
+  // don't use.
   //
   // The result of compilation is written to `*out_compilation_result`, which
   // must be non-null. If `out_executable` is non-null, also builds an
@@ -113,6 +130,10 @@ class XlaCompilationCache : public ResourceBase {
 
     // Returns a human-readable description of the signature.
     string HumanString() const;
+
+    // Returns a serialization of the signature that is stable across
+    // processes, which identifies the signature in the persistent cache.
+    string Serialize() const;
   };
 
   // Builds the signature for a compilation.
@@ -120,33 +141,86 @@ class XlaCompilationCache : public ResourceBase {
       const NameAttrList& function,
       absl::Span<const XlaCompiler::Argument> args);
 
+  // Converts compilation results to and from the format in which they are
+  // stored in the persistent cache.
+  static Status CompilationResultToProto(
+      const XlaCompiler::CompilationResult& result,
+      XlaCompilationResultProto* proto);
+  static Status CompilationResultFromProto(
+      const XlaCompilationResultProto& proto,
+      XlaCompiler::CompilationResult* result);
+
  private:
+  using CompileFn = std::function<Status(XlaCompiler* compiler,
+                                          XlaCompiler::CompilationResult*)>;
+
+  // The value associated with a cache entry.
+  struct Entry;
+
   // Common implementation of Compile and CompileSingleOp.
   Status CompileImpl(
       const XlaCompiler::Options& options, const NameAttrList& function,
-      absl::Span<const XlaCompiler::Argument> args,
-      const std::function<Status(XlaCompiler* compiler,
-                                 XlaCompiler::CompilationResult*)>& compile_fn,
-      absl::optional<int64> compile_threshold,
+      absl::Span<const XlaCompiler::Argument> args, const CompileFn& compile_fn,
+      absl::optional<int64> compile_threshold, bool asynchronous,
       const XlaCompiler::CompilationResult** out_compilation_result,
       xla::LocalExecutable** out_executable);
 
+  // Compiles `entry` with `compile_fn` and builds its executable.
+  Status CompileStrict(Entry* entry, const XlaCompiler::Options& options,
+                       const Signature& signature, const NameAttrList& function,
+                       const CompileFn& compile_fn)
+      EXCLUSIVE_LOCKS_REQUIRED(entry->mu);
+
+  // Schedules the compilation of `entry` on `async_compiler_threads_`. The
+  // entry is updated once the compilation has finished.
+  void CompileAsynchronously(Entry* entry, const XlaCompiler::Options& options,
+                             const Signature& signature,
+                             const NameAttrList& function,
+                             const CompileFn& compile_fn)
+      EXCLUSIVE_LOCKS_REQUIRED(entry->mu);
+
   // Takes `result` which has been compiled from a Tensorflow subgraph to a
   // XLA computation already, and generates an XLA LocalExecutable `executable`.
   Status BuildExecutable(const XlaCompiler::Options& options,
                          const XlaCompiler::CompilationResult& result,
                          std::unique_ptr<xla::LocalExecutable>* executable);
 
+  // Returns the name of the file that holds the persistent cache entry for the
+  // compilation of `function` with `serialized_signature`.
+  string PersistentCacheFilename(const XlaCompiler::Options& options,
+                                 const NameAttrList& function,
+                                 const string& serialized_signature) const;
+
+  // Reads a compilation result from the persistent cache. Returns false if
+  // there is no entry for the signature, or if it can't be read.
+  bool ReadFromPersistentCache(const string& filename,
+                               const string& serialized_signature,
+                               XlaCompiler::CompilationResult* result);
+
+  // Writes a compilation result to the persistent cache.
+  Status WriteToPersistentCache(const string& filename,
+                                const string& serialized_signature,
+                                const XlaCompiler::CompilationResult& result);
+
   xla::LocalClient* const client_;
   const DeviceType device_type_;
 
-  // The value associated with a cache entry.
+  // Directory of the persistent cache, or empty if it is disabled.
+  const string persistent_cache_dir_;
+
+  // Fingerprint of the TensorFlow version, the platform and the XLA flags,
+  // which all determine the result of a compilation.
+  uint64 compiler_fingerprint_ = 0;
+
   struct Entry {
     mutex mu;
 
     // Have we tried compiling this entry?
     bool compiled = false;
 
+    // Is this entry being compiled on a background thread?
+    bool compiling_asynchronously GUARDED_BY(mu) = false;
+
     // The number of times a compilation with this signature has been requested.
     int64 request_count = 0;
 
@@ -191,6 +265,13 @@ class XlaCompilationCache : public ResourceBase {
   // signature before  we attempt to compile it.
   static constexpr int64 kDefaultCompilationThreshold = 2;
 
+  // Threads running the compilations requested in kAsync mode. Created on the
+  // first such request.
+  static constexpr int kNumAsyncCompilerThreads = 4;
+  mutex async_compiler_mu_;
+  std::unique_ptr<thread::ThreadPool> async_compiler_threads_
+      GUARDED_BY(async_compiler_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(XlaCompilationCache);
 };
 
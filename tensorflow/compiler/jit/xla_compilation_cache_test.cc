@@ -16,6 +16,9 @@ limitations under the License.
 #include "tensorflow/compiler/jit/xla_compilation_cache.h"
 
 #include "tensorflow/compiler/tf2xla/shape_util.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -52,6 +55,92 @@ TEST(XlaCompilationCacheTest, SignatureEquality) {
   }
 }
 
+TEST(XlaCompilationCacheTest, SignatureSerialization) {
+  NameAttrList fn;
+  fn.set_name("afunction");
+  std::vector<XlaCompiler::Argument> args(2);
+  args[0].kind = XlaCompiler::Argument::kConstant;
+  args[0].type = DT_STRING;
+  args[0].shape = TensorShape({1});
+  args[0].constant_value = test::AsTensor<tstring>({"a"});
+  args[1].kind = XlaCompiler::Argument::kParameter;
+  args[1].type = DT_FLOAT;
+  args[1].shape = TensorShape({2, 3});
+  TF_ASSERT_OK_AND_ASSIGN(XlaCompilationCache::Signature s1,
+                          XlaCompilationCache::BuildSignature(fn, args));
+
+  // Equal string constants in different buffers serialize identically.
+  args[0].constant_value = test::AsTensor<tstring>({"a"});
+  TF_ASSERT_OK_AND_ASSIGN(XlaCompilationCache::Signature s2,
+                          XlaCompilationCache::BuildSignature(fn, args));
+  EXPECT_EQ(s1.Serialize(), s2.Serialize());
+
+  args[0].constant_value = test::AsTensor<tstring>({"b"});
+  TF_ASSERT_OK_AND_ASSIGN(XlaCompilationCache::Signature s3,
+                          XlaCompilationCache::BuildSignature(fn, args));
+  EXPECT_NE(s1.Serialize(), s3.Serialize());
+
+  args[1].shape = TensorShape({3, 2});
+  TF_ASSERT_OK_AND_ASSIGN(XlaCompilationCache::Signature s4,
+                          XlaCompilationCache::BuildSignature(fn, args));
+  EXPECT_NE(s3.Serialize(), s4.Serialize());
+}
+
+TEST(XlaCompilationCacheTest, CompilationResultProtoRoundTrip) {
+  XlaCompiler::CompilationResult result;
+  result.input_mapping = {0, 2};
+  result.xla_input_shapes = {xla::ShapeUtil::MakeShape(xla::F32, {2, 3}),
+                             xla::ShapeUtil::MakeShape(xla::S32, {})};
+  result.xla_output_shape = xla::ShapeUtil::MakeTupleShape(
+      {xla::ShapeUtil::MakeShape(xla::F32, {2, 3})});
+  result.outputs.resize(2);
+  result.outputs[0].type = DT_FLOAT;
+  result.outputs[0].shape = TensorShape({2, 3});
+  result.outputs[1].type = DT_INT32;
+  result.outputs[1].shape = TensorShape({2});
+  result.outputs[1].is_constant = true;
+  result.outputs[1].constant_value = test::AsTensor<int32>({7, 8});
+  result.resource_updates.resize(1);
+  result.resource_updates[0].input_index = 1;
+  result.resource_updates[0].type = DT_FLOAT;
+  result.resource_updates[0].shape = TensorShape({4});
+  result.resource_updates[0].modified = true;
+  result.resource_updates[0].tensor_array_gradients_accessed = {"grad"};
+  xla::HloModuleProto module;
+  module.set_name("cluster");
+  result.computation = std::make_shared<xla::XlaComputation>(module);
+
+  XlaCompilationResultProto proto;
+  TF_ASSERT_OK(XlaCompilationCache::CompilationResultToProto(result, &proto));
+  XlaCompiler::CompilationResult restored;
+  TF_ASSERT_OK(
+      XlaCompilationCache::CompilationResultFromProto(proto, &restored));
+
+  EXPECT_EQ(restored.input_mapping, result.input_mapping);
+  ASSERT_EQ(restored.xla_input_shapes.size(), 2);
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_TRUE(xla::ShapeUtil::Equal(restored.xla_input_shapes[i],
+                                      result.xla_input_shapes[i]));
+  }
+  EXPECT_TRUE(xla::ShapeUtil::Equal(restored.xla_output_shape,
+                                    result.xla_output_shape));
+  ASSERT_EQ(restored.outputs.size(), 2);
+  EXPECT_EQ(restored.outputs[0].type, DT_FLOAT);
+  EXPECT_EQ(restored.outputs[0].shape, TensorShape({2, 3}));
+  EXPECT_FALSE(restored.outputs[0].is_constant);
+  EXPECT_TRUE(restored.outputs[1].is_constant);
+  test::ExpectTensorEqual<int32>(restored.outputs[1].constant_value,
+                                 result.outputs[1].constant_value);
+  ASSERT_EQ(restored.resource_updates.size(), 1);
+  EXPECT_EQ(restored.resource_updates[0].input_index, 1);
+  EXPECT_EQ(restored.resource_updates[0].shape, TensorShape({4}));
+  EXPECT_TRUE(restored.resource_updates[0].modified);
+  EXPECT_EQ(restored.resource_updates[0].tensor_array_gradients_accessed,
+            std::set<string>({"grad"}));
+  ASSERT_NE(restored.computation, nullptr);
+  EXPECT_EQ(restored.computation->proto().name(), "cluster");
+}
+
 static void BM_BuildSignature(int iters, int n_args) {
   NameAttrList fn;
   fn.set_name("afunction");
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/refcount.h"
@@ -247,19 +248,25 @@ void XlaComputationLaunchContext::PopulateInputs(
   }
 }
 
-static bool MustAliasOutput(
+// Returns the index in the computation result of output `output_num`.
+static xla::ShapeIndex AliasOutputIndex(
     const xla::HloInputOutputAliasConfig& input_output_alias, int output_num) {
-  xla::ShapeIndex output_index;
   if (input_output_alias.shape().IsTuple()) {
-    output_index = {output_num};
-  } else {
-    DCHECK_EQ(output_num, 0)
-        << "output_num must be 0 for non-tuple shapes but is " << output_num;
-    output_index = {};
+    return {output_num};
   }
-  if (input_output_alias.shape().tuple_shapes_size() == 0) {
+  DCHECK_EQ(output_num, 0)
+      << "output_num must be 0 for non-tuple shapes but is " << output_num;
+  return {};
+}
+
+static bool MustAliasOutput(
+    const xla::HloInputOutputAliasConfig& input_output_alias, int output_num) {
+  if (input_output_alias.shape().IsTuple() &&
+      input_output_alias.shape().tuple_shapes_size() == 0) {
     return false;
   }
+  xla::ShapeIndex output_index =
+      AliasOutputIndex(input_output_alias, output_num);
   return input_output_alias.OutputHasAlias(output_index) &&
          input_output_alias.GetAliasedParameter(output_index).value().kind ==
              xla::HloInputOutputAliasConfig::kUserAlias;
@@ -272,9 +279,12 @@ static const Tensor* FindAliasedTensorForOutput(
     absl::Span<const int> input_mapping,
     const std::map<int, OptionalTensor>& resource_var_snapshots) {
   if (MustAliasOutput(input_output_alias, output_num)) {
-    int xla_param = input_output_alias.GetAliasedParameter({output_num})
-                        .value()
-                        .parameter_number;
+    int xla_param =
+        input_output_alias
+            .GetAliasedParameter(
+                AliasOutputIndex(input_output_alias, output_num))
+            .value()
+            .parameter_number;
     int tf_param = input_mapping[xla_param] - missing_ctx_input_prefix;
     const Tensor* input_tensor = &ctx->input(tf_param);
 
@@ -370,11 +380,115 @@ static Status SetBufferForResourceVarTensorUnderAllocateXlaTensors(
   return Status::OK();
 }
 
+// Looks up (or creates, if the computation initializes them) the variables
+// written by `kernel`, in the order of `kernel->resource_updates`.
+static Status GetVariableInfosForResourceUpdates(
+    OpKernelContext* ctx, const XlaCompiler::CompilationResult* kernel,
+    int missing_ctx_input_prefix, std::vector<VariableInfo>* variable_infos) {
+  variable_infos->reserve(kernel->resource_updates.size());
+
+  for (int i = 0; i < kernel->resource_updates.size(); ++i) {
+    const XlaCompiler::ResourceUpdate& write = kernel->resource_updates[i];
+    int actual_input_index = write.input_index - missing_ctx_input_prefix;
+    if (actual_input_index < 0 || actual_input_index >= ctx->num_inputs()) {
+      return errors::Internal("Invalid input index for variable write.");
+    }
+
+    // TODO(b/35625933): tensorflow::Var should contain a PersistentTensor,
+    // not a Tensor.
+    Var* variable = nullptr;
+    TF_RETURN_IF_ERROR(LookupOrCreateResource<Var>(
+        ctx, HandleFromInput(ctx, actual_input_index), &variable,
+        [&write](Var** ptr) {
+          *ptr = new Var(write.type);
+          return Status::OK();
+        }));
+    variable_infos->emplace_back(actual_input_index, variable);
+  }
+  return Status::OK();
+}
+
+// Sets `*copy` to a new tensor holding the value of `tensor`, on the same
+// device.
+static Status CopyTensorForDonation(OpKernelContext* ctx, const Tensor& tensor,
+                                    Tensor* copy) {
+  se::Stream* stream =
+      ctx->op_device_context() ? ctx->op_device_context()->stream() : nullptr;
+  if (stream == nullptr) {
+    *copy = tensor::DeepCopy(tensor);
+    return Status::OK();
+  }
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(tensor.dtype(), tensor.shape(), copy));
+  if (tensor.TotalBytes() > 0) {
+    se::DeviceMemoryBase dst = XlaTensor::DeviceMemoryFromTensor(*copy);
+    stream->ThenMemcpy(&dst, XlaTensor::DeviceMemoryFromTensor(tensor),
+                       tensor.TotalBytes());
+    if (!stream->ok()) {
+      return errors::Internal("Failed to copy a donated variable.");
+    }
+  }
+  return Status::OK();
+}
+
+Status XlaComputationLaunchContext::DonateResourceVariables(
+    OpKernelContext* ctx, const XlaCompiler::CompilationResult* kernel,
+    int missing_ctx_input_prefix,
+    const xla::HloInputOutputAliasConfig& input_output_alias,
+    std::map<int, OptionalTensor>* resource_var_snapshots,
+    std::vector<VariableInfo>* resource_update_variables) {
+  if (allocate_xla_tensors_) {
+    return errors::Unimplemented(
+        "Aliasing is not yet supported for allocate_xla_tensors_.");
+  }
+  TF_RETURN_IF_ERROR(GetVariableInfosForResourceUpdates(
+      ctx, kernel, missing_ctx_input_prefix, resource_update_variables));
+  TF_RETURN_IF_ERROR(LockVariables(absl::MakeSpan(*resource_update_variables)));
+
+  // Variable updates follow the non-constant, non-resource outputs.
+  int output_num = absl::c_count_if(
+      kernel->outputs, [](const XlaCompiler::OutputDescription& output) {
+        return !output.is_constant && output.type != DT_RESOURCE;
+      });
+  for (int i = 0; i < kernel->resource_updates.size(); ++i, ++output_num) {
+    if (!MustAliasOutput(input_output_alias, output_num)) {
+      continue;
+    }
+    const XlaCompiler::ResourceUpdate& write = kernel->resource_updates[i];
+    auto it = resource_var_snapshots->find(write.input_index);
+    TF_RET_CHECK(it != resource_var_snapshots->end() && it->second.present)
+        << "Aliased variable update " << i << " has no snapshot";
+    Tensor& snapshot = it->second.value;
+    Var* variable = (*resource_update_variables)[i].var();
+
+    // The computation overwrites the buffer it is given, so it may only get a
+    // buffer that nothing but the variable refers to.
+    bool shared = variable->copy_on_read_mode.load();
+    if (variable->tensor()->SharesBufferWith(snapshot)) {
+      // Drop the snapshot's own reference before counting.
+      snapshot = Tensor();
+      shared = shared || !XlaTensor::RefCountIsOne(*variable->tensor());
+      snapshot = *variable->tensor();
+    } else {
+      shared = shared || !XlaTensor::RefCountIsOne(snapshot);
+    }
+    if (shared) {
+      VLOG(2) << "Copying variable update " << i << " before donating it";
+      Tensor copy;
+      TF_RETURN_IF_ERROR(CopyTensorForDonation(ctx, snapshot, &copy));
+      snapshot = copy;
+    } else {
+      VLOG(2) << "Donating the buffer of variable update " << i;
+    }
+  }
+  return Status::OK();
+}
+
 Status XlaComputationLaunchContext::PopulateOutputs(
     OpKernelContext* ctx, const XlaCompiler::CompilationResult* kernel,
     ScopedShapedBuffer output, int missing_ctx_input_prefix,
     const xla::HloInputOutputAliasConfig& input_output_alias,
-    const std::map<int, OptionalTensor>& resource_var_snapshots) {
+    const std::map<int, OptionalTensor>& resource_var_snapshots,
+    absl::Span<VariableInfo> locked_resource_update_variables) {
   se::Stream* stream =
       ctx->op_device_context() ? ctx->op_device_context()->stream() : nullptr;
 
@@ -496,29 +610,15 @@ Status XlaComputationLaunchContext::PopulateOutputs(
 
   // Apply variable updates, if any.
   VLOG(2) << "Applying variable updates";
-  std::vector<VariableInfo> variable_infos;
-  variable_infos.reserve(kernel->resource_updates.size());
-
-  for (int i = 0; i < kernel->resource_updates.size(); ++i) {
-    const XlaCompiler::ResourceUpdate& write = kernel->resource_updates[i];
-    int actual_input_index = write.input_index - missing_ctx_input_prefix;
-    if (actual_input_index < 0 || actual_input_index >= ctx->num_inputs()) {
-      return errors::Internal("Invalid input index for variable write.");
-    }
-
-    // TODO(b/35625933): tensorflow::Var should contain a PersistentTensor,
-    // not a Tensor.
-    Var* variable = nullptr;
-    TF_RETURN_IF_ERROR(LookupOrCreateResource<Var>(
-        ctx, HandleFromInput(ctx, actual_input_index), &variable,
-        [&write](Var** ptr) {
-          *ptr = new Var(write.type);
-          return Status::OK();
-        }));
-    variable_infos.emplace_back(actual_input_index, variable);
+  std::vector<VariableInfo> owned_variable_infos;
+  absl::Span<VariableInfo> variable_infos = locked_resource_update_variables;
+  if (variable_infos.empty()) {
+    TF_RETURN_IF_ERROR(GetVariableInfosForResourceUpdates(
+        ctx, kernel, missing_ctx_input_prefix, &owned_variable_infos));
+    TF_RETURN_IF_ERROR(LockVariables(absl::MakeSpan(owned_variable_infos)));
+    variable_infos = absl::MakeSpan(owned_variable_infos);
   }
-
-  TF_RETURN_IF_ERROR(LockVariables(absl::MakeSpan(variable_infos)));
+  TF_RET_CHECK(variable_infos.size() == kernel->resource_updates.size());
 
   for (int i = 0; i < kernel->resource_updates.size(); ++i) {
     Allocator* allocator = ctx->device()->GetAllocator({});
@@ -150,11 +150,36 @@ class XlaComputationLaunchContext {
   //
   // Assumes that the first `missing_ctx_input_prefix` inputs to the kernel are
   // missing and adjusts input indices accordingly.
+  //
+  // If `locked_resource_update_variables` is not empty, it holds the already
+  // locked variables written by the computation, as returned by
+  // DonateResourceVariables(), and no further locks are taken.
   Status PopulateOutputs(
       OpKernelContext* ctx, const XlaCompiler::CompilationResult* kernel,
       xla::ScopedShapedBuffer output, int missing_ctx_input_prefix,
       const xla::HloInputOutputAliasConfig& input_output_alias,
-      const std::map<int, OptionalTensor>& resource_var_snapshots);
+      const std::map<int, OptionalTensor>& resource_var_snapshots,
+      absl::Span<VariableInfo> locked_resource_update_variables = {});
+
+  // Prepares the snapshots in `resource_var_snapshots` of the variables whose
+  // updates `kernel` writes in place, i.e. whose update output is aliased with
+  // the variable's parameter (see XlaCompiler::CompileOptions::
+  // alias_resource_update), to be donated to the computation.
+  //
+  // Locks every variable written by the computation and returns them in
+  // `*resource_update_variables`; the locks must be held until the updates
+  // have been written back by PopulateOutputs(). A snapshot is donated as is
+  // when nothing but the variable references its buffer. Otherwise the
+  // snapshot is replaced by a private copy, so that other readers of the
+  // buffer never observe the update.
+  //
+  // Must be called before PopulateInputs().
+  Status DonateResourceVariables(
+      OpKernelContext* ctx, const XlaCompiler::CompilationResult* kernel,
+      int missing_ctx_input_prefix,
+      const xla::HloInputOutputAliasConfig& input_output_alias,
+      std::map<int, OptionalTensor>* resource_var_snapshots,
+      std::vector<VariableInfo>* resource_update_variables);
 
   // Return the argument list. Only valid after PopulateInputs() has been
   // called.
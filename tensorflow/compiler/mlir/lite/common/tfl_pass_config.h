@@ -57,6 +57,13 @@ struct PassConfig {
   // are formed by grouping consecutive ops of the same device, under a
   // `tf_device.launch` op.
   bool form_clusters;
+  // If `conversion_cache_dir` is not empty, the legalization and quantization
+  // passes are run on each function separately and their results are cached in
+  // this directory, so converting a model which shares functions with a model
+  // converted before only runs them on the functions that changed. Entries are
+  // not invalidated when the converter itself changes, so the directory should
+  // be specific to a converter build.
+  std::string conversion_cache_dir;
 };
 
 }  // namespace TFL
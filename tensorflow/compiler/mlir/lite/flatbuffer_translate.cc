@@ -497,6 +497,9 @@ Optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
     return llvm::None;
   }
   absl::string_view tensor_data = tensor.tensor_data();
+  // Honor the 'force_align' of the schema, so that the interpreter can use the
+  // data of a memory-mapped model in place.
+  builder_.ForceVectorAlignment(tensor_data.size(), sizeof(uint8_t), 16);
   auto buffer_data = builder_.CreateVector(
       reinterpret_cast<const uint8_t*>(tensor_data.data()), tensor_data.size());
   return tflite::CreateBuffer(builder_, buffer_data);
@@ -15,6 +15,11 @@ limitations under the License.
 
 #include "tensorflow/compiler/mlir/lite/tf_tfl_passes.h"
 
+#include <string>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "mlir/IR/Attributes.h"  // TF:local_config_mlir
 #include "mlir/IR/Module.h"  // TF:local_config_mlir
 #include "mlir/Pass/Pass.h"  // TF:local_config_mlir
@@ -34,6 +39,25 @@ CreateTFExecutorToControlDialectConversion();
 }  // namespace mlir
 
 namespace tensorflow {
+namespace {
+
+// Returns a cache key identifying the quantization passes added by
+// AddQuantizationPasses for `quant_specs` and `emit_quant_adaptor_ops`.
+std::string QuantizationCacheKey(
+    const mlir::TFL::QuantizationSpecs& quant_specs,
+    bool emit_quant_adaptor_ops) {
+  return absl::StrCat(
+      "quantize:", quant_specs.target_func, ":",
+      static_cast<int>(quant_specs.inference_type), ":",
+      quant_specs.weight_quantization, ":",
+      quant_specs.post_training_quantization, ":", emit_quant_adaptor_ops, ":",
+      absl::StrJoin(quant_specs.input_ranges, ",",
+                    [](std::string* out, const std::pair<double, double>& r) {
+                      absl::StrAppend(out, r.first, "/", r.second);
+                    }));
+}
+
+}  // namespace
 
 void AddQuantizationPasses(const mlir::TFL::QuantizationSpecs& quant_specs,
                            bool emit_quant_adaptor_ops,
@@ -105,10 +129,19 @@ void AddTFToTFLConversionPasses(const mlir::TFL::PassConfig& pass_config,
   if (pass_config.emit_builtin_tflite_ops) {
     // Prepare for TFLite dialect, rerun canonicalization, and then legalize to
     // the TFLite dialect.
-    pass_manager->addPass(mlir::TFL::CreatePrepareTFPass());
-    pass_manager->addPass(mlir::createCanonicalizerPass());
-    pass_manager->addPass(mlir::TFL::CreateLegalizeTFPass());
-    pass_manager->addPass(mlir::TFL::CreateOptimizePass());
+    auto add_legalization_passes = [](mlir::PassManager* pass_manager) {
+      pass_manager->addPass(mlir::TFL::CreatePrepareTFPass());
+      pass_manager->addPass(mlir::createCanonicalizerPass());
+      pass_manager->addPass(mlir::TFL::CreateLegalizeTFPass());
+      pass_manager->addPass(mlir::TFL::CreateOptimizePass());
+    };
+    if (pass_config.conversion_cache_dir.empty()) {
+      add_legalization_passes(pass_manager);
+    } else {
+      pass_manager->addPass(mlir::TFL::CreateCacheFunctionPassesPass(
+          pass_config.conversion_cache_dir, "legalize",
+          add_legalization_passes));
+    }
     // This pass operates on TensorFlow ops but is triggered after legalization
     // so that it can target constants introduced once TensorFlow Identity ops
     // are removed during legalization.
@@ -127,8 +160,19 @@ void AddTFToTFLConversionPasses(const mlir::TFL::PassConfig& pass_config,
     // Run quantization after all the floating point model conversion is
     // completed.
     if (pass_config.quant_specs.RunPropagationAndRewriteQuantizationPasses()) {
-      AddQuantizationPasses(pass_config.quant_specs,
-                            pass_config.emit_quant_adaptor_ops, pass_manager);
+      if (pass_config.conversion_cache_dir.empty()) {
+        AddQuantizationPasses(pass_config.quant_specs,
+                              pass_config.emit_quant_adaptor_ops, pass_manager);
+      } else {
+        const auto& quant_specs = pass_config.quant_specs;
+        const bool emit_quant_adaptor_ops = pass_config.emit_quant_adaptor_ops;
+        pass_manager->addPass(mlir::TFL::CreateCacheFunctionPassesPass(
+            pass_config.conversion_cache_dir,
+            QuantizationCacheKey(quant_specs, emit_quant_adaptor_ops),
+            [quant_specs, emit_quant_adaptor_ops](mlir::PassManager* pm) {
+              AddQuantizationPasses(quant_specs, emit_quant_adaptor_ops, pm);
+            }));
+      }
     }
   }
 }
@@ -177,6 +177,7 @@ int main(int argc, char **argv) {
   pass_config.emit_builtin_tflite_ops = emit_builtin_tflite_ops;
   pass_config.emit_quant_adaptor_ops = emit_quant_adaptor_ops;
   pass_config.lower_tensor_list_ops = lower_tensor_list_ops;
+  pass_config.conversion_cache_dir = conversion_cache_dir;
 
   tensorflow::AddTFToTFLConversionPasses(pass_config, &pm);
 
@@ -76,3 +76,12 @@ opt<std::string> quant_stats_file_name("quant-stats",
                                        llvm::cl::desc("<stats file>"),
                                        llvm::cl::value_desc("filename"),
                                        llvm::cl::init(""));
+
+// The directory in which the results of the legalization and quantization
+// passes are cached per function, to speed up converting models which share
+// functions. The passes are not cached if this is empty.
+// NOLINTNEXTLINE
+opt<std::string> conversion_cache_dir(
+    "conversion-cache-dir",
+    llvm::cl::desc("Directory caching the converted functions"),
+    llvm::cl::value_desc("dirname"), llvm::cl::init(""));
@@ -38,4 +38,5 @@ extern llvm::cl::opt<bool> output_mlir;
 extern llvm::cl::list<std::string> custom_opdefs;
 extern llvm::cl::opt<bool> emit_quant_adaptor_ops;
 extern llvm::cl::opt<std::string> quant_stats_file_name;
+extern llvm::cl::opt<std::string> conversion_cache_dir;
 #endif  // TENSORFLOW_COMPILER_MLIR_LITE_TF_TFL_TRANSLATE_CL_H_
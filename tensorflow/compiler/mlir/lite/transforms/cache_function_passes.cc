@@ -0,0 +1,180 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// This transformation pass runs a pipeline of function passes on each function
+// of the module separately, and caches the resulting function in a directory
+// keyed by the fingerprint of the function before the pipeline. Converting a
+// model which shares most of its functions with a previously converted model
+// then only runs the pipeline on the functions that changed.
+
+#include <functional>
+#include <string>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/IR/Function.h"  // TF:local_config_mlir
+#include "mlir/IR/Module.h"  // TF:local_config_mlir
+#include "mlir/IR/OperationSupport.h"  // TF:local_config_mlir
+#include "mlir/Parser.h"  // TF:local_config_mlir
+#include "mlir/Pass/Pass.h"  // TF:local_config_mlir
+#include "mlir/Pass/PassManager.h"  // TF:local_config_mlir
+#include "tensorflow/compiler/mlir/lite/transforms/passes.h"
+#include "tensorflow/core/platform/fingerprint.h"
+
+namespace mlir {
+namespace TFL {
+namespace {
+
+// Prints `op` with its locations, which become the tensor names of the
+// exported model and so must survive a round trip through the cache.
+std::string PrintWithLocations(Operation* op) {
+  std::string text;
+  llvm::raw_string_ostream os(text);
+  op->print(os, OpPrintingFlags().enableDebugInfo());
+  return os.str();
+}
+
+class CacheFunctionPassesPass : public ModulePass<CacheFunctionPassesPass> {
+ public:
+  CacheFunctionPassesPass(llvm::StringRef cache_dir, llvm::StringRef cache_key,
+                          std::function<void(PassManager*)> add_passes)
+      : cache_dir_(cache_dir),
+        cache_key_(cache_key),
+        add_passes_(std::move(add_passes)) {}
+
+ private:
+  void runOnModule() override;
+
+  // Returns a new module holding a clone of `func` and declarations of the
+  // other functions of the module, which `func` may call.
+  OwningModuleRef IsolateFunction(FuncOp func);
+
+  // Replaces `func` with the function of the same name in `module`.
+  void ReplaceFunction(FuncOp func, ModuleOp module);
+
+  // Reads the cached module of `key`, or returns an empty string if there is
+  // none.
+  std::string ReadCacheEntry(llvm::StringRef key);
+  void WriteCacheEntry(llvm::StringRef key, llvm::StringRef text);
+
+  std::string cache_dir_;
+  std::string cache_key_;
+  std::function<void(PassManager*)> add_passes_;
+};
+
+void CacheFunctionPassesPass::runOnModule() {
+  ModuleOp module = getModule();
+  llvm::SmallVector<FuncOp, 4> funcs;
+  for (auto func : module.getOps<FuncOp>()) {
+    if (!func.isExternal()) funcs.push_back(func);
+  }
+
+  for (FuncOp func : funcs) {
+    OwningModuleRef isolated = IsolateFunction(func);
+    const std::string key = absl::StrCat(
+        tensorflow::Fingerprint64(
+            absl::StrCat(cache_key_, "\n", PrintWithLocations(*isolated))),
+        ".mlir");
+
+    const std::string cached = ReadCacheEntry(key);
+    if (!cached.empty()) {
+      // A corrupted entry is ignored and overwritten below.
+      if (OwningModuleRef result = parseSourceString(cached, &getContext())) {
+        ReplaceFunction(func, *result);
+        continue;
+      }
+    }
+
+    PassManager pass_manager(&getContext());
+    add_passes_(&pass_manager);
+    if (failed(pass_manager.run(*isolated))) return signalPassFailure();
+    WriteCacheEntry(key, PrintWithLocations(*isolated));
+    ReplaceFunction(func, *isolated);
+  }
+}
+
+OwningModuleRef CacheFunctionPassesPass::IsolateFunction(FuncOp func) {
+  OwningModuleRef isolated = ModuleOp::create(getModule().getLoc());
+  for (auto other : getModule().getOps<FuncOp>()) {
+    if (other == func) {
+      isolated->push_back(func.clone());
+    } else {
+      isolated->push_back(
+          FuncOp::create(other.getLoc(), other.getName(), other.getType()));
+    }
+  }
+  return isolated;
+}
+
+void CacheFunctionPassesPass::ReplaceFunction(FuncOp func, ModuleOp module) {
+  FuncOp replacement = module.lookupSymbol<FuncOp>(func.getName());
+  replacement.getOperation()->moveBefore(func);
+  func.erase();
+}
+
+std::string CacheFunctionPassesPass::ReadCacheEntry(llvm::StringRef key) {
+  llvm::SmallString<128> path(cache_dir_);
+  llvm::sys::path::append(path, key);
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer) return "";
+  return (*buffer)->getBuffer().str();
+}
+
+void CacheFunctionPassesPass::WriteCacheEntry(llvm::StringRef key,
+                                              llvm::StringRef text) {
+  // Write to a unique file first and rename it into place, so concurrent
+  // conversions sharing the cache never read a partially written entry.
+  // Failing to write an entry only costs a cache miss later.
+  if (llvm::sys::fs::create_directories(cache_dir_)) return;
+  llvm::SmallString<128> model(cache_dir_);
+  llvm::sys::path::append(model, key + "-%%%%%%.tmp");
+  int fd;
+  llvm::SmallString<128> temp_path;
+  if (llvm::sys::fs::createUniqueFile(model, fd, temp_path)) return;
+  {
+    llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+    os << text;
+    if (os.has_error()) {
+      os.clear_error();
+      llvm::sys::fs::remove(temp_path);
+      return;
+    }
+  }
+  llvm::SmallString<128> path(cache_dir_);
+  llvm::sys::path::append(path, key);
+  if (llvm::sys::fs::rename(temp_path, path)) {
+    llvm::sys::fs::remove(temp_path);
+  }
+}
+
+}  // namespace
+
+// Creates an instance of the TensorFlow Lite dialect CacheFunctionPasses pass.
+std::unique_ptr<OpPassBase<ModuleOp>> CreateCacheFunctionPassesPass(
+    llvm::StringRef cache_dir, llvm::StringRef cache_key,
+    std::function<void(PassManager*)> add_passes) {
+  return std::make_unique<CacheFunctionPassesPass>(cache_dir, cache_key,
+                                                   std::move(add_passes));
+}
+
+}  // namespace TFL
+}  // namespace mlir
@@ -16,13 +16,16 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_MLIR_LITE_TRANSFORMS_PASSES_H_
 #define TENSORFLOW_COMPILER_MLIR_LITE_TRANSFORMS_PASSES_H_
 
+#include <functional>
 #include <memory>
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
 
 namespace mlir {
 class FuncOp;
 class ModuleOp;
+class PassManager;
 template <typename T>
 class OpPassBase;
 
@@ -73,6 +76,15 @@ std::unique_ptr<OpPassBase<ModuleOp>> CreateLegalizeOphintFuncOpPass();
 std::unique_ptr<OpPassBase<FuncOp>> CreateSplitMergedOperandsPass();
 
 std::unique_ptr<OpPassBase<ModuleOp>> CreateOptimizeFunctionalOpsPass();
+
+// Creates an instance of the TensorFlow Lite dialect CacheFunctionPasses pass,
+// which runs the function passes added by `add_passes` on each function of the
+// module separately, and caches the resulting functions in `cache_dir`. The
+// cache entries are keyed by `cache_key` and the function before the passes,
+// so `cache_key` must identify the passes and all their options.
+std::unique_ptr<OpPassBase<ModuleOp>> CreateCacheFunctionPassesPass(
+    llvm::StringRef cache_dir, llvm::StringRef cache_key,
+    std::function<void(PassManager*)> add_passes);
 }  // namespace TFL
 
 }  // namespace mlir
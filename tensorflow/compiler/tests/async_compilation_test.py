@@ -0,0 +1,99 @@
+# Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for compiling XLA clusters on a background thread."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+import time
+
+from tensorflow.core.protobuf import config_pb2
+from tensorflow.core.protobuf import rewriter_config_pb2
+from tensorflow.python.client import session as session_lib
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import function
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.platform import test
+
+
+def NoRewriteSessionConfig():
+  rewriter_config = rewriter_config_pb2.RewriterConfig(
+      disable_model_pruning=True,
+      arithmetic_optimization=rewriter_config_pb2.RewriterConfig.OFF,
+      dependency_optimization=rewriter_config_pb2.RewriterConfig.OFF,
+      function_optimization=rewriter_config_pb2.RewriterConfig.OFF)
+  graph_options = config_pb2.GraphOptions(rewrite_options=rewriter_config)
+  return config_pb2.ConfigProto(graph_options=graph_options)
+
+
+def LabelsOfRun(sess, fetch, feed_dict):
+  """Runs `fetch` and returns its result and the labels of the executed ops."""
+  run_metadata = config_pb2.RunMetadata()
+  result = sess.run(
+      fetch,
+      feed_dict=feed_dict,
+      run_metadata=run_metadata,
+      options=config_pb2.RunOptions(
+          trace_level=config_pb2.RunOptions.FULL_TRACE))
+  labels = []
+  for dev_stats in run_metadata.step_stats.dev_stats:
+    for node_stats in dev_stats.node_stats:
+      labels.append(node_stats.timeline_label)
+  return result, labels
+
+
+def InLabels(labels, substr):
+  """Returns true iff one of the labels contains substr."""
+  return any(substr in x for x in labels)
+
+
+class AsyncCompilationTest(test.TestCase):
+
+  def testFallsBackToTensorFlowUntilCompiled(self):
+
+    @function.Defun(compiled=True)
+    def CompiledFunction(x):
+      return math_ops.log(x)
+
+    with session_lib.Session(config=NoRewriteSessionConfig()) as sess:
+      x = array_ops.placeholder(dtypes.float32)
+      y = CompiledFunction(x)
+      feed_dict = {x: [1., 1., 1.]}
+
+      # The first run starts the compilation in the background, and runs the
+      # cluster without XLA.
+      result, labels = LabelsOfRun(sess, y, feed_dict)
+      self.assertAllClose(result, [0., 0., 0.])
+      self.assertTrue(InLabels(labels, "_XlaCompile"))
+      self.assertFalse(InLabels(labels, "_XlaRun"))
+
+      # Once the compilation has finished, the cluster runs with XLA.
+      for _ in range(100):
+        result, labels = LabelsOfRun(sess, y, feed_dict)
+        self.assertAllClose(result, [0., 0., 0.])
+        if InLabels(labels, "_XlaRun"):
+          break
+        time.sleep(0.1)
+      self.assertTrue(InLabels(labels, "_XlaRun"))
+
+
+if __name__ == "__main__":
+  os.environ["TF_XLA_FLAGS"] = ("--tf_xla_enable_lazy_compilation=true "
+                                "--tf_xla_async_compilation=true " +
+                                os.environ.get("TF_XLA_FLAGS", ""))
+  test.main()
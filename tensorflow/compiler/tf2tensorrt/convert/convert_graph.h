@@ -48,6 +48,11 @@ struct ConversionParams {
   // maximum number of cached engines
   int max_cached_engines = 1;
   bool use_calibration = true;
+  // Batch sizes that dynamic TRT ops build engines for. An engine built for
+  // one of them serves every smaller batch size, so a miss in the engine cache
+  // builds an engine for the smallest of them that fits the input. If empty,
+  // engines are built for the batch size of the input.
+  std::vector<int> profile_batch_sizes;
 };
 
 // Method to call from optimization pass
@@ -117,6 +117,7 @@ struct EngineInfo {
   int maximum_cached_engines;
   TrtPrecisionMode precision_mode;
   bool use_calibration;
+  std::vector<int> profile_batch_sizes;
 };
 
 // Constructs a graphdef from the segment in the given graph. Adds _Arg
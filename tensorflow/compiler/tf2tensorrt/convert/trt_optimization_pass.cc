@@ -14,6 +14,8 @@ limitations under the License.
 
 #include "tensorflow/compiler/tf2tensorrt/convert/trt_optimization_pass.h"
 
+#include <algorithm>
+
 #include "absl/strings/ascii.h"
 #include "absl/strings/escaping.h"
 #include "absl/strings/str_cat.h"
@@ -67,6 +69,20 @@ Status TRTOptimizationPass::Init(
   if (params.count("use_calibration")) {
     use_calibration_ = params.at("use_calibration").b();
   }
+  if (params.count("profile_batch_sizes")) {
+    profile_batch_sizes_.clear();
+    for (int64 batch_size : params.at("profile_batch_sizes").list().i()) {
+      if (batch_size <= 0) {
+        return errors::InvalidArgument(
+            "profile_batch_sizes must be positive, got ", batch_size);
+      }
+      profile_batch_sizes_.push_back(batch_size);
+    }
+    std::sort(profile_batch_sizes_.begin(), profile_batch_sizes_.end());
+    profile_batch_sizes_.erase(
+        std::unique(profile_batch_sizes_.begin(), profile_batch_sizes_.end()),
+        profile_batch_sizes_.end());
+  }
   if (params.count("trt_logger")) {
     trt_logger_name_ = params.at("trt_logger").s();
   }
@@ -259,6 +275,7 @@ Status TRTOptimizationPass::Optimize(grappler::Cluster* cluster,
   cp.is_dyn_op = is_dynamic_op_;
   cp.max_cached_engines = max_cached_batches_;
   cp.use_calibration = use_calibration_;
+  cp.profile_batch_sizes = profile_batch_sizes_;
   auto status = ConvertAfterShapes(cp);
   VLOG(1) << "Returning from " << name_;
   return status;
@@ -73,6 +73,7 @@ class TRTOptimizationPass : public grappler::CustomGraphOptimizer {
   int max_cached_batches_;
   int64_t max_workspace_size_bytes_;
   bool use_calibration_;
+  std::vector<int> profile_batch_sizes_;
 };
 
 }  // namespace convert
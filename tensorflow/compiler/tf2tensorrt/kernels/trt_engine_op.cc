@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_allocator.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_logger.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_lru_cache.h"
+#include "tensorflow/compiler/tf2tensorrt/utils/trt_persistent_engine_cache.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/graph_optimizer.h"
 #include "tensorflow/core/framework/function.h"
@@ -35,8 +36,10 @@ limitations under the License.
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
@@ -122,6 +125,23 @@ class TRTEngineOp : public AsyncOpKernel {
       const std::vector<TensorShape>& input_shapes, OpKernelContext* ctx,
       TRTEngineCacheResource* cache_res);
 
+  // Returns the key of the engine for 'engine_input_shapes' in
+  // persistent_cache_.
+  TRTPersistentEngineKey GetPersistentEngineKey(
+      OpKernelContext* ctx,
+      const std::vector<TensorShape>& engine_input_shapes);
+
+  // Loads the engine for 'engine_input_shapes' from persistent_cache_, if it
+  // has one.
+  TrtUniquePtrType<nvinfer1::ICudaEngine> LoadPersistentEngine(
+      OpKernelContext* ctx, const std::vector<TensorShape>& engine_input_shapes,
+      TRTBaseAllocator* allocator);
+
+  // Stores 'engine', built for 'engine_input_shapes', in persistent_cache_.
+  void StorePersistentEngine(
+      OpKernelContext* ctx, const std::vector<TensorShape>& engine_input_shapes,
+      nvinfer1::ICudaEngine* engine);
+
   // Verify that the input shapes are consistent and can be handled by this op.
   Status VerifyInputShapes(const std::vector<TensorShape>& shapes);
 
@@ -132,6 +152,10 @@ class TRTEngineOp : public AsyncOpKernel {
       const std::vector<TensorShape>& actual_input_shapes,
       std::vector<TensorShape>* engine_input_shapes);
 
+  // Raises the batch size of 'engine_input_shapes' to the smallest of
+  // profile_batch_sizes_ that is at least as large, if there is one.
+  void ApplyBatchSizeProfile(std::vector<TensorShape>* engine_input_shapes);
+
   std::vector<string> input_nodes_;
   std::vector<string> output_nodes_;
 
@@ -146,6 +170,7 @@ class TRTEngineOp : public AsyncOpKernel {
 
   // Engine Precision mode.
   TrtPrecisionMode precision_mode_;
+  string precision_mode_string_;
 
   // Whether engine is constructed during the conversion or needs to be
   // constructed from protobuf segment.
@@ -157,6 +182,10 @@ class TRTEngineOp : public AsyncOpKernel {
   // Maximum number of cached engines
   int max_cached_engines_;
 
+  // Sorted batch sizes to build engines for, so that one engine serves a range
+  // of batch sizes instead of only the batch size that triggered its build.
+  std::vector<int> profile_batch_sizes_;
+
   int64 workspace_size_;
   mutex engine_mutex_;
   FunctionLibraryRuntime::Handle func_handle_;
@@ -167,6 +196,14 @@ class TRTEngineOp : public AsyncOpKernel {
   // If true, create calibration graph for INT8 mode. Otherwise, we are using
   // user-provided quantization ranges.
   bool use_calibration_;
+
+  // Stores the engines this op builds across process restarts, or null if
+  // TF_TRT_ENGINE_CACHE_DIR is not set.
+  std::unique_ptr<TRTPersistentEngineCache> persistent_cache_;
+
+  // Fingerprint of everything the engines of this op are built from besides
+  // their input shapes, used to key persistent_cache_.
+  uint64 segment_fingerprint_ = 0;
 };
 
 #define TYPECASE(dt, X, Y)                                    \
@@ -255,9 +292,8 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
   OP_REQUIRES_OK(context, context->GetAttr("static_engine", &static_engine_));
 
   VLOG(1) << "Constructing " << name();
-  string precision_string;
   OP_REQUIRES_OK(context,
-                 context->GetAttr("precision_mode", &precision_string));
+                 context->GetAttr("precision_mode", &precision_mode_string_));
   string calibration_data;
   OP_REQUIRES_OK(context,
                  context->GetAttr("calibration_data", &calibration_data));
@@ -265,8 +301,8 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
   OP_REQUIRES(context, !func_.name().empty(),
               errors::InvalidArgument(
                   "The TF function for the TRT segment could not be empty"));
-  OP_REQUIRES_OK(context,
-                 TrtPrecisionModeFromName(precision_string, &precision_mode_));
+  OP_REQUIRES_OK(context, TrtPrecisionModeFromName(precision_mode_string_,
+                                                   &precision_mode_));
   OP_REQUIRES_OK(context,
                  context->GetAttr("use_calibration", &use_calibration_));
   func_handle_ = kInvalidHandle;
@@ -283,12 +319,30 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
   calibration_mode_ =
       (use_calibration_ && precision_mode_ == TrtPrecisionMode::INT8 &&
        calibration_data.empty());
+  if (!static_engine_) {
+    persistent_cache_ = TRTPersistentEngineCache::FromEnv(context->env());
+  }
+  if (persistent_cache_) {
+    string serialized_graph;
+    OP_REQUIRES(context,
+                SerializeToStringDeterministic(segment_graph_,
+                                               &serialized_graph),
+                errors::Internal("Could not serialize the segment of ",
+                                 name()));
+    segment_fingerprint_ =
+        FingerprintCat64(Fingerprint64(serialized_graph),
+                         FingerprintCat64(Fingerprint64(calibration_data),
+                                          workspace_size_));
+  }
   if (!calibration_data.empty()) {
     calibrator_.reset(new TRTInt8Calibrator(calibration_data));
     calibration_data.resize(0);
   }
   OP_REQUIRES_OK(context, context->GetAttr("max_cached_engines_count",
                                            &max_cached_engines_));
+  OP_REQUIRES_OK(context, context->GetAttr("profile_batch_sizes",
+                                           &profile_batch_sizes_));
+  std::sort(profile_batch_sizes_.begin(), profile_batch_sizes_.end());
 }
 
 void TRTEngineOp::ExecuteNativeSegment(OpKernelContext* ctx,
@@ -441,6 +495,17 @@ Status TRTEngineOp::GetEngineInputShapes(
   return Status::OK();
 }
 
+void TRTEngineOp::ApplyBatchSizeProfile(
+    std::vector<TensorShape>* engine_input_shapes) {
+  const int batch_size = (*engine_input_shapes)[0].dim_size(0);
+  auto it = std::lower_bound(profile_batch_sizes_.begin(),
+                             profile_batch_sizes_.end(), batch_size);
+  if (it == profile_batch_sizes_.end()) return;
+  for (TensorShape& shape : *engine_input_shapes) {
+    shape.set_dim(0, *it);
+  }
+}
+
 void TRTEngineOp::ComputeAsync(OpKernelContext* ctx,
                                AsyncOpKernel::DoneCallback done) {
   auto helper = new AsyncHelper(done);
@@ -639,19 +704,23 @@ bool TRTEngineOp::ExecuteTrtEngine(OpKernelContext* ctx,
   return !kRetry;
 }
 
-Status TRTEngineOp::GetEngineCacheResource(OpKernelContext* ctx,
-                                           TRTEngineCacheResource** cache_res) {
-  // Canonicalize the op name by removing the scopes if any. This is mainly
-  // because in TFv2, the function graph can be instantiated in various ways and
-  // it'll insert scope names to the name of the TRTEngineOps, which will result
-  // in many different engine caches if we use the instantiated op name
-  // directly, but we still want all of them share the same cache (if they were
-  // representing the same subgraph).
-  absl::string_view resource_name = name();
-  size_t last_slash = resource_name.find_last_of('/');
+// Canonicalize the op name by removing the scopes if any. This is mainly
+// because in TFv2, the function graph can be instantiated in various ways and
+// it'll insert scope names to the name of the TRTEngineOps, which will result
+// in many different engine caches if we use the instantiated op name
+// directly, but we still want all of them share the same cache (if they were
+// representing the same subgraph).
+static absl::string_view CanonicalOpName(absl::string_view op_name) {
+  size_t last_slash = op_name.find_last_of('/');
   if (last_slash != absl::string_view::npos) {
-    resource_name.remove_prefix(last_slash + 1);
+    op_name.remove_prefix(last_slash + 1);
   }
+  return op_name;
+}
+
+Status TRTEngineOp::GetEngineCacheResource(OpKernelContext* ctx,
+                                           TRTEngineCacheResource** cache_res) {
+  absl::string_view resource_name = CanonicalOpName(name());
 
   // Get engine cache.
   return ctx->resource_manager()->LookupOrCreate(
@@ -662,6 +731,65 @@ Status TRTEngineOp::GetEngineCacheResource(OpKernelContext* ctx,
       }});
 }
 
+TRTPersistentEngineKey TRTEngineOp::GetPersistentEngineKey(
+    OpKernelContext* ctx, const std::vector<TensorShape>& engine_input_shapes) {
+  TRTPersistentEngineKey key;
+  key.op_name = string(CanonicalOpName(name()));
+  key.segment_fingerprint = segment_fingerprint_;
+  key.precision_mode = precision_mode_string_;
+  key.input_shapes = engine_input_shapes;
+  key.tensorrt_version = absl::StrCat(getInferLibVersion());
+  const auto& description =
+      ctx->op_device_context()->stream()->parent()->GetDeviceDescription();
+  int cc_major = 0, cc_minor = 0;
+  description.cuda_compute_capability(&cc_major, &cc_minor);
+  key.gpu_model = absl::StrCat(description.name(), " sm_", cc_major, cc_minor);
+  return key;
+}
+
+TrtUniquePtrType<nvinfer1::ICudaEngine> TRTEngineOp::LoadPersistentEngine(
+    OpKernelContext* ctx, const std::vector<TensorShape>& engine_input_shapes,
+    TRTBaseAllocator* allocator) {
+  const TRTPersistentEngineKey key =
+      GetPersistentEngineKey(ctx, engine_input_shapes);
+  string serialized_engine;
+  Status status = persistent_cache_->Lookup(key, &serialized_engine);
+  if (!status.ok()) {
+    if (!errors::IsNotFound(status)) {
+      LOG(WARNING) << "Could not load the persistent TensorRT engine for "
+                   << name() << ": " << status;
+    }
+    return nullptr;
+  }
+  TrtUniquePtrType<IRuntime> infer(nvinfer1::createInferRuntime(logger));
+  infer->setGpuAllocator(allocator);
+  TrtUniquePtrType<nvinfer1::ICudaEngine> engine(infer->deserializeCudaEngine(
+      serialized_engine.data(), serialized_engine.size(), nullptr));
+  if (!engine) {
+    LOG(WARNING) << "Could not deserialize the persistent TensorRT engine in "
+                 << persistent_cache_->EngineFilename(key);
+    return nullptr;
+  }
+  LOG(INFO) << "Loaded TensorRT engine for " << name() << " from "
+            << persistent_cache_->EngineFilename(key);
+  return engine;
+}
+
+void TRTEngineOp::StorePersistentEngine(
+    OpKernelContext* ctx, const std::vector<TensorShape>& engine_input_shapes,
+    nvinfer1::ICudaEngine* engine) {
+  const TRTPersistentEngineKey key =
+      GetPersistentEngineKey(ctx, engine_input_shapes);
+  TrtUniquePtrType<nvinfer1::IHostMemory> engine_data(engine->serialize());
+  Status status = persistent_cache_->Insert(
+      key, StringPiece(static_cast<const char*>(engine_data->data()),
+                       engine_data->size()));
+  if (!status.ok()) {
+    LOG(WARNING) << "Could not store the TensorRT engine for " << name()
+                 << " in " << persistent_cache_->directory() << ": " << status;
+  }
+}
+
 StatusOr<EngineContext*> TRTEngineOp::GetEngine(
     const std::vector<TensorShape>& input_shapes, OpKernelContext* ctx,
     TRTEngineCacheResource* cache_res) {
@@ -729,7 +857,23 @@ StatusOr<EngineContext*> TRTEngineOp::GetEngine(
       GetEngineInputShapes(cache, input_shapes, &engine_input_shapes));
 
   // If matched, use that engine. Otherwise, we will look in cache for that
-  // exact shape and possibly create a new engine if it is not in cache.
+  // exact shape and possibly create a new engine if it is not in cache. The
+  // new engine is built for the batch size profile that covers the input, so
+  // that it also serves the other batch sizes in that profile.
+  if (!cache.count(engine_input_shapes)) {
+    ApplyBatchSizeProfile(&engine_input_shapes);
+  }
+  if (!cache.count(engine_input_shapes) && persistent_cache_) {
+    TrtUniquePtrType<nvinfer1::ICudaEngine> engine =
+        LoadPersistentEngine(ctx, engine_input_shapes, allocator);
+    if (engine) {
+      TrtUniquePtrType<nvinfer1::IExecutionContext> exec_context(
+          engine->createExecutionContext());
+      cache.emplace(engine_input_shapes,
+                    absl::make_unique<EngineContext>(std::move(engine),
+                                                     std::move(exec_context)));
+    }
+  }
   if (!cache.count(engine_input_shapes)) {
     TrtUniquePtrType<nvinfer1::ICudaEngine> engine;
     bool convert_successfully = false;
@@ -744,9 +888,9 @@ StatusOr<EngineContext*> TRTEngineOp::GetEngine(
     // Up to this point, calibrator_ can never be empty, since otherwise it
     // means calibration_mode_ is true and this path won't get executed.
     auto status = convert::ConvertGraphDefToEngine(
-        segment_graph_, precision_mode_, batch_size, workspace_size_,
-        partial_shapes, &logger, allocator, calibrator_.get(), &engine,
-        use_calibration_, &convert_successfully);
+        segment_graph_, precision_mode_, engine_input_shapes[0].dim_size(0),
+        workspace_size_, partial_shapes, &logger, allocator, calibrator_.get(),
+        &engine, use_calibration_, &convert_successfully);
     if (!status.ok()) {
       LOG(WARNING) << "Engine creation for " << name() << " failed. "
                    << "The native segment will be used instead. "
@@ -756,6 +900,9 @@ StatusOr<EngineContext*> TRTEngineOp::GetEngine(
       cache.emplace(engine_input_shapes, absl::make_unique<EngineContext>());
       return &empty_context;
     }
+    if (persistent_cache_) {
+      StorePersistentEngine(ctx, engine_input_shapes, engine.get());
+    }
     TrtUniquePtrType<nvinfer1::IExecutionContext> exec_context(
         engine->createExecutionContext());
     cache.emplace(engine_input_shapes,
@@ -49,7 +49,8 @@ using ::testing::ElementsAre;
 
 class TRTEngineOpTestBase : public OpsTestBase {
  public:
-  void AddSimpleTrtOp(DataType dtype, int max_cached_engines_count = 1) {
+  void AddSimpleTrtOp(DataType dtype, int max_cached_engines_count = 1,
+                      const std::vector<int>& profile_batch_sizes = {}) {
     // Create the GPU device.
     std::unique_ptr<Device> device(
         DeviceFactory::NewDevice("GPU", {}, "/job:worker/replica:0/task:0"));
@@ -87,6 +88,7 @@ class TRTEngineOpTestBase : public OpsTestBase {
                      .Attr("workspace_size_bytes", 1 << 20)
                      .Attr("precision_mode", "FP32")
                      .Attr("use_calibration", false)
+                     .Attr("profile_batch_sizes", profile_batch_sizes)
                      .Attr("OutT", {dtype})
                      .Finalize(OpsTestBase::node_def()));
     TF_ASSERT_OK(InitOpWithFunctionLibrary());
@@ -169,6 +171,45 @@ TEST_F(TRTEngineOpTestBase, DynamicShapes) {
   EXPECT_THAT((++iter)->first, ElementsAre(TensorShape({2, 2})));
 }
 
+TEST_F(TRTEngineOpTestBase, BatchSizeProfiles) {
+  TRTEngineOpTestBase::AddSimpleTrtOp(DT_FLOAT, /*max_cached_engines_count=*/4,
+                                      /*profile_batch_sizes=*/{8, 4});
+
+  // The engine is built for the smallest profile that covers the input.
+  TRTEngineOpTestBase::AddSimpleInput<float>(TensorShape({3, 2}));
+  TF_ASSERT_OK(OpsTestBase::RunOpKernel());
+  TRTEngineCacheResource* cache_resource = nullptr;
+  TF_ASSERT_OK(
+      device_->resource_manager()->Lookup("TF-TRT", "myop", &cache_resource));
+  core::ScopedUnref sc(cache_resource);
+  auto cache = &cache_resource->cache_;
+  EXPECT_EQ(1, cache->size());
+  EXPECT_THAT(cache->begin()->first, ElementsAre(TensorShape({4, 2})));
+
+  // Other batch sizes in the profile reuse that engine.
+  ResetInputs();
+  TRTEngineOpTestBase::AddSimpleInput<float>(TensorShape({4, 2}));
+  TF_ASSERT_OK(OpsTestBase::RunOpKernel());
+  EXPECT_EQ(1, cache->size());
+
+  // A larger batch size builds an engine for the next profile.
+  ResetInputs();
+  TRTEngineOpTestBase::AddSimpleInput<float>(TensorShape({5, 2}));
+  TF_ASSERT_OK(OpsTestBase::RunOpKernel());
+  EXPECT_EQ(2, cache->size());
+  EXPECT_THAT(cache->begin()->first, ElementsAre(TensorShape({8, 2})));
+  Tensor* output = OpsTestBase::GetOutput(0);
+  EXPECT_EQ(TensorShape({5, 2}), output->shape());
+  EXPECT_EQ(18.0f, output->flat<float>()(9));
+
+  // Batch sizes beyond every profile get an engine for their own batch size.
+  ResetInputs();
+  TRTEngineOpTestBase::AddSimpleInput<float>(TensorShape({9, 2}));
+  TF_ASSERT_OK(OpsTestBase::RunOpKernel());
+  EXPECT_EQ(3, cache->size());
+  EXPECT_THAT(cache->begin()->first, ElementsAre(TensorShape({9, 2})));
+}
+
 template <typename T>
 class TRTEngineOpTest : public TRTEngineOpTestBase {};
 
@@ -0,0 +1,133 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/tf2tensorrt/utils/trt_persistent_engine_cache.h"
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/tf2tensorrt/utils/trt_engine_instance.pb.h"  // NOLINT
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace tensorrt {
+namespace {
+
+// Returns the fingerprint of every field of 'key'.
+uint64 KeyFingerprint(const TRTPersistentEngineKey& key) {
+  return Fingerprint64(absl::StrCat(
+      key.op_name, "|", key.segment_fingerprint, "|", key.precision_mode, "|",
+      TensorShapeUtils::ShapeListString(key.input_shapes), "|",
+      key.tensorrt_version, "|", key.gpu_model));
+}
+
+// Returns true if 'instance' was stored for 'key'. Files are named by a
+// fingerprint of the key, which this guards against collisions of.
+bool InstanceMatchesKey(const TRTEngineInstance& instance,
+                        const TRTPersistentEngineKey& key) {
+  if (instance.tensorrt_version() != key.tensorrt_version ||
+      instance.gpu_model() != key.gpu_model ||
+      instance.input_shapes_size() !=
+          static_cast<int>(key.input_shapes.size())) {
+    return false;
+  }
+  for (int i = 0; i < instance.input_shapes_size(); ++i) {
+    if (TensorShape(instance.input_shapes(i)) != key.input_shapes[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+std::unique_ptr<TRTPersistentEngineCache> TRTPersistentEngineCache::FromEnv(
+    Env* env) {
+  const char* directory = getenv("TF_TRT_ENGINE_CACHE_DIR");
+  if (directory == nullptr || directory[0] == '\0') return nullptr;
+  return std::unique_ptr<TRTPersistentEngineCache>(
+      new TRTPersistentEngineCache(env, directory));
+}
+
+TRTPersistentEngineCache::TRTPersistentEngineCache(Env* env,
+                                                   const string& directory)
+    : env_(env), directory_(directory) {}
+
+string TRTPersistentEngineCache::EngineFilename(
+    const TRTPersistentEngineKey& key) const {
+  // Keep the op name readable, but only with characters that are safe in any
+  // file system.
+  string op_name = key.op_name;
+  for (char& c : op_name) {
+    if (!absl::ascii_isalnum(c) && c != '-') c = '_';
+  }
+  return io::JoinPath(
+      directory_, absl::StrCat(op_name, "_",
+                               strings::FpToString(KeyFingerprint(key)),
+                               ".trtengine"));
+}
+
+Status TRTPersistentEngineCache::Lookup(const TRTPersistentEngineKey& key,
+                                        string* serialized_engine) const {
+  const string filename = EngineFilename(key);
+  Status status = env_->FileExists(filename);
+  if (!status.ok()) {
+    return errors::NotFound("No persistent TensorRT engine in ", filename);
+  }
+  string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env_, filename, &contents));
+  TRTEngineInstance instance;
+  if (!instance.ParseFromString(contents)) {
+    return errors::DataLoss("Could not parse TensorRT engine in ", filename);
+  }
+  if (!InstanceMatchesKey(instance, key)) {
+    LOG(WARNING) << "Ignoring TensorRT engine in " << filename
+                 << ", which was stored for a different engine.";
+    return errors::NotFound("No persistent TensorRT engine in ", filename);
+  }
+  *serialized_engine = std::move(*instance.mutable_serialized_engine());
+  return Status::OK();
+}
+
+Status TRTPersistentEngineCache::Insert(const TRTPersistentEngineKey& key,
+                                        StringPiece serialized_engine) const {
+  TRTEngineInstance instance;
+  for (const TensorShape& shape : key.input_shapes) {
+    shape.AsProto(instance.add_input_shapes());
+  }
+  instance.set_serialized_engine(serialized_engine.data(),
+                                 serialized_engine.size());
+  instance.set_tensorrt_version(key.tensorrt_version);
+  instance.set_gpu_model(key.gpu_model);
+
+  TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(directory_));
+  const string filename = EngineFilename(key);
+  const string temp_filename =
+      absl::StrCat(filename, ".tmp-", strings::FpToString(random::New64()));
+  Status status =
+      WriteStringToFile(env_, temp_filename, instance.SerializeAsString());
+  if (status.ok()) status = env_->RenameFile(temp_filename, filename);
+  if (!status.ok()) {
+    env_->DeleteFile(temp_filename).IgnoreError();
+  }
+  return status;
+}
+
+}  // namespace tensorrt
+}  // namespace tensorflow
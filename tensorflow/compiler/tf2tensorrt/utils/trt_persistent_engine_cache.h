@@ -0,0 +1,81 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_PERSISTENT_ENGINE_CACHE_H_
+#define TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_PERSISTENT_ENGINE_CACHE_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace tensorrt {
+
+// Identifies an engine in a TRTPersistentEngineCache. A serialized engine can
+// only be deserialized by the TensorRT version that built it, and only runs on
+// the GPU model it was built for, so both are part of the key.
+struct TRTPersistentEngineKey {
+  // Canonical name of the TRTEngineOp that built the engine.
+  string op_name;
+  // Fingerprint of what the op builds engines from besides the input shapes,
+  // such as its segment graph and calibration data.
+  uint64 segment_fingerprint = 0;
+  string precision_mode;
+  std::vector<TensorShape> input_shapes;
+  string tensorrt_version;
+  string gpu_model;
+};
+
+// Stores serialized TensorRT engines in a directory, one file per engine, so
+// that a process can load the engines that an earlier process built instead
+// of building them again. Several processes may share the directory.
+class TRTPersistentEngineCache {
+ public:
+  // Returns a cache in the directory named by the TF_TRT_ENGINE_CACHE_DIR
+  // environment variable, or nullptr if it is not set.
+  static std::unique_ptr<TRTPersistentEngineCache> FromEnv(Env* env);
+
+  TRTPersistentEngineCache(Env* env, const string& directory);
+
+  const string& directory() const { return directory_; }
+
+  // Returns the path of the file that stores the engine for 'key'.
+  string EngineFilename(const TRTPersistentEngineKey& key) const;
+
+  // Reads the serialized engine stored for 'key' into 'serialized_engine'.
+  // Returns NotFound if there is none.
+  Status Lookup(const TRTPersistentEngineKey& key,
+                string* serialized_engine) const;
+
+  // Stores 'serialized_engine' for 'key', replacing any stored engine. The
+  // file is written under a temporary name and renamed into place, so readers
+  // never see a partial engine.
+  Status Insert(const TRTPersistentEngineKey& key,
+                StringPiece serialized_engine) const;
+
+ private:
+  Env* env_;
+  const string directory_;
+};
+
+}  // namespace tensorrt
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_PERSISTENT_ENGINE_CACHE_H_
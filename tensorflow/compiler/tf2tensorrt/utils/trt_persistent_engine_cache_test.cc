@@ -0,0 +1,103 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/tf2tensorrt/utils/trt_persistent_engine_cache.h"
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace tensorrt {
+namespace {
+
+TRTPersistentEngineKey MakeKey() {
+  TRTPersistentEngineKey key;
+  key.op_name = "scope/TRTEngineOp_0";
+  key.segment_fingerprint = 1234;
+  key.precision_mode = "FP16";
+  key.input_shapes = {TensorShape({1, 28, 28, 3}), TensorShape({1})};
+  key.tensorrt_version = "6.0.1";
+  key.gpu_model = "Tesla V100 sm_70";
+  return key;
+}
+
+TRTPersistentEngineCache MakeCache(const string& name) {
+  return TRTPersistentEngineCache(
+      Env::Default(), io::JoinPath(testing::TmpDir(), "trt_engines", name));
+}
+
+TEST(TRTPersistentEngineCacheTest, InsertThenLookup) {
+  TRTPersistentEngineCache cache = MakeCache("insert_then_lookup");
+  const TRTPersistentEngineKey key = MakeKey();
+  string engine;
+  EXPECT_TRUE(errors::IsNotFound(cache.Lookup(key, &engine)));
+
+  TF_ASSERT_OK(cache.Insert(key, "engine"));
+  TF_ASSERT_OK(cache.Lookup(key, &engine));
+  EXPECT_EQ("engine", engine);
+
+  // A second insertion replaces the engine.
+  TF_ASSERT_OK(cache.Insert(key, "new engine"));
+  TF_ASSERT_OK(cache.Lookup(key, &engine));
+  EXPECT_EQ("new engine", engine);
+}
+
+TEST(TRTPersistentEngineCacheTest, KeysDoNotShareEngines) {
+  TRTPersistentEngineCache cache = MakeCache("keys_do_not_share_engines");
+  TF_ASSERT_OK(cache.Insert(MakeKey(), "engine"));
+
+  string engine;
+  TRTPersistentEngineKey key = MakeKey();
+  key.input_shapes[0] = TensorShape({2, 28, 28, 3});
+  EXPECT_TRUE(errors::IsNotFound(cache.Lookup(key, &engine)));
+
+  key = MakeKey();
+  key.tensorrt_version = "7.0.0";
+  EXPECT_TRUE(errors::IsNotFound(cache.Lookup(key, &engine)));
+
+  key = MakeKey();
+  key.gpu_model = "Tesla T4 sm_75";
+  EXPECT_TRUE(errors::IsNotFound(cache.Lookup(key, &engine)));
+
+  key = MakeKey();
+  key.segment_fingerprint = 5678;
+  EXPECT_TRUE(errors::IsNotFound(cache.Lookup(key, &engine)));
+}
+
+TEST(TRTPersistentEngineCacheTest, EngineFilenameIsInDirectory) {
+  TRTPersistentEngineCache cache = MakeCache("filename");
+  const string filename = cache.EngineFilename(MakeKey());
+  EXPECT_EQ(cache.directory(), io::Dirname(filename));
+  EXPECT_TRUE(absl::StartsWith(io::Basename(filename), "scope_TRTEngineOp_0_"));
+  EXPECT_TRUE(absl::EndsWith(filename, ".trtengine"));
+}
+
+TEST(TRTPersistentEngineCacheTest, FromEnv) {
+  unsetenv("TF_TRT_ENGINE_CACHE_DIR");
+  EXPECT_EQ(nullptr, TRTPersistentEngineCache::FromEnv(Env::Default()));
+
+  setenv("TF_TRT_ENGINE_CACHE_DIR", "/tmp/trt_engines", /*overwrite=*/1);
+  auto cache = TRTPersistentEngineCache::FromEnv(Env::Default());
+  ASSERT_NE(nullptr, cache);
+  EXPECT_EQ("/tmp/trt_engines", cache->directory());
+  unsetenv("TF_TRT_ENGINE_CACHE_DIR");
+}
+
+}  // namespace
+}  // namespace tensorrt
+}  // namespace tensorflow
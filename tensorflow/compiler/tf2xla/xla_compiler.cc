@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 
+#include <algorithm>
 #include <numeric>
 #include <vector>
 
@@ -153,6 +154,9 @@ Status ExecuteGraph(XlaContext* xla_context, std::unique_ptr<Graph> graph,
 //   `resource_updates` is a ResourceUpdate, whose `index` is the index of a
 //   resource variable argument to the computation to be updated, and `type` is
 //   the type of the final output.
+// - If `alias_resource_update` is true, the outputs holding updated variable
+//   values are aliased with the parameters, located through `input_mapping`,
+//   that hold the variables' initial values.
 Status BuildComputation(
     const std::vector<XlaCompiler::Argument>& args,
     const std::vector<XlaExpression>& retvals,
@@ -162,7 +166,8 @@ Status BuildComputation(
     std::unique_ptr<xla::XlaOp> token_output,
     const XlaCompiler::ShapeRepresentationFn& shape_representation_fn,
     bool is_entry_computation, bool return_updated_values_for_all_resources,
-    bool always_return_tuple, xla::XlaBuilder* builder,
+    bool always_return_tuple, bool use_tuple_arg, bool alias_resource_update,
+    const std::vector<int>& input_mapping, xla::XlaBuilder* builder,
     xla::XlaComputation* computation, int* num_computation_outputs,
     int* num_nonconst_outputs,
     std::vector<XlaCompiler::OutputDescription>* outputs,
@@ -271,6 +276,10 @@ Status BuildComputation(
               return a->arg_num() < b->arg_num();
             });
 
+  // Pairs of (output tuple index, argument number) of the variable updates that
+  // are aliased with their input parameter.
+  std::vector<std::pair<int, int>> aliased_updates;
+
   for (const XlaResource* resource : arg_resources) {
     DCHECK_LT(resource->arg_num(), args.size());
     const XlaCompiler::Argument& arg = args[resource->arg_num()];
@@ -332,6 +341,17 @@ Status BuildComputation(
                                              representation_shape->layout());
       }
 
+      // Only plain variables whose type and shape are unchanged can be updated
+      // in place; the parameter layout is not known to match the output layout
+      // when a representation shape applies.
+      if (alias_resource_update && is_entry_computation &&
+          resource->kind() == XlaResource::kVariable && arg.initialized &&
+          !representation_shape && arg.type == resource->type() &&
+          absl::holds_alternative<TensorShape>(arg.shape) &&
+          absl::get<TensorShape>(arg.shape).IsSameSize(resource->shape())) {
+        aliased_updates.emplace_back(elems.size(), resource->arg_num());
+      }
+
       elems.push_back(handle);
     }
   }
@@ -388,6 +408,22 @@ Status BuildComputation(
     xla::GetTupleElement(tuple, 0);
   }
 
+  for (const auto& update : aliased_updates) {
+    auto it =
+        std::find(input_mapping.begin(), input_mapping.end(), update.second);
+    TF_RET_CHECK(it != input_mapping.end());
+    const int param = it - input_mapping.begin();
+    xla::ShapeIndex output_index;
+    if (always_return_tuple || elems.size() != 1) {
+      output_index = {update.first};
+    }
+    if (use_tuple_arg) {
+      builder->SetUpAlias(output_index, /*param_number=*/0, {param});
+    } else {
+      builder->SetUpAlias(output_index, param, /*param_index=*/{});
+    }
+  }
+
   xla::StatusOr<xla::XlaComputation> computation_status = builder->Build();
   if (!computation_status.ok()) {
     return computation_status.status();
@@ -1382,7 +1418,9 @@ Status XlaCompiler::CompileGraph(
                                    : ShapeRepresentationFn{},
       options.is_entry_computation,
       options.return_updated_values_for_all_resources,
-      options.always_return_tuple, &builder, result->computation.get(),
+      options.always_return_tuple, options.use_tuple_arg,
+      options.alias_resource_update, result->input_mapping, &builder,
+      result->computation.get(),
       &num_computation_outputs, &num_nonconst_outputs, &result->outputs,
       &result->resource_updates, &result->xla_output_shape));
 
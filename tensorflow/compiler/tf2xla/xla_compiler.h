@@ -216,6 +216,13 @@ class XlaCompiler {
 
     // True when we should add XLA input & output to the graph/function.
     bool add_token_input_output = false;
+
+    // If 'alias_resource_update' is true, the output that holds the updated
+    // value of a resource variable is aliased with the parameter that holds
+    // the variable's initial value, so the update is written into the buffer
+    // the caller passed in. The caller must not pass in a buffer that anything
+    // else still reads. Only applies to the entry computation.
+    bool alias_resource_update = false;
   };
 
   struct OutputDescription {
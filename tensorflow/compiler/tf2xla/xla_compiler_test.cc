@@ -1109,6 +1109,48 @@ TEST_F(XlaCompilerTest, Variables) {
   RunAndCheckVariablesComputation(client_, result);
 }
 
+// Tests that variable updates are aliased with the variable's parameter when
+// requested.
+TEST_F(XlaCompilerTest, AliasResourceUpdate) {
+  Scope scope = Scope::NewRootScope().ExitOnError();
+  auto a = ops::_Arg(scope.WithOpName("A"), DT_INT32, 0);
+  auto var = ops::_Arg(scope.WithOpName("V"), DT_RESOURCE, 1);
+  auto write = ops::AssignAddVariableOp(scope, var, a);
+  auto read = ops::ReadVariableOp(
+      scope.WithControlDependencies(std::vector<Operation>{write}), var,
+      DT_INT32);
+  auto d = ops::_Retval(scope.WithOpName("D"), read, 0);
+  std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+  TF_ASSERT_OK(scope.ToGraph(graph.get()));
+
+  std::vector<XlaCompiler::Argument> args(2);
+  args[0].kind = XlaCompiler::Argument::kParameter;
+  args[0].type = DT_INT32;
+  args[0].shape = TensorShape({2});
+  args[1].kind = XlaCompiler::Argument::kResource;
+  args[1].resource_kind = XlaResource::kVariable;
+  args[1].initialized = true;
+  args[1].type = DT_INT32;
+  args[1].shape = TensorShape({2});
+
+  XlaCompiler compiler(DefaultOptions());
+
+  XlaCompiler::CompileOptions compile_options;
+  compile_options.alias_resource_update = true;
+  XlaCompiler::CompilationResult result;
+  TF_ASSERT_OK(compiler.CompileGraph(compile_options, "add", std::move(graph),
+                                     args, /*user_aliases=*/{}, &result));
+  ASSERT_EQ(result.resource_updates.size(), 1);
+
+  // The update is the second output and aliases the variable's parameter.
+  const xla::HloInputOutputAliasProto& alias =
+      result.computation->proto().input_output_alias();
+  ASSERT_EQ(alias.entries_size(), 1);
+  EXPECT_THAT(alias.entries(0).output_shape_index(), ::testing::ElementsAre(1));
+  EXPECT_EQ(alias.entries(0).parameter_number(), 1);
+  EXPECT_THAT(alias.entries(0).parameter_shape_index(), ::testing::IsEmpty());
+}
+
 TEST_F(XlaCompilerTest, ResultLayoutSingle) {
   Scope scope = Scope::NewRootScope().ExitOnError();
   auto a = ops::_Arg(scope.WithOpName("A"), DT_INT32, 0);
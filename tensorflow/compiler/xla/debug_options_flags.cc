@@ -534,6 +534,37 @@ static void AllocateFlags() {
                        flag_values->xla_gpu_algorithm_blacklist_path(),
                        "An AlgorithmBlacklist text proto file as a blacklist "
                        "of convolutions to avoid to use."),
+      tensorflow::Flag(
+          "xla_gpu_enable_cuda_graphs",
+          bool_setter_for(&DebugOptions::set_xla_gpu_enable_cuda_graphs),
+          flag_values->xla_gpu_enable_cuda_graphs(),
+          "Capture the thunks of eligible XLA:GPU executables into CUDA "
+          "graphs and replay them on subsequent executions."),
+      tensorflow::Flag(
+          "xla_gpu_autotune_database_dir",
+          string_setter_for(&DebugOptions::set_xla_gpu_autotune_database_dir),
+          flag_values->xla_gpu_autotune_database_dir(),
+          "Directory in which convolution and GEMM autotuning results are "
+          "persisted and shared between processes."),
+      tensorflow::Flag(
+          "xla_gpu_max_streams",
+          int32_setter_for(&DebugOptions::set_xla_gpu_max_streams),
+          flag_values->xla_gpu_max_streams(),
+          "Maximum number of streams used by an XLA:GPU executable. 0 means "
+          "no limit."),
+      tensorflow::Flag(
+          "xla_cpu_object_cache_dir",
+          string_setter_for(&DebugOptions::set_xla_cpu_object_cache_dir),
+          flag_values->xla_cpu_object_cache_dir(),
+          "Directory in which XLA:CPU caches JIT-compiled object files."),
+      tensorflow::Flag(
+          "xla_cpu_parallel_codegen_split_count",
+          int32_setter_for(
+              &DebugOptions::set_xla_cpu_parallel_codegen_split_count),
+          flag_values->xla_cpu_parallel_codegen_split_count(),
+          "Number of parts XLA:CPU splits an LLVM module into to optimize and "
+          "compile them concurrently. 1 or less compiles the module as a "
+          "whole."),
   });
   ParseFlagsFromEnvAndDieIfUnknown("XLA_FLAGS", *flag_objects);
 }
@@ -18,7 +18,9 @@ limitations under the License.
 #include <iostream>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_format.h"
@@ -35,6 +37,11 @@ class NoopStats : public CompilationStats {
 
   void EndPass(absl::string_view pass_name) override {}
 
+  void RecordPassResult(absl::string_view pass_name, int64 instructions_before,
+                        int64 instructions_after, bool changed) override {}
+
+  std::vector<PassSummary> GetPassSummaries() const override { return {}; }
+
   void CompilationReport() override {}
 };
 
@@ -46,25 +53,38 @@ class Stats : public CompilationStats {
 
   void EndPass(absl::string_view pass_name) override;
 
+  void RecordPassResult(absl::string_view pass_name, int64 instructions_before,
+                        int64 instructions_after, bool changed) override;
+
+  std::vector<PassSummary> GetPassSummaries() const override;
+
   void CompilationReport() override;
 
  private:
   struct PassInfo {
-    PassInfo(absl::string_view name, double duration)
-        : name(name), duration_ms(duration) {}
-
-    absl::string_view name;
-    int num_runs = 1;
+    PassInfo(absl::string_view name, double duration, bool changed,
+             int64 instruction_delta)
+        : name(name),
+          duration_ms(duration),
+          changed(changed),
+          instruction_delta(instruction_delta) {}
+
+    string name;
     double duration_ms;
+    bool changed;
+    int64 instruction_delta;
   };
 
   // Info about the passes that have been run so far.
   std::vector<PassInfo> passes_;
   // Used to avoid nested calls to StartPass.
   bool pass_running_ = false;
-  absl::string_view current_pass_;
+  string current_pass_;
   // The start time of the currently running pass.
   uint64 start_micros_;
+  // What RecordPassResult reported for the currently running pass.
+  bool current_changed_ = false;
+  int64 current_instruction_delta_ = 0;
 };
 
 /* static */
@@ -81,7 +101,9 @@ void Stats::StartPass(absl::string_view pass_name) {
   CHECK(!pass_running_) << "Can't start " << pass_name << " while running "
                         << current_pass_;
   pass_running_ = true;
-  current_pass_ = pass_name;
+  current_pass_ = string(pass_name);
+  current_changed_ = false;
+  current_instruction_delta_ = 0;
   start_micros_ = tensorflow::Env::Default()->NowMicros();
 }
 
@@ -91,41 +113,56 @@ void Stats::EndPass(absl::string_view pass_name) {
   pass_running_ = false;
   uint64 end_micros = tensorflow::Env::Default()->NowMicros();
   double duration_ms = (end_micros - start_micros_) / 1000.0;
-  passes_.push_back(PassInfo(current_pass_, duration_ms));
+  passes_.push_back(PassInfo(current_pass_, duration_ms, current_changed_,
+                             current_instruction_delta_));
 }
 
-void Stats::CompilationReport() {
-  CHECK(!pass_running_) << "EndPass never called for " << current_pass_;
-  absl::flat_hash_map<absl::string_view, PassInfo> summary;
-  double total_duration = 0;
+void Stats::RecordPassResult(absl::string_view pass_name,
+                             int64 instructions_before,
+                             int64 instructions_after, bool changed) {
+  CHECK(pass_running_);
+  CHECK_EQ(current_pass_, pass_name);
+  current_changed_ = changed;
+  current_instruction_delta_ = instructions_after - instructions_before;
+}
 
-  for (auto& pass_run : passes_) {
-    auto pass_name = pass_run.name;
-    total_duration += pass_run.duration_ms;
-    auto it = summary.find(pass_name);
-    if (it == summary.end()) {
-      summary.insert(std::make_pair(pass_name, pass_run));
-    } else {
-      ++summary.at(pass_name).num_runs;
-      summary.at(pass_name).duration_ms += pass_run.duration_ms;
-    }
+std::vector<CompilationStats::PassSummary> Stats::GetPassSummaries() const {
+  absl::flat_hash_map<absl::string_view, PassSummary> summary;
+  for (const PassInfo& pass_run : passes_) {
+    PassSummary& pass_summary = summary[pass_run.name];
+    pass_summary.name = pass_run.name;
+    ++pass_summary.num_runs;
+    if (pass_run.changed) ++pass_summary.num_changed_runs;
+    pass_summary.duration_ms += pass_run.duration_ms;
+    pass_summary.instruction_delta += pass_run.instruction_delta;
   }
 
-  std::vector<PassInfo> sorted_summary;
+  std::vector<PassSummary> sorted_summary;
   sorted_summary.reserve(summary.size());
   for (auto& it : summary) {
     sorted_summary.push_back(it.second);
   }
-  absl::c_sort(sorted_summary, [](const PassInfo& a, const PassInfo& b) {
+  absl::c_sort(sorted_summary, [](const PassSummary& a, const PassSummary& b) {
     // Sort passes that take the longest first, break ties using pass names.
     return std::make_pair(b.duration_ms, a.name) <
            std::make_pair(a.duration_ms, b.name);
   });
+  return sorted_summary;
+}
+
+void Stats::CompilationReport() {
+  CHECK(!pass_running_) << "EndPass never called for " << current_pass_;
+  double total_duration = 0;
+  for (const PassInfo& pass_run : passes_) {
+    total_duration += pass_run.duration_ms;
+  }
   LOG(INFO) << "Total runtime (ms) of HLO passes: " << total_duration;
-  LOG(INFO) << "Pass name, num runs, time (ms)";
-  for (auto& pass_info : sorted_summary) {
+  LOG(INFO) << "Pass name, num runs, num changed runs, time (ms), "
+               "instruction delta";
+  for (const PassSummary& pass_info : GetPassSummaries()) {
     LOG(INFO) << pass_info.name << ", " << pass_info.num_runs << ", "
-              << pass_info.duration_ms;
+              << pass_info.num_changed_runs << ", " << pass_info.duration_ms
+              << ", " << pass_info.instruction_delta;
   }
 }
 
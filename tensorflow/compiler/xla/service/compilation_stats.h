@@ -18,18 +18,32 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/strings/str_format.h"
+#include "tensorflow/compiler/xla/types.h"
 
 namespace xla {
 
 // This class is used to collect information about HLO passes and print some
 // statistics at the end of compilation. From HloPassPipeline, we call StartPass
-// before the execution of a pass, and EndPass after. Currently, we only collect
-// timing information and how many times each pass was run. In the future, we
-// can add more things, such as the size of the HLO graph after each pass.
+// before the execution of a pass, RecordPassResult once it has run, and
+// EndPass after. We collect timing information, how many times each pass was
+// run (for passes inside an HloPassFix, this counts every fixed-point
+// iteration), how many of those runs changed the HLO, and how the number of
+// HLO instructions changed.
 class CompilationStats {
  public:
+  // Totals for one pass over all of its runs.
+  struct PassSummary {
+    string name;
+    int num_runs = 0;
+    int num_changed_runs = 0;
+    double duration_ms = 0;
+    // Instruction count after minus before, summed over all runs.
+    int64 instruction_delta = 0;
+  };
+
   virtual ~CompilationStats() = default;
 
   static std::unique_ptr<CompilationStats> MakeNoopStats();
@@ -40,6 +54,15 @@ class CompilationStats {
 
   virtual void EndPass(absl::string_view pass_name) = 0;
 
+  // Records the outcome of the running pass: the number of HLO instructions
+  // before and after it, and whether it reported a change.
+  virtual void RecordPassResult(absl::string_view pass_name,
+                                int64 instructions_before,
+                                int64 instructions_after, bool changed) = 0;
+
+  // Returns per-pass totals, sorted by decreasing total run time.
+  virtual std::vector<PassSummary> GetPassSummaries() const = 0;
+
   virtual void CompilationReport() = 0;
 };
 
@@ -279,6 +279,10 @@ Status IrEmitter::HandleCopy(HloInstruction* copy) {
     TF_RETURN_IF_ERROR(EmitTargetAddressForOp(copy));
     return EmitMemcpy(*(copy->operand(0)), *copy);
   } else if (copy->shape().IsArray()) {
+    int64 tile_size = GetTransposeTileSize(*copy);
+    if (tile_size > 0) {
+      return EmitTiledTransposeCopy(copy, tile_size);
+    }
     // Use the elemental emitter for array shapes.
     return DefaultAction(copy);
   }
@@ -286,6 +290,119 @@ Status IrEmitter::HandleCopy(HloInstruction* copy) {
                        PrimitiveType_Name(copy->shape().element_type()));
 }
 
+int64 IrEmitter::GetTransposeTileSize(const HloInstruction& copy) {
+  const Shape& target_shape = copy.shape();
+  const Shape& source_shape = copy.operand(0)->shape();
+  if (target_shape.rank() < 2) {
+    return 0;
+  }
+  const int64 target_minor_dim = LayoutUtil::Minor(target_shape.layout(), 0);
+  const int64 source_minor_dim = LayoutUtil::Minor(source_shape.layout(), 0);
+  if (target_minor_dim == source_minor_dim) {
+    return 0;
+  }
+
+  // A tile of the source and a tile of the target should fit into half of the
+  // L1 data cache, leaving the other half to everything else.
+  const int64 element_byte_size =
+      ShapeUtil::ByteSizeOfPrimitiveType(target_shape.element_type());
+  const int64 l1_byte_size = target_machine_features_.l1_data_cache_byte_size(
+      *compute_function_->function());
+  int64 tile_size = 1;
+  while (2 * (2 * tile_size) * (2 * tile_size) * element_byte_size <=
+         l1_byte_size / 2) {
+    tile_size *= 2;
+  }
+  // Tiling only pays off if both transposed dimensions span several tiles.
+  constexpr int64 kMinTileSize = 8;
+  if (tile_size < kMinTileSize ||
+      target_shape.dimensions(target_minor_dim) < 2 * tile_size ||
+      target_shape.dimensions(source_minor_dim) < 2 * tile_size) {
+    return 0;
+  }
+  return tile_size;
+}
+
+Status IrEmitter::EmitTiledTransposeCopy(HloInstruction* copy,
+                                         int64 tile_size) {
+  const HloInstruction* operand = copy->operand(0);
+  const Shape& shape = copy->shape();
+  const int64 target_minor_dim = LayoutUtil::Minor(shape.layout(), 0);
+  const int64 source_minor_dim =
+      LayoutUtil::Minor(operand->shape().layout(), 0);
+  VLOG(2) << "Emitting " << copy->name() << " in tiles of " << tile_size << "x"
+          << tile_size << " elements";
+
+  TF_RETURN_IF_ERROR(EmitTargetAddressForOp(copy));
+  llvm_ir::IrArray target_array = GetIrArrayFor(copy);
+  llvm_ir::IrArray source_array = GetIrArrayFor(operand);
+
+  // Each dimension is iterated in [start, end). If ParallelTaskAssignment
+  // partitioned the copy, the most-major dimensions of the target are limited
+  // to the partition this function is called for.
+  const int64 rank = shape.rank();
+  std::vector<llvm::Value*> starts(rank, b_.getInt64(0));
+  std::vector<llvm::Value*> ends(rank);
+  for (int64 dim = 0; dim < rank; ++dim) {
+    ends[dim] = b_.getInt64(shape.dimensions(dim));
+  }
+  if (ShouldEmitParallelLoopFor(*copy)) {
+    std::vector<std::pair<llvm::Value*, llvm::Value*>> dynamic_loop_bounds =
+        compute_function_->GetDynamicLoopBounds();
+    for (int64 i = 0; i < dynamic_loop_bounds.size(); ++i) {
+      const int64 dim = LayoutUtil::Major(shape.layout(), i);
+      starts[dim] = dynamic_loop_bounds[i].first;
+      ends[dim] = dynamic_loop_bounds[i].second;
+    }
+  }
+
+  // The dimensions other than the two transposed ones are iterated in the
+  // order of the target layout, outside the tiles.
+  llvm_ir::ForLoopNest loops(IrName(copy), &b_);
+  std::vector<llvm::Value*> multi_index(rank);
+  std::vector<std::unique_ptr<llvm_ir::ForLoop>> outer_loops;
+  for (int64 i = 0; i < rank; ++i) {
+    const int64 dim = LayoutUtil::Major(shape.layout(), i);
+    if (dim != target_minor_dim && dim != source_minor_dim) {
+      outer_loops.push_back(loops.AddLoop(absl::StrCat("dim.", dim),
+                                          starts[dim], ends[dim]));
+      multi_index[dim] = outer_loops.back()->GetIndVarValue();
+    }
+  }
+
+  // Adds a loop over the tiles of `dim` and returns the start and the end of
+  // the current tile.
+  std::vector<std::unique_ptr<llvm_ir::ForLoop>> tile_loops;
+  auto add_tile_loop = [&](int64 dim, absl::string_view suffix) {
+    tile_loops.push_back(loops.AddLoop(absl::StrCat(suffix, "_tile"),
+                                       starts[dim], ends[dim],
+                                       b_.getInt64(tile_size)));
+    llvm::Value* tile_start = tile_loops.back()->GetIndVarValue();
+    llvm::Value* tile_end = Add(tile_start, b_.getInt64(tile_size));
+    tile_end = Select(ICmpSLT(tile_end, ends[dim]), tile_end, ends[dim]);
+    return std::make_pair(tile_start, tile_end);
+  };
+  auto target_tile = add_tile_loop(target_minor_dim, "target");
+  auto source_tile = add_tile_loop(source_minor_dim, "source");
+
+  // Within a tile, the innermost loop reads the source contiguously.
+  std::unique_ptr<llvm_ir::ForLoop> target_loop =
+      loops.AddLoop("target", target_tile.first, target_tile.second);
+  std::unique_ptr<llvm_ir::ForLoop> source_loop =
+      loops.AddLoop("source", source_tile.first, source_tile.second);
+  multi_index[target_minor_dim] = target_loop->GetIndVarValue();
+  multi_index[source_minor_dim] = source_loop->GetIndVarValue();
+
+  SetToFirstInsertPoint(loops.GetInnerLoopBodyBasicBlock(), &b_);
+  llvm_ir::IrArray::Index source_index(multi_index, operand->shape(),
+                                       b_.getInt64Ty());
+  llvm_ir::IrArray::Index target_index(multi_index, shape, b_.getInt64Ty());
+  llvm::Value* element = source_array.EmitReadArrayElement(source_index, &b_);
+  target_array.EmitWriteArrayElement(target_index, element, &b_);
+  SetToFirstInsertPoint(loops.GetOuterLoopExitBasicBlock(), &b_);
+  return Status::OK();
+}
+
 // Calculate the alignment of a buffer allocated for a given primitive type.
 int IrEmitter::MinimumAlignmentForPrimitiveType(PrimitiveType primitive_type) {
   int64 byte_size = ShapeUtil::ByteSizeOfPrimitiveType(primitive_type);
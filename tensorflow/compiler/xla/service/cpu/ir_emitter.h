@@ -416,6 +416,15 @@ class IrEmitter : public DfsHloVisitorWithDefault,
                                      absl::Span<HloInstruction* const> operands,
                                      string* failure_reason);
 
+  // Returns the size of the square tiles in which a copy that transposes the
+  // minor-most dimension is emitted, or 0 if the copy should be emitted with
+  // the elemental IR emitter instead.
+  int64 GetTransposeTileSize(const HloInstruction& copy);
+
+  // Emits a copy that transposes the minor-most dimension tile by tile, so that
+  // the source and target cache lines of a tile stay in the L1 cache.
+  Status EmitTiledTransposeCopy(HloInstruction* copy, int64 tile_size);
+
   // Emits LLVM IR to transfer "element_count" elements of type "primitive_type"
   // from the address "source" to the address "target".
   void EmitTransferElements(llvm::Value* target, llvm::Value* source,
@@ -0,0 +1,164 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/module_partitioner.h"
+
+#include <algorithm>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
+#include "tensorflow/compiler/xla/types.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+using References =
+    absl::flat_hash_map<const llvm::GlobalObject*,
+                        std::vector<const llvm::GlobalObject*>>;
+
+// Adds the definitions that `value` refers to, looking through constant
+// expressions and aggregates, to `referenced`.
+void CollectReferences(const llvm::Value* value,
+                       absl::flat_hash_set<const llvm::Value*>* visited,
+                       std::vector<const llvm::GlobalObject*>* referenced) {
+  if (!visited->insert(value).second) return;
+  if (auto* global = llvm::dyn_cast<llvm::GlobalObject>(value)) {
+    if (!global->isDeclaration()) referenced->push_back(global);
+    return;
+  }
+  if (auto* constant = llvm::dyn_cast<llvm::Constant>(value)) {
+    for (const llvm::Use& operand : constant->operands()) {
+      CollectReferences(operand.get(), visited, referenced);
+    }
+  }
+}
+
+// Appends `global` to `order` after everything it refers to. Returns false if
+// it is part of a reference cycle.
+bool PostOrder(const llvm::GlobalObject* global, const References& references,
+               absl::flat_hash_map<const llvm::GlobalObject*, bool>* done,
+               std::vector<const llvm::GlobalObject*>* order) {
+  auto inserted = done->emplace(global, false);
+  if (!inserted.second) return inserted.first->second;
+  for (const llvm::GlobalObject* referenced : references.at(global)) {
+    if (referenced != global &&
+        !PostOrder(referenced, references, done, order)) {
+      return false;
+    }
+  }
+  (*done)[global] = true;
+  order->push_back(global);
+  return true;
+}
+
+int64 Weight(const llvm::GlobalObject* global) {
+  if (auto* function = llvm::dyn_cast<llvm::Function>(global)) {
+    return std::max<int64>(1, function->getInstructionCount());
+  }
+  return 1;
+}
+
+}  // namespace
+
+std::vector<std::string> PartitionModuleToBitcode(llvm::Module* module,
+                                                  int max_parts) {
+  if (max_parts < 2 || !module->getComdatSymbolTable().empty() ||
+      !module->alias_empty() || !module->ifunc_empty()) {
+    return {};
+  }
+  std::vector<const llvm::GlobalObject*> definitions;
+  for (const llvm::GlobalObject& global : module->global_objects()) {
+    if (global.isDeclaration()) continue;
+    if (global.hasAppendingLinkage()) return {};
+    definitions.push_back(&global);
+  }
+
+  References references;
+  for (const llvm::GlobalObject* global : definitions) {
+    absl::flat_hash_set<const llvm::Value*> visited;
+    std::vector<const llvm::GlobalObject*>& referenced = references[global];
+    if (auto* function = llvm::dyn_cast<llvm::Function>(global)) {
+      for (const llvm::Instruction& instruction :
+           llvm::instructions(function)) {
+        for (const llvm::Use& operand : instruction.operands()) {
+          CollectReferences(operand.get(), &visited, &referenced);
+        }
+      }
+    } else {
+      CollectReferences(
+          llvm::cast<llvm::GlobalVariable>(global)->getInitializer(), &visited,
+          &referenced);
+    }
+  }
+
+  // Self references (recursion) are fine; other cycles would make parts
+  // depend on each other.
+  absl::flat_hash_map<const llvm::GlobalObject*, bool> done;
+  std::vector<const llvm::GlobalObject*> order;
+  int64 total_weight = 0;
+  for (const llvm::GlobalObject* global : definitions) {
+    if (!PostOrder(global, references, &done, &order)) return {};
+    total_weight += Weight(global);
+  }
+
+  const int64 part_weight = (total_weight + max_parts - 1) / max_parts;
+  absl::flat_hash_map<const llvm::GlobalValue*, int> part_of;
+  int num_parts = 1;
+  int64 weight = 0;
+  for (const llvm::GlobalObject* global : order) {
+    if (weight >= part_weight && num_parts < max_parts) {
+      ++num_parts;
+      weight = 0;
+    }
+    part_of[global] = num_parts - 1;
+    weight += Weight(global);
+  }
+  if (num_parts < 2) return {};
+
+  for (llvm::GlobalObject& global : module->global_objects()) {
+    if (global.isDeclaration() || !global.hasLocalLinkage()) continue;
+    if (!global.hasName()) global.setName("__xla_cpu_part_local");
+    global.setLinkage(llvm::GlobalValue::ExternalLinkage);
+    global.setVisibility(llvm::GlobalValue::HiddenVisibility);
+  }
+
+  std::vector<std::string> parts(num_parts);
+  for (int i = 0; i < num_parts; ++i) {
+    llvm::ValueToValueMapTy value_map;
+    std::unique_ptr<llvm::Module> part =
+        llvm::CloneModule(*module, value_map,
+                          [&](const llvm::GlobalValue* global) {
+                            auto it = part_of.find(global);
+                            return it != part_of.end() && it->second == i;
+                          });
+    part->setModuleIdentifier(
+        absl::StrCat(module->getModuleIdentifier(), ".part", i));
+    llvm::raw_string_ostream stream(parts[i]);
+    llvm::WriteBitcodeToFile(*part, stream);
+    stream.flush();
+  }
+  return parts;
+}
+
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,48 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_MODULE_PARTITIONER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_MODULE_PARTITIONER_H_
+
+#include <string>
+#include <vector>
+
+#include "llvm/IR/Module.h"
+
+namespace xla {
+namespace cpu {
+
+// Splits `module` into at most `max_parts` modules that together define
+// everything `module` defines, so that they can be optimized and compiled
+// concurrently. The parts are returned as bitcode, so that each one can be
+// loaded into its own llvm::LLVMContext.
+//
+// Definitions are assigned to parts in post-order of the references between
+// them, balancing the number of instructions per part, so part i only refers
+// to definitions from parts 0 to i: a JIT can resolve and finalize the parts
+// in order. Local definitions are given external linkage and hidden
+// visibility so that other parts can refer to them, which modifies `module`.
+//
+// The split only depends on `module` and `max_parts`. Returns an empty vector,
+// leaving `module` unchanged, if the module can't be split into at least two
+// parts: e.g. when definitions refer to each other cyclically, or when the
+// module has comdats, aliases or appending globals.
+std::vector<std::string> PartitionModuleToBitcode(llvm::Module* module,
+                                                  int max_parts);
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_MODULE_PARTITIONER_H_
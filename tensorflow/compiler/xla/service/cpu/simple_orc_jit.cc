@@ -22,6 +22,9 @@ limitations under the License.
 #include <utility>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/JITSymbol.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
@@ -29,6 +32,7 @@ limitations under the License.
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/Host.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime.h"
+#include "tensorflow/compiler/xla/service/cpu/module_partitioner.h"
 #include "tensorflow/compiler/xla/service/cpu/orc_jit_memory_mapper.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_conv2d.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_conv2d_mkl.h"
@@ -43,7 +47,15 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/runtime_single_threaded_matmul.h"
 #include "tensorflow/compiler/xla/service/cpu/windows_compatibility.h"
 #include "tensorflow/compiler/xla/service/custom_call_target_registry.h"
+#include "tensorflow/compiler/xla/service/llvm_ir/llvm_util.h"
+#include "tensorflow/compiler/xla/status.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
@@ -63,6 +75,28 @@ llvm::SmallVector<std::string, 0> DetectMachineAttributes() {
   return result;
 }
 
+// The entry is first written to a temporary file and then renamed, so that
+// concurrent readers never see a partially written object file.
+Status WriteObjectCacheEntry(const std::string& dir,
+                             const std::string& filename,
+                             const llvm::MemoryBuffer& object_file) {
+  tensorflow::Env* env = tensorflow::Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(dir));
+  const std::string tmp_filename =
+      absl::StrCat(filename, ".tmp", tensorflow::random::New64());
+  Status status = tensorflow::WriteStringToFile(
+      env, tmp_filename,
+      tensorflow::StringPiece(object_file.getBufferStart(),
+                              object_file.getBufferSize()));
+  if (status.ok()) {
+    status = env->RenameFile(tmp_filename, filename);
+  }
+  if (!status.ok()) {
+    env->DeleteFile(tmp_filename).IgnoreError();
+  }
+  return status;
+}
+
 }  // namespace
 
 /*static*/ std::unique_ptr<llvm::TargetMachine>
@@ -87,12 +121,20 @@ SimpleOrcJIT::SimpleOrcJIT(
     bool disable_expensive_passes,
     LLVMCompiler::ModuleHook pre_optimization_hook,
     LLVMCompiler::ModuleHook post_optimization_hook,
-    std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook)
+    std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook,
+    std::string object_cache_dir, int codegen_split_count)
     : target_machine_(InferTargetMachineForJIT(target_options, opt_level)),
       data_layout_(target_machine_->createDataLayout()),
       symbol_resolver_(llvm::orc::createLegacyLookupResolver(
           execution_session_,
           [this](const std::string& name) -> llvm::JITSymbol {
+            // Parts of a split module refer to each other's hidden symbols.
+            if (!part_keys_.empty()) {
+              if (auto symbol =
+                      FindSymbol(name, /*exported_symbols_only=*/false)) {
+                return symbol;
+              }
+            }
             return this->ResolveRuntimeSymbol(name);
           },
           [](llvm::Error Err) {
@@ -118,12 +160,29 @@ SimpleOrcJIT::SimpleOrcJIT(
           [this](VModuleKeyT, const llvm::object::ObjectFile& object) {
             this->NotifyObjectFreed(object);
           }),
-      compile_layer_(
-          object_layer_,
-          CompilerFunctor(
-              target_machine_.get(), opt_level, optimize_for_size,
-              disable_expensive_passes, std::move(pre_optimization_hook),
-              std::move(post_optimization_hook), std::move(post_codegen_hook))),
+      compiler_functor_(target_machine_.get(), opt_level, optimize_for_size,
+                        disable_expensive_passes, pre_optimization_hook,
+                        post_optimization_hook, post_codegen_hook),
+      object_cache_dir_(std::move(object_cache_dir)),
+      target_options_(target_options),
+      opt_level_(opt_level),
+      optimize_for_size_(optimize_for_size),
+      disable_expensive_passes_(disable_expensive_passes),
+      pre_optimization_hook_(std::move(pre_optimization_hook)),
+      post_optimization_hook_(std::move(post_optimization_hook)),
+      post_codegen_hook_(std::move(post_codegen_hook)),
+      codegen_split_count_(codegen_split_count),
+      object_cache_key_suffix_(absl::StrCat(
+          LLVM_VERSION_STRING, ";", target_machine_->getTargetTriple().str(),
+          ";", target_machine_->getTargetCPU().str(), ";",
+          target_machine_->getTargetFeatureString().str(), ";", opt_level,
+          ";", optimize_for_size, ";", disable_expensive_passes, ";",
+          target_options.UnsafeFPMath, target_options.NoInfsFPMath,
+          target_options.NoNaNsFPMath, target_options.NoSignedZerosFPMath)),
+      compile_layer_(object_layer_,
+                     [this](llvm::Module& module) {
+                       return this->CompileModule(module, compiler_functor_);
+                     }),
       gdb_jit_event_listener_(
           llvm::JITEventListener::createGDBRegistrationListener()) {
   VLOG(1) << "CPU target: " << target_machine_->getTargetCPU().str()
@@ -169,28 +228,155 @@ void SimpleOrcJIT::NotifyObjectFreed(const llvm::object::ObjectFile& object) {
   gdb_jit_event_listener_->notifyFreeingObject(key);
 }
 
+std::string SimpleOrcJIT::ObjectCacheFilename(
+    const llvm::Module& module) const {
+  uint64 key = tensorflow::Fingerprint64(
+      absl::StrCat(llvm_ir::DumpModuleToString(module), ";",
+                   object_cache_key_suffix_));
+  return tensorflow::io::JoinPath(
+      object_cache_dir_,
+      absl::StrCat(
+          tensorflow::strings::Hex(key, tensorflow::strings::kZeroPad16),
+          ".o"));
+}
+
+SimpleOrcJIT::ObjLayerT::ObjectPtr SimpleOrcJIT::CompileModule(
+    llvm::Module& module, const CompilerFunctor& compiler_functor) {
+  if (object_cache_dir_.empty()) {
+    return compiler_functor(module);
+  }
+
+  // The filename has to be computed before compiling, which optimizes the
+  // module in place.
+  const std::string filename = ObjectCacheFilename(module);
+  tensorflow::Env* env = tensorflow::Env::Default();
+  if (env->FileExists(filename).ok()) {
+    std::string object_file;
+    Status status = tensorflow::ReadFileToString(env, filename, &object_file);
+    if (status.ok()) {
+      VLOG(1) << "Loaded the object file for " << module.getName().str()
+              << " from " << filename;
+      return llvm::MemoryBuffer::getMemBufferCopy(object_file,
+                                                  module.getName());
+    }
+    LOG(WARNING) << "Ignoring unreadable object cache entry " << filename
+                 << ": " << status;
+  }
+
+  ObjLayerT::ObjectPtr object_file = compiler_functor(module);
+  Status status = WriteObjectCacheEntry(object_cache_dir_, filename,
+                                        *object_file);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to write object cache entry " << filename << ": "
+                 << status;
+  }
+  return object_file;
+}
+
 SimpleOrcJIT::VModuleKeyT SimpleOrcJIT::AddModule(
     std::unique_ptr<llvm::Module> module) {
+  if (codegen_split_count_ > 1) {
+    std::vector<std::string> parts =
+        PartitionModuleToBitcode(module.get(), codegen_split_count_);
+    if (!parts.empty()) {
+      if (pre_optimization_hook_) {
+        pre_optimization_hook_(*module);
+      }
+      module.reset();
+      return AddModuleParts(parts);
+    }
+    VLOG(1) << "Compiling " << module->getName().str() << " without splitting";
+  }
   auto key = execution_session_.allocateVModule();
   cantFail(compile_layer_.addModule(key, std::move(module)));
   module_keys_.push_back(key);
   return key;
 }
 
+SimpleOrcJIT::VModuleKeyT SimpleOrcJIT::AddModuleParts(
+    const std::vector<std::string>& parts) {
+  const int num_parts = parts.size();
+  LLVMCompiler::ModuleHook post_optimization_hook;
+  if (post_optimization_hook_) {
+    post_optimization_hook = [this](const llvm::Module& module) {
+      tensorflow::mutex_lock lock(hook_mu_);
+      post_optimization_hook_(module);
+    };
+  }
+  std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook;
+  if (post_codegen_hook_) {
+    post_codegen_hook = [this](const llvm::object::ObjectFile& object) {
+      tensorflow::mutex_lock lock(hook_mu_);
+      post_codegen_hook_(object);
+    };
+  }
+  // Neither LLVMContext nor TargetMachine is thread-safe, so each part is
+  // loaded into its own context and compiled by its own target machine.
+  std::vector<std::unique_ptr<llvm::TargetMachine>> target_machines;
+  for (int i = 0; i < num_parts; ++i) {
+    target_machines.push_back(
+        InferTargetMachineForJIT(target_options_, opt_level_));
+  }
+  std::vector<ObjLayerT::ObjectPtr> objects(num_parts);
+  {
+    tensorflow::thread::ThreadPool pool(tensorflow::Env::Default(),
+                                        "xla_cpu_codegen", num_parts);
+    for (int i = 0; i < num_parts; ++i) {
+      pool.Schedule([&, i]() {
+        llvm::LLVMContext context;
+        std::unique_ptr<llvm::Module> part = llvm::cantFail(
+            llvm::parseBitcodeFile(llvm::MemoryBufferRef(parts[i], ""),
+                                   context));
+        CompilerFunctor compiler_functor(
+            target_machines[i].get(), opt_level_, optimize_for_size_,
+            disable_expensive_passes_, /*pre_optimization_hook=*/nullptr,
+            post_optimization_hook, post_codegen_hook);
+        objects[i] = CompileModule(*part, compiler_functor);
+      });
+    }
+  }  // Waits for all parts to be compiled.
+
+  // Parts only refer to earlier parts, so finalizing a part (which happens
+  // on the first symbol lookup) never needs a part that is being finalized.
+  std::vector<VModuleKeyT> keys;
+  for (ObjLayerT::ObjectPtr& object : objects) {
+    auto key = execution_session_.allocateVModule();
+    cantFail(object_layer_.addObject(key, std::move(object)));
+    module_keys_.push_back(key);
+    keys.push_back(key);
+  }
+  const VModuleKeyT first_key = keys.front();
+  part_keys_[first_key] = std::move(keys);
+  return first_key;
+}
+
 void SimpleOrcJIT::RemoveModule(SimpleOrcJIT::VModuleKeyT key) {
-  module_keys_.erase(std::remove(module_keys_.begin(), module_keys_.end(), key),
-                     module_keys_.end());
-  cantFail(compile_layer_.removeModule(key));
+  std::vector<VModuleKeyT> keys = {key};
+  auto it = part_keys_.find(key);
+  if (it != part_keys_.end()) {
+    keys = std::move(it->second);
+    part_keys_.erase(it);
+  }
+  for (VModuleKeyT part_key : keys) {
+    module_keys_.erase(
+        std::remove(module_keys_.begin(), module_keys_.end(), part_key),
+        module_keys_.end());
+    cantFail(compile_layer_.removeModule(part_key));
+  }
 }
 
 llvm::JITSymbol SimpleOrcJIT::FindCompiledSymbol(const std::string& name) {
+  return FindSymbol(name, /*exported_symbols_only=*/true);
+}
+
+llvm::JITSymbol SimpleOrcJIT::FindSymbol(const std::string& name,
+                                         bool exported_symbols_only) {
   // Resolve symbol from last module to first, allowing later redefinitions of
   // symbols shadow earlier ones.
   for (auto& key :
        llvm::make_range(module_keys_.rbegin(), module_keys_.rend())) {
-    if (auto symbol =
-            compile_layer_.findSymbolIn(key, name,
-                                        /*ExportedSymbolsOnly=*/true)) {
+    if (auto symbol = compile_layer_.findSymbolIn(key, name,
+                                                  exported_symbols_only)) {
       return symbol;
     }
   }
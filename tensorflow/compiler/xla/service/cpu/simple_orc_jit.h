@@ -20,6 +20,7 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/ExecutionEngine/JITEventListener.h"
 #include "llvm/ExecutionEngine/Orc/Core.h"
@@ -30,6 +31,7 @@ limitations under the License.
 #include "llvm/Target/TargetMachine.h"
 #include "tensorflow/compiler/xla/service/cpu/compiler_functor.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace xla {
 namespace cpu {
@@ -54,13 +56,24 @@ class SimpleOrcJIT {
   // {pre,post}_optimization_hook is invoked on the module before/after all
   // LLVM IR-level optimizations.  post_codegen_hook is invoked after
   // compiling to machine code.
+  //
+  // If object_cache_dir is not empty, the object files compiled for modules
+  // are stored in this directory, keyed by the module's IR and the target, and
+  // modules whose object file is found there are not compiled again.  The
+  // hooks are not invoked for such modules.
+  //
+  // If codegen_split_count is greater than one, modules are split into up to
+  // that many parts (see PartitionModuleToBitcode) that are optimized and
+  // compiled concurrently. pre_optimization_hook then sees the whole module,
+  // and the other hooks see each part, one part at a time.
   SimpleOrcJIT(
       const llvm::TargetOptions& target_options,
       llvm::CodeGenOpt::Level opt_level, bool optimize_for_size,
       bool disable_expensive_passes,
       LLVMCompiler::ModuleHook pre_optimization_hook,
       LLVMCompiler::ModuleHook post_optimization_hook,
-      std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook);
+      std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook,
+      std::string object_cache_dir = "", int codegen_split_count = 1);
 
   const llvm::DataLayout& data_layout() const { return data_layout_; }
 
@@ -90,6 +103,23 @@ class SimpleOrcJIT {
  private:
   llvm::JITSymbol ResolveRuntimeSymbol(const std::string& name);
 
+  // Looks `name` up in the compiled modules, last added first.
+  llvm::JITSymbol FindSymbol(const std::string& name,
+                             bool exported_symbols_only);
+
+  // Compiles `module` to an object file with `compiler_functor`, going
+  // through the object cache if there is one.
+  ObjLayerT::ObjectPtr CompileModule(
+      llvm::Module& module,  // NOLINT
+      const CompilerFunctor& compiler_functor);
+
+  // Compiles the bitcode `parts` of a split module concurrently and adds the
+  // object files to the JIT. Returns the key of the first part.
+  VModuleKeyT AddModuleParts(const std::vector<std::string>& parts);
+
+  // Returns the path of the object cache entry for `module`.
+  std::string ObjectCacheFilename(const llvm::Module& module) const;
+
   void NotifyObjectFinalized(
       const llvm::object::ObjectFile& object,
       const llvm::RuntimeDyld::LoadedObjectInfo& object_info);
@@ -101,6 +131,24 @@ class SimpleOrcJIT {
   llvm::orc::ExecutionSession execution_session_;
   std::shared_ptr<llvm::orc::SymbolResolver> symbol_resolver_;
   ObjLayerT object_layer_;
+  const CompilerFunctor compiler_functor_;
+  const std::string object_cache_dir_;
+  // What it takes to build a CompilerFunctor for each part of a split module.
+  const llvm::TargetOptions target_options_;
+  const llvm::CodeGenOpt::Level opt_level_;
+  const bool optimize_for_size_;
+  const bool disable_expensive_passes_;
+  const LLVMCompiler::ModuleHook pre_optimization_hook_;
+  const LLVMCompiler::ModuleHook post_optimization_hook_;
+  const std::function<void(const llvm::object::ObjectFile&)>
+      post_codegen_hook_;
+  const int codegen_split_count_;
+  // Serializes the hook calls made while compiling parts concurrently.
+  tensorflow::mutex hook_mu_;
+  // The keys of all parts of a split module, by the key of its first part.
+  absl::flat_hash_map<VModuleKeyT, std::vector<VModuleKeyT>> part_keys_;
+  // Describes everything besides the IR that the compiled code depends on.
+  const std::string object_cache_key_suffix_;
   CompileLayerT compile_layer_;
 
   // Non owning pointer to a JIT event listener that registers the JIT events
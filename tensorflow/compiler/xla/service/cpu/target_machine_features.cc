@@ -57,5 +57,16 @@ int64 LLVMTargetMachineFeatures::minimum_alignment_for_allocation(
   return buffer_alignment;
 }
 
+int64 LLVMTargetMachineFeatures::l1_data_cache_byte_size(
+    const llvm::Function& function) const {
+  llvm::Optional<unsigned> cache_size =
+      GetTargetTransformInfoFor(function)->getCacheSize(
+          llvm::TargetTransformInfo::CacheLevel::L1D);
+  // LLVM doesn't know the cache sizes of every target.  Guess 32KiB, which is
+  // what most x86 and ARM cores have, for the others.
+  const int64 kDefaultL1DataCacheByteSize = 32 * 1024;
+  return cache_size.hasValue() ? *cache_size : kDefaultL1DataCacheByteSize;
+}
+
 }  // namespace cpu
 }  // namespace xla
@@ -55,6 +55,11 @@ class TargetMachineFeatures {
   // Returns the minimum alignment for a buffer of size size_bytes.
   virtual int64 minimum_alignment_for_allocation(int64 size_bytes) const = 0;
 
+  // Returns the size of the L1 data cache in bytes.  We need to pass in
+  // "function" for the same reason as in vector_register_byte_size.
+  virtual int64 l1_data_cache_byte_size(
+      const llvm::Function& function) const = 0;
+
   virtual ~TargetMachineFeatures() = default;
 };
 
@@ -86,6 +91,8 @@ class LLVMTargetMachineFeatures : public TargetMachineFeatures {
 
   int64 minimum_alignment_for_allocation(int64 size_bytes) const override;
 
+  int64 l1_data_cache_byte_size(const llvm::Function& function) const override;
+
  private:
   llvm::TargetTransformInfo* GetTargetTransformInfoFor(
       const llvm::Function& function) const;
@@ -0,0 +1,83 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/compiler/xla/literal.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/compiler/xla/tests/literal_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+class CpuObjectCacheTest : public HloTestBase {
+ protected:
+  CpuObjectCacheTest()
+      : cache_dir_(tensorflow::io::JoinPath(tensorflow::testing::TmpDir(),
+                                            "cpu_object_cache")) {
+    tensorflow::int64 undeleted_files, undeleted_dirs;
+    tensorflow::Env::Default()
+        ->DeleteRecursively(cache_dir_, &undeleted_files, &undeleted_dirs)
+        .IgnoreError();
+  }
+
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = HloTestBase::GetDebugOptionsForTest();
+    debug_options.set_xla_cpu_object_cache_dir(cache_dir_);
+    return debug_options;
+  }
+
+  std::vector<std::string> CacheEntries() {
+    std::vector<std::string> entries;
+    TF_CHECK_OK(tensorflow::Env::Default()->GetMatchingPaths(
+        tensorflow::io::JoinPath(cache_dir_, "*.o"), &entries));
+    return entries;
+  }
+
+  const std::string cache_dir_;
+};
+
+TEST_F(CpuObjectCacheTest, ReusesObjectFiles) {
+  const char* const hlo_text = R"(
+HloModule ObjectCache
+
+ENTRY main {
+  a = f32[4] constant({1, 2, 3, 4})
+  b = f32[4] constant({10, 20, 30, 40})
+  ROOT add = f32[4] add(a, b)
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(hlo_text));
+  Literal first_result = ExecuteAndTransfer(std::move(module), {});
+  std::vector<std::string> entries = CacheEntries();
+  ASSERT_EQ(entries.size(), 1);
+
+  // The second compilation of the same module loads the cached object file.
+  TF_ASSERT_OK_AND_ASSIGN(module, ParseAndReturnVerifiedModule(hlo_text));
+  Literal second_result = ExecuteAndTransfer(std::move(module), {});
+  EXPECT_EQ(CacheEntries(), entries);
+  EXPECT_TRUE(LiteralTestUtil::Equal(first_result, second_result));
+  LiteralTestUtil::ExpectR1Equal<float>({11, 22, 33, 44}, second_result);
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
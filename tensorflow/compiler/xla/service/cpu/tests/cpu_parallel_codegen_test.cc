@@ -0,0 +1,88 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/literal.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/compiler/xla/tests/literal_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+class CpuParallelCodegenTest : public HloTestBase {
+ protected:
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = HloTestBase::GetDebugOptionsForTest();
+    debug_options.set_xla_cpu_parallel_codegen_split_count(4);
+    return debug_options;
+  }
+};
+
+TEST_F(CpuParallelCodegenTest, RunsModuleSplitIntoParts) {
+  // Several computations (map, reduce and while) give the partitioner more
+  // than one function to place.
+  const char* const hlo_text = R"(
+HloModule ParallelCodegen
+
+square {
+  x = f32[] parameter(0)
+  ROOT mul = f32[] multiply(x, x)
+}
+
+sum {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT add = f32[] add(a, b)
+}
+
+cond {
+  state = (s32[], f32[4]) parameter(0)
+  i = s32[] get-tuple-element(state), index=0
+  limit = s32[] constant(3)
+  ROOT lt = pred[] compare(i, limit), direction=LT
+}
+
+body {
+  state = (s32[], f32[4]) parameter(0)
+  i = s32[] get-tuple-element(state), index=0
+  one = s32[] constant(1)
+  next = s32[] add(i, one)
+  v = f32[4] get-tuple-element(state), index=1
+  doubled = f32[4] add(v, v)
+  ROOT result = (s32[], f32[4]) tuple(next, doubled)
+}
+
+ENTRY main {
+  a = f32[4] constant({1, 2, 3, 4})
+  squared = f32[4] map(a), to_apply=square
+  zero = s32[] constant(0)
+  init = (s32[], f32[4]) tuple(zero, squared)
+  loop = (s32[], f32[4]) while(init), condition=cond, body=body
+  v = f32[4] get-tuple-element(loop), index=1
+  f0 = f32[] constant(0)
+  ROOT total = f32[] reduce(v, f0), dimensions={0}, to_apply=sum
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(hlo_text));
+  Literal result = ExecuteAndTransfer(std::move(module), {});
+  // (1 + 4 + 9 + 16) * 2^3.
+  LiteralTestUtil::ExpectR0Equal<float>(240, result);
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,66 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+
+#include "tensorflow/compiler/xla/service/cpu/cpu_compiler.h"
+#include "tensorflow/compiler/xla/service/cpu/tests/cpu_codegen_test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+using CpuTiledTransposeTest = CpuCodegenTest;
+
+TEST_F(CpuTiledTransposeTest, TransposingCopyIsTiled) {
+  const string hlo_text = R"(
+HloModule TiledTranspose
+
+ENTRY main {
+  a = f32[1024,512]{1,0} parameter(0)
+  ROOT copy = f32[1024,512]{0,1} copy(a)
+}
+)";
+
+  string filecheck_pattern = R"(
+CHECK: copy.target_tile
+CHECK: copy.source_tile
+)";
+
+  CompileAndVerifyIr(hlo_text, filecheck_pattern,
+                     /*match_optimized_ir=*/false);
+}
+
+TEST_F(CpuTiledTransposeTest, SmallTransposingCopyIsNotTiled) {
+  const string hlo_text = R"(
+HloModule SmallTranspose
+
+ENTRY main {
+  a = f32[4,8]{1,0} parameter(0)
+  ROOT copy = f32[4,8]{0,1} copy(a)
+}
+)";
+
+  string filecheck_pattern = R"(
+CHECK-NOT: copy.target_tile
+)";
+
+  CompileAndVerifyIr(hlo_text, filecheck_pattern,
+                     /*match_optimized_ir=*/false);
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -29,9 +29,15 @@ StatusOr<bool> AliasPassthroughParams::Run(HloModule* module) {
   }
   bool changed = false;
   absl::flat_hash_set<int64> used_params;
+  const HloInputOutputAliasConfig& alias_config =
+      module->input_output_alias_config();
   for (int64 i = 0; i < root->operand_count(); ++i) {
+    // Leave parameters and outputs that the user already aliased alone.
     if (root->operand(i)->opcode() == HloOpcode::kParameter &&
-        used_params.count(root->operand(i)->parameter_number()) == 0) {
+        used_params.count(root->operand(i)->parameter_number()) == 0 &&
+        !alias_config.ParameterHasAlias(root->operand(i)->parameter_number(),
+                                        /*param_index=*/{}) &&
+        !alias_config.OutputHasAlias(/*output_index=*/{i})) {
       VLOG(2) << "Parameter " << root->operand(i)->parameter_number()
               << " with shape " << root->operand(i)->shape().ToString()
               << " in module " << module->name()
@@ -0,0 +1,156 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/autotune_database.h"
+
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace xla {
+namespace gpu {
+
+tensorflow::CudnnVersion GetCudnnVersion(se::StreamExecutor* stream_executor) {
+  tensorflow::CudnnVersion cudnn_version;
+  if (auto* dnn = stream_executor->AsDnn()) {
+    StatusOr<se::dnn::VersionInfo> version_or = dnn->GetVersion();
+    if (version_or.ok()) {
+      const auto& version = version_or.ValueOrDie();
+      cudnn_version.set_major(version.major_version());
+      cudnn_version.set_minor(version.minor_version());
+      cudnn_version.set_patch(version.patch());
+    }
+  }
+  return cudnn_version;
+}
+
+tensorflow::ComputeCapability GetComputeCapability(
+    se::StreamExecutor* stream_executor) {
+  tensorflow::ComputeCapability cc;
+  int cc_major, cc_minor;
+  stream_executor->GetDeviceDescription().cuda_compute_capability(&cc_major,
+                                                                  &cc_minor);
+  cc.set_major(cc_major);
+  cc.set_minor(cc_minor);
+  return cc;
+}
+
+AutotuneResultsKey MakeAutotuneResultsKey(se::StreamExecutor* stream_executor,
+                                          absl::string_view hlo) {
+  AutotuneResultsKey key;
+  key.set_device_model(stream_executor->GetDeviceDescription().name());
+  *key.mutable_cc() = GetComputeCapability(stream_executor);
+  *key.mutable_cudnn_version() = GetCudnnVersion(stream_executor);
+  if (auto* blas = stream_executor->AsBlas()) {
+    (void)blas->GetVersion(key.mutable_blas_version());
+  }
+  key.set_hlo(std::string(hlo));
+  return key;
+}
+
+/*static*/ const AutotuneDatabase* AutotuneDatabase::Get(
+    const DebugOptions& debug_options) {
+  const std::string& dir = debug_options.xla_gpu_autotune_database_dir();
+  if (dir.empty()) {
+    return nullptr;
+  }
+  static tensorflow::mutex mu(tensorflow::LINKER_INITIALIZED);
+  static auto& databases GUARDED_BY(mu) =
+      *new absl::flat_hash_map<std::string,
+                               std::unique_ptr<AutotuneDatabase>>();
+  tensorflow::mutex_lock lock(mu);
+  std::unique_ptr<AutotuneDatabase>& database = databases[dir];
+  if (database == nullptr) {
+    database = absl::make_unique<AutotuneDatabase>(dir);
+  }
+  return database.get();
+}
+
+std::string AutotuneDatabase::FilenameForKey(
+    const std::string& serialized_key) const {
+  return tensorflow::io::JoinPath(
+      dir_, absl::StrCat(tensorflow::strings::Hex(
+                             tensorflow::Fingerprint64(serialized_key),
+                             tensorflow::strings::kZeroPad16),
+                         ".autotune.pb"));
+}
+
+absl::optional<tensorflow::AutotuneResult> AutotuneDatabase::Lookup(
+    const AutotuneResultsKey& key) const {
+  std::string serialized_key;
+  tensorflow::SerializeToStringDeterministic(key, &serialized_key);
+  const std::string filename = FilenameForKey(serialized_key);
+  tensorflow::Env* env = tensorflow::Env::Default();
+  if (!env->FileExists(filename).ok()) {
+    return absl::nullopt;
+  }
+  AutotuneResultsEntry entry;
+  Status status = tensorflow::ReadBinaryProto(env, filename, &entry);
+  if (status.ok()) {
+    // Guards against fingerprint collisions.
+    std::string serialized_entry_key;
+    tensorflow::SerializeToStringDeterministic(entry.key(),
+                                               &serialized_entry_key);
+    if (serialized_entry_key != serialized_key) {
+      status = tensorflow::errors::FailedPrecondition("key mismatch");
+    }
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Ignoring unusable autotuning database entry " << filename
+                 << ": " << status;
+    return absl::nullopt;
+  }
+  return entry.result();
+}
+
+// The entry is first written to a temporary file and then renamed, so that
+// concurrent readers never see a partially written entry.
+Status AutotuneDatabase::Insert(
+    const AutotuneResultsKey& key,
+    const tensorflow::AutotuneResult& result) const {
+  AutotuneResultsEntry entry;
+  *entry.mutable_key() = key;
+  *entry.mutable_result() = result;
+  std::string serialized_key;
+  tensorflow::SerializeToStringDeterministic(key, &serialized_key);
+  const std::string filename = FilenameForKey(serialized_key);
+
+  tensorflow::Env* env = tensorflow::Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(dir_));
+  const std::string tmp_filename =
+      absl::StrCat(filename, ".tmp", tensorflow::random::New64());
+  Status status = tensorflow::WriteBinaryProto(env, tmp_filename, entry);
+  if (status.ok()) {
+    status = env->RenameFile(tmp_filename, filename);
+  }
+  if (!status.ok()) {
+    env->DeleteFile(tmp_filename).IgnoreError();
+  }
+  return status;
+}
+
+}  // namespace gpu
+}  // namespace xla
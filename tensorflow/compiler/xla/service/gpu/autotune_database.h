@@ -0,0 +1,78 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_DATABASE_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_DATABASE_H_
+
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_autotuning.pb.h"
+#include "tensorflow/compiler/xla/status.h"
+#include "tensorflow/compiler/xla/xla.pb.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
+#include "tensorflow/core/protobuf/autotuning.pb.h"
+
+namespace xla {
+namespace gpu {
+
+// Returns the version of the DNN library used by `stream_executor`, or an
+// empty version if it has none.
+tensorflow::CudnnVersion GetCudnnVersion(se::StreamExecutor* stream_executor);
+
+// Returns the CUDA compute capability of the device of `stream_executor`.
+tensorflow::ComputeCapability GetComputeCapability(
+    se::StreamExecutor* stream_executor);
+
+// Returns the key of the autotuning result for the instruction with the
+// canonical text `hlo` on the device of `stream_executor`.
+AutotuneResultsKey MakeAutotuneResultsKey(se::StreamExecutor* stream_executor,
+                                          absl::string_view hlo);
+
+// A directory of autotuning results that persists across processes. Each
+// result lives in its own file, named after a fingerprint of its key, so that
+// many processes (e.g. every replica of a job) can share one directory: a
+// result is measured once and then reused by everybody else.
+//
+// This class is thread-safe.
+class AutotuneDatabase {
+ public:
+  explicit AutotuneDatabase(std::string dir) : dir_(std::move(dir)) {}
+
+  // Returns the database in the directory set by
+  // --xla_gpu_autotune_database_dir, or nullptr if it is not set.
+  static const AutotuneDatabase* Get(const DebugOptions& debug_options);
+
+  // Returns the result stored for `key`, if any. Unreadable entries are
+  // logged and treated as missing.
+  absl::optional<tensorflow::AutotuneResult> Lookup(
+      const AutotuneResultsKey& key) const;
+
+  // Stores `result` for `key`, replacing any previous result.
+  Status Insert(const AutotuneResultsKey& key,
+                const tensorflow::AutotuneResult& result) const;
+
+ private:
+  std::string FilenameForKey(const std::string& serialized_key) const;
+
+  const std::string dir_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_DATABASE_H_
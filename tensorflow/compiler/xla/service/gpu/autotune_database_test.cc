@@ -0,0 +1,109 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/autotune_database.h"
+
+#include "tensorflow/compiler/xla/xla.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+class AutotuneDatabaseTest : public testing::Test {
+ protected:
+  AutotuneDatabaseTest()
+      : dir_(tensorflow::io::JoinPath(tensorflow::testing::TmpDir(),
+                                      "autotune_database")) {
+    tensorflow::int64 undeleted_files, undeleted_dirs;
+    tensorflow::Env::Default()
+        ->DeleteRecursively(dir_, &undeleted_files, &undeleted_dirs)
+        .IgnoreError();
+    key_.set_device_model("Tesla V100-SXM2-16GB");
+    key_.mutable_cc()->set_major(7);
+    key_.mutable_cc()->set_minor(0);
+    key_.mutable_cudnn_version()->set_major(7);
+    key_.mutable_cudnn_version()->set_minor(6);
+    key_.mutable_cudnn_version()->set_patch(2);
+    key_.set_blas_version("10000");
+    key_.set_hlo(
+        R"((f16[256,112,112,64]{3,2,1,0}, u8[0]{0}) custom-call(f16[256,224,224,4]{3,2,1,0}, f16[7,7,4,64]{2,1,0,3}), window={size=7x7 stride=2x2 pad=3_3x3_3}, dim_labels=b01f_01io->b01f, custom_call_target="__cudnn$convForward", backend_config="{conv_result_scale:1}")");
+  }
+
+  const std::string dir_;
+  AutotuneResultsKey key_;
+};
+
+TEST_F(AutotuneDatabaseTest, LookupAfterInsert) {
+  AutotuneDatabase database(dir_);
+  EXPECT_FALSE(database.Lookup(key_).has_value());
+
+  tensorflow::AutotuneResult result;
+  result.mutable_conv()->set_algorithm(3);
+  result.mutable_conv()->set_tensor_ops_enabled(true);
+  result.set_scratch_bytes(1024);
+  TF_ASSERT_OK(database.Insert(key_, result));
+
+  // Another process sharing the directory sees the result.
+  AutotuneDatabase other_database(dir_);
+  absl::optional<tensorflow::AutotuneResult> found =
+      other_database.Lookup(key_);
+  ASSERT_TRUE(found.has_value());
+  EXPECT_EQ(found->conv().algorithm(), 3);
+  EXPECT_TRUE(found->conv().tensor_ops_enabled());
+  EXPECT_EQ(found->scratch_bytes(), 1024);
+}
+
+TEST_F(AutotuneDatabaseTest, ResultsAreKeyedByDeviceAndLibraryVersions) {
+  AutotuneDatabase database(dir_);
+  tensorflow::AutotuneResult result;
+  result.mutable_gemm()->set_algorithm(7);
+  TF_ASSERT_OK(database.Insert(key_, result));
+
+  AutotuneResultsKey other_device = key_;
+  other_device.set_device_model("Tesla P100-PCIE-16GB");
+  EXPECT_FALSE(database.Lookup(other_device).has_value());
+
+  AutotuneResultsKey other_cudnn = key_;
+  other_cudnn.mutable_cudnn_version()->set_minor(5);
+  EXPECT_FALSE(database.Lookup(other_cudnn).has_value());
+
+  AutotuneResultsKey other_blas = key_;
+  other_blas.set_blas_version("10010");
+  EXPECT_FALSE(database.Lookup(other_blas).has_value());
+
+  AutotuneResultsKey other_hlo = key_;
+  other_hlo.set_hlo("f32[2,2]{1,0} custom-call()");
+  EXPECT_FALSE(database.Lookup(other_hlo).has_value());
+
+  EXPECT_TRUE(database.Lookup(key_).has_value());
+}
+
+TEST_F(AutotuneDatabaseTest, GetRequiresDirectory) {
+  DebugOptions debug_options;
+  EXPECT_EQ(AutotuneDatabase::Get(debug_options), nullptr);
+
+  debug_options.set_xla_gpu_autotune_database_dir(dir_);
+  const AutotuneDatabase* database = AutotuneDatabase::Get(debug_options);
+  ASSERT_NE(database, nullptr);
+  EXPECT_EQ(AutotuneDatabase::Get(debug_options), database);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <limits>
 
+#include "tensorflow/compiler/xla/service/gpu/autotune_database.h"
 #include "tensorflow/compiler/xla/service/gpu/backend_configs.pb.h"
 #include "tensorflow/compiler/xla/service/gpu/buffer_comparator.h"
 #include "tensorflow/compiler/xla/service/gpu/gemm_thunk.h"
@@ -227,11 +228,41 @@ static StatusOr<absl::optional<se::blas::AlgorithmType>> DoGemmAutotune(
     VLOG(2) << "Batch size is non-singular, using generic algorithm";
     result = absl::nullopt;
   } else {
-    TF_ASSIGN_OR_RETURN(
-        result,
-        DoUncachedGemmAutotune(instr, lhs_buffer, rhs_buffer, output_buffer,
-                               reference_result_buffer, stream, allocator,
-                               comparator, crash_on_checking_failure));
+    const AutotuneDatabase* database =
+        AutotuneDatabase::Get(instr->GetModule()->config().debug_options());
+    AutotuneResultsKey database_key;
+    absl::optional<AutotuneResult> database_result;
+    if (database != nullptr) {
+      auto options = HloPrintOptions::Canonical();
+      options.set_print_backend_config(true);
+      database_key =
+          MakeAutotuneResultsKey(stream->parent(), instr->ToString(options));
+      database_result = database->Lookup(database_key);
+    }
+    if (database_result) {
+      // A result without a gemm key records that no algorithm worked.
+      VLOG(4) << "Autotuning database hit";
+      if (database_result->has_gemm()) {
+        result = database_result->gemm().algorithm();
+      }
+    } else {
+      TF_ASSIGN_OR_RETURN(
+          result,
+          DoUncachedGemmAutotune(instr, lhs_buffer, rhs_buffer, output_buffer,
+                                 reference_result_buffer, stream, allocator,
+                                 comparator, crash_on_checking_failure));
+      if (database != nullptr) {
+        AutotuneResult autotune_result;
+        if (result) {
+          autotune_result.mutable_gemm()->set_algorithm(*result);
+        }
+        Status status = database->Insert(database_key, autotune_result);
+        if (!status.ok()) {
+          LOG(WARNING) << "Failed to store the autotuning result for "
+                       << instr->ToString() << ": " << status;
+        }
+      }
+    }
   }
 
   CHECK(autotune_cache.emplace(key, result).second);
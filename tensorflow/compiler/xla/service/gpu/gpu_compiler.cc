@@ -52,6 +52,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/gpu_layout_assignment.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_sanitize_constant_names.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_scatter_expander.h"
+#include "tensorflow/compiler/xla/service/gpu/horizontal_fusion.h"
 #include "tensorflow/compiler/xla/service/gpu/instruction_fusion.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emitter_context.h"
@@ -283,6 +284,17 @@ Status GpuCompiler::OptimizeHloModule(
     }
   }
 
+  {
+    // Packs the small kernels left over by the vertical fusion passes above
+    // into fewer launches.
+    HloPassFix<HloPassPipeline> horizontal_fusion("horizontal_fusion");
+    horizontal_fusion.AddPass<GpuHorizontalFusion>();
+    horizontal_fusion.AddPass<HloCSE>(/*is_layout_sensitive=*/true,
+                                      /*only_fusion_computations=*/true);
+    horizontal_fusion.AddPass<HloDCE>();
+    TF_RETURN_IF_ERROR(horizontal_fusion.Run(hlo_module).status());
+  }
+
   return Status::OK();
 }
 
@@ -360,7 +372,11 @@ StatusOr<std::unique_ptr<Executable>> GpuCompiler::RunBackend(
   // Determine the HLO schedule, which is an ordering of HLO instructions.  This
   // is used by buffer assignment to enable buffer reuse, and the same ordering
   // must also be used to determine the thunk launch schedule.
-  std::unique_ptr<StreamAssignment> stream_assignment = AssignStreams(*module);
+  HloCostAnalysis stream_cost_analysis(ShapeSizeBytesFunction());
+  TF_RETURN_IF_ERROR(
+      module->entry_computation()->Accept(&stream_cost_analysis));
+  std::unique_ptr<StreamAssignment> stream_assignment =
+      AssignStreams(*module, &stream_cost_analysis);
   TF_ASSIGN_OR_RETURN(
       std::unique_ptr<GpuHloSchedule> hlo_schedule,
       GpuHloSchedule::Build(*module, *stream_assignment, pointer_size_));
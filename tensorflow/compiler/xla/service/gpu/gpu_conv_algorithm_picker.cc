@@ -21,6 +21,7 @@ limitations under the License.
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/service/gpu/autotune_database.h"
 #include "tensorflow/compiler/xla/service/gpu/backend_configs.pb.h"
 #include "tensorflow/compiler/xla/service/gpu/buffer_comparator.h"
 #include "tensorflow/compiler/xla/service/gpu/convolution_thunk.h"
@@ -129,31 +130,6 @@ string NumBytesToString(int64 bytes) {
                       bytes, "B)");
 }
 
-tensorflow::CudnnVersion GetCudnnVersion(se::StreamExecutor* stream_executor) {
-  tensorflow::CudnnVersion cudnn_version;
-  if (auto* dnn = stream_executor->AsDnn()) {
-    StatusOr<se::dnn::VersionInfo> version_or = dnn->GetVersion();
-    if (version_or.ok()) {
-      const auto& version = version_or.ValueOrDie();
-      cudnn_version.set_major(version.major_version());
-      cudnn_version.set_minor(version.minor_version());
-      cudnn_version.set_patch(version.patch());
-    }
-  }
-  return cudnn_version;
-}
-
-tensorflow::ComputeCapability GetComputeCapability(
-    se::StreamExecutor* stream_executor) {
-  tensorflow::ComputeCapability cc;
-  int cc_major, cc_minor;
-  stream_executor->GetDeviceDescription().cuda_compute_capability(&cc_major,
-                                                                  &cc_minor);
-  cc.set_major(cc_major);
-  cc.set_minor(cc_minor);
-  return cc;
-}
-
 void PrintPlatformInfo(const se::Stream* stream) {
   auto* se = stream->parent();
   const auto& desc = se->GetDeviceDescription();
@@ -273,6 +249,22 @@ StatusOr<AutotuneResult> GpuConvAlgorithmPicker::PickBestAlgorithm(
     autotune_cache_stats.cache_misses++;
   }
 
+  // Results measured by other processes are reused as is, so that every
+  // process sharing the database picks the same algorithm.
+  const AutotuneDatabase* database =
+      AutotuneDatabase::Get(instr->GetModule()->config().debug_options());
+  AutotuneResultsKey database_key;
+  if (database != nullptr) {
+    database_key = MakeAutotuneResultsKey(stream_exec_, std::get<1>(key));
+    if (absl::optional<AutotuneResult> result =
+            database->Lookup(database_key)) {
+      VLOG(2) << "Autotuning database hit for " << instr->ToString();
+      tensorflow::mutex_lock lock(autotune_cache_lock);
+      autotune_cache.insert({key, *result});
+      return *result;
+    }
+  }
+
   // Make sure any previous activity on this executor is done. We don't want to
   // interfere with programs that are still running on the GPU.
   if (!stream_exec_->SynchronizeAllActivity()) {
@@ -303,6 +295,13 @@ StatusOr<AutotuneResult> GpuConvAlgorithmPicker::PickBestAlgorithm(
   }
 
   if (result_or.ok()) {
+    if (database != nullptr) {
+      Status status = database->Insert(database_key, result_or.ValueOrDie());
+      if (!status.ok()) {
+        LOG(WARNING) << "Failed to store the autotuning result for "
+                     << instr->ToString() << ": " << status;
+      }
+    }
     tensorflow::mutex_lock lock(autotune_cache_lock);
     CHECK(autotune_cache.insert({key, result_or.ValueOrDie()}).second);
   }
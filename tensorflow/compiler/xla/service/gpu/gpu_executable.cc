@@ -19,6 +19,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "tensorflow/compiler/xla/map_util.h"
@@ -26,6 +27,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/gpu_debug_info_manager.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_types.h"
 #include "tensorflow/compiler/xla/service/gpu/hlo_execution_profiler.h"
+#include "tensorflow/compiler/xla/service/gpu/sequential_thunk.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/buffer_assignment_util.h"
 #include "tensorflow/compiler/xla/service/logical_buffer.h"
@@ -38,6 +40,9 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/stream_executor/gpu/gpu_driver.h"
+#include "tensorflow/stream_executor/gpu/gpu_executor.h"
+#include "tensorflow/stream_executor/gpu/gpu_stream.h"
 #include "tensorflow/stream_executor/platform.h"
 
 namespace xla {
@@ -46,8 +51,55 @@ namespace {
 
 using tensorflow::tracing::ScopedAnnotation;
 
+// Every distinct set of buffer addresses needs its own graph. Executables whose
+// buffers move between runs stop capturing new graphs once this many are
+// cached and launch their thunks one by one instead.
+constexpr int kMaxCudaGraphsPerExecutable = 8;
+
+// Returns true if the work enqueued by the thunk can be recorded into a CUDA
+// graph and replayed. Thunks that synchronize with the host, allocate scratch
+// memory, call into libraries or contain control flow are excluded.
+bool IsCudaGraphCompatible(const Thunk& thunk) {
+  switch (thunk.kind()) {
+    case Thunk::kKernel:
+    case Thunk::kMemset32BitValue:
+    case Thunk::kMemzero:
+      return true;
+    case Thunk::kSequential:
+      return absl::c_all_of(
+          static_cast<const SequentialThunk&>(thunk).thunks(),
+          [](const std::unique_ptr<Thunk>& nested_thunk) {
+            return IsCudaGraphCompatible(*nested_thunk);
+          });
+    default:
+      return false;
+  }
+}
+
 }  // namespace
 
+// Owns an instantiated CUDA graph.
+class CudaGraphExec {
+ public:
+  CudaGraphExec(se::gpu::GpuContext* context,
+                se::gpu::GpuGraphExecHandle graph_exec)
+      : context_(context), graph_exec_(graph_exec) {}
+  ~CudaGraphExec() {
+    se::gpu::GpuDriver::DestroyGraphExec(context_, graph_exec_);
+  }
+
+  Status Launch(se::Stream* stream) {
+    return se::gpu::GpuDriver::GraphLaunch(
+        context_, graph_exec_, se::gpu::AsGpuStreamValue(stream));
+  }
+
+ private:
+  se::gpu::GpuContext* context_;
+  se::gpu::GpuGraphExecHandle graph_exec_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(CudaGraphExec);
+};
+
 // Implementation note: HLO profiling is always enabled for GPU executables,
 // since we can use timers around thunks.
 GpuExecutable::GpuExecutable(
@@ -68,6 +120,11 @@ GpuExecutable::GpuExecutable(
   GpuDebugInfoManager::Get()->RegisterModule(module().name(), shared_module(),
                                              assignment_);
   ComputeThunkAnnotations();
+  cuda_graph_compatible_ =
+      thunk_schedule_->StreamCount() == 1 &&
+      absl::c_all_of(thunk_schedule_->TotalOrder(), [](const Thunk* thunk) {
+        return IsCudaGraphCompatible(*thunk);
+      });
 }
 
 GpuExecutable::~GpuExecutable() {
@@ -89,6 +146,82 @@ GpuExecutable::~GpuExecutable() {
   }
 }
 
+StatusOr<std::unique_ptr<CudaGraphExec>> GpuExecutable::CaptureCudaGraph(
+    const ServiceExecutableRunOptions* run_options,
+    const BufferAllocations& buffer_allocations,
+    HloExecutionProfiler* profiler) {
+  se::Stream* main_stream = run_options->stream();
+  se::gpu::GpuContext* context =
+      se::gpu::AsGpuStream(main_stream)->parent()->gpu_context();
+  se::gpu::GpuStreamHandle stream_handle =
+      se::gpu::AsGpuStreamValue(main_stream);
+
+  TF_RETURN_IF_ERROR(
+      se::gpu::GpuDriver::StreamBeginCapture(context, stream_handle));
+  Status record_status = Status::OK();
+  for (Thunk* thunk : thunk_schedule_->TotalOrder()) {
+    Thunk::ExecuteParams thunk_params{
+        &buffer_allocations, main_stream, run_options->run_options().run_id(),
+        profiler, run_options->run_options().device_assignment()};
+    record_status = thunk->ExecuteOnStream(thunk_params);
+    if (!record_status.ok()) {
+      break;
+    }
+  }
+  // Always end the capture so that the stream is usable again, even if
+  // recording one of the thunks failed.
+  se::gpu::GpuGraphHandle graph = nullptr;
+  Status end_status =
+      se::gpu::GpuDriver::StreamEndCapture(context, stream_handle, &graph);
+  auto destroy_graph = MakeCleanup(
+      [&]() { se::gpu::GpuDriver::DestroyGraph(context, graph); });
+  TF_RETURN_IF_ERROR(record_status);
+  TF_RETURN_IF_ERROR(end_status);
+
+  se::gpu::GpuGraphExecHandle graph_exec = nullptr;
+  TF_RETURN_IF_ERROR(
+      se::gpu::GpuDriver::GraphInstantiate(context, graph, &graph_exec));
+  VLOG(1) << "Captured a CUDA graph of " << thunk_schedule_->TotalOrder().size()
+          << " thunks for " << module().name();
+  return absl::make_unique<CudaGraphExec>(context, graph_exec);
+}
+
+StatusOr<bool> GpuExecutable::ExecuteThunksWithCudaGraph(
+    const ServiceExecutableRunOptions* run_options,
+    const BufferAllocations& buffer_allocations,
+    HloExecutionProfiler* profiler) {
+  se::Stream* main_stream = run_options->stream();
+  CudaGraphKey key;
+  key.first = main_stream->parent();
+  key.second.reserve(assignment_->Allocations().size());
+  for (BufferAllocation::Index i = 0; i < assignment_->Allocations().size();
+       ++i) {
+    key.second.push_back(buffer_allocations.GetDeviceAddress(i).opaque());
+  }
+
+  tensorflow::mutex_lock lock(cuda_graph_mutex_);
+  auto it = cuda_graphs_.find(key);
+  if (it == cuda_graphs_.end()) {
+    if (cuda_graph_capture_failed_ ||
+        cuda_graphs_.size() >= kMaxCudaGraphsPerExecutable) {
+      return false;
+    }
+    StatusOr<std::unique_ptr<CudaGraphExec>> graph_exec =
+        CaptureCudaGraph(run_options, buffer_allocations, profiler);
+    if (!graph_exec.ok()) {
+      LOG(WARNING) << "Failed to capture a CUDA graph for " << module().name()
+                   << "; launching its thunks individually: "
+                   << graph_exec.status();
+      cuda_graph_capture_failed_ = true;
+      return false;
+    }
+    it = cuda_graphs_.emplace(std::move(key), graph_exec.ConsumeValueOrDie())
+             .first;
+  }
+  TF_RETURN_IF_ERROR(it->second->Launch(main_stream));
+  return true;
+}
+
 void GpuExecutable::ComputeThunkAnnotations() {
   CanonicalNameMap canonical_name_map;
   for (Thunk* thunk : thunk_schedule_->TotalOrder()) {
@@ -170,9 +303,25 @@ Status GpuExecutable::ExecuteThunks(
       [&] { return absl::StrCat(hlo_module_->name(), ":XLA GPU module"); },
       tensorflow::profiler::TraceMeLevel::kInfo);
 
+  // Replaying a CUDA graph skips the per-thunk launch overhead. Profiling
+  // needs timers around each thunk, so it always launches them one by one.
+  bool launched_cuda_graph = false;
+  if (cuda_graph_compatible_ && !do_profile &&
+      hlo_module_->config().debug_options().xla_gpu_enable_cuda_graphs()) {
+    for (Thunk* thunk : thunk_schedule_->TotalOrder()) {
+      TF_RETURN_IF_ERROR(thunk->Initialize(*this, executor));
+    }
+    TF_ASSIGN_OR_RETURN(
+        launched_cuda_graph,
+        ExecuteThunksWithCudaGraph(run_options, buffer_allocations, &profiler));
+  }
+
   std::map<const Thunk*, std::unique_ptr<se::Event>> thunk_to_finish_event;
   bool scoped_annotation_enabled = ScopedAnnotation::IsEnabled();
   for (Thunk* thunk : thunk_schedule_->TotalOrder()) {
+    if (launched_cuda_graph) {
+      break;
+    }
     // Annotate execution of this op if tracing was enabled when we started
     // running this module.  If tracing is enabled *while* we're running the
     // module, we won't get any data, but that's probably an OK trade-off.
@@ -281,16 +430,26 @@ GpuExecutable::ResolveConstantGlobals(se::Stream* stream) {
       VLOG(3) << "Resolved global "
               << llvm_ir::ConstantBufferAllocationToGlobalName(allocation)
               << " to " << global.opaque();
-      InsertOrDie(&globals, i, global);
 
       const Literal& literal =
           llvm_ir::LiteralForConstantAllocation(allocation);
       CHECK(literal.shape().IsArray());
-      if (!ShouldEmitLiteralInLlvmIr(literal)) {
-        VLOG(3) << "H2D memcpy for constant with shape "
-                << ShapeUtil::HumanString(literal.shape());
-        stream->ThenMemcpy(&global, literal.untyped_data(), allocation.size());
+      if (ShouldEmitLiteralInLlvmIr(literal)) {
+        InsertOrDie(&globals, i, global);
+        continue;
       }
+      // The global holds the address of the shared buffer of the constant.
+      TF_ASSIGN_OR_RETURN(
+          SharedConstantPool::Buffer buffer,
+          SharedConstantPool::Get()->GetOrCreate(executor, literal));
+      VLOG(3) << "Shared constant buffer " << buffer->opaque()
+              << " for constant with shape "
+              << ShapeUtil::HumanString(literal.shape());
+      void* address = buffer->opaque();
+      TF_RETURN_IF_ERROR(
+          executor->SynchronousMemcpyH2D(&address, sizeof(address), &global));
+      InsertOrDie(&globals, i, *buffer);
+      shared_constants_.push_back(std::move(buffer));
     }
   }
 
@@ -16,8 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_EXECUTABLE_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_EXECUTABLE_H_
 
+#include <map>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
@@ -27,6 +30,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/executable.h"
 #include "tensorflow/compiler/xla/service/gpu/buffer_allocations.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_types.h"
+#include "tensorflow/compiler/xla/service/gpu/shared_constant_pool.h"
 #include "tensorflow/compiler/xla/service/gpu/stream_assignment.h"
 #include "tensorflow/compiler/xla/service/gpu/thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/thunk_schedule.h"
@@ -36,12 +40,17 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/shaped_buffer.h"
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/stream_executor/device_memory_allocator.h"
 
 namespace xla {
 namespace gpu {
 
+class CudaGraphExec;
+class HloExecutionProfiler;
+
 // GPU-targeting implementation of the XLA Executable interface.
 //
 // Launches the given GPU kernel via the StreamExecutor.
@@ -116,13 +125,30 @@ class GpuExecutable : public Executable {
 
   // Loads the PTX or CUBIN for this executable into `executor` and resolves the
   // globals corresponding to constant buffers.  Returns a map mapping buffer
-  // allocation indices to GPU pointers.
+  // allocation indices to GPU pointers. Constants which are not emitted into
+  // the LLVM IR are mapped to buffers from the SharedConstantPool.
   StatusOr<const BufferAllocToDeviceMemoryMap*> ResolveConstantGlobals(
       stream_executor::Stream* stream);
 
   // Computes annotations for each thunk and store them in thunk_annotations_.
   void ComputeThunkAnnotations();
 
+  // Launches all thunks with a single CUDA graph launch on the main stream.
+  // The graph is captured on the first execution with a given set of buffer
+  // addresses. Returns false if no graph could be used, in which case the
+  // caller should launch the thunks one by one.
+  StatusOr<bool> ExecuteThunksWithCudaGraph(
+      const ServiceExecutableRunOptions* run_options,
+      const BufferAllocations& buffer_allocations,
+      HloExecutionProfiler* profiler);
+
+  // Records the thunks on the main stream into a CUDA graph and instantiates
+  // it. The thunks must already be initialized.
+  StatusOr<std::unique_ptr<CudaGraphExec>> CaptureCudaGraph(
+      const ServiceExecutableRunOptions* run_options,
+      const BufferAllocations& buffer_allocations,
+      HloExecutionProfiler* profiler);
+
   // GpuExecutable check with either AMD's ISA version, or Nvdia's major minor
   // version for compute capability, depending on the hardware.
   Status CheckCompatibilityWithServiceExecutableRunOptions(
@@ -160,6 +186,20 @@ class GpuExecutable : public Executable {
   // constructing ScopeAnnotation objects.
   absl::flat_hash_map<Thunk*, string> thunk_annotations_;
 
+  // Whether the thunk schedule uses a single stream and contains only thunks
+  // that can be recorded into a CUDA graph.
+  bool cuda_graph_compatible_ = false;
+
+  // Instantiated CUDA graphs, keyed by the executor and the device addresses
+  // of all buffer allocations that were baked into the graph.
+  using CudaGraphKey =
+      std::pair<stream_executor::StreamExecutor*, std::vector<const void*>>;
+  tensorflow::mutex cuda_graph_mutex_;
+  std::map<CudaGraphKey, std::unique_ptr<CudaGraphExec>> cuda_graphs_
+      GUARDED_BY(cuda_graph_mutex_);
+  // Set once capturing failed, so that it isn't attempted again.
+  bool cuda_graph_capture_failed_ GUARDED_BY(cuda_graph_mutex_) = false;
+
   // Cache of module handles and constant buffer allocation maps used by
   // `ResolveConstantGlobals`.
   tensorflow::mutex module_handle_mutex_;
@@ -167,6 +207,10 @@ class GpuExecutable : public Executable {
       module_handles_ GUARDED_BY(module_handle_mutex_);
   std::map<stream_executor::StreamExecutor*, BufferAllocToDeviceMemoryMap>
       module_globals_ GUARDED_BY(module_handle_mutex_);
+  // The buffers of the constants which are not emitted into the LLVM IR, shared
+  // with the other executables having the same constants.
+  std::vector<SharedConstantPool::Buffer> shared_constants_
+      GUARDED_BY(module_handle_mutex_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(GpuExecutable);
 };
@@ -19,6 +19,7 @@ limitations under the License.
 #include <stack>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
@@ -176,6 +177,19 @@ bool IsInputFusibleScatter(const HloInstruction& instr) {
   return false;
 }
 
+bool IsSliceInputFusion(const HloInstruction& instr) {
+  if (!instr.IsInputFusion() || !instr.IsMultiOutputFusion()) {
+    return false;
+  }
+  return absl::c_all_of(
+      instr.fused_expression_root()->operands(),
+      [](const HloInstruction* operand) {
+        return operand->opcode() == HloOpcode::kSlice &&
+               absl::c_all_of(operand->slice_strides(),
+                              [](int64 stride) { return stride == 1; });
+      });
+}
+
 bool IsInputFusible(const HloInstruction& instr) {
   // Input fusion only handles non-elemental reduction and scatter operations.
   return instr.IsFusible() &&
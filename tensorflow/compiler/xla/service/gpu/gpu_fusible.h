@@ -61,6 +61,10 @@ bool IsInputFusibleReduction(const HloInstruction& instr);
 // is either an unfused scatter op or a scatter input fusion.
 bool IsInputFusibleScatter(const HloInstruction& instr);
 
+// Whether `instr` is an input fusion whose root is a tuple of non-strided
+// slices, as created by GpuHorizontalFusion.
+bool IsSliceInputFusion(const HloInstruction& instr);
+
 // Determines whether the combination of `instr1` and `instr2` into a (possibly
 // multi-output) fusion would be "too large" -- i.e., have more operands and
 // outputs than is allowed.
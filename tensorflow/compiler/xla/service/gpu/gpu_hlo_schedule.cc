@@ -149,6 +149,10 @@ GpuHloOrdering::GpuHloOrdering(
 // because C completes before D starts in stream 0, and E depends on D.
 // However, if the total order is A,B,D,C,E, then C and E can run
 // concurrently.
+//
+// All-reduces are launched as soon as their operands are, ahead of other ready
+// HLOs: they run on a communication stream of their own, so the earlier they
+// start, the more of the computation launched after them overlaps them.
 void BFSLaunchOrder(const HloComputation* computation,
                     std::vector<HloInstruction*>* launch_order) {
   // This topological sort uses two data structures:
@@ -178,7 +182,11 @@ void BFSLaunchOrder(const HloComputation* computation,
     for (HloInstruction* y : x->users()) {
       --incoming_edge_count[y];
       if (incoming_edge_count[y] == 0) {
-        queue.push_back(y);
+        if (y->opcode() == HloOpcode::kAllReduce) {
+          queue.push_front(y);
+        } else {
+          queue.push_back(y);
+        }
       }
     }
   }
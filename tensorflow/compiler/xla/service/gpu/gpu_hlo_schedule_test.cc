@@ -401,5 +401,48 @@ TEST_F(GpuHloScheduleTest, LatticeMatMul) {
   }
 }
 
+// All-reduces are launched as soon as their operands are.
+TEST_F(GpuHloScheduleTest, AllReduceLaunchedEarly) {
+  const char* const kModuleStr = R"(
+HloModule m
+
+sum {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT add = f32[] add(a, b)
+}
+
+ENTRY entry {
+  x = f32[2,2] parameter(0)
+  y = f32[2,2] parameter(1)
+  dot1 = f32[2,2] dot(x, y), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+  dot2 = f32[2,2] dot(y, x), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+  ar = f32[2,2] all-reduce(dot1), replica_groups={}, to_apply=sum
+  ROOT add = f32[2,2] add(ar, dot2)
+}
+)";
+  HloModuleConfig config;
+  auto debug_options = GetDebugOptionsForTest();
+  debug_options.set_xla_gpu_disable_multi_streaming(false);
+  config.set_debug_options(debug_options);
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kModuleStr, config));
+  HloInstruction* dot1 = FindInstruction(module.get(), "dot1");
+  HloInstruction* ar = FindInstruction(module.get(), "ar");
+
+  std::unique_ptr<StreamAssignment> streams = AssignStreams(*module);
+  EXPECT_NE(streams->StreamNumberForHlo(*dot1),
+            streams->StreamNumberForHlo(*ar));
+
+  auto schedule = BuildGpuHloSchedule(*module, *streams);
+  const HloVec& launch_order = schedule->ThunkLaunchOrder();
+  auto dot1_it = std::find(launch_order.begin(), launch_order.end(), dot1);
+  ASSERT_NE(dot1_it, launch_order.end());
+  ASSERT_NE(dot1_it + 1, launch_order.end());
+  EXPECT_EQ(*(dot1_it + 1), ar);
+}
+
 }  // namespace gpu
 }  // namespace xla
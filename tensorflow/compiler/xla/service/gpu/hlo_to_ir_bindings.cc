@@ -21,6 +21,7 @@ limitations under the License.
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Instructions.h"
 #include "tensorflow/compiler/xla/service/gpu/buffer_allocations.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/hlo_opcode.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/buffer_assignment_util.h"
@@ -122,10 +123,9 @@ void HloToIrBindings::EmitBasePointersForHlos(
             BindHloToIrValue(*non_io_hlo, b_->CreateAlloca(pointee_type),
                              index);
           } else if (slice.allocation()->is_constant()) {
-            llvm::Value* global_for_constant = module_->getGlobalVariable(
-                llvm_ir::ConstantBufferAllocationToGlobalName(
-                    *slice.allocation()));
-            BindHloToIrValue(*non_io_hlo, global_for_constant);
+            llvm::Value* address =
+                EmitConstantBufferAddress(*slice.allocation(), module_, b_);
+            BindHloToIrValue(*non_io_hlo, address);
           } else {
             const int64 offset = slice.offset();
             CHECK_NE(nullptr, temp_buffer_base_);
@@ -307,5 +307,25 @@ string HloToIrBindings::ToString() const {
   return s;
 }
 
+llvm::Value* EmitConstantBufferAddress(const BufferAllocation& allocation,
+                                       llvm::Module* module,
+                                       llvm::IRBuilder<>* b) {
+  llvm::GlobalVariable* global = module->getGlobalVariable(
+      llvm_ir::ConstantBufferAllocationToGlobalName(allocation));
+  CHECK_NE(global, nullptr);
+  if (ShouldEmitLiteralInLlvmIr(
+          llvm_ir::LiteralForConstantAllocation(allocation))) {
+    return global;
+  }
+  // The address is written before any kernel of the executable runs and never
+  // changes afterwards.
+  llvm::LoadInst* address = b->CreateLoad(global);
+  address->setMetadata(llvm::LLVMContext::MD_invariant_load,
+                       llvm::MDNode::get(b->getContext(), {}));
+  llvm_ir::SetAlignmentMetadataForLoad(address, kConstantBufferAlignBytes);
+  llvm_ir::SetDereferenceableMetadataForLoad(address, allocation.size());
+  return address;
+}
+
 }  // namespace gpu
 }  // namespace xla
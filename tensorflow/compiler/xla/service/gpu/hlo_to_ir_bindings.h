@@ -120,6 +120,14 @@ class HloToIrBindings {
   llvm_ir::AliasAnalysis alias_analysis_;
 };
 
+// Emits the address of the constant buffer `allocation` in the function `b`
+// inserts into. Constants whose literal is emitted into the LLVM IR live in
+// their global. The other constants live in buffers shared across executables
+// (see SharedConstantPool), and their global holds the address of the buffer.
+llvm::Value* EmitConstantBufferAddress(const BufferAllocation& allocation,
+                                       llvm::Module* module,
+                                       llvm::IRBuilder<>* b);
+
 }  // namespace gpu
 }  // namespace xla
 
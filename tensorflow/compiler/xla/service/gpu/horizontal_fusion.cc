@@ -0,0 +1,251 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/horizontal_fusion.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/layout_util.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_fusible.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/util.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+// Fusions larger than this are expected to saturate the device on their own,
+// so packing them with others saves little launch overhead.
+constexpr int64 kMaxCandidateElements = 128 * 2048;
+constexpr int64 kMaxCandidateInstructions = 30;
+// Bounds the code size of the emitted kernel; each fused computation adds a
+// branch to the concatenation.
+constexpr int64 kMaxFusionBatchSize = 32;
+
+bool IsHorizontalFusionCandidate(const HloInstruction& instr,
+                                 const HloInstruction& consumer) {
+  if (instr.opcode() != HloOpcode::kFusion ||
+      instr.fusion_kind() != HloInstruction::FusionKind::kLoop ||
+      instr.IsMultiOutputFusion()) {
+    return false;
+  }
+  // A dynamic-update-slice root is emitted in place and must keep its own
+  // kernel.
+  if (instr.fused_expression_root()->opcode() ==
+      HloOpcode::kDynamicUpdateSlice) {
+    return false;
+  }
+  // The output is read back through a bitcast of a flat array, so its layout
+  // must be the one a reshape to and from rank 1 preserves.
+  const Shape& shape = instr.shape();
+  if (!shape.IsArray() || !LayoutUtil::HasLayout(shape) ||
+      !LayoutUtil::IsMonotonicWithDim0Major(shape.layout())) {
+    return false;
+  }
+  const int64 num_elements = ShapeUtil::ElementsIn(shape);
+  if (num_elements == 0 || num_elements > kMaxCandidateElements ||
+      instr.fused_instruction_count() > kMaxCandidateInstructions) {
+    return false;
+  }
+  // Every use must be by `consumer`; this is what guarantees that the
+  // candidates of one consumer are independent of each other.
+  return absl::c_all_of(instr.users(), [&](const HloInstruction* user) {
+    return user == &consumer;
+  });
+}
+
+class HorizontalFusionImpl {
+ public:
+  explicit HorizontalFusionImpl(HloComputation* computation)
+      : computation_(computation) {}
+
+  StatusOr<bool> Run();
+
+ private:
+  // Returns the candidates among the operands of `consumer`, grouped by
+  // element type and ordered by size within a group.
+  std::vector<HloInstruction*> FindCandidates(HloInstruction* consumer);
+
+  // Replaces `fusions` with one kInput fusion computing all their outputs.
+  Status Fuse(absl::Span<HloInstruction* const> fusions);
+
+  HloComputation* computation_;
+};
+
+std::vector<HloInstruction*> HorizontalFusionImpl::FindCandidates(
+    HloInstruction* consumer) {
+  std::vector<HloInstruction*> candidates;
+  absl::flat_hash_set<HloInstruction*> seen;
+  for (HloInstruction* operand : consumer->operands()) {
+    if (seen.insert(operand).second &&
+        IsHorizontalFusionCandidate(*operand, *consumer)) {
+      candidates.push_back(operand);
+    }
+  }
+  absl::c_stable_sort(candidates, [](const HloInstruction* a,
+                                     const HloInstruction* b) {
+    const PrimitiveType a_type = a->shape().element_type();
+    const PrimitiveType b_type = b->shape().element_type();
+    if (a_type != b_type) {
+      return a_type < b_type;
+    }
+    return ShapeUtil::ElementsIn(a->shape()) <
+           ShapeUtil::ElementsIn(b->shape());
+  });
+  return candidates;
+}
+
+Status HorizontalFusionImpl::Fuse(absl::Span<HloInstruction* const> fusions) {
+  const PrimitiveType element_type = fusions[0]->shape().element_type();
+  HloComputation::Builder builder("horizontally_fused_computation");
+  std::vector<HloInstruction*> operands;
+  absl::flat_hash_map<HloInstruction*, HloInstruction*> operand_to_parameter;
+  std::vector<HloInstruction*> flat_outputs;
+  for (HloInstruction* fusion : fusions) {
+    absl::flat_hash_map<const HloInstruction*, HloInstruction*> clones;
+    for (HloInstruction* instr :
+         fusion->fused_instructions_computation()->MakeInstructionPostOrder()) {
+      if (instr->opcode() == HloOpcode::kParameter) {
+        HloInstruction* operand =
+            fusion->mutable_operand(instr->parameter_number());
+        auto it = operand_to_parameter.find(operand);
+        if (it == operand_to_parameter.end()) {
+          HloInstruction* parameter =
+              builder.AddInstruction(HloInstruction::CreateParameter(
+                  operands.size(), operand->shape(),
+                  absl::StrCat("param_", operands.size())));
+          it = operand_to_parameter.emplace(operand, parameter).first;
+          operands.push_back(operand);
+        }
+        clones[instr] = it->second;
+        continue;
+      }
+      std::vector<HloInstruction*> new_operands;
+      for (HloInstruction* operand : instr->operands()) {
+        new_operands.push_back(clones.at(operand));
+      }
+      clones[instr] = builder.AddInstruction(
+          instr->CloneWithNewOperands(instr->shape(), new_operands));
+    }
+    const Shape flat_shape = ShapeUtil::MakeShapeWithDescendingLayout(
+        element_type, {ShapeUtil::ElementsIn(fusion->shape())});
+    flat_outputs.push_back(builder.AddInstruction(HloInstruction::CreateReshape(
+        flat_shape, clones.at(fusion->fused_expression_root()))));
+  }
+
+  int64 total_elements = 0;
+  for (const HloInstruction* flat_output : flat_outputs) {
+    total_elements += flat_output->shape().dimensions(0);
+  }
+  HloInstruction* concat =
+      builder.AddInstruction(HloInstruction::CreateConcatenate(
+          ShapeUtil::MakeShapeWithDescendingLayout(element_type,
+                                                   {total_elements}),
+          flat_outputs, /*dimension=*/0));
+  std::vector<HloInstruction*> slices;
+  int64 offset = 0;
+  for (const HloInstruction* flat_output : flat_outputs) {
+    const int64 size = flat_output->shape().dimensions(0);
+    slices.push_back(builder.AddInstruction(HloInstruction::CreateSlice(
+        flat_output->shape(), concat, {offset}, {offset + size}, {1})));
+    offset += size;
+  }
+  HloInstruction* tuple =
+      builder.AddInstruction(HloInstruction::CreateTuple(slices));
+
+  HloComputation* fused_computation =
+      computation_->parent()->AddEmbeddedComputation(builder.Build(tuple));
+  HloInstruction* horizontal_fusion =
+      computation_->AddInstruction(HloInstruction::CreateFusion(
+          tuple->shape(), HloInstruction::FusionKind::kInput, operands,
+          fused_computation));
+  VLOG(2) << "Horizontally fused " << fusions.size()
+          << " fusions into " << horizontal_fusion->name();
+
+  for (int64 i = 0; i < fusions.size(); ++i) {
+    HloInstruction* element =
+        computation_->AddInstruction(HloInstruction::CreateGetTupleElement(
+            slices[i]->shape(), horizontal_fusion, i));
+    HloInstruction* bitcast = computation_->AddInstruction(
+        HloInstruction::CreateBitcast(fusions[i]->shape(), element));
+    TF_RETURN_IF_ERROR(computation_->ReplaceInstruction(fusions[i], bitcast));
+  }
+  return Status::OK();
+}
+
+StatusOr<bool> HorizontalFusionImpl::Run() {
+  bool changed = false;
+  for (HloInstruction* consumer : computation_->MakeInstructionPostOrder()) {
+    const std::vector<HloInstruction*> candidates = FindCandidates(consumer);
+    // Walk the candidates in batches of one element type whose kernel stays
+    // within the parameter limit.
+    for (int64 begin = 0; begin < candidates.size();) {
+      const PrimitiveType element_type =
+          candidates[begin]->shape().element_type();
+      absl::flat_hash_set<const HloInstruction*> batch_operands;
+      int64 end = begin;
+      while (end < candidates.size() && end - begin < kMaxFusionBatchSize &&
+             candidates[end]->shape().element_type() == element_type) {
+        absl::flat_hash_set<const HloInstruction*> operands = batch_operands;
+        operands.insert(candidates[end]->operands().begin(),
+                        candidates[end]->operands().end());
+        // One buffer per distinct operand, one per output and one for the
+        // output tuple.
+        if (operands.size() + (end - begin + 1) + 1 >
+            kMaxOperandsAndOutputsPerFusion) {
+          break;
+        }
+        batch_operands = std::move(operands);
+        ++end;
+      }
+      if (end == begin) {
+        // A single candidate with too many operands; it stays alone.
+        end = begin + 1;
+      }
+      if (end - begin > 1) {
+        TF_RETURN_IF_ERROR(
+            Fuse(absl::MakeConstSpan(candidates).subspan(begin, end - begin)));
+        changed = true;
+      }
+      begin = end;
+    }
+  }
+  return changed;
+}
+
+}  // namespace
+
+StatusOr<bool> GpuHorizontalFusion::Run(HloModule* module) {
+  bool changed = false;
+  VLOG(2) << "GpuHorizontalFusion for module: " << module->name();
+  for (HloComputation* computation : module->MakeNonfusionComputations()) {
+    TF_ASSIGN_OR_RETURN(bool computation_changed,
+                        HorizontalFusionImpl(computation).Run());
+    changed |= computation_changed;
+  }
+  return changed;
+}
+
+}  // namespace gpu
+}  // namespace xla
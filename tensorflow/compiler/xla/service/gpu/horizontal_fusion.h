@@ -0,0 +1,60 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HORIZONTAL_FUSION_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HORIZONTAL_FUSION_H_
+
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace gpu {
+
+// An HLO pass that packs small, independent loop fusions into a single kernel
+// launch, which cuts launch overhead for graphs with many tiny kernels, e.g.
+// per-variable optimizer updates.
+//
+// Candidates are sibling kLoop fusions whose only user is one common
+// consumer. Because each candidate reaches the rest of the graph only through
+// that consumer, none of them can depend on another and fusing them cannot
+// create a cycle. Each batch of candidates with the same element type becomes
+// one kInput fusion:
+//
+//   fused_computation {
+//     ...
+//     flat.0 = f32[n0] reshape(root.0)
+//     flat.1 = f32[n1] reshape(root.1)
+//     concat = f32[n0 + n1] concatenate(flat.0, flat.1)
+//     slice.0 = f32[n0] slice(concat), slice={[0:n0]}
+//     slice.1 = f32[n1] slice(concat), slice={[n0:n0 + n1]}
+//     ROOT tuple = (f32[n0], f32[n1]) tuple(slice.0, slice.1)
+//   }
+//
+// The concatenation partitions one index space among the original fusions;
+// IrEmitterUnnested emits it as a single loop in which every thread computes
+// one element and writes it to the output its index falls into. The users of
+// each original fusion read its output through a bitcast of the matching
+// tuple element.
+class GpuHorizontalFusion : public HloModulePass {
+ public:
+  absl::string_view name() const override { return "gpu_horizontal_fusion"; }
+
+  StatusOr<bool> Run(HloModule* module) override;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HORIZONTAL_FUSION_H_
@@ -0,0 +1,156 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/horizontal_fusion.h"
+
+#include "tensorflow/compiler/xla/service/gpu/gpu_fusible.h"
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+using HorizontalFusionTest = HloTestBase;
+
+TEST_F(HorizontalFusionTest, FusesIndependentLoopFusions) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+    HloModule test_module
+
+    fused_computation.1 {
+      p0.1 = f32[1024]{0} parameter(0)
+      p1.1 = f32[1024]{0} parameter(1)
+      ROOT add.1 = f32[1024]{0} add(p0.1, p1.1)
+    }
+
+    fused_computation.2 {
+      p0.2 = f32[16,32]{1,0} parameter(0)
+      p1.2 = f32[16,32]{1,0} parameter(1)
+      ROOT mul.2 = f32[16,32]{1,0} multiply(p0.2, p1.2)
+    }
+
+    fused_computation.3 {
+      p0.3 = f32[7]{0} parameter(0)
+      ROOT neg.3 = f32[7]{0} negate(p0.3)
+    }
+
+    ENTRY entry {
+      a = f32[1024]{0} parameter(0)
+      b = f32[1024]{0} parameter(1)
+      c = f32[16,32]{1,0} parameter(2)
+      d = f32[7]{0} parameter(3)
+      fusion.1 = f32[1024]{0} fusion(a, b), kind=kLoop,
+          calls=fused_computation.1
+      fusion.2 = f32[16,32]{1,0} fusion(c, c), kind=kLoop,
+          calls=fused_computation.2
+      fusion.3 = f32[7]{0} fusion(d), kind=kLoop, calls=fused_computation.3
+      ROOT tuple = (f32[1024]{0}, f32[16,32]{1,0}, f32[7]{0})
+          tuple(fusion.1, fusion.2, fusion.3)
+    })")
+                    .ValueOrDie();
+  EXPECT_TRUE(GpuHorizontalFusion().Run(module.get()).ValueOrDie());
+  SCOPED_TRACE(module->ToString());
+
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_THAT(root, op::Tuple(op::Bitcast(op::GetTupleElement(op::Fusion())),
+                              op::Bitcast(op::GetTupleElement(op::Fusion())),
+                              op::Bitcast(op::GetTupleElement(op::Fusion()))));
+  const HloInstruction* fusion = root->operand(0)->operand(0)->operand(0);
+  EXPECT_EQ(fusion, root->operand(1)->operand(0)->operand(0));
+  EXPECT_EQ(fusion, root->operand(2)->operand(0)->operand(0));
+  EXPECT_TRUE(IsSliceInputFusion(*fusion));
+  // The shared operand `c` becomes a single parameter.
+  EXPECT_EQ(fusion->operand_count(), 4);
+  EXPECT_THAT(fusion->fused_expression_root(),
+              op::Tuple(op::Slice(op::Concatenate()),
+                        op::Slice(op::Concatenate()),
+                        op::Slice(op::Concatenate())));
+  for (const HloInstruction* operand : root->operands()) {
+    EXPECT_EQ(ShapeUtil::ElementsIn(operand->shape()),
+              ShapeUtil::ElementsIn(operand->operand(0)->shape()));
+  }
+}
+
+TEST_F(HorizontalFusionTest, BatchesByElementType) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+    HloModule test_module
+
+    fused_f32 {
+      p.f = f32[64]{0} parameter(0)
+      ROOT neg.f = f32[64]{0} negate(p.f)
+    }
+
+    fused_s32 {
+      p.s = s32[64]{0} parameter(0)
+      ROOT neg.s = s32[64]{0} negate(p.s)
+    }
+
+    ENTRY entry {
+      a = f32[64]{0} parameter(0)
+      b = s32[64]{0} parameter(1)
+      fusion.1 = f32[64]{0} fusion(a), kind=kLoop, calls=fused_f32
+      fusion.2 = s32[64]{0} fusion(b), kind=kLoop, calls=fused_s32
+      fusion.3 = f32[64]{0} fusion(a), kind=kLoop, calls=fused_f32
+      fusion.4 = s32[64]{0} fusion(b), kind=kLoop, calls=fused_s32
+      ROOT tuple = (f32[64]{0}, s32[64]{0}, f32[64]{0}, s32[64]{0})
+          tuple(fusion.1, fusion.2, fusion.3, fusion.4)
+    })")
+                    .ValueOrDie();
+  EXPECT_TRUE(GpuHorizontalFusion().Run(module.get()).ValueOrDie());
+  SCOPED_TRACE(module->ToString());
+
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  auto fusion_of = [&](int64 i) {
+    return root->operand(i)->operand(0)->operand(0);
+  };
+  EXPECT_EQ(fusion_of(0), fusion_of(2));
+  EXPECT_EQ(fusion_of(1), fusion_of(3));
+  EXPECT_NE(fusion_of(0), fusion_of(1));
+  EXPECT_TRUE(IsSliceInputFusion(*fusion_of(0)));
+  EXPECT_TRUE(IsSliceInputFusion(*fusion_of(1)));
+}
+
+TEST_F(HorizontalFusionTest, DoesNotFuseDependentFusions) {
+  // fusion.2 reads fusion.1, so fusing the two would create a cycle.
+  auto module = ParseAndReturnVerifiedModule(R"(
+    HloModule test_module
+
+    fused_computation.1 {
+      p0.1 = f32[64]{0} parameter(0)
+      ROOT neg.1 = f32[64]{0} negate(p0.1)
+    }
+
+    fused_computation.2 {
+      p0.2 = f32[64]{0} parameter(0)
+      ROOT exp.2 = f32[64]{0} exponential(p0.2)
+    }
+
+    ENTRY entry {
+      a = f32[64]{0} parameter(0)
+      fusion.1 = f32[64]{0} fusion(a), kind=kLoop, calls=fused_computation.1
+      fusion.2 = f32[64]{0} fusion(fusion.1), kind=kLoop,
+          calls=fused_computation.2
+      ROOT tuple = (f32[64]{0}, f32[64]{0}) tuple(fusion.1, fusion.2)
+    })")
+                    .ValueOrDie();
+  EXPECT_FALSE(GpuHorizontalFusion().Run(module.get()).ValueOrDie());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -23,6 +23,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
@@ -46,6 +47,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/copy_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/cudnn_batchnorm_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/for_thunk.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_fusible.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_conv_runner.h"
 #include "tensorflow/compiler/xla/service/gpu/hlo_to_ir_bindings.h"
@@ -361,6 +363,9 @@ Status IrEmitterUnnested::HandleTriangularSolve(HloInstruction* hlo) {
 Status IrEmitterUnnested::HandleFusion(HloInstruction* fusion) {
   HloInstruction* root = fusion->fused_expression_root();
   if (fusion->IsInputFusion()) {
+    if (IsSliceInputFusion(*fusion)) {
+      return EmitInputFusibleNonStridedSlices(fusion);
+    }
     switch (root->opcode()) {
       case HloOpcode::kScatter: {
         std::vector<std::unique_ptr<Thunk>> thunks;
@@ -1455,9 +1460,8 @@ std::unique_ptr<KernelThunk> IrEmitterUnnested::BuildKernelThunk(
 
     llvm::Value* loc;
     if (slice.allocation()->is_constant()) {
-      loc = ir_emitter_context_->llvm_module()->getGlobalVariable(
-          llvm_ir::ConstantBufferAllocationToGlobalName(*slice.allocation()));
-      CHECK_NE(loc, nullptr);
+      loc = EmitConstantBufferAddress(
+          *slice.allocation(), ir_emitter_context_->llvm_module(), &b_);
     } else {
       loc = InBoundsGEP(kernel_args.at(slice.allocation()),
                         {b_.getInt64(slice.offset())});
@@ -1802,6 +1806,81 @@ Status IrEmitterUnnested::EmitTargetElementLoopInThunk(
   return Status::OK();
 }
 
+Status IrEmitterUnnested::EmitInputFusibleNonStridedSlices(
+    HloInstruction* unnested_hlo) {
+  std::unique_ptr<KernelThunk> kernel_thunk =
+      BuildKernelThunk(unnested_hlo, /*implements_whole_instruction=*/true);
+  const HloInstruction* root = unnested_hlo->fused_expression_root();
+  // All slices of a horizontal fusion share one operand, so its shape is the
+  // index space of the whole kernel.
+  const Shape& input_shape = root->operand(0)->operand(0)->shape();
+  for (const HloInstruction* slice : root->operands()) {
+    TF_RET_CHECK(ShapeUtil::EqualIgnoringElementType(
+        slice->operand(0)->shape(), input_shape))
+        << "Slices of " << unnested_hlo->name()
+        << " read operands of different shapes";
+  }
+  LaunchDimensions launch_dimensions = CalculateLaunchDimensions(
+      input_shape, ir_emitter_context_->device_description());
+  UpdateLaunchDimensions(launch_dimensions, kernel_thunk.get(),
+                         ir_emitter_context_->llvm_module());
+
+  GpuElementalIrEmitter elemental_emitter(hlo_module_config_,
+                                          ir_emitter_context_->llvm_module(),
+                                          &b_, GetNestedComputer());
+  FusedIrEmitter fused_emitter(GetGeneratorForOperandIrArrays(unnested_hlo),
+                               &elemental_emitter);
+  TF_RETURN_IF_ERROR(root->Accept(&fused_emitter));
+
+  std::vector<IrArray> output_arrays =
+      ConstructIrArrayForOutputs(*unnested_hlo);
+  KernelSupportLibrary{&b_}.If("emit_slices_tuple", IsBlock0Thread0(&b_), [&] {
+    llvm_ir::EmitTuple(GetIrArray(*unnested_hlo, *unnested_hlo),
+                       output_arrays, &b_);
+  });
+
+  auto body_emitter = [&](const IrArray::Index& index) -> Status {
+    absl::flat_hash_map<const HloInstruction*, llvm::Value*> input_values;
+    for (int64 i = 0; i < root->operand_count(); ++i) {
+      const HloInstruction* slice = root->operand(i);
+      llvm::Value* input = input_values[slice->operand(0)];
+      if (input == nullptr) {
+        TF_ASSIGN_OR_RETURN(
+            input, fused_emitter.GetGenerator(slice->operand(0))(index));
+        input_values[slice->operand(0)] = input;
+      }
+      llvm::Value* in_bounds = b_.getTrue();
+      std::vector<llvm::Value*> output_multidim;
+      for (int64 dim = 0; dim < input_shape.rank(); ++dim) {
+        llvm::Value* start =
+            index.GetConstantWithIndexType(slice->slice_starts(dim));
+        llvm::Value* limit =
+            index.GetConstantWithIndexType(slice->slice_limits(dim));
+        in_bounds = And(in_bounds, ICmpSGE(index[dim], start));
+        in_bounds = And(in_bounds, ICmpSLT(index[dim], limit));
+        output_multidim.push_back(Sub(index[dim], start));
+      }
+      KernelSupportLibrary{&b_}.If(
+          absl::StrCat("slice", i), in_bounds, [&] {
+            IrArray::Index output_index(output_multidim, slice->shape(),
+                                        index.GetType());
+            output_arrays[i].EmitWriteArrayElement(output_index, input, &b_);
+          });
+    }
+    return Status::OK();
+  };
+  TF_RETURN_IF_ERROR(
+      ParallelLoopEmitter(body_emitter, input_shape, launch_dimensions, &b_)
+          .EmitLoop(IrName(unnested_hlo),
+                    GetIndexTypeForKernel(unnested_hlo,
+                                          launch_dimensions.launch_bound(),
+                                          &b_)));
+  b_.SetInsertPoint(b_.GetInsertBlock()->getTerminator());
+
+  AddThunkToThunkSequence(std::move(kernel_thunk));
+  return Status::OK();
+}
+
 namespace {
 
 // Returns true if the fusion contains any instruction that is likely
@@ -3106,12 +3185,19 @@ Status IrEmitterUnnested::EmitConstantGlobals() {
 
     const Literal& literal = llvm_ir::LiteralForConstantAllocation(allocation);
     const bool should_emit_initializer = ShouldEmitLiteralInLlvmIr(literal);
-    llvm::ArrayType* global_type =
-        llvm::ArrayType::get(b_.getInt8Ty(), allocation.size());
+    // Constants without an initializer live in device buffers shared by all
+    // the executables with the same constant, so their global only holds the
+    // address of that buffer, which GpuExecutable writes when loading the
+    // module. See EmitConstantBufferAddress.
+    llvm::Type* global_type =
+        should_emit_initializer
+            ? static_cast<llvm::Type*>(
+                  llvm::ArrayType::get(b_.getInt8Ty(), allocation.size()))
+            : b_.getInt8PtrTy();
     llvm::Constant* initializer =
         should_emit_initializer
             ? llvm_ir::ConvertLiteralToIrConstant(literal, module_)
-            : llvm::ConstantAggregateZero::get(global_type);
+            : llvm::Constant::getNullValue(global_type);
     if (should_emit_initializer) {
       VLOG(3) << "Emitted initializer for constant with shape "
               << ShapeUtil::HumanString(literal.shape());
@@ -3135,7 +3221,9 @@ Status IrEmitterUnnested::EmitConstantGlobals() {
         /*TLMode=*/llvm::GlobalValue::NotThreadLocal,
         /*AddressSpace=*/global_address_space,
         /*isExternallyInitialized=*/false);
-    global_for_const->setAlignment(kConstantBufferAlignBytes);
+    if (should_emit_initializer) {
+      global_for_const->setAlignment(kConstantBufferAlignBytes);
+    }
     ir_emitter_context_->llvm_module()->getGlobalList().push_back(
         global_for_const);
   }
@@ -173,6 +173,14 @@ class IrEmitterUnnested : public IrEmitter,
   Status EmitReductionFromOrToContiguousDimensions(
       HloInstruction* unnested_hlo);
 
+  // Generates code for an input fusion rooted at a tuple of non-strided
+  // slices. One loop covers the shape of the sliced operands; every index
+  // computes the operand elements once and stores them to each slice whose
+  // range contains the index.
+  //
+  // Prerequisite: `IsSliceInputFusion(*unnested_hlo)`
+  Status EmitInputFusibleNonStridedSlices(HloInstruction* unnested_hlo);
+
   // Computes the KernelMappingScheme for the reduce HLO and indicates whether
   // the reduction is a row reduction. For an un-fused reduce op, unnested_hlo
   // and first_reduce are the same instruction. For a kInput fusion,
@@ -0,0 +1,94 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/shared_constant_pool.h"
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace gpu {
+
+/* static */ SharedConstantPool* SharedConstantPool::Get() {
+  static auto* pool = new SharedConstantPool;
+  return pool;
+}
+
+StatusOr<SharedConstantPool::Buffer> SharedConstantPool::GetOrCreate(
+    se::StreamExecutor* executor, const Literal& literal) {
+  const absl::string_view contents(
+      static_cast<const char*>(literal.untyped_data()), literal.size_bytes());
+  if (contents.empty()) {
+    return std::make_shared<const se::DeviceMemoryBase>();
+  }
+  const tensorflow::Fprint128 fingerprint =
+      tensorflow::Fingerprint128(contents);
+  const Key key(executor, fingerprint.low64, fingerprint.high64,
+                contents.size());
+
+  // The lock is held while the contents are copied to the device, so that
+  // concurrent loads of executables with the same constants copy them once.
+  tensorflow::mutex_lock lock(mu_);
+  std::weak_ptr<const se::DeviceMemoryBase>& pooled = buffers_[key];
+  if (Buffer buffer = pooled.lock()) {
+    VLOG(3) << "Sharing constant buffer " << buffer->opaque() << " of "
+            << contents.size() << " bytes";
+    return buffer;
+  }
+
+  se::DeviceMemoryBase memory = executor->AllocateArray<uint8>(contents.size());
+  if (memory.is_null()) {
+    buffers_.erase(key);
+    return ResourceExhausted("Failed to allocate %d bytes for a constant",
+                             contents.size());
+  }
+  Status status =
+      executor->SynchronousMemcpyH2D(contents.data(), contents.size(), &memory);
+  if (!status.ok()) {
+    executor->Deallocate(&memory);
+    buffers_.erase(key);
+    return status;
+  }
+  VLOG(3) << "Pooled constant buffer " << memory.opaque() << " of "
+          << contents.size() << " bytes";
+  Buffer buffer(new se::DeviceMemoryBase(memory),
+                [this, key](const se::DeviceMemoryBase* released) {
+                  Release(key, *released);
+                  delete released;
+                });
+  pooled = buffer;
+  return buffer;
+}
+
+int64 SharedConstantPool::size() const {
+  tensorflow::mutex_lock lock(mu_);
+  return buffers_.size();
+}
+
+void SharedConstantPool::Release(const Key& key, se::DeviceMemoryBase buffer) {
+  {
+    tensorflow::mutex_lock lock(mu_);
+    auto it = buffers_.find(key);
+    if (it != buffers_.end() && it->second.expired()) {
+      buffers_.erase(it);
+    }
+  }
+  std::get<0>(key)->Deallocate(&buffer);
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,73 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_SHARED_CONSTANT_POOL_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_SHARED_CONSTANT_POOL_H_
+
+#include <map>
+#include <memory>
+#include <tuple>
+
+#include "tensorflow/compiler/xla/literal.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace xla {
+namespace gpu {
+
+// A pool of the device buffers holding the constants of GPU executables which
+// are not emitted into their LLVM IR. Executables compiled from the same model,
+// e.g. for different argument shapes, often have the same large constants, so
+// the buffers are deduplicated by device and contents, and shared by all the
+// executables using them.
+//
+// This class is thread-safe.
+class SharedConstantPool {
+ public:
+  // Returns the process-wide pool.
+  static SharedConstantPool* Get();
+
+  using Buffer = std::shared_ptr<const se::DeviceMemoryBase>;
+
+  // Returns a buffer on `executor` holding the contents of `literal`, which is
+  // allocated and copied to the device unless the pool already holds such a
+  // buffer. The buffer is deallocated once the last copy of the returned
+  // pointer is destroyed.
+  StatusOr<Buffer> GetOrCreate(se::StreamExecutor* executor,
+                               const Literal& literal);
+
+  // Returns the number of buffers in the pool.
+  int64 size() const;
+
+ private:
+  // The device, the 128-bit fingerprint of the contents and their size.
+  using Key = std::tuple<se::StreamExecutor*, uint64, uint64, int64>;
+
+  // Deallocates `buffer`, and removes it from the pool unless another buffer
+  // has been pooled under `key` since its last user released it.
+  void Release(const Key& key, se::DeviceMemoryBase buffer);
+
+  mutable tensorflow::mutex mu_;
+  std::map<Key, std::weak_ptr<const se::DeviceMemoryBase>> buffers_
+      GUARDED_BY(mu_);
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_SHARED_CONSTANT_POOL_H_
@@ -0,0 +1,86 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/shared_constant_pool.h"
+
+#include <memory>
+
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+class SharedConstantPoolTest : public ::testing::Test {
+ protected:
+  SharedConstantPoolTest() {
+    se::Platform* platform =
+        se::MultiPlatformManager::PlatformWithName("Host").ConsumeValueOrDie();
+    executor_ = platform->ExecutorForDevice(0).ConsumeValueOrDie();
+  }
+
+  se::StreamExecutor* executor_;
+  SharedConstantPool pool_;
+};
+
+TEST_F(SharedConstantPoolTest, IdenticalConstantsShareABuffer) {
+  Literal literal = LiteralUtil::CreateR1<float>({1.0f, 2.0f, 3.0f});
+  Literal same_bytes = LiteralUtil::CreateR2<float>({{1.0f, 2.0f, 3.0f}});
+  TF_ASSERT_OK_AND_ASSIGN(SharedConstantPool::Buffer buffer,
+                          pool_.GetOrCreate(executor_, literal));
+  TF_ASSERT_OK_AND_ASSIGN(SharedConstantPool::Buffer shared,
+                          pool_.GetOrCreate(executor_, same_bytes));
+  EXPECT_EQ(buffer->opaque(), shared->opaque());
+  EXPECT_EQ(pool_.size(), 1);
+
+  float contents[3];
+  TF_ASSERT_OK(executor_->SynchronousMemcpyD2H(*buffer, sizeof(contents),
+                                               contents));
+  EXPECT_EQ(contents[0], 1.0f);
+  EXPECT_EQ(contents[1], 2.0f);
+  EXPECT_EQ(contents[2], 3.0f);
+}
+
+TEST_F(SharedConstantPoolTest, DifferentConstantsDoNotShareABuffer) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      SharedConstantPool::Buffer buffer,
+      pool_.GetOrCreate(executor_, LiteralUtil::CreateR1<float>({1.0f})));
+  TF_ASSERT_OK_AND_ASSIGN(
+      SharedConstantPool::Buffer other,
+      pool_.GetOrCreate(executor_, LiteralUtil::CreateR1<float>({2.0f})));
+  EXPECT_NE(buffer->opaque(), other->opaque());
+  EXPECT_EQ(pool_.size(), 2);
+}
+
+TEST_F(SharedConstantPoolTest, BufferIsReleasedWithItsLastUser) {
+  Literal literal = LiteralUtil::CreateR1<int32>({4, 5});
+  TF_ASSERT_OK_AND_ASSIGN(SharedConstantPool::Buffer buffer,
+                          pool_.GetOrCreate(executor_, literal));
+  SharedConstantPool::Buffer copy = buffer;
+  buffer.reset();
+  EXPECT_EQ(pool_.size(), 1);
+  copy.reset();
+  EXPECT_EQ(pool_.size(), 0);
+
+  TF_ASSERT_OK_AND_ASSIGN(buffer, pool_.GetOrCreate(executor_, literal));
+  EXPECT_EQ(pool_.size(), 1);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -15,12 +15,16 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/gpu/stream_assignment.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "tensorflow/compiler/xla/map_util.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_reachability.h"
+#include "tensorflow/compiler/xla/shape_util.h"
 
 namespace xla {
 namespace gpu {
@@ -58,14 +62,62 @@ inline bool IsStreamNumValid(int stream_num) {
   return stream_num != kInvalidStreamNum;
 }
 
+// Instructions whose estimated cost, in flops plus bytes accessed, is below
+// this don't get a stream of their own: the event synchronization with their
+// operands and users would cost more than running them concurrently saves.
+constexpr double kMinCostForSeparateStream = 1 << 20;
+
+// Returns true if `hlo` is a library call or copy that may be worth running on
+// a stream of its own.
+bool IsStreamCandidate(const HloInstruction& hlo) {
+  return IsCublasGemm(hlo) || IsMatrixMultiplication(hlo) ||
+         IsCustomCallToDnnConvolution(hlo) ||
+         hlo.opcode() == HloOpcode::kCopy;
+}
+
+// Returns the estimated cost of `hlo`, or 0 if `cost_analysis` is null.
+double EstimatedCost(const HloInstruction& hlo,
+                     const HloCostAnalysis* cost_analysis) {
+  if (cost_analysis == nullptr) {
+    return 0;
+  }
+  int64 flops = cost_analysis->flop_count(hlo);
+  int64 bytes_accessed = cost_analysis->bytes_accessed(hlo);
+  if (flops >= 0 && bytes_accessed >= 0) {
+    return flops + bytes_accessed;
+  }
+  // HloCostAnalysis doesn't know the cost of custom calls, which include the
+  // cuBLAS and cuDNN calls. Use the sizes of their operands and results.
+  int64 size = 0;
+  auto add_size = [&size](const Shape& shape) {
+    ShapeUtil::ForEachSubshape(
+        shape, [&size](const Shape& subshape, const ShapeIndex& /*index*/) {
+          if (subshape.IsArray()) {
+            size += ShapeUtil::ByteSizeOf(subshape);
+          }
+        });
+  };
+  add_size(hlo.shape());
+  for (const HloInstruction* operand : hlo.operands()) {
+    add_size(operand->shape());
+  }
+  return size;
+}
+
 // Returns which existing stream to assign to `hlo`, or -1 if a stream is not
 // needed. `stream_assignment` is the existing stream assignment for all
-// instructions topologically before `hlo`. `seen_gemms` contains all GEMMs that
-// are topologically before `hlo`.
+// instructions topologically before `hlo`, and `stream_costs` is the estimated
+// cost of the instructions assigned to each stream so far. `seen_candidates`
+// contains all instructions topologically before `hlo` that were considered
+// for a stream of their own. `communication_stream` is the stream reserved for
+// all-reduces, or -1 if there is none yet; no other instruction is put on it.
+// No more than `max_streams` streams besides it are used, if it is positive.
 int ComputeStreamToAssign(
     const HloInstruction& hlo, const StreamAssignment& stream_assignment,
     const HloReachabilityMap& reachability,
-    const std::vector<const HloInstruction*>& seen_gemms) {
+    const std::vector<const HloInstruction*>& seen_candidates,
+    const std::vector<double>& stream_costs, bool is_candidate,
+    int communication_stream, int max_streams) {
   if (hlo.opcode() == HloOpcode::kParameter ||
       hlo.opcode() == HloOpcode::kConstant) {
     // kParameter and kConstant do not need a thunk.
@@ -79,12 +131,14 @@ int ComputeStreamToAssign(
     return 0;
   }
 
-  if (!(IsCublasGemm(hlo) || IsMatrixMultiplication(hlo))) {
-    // If `hlo` is not implemented as a GEMM, keep it close to its operands to
-    // avoid excessive synchronization.
+  if (!is_candidate) {
+    // If `hlo` doesn't benefit from a stream of its own, keep it close to its
+    // operands to avoid excessive synchronization.
     int stream_num = -1;
     for (const auto* operand : hlo.operands()) {
-      if (stream_assignment.HasStreamAssigned(*operand)) {
+      if (stream_assignment.HasStreamAssigned(*operand) &&
+          stream_assignment.StreamNumberForHlo(*operand) !=
+              communication_stream) {
         stream_num = std::max(stream_num,
                               stream_assignment.StreamNumberForHlo(*operand));
       }
@@ -95,36 +149,64 @@ int ComputeStreamToAssign(
     return stream_num;
   }
 
-  // Assign different streams to concurrent GEMMs. The code below uses a
+  // Assign different streams to concurrent candidates. The code below uses a
   // greedy approach. First, we compute as forbidden_stream_numbers the
-  // streams assigned to GEMMs that are concurrent with `hlo`. Then, we assign
-  // `hlo` a different stream.
+  // streams assigned to candidates that are concurrent with `hlo`. Then, we
+  // assign `hlo` the least loaded of the other streams, or a new stream if
+  // there is none.
   absl::flat_hash_set<int> forbidden_stream_numbers;
-  for (const auto* seen_gemm : seen_gemms) {
-    int stream_num = stream_assignment.StreamNumberForHlo(*seen_gemm);
+  for (const auto* seen_candidate : seen_candidates) {
+    int stream_num = stream_assignment.StreamNumberForHlo(*seen_candidate);
     if (!forbidden_stream_numbers.contains(stream_num) &&
-        CanRunConcurrently(*seen_gemm, hlo, reachability)) {
+        CanRunConcurrently(*seen_candidate, hlo, reachability)) {
       forbidden_stream_numbers.insert(stream_num);
     }
   }
 
+  int best_stream_num = kInvalidStreamNum;
   for (int stream_num = 0; stream_num < stream_assignment.StreamCount();
        ++stream_num) {
-    if (!forbidden_stream_numbers.contains(stream_num)) {
-      return stream_num;
+    if (stream_num != communication_stream &&
+        !forbidden_stream_numbers.contains(stream_num) &&
+        (!IsStreamNumValid(best_stream_num) ||
+         stream_costs[stream_num] < stream_costs[best_stream_num])) {
+      best_stream_num = stream_num;
     }
   }
-  return stream_assignment.StreamCount();
+  if (IsStreamNumValid(best_stream_num)) {
+    return best_stream_num;
+  }
+  const int compute_stream_count =
+      stream_assignment.StreamCount() -
+      (IsStreamNumValid(communication_stream) ? 1 : 0);
+  if (max_streams <= 0 || compute_stream_count < max_streams) {
+    return stream_assignment.StreamCount();
+  }
+  // Every stream is busy with a concurrent candidate and no new stream may be
+  // created, so share the least loaded one.
+  for (int stream_num = 0; stream_num < stream_assignment.StreamCount();
+       ++stream_num) {
+    if (stream_num != communication_stream &&
+        (!IsStreamNumValid(best_stream_num) ||
+         stream_costs[stream_num] < stream_costs[best_stream_num])) {
+      best_stream_num = stream_num;
+    }
+  }
+  return best_stream_num;
 }
 
 }  // namespace
 
-std::unique_ptr<StreamAssignment> AssignStreams(const HloModule& module) {
+std::unique_ptr<StreamAssignment> AssignStreams(
+    const HloModule& module, const HloCostAnalysis* cost_analysis) {
   auto stream_assignment = absl::make_unique<StreamAssignment>();
   const HloComputation& computation = *module.entry_computation();
   std::unique_ptr<HloReachabilityMap> reachability =
       HloReachabilityMap::Build(&computation);
-  std::vector<const HloInstruction*> seen_gemms;
+  const int max_streams =
+      module.config().debug_options().xla_gpu_max_streams();
+  std::vector<const HloInstruction*> seen_candidates;
+  std::vector<double> stream_costs;
   // The execution of different RNG Hlo instructions in the same module updates
   // a common global variable. To avoid a race condition, we simply assign all
   // RNG kernels to the same stream to make them run sequentially.
@@ -132,23 +214,45 @@ std::unique_ptr<StreamAssignment> AssignStreams(const HloModule& module) {
   // TODO(b/111791052): If we remove such a common variable, we will need to
   // clean up the code here.
   int stream_num_for_rng = kInvalidStreamNum;
+  // All-reduces run on a stream of their own, in program order, so that the
+  // kernels computing other values don't wait for the communication. Their
+  // users wait for them through the cross-stream dependencies of the thunk
+  // schedule.
+  const bool async_all_reduce =
+      !module.config().debug_options().xla_gpu_disable_multi_streaming();
+  int communication_stream = kInvalidStreamNum;
   for (const auto* hlo : computation.MakeInstructionPostOrder()) {
     // If we ever enable fusion of RNG instructions, we will need to extend this
     // code to look inside a fused instruction.
-    int stream_num = (hlo->opcode() == HloOpcode::kRng &&
-                      IsStreamNumValid(stream_num_for_rng))
-                         ? stream_num_for_rng
-                         : ComputeStreamToAssign(*hlo, *stream_assignment,
-                                                 *reachability, seen_gemms);
+    double cost = EstimatedCost(*hlo, cost_analysis);
+    bool is_candidate =
+        IsStreamCandidate(*hlo) &&
+        (cost_analysis == nullptr || cost >= kMinCostForSeparateStream);
+    int stream_num;
+    if (hlo->opcode() == HloOpcode::kRng &&
+        IsStreamNumValid(stream_num_for_rng)) {
+      stream_num = stream_num_for_rng;
+    } else if (hlo->opcode() == HloOpcode::kAllReduce && async_all_reduce) {
+      if (!IsStreamNumValid(communication_stream)) {
+        communication_stream = stream_assignment->StreamCount();
+      }
+      stream_num = communication_stream;
+    } else {
+      stream_num = ComputeStreamToAssign(
+          *hlo, *stream_assignment, *reachability, seen_candidates,
+          stream_costs, is_candidate, communication_stream, max_streams);
+    }
     if (IsStreamNumValid(stream_num)) {
       stream_assignment->AssignStreamToHlo(hlo, stream_num);
+      stream_costs.resize(stream_assignment->StreamCount(), 0);
+      stream_costs[stream_num] += cost;
       if (hlo->opcode() == HloOpcode::kRng &&
           !IsStreamNumValid(stream_num_for_rng)) {
         stream_num_for_rng = stream_num;
       }
     }
-    if (IsCublasGemm(*hlo) || IsMatrixMultiplication(*hlo)) {
-      seen_gemms.push_back(hlo);
+    if (is_candidate) {
+      seen_candidates.push_back(hlo);
     }
   }
   return stream_assignment;
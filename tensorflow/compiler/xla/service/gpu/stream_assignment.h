@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_STREAM_ASSIGNMENT_H_
 
 #include "absl/container/flat_hash_map.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 
@@ -37,8 +38,18 @@ class StreamAssignment {
   absl::flat_hash_map<const HloInstruction*, int> hlo_to_stream_number_;
 };
 
-// Assigns GPU streams to instructions in `module`.
-std::unique_ptr<StreamAssignment> AssignStreams(const HloModule& module);
+// Assigns GPU streams to instructions in `module`. Concurrent GEMMs,
+// convolutions and copies are spread over up to --xla_gpu_max_streams streams;
+// all-reduces share one more stream, so that computation independent of them
+// overlaps the communication; everything else runs on the stream of its
+// operands.
+//
+// If `cost_analysis` is not null, it must have been run on the entry
+// computation of `module`. It is used to keep instructions that are too cheap
+// to be worth the extra synchronization on the streams of their operands, and
+// to put each expensive instruction on the least loaded stream.
+std::unique_ptr<StreamAssignment> AssignStreams(
+    const HloModule& module, const HloCostAnalysis* cost_analysis = nullptr);
 
 }  // namespace gpu
 }  // namespace xla
@@ -24,22 +24,48 @@ limitations under the License.
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
 #include "tensorflow/compiler/xla/tests/test_utils.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 
 namespace xla {
 namespace gpu {
 
 class StreamAssignmentTest : public HloTestBase {
  protected:
-  std::unique_ptr<HloModule> CreateNewVerifiedModule() {
+  std::unique_ptr<HloModule> CreateNewVerifiedModule(int max_streams = 0) {
     HloModuleConfig config;
     auto debug_options = GetDebugOptionsForTest();
     debug_options.set_xla_gpu_disable_multi_streaming(false);
+    debug_options.set_xla_gpu_max_streams(max_streams);
     config.set_debug_options(debug_options);
     return absl::make_unique<HloModule>("test_module", config);
   }
 
+  // Builds an entry computation that adds the results of two concurrent dots
+  // of `shape`, and returns the two dots.
+  std::pair<HloInstruction*, HloInstruction*> AddConcurrentMatMuls(
+      HloModule* module, const Shape& shape) {
+    HloComputation::Builder builder("entry_computation");
+    HloInstruction* x = builder.AddInstruction(HloInstruction::CreateParameter(
+        /*parameter_number=*/0, shape, /*name=*/"x"));
+    HloInstruction* y = builder.AddInstruction(HloInstruction::CreateParameter(
+        /*parameter_number=*/1, shape, /*name=*/"y"));
+    HloInstruction* dot1 =
+        builder.AddInstruction(CreateCanonicalDot(shape, x, y));
+    HloInstruction* dot2 =
+        builder.AddInstruction(CreateCanonicalDot(shape, y, x));
+    HloInstruction* add = builder.AddInstruction(
+        HloInstruction::CreateBinary(shape, HloOpcode::kAdd, dot1, dot2));
+    module->AddEntryComputation(builder.Build(add));
+    return {dot1, dot2};
+  }
+
+  static int64 ShapeSize(const Shape& shape) {
+    return ShapeUtil::ByteSizeOf(shape, /*pointer_size=*/8);
+  }
+
   // Pre-canned shapes.
   Shape f32_2x2_ = ShapeUtil::MakeShape(F32, {2, 2});
+  Shape f32_512x512_ = ShapeUtil::MakeShape(F32, {512, 512});
 };
 
 TEST_F(StreamAssignmentTest, SequentialMatMul) {
@@ -139,5 +165,117 @@ TEST_F(StreamAssignmentTest, LatticeMatMul) {
             assignment->StreamNumberForHlo(*d31));
 }
 
+TEST_F(StreamAssignmentTest, ConcurrentCopies) {
+  HloComputation::Builder builder("entry_computation");
+  HloInstruction* x = builder.AddInstruction(HloInstruction::CreateParameter(
+      /*parameter_number=*/0, f32_512x512_, /*name=*/"x"));
+  HloInstruction* y = builder.AddInstruction(HloInstruction::CreateParameter(
+      /*parameter_number=*/1, f32_512x512_, /*name=*/"y"));
+  HloInstruction* copy1 = builder.AddInstruction(
+      HloInstruction::CreateUnary(f32_512x512_, HloOpcode::kCopy, x));
+  HloInstruction* copy2 = builder.AddInstruction(
+      HloInstruction::CreateUnary(f32_512x512_, HloOpcode::kCopy, y));
+  builder.AddInstruction(HloInstruction::CreateTuple({copy1, copy2}));
+
+  auto module = CreateNewVerifiedModule();
+  module->AddEntryComputation(builder.Build());
+
+  std::unique_ptr<StreamAssignment> assignment = AssignStreams(*module);
+  EXPECT_NE(assignment->StreamNumberForHlo(*copy1),
+            assignment->StreamNumberForHlo(*copy2));
+}
+
+TEST_F(StreamAssignmentTest, MaxStreams) {
+  HloComputation::Builder builder("entry_computation");
+  HloInstruction* x = builder.AddInstruction(HloInstruction::CreateParameter(
+      /*parameter_number=*/0, f32_2x2_, /*name=*/"x"));
+  HloInstruction* y = builder.AddInstruction(HloInstruction::CreateParameter(
+      /*parameter_number=*/1, f32_2x2_, /*name=*/"y"));
+  std::vector<HloInstruction*> dots;
+  for (int i = 0; i < 4; ++i) {
+    dots.push_back(builder.AddInstruction(
+        CreateCanonicalDot(f32_2x2_, i % 2 ? x : y, i / 2 ? x : y)));
+  }
+  builder.AddInstruction(HloInstruction::CreateTuple(dots));
+
+  auto module = CreateNewVerifiedModule(/*max_streams=*/2);
+  module->AddEntryComputation(builder.Build());
+
+  std::unique_ptr<StreamAssignment> assignment = AssignStreams(*module);
+  EXPECT_EQ(assignment->StreamCount(), 2);
+  EXPECT_NE(assignment->StreamNumberForHlo(*dots[0]),
+            assignment->StreamNumberForHlo(*dots[1]));
+}
+
+TEST_F(StreamAssignmentTest, CostAnalysisKeepsCheapMatMulsTogether) {
+  auto module = CreateNewVerifiedModule();
+  HloInstruction* dot1;
+  HloInstruction* dot2;
+  std::tie(dot1, dot2) = AddConcurrentMatMuls(module.get(), f32_2x2_);
+  HloCostAnalysis cost_analysis(ShapeSize);
+  TF_ASSERT_OK(module->entry_computation()->Accept(&cost_analysis));
+
+  std::unique_ptr<StreamAssignment> assignment =
+      AssignStreams(*module, &cost_analysis);
+  EXPECT_EQ(assignment->StreamNumberForHlo(*dot1),
+            assignment->StreamNumberForHlo(*dot2));
+}
+
+TEST_F(StreamAssignmentTest, CostAnalysisSplitsExpensiveMatMuls) {
+  auto module = CreateNewVerifiedModule();
+  HloInstruction* dot1;
+  HloInstruction* dot2;
+  std::tie(dot1, dot2) = AddConcurrentMatMuls(module.get(), f32_512x512_);
+  HloCostAnalysis cost_analysis(ShapeSize);
+  TF_ASSERT_OK(module->entry_computation()->Accept(&cost_analysis));
+
+  std::unique_ptr<StreamAssignment> assignment =
+      AssignStreams(*module, &cost_analysis);
+  EXPECT_NE(assignment->StreamNumberForHlo(*dot1),
+            assignment->StreamNumberForHlo(*dot2));
+}
+
+TEST_F(StreamAssignmentTest, AllReducesRunOnCommunicationStream) {
+  const char* const kModuleStr = R"(
+HloModule m
+
+sum {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT add = f32[] add(a, b)
+}
+
+ENTRY entry {
+  p0 = f32[2,2] parameter(0)
+  p1 = f32[2,2] parameter(1)
+  ar0 = f32[2,2] all-reduce(p0), replica_groups={}, to_apply=sum
+  dot = f32[2,2] dot(p1, p1), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+  ar1 = f32[2,2] all-reduce(dot), replica_groups={}, to_apply=sum
+  add = f32[2,2] add(ar0, dot)
+  ROOT tuple = (f32[2,2], f32[2,2]) tuple(ar1, add)
+}
+)";
+  HloModuleConfig config;
+  auto debug_options = GetDebugOptionsForTest();
+  debug_options.set_xla_gpu_disable_multi_streaming(false);
+  config.set_debug_options(debug_options);
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kModuleStr, config));
+
+  std::unique_ptr<StreamAssignment> assignment = AssignStreams(*module);
+  const HloInstruction* ar0 = FindInstruction(module.get(), "ar0");
+  const HloInstruction* ar1 = FindInstruction(module.get(), "ar1");
+  const HloInstruction* dot = FindInstruction(module.get(), "dot");
+  const HloInstruction* add = FindInstruction(module.get(), "add");
+  EXPECT_EQ(assignment->StreamNumberForHlo(*ar0),
+            assignment->StreamNumberForHlo(*ar1));
+  EXPECT_NE(assignment->StreamNumberForHlo(*ar0),
+            assignment->StreamNumberForHlo(*dot));
+  // Users of all-reduces stay off the communication stream.
+  EXPECT_EQ(assignment->StreamNumberForHlo(*add),
+            assignment->StreamNumberForHlo(*dot));
+}
+
 }  // namespace gpu
 }  // namespace xla
@@ -121,10 +121,16 @@ StatusOr<bool> HloConstantFolding::Run(HloModule* module) {
       // Don't constant fold unless it's a net positive or the output is small.
       if (instruction->shape().IsArray()) {
         int64 elements_in_removed_operands = 0;
+        int64 elements_in_operands = 0;
         for (HloInstruction* operand : instruction->operands()) {
-          if (operand->user_count() == 1 && operand->shape().IsArray()) {
-            elements_in_removed_operands +=
-                ShapeUtil::ElementsIn(operand->shape());
+          if (!operand->shape().IsArray()) {
+            continue;
+          }
+          const int64 elements_in_operand =
+              ShapeUtil::ElementsIn(operand->shape());
+          elements_in_operands += elements_in_operand;
+          if (operand->user_count() == 1) {
+            elements_in_removed_operands += elements_in_operand;
           }
         }
         int64 elements_in_constant =
@@ -135,6 +141,16 @@ StatusOr<bool> HloConstantFolding::Run(HloModule* module) {
             elements_in_constant > kMaximumConstantSizeElements) {
           continue;
         }
+
+        // Evaluation time grows with the number of elements read and written.
+        // Past this point folding costs more compile time than it saves.
+        static const int64 kMaximumEvaluatedElements = 100 * 1000 * 1000;
+        if (elements_in_constant + elements_in_operands >
+            kMaximumEvaluatedElements) {
+          VLOG(2) << "Not folding large instruction: "
+                  << instruction->ToString();
+          continue;
+        }
       }
 
       Literal result;
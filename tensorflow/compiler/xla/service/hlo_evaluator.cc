@@ -28,6 +28,7 @@ limitations under the License.
 #include "absl/container/inlined_vector.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 #include "absl/types/span.h"
 #include "tensorflow/compiler/xla/index_util.h"
 #include "tensorflow/compiler/xla/layout_util.h"
@@ -168,8 +169,119 @@ StatusOr<Literal> Compare<complex128>(const Shape& shape,
   return std::move(result);
 }
 
+// Returns, for each dimension of the dense array `shape`, how many elements
+// apart neighbouring indices along that dimension are in its buffer.
+std::vector<int64> DenseStrides(const Shape& shape) {
+  std::vector<int64> strides(shape.rank());
+  int64 stride = 1;
+  for (int64 dim : LayoutUtil::MinorToMajor(shape)) {
+    strides[dim] = stride;
+    stride *= shape.dimensions(dim);
+  }
+  return strides;
+}
+
+// Visits the elements of the dense array `shape` in buffer order and calls
+// `fn(position, offset)` with each element's position in the buffer and the
+// dot product of its index with `strides`. The offset is maintained
+// incrementally, which avoids materializing a multi-dimensional index per
+// element.
+template <typename Fn>
+void ForEachStridedOffset(const Shape& shape, absl::Span<const int64> strides,
+                          const Fn& fn) {
+  const int64 num_elements = ShapeUtil::ElementsIn(shape);
+  if (num_elements == 0) {
+    return;
+  }
+  absl::Span<const int64> minor_to_major = LayoutUtil::MinorToMajor(shape);
+  if (minor_to_major.empty()) {
+    fn(0, 0);
+    return;
+  }
+  const int64 minor_dim = minor_to_major[0];
+  const int64 minor_size = shape.dimensions(minor_dim);
+  const int64 minor_stride = strides[minor_dim];
+  std::vector<int64> index(shape.rank(), 0);
+  int64 offset = 0;
+  for (int64 position = 0; position < num_elements; position += minor_size) {
+    for (int64 i = 0; i < minor_size; ++i) {
+      fn(position + i, offset + i * minor_stride);
+    }
+    for (int64 k = 1; k < minor_to_major.size(); ++k) {
+      const int64 dim = minor_to_major[k];
+      offset += strides[dim];
+      if (++index[dim] < shape.dimensions(dim)) {
+        break;
+      }
+      offset -= index[dim] * strides[dim];
+      index[dim] = 0;
+    }
+  }
+}
+
+template <typename T>
+void GatherStrided(const LiteralBase& source,
+                   absl::Span<const int64> source_strides, Literal* result) {
+  const T* source_data = static_cast<const T*>(source.untyped_data());
+  T* result_data = static_cast<T*>(result->untyped_data());
+  ForEachStridedOffset(result->shape(), source_strides,
+                       [&](int64 position, int64 offset) {
+                         result_data[position] = source_data[offset];
+                       });
+}
+
+// Builds a literal of `result_shape` whose element at index `i` is the element
+// of `source` at buffer offset sum(i[d] * source_strides[d]). Broadcast and
+// transpose are both such gathers; doing them in bulk produces the result
+// directly in the requested layout.
+Literal GatherStrided(const LiteralBase& source,
+                      absl::Span<const int64> source_strides,
+                      const Shape& result_shape) {
+  Literal result(result_shape);
+  switch (ShapeUtil::ByteSizeOfPrimitiveType(result_shape.element_type())) {
+    case 1:
+      GatherStrided<uint8>(source, source_strides, &result);
+      break;
+    case 2:
+      GatherStrided<uint16>(source, source_strides, &result);
+      break;
+    case 4:
+      GatherStrided<uint32>(source, source_strides, &result);
+      break;
+    case 8:
+      GatherStrided<uint64>(source, source_strides, &result);
+      break;
+    case 16:
+      GatherStrided<complex128>(source, source_strides, &result);
+      break;
+    default:
+      LOG(FATAL) << "Unexpected element type "
+                 << PrimitiveType_Name(result_shape.element_type());
+  }
+  return result;
+}
+
+bool IsBulkGatherable(const Shape& source_shape, const Shape& result_shape) {
+  return LayoutUtil::IsDenseArray(source_shape) &&
+         LayoutUtil::IsDenseArray(result_shape) &&
+         source_shape.element_type() == result_shape.element_type();
+}
+
 }  // namespace
 
+/* static */ bool HloEvaluator::HaveSameDenseLayout(
+    const Literal& result, absl::Span<const Literal* const> operands) {
+  if (!LayoutUtil::IsDenseArray(result.shape())) {
+    return false;
+  }
+  return absl::c_all_of(operands, [&](const Literal* operand) {
+    return LayoutUtil::IsDenseArray(operand->shape()) &&
+           ShapeUtil::SameDimensions(operand->shape(), result.shape()) &&
+           Layout::Equal().MinorToMajorOnly()(operand->shape().layout(),
+                                              result.shape().layout());
+  });
+}
+
 // Note that unsupported types by the typed visitor does not necessarily imply
 // the non-typed HloEvaluator (parent evaluator) would not support them either
 // in the type-agnostic handler. For e.g., HandleGetTupleElement in the parent
@@ -458,8 +570,20 @@ Status HloEvaluator::HandleReshape(HloInstruction* reshape) {
 }
 
 Status HloEvaluator::HandleTranspose(HloInstruction* transpose) {
-  evaluated_[transpose] = GetEvaluatedLiteralFor(transpose->operand(0))
-                              .Transpose(transpose->dimensions());
+  const Literal& operand = GetEvaluatedLiteralFor(transpose->operand(0));
+  if (IsBulkGatherable(operand.shape(), transpose->shape())) {
+    // Dimension `i` of the result is dimension `permutation[i]` of the
+    // operand.
+    const std::vector<int64> operand_strides = DenseStrides(operand.shape());
+    std::vector<int64> source_strides(transpose->shape().rank());
+    for (int64 i = 0; i < source_strides.size(); ++i) {
+      source_strides[i] = operand_strides[transpose->dimensions(i)];
+    }
+    evaluated_[transpose] =
+        GatherStrided(operand, source_strides, transpose->shape());
+    return Status::OK();
+  }
+  evaluated_[transpose] = operand.Transpose(transpose->dimensions());
   return Status::OK();
 }
 
@@ -1808,6 +1932,19 @@ Status HloEvaluator::HandleBroadcast(HloInstruction* broadcast) {
         broadcast->ToString());
   }
 
+  if (IsBulkGatherable(operand.shape(), broadcast->shape())) {
+    // Dimensions of the result that don't come from the operand don't move
+    // the source offset.
+    const std::vector<int64> operand_strides = DenseStrides(operand.shape());
+    std::vector<int64> source_strides(broadcast->shape().rank(), 0);
+    for (int64 i = 0; i < broadcast->dimensions().size(); ++i) {
+      source_strides[broadcast->dimensions(i)] = operand_strides[i];
+    }
+    evaluated_[broadcast] =
+        GatherStrided(operand, source_strides, broadcast->shape());
+    return Status::OK();
+  }
+
   TF_ASSIGN_OR_RETURN(
       evaluated_[broadcast],
       operand.Broadcast(broadcast->shape(), broadcast->dimensions()));
@@ -2210,6 +2347,150 @@ Status HloEvaluator::HandleSort(HloInstruction* sort) {
   return Status::OK();
 }
 
+// Recognizes reducers of the form `ROOT op(parameter(0), parameter(1))` on
+// scalars with op add, maximum or minimum, which HandleReduce evaluates
+// without calling back into the evaluator. Sets `*accumulator_is_lhs` to
+// whether the accumulator (parameter 0) is the first operand of `op`.
+static absl::optional<HloOpcode> GetBulkReducerOpcode(
+    HloComputation* computation, bool* accumulator_is_lhs) {
+  const HloInstruction* root = computation->root_instruction();
+  if (computation->num_parameters() != 2 ||
+      (root->opcode() != HloOpcode::kAdd &&
+       root->opcode() != HloOpcode::kMaximum &&
+       root->opcode() != HloOpcode::kMinimum)) {
+    return absl::nullopt;
+  }
+  const HloInstruction* accumulator = computation->parameter_instruction(0);
+  const HloInstruction* value = computation->parameter_instruction(1);
+  if (root->operand(0) == accumulator && root->operand(1) == value) {
+    *accumulator_is_lhs = true;
+  } else if (root->operand(0) == value && root->operand(1) == accumulator) {
+    *accumulator_is_lhs = false;
+  } else {
+    return absl::nullopt;
+  }
+  // The slow path rejects reducers with invalid shapes when it evaluates
+  // them; keep rejecting them here.
+  for (const HloInstruction* instruction : {root, accumulator, value}) {
+    if (!ShapeUtil::IsScalar(instruction->shape()) ||
+        !ShapeUtil::ValidateShape(instruction->shape()).ok()) {
+      return absl::nullopt;
+    }
+  }
+  return root->opcode();
+}
+
+template <typename T>
+static bool IsNanValue(T value) {
+  return std::is_floating_point<T>::value &&
+         std::isnan(static_cast<double>(value));
+}
+
+template <typename T>
+static T ReduceMaximum(T lhs, T rhs) {
+  // Matches HloEvaluatorTypedVisitor::HandleMaximum, including NaN handling.
+  return ((lhs >= rhs) || IsNanValue(lhs)) ? lhs : rhs;
+}
+
+template <typename T>
+static T ReduceMinimum(T lhs, T rhs) {
+  return ((lhs <= rhs) || IsNanValue(lhs)) ? lhs : rhs;
+}
+
+// Floating-point sums are accumulated in double; integer sums wrap around, as
+// they do in the typed visitor.
+template <typename T, typename Enable = void>
+struct BulkSumType {
+  using type = double;
+};
+
+template <typename T>
+struct BulkSumType<T,
+                   typename std::enable_if<std::is_integral<T>::value>::type> {
+  using type = typename std::make_unsigned<T>::type;
+};
+
+// Reduces `input` into `result` in a single pass over the input buffer.
+// `output_strides` maps each input dimension to its stride in `result`, zero
+// for reduced dimensions. Every output element sees its inputs in the same
+// order as in the element-by-element path, and floating-point sums are
+// accumulated in double as there, so the results are identical.
+template <typename T>
+static void BulkReduce(HloOpcode opcode, bool accumulator_is_lhs,
+                       const Literal& input, T init,
+                       absl::Span<const int64> output_strides,
+                       Literal* result) {
+  absl::Span<const T> input_data = input.data<T>();
+  absl::Span<T> result_data = result->data<T>();
+  if (opcode == HloOpcode::kAdd) {
+    using AccumT = typename BulkSumType<T>::type;
+    std::vector<AccumT> sums(result_data.size(), static_cast<AccumT>(init));
+    ForEachStridedOffset(input.shape(), output_strides,
+                         [&](int64 position, int64 offset) {
+                           sums[offset] += static_cast<AccumT>(
+                               input_data[position]);
+                         });
+    for (int64 i = 0; i < result_data.size(); ++i) {
+      result_data[i] = static_cast<T>(sums[i]);
+    }
+    return;
+  }
+  T (*op)(T, T) =
+      opcode == HloOpcode::kMaximum ? &ReduceMaximum<T> : &ReduceMinimum<T>;
+  std::fill(result_data.begin(), result_data.end(), init);
+  ForEachStridedOffset(input.shape(), output_strides,
+                       [&](int64 position, int64 offset) {
+                         T& accumulator = result_data[offset];
+                         accumulator =
+                             accumulator_is_lhs
+                                 ? op(accumulator, input_data[position])
+                                 : op(input_data[position], accumulator);
+                       });
+}
+
+// Runs BulkReduce if the reduction qualifies for it and returns whether it
+// did.
+static bool TryBulkReduce(HloComputation* function, const Literal& input,
+                          const Literal& init,
+                          absl::Span<const int64> result_to_arg_index,
+                          Literal* result) {
+  bool accumulator_is_lhs;
+  absl::optional<HloOpcode> opcode =
+      GetBulkReducerOpcode(function, &accumulator_is_lhs);
+  if (!opcode || !LayoutUtil::IsDenseArray(input.shape()) ||
+      !LayoutUtil::IsDenseArray(result->shape()) ||
+      input.shape().element_type() != init.shape().element_type() ||
+      input.shape().element_type() != result->shape().element_type()) {
+    return false;
+  }
+  const std::vector<int64> result_strides = DenseStrides(result->shape());
+  std::vector<int64> output_strides(input.shape().rank(), 0);
+  for (int64 i = 0; i < result_to_arg_index.size(); ++i) {
+    output_strides[result_to_arg_index[i]] = result_strides[i];
+  }
+  switch (input.shape().element_type()) {
+#define BULK_REDUCE_CASE(type, native_type)                                   \
+  case type:                                                                  \
+    BulkReduce<native_type>(*opcode, accumulator_is_lhs, input,               \
+                            init.GetFirstElement<native_type>(),              \
+                            output_strides, result);                          \
+    return true;
+    BULK_REDUCE_CASE(S8, int8)
+    BULK_REDUCE_CASE(S16, int16)
+    BULK_REDUCE_CASE(S32, int32)
+    BULK_REDUCE_CASE(S64, int64)
+    BULK_REDUCE_CASE(U8, uint8)
+    BULK_REDUCE_CASE(U16, uint16)
+    BULK_REDUCE_CASE(U32, uint32)
+    BULK_REDUCE_CASE(U64, uint64)
+    BULK_REDUCE_CASE(F32, float)
+    BULK_REDUCE_CASE(F64, double)
+#undef BULK_REDUCE_CASE
+    default:
+      return false;
+  }
+}
+
 static bool IsScalarAdd(HloComputation* computation) {
   HloInstruction* instruction = computation->root_instruction();
   if (instruction->opcode() == HloOpcode::kAdd &&
@@ -2403,13 +2684,16 @@ Status HloEvaluator::HandleReduce(HloInstruction* instr) {
     results[i] = Literal(is_tuple ? out_shape.tuple_shapes(i) : out_shape);
   }
 
-  TF_RETURN_IF_ERROR(ShapeUtil::ForEachIndexWithStatus(
-      output_shape, [&](absl::Span<const int64> output_index) {
-        return GenerateReduceOutputElement(
-            output_index, init_values, input_args, absl::Span<Literal>(results),
-            function, &embedded_evaluator, arg_dim_steps, arg_dim_counts,
-            result_to_arg_index);
-      }));
+  if (is_tuple || !TryBulkReduce(function, *input_args[0], *init_values[0],
+                                 result_to_arg_index, &results[0])) {
+    TF_RETURN_IF_ERROR(ShapeUtil::ForEachIndexWithStatus(
+        output_shape, [&](absl::Span<const int64> output_index) {
+          return GenerateReduceOutputElement(
+              output_index, init_values, input_args,
+              absl::Span<Literal>(results), function, &embedded_evaluator,
+              arg_dim_steps, arg_dim_counts, result_to_arg_index);
+        }));
+  }
 
   if (is_tuple) {
     Literal tuple_result(inferred_return_shape);
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/compiler/xla/service/hlo_evaluator.h"
 
+#include <cmath>
 #include <initializer_list>
 #include <memory>
 #include <string>
@@ -4426,5 +4427,71 @@ TEST_F(HloEvaluatorTest, ZeroSizedIotaWithHugeDimension) {
   EXPECT_THAT(actual_literal.data<float>(), ::testing::IsEmpty());
 }
 
+// Transpose and broadcast write their results directly in the layout of the
+// instruction.
+TEST_F(HloEvaluatorTest, TransposeAndBroadcastIntoNonDefaultLayouts) {
+  constexpr absl::string_view hlo_text = R"(
+  HloModule test
+
+  ENTRY t {
+    c = s32[2,3]{1,0} constant({{1, 2, 3}, {4, 5, 6}})
+    transpose = s32[3,2]{0,1} transpose(c), dimensions={1,0}
+    v = s32[3]{0} constant({7, 8, 9})
+    broadcast = s32[3,2,2]{0,2,1} broadcast(v), dimensions={0}
+    ROOT tuple = (s32[3,2]{0,1}, s32[3,2,2]{0,2,1}) tuple(transpose, broadcast)
+  })";
+
+  TF_ASSERT_OK_AND_ASSIGN(m_, ParseAndReturnVerifiedModule(hlo_text));
+  TF_ASSERT_OK_AND_ASSIGN(
+      Literal actual_literal,
+      HloEvaluator().Evaluate(*m_->entry_computation(), {}));
+  std::vector<Literal> results = actual_literal.DecomposeTuple();
+  EXPECT_TRUE(LiteralTestUtil::Equal(
+      LiteralUtil::CreateR2<int32>({{1, 4}, {2, 5}, {3, 6}}), results[0]));
+  EXPECT_TRUE(LiteralTestUtil::Equal(
+      LiteralUtil::CreateR3<int32>(
+          {{{7, 7}, {7, 7}}, {{8, 8}, {8, 8}}, {{9, 9}, {9, 9}}}),
+      results[1]));
+}
+
+TEST_F(HloEvaluatorTest, ReduceWithSimpleReducers) {
+  constexpr absl::string_view hlo_text = R"(
+  HloModule test
+
+  max {
+    acc = f32[] parameter(0)
+    x = f32[] parameter(1)
+    ROOT max = f32[] maximum(x, acc)
+  }
+
+  add {
+    acc = s32[] parameter(0)
+    x = s32[] parameter(1)
+    ROOT add = s32[] add(acc, x)
+  }
+
+  ENTRY t {
+    f = f32[2,3]{0,1} constant({{1, nan, 3}, {4, 6, 5}})
+    f_init = f32[] constant(-inf)
+    row_max = f32[2]{0} reduce(f, f_init), dimensions={1}, to_apply=max
+    s = s32[2,3]{0,1} constant({{1, 2, 3}, {4, 5, 2147483647}})
+    s_init = s32[] constant(10)
+    column_sum = s32[3]{0} reduce(s, s_init), dimensions={0}, to_apply=add
+    ROOT tuple = (f32[2]{0}, s32[3]{0}) tuple(row_max, column_sum)
+  })";
+
+  TF_ASSERT_OK_AND_ASSIGN(m_, ParseAndReturnVerifiedModule(hlo_text));
+  TF_ASSERT_OK_AND_ASSIGN(
+      Literal actual_literal,
+      HloEvaluator().Evaluate(*m_->entry_computation(), {}));
+  std::vector<Literal> results = actual_literal.DecomposeTuple();
+  // The NaN propagates because maximum keeps a NaN left operand.
+  EXPECT_TRUE(std::isnan(results[0].Get<float>({0})));
+  EXPECT_EQ(results[0].Get<float>({1}), 6);
+  // Integer sums wrap around.
+  EXPECT_TRUE(LiteralTestUtil::Equal(
+      LiteralUtil::CreateR1<int32>({15, 17, -2147483636}), results[1]));
+}
+
 }  // namespace
 }  // namespace xla
@@ -63,11 +63,18 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
     MaybeDumpHlo(*hlo,
                  /*after_pass_name=*/last_pass_name,
                  /*before_pass_name=*/pass_name);
+    int64 instructions_before = 0;
     if (!pass->IsPassPipeline()) {
       compilation_stats_->StartPass(pass_name);
+      instructions_before = InstructionCount(*hlo);
     }
     TF_ASSIGN_OR_RETURN(bool pass_changed, RunHelper(pass, hlo));
     changed |= pass_changed;
+    if (!pass->IsPassPipeline()) {
+      compilation_stats_->RecordPassResult(pass_name, instructions_before,
+                                           InstructionCount(*hlo),
+                                           pass_changed);
+    }
     TF_RETURN_IF_ERROR(RunInvariantCheckers(hlo, pass_name));
     last_pass_name = string(pass_name);
     if (!pass->IsPassPipeline()) {
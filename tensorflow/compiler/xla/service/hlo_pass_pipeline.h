@@ -110,6 +110,16 @@ class HloPassPipeline : public HloPassInterface {
                                   HloModuleGroup* module_group) {
     return pass->RunOnModuleGroup(module_group);
   }
+  static int64 InstructionCount(const HloModule& module) {
+    return module.instruction_count();
+  }
+  static int64 InstructionCount(const HloModuleGroup& module_group) {
+    int64 count = 0;
+    for (const HloModule* module : module_group.modules()) {
+      count += module->instruction_count();
+    }
+    return count;
+  }
 
   const string name_;
   std::vector<std::unique_ptr<HloPassInterface>> passes_;
@@ -15,13 +15,20 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
 
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/service/algebraic_simplifier.h"
+#include "tensorflow/compiler/xla/service/compilation_stats.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_cse.h"
+#include "tensorflow/compiler/xla/service/hlo_dce.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/service/hlo_parser.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_fix.h"
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace xla {
 namespace {
@@ -255,5 +262,154 @@ ENTRY main {
       ::testing::HasSubstr("Module group pass cannot be run on a module"));
 }
 
+TEST_F(HloPassPipelineTest, CompilationStats) {
+  // Test that the pipeline reports each pass run to its CompilationStats.
+  const string module_str = R"(
+HloModule CompilationStats
+
+ENTRY main {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  dead = f32[] add(a, b)
+  ROOT foo = f32[] multiply(a, b)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerifiedHloModule> module,
+                          ParseAndReturnVerifiedModule(module_str));
+  std::unique_ptr<CompilationStats> stats = CompilationStats::MakeStats();
+  HloPassPipeline pipeline(TestName(), stats.get());
+  pipeline.AddPass<FooToBarModulePass>();
+  pipeline.AddPass<HloDCE>();
+  pipeline.AddPass<FooToBarModulePass>();
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, pipeline.Run(module.get()));
+  EXPECT_TRUE(changed);
+
+  std::vector<CompilationStats::PassSummary> summaries =
+      stats->GetPassSummaries();
+  ASSERT_EQ(summaries.size(), 2);
+  for (const CompilationStats::PassSummary& summary : summaries) {
+    if (summary.name == "foo2bar") {
+      EXPECT_EQ(summary.num_runs, 2);
+      EXPECT_EQ(summary.num_changed_runs, 1);
+      EXPECT_EQ(summary.instruction_delta, 0);
+    } else {
+      EXPECT_EQ(summary.name, "dce");
+      EXPECT_EQ(summary.num_runs, 1);
+      EXPECT_EQ(summary.num_changed_runs, 1);
+      EXPECT_EQ(summary.instruction_delta, -1);
+    }
+  }
+}
+
+// Representative modules whose compile time BM_SimplificationPipeline tracks.
+const char* const kBenchmarkCorpus[] = {
+    R"(
+HloModule ElementwiseChain
+
+ENTRY main {
+  p0 = f32[128,128] parameter(0)
+  p1 = f32[128,128] parameter(1)
+  zero = f32[] constant(0)
+  one = f32[] constant(1)
+  zeros = f32[128,128] broadcast(zero), dimensions={}
+  ones = f32[128,128] broadcast(one), dimensions={}
+  add0 = f32[128,128] add(p0, zeros)
+  mul0 = f32[128,128] multiply(add0, ones)
+  add1 = f32[128,128] add(p0, p1)
+  add2 = f32[128,128] add(p0, p1)
+  sub = f32[128,128] subtract(add1, add2)
+  neg0 = f32[128,128] negate(mul0)
+  neg1 = f32[128,128] negate(neg0)
+  ROOT out = f32[128,128] add(neg1, sub)
+}
+)",
+    R"(
+HloModule DotReduce
+
+add_f32 {
+  x = f32[] parameter(0)
+  y = f32[] parameter(1)
+  ROOT sum = f32[] add(x, y)
+}
+
+ENTRY main {
+  a = f32[64,32] parameter(0)
+  b = f32[32,16] parameter(1)
+  dot = f32[64,16] dot(a, b), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  t0 = f32[16,64] transpose(dot), dimensions={1,0}
+  t1 = f32[64,16] transpose(t0), dimensions={1,0}
+  zero = f32[] constant(0)
+  ROOT reduce = f32[64] reduce(t1, zero), dimensions={1}, to_apply=add_f32
+}
+)",
+    R"(
+HloModule CountedLoop
+
+cond {
+  state = (s32[], f32[8]) parameter(0)
+  i = s32[] get-tuple-element(state), index=0
+  limit = s32[] constant(10)
+  ROOT lt = pred[] compare(i, limit), direction=LT
+}
+
+body {
+  state = (s32[], f32[8]) parameter(0)
+  i = s32[] get-tuple-element(state), index=0
+  v = f32[8] get-tuple-element(state), index=1
+  one = s32[] constant(1)
+  next_i = s32[] add(i, one)
+  two = f32[] constant(2)
+  twos = f32[8] broadcast(two), dimensions={}
+  next_v = f32[8] multiply(v, twos)
+  ROOT next = (s32[], f32[8]) tuple(next_i, next_v)
+}
+
+ENTRY main {
+  v = f32[8] parameter(0)
+  zero = s32[] constant(0)
+  init = (s32[], f32[8]) tuple(zero, v)
+  loop = (s32[], f32[8]) while(init), condition=cond, body=body
+  ROOT result = f32[8] get-tuple-element(loop), index=1
+}
+)",
+};
+
+void BM_SimplificationPipeline(int num_iters, int corpus_index) {
+  // Runs a simplification pipeline to a fixed point on one corpus module.
+  tensorflow::testing::StopTiming();
+  std::unique_ptr<CompilationStats> stats = CompilationStats::MakeStats();
+  int64 num_instructions = 0;
+  for (int i = 0; i < num_iters; ++i) {
+    std::unique_ptr<HloModule> module =
+        ParseAndReturnUnverifiedModule(kBenchmarkCorpus[corpus_index])
+            .ConsumeValueOrDie();
+    num_instructions += module->instruction_count();
+    HloPassPipeline pipeline("BM_SimplificationPipeline", stats.get());
+    HloPassPipeline& simplification =
+        pipeline.AddPass<HloPassFix<HloPassPipeline>>("simplification",
+                                                       stats.get());
+    simplification.AddPass<AlgebraicSimplifier>(AlgebraicSimplifierOptions());
+    simplification.AddPass<HloCSE>(/*is_layout_sensitive=*/false);
+    simplification.AddPass<HloDCE>();
+
+    tensorflow::testing::StartTiming();
+    CHECK(pipeline.Run(module.get()).ok());
+    tensorflow::testing::StopTiming();
+  }
+  tensorflow::testing::ItemsProcessed(num_instructions);
+  // Per-pass run counts and HLO size changes, so that a compile time
+  // regression can be traced to the pass that caused it.
+  string label;
+  for (const CompilationStats::PassSummary& summary :
+       stats->GetPassSummaries()) {
+    absl::StrAppend(&label, summary.name, ":", summary.num_runs, "/",
+                    summary.num_changed_runs, "/", summary.instruction_delta,
+                    " ");
+  }
+  tensorflow::testing::SetLabel(label);
+}
+
+BENCHMARK(BM_SimplificationPipeline)->Arg(0)->Arg(1)->Arg(2);
+
 }  // namespace
 }  // namespace xla
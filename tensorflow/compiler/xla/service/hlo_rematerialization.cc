@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/buffer_value.h"
 #include "tensorflow/compiler/xla/service/flatten_call_graph.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/hlo_dce.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/hlo_memory_scheduler.h"
@@ -135,6 +136,11 @@ struct Item {
   // The buffers used by this instruction.
   BufferIdList buffers_used;
 
+  // Estimated work (flops, transcendentals and bytes accessed) to recompute
+  // this instruction, or -1 if not computed yet. Only used for cost-aware
+  // candidate selection.
+  int64 recompute_work = -1;
+
  private:
   friend class InstructionList;
 
@@ -380,8 +386,14 @@ class MemoryUsageTracker {
   // EndInstruction memory for dead operand(s) is freed.
   Status BeginInstruction(Item* item);
 
-  int64 RematerializationCost(const HloInstruction* instruction,
-                              int64 memory_reduced, int64 memory_limit_bytes) {
+  // Returns the cost of rematerializing the given item. By default this is
+  // the inverse of the benefit of rematerialization. With cost-aware selection
+  // it is the estimated work to recompute the instruction per byte saved, so
+  // that cheap recomputations are preferred.
+  double RematerializationCost(Item* item, int64 memory_reduced,
+                               int64 memory_limit_bytes,
+                               bool cost_aware_selection) {
+    const HloInstruction* instruction = item->instruction;
     // If none of the users of 'instruction' have been placed in the sequence
     // (as tracked by memory_tracker), then rematerialization of 'instruction'
     // is a zero-cost move of 'instruction' in the sequence.
@@ -392,10 +404,29 @@ class MemoryUsageTracker {
     }
 
     CHECK_GT(memory_reduced, 0);
+    if (cost_aware_selection) {
+      return static_cast<double>(RecomputeWork(item)) / memory_reduced;
+    }
     // Return the inverse of the benefit of rematerialization.
     return memory_limit_bytes / memory_reduced;
   }
 
+  // Returns the cost of compressing the given item into compact_shape. With
+  // cost-aware selection it is the number of bytes copied by the compressing
+  // and uncompressing copies per byte saved.
+  double CompressionCost(Item* item, const Shape& compact_shape,
+                         int64 memory_reduced, int64 memory_limit_bytes,
+                         bool cost_aware_selection) const {
+    CHECK_GT(memory_reduced, 0);
+    if (cost_aware_selection) {
+      const int64 bytes_copied =
+          2 * (size_function_(item->instruction->shape()) +
+               size_function_(compact_shape));
+      return static_cast<double>(bytes_copied) / memory_reduced;
+    }
+    return memory_limit_bytes / memory_reduced;
+  }
+
   // Finishes the placement of the current instruction. This frees any dead
   // operands or dead result of the instruction. This must be called after
   // each call to BeginInstruction.
@@ -423,9 +454,13 @@ class MemoryUsageTracker {
   // to uses).
   Status AddRematerializedInstruction(Item* original_item, Item* remat_item);
 
+  // Picks the candidate with the lowest rematerialization or compression
+  // cost. If cost_aware_selection is true, costs are estimated with
+  // HloCostAnalysis instead of only the number of bytes saved.
   std::pair<Item*, RematStrategy> PickRematerializationCandidate(
       const InstructionList& instruction_list, int64 memory_limit_bytes,
-      absl::flat_hash_map<const HloInstruction*, bool>* remat_able);
+      absl::flat_hash_map<const HloInstruction*, bool>* remat_able,
+      bool cost_aware_selection);
 
   // Returns whether the given instruction has been placed (BeginInstruction
   // has been called with 'instruction' as the argument).
@@ -484,6 +519,10 @@ class MemoryUsageTracker {
     }
   };
 
+  // Returns the estimated work to recompute the instruction of the given item.
+  // The result is cached in the item.
+  int64 RecomputeWork(Item* item) const;
+
   // Get the compact shape of given hlo instruction. An internal cache is used
   // to avoid computing the shape multiple times.
   StatusOr<Shape> GetCompactShape(const HloInstruction* hlo);
@@ -1021,6 +1060,33 @@ string MemoryUsageTracker::ToString() const {
   return output;
 }
 
+int64 MemoryUsageTracker::RecomputeWork(Item* item) const {
+  if (item->recompute_work >= 0) {
+    return item->recompute_work;
+  }
+  HloInstruction* instruction = item->instruction;
+  HloCostAnalysis cost_analysis(size_function_);
+  Status status = cost_analysis.Preprocess(instruction);
+  if (status.ok()) {
+    status = instruction->Visit(&cost_analysis);
+  }
+  if (status.ok()) {
+    status = cost_analysis.Postprocess(instruction);
+  }
+  if (status.ok()) {
+    item->recompute_work = cost_analysis.flop_count(*instruction) +
+                           cost_analysis.transcendental_count(*instruction) +
+                           cost_analysis.bytes_accessed(*instruction);
+  } else {
+    // Fall back to the size of the output if the cost analysis doesn't
+    // support the instruction.
+    VLOG(3) << "Unable to estimate the cost of " << instruction->name()
+            << ": " << status;
+    item->recompute_work = size_function_(instruction->shape());
+  }
+  return item->recompute_work;
+}
+
 StatusOr<Shape> MemoryUsageTracker::GetCompactShape(const HloInstruction* hlo) {
   auto it = compact_shape_.find(hlo);
   if (it != compact_shape_.end()) {
@@ -1121,9 +1187,10 @@ int64 RematerializationCost(const HloInstruction* instruction,
 std::pair<Item*, RematStrategy>
 MemoryUsageTracker::PickRematerializationCandidate(
     const InstructionList& instruction_list, int64 memory_limit_bytes,
-    absl::flat_hash_map<const HloInstruction*, bool>* remat_able) {
+    absl::flat_hash_map<const HloInstruction*, bool>* remat_able,
+    bool cost_aware_selection) {
   Item* best_item = nullptr;
-  int64 best_cost = 0;
+  double best_cost = 0;
   RematStrategy best_strategy;
 
   VLOG(5) << "Picking candidate";
@@ -1167,7 +1234,9 @@ MemoryUsageTracker::PickRematerializationCandidate(
           const int64 memory_reduced =
               MemoryReducedIfCompressed(item, compact_shape);
           if (memory_reduced > 0) {
-            const int64 cost = memory_limit_bytes / memory_reduced;
+            const double cost =
+                CompressionCost(item, compact_shape, memory_reduced,
+                                memory_limit_bytes, cost_aware_selection);
             if (best_item == nullptr || cost < best_cost) {
               VLOG(3) << "candidate " << candidate->name() << "("
                       << candidate->ToShortString() << ")"
@@ -1199,8 +1268,8 @@ MemoryUsageTracker::PickRematerializationCandidate(
     const int64 memory_reduced = MemoryReducedIfRematerialized(item);
 
     if (memory_reduced > 0) {
-      const int cost =
-          RematerializationCost(candidate, memory_reduced, memory_limit_bytes);
+      const double cost = RematerializationCost(
+          item, memory_reduced, memory_limit_bytes, cost_aware_selection);
 
       VLOG(5) << "candidate " << candidate->name() << ", memory reduced "
               << memory_reduced << ", cost per byte " << cost;
@@ -1457,6 +1526,11 @@ StatusOr<bool> HloRematerialization::RematerializeComputation(
     instruction_index++;
 
     while (memory_tracker.memory_usage() + callee_usage > memory_limit_bytes) {
+      if (CompileTimeBudgetExceeded()) {
+        VLOG(1) << "Compile-time budget exhausted at instruction "
+                << instruction->name() << ", stopping rematerialization.";
+        break;
+      }
       VLOG(2) << "Over memory limit at instruction " << instruction->name()
               << ", using "
               << HumanReadableNumBytes(memory_tracker.memory_usage() +
@@ -1467,7 +1541,8 @@ StatusOr<bool> HloRematerialization::RematerializeComputation(
       RematStrategy best_strategy;
       std::tie(best_item, best_strategy) =
           memory_tracker.PickRematerializationCandidate(
-              instruction_list, memory_limit_bytes, &remat_able);
+              instruction_list, memory_limit_bytes, &remat_able,
+              cost_aware_selection_);
 
       if (best_item == nullptr) {
         VLOG(3) << "Unable to find rematerialization candidate at program "
@@ -1514,7 +1589,8 @@ StatusOr<bool> HloRematerialization::RematerializeComputation(
     const CallSite* callsite = call_graph_node.GetCallSite(instruction);
     if (callsite != nullptr &&
         callsite->context() == CallContext::kSequential &&
-        memory_tracker.memory_usage() + callee_usage > memory_limit_bytes) {
+        memory_tracker.memory_usage() + callee_usage > memory_limit_bytes &&
+        !CompileTimeBudgetExceeded()) {
       // Memory usage exceeds the limit. Try to rematerialize any
       // subcomputation(s) that this instruction calls.
       VLOG(1) << "Memory usage still over the limit ("
@@ -1582,6 +1658,10 @@ StatusOr<bool> HloRematerialization::RematerializeComputation(
   return changed;
 }
 
+bool HloRematerialization::CompileTimeBudgetExceeded() const {
+  return absl::Now() >= deadline_;
+}
+
 StatusOr<bool> HloRematerialization::Run(HloModule* module) {
   VLOG(1) << "HloRematerialization() with memory limit of "
           << HumanReadableNumBytes(memory_limit_bytes_);
@@ -1592,6 +1672,7 @@ StatusOr<bool> HloRematerialization::Run(HloModule* module) {
   rematerialized_computations_.clear();
   instructions_rematerialized_ = 0;
   net_instructions_added_ = 0;
+  deadline_ = absl::Now() + max_compile_time_;
 
   TF_RET_CHECK(module->has_schedule());
   TF_ASSIGN_OR_RETURN(points_to_analysis_, TuplePointsToAnalysis::Run(module));
@@ -17,6 +17,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/time/time.h"
 #include "tensorflow/compiler/xla/service/call_graph.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
@@ -66,16 +67,29 @@ class HloRematerialization : public HloModulePass {
   //
   //   compact_shape_function: Function which returns the compact form of a
   //   shape. If nullptr is provided, an default identity function is used.
+  //
+  //   cost_aware_selection: If true, candidates are ranked by the work
+  //     estimated by HloCostAnalysis per byte saved (recompute flops and bytes,
+  //     or bytes copied for compression) instead of only the bytes saved, so
+  //     cheap recomputations are preferred over expensive ones.
+  //
+  //   max_compile_time: Upper bound on the time spent in Run(). Once exceeded,
+  //     no further instructions are rematerialized and the module is left
+  //     with whatever memory reduction was achieved so far.
   explicit HloRematerialization(
       const ShapeSizeFunction& size_function, int64 memory_limit_bytes,
       RematerializationSizes* sizes,
-      CompactShapeFunction compact_shape_function = nullptr)
+      CompactShapeFunction compact_shape_function = nullptr,
+      bool cost_aware_selection = false,
+      absl::Duration max_compile_time = absl::InfiniteDuration())
       : size_function_(size_function),
         memory_limit_bytes_(memory_limit_bytes),
         sizes_(sizes),
         compact_shape_function_(compact_shape_function == nullptr
                                     ? DefaultCompactShapeFunction
-                                    : std::move(compact_shape_function)) {}
+                                    : std::move(compact_shape_function)),
+        cost_aware_selection_(cost_aware_selection),
+        max_compile_time_(max_compile_time) {}
   ~HloRematerialization() override = default;
 
   absl::string_view name() const override { return "rematerialization"; }
@@ -109,6 +123,10 @@ class HloRematerialization : public HloModulePass {
   StatusOr<int64> CalledComputationsMemoryUsage(
       const HloInstruction* instruction) const;
 
+  // Returns true if the compile-time budget given by max_compile_time_ has
+  // been used up.
+  bool CompileTimeBudgetExceeded() const;
+
   // Selects an algorithm to use for HLO scheduling.
   MemorySchedulerAlgorithm scheduler_algorithm_;
 
@@ -127,6 +145,13 @@ class HloRematerialization : public HloModulePass {
   // already considered compact.
   const CompactShapeFunction compact_shape_function_;
 
+  // Whether to rank candidates using HloCostAnalysis estimates.
+  const bool cost_aware_selection_;
+
+  // The compile-time budget for Run() and the deadline derived from it.
+  const absl::Duration max_compile_time_;
+  absl::Time deadline_ = absl::InfiniteFuture();
+
   // Call graph of the hlo_module.
   std::unique_ptr<CallGraph> call_graph_;
 
@@ -40,15 +40,19 @@ using ::testing::_;
 // RematerializationTestBase for more.
 class HloRematerializationTest : public RematerializationTestBase {
  protected:
-  StatusOr<bool> RunHloRematerialization(int64 memory_limit_bytes,
-                                         HloModule* module) {
+  StatusOr<bool> RunHloRematerialization(
+      int64 memory_limit_bytes, HloModule* module,
+      bool cost_aware_selection = false,
+      absl::Duration max_compile_time = absl::InfiniteDuration()) {
     TF_EXPECT_OK(verifier().Run(module).status());
     HloMemoryScheduler scheduler(
         [](const BufferValue& buffer) { return ByteSizeOf(buffer.shape()); },
         ComputationSchedulerToModuleScheduler(DefaultMemoryScheduler));
     TF_EXPECT_OK(scheduler.Run(module).status());
     HloRematerialization remat(ByteSizeOf, memory_limit_bytes,
-                               /*sizes=*/nullptr);
+                               /*sizes=*/nullptr,
+                               /*compact_shape_function=*/nullptr,
+                               cost_aware_selection, max_compile_time);
     return remat.Run(module);
   }
 };
@@ -118,6 +122,46 @@ TEST_F(HloRematerializationTest, SingleComputationNoRematerialization) {
 // only one computation needs to have an instruction rematerialized. The entry
 // computation should be the one chosen because rematerialization in the while
 // will presumably be more expensive.
+// Test that cost-aware selection rematerializes the cheap broadcast in the
+// computation produced by MakeRematerializableComputation.
+TEST_F(HloRematerializationTest, SingleComputationCostAware) {
+  auto module = CreateNewVerifiedModule();
+  HloComputation* computation =
+      module->AddEntryComputation(MakeRematerializableComputation());
+
+  const HloInstruction* slice = computation->root_instruction();
+  ASSERT_THAT(slice, op::Slice(op::Concatenate(op::Broadcast(_), _)));
+  const HloInstruction* concat = slice->operand(0);
+  const HloInstruction* bcast = concat->operand(0);
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      bool changed,
+      RunHloRematerialization(/*memory_limit_bytes=*/14 * 1024, module.get(),
+                              /*cost_aware_selection=*/true));
+  EXPECT_TRUE(changed);
+
+  EXPECT_EQ(computation->root_instruction(), slice);
+  const HloInstruction* remat_bcast = concat->operand(0);
+  EXPECT_THAT(remat_bcast, op::Broadcast(::testing::Ne(bcast)));
+}
+
+// Test that no instructions are rematerialized once the compile-time budget is
+// used up.
+TEST_F(HloRematerializationTest, CompileTimeBudgetExceeded) {
+  auto module = CreateNewVerifiedModule();
+  HloComputation* computation =
+      module->AddEntryComputation(MakeRematerializableComputation());
+  const int64 instruction_count = computation->instruction_count();
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      bool changed,
+      RunHloRematerialization(/*memory_limit_bytes=*/14 * 1024, module.get(),
+                              /*cost_aware_selection=*/false,
+                              /*max_compile_time=*/absl::ZeroDuration()));
+  EXPECT_FALSE(changed);
+  EXPECT_EQ(computation->instruction_count(), instruction_count);
+}
+
 TEST_F(HloRematerializationTest, RematerializeAroundWhile) {
   auto module = CreateNewVerifiedModule();
 
@@ -55,6 +55,10 @@ HeapSimulator::Result AlternateMemoryBestFitHeap::Finish() {
 
   AddInputAndOutputRequiredAssignments();
 
+  if (enable_cross_program_prefetch_) {
+    AllocateCrossProgramPrefetchBuffer(sorted_buffer_intervals);
+  }
+
   for (auto& interval : sorted_buffer_intervals) {
     if (!interval.need_allocation) {
       continue;
@@ -156,6 +160,100 @@ HeapSimulator::Result AlternateMemoryBestFitHeap::Finish() {
   return result_;
 }
 
+bool AlternateMemoryBestFitHeap::IsCrossProgramPrefetchable(
+    const BufferInterval& interval) const {
+  const HloValue* value = interval.buffer;
+  const HloInstruction* defining_instruction = value->defining_instruction();
+  const HloComputation* entry_computation =
+      alias_analysis_.dataflow_analysis().module().entry_computation();
+  if (defining_instruction->opcode() != HloOpcode::kParameter ||
+      defining_instruction->parent() != entry_computation ||
+      !value->shape().IsArray() || value->live_out_of_module() ||
+      !interval.colocations.empty() || value->uses().empty()) {
+    return false;
+  }
+  // Outputs are pinned to the default memory at the root.
+  auto required_assignment_it = required_assignments_.find(value);
+  if (required_assignment_it != required_assignments_.end()) {
+    const int64 definition_time =
+        hlo_live_range_.instruction_schedule().at(defining_instruction);
+    for (const RequiredMemoryAssignment& required_assignment :
+         required_assignment_it->second) {
+      if (required_assignment.time != definition_time) {
+        return false;
+      }
+    }
+  }
+  return absl::c_all_of(value->uses(), [&](const HloUse& use) {
+    const HloInstruction* user = use.instruction;
+    return user->parent() == entry_computation &&
+           (user->opcode() == HloOpcode::kDot ||
+            user->opcode() == HloOpcode::kConvolution ||
+            user->opcode() == HloOpcode::kFusion);
+  });
+}
+
+void AlternateMemoryBestFitHeap::AllocateCrossProgramPrefetchBuffer(
+    const std::vector<BufferInterval>& sorted_buffer_intervals) {
+  const auto& instruction_schedule = hlo_live_range_.instruction_schedule();
+  // The intervals are sorted by decreasing size, so the first candidate that
+  // fits is the largest one.
+  for (const BufferInterval& interval : sorted_buffer_intervals) {
+    if (!interval.need_allocation || !IsCrossProgramPrefetchable(interval)) {
+      continue;
+    }
+    const HloValue* buffer = interval.buffer;
+    int64 parameter_time =
+        instruction_schedule.at(buffer->defining_instruction());
+    std::vector<HloUse> uses = buffer->uses();
+    absl::c_sort(uses, [&](HloUse use1, HloUse use2) {
+      return instruction_schedule.at(use1.instruction) <
+             instruction_schedule.at(use2.instruction);
+    });
+    int64 first_use_time = instruction_schedule.at(uses.front().instruction);
+    int64 last_use_time = instruction_schedule.at(uses.back().instruction);
+    if (ViolatesMaximumOutstandingAsyncCopies(parameter_time,
+                                              first_use_time)) {
+      VLOG(3) << "Cross-program prefetch would violate the outstanding async "
+                 "copy limit.";
+      return;
+    }
+
+    // Reserve the chunk until the end of the program so that the prefetched
+    // buffer isn't reused by other values and can remain resident for the
+    // next invocation.
+    BufferInterval prefetch_interval = interval;
+    prefetch_interval.start = parameter_time;
+    prefetch_interval.end = hlo_live_range_.schedule_end_time();
+    ChunkCandidate chunk_candidate = FindChunkCandidate(prefetch_interval);
+    if (chunk_candidate.heap_size >= max_size_in_bytes_) {
+      continue;
+    }
+    VLOG(3) << "Cross-program prefetching " << buffer->ToShortString()
+            << ". Offset = " << chunk_candidate.chunk.offset
+            << ", size = " << chunk_candidate.chunk.size;
+
+    MemorySpaceAssignment::AllocationSequence* allocations =
+        &(*allocation_map_)[buffer];
+    allocations->push_back(absl::make_unique<MemorySpaceAssignment::Allocation>(
+        buffer->defining_instruction(), buffer->defining_position(),
+        MemorySpace::kDefault, kDummyChunk, parameter_time, first_use_time));
+    AddToPendingChunks(prefetch_interval, chunk_candidate);
+    AddAsyncCopy(*allocations->back(), MemorySpace::kAlternate,
+                 chunk_candidate.chunk, parameter_time, first_use_time,
+                 allocations);
+    auto* prefetch = static_cast<MemorySpaceAssignment::CopyAllocation*>(
+        allocations->back().get());
+    prefetch->set_is_cross_program_prefetch();
+    prefetch->Extend(last_use_time);
+    for (HloUse use : uses) {
+      prefetch->AddUse(use);
+    }
+    CommitPendingChunks();
+    return;
+  }
+}
+
 void AlternateMemoryBestFitHeap::AddInputAndOutputRequiredAssignments() {
   // Go through the parameters and outputs and pin them to default memory by
   // adding a required assignment.
@@ -592,7 +690,7 @@ MemorySpaceAssignment::Run(
     BufferValue::SizeFunction size_fn,
     AlternateMemoryBestFitHeap::IsAllowedInAlternateMemoryFunction
         is_allowed_in_alternate_mem,
-    int64 max_outstanding_async_copies) {
+    int64 max_outstanding_async_copies, bool enable_cross_program_prefetch) {
   CHECK(module->has_schedule());
   VLOG(4) << "Module before memory space assignment: ";
   XLA_VLOG_LINES(4, module->ToString());
@@ -611,7 +709,8 @@ MemorySpaceAssignment::Run(
       *memory_space_assignment.hlo_live_range_,
       alternate_memory_space_alignment_in_bytes,
       GlobalDecreasingSizeBestFitHeap::Type::kSpatial,
-      is_allowed_in_alternate_mem, max_outstanding_async_copies);
+      is_allowed_in_alternate_mem, max_outstanding_async_copies,
+      enable_cross_program_prefetch);
 
   TF_RETURN_IF_ERROR(HeapSimulator::Run(std::move(algorithm), *module,
                                         module->schedule(),
@@ -781,6 +880,15 @@ Status MemorySpaceAssignment::Process() {
   int64 alternate_memory_size = 0;
   for (auto& buffer_and_sequence : allocation_map_) {
     for (auto& allocation : buffer_and_sequence.second) {
+      // The defining position of a copy allocation still refers to the
+      // parameter until the copy is processed.
+      if (allocation->is_copy_allocation() &&
+          static_cast<CopyAllocation*>(allocation.get())
+              ->is_cross_program_prefetch()) {
+        HloPosition position = allocation->defining_position();
+        preset_assignments_->set_cross_program_prefetch(
+            position.instruction->parameter_number(), position.index);
+      }
       TF_RETURN_IF_ERROR(allocation->Process(this));
       // Add the offset and size of the allocation in the alternate memory to
       // the output map. Special case for bitcast: since bitcast doesn't define
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_MEMORY_SPACE_ASSIGNMENT_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_MEMORY_SPACE_ASSIGNMENT_H_
 
+#include "absl/types/optional.h"
 #include "tensorflow/compiler/xla/service/heap_simulator.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
 
@@ -25,7 +26,10 @@ namespace xla {
 // assignment. It contains two data structures: (1) a chunks vector that maps a
 // defining HloPosition to a Chunk (offset and size), and (2) a sizes vector
 // that maps the memory space to its size. If there is only one alternate memory
-// space like there is currently, there will be one entry in sizes.
+// space like there is currently, there will be one entry in sizes. If a
+// cross-program prefetch was planned, it also records the entry computation
+// parameter (number and shape index) that is prefetched so that the runtime can
+// keep it resident in the alternate memory across program invocations.
 class PresetAssignments {
  public:
   PresetAssignments() = default;
@@ -46,12 +50,22 @@ class PresetAssignments {
 
   absl::Span<const std::pair<int64, int64>> sizes() const { return sizes_; }
 
+  void set_cross_program_prefetch(int64 parameter, const ShapeIndex& index) {
+    cross_program_prefetch_ = std::make_pair(parameter, index);
+  }
+
+  const absl::optional<std::pair<int64, ShapeIndex>>& cross_program_prefetch()
+      const {
+    return cross_program_prefetch_;
+  }
+
   // Remove the chunks_ entry that corresponds to instruction.
   void RemoveAssignmentForInstruction(const HloInstruction* instruction);
 
  private:
   std::vector<std::pair<HloPosition, HeapSimulator::Chunk>> chunks_;
   std::vector<std::pair<int64, int64>> sizes_;
+  absl::optional<std::pair<int64, ShapeIndex>> cross_program_prefetch_;
 };
 
 // MemorySpaceAssignment assigns memory spaces (default or alternate) to each
@@ -211,6 +225,13 @@ class MemorySpaceAssignment {
       copy_start_schedule_after_ = copy_start_schedule_after;
     }
 
+    // A cross-program prefetch copies an entry computation parameter into the
+    // alternate memory and keeps it there until the end of the program.
+    bool is_cross_program_prefetch() const {
+      return is_cross_program_prefetch_;
+    }
+    void set_is_cross_program_prefetch() { is_cross_program_prefetch_ = true; }
+
    private:
     const Allocation& prev_allocation_;
     // These variables define the scheduling boundaries where CopyStart and
@@ -219,6 +240,7 @@ class MemorySpaceAssignment {
     // is before copy_done_schedule_before_.
     int64 copy_start_schedule_after_;
     int64 copy_done_schedule_before_;
+    bool is_cross_program_prefetch_ = false;
     HloInstruction* copy_start_;
     HloInstruction* copy_done_;
   };
@@ -238,6 +260,10 @@ class MemorySpaceAssignment {
   // HloValues (e.g., based on the opcode) to be placed on the alternate memory.
   // max_outstanding_async_copies specifies the upper bound for number of
   // outstanding asynchronous copies, -1 for unlimited.
+  // enable_cross_program_prefetch allows one entry computation parameter whose
+  // uses are all dots, convolutions or fusions (typically weights) to be
+  // prefetched into the alternate memory at the beginning of the program and
+  // kept there until its end, so it can stay resident across invocations.
   // TODO(berkin): Use the cost model instead of using number of instructions to
   // decide how early to prefetch.
   static StatusOr<std::unique_ptr<PresetAssignments>> Run(
@@ -246,7 +272,8 @@ class MemorySpaceAssignment {
       int64 alternate_memory_space_alignment_in_bytes,
       BufferValue::SizeFunction size_fn,
       std::function<bool(const HloValue&)> is_allowed_in_alternate_mem,
-      int64 max_outstanding_async_copies = -1);
+      int64 max_outstanding_async_copies = -1,
+      bool enable_cross_program_prefetch = false);
 
   // Returns the maximum number of outstanding asynchronous copies in the
   // module.
@@ -324,7 +351,7 @@ class AlternateMemoryBestFitHeap : public GlobalDecreasingSizeBestFitHeap {
       const HloLiveRange& hlo_live_range, int64 alignment,
       GlobalDecreasingSizeBestFitHeap::Type type,
       IsAllowedInAlternateMemoryFunction is_allowed_in_alternate_mem,
-      int64 max_outstanding_async_copies)
+      int64 max_outstanding_async_copies, bool enable_cross_program_prefetch)
       : GlobalDecreasingSizeBestFitHeap(alignment, type),
         allocation_map_(allocation_map),
         max_size_in_bytes_(max_size_in_bytes),
@@ -333,7 +360,8 @@ class AlternateMemoryBestFitHeap : public GlobalDecreasingSizeBestFitHeap {
         alias_analysis_(alias_analysis),
         hlo_live_range_(hlo_live_range),
         is_allowed_in_alternate_mem_(is_allowed_in_alternate_mem),
-        max_outstanding_async_copies_(max_outstanding_async_copies) {}
+        max_outstanding_async_copies_(max_outstanding_async_copies),
+        enable_cross_program_prefetch_(enable_cross_program_prefetch) {}
 
   HeapSimulator::Result Finish() override;
 
@@ -357,6 +385,18 @@ class AlternateMemoryBestFitHeap : public GlobalDecreasingSizeBestFitHeap {
       HloInstruction* non_bitcast_operand,
       MemorySpaceAssignment::AllocationSequence* allocations);
 
+  // Returns true if the buffer interval is a candidate for cross-program
+  // prefetching: an array entry computation parameter that isn't live out and
+  // whose uses are all dots, convolutions or fusions in the entry computation.
+  bool IsCrossProgramPrefetchable(const BufferInterval& interval) const;
+
+  // Picks the largest cross-program prefetch candidate that fits in the
+  // alternate memory and allocates it there from its definition until the end
+  // of the program, with an asynchronous copy that completes before its first
+  // use.
+  void AllocateCrossProgramPrefetchBuffer(
+      const std::vector<BufferInterval>& sorted_buffer_intervals);
+
   // Adds input and outputs as required assignments.
   void AddInputAndOutputRequiredAssignments();
 
@@ -411,6 +451,7 @@ class AlternateMemoryBestFitHeap : public GlobalDecreasingSizeBestFitHeap {
   // asynchronous copies.
   BufferIntervalTree async_copy_interval_tree_;
   int64 max_outstanding_async_copies_;
+  bool enable_cross_program_prefetch_;
   std::vector<std::pair<BufferInterval, ChunkCandidate>> pending_chunks_;
   std::vector<std::pair<int64, int64>> pending_async_copies_;
   // This map contains required memory assignments for HloValues (e.g., input
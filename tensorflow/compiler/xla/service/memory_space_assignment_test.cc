@@ -33,7 +33,8 @@ class MemorySpaceAssignmentTest : public HloTestBase {
 
   std::unique_ptr<PresetAssignments> AssignMemorySpace(
       HloModule* module, int64 max_outstanding_async_copies = -1,
-      int64 max_prefetch_interval = 10) {
+      int64 max_prefetch_interval = 10,
+      bool enable_cross_program_prefetch = false) {
     auto size_fn = [](const BufferValue& buffer) {
       return ShapeUtil::ByteSizeOf(buffer.shape(), /*pointer_size=*/8);
     };
@@ -57,7 +58,8 @@ class MemorySpaceAssignmentTest : public HloTestBase {
             /*max_size_in_bytes=*/128,
             /*min_prefetch_interval=*/2, max_prefetch_interval,
             /*alternate_memory_space_alignment_in_bytes=*/8, size_fn,
-            is_allowed_in_alternate_mem, max_outstanding_async_copies)
+            is_allowed_in_alternate_mem, max_outstanding_async_copies,
+            enable_cross_program_prefetch)
             .ValueOrDie();
     CheckPresetAssignments(preset_assignments.get());
     return preset_assignments;
@@ -1429,5 +1431,77 @@ TEST_F(MemorySpaceAssignmentTest, InputOutputAlias) {
             kDefaultMemorySpace);
 }
 
+TEST_F(MemorySpaceAssignmentTest, CrossProgramPrefetch) {
+  HloComputation::Builder builder(TestName());
+  Shape lhs_shape = ShapeUtil::MakeShape(F32, {2, 3});
+  Shape rhs_shape = ShapeUtil::MakeShape(F32, {3, 2});
+  Shape result_shape = ShapeUtil::MakeShape(F32, {2, 2});
+  HloInstruction* p0 = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, lhs_shape, "p0"));
+  HloInstruction* p1 = builder.AddInstruction(
+      HloInstruction::CreateParameter(1, rhs_shape, "p1"));
+  // p0 is also used by an elementwise op, so only p1 (the weights) is a
+  // cross-program prefetch candidate.
+  HloInstruction* negate0 = builder.AddInstruction(
+      HloInstruction::CreateUnary(lhs_shape, HloOpcode::kNegate, p0));
+  DotDimensionNumbers dot_dnums;
+  dot_dnums.add_lhs_contracting_dimensions(1);
+  dot_dnums.add_rhs_contracting_dimensions(0);
+  HloInstruction* dot = builder.AddInstruction(HloInstruction::CreateDot(
+      result_shape, negate0, p1, dot_dnums, DefaultPrecisionConfig(2)));
+  HloInstruction* negate1 = builder.AddInstruction(
+      HloInstruction::CreateUnary(result_shape, HloOpcode::kNegate, dot));
+
+  auto module = CreateNewVerifiedModule();
+  HloComputation* computation = module->AddEntryComputation(builder.Build());
+
+  HloSchedule schedule(module.get());
+  schedule.set_sequence(computation, {p0, p1, negate0, dot, negate1});
+  TF_CHECK_OK(module->set_schedule(schedule));
+
+  std::unique_ptr<PresetAssignments> preset_assignments = AssignMemorySpace(
+      module.get(), /*max_outstanding_async_copies=*/-1,
+      /*max_prefetch_interval=*/10, /*enable_cross_program_prefetch=*/true);
+
+  ASSERT_TRUE(preset_assignments->cross_program_prefetch().has_value());
+  EXPECT_EQ(preset_assignments->cross_program_prefetch()->first, 1);
+  EXPECT_EQ(preset_assignments->cross_program_prefetch()->second,
+            ShapeIndex({}));
+  EXPECT_THAT(dot->operand(1),
+              op::ShapeWithLayout(ShapeUtil::MakeShapeWithLayout(
+                  F32, {3, 2}, /*minor_to_major=*/{1, 0}, /*tiles=*/{},
+                  /*element_size_in_bits=*/0, kAlternateMemorySpace)));
+  EXPECT_THAT(dot->operand(1), op::CopyDone(op::CopyStart(p1)));
+  EXPECT_EQ(p1->shape().layout().memory_space(), kDefaultMemorySpace);
+}
+
+TEST_F(MemorySpaceAssignmentTest, CrossProgramPrefetchDisabled) {
+  HloComputation::Builder builder(TestName());
+  Shape lhs_shape = ShapeUtil::MakeShape(F32, {2, 3});
+  Shape rhs_shape = ShapeUtil::MakeShape(F32, {3, 2});
+  Shape result_shape = ShapeUtil::MakeShape(F32, {2, 2});
+  HloInstruction* p0 = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, lhs_shape, "p0"));
+  HloInstruction* p1 = builder.AddInstruction(
+      HloInstruction::CreateParameter(1, rhs_shape, "p1"));
+  DotDimensionNumbers dot_dnums;
+  dot_dnums.add_lhs_contracting_dimensions(1);
+  dot_dnums.add_rhs_contracting_dimensions(0);
+  HloInstruction* dot = builder.AddInstruction(HloInstruction::CreateDot(
+      result_shape, p0, p1, dot_dnums, DefaultPrecisionConfig(2)));
+
+  auto module = CreateNewVerifiedModule();
+  HloComputation* computation = module->AddEntryComputation(builder.Build());
+
+  HloSchedule schedule(module.get());
+  schedule.set_sequence(computation, {p0, p1, dot});
+  TF_CHECK_OK(module->set_schedule(schedule));
+
+  std::unique_ptr<PresetAssignments> preset_assignments =
+      AssignMemorySpace(module.get());
+
+  EXPECT_FALSE(preset_assignments->cross_program_prefetch().has_value());
+}
+
 }  // namespace
 }  // namespace xla
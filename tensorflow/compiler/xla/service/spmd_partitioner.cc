@@ -0,0 +1,696 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/spmd_partitioner.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/optional.h"
+#include "tensorflow/compiler/xla/array.h"
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/primitive_util.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/hlo_sharding.h"
+#include "tensorflow/compiler/xla/shape_tree.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+
+namespace xla {
+
+namespace {
+
+// Returns `sharding` if every partition holds one even tile of `shape` under
+// it, and a replicated sharding otherwise. Applies to each leaf of tuples.
+HloSharding EffectiveSharding(const Shape& shape, const HloSharding& sharding,
+                              int64 num_partitions) {
+  if (shape.IsTuple()) {
+    StatusOr<ShapeTree<HloSharding>> tree_or = sharding.AsShapeTree(shape);
+    ShapeTree<HloSharding> tree =
+        tree_or.ok() ? tree_or.ConsumeValueOrDie()
+                     : ShapeTree<HloSharding>(shape, HloSharding::Replicate());
+    for (auto& index_and_sharding : tree.leaves()) {
+      index_and_sharding.second = EffectiveSharding(
+          ShapeUtil::GetSubshape(shape, index_and_sharding.first),
+          index_and_sharding.second, num_partitions);
+    }
+    return HloSharding::Tuple(tree);
+  }
+  if (!shape.IsArray() || sharding.IsTuple() || sharding.IsTileMaximal()) {
+    return HloSharding::Replicate();
+  }
+  const Array<int64>& tiles = sharding.tile_assignment();
+  if (tiles.num_dimensions() != shape.rank() ||
+      tiles.num_elements() != num_partitions) {
+    return HloSharding::Replicate();
+  }
+  bool valid = true;
+  std::vector<bool> seen(num_partitions, false);
+  tiles.Each([&](absl::Span<const int64> /*index*/, int64 device) {
+    if (device < 0 || device >= num_partitions || seen[device]) {
+      valid = false;
+    } else {
+      seen[device] = true;
+    }
+  });
+  for (int64 i = 0; i < shape.rank(); ++i) {
+    valid = valid && shape.dimensions(i) % tiles.dim(i) == 0;
+  }
+  return valid ? sharding : HloSharding::Replicate();
+}
+
+// Returns the shape of the part of `shape` that one partition holds.
+Shape ShardShape(const Shape& shape, const HloSharding& sharding) {
+  if (shape.IsTuple()) {
+    std::vector<Shape> subshapes;
+    for (int64 i = 0; i < shape.tuple_shapes_size(); ++i) {
+      subshapes.push_back(ShardShape(shape.tuple_shapes(i),
+                                     sharding.GetSubSharding(shape, {i})));
+    }
+    return ShapeUtil::MakeTupleShape(subshapes);
+  }
+  return sharding.TileShape(shape);
+}
+
+// Returns the sharding of a tuple of values with the given shardings.
+HloSharding MakeTupleSharding(const Shape& tuple_shape,
+                              absl::Span<const HloSharding> elements) {
+  std::vector<HloSharding> leaves;
+  for (int64 i = 0; i < elements.size(); ++i) {
+    if (ShapeUtil::GetLeafCount(tuple_shape.tuple_shapes(i)) == 0) {
+      continue;
+    }
+    if (elements[i].IsTuple()) {
+      leaves.insert(leaves.end(), elements[i].tuple_elements().begin(),
+                    elements[i].tuple_elements().end());
+    } else {
+      leaves.push_back(elements[i]);
+    }
+  }
+  if (leaves.empty()) {
+    leaves.push_back(HloSharding::Replicate());
+  }
+  return HloSharding::Tuple(tuple_shape, leaves);
+}
+
+// Returns the sharding of an operand of shape `operand_shape` under which each
+// partition holds the part of the operand its tile of an output sharded with
+// `output` depends on, where operand dimension i runs along output dimension
+// operand_to_output[i], or along no output dimension if that is -1. Returns
+// nullopt if there is no such sharding, i.e. partitions would need to hold
+// different overlapping parts of the operand.
+absl::optional<HloSharding> OperandShardingFromOutput(
+    const HloSharding& output, const Shape& operand_shape,
+    absl::Span<const int64> operand_to_output) {
+  if (output.IsReplicated()) {
+    return HloSharding::Replicate();
+  }
+  const Array<int64>& tiles = output.tile_assignment();
+  std::vector<int64> dims(operand_to_output.size(), 1);
+  int64 num_tiles = 1;
+  for (int64 i = 0; i < operand_to_output.size(); ++i) {
+    if (operand_to_output[i] >= 0) {
+      dims[i] = tiles.dim(operand_to_output[i]);
+      num_tiles *= dims[i];
+    }
+  }
+  if (num_tiles == 1) {
+    return HloSharding::Replicate();
+  }
+  if (num_tiles != tiles.num_elements()) {
+    return absl::nullopt;
+  }
+  for (int64 i = 0; i < dims.size(); ++i) {
+    if (operand_shape.dimensions(i) % dims[i] != 0) {
+      return absl::nullopt;
+    }
+  }
+  Array<int64> operand_tiles(dims);
+  tiles.Each([&](absl::Span<const int64> index, int64 device) {
+    std::vector<int64> operand_index(dims.size(), 0);
+    for (int64 i = 0; i < operand_to_output.size(); ++i) {
+      if (operand_to_output[i] >= 0) {
+        operand_index[i] = index[operand_to_output[i]];
+      }
+    }
+    operand_tiles(operand_index) = device;
+  });
+  return HloSharding::Tile(operand_tiles);
+}
+
+// An entry computation instruction, rewritten to work on the part of its
+// value each partition holds under `sharding`.
+struct PartitionedHlo {
+  HloInstruction* hlo;
+  HloSharding sharding;
+};
+
+// Builds the partitioned version of one entry computation.
+class EntryPartitioner {
+ public:
+  EntryPartitioner(HloModule* module, const HloComputation* entry,
+                   int64 num_partitions, bool partitions_as_replicas)
+      : module_(module),
+        entry_(entry),
+        num_partitions_(num_partitions),
+        partitions_as_replicas_(partitions_as_replicas),
+        builder_(entry->name()) {
+    for (const HloComputation* computation : module->computations()) {
+      for (const HloInstruction* instruction : computation->instructions()) {
+        if (instruction->channel_id()) {
+          next_channel_id_ =
+              std::max(next_channel_id_, *instruction->channel_id() + 1);
+        }
+      }
+    }
+  }
+
+  // Returns the partitioned computation, which is added to the module.
+  HloComputation* Partition() {
+    for (const HloInstruction* hlo : entry_->MakeInstructionPostOrder()) {
+      HloSharding sharding = TargetSharding(hlo);
+      HloInstruction* result = PartitionInstruction(hlo, sharding);
+      partitioned_.emplace(hlo, PartitionedHlo{result, sharding});
+    }
+    const PartitionedHlo& root = partitioned_.at(entry_->root_instruction());
+    return module_->AddEmbeddedComputation(builder_.Build(root.hlo));
+  }
+
+ private:
+  HloInstruction* Add(std::unique_ptr<HloInstruction> instruction) {
+    instruction->clear_sharding();
+    return builder_.AddInstruction(std::move(instruction));
+  }
+
+  HloSharding Replicated(const Shape& shape) const {
+    return EffectiveSharding(shape, HloSharding::Replicate(), num_partitions_);
+  }
+
+  // Unannotated elementwise ops follow a tiled operand of the same shape;
+  // everything else without a sharding is replicated.
+  HloSharding TargetSharding(const HloInstruction* hlo) const {
+    if (!hlo->has_sharding() && hlo->IsElementwise() &&
+        hlo->shape().IsArray()) {
+      for (const HloInstruction* operand : hlo->operands()) {
+        const HloSharding& sharding = partitioned_.at(operand).sharding;
+        if (!sharding.IsReplicated() &&
+            ShapeUtil::SameDimensions(operand->shape(), hlo->shape())) {
+          return sharding;
+        }
+      }
+    }
+    return EffectiveSharding(
+        hlo->shape(),
+        hlo->has_sharding() ? hlo->sharding() : HloSharding::Replicate(),
+        num_partitions_);
+  }
+
+  // Returns the number of the partition running the program, as a U32.
+  HloInstruction* PartitionNumber() {
+    if (partition_number_ == nullptr) {
+      partition_number_ = Add(partitions_as_replicas_
+                                  ? HloInstruction::CreateReplicaId()
+                                  : HloInstruction::CreatePartitionId());
+    }
+    return partition_number_;
+  }
+
+  // Returns S32 scalars holding the offsets within `shape` of the tile the
+  // running partition holds under `sharding`.
+  std::vector<HloInstruction*> TileOffsets(const Shape& shape,
+                                           const HloSharding& sharding) {
+    const Array<int64>& tiles = sharding.tile_assignment();
+    std::vector<HloInstruction*> offsets;
+    for (int64 i = 0; i < shape.rank(); ++i) {
+      if (tiles.dim(i) == 1) {
+        offsets.push_back(Add(
+            HloInstruction::CreateConstant(LiteralUtil::CreateR0<int32>(0))));
+        continue;
+      }
+      const int64 tile_size = shape.dimensions(i) / tiles.dim(i);
+      std::vector<int32> table(num_partitions_);
+      for (int64 device = 0; device < num_partitions_; ++device) {
+        table[device] = sharding.TileIndexForDevice(device)[i] * tile_size;
+      }
+      HloInstruction* table_hlo = Add(HloInstruction::CreateConstant(
+          LiteralUtil::CreateR1<int32>(table)));
+      HloInstruction* offset = Add(HloInstruction::CreateDynamicSlice(
+          ShapeUtil::MakeShape(S32, {1}), table_hlo, {PartitionNumber()},
+          {1}));
+      offsets.push_back(Add(HloInstruction::CreateReshape(
+          ShapeUtil::MakeShape(S32, {}), offset)));
+    }
+    return offsets;
+  }
+
+  // Returns a scalar computation applying `opcode` to values of `type`.
+  HloComputation* Reducer(PrimitiveType type, HloOpcode opcode) {
+    HloComputation*& reducer = reducers_[{type, opcode}];
+    if (reducer == nullptr) {
+      HloComputation::Builder builder(
+          absl::StrCat("spmd_", HloOpcodeString(opcode), "_",
+                       primitive_util::LowercasePrimitiveTypeName(type)));
+      const Shape scalar = ShapeUtil::MakeShape(type, {});
+      HloInstruction* x = builder.AddInstruction(
+          HloInstruction::CreateParameter(0, scalar, "x"));
+      HloInstruction* y = builder.AddInstruction(
+          HloInstruction::CreateParameter(1, scalar, "y"));
+      builder.AddInstruction(
+          HloInstruction::CreateBinary(scalar, opcode, x, y));
+      reducer = module_->AddEmbeddedComputation(builder.Build());
+    }
+    return reducer;
+  }
+
+  HloComputation* SumReducer(PrimitiveType type) {
+    return Reducer(type, type == PRED ? HloOpcode::kOr : HloOpcode::kAdd);
+  }
+
+  // Combines `operand` over all partitions with `reducer`.
+  HloInstruction* AllReduce(HloInstruction* operand, HloComputation* reducer) {
+    absl::optional<int64> channel_id;
+    if (!partitions_as_replicas_) {
+      channel_id = next_channel_id_++;
+    }
+    return Add(HloInstruction::CreateAllReduce(operand->shape(), {operand},
+                                               reducer,
+                                               /*replica_groups=*/{},
+                                               channel_id));
+  }
+
+  // Converts `hlo`, the parts of a value of shape `shape` under sharding
+  // `from`, to the parts under sharding `to`.
+  HloInstruction* Reshard(HloInstruction* hlo, const Shape& shape,
+                          const HloSharding& from, const HloSharding& to) {
+    if (from == to) {
+      return hlo;
+    }
+    if (shape.IsTuple()) {
+      std::vector<HloInstruction*> elements;
+      for (int64 i = 0; i < shape.tuple_shapes_size(); ++i) {
+        HloInstruction* element =
+            Add(HloInstruction::CreateGetTupleElement(
+                hlo->shape().tuple_shapes(i), hlo, i));
+        elements.push_back(Reshard(element, shape.tuple_shapes(i),
+                                   from.GetSubSharding(shape, {i}),
+                                   to.GetSubSharding(shape, {i})));
+      }
+      return Add(HloInstruction::CreateTuple(elements));
+    }
+    HloInstruction* result = hlo;
+    if (!from.IsReplicated()) {
+      // Gather: every partition writes its tile into zeros at the tile's
+      // offset, and the sum over partitions is the full value.
+      HloInstruction* zero = Add(HloInstruction::CreateConstant(
+          LiteralUtil::Zero(shape.element_type())));
+      HloInstruction* zeros =
+          Add(HloInstruction::CreateBroadcast(shape, zero, {}));
+      result = Add(HloInstruction::CreateDynamicUpdateSlice(
+          shape, zeros, hlo, TileOffsets(shape, from)));
+      result = AllReduce(result, SumReducer(shape.element_type()));
+    }
+    if (!to.IsReplicated()) {
+      const Shape tile_shape = to.TileShape(shape);
+      result = Add(HloInstruction::CreateDynamicSlice(
+          tile_shape, result, TileOffsets(shape, to), tile_shape.dimensions()));
+    }
+    return result;
+  }
+
+  // Returns operand `i` of `hlo` under `sharding`.
+  HloInstruction* Operand(const HloInstruction* hlo, int64 i,
+                          const HloSharding& sharding) {
+    const HloInstruction* operand = hlo->operand(i);
+    const PartitionedHlo& partitioned = partitioned_.at(operand);
+    return Reshard(partitioned.hlo, operand->shape(), partitioned.sharding,
+                   sharding);
+  }
+
+  // Returns `hlo` on the operands in `operands`, computing the tiles of
+  // `sharding`.
+  HloInstruction* CloneOnTiles(const HloInstruction* hlo,
+                               const HloSharding& sharding,
+                               absl::Span<HloInstruction* const> operands) {
+    return Add(hlo->CloneWithNewOperands(ShardShape(hlo->shape(), sharding),
+                                         operands));
+  }
+
+  // Each of the Partition* functions below returns `hlo` computed under
+  // `sharding`, or null if it can't partition `hlo` that way.
+
+  HloInstruction* PartitionElementwise(const HloInstruction* hlo,
+                                       const HloSharding& sharding) {
+    std::vector<HloInstruction*> operands;
+    for (int64 i = 0; i < hlo->operand_count(); ++i) {
+      // Scalar operands, e.g. the bounds of a clamp, stay replicated.
+      operands.push_back(Operand(
+          hlo, i,
+          ShapeUtil::SameDimensions(hlo->operand(i)->shape(), hlo->shape())
+              ? sharding
+              : HloSharding::Replicate()));
+    }
+    return CloneOnTiles(hlo, sharding, operands);
+  }
+
+  HloInstruction* PartitionBroadcast(const HloInstruction* hlo,
+                                     const HloSharding& sharding) {
+    // Tiles along the new dimensions need the full operand; tiles along the
+    // operand's dimensions need the matching operand tile.
+    absl::optional<HloSharding> operand_sharding = OperandShardingFromOutput(
+        sharding, hlo->operand(0)->shape(), hlo->dimensions());
+    if (!operand_sharding) {
+      return nullptr;
+    }
+    return CloneOnTiles(hlo, sharding, {Operand(hlo, 0, *operand_sharding)});
+  }
+
+  HloInstruction* PartitionTranspose(const HloInstruction* hlo,
+                                     const HloSharding& sharding) {
+    std::vector<int64> operand_to_output(hlo->shape().rank());
+    for (int64 i = 0; i < hlo->dimensions().size(); ++i) {
+      operand_to_output[hlo->dimensions(i)] = i;
+    }
+    absl::optional<HloSharding> operand_sharding = OperandShardingFromOutput(
+        sharding, hlo->operand(0)->shape(), operand_to_output);
+    if (!operand_sharding) {
+      return nullptr;
+    }
+    return CloneOnTiles(hlo, sharding, {Operand(hlo, 0, *operand_sharding)});
+  }
+
+  HloInstruction* PartitionDot(const HloInstruction* hlo,
+                               const HloSharding& sharding) {
+    const DotDimensionNumbers& dnums = hlo->dot_dimension_numbers();
+    const Shape& lhs_shape = hlo->operand(0)->shape();
+    const Shape& rhs_shape = hlo->operand(1)->shape();
+
+    // The output has the batch dimensions, then the non-contracting
+    // dimensions of the lhs, then those of the rhs.
+    std::vector<int64> lhs_to_output(lhs_shape.rank(), -1);
+    std::vector<int64> rhs_to_output(rhs_shape.rank(), -1);
+    int64 output_dim = 0;
+    for (int64 i = 0; i < dnums.lhs_batch_dimensions_size(); ++i) {
+      lhs_to_output[dnums.lhs_batch_dimensions(i)] = output_dim;
+      rhs_to_output[dnums.rhs_batch_dimensions(i)] = output_dim;
+      ++output_dim;
+    }
+    for (int64 i = 0; i < lhs_shape.rank(); ++i) {
+      if (lhs_to_output[i] < 0 &&
+          !absl::c_linear_search(dnums.lhs_contracting_dimensions(), i)) {
+        lhs_to_output[i] = output_dim++;
+      }
+    }
+    for (int64 i = 0; i < rhs_shape.rank(); ++i) {
+      if (rhs_to_output[i] < 0 &&
+          !absl::c_linear_search(dnums.rhs_contracting_dimensions(), i)) {
+        rhs_to_output[i] = output_dim++;
+      }
+    }
+
+    // Output tiles along batch and non-contracting dimensions are computed
+    // from operand tiles alone.
+    if (!sharding.IsReplicated()) {
+      absl::optional<HloSharding> lhs_sharding =
+          OperandShardingFromOutput(sharding, lhs_shape, lhs_to_output);
+      absl::optional<HloSharding> rhs_sharding =
+          OperandShardingFromOutput(sharding, rhs_shape, rhs_to_output);
+      if (lhs_sharding && rhs_sharding) {
+        return CloneOnTiles(hlo, sharding,
+                            {Operand(hlo, 0, *lhs_sharding),
+                             Operand(hlo, 1, *rhs_sharding)});
+      }
+    }
+
+    // An operand tiled along contracting dimensions only is contracted with
+    // the matching tiles of the other operand, and the partial results are
+    // summed over the partitions.
+    for (int64 side = 0; side < 2; ++side) {
+      const PartitionedHlo& tiled = partitioned_.at(hlo->operand(side));
+      if (tiled.sharding.IsReplicated()) {
+        continue;
+      }
+      const auto& contracting = side == 0 ? dnums.lhs_contracting_dimensions()
+                                          : dnums.rhs_contracting_dimensions();
+      const auto& other_contracting = side == 0
+                                          ? dnums.rhs_contracting_dimensions()
+                                          : dnums.lhs_contracting_dimensions();
+      const Array<int64>& tiles = tiled.sharding.tile_assignment();
+      bool contracting_only = true;
+      for (int64 i = 0; i < tiles.num_dimensions(); ++i) {
+        contracting_only = contracting_only &&
+                           (tiles.dim(i) == 1 ||
+                            absl::c_linear_search(contracting, i));
+      }
+      if (!contracting_only) {
+        continue;
+      }
+      const Shape& other_shape = side == 0 ? rhs_shape : lhs_shape;
+      std::vector<int64> other_dims(other_shape.rank(), 1);
+      for (int64 i = 0; i < contracting.size(); ++i) {
+        other_dims[other_contracting[i]] = tiles.dim(contracting[i]);
+      }
+      Array<int64> other_tiles(other_dims);
+      tiles.Each([&](absl::Span<const int64> index, int64 device) {
+        std::vector<int64> other_index(other_dims.size(), 0);
+        for (int64 i = 0; i < contracting.size(); ++i) {
+          other_index[other_contracting[i]] = index[contracting[i]];
+        }
+        other_tiles(other_index) = device;
+      });
+      HloInstruction* other =
+          Operand(hlo, 1 - side, HloSharding::Tile(other_tiles));
+      HloInstruction* partial = Add(hlo->CloneWithNewOperands(
+          hlo->shape(), side == 0 ? std::vector<HloInstruction*>{tiled.hlo,
+                                                                 other}
+                                  : std::vector<HloInstruction*>{other,
+                                                                 tiled.hlo}));
+      HloInstruction* sum =
+          AllReduce(partial, SumReducer(hlo->shape().element_type()));
+      return Reshard(sum, hlo->shape(), HloSharding::Replicate(), sharding);
+    }
+    return nullptr;
+  }
+
+  HloInstruction* PartitionConvolution(const HloInstruction* hlo,
+                                       const HloSharding& sharding) {
+    if (sharding.IsReplicated() || hlo->feature_group_count() != 1 ||
+        hlo->batch_group_count() != 1) {
+      return nullptr;
+    }
+    const ConvolutionDimensionNumbers& dnums =
+        hlo->convolution_dimension_numbers();
+    // Tiling the spatial dimensions would need halos from neighboring tiles.
+    const Array<int64>& tiles = sharding.tile_assignment();
+    for (int64 i = 0; i < tiles.num_dimensions(); ++i) {
+      if (tiles.dim(i) != 1 && i != dnums.output_batch_dimension() &&
+          i != dnums.output_feature_dimension()) {
+        return nullptr;
+      }
+    }
+    const Shape& lhs_shape = hlo->operand(0)->shape();
+    const Shape& rhs_shape = hlo->operand(1)->shape();
+    std::vector<int64> lhs_to_output(lhs_shape.rank(), -1);
+    lhs_to_output[dnums.input_batch_dimension()] =
+        dnums.output_batch_dimension();
+    std::vector<int64> rhs_to_output(rhs_shape.rank(), -1);
+    rhs_to_output[dnums.kernel_output_feature_dimension()] =
+        dnums.output_feature_dimension();
+    absl::optional<HloSharding> lhs_sharding =
+        OperandShardingFromOutput(sharding, lhs_shape, lhs_to_output);
+    absl::optional<HloSharding> rhs_sharding =
+        OperandShardingFromOutput(sharding, rhs_shape, rhs_to_output);
+    if (!lhs_sharding || !rhs_sharding) {
+      return nullptr;
+    }
+    return CloneOnTiles(
+        hlo, sharding,
+        {Operand(hlo, 0, *lhs_sharding), Operand(hlo, 1, *rhs_sharding)});
+  }
+
+  HloInstruction* PartitionReduce(const HloInstruction* hlo,
+                                  const HloSharding& sharding) {
+    if (hlo->shape().IsTuple()) {
+      return nullptr;
+    }
+    const PartitionedHlo& input = partitioned_.at(hlo->operand(0));
+    if (input.sharding.IsReplicated()) {
+      return nullptr;
+    }
+    const Array<int64>& tiles = input.sharding.tile_assignment();
+    auto is_reduced = [&](int64 dim) {
+      return absl::c_linear_search(hlo->dimensions(), dim);
+    };
+    bool tiled_kept = false;
+    bool tiled_reduced = false;
+    for (int64 i = 0; i < tiles.num_dimensions(); ++i) {
+      if (tiles.dim(i) != 1) {
+        (is_reduced(i) ? tiled_reduced : tiled_kept) = true;
+      }
+    }
+    if (tiled_kept && tiled_reduced) {
+      return nullptr;
+    }
+    HloInstruction* init = Operand(hlo, 1, HloSharding::Replicate());
+    if (tiled_reduced) {
+      // The reduction function may be applied to the initial value any number
+      // of times, so each partition reduces its tile and the partial results
+      // are combined with the same function.
+      HloInstruction* partial =
+          Add(hlo->CloneWithNewOperands(hlo->shape(), {input.hlo, init}));
+      HloInstruction* result = AllReduce(partial, hlo->to_apply());
+      return Reshard(result, hlo->shape(), HloSharding::Replicate(), sharding);
+    }
+    // Tiled along kept dimensions only: the output keeps the input's tiling.
+    std::vector<int64> output_dims;
+    for (int64 i = 0; i < tiles.num_dimensions(); ++i) {
+      if (!is_reduced(i)) {
+        output_dims.push_back(tiles.dim(i));
+      }
+    }
+    Array<int64> output_tiles(output_dims);
+    tiles.Each([&](absl::Span<const int64> index, int64 device) {
+      std::vector<int64> output_index;
+      for (int64 i = 0; i < index.size(); ++i) {
+        if (!is_reduced(i)) {
+          output_index.push_back(index[i]);
+        }
+      }
+      output_tiles(output_index) = device;
+    });
+    const HloSharding output_sharding = HloSharding::Tile(output_tiles);
+    HloInstruction* result =
+        CloneOnTiles(hlo, output_sharding, {input.hlo, init});
+    return Reshard(result, hlo->shape(), output_sharding, sharding);
+  }
+
+  // Computes `hlo` on replicated operands.
+  HloInstruction* PartitionReplicated(const HloInstruction* hlo,
+                                      const HloSharding& sharding) {
+    std::vector<HloInstruction*> operands;
+    for (int64 i = 0; i < hlo->operand_count(); ++i) {
+      operands.push_back(
+          Operand(hlo, i, Replicated(hlo->operand(i)->shape())));
+    }
+    HloInstruction* result =
+        Add(hlo->CloneWithNewOperands(hlo->shape(), operands));
+    return Reshard(result, hlo->shape(), Replicated(hlo->shape()), sharding);
+  }
+
+  HloInstruction* PartitionInstruction(const HloInstruction* hlo,
+                                       const HloSharding& sharding) {
+    HloInstruction* result = nullptr;
+    switch (hlo->opcode()) {
+      case HloOpcode::kParameter:
+        return Add(HloInstruction::CreateParameter(
+            hlo->parameter_number(), ShardShape(hlo->shape(), sharding),
+            hlo->name()));
+      case HloOpcode::kTuple: {
+        std::vector<HloInstruction*> elements;
+        std::vector<HloSharding> element_shardings;
+        for (const HloInstruction* operand : hlo->operands()) {
+          const PartitionedHlo& element = partitioned_.at(operand);
+          elements.push_back(element.hlo);
+          element_shardings.push_back(element.sharding);
+        }
+        return Reshard(Add(HloInstruction::CreateTuple(elements)), hlo->shape(),
+                       MakeTupleSharding(hlo->shape(), element_shardings),
+                       sharding);
+      }
+      case HloOpcode::kGetTupleElement: {
+        const HloInstruction* operand = hlo->operand(0);
+        const PartitionedHlo& tuple = partitioned_.at(operand);
+        HloInstruction* element =
+            Add(HloInstruction::CreateGetTupleElement(
+                tuple.hlo->shape().tuple_shapes(hlo->tuple_index()), tuple.hlo,
+                hlo->tuple_index()));
+        return Reshard(
+            element, hlo->shape(),
+            tuple.sharding.GetSubSharding(operand->shape(),
+                                          {hlo->tuple_index()}),
+            sharding);
+      }
+      case HloOpcode::kBroadcast:
+        result = PartitionBroadcast(hlo, sharding);
+        break;
+      case HloOpcode::kTranspose:
+        result = PartitionTranspose(hlo, sharding);
+        break;
+      case HloOpcode::kDot:
+        result = PartitionDot(hlo, sharding);
+        break;
+      case HloOpcode::kConvolution:
+        result = PartitionConvolution(hlo, sharding);
+        break;
+      case HloOpcode::kReduce:
+        result = PartitionReduce(hlo, sharding);
+        break;
+      default:
+        if (hlo->IsElementwise() && hlo->shape().IsArray()) {
+          result = PartitionElementwise(hlo, sharding);
+        }
+        break;
+    }
+    if (result == nullptr) {
+      result = PartitionReplicated(hlo, sharding);
+    }
+    return result;
+  }
+
+  HloModule* module_;
+  const HloComputation* entry_;
+  const int64 num_partitions_;
+  const bool partitions_as_replicas_;
+  HloComputation::Builder builder_;
+  int64 next_channel_id_ = 1;
+  HloInstruction* partition_number_ = nullptr;
+  std::map<std::pair<PrimitiveType, HloOpcode>, HloComputation*> reducers_;
+  std::unordered_map<const HloInstruction*, PartitionedHlo> partitioned_;
+};
+
+}  // namespace
+
+StatusOr<bool> SpmdPartitioner::Run(HloModule* module) {
+  if (num_partitions_ <= 1) {
+    return false;
+  }
+  HloComputation* entry = module->entry_computation();
+  const bool has_tiles = absl::c_any_of(
+      entry->instructions(), [&](const HloInstruction* instruction) {
+        return instruction->has_sharding() &&
+               !EffectiveSharding(instruction->shape(), instruction->sharding(),
+                                  num_partitions_)
+                    .IsReplicated();
+      });
+  if (!has_tiles) {
+    VLOG(2) << "No tiled shardings in " << module->name();
+    return false;
+  }
+
+  EntryPartitioner partitioner(module, entry, num_partitions_,
+                               partitions_as_replicas_);
+  module->ReplaceEntryComputation(partitioner.Partition());
+  // Drops the original entry computation.
+  TF_RETURN_IF_ERROR(module->RemoveUnusedComputations());
+  return true;
+}
+
+}  // namespace xla
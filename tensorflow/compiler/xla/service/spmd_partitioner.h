@@ -0,0 +1,74 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_SPMD_PARTITIONER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_SPMD_PARTITIONER_H_
+
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+#include "tensorflow/compiler/xla/statusor.h"
+
+namespace xla {
+
+// Rewrites a module whose entry computation carries HloSharding annotations
+// into the single program (SPMD) that every partition runs on its own shard
+// of the data.
+//
+// Every array of the entry computation is split into the tiles its sharding
+// describes, and each partition holds the tile its partition number is
+// assigned to; replicated arrays are held in full by every partition. The
+// entry parameters and result become the local tiles. Instructions without a
+// sharding are replicated, except elementwise ops, which take the sharding of
+// a tiled operand of the same shape.
+//
+// Elementwise ops, transposes and broadcasts run on local tiles. Dots and
+// convolutions run on local tiles when the output tiling maps onto operand
+// dimensions (batch and non-contracting dimensions of dots, batch and output
+// feature dimensions of convolutions); a dot whose operands are tiled along
+// the contracting dimensions runs locally and sums the partial results with
+// an all-reduce. A reduce of an operand tiled along the kept dimensions runs
+// locally, and one tiled along the reduced dimensions combines the local
+// results with an all-reduce. Any other instruction, and any sharding these
+// rules cannot serve, is computed on replicated operands.
+//
+// Changing an array's sharding gathers it with a dynamic-update-slice into
+// zeros followed by an all-reduce, and tiles it with a dynamic-slice at the
+// offsets of the partition. Shardings that don't tile all partitions evenly
+// are treated as replicated.
+class SpmdPartitioner : public HloModulePass {
+ public:
+  // If `partitions_as_replicas` is true, the partitions are run as replicas:
+  // the partition number is read with replica-id and collectives are
+  // cross-replica. This lets backends that only run replicated programs, e.g.
+  // XLA:GPU, execute the result with one replica per partition. Otherwise
+  // the partition number is read with partition-id and collectives are
+  // cross-partition, i.e. carry a channel id.
+  explicit SpmdPartitioner(int64 num_partitions,
+                           bool partitions_as_replicas = false)
+      : num_partitions_(num_partitions),
+        partitions_as_replicas_(partitions_as_replicas) {}
+  ~SpmdPartitioner() override = default;
+  absl::string_view name() const override { return "spmd-partitioning"; }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  int64 num_partitions_;
+  bool partitions_as_replicas_;
+};
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_SPMD_PARTITIONER_H_
@@ -0,0 +1,235 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/spmd_partitioner.h"
+
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/pattern_matcher.h"
+#include "tensorflow/compiler/xla/service/pattern_matcher_gmock.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace xla {
+namespace {
+
+namespace m = match;
+
+using SpmdPartitionerTest = HloTestBase;
+
+int64 CountOpcode(const HloComputation* computation, HloOpcode opcode) {
+  int64 count = 0;
+  for (const HloInstruction* instruction : computation->instructions()) {
+    count += instruction->opcode() == opcode;
+  }
+  return count;
+}
+
+TEST_F(SpmdPartitionerTest, NoTiledShardings) {
+  const char* const kModuleStr = R"(
+HloModule m
+
+ENTRY test {
+  p0 = f32[8,16] parameter(0), sharding={replicated}
+  ROOT neg = f32[8,16] negate(p0)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kModuleStr));
+  SpmdPartitioner partitioner(/*num_partitions=*/2);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, partitioner.Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(SpmdPartitionerTest, ElementwiseOnTiles) {
+  const char* const kModuleStr = R"(
+HloModule m
+
+ENTRY test {
+  p0 = f32[8,16] parameter(0), sharding={devices=[2,1]0,1}
+  p1 = f32[8,16] parameter(1), sharding={devices=[2,1]0,1}
+  add = f32[8,16] add(p0, p1)
+  ROOT neg = f32[8,16] negate(add), sharding={devices=[2,1]0,1}
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kModuleStr));
+  SpmdPartitioner partitioner(/*num_partitions=*/2);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, partitioner.Run(module.get()));
+  EXPECT_TRUE(changed);
+  const Shape tile_shape = ShapeUtil::MakeShape(F32, {4, 16});
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, GmockMatch(m::Negate(
+                        m::Add(m::Parameter(0), m::Parameter(1))
+                            .WithShapeEqualTo(&tile_shape))));
+  EXPECT_EQ(CountOpcode(module->entry_computation(), HloOpcode::kAllReduce),
+            0);
+}
+
+TEST_F(SpmdPartitionerTest, DotTiledAlongNonContractingDimension) {
+  const char* const kModuleStr = R"(
+HloModule m
+
+ENTRY test {
+  lhs = f32[8,32] parameter(0), sharding={devices=[2,1]0,1}
+  rhs = f32[32,16] parameter(1), sharding={replicated}
+  ROOT dot = f32[8,16] dot(lhs, rhs), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}, sharding={devices=[2,1]0,1}
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kModuleStr));
+  SpmdPartitioner partitioner(/*num_partitions=*/2);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, partitioner.Run(module.get()));
+  EXPECT_TRUE(changed);
+  const Shape lhs_shape = ShapeUtil::MakeShape(F32, {4, 32});
+  const Shape rhs_shape = ShapeUtil::MakeShape(F32, {32, 16});
+  const Shape dot_shape = ShapeUtil::MakeShape(F32, {4, 16});
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root,
+              GmockMatch(m::Dot(m::Parameter(0).WithShapeEqualTo(&lhs_shape),
+                                m::Parameter(1).WithShapeEqualTo(&rhs_shape))
+                             .WithShapeEqualTo(&dot_shape)));
+}
+
+TEST_F(SpmdPartitionerTest, DotTiledAlongContractingDimension) {
+  const char* const kModuleStr = R"(
+HloModule m
+
+ENTRY test {
+  lhs = f32[8,32] parameter(0), sharding={devices=[1,2]0,1}
+  rhs = f32[32,16] parameter(1), sharding={devices=[2,1]0,1}
+  ROOT dot = f32[8,16] dot(lhs, rhs), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}, sharding={replicated}
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kModuleStr));
+  SpmdPartitioner partitioner(/*num_partitions=*/2);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, partitioner.Run(module.get()));
+  EXPECT_TRUE(changed);
+  const Shape lhs_shape = ShapeUtil::MakeShape(F32, {8, 16});
+  const Shape rhs_shape = ShapeUtil::MakeShape(F32, {16, 16});
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, GmockMatch(m::AllReduce(m::Dot(
+                        m::Parameter(0).WithShapeEqualTo(&lhs_shape),
+                        m::Parameter(1).WithShapeEqualTo(&rhs_shape)))));
+  EXPECT_TRUE(root->channel_id().has_value());
+}
+
+TEST_F(SpmdPartitionerTest, ReshardToReplicatedAsReplicas) {
+  const char* const kModuleStr = R"(
+HloModule m
+
+ENTRY test {
+  p0 = f32[8,16] parameter(0), sharding={devices=[1,2]0,1}
+  ROOT exp = f32[8,16] exponential(p0), sharding={replicated}
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kModuleStr));
+  SpmdPartitioner partitioner(/*num_partitions=*/2,
+                              /*partitions_as_replicas=*/true);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, partitioner.Run(module.get()));
+  EXPECT_TRUE(changed);
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  // The tiles are gathered before the replicated exponential.
+  const HloInstruction* gather;
+  ASSERT_THAT(root, GmockMatch(m::Exp(m::AllReduce(m::Op(&gather)))));
+  EXPECT_FALSE(root->operand(0)->channel_id().has_value());
+  EXPECT_EQ(gather->opcode(), HloOpcode::kDynamicUpdateSlice);
+  EXPECT_THAT(gather->operand(0), GmockMatch(m::Broadcast(m::Constant())));
+  EXPECT_THAT(gather->operand(1), GmockMatch(m::Parameter(0)));
+  EXPECT_TRUE(ShapeUtil::Equal(gather->operand(1)->shape(),
+                               ShapeUtil::MakeShape(F32, {8, 8})));
+  EXPECT_THAT(gather->operand(2), GmockMatch(m::Constant()));
+  EXPECT_THAT(gather->operand(3), GmockMatch(m::Reshape()));
+  EXPECT_EQ(CountOpcode(module->entry_computation(), HloOpcode::kReplicaId),
+            1);
+  EXPECT_EQ(CountOpcode(module->entry_computation(), HloOpcode::kPartitionId),
+            0);
+}
+
+TEST_F(SpmdPartitionerTest, ReshardToTiles) {
+  const char* const kModuleStr = R"(
+HloModule m
+
+ENTRY test {
+  p0 = f32[8,16] parameter(0), sharding={replicated}
+  ROOT neg = f32[8,16] negate(p0), sharding={devices=[2,1]1,0}
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kModuleStr));
+  SpmdPartitioner partitioner(/*num_partitions=*/2);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, partitioner.Run(module.get()));
+  EXPECT_TRUE(changed);
+  const Shape tile_shape = ShapeUtil::MakeShape(F32, {4, 16});
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, GmockMatch(m::Negate(
+                        m::DynamicSlice(m::Parameter(0), m::Reshape(),
+                                        m::Constant())
+                            .WithShapeEqualTo(&tile_shape))));
+}
+
+TEST_F(SpmdPartitionerTest, ReduceTiledAlongReducedDimension) {
+  const char* const kModuleStr = R"(
+HloModule m
+
+sum {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT add = f32[] add(a, b)
+}
+
+ENTRY test {
+  p0 = f32[8,16] parameter(0), sharding={devices=[1,2]0,1}
+  zero = f32[] constant(0)
+  ROOT reduce = f32[8] reduce(p0, zero), dimensions={1}, to_apply=sum
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kModuleStr));
+  SpmdPartitioner partitioner(/*num_partitions=*/2);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, partitioner.Run(module.get()));
+  EXPECT_TRUE(changed);
+  const Shape tile_shape = ShapeUtil::MakeShape(F32, {8, 8});
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, GmockMatch(m::AllReduce(m::Reduce(
+                        m::Parameter(0).WithShapeEqualTo(&tile_shape),
+                        m::Constant()))));
+}
+
+TEST_F(SpmdPartitionerTest, UnevenShardingIsReplicated) {
+  const char* const kModuleStr = R"(
+HloModule m
+
+ENTRY test {
+  p0 = f32[7,16] parameter(0), sharding={devices=[2,1]0,1}
+  ROOT neg = f32[7,16] negate(p0)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kModuleStr));
+  SpmdPartitioner partitioner(/*num_partitions=*/2);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, partitioner.Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+}  // namespace
+}  // namespace xla
@@ -64,14 +64,18 @@ class XRTCompileOp : public OpKernel {
                  std::unique_ptr<xla::LocalExecutable>* program);
 };
 
+// The compilation cache is shared by the devices of the process, so the key
+// names the device as well as the computation.
 Status CompilationCacheKey(const xrt::XLAComputation& computation,
+                           const XRTGenericDeviceAccessor::ScopedRef& device,
                            string* key) {
   const size_t size = computation.ByteSizeLong();
   auto serialized = absl::make_unique<char[]>(size);
   TF_RET_CHECK(
       SerializeToBufferDeterministic(computation, serialized.get(), size));
   uint64 fingerprint = Fingerprint64(absl::string_view(serialized.get(), size));
-  *key = absl::StrCat(fingerprint);
+  *key = absl::StrCat(fingerprint, ":", device.client()->platform()->Name(),
+                      ":", device.device_ordinal());
   return Status::OK();
 }
 
@@ -152,8 +156,12 @@ void XRTCompileOp::Compute(OpKernelContext* ctx) {
       errors::InvalidArgument(
           "Unable to parse computation input to XLAComputation"));
 
+  class XRTGenericDeviceAccessor::ScopedRef device_ref;
+  OP_REQUIRES_OK(ctx,
+                 XRTGenericDeviceAccessor::InitScopedRef(ctx, &device_ref));
+
   string key;
-  OP_REQUIRES_OK(ctx, CompilationCacheKey(computation_proto, &key));
+  OP_REQUIRES_OK(ctx, CompilationCacheKey(computation_proto, device_ref, &key));
 
   // Process-wide cache of XLA executables.
   auto cache_or = GetOrCreateCompilationCache(rm, /*max_number_of_entries=*/0);
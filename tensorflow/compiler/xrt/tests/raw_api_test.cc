@@ -1087,6 +1087,67 @@ TEST(RawApiTest, CompileAndExecuteWithArgumentVector) {
   EXPECT_EQ(program_shape.parameters_size(), 2);
 }
 
+TEST(RawApiTest, ExecuteCompiledProgramInAnotherSession) {
+  xrt::XLAAllocation p0;
+  *p0.mutable_value() = FloatVector({1.0f, 2.0f});
+  xrt::XLAAllocation p1;
+  *p1.mutable_value() = FloatVector({8.0f, 5.0f});
+
+  xrt::XLAComputation c;
+  auto config = c.mutable_config();
+  auto shapes = config->mutable_program_shape();
+  *shapes->add_parameters() =
+      xla::ShapeUtil::MakeShape(xla::F32, {2}).ToProto();
+  *shapes->add_parameters() =
+      xla::ShapeUtil::MakeShape(xla::F32, {2}).ToProto();
+  *shapes->mutable_result() =
+      xla::ShapeUtil::MakeShape(xla::F32, {2}).ToProto();
+  StoreComputationSnapshot(AddAndScale(), c.mutable_hlo_snapshot());
+
+  Scope compile_root = Scope::NewRootScope().WithDevice(DeviceFromFlag());
+  auto computation = ops::Const(compile_root.WithDevice("/device:CPU:0"),
+                                c.SerializeAsString());
+  auto c_handle = ops::XRTCompile(compile_root, computation);
+  TF_ASSERT_OK(compile_root.status());
+
+  std::vector<Tensor> outputs;
+  {
+    XrtClientSession session(compile_root);
+    TF_EXPECT_OK(session.Run({c_handle.handle}, &outputs));
+  }
+  // The compilation cache is shared across sessions, so the handle compiled
+  // above can be executed from a new session.
+  const int64 handle = outputs[0].scalar<int64>()();
+
+  xrt::XRTExecutionConfig e;
+  e.set_release_input_handles(true);
+  e.set_release_compilation_handle(true);
+
+  Scope root = Scope::NewRootScope().WithDevice(DeviceFromFlag());
+  auto e_config =
+      ops::Const(root.WithDevice("/device:CPU:0"), e.SerializeAsString());
+  auto c_handle_value = ops::Const(root.WithDevice("/device:CPU:0"), handle);
+  auto p0_value =
+      ops::Const(root.WithDevice("/device:CPU:0"), p0.SerializeAsString());
+  auto p0_handle = ops::XRTAllocate(root, p0_value);
+  auto p1_value =
+      ops::Const(root.WithDevice("/device:CPU:0"), p1.SerializeAsString());
+  auto p1_handle = ops::XRTAllocate(root, p1_value);
+  auto result = ops::XRTExecute(root, c_handle_value, e_config,
+                                {Output(p0_handle), Output(p1_handle)});
+  auto read_back = ops::XRTReadLiteralAndRelease(root, result);
+  TF_ASSERT_OK(root.status());
+
+  XrtClientSession session(root);
+  TF_EXPECT_OK(session.Run({read_back}, &outputs));
+
+  xla::LiteralProto response;
+  EXPECT_TRUE(response.ParseFromString(outputs[0].scalar<tstring>()()));
+
+  auto expected = xla::LiteralUtil::CreateR1<float>({27.0f, 21.0f});
+  EXPECT_TRUE(CompareLiteralToLiteralProto(expected, response));
+}
+
 TEST(RawApiTest, CompileWithXlaReturnShapes) {
   xla::XlaBuilder builder("XrtXlaShapes");
   auto input_shape = xla::ShapeUtil::MakeShape(xla::BF16, {32, 3, 128, 128});
@@ -38,6 +38,15 @@ int64 GetCompilationCacheSizeFromEnv() {
   return env == nullptr ? 1024 : std::stol(env);
 }
 
+// Returns the cache shared by all the resource managers of the process. It is
+// never deleted, so executables survive the sessions which compiled them.
+XRTCompilationCache* GetProcessWideCompilationCache(
+    int64 max_number_of_entries) {
+  static XRTCompilationCache* cache =
+      new XRTCompilationCache(max_number_of_entries);
+  return cache;
+}
+
 }  // namespace
 
 const char* kXRTCompilationCacheResourceName = "xrt_compilation_cache";
@@ -295,7 +304,9 @@ xla::StatusOr<RefPtr<XRTCompilationCache>> GetOrCreateCompilationCache(
   TF_RETURN_IF_ERROR(rm->LookupOrCreate<XRTCompilationCache>(
       rm->default_container(), kXRTCompilationCacheResourceName, &cache,
       [&](XRTCompilationCache** new_cache) {
-        *new_cache = new XRTCompilationCache(max_number_of_entries);
+        // The resource manager owns a reference to the shared cache.
+        *new_cache = GetProcessWideCompilationCache(max_number_of_entries);
+        (*new_cache)->Ref();
         return Status::OK();
       }));
   return RefPtr<XRTCompilationCache>(cache);
@@ -234,10 +234,15 @@ class XRTCompilationCache : public ResourceBase {
 };
 
 // Looks up or create an XRTCompilationCache object within the given resource
-// manager, under the default container. The max_number_of_entries sets the
-// maximum number of entries within the cache (which will be LRU-evicted).
-// If max_number_of_entries is set to sero, the size of the cache will be
-// configured using the TF_XRT_COMPILATION_CACHE_SIZE environment variable.
+// manager, under the default container. All the resource managers of the
+// process share the same cache, so that the handles of compiled programs are
+// valid across sessions and a program compiled by one session is not compiled
+// again by the next; cache keys must therefore identify the device. The
+// max_number_of_entries sets the maximum number of entries within the cache
+// (which will be LRU-evicted), and only applies to the call creating the
+// shared cache. If max_number_of_entries is set to sero, the size of the cache
+// will be configured using the TF_XRT_COMPILATION_CACHE_SIZE environment
+// variable.
 xla::StatusOr<RefPtr<XRTCompilationCache>> GetOrCreateCompilationCache(
     ResourceMgr* rm, int64 max_number_of_entries);
 
@@ -24,9 +24,9 @@ limitations under the License.
 
 namespace tensorflow {
 
-// This accessor is used for XLA CPU/GPU. It uses the device resource manager,
-// so e.g., on multi-GPU setups the compilation cache will not be shared across
-// devices.
+// This accessor is used for XLA CPU/GPU. It uses the device resource manager.
+// The compilation cache is shared across devices, but its entries are keyed by
+// device, so e.g., on multi-GPU setups each device compiles its own programs.
 class XRTGenericDeviceAccessor {
  public:
   static Status GetResourceManager(OpKernelContext* ctx, ResourceMgr** rm);
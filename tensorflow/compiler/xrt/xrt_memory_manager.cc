@@ -20,6 +20,7 @@ limitations under the License.
 #include <unordered_map>
 
 #include "absl/memory/memory.h"
+#include "tensorflow/compiler/xrt/xrt_pooled_allocator.h"
 #include "tensorflow/core/lib/random/random.h"
 
 namespace tensorflow {
@@ -258,9 +259,14 @@ void XRTMemoryManager::ReleaseAllAllocations() {
 
 xla::StatusOr<se::OwningDeviceMemory> XRTMemoryManager::Allocate(
     xla::Backend* backend, int device_ordinal, size_t size) {
-  se::DeviceMemoryAllocator* allocator = backend->memory_allocator();
+  XRTPooledAllocator* allocator = XRTPooledAllocator::Get(backend);
   auto memory_or =
       allocator->Allocate(device_ordinal, size, /*retry_on_failure=*/false);
+  if (memory_or.status().code() == error::RESOURCE_EXHAUSTED &&
+      allocator->ReleasePooledMemory(device_ordinal) > 0) {
+    memory_or =
+        allocator->Allocate(device_ordinal, size, /*retry_on_failure=*/false);
+  }
   if (memory_or.status().code() == error::RESOURCE_EXHAUSTED) {
     VLOG(4) << "Allocate of " << size << " bytes failed on device "
             << device_ordinal;
@@ -317,6 +323,14 @@ Status XRTMemoryManager::TryFreeMemoryStep(MemoryReclaimContext* mrctx,
   if (device_context == nullptr) {
     return status;
   }
+  if (!mrctx->done_releasing_pool) {
+    // Buffers kept for reuse by the pooled allocator are the cheapest to free.
+    mrctx->done_releasing_pool = true;
+    if (XRTPooledAllocator::Get(mrctx->backend)
+            ->ReleasePooledMemory(mrctx->device_ordinal) > 0) {
+      return Status::OK();
+    }
+  }
   if (!mrctx->done_freeing) {
     // If the caller passed us a zero requested_free_size, we try to free chunks
     // of kMaxFreeSize memory, until either the run function suceeds, or we run
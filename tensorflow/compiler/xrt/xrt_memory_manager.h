@@ -102,7 +102,8 @@ class XRTMemoryManager : public ResourceBase {
   void ReleaseAllAllocations();
 
   // Tries to allocate size bytes of device memory from the device_ordinal
-  // device. Might attempt to free some unpinned device memory, if the underline
+  // device, through the XRTPooledAllocator of the backend. Might attempt to
+  // free the pooled buffers and some unpinned device memory, if the underline
   // allocator call fails, and try the allocation again.
   xla::StatusOr<se::OwningDeviceMemory> Allocate(xla::Backend* backend,
                                                  int device_ordinal,
@@ -138,6 +139,7 @@ class XRTMemoryManager : public ResourceBase {
     const int device_ordinal = 0;
     const size_t requested_free_size = 0;
     size_t free_size = 0;
+    bool done_releasing_pool = false;
     bool done_freeing = false;
     bool done_compacting = false;
   };
@@ -0,0 +1,158 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xrt/xrt_pooled_allocator.h"
+
+#include <stdlib.h>
+
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+
+namespace tensorflow {
+
+namespace {
+
+size_t GetDeviceMemoryPoolSizeFromEnv() {
+  const char* env = getenv("TF_XRT_DEVICE_MEMORY_POOL_SIZE");
+  return env == nullptr ? (256 << 20) : std::stoull(env);
+}
+
+}  // namespace
+
+XRTPooledAllocator::XRTPooledAllocator(se::DeviceMemoryAllocator* allocator,
+                                       size_t max_pooled_bytes)
+    : se::DeviceMemoryAllocator(allocator->platform()),
+      allocator_(allocator),
+      max_pooled_bytes_(max_pooled_bytes) {}
+
+XRTPooledAllocator::~XRTPooledAllocator() {
+  for (const PooledBuffer& buffer : buffers_) {
+    TF_CHECK_OK(allocator_->Deallocate(buffer.device_ordinal, buffer.memory));
+  }
+}
+
+/* static */ XRTPooledAllocator* XRTPooledAllocator::Get(
+    xla::Backend* backend) {
+  static mutex* lock = new mutex();
+  static auto* allocators =
+      new absl::flat_hash_map<const xla::Backend*, XRTPooledAllocator*>();
+  mutex_lock l(*lock);
+  XRTPooledAllocator*& allocator = (*allocators)[backend];
+  if (allocator == nullptr) {
+    allocator = new XRTPooledAllocator(backend->memory_allocator(),
+                                       GetDeviceMemoryPoolSizeFromEnv());
+  }
+  return allocator;
+}
+
+xla::StatusOr<se::OwningDeviceMemory> XRTPooledAllocator::Allocate(
+    int device_ordinal, uint64 size, bool retry_on_failure,
+    int64 memory_space) {
+  if (size == 0 || memory_space != 0) {
+    return allocator_->Allocate(device_ordinal, size, retry_on_failure,
+                                memory_space);
+  }
+  {
+    mutex_lock lock(lock_);
+    auto it = buffers_by_size_.find(SizeKey(device_ordinal, size));
+    if (it != buffers_by_size_.end()) {
+      // Hand out the most recently pooled buffer, which is the most likely to
+      // still be in the caches.
+      se::DeviceMemoryBase memory = TakeLocked(it->second.back());
+      VLOG(3) << "Reusing pooled buffer " << memory.opaque() << " of " << size
+              << " bytes on device " << device_ordinal;
+      return se::OwningDeviceMemory(memory, device_ordinal, this);
+    }
+  }
+  TF_ASSIGN_OR_RETURN(se::OwningDeviceMemory memory,
+                      allocator_->Allocate(device_ordinal, size,
+                                           retry_on_failure, memory_space));
+  // Deallocations of the new buffer go through the pool.
+  return se::OwningDeviceMemory(memory.Release(), device_ordinal, this);
+}
+
+Status XRTPooledAllocator::Deallocate(int device_ordinal,
+                                      se::DeviceMemoryBase mem) {
+  if (mem.is_null() || mem.size() > max_pooled_bytes_) {
+    return allocator_->Deallocate(device_ordinal, mem);
+  }
+  std::vector<PooledBuffer> evicted;
+  {
+    mutex_lock lock(lock_);
+    auto it =
+        buffers_.insert(buffers_.end(), PooledBuffer{device_ordinal, mem});
+    buffers_by_size_[SizeKey(device_ordinal, mem.size())].push_back(it);
+    pooled_bytes_ += mem.size();
+    while (pooled_bytes_ > max_pooled_bytes_) {
+      const int evicted_ordinal = buffers_.front().device_ordinal;
+      evicted.push_back(
+          PooledBuffer{evicted_ordinal, TakeLocked(buffers_.begin())});
+    }
+  }
+  Status status;
+  for (const PooledBuffer& buffer : evicted) {
+    status.Update(allocator_->Deallocate(buffer.device_ordinal, buffer.memory));
+  }
+  return status;
+}
+
+size_t XRTPooledAllocator::ReleasePooledMemory(int device_ordinal) {
+  std::vector<se::DeviceMemoryBase> released;
+  {
+    mutex_lock lock(lock_);
+    for (auto it = buffers_.begin(); it != buffers_.end();) {
+      auto next = std::next(it);
+      if (it->device_ordinal == device_ordinal) {
+        released.push_back(TakeLocked(it));
+      }
+      it = next;
+    }
+  }
+  size_t released_bytes = 0;
+  for (const se::DeviceMemoryBase& memory : released) {
+    released_bytes += memory.size();
+    TF_CHECK_OK(allocator_->Deallocate(device_ordinal, memory));
+  }
+  VLOG(3) << "Released " << released_bytes << " pooled bytes on device "
+          << device_ordinal;
+  return released_bytes;
+}
+
+se::DeviceMemoryBase XRTPooledAllocator::TakeLocked(BufferList::iterator it) {
+  auto by_size_it =
+      buffers_by_size_.find(SizeKey(it->device_ordinal, it->memory.size()));
+  CHECK(by_size_it != buffers_by_size_.end());
+  // Buffers are only taken out as the least or most recently pooled buffer of
+  // their device and size, i.e. from the front or back of their deque.
+  std::deque<BufferList::iterator>& same_size = by_size_it->second;
+  if (same_size.back() == it) {
+    same_size.pop_back();
+  } else {
+    CHECK(same_size.front() == it);
+    same_size.pop_front();
+  }
+  if (same_size.empty()) {
+    buffers_by_size_.erase(by_size_it);
+  }
+  se::DeviceMemoryBase memory = it->memory;
+  pooled_bytes_ -= memory.size();
+  buffers_.erase(it);
+  return memory;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,108 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XRT_XRT_POOLED_ALLOCATOR_H_
+#define TENSORFLOW_COMPILER_XRT_XRT_POOLED_ALLOCATOR_H_
+
+#include <deque>
+#include <list>
+#include <map>
+#include <utility>
+
+#include "tensorflow/compiler/xla/service/backend.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/stream_executor/device_memory_allocator.h"
+
+namespace tensorflow {
+
+// A device memory allocator which keeps the buffers deallocated through it in
+// a pool, and hands them out again to allocations of the same size on the same
+// device, instead of going back to the wrapped allocator. Clients running the
+// same small computations over and over allocate the same sizes over and over,
+// so most of their allocations are served from the pool.
+//
+// At most max_pooled_bytes bytes are kept in the pool; the least recently
+// pooled buffers are returned to the wrapped allocator beyond that.
+//
+// Buffers are pooled as soon as they are deallocated, so this may only be used
+// by clients which deallocate a buffer once the device is done with it, as XRT
+// does (executions and transfers block until they complete).
+class XRTPooledAllocator : public se::DeviceMemoryAllocator {
+ public:
+  XRTPooledAllocator(se::DeviceMemoryAllocator* allocator,
+                     size_t max_pooled_bytes);
+  ~XRTPooledAllocator() override;
+
+  // Returns the process-wide pooled allocator wrapping the memory allocator of
+  // `backend`. Its pool size is read from the TF_XRT_DEVICE_MEMORY_POOL_SIZE
+  // environment variable, in bytes.
+  static XRTPooledAllocator* Get(xla::Backend* backend);
+
+  xla::StatusOr<se::OwningDeviceMemory> Allocate(int device_ordinal,
+                                                 uint64 size,
+                                                 bool retry_on_failure,
+                                                 int64 memory_space) override;
+  using se::DeviceMemoryAllocator::Allocate;
+
+  Status Deallocate(int device_ordinal, se::DeviceMemoryBase mem) override;
+
+  bool AllowsAsynchronousDeallocation() const override {
+    return allocator_->AllowsAsynchronousDeallocation();
+  }
+
+  xla::StatusOr<se::Stream*> GetStream(int device_ordinal) override {
+    return allocator_->GetStream(device_ordinal);
+  }
+
+  // Returns the pooled buffers of `device_ordinal` to the wrapped allocator,
+  // and returns the number of bytes released.
+  size_t ReleasePooledMemory(int device_ordinal);
+
+  // Returns the number of bytes held in the pool.
+  size_t pooled_bytes() const {
+    mutex_lock lock(lock_);
+    return pooled_bytes_;
+  }
+
+ private:
+  struct PooledBuffer {
+    int device_ordinal;
+    se::DeviceMemoryBase memory;
+  };
+  using BufferList = std::list<PooledBuffer>;
+  // Device ordinal and size in bytes.
+  using SizeKey = std::pair<int, uint64>;
+
+  // Removes `it` from the pool and returns its memory.
+  se::DeviceMemoryBase TakeLocked(BufferList::iterator it)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  se::DeviceMemoryAllocator* const allocator_;
+  const size_t max_pooled_bytes_;
+
+  mutable mutex lock_;
+  // The pooled buffers, least recently pooled first.
+  BufferList buffers_ GUARDED_BY(lock_);
+  // The pooled buffers of each device and size, least recently pooled first.
+  std::map<SizeKey, std::deque<BufferList::iterator>> buffers_by_size_
+      GUARDED_BY(lock_);
+  size_t pooled_bytes_ GUARDED_BY(lock_) = 0;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_XRT_XRT_POOLED_ALLOCATOR_H_
@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/backend.h"
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xrt/xrt_memory_manager.h"
+#include "tensorflow/compiler/xrt/xrt_pooled_allocator.h"
 
 namespace tensorflow {
 namespace {
@@ -93,7 +94,8 @@ Status AllocateScopedShapedBuffer(
   // it goes out of scope. That's useful if we return early as the result of an
   // error allocating one of the later buffers.
   *buffer = absl::make_unique<xla::ScopedShapedBuffer>(
-      shape, on_device_shape, backend->memory_allocator(), device_ordinal);
+      shape, on_device_shape, XRTPooledAllocator::Get(backend),
+      device_ordinal);
   for (auto& index_to_buffer : (*buffer)->buffers()) {
     const xla::Shape& subshape =
         xla::ShapeUtil::GetSubshape(on_device_shape, index_to_buffer.first);
@@ -184,12 +186,12 @@ void XRTTupleAllocation::ReleaseBuffers() {
   // call. To avoid a leak, there must be no error-case returns from here until
   // the end of the method.
   auto shaped_buffer = scoped_buffer->release();
-  *allocation = new XRTTupleAllocation(
-      device_ordinal, backend->memory_allocator(),
-      shaped_buffer.on_host_shape(), shaped_buffer.on_device_shape());
+  auto allocator = XRTPooledAllocator::Get(backend);
+  *allocation = new XRTTupleAllocation(device_ordinal, allocator,
+                                       shaped_buffer.on_host_shape(),
+                                       shaped_buffer.on_device_shape());
   (*allocation)
-      ->InitializeFromShapedBuffer(shaped_buffer, backend->memory_allocator(),
-                                   device_ordinal);
+      ->InitializeFromShapedBuffer(shaped_buffer, allocator, device_ordinal);
   (*allocation)->SetDeviceMemorySize();
   return Status::OK();
 }
@@ -207,12 +209,12 @@ void XRTTupleAllocation::ReleaseBuffers() {
   // call. To avoid a leak, there must be no error-case returns from here until
   // the end of the method.
   auto shaped_buffer = scoped_buffer->release();
-  *allocation = new XRTTupleAllocation(
-      device_ordinal, backend->memory_allocator(),
-      shaped_buffer.on_host_shape(), shaped_buffer.on_device_shape());
+  auto allocator = XRTPooledAllocator::Get(backend);
+  *allocation = new XRTTupleAllocation(device_ordinal, allocator,
+                                       shaped_buffer.on_host_shape(),
+                                       shaped_buffer.on_device_shape());
   (*allocation)
-      ->InitializeFromShapedBuffer(shaped_buffer, backend->memory_allocator(),
-                                   device_ordinal);
+      ->InitializeFromShapedBuffer(shaped_buffer, allocator, device_ordinal);
   (*allocation)->SetDeviceMemorySize();
   return Status::OK();
 }
@@ -220,7 +222,7 @@ void XRTTupleAllocation::ReleaseBuffers() {
 /*static*/ Status XRTTupleAllocation::CreateFromBuffer(
     const xla::ShapedBuffer& shaped_buffer, xla::Backend* backend,
     int device_ordinal, XRTTupleAllocation** allocation) {
-  auto allocator = backend->memory_allocator();
+  auto allocator = XRTPooledAllocator::Get(backend);
 
   *allocation = new XRTTupleAllocation(device_ordinal, allocator,
                                        shaped_buffer.on_host_shape(),
@@ -307,7 +309,7 @@ xla::StatusOr<bool> XRTTupleAllocation::SwapIn(XRTMemoryManager* memory_manager,
         stream.get(), *literal_, *scoped_buffer));
 
     auto shaped_buffer = scoped_buffer->release();
-    InitializeFromShapedBuffer(shaped_buffer, backend->memory_allocator(),
+    InitializeFromShapedBuffer(shaped_buffer, XRTPooledAllocator::Get(backend),
                                device_ordinal());
     literal_ = nullptr;
     return true;
@@ -448,7 +450,7 @@ void XRTTupleAllocation::SetDeviceMemorySize() {
     const xla::ShapeTree<ExpandedTupleInput>& elements,
     XRTTupleAllocation** allocation) {
   auto transfer_manager = backend->transfer_manager();
-  auto allocator = backend->memory_allocator();
+  auto allocator = XRTPooledAllocator::Get(backend);
   TF_ASSIGN_OR_RETURN(auto stream, backend->BorrowStream(device_ordinal));
 
   xla::Shape host_shape;
@@ -111,6 +111,10 @@ class BaseCollectiveExecutor : public CollectiveExecutor {
   void ExecuteAsync(OpKernelContext* ctx, const CollectiveParams& col_params,
                     const string& exec_key, StatusCallback done) override;
 
+  void ExecuteAsync(OpKernelContext* ctx, const CollectiveParams& col_params,
+                    const string& exec_key, const Tensor* input,
+                    Tensor* output, StatusCallback done) override;
+
   void CompleteParamsAsync(const string& device, CollectiveParams* cp,
                            CancellationManager* cancel_mgr,
                            StatusCallback done) override;
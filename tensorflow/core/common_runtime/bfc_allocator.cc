@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/bfc_allocator.h"
 
 #include <atomic>
+#include <functional>
+#include <thread>  // NOLINT
 
 #include "tensorflow/core/common_runtime/allocator_retry.h"
 #include "tensorflow/core/lib/core/bits.h"
@@ -30,9 +32,31 @@ limitations under the License.
 #include "tensorflow/core/platform/stacktrace.h"
 #endif
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/bfc_memory_map.pb.h"
 
 namespace tensorflow {
+namespace {
+
+auto* bfc_bytes_in_use = monitoring::Gauge<int64, 1>::New(
+    "/tensorflow/core/bfc_allocator/bytes_in_use",
+    "The number of bytes in use in a BFC allocator.", "allocator");
+
+auto* bfc_peak_bytes_in_use = monitoring::Gauge<int64, 1>::New(
+    "/tensorflow/core/bfc_allocator/peak_bytes_in_use",
+    "The largest number of bytes in use in a BFC allocator.", "allocator");
+
+auto* bfc_allocation_retries = monitoring::Counter<1>::New(
+    "/tensorflow/core/bfc_allocator/allocation_retries",
+    "The number of allocations that a BFC allocator could not serve right "
+    "away, and retried while waiting for memory to be freed.",
+    "allocator");
+
+auto* bfc_allocation_failures = monitoring::Counter<1>::New(
+    "/tensorflow/core/bfc_allocator/allocation_failures",
+    "The number of allocations that a BFC allocator failed.", "allocator");
+
+}  // namespace
 
 BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
                            bool allow_growth, const string& name,
@@ -40,6 +64,10 @@ BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
     : garbage_collection_(garbage_collection),
       sub_allocator_(sub_allocator),
       name_(name),
+      bytes_in_use_cell_(bfc_bytes_in_use->GetCell(name)),
+      peak_bytes_in_use_cell_(bfc_peak_bytes_in_use->GetCell(name)),
+      allocation_retries_cell_(bfc_allocation_retries->GetCell(name)),
+      allocation_failures_cell_(bfc_allocation_failures->GetCell(name)),
       free_chunks_list_(kInvalidChunkHandle),
       next_allocation_id_(1) {
   if (allow_growth) {
@@ -209,6 +237,7 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
   if (r != nullptr) {
     return r;
   } else {
+    allocation_retries_cell_->IncrementBy(1);
     static const int64 kMaxMillisToWait = 10000;  // 10 seconds
     r = retry_helper_.AllocateRaw(
         [this, &allocation_attr](size_t a, size_t nb, bool v) {
@@ -219,13 +248,48 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
           return AllocateRawInternal(a, nb, v, freed_by_count);
         },
         kMaxMillisToWait, unused_alignment, num_bytes);
+    if (r == nullptr) {
+      allocation_failures_cell_->IncrementBy(1);
+    }
     return r;
   }
 }
 
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
+  void* ptr = AllocateRawImpl(unused_alignment, num_bytes, allocation_attr);
+  if (ptr != nullptr) {
+    AddTraceMe("MemoryAllocation", ptr, num_bytes);
+  }
+  return ptr;
+}
+
+void BFCAllocator::AddTraceMe(absl::string_view traceme_name, const void* ptr,
+                              size_t num_bytes) {
+  if (!profiler::TraceMeRecorder::Active(profiler::TraceMeLevel::kInfo)) {
+    return;
+  }
+  string name = strings::StrCat(traceme_name, "#allocator_name=", name_,
+                                ",addr=", reinterpret_cast<uintptr_t>(ptr));
+  if (num_bytes > 0) {
+    strings::StrAppend(&name, ",bytes_requested=", num_bytes,
+                       ",tf_op=", allocating_op_name ? allocating_op_name : "",
+                       ",step_id=", allocating_step_id);
+  }
+  strings::StrAppend(&name, "#");
+  profiler::TraceMe trace_me(std::move(name), profiler::TraceMeLevel::kInfo);
+}
+
+void* BFCAllocator::AllocateRawImpl(
+    size_t unused_alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
   VLOG(1) << "AllocateRaw " << Name() << "  " << num_bytes;
+  if (chunk_cache_ != nullptr) {
+    void* ptr = AllocateFromChunkCache(num_bytes);
+    if (ptr != nullptr) {
+      return ptr;
+    }
+  }
   if (allocation_attr.no_retry_on_failure) {
     // Return immediately upon the first failure if this is for allocating an
     // optional scratch space.
@@ -405,6 +469,15 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     }
   }
 
+  // Chunks parked in the chunk cache are free from the caller's point of view,
+  // so hand them back to the bins before deciding that memory is exhausted.
+  if (chunk_cache_ != nullptr && DrainChunkCache()) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    if (ptr != nullptr) {
+      return ptr;
+    }
+  }
+
   // Reaching this point means that no chunks can satisfy the request. Also,
   // the unallocated bytes cannot satisfy the request. Before giving up, let's
   // try deallocating free regions so that suballocator can combine them with
@@ -475,8 +548,17 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
         stats_.bytes_in_use += chunk->size;
         stats_.peak_bytes_in_use =
             std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+        bytes_in_use_cell_->Set(stats_.bytes_in_use);
+        peak_bytes_in_use_cell_->Set(stats_.peak_bytes_in_use);
         stats_.largest_alloc_size =
             std::max<std::size_t>(stats_.largest_alloc_size, chunk->size);
+        if (chunk_cache_ != nullptr) {
+          RecordLiveBytes(chunk->size);
+          if (chunk->size <= kMaxCachedChunkSize &&
+              timing_counter_ == nullptr) {
+            TrackCacheableChunk(chunk->ptr, chunk->size);
+          }
+        }
 
 #ifdef TENSORFLOW_MEM_DEBUG
         if (ShouldRecordOpName()) {
@@ -549,6 +631,13 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
 void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(1) << "DeallocateRaw " << Name() << " "
           << (ptr ? RequestedSize(ptr) : 0);
+  if (ptr != nullptr) {
+    AddTraceMe("MemoryDeallocation", ptr, 0);
+  }
+  if (chunk_cache_ != nullptr && ptr != nullptr &&
+      DeallocateToChunkCache(ptr)) {
+    return;
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
@@ -564,6 +653,17 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle);
 
+  if (chunk_cache_ != nullptr) {
+    RecordLiveBytes(-static_cast<int64>(ChunkFromHandle(h)->size));
+  }
+  ReleaseChunk(h);
+
+  if (VLOG_IS_ON(4)) {
+    LOG(INFO) << "F: " << RenderOccupancy();
+  }
+}
+
+void BFCAllocator::ReleaseChunk(BFCAllocator::ChunkHandle h) {
   MarkFree(h);
 
   // Consider coalescing it.
@@ -573,9 +673,154 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
   } else {
     InsertFreeChunkIntoBin(TryToCoalesce(h, false));
   }
+}
 
-  if (VLOG_IS_ON(4)) {
-    LOG(INFO) << "F: " << RenderOccupancy();
+void BFCAllocator::EnableChunkCache(size_t max_bytes_per_shard) {
+  CHECK(chunk_cache_ == nullptr) << "Chunk cache already enabled for "
+                                 << Name();
+  {
+    mutex_lock l(lock_);
+    CHECK_EQ(stats_.num_allocs, 0)
+        << "EnableChunkCache must be called before the first allocation";
+  }
+  max_cached_bytes_per_shard_ = max_bytes_per_shard;
+  chunk_cache_.reset(new ChunkCacheShard[kNumChunkCacheShards]);
+}
+
+BFCAllocator::ChunkCacheShard* BFCAllocator::ChunkCacheShardForThread() {
+  static thread_local const size_t shard =
+      std::hash<std::thread::id>()(std::this_thread::get_id()) %
+      kNumChunkCacheShards;
+  return &chunk_cache_[shard];
+}
+
+BFCAllocator::ChunkCacheShard* BFCAllocator::ChunkCacheShardForPtr(
+    const void* ptr) {
+  const uintptr_t p = reinterpret_cast<uintptr_t>(ptr);
+  return &chunk_cache_[(p >> kMinAllocationBits) % kNumChunkCacheShards];
+}
+
+void BFCAllocator::TrackCacheableChunk(void* ptr, size_t size) {
+  ChunkCacheShard* shard = ChunkCacheShardForPtr(ptr);
+  mutex_lock l(shard->mu);
+  shard->cacheable[ptr] = size;
+}
+
+void* BFCAllocator::AllocateFromChunkCache(size_t num_bytes) {
+  if (num_bytes == 0 || timing_counter_ != nullptr) {
+    return nullptr;
+  }
+  const size_t rounded_bytes = RoundedBytes(num_bytes);
+  if (rounded_bytes > kMaxCachedChunkSize) {
+    return nullptr;
+  }
+  void* ptr = nullptr;
+  {
+    ChunkCacheShard* shard = ChunkCacheShardForThread();
+    mutex_lock l(shard->mu);
+    std::vector<void*>& free_chunks =
+        shard->free_chunks[rounded_bytes / kMinAllocationSize - 1];
+    if (free_chunks.empty()) {
+      return nullptr;
+    }
+    ptr = free_chunks.back();
+    free_chunks.pop_back();
+    shard->free_bytes -= rounded_bytes;
+  }
+  {
+    ChunkCacheShard* shard = ChunkCacheShardForPtr(ptr);
+    mutex_lock l(shard->mu);
+    shard->cacheable[ptr] = rounded_bytes;
+  }
+  num_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+  RecordLiveBytes(rounded_bytes);
+  int64 largest = largest_cached_alloc_size_.load(std::memory_order_relaxed);
+  while (largest < static_cast<int64>(rounded_bytes) &&
+         !largest_cached_alloc_size_.compare_exchange_weak(
+             largest, rounded_bytes, std::memory_order_relaxed)) {
+  }
+  return ptr;
+}
+
+bool BFCAllocator::DeallocateToChunkCache(void* ptr) {
+  size_t size = 0;
+  {
+    ChunkCacheShard* shard = ChunkCacheShardForPtr(ptr);
+    mutex_lock l(shard->mu);
+    auto it = shard->cacheable.find(ptr);
+    if (it == shard->cacheable.end()) {
+      return false;
+    }
+    size = it->second;
+    shard->cacheable.erase(it);
+  }
+  RecordLiveBytes(-static_cast<int64>(size));
+
+  // Once the shard is over budget, return half of it to the bins in one batch
+  // so that lock_ is taken once per many frees rather than once per free.
+  std::vector<void*> to_release;
+  {
+    ChunkCacheShard* shard = ChunkCacheShardForThread();
+    mutex_lock l(shard->mu);
+    shard->free_chunks[size / kMinAllocationSize - 1].push_back(ptr);
+    shard->free_bytes += size;
+    if (shard->free_bytes > max_cached_bytes_per_shard_) {
+      const size_t target = max_cached_bytes_per_shard_ / 2;
+      // Release the largest chunks first; they are the most likely to let the
+      // bins coalesce into something useful.
+      for (int i = kNumCachedChunkSizes - 1;
+           i >= 0 && shard->free_bytes > target; --i) {
+        std::vector<void*>& free_chunks = shard->free_chunks[i];
+        while (!free_chunks.empty() && shard->free_bytes > target) {
+          to_release.push_back(free_chunks.back());
+          free_chunks.pop_back();
+          shard->free_bytes -= (i + 1) * kMinAllocationSize;
+        }
+      }
+    }
+  }
+  if (!to_release.empty()) {
+    {
+      mutex_lock l(lock_);
+      for (void* p : to_release) {
+        BFCAllocator::ChunkHandle h = region_manager_.get_handle(p);
+        CHECK(h != kInvalidChunkHandle);
+        ReleaseChunk(h);
+      }
+    }
+    retry_helper_.NotifyDealloc();
+  }
+  return true;
+}
+
+bool BFCAllocator::DrainChunkCache() {
+  bool released = false;
+  for (int s = 0; s < kNumChunkCacheShards; ++s) {
+    ChunkCacheShard* shard = &chunk_cache_[s];
+    mutex_lock l(shard->mu);
+    for (std::vector<void*>& free_chunks : shard->free_chunks) {
+      for (void* p : free_chunks) {
+        BFCAllocator::ChunkHandle h = region_manager_.get_handle(p);
+        CHECK(h != kInvalidChunkHandle);
+        ReleaseChunk(h);
+        released = true;
+      }
+      free_chunks.clear();
+    }
+    shard->free_bytes = 0;
+  }
+  return released;
+}
+
+void BFCAllocator::RecordLiveBytes(int64 delta) {
+  const int64 live =
+      live_bytes_.fetch_add(delta, std::memory_order_relaxed) + delta;
+  if (delta <= 0) {
+    return;
+  }
+  int64 peak = peak_live_bytes_.load(std::memory_order_relaxed);
+  while (peak < live && !peak_live_bytes_.compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
   }
 }
 
@@ -662,6 +907,7 @@ void BFCAllocator::MarkFree(BFCAllocator::ChunkHandle h) {
 
   // Updates the stats.
   stats_.bytes_in_use -= c->size;
+  bytes_in_use_cell_->Set(stats_.bytes_in_use);
 
 #ifdef TENSORFLOW_MEM_DEBUG
   if (ShouldRecordOpName()) {
@@ -819,6 +1065,44 @@ int64 BFCAllocator::AllocationId(const void* ptr) const {
   return c->allocation_id;
 }
 
+bool BFCAllocator::ShouldRelocate(const void* ptr) const {
+  mutex_lock l(lock_);
+  for (const auto& region : region_manager_.regions()) {
+    if (ptr < region.ptr() || ptr >= region.end_ptr()) {
+      continue;
+    }
+    const ChunkHandle h = region.get_handle(ptr);
+    if (h == kInvalidChunkHandle) {
+      return false;
+    }
+    const Chunk* c = ChunkFromHandle(h);
+    if (!c->in_use() || c->ptr != ptr) {
+      return false;
+    }
+    const bool prev_free = c->prev != kInvalidChunkHandle &&
+                           !ChunkFromHandle(c->prev)->in_use();
+    const bool next_free = c->next != kInvalidChunkHandle &&
+                           !ChunkFromHandle(c->next)->in_use();
+    if (!prev_free && !next_free) {
+      return false;
+    }
+    // Mirror the search in FindChunkPtr to see where a fresh allocation of
+    // the same size would land.  Landing in a neighbour would only shift the
+    // chunk, so that does not count.
+    const size_t rounded_bytes = RoundedBytes(c->requested_size);
+    for (BinNum b = BinNumForSize(rounded_bytes); b < kNumBins; ++b) {
+      const Bin* bin = BinFromIndex(b);
+      for (ChunkHandle candidate : bin->free_chunks) {
+        if (ChunkFromHandle(candidate)->size >= rounded_bytes) {
+          return candidate != c->prev && candidate != c->next;
+        }
+      }
+    }
+    return false;
+  }
+  return false;
+}
+
 namespace {
 
 void RenderRegion(char* rendered, const size_t resolution,
@@ -1070,14 +1354,49 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
   mutex_lock l(lock_);
-  return stats_;
+  AllocatorStats stats = stats_;
+  if (chunk_cache_ != nullptr) {
+    stats.num_allocs += num_cache_hits_.load(std::memory_order_relaxed);
+    stats.bytes_in_use = live_bytes_.load(std::memory_order_relaxed);
+    stats.peak_bytes_in_use = peak_live_bytes_.load(std::memory_order_relaxed);
+    stats.largest_alloc_size = std::max(
+        stats.largest_alloc_size,
+        largest_cached_alloc_size_.load(std::memory_order_relaxed));
+  }
+
+  // Chunks within a bin are ordered by size, so the largest free chunk is the
+  // last one of the highest non-empty bin.
+  for (BinNum b = kNumBins - 1; b >= 0; --b) {
+    const Bin* bin = BinFromIndex(b);
+    if (!bin->free_chunks.empty()) {
+      stats.largest_free_block_bytes =
+          ChunkFromHandle(*bin->free_chunks.rbegin())->size;
+      break;
+    }
+  }
+  const int64 free_bytes =
+      static_cast<int64>(total_region_allocated_bytes_) - stats.bytes_in_use;
+  if (free_bytes > 0) {
+    stats.fragmentation =
+        1.0 - static_cast<double>(stats.largest_free_block_bytes) / free_bytes;
+  } else {
+    stats.fragmentation = 0.0;
+  }
+  return stats;
 }
 
 void BFCAllocator::ClearStats() {
   mutex_lock l(lock_);
   stats_.num_allocs = 0;
   stats_.peak_bytes_in_use = stats_.bytes_in_use;
+  peak_bytes_in_use_cell_->Set(stats_.peak_bytes_in_use);
   stats_.largest_alloc_size = 0;
+  if (chunk_cache_ != nullptr) {
+    num_cache_hits_.store(0, std::memory_order_relaxed);
+    peak_live_bytes_.store(live_bytes_.load(std::memory_order_relaxed),
+                           std::memory_order_relaxed);
+    largest_cached_alloc_size_.store(0, std::memory_order_relaxed);
+  }
 }
 
 std::array<BFCAllocator::BinDebugInfo, BFCAllocator::kNumBins>
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_BFC_ALLOCATOR_H_
 
 #include <array>
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <string>
@@ -24,10 +25,13 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/allocator_retry.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/macros.h"
@@ -61,6 +65,10 @@ class BFCAllocator : public Allocator {
     return AllocateRaw(alignment, num_bytes, AllocationAttributes());
   }
 
+  // While the profiler records TraceMe events of level kInfo, allocations and
+  // deallocations are reported as "MemoryAllocation" and "MemoryDeallocation"
+  // events, annotated with the allocator, the address and, for allocations,
+  // the size and the op and step that requested the memory.
   void* AllocateRaw(size_t alignment, size_t num_bytes,
                     const AllocationAttributes& allocation_attr) override;
 
@@ -74,12 +82,37 @@ class BFCAllocator : public Allocator {
 
   int64 AllocationId(const void* ptr) const override;
 
+  // Returns true if 'ptr' is the start of an in-use chunk with a free
+  // neighbour, and a best-fit allocation of its size would be carved out of
+  // some other free chunk, so moving it both fills a hole and lets its current
+  // chunk coalesce.
+  bool ShouldRelocate(const void* ptr) const override;
+
+  // Also reports the largest free chunk and the resulting fragmentation of
+  // the free memory held in regions.
   absl::optional<AllocatorStats> GetStats() override;
 
   void ClearStats() override;
 
   void SetTimingCounter(SharedCounter* sc) { timing_counter_ = sc; }
 
+  // Enables a front-end cache for small chunks.  A freed chunk of at most
+  // kMaxCachedChunkSize bytes is parked in a cache shard picked by the freeing
+  // thread instead of being returned to the bins, and a later request of the
+  // same rounded size from a thread mapped to that shard takes it back without
+  // touching lock_.  Once a shard holds more than 'max_bytes_per_shard' bytes,
+  // half of it is returned to the bins under a single acquisition of lock_.
+  // All shards are drained before the allocator reports an out-of-memory.
+  //
+  // The cache is bypassed while a timing counter is set, since cached chunks
+  // carry no free timestamp.  GetStats() stays exact: cached chunks are
+  // reported as free and cache hits are counted as allocations.
+  // RequestedSize() and AllocationId() of a chunk served from the cache report
+  // the values of the allocation that first took it from a bin.
+  //
+  // Must be called before the first allocation.
+  void EnableChunkCache(size_t max_bytes_per_shard);
+
   void SetSafeFrontier(uint64 count) override;
 
   virtual bool ShouldRecordOpName() const { return false; }
@@ -89,6 +122,13 @@ class BFCAllocator : public Allocator {
  private:
   struct Bin;
 
+  void* AllocateRawImpl(size_t alignment, size_t num_bytes,
+                        const AllocationAttributes& allocation_attr);
+
+  // Reports an allocation or deallocation to the profiler.
+  void AddTraceMe(absl::string_view traceme_name, const void* ptr,
+                  size_t num_bytes);
+
   void* AllocateRawInternal(size_t alignment, size_t num_bytes,
                             bool dump_log_on_failure,
                             uint64 freed_before_count);
@@ -99,6 +139,12 @@ class BFCAllocator : public Allocator {
 
   void DeallocateRawInternal(void* ptr);
 
+  // Returns a cached chunk matching 'num_bytes', or nullptr on a cache miss.
+  void* AllocateFromChunkCache(size_t num_bytes);
+
+  // Parks 'ptr' in the chunk cache, returning false if it is not cacheable.
+  bool DeallocateToChunkCache(void* ptr);
+
   // Chunks whose freed_at_count is later than the safe frontier value are kept
   // on a special list and not subject to merging immediately upon being freed.
   //
@@ -374,6 +420,39 @@ class BFCAllocator : public Allocator {
   // Returns 'bytes' rounded up to the next highest kMinAllocationSize.
   static size_t RoundedBytes(size_t bytes);
 
+  // Chunks up to this size may be held by the chunk cache.  Each cache shard
+  // keeps one free list per multiple of kMinAllocationSize up to this size.
+  static const size_t kMaxCachedChunkSize = 64 << 10;
+  static const int kNumCachedChunkSizes =
+      kMaxCachedChunkSize / kMinAllocationSize;
+  static const int kNumChunkCacheShards = 16;
+
+  struct ChunkCacheShard {
+    mutex mu;
+    // Free chunks held by the cache, indexed by
+    // (chunk size / kMinAllocationSize - 1).
+    std::vector<void*> free_chunks[kNumCachedChunkSizes] GUARDED_BY(mu);
+    size_t free_bytes GUARDED_BY(mu) = 0;
+    // In-use chunks that may be cached once freed, mapped to their chunk
+    // size.  Unlike free lists, which are picked by thread, each chunk is
+    // tracked in the shard picked by its address.
+    std::unordered_map<const void*, size_t> cacheable GUARDED_BY(mu);
+  };
+
+  ChunkCacheShard* ChunkCacheShardForThread();
+  ChunkCacheShard* ChunkCacheShardForPtr(const void* ptr);
+
+  // Records that the in-use chunk at 'ptr' may be cached when freed.
+  void TrackCacheableChunk(void* ptr, size_t size)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns every chunk held by the chunk cache to the bins.  Returns true if
+  // any chunk was returned.
+  bool DrainChunkCache() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Adjusts the exact usage stats kept while the chunk cache is enabled.
+  void RecordLiveBytes(int64 delta);
+
   // Try to add a new memory region that can satisfy an allocation of
   // 'rounded_bytes' bytes.  Returns true on success and false on
   // failure.
@@ -440,6 +519,9 @@ class BFCAllocator : public Allocator {
 
   void MarkFree(ChunkHandle h) EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Marks the in-use chunk 'h' free and returns it to its bin.
+  void ReleaseChunk(ChunkHandle h) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   ChunkHandle TryToCoalesce(ChunkHandle h, bool ignore_freed_at)
       EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
@@ -461,7 +543,7 @@ class BFCAllocator : public Allocator {
   // Structures immutable after construction
   size_t memory_limit_ = 0;
 
-  inline int Log2FloorNonZeroSlow(uint64 n) {
+  inline int Log2FloorNonZeroSlow(uint64 n) const {
     int r = 0;
     while (n > 0) {
       r++;
@@ -471,7 +553,7 @@ class BFCAllocator : public Allocator {
   }
 
   // Returns floor(log2(n)).
-  inline int Log2FloorNonZero(uint64 n) {
+  inline int Log2FloorNonZero(uint64 n) const {
 #if defined(__GNUC__)
     return 63 ^ __builtin_clzll(n);
 #elif defined(PLATFORM_WINDOWS) && (_WIN64)
@@ -487,10 +569,13 @@ class BFCAllocator : public Allocator {
   Bin* BinFromIndex(BinNum index) {
     return reinterpret_cast<Bin*>(&(bins_space_[index * sizeof(Bin)]));
   }
+  const Bin* BinFromIndex(BinNum index) const {
+    return reinterpret_cast<const Bin*>(&(bins_space_[index * sizeof(Bin)]));
+  }
   size_t BinNumToSize(BinNum index) {
     return static_cast<size_t>(256) << index;
   }
-  BinNum BinNumForSize(size_t bytes) {
+  BinNum BinNumForSize(size_t bytes) const {
     uint64 v = std::max<size_t>(bytes, 256) >> kMinAllocationBits;
     int b = std::min(kNumBins - 1, Log2FloorNonZero(v));
     return b;
@@ -515,11 +600,28 @@ class BFCAllocator : public Allocator {
 
   std::unique_ptr<SubAllocator> sub_allocator_;
   string name_;
+
+  // The cells of the monitoring metrics of this allocator, labeled by name_.
+  monitoring::GaugeCell<int64>* bytes_in_use_cell_;
+  monitoring::GaugeCell<int64>* peak_bytes_in_use_cell_;
+  monitoring::CounterCell* allocation_retries_cell_;
+  monitoring::CounterCell* allocation_failures_cell_;
   SharedCounter* timing_counter_ = nullptr;
   std::deque<ChunkHandle> timestamped_chunks_;
 
   std::atomic<uint64> safe_frontier_ = {0};
 
+  // Small-chunk cache; null unless EnableChunkCache() was called.
+  std::unique_ptr<ChunkCacheShard[]> chunk_cache_;
+  size_t max_cached_bytes_per_shard_ = 0;
+
+  // While the chunk cache is enabled, stats_ counts cached chunks as in use
+  // and misses cache hits, so GetStats() reports these instead.
+  std::atomic<int64> live_bytes_ = {0};
+  std::atomic<int64> peak_live_bytes_ = {0};
+  std::atomic<int64> largest_cached_alloc_size_ = {0};
+  std::atomic<int64> num_cache_hits_ = {0};
+
   // Structures mutable after construction
   mutable mutex lock_;
   RegionManager region_manager_ GUARDED_BY(lock_);
@@ -21,6 +21,7 @@ limitations under the License.
 #include <utility>
 
 #include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/types.h"
@@ -63,7 +64,13 @@ const char* GetCollectiveName(const CollectiveParams* cp, bool nccl) {
       return "HierarchicalTreeBroadcast";
 
     case REDUCTION_COLLECTIVE:
-      return nccl ? "NcclReduce" : "RingReduce";
+      if (nccl) return "NcclReduce";
+      // Unless a flat ring is requested, prefer reducing within each task
+      // first when the group spans several tasks.
+      return cp->instance.impl_details.communication_hint != "ring" &&
+                     HierarchicalReducer::IsApplicable(*cp)
+                 ? "HierarchicalReduce"
+                 : "RingReduce";
 
     case GATHER_COLLECTIVE:
       return "RingGather";
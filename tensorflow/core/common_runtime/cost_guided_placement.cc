@@ -0,0 +1,151 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/cost_guided_placement.h"
+
+#include <algorithm>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/costmodel.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace {
+
+// The measurements of a node, merged over the partitions of a cost graph.
+struct MeasuredNode {
+  int64 compute_cost = 0;
+  std::vector<int64> output_sizes;
+};
+
+bool IsOnCpu(const Node* n) {
+  DeviceNameUtils::ParsedName parsed;
+  return DeviceNameUtils::ParseFullName(n->assigned_device_name(), &parsed) &&
+         parsed.has_type && parsed.type == DEVICE_CPU;
+}
+
+// Returns true if the placer was free to place `n` anywhere.
+bool IsMovable(const Node* n) {
+  if (!n->IsOp() || n->IsControlFlow() || n->IsSend() || n->IsRecv() ||
+      !n->requested_device().empty() || n->op_def().is_stateful() ||
+      HasNodeAttr(n->def(), kColocationAttrName)) {
+    return false;
+  }
+  for (DataType dtype : n->input_types()) {
+    if (IsRefType(dtype) || dtype == DT_RESOURCE) return false;
+  }
+  for (DataType dtype : n->output_types()) {
+    if (IsRefType(dtype) || dtype == DT_RESOURCE) return false;
+  }
+  return FindKernelDef(DeviceType(DEVICE_CPU), n->def(), nullptr, nullptr)
+      .ok();
+}
+
+int64 OutputSize(const std::unordered_map<string, MeasuredNode>& measured,
+                 const Node* n, int slot) {
+  auto it = measured.find(n->name());
+  if (it == measured.end() || slot >= it->second.output_sizes.size()) {
+    return 0;
+  }
+  return it->second.output_sizes[slot];
+}
+
+}  // namespace
+
+Status ComputeCostGuidedPlacement(
+    const Graph& graph, const CostGraphDef& costs, const string& cpu_device,
+    const CostGuidedPlacementOptions& options,
+    std::unordered_map<string, string>* placements) {
+  std::unordered_map<string, MeasuredNode> measured;
+  for (const CostGraphDef::Node& cnode : costs.node()) {
+    MeasuredNode& m = measured[cnode.name()];
+    m.compute_cost = std::max(m.compute_cost, cnode.compute_cost());
+    if (m.output_sizes.size() < cnode.output_info_size()) {
+      m.output_sizes.resize(cnode.output_info_size(), 0);
+    }
+    for (int i = 0; i < cnode.output_info_size(); ++i) {
+      m.output_sizes[i] =
+          std::max(m.output_sizes[i], cnode.output_info(i).size());
+    }
+  }
+  auto copy_micros = [&options](int64 bytes) -> int64 {
+    if (bytes <= 0) return 0;
+    return CostModel::CopyTimeEstimate(Bytes(bytes),
+                                       options.copy_latency_millis,
+                                       options.copy_gbps)
+        .value();
+  };
+
+  placements->clear();
+  for (const Node* n : graph.op_nodes()) {
+    if (IsOnCpu(n) || !IsMovable(n)) continue;
+    auto it = measured.find(n->name());
+    if (it == measured.end() ||
+        it->second.compute_cost > options.max_compute_micros) {
+      continue;
+    }
+    const string& device = n->assigned_device_name();
+
+    // The copies between `device` and the host that moving `n` to the host
+    // removes, and those that it adds. The partitioner sends each output once
+    // per destination device.
+    int64 removed_micros = 0;
+    int64 added_micros = 0;
+    std::set<std::pair<const Node*, int>> inputs;
+    std::vector<std::set<string>> output_devices(n->num_outputs());
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge() ||
+          !inputs.emplace(e->src(), e->src_output()).second) {
+        continue;
+      }
+      const string& src_device = e->src()->assigned_device_name();
+      const int64 bytes = OutputSize(measured, e->src(), e->src_output());
+      if (src_device == cpu_device) {
+        removed_micros += copy_micros(bytes);
+      } else if (src_device == device) {
+        added_micros += copy_micros(bytes);
+      }
+    }
+    for (const Edge* e : n->out_edges()) {
+      if (e->IsControlEdge() || !e->dst()->IsOp()) continue;
+      output_devices[e->src_output()].insert(e->dst()->assigned_device_name());
+    }
+    for (int i = 0; i < n->num_outputs(); ++i) {
+      const int64 bytes = OutputSize(measured, n, i);
+      if (output_devices[i].count(cpu_device) > 0) {
+        removed_micros += copy_micros(bytes);
+      }
+      if (output_devices[i].count(device) > 0) {
+        added_micros += copy_micros(bytes);
+      }
+    }
+
+    if (removed_micros > added_micros + it->second.compute_cost) {
+      VLOG(2) << "Moving " << n->name() << " from " << device << " to "
+              << cpu_device << ": " << removed_micros << "us of copies for "
+              << added_micros << "us of copies and "
+              << it->second.compute_cost << "us of compute";
+      (*placements)[n->name()] = cpu_device;
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace tensorflow
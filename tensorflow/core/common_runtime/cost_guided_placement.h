@@ -0,0 +1,60 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_COST_GUIDED_PLACEMENT_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_COST_GUIDED_PLACEMENT_H_
+
+#include <unordered_map>
+
+#include "tensorflow/core/framework/cost_graph.pb.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+struct CostGuidedPlacementOptions {
+  // Only nodes measured to run for at most this many microseconds are moved.
+  int64 max_compute_micros = 50;
+
+  // The linear model of the copies between the host and the devices, see
+  // CostModel::CopyTimeEstimate.
+  double copy_latency_millis = 0.01;
+  double copy_gbps = 64.0;
+};
+
+// Picks the nodes of the placed `graph` that run faster on the host device
+// `cpu_device` than on the device they are assigned to, according to the
+// execution times and output sizes measured in `costs` (see
+// CostModelManager::AddToCostGraphDef).
+//
+// A node is moved when it is cheap, and when the copies between its device and
+// the host that moving it removes are estimated to take longer than those it
+// adds plus its measured execution time.  Only the nodes that the placer was
+// free to place are considered: nodes with a requested device, stateful nodes,
+// nodes with colocation constraints or with reference or resource edges, and
+// nodes without a CPU kernel keep their device.  The decisions are made
+// independently against the current placement.
+//
+// On success `*placements` maps the names of the nodes to move to
+// `cpu_device`.
+Status ComputeCostGuidedPlacement(
+    const Graph& graph, const CostGraphDef& costs, const string& cpu_device,
+    const CostGuidedPlacementOptions& options,
+    std::unordered_map<string, string>* placements);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_COST_GUIDED_PLACEMENT_H_
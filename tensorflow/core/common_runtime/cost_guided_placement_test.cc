@@ -0,0 +1,119 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/cost_guided_placement.h"
+
+#include <unordered_map>
+
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kCPU[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+constexpr char kGPU[] = "/job:localhost/replica:0/task:0/device:GPU:0";
+
+class DummyOp : public OpKernel {
+ public:
+  explicit DummyOp(OpKernelConstruction* context) : OpKernel(context) {}
+  void Compute(OpKernelContext* context) override {}
+};
+
+REGISTER_OP("CostGuidedTestOp").Input("i: float").Output("o: float");
+REGISTER_KERNEL_BUILDER(Name("CostGuidedTestOp").Device(DEVICE_CPU), DummyOp);
+REGISTER_OP("CostGuidedTestSource").Output("o: float");
+REGISTER_KERNEL_BUILDER(Name("CostGuidedTestSource").Device(DEVICE_CPU),
+                        DummyOp);
+REGISTER_OP("CostGuidedTestDeviceOnlyOp").Input("i: float").Output("o: float");
+
+class CostGuidedPlacementTest : public ::testing::Test {
+ protected:
+  CostGuidedPlacementTest() : graph_(OpRegistry::Global()) {}
+
+  Node* AddNode(const string& name, const string& op, Node* input,
+                const string& device, int64 compute_cost, int64 output_size) {
+    NodeBuilder builder(name, op);
+    if (input != nullptr) builder.Input(input);
+    Node* node;
+    TF_CHECK_OK(builder.Finalize(&graph_, &node));
+    node->set_assigned_device_name(device);
+    CostGraphDef::Node* cnode = costs_.add_node();
+    cnode->set_name(name);
+    cnode->set_device(device);
+    cnode->set_compute_cost(compute_cost);
+    cnode->add_output_info()->set_size(output_size);
+    return node;
+  }
+
+  // Builds host -> `op` -> host, with `op` on the GPU.
+  Node* AddHostRoundTrip(const string& op, int64 compute_cost) {
+    Node* source =
+        AddNode("source", "CostGuidedTestSource", nullptr, kCPU, 10, 1 << 20);
+    Node* node = AddNode("node", op, source, kGPU, compute_cost, 1 << 20);
+    AddNode("sink", "CostGuidedTestOp", node, kCPU, 10, 1 << 20);
+    return node;
+  }
+
+  std::unordered_map<string, string> Place() {
+    std::unordered_map<string, string> placements;
+    TF_CHECK_OK(ComputeCostGuidedPlacement(
+        graph_, costs_, kCPU, CostGuidedPlacementOptions(), &placements));
+    return placements;
+  }
+
+  Graph graph_;
+  CostGraphDef costs_;
+};
+
+TEST_F(CostGuidedPlacementTest, MovesCheapNodeBetweenHostNodes) {
+  AddHostRoundTrip("CostGuidedTestOp", 5);
+  const auto placements = Place();
+  ASSERT_EQ(1, placements.size());
+  EXPECT_EQ(kCPU, placements.at("node"));
+}
+
+TEST_F(CostGuidedPlacementTest, KeepsExpensiveNode) {
+  AddHostRoundTrip("CostGuidedTestOp", 1000);
+  EXPECT_TRUE(Place().empty());
+}
+
+TEST_F(CostGuidedPlacementTest, KeepsNodeWithoutCpuKernel) {
+  AddHostRoundTrip("CostGuidedTestDeviceOnlyOp", 5);
+  EXPECT_TRUE(Place().empty());
+}
+
+TEST_F(CostGuidedPlacementTest, KeepsRequestedNode) {
+  Node* node = AddHostRoundTrip("CostGuidedTestOp", 5);
+  node->set_requested_device(kGPU);
+  EXPECT_TRUE(Place().empty());
+}
+
+TEST_F(CostGuidedPlacementTest, KeepsNodeFeedingDevice) {
+  // The output of `node` is 4x larger than its input, and is consumed on the
+  // GPU: moving it would copy more than it saves.
+  Node* source =
+      AddNode("source", "CostGuidedTestSource", nullptr, kCPU, 10, 1 << 20);
+  Node* node = AddNode("node", "CostGuidedTestOp", source, kGPU, 5, 4 << 20);
+  AddNode("consumer", "CostGuidedTestOp", node, kGPU, 10, 1 << 20);
+  EXPECT_TRUE(Place().empty());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/direct_session.h"
 
+#include <algorithm>
 #include <atomic>
 #include <string>
 #include <vector>
@@ -23,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/collective_executor_mgr.h"
 #include "tensorflow/core/common_runtime/collective_param_resolver_local.h"
 #include "tensorflow/core/common_runtime/constant_folding.h"
+#include "tensorflow/core/common_runtime/cost_guided_placement.h"
 #include "tensorflow/core/common_runtime/debugger_state_interface.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/device_resolver_local.h"
@@ -30,12 +32,14 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/graph_optimizer.h"
+#include "tensorflow/core/common_runtime/memory_compaction.h"
 #include "tensorflow/core/common_runtime/memory_types.h"
 #include "tensorflow/core/common_runtime/metrics.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -59,6 +63,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/core/threadpool_options.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/random/random.h"
@@ -447,6 +452,45 @@ Status DirectSession::ExtendLocked(GraphDef graph) {
   return Status::OK();
 }
 
+Status DirectSession::PlaceWithMeasuredCosts(const CostGraphDef& cost_graph) {
+  {
+    mutex_lock l(graph_state_lock_);
+    const Graph* graph = execution_state_->full_graph();
+    if (graph == nullptr) {
+      return errors::FailedPrecondition(
+          "Cost-guided placement is not supported when `place_pruned_graph` "
+          "is true.");
+    }
+    std::unordered_map<string, string> placements;
+    TF_RETURN_IF_ERROR(ComputeCostGuidedPlacement(
+        *graph, cost_graph, device_set_.client_device()->name(),
+        CostGuidedPlacementOptions(), &placements));
+    VLOG(1) << "Cost-guided placement moves " << placements.size()
+            << " nodes to " << device_set_.client_device()->name();
+    if (placements.empty()) return Status::OK();
+    std::unique_ptr<GraphExecutionState> state;
+    TF_RETURN_IF_ERROR(execution_state_->Replace(placements, &state));
+    execution_state_.swap(state);
+  }
+
+  // Keep the executors of the pending partial runs, which look them up by
+  // signature.
+  mutex_lock l(executor_lock_);
+  std::unordered_set<string> partial_run_keys;
+  for (const auto& it : partial_runs_) {
+    partial_run_keys.insert(it.first.substr(0, it.first.find(';')));
+  }
+  for (auto it = executors_.begin(); it != executors_.end();) {
+    if (partial_run_keys.count(it->first) > 0) {
+      ++it;
+    } else {
+      retired_executors_.push_back(std::move(it->second));
+      it = executors_.erase(it);
+    }
+  }
+  return Status::OK();
+}
+
 Status DirectSession::Run(const NamedTensorList& inputs,
                           const std::vector<string>& output_names,
                           const std::vector<string>& target_nodes,
@@ -591,10 +635,18 @@ Status DirectSession::RunInternal(
           ((measure_step_count + 1) % build_cost_model_every == 0);
     }
   }
-  if (do_trace || update_cost_model ||
+  // Measure the first steps of the signature for the cost-guided placement.
+  const int64 placement_warmup_steps =
+      options_.config.experimental().cost_guided_placement_warmup_steps();
+  const bool measure_for_placement =
+      placement_warmup_steps > 0 && !cost_guided_placement_done_ &&
+      executor_step_count < placement_warmup_steps;
+  if (do_trace || update_cost_model || measure_for_placement ||
       run_options.report_tensor_allocations_upon_oom()) {
-    run_state.collector.reset(
-        new StepStatsCollector(run_metadata->mutable_step_stats()));
+    run_state.collector.reset(new StepStatsCollector(
+        run_metadata->mutable_step_stats(),
+        /*collect_hardware_counters=*/run_options.trace_level() >=
+            RunOptions::HARDWARE_TRACE));
     args.stats_collector = run_state.collector.get();
   }
 
@@ -657,7 +709,8 @@ Status DirectSession::RunInternal(
   if (ShouldUseRunHandlerPool(run_options) &&
       run_options.experimental().use_run_handler_pool()) {
     VLOG(1) << "Using RunHandler to scheduler inter-op closures.";
-    handler = GetOrCreateRunHandlerPool(options_)->Get(step_id);
+    handler = GetOrCreateRunHandlerPool(options_)->Get(
+        step_id, run_options.experimental().run_handler_pool_options());
   }
   auto* handler_ptr = handler.get();
 
@@ -675,6 +728,18 @@ Status DirectSession::RunInternal(
     };
   }
 
+  // The step-scoped arenas of the CPU partitions, reset once all the
+  // executors are done.
+  std::vector<StepArenaAllocator*> step_arenas;
+  auto reset_step_arenas = gtl::MakeCleanup([&step_arenas]() {
+    for (StepArenaAllocator* arena : step_arenas) {
+      arena->Reset();
+      arena->Unref();
+    }
+  });
+  const bool use_step_arena_allocator =
+      options_.config.experimental().use_step_arena_allocator();
+
   for (const auto& item : executors_and_keys->items) {
     // TODO(azaks): support partial run.
     // TODO(azaks): if the device picks its own threadpool, we need to assign
@@ -693,6 +758,13 @@ Status DirectSession::RunInternal(
     if (handler != nullptr) {
       args.user_intra_op_threadpool = handler->AsIntraThreadPoolInterface();
     }
+    args.step_allocator = nullptr;
+    if (use_step_arena_allocator &&
+        item.device->device_type() == DEVICE_CPU) {
+      step_arenas.push_back(new StepArenaAllocator(
+          item.device->GetAllocator(AllocatorAttributes())));
+      args.step_allocator = step_arenas.back();
+    }
 
     item.executor->RunAsync(args, barrier->Get());
   }
@@ -730,8 +802,30 @@ Status DirectSession::RunInternal(
     run_state.collector->Finalize();
   }
 
+  const float compaction_threshold =
+      options_.config.experimental()
+          .memory_compaction_fragmentation_threshold();
+  if (compaction_threshold > 0) {
+    absl::flat_hash_set<Device*> compacted_devices;
+    for (const auto& item : executors_and_keys->items) {
+      if (!compacted_devices.insert(item.device).second) continue;
+      int64 bytes_relocated = 0;
+      Status s = MaybeCompactResourceVariables(
+          item.device, compaction_threshold, &bytes_relocated);
+      if (!s.ok()) {
+        // The step itself succeeded, so a failed compaction only loses the
+        // chance to defragment.
+        LOG(WARNING) << "Memory compaction of " << item.device->name()
+                     << " failed: " << s;
+      } else if (bytes_relocated > 0) {
+        VLOG(1) << "Relocated " << bytes_relocated << " bytes of variables on "
+                << item.device->name();
+      }
+    }
+  }
+
   // Build and return the cost model as instructed.
-  if (update_cost_model) {
+  if (update_cost_model || measure_for_placement) {
     // Build the cost model
     std::unordered_map<string, const Graph*> device_to_graph;
     for (const PerPartitionExecutorsAndLib& partition :
@@ -745,10 +839,31 @@ Status DirectSession::RunInternal(
     run_state.collector->BuildCostModel(&cost_model_manager_, device_to_graph);
 
     // annotate stats onto cost graph.
-    CostGraphDef* cost_graph = run_metadata->mutable_cost_graph();
-    for (const auto& item : executors_and_keys->items) {
-      TF_RETURN_IF_ERROR(
-          cost_model_manager_.AddToCostGraphDef(item.graph.get(), cost_graph));
+    if (update_cost_model) {
+      CostGraphDef* cost_graph = run_metadata->mutable_cost_graph();
+      for (const auto& item : executors_and_keys->items) {
+        TF_RETURN_IF_ERROR(cost_model_manager_.AddToCostGraphDef(
+            item.graph.get(), cost_graph));
+      }
+    }
+  }
+
+  // Place the graph again once the warm-up steps have been measured.
+  if (measure_for_placement &&
+      executor_step_count + 1 == placement_warmup_steps &&
+      !cost_guided_placement_done_.exchange(true)) {
+    CostGraphDef cost_graph;
+    {
+      mutex_lock l(executor_lock_);
+      for (const auto& item : executors_and_keys->items) {
+        TF_RETURN_IF_ERROR(cost_model_manager_.AddToCostGraphDef(
+            item.graph.get(), &cost_graph));
+      }
+    }
+    Status s = PlaceWithMeasuredCosts(cost_graph);
+    if (!s.ok()) {
+      // The step itself succeeded, so the session keeps the current placement.
+      LOG(WARNING) << "Cost-guided placement failed: " << s;
     }
   }
 
@@ -768,7 +883,15 @@ Status DirectSession::RunInternal(
       }
     }
   }
-  metrics::UpdateGraphExecTime(options_.env->NowMicros() - start_time_usecs);
+  const uint64 run_time_usecs = options_.env->NowMicros() - start_time_usecs;
+  metrics::UpdateGraphExecTime(run_time_usecs);
+  // Only sessions of identified models are labeled, which keeps the number of
+  // exported time series bounded.
+  if (options_.config.experimental().has_session_metadata()) {
+    metrics::UpdateSessionRunTime(
+        options_.config.experimental().session_metadata().name(),
+        executors_and_keys->metrics_signature, run_time_usecs);
+  }
 
   return Status::OK();
 }
@@ -1258,6 +1381,14 @@ Status DirectSession::CreateExecutors(
   std::unique_ptr<ExecutorsAndKeys> ek(new ExecutorsAndKeys);
 
   ek->callable_options = callable_options;
+  {
+    std::vector<string> signature(callable_options.fetch().begin(),
+                                  callable_options.fetch().end());
+    signature.insert(signature.end(), callable_options.target().begin(),
+                     callable_options.target().end());
+    std::sort(signature.begin(), signature.end());
+    ek->metrics_signature = str_util::Join(signature, ",");
+  }
 
   std::unordered_map<string, std::unique_ptr<Graph>> graphs;
   TF_RETURN_IF_ERROR(CreateGraphs(
@@ -1297,15 +1428,22 @@ Status DirectSession::CreateExecutors(
       nullptr, nullptr, session_metadata));
 
   GraphOptimizer optimizer(optimizer_opts);
-  for (auto iter = graphs.begin(); iter != graphs.end(); ++iter) {
-    const string& partition_name = iter->first;
-    std::unique_ptr<Graph>& partition_graph = iter->second;
-
+  const DebugOptions& debug_options =
+      options.callable_options.run_options().debug_options();
+  const auto executor_type = options_.config.experimental().executor_type();
+  const bool keep_partition_graphs =
+      !options_.config.experimental().disable_output_partition_graphs() ||
+      options_.config.graph_options().build_cost_model() > 0;
+
+  // Optimizes the graph of a partition and creates its executor. The
+  // partitions are independent, so this runs for all of them concurrently.
+  auto create_partition_executor =
+      [&](const string& partition_name,
+          std::unique_ptr<Graph>* partition_graph,
+          ExecutorsAndKeys::PerPartitionExecutorsAndLib* item) -> Status {
     Device* device;
     TF_RETURN_IF_ERROR(device_mgr_->LookupDevice(partition_name, &device));
 
-    ek->items.resize(ek->items.size() + 1);
-    auto* item = &(ek->items.back());
     auto lib = func_info->proc_flr->GetFLR(partition_name);
     if (lib == nullptr) {
       return errors::Internal("Could not find device: ", partition_name);
@@ -1345,30 +1483,58 @@ Status DirectSession::CreateExecutors(
       return Status::OK();
     };
 
-    optimizer.Optimize(lib, options_.env, device, &partition_graph,
+    optimizer.Optimize(lib, options_.env, device, partition_graph,
                        /*shape_map=*/nullptr);
 
     // TensorFlow Debugger (tfdbg) inserts debug nodes in the graph.
-    const DebugOptions& debug_options =
-        options.callable_options.run_options().debug_options();
     if (!debug_options.debug_tensor_watch_opts().empty()) {
       TF_RETURN_IF_ERROR(DecorateAndPublishGraphForDebug(
-          debug_options, partition_graph.get(), params.device));
+          debug_options, partition_graph->get(), params.device));
     }
 
     TF_RETURN_IF_ERROR(EnsureMemoryTypes(DeviceType(device->device_type()),
                                          device->name(),
-                                         partition_graph.get()));
+                                         partition_graph->get()));
 
     item->executor = nullptr;
     item->device = device;
-    auto executor_type = options_.config.experimental().executor_type();
-    TF_RETURN_IF_ERROR(
-        NewExecutor(executor_type, params, *partition_graph, &item->executor));
-    if (!options_.config.experimental().disable_output_partition_graphs() ||
-        options_.config.graph_options().build_cost_model() > 0) {
-      item->graph = std::move(partition_graph);
+    TF_RETURN_IF_ERROR(NewExecutor(executor_type, params, **partition_graph,
+                                   &item->executor));
+    if (keep_partition_graphs) {
+      item->graph = std::move(*partition_graph);
     }
+    return Status::OK();
+  };
+
+  std::vector<std::pair<const string*, std::unique_ptr<Graph>*>> partitions;
+  partitions.reserve(graphs.size());
+  for (auto& partition : graphs) {
+    partitions.emplace_back(&partition.first, &partition.second);
+  }
+  ek->items.resize(partitions.size());
+  std::vector<Status> statuses(partitions.size());
+  // The debugger publishes the graphs of the partitions as it decorates them,
+  // so they are created one at a time when it is enabled.
+  if (partitions.size() > 1 &&
+      debug_options.debug_tensor_watch_opts().empty()) {
+    thread::ThreadPool pool(
+        options_.env, "create_executors",
+        std::min(static_cast<int>(partitions.size()), port::MaxParallelism()));
+    for (size_t i = 0; i < partitions.size(); ++i) {
+      pool.Schedule([&, i]() {
+        statuses[i] = create_partition_executor(
+            *partitions[i].first, partitions[i].second, &ek->items[i]);
+      });
+    }
+    // The destructor of `pool` waits for all the partitions.
+  } else {
+    for (size_t i = 0; i < partitions.size(); ++i) {
+      statuses[i] = create_partition_executor(
+          *partitions[i].first, partitions[i].second, &ek->items[i]);
+    }
+  }
+  for (const Status& s : statuses) {
+    TF_RETURN_IF_ERROR(s);
   }
 
   // Cache the mapping from input/output names to graph elements to
@@ -1468,7 +1634,10 @@ Status DirectSession::GetOrCreateExecutors(
         strings::StrCat(sorted_key, ";", handle_name_counter_value);
   }
 
-  // See if we already have the executors for this run.
+  // See if we already have the executors for this run, or if another thread
+  // is creating them.
+  std::shared_ptr<PendingExecutors> pending;
+  bool create = false;
   {
     mutex_lock l(executor_lock_);
     auto it = executors_.find(sorted_key);
@@ -1478,11 +1647,26 @@ Status DirectSession::GetOrCreateExecutors(
       executors_.emplace(key, it->second);
       return Status::OK();
     }
+    std::shared_ptr<PendingExecutors>& entry = pending_executors_[sorted_key];
+    if (entry == nullptr) {
+      entry = std::make_shared<PendingExecutors>();
+      create = true;
+    }
+    pending = entry;
+  }
+  if (!create) {
+    pending->done.WaitForNotification();
+    TF_RETURN_IF_ERROR(pending->status);
+    mutex_lock l(executor_lock_);
+    executors_.emplace(key, pending->executors_and_keys);
+    *executors_and_keys = pending->executors_and_keys.get();
+    return Status::OK();
   }
 
   // Nothing found, so create the executors and store in the cache.
   // The executor_lock_ is intentionally released while executors are
-  // being created.
+  // being created, so that the executors of other signatures can be created
+  // concurrently.
   CallableOptions callable_options;
   callable_options.mutable_feed()->Reserve(inputs_sorted.size());
   for (const string& input : inputs_sorted) {
@@ -1503,26 +1687,34 @@ Status DirectSession::GetOrCreateExecutors(
       ->set_collective_graph_key(run_state_args->collective_graph_key);
   std::unique_ptr<ExecutorsAndKeys> ek;
   std::unique_ptr<FunctionInfo> func_info;
-  TF_RETURN_IF_ERROR(
-      CreateExecutors(callable_options, &ek, &func_info, run_state_args));
+  Status s = CreateExecutors(callable_options, &ek, &func_info, run_state_args);
 
-  // Reacquire the lock, try to insert into the map.
-  mutex_lock l(executor_lock_);
+  {
+    // Reacquire the lock, try to insert into the map.
+    mutex_lock l(executor_lock_);
+    pending_executors_.erase(sorted_key);
+    pending->status = s;
+    if (s.ok()) {
+      // Another thread may have created the entry before us, in which case we
+      // will reuse the already created one.
+      auto insert_result = executors_.emplace(
+          sorted_key, std::shared_ptr<ExecutorsAndKeys>(std::move(ek)));
+      if (insert_result.second) {
+        functions_.push_back(std::move(func_info));
+      }
 
-  // Another thread may have created the entry before us, in which case we will
-  // reuse the already created one.
-  auto insert_result = executors_.emplace(
-      sorted_key, std::shared_ptr<ExecutorsAndKeys>(std::move(ek)));
-  if (insert_result.second) {
-    functions_.push_back(std::move(func_info));
+      // Insert the value under the original key, so the fast path lookup will
+      // work if the user uses the same order of inputs, outputs, and targets
+      // again.
+      executors_.emplace(key, insert_result.first->second);
+      pending->executors_and_keys = insert_result.first->second;
+      *executors_and_keys = insert_result.first->second.get();
+    }
   }
-
-  // Insert the value under the original key, so the fast path lookup will work
-  // if the user uses the same order of inputs, outputs, and targets again.
-  executors_.emplace(key, insert_result.first->second);
-  *executors_and_keys = insert_result.first->second.get();
-
-  return Status::OK();
+  // Wake up the threads waiting for these executors. Failures are not cached,
+  // so a later call for the same signature tries again.
+  pending->done.Notify();
+  return s;
 }
 
 Status DirectSession::CreateGraphs(
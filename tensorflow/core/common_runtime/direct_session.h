@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/framework/session_state.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -165,6 +166,10 @@ class DirectSession : public Session {
 
     CallableOptions callable_options;
 
+    // The sorted fetches and targets of the callable, used to label the
+    // per-signature latency metrics.
+    string metrics_signature;
+
     int64 collective_graph_key = BuildGraphOptions::kNoCollectiveGraphKey;
   };
 
@@ -262,6 +267,11 @@ class DirectSession : public Session {
   ::tensorflow::Status ExtendLocked(GraphDef graph)
       EXCLUSIVE_LOCKS_REQUIRED(graph_state_lock_);
 
+  // Places the graph again with the execution costs measured in `cost_graph`
+  // (see ComputeCostGuidedPlacement), and drops the cached executors so that
+  // the next steps run with the new placement.
+  ::tensorflow::Status PlaceWithMeasuredCosts(const CostGraphDef& cost_graph);
+
   ::tensorflow::Status ResourceHandleToInputTensor(
       const Tensor& resource_tensor, Tensor* retrieved_tensor);
 
@@ -350,6 +360,23 @@ class DirectSession : public Session {
   std::unordered_map<string, std::shared_ptr<ExecutorsAndKeys>> executors_
       GUARDED_BY(executor_lock_);
 
+  // The executors that are being created for a sorted signature. Callers that
+  // miss the cache while the executors of their signature are being created
+  // wait for them, instead of creating them again. Executors of different
+  // signatures are created concurrently.
+  struct PendingExecutors {
+    Notification done;
+    Status status;
+    std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
+  };
+  std::unordered_map<string, std::shared_ptr<PendingExecutors>>
+      pending_executors_ GUARDED_BY(executor_lock_);
+
+  // The executors dropped from executors_ when the graph was placed again.
+  // Steps that are running may still use them.
+  std::vector<std::shared_ptr<ExecutorsAndKeys>> retired_executors_
+      GUARDED_BY(executor_lock_);
+
   class RunCallableCallFrame;
   struct Callable {
     std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
@@ -404,6 +431,11 @@ class DirectSession : public Session {
   // Manages all the cost models for the graphs executed in this session.
   CostModelManager cost_model_manager_;
 
+  // Set once the graph has been placed again with the costs measured over
+  // the first ConfigProto.Experimental.cost_guided_placement_warmup_steps
+  // steps.
+  std::atomic<bool> cost_guided_placement_done_{false};
+
   // For testing collective graph key generation.
   mutex collective_graph_key_lock_;
   int64 collective_graph_key_ GUARDED_BY(collective_graph_key_lock_) = -1;
@@ -150,6 +150,36 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork) {
   EXPECT_FLOAT_EQ(5.0, mat(0, 0));
 }
 
+TEST_F(DirectSessionMinusAXTest, WarmUp) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  Tensor x(DT_FLOAT, TensorShape({2, 1}));
+  test::FillValues<float>(&x, {2, 1});
+  std::vector<Session::WarmUpSignature> signatures(2);
+  signatures[0].output_tensor_names = {y_ + ":0"};
+  signatures[0].target_node_names = {y_neg_};
+  signatures[1].inputs = {{x_ + ":0", x}};
+  signatures[1].output_tensor_names = {z_ + ":0"};
+  TF_ASSERT_OK(session->WarmUp(signatures));
+
+  // The warmed up signatures run as usual.
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({{x_ + ":0", x}}, {z_ + ":0"}, {}, &outputs));
+  ASSERT_EQ(1, outputs.size());
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({-8, 2}, TensorShape({2, 1})), outputs[0]);
+
+  // The error of a signature which cannot run is returned.
+  signatures.emplace_back();
+  signatures[2].output_tensor_names = {"missing:0"};
+  Status s = session->WarmUp(signatures);
+  EXPECT_FALSE(s.ok());
+  EXPECT_TRUE(absl::StrContains(s.error_message(), "signature 2")) << s;
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_Callable) {
   Initialize({3, 2, -1, 0});
   auto session = CreateSession();
@@ -226,6 +256,31 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_OptimizeForStaticGraph) {
       absl::StrContains(s.error_message(), "optimize_for_static_graph"));
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_StepArenaAllocator) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options(DefaultSessionOptions());
+  options.config.mutable_experimental()->set_use_step_arena_allocator(true);
+  auto session = absl::WrapUnique(NewSession(options));
+
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+  std::vector<std::pair<string, Tensor>> inputs;
+  std::vector<string> output_names = {y_ + ":0"};
+  std::vector<string> target_nodes = {y_neg_};
+  // The fetched outputs must remain valid after the step arenas are reset.
+  std::vector<Tensor> outputs;
+  for (int i = 0; i < 3; ++i) {
+    std::vector<Tensor> step_outputs;
+    TF_ASSERT_OK(
+        session->Run(inputs, output_names, target_nodes, &step_outputs));
+    ASSERT_EQ(1, step_outputs.size());
+    outputs.push_back(step_outputs[0]);
+  }
+  for (const Tensor& output : outputs) {
+    EXPECT_FLOAT_EQ(5.0, output.matrix<float>()(0, 0));
+  }
+}
+
 TEST_F(DirectSessionMinusAXTest,
        RunSimpleNetwork_DisableOutputPartitionGraphs) {
   Initialize({3, 2, -1, 0});
@@ -580,6 +635,41 @@ TEST_F(DirectSessionMinusAXTest, TestPerSessionThreads) {
   delete tp;
 }
 
+TEST_F(DirectSessionMinusAXTest, ConcurrentExecutorCreation) {
+  Initialize({1, 2, 3, 4});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  // Each signature is first run by several threads at once, and the
+  // signatures are created concurrently with each other.
+  const std::vector<std::vector<string>> signatures = {
+      {y_ + ":0"},
+      {y_neg_ + ":0"},
+      {z_ + ":0"},
+      {y_ + ":0", z_ + ":0"},
+      {z_ + ":0", y_ + ":0"}};
+  thread::ThreadPool* tp = new thread::ThreadPool(Env::Default(), "test", 8);
+  for (int i = 0; i < 40; ++i) {
+    const std::vector<string>& output_names = signatures[i % signatures.size()];
+    tp->Schedule([this, &session, &output_names]() {
+      std::vector<Tensor> outputs;
+      TF_ASSERT_OK(session->Run({}, output_names, {}, &outputs));
+      ASSERT_EQ(output_names.size(), outputs.size());
+      for (int j = 0; j < output_names.size(); ++j) {
+        // y = A * x = [3, 7], and the other outputs are its negation.
+        const float sign = output_names[j] == y_ + ":0" ? 1.0 : -1.0;
+        auto mat = outputs[j].matrix<float>();
+        EXPECT_FLOAT_EQ(sign * 3.0, mat(0, 0));
+        EXPECT_FLOAT_EQ(sign * 7.0, mat(1, 0));
+      }
+    });
+  }
+
+  // Wait for the functions to finish.
+  delete tp;
+}
+
 TEST_F(DirectSessionMinusAXTest, TwoCreateCallsFails) {
   Initialize({1, 2, 3, 4});
   auto session = CreateSession();
@@ -668,6 +758,33 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithOpts) {
   EXPECT_EQ(run_metadata.step_stats().dev_stats_size(), 2);
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithHardwareTrace) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  RunOptions run_options;
+  run_options.set_trace_level(RunOptions::HARDWARE_TRACE);
+  RunMetadata run_metadata;
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run(run_options, {}, {y_ + ":0"}, {}, &outputs,
+                            &run_metadata));
+
+  // y = A * x reads a 2x2 and a 2x1 float matrix, and writes a 2x1 one. The
+  // cycle counts depend on the platform, so they are not checked.
+  int num_matmuls = 0;
+  for (const auto& dev_stats : run_metadata.step_stats().dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      if (node_stats.node_name() != y_) continue;
+      ++num_matmuls;
+      EXPECT_EQ(node_stats.hardware_counters().bytes_read(), 24);
+      EXPECT_EQ(node_stats.hardware_counters().bytes_written(), 8);
+    }
+  }
+  EXPECT_EQ(num_matmuls, 1);
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithOpts_Callable) {
   Initialize({3, 2, -1, 0});
   auto session = CreateSession();
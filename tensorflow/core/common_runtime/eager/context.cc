@@ -60,6 +60,14 @@ bool ReadBoolFromEnvVar(StringPiece env_var_name, bool default_val) {
   return default_val;
 }
 
+int64 ReadInt64FromEnvVar(StringPiece env_var_name, int64 default_val) {
+  int64 val;
+  if (tensorflow::ReadInt64FromEnvVar(env_var_name, default_val, &val).ok()) {
+    return val;
+  }
+  return default_val;
+}
+
 auto* eager_context_created =
     monitoring::Gauge<bool, 0>::New("/tensorflow/core/eager_context_created",
                                     "True if an eager context was created.");
@@ -83,6 +91,8 @@ EagerContext::EagerContext(
           device_mgr, opts.env, &opts.config, TF_GRAPH_DEF_VERSION,
           &func_lib_def_, opts.config.graph_options().optimizer_options(),
           thread_pool_.get(), cluster_flr, custom_kernel_creator_)),
+      kernel_cache_capacity_(
+          ReadInt64FromEnvVar("TF_EAGER_KERNEL_CACHE_CAPACITY", 0)),
       log_device_placement_(opts.config.log_device_placement()),
       allow_soft_placement_(opts.config.allow_soft_placement()),
       num_active_steps_(0),
@@ -171,6 +181,8 @@ void EagerContext::ClearCaches() {
     mutex_lock ml(cache_mu_);
     default_executor_.WaitForAllPendingNodes().IgnoreError();
     kernel_cache_.clear();
+    kernel_cache_lru_.clear();
+    kernel_cache_generation_.fetch_add(1, std::memory_order_release);
     for (auto& entry : registered_functions_) {
       entry.second->cached_kernel_keys->clear();
     }
@@ -505,8 +517,14 @@ Status EagerContext::RemoveFunction(const string& func) {
     is_last_ref = registered_function->RefCountIsOne();
     if (is_last_ref) {
       for (auto& key : *registered_function->cached_kernel_keys) {
-        kernel_cache_.erase(key);
+        auto iter = kernel_cache_.find(key);
+        if (iter == kernel_cache_.end()) continue;
+        if (kernel_cache_capacity_ > 0) {
+          kernel_cache_lru_.erase(iter->second.lru_position);
+        }
+        kernel_cache_.erase(iter);
       }
+      kernel_cache_generation_.fetch_add(1, std::memory_order_release);
       registered_functions_.erase(func);
     }
     registered_function->Unref();
@@ -520,12 +538,25 @@ Status EagerContext::RemoveFunction(const string& func) {
 
 core::RefCountPtr<KernelAndDevice> EagerContext::GetCachedKernel(
     Fprint128 cache_key) {
+  if (kernel_cache_capacity_ > 0) {
+    // Marking the kernel as recently used requires an exclusive lock.
+    mutex_lock l(cache_mu_);
+    auto iter = kernel_cache_.find(cache_key);
+    if (iter == kernel_cache_.end()) {
+      return nullptr;
+    }
+    kernel_cache_lru_.splice(kernel_cache_lru_.begin(), kernel_cache_lru_,
+                             iter->second.lru_position);
+    core::RefCountPtr<KernelAndDevice> new_ref(iter->second.kernel.get());
+    new_ref->Ref();
+    return new_ref;
+  }
   tf_shared_lock l(cache_mu_);
   auto iter = kernel_cache_.find(cache_key);
   if (iter == kernel_cache_.end()) {
     return nullptr;
   }
-  core::RefCountPtr<KernelAndDevice> new_ref(iter->second.get());
+  core::RefCountPtr<KernelAndDevice> new_ref(iter->second.kernel.get());
   new_ref->Ref();
   return new_ref;
 }
@@ -535,7 +566,30 @@ void EagerContext::AddKernelToCache(Fprint128 cache_key,
   mutex_lock ml(cache_mu_);
   core::RefCountPtr<KernelAndDevice> new_ref(kernel);
   new_ref->Ref();
-  kernel_cache_[cache_key] = std::move(new_ref);
+  auto iter = kernel_cache_.find(cache_key);
+  if (iter != kernel_cache_.end()) {
+    iter->second.kernel = std::move(new_ref);
+    kernel_cache_generation_.fetch_add(1, std::memory_order_release);
+    if (kernel_cache_capacity_ > 0) {
+      kernel_cache_lru_.splice(kernel_cache_lru_.begin(), kernel_cache_lru_,
+                               iter->second.lru_position);
+    }
+  } else {
+    KernelCacheEntry& entry = kernel_cache_[cache_key];
+    entry.kernel = std::move(new_ref);
+    if (kernel_cache_capacity_ > 0) {
+      entry.lru_position =
+          kernel_cache_lru_.insert(kernel_cache_lru_.begin(), cache_key);
+      while (static_cast<int64>(kernel_cache_.size()) >
+             kernel_cache_capacity_) {
+        // The evicted kernel is destroyed once the operations still running
+        // it drop their references.
+        kernel_cache_.erase(kernel_cache_lru_.back());
+        kernel_cache_lru_.pop_back();
+        kernel_cache_generation_.fetch_add(1, std::memory_order_release);
+      }
+    }
+  }
   auto* registered_function =
       gtl::FindPtrOrNull(registered_functions_, kernel->name());
   // The kernel name can be either a primitive op or a function.
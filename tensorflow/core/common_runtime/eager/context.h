@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstddef>
+#include <list>
 #include <map>
 #include <memory>
 #include <queue>
@@ -193,8 +194,17 @@ class EagerContext : public core::RefCounted {
 
   core::RefCountPtr<KernelAndDevice> GetCachedKernel(Fprint128 cache_key);
 
+  // Adds `kernel` to the cache, evicting the least recently used kernels if
+  // the cache holds more than TF_EAGER_KERNEL_CACHE_CAPACITY kernels.
   void AddKernelToCache(Fprint128 cache_key, KernelAndDevice* kernel);
 
+  // Returns a number that changes whenever a kernel is removed from or
+  // replaced in the cache, so that a kernel found in the cache may be reused
+  // without another lookup for as long as the generation is unchanged.
+  int64 KernelCacheGeneration() const {
+    return kernel_cache_generation_.load(std::memory_order_acquire);
+  }
+
   bool LogDevicePlacement() const { return log_device_placement_; }
   bool AllowSoftPlacement() const { return allow_soft_placement_; }
   bool LogMemory() const { return log_memory_; }
@@ -425,9 +435,19 @@ class EagerContext : public core::RefCounted {
 
     std::unique_ptr<std::vector<Fprint128>> cached_kernel_keys;
   };
-  std::unordered_map<Fprint128, core::RefCountPtr<KernelAndDevice>,
-                     Fprint128Hasher>
-      kernel_cache_ GUARDED_BY(cache_mu_);
+  struct KernelCacheEntry {
+    core::RefCountPtr<KernelAndDevice> kernel;
+    // Position of the key in kernel_cache_lru_.
+    std::list<Fprint128>::iterator lru_position;
+  };
+  std::unordered_map<Fprint128, KernelCacheEntry, Fprint128Hasher> kernel_cache_
+      GUARDED_BY(cache_mu_);
+  // Keys of kernel_cache_, the most recently used first. Only maintained if
+  // kernel_cache_capacity_ is positive.
+  std::list<Fprint128> kernel_cache_lru_ GUARDED_BY(cache_mu_);
+  // Maximum number of cached kernels, or 0 for no limit.
+  const int64 kernel_cache_capacity_;
+  std::atomic<int64> kernel_cache_generation_{0};
   std::unordered_map<string, RegisteredFunction*> registered_functions_
       GUARDED_BY(cache_mu_);
 
@@ -17,11 +17,27 @@ limitations under the License.
 
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
+namespace {
+
+int64 ReadMaxBatchSize() {
+  int64 max_batch_size;
+  Status status = ReadInt64FromEnvVar("TF_EAGER_EXECUTOR_MAX_BATCH_SIZE", 64,
+                                      &max_batch_size);
+  if (!status.ok()) {
+    LOG(WARNING) << "Disabling batching of eager nodes: " << status;
+    return 1;
+  }
+  return max_batch_size;
+}
+
+}  // namespace
 
 EagerExecutor::EagerExecutor(bool async)
     : next_node_id_(0),
+      max_batch_size_(ReadMaxBatchSize()),
       thread_(async ? tensorflow::Env::Default()->StartThread(
                           tensorflow::ThreadOptions(), "eager_async_executor",
                           std::bind(&EagerExecutor::Run, this))
@@ -109,7 +125,7 @@ Status EagerExecutor::AddOrExecute(std::unique_ptr<EagerNode> node) {
     } else {
       status = status_;
       if (status.ok() && Async()) {
-        node_queue_.push(std::move(item));
+        node_queue_.push_back(std::move(item));
         // If there were no previous nodes pending, wake the run thread to
         // start processing requests again.
         if (node_queue_.size() == 1) {
@@ -190,7 +206,7 @@ void EagerExecutor::NodeDone(core::RefCountPtr<NodeItem> item,
       if (Async()) {
         DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
         need_notification = unfinished_nodes_.empty();
-        node_queue_.pop();
+        node_queue_.pop_front();
       } else {
         need_notification = unfinished_nodes_.empty();
       }
@@ -212,7 +228,7 @@ void EagerExecutor::NodeDone(core::RefCountPtr<NodeItem> item,
       }
       while (!node_queue_.empty()) {
         items_to_destroy.push_back(std::move(node_queue_.front()));
-        node_queue_.pop();
+        node_queue_.pop_front();
       }
       for (auto& it : unfinished_nodes_) {
         items_to_destroy.push_back(std::move(it.second));
@@ -259,6 +275,7 @@ void EagerExecutor::Run() {
       gtl::MakeCleanup([this] { thread_exited_notification_.Notify(); });
   while (true) {
     core::RefCountPtr<NodeItem> curr_item;
+    std::vector<core::RefCountPtr<NodeItem>> batch;
     {
       tensorflow::mutex_lock l(node_queue_mutex_);
       while (node_queue_.empty() || !status_.ok()) {
@@ -274,8 +291,13 @@ void EagerExecutor::Run() {
       // and register a notification for its completion.
       curr_item.reset(node_queue_.front().get());
       curr_item->Ref();
+      batch = ScheduleBatchLocked();
+    }
+    if (batch.empty()) {
+      RunItem(std::move(curr_item));
+    } else {
+      RunBatch(std::move(batch));
     }
-    RunItem(std::move(curr_item));
   }
 }
 
@@ -300,7 +322,7 @@ void EagerExecutor::RunItem(core::RefCountPtr<NodeItem> item) {
   if (item->state == NodeState::kPENDING) {
     item->state = NodeState::kSCHEDULED;
     if (!node_queue_.empty() && item.get() == node_queue_.front().get()) {
-      node_queue_.pop();
+      node_queue_.pop_front();
     }
     DVLOG(3) << "Add Node: [id " << item->id << "] to unfinished map.";
     unfinished_nodes_.emplace_hint(unfinished_nodes_.end(), item->id,
@@ -308,4 +330,52 @@ void EagerExecutor::RunItem(core::RefCountPtr<NodeItem> item) {
   }
 }
 
+std::vector<core::RefCountPtr<EagerExecutor::NodeItem>>
+EagerExecutor::ScheduleBatchLocked() {
+  std::vector<core::RefCountPtr<NodeItem>> items;
+  if (max_batch_size_ <= 1 || node_queue_.size() <= 1) return items;
+  AsyncEagerNode* async_node = node_queue_.front()->node->AsAsync();
+  const void* batch_key =
+      async_node == nullptr ? nullptr : async_node->BatchKey();
+  if (batch_key == nullptr) return items;
+  const size_t max_batch_size = static_cast<size_t>(max_batch_size_);
+  size_t batch_size = 1;
+  while (batch_size < node_queue_.size() && batch_size < max_batch_size) {
+    AsyncEagerNode* next = node_queue_[batch_size]->node->AsAsync();
+    if (next == nullptr || next->BatchKey() != batch_key) break;
+    ++batch_size;
+  }
+  if (batch_size == 1) return items;
+  // The nodes are scheduled before any of them runs, since the batch may be
+  // done before the last of them would have reached the front of the queue.
+  for (size_t i = 0; i < batch_size; ++i) {
+    core::RefCountPtr<NodeItem> item = std::move(node_queue_.front());
+    node_queue_.pop_front();
+    item->state = NodeState::kSCHEDULED;
+    items.emplace_back(item.get());
+    items.back()->Ref();
+    unfinished_nodes_.emplace_hint(unfinished_nodes_.end(), item->id,
+                                   std::move(item));
+  }
+  return items;
+}
+
+void EagerExecutor::RunBatch(std::vector<core::RefCountPtr<NodeItem>> items) {
+  AsyncEagerNode* async_node = items.front()->node->AsAsync();
+  std::vector<AsyncEagerNode*> others;
+  // Each item keeps its reference until NodeDone() is called for it.
+  std::vector<NodeItem*> batch;
+  for (auto& item : items) {
+    DVLOG(3) << "Running Node: [id " << item->id << "] in a batch of "
+             << items.size() << " " << item->node->DebugString();
+    if (!batch.empty()) others.push_back(item->node->AsAsync());
+    batch.push_back(item.release());
+  }
+  async_node->RunBatchAsync(others, [this, batch](const Status& status) {
+    for (NodeItem* item : batch) {
+      NodeDone(core::RefCountPtr<NodeItem>(item), status);
+    }
+  });
+}
+
 }  // namespace tensorflow
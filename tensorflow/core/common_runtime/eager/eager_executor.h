@@ -17,9 +17,9 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstddef>
+#include <deque>
 #include <map>
 #include <memory>
-#include <queue>
 #include <string>
 #include <vector>
 
@@ -79,6 +79,21 @@ class AsyncEagerNode : public EagerNode {
 
   AsyncEagerNode* AsAsync() final { return this; }
 
+  // Consecutive nodes that return the same non-null key may be run together by
+  // RunBatchAsync() of the first of them, e.g. to send the operations of
+  // several nodes to a remote worker in a single request. Such nodes must be
+  // of the same class. Returns nullptr, i.e. no batching, by default.
+  virtual const void* BatchKey() const { return nullptr; }
+
+  // Runs this node together with `others`, the nodes added right after it,
+  // which have the same BatchKey(). `done` is called once, when all of them
+  // are done, and all of them will then be cleaned up.
+  virtual void RunBatchAsync(const std::vector<AsyncEagerNode*>& others,
+                             StatusCallback done) {
+    done(errors::Unimplemented("Batching is not supported by ",
+                               DebugString()));
+  }
+
   Status Run() final {
     return errors::Unimplemented("Don't call AsyncEagerNode::Run().");
   }
@@ -168,6 +183,15 @@ class EagerExecutor {
 
   void RunItem(core::RefCountPtr<NodeItem> item);
 
+  // If the node at the front of node_queue_ can be batched with the nodes
+  // following it, moves it and them, up to max_batch_size_ nodes in all, to
+  // unfinished_nodes_ and returns them. Otherwise returns an empty vector.
+  std::vector<core::RefCountPtr<NodeItem>> ScheduleBatchLocked()
+      EXCLUSIVE_LOCKS_REQUIRED(node_queue_mutex_);
+
+  // Runs the nodes returned by ScheduleBatchLocked().
+  void RunBatch(std::vector<core::RefCountPtr<NodeItem>> items);
+
   // The impl of WaitForAllPendingNodes
   // `lock` is the lock that holds node_queue_mutex_.
   Status WaitForAllPendingNodesLocked(mutex_lock* lock)
@@ -183,7 +207,7 @@ class EagerExecutor {
   condition_variable nodes_pending_ GUARDED_BY(node_queue_mutex_);
 
   // Queue of pending NodeItems. Ordered by NodeItem::id.
-  std::queue<core::RefCountPtr<NodeItem>> node_queue_
+  std::deque<core::RefCountPtr<NodeItem>> node_queue_
       GUARDED_BY(node_queue_mutex_);
 
   // Ordered by NodeItem::id.
@@ -209,6 +233,11 @@ class EagerExecutor {
   // current EagerNode.
   ExecutorState state_ GUARDED_BY(node_queue_mutex_) = ExecutorState::kActive;
 
+  // The maximum number of nodes run together by RunBatch(), from the
+  // TF_EAGER_EXECUTOR_MAX_BATCH_SIZE environment variable. Batching is
+  // disabled if it is at most 1.
+  const int64 max_batch_size_;
+
   // Thread object that calls the `Run` method in async mode.This thread runs
   // until state_ is set to kShuttingDown. It is `nullptr` in sync mode.
   const std::unique_ptr<Thread> thread_;
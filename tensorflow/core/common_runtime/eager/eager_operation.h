@@ -51,6 +51,8 @@ class EagerOperation {
       h->Unref();
     }
     inputs_.clear();
+    // The kernel must not outlive the context it was created for.
+    last_kernel_.reset();
   }
 
   void Reset(tensorflow::EagerContext* ctx, const char* op, bool is_function,
@@ -128,6 +130,26 @@ class EagerOperation {
     return remote_func_params_;
   }
 
+  // Returns the kernel last recorded by SetLastKernel() if it was recorded for
+  // `cache_key` at kernel cache `generation`, or nullptr. This lets an
+  // operation that is executed repeatedly skip the kernel cache lookup.
+  core::RefCountPtr<KernelAndDevice> GetLastKernel(Fprint128 cache_key,
+                                                   int64 generation) const {
+    if (last_kernel_ == nullptr || !(last_kernel_key_ == cache_key) ||
+        last_kernel_generation_ != generation) {
+      return nullptr;
+    }
+    last_kernel_->Ref();
+    return core::RefCountPtr<KernelAndDevice>(last_kernel_.get());
+  }
+  void SetLastKernel(Fprint128 cache_key, int64 generation,
+                     KernelAndDevice* kernel) {
+    kernel->Ref();
+    last_kernel_.reset(kernel);
+    last_kernel_key_ = cache_key;
+    last_kernel_generation_ = generation;
+  }
+
 #ifdef TENSORFLOW_MEM_DEBUG
   const char* op_name() const { return op_name_; }
   const char* op_name_ = nullptr;
@@ -145,6 +167,9 @@ class EagerOperation {
   CancellationManager* cancellation_manager_ = nullptr;  // Not owned.
   EagerExecutor* executor_;                              // Not owned.
   absl::optional<EagerRemoteFunctionParams> remote_func_params_;
+  core::RefCountPtr<KernelAndDevice> last_kernel_;
+  Fprint128 last_kernel_key_;
+  int64 last_kernel_generation_ = -1;
 };
 
 inline void EagerOperation::AddInput(tensorflow::TensorHandle* h) {
@@ -539,7 +539,14 @@ Status EagerLocalExecute(EagerOperation* op, TensorHandle** retvals,
     }
   }
 
-  core::RefCountPtr<KernelAndDevice> kernel = ctx->GetCachedKernel(cache_key);
+  // An operation executed again with the same attrs reuses its last kernel,
+  // unless kernels were evicted from the cache since.
+  const int64 kernel_cache_generation = ctx->KernelCacheGeneration();
+  core::RefCountPtr<KernelAndDevice> kernel =
+      op->GetLastKernel(cache_key, kernel_cache_generation);
+  if (kernel == nullptr) {
+    kernel = ctx->GetCachedKernel(cache_key);
+  }
   if (kernel == nullptr) {
     DVLOG(2) << "Creating new kernel for " << op->Name() << " on device "
              << DeviceNameOrUnspecified(op->Device());
@@ -612,6 +619,7 @@ Status EagerLocalExecute(EagerOperation* op, TensorHandle** retvals,
 
     ctx->AddKernelToCache(cache_key, kernel.get());
   }
+  op->SetLastKernel(cache_key, kernel_cache_generation, kernel.get());
   const DataTypeVector& output_dtypes = kernel->output_dtypes();
   const size_t num_outputs = static_cast<int>(output_dtypes.size());
   if (num_outputs > *num_retvals) {
@@ -81,6 +81,9 @@ std::function<void(std::function<void()>)>* KernelAndDevice::get_runner()
 }
 
 KernelAndDeviceFunc::~KernelAndDeviceFunc() {
+  for (Rendezvous* rendezvous : idle_rendezvous_) {
+    rendezvous->Unref();
+  }
   if (handle_ != kInvalidHandle) {
     Status status = pflr_->ReleaseHandle(handle_);
     if (!status.ok()) {
@@ -352,7 +355,7 @@ Status KernelAndDeviceFunc::Run(
   // We don't pass rendezvous from eager context because we can get tensor
   // name collisions in send/recv ops when running multiple instances
   // of the same multi-device function concurrently.
-  Rendezvous* rendezvous = rendezvous_creator_(opts->step_id);
+  Rendezvous* rendezvous = GetRendezvous(opts->step_id);
   opts->rendezvous = rendezvous;
   opts->create_rendezvous = false;
 
@@ -389,10 +392,38 @@ Status KernelAndDeviceFunc::Run(
     done.WaitForNotification();
   }
 
-  rendezvous->Unref();
+  ReleaseRendezvous(rendezvous, status);
   return status;
 }
 
+Rendezvous* KernelAndDeviceFunc::GetRendezvous(int64 step_id) {
+  if (!is_cross_process_) {
+    mutex_lock l(rendezvous_mu_);
+    if (!idle_rendezvous_.empty()) {
+      Rendezvous* rendezvous = idle_rendezvous_.back();
+      idle_rendezvous_.pop_back();
+      return rendezvous;
+    }
+  }
+  return rendezvous_creator_(step_id);
+}
+
+void KernelAndDeviceFunc::ReleaseRendezvous(Rendezvous* rendezvous,
+                                            const Status& status) {
+  // A failed run may have aborted its rendezvous or left tensors in it, and a
+  // cross-process rendezvous belongs to its step. Only a few concurrent runs
+  // need to be served from idle rendezvous.
+  constexpr size_t kMaxIdleRendezvous = 8;
+  if (status.ok() && !is_cross_process_ && !rendezvous->is_cross_process()) {
+    mutex_lock l(rendezvous_mu_);
+    if (idle_rendezvous_.size() < kMaxIdleRendezvous) {
+      idle_rendezvous_.push_back(rendezvous);
+      return;
+    }
+  }
+  rendezvous->Unref();
+}
+
 tensorflow::Device* KernelAndDeviceOp::OutputDevice(int idx) const {
   if (kernel_->output_memory_types()[idx] == HOST_MEMORY) {
     return nullptr;
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 // clang-format off
 // Required for IS_MOBILE_PLATFORM
@@ -39,6 +40,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
 #if !defined(IS_MOBILE_PLATFORM)
 #include "tensorflow/core/protobuf/remote_tensor_handle.pb.h"
@@ -275,6 +278,13 @@ class KernelAndDeviceFunc final : public KernelAndDevice {
   const string& name() const override { return name_; };
 
  private:
+  // Returns a rendezvous for a run of this function with `step_id`, reusing an
+  // idle one when possible.
+  Rendezvous* GetRendezvous(int64 step_id);
+  // Keeps `rendezvous` for later runs if it is reusable after a run that
+  // finished with `status`, and unrefs it otherwise.
+  void ReleaseRendezvous(Rendezvous* rendezvous, const Status& status);
+
   ProcessFunctionLibraryRuntime* const pflr_;  // non-null
   FunctionLibraryRuntime::Handle handle_;
   // Indicates whether the function needs to execute cross process.
@@ -294,6 +304,12 @@ class KernelAndDeviceFunc final : public KernelAndDevice {
 
   std::function<Rendezvous*(const int64)> rendezvous_creator_;
   std::function<int64()> get_op_id_;
+
+  // Rendezvous left by successful runs of a function that runs within this
+  // process. Every send of such a run has been received, so the rendezvous
+  // is empty and can serve another run.
+  mutex rendezvous_mu_;
+  std::vector<Rendezvous*> idle_rendezvous_ GUARDED_BY(rendezvous_mu_);
 };
 
 }  // namespace tensorflow
@@ -24,6 +24,7 @@ limitations under the License.
 
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/ThreadPool"
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
@@ -58,6 +59,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
@@ -128,6 +130,7 @@ void SetReferencedTensors(NodeExecStatsInterface* stats,
 }  // namespace nodestats
 
 class ExecutorImpl;
+class ExecutorWorkQueues;
 class GraphView;
 
 struct EdgeInfo {
@@ -318,6 +321,13 @@ class ExecutorImpl : public Executor {
     CHECK(p.delete_kernel != nullptr);
   }
 
+  // Schedules expensive nodes on up to 'num_workers' work-stealing workers
+  // per step instead of one runner closure per node. See ExecutorWorkQueues.
+  void EnableWorkStealing(int num_workers) {
+    CHECK_GT(num_workers, 0);
+    num_work_stealing_workers_ = num_workers;
+  }
+
   ~ExecutorImpl() override {
     for (int32 i = 0; i < gview_.num_nodes(); i++) {
       NodeItem* item = gview_.node(i);
@@ -396,6 +406,10 @@ class ExecutorImpl : public Executor {
   // A cached value of params_
   bool device_record_tensor_accesses_ = false;
 
+  // Number of work-stealing workers per step, or 0 if work stealing is
+  // disabled.
+  int num_work_stealing_workers_ = 0;
+
   // Root nodes (with no in edges) that should form the initial ready queue
   std::vector<const NodeItem*> root_nodes_;
 
@@ -1236,6 +1250,7 @@ class ExecutorState {
     int64 input_iter = -1;
     bool is_dead = false;
 
+    TaggedNode() : node_item(nullptr) {}
     TaggedNode(const NodeItem* node_item, FrameState* in_frame, int64 in_iter,
                bool dead)
         : node_item(node_item),
@@ -1280,6 +1295,7 @@ class ExecutorState {
   };
 
   struct AsyncState;
+  friend class ExecutorWorkQueues;
 
   const bool vlog_;  // true if VLOG_IS_ON(1). Used to check vlog cheaply.
 
@@ -1297,6 +1313,7 @@ class ExecutorState {
   TensorStore* tensor_store_;
   // Step-local container.
   ScopedStepContainer* step_container_;
+  Allocator* step_allocator_;
   StepStatsCollectorInterface* const stats_collector_;
   const tracing::EventCollector* const event_collector_;
   Context context_;
@@ -1312,6 +1329,9 @@ class ExecutorState {
   Executor::Args::Runner runner_;
   bool sync_on_finish_;
 
+  // Non-null if the executor schedules expensive nodes by work stealing.
+  std::shared_ptr<ExecutorWorkQueues> work_queues_;
+
   // Owned.
 
   // A flag that is set on error after the frame state has been
@@ -1390,6 +1410,9 @@ class ExecutorState {
   void ScheduleReady(const TaggedNodeSeq& ready,
                      TaggedNodeReadyQueue* inline_ready);
 
+  // Arranges for 'tagged_node' to be processed on another thread.
+  void Dispatch(const TaggedNode& tagged_node, int64 scheduled_nsec);
+
   // For debugging/logging only.
   inline void MaybeMarkCompleted(FrameState* frame, int64 iter,
                                  const NodeItem& item);
@@ -1421,6 +1444,152 @@ class ExecutorState {
   }
 };
 
+// Work-stealing queues for the expensive nodes of one step, used by the
+// "WORK_STEALING" executor.
+//
+// Every worker slot owns an Eigen::RunQueue. A worker pushes and pops ready
+// nodes at the front of its own queue without locking, so the successors of a
+// node tend to run on the thread whose cache holds its outputs. When its own
+// queue runs dry, a worker steals from the back of the queues of the other
+// workers. Threads that are not workers of the step (e.g. the thread starting
+// the step, or the thread completing an asynchronous kernel) push at the back
+// of a queue. The runner is only handed a closure when a new worker needs to
+// be started, so once all worker slots are busy, dispatching a node costs
+// neither a closure allocation nor a trip through the threadpool queue.
+//
+// The queues are reference counted by the ExecutorState and by every running
+// worker, since a worker may still check the queues for work after the last
+// node of the step has been processed and the ExecutorState deleted.
+class ExecutorWorkQueues
+    : public std::enable_shared_from_this<ExecutorWorkQueues> {
+ public:
+  struct Task {
+    // Null for an empty task.
+    ExecutorState* state = nullptr;
+    ExecutorState::TaggedNode tagged_node;
+    int64 scheduled_nsec = 0;
+  };
+
+  ExecutorWorkQueues(int num_workers, Executor::Args::Runner runner)
+      : workers_(num_workers), runner_(std::move(runner)) {}
+
+  // Enqueues 'task', and starts a new worker if a worker slot is idle.
+  void Schedule(Task task);
+
+ private:
+  typedef Eigen::RunQueue<Task, 256> Queue;
+
+  struct Worker {
+    // Only the thread running the worker may push or pop at the front.
+    Queue queue;
+    // True while a thread runs the worker.
+    std::atomic<bool> active{false};
+  };
+
+  // Identifies the worker, if any, run by the current thread.
+  struct CurrentWorker {
+    const ExecutorWorkQueues* queues = nullptr;
+    int index = -1;
+  };
+  static CurrentWorker* current_worker() {
+    static thread_local CurrentWorker current;
+    return &current;
+  }
+
+  // Returns true if the calling thread now runs worker 'index'.
+  bool ClaimWorker(int index) {
+    bool expected = false;
+    return workers_[index].active.compare_exchange_strong(expected, true);
+  }
+
+  // Returns the index of a newly claimed worker slot, or -1 if all the
+  // workers are active.
+  int ClaimIdleWorker() {
+    for (int i = 0; i < workers_.size(); ++i) {
+      if (!workers_[i].active.load(std::memory_order_relaxed) &&
+          ClaimWorker(i)) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  bool Empty() const {
+    for (const Worker& worker : workers_) {
+      if (!worker.queue.Empty()) return false;
+    }
+    return true;
+  }
+
+  // Returns the next task for worker 'index', stealing from the other
+  // workers if its own queue is empty.
+  Task Pop(int index) {
+    Task task = workers_[index].queue.PopFront();
+    const int num_workers = workers_.size();
+    for (int i = 1; task.state == nullptr && i < num_workers; ++i) {
+      task = workers_[(index + i) % num_workers].queue.PopBack();
+    }
+    return task;
+  }
+
+  // Processes tasks as worker 'index' until all the queues are empty.
+  void WorkerLoop(int index);
+
+  std::vector<Worker> workers_;
+  const Executor::Args::Runner runner_;
+  std::atomic<uint32> next_queue_{0};
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ExecutorWorkQueues);
+};
+
+void ExecutorWorkQueues::Schedule(Task task) {
+  // Once the task is pushed, it may be processed and the step may complete,
+  // releasing the reference of the ExecutorState, before this call returns.
+  std::shared_ptr<ExecutorWorkQueues> queues = shared_from_this();
+  const CurrentWorker* current = current_worker();
+  if (current->queues == this) {
+    task = workers_[current->index].queue.PushFront(std::move(task));
+  } else {
+    const uint32 index =
+        next_queue_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+    task = workers_[index].queue.PushBack(std::move(task));
+  }
+  if (task.state != nullptr) {
+    // The queue is full: process the node in a closure of its own.
+    runner_([task]() {
+      task.state->Process(task.tagged_node, task.scheduled_nsec);
+    });
+    return;
+  }
+  // Pairs with the fence in WorkerLoop: either a worker is started here, or
+  // an exiting worker observes the task that was just pushed.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const int index = ClaimIdleWorker();
+  if (index >= 0) {
+    runner_([queues, index]() { queues->WorkerLoop(index); });
+  }
+}
+
+void ExecutorWorkQueues::WorkerLoop(int index) {
+  CurrentWorker* current = current_worker();
+  const CurrentWorker saved = *current;
+  current->queues = this;
+  current->index = index;
+  while (true) {
+    Task task = Pop(index);
+    if (task.state != nullptr) {
+      task.state->Process(task.tagged_node, task.scheduled_nsec);
+      continue;
+    }
+    workers_[index].active.store(false);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // Another thread may have pushed a task before observing this worker as
+    // idle, and not started a new worker.
+    if (Empty() || !ClaimWorker(index)) break;
+  }
+  *current = saved;
+}
+
 ExecutorState::ExecutorState(const Executor::Args& args, ExecutorImpl* impl)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
@@ -1433,6 +1602,7 @@ ExecutorState::ExecutorState(const Executor::Args& args, ExecutorImpl* impl)
       session_metadata_(impl->params_.session_metadata),
       tensor_store_(args.tensor_store),
       step_container_(args.step_container),
+      step_allocator_(args.step_allocator),
       stats_collector_(args.stats_collector),
       event_collector_(
           tracing::GetEventCollector(tracing::EventCategory::kCompute)),
@@ -1449,6 +1619,10 @@ ExecutorState::ExecutorState(const Executor::Args& args, ExecutorImpl* impl)
     user_device_ = RenamedDevice::NewRenamedDevice(
         device->name(), device, false, false, args.user_intra_op_threadpool);
   }
+  if (impl_->num_work_stealing_workers_ > 0) {
+    work_queues_ = std::make_shared<ExecutorWorkQueues>(
+        impl_->num_work_stealing_workers_, runner_);
+  }
 
   // We start the entire execution in iteration 0 of the root frame
   // so let us create the root frame and the state for iteration 0.
@@ -1649,7 +1823,7 @@ bool MightTrace(const NodeItem& item,
 
   if (tracing::ScopedAnnotation::IsEnabled()) return true;
 
-  return profiler::TraceMeRecorder::Active(
+  return profiler::TraceMeRecorder::Sample(
       profiler::GetTFTraceMeLevel(item.kernel->IsExpensive()));
 }
 
@@ -1694,6 +1868,7 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
   params.function_library = impl_->params_.function_library;
   params.resource_manager = device->resource_manager();
   params.step_container = step_container_;
+  params.step_allocator = step_allocator_;
   params.slice_reader_cache = slice_reader_cache_;
   params.inputs = &inputs;
   params.input_alloc_attrs = &input_alloc_attrs;
@@ -2315,7 +2490,7 @@ void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
   if (inline_ready == nullptr) {
     // Schedule to run all the ready ops in thread pool.
     for (auto& tagged_node : ready) {
-      runner_([=]() { Process(tagged_node, scheduled_nsec); });
+      Dispatch(tagged_node, scheduled_nsec);
     }
     return;
   }
@@ -2330,8 +2505,7 @@ void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
       if (curr_expensive_node) {
         // Dispatch to another thread since there is plenty of work to
         // do for this thread.
-        runner_(std::bind(&ExecutorState::Process, this, *curr_expensive_node,
-                          scheduled_nsec));
+        Dispatch(*curr_expensive_node, scheduled_nsec);
       }
       curr_expensive_node = &tagged_node;
     }
@@ -2342,12 +2516,24 @@ void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
     } else {
       // There are inline nodes to run already. We dispatch this expensive
       // node to other thread.
-      runner_(std::bind(&ExecutorState::Process, this, *curr_expensive_node,
-                        scheduled_nsec));
+      Dispatch(*curr_expensive_node, scheduled_nsec);
     }
   }
 }
 
+void ExecutorState::Dispatch(const TaggedNode& tagged_node,
+                             int64 scheduled_nsec) {
+  if (work_queues_) {
+    ExecutorWorkQueues::Task task;
+    task.state = this;
+    task.tagged_node = tagged_node;
+    task.scheduled_nsec = scheduled_nsec;
+    work_queues_->Schedule(std::move(task));
+  } else {
+    runner_([=]() { Process(tagged_node, scheduled_nsec); });
+  }
+}
+
 inline void ExecutorState::MaybeMarkCompleted(FrameState* frame, int64 iter,
                                               const NodeItem& item) {
   // TODO(misard) Replace with a finer-grain enabling flag once we
@@ -2963,6 +3149,30 @@ class DefaultExecutorRegistrar {
 };
 static DefaultExecutorRegistrar registrar;
 
+// Registers the "WORK_STEALING" executor, which differs from the default
+// executor only in how expensive nodes are dispatched: see
+// ExecutorWorkQueues. Select it with
+// ConfigProto.Experimental.executor_type.
+class WorkStealingExecutorRegistrar {
+ public:
+  WorkStealingExecutorRegistrar() {
+    ExecutorFactory::Register("WORK_STEALING", new Factory);
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      auto impl = absl::make_unique<ExecutorImpl>(params);
+      impl->EnableWorkStealing(port::MaxParallelism());
+      TF_RETURN_IF_ERROR(impl->Initialize(graph));
+      *out_executor = std::move(impl);
+      return Status::OK();
+    }
+  };
+};
+static WorkStealingExecutorRegistrar work_stealing_registrar;
+
 }  // namespace
 
 }  // namespace tensorflow
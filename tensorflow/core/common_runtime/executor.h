@@ -100,6 +100,10 @@ class Executor {
     CollectiveExecutor* collective_executor = nullptr;
     thread::ThreadPoolInterface* user_intra_op_threadpool = nullptr;
 
+    // If not null, serves the step-scoped allocations of the step. Must
+    // outlive the step.
+    Allocator* step_allocator = nullptr;
+
     // If true, calls Sync() on the device.
     bool sync_on_finish = false;
 
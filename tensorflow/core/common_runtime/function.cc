@@ -15,7 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/function.h"
 
+#include <algorithm>
 #include <deque>
+#include <list>
+#include <unordered_map>
 #include <vector>
 
 #include "absl/algorithm/container.h"
@@ -27,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_optimizer.h"
 #include "tensorflow/core/common_runtime/memory_types.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
+#include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -42,9 +46,12 @@ limitations under the License.
 #include "tensorflow/core/graph/optimizer_cse.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 // See core/kernels/function_ops.cc for related kernels.
 
@@ -410,6 +417,9 @@ class FunctionLibraryRuntimeImpl : public FunctionLibraryRuntime {
     FunctionLibraryRuntimeOverlay* overlay_flr = nullptr;
     string executor_type;
     Executor::RendezvousFactory rendezvous_factory = nullptr;
+    // Key of the optimized body in the FunctionBodyCache, or 0 if the body
+    // is not cached.
+    uint64 body_cache_key = 0;
 
     ~Item() {
       delete this->func_graph;
@@ -433,6 +443,8 @@ class FunctionLibraryRuntimeImpl : public FunctionLibraryRuntime {
                            std::unique_ptr<FunctionBody>* fbody);
   Status CreateItem(Item** item);
   Status GetOrCreateItem(LocalHandle local_handle, Item** item);
+  uint64 FunctionBodyCacheKey(const string& function_name, AttrSlice attrs,
+                              const FunctionLibraryDefinition* lib_def);
   Status InstantiateSymbolicGradient(const NameAttrList& func,
                                      const FunctionLibraryDefinition* lib_def,
                                      std::unique_ptr<FunctionBody>* g_body);
@@ -783,6 +795,10 @@ Status FunctionLibraryRuntimeImpl::Instantiate(
     }
     TF_RETURN_IF_ERROR(FunctionDefToBody(*fdef, attrs, lib_def, &fbody));
   }
+  const uint64 body_cache_key =
+      function_name == kGradientOp
+          ? 0
+          : FunctionBodyCacheKey(function_name, attrs, lib_def);
 
   LocalHandle local_handle;
   {
@@ -797,6 +813,7 @@ Status FunctionLibraryRuntimeImpl::Instantiate(
       item->func_graph = fbody.release();
       item->instantiation_counter = 1;
       item->executor_type = ExecutorType(options, attrs);
+      item->body_cache_key = body_cache_key;
       if (options.lib_def) {
         item->overlay_flr =
             new FunctionLibraryRuntimeOverlay(this, options.lib_def);
@@ -920,12 +937,122 @@ void PruneFunctionBody(const FunctionDef& fdef, Graph* g) {
     FixupSourceAndSinkEdges(g);
   }
 }
+
+// A process-wide cache of optimized function bodies. The runtimes of
+// different sessions on the same device reuse the body of a function
+// instantiated with the same attrs and optimizer options, instead of
+// optimizing it again. Executors are not shared, since their kernels belong
+// to a runtime. The least recently used bodies are evicted.
+class FunctionBodyCache {
+ public:
+  static FunctionBodyCache* Global() {
+    static FunctionBodyCache* cache = [] {
+      int64 capacity;
+      Status s = ReadInt64FromEnvVar("TF_FUNCTION_BODY_CACHE_CAPACITY",
+                                     /*default_val=*/256, &capacity);
+      if (!s.ok()) {
+        LOG(ERROR) << s.error_message();
+      }
+      return new FunctionBodyCache(capacity);
+    }();
+    return cache;
+  }
+
+  bool enabled() const { return capacity_ > 0; }
+
+  // Returns the body cached under `key`, or nullptr.
+  std::shared_ptr<const Graph> Lookup(uint64 key) {
+    mutex_lock l(mu_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+      return nullptr;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->second;
+  }
+
+  void Insert(uint64 key, std::shared_ptr<const Graph> body) {
+    // Destroys the evicted bodies outside the lock.
+    std::shared_ptr<const Graph> evicted;
+    mutex_lock l(mu_);
+    if (entries_.find(key) != entries_.end()) {
+      return;
+    }
+    lru_.emplace_front(key, std::move(body));
+    entries_[key] = lru_.begin();
+    if (static_cast<int64>(lru_.size()) > capacity_) {
+      evicted = std::move(lru_.back().second);
+      entries_.erase(lru_.back().first);
+      lru_.pop_back();
+    }
+  }
+
+ private:
+  explicit FunctionBodyCache(int64 capacity) : capacity_(capacity) {}
+
+  typedef std::list<std::pair<uint64, std::shared_ptr<const Graph>>> LruList;
+
+  const int64 capacity_;
+  mutex mu_;
+  LruList lru_ GUARDED_BY(mu_);
+  std::unordered_map<uint64, LruList::iterator> entries_ GUARDED_BY(mu_);
+};
 }  // namespace
 
+uint64 FunctionLibraryRuntimeImpl::FunctionBodyCacheKey(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryDefinition* lib_def) {
+  // A cached body refers to the library's default registry, so only the
+  // libraries over the global registry are cached.
+  if (!FunctionBodyCache::Global()->enabled() ||
+      lib_def->default_registry() != OpRegistry::Global()) {
+    return 0;
+  }
+  const FunctionDef* fdef = lib_def->Find(function_name);
+  if (fdef == nullptr) {
+    return 0;
+  }
+
+  // The optimizer may inline any function the body reaches.
+  std::vector<string> names = lib_def->ReachableDefinitions(*fdef)
+                                  .ListFunctionNames();
+  names.push_back(function_name);
+  std::vector<uint64> function_fps;
+  function_fps.reserve(names.size());
+  for (const string& name : names) {
+    function_fps.push_back(lib_def->Fingerprint(name));
+  }
+  std::sort(function_fps.begin(), function_fps.end());
+  uint64 key = Fingerprint64(function_name);
+  for (const uint64 function_fp : function_fps) {
+    key = FingerprintCat64(key, function_fp);
+  }
+
+  std::vector<std::pair<StringPiece, const AttrValue*>> sorted_attrs;
+  for (const auto& attr : attrs) {
+    sorted_attrs.emplace_back(attr.first, &attr.second);
+  }
+  std::sort(sorted_attrs.begin(), sorted_attrs.end());
+  for (const auto& attr : sorted_attrs) {
+    key = FingerprintCat64(key, Fingerprint64(attr.first));
+    key = FingerprintCat64(key, AttrValueFingerprint(*attr.second));
+  }
+
+  string serialized_options;
+  SerializeToStringDeterministic(optimizer_.options(), &serialized_options);
+  key = FingerprintCat64(key, Fingerprint64(serialized_options));
+  key = FingerprintCat64(key, graph_def_version_);
+  key = FingerprintCat64(key, Fingerprint64(device_->device_type()));
+  key = FingerprintCat64(key, Fingerprint64(device_name_));
+  // 0 marks uncached bodies.
+  return key == 0 ? 1 : key;
+}
+
 Status FunctionLibraryRuntimeImpl::CreateItem(Item** item) {
   const FunctionBody* fbody;
   FunctionLibraryRuntime* flr;
   string executor_type;
+  uint64 body_cache_key;
   {
     tf_shared_lock l(mu_);
     fbody = (*item)->func_graph;
@@ -933,16 +1060,32 @@ Status FunctionLibraryRuntimeImpl::CreateItem(Item** item) {
               ? static_cast<FunctionLibraryRuntime*>((*item)->overlay_flr)
               : static_cast<FunctionLibraryRuntime*>(this);
     executor_type = (*item)->executor_type;
+    body_cache_key = (*item)->body_cache_key;
   }
   const FunctionLibraryDefinition* lib_def =
       flr->GetFunctionLibraryDefinition();
   std::unique_ptr<Graph> g(new Graph(lib_def));
-  CopyGraph(*fbody->graph, g.get());
-
-  PruneFunctionBody(fbody->fdef, g.get());
-  optimizer_.Optimize(this, env(), device(), &g, /*shape_map=*/nullptr);
-  TF_RETURN_IF_ERROR(EnsureMemoryTypes(DeviceType(device()->device_type()),
-                                       device()->name(), g.get()));
+  std::shared_ptr<const Graph> cached_body =
+      body_cache_key != 0 ? FunctionBodyCache::Global()->Lookup(body_cache_key)
+                          : nullptr;
+  if (cached_body != nullptr) {
+    CopyGraph(*cached_body, g.get());
+  } else {
+    CopyGraph(*fbody->graph, g.get());
+
+    PruneFunctionBody(fbody->fdef, g.get());
+    optimizer_.Optimize(this, env(), device(), &g, /*shape_map=*/nullptr);
+    TF_RETURN_IF_ERROR(EnsureMemoryTypes(DeviceType(device()->device_type()),
+                                         device()->name(), g.get()));
+    if (body_cache_key != 0) {
+      // The cached copy owns the functions it may call, since it outlives
+      // `lib_def`.
+      auto body = std::make_shared<Graph>(
+          lib_def->ReachableDefinitions(fbody->fdef));
+      CopyGraph(*g, body.get());
+      FunctionBodyCache::Global()->Insert(body_cache_key, std::move(body));
+    }
+  }
 
   // Creates an executor based on the g. This must be done without
   // holding mu_ because create_kernel_ calls back into the library.
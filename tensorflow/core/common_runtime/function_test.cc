@@ -392,6 +392,40 @@ TEST_F(FunctionLibraryRuntimeTest, XTimesTwo) {
   test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6, 8}));
 }
 
+TEST_F(FunctionLibraryRuntimeTest, BodyCacheSharedAcrossRuntimes) {
+  auto x = test::AsTensor<float>({1, 2, 3, 4});
+  Tensor y;
+  Init({test::function::XTimesTwo(), test::function::XTimesFour()});
+  TF_CHECK_OK(
+      InstantiateAndRun(flr0_, "XTimesFour", {{"T", DT_FLOAT}}, {x}, {&y}));
+  test::ExpectTensorEqual<float>(y, test::AsTensor<float>({4, 8, 12, 16}));
+
+  // A new runtime over an equal library reuses the cached body.
+  Init({test::function::XTimesTwo(), test::function::XTimesFour()});
+  TF_CHECK_OK(
+      InstantiateAndRun(flr0_, "XTimesFour", {{"T", DT_FLOAT}}, {x}, {&y}));
+  test::ExpectTensorEqual<float>(y, test::AsTensor<float>({4, 8, 12, 16}));
+
+  // Changing a called function must not hit the cached body.
+  FunctionDef x_times_three = test::function::XTimesTwo();
+  for (NodeDef& node : *x_times_three.mutable_node_def()) {
+    if (node.name() == "two") {
+      test::AsScalar<int64>(3).AsProtoTensorContent(
+          (*node.mutable_attr())["value"].mutable_tensor());
+    }
+  }
+  Init({x_times_three, test::function::XTimesFour()});
+  TF_CHECK_OK(
+      InstantiateAndRun(flr0_, "XTimesFour", {{"T", DT_FLOAT}}, {x}, {&y}));
+  test::ExpectTensorEqual<float>(y, test::AsTensor<float>({9, 18, 27, 36}));
+
+  // Bodies for other attrs are cached separately.
+  auto x_int = test::AsTensor<int32>({1, 2, 3, 4});
+  TF_CHECK_OK(InstantiateAndRun(flr0_, "XTimesFour", {{"T", DT_INT32}},
+                                {x_int}, {&y}));
+  test::ExpectTensorEqual<int32>(y, test::AsTensor<int32>({9, 18, 27, 36}));
+}
+
 TEST_F(FunctionLibraryRuntimeTest, XTimesN) {
   Init({test::function::XTimesTwo(), test::function::XTimesFour(),
         test::function::XTimes16()});
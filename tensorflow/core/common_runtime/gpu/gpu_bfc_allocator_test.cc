@@ -303,6 +303,103 @@ TEST(GPUBFCAllocatorTest, AllocationsAndDeallocationsWithGrowth) {
   }
 }
 
+TEST(GPUBFCAllocatorTest, ChunkCacheReusesChunksAndKeepsStatsExact) {
+  PlatformGpuId platform_gpu_id(0);
+  GPUMemAllocator* sub_allocator = new GPUMemAllocator(
+      GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie(),
+      platform_gpu_id, false /*use_unified_memory*/, {}, {});
+  GPUBFCAllocator a(sub_allocator, 1 << 30, "GPU_0_bfc");
+  a.EnableChunkCache(1 << 20);
+
+  void* p1 = a.AllocateRaw(1, 1000);
+  CheckStats(&a, 1, 1024, 1024, 1024);
+  a.DeallocateRaw(p1);
+  CheckStats(&a, 1, 0, 1024, 1024);
+
+  // The freed chunk comes back from the cache for the same rounded size.
+  void* p2 = a.AllocateRaw(1, 1024);
+  EXPECT_EQ(p1, p2);
+  CheckStats(&a, 2, 1024, 1024, 1024);
+
+  // A different size is served from the bins.
+  void* p3 = a.AllocateRaw(1, 4096);
+  EXPECT_NE(p2, p3);
+  CheckStats(&a, 3, 5120, 5120, 4096);
+
+  a.DeallocateRaw(p2);
+  a.DeallocateRaw(p3);
+  CheckStats(&a, 3, 0, 5120, 4096);
+
+  a.ClearStats();
+  CheckStats(&a, 0, 0, 0, 0);
+  void* p4 = a.AllocateRaw(1, 4096);
+  EXPECT_EQ(p3, p4);
+  CheckStats(&a, 1, 4096, 4096, 4096);
+  a.DeallocateRaw(p4);
+}
+
+TEST(GPUBFCAllocatorTest, ChunkCacheIsDrainedBeforeOutOfMemory) {
+  PlatformGpuId platform_gpu_id(0);
+  GPUMemAllocator* sub_allocator = new GPUMemAllocator(
+      GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie(),
+      platform_gpu_id, false /*use_unified_memory*/, {}, {});
+  GPUBFCAllocator a(sub_allocator, 1 << 20, "GPU_0_bfc");
+  a.EnableChunkCache(1 << 30);
+
+  // Fill the whole region with small chunks, then park all of them in the
+  // cache.
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 64; ++i) {
+    void* raw = a.AllocateRaw(1, 16 << 10);
+    ASSERT_NE(raw, nullptr);
+    ptrs.push_back(raw);
+  }
+  for (void* raw : ptrs) {
+    a.DeallocateRaw(raw);
+  }
+
+  // Only a fully coalesced region satisfies this request.
+  void* big = a.AllocateRaw(1, 1 << 20);
+  EXPECT_NE(big, nullptr);
+  a.DeallocateRaw(big);
+}
+
+TEST(GPUBFCAllocatorTest, ReportsFragmentationAndRelocationCandidates) {
+  PlatformGpuId platform_gpu_id(0);
+  GPUMemAllocator* sub_allocator = new GPUMemAllocator(
+      GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie(),
+      platform_gpu_id, false /*use_unified_memory*/, {}, {});
+  GPUBFCAllocator a(sub_allocator, 4 << 20, "GPU_0_bfc");
+
+  // Fill the region with four 1MiB chunks and free every other one.
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 4; ++i) {
+    ptrs.push_back(a.AllocateRaw(1, 1 << 20));
+    ASSERT_NE(ptrs.back(), nullptr);
+  }
+  std::sort(ptrs.begin(), ptrs.end());
+  absl::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats && stats->fragmentation);
+  EXPECT_EQ(0.0, *stats->fragmentation);
+
+  a.DeallocateRaw(ptrs[0]);
+  a.DeallocateRaw(ptrs[2]);
+  stats = a.GetStats();
+  ASSERT_TRUE(stats && stats->fragmentation);
+  EXPECT_EQ(1 << 20, stats->largest_free_block_bytes);
+  EXPECT_DOUBLE_EQ(0.5, *stats->fragmentation);
+
+  // Moving ptrs[1] would only land in one of its own neighbours, while
+  // ptrs[3] would fill the hole at ptrs[0] and free a block next to ptrs[2].
+  EXPECT_FALSE(a.ShouldRelocate(ptrs[1]));
+  EXPECT_TRUE(a.ShouldRelocate(ptrs[3]));
+  int dummy = 0;
+  EXPECT_FALSE(a.ShouldRelocate(&dummy));
+
+  a.DeallocateRaw(ptrs[1]);
+  a.DeallocateRaw(ptrs[3]);
+}
+
 TEST(GPUBFCAllocatorTest, DISABLED_AllocatorReceivesZeroMemory) {
   PlatformGpuId platform_gpu_id(0);
   GPUMemAllocator* sub_allocator = new GPUMemAllocator(
@@ -346,6 +346,27 @@ TEST_F(GPUDeviceTest, CopyTensorInSameDevice) {
   }
 }
 
+TEST_F(GPUDeviceTest, IsGpuHostMemory) {
+  SessionOptions opts = MakeSessionOptions("0");
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      opts, kDeviceNamePrefix, &devices));
+  AllocatorAttributes attr;
+  attr.set_on_host(true);
+  attr.set_gpu_compatible(true);
+  Allocator* host_allocator = devices[0]->GetAllocator(attr);
+  char* pinned = static_cast<char*>(
+      host_allocator->AllocateRaw(Allocator::kAllocatorAlignment, 1024));
+  ASSERT_NE(pinned, nullptr);
+  EXPECT_TRUE(GPUProcessState::singleton()->IsGpuHostMemory(pinned));
+  EXPECT_TRUE(GPUProcessState::singleton()->IsGpuHostMemory(pinned + 1023));
+  host_allocator->DeallocateRaw(pinned);
+
+  Tensor pageable(cpu_allocator(), DT_FLOAT, TensorShape({4}));
+  EXPECT_FALSE(GPUProcessState::singleton()->IsGpuHostMemory(
+      pageable.tensor_data().data()));
+}
+
 class GPUKernelTrackerTest : public ::testing::Test {
  protected:
   void Init(const GPUKernelTracker::Params& params) {
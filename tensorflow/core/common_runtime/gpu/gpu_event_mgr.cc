@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -27,6 +28,23 @@ namespace {
 //  - Is this the right number of threads?
 //  - Should EventMgrs be shared between GPUDevices on a multi-GPU machine?
 static const int kNumThreads = 2;
+
+// Whether EventMgrs detect completions with host callbacks rather than by
+// polling events.
+bool UseHostCallbacks() {
+  static const bool use_host_callbacks = [] {
+    bool value;
+    Status status = ReadBoolFromEnvVar("TF_GPU_EVENT_MGR_USE_HOST_CALLBACKS",
+                                       false, &value);
+    if (!status.ok()) {
+      LOG(WARNING) << "Ignoring TF_GPU_EVENT_MGR_USE_HOST_CALLBACKS: "
+                   << status;
+      return false;
+    }
+    return value;
+  }();
+  return use_host_callbacks;
+}
 }  // namespace
 
 namespace gpu_event_mgr {
@@ -90,6 +108,10 @@ void InitThreadpoolLabels(thread::ThreadPool* threadpool) {
 }  // namespace gpu_event_mgr
 
 EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
+    : EventMgr(se, gpu_options, UseHostCallbacks()) {}
+
+EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options,
+                   bool use_host_callbacks)
     : exec_(se),
       deferred_bytes_threshold_(gpu_options.deferred_deletion_bytes()
                                     ? gpu_options.deferred_deletion_bytes()
@@ -97,6 +119,7 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
       polling_active_delay_usecs_(gpu_options.polling_active_delay_usecs()
                                       ? gpu_options.polling_active_delay_usecs()
                                       : 10),
+      use_host_callbacks_(use_host_callbacks),
       accumulated_stream_(nullptr),
       accumulated_tensors_(new TensorReferenceVector),
       accumulated_tensor_bytes_(0),
@@ -145,7 +168,15 @@ void EventMgr::StartPollingLoop() {
     stop_polling_ = false;
   }
   polling_stopped_.reset(new Notification);
-  threadpool_.Schedule([this]() { PollLoop(); });
+  if (use_host_callbacks_) {
+    {
+      mutex_lock l(completed_mu_);
+      stop_completions_ = false;
+    }
+    threadpool_.Schedule([this]() { CompletionLoop(); });
+  } else {
+    threadpool_.Schedule([this]() { PollLoop(); });
+  }
 }
 
 void EventMgr::StopPollingLoop() {
@@ -155,6 +186,13 @@ void EventMgr::StopPollingLoop() {
       stop_polling_ = true;
       events_pending_.notify_all();
     }
+    {
+      mutex_lock l(completed_mu_);
+      stop_completions_ = true;
+      completed_cv_.notify_all();
+    }
+    // With host callbacks, this waits for the pending ones to complete, as
+    // they refer to this object.
     polling_stopped_->WaitForNotification();
     polling_stopped_.reset(nullptr);
   }
@@ -218,7 +256,63 @@ void EventMgr::PollLoop() {
   polling_stopped_->Notify();
 }
 
+void EventMgr::HandOffCompleted(Completed* c) {
+  Completed* head = completed_.load(std::memory_order_relaxed);
+  do {
+    c->next = head;
+  } while (!completed_.compare_exchange_weak(
+      head, c, std::memory_order_release, std::memory_order_relaxed));
+  // The completion loop only sleeps once it has emptied the list.
+  if (head == nullptr) {
+    mutex_lock l(completed_mu_);
+    completed_cv_.notify_one();
+  }
+}
+
+void EventMgr::CompletionLoop() {
+  ToFreeVector to_free;
+  while (true) {
+    Completed* head = completed_.exchange(nullptr, std::memory_order_acquire);
+    if (head == nullptr) {
+      mutex_lock l(completed_mu_);
+      if (stop_completions_ && pending_callbacks_.load() == 0) {
+        break;
+      }
+      // Checked under completed_mu_, so that the notification of
+      // HandOffCompleted() is not missed.
+      if (completed_.load(std::memory_order_acquire) == nullptr) {
+        completed_cv_.wait(l);
+      }
+      continue;
+    }
+    // Retires the records in their order of completion.
+    Completed* first = nullptr;
+    while (head != nullptr) {
+      Completed* next = head->next;
+      head->next = first;
+      first = head;
+      head = next;
+    }
+    while (first != nullptr) {
+      Completed* next = first->next;
+      to_free.push_back(std::move(first->iu));
+      delete first;
+      first = next;
+    }
+    FreeMemory(to_free);
+    pending_callbacks_ -= to_free.size();
+    to_free.clear();
+  }
+  polling_stopped_->Notify();
+}
+
 void EventMgr::QueueInUse(se::Stream* stream, InUse iu) {
+  if (use_host_callbacks_) {
+    ++pending_callbacks_;
+    Completed* c = new Completed{std::move(iu), nullptr};
+    stream->ThenDoHostCallback([this, c]() { HandOffCompleted(c); });
+    return;
+  }
   VLOG(2) << "QueueInUse  free_events_ " << free_events_.size()
           << " used_events_ " << used_events_.size();
   // Events are created on demand, and repeatedly reused.  There is no
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_EVENT_MGR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_EVENT_MGR_H_
 
+#include <atomic>
 #include <deque>
 #include <vector>
 #include "tensorflow/core/framework/log_memory.h"
@@ -61,6 +62,15 @@ void WarnIfInCallback(std::function<void()> f);
 // An object to keep track of pending Events in the StreamExecutor streams
 // and associated Tensors that cannot safely be deleted until the associated
 // Events are recorded.
+//
+// By default, a dedicated thread polls the Events while any are pending,
+// sleeping GPUOptions::polling_active_delay_usecs between polls.  If the
+// environment variable TF_GPU_EVENT_MGR_USE_HOST_CALLBACKS is true, host
+// callbacks enqueued on the streams report completions instead, which saves
+// the polling delay and the busy thread.  As host callbacks must not call into
+// the GPU runtime, they only hand the completed records off to the dedicated
+// thread, through a lock-free list, which then releases the memory and
+// schedules the functions as usual.
 class EventMgr {
  public:
   virtual ~EventMgr();
@@ -111,6 +121,7 @@ class EventMgr {
   se::StreamExecutor* const exec_;
   const int64 deferred_bytes_threshold_;
   const int32 polling_active_delay_usecs_;
+  const bool use_host_callbacks_;
   mutex mu_;
   condition_variable events_pending_ GUARDED_BY(mu_);
 
@@ -126,6 +137,8 @@ class EventMgr {
   typedef gtl::InlinedVector<InUse, 4> ToFreeVector;
 
   EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options);
+  EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options,
+           bool use_host_callbacks);
 
   void FreeMemory(const ToFreeVector& to_free) {
     for (const auto& iu : to_free) {
@@ -181,6 +194,20 @@ class EventMgr {
   // straggler Events.
   void PollLoop();
 
+  // A record completed by a host callback, in the list "completed_".
+  struct Completed {
+    InUse iu;
+    Completed* next;
+  };
+
+  // Called by the host callback enqueued for "c" once it completes.  Pushes
+  // "c" to "completed_" and wakes up the completion loop if needed.
+  void HandOffCompleted(Completed* c);
+
+  // Replaces PollLoop() when host callbacks are used: retires the records
+  // handed off by the host callbacks, in their order of completion.
+  void CompletionLoop();
+
   // Setup/Teardown functions for the polling loop.
   void StartPollingLoop();
   void StopPollingLoop();
@@ -200,6 +227,16 @@ class EventMgr {
   bool stop_polling_ GUARDED_BY(mu_);
   std::unique_ptr<Notification> polling_stopped_;
 
+  // The records completed by host callbacks and not yet retired, most recent
+  // first.
+  std::atomic<Completed*> completed_{nullptr};
+  // The number of host callbacks enqueued and not yet retired.
+  std::atomic<int64> pending_callbacks_{0};
+  // Only used to put the completion loop to sleep while "completed_" is empty.
+  mutex completed_mu_;
+  condition_variable completed_cv_ GUARDED_BY(completed_mu_);
+  bool stop_completions_ GUARDED_BY(completed_mu_) = false;
+
   // The main PollLoop for the event manager runs in this threadpool.
   thread::ThreadPool threadpool_;
 };
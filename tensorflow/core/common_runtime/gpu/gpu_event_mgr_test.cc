@@ -41,6 +41,9 @@ class TEST_EventMgr : public EventMgr {
  public:
   TEST_EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
       : EventMgr(se, gpu_options) {}
+  TEST_EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options,
+                bool use_host_callbacks)
+      : EventMgr(se, gpu_options, use_host_callbacks) {}
 };
 
 class TEST_EventMgrHelper {
@@ -283,6 +286,31 @@ TEST(EventMgr, WarnIfInCallback) {
   note.WaitForNotification();
   EXPECT_TRUE(hit);
 }
+
+// With host callbacks, records are retired in order without polling.
+TEST(EventMgr, HostCallbacks) {
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  TEST_EventMgr em(stream_exec, GPUOptions(), true /* use_host_callbacks */);
+  EXPECT_EQ(0, live_tensor_bytes);
+  std::unique_ptr<se::Stream> stream(new se::Stream(stream_exec));
+  CHECK(stream);
+  stream->Init();
+  for (int i = 0; i < 5; ++i) {
+    TensorReferenceVector v;
+    AddTensorReference(&v, 100 * 1048576);
+    em.ThenDeleteTensors(stream.get(), v);
+    Notification note;
+    bool in_callback = false;
+    em.ThenExecute(stream.get(), [&note, &in_callback]() {
+      gpu_event_mgr::WarnIfInCallback([&in_callback] { in_callback = true; });
+      note.Notify();
+    });
+    note.WaitForNotification();
+    EXPECT_TRUE(in_callback);
+    // The tensors were released before the function was scheduled.
+    EXPECT_EQ(0, live_tensor_bytes);
+  }
+}
 }  // namespace
 
 // Provides access to private resources of BaseGPUDevice.
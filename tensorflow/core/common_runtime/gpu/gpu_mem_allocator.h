@@ -16,9 +16,15 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_MEM_ALLOCATOR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_MEM_ALLOCATOR_H_
 
+#include <unordered_map>
+#include <vector>
+
 #include "tensorflow/core/common_runtime/gpu/gpu_id.h"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 
@@ -40,6 +46,18 @@ class GPUMemAllocator : public SubAllocator {
   }
   ~GPUMemAllocator() override {}
 
+  // Lets the allocations that do not fit in the memory of this GPU be served
+  // from the memory of "peers", GPUs that this one has peer access to (e.g.
+  // over NVLink), up to "peer_bytes_limit" bytes in total.  Peer memory is
+  // only used once memory of this GPU was allocated, so that the first region
+  // of the BFC allocator, which is as large as possible, is local.
+  void SetPeerFallback(const std::vector<se::StreamExecutor*>& peers,
+                       size_t peer_bytes_limit) {
+    mutex_lock l(peer_mu_);
+    peers_ = peers;
+    peer_bytes_limit_ = peer_bytes_limit;
+  }
+
   void* Alloc(size_t alignment, size_t num_bytes) override {
     void* ptr = nullptr;
     if (num_bytes > 0) {
@@ -47,6 +65,11 @@ class GPUMemAllocator : public SubAllocator {
         ptr = stream_exec_->UnifiedMemoryAllocate(num_bytes);
       } else {
         ptr = stream_exec_->AllocateArray<char>(num_bytes).opaque();
+        if (ptr == nullptr) {
+          ptr = AllocFromPeer(num_bytes);
+        } else {
+          has_local_memory_ = true;
+        }
       }
       VisitAlloc(ptr, gpu_id_.value(), num_bytes);
     }
@@ -60,16 +83,58 @@ class GPUMemAllocator : public SubAllocator {
         stream_exec_->UnifiedMemoryDeallocate(ptr);
       } else {
         se::DeviceMemoryBase gpu_ptr(ptr);
-        stream_exec_->Deallocate(&gpu_ptr);
+        se::StreamExecutor* owner = stream_exec_;
+        if (peer_bytes_limit_ > 0) {
+          mutex_lock l(peer_mu_);
+          auto it = peer_allocations_.find(ptr);
+          if (it != peer_allocations_.end()) {
+            owner = it->second;
+            peer_bytes_ -= num_bytes;
+            peer_allocations_.erase(it);
+          }
+        }
+        owner->Deallocate(&gpu_ptr);
       }
     }
   }
 
  private:
+  void* AllocFromPeer(size_t num_bytes) {
+    mutex_lock l(peer_mu_);
+    if (!has_local_memory_ || peer_bytes_ + num_bytes > peer_bytes_limit_) {
+      return nullptr;
+    }
+    for (se::StreamExecutor* peer : peers_) {
+      void* ptr = peer->AllocateArray<char>(num_bytes).opaque();
+      if (ptr != nullptr) {
+        VLOG(1) << "Allocated " << num_bytes << " bytes for GPU "
+                << gpu_id_.value() << " on peer device "
+                << peer->device_ordinal();
+        peer_bytes_ += num_bytes;
+        peer_allocations_[ptr] = peer;
+        return ptr;
+      }
+    }
+    return nullptr;
+  }
+
   se::StreamExecutor* stream_exec_;  // not owned, non-null
   const PlatformGpuId gpu_id_;
   const bool use_unified_memory_ = false;
 
+  // Set once memory of this GPU is allocated.  Alloc() is only called by the
+  // BFC allocator with its lock held.
+  bool has_local_memory_ = false;
+
+  mutex peer_mu_;
+  std::vector<se::StreamExecutor*> peers_ GUARDED_BY(peer_mu_);  // not owned
+  // Only set before the first allocation.
+  size_t peer_bytes_limit_ = 0;
+  size_t peer_bytes_ GUARDED_BY(peer_mu_) = 0;
+  // The owner of each allocation served from a peer.
+  std::unordered_map<void*, se::StreamExecutor*> peer_allocations_
+      GUARDED_BY(peer_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(GPUMemAllocator);
 };
 
@@ -112,6 +112,36 @@ Allocator* GPUProcessState::GetGPUAllocator(const GPUOptions& options,
         (options.per_process_gpu_memory_fraction() > 1.0 ||
          options.experimental().use_unified_memory()),
         gpu_visitors_[bus_id], {});
+    // The allocations that do not fit in this GPU may be served from its
+    // peers, up to TF_GPU_PEER_MEMORY_LIMIT_IN_MB, which extends the memory
+    // limit of the BFC allocator.
+    int64 peer_mem_limit_in_mb = 0;
+    Status peer_status = ReadInt64FromEnvVar("TF_GPU_PEER_MEMORY_LIMIT_IN_MB",
+                                             0, &peer_mem_limit_in_mb);
+    if (!peer_status.ok()) {
+      LOG(ERROR) << "GetGPUAllocator: " << peer_status.error_message();
+    } else if (peer_mem_limit_in_mb > 0) {
+      se::StreamExecutor* stream_exec =
+          GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie();
+      std::vector<se::StreamExecutor*> peers;
+      se::Platform* gpu_manager = GPUMachineManager();
+      for (int i = 0; i < gpu_manager->VisibleDeviceCount(); ++i) {
+        se::StreamExecutor* peer =
+            gpu_manager->ExecutorForDevice(i).ValueOrDie();
+        if (peer != stream_exec && stream_exec->CanEnablePeerAccessTo(peer) &&
+            stream_exec->EnablePeerAccessTo(peer).ok()) {
+          peers.push_back(peer);
+        }
+      }
+      if (peers.empty()) {
+        LOG(WARNING) << "Ignoring TF_GPU_PEER_MEMORY_LIMIT_IN_MB for GPU "
+                     << tf_gpu_id.value() << ", which has no peer GPUs.";
+      } else {
+        const size_t peer_bytes_limit = peer_mem_limit_in_mb * (1LL << 20);
+        sub_allocator->SetPeerFallback(peers, peer_bytes_limit);
+        total_bytes += peer_bytes_limit;
+      }
+    }
     GPUBFCAllocator* gpu_bfc_allocator =
         new GPUBFCAllocator(sub_allocator, total_bytes, options,
                             strings::StrCat("GPU_", tf_gpu_id.value(), "_bfc"));
@@ -121,6 +151,14 @@ Allocator* GPUProcessState::GetGPUAllocator(const GPUOptions& options,
       timing_counter = new SharedCounter;
       gpu_bfc_allocator->SetTimingCounter(timing_counter);
     }
+    int64 chunk_cache_bytes = 0;
+    Status status = ReadInt64FromEnvVar("TF_GPU_BFC_CHUNK_CACHE_BYTES", 0,
+                                        &chunk_cache_bytes);
+    if (!status.ok()) {
+      LOG(ERROR) << "GetGPUAllocator: " << status.error_message();
+    } else if (chunk_cache_bytes > 0 && timing_counter == nullptr) {
+      gpu_bfc_allocator->EnableChunkCache(chunk_cache_bytes);
+    }
 
     // If true, checks for memory overwrites by writing
     // distinctive patterns on both ends of allocated memory.
@@ -239,9 +277,21 @@ Allocator* GPUProcessState::GetGpuHostAllocator(int numa_node) {
     while (gpu_host_free_visitors_.size() <= numa_node) {
       gpu_host_free_visitors_.push_back({});
     }
-    SubAllocator* sub_allocator =
-        new GpuHostAllocator(se, numa_node, gpu_host_alloc_visitors_[numa_node],
-                             gpu_host_free_visitors_[numa_node]);
+    std::vector<SubAllocator::Visitor> alloc_visitors =
+        gpu_host_alloc_visitors_[numa_node];
+    alloc_visitors.push_back([this](void* ptr, int, size_t num_bytes) {
+      mutex_lock l(gpu_host_regions_mu_);
+      gpu_host_regions_[reinterpret_cast<uintptr_t>(ptr) + num_bytes] =
+          num_bytes;
+    });
+    std::vector<SubAllocator::Visitor> free_visitors =
+        gpu_host_free_visitors_[numa_node];
+    free_visitors.push_back([this](void* ptr, int, size_t num_bytes) {
+      mutex_lock l(gpu_host_regions_mu_);
+      gpu_host_regions_.erase(reinterpret_cast<uintptr_t>(ptr) + num_bytes);
+    });
+    SubAllocator* sub_allocator = new GpuHostAllocator(
+        se, numa_node, alloc_visitors, free_visitors);
     // TODO(zheng-xq): evaluate whether 64GB by default is the best choice.
     int64 gpu_host_mem_limit_in_mb = -1;
     Status status = ReadInt64FromEnvVar("TF_GPU_HOST_MEM_LIMIT_IN_MB",
@@ -285,6 +335,14 @@ Allocator* GPUProcessState::GetGpuHostAllocator(int numa_node) {
   }
 }
 
+bool GPUProcessState::IsGpuHostMemory(const void* ptr) {
+  const uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+  mutex_lock l(gpu_host_regions_mu_);
+  // The first region ending past "ptr" is the only one that may hold it.
+  auto it = gpu_host_regions_.upper_bound(address);
+  return it != gpu_host_regions_.end() && address >= it->first - it->second;
+}
+
 void GPUProcessState::AddGPUAllocVisitor(int bus_id,
                                          const SubAllocator::Visitor& visitor) {
 #if (defined(GOOGLE_CUDA) && GOOGLE_CUDA) || \
@@ -344,6 +402,10 @@ void GPUProcessState::TestOnlyReset() {
     gpu_host_alloc_visitors_.clear();
     gpu_host_free_visitors_.clear();
   }
+  {
+    mutex_lock lock(gpu_host_regions_mu_);
+    gpu_host_regions_.clear();
+  }
 }
 
 }  // namespace tensorflow
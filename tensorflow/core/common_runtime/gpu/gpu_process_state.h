@@ -91,6 +91,11 @@ class GPUProcessState {
 
   virtual Allocator* GetGpuHostAllocator(int numa_node);
 
+  // Returns true if "ptr" points into memory allocated through a
+  // GpuHostAllocator, i.e. pinned host memory that GPUs copy to and from
+  // asynchronously.
+  bool IsGpuHostMemory(const void* ptr);
+
   // Registers a Visitor to be invoked on new chunks of memory allocated by the
   // SubAllocator of every GPU proximate to the specified bus.  The AllocVisitor
   // is provided with a memory pointer, a GPU id, and the size of the area it
@@ -155,6 +160,12 @@ class GPUProcessState {
       GUARDED_BY(mu_);
   std::vector<std::vector<SubAllocator::Visitor>> gpu_host_free_visitors_
       GUARDED_BY(mu_);
+
+  // The regions allocated by the SubAllocators of gpu_host_allocators_,
+  // mapping their end addresses to their sizes.
+  mutex gpu_host_regions_mu_;
+  std::map<uintptr_t, size_t> gpu_host_regions_
+      GUARDED_BY(gpu_host_regions_mu_);
 };
 
 }  // namespace tensorflow
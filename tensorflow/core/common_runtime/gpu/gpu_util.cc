@@ -15,6 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <vector>
+
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -26,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_reference.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -34,6 +41,7 @@ limitations under the License.
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/platform/tracing.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 
 // IMPLEMENTATION NOTE:
@@ -47,6 +55,13 @@ limitations under the License.
 //    ensure the causal ordering by arranging the copy done callback
 //    happens-after all activities scheduled on the given stream being
 //    finished.
+//
+// 3. Copies between GPUs and pageable host memory are synchronous, as the
+//    driver stages them through its own pinned buffers.  If
+//    TF_GPU_STAGED_COPY_CHUNK_BYTES is set, the copies larger than that are
+//    instead staged in chunks of that size through pinned buffers from the
+//    GPU host allocator, so that copying a chunk on the host overlaps the
+//    transfer of the others, and the stream runs asynchronously.
 
 // If this need to be runtime configurable, consider adding options to
 // ConfigProto.
@@ -109,6 +124,150 @@ void* GetBase(const Tensor* src) {
 
 void* GetBase(Tensor* dst) { return DMAHelper::base(dst); }
 
+namespace {
+
+// The number of pinned buffers a staged copy cycles through, which bounds the
+// pinned memory it holds.
+const int kNumStagingBuffers = 4;
+
+// Returns TF_GPU_STAGED_COPY_CHUNK_BYTES, or 0 if copies are not staged.
+int64 StagedCopyChunkBytes() {
+  static const int64 chunk_bytes = [] {
+    int64 value;
+    Status status =
+        ReadInt64FromEnvVar("TF_GPU_STAGED_COPY_CHUNK_BYTES", 0, &value);
+    if (!status.ok() || value < 0) {
+      LOG(WARNING) << "Ignoring invalid TF_GPU_STAGED_COPY_CHUNK_BYTES: "
+                   << status;
+      return int64{0};
+    }
+    return value;
+  }();
+  return chunk_bytes;
+}
+
+// Returns the allocator of the pinned buffers through which to stage a copy of
+// "total_bytes" between "gpu_device" and the host memory at "host_ptr", or
+// nullptr if the copy is not worth staging.
+Allocator* StagingAllocator(Device* gpu_device, const void* host_ptr,
+                            int64 total_bytes) {
+  const int64 chunk_bytes = StagedCopyChunkBytes();
+  if (chunk_bytes == 0 || total_bytes <= chunk_bytes) return nullptr;
+  // Staged copies wait for EventMgr callbacks, so they cannot be issued from
+  // one.
+  bool in_callback = false;
+  gpu_event_mgr::WarnIfInCallback([&in_callback] { in_callback = true; });
+  if (in_callback) return nullptr;
+  if (GPUProcessState::singleton()->IsGpuHostMemory(host_ptr)) return nullptr;
+  AllocatorAttributes attr;
+  attr.set_on_host(true);
+  attr.set_gpu_compatible(true);
+  return gpu_device->GetAllocator(attr);
+}
+
+// Allocates the staging buffers of a copy of "num_chunks" chunks.  Returns
+// false, having allocated nothing, if one of them cannot be allocated.
+bool AllocateStagingBuffers(Allocator* allocator, int64 num_chunks,
+                            std::vector<void*>* buffers) {
+  const int64 num_buffers = std::min<int64>(num_chunks, kNumStagingBuffers);
+  for (int64 i = 0; i < num_buffers; ++i) {
+    void* buffer = allocator->AllocateRaw(Allocator::kAllocatorAlignment,
+                                          StagedCopyChunkBytes());
+    if (buffer == nullptr) {
+      for (void* b : *buffers) allocator->DeallocateRaw(b);
+      buffers->clear();
+      return false;
+    }
+    buffers->push_back(buffer);
+  }
+  return true;
+}
+
+// Issues the copy of "total_bytes" from the pageable "src" to "dst" on the GPU
+// on "stream", staged through pinned buffers from "allocator", and returns
+// true, or returns false, having issued nothing, if the buffers cannot be
+// allocated.  Blocks while all the buffers are in use.
+bool StagedCopyToDevice(EventMgr* event_mgr, Allocator* allocator,
+                        se::Stream* stream, const void* src, void* dst,
+                        int64 total_bytes) {
+  const int64 chunk_bytes = StagedCopyChunkBytes();
+  const int64 num_chunks = (total_bytes + chunk_bytes - 1) / chunk_bytes;
+  std::vector<void*> buffers;
+  if (!AllocateStagingBuffers(allocator, num_chunks, &buffers)) return false;
+  // Notified once the transfer from each buffer completes.
+  std::vector<std::shared_ptr<Notification>> transferred(buffers.size());
+  for (int64 i = 0; i < num_chunks; ++i) {
+    const int64 offset = i * chunk_bytes;
+    const int64 bytes = std::min(chunk_bytes, total_bytes - offset);
+    const int b = i % buffers.size();
+    if (transferred[b] != nullptr) transferred[b]->WaitForNotification();
+    std::memcpy(buffers[b], static_cast<const char*>(src) + offset, bytes);
+    DeviceMemoryBase gpu_dst_ptr(static_cast<char*>(dst) + offset, bytes);
+    stream->ThenMemcpy(&gpu_dst_ptr, buffers[b], bytes);
+    std::shared_ptr<Notification> note = std::make_shared<Notification>();
+    transferred[b] = note;
+    event_mgr->ThenExecute(stream, [note]() { note->Notify(); });
+  }
+  for (void* buffer : buffers) {
+    event_mgr->ThenDeleteBuffer(stream, {allocator, buffer, "", 0});
+  }
+  return true;
+}
+
+// Issues the copy of "total_bytes" from "src" on the GPU to the pageable "dst"
+// on "stream", staged through pinned buffers from "allocator" which EventMgr
+// callbacks copy to "dst", and returns true, or returns false, having issued
+// nothing, if the buffers cannot be allocated.  Calls "done" once all of "dst"
+// is written.  Blocks while all the buffers are in use.
+bool StagedCopyFromDevice(EventMgr* event_mgr, Allocator* allocator,
+                          se::Stream* stream, const void* src, void* dst,
+                          int64 total_bytes, std::function<void()> done) {
+  const int64 chunk_bytes = StagedCopyChunkBytes();
+  const int64 num_chunks = (total_bytes + chunk_bytes - 1) / chunk_bytes;
+  struct State {
+    Allocator* allocator;
+    std::vector<void*> buffers;
+    std::function<void()> done;
+    // The number of chunks not yet copied to "dst".
+    std::atomic<int64> pending;
+  };
+  auto state = std::make_shared<State>();
+  if (!AllocateStagingBuffers(allocator, num_chunks, &state->buffers)) {
+    return false;
+  }
+  state->allocator = allocator;
+  state->done = std::move(done);
+  state->pending = num_chunks;
+  // Notified once each buffer is copied to "dst".
+  std::vector<std::shared_ptr<Notification>> copied(state->buffers.size());
+  for (int64 i = 0; i < num_chunks; ++i) {
+    const int64 offset = i * chunk_bytes;
+    const int64 bytes = std::min(chunk_bytes, total_bytes - offset);
+    const int b = i % state->buffers.size();
+    if (copied[b] != nullptr) copied[b]->WaitForNotification();
+    void* buffer = state->buffers[b];
+    DeviceMemoryBase gpu_src_ptr(
+        const_cast<char*>(static_cast<const char*>(src)) + offset, bytes);
+    stream->ThenMemcpy(buffer, gpu_src_ptr, bytes);
+    std::shared_ptr<Notification> note = std::make_shared<Notification>();
+    copied[b] = note;
+    char* chunk_dst = static_cast<char*>(dst) + offset;
+    // The callbacks may run concurrently, so the last one to finish releases
+    // the buffers.
+    event_mgr->ThenExecute(stream, [state, note, buffer, chunk_dst, bytes]() {
+      std::memcpy(chunk_dst, buffer, bytes);
+      note->Notify();
+      if (--state->pending == 0) {
+        for (void* b : state->buffers) state->allocator->DeallocateRaw(b);
+        state->done();
+      }
+    });
+  }
+  return true;
+}
+
+}  // namespace
+
 /*static*/
 void GPUUtil::SetProtoFromGPU(const Tensor& tensor, Device* dev,
                               const DeviceContext* device_context,
@@ -275,24 +434,32 @@ void GPUUtil::CopyGPUTensorToCPU(Device* gpu_device,
   // Wait for the sender's main stream to make sure the data are available.
   send_device_to_host_stream->ThenWaitFor(send_stream);
 
+  // Use of the input may outlive stack scope, so keep a ref.
+  TensorReference input_ref(*gpu_tensor);
+  auto copy_done = [send_device_to_host_stream, done, input_ref]() {
+    if (!send_device_to_host_stream->ok()) {
+      LOG(FATAL) << "GPU->CPU Memcpy failed";
+    }
+    input_ref.Unref();
+    done(Status::OK());
+  };
   const int64 total_bytes = gpu_tensor->TotalBytes();
   if (total_bytes > 0) {
     void* src_ptr = GetBase(gpu_tensor);
-    DeviceMemoryBase gpu_src_ptr(src_ptr, total_bytes);
     void* dst_ptr = GetBase(cpu_tensor);
+    Allocator* staging_allocator =
+        StagingAllocator(gpu_device, dst_ptr, total_bytes);
+    if (staging_allocator != nullptr &&
+        StagedCopyFromDevice(dev_info->event_mgr, staging_allocator,
+                             send_device_to_host_stream, src_ptr, dst_ptr,
+                             total_bytes, copy_done)) {
+      return;
+    }
+    DeviceMemoryBase gpu_src_ptr(src_ptr, total_bytes);
     send_device_to_host_stream->ThenMemcpy(dst_ptr, gpu_src_ptr, total_bytes);
   }
-  // Use of the input may outlive stack scope, so keep a ref.
-  TensorReference input_ref(*gpu_tensor);
-  dev_info->event_mgr->ThenExecute(
-      send_device_to_host_stream,
-      [send_device_to_host_stream, done, input_ref]() {
-        if (!send_device_to_host_stream->ok()) {
-          LOG(FATAL) << "GPU->CPU Memcpy failed";
-        }
-        input_ref.Unref();
-        done(Status::OK());
-      });
+  dev_info->event_mgr->ThenExecute(send_device_to_host_stream,
+                                   std::move(copy_done));
 }
 
 /*  static */
@@ -327,8 +494,16 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
   if (total_bytes > 0) {
     void* src_ptr = GetBase(cpu_tensor);
     void* dst_ptr = GetBase(gpu_tensor);
-    DeviceMemoryBase gpu_dst_ptr(dst_ptr, total_bytes);
-    recv_host_to_device_stream->ThenMemcpy(&gpu_dst_ptr, src_ptr, total_bytes);
+    Allocator* staging_allocator =
+        StagingAllocator(gpu_device, src_ptr, total_bytes);
+    if (staging_allocator == nullptr ||
+        !StagedCopyToDevice(dev_info->event_mgr, staging_allocator,
+                            recv_host_to_device_stream, src_ptr, dst_ptr,
+                            total_bytes)) {
+      DeviceMemoryBase gpu_dst_ptr(dst_ptr, total_bytes);
+      recv_host_to_device_stream->ThenMemcpy(&gpu_dst_ptr, src_ptr,
+                                             total_bytes);
+    }
   }
   // Use of cpu_tensor may outlive stack scope, so keep a ref.
   TensorReference input_ref(*cpu_tensor);
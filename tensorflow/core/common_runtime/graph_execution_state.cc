@@ -276,6 +276,43 @@ Status GraphExecutionState::Extend(
   return Status::OK();
 }
 
+Status GraphExecutionState::Replace(
+    const std::unordered_map<string, string>& requested_devices,
+    std::unique_ptr<GraphExecutionState>* out) const {
+  if (!original_graph_def_) {
+    return errors::FailedPrecondition(
+        "Placing the graph again is not supported when "
+        "`optimize_for_static_graph` is true.");
+  }
+  auto gdef = absl::make_unique<GraphDef>(*original_graph_def_);
+  for (NodeDef& node : *gdef->mutable_node()) {
+    auto it = requested_devices.find(node.name());
+    if (it != requested_devices.end()) {
+      node.set_device(it->second);
+    }
+  }
+
+  GraphExecutionStateOptions options;
+  options.device_set = device_set_;
+  options.session_options = session_options_;
+  options.session_handle = session_handle_;
+  options.stateful_placements = stateful_placements_;
+  auto flib_def = absl::make_unique<FunctionLibraryDefinition>(
+      OpRegistry::Global(), gdef->library());
+  auto new_execution_state = absl::WrapUnique(new GraphExecutionState(
+      std::move(gdef), std::move(flib_def), options));
+
+  if (!session_options_->config.graph_options().place_pruned_graph()) {
+    auto base_graph = absl::make_unique<Graph>(OpRegistry::Global());
+    TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(
+        {}, *new_execution_state->original_graph_def_, base_graph.get()));
+    TF_RETURN_IF_ERROR(
+        new_execution_state->InitBaseGraph(std::move(base_graph)));
+  }
+  *out = std::move(new_execution_state);
+  return Status::OK();
+}
+
 void GraphExecutionState::SaveStatefulNodes(Graph* graph) {
   for (Node* n : graph->nodes()) {
     if (n->op_def().is_stateful()) {
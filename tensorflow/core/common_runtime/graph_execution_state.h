@@ -130,6 +130,16 @@ class GraphExecutionState {
   Status Extend(const GraphDef& extension_def,
                 std::unique_ptr<GraphExecutionState>* out) const;
 
+  // Creates a new GraphExecutionState for the same graph, in which the nodes
+  // named in `requested_devices` request the mapped devices, and places it
+  // again. The placement of stateful nodes is kept.
+  //
+  // If successful, returns OK and the caller takes ownership of "*out".
+  // Otherwise returns an error and does not modify "*out".
+  Status Replace(
+      const std::unordered_map<string, string>& requested_devices,
+      std::unique_ptr<GraphExecutionState>* out) const;
+
   // Builds a ClientGraph (a sub-graph of the full graph as induced by
   // the Node set specified in "options").  If successful, returns OK
   // and the caller takes the ownership of "*out". Otherwise, returns
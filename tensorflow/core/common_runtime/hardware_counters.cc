@@ -0,0 +1,122 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/hardware_counters.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+#if defined(__linux__)
+namespace {
+
+// The events of the counters, in the order of HardwareCounterValues.
+constexpr uint64 kCounterEvents[] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+};
+
+int OpenCounter(uint64 event, int group_fd) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = event;
+  attr.read_format = PERF_FORMAT_GROUP;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  // Count the calling thread on any CPU.
+  return syscall(__NR_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1, group_fd,
+                 /*flags=*/0);
+}
+
+}  // namespace
+
+ThreadHardwareCounters::ThreadHardwareCounters() {
+  static_assert(sizeof(kCounterEvents) / sizeof(kCounterEvents[0]) ==
+                    kNumCounters,
+                "");
+  fds_[0] = OpenCounter(kCounterEvents[0], /*group_fd=*/-1);
+  for (int i = 1; i < kNumCounters; ++i) {
+    fds_[i] = fds_[0] < 0 ? -1 : OpenCounter(kCounterEvents[i], fds_[0]);
+  }
+  if (fds_[0] < 0) {
+    VLOG(1) << "Hardware performance counters are unavailable: "
+            << strerror(errno);
+  }
+}
+
+ThreadHardwareCounters::~ThreadHardwareCounters() {
+  for (int fd : fds_) {
+    if (fd >= 0) close(fd);
+  }
+}
+
+bool ThreadHardwareCounters::Read(HardwareCounterValues* values) const {
+  // With PERF_FORMAT_GROUP, the leader reads the number of counters of the
+  // group, then the value of each counter.
+  struct {
+    uint64 nr;
+    uint64 values[kNumCounters];
+  } group;
+  const ssize_t size = read(fds_[0], &group, sizeof(group));
+  if (size < static_cast<ssize_t>(sizeof(group.nr))) return false;
+  int64 counts[kNumCounters] = {};
+  // The counters of the group are read in the order they were opened, skipping
+  // the ones that failed to open.
+  uint64 next = 0;
+  for (int i = 0; i < kNumCounters && next < group.nr; ++i) {
+    if (fds_[i] >= 0) counts[i] = group.values[next++];
+  }
+  values->cpu_cycles = counts[0];
+  values->instructions = counts[1];
+  values->llc_misses = counts[2];
+  return true;
+}
+
+/*static*/ ThreadHardwareCounters* ThreadHardwareCounters::Get() {
+  static thread_local ThreadHardwareCounters counters;
+  return counters.fds_[0] >= 0 ? &counters : nullptr;
+}
+
+#else  // !defined(__linux__)
+
+ThreadHardwareCounters::ThreadHardwareCounters() {
+  for (int i = 0; i < kNumCounters; ++i) fds_[i] = -1;
+}
+
+ThreadHardwareCounters::~ThreadHardwareCounters() {}
+
+bool ThreadHardwareCounters::Read(HardwareCounterValues* values) const {
+  return false;
+}
+
+/*static*/ ThreadHardwareCounters* ThreadHardwareCounters::Get() {
+  return nullptr;
+}
+
+#endif  // defined(__linux__)
+
+}  // namespace tensorflow
@@ -0,0 +1,62 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HARDWARE_COUNTERS_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HARDWARE_COUNTERS_H_
+
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Values of the hardware performance counters of a thread. A counter the CPU
+// does not support reads as 0.
+struct HardwareCounterValues {
+  int64 cpu_cycles = 0;
+  int64 instructions = 0;
+  int64 llc_misses = 0;
+};
+
+// The hardware performance counters of the calling thread, counted in user
+// space with perf_event_open(2).
+//
+// Counters are only available on Linux, when the kernel lets processes count
+// their own events (see /proc/sys/kernel/perf_event_paranoid).
+class ThreadHardwareCounters {
+ public:
+  ~ThreadHardwareCounters();
+
+  // Returns the counters of the calling thread, which are opened the first
+  // time the thread calls Get(), or nullptr if counters are unavailable.
+  static ThreadHardwareCounters* Get();
+
+  // Reads the current values of the counters. Returns false on failure.
+  bool Read(HardwareCounterValues* values) const;
+
+ private:
+  static constexpr int kNumCounters = 3;
+
+  ThreadHardwareCounters();
+
+  // The group leader counts cycles, and the other counters are read with it.
+  // A counter that could not be opened is -1.
+  int fds_[kNumCounters];
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ThreadHardwareCounters);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HARDWARE_COUNTERS_H_
@@ -0,0 +1,244 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include <memory>
+#include <set>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+
+HierarchicalReducer::~HierarchicalReducer() {
+  // The merge and final ops of the phases are borrowed from col_params_.
+  for (CollectiveParams* sub : {&local_reduce_params_, &peer_reduce_params_}) {
+    sub->merge_op.release();
+    sub->final_op.release();
+  }
+}
+
+/*static*/
+bool HierarchicalReducer::IsApplicable(const CollectiveParams& col_params) {
+  return col_params.group.num_tasks > 1 &&
+         col_params.instance.same_num_devices_per_task &&
+         col_params.group.group_size > col_params.group.num_tasks;
+}
+
+Status HierarchicalReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  DCHECK_EQ(col_params->instance.type, REDUCTION_COLLECTIVE);
+  DCHECK_EQ(col_params->instance.impl_details.collective_name,
+            "HierarchicalReduce");
+  if (!IsApplicable(*col_params)) {
+    return errors::Internal(
+        "HierarchicalReduce requires a group spanning several tasks with the "
+        "same number of devices each, got ",
+        col_params->group.group_size, " devices in ",
+        col_params->group.num_tasks, " tasks for ", col_params->name);
+  }
+  // Precondition: device_names must be sorted so that all devices in the same
+  // task are adjacent.
+  const int devices_per_task =
+      col_params->group.group_size / col_params->group.num_tasks;
+  for (int di = 0; di < col_params->group.group_size; ++di) {
+    if (col_params->instance.task_names[di] !=
+        col_params->instance.task_names[di - di % devices_per_task]) {
+      return errors::Internal("Devices of ", col_params->name,
+                              " are not sorted by task");
+    }
+  }
+  return Status::OK();
+}
+
+Status HierarchicalReducer::InitializeCollectiveContext(
+    CollectiveContext* col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = &col_ctx->col_params;
+  TF_RETURN_IF_ERROR(collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality));
+
+  const int num_tasks = col_params_->group.num_tasks;
+  devices_per_task_ = col_params_->group.group_size / num_tasks;
+  const int task = col_params_->default_rank / devices_per_task_;
+  local_rank_ = col_params_->default_rank % devices_per_task_;
+  const int64 num_elements = col_ctx->output->NumElements();
+  shard_elements_ = (num_elements + devices_per_task_ - 1) / devices_per_task_;
+
+  std::vector<int> local_ranks;
+  for (int di = 0; di < devices_per_task_; ++di) {
+    local_ranks.push_back(task * devices_per_task_ + di);
+  }
+  std::vector<int> peer_ranks;
+  for (int ti = 0; ti < num_tasks; ++ti) {
+    peer_ranks.push_back(ti * devices_per_task_ + local_rank_);
+  }
+  const int64 padded_elements = shard_elements_ * devices_per_task_;
+  TF_RETURN_IF_ERROR(InitializeSubParams(REDUCTION_COLLECTIVE, "RingReduce",
+                                         local_ranks, padded_elements,
+                                         &local_reduce_params_));
+  TF_RETURN_IF_ERROR(InitializeSubParams(REDUCTION_COLLECTIVE, "RingReduce",
+                                         peer_ranks, shard_elements_,
+                                         &peer_reduce_params_));
+  return InitializeSubParams(GATHER_COLLECTIVE, "RingGather", local_ranks,
+                             padded_elements, &local_gather_params_);
+}
+
+Status HierarchicalReducer::InitializeSubParams(CollectiveType type,
+                                                const string& collective_name,
+                                                const std::vector<int>& ranks,
+                                                int64 num_elements,
+                                                CollectiveParams* sub) {
+  const CollectiveParams& cp = *col_params_;
+  sub->name = strings::StrCat(cp.name, ":", collective_name);
+  sub->group.group_key = cp.group.group_key;
+  sub->group.group_size = ranks.size();
+  sub->group.device_type = cp.group.device_type;
+  sub->instance = cp.instance;
+  sub->instance.type = type;
+  sub->instance.shape = TensorShape({num_elements});
+  sub->instance.device_names.clear();
+  sub->instance.task_names.clear();
+  sub->instance.impl_details.collective_name = collective_name;
+  sub->instance.impl_details.subdiv_permutations.clear();
+  if (type == GATHER_COLLECTIVE) {
+    sub->instance.impl_details.subdiv_offsets.clear();
+  } else {
+    // Both reduce phases call UnblockDependencies() on this instance, so each
+    // device of the task counts twice.
+    for (auto& it : sub->instance.num_devices_per_task) {
+      it.second *= 2;
+    }
+    sub->merge_op.reset(cp.merge_op.get());
+    // With the same number of devices in every task, dividing by the devices
+    // per task and then by the number of tasks yields the group mean.
+    sub->final_op.reset(cp.final_op.get());
+  }
+  sub->task.is_local.clear();
+  std::set<string> tasks;
+  for (int i = 0; i < ranks.size(); ++i) {
+    sub->instance.device_names.push_back(cp.instance.device_names[ranks[i]]);
+    sub->instance.task_names.push_back(cp.instance.task_names[ranks[i]]);
+    sub->task.is_local.push_back(cp.task.is_local[ranks[i]]);
+    tasks.insert(cp.instance.task_names[ranks[i]]);
+    if (ranks[i] == cp.default_rank) sub->default_rank = i;
+  }
+  sub->group.num_tasks = tasks.size();
+
+  CollectiveImplementationInterface* col_impl;
+  TF_RETURN_IF_ERROR(CollectiveRegistry::LookupParamResolverInstance(
+      collective_name, &col_impl));
+  return col_impl->InitializeCollectiveParams(sub);
+}
+
+void HierarchicalReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  const int64 num_elements = col_ctx_->output->NumElements();
+  const int64 padded_elements = shard_elements_ * devices_per_task_;
+  Tensor output;
+  CHECK(output.CopyFrom(*col_ctx_->output, TensorShape({num_elements})));
+
+  // Work on the output in place unless the tensor must be padded.
+  Tensor work;
+  if (padded_elements == num_elements) {
+    work = output;
+  } else {
+    work = Tensor(col_ctx_->device->GetAllocator(
+                      col_ctx_->op_ctx->output_alloc_attr(0)),
+                  col_params_->instance.data_type,
+                  TensorShape({padded_elements}));
+  }
+  Tensor input;
+  CHECK(input.CopyFrom(*col_ctx_->input, TensorShape({num_elements})));
+  Tensor work_prefix = work.Slice(0, num_elements);
+  Status status;
+  if (DMAHelper::base(&input) != DMAHelper::base(&work_prefix)) {
+    status = MemCpy(&input, &work_prefix);
+  }
+
+  Tensor shard = work.Slice(local_rank_ * shard_elements_,
+                            (local_rank_ + 1) * shard_elements_);
+  if (status.ok()) {
+    status = RunSubCollective(local_reduce_params_, "local", &work, &work);
+  }
+  if (status.ok()) {
+    status = RunSubCollective(peer_reduce_params_, "peer", &shard, &shard);
+  }
+  if (status.ok()) {
+    status = RunSubCollective(local_gather_params_, "gather", &shard, &work);
+  }
+  if (status.ok() && padded_elements != num_elements) {
+    status = MemCpy(&work_prefix, &output);
+  }
+  done(status);
+}
+
+Status HierarchicalReducer::RunSubCollective(const CollectiveParams& sub,
+                                             const string& phase,
+                                             const Tensor* input,
+                                             Tensor* output) {
+  profiler::TraceMe activity(
+      [&] { return strings::StrCat("HierarchicalReduce:", phase); },
+      profiler::TraceMeLevel::kInfo);
+  CollectiveImplementationInterface* col_impl = nullptr;
+  TF_RETURN_IF_ERROR(CollectiveRegistry::Lookup(
+      sub.instance.impl_details.collective_name, &col_impl));
+  std::unique_ptr<CollectiveImplementationInterface> impl(col_impl);
+  // Each phase gets its own exec_key, so that their BufRendezvous keys differ.
+  CollectiveContext ctx(col_ctx_->col_exec, col_ctx_->dev_mgr,
+                        col_ctx_->op_ctx, col_ctx_->op_params, sub,
+                        strings::StrCat(col_ctx_->exec_key, ":", phase),
+                        col_ctx_->step_id, input, output);
+  TF_RETURN_IF_ERROR(impl->InitializeCollectiveContext(&ctx));
+  Notification note;
+  Status status;
+  impl->Run([&note, &status](const Status& s) {
+    status = s;
+    note.Notify();
+  });
+  note.WaitForNotification();
+  return status;
+}
+
+Status HierarchicalReducer::MemCpy(const Tensor* src, Tensor* dst) {
+  Notification note;
+  Status status;
+  CollectiveRemoteAccessLocal::MemCpyAsync(
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+      col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+      col_ctx_->op_ctx->output_alloc_attr(0), src, dst,
+      0 /*dev_to_dev_stream_index*/, [&note, &status](const Status& s) {
+        status.Update(s);
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
+
+REGISTER_COLLECTIVE(HierarchicalReduce, HierarchicalReducer);
+
+}  // namespace tensorflow
@@ -0,0 +1,89 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+
+namespace tensorflow {
+
+// Hierarchical implementation of collective all-reduce for groups spanning
+// several tasks with the same number of devices each.  A flat ring crosses
+// the network at every task boundary on every one of its 2 * (group_size - 1)
+// steps; this implementation instead
+//   1. all-reduces the tensor among the devices of each task,
+//   2. all-reduces shard i of the tensor among the i-th devices of all tasks,
+//      so that only 2 * (num_tasks - 1) steps cross the network, each
+//      carrying one shard per device,
+//   3. all-gathers the shards among the devices of each task.
+// Each phase is a RingReducer or RingGatherer over a subset of the group.
+// The tensor is padded to a multiple of the devices per task when needed.
+class HierarchicalReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalReducer() = default;
+  ~HierarchicalReducer() override;
+
+  // Checks that the group suits a hierarchical reduction, i.e. that it spans
+  // several tasks with the same number of devices each.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality, and the CollectiveParams of the three phases.
+  Status InitializeCollectiveContext(CollectiveContext* col_ctx) override;
+
+  // No-op for hierarchical reducer.
+  Status InitializeCollectiveGroupRuntimeDetails(
+      CollGroupRuntimeDetails*) override {
+    return Status::OK();
+  }
+
+  // Runs the three phases in turn.
+  // Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+  // Returns true if a reduction over the group of `col_params` benefits from
+  // HierarchicalReducer.
+  static bool IsApplicable(const CollectiveParams& col_params);
+
+ private:
+  // Populates `sub` with the CollectiveParams of a collective of `type`,
+  // implemented by `collective_name`, among the devices of `ranks`, over a
+  // vector of `num_elements`.
+  Status InitializeSubParams(CollectiveType type, const string& collective_name,
+                             const std::vector<int>& ranks, int64 num_elements,
+                             CollectiveParams* sub);
+
+  // Runs the collective of `sub` on `input` and `output`, and waits for it.
+  Status RunSubCollective(const CollectiveParams& sub, const string& phase,
+                          const Tensor* input, Tensor* output);
+
+  // Copies `src` to `dst` on this device, and waits for the copy.
+  Status MemCpy(const Tensor* src, Tensor* dst);
+
+  CollectiveContext* col_ctx_ = nullptr;          // Not owned
+  const CollectiveParams* col_params_ = nullptr;  // Not owned
+  int devices_per_task_ = 0;
+  int local_rank_ = 0;
+  int64 shard_elements_ = 0;
+  CollectiveParams local_reduce_params_;
+  CollectiveParams peer_reduce_params_;
+  CollectiveParams local_gather_params_;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
@@ -0,0 +1,237 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include <atomic>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/device_resolver_local.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/common_runtime/test_collective_executor_mgr.h"
+#include "tensorflow/core/common_runtime/threadpool_device.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/unbounded_work_queue.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+static int64 kStepId = 123;
+
+std::unique_ptr<OpKernel> GetKernel(const string& op, DataType dtype,
+                                    int num_inputs, DeviceBase* device) {
+  NodeDef node_def;
+  NodeDefBuilder builder(strings::StrCat(op, "_node"), op);
+  builder.Attr("T", dtype);
+  for (int i = 0; i < num_inputs; ++i) {
+    builder.Input(FakeInput(dtype));
+  }
+  if (op == "CollectiveReduce") {
+    builder.Attr("merge_op", "Add")
+        .Attr("final_op", "Div")
+        .Attr("group_size", 1)
+        .Attr("group_key", 1)
+        .Attr("instance_key", 1)
+        .Attr("subdiv_offsets", std::vector<int>());
+  }
+  TF_CHECK_OK(builder.Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      DEVICE_CPU, device, device->GetAllocator(AllocatorAttributes()), node_def,
+      TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+class HierarchicalReducerTest : public ::testing::Test {
+ protected:
+  ~HierarchicalReducerTest() override {
+    if (col_exec_) col_exec_->Unref();
+  }
+
+  // Sets up `num_tasks` simulated tasks of `num_devices` CPU devices each, all
+  // in this process.
+  void Init(int num_tasks, int num_devices) {
+    std::vector<std::unique_ptr<Device>> devices;
+    SessionOptions sess_opts;
+    sess_opts.env = Env::Default();
+    col_params_.name = "test_collective";
+    col_params_.group.group_key = 5;
+    col_params_.group.device_type = DEVICE_CPU;
+    col_params_.group.group_size = num_tasks * num_devices;
+    col_params_.group.num_tasks = num_tasks;
+    col_params_.instance.instance_key = 17;
+    col_params_.instance.type = REDUCTION_COLLECTIVE;
+    col_params_.instance.data_type = DT_FLOAT;
+    col_params_.instance.impl_details.collective_name = "HierarchicalReduce";
+    col_params_.instance.same_num_devices_per_task = true;
+    for (int ti = 0; ti < num_tasks; ++ti) {
+      const string task_name =
+          strings::StrCat("/job:worker/replica:0/task:", ti);
+      col_params_.instance.num_devices_per_task[task_name] = num_devices;
+      for (int di = 0; di < num_devices; ++di) {
+        const string dev_name = strings::StrCat(task_name, "/cpu:", di);
+        devices.push_back(absl::make_unique<ThreadPoolDevice>(
+            sess_opts, dev_name, Bytes(4 << 20), DeviceLocality(),
+            cpu_allocator()));
+        col_params_.instance.device_names.push_back(dev_name);
+        col_params_.instance.task_names.push_back(task_name);
+        // This test runs in a single process so is_local is always true.
+        col_params_.task.is_local.push_back(true);
+      }
+    }
+    dev_mgr_ = absl::make_unique<StaticDeviceMgr>(std::move(devices));
+    dev_resolver_ = absl::make_unique<DeviceResolverLocal>(dev_mgr_.get());
+    auto work_queue =
+        std::make_shared<UnboundedWorkQueue>(Env::Default(), "test");
+    col_exec_ = new BaseCollectiveExecutor(
+        &col_exec_mgr_,
+        new CollectiveRemoteAccessLocal(dev_mgr_.get(), dev_resolver_.get(),
+                                        work_queue, kStepId),
+        kStepId, dev_mgr_.get(), &gpu_ring_order_);
+    HierarchicalReducer reducer;
+    TF_ASSERT_OK(reducer.InitializeCollectiveParams(&col_params_));
+  }
+
+  // Reduces the tensors of all devices, where device `rank` contributes
+  // rank * 100 + i at index i, and checks that each gets the mean.
+  void RunTest(int num_tasks, int num_devices, int tensor_len) {
+    Init(num_tasks, num_devices);
+    const int group_size = num_tasks * num_devices;
+    std::vector<Tensor> tensors(group_size);
+    std::vector<Status> statuses(group_size);
+    std::atomic<int> done(0);
+    for (int rank = 0; rank < group_size; ++rank) {
+      tensors[rank] = Tensor(DT_FLOAT, TensorShape({tensor_len}));
+      for (int i = 0; i < tensor_len; ++i) {
+        tensors[rank].flat<float>()(i) = rank * 100 + i;
+      }
+      SchedClosure([this, rank, &tensors, &statuses, &done] {
+        statuses[rank] = DoReduce(rank, &tensors[rank]);
+        ++done;
+      });
+    }
+    while (done < group_size) {
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+    const float mean_offset = 100.0f * (group_size - 1) / 2;
+    for (int rank = 0; rank < group_size; ++rank) {
+      TF_EXPECT_OK(statuses[rank]);
+      for (int i = 0; i < tensor_len; ++i) {
+        EXPECT_FLOAT_EQ(mean_offset + i, tensors[rank].flat<float>()(i))
+            << "Mismatch at device " << rank << " index " << i;
+      }
+    }
+  }
+
+  Status DoReduce(int rank, Tensor* tensor) {
+    Device* device = nullptr;
+    TF_RETURN_IF_ERROR(dev_mgr_->LookupDevice(
+        col_params_.instance.device_names[rank], &device));
+    CollectiveParams col_params;
+    col_params.name = col_params_.name;
+    col_params.group = col_params_.group;
+    col_params.instance = col_params_.instance;
+    col_params.instance.impl_details.collective_name =
+        col_params_.instance.impl_details.collective_name;
+    col_params.task = col_params_.task;
+    col_params.default_rank = rank;
+    col_params.merge_op = GetKernel("Add", DT_FLOAT, 2, device);
+    col_params.final_op = GetKernel("Div", DT_FLOAT, 2, device);
+
+    OpKernelContext::Params op_params;
+    op_params.step_id = kStepId;
+    op_params.device = device;
+    gtl::InlinedVector<TensorValue, 4> inputs;
+    inputs.push_back(TensorValue(tensor));
+    op_params.inputs = &inputs;
+    gtl::InlinedVector<AllocatorAttributes, 4> input_aa(
+        {AllocatorAttributes()});
+    op_params.input_alloc_attrs = &input_aa;
+    DeviceContext* dev_ctx = new DeviceContext;
+    op_params.op_device_context = dev_ctx;
+    int forward_from = 0;
+    op_params.forward_from_array = &forward_from;
+    AllocatorAttributes generic_alloc_attr;
+    op_params.output_attr_array = &generic_alloc_attr;
+    std::unique_ptr<OpKernel> op =
+        GetKernel("CollectiveReduce", DT_FLOAT, 1, device);
+    op_params.op_kernel = op.get();
+    OpKernelContext ctx(&op_params, 1);
+    Tensor* output = nullptr;
+    TF_CHECK_OK(ctx.forward_input_or_allocate_output({0}, 0, tensor->shape(),
+                                                     &output));
+
+    string exec_key = strings::StrCat(col_params.instance.instance_key, ":0:0");
+    HierarchicalReducer reducer;
+    CollectiveContext col_ctx(col_exec_, dev_mgr_.get(), &ctx, &op_params,
+                              col_params, exec_key, kStepId, tensor, output);
+    Status status = reducer.InitializeCollectiveContext(&col_ctx);
+    if (status.ok()) {
+      reducer.Run([&status](const Status& s) { status = s; });
+    }
+    if (status.ok()) {
+      CHECK(tensor->CopyFrom(*output, tensor->shape()));
+    }
+    dev_ctx->Unref();
+    return status;
+  }
+
+  TestCollectiveExecutorMgr col_exec_mgr_;
+  CollectiveExecutor* col_exec_ = nullptr;
+  std::unique_ptr<DeviceMgr> dev_mgr_;
+  std::unique_ptr<DeviceResolverLocal> dev_resolver_;
+  string gpu_ring_order_;
+  CollectiveParams col_params_;
+};
+
+TEST_F(HierarchicalReducerTest, IsApplicable) {
+  Init(2, 2);
+  EXPECT_TRUE(HierarchicalReducer::IsApplicable(col_params_));
+  col_params_.instance.same_num_devices_per_task = false;
+  EXPECT_FALSE(HierarchicalReducer::IsApplicable(col_params_));
+  col_params_.instance.same_num_devices_per_task = true;
+  col_params_.group.num_tasks = 1;
+  EXPECT_FALSE(HierarchicalReducer::IsApplicable(col_params_));
+  col_params_.group.num_tasks = col_params_.group.group_size;
+  EXPECT_FALSE(HierarchicalReducer::IsApplicable(col_params_));
+}
+
+TEST_F(HierarchicalReducerTest, Reduce2Tasks2Devices) { RunTest(2, 2, 8); }
+
+TEST_F(HierarchicalReducerTest, Reduce2Tasks2DevicesPadded) {
+  RunTest(2, 2, 7);
+}
+
+TEST_F(HierarchicalReducerTest, Reduce3Tasks4Devices) { RunTest(3, 4, 1001); }
+
+TEST_F(HierarchicalReducerTest, ReduceFewerElementsThanDevices) {
+  RunTest(2, 4, 3);
+}
+
+}  // namespace
+}  // namespace tensorflow
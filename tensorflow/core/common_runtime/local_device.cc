@@ -47,6 +47,23 @@ bool OverrideGlobalThreadPoolFromEnvironment() {
   return override_global_threadpool;
 }
 
+// Returns true if the intra-op thread pools should run in work-stealing mode,
+// for many-core machines where small parallel loops are dominated by waking
+// threads.
+bool IntraOpWorkStealingFromEnvironment() {
+  static const bool work_stealing = [] {
+    bool flag;
+    auto status = ReadBoolFromEnvVar("TF_INTRA_OP_WORK_STEALING",
+                                     /*default_val=*/false, &flag);
+    if (!status.ok()) {
+      LOG(ERROR) << "IntraOpWorkStealing: " << status.error_message();
+      return false;
+    }
+    return flag;
+  }();
+  return work_stealing;
+}
+
 }  // namespace
 
 /* static */
@@ -87,11 +104,25 @@ struct LocalDevice::EigenThreadPoolInfo {
     ThreadOptions thread_opts;
     thread_opts.numa_node = numa_node;
     eigen_worker_threads_.num_threads = intra_op_parallelism_threads;
-    eigen_worker_threads_.workers = new thread::ThreadPool(
-        options.env, thread_opts, strings::StrCat("numa_", numa_node, "_Eigen"),
-        intra_op_parallelism_threads,
-        !options.config.experimental().disable_thread_spinning(),
-        /*allocator=*/nullptr);
+    const bool allow_spinning =
+        !options.config.experimental().disable_thread_spinning();
+    if (IntraOpWorkStealingFromEnvironment()) {
+      thread::ThreadPool::WorkStealingOptions work_stealing_options;
+      work_stealing_options.numa_aware = true;
+      work_stealing_options.cost_measurement_nanos = 10000;
+      work_stealing_options.max_spin_nanos = allow_spinning ? 20000 : 0;
+      eigen_worker_threads_.workers = new thread::ThreadPool(
+          options.env, thread_opts,
+          strings::StrCat("numa_", numa_node, "_Eigen"),
+          intra_op_parallelism_threads, allow_spinning, work_stealing_options,
+          /*allocator=*/nullptr);
+    } else {
+      eigen_worker_threads_.workers = new thread::ThreadPool(
+          options.env, thread_opts,
+          strings::StrCat("numa_", numa_node, "_Eigen"),
+          intra_op_parallelism_threads, allow_spinning,
+          /*allocator=*/nullptr);
+    }
     Eigen::ThreadPoolInterface* threadpool =
         eigen_worker_threads_.workers->AsEigenThreadPool();
     if (allocator != nullptr) {
@@ -149,9 +180,15 @@ LocalDevice::LocalDevice(const SessionOptions& options,
   } else {
     // Each LocalDevice owns a separate ThreadPoolDevice for numerical
     // computations.
-    // TODO(tucker): NUMA for these too?
-    owned_tp_info_.reset(new LocalDevice::EigenThreadPoolInfo(
-        options, port::kNUMANoAffinity, nullptr));
+    if (options.config.experimental().use_numa_affinity()) {
+      int numa_node = attributes.locality().numa_node();
+      owned_tp_info_.reset(new LocalDevice::EigenThreadPoolInfo(
+          options, numa_node,
+          ProcessState::singleton()->GetCPUAllocator(numa_node)));
+    } else {
+      owned_tp_info_.reset(new LocalDevice::EigenThreadPoolInfo(
+          options, port::kNUMANoAffinity, nullptr));
+    }
     tp_info = owned_tp_info_.get();
   }
   set_tensorflow_cpu_worker_threads(&tp_info->eigen_worker_threads_);
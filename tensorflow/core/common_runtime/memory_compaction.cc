@@ -0,0 +1,110 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/memory_compaction.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Returns true if `tensor` owns its whole buffer and nothing else refers to
+// it, so swapping in a copy is invisible to everybody but the variable.
+bool IsRelocatable(Tensor* tensor) {
+  if (!tensor->IsInitialized() || tensor->NumElements() == 0 ||
+      !DataTypeCanUseMemcpy(tensor->dtype())) {
+    return false;
+  }
+  TensorBuffer* buffer = DMAHelper::buffer(tensor);
+  return buffer != nullptr && buffer->OwnsMemory() &&
+         buffer->root_buffer() == buffer && buffer->RefCountIsOne();
+}
+
+}  // namespace
+
+Status CompactResourceVariables(Device* device, int64* bytes_relocated) {
+  *bytes_relocated = 0;
+  ResourceMgr* rm = device->resource_manager();
+  if (rm == nullptr) {
+    return Status::OK();
+  }
+  Allocator* allocator = device->GetAllocator(AllocatorAttributes());
+  const DeviceContext* device_context = nullptr;
+  if (const DeviceBase::GpuDeviceInfo* gpu_info =
+          device->tensorflow_gpu_device_info()) {
+    device_context = gpu_info->default_context;
+  }
+
+  std::vector<std::unique_ptr<Var, core::RefCountDeleter>> vars;
+  rm->GetAll<Var>(&vars);
+  for (const auto& var : vars) {
+    mutex_lock ml(*var->mu());
+    Tensor* tensor = var->tensor();
+    if (!var->is_initialized || !IsRelocatable(tensor) ||
+        !allocator->ShouldRelocate(DMAHelper::base(tensor))) {
+      continue;
+    }
+    // Compaction is best effort: give up on this variable rather than wait
+    // for memory to become available.
+    AllocationAttributes allocation_attr;
+    allocation_attr.no_retry_on_failure = true;
+    Tensor relocated(allocator, tensor->dtype(), tensor->shape(),
+                     allocation_attr);
+    if (!relocated.IsInitialized()) {
+      continue;
+    }
+    Notification copied;
+    Status copy_status;
+    device->CopyTensorInSameDevice(tensor, &relocated, device_context,
+                                   [&copied, &copy_status](const Status& s) {
+                                     copy_status = s;
+                                     copied.Notify();
+                                   });
+    copied.WaitForNotification();
+    TF_RETURN_IF_ERROR(copy_status);
+    *bytes_relocated += tensor->TotalBytes();
+    *tensor = relocated;
+  }
+  return Status::OK();
+}
+
+Status MaybeCompactResourceVariables(Device* device,
+                                     double fragmentation_threshold,
+                                     int64* bytes_relocated) {
+  *bytes_relocated = 0;
+  absl::optional<AllocatorStats> stats =
+      device->GetAllocator(AllocatorAttributes())->GetStats();
+  if (!stats || !stats->fragmentation ||
+      *stats->fragmentation < fragmentation_threshold) {
+    return Status::OK();
+  }
+  VLOG(1) << "Compacting memory of " << device->name()
+          << " at fragmentation " << *stats->fragmentation;
+  return CompactResourceVariables(device, bytes_relocated);
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,48 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_COMPACTION_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_COMPACTION_H_
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Moves the buffers of the resource variables in `device`'s resource manager
+// that the device allocator reports as worth relocating (see
+// Allocator::ShouldRelocate) into fresh allocations, so that their old chunks
+// can coalesce with the free memory around them.
+//
+// Each variable is moved under an exclusive lock on its mutex, and only if
+// nothing else aliases its buffer, so it is safe to call while other steps
+// are running; it is meant to be called between steps.  Variables that cannot
+// be copied with memcpy semantics are left in place, as are variables for
+// which no new allocation can be made.
+//
+// On success `*bytes_relocated` holds the number of bytes moved.
+Status CompactResourceVariables(Device* device, int64* bytes_relocated);
+
+// Calls CompactResourceVariables() if the fragmentation reported by the
+// device allocator is at least `fragmentation_threshold`.  Leaves
+// `*bytes_relocated` at 0 if the allocator does not report fragmentation.
+Status MaybeCompactResourceVariables(Device* device,
+                                     double fragmentation_threshold,
+                                     int64* bytes_relocated);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_COMPACTION_H_
@@ -0,0 +1,110 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/memory_compaction.h"
+
+#include "tensorflow/core/common_runtime/threadpool_device.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+// Asks for every buffer to be relocated and reports a fixed fragmentation.
+class RelocatingAllocator : public AllocatorWrapper {
+ public:
+  RelocatingAllocator() : AllocatorWrapper(cpu_allocator()) {}
+
+  bool ShouldRelocate(const void* ptr) const override { return true; }
+
+  absl::optional<AllocatorStats> GetStats() override {
+    AllocatorStats stats;
+    stats.fragmentation = fragmentation;
+    return stats;
+  }
+
+  double fragmentation = 0.5;
+};
+
+class MemoryCompactionTest : public ::testing::Test {
+ protected:
+  MemoryCompactionTest()
+      : device_(SessionOptions(), "/device:CPU:0", Bytes(256 << 20),
+                DeviceLocality(), &allocator_) {}
+
+  // Creates an initialized float variable "v" holding 0, 1, ..., 15. The
+  // caller owns one ref on the result.
+  Var* CreateVariable() {
+    Var* var = new Var(DT_FLOAT);
+    *var->tensor() = test::AsTensor<float>(
+        {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15});
+    var->is_initialized = true;
+    var->Ref();
+    TF_CHECK_OK(device_.resource_manager()->Create("c", "v", var));
+    return var;
+  }
+
+  RelocatingAllocator allocator_;
+  ThreadPoolDevice device_;
+};
+
+TEST_F(MemoryCompactionTest, RelocatesUnaliasedVariables) {
+  Var* var = CreateVariable();
+  core::ScopedUnref unref(var);
+  const Tensor expected = tensor::DeepCopy(*var->tensor());
+  const void* old_data = var->tensor()->tensor_data().data();
+
+  int64 bytes_relocated = 0;
+  TF_ASSERT_OK(CompactResourceVariables(&device_, &bytes_relocated));
+  EXPECT_EQ(64, bytes_relocated);
+  EXPECT_NE(old_data, var->tensor()->tensor_data().data());
+  test::ExpectTensorEqual<float>(expected, *var->tensor());
+}
+
+TEST_F(MemoryCompactionTest, LeavesAliasedVariablesInPlace) {
+  Var* var = CreateVariable();
+  core::ScopedUnref unref(var);
+  const Tensor alias = *var->tensor();
+
+  int64 bytes_relocated = 0;
+  TF_ASSERT_OK(CompactResourceVariables(&device_, &bytes_relocated));
+  EXPECT_EQ(0, bytes_relocated);
+  EXPECT_TRUE(alias.SharesBufferWith(*var->tensor()));
+}
+
+TEST_F(MemoryCompactionTest, RespectsFragmentationThreshold) {
+  Var* var = CreateVariable();
+  core::ScopedUnref unref(var);
+
+  int64 bytes_relocated = 0;
+  TF_ASSERT_OK(
+      MaybeCompactResourceVariables(&device_, 0.75, &bytes_relocated));
+  EXPECT_EQ(0, bytes_relocated);
+
+  allocator_.fragmentation = 0.8;
+  TF_ASSERT_OK(
+      MaybeCompactResourceVariables(&device_, 0.75, &bytes_relocated));
+  EXPECT_EQ(64, bytes_relocated);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -36,6 +36,14 @@ auto* graph_run_time_usecs_histogram = monitoring::Sampler<0>::New(
     // Power of 2 with bucket count 20 (> 17 minutes)
     {monitoring::Buckets::Exponential(1000, 2, 20)});
 
+auto* session_run_time_usecs = monitoring::Sampler<2>::New(
+    {"/tensorflow/core/session_run_time_usecs",
+     "The wall-clock time spent on session runs in microseconds, per model "
+     "and signature.",
+     "model", "signature"},
+    // Power of 2 with bucket count 20 (> 17 minutes)
+    {monitoring::Buckets::Exponential(1000, 2, 20)});
+
 auto* graph_run_input_tensor_bytes = monitoring::Sampler<0>::New(
     {"/tensorflow/core/graph_run_input_tensor_bytes",
      "The size of input tensors in bytes."},
@@ -106,6 +114,21 @@ auto* mlir_import_failure_count = monitoring::Counter<0>::New(
     "/tensorflow/mlir/import_failure_count",
     "The number of jobs that failed during mlir import or verification.");
 
+auto* worker_run_graph_time_usecs_histogram = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/worker_run_graph_time_usecs_histogram",
+     "The wall-clock time spent by the master waiting for the partition of a "
+     "step on a worker in microseconds.",
+     "worker"},
+    // Power of 2 with bucket count 20 (> 17 minutes)
+    {monitoring::Buckets::Exponential(1000, 2, 20)});
+
+auto* step_straggler_time_usecs_histogram = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/step_straggler_time_usecs_histogram",
+     "The wall-clock time between the first and the last partition of a step "
+     "finishing in microseconds."},
+    // Power of 2 with bucket count 20 (> 17 minutes)
+    {monitoring::Buckets::Exponential(1000, 2, 20)});
+
 }  // namespace
 
 void RecordTFDataAutotune(const string& name) {
@@ -156,6 +179,13 @@ void UpdateGraphExecTime(const uint64 running_time_usecs) {
   }
 }
 
+void UpdateSessionRunTime(const string& model, const string& signature,
+                          const uint64 running_time_usecs) {
+  if (running_time_usecs > 0) {
+    session_run_time_usecs->GetCell(model, signature)->Add(running_time_usecs);
+  }
+}
+
 void UpdateGraphBuildTime(const uint64 running_time_usecs) {
   if (running_time_usecs > 0) {
     build_graph_calls->GetCell()->IncrementBy(1);
@@ -174,5 +204,15 @@ void IncrementMLIRImportFailureCount() {
   mlir_import_failure_count->GetCell()->IncrementBy(1);
 }
 
+void UpdateWorkerRunGraphTime(const string& worker,
+                              const uint64 running_time_usecs) {
+  worker_run_graph_time_usecs_histogram->GetCell(worker)->Add(
+      running_time_usecs);
+}
+
+void UpdateStepStragglerTime(const uint64 straggler_time_usecs) {
+  step_straggler_time_usecs_histogram->GetCell()->Add(straggler_time_usecs);
+}
+
 }  // namespace metrics
 }  // namespace tensorflow
@@ -65,6 +65,11 @@ void RecordGraphOutputTensors(const size_t size);
 
 void UpdateGraphExecTime(const uint64 running_time_usecs);
 
+// Records the wall-clock time of a session run of the signature `signature`
+// (the fetches and targets of the run) of the model `model`.
+void UpdateSessionRunTime(const string& model, const string& signature,
+                          const uint64 running_time_usecs);
+
 // Updates the metrics stored about time spent building graphs.
 //
 // By "GraphBuild", we refer to building a client graph, which is a sub-graph of
@@ -86,6 +91,15 @@ void UpdateXlaCompilationTime(const uint64 compilation_time_usecs);
 // Increment the number of jobs that failed during import to mlir.
 void IncrementMLIRImportFailureCount();
 
+// Updates the metrics stored about the time that the partition of a step on
+// `worker` took to run, as seen by the master.
+void UpdateWorkerRunGraphTime(const string& worker,
+                              const uint64 running_time_usecs);
+
+// Updates the metrics stored about the time between the first and the last
+// partition of a step finishing. Large values point to straggling workers.
+void UpdateStepStragglerTime(const uint64 straggler_time_usecs);
+
 }  // namespace metrics
 }  // namespace tensorflow
 
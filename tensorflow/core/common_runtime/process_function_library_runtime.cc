@@ -983,6 +983,7 @@ void ProcessFunctionLibraryRuntime::RunMultiDevice(
     refcounted_done->Ref();
   }
 
+  rets->resize(data->num_outputs_);
   FunctionLibraryRuntime::Options opts_copy = opts;
   for (const auto& pair : data->glue_) {
     const string& target = pair.first;
@@ -1001,8 +1002,10 @@ void ProcessFunctionLibraryRuntime::RunMultiDevice(
       refcounted_done->Unref();
       continue;
     }
+    // `comp_data` is referenced rather than copied by the callbacks below, as
+    // `data` is not released while the function runs.
     std::vector<Tensor>* comp_rets = new std::vector<Tensor>;
-    rets->resize(data->num_outputs_);
+    comp_rets->reserve(comp_data.ret_indices_.size());
 
     FunctionLibraryRuntime* flr = GetFLR(target);
     if (flr != nullptr) {
@@ -1016,7 +1019,7 @@ void ProcessFunctionLibraryRuntime::RunMultiDevice(
       VLOG(4) << "    with " << opts_copy.DebugString();
 
       flr->Run(opts_copy, handle, comp_args.local_args, comp_rets,
-               [comp_rets, rets, comp_data, refcounted_done,
+               [comp_rets, rets, &comp_data, refcounted_done,
                 data](const Status& status) {
                  if (!status.ok()) {
                    VLOG(2) << "Component function execution failed: " << status;
@@ -1043,7 +1046,7 @@ void ProcessFunctionLibraryRuntime::RunMultiDevice(
       InternalArgsView comp_args_view(&comp_args);
       RunInternal(
           opts_copy, handle, comp_args_view, comp_rets, cleanup_items,
-          [comp_rets, rets, comp_data, refcounted_done](const Status& status) {
+          [comp_rets, rets, &comp_data, refcounted_done](const Status& status) {
             if (!status.ok()) {
               VLOG(2) << "Component function execution failed: " << status;
               refcounted_done->UpdateStatus(status);
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
@@ -71,6 +72,24 @@ void IntraProcessRendezvous::SameWorkerRecvDone(
   const bool dst_host =
       (recv_args.alloc_attrs.on_host() || parsed.dst.type == "CPU");
   if (src_host && dst_host) {
+    if (parsed.src.type == "CPU" && parsed.dst.type == "CPU" &&
+        DataTypeCanUseMemcpy(in.dtype()) && in.NumElements() > 0) {
+      // CPU devices pinned to different NUMA nodes each allocate from their
+      // own node; copy the tensor over so the consumer reads local memory.
+      Device* src_device;
+      Device* dst_device;
+      if (device_mgr_->LookupDevice(parsed.src_device, &src_device).ok() &&
+          device_mgr_->LookupDevice(parsed.dst_device, &dst_device).ok() &&
+          src_device->attributes().locality().numa_node() !=
+              dst_device->attributes().locality().numa_node()) {
+        Tensor copy(dst_device->GetAllocator(recv_args.alloc_attrs),
+                    in.dtype(), in.shape());
+        tensor::DeepCopy(in, &copy);
+        *out = copy;
+        done(Status::OK());
+        return;
+      }
+    }
     *out = in;
     done(Status::OK());
     return;
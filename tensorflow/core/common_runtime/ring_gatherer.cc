@@ -96,14 +96,15 @@ void RingGatherer::Run(StatusCallback done) {
                                   col_ctx_->device->GetAllocator(attr),
                                   false /*align_chunks*/));
 
-  // Start by copying input to the rank-specific offset of output.
+  // Start by copying input to the rank-specific offset of output, unless it is
+  // already there.
   // We are running in a blockable thread and the callback can't block so
   // just wait here on the copy.
-  {
+  Tensor alias_chunk(ca_->ChunkAlias(col_params_->subdiv_rank[0]));
+  if (DMAHelper::base(col_ctx_->input) != DMAHelper::base(&alias_chunk)) {
     profiler::TraceMe activity("MemCpyAsync", profiler::TraceMeLevel::kInfo);
     Notification note;
     Status status;
-    Tensor alias_chunk(ca_->ChunkAlias(col_params_->subdiv_rank[0]));
     CollectiveRemoteAccessLocal::MemCpyAsync(
         col_ctx_->op_ctx->op_device_context(),
         col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
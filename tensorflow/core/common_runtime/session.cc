@@ -15,11 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/public/session.h"
 
+#include <algorithm>
 #include <string>
 
 #include "tensorflow/core/common_runtime/session_factory.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/monitoring.h"
 
@@ -60,6 +64,31 @@ Status Session::PRun(const string& handle,
       "Partial run is not supported for this session.");
 }
 
+Status Session::WarmUp(const std::vector<WarmUpSignature>& signatures) {
+  std::vector<Status> statuses(signatures.size());
+  auto warm_up = [this, &signatures, &statuses](int i) {
+    std::vector<Tensor> outputs;
+    statuses[i] = Run(signatures[i].inputs, signatures[i].output_tensor_names,
+                      signatures[i].target_node_names, &outputs);
+  };
+  if (signatures.size() > 1) {
+    // The destructor of the pool waits for all the runs to complete.
+    thread::ThreadPool pool(
+        Env::Default(), "session_warm_up",
+        std::min<int>(signatures.size(), port::MaxParallelism()));
+    for (int i = 0; i < signatures.size(); ++i) {
+      pool.Schedule([&warm_up, i]() { warm_up(i); });
+    }
+  } else if (signatures.size() == 1) {
+    warm_up(0);
+  }
+  for (int i = 0; i < signatures.size(); ++i) {
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(statuses[i],
+                                    "While warming up signature ", i);
+  }
+  return Status::OK();
+}
+
 Session* NewSession(const SessionOptions& options) {
   SessionFactory* factory;
   Status s = SessionFactory::GetFactory(options, &factory);
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/shape_refiner.h"
 
+#include <algorithm>
 #include <deque>
 #include <memory>
 #include <unordered_set>
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/public/session.h"
 
@@ -189,6 +191,71 @@ Status ShapeRefiner::InferShapesForFunction(
 }
 
 Status ShapeRefiner::AddNode(const Node* node) {
+  std::unique_ptr<ExtendedInferenceContext> ec;
+  TF_RETURN_IF_ERROR(InferNode(node, &ec));
+  // Store the resulting context object in the map.
+  node_to_context_[node].swap(ec);
+  return Status::OK();
+}
+
+Status ShapeRefiner::AddNodes(
+    gtl::ArraySlice<const Node*> nodes, thread::ThreadPool* pool,
+    const std::function<Status(const Node*)>& added_fn) {
+  // The level of a node is one more than the highest level of its inputs among
+  // 'nodes', or 0 if it has none.
+  gtl::FlatMap<const Node*, int> node_levels;
+  std::vector<std::vector<const Node*>> levels;
+  for (const Node* node : nodes) {
+    int level = 0;
+    for (const Edge* e : node->in_edges()) {
+      if (e->IsControlEdge()) continue;
+      auto it = node_levels.find(e->src());
+      if (it != node_levels.end()) level = std::max(level, it->second + 1);
+    }
+    node_levels[node] = level;
+    if (level == static_cast<int>(levels.size())) levels.emplace_back();
+    levels[level].push_back(node);
+  }
+
+  for (const std::vector<const Node*>& level : levels) {
+    std::vector<std::unique_ptr<ExtendedInferenceContext>> contexts(
+        level.size());
+    std::vector<Status> statuses(level.size());
+    auto infer_nodes = [this, &level, &contexts, &statuses](int64 start,
+                                                            int64 limit) {
+      for (int64 i = start; i < limit; ++i) {
+        statuses[i] = InferNode(level[i], &contexts[i]);
+      }
+    };
+    // Function shape inference adds the nodes of the function bodies to this
+    // refiner, so it cannot run concurrently.
+    if (pool != nullptr && function_library_ == nullptr && level.size() > 1) {
+      // Running a shape function takes roughly a few microseconds.
+      pool->ParallelFor(level.size(), /*cost_per_unit=*/10000, infer_nodes);
+    } else {
+      infer_nodes(0, level.size());
+    }
+
+    Status status;
+    for (int i = 0; i < level.size(); ++i) {
+      if (statuses[i].ok()) {
+        node_to_context_[level[i]].swap(contexts[i]);
+      } else {
+        status.Update(statuses[i]);
+      }
+    }
+    TF_RETURN_IF_ERROR(status);
+    if (added_fn) {
+      for (const Node* node : level) {
+        TF_RETURN_IF_ERROR(added_fn(node));
+      }
+    }
+  }
+  return Status::OK();
+}
+
+Status ShapeRefiner::InferNode(const Node* node,
+                               std::unique_ptr<ExtendedInferenceContext>* ec) {
   // Create the inference context for this node with the existing input shapes.
   std::unique_ptr<InferenceContext> ic(new InferenceContext(
       graph_def_version_, node->def(), node->op_def(),
@@ -238,16 +305,10 @@ Status ShapeRefiner::AddNode(const Node* node) {
         "', did you forget to define it?");
   }
 
-  std::unique_ptr<ExtendedInferenceContext> ec(
-      new ExtendedInferenceContext(std::move(ic), node));
+  ec->reset(new ExtendedInferenceContext(std::move(ic), node));
 
   // Run the shape inference function, and return if there was an error.
-  TF_RETURN_IF_ERROR(RunShapeFn(node, op_reg_data, ec.get()));
-
-  // Store the resulting context object in the map.
-  node_to_context_[node].swap(ec);
-
-  return Status::OK();
+  return RunShapeFn(node, op_reg_data, ec->get());
 }
 
 Status ShapeRefiner::SetShape(const Node* node, int output_port,
@@ -683,8 +744,11 @@ Status ShapeRefiner::RunShapeFn(const Node* node,
 
         Tensor result;
         bool evaluated = false;
-        TF_RETURN_IF_ERROR(
-            EvaluateConstantTensorForEdge(node, i, &evaluated, &result));
+        {
+          mutex_lock l(mu_);
+          TF_RETURN_IF_ERROR(
+              EvaluateConstantTensorForEdge(node, i, &evaluated, &result));
+        }
         if (evaluated) {
           real_tensors[i] = result;
           input_tensors[i] = &real_tensors[i];
@@ -700,7 +764,10 @@ Status ShapeRefiner::RunShapeFn(const Node* node,
           input_tensors_as_shapes.resize(i + 1);
         }
         ShapeHandle s;
-        TF_RETURN_IF_ERROR(ConstantPartialShape(c, node, i, &s));
+        {
+          mutex_lock l(mu_);
+          TF_RETURN_IF_ERROR(ConstantPartialShape(c, node, i, &s));
+        }
         input_tensors_as_shapes[i] = s;
         rerun_shape_fn = true;
       }
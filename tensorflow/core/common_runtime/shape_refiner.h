@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SHAPE_REFINER_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_SHAPE_REFINER_H_
 
+#include <functional>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/graph_runner.h"
@@ -22,7 +23,10 @@ limitations under the License.
 #include "tensorflow/core/framework/shape_inference.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -90,6 +94,21 @@ class ShapeRefiner {
   //  - The shape inference function returns an error.
   Status AddNode(const Node* node);
 
+  // Adds 'nodes', which must be in topological order, like successive calls to
+  // AddNode() would. The nodes are added level by level: the nodes of a level
+  // only have inputs among the nodes of the previous levels, so their shape
+  // functions run concurrently on 'pool', unless it is null or function shape
+  // inference is enabled.
+  //
+  // If set, 'added_fn' is called on each node once its level is added, in the
+  // order of 'nodes' and before the next level is added. It may, e.g., refine
+  // the shapes of the node with SetShape().
+  //
+  // Returns the first error of the first level which has one. The nodes of
+  // that level which did not fail, and of the previous levels, remain added.
+  Status AddNodes(gtl::ArraySlice<const Node*> nodes, thread::ThreadPool* pool,
+                  const std::function<Status(const Node*)>& added_fn = nullptr);
+
   // Sets 'node's 'output_port' output to have shape 'shape'.
   //
   // Returns an error if 'node' was not previously added to this
@@ -225,6 +244,12 @@ class ShapeRefiner {
                                   shape_inference::InferenceContext* ctx,
                                   shape_inference::ShapeHandle* result);
 
+  // Creates the ExtendedInferenceContext of 'node' and runs its shape
+  // function, without adding it. Only reads node_to_context_, so it can run
+  // concurrently for several nodes.
+  Status InferNode(const Node* node,
+                   std::unique_ptr<ExtendedInferenceContext>* ec);
+
   Status RunShapeFn(const Node* node, const OpRegistrationData* op_reg_data,
                     ExtendedInferenceContext* ec);
 
@@ -235,6 +260,10 @@ class ShapeRefiner {
   // deleted after the tensors.
   GraphRunner graph_runner_;
 
+  // Serializes the constant evaluation of the nodes added concurrently by
+  // AddNodes(), which uses graph_runner_ and const_tensor_map_.
+  mutex mu_;
+
   // Stores a map from a node to its ExtendedInferenceContext.
   std::unordered_map<const Node*, std::unique_ptr<ExtendedInferenceContext>>
       node_to_context_;
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/public/version.h"
@@ -166,6 +167,62 @@ TEST_F(ShapeRefinerTest, BadShapes) {
                                 "Dimensions must be equal, but are 1 and 2"));
 }
 
+TEST_F(ShapeRefinerTest, AddNodes) {
+  Scope root = Scope::NewRootScope();
+  auto a = ops::Const(root, {{1.0f}, {2.0f}});
+  auto b = ops::Const(root, {{1.0f, 2.0f}});
+  auto mm = ops::MatMul(root, a, b);
+  // The shape functions of the reshapes evaluate their constant shape input.
+  auto shape1 = ops::Const(root, {4});
+  auto shape2 = ops::Const(root, {1, 4});
+  auto reshape1 = ops::Reshape(root, mm, shape1);
+  auto reshape2 = ops::Reshape(root, mm, shape2);
+
+  ShapeRefiner m(TF_GRAPH_DEF_VERSION, OpRegistry::Global());
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  std::vector<const Node*> added;
+  TF_ASSERT_OK(m.AddNodes(
+      {a.node(), b.node(), shape1.node(), shape2.node(), mm.node(),
+       reshape1.node(), reshape2.node()},
+      &pool, [&added](const Node* node) {
+        added.push_back(node);
+        return Status::OK();
+      }));
+
+  EXPECT_SHAPE("[2,1]", m, a, 0);
+  EXPECT_SHAPE("[1,2]", m, b, 0);
+  EXPECT_SHAPE("[2,2]", m, mm, 0);
+  EXPECT_SHAPE("[4]", m, reshape1, 0);
+  EXPECT_SHAPE("[1,4]", m, reshape2, 0);
+  // The nodes are added level by level.
+  EXPECT_EQ(added,
+            std::vector<const Node*>({a.node(), b.node(), shape1.node(),
+                                      shape2.node(), mm.node(), reshape1.node(),
+                                      reshape2.node()}));
+}
+
+TEST_F(ShapeRefinerTest, AddNodesBadShapes) {
+  Scope root = Scope::NewRootScope();
+  auto a = ops::Const(root, {{1.0f}, {2.0f}});
+  auto b = ops::Const(root, {{1.0f}, {2.0f}});
+  auto mm = ops::MatMul(root, a, b);
+  auto c = ops::Const(root, 1.0f);
+  auto add = ops::Add(root, mm, c);
+
+  ShapeRefiner m(TF_GRAPH_DEF_VERSION, OpRegistry::Global());
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  Status s = m.AddNodes({a.node(), b.node(), mm.node(), c.node(), add.node()},
+                        &pool);
+  ASSERT_FALSE(s.ok());
+  ASSERT_TRUE(absl::StrContains(s.error_message(),
+                                "Dimensions must be equal, but are 1 and 2"));
+  // The nodes of the levels up to the failing one remain added.
+  EXPECT_NE(m.GetContext(a.node()), nullptr);
+  EXPECT_NE(m.GetContext(c.node()), nullptr);
+  EXPECT_EQ(m.GetContext(mm.node()), nullptr);
+  EXPECT_EQ(m.GetContext(add.node()), nullptr);
+}
+
 TEST_F(ShapeRefinerTest, SetShape) {
   ShapeRefiner m(TF_GRAPH_DEF_VERSION, OpRegistry::Global());
 
@@ -0,0 +1,272 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_plan_executor.h"
+
+#include <unordered_map>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+class StaticPlanExecutorImpl : public Executor {
+ public:
+  explicit StaticPlanExecutorImpl(const LocalExecutorParams& params)
+      : params_(params) {}
+
+  ~StaticPlanExecutorImpl() override {
+    for (const KernelState& kernel_state : kernels_) {
+      if (kernel_state.kernel != nullptr) {
+        params_.delete_kernel(kernel_state.kernel);
+      }
+    }
+  }
+
+  Status Initialize(const Graph& graph);
+
+  void RunAsync(const Args& args, DoneCallback done) override {
+    done(RunSync(args));
+  }
+
+ private:
+  // Static information about a kernel in the plan.
+  struct KernelState {
+    OpKernel* kernel = nullptr;
+    // The inputs of all the kernels are stored contiguously, in plan order;
+    // the inputs of this kernel start at this index.
+    int input_start_index = 0;
+    int num_inputs = 0;
+    int num_outputs = 0;
+    // For each output, the input slots (in the contiguous input array) of
+    // its consumers.
+    std::vector<gtl::InlinedVector<int, 2>> output_locations;
+    // The allocator attributes of every output.
+    std::vector<AllocatorAttributes> output_alloc_attrs;
+  };
+
+  Status RunSync(const Args& args) const;
+
+  const LocalExecutorParams params_;
+
+  // The kernels, in a topological order of the graph.
+  std::vector<KernelState> kernels_;
+  int total_num_inputs_ = 0;
+
+  // The allocator attributes of every input slot, i.e. those of the output
+  // feeding the slot.
+  std::vector<AllocatorAttributes> input_alloc_attrs_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StaticPlanExecutorImpl);
+};
+
+Status StaticPlanExecutorImpl::Initialize(const Graph& graph) {
+  std::vector<Node*> ordered_nodes;
+  GetReversePostOrder(graph, &ordered_nodes);
+
+  // Check that the plan can run every node before creating any kernel.
+  for (const Node* n : ordered_nodes) {
+    if (!n->IsOp()) continue;
+    if (n->IsControlFlow()) {
+      return errors::Unimplemented(
+          "The static plan executor does not support control flow: ",
+          FormatNodeForError(*n));
+    }
+    for (DataType dt : n->output_types()) {
+      if (IsRefType(dt)) {
+        return errors::Unimplemented(
+            "The static plan executor does not support reference-typed "
+            "edges: ",
+            FormatNodeForError(*n));
+      }
+    }
+  }
+
+  std::unordered_map<const Node*, int> node_to_index;
+  kernels_.reserve(ordered_nodes.size());
+  int next_input_index = 0;
+  for (const Node* n : ordered_nodes) {
+    if (!n->IsOp()) continue;
+    node_to_index[n] = kernels_.size();
+    kernels_.emplace_back();
+    KernelState& kernel_state = kernels_.back();
+    TF_RETURN_IF_ERROR(params_.create_kernel(n->def(), &kernel_state.kernel));
+    if (kernel_state.kernel->AsAsync() != nullptr) {
+      return errors::Unimplemented(
+          "The static plan executor does not support asynchronous kernels: ",
+          FormatNodeForError(*n));
+    }
+    kernel_state.input_start_index = next_input_index;
+    kernel_state.num_inputs = n->num_inputs();
+    kernel_state.num_outputs = n->num_outputs();
+    kernel_state.output_locations.resize(kernel_state.num_outputs);
+    kernel_state.output_alloc_attrs.resize(kernel_state.num_outputs);
+    const MemoryTypeVector& output_memory_types =
+        kernel_state.kernel->output_memory_types();
+    for (int i = 0; i < kernel_state.num_outputs; ++i) {
+      if (output_memory_types[i] == HOST_MEMORY) {
+        kernel_state.output_alloc_attrs[i].set_on_host(true);
+      }
+    }
+    next_input_index += kernel_state.num_inputs;
+  }
+  total_num_inputs_ = next_input_index;
+  input_alloc_attrs_.resize(total_num_inputs_);
+
+  for (const auto& node_and_index : node_to_index) {
+    const Node* n = node_and_index.first;
+    KernelState& kernel_state = kernels_[node_and_index.second];
+    for (const Edge* e : n->out_edges()) {
+      if (e->IsControlEdge()) continue;
+      auto dst = node_to_index.find(e->dst());
+      if (dst == node_to_index.end()) continue;
+      const int location =
+          kernels_[dst->second].input_start_index + e->dst_input();
+      kernel_state.output_locations[e->src_output()].push_back(location);
+      input_alloc_attrs_[location] =
+          kernel_state.output_alloc_attrs[e->src_output()];
+    }
+  }
+  return Status::OK();
+}
+
+Status StaticPlanExecutorImpl::RunSync(const Args& args) const {
+  // The inputs of every kernel, stored contiguously in plan order. Each input
+  // slot is written exactly once, by its producer, before its consumer runs.
+  std::vector<Tensor> input_tensors(total_num_inputs_);
+
+  OpKernelContext::Params params;
+  params.step_id = args.step_id;
+  Device* device = params_.device;
+  params.device = device;
+  params.rendezvous = args.rendezvous;
+  params.create_rendezvous = &params_.rendezvous_factory;
+  params.session_state = args.session_state;
+  params.session_handle = args.session_handle;
+  params.session_metadata = params_.session_metadata;
+  params.tensor_store = args.tensor_store;
+  params.cancellation_manager = args.cancellation_manager;
+  params.call_frame = args.call_frame;
+  params.function_library = params_.function_library;
+  params.resource_manager = device->resource_manager();
+  params.step_container = args.step_container;
+  params.step_allocator = args.step_allocator;
+  params.collective_executor = args.collective_executor;
+  Args::Runner runner = args.runner;
+  params.runner = &runner;
+  params.stats_collector = args.stats_collector;
+  params.frame_iter = FrameAndIter(0, 0);
+
+  DeviceContext* device_context = nullptr;
+  TF_RETURN_IF_ERROR(device->TryGetDeviceContext(&device_context));
+  core::ScopedUnref unref_device_context(device_context);
+  params.op_device_context = device_context;
+
+  gtl::InlinedVector<TensorValue, 4> inputs;
+  gtl::InlinedVector<AllocatorAttributes, 4> input_alloc_attrs;
+  params.inputs = &inputs;
+  params.input_alloc_attrs = &input_alloc_attrs;
+
+  for (const KernelState& kernel_state : kernels_) {
+    if (args.cancellation_manager &&
+        args.cancellation_manager->IsCancelled()) {
+      return errors::Cancelled("Step was cancelled");
+    }
+    const int start = kernel_state.input_start_index;
+    inputs.clear();
+    input_alloc_attrs.clear();
+    for (int i = 0; i < kernel_state.num_inputs; ++i) {
+      inputs.emplace_back(&input_tensors[start + i]);
+      input_alloc_attrs.push_back(input_alloc_attrs_[start + i]);
+    }
+    params.op_kernel = kernel_state.kernel;
+    params.output_attr_array = kernel_state.output_alloc_attrs.data();
+
+    OpKernelContext ctx(&params, kernel_state.num_outputs);
+    device->Compute(kernel_state.kernel, &ctx);
+
+    // The inputs of this kernel have no other consumer.
+    for (int i = 0; i < kernel_state.num_inputs; ++i) {
+      input_tensors[start + i] = Tensor();
+    }
+    TF_RETURN_IF_ERROR(ctx.status());
+
+    for (int i = 0; i < kernel_state.num_outputs; ++i) {
+      TensorValue val = ctx.release_output(i);
+      const auto& locations = kernel_state.output_locations[i];
+      if (val.tensor == nullptr) {
+        if (locations.empty()) continue;
+        return errors::Internal("Missing ", i, "-th output from ",
+                                FormatNodeDefForError(
+                                    kernel_state.kernel->def()));
+      }
+      for (int location : locations) {
+        input_tensors[location] = *val.tensor;
+      }
+      delete val.tensor;
+    }
+  }
+  return args.sync_on_finish ? device->Sync() : Status::OK();
+}
+
+}  // namespace
+
+Status NewStaticPlanExecutor(const LocalExecutorParams& params,
+                             const Graph& graph, Executor** executor) {
+  auto impl = absl::make_unique<StaticPlanExecutorImpl>(params);
+  TF_RETURN_IF_ERROR(impl->Initialize(graph));
+  *executor = impl.release();
+  return Status::OK();
+}
+
+namespace {
+
+class StaticPlanExecutorRegistrar {
+ public:
+  StaticPlanExecutorRegistrar() {
+    ExecutorFactory::Register("STATIC_PLAN", new Factory);
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      Executor* ret = nullptr;
+      Status s = NewStaticPlanExecutor(params, graph, &ret);
+      if (errors::IsUnimplemented(s)) {
+        VLOG(1) << "Falling back to the default executor: " << s;
+        TF_RETURN_IF_ERROR(NewLocalExecutor(params, graph, &ret));
+      } else {
+        TF_RETURN_IF_ERROR(s);
+      }
+      out_executor->reset(ret);
+      return Status::OK();
+    }
+  };
+};
+static StaticPlanExecutorRegistrar registrar;
+
+}  // namespace
+}  // namespace tensorflow
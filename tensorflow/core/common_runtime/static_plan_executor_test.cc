@@ -0,0 +1,166 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_plan_executor.h"
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
+#include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/versions.pb.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+#define ALICE "/job:j/replica:0/task:0/cpu:0"
+#define BOB "/job:j/replica:0/task:0/device:GPU:0"
+
+class StaticPlanExecutorTest : public ::testing::Test {
+ protected:
+  StaticPlanExecutorTest()
+      : device_(DeviceFactory::NewDevice("CPU", {},
+                                         "/job:localhost/replica:0/task:0")) {}
+
+  ~StaticPlanExecutorTest() override {
+    if (rendez_ != nullptr) CHECK(rendez_->Unref());
+  }
+
+  LocalExecutorParams NewParams(int version) {
+    LocalExecutorParams params;
+    params.device = device_.get();
+    params.create_kernel = [this, version](const NodeDef& ndef,
+                                           OpKernel** kernel) {
+      return CreateNonCachedKernel(device_.get(), nullptr, ndef, version,
+                                   kernel);
+    };
+    params.delete_kernel = [](OpKernel* kernel) {
+      DeleteNonCachedKernel(kernel);
+    };
+    rendez_ = NewLocalRendezvous();
+    params.rendezvous_factory = [this](const int64, const DeviceMgr*,
+                                       Rendezvous** r) {
+      *r = rendez_;
+      rendez_->Ref();
+      return Status::OK();
+    };
+    return params;
+  }
+
+  Rendezvous::ParsedKey Key(const string& sender, const string& receiver,
+                            const string& name) {
+    Rendezvous::ParsedKey result;
+    TF_CHECK_OK(Rendezvous::ParseKey(
+        Rendezvous::CreateKey(sender, 1, receiver, name, FrameAndIter(0, 0)),
+        &result));
+    return result;
+  }
+
+  Status Run(Executor* executor) {
+    Executor::Args args;
+    args.rendezvous = rendez_;
+    args.runner = [](std::function<void()> fn) { fn(); };
+    return executor->Run(args);
+  }
+
+  float Fetch(const string& name) {
+    Tensor out;
+    bool is_dead = false;
+    TF_CHECK_OK(rendez_->Recv(Key(BOB, ALICE, name), Rendezvous::Args(), &out,
+                              &is_dead));
+    return out.scalar<float>()();
+  }
+
+  std::unique_ptr<Device> device_;
+  Rendezvous* rendez_ = nullptr;
+};
+
+TEST_F(StaticPlanExecutorTest, SimpleAdd) {
+  // c = (a + b) + (a + b), with 'a + b' consumed twice.
+  Graph g(OpRegistry::Global());
+  Node* a = test::graph::Constant(&g, test::AsScalar<float>(1.0));
+  Node* b = test::graph::Constant(&g, test::AsScalar<float>(2.0));
+  Node* sum = test::graph::Add(&g, a, b);
+  Node* c = test::graph::Add(&g, sum, sum);
+  test::graph::Send(&g, c, "c", BOB, 1, ALICE);
+  test::graph::Send(&g, sum, "sum", BOB, 1, ALICE);
+
+  Executor* executor = nullptr;
+  TF_ASSERT_OK(NewStaticPlanExecutor(NewParams(g.versions().producer()), g,
+                                     &executor));
+  std::unique_ptr<Executor> executor_owner(executor);
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(Run(executor));
+    EXPECT_EQ(3.0, Fetch("sum"));
+    EXPECT_EQ(6.0, Fetch("c"));
+  }
+}
+
+TEST_F(StaticPlanExecutorTest, KernelError) {
+  Graph g(OpRegistry::Global());
+  Node* a = test::graph::Constant(&g, test::AsTensor<float>({1.0, 2.0}));
+  Node* b = test::graph::Constant(&g, test::AsTensor<float>({1.0, 2.0, 3.0}));
+  test::graph::Send(&g, test::graph::Add(&g, a, b), "c", BOB, 1, ALICE);
+
+  Executor* executor = nullptr;
+  TF_ASSERT_OK(NewStaticPlanExecutor(NewParams(g.versions().producer()), g,
+                                     &executor));
+  std::unique_ptr<Executor> executor_owner(executor);
+  EXPECT_TRUE(errors::IsInvalidArgument(Run(executor)));
+}
+
+TEST_F(StaticPlanExecutorTest, UnsupportedGraphs) {
+  {
+    // Recv is an asynchronous kernel.
+    Graph g(OpRegistry::Global());
+    Node* a = test::graph::Recv(&g, "a", "float", ALICE, 1, BOB);
+    test::graph::Send(&g, test::graph::Identity(&g, a), "b", BOB, 1, ALICE);
+    Executor* executor = nullptr;
+    EXPECT_TRUE(errors::IsUnimplemented(NewStaticPlanExecutor(
+        NewParams(g.versions().producer()), g, &executor)));
+    rendez_->Unref();
+    rendez_ = nullptr;
+  }
+  {
+    Graph g(OpRegistry::Global());
+    Node* a = test::graph::Constant(&g, test::AsScalar<float>(1.0));
+    Node* pred = test::graph::Constant(&g, test::AsScalar<bool>(true));
+    test::graph::Send(&g, test::graph::Switch(&g, a, pred), "b", BOB, 1,
+                      ALICE);
+    Executor* executor = nullptr;
+    EXPECT_TRUE(errors::IsUnimplemented(NewStaticPlanExecutor(
+        NewParams(g.versions().producer()), g, &executor)));
+  }
+}
+
+TEST_F(StaticPlanExecutorTest, FactoryFallsBackToDefaultExecutor) {
+  Graph g(OpRegistry::Global());
+  Node* a = test::graph::Recv(&g, "a", "float", ALICE, 1, BOB);
+  test::graph::Send(&g, test::graph::Add(&g, a, a), "b", BOB, 1, ALICE);
+
+  std::unique_ptr<Executor> executor;
+  TF_ASSERT_OK(NewExecutor("STATIC_PLAN", NewParams(g.versions().producer()),
+                           g, &executor));
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, BOB, "a"), Rendezvous::Args(),
+                             test::AsScalar<float>(2.0), false));
+  TF_ASSERT_OK(Run(executor.get()));
+  EXPECT_EQ(4.0, Fetch("b"));
+}
+
+}  // namespace
+}  // namespace tensorflow
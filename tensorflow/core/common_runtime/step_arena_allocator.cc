@@ -0,0 +1,142 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+struct StepArenaAllocator::Block {
+  char* memory;
+  // One reference for every live allocation carved from the block, plus one
+  // while the arena may carve new allocations from it.
+  std::atomic<int64> refs{1};
+};
+
+namespace {
+
+char* AlignUp(char* ptr, size_t alignment) {
+  const uintptr_t value = reinterpret_cast<uintptr_t>(ptr);
+  return reinterpret_cast<char*>((value + alignment - 1) & ~(alignment - 1));
+}
+
+}  // namespace
+
+StepArenaAllocator::StepArenaAllocator(Allocator* base, size_t block_size)
+    : base_(base), block_size_(block_size) {
+  CHECK(base_ != nullptr);
+}
+
+StepArenaAllocator::~StepArenaAllocator() {
+  DCHECK_EQ(live_allocations_.load(), 0);
+  Reset();
+}
+
+string StepArenaAllocator::Name() {
+  return strings::StrCat("step_arena_", base_->Name());
+}
+
+void* StepArenaAllocator::AllocateFromBase(size_t alignment,
+                                           size_t num_bytes) {
+  // Reserve a whole alignment unit in front of the allocation for the header.
+  const size_t offset = std::max(alignment, sizeof(Header));
+  char* base_ptr =
+      static_cast<char*>(base_->AllocateRaw(alignment, num_bytes + offset));
+  if (base_ptr == nullptr) return nullptr;
+  char* ptr = AlignUp(base_ptr + sizeof(Header), alignment);
+  Header* header = reinterpret_cast<Header*>(ptr) - 1;
+  header->block = nullptr;
+  header->base_ptr = base_ptr;
+  return ptr;
+}
+
+void* StepArenaAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  alignment = std::max(alignment, alignof(Header));
+  void* result = nullptr;
+  if (num_bytes <= block_size_ / 4) {
+    mutex_lock l(mu_);
+    if (!reset_) {
+      char* ptr = nullptr;
+      if (current_ != nullptr) {
+        ptr = AlignUp(next_ + sizeof(Header), alignment);
+      }
+      if (ptr == nullptr || ptr + num_bytes > limit_) {
+        // Start a new block. The previous one is returned to the base
+        // allocator once its allocations die.
+        char* memory = static_cast<char*>(
+            base_->AllocateRaw(Allocator::kAllocatorAlignment, block_size_));
+        if (memory == nullptr) return nullptr;
+        if (current_ != nullptr) UnrefBlock(current_);
+        current_ = new Block;
+        current_->memory = memory;
+        limit_ = memory + block_size_;
+        ptr = AlignUp(memory + sizeof(Header), alignment);
+      }
+      current_->refs.fetch_add(1, std::memory_order_relaxed);
+      Header* header = reinterpret_cast<Header*>(ptr) - 1;
+      header->block = current_;
+      header->base_ptr = nullptr;
+      next_ = ptr + num_bytes;
+      result = ptr;
+    }
+  }
+  if (result == nullptr) {
+    result = AllocateFromBase(alignment, num_bytes);
+    if (result == nullptr) return nullptr;
+  }
+  live_allocations_.fetch_add(1, std::memory_order_relaxed);
+  Ref();
+  return result;
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  Header* header = reinterpret_cast<Header*>(ptr) - 1;
+  if (header->block != nullptr) {
+    UnrefBlock(header->block);
+  } else {
+    base_->DeallocateRaw(header->base_ptr);
+  }
+  live_allocations_.fetch_sub(1, std::memory_order_relaxed);
+  // May delete this allocator.
+  Unref();
+}
+
+void StepArenaAllocator::UnrefBlock(Block* block) {
+  if (block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    base_->DeallocateRaw(block->memory);
+    delete block;
+  }
+}
+
+int64 StepArenaAllocator::Reset() {
+  mutex_lock l(mu_);
+  reset_ = true;
+  if (current_ != nullptr) {
+    UnrefBlock(current_);
+    current_ = nullptr;
+  }
+  next_ = nullptr;
+  limit_ = nullptr;
+  const int64 escaped = live_allocations_.load(std::memory_order_relaxed);
+  VLOG_IF(1, escaped > 0) << escaped << " allocations escaped from " << Name();
+  return escaped;
+}
+
+}  // namespace tensorflow
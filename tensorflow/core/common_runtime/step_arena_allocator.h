@@ -0,0 +1,101 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+
+#include <atomic>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An allocator for the tensors of a single step that are expected to die
+// within the step, e.g. the temporaries of OpKernelContext::allocate_temp().
+//
+// Memory is obtained from the base allocator in large blocks, and requests
+// are served by bumping a pointer in the current block, so the base
+// allocator (and its lock) is only involved once per block. Every step uses
+// its own StepArenaAllocator, so concurrent steps never contend on it.
+//
+// Reset() marks the end of the step: the arena stops serving allocations, and
+// every block is returned to the base allocator as soon as the allocations
+// carved from it have been deallocated. Allocations still alive at that
+// point have escaped the step (e.g. a temporary set as a fetched output);
+// they remain valid, and keep their block alive, until deallocated.
+//
+// The allocator is reference counted: the creator holds one reference and
+// every live allocation holds another, so the allocator outlives all of the
+// tensors it allocated.
+class StepArenaAllocator : public Allocator, public core::RefCounted {
+ public:
+  static constexpr size_t kDefaultBlockSize = 1 << 20;
+
+  // Allocations larger than a quarter of 'block_size' are forwarded to
+  // 'base', which must outlive this allocator.
+  explicit StepArenaAllocator(Allocator* base,
+                              size_t block_size = kDefaultBlockSize);
+
+  string Name() override;
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+
+  // Ends the step. Subsequent allocations are forwarded to the base
+  // allocator. Returns the number of allocations still alive, i.e. the
+  // number of escaped allocations.
+  int64 Reset();
+
+ private:
+  struct Block;
+  // Precedes every allocation returned by AllocateRaw().
+  struct Header {
+    // The block serving the allocation, or nullptr if the allocation was
+    // forwarded to the base allocator.
+    Block* block;
+    // The pointer returned by the base allocator for forwarded allocations.
+    void* base_ptr;
+  };
+
+  ~StepArenaAllocator() override;
+
+  // Returns 'block' to the base allocator once it has no live allocation and
+  // the arena no longer serves allocations from it.
+  void UnrefBlock(Block* block);
+
+  void* AllocateFromBase(size_t alignment, size_t num_bytes);
+
+  Allocator* const base_;
+  const size_t block_size_;
+
+  mutex mu_;
+  bool reset_ GUARDED_BY(mu_) = false;
+  // The block serving allocations, and its unused range [next_, limit_).
+  Block* current_ GUARDED_BY(mu_) = nullptr;
+  char* next_ GUARDED_BY(mu_) = nullptr;
+  char* limit_ GUARDED_BY(mu_) = nullptr;
+
+  std::atomic<int64> live_allocations_{0};
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArenaAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
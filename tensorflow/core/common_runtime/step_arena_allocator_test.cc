@@ -0,0 +1,153 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Counts the live allocations of the CPU allocator made through it.
+class CountingAllocator : public Allocator {
+ public:
+  string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocations_;
+    ++live_allocations_;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    --live_allocations_;
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  int num_allocations() const { return num_allocations_; }
+  int live_allocations() const { return live_allocations_; }
+
+ private:
+  std::atomic<int> num_allocations_{0};
+  std::atomic<int> live_allocations_{0};
+};
+
+TEST(StepArenaAllocatorTest, SmallAllocationsShareBlocks) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = new StepArenaAllocator(&base, 4096);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 8; ++i) {
+    void* ptr = arena->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) %
+                  Allocator::kAllocatorAlignment,
+              0);
+    memset(ptr, i, 100);
+    ptrs.push_back(ptr);
+  }
+  // All eight allocations fit in a single 4KB block.
+  EXPECT_EQ(1, base.num_allocations());
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(i, static_cast<char*>(ptrs[i])[99]);
+    arena->DeallocateRaw(ptrs[i]);
+  }
+  EXPECT_EQ(0, arena->Reset());
+  EXPECT_EQ(0, base.live_allocations());
+  arena->Unref();
+}
+
+TEST(StepArenaAllocatorTest, LargeAllocationsAreForwarded) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = new StepArenaAllocator(&base, 4096);
+  void* ptr = arena->AllocateRaw(Allocator::kAllocatorAlignment, 2048);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(1, base.num_allocations());
+  arena->DeallocateRaw(ptr);
+  EXPECT_EQ(0, base.live_allocations());
+  EXPECT_EQ(0, arena->Reset());
+  arena->Unref();
+}
+
+TEST(StepArenaAllocatorTest, BlocksAreReleasedWhenFull) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = new StepArenaAllocator(&base, 4096);
+  for (int i = 0; i < 100; ++i) {
+    void* ptr = arena->AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+    arena->DeallocateRaw(ptr);
+  }
+  // Only the current block is still held by the arena.
+  EXPECT_GT(base.num_allocations(), 1);
+  EXPECT_EQ(1, base.live_allocations());
+  EXPECT_EQ(0, arena->Reset());
+  EXPECT_EQ(0, base.live_allocations());
+  arena->Unref();
+}
+
+TEST(StepArenaAllocatorTest, EscapedTensorsOutliveTheArena) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = new StepArenaAllocator(&base);
+  Tensor escaped(arena, DT_FLOAT, TensorShape({16}));
+  Tensor large(arena, DT_FLOAT, TensorShape({1 << 20}));
+  {
+    Tensor temp(arena, DT_FLOAT, TensorShape({16}));
+  }
+  escaped.flat<float>().setConstant(1.0f);
+  EXPECT_EQ(2, arena->Reset());
+  arena->Unref();
+
+  // The tensors are still valid, and release their memory when destroyed.
+  EXPECT_EQ(1.0f, escaped.flat<float>()(15));
+  EXPECT_EQ(2, base.live_allocations());
+  escaped = Tensor();
+  large = Tensor();
+  EXPECT_EQ(0, base.live_allocations());
+}
+
+TEST(StepArenaAllocatorTest, AllocationsAfterResetAreForwarded) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = new StepArenaAllocator(&base);
+  arena->Reset();
+  void* ptr = arena->AllocateRaw(Allocator::kAllocatorAlignment, 16);
+  EXPECT_EQ(1, base.live_allocations());
+  arena->DeallocateRaw(ptr);
+  EXPECT_EQ(0, base.live_allocations());
+  arena->Unref();
+}
+
+TEST(StepArenaAllocatorTest, ConcurrentAllocations) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = new StepArenaAllocator(&base, 1 << 16);
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 8);
+    for (int i = 0; i < 8; ++i) {
+      pool.Schedule([arena, i]() {
+        for (int j = 0; j < 1000; ++j) {
+          Tensor t(arena, DT_INT32, TensorShape({j % 64 + 1}));
+          t.flat<int32>().setConstant(i);
+          CHECK_EQ(i, t.flat<int32>()(j % 64));
+        }
+      });
+    }
+  }
+  EXPECT_EQ(0, arena->Reset());
+  arena->Unref();
+  EXPECT_EQ(0, base.live_allocations());
+}
+
+}  // namespace
+}  // namespace tensorflow
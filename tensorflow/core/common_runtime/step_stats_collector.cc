@@ -121,6 +121,12 @@ void NodeExecStatsWrapper::RecordComputeStarted() {
   stats_->set_op_start_rel_micros(now_nanos / EnvTime::kMicrosToNanos -
                                   stats_->all_start_micros());
   stats_->set_op_start_rel_nanos(now_nanos - stats_->all_start_nanos());
+  if (step_stats_collector_->collect_hardware_counters()) {
+    counters_ = ThreadHardwareCounters::Get();
+    if (counters_ != nullptr && !counters_->Read(&counters_start_)) {
+      counters_ = nullptr;
+    }
+  }
 }
 
 void NodeExecStatsWrapper::RecordComputeEnded() {
@@ -130,6 +136,20 @@ void NodeExecStatsWrapper::RecordComputeEnded() {
   stats_->set_op_end_rel_micros(now_nanos / EnvTime::kMicrosToNanos -
                                 stats_->all_start_micros());
   stats_->set_op_end_rel_nanos(now_nanos - stats_->all_start_nanos());
+  // The counters are per thread, so they only measure the kernel if it ended
+  // on the thread that started it.
+  HardwareCounterValues counters_end;
+  if (counters_ != nullptr && counters_ == ThreadHardwareCounters::Get() &&
+      counters_->Read(&counters_end)) {
+    auto* hardware_counters = stats_->mutable_hardware_counters();
+    hardware_counters->set_cpu_cycles(counters_end.cpu_cycles -
+                                      counters_start_.cpu_cycles);
+    hardware_counters->set_instructions(counters_end.instructions -
+                                        counters_start_.instructions);
+    hardware_counters->set_llc_misses(counters_end.llc_misses -
+                                      counters_start_.llc_misses);
+  }
+  counters_ = nullptr;
 }
 
 void NodeExecStatsWrapper::RecordExecutorEnded() {
@@ -156,6 +176,15 @@ void NodeExecStatsWrapper::SetMemory(OpKernelContext* ctx) {
     ms->mutable_persistent_tensor_alloc_ids()->Add(alloc_id);
   }
   ms->set_persistent_memory_size(ctx->persistent_memory_allocated());
+  if (step_stats_collector_->collect_hardware_counters()) {
+    int64 bytes_read = 0;
+    for (int i = 0; i < ctx->num_inputs(); ++i) {
+      if (ctx->has_input(i) && !ctx->input_is_ref(i)) {
+        bytes_read += ctx->input(i).TotalBytes();
+      }
+    }
+    stats_->mutable_hardware_counters()->set_bytes_read(bytes_read);
+  }
 }
 
 void NodeExecStatsWrapper::SetOutput(int slot, const Tensor* tensor) {
@@ -163,6 +192,11 @@ void NodeExecStatsWrapper::SetOutput(int slot, const Tensor* tensor) {
   NodeOutput* node_output = stats_->add_output();
   node_output->set_slot(slot);
   tensor->FillDescription(node_output->mutable_tensor_description());
+  if (step_stats_collector_->collect_hardware_counters()) {
+    auto* hardware_counters = stats_->mutable_hardware_counters();
+    hardware_counters->set_bytes_written(hardware_counters->bytes_written() +
+                                         tensor->TotalBytes());
+  }
 }
 
 void NodeExecStatsWrapper::SetReferencedTensors(
@@ -203,8 +237,11 @@ void NodeExecStatsWrapper::Finalize() {
   allocations_.clear();
 }
 
-StepStatsCollector::StepStatsCollector(StepStats* step_stats)
-    : finalized_(false), step_stats_(step_stats) {}
+StepStatsCollector::StepStatsCollector(StepStats* step_stats,
+                                       bool collect_hardware_counters)
+    : collect_hardware_counters_(collect_hardware_counters),
+      finalized_(false),
+      step_stats_(step_stats) {}
 
 static int ExtractGpuWithStreamAll(string device_name) {
   // Check if the device name matches the ".*gpu:(\\d+)/stream:all$" regexp,
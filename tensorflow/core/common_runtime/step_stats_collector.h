@@ -18,6 +18,7 @@ limitations under the License.
 #include <memory>
 #include <unordered_map>
 #include <vector>
+#include "tensorflow/core/common_runtime/hardware_counters.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tensor_reference.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -131,6 +132,10 @@ class NodeExecStatsWrapper : public NodeExecStatsInterface {
 
   gtl::InlinedVector<std::pair<AllocatorMemoryUsed*, TrackingAllocator*>, 2>
       allocations_;
+  // The hardware counters of the thread that started Compute(), and their
+  // values at that time.
+  ThreadHardwareCounters* counters_ = nullptr;
+  HardwareCounterValues counters_start_;
   std::unique_ptr<NodeExecStats> stats_;
   const NodeDef* const node_;                       // Not owned.
   StepStatsCollector* const step_stats_collector_;  // Not owned.
@@ -162,7 +167,13 @@ class StepStatsCollectorInterface {
 class StepStatsCollector : public StepStatsCollectorInterface {
  public:
   // Does not take ownership of `step_stats`.
-  explicit StepStatsCollector(StepStats* step_stats);
+  //
+  // If `collect_hardware_counters` is true, the hardware performance counters
+  // of the thread running each synchronous kernel are recorded around its
+  // Compute(), when the platform allows it, along with the sizes of the
+  // kernel's inputs and outputs.
+  explicit StepStatsCollector(StepStats* step_stats,
+                              bool collect_hardware_counters = false);
 
   // BuildCostModel builds or updates a CostModel managed by cost_model_manager,
   // using the currently collected DeviceStats associated with the devices in
@@ -190,6 +201,8 @@ class StepStatsCollector : public StepStatsCollectorInterface {
   // swaps the content of StepStats* from constructor with 'ss'.
   void FinalizeAndSwap(StepStats* step_stats);
 
+  bool collect_hardware_counters() const { return collect_hardware_counters_; }
+
  private:
   // TODO(suharshs): Make this configurable if its not possible to find a value
   // that works for all cases.
@@ -200,6 +213,7 @@ class StepStatsCollector : public StepStatsCollectorInterface {
 
   void FinalizeInternal() EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  const bool collect_hardware_counters_;
   mutex mu_;
   bool finalized_ GUARDED_BY(mu_);
   std::unordered_map<string, NodeStatsVector> dev_stats_ GUARDED_BY(mu_);
@@ -0,0 +1,268 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/benchmark_pipelines.h"
+
+#include <memory>
+
+#include "tensorflow/core/example/example.pb.h"
+#include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using FDH = FunctionDefHelper;
+
+constexpr char kRetvalName[] = "dataset";
+
+template <typename T>
+Tensor Scalar(const T& value) {
+  Tensor t(DataTypeToEnum<T>::value, TensorShape({}));
+  t.scalar<T>()() = value;
+  return t;
+}
+
+Status AddConst(const string& name, const Tensor& value,
+                GraphDef* graph_def) {
+  return NodeDefBuilder(name, "Const")
+      .Attr("dtype", value.dtype())
+      .Attr("value", value)
+      .Finalize(graph_def->add_node());
+}
+
+// Adds the `_Retval` node that marks `dataset` as the output of the graph.
+Status AddRetval(const string& dataset, GraphDef* graph_def) {
+  return NodeDefBuilder(kRetvalName, FunctionLibraryDefinition::kRetOp)
+      .Input(dataset, 0, DT_VARIANT)
+      .Attr("T", DT_VARIANT)
+      .Attr("index", 0)
+      .Finalize(graph_def->add_node());
+}
+
+// Adds `TFRecordDataset(filenames)` as the node "records".
+Status AddTFRecordDataset(const std::vector<string>& filenames,
+                          GraphDef* graph_def) {
+  Tensor filenames_tensor(DT_STRING,
+                          TensorShape({static_cast<int64>(filenames.size())}));
+  for (size_t i = 0; i < filenames.size(); ++i) {
+    filenames_tensor.flat<tstring>()(i) = filenames[i];
+  }
+  TF_RETURN_IF_ERROR(AddConst("filenames", filenames_tensor, graph_def));
+  TF_RETURN_IF_ERROR(
+      AddConst("compression_type", Scalar<tstring>(""), graph_def));
+  TF_RETURN_IF_ERROR(
+      AddConst("record_buffer_size", Scalar<int64>(256 << 10), graph_def));
+  return NodeDefBuilder("records", "TFRecordDataset")
+      .Input("filenames", 0, DT_STRING)
+      .Input("compression_type", 0, DT_STRING)
+      .Input("record_buffer_size", 0, DT_INT64)
+      .Finalize(graph_def->add_node());
+}
+
+// Adds the function that parses the records of `WriteSyntheticImageRecords`
+// into an (image, label) pair, and decodes the image if `decode` is true.
+void AddParseFunction(const string& name, bool decode, GraphDef* graph_def) {
+  // Empty defaults make both features required.
+  std::vector<FDH::Node> nodes = {
+      {{"image_default"},
+       "Const",
+       {},
+       {{"dtype", DT_STRING}, {"value", Tensor(DT_STRING, TensorShape({0}))}}},
+      {{"label_default"},
+       "Const",
+       {},
+       {{"dtype", DT_INT64}, {"value", Tensor(DT_INT64, TensorShape({0}))}}},
+      {{"parse"},
+       "ParseSingleExample",
+       {"record", "image_default:output:0", "label_default:output:0"},
+       {{"num_sparse", 0},
+        {"sparse_keys", gtl::ArraySlice<string>()},
+        {"dense_keys", std::vector<string>({"image", "label"})},
+        {"sparse_types", DataTypeSlice()},
+        {"Tdense", DataTypeSlice({DT_STRING, DT_INT64})},
+        {"dense_shapes",
+         std::vector<TensorShape>({TensorShape({}), TensorShape({})})}}}};
+  string image = "parse:dense_values:0";
+  if (decode) {
+    nodes.push_back({{"decode"},
+                     "DecodeJpeg",
+                     {"parse:dense_values:0"},
+                     {{"channels", 3}}});
+    image = "decode:image:0";
+  }
+  *graph_def->mutable_library()->add_function() = FDH::Create(
+      name, {"record: string"},
+      {decode ? "image: uint8" : "image: string", "label: int64"}, {}, nodes,
+      {{"image", image}, {"label", "parse:dense_values:1"}});
+}
+
+// Adds `input.map(function, num_parallel_calls).batch(batch_size,
+// drop_remainder=True).prefetch(1)`, where `function` produces elements of
+// the given types and shapes.
+Status AddMapBatchPrefetch(const string& input, const string& function,
+                           int num_parallel_calls, int64 batch_size,
+                           const DataTypeVector& types,
+                           const std::vector<PartialTensorShape>& shapes,
+                           GraphDef* graph_def) {
+  std::vector<PartialTensorShape> batched_shapes;
+  for (const PartialTensorShape& shape : shapes) {
+    batched_shapes.push_back(
+        PartialTensorShape({batch_size}).Concatenate(shape));
+  }
+  NameAttrList f;
+  f.set_name(function);
+  TF_RETURN_IF_ERROR(
+      AddConst("num_parallel_calls", Scalar<int32>(num_parallel_calls),
+               graph_def));
+  TF_RETURN_IF_ERROR(NodeDefBuilder("map", "ParallelMapDataset")
+                         .Input(input, 0, DT_VARIANT)
+                         .Input(gtl::ArraySlice<NodeDefBuilder::NodeOut>())
+                         .Input("num_parallel_calls", 0, DT_INT32)
+                         .Attr("f", f)
+                         .Attr("output_types", types)
+                         .Attr("output_shapes", shapes)
+                         .Finalize(graph_def->add_node()));
+  TF_RETURN_IF_ERROR(
+      AddConst("batch_size", Scalar<int64>(batch_size), graph_def));
+  TF_RETURN_IF_ERROR(
+      AddConst("drop_remainder", Scalar<bool>(true), graph_def));
+  TF_RETURN_IF_ERROR(NodeDefBuilder("batch", "BatchDatasetV2")
+                         .Input("map", 0, DT_VARIANT)
+                         .Input("batch_size", 0, DT_INT64)
+                         .Input("drop_remainder", 0, DT_BOOL)
+                         .Attr("output_types", types)
+                         .Attr("output_shapes", batched_shapes)
+                         .Finalize(graph_def->add_node()));
+  TF_RETURN_IF_ERROR(
+      AddConst("prefetch_buffer_size", Scalar<int64>(1), graph_def));
+  TF_RETURN_IF_ERROR(NodeDefBuilder("prefetch", "PrefetchDataset")
+                         .Input("batch", 0, DT_VARIANT)
+                         .Input("prefetch_buffer_size", 0, DT_INT64)
+                         .Attr("output_types", types)
+                         .Attr("output_shapes", batched_shapes)
+                         .Finalize(graph_def->add_node()));
+  return AddRetval("prefetch", graph_def);
+}
+
+}  // namespace
+
+Status WriteSyntheticImageRecords(Env* env, const string& filename,
+                                  int64 num_records, int height, int width) {
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(filename, &file));
+  io::RecordWriter writer(file.get());
+  random::PhiloxRandom philox(/*seed=*/42);
+  random::SimplePhilox rnd(&philox);
+  std::vector<uint8> pixels(static_cast<size_t>(height) * width * 3);
+  jpeg::CompressFlags flags;
+  flags.format = jpeg::FORMAT_RGB;
+  for (int64 i = 0; i < num_records; ++i) {
+    for (uint8& pixel : pixels) {
+      pixel = static_cast<uint8>(rnd.Uniform(256));
+    }
+    tstring image;
+    if (!jpeg::Compress(pixels.data(), width, height, flags, &image)) {
+      return errors::Internal("Failed to compress a ", height, "x", width,
+                              " image");
+    }
+    Example example;
+    auto& features = *example.mutable_features()->mutable_feature();
+    features["image"].mutable_bytes_list()->add_value(image.data(),
+                                                      image.size());
+    features["label"].mutable_int64_list()->add_value(i % 1000);
+    TF_RETURN_IF_ERROR(writer.WriteRecord(example.SerializeAsString()));
+  }
+  TF_RETURN_IF_ERROR(writer.Close());
+  return file->Close();
+}
+
+Status ShuffleBatchPipeline(int64 num_elements, int64 buffer_size,
+                            int64 batch_size, GraphDef* graph_def) {
+  graph_def->Clear();
+  const DataTypeVector types = {DT_INT64};
+  const std::vector<PartialTensorShape> shapes = {PartialTensorShape({})};
+  const std::vector<PartialTensorShape> batched_shapes = {
+      PartialTensorShape({batch_size})};
+  TF_RETURN_IF_ERROR(AddConst("start", Scalar<int64>(0), graph_def));
+  TF_RETURN_IF_ERROR(AddConst("stop", Scalar<int64>(num_elements), graph_def));
+  TF_RETURN_IF_ERROR(AddConst("step", Scalar<int64>(1), graph_def));
+  TF_RETURN_IF_ERROR(NodeDefBuilder("range", "RangeDataset")
+                         .Input("start", 0, DT_INT64)
+                         .Input("stop", 0, DT_INT64)
+                         .Input("step", 0, DT_INT64)
+                         .Attr("output_types", types)
+                         .Attr("output_shapes", shapes)
+                         .Finalize(graph_def->add_node()));
+  TF_RETURN_IF_ERROR(
+      AddConst("shuffle_buffer_size", Scalar<int64>(buffer_size), graph_def));
+  TF_RETURN_IF_ERROR(AddConst("seed", Scalar<int64>(0), graph_def));
+  TF_RETURN_IF_ERROR(AddConst("seed2", Scalar<int64>(0), graph_def));
+  TF_RETURN_IF_ERROR(NodeDefBuilder("shuffle", "ShuffleDataset")
+                         .Input("range", 0, DT_VARIANT)
+                         .Input("shuffle_buffer_size", 0, DT_INT64)
+                         .Input("seed", 0, DT_INT64)
+                         .Input("seed2", 0, DT_INT64)
+                         .Attr("output_types", types)
+                         .Attr("output_shapes", shapes)
+                         .Finalize(graph_def->add_node()));
+  TF_RETURN_IF_ERROR(
+      AddConst("batch_size", Scalar<int64>(batch_size), graph_def));
+  TF_RETURN_IF_ERROR(
+      AddConst("drop_remainder", Scalar<bool>(true), graph_def));
+  TF_RETURN_IF_ERROR(NodeDefBuilder("batch", "BatchDatasetV2")
+                         .Input("shuffle", 0, DT_VARIANT)
+                         .Input("batch_size", 0, DT_INT64)
+                         .Input("drop_remainder", 0, DT_BOOL)
+                         .Attr("output_types", types)
+                         .Attr("output_shapes", batched_shapes)
+                         .Finalize(graph_def->add_node()));
+  return AddRetval("batch", graph_def);
+}
+
+Status TFRecordParsePipeline(const std::vector<string>& filenames,
+                             int64 batch_size, int num_parallel_calls,
+                             GraphDef* graph_def) {
+  graph_def->Clear();
+  TF_RETURN_IF_ERROR(AddTFRecordDataset(filenames, graph_def));
+  AddParseFunction("ParseImageRecord", /*decode=*/false, graph_def);
+  return AddMapBatchPrefetch(
+      "records", "ParseImageRecord", num_parallel_calls, batch_size,
+      {DT_STRING, DT_INT64}, {PartialTensorShape({}), PartialTensorShape({})},
+      graph_def);
+}
+
+Status ImageDecodePipeline(const std::vector<string>& filenames, int height,
+                           int width, int64 batch_size, int num_parallel_calls,
+                           GraphDef* graph_def) {
+  graph_def->Clear();
+  TF_RETURN_IF_ERROR(AddTFRecordDataset(filenames, graph_def));
+  AddParseFunction("ParseAndDecodeImageRecord", /*decode=*/true, graph_def);
+  return AddMapBatchPrefetch(
+      "records", "ParseAndDecodeImageRecord", num_parallel_calls, batch_size,
+      {DT_UINT8, DT_INT64},
+      {PartialTensorShape({height, width, 3}), PartialTensorShape({})},
+      graph_def);
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,63 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_BENCHMARK_PIPELINES_H_
+#define TENSORFLOW_CORE_DATA_BENCHMARK_PIPELINES_H_
+
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// Standard input pipelines for `RunInputPipelineBenchmark`, as dataset graphs
+// equivalent to the output of the `DatasetToGraph` op.
+
+// Writes `num_records` serialized `tf.Example`s to the TFRecord file
+// `filename`, each with an "image" feature holding a `height` x `width` RGB
+// JPEG image and an int64 "label" feature.
+Status WriteSyntheticImageRecords(Env* env, const string& filename,
+                                  int64 num_records, int height, int width);
+
+// tf.data.Dataset.range(num_elements)
+//     .shuffle(buffer_size)
+//     .batch(batch_size, drop_remainder=True)
+Status ShuffleBatchPipeline(int64 num_elements, int64 buffer_size,
+                            int64 batch_size, GraphDef* graph_def);
+
+// tf.data.TFRecordDataset(filenames)
+//     .map(parse_example, num_parallel_calls)
+//     .batch(batch_size, drop_remainder=True)
+//     .prefetch(1)
+//
+// where `parse_example` extracts the features of
+// `WriteSyntheticImageRecords` without decoding the image.
+Status TFRecordParsePipeline(const std::vector<string>& filenames,
+                             int64 batch_size, int num_parallel_calls,
+                             GraphDef* graph_def);
+
+// As `TFRecordParsePipeline`, but the map function also decodes the JPEG
+// images, which must all be `height` x `width`.
+Status ImageDecodePipeline(const std::vector<string>& filenames, int height,
+                           int width, int64 batch_size, int num_parallel_calls,
+                           GraphDef* graph_def);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_BENCHMARK_PIPELINES_H_
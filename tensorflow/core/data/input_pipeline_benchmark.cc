@@ -0,0 +1,195 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/input_pipeline_benchmark.h"
+
+#include <algorithm>
+#include <atomic>
+#include <ctime>
+#include <map>
+#include <memory>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// An iterator and the model its transformations record in.
+struct ProfiledIterator {
+  std::shared_ptr<model::Model> model;
+  std::unique_ptr<standalone::Iterator> iterator;
+  // Serializes the consumers of a shared iterator.
+  mutex mu;
+};
+
+// What a single consumer measured.
+struct ConsumerStats {
+  int64 num_elements = 0;
+  int64 num_bytes = 0;
+  Status status;
+};
+
+// Merges the profiles of the iterators of the consumers, which have the same
+// transformations.
+std::vector<InputPipelineStageStats> MergeProfiles(
+    const std::vector<std::unique_ptr<ProfiledIterator>>& iterators) {
+  std::map<string, InputPipelineStageStats> stages;
+  for (const auto& iterator : iterators) {
+    for (const auto& pair : iterator->model->Profile()) {
+      const model::NodeProfile& node = pair.second;
+      InputPipelineStageStats& stage = stages[pair.first];
+      stage.name = pair.first;
+      const int64 num_elements = stage.num_elements + node.num_elements;
+      if (num_elements > 0) {
+        // Averages weighted by the number of elements.
+        stage.processing_time_ns =
+            (stage.processing_time_ns * stage.num_elements +
+             node.processing_time * node.num_elements) /
+            num_elements;
+        stage.parallelism = (stage.parallelism * stage.num_elements +
+                             node.parallelism * node.num_elements) /
+                            num_elements;
+      }
+      stage.num_elements = num_elements;
+    }
+  }
+  std::vector<InputPipelineStageStats> result;
+  result.reserve(stages.size());
+  for (auto& pair : stages) {
+    result.push_back(std::move(pair.second));
+  }
+  std::sort(result.begin(), result.end(),
+            [](const InputPipelineStageStats& a,
+               const InputPipelineStageStats& b) {
+              return a.processing_time_ns > b.processing_time_ns;
+            });
+  return result;
+}
+
+}  // namespace
+
+string InputPipelineBenchmarkResults::DebugString() const {
+  string result = strings::Printf(
+      "%lld elements in %.3f s: %.1f elements/s, %.1f MB/s, %.2f cores\n",
+      static_cast<long long>(num_elements), wall_time_seconds,
+      elements_per_second(), bytes_per_second() / 1e6, cpu_utilization());
+  for (const InputPipelineStageStats& stage : stages) {
+    strings::Appendf(&result, "  %s: %lld elements, %.1f us/element, %.1f "
+                     "threads\n",
+                     stage.name.c_str(),
+                     static_cast<long long>(stage.num_elements),
+                     stage.processing_time_ns / 1e3, stage.parallelism);
+  }
+  return result;
+}
+
+Status RunInputPipelineBenchmark(const GraphDef& graph_def,
+                                 const InputPipelineBenchmarkOptions& options,
+                                 InputPipelineBenchmarkResults* results) {
+  if (options.num_consumers < 1) {
+    return errors::InvalidArgument("num_consumers must be positive, got ",
+                                   options.num_consumers);
+  }
+  std::unique_ptr<standalone::Dataset> dataset;
+  TF_RETURN_IF_ERROR(standalone::Dataset::FromGraph(options.dataset_params,
+                                                    graph_def, &dataset));
+
+  const int num_iterators =
+      options.share_iterator ? 1 : options.num_consumers;
+  std::vector<std::unique_ptr<ProfiledIterator>> iterators;
+  for (int i = 0; i < num_iterators; ++i) {
+    auto iterator = absl::make_unique<ProfiledIterator>();
+    iterator->model = std::make_shared<model::Model>(
+        /*remove_node_hook=*/[](std::shared_ptr<model::Node>) {});
+    iterator->model->CollectResourceUsage();
+    TF_RETURN_IF_ERROR(
+        dataset->MakeIterator(iterator->model, &iterator->iterator));
+    for (int64 j = 0; j < options.num_warmup_elements; ++j) {
+      std::vector<Tensor> outputs;
+      bool end_of_input = false;
+      TF_RETURN_IF_ERROR(iterator->iterator->GetNext(&outputs, &end_of_input));
+      if (end_of_input) break;
+    }
+    iterators.push_back(std::move(iterator));
+  }
+
+  Env* env = Env::Default();
+  std::vector<ConsumerStats> consumer_stats(options.num_consumers);
+  std::atomic<int64> num_elements(0);
+  std::atomic<bool> done(false);
+  const uint64 start_micros = env->NowMicros();
+  const uint64 end_micros =
+      start_micros + static_cast<uint64>(options.max_seconds * 1e6);
+  const std::clock_t start_cpu = std::clock();
+  {
+    thread::ThreadPool pool(env, "input_pipeline_benchmark",
+                            options.num_consumers);
+    BlockingCounter counter(options.num_consumers);
+    for (int i = 0; i < options.num_consumers; ++i) {
+      ProfiledIterator* iterator = iterators[i % num_iterators].get();
+      ConsumerStats* stats = &consumer_stats[i];
+      pool.Schedule([&, iterator, stats]() {
+        while (!done) {
+          std::vector<Tensor> outputs;
+          bool end_of_input = false;
+          {
+            mutex_lock l(iterator->mu);
+            stats->status =
+                iterator->iterator->GetNext(&outputs, &end_of_input);
+          }
+          if (!stats->status.ok() || end_of_input) {
+            done = true;
+            break;
+          }
+          ++stats->num_elements;
+          for (const Tensor& t : outputs) {
+            stats->num_bytes += t.TotalBytes();
+          }
+          const int64 total = ++num_elements;
+          if ((options.max_elements > 0 && total >= options.max_elements) ||
+              env->NowMicros() >= end_micros) {
+            done = true;
+          }
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  const std::clock_t end_cpu = std::clock();
+
+  *results = InputPipelineBenchmarkResults();
+  results->wall_time_seconds = (env->NowMicros() - start_micros) / 1e6;
+  results->cpu_time_seconds =
+      static_cast<double>(end_cpu - start_cpu) / CLOCKS_PER_SEC;
+  for (const ConsumerStats& stats : consumer_stats) {
+    TF_RETURN_IF_ERROR(stats.status);
+    results->num_elements += stats.num_elements;
+    results->num_bytes += stats.num_bytes;
+  }
+  results->stages = MergeProfiles(iterators);
+  return Status::OK();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,107 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_INPUT_PIPELINE_BENCHMARK_H_
+#define TENSORFLOW_CORE_DATA_INPUT_PIPELINE_BENCHMARK_H_
+
+#include <vector>
+
+#include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// The facilities in this file measure the throughput of a tf.data input
+// pipeline in isolation from the model that consumes it. The pipeline is given
+// as a dataset graph (e.g. the output of the `DatasetToGraph` op, or one of the
+// pipelines of benchmark_pipelines.h) and run with the standalone API.
+//
+// Example usage:
+//
+//   InputPipelineBenchmarkOptions options;
+//   options.num_consumers = 4;
+//   InputPipelineBenchmarkResults results;
+//   TF_RETURN_IF_ERROR(
+//       RunInputPipelineBenchmark(graph_def, options, &results));
+//   LOG(INFO) << results.DebugString();
+
+struct InputPipelineBenchmarkOptions {
+  standalone::Dataset::Params dataset_params;
+  // The number of threads consuming elements.
+  int num_consumers = 1;
+  // If true, the consumers share a single iterator, as the replicas of a model
+  // do. Otherwise each consumer drives its own iterator.
+  bool share_iterator = true;
+  // The number of elements each iterator produces before the measurement
+  // starts, e.g. to fill shuffle buffers.
+  int64 num_warmup_elements = 0;
+  // The measurement ends after this many elements (if positive), after
+  // `max_seconds`, or at the end of the input, whichever comes first.
+  int64 max_elements = 0;
+  double max_seconds = 10.0;
+};
+
+// The statistics of one transformation of the pipeline, as recorded by the
+// tf.data performance model.
+struct InputPipelineStageStats {
+  // The prefix of the transformation's iterator, e.g. "Iterator::Batch::Map".
+  string name;
+  int64 num_elements = 0;
+  // The average time, in nanoseconds, the transformation spent producing an
+  // element, excluding the time spent in its inputs.
+  double processing_time_ns = 0;
+  double parallelism = 1;
+};
+
+struct InputPipelineBenchmarkResults {
+  int64 num_elements = 0;
+  // The total size of the tensors of the elements.
+  int64 num_bytes = 0;
+  double wall_time_seconds = 0;
+  // The CPU time of the whole process during the measurement.
+  double cpu_time_seconds = 0;
+  // Ordered by decreasing processing time per element.
+  std::vector<InputPipelineStageStats> stages;
+
+  double elements_per_second() const {
+    return wall_time_seconds > 0 ? num_elements / wall_time_seconds : 0;
+  }
+  double bytes_per_second() const {
+    return wall_time_seconds > 0 ? num_bytes / wall_time_seconds : 0;
+  }
+  // The average number of cores the process kept busy.
+  double cpu_utilization() const {
+    return wall_time_seconds > 0 ? cpu_time_seconds / wall_time_seconds : 0;
+  }
+
+  string DebugString() const;
+};
+
+// Runs the dataset graph `graph_def` as described by `options`, and stores the
+// measurements in `results`.
+//
+// The per-stage statistics are recorded in a performance model of the
+// benchmark's own; transformations under a `ModelDataset` (i.e. autotuned
+// pipelines) record in the model of that dataset instead and are not reported.
+Status RunInputPipelineBenchmark(const GraphDef& graph_def,
+                                 const InputPipelineBenchmarkOptions& options,
+                                 InputPipelineBenchmarkResults* results);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_INPUT_PIPELINE_BENCHMARK_H_
@@ -0,0 +1,118 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/input_pipeline_benchmark.h"
+
+#include "tensorflow/core/data/benchmark_pipelines.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+TEST(InputPipelineBenchmark, ShuffleBatch) {
+  GraphDef graph_def;
+  TF_ASSERT_OK(ShuffleBatchPipeline(/*num_elements=*/1000,
+                                    /*buffer_size=*/100, /*batch_size=*/10,
+                                    &graph_def));
+  InputPipelineBenchmarkOptions options;
+  options.num_warmup_elements = 5;
+  InputPipelineBenchmarkResults results;
+  TF_ASSERT_OK(RunInputPipelineBenchmark(graph_def, options, &results));
+  // The warmup consumes 5 of the 100 batches.
+  EXPECT_EQ(results.num_elements, 95);
+  EXPECT_EQ(results.num_bytes, 95 * 10 * sizeof(int64));
+  EXPECT_GT(results.elements_per_second(), 0);
+  ASSERT_FALSE(results.stages.empty());
+  for (const InputPipelineStageStats& stage : results.stages) {
+    EXPECT_GT(stage.num_elements, 0) << stage.name;
+  }
+  for (int i = 1; i < results.stages.size(); ++i) {
+    EXPECT_GE(results.stages[i - 1].processing_time_ns,
+              results.stages[i].processing_time_ns);
+  }
+}
+
+TEST(InputPipelineBenchmark, MaxElements) {
+  GraphDef graph_def;
+  TF_ASSERT_OK(ShuffleBatchPipeline(/*num_elements=*/100000,
+                                    /*buffer_size=*/10, /*batch_size=*/1,
+                                    &graph_def));
+  InputPipelineBenchmarkOptions options;
+  options.num_consumers = 4;
+  options.share_iterator = false;
+  options.max_elements = 100;
+  InputPipelineBenchmarkResults results;
+  TF_ASSERT_OK(RunInputPipelineBenchmark(graph_def, options, &results));
+  // Each consumer may fetch one element after the limit is reached.
+  EXPECT_GE(results.num_elements, 100);
+  EXPECT_LT(results.num_elements, 100 + options.num_consumers);
+}
+
+TEST(InputPipelineBenchmark, InvalidNumConsumers) {
+  GraphDef graph_def;
+  TF_ASSERT_OK(ShuffleBatchPipeline(10, 10, 1, &graph_def));
+  InputPipelineBenchmarkOptions options;
+  options.num_consumers = 0;
+  InputPipelineBenchmarkResults results;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      RunInputPipelineBenchmark(graph_def, options, &results)));
+}
+
+class ImageRecordsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    filename_ = io::JoinPath(testing::TmpDir(), "benchmark_images.tfrecord");
+    TF_ASSERT_OK(WriteSyntheticImageRecords(Env::Default(), filename_,
+                                            kNumRecords, kHeight, kWidth));
+  }
+
+  static constexpr int kNumRecords = 32;
+  static constexpr int kHeight = 16;
+  static constexpr int kWidth = 24;
+  string filename_;
+};
+
+TEST_F(ImageRecordsTest, TFRecordParse) {
+  GraphDef graph_def;
+  TF_ASSERT_OK(TFRecordParsePipeline({filename_}, /*batch_size=*/8,
+                                     /*num_parallel_calls=*/2, &graph_def));
+  InputPipelineBenchmarkOptions options;
+  options.num_consumers = 2;
+  InputPipelineBenchmarkResults results;
+  TF_ASSERT_OK(RunInputPipelineBenchmark(graph_def, options, &results));
+  EXPECT_EQ(results.num_elements, kNumRecords / 8);
+  EXPECT_GT(results.num_bytes, 0);
+}
+
+TEST_F(ImageRecordsTest, ImageDecode) {
+  GraphDef graph_def;
+  TF_ASSERT_OK(ImageDecodePipeline({filename_}, kHeight, kWidth,
+                                   /*batch_size=*/8, /*num_parallel_calls=*/2,
+                                   &graph_def));
+  InputPipelineBenchmarkOptions options;
+  InputPipelineBenchmarkResults results;
+  TF_ASSERT_OK(RunInputPipelineBenchmark(graph_def, options, &results));
+  EXPECT_EQ(results.num_elements, kNumRecords / 8);
+  // Each element is a batch of decoded images and their labels.
+  EXPECT_EQ(results.num_bytes,
+            kNumRecords * (kHeight * kWidth * 3 + sizeof(int64)));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
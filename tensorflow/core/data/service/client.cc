@@ -0,0 +1,106 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/service/client.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Calls a worker running in this process directly.
+class LocalDataServiceClient : public DataServiceClient {
+ public:
+  explicit LocalDataServiceClient(std::shared_ptr<DataServiceWorkerImpl> worker)
+      : worker_(std::move(worker)) {}
+
+  Status RegisterDataset(const string& dataset_graph,
+                         int64* dataset_id) override {
+    return worker_->RegisterDataset(dataset_graph, dataset_id);
+  }
+
+  Status GetElement(int64 dataset_id, std::vector<Tensor>* components,
+                    bool* end_of_sequence) override {
+    return worker_->GetElement(dataset_id, components, end_of_sequence);
+  }
+
+ private:
+  const std::shared_ptr<DataServiceWorkerImpl> worker_;
+};
+
+struct Registry {
+  mutex mu;
+  DataServiceClient::Factory remote_factory GUARDED_BY(mu);
+  absl::flat_hash_map<string, std::shared_ptr<DataServiceWorkerImpl>>
+      local_workers GUARDED_BY(mu);
+};
+
+Registry* GlobalRegistry() {
+  static Registry* registry = new Registry;
+  return registry;
+}
+
+}  // namespace
+
+/* static */
+Status DataServiceClient::Create(const string& address,
+                                 std::unique_ptr<DataServiceClient>* client) {
+  Registry* registry = GlobalRegistry();
+  Factory remote_factory;
+  {
+    mutex_lock l(registry->mu);
+    auto it = registry->local_workers.find(address);
+    if (it != registry->local_workers.end()) {
+      *client = absl::make_unique<LocalDataServiceClient>(it->second);
+      return Status::OK();
+    }
+    remote_factory = registry->remote_factory;
+  }
+  if (!remote_factory) {
+    return errors::Unavailable(
+        "No data service worker is running at ", address,
+        " in this process, and no remote data service client is linked in.");
+  }
+  return remote_factory(address, client);
+}
+
+/* static */
+void DataServiceClient::RegisterRemoteFactory(Factory factory) {
+  Registry* registry = GlobalRegistry();
+  mutex_lock l(registry->mu);
+  registry->remote_factory = std::move(factory);
+}
+
+/* static */
+void DataServiceClient::RegisterLocalWorker(
+    const string& address, std::shared_ptr<DataServiceWorkerImpl> worker) {
+  Registry* registry = GlobalRegistry();
+  mutex_lock l(registry->mu);
+  registry->local_workers[address] = std::move(worker);
+}
+
+/* static */
+void DataServiceClient::UnregisterLocalWorker(const string& address) {
+  Registry* registry = GlobalRegistry();
+  mutex_lock l(registry->mu);
+  registry->local_workers.erase(address);
+}
+
+}  // namespace data
+}  // namespace tensorflow
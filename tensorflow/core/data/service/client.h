@@ -0,0 +1,70 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_CLIENT_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_CLIENT_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/data/service/worker_impl.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+namespace data {
+
+// A client of a data service worker (see worker_impl.h).
+//
+// Clients are obtained with `DataServiceClient::Create()`. Workers started in
+// the same process are called directly, so elements are handed over without
+// being serialized or copied. Other addresses are reached through the remote
+// client factory, which the gRPC client registers when it is linked in. This
+// keeps the consumer side (e.g. the `DataServiceDataset` kernel) free of any
+// RPC dependency.
+class DataServiceClient {
+ public:
+  virtual ~DataServiceClient() = default;
+
+  // See DataServiceWorkerImpl::RegisterDataset().
+  virtual Status RegisterDataset(const string& dataset_graph,
+                                 int64* dataset_id) = 0;
+
+  // See DataServiceWorkerImpl::GetElement().
+  virtual Status GetElement(int64 dataset_id, std::vector<Tensor>* components,
+                            bool* end_of_sequence) = 0;
+
+  // Creates a client for the worker at `address`, e.g. "localhost:5000".
+  static Status Create(const string& address,
+                       std::unique_ptr<DataServiceClient>* client);
+
+  // Sets the factory used to create clients for workers outside of this
+  // process.
+  using Factory = std::function<Status(
+      const string& address, std::unique_ptr<DataServiceClient>* client)>;
+  static void RegisterRemoteFactory(Factory factory);
+
+  // Makes `worker` available to in-process clients under `address`, until
+  // `UnregisterLocalWorker(address)` is called.
+  static void RegisterLocalWorker(
+      const string& address, std::shared_ptr<DataServiceWorkerImpl> worker);
+  static void UnregisterLocalWorker(const string& address);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_CLIENT_H_
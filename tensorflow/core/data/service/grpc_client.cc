@@ -0,0 +1,98 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Registers a DataServiceClient factory that reaches remote workers through
+// gRPC. Linking this library in is enough to make `DataServiceClient::Create()`
+// accept addresses of workers running in other processes.
+
+#include <limits>
+
+#include "absl/memory/memory.h"
+#include "grpcpp/client_context.h"
+#include "grpcpp/create_channel.h"
+#include "grpcpp/security/credentials.h"
+#include "grpcpp/support/channel_arguments.h"
+#include "tensorflow/core/data/service/client.h"
+#include "tensorflow/core/data/service/data_service.grpc.pb.h"
+#include "tensorflow/core/data/service/data_service.pb.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+class GrpcDataServiceClient : public DataServiceClient {
+ public:
+  explicit GrpcDataServiceClient(std::unique_ptr<DataServiceWorker::Stub> stub)
+      : stub_(std::move(stub)) {}
+
+  Status RegisterDataset(const string& dataset_graph,
+                         int64* dataset_id) override {
+    RegisterDatasetRequest request;
+    request.set_dataset_graph(dataset_graph);
+    RegisterDatasetResponse response;
+    ::grpc::ClientContext ctx;
+    TF_RETURN_IF_ERROR(
+        FromGrpcStatus(stub_->RegisterDataset(&ctx, request, &response)));
+    *dataset_id = response.dataset_id();
+    return Status::OK();
+  }
+
+  Status GetElement(int64 dataset_id, std::vector<Tensor>* components,
+                    bool* end_of_sequence) override {
+    GetElementRequest request;
+    request.set_dataset_id(dataset_id);
+    GetElementResponse response;
+    ::grpc::ClientContext ctx;
+    TF_RETURN_IF_ERROR(
+        FromGrpcStatus(stub_->GetElement(&ctx, request, &response)));
+    *end_of_sequence = response.end_of_sequence();
+    components->clear();
+    components->reserve(response.components_size());
+    for (const TensorProto& proto : response.components()) {
+      Tensor component;
+      if (!component.FromProto(proto)) {
+        return errors::DataLoss("Unable to parse tensor from proto.");
+      }
+      components->push_back(std::move(component));
+    }
+    return Status::OK();
+  }
+
+ private:
+  const std::unique_ptr<DataServiceWorker::Stub> stub_;
+};
+
+Status CreateGrpcDataServiceClient(const string& address,
+                                   std::unique_ptr<DataServiceClient>* client) {
+  ::grpc::ChannelArguments args;
+  args.SetMaxReceiveMessageSize(std::numeric_limits<int32>::max());
+  auto channel = ::grpc::CreateCustomChannel(
+      address, ::grpc::InsecureChannelCredentials(), args);
+  *client =
+      absl::make_unique<GrpcDataServiceClient>(DataServiceWorker::NewStub(
+          channel));
+  return Status::OK();
+}
+
+static bool grpc_data_service_client_registered = []() {
+  DataServiceClient::RegisterRemoteFactory(CreateGrpcDataServiceClient);
+  return true;
+}();
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
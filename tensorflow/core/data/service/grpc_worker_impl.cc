@@ -0,0 +1,52 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/service/grpc_worker_impl.h"
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
+
+namespace tensorflow {
+namespace data {
+
+::grpc::Status GrpcDataServiceWorkerImpl::RegisterDataset(
+    ::grpc::ServerContext* ctx, const RegisterDatasetRequest* request,
+    RegisterDatasetResponse* response) {
+  int64 dataset_id;
+  Status s = impl_->RegisterDataset(request->dataset_graph(), &dataset_id);
+  if (s.ok()) {
+    response->set_dataset_id(dataset_id);
+  }
+  return ToGrpcStatus(s);
+}
+
+::grpc::Status GrpcDataServiceWorkerImpl::GetElement(
+    ::grpc::ServerContext* ctx, const GetElementRequest* request,
+    GetElementResponse* response) {
+  std::vector<Tensor> components;
+  bool end_of_sequence = false;
+  Status s = impl_->GetElement(request->dataset_id(), &components,
+                               &end_of_sequence);
+  if (!s.ok()) {
+    return ToGrpcStatus(s);
+  }
+  response->set_end_of_sequence(end_of_sequence);
+  for (const Tensor& component : components) {
+    component.AsProtoTensorContent(response->add_components());
+  }
+  return ::grpc::Status::OK;
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,54 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_GRPC_WORKER_IMPL_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_GRPC_WORKER_IMPL_H_
+
+#include <memory>
+
+#include "grpcpp/server_context.h"
+#include "grpcpp/support/status.h"
+#include "tensorflow/core/data/service/data_service.grpc.pb.h"
+#include "tensorflow/core/data/service/data_service.pb.h"
+#include "tensorflow/core/data/service/worker_impl.h"
+
+namespace tensorflow {
+namespace data {
+
+// Exposes a DataServiceWorkerImpl through gRPC.
+class GrpcDataServiceWorkerImpl : public DataServiceWorker::Service {
+ public:
+  explicit GrpcDataServiceWorkerImpl(
+      std::shared_ptr<DataServiceWorkerImpl> impl)
+      : impl_(std::move(impl)) {}
+
+  ::grpc::Status RegisterDataset(::grpc::ServerContext* ctx,
+                                 const RegisterDatasetRequest* request,
+                                 RegisterDatasetResponse* response) override;
+
+  ::grpc::Status GetElement(::grpc::ServerContext* ctx,
+                            const GetElementRequest* request,
+                            GetElementResponse* response) override;
+
+ private:
+  const std::shared_ptr<DataServiceWorkerImpl> impl_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GrpcDataServiceWorkerImpl);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_GRPC_WORKER_IMPL_H_
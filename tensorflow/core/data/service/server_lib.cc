@@ -0,0 +1,69 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/service/server_lib.h"
+
+#include <limits>
+
+#include "absl/memory/memory.h"
+#include "grpcpp/security/server_credentials.h"
+#include "grpcpp/server_builder.h"
+#include "tensorflow/core/data/service/client.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace data {
+
+/* static */
+Status DataServiceServer::Create(int port,
+                                 std::unique_ptr<DataServiceServer>* server) {
+  std::unique_ptr<DataServiceServer> result(new DataServiceServer);
+  result->impl_ = std::make_shared<DataServiceWorkerImpl>();
+  result->service_ =
+      absl::make_unique<GrpcDataServiceWorkerImpl>(result->impl_);
+
+  ::grpc::ServerBuilder builder;
+  builder.AddListeningPort(strings::StrCat("0.0.0.0:", port),
+                           ::grpc::InsecureServerCredentials(),
+                           &result->port_);
+  builder.SetMaxReceiveMessageSize(std::numeric_limits<int32>::max());
+  builder.SetMaxSendMessageSize(std::numeric_limits<int32>::max());
+  builder.RegisterService(result->service_.get());
+  result->server_ = builder.BuildAndStart();
+  if (!result->server_) {
+    return errors::Unknown("Could not start data service server on port ",
+                           port);
+  }
+  DataServiceClient::RegisterLocalWorker(result->address(), result->impl_);
+  LOG(INFO) << "Started data service worker at " << result->address();
+  *server = std::move(result);
+  return Status::OK();
+}
+
+DataServiceServer::~DataServiceServer() {
+  DataServiceClient::UnregisterLocalWorker(address());
+  server_->Shutdown();
+  server_->Wait();
+}
+
+void DataServiceServer::Join() { server_->Wait(); }
+
+string DataServiceServer::address() const {
+  return strings::StrCat("localhost:", port_);
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,65 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SERVER_LIB_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SERVER_LIB_H_
+
+#include <memory>
+
+#include "grpcpp/server.h"
+#include "tensorflow/core/data/service/grpc_worker_impl.h"
+#include "tensorflow/core/data/service/worker_impl.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+namespace data {
+
+// A standalone tf.data service worker, serving input pipelines over gRPC.
+//
+// Consumers in the same process as the server reach it through
+// `DataServiceClient` without going through gRPC.
+class DataServiceServer {
+ public:
+  // Starts a server listening on `port`. If `port` is 0, an unused port is
+  // picked.
+  static Status Create(int port, std::unique_ptr<DataServiceServer>* server);
+
+  // Stops the server.
+  ~DataServiceServer();
+
+  // Blocks until the server has shut down.
+  void Join();
+
+  // Returns the port the server is listening on.
+  int port() const { return port_; }
+
+  // Returns the address consumers should use to reach this server.
+  string address() const;
+
+ private:
+  DataServiceServer() = default;
+
+  int port_ = 0;
+  std::shared_ptr<DataServiceWorkerImpl> impl_;
+  std::unique_ptr<GrpcDataServiceWorkerImpl> service_;
+  std::unique_ptr<::grpc::Server> server_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(DataServiceServer);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SERVER_LIB_H_
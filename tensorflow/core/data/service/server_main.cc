@@ -0,0 +1,45 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Runs a standalone tf.data service worker.
+//
+// Usage: data_service_server --port=5000
+
+#include <vector>
+
+#include "tensorflow/core/data/service/server_lib.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+int main(int argc, char* argv[]) {
+  tensorflow::int32 port = 0;
+  std::vector<tensorflow::Flag> flag_list = {
+      tensorflow::Flag("port", &port,
+                       "Port to listen on. If 0, an unused port is picked."),
+  };
+  tensorflow::string usage = tensorflow::Flags::Usage(argv[0], flag_list);
+  const bool parse_ok = tensorflow::Flags::Parse(&argc, argv, flag_list);
+  tensorflow::port::InitMain(argv[0], &argc, &argv);
+  if (!parse_ok || argc != 1) {
+    LOG(ERROR) << usage;
+    return -1;
+  }
+
+  std::unique_ptr<tensorflow::data::DataServiceServer> server;
+  TF_CHECK_OK(tensorflow::data::DataServiceServer::Create(port, &server));
+  server->Join();
+  return 0;
+}
@@ -0,0 +1,90 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/service/worker_impl.h"
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/hash.h"
+
+namespace tensorflow {
+namespace data {
+
+Status DataServiceWorkerImpl::RegisterDataset(const string& dataset_graph,
+                                              int64* dataset_id) {
+  const uint64 fingerprint = Hash64(dataset_graph);
+  {
+    mutex_lock l(mu_);
+    auto it = dataset_ids_by_fingerprint_.find(fingerprint);
+    if (it != dataset_ids_by_fingerprint_.end()) {
+      *dataset_id = it->second;
+      return Status::OK();
+    }
+  }
+
+  // Build the dataset without holding `mu_`, since running the dataset graph
+  // can take a while.
+  GraphDef graph_def;
+  if (!graph_def.ParseFromString(dataset_graph)) {
+    return errors::InvalidArgument("Could not parse the dataset graph");
+  }
+  auto task = std::make_shared<Task>();
+  TF_RETURN_IF_ERROR(
+      standalone::Dataset::FromGraph({}, graph_def, &task->dataset));
+  {
+    mutex_lock l(task->mu);
+    TF_RETURN_IF_ERROR(task->dataset->MakeIterator(&task->iterator));
+  }
+
+  mutex_lock l(mu_);
+  auto it = dataset_ids_by_fingerprint_.find(fingerprint);
+  if (it != dataset_ids_by_fingerprint_.end()) {
+    // Another consumer registered the same dataset concurrently.
+    *dataset_id = it->second;
+    return Status::OK();
+  }
+  *dataset_id = next_dataset_id_++;
+  dataset_ids_by_fingerprint_[fingerprint] = *dataset_id;
+  tasks_[*dataset_id] = std::move(task);
+  VLOG(1) << "Registered dataset " << *dataset_id;
+  return Status::OK();
+}
+
+Status DataServiceWorkerImpl::GetElement(int64 dataset_id,
+                                         std::vector<Tensor>* components,
+                                         bool* end_of_sequence) {
+  std::shared_ptr<Task> task;
+  {
+    mutex_lock l(mu_);
+    auto it = tasks_.find(dataset_id);
+    if (it == tasks_.end()) {
+      return errors::NotFound("Dataset ", dataset_id, " is not registered");
+    }
+    task = it->second;
+  }
+
+  mutex_lock l(task->mu);
+  components->clear();
+  if (task->end_of_sequence) {
+    *end_of_sequence = true;
+    return Status::OK();
+  }
+  TF_RETURN_IF_ERROR(task->iterator->GetNext(components, end_of_sequence));
+  task->end_of_sequence = *end_of_sequence;
+  return Status::OK();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,75 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_WORKER_IMPL_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_WORKER_IMPL_H_
+
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// Transport-independent implementation of a data service worker. A worker
+// runs the input pipelines registered with it and hands out their elements to
+// consumers as they ask for them.
+//
+// This class is thread-safe.
+class DataServiceWorkerImpl {
+ public:
+  DataServiceWorkerImpl() = default;
+
+  // Builds the dataset described by `dataset_graph`, a serialized GraphDef as
+  // produced by the `DatasetToGraph` op, and stores its id in `*dataset_id`.
+  // If an identical graph has already been registered, returns the id of the
+  // existing dataset instead, so that consumers running the same pipeline
+  // share its elements rather than duplicating the preprocessing work.
+  Status RegisterDataset(const string& dataset_graph, int64* dataset_id);
+
+  // Produces the next element of dataset `dataset_id`. Once the dataset is
+  // exhausted, sets `*end_of_sequence` for every subsequent call.
+  Status GetElement(int64 dataset_id, std::vector<Tensor>* components,
+                    bool* end_of_sequence);
+
+ private:
+  // A registered dataset, and the single iterator consumers read from.
+  struct Task {
+    mutex mu;
+    // `iterator` must be destroyed before `dataset`.
+    std::unique_ptr<standalone::Dataset> dataset;
+    std::unique_ptr<standalone::Iterator> iterator GUARDED_BY(mu);
+    bool end_of_sequence GUARDED_BY(mu) = false;
+  };
+
+  mutex mu_;
+  int64 next_dataset_id_ GUARDED_BY(mu_) = 0;
+  absl::flat_hash_map<uint64, int64> dataset_ids_by_fingerprint_
+      GUARDED_BY(mu_);
+  absl::flat_hash_map<int64, std::shared_ptr<Task>> tasks_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(DataServiceWorkerImpl);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_WORKER_IMPL_H_
@@ -0,0 +1,174 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/service/worker_impl.h"
+
+#include "tensorflow/core/data/service/client.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Returns a serialized graph equivalent to `tf.data.Dataset.range(stop)`.
+string RangeGraph(int64 stop) {
+  GraphDef graph_def;
+  CHECK(protobuf::TextFormat::ParseFromString(
+      strings::StrCat(R"proto(
+        node {
+          name: "start"
+          op: "Const"
+          attr {
+            key: "dtype"
+            value { type: DT_INT64 }
+          }
+          attr {
+            key: "value"
+            value { tensor { dtype: DT_INT64 tensor_shape {} int64_val: 0 } }
+          }
+        }
+        node {
+          name: "stop"
+          op: "Const"
+          attr {
+            key: "dtype"
+            value { type: DT_INT64 }
+          }
+          attr {
+            key: "value"
+            value {
+              tensor { dtype: DT_INT64 tensor_shape {} int64_val: )proto",
+                      stop, R"proto( }
+            }
+          }
+        }
+        node {
+          name: "step"
+          op: "Const"
+          attr {
+            key: "dtype"
+            value { type: DT_INT64 }
+          }
+          attr {
+            key: "value"
+            value { tensor { dtype: DT_INT64 tensor_shape {} int64_val: 1 } }
+          }
+        }
+        node {
+          name: "range"
+          op: "RangeDataset"
+          input: "start"
+          input: "stop"
+          input: "step"
+          attr {
+            key: "output_shapes"
+            value { list { shape {} } }
+          }
+          attr {
+            key: "output_types"
+            value { list { type: DT_INT64 } }
+          }
+        }
+        node {
+          name: "dataset"
+          op: "_Retval"
+          input: "range"
+          attr {
+            key: "T"
+            value { type: DT_VARIANT }
+          }
+          attr {
+            key: "index"
+            value { i: 0 }
+          }
+        }
+      )proto"),
+      &graph_def));
+  return graph_def.SerializeAsString();
+}
+
+TEST(DataServiceWorkerImpl, GetElements) {
+  DataServiceWorkerImpl worker;
+  int64 dataset_id;
+  TF_ASSERT_OK(worker.RegisterDataset(RangeGraph(3), &dataset_id));
+  for (int64 expected = 0; expected < 3; ++expected) {
+    std::vector<Tensor> components;
+    bool end_of_sequence = true;
+    TF_ASSERT_OK(worker.GetElement(dataset_id, &components, &end_of_sequence));
+    ASSERT_FALSE(end_of_sequence);
+    ASSERT_EQ(1, components.size());
+    EXPECT_EQ(expected, components[0].scalar<int64>()());
+  }
+  for (int i = 0; i < 2; ++i) {
+    std::vector<Tensor> components;
+    bool end_of_sequence = false;
+    TF_ASSERT_OK(worker.GetElement(dataset_id, &components, &end_of_sequence));
+    EXPECT_TRUE(end_of_sequence);
+  }
+}
+
+TEST(DataServiceWorkerImpl, IdenticalGraphsShareElements) {
+  DataServiceWorkerImpl worker;
+  int64 first_id, second_id, other_id;
+  TF_ASSERT_OK(worker.RegisterDataset(RangeGraph(10), &first_id));
+  TF_ASSERT_OK(worker.RegisterDataset(RangeGraph(10), &second_id));
+  TF_ASSERT_OK(worker.RegisterDataset(RangeGraph(5), &other_id));
+  EXPECT_EQ(first_id, second_id);
+  EXPECT_NE(first_id, other_id);
+
+  std::vector<Tensor> components;
+  bool end_of_sequence;
+  TF_ASSERT_OK(worker.GetElement(first_id, &components, &end_of_sequence));
+  EXPECT_EQ(0, components[0].scalar<int64>()());
+  TF_ASSERT_OK(worker.GetElement(second_id, &components, &end_of_sequence));
+  EXPECT_EQ(1, components[0].scalar<int64>()());
+  TF_ASSERT_OK(worker.GetElement(other_id, &components, &end_of_sequence));
+  EXPECT_EQ(0, components[0].scalar<int64>()());
+}
+
+TEST(DataServiceWorkerImpl, UnknownDataset) {
+  DataServiceWorkerImpl worker;
+  std::vector<Tensor> components;
+  bool end_of_sequence;
+  EXPECT_TRUE(errors::IsNotFound(
+      worker.GetElement(42, &components, &end_of_sequence)));
+}
+
+TEST(DataServiceClient, LocalWorker) {
+  auto worker = std::make_shared<DataServiceWorkerImpl>();
+  DataServiceClient::RegisterLocalWorker("local:0", worker);
+  std::unique_ptr<DataServiceClient> client;
+  TF_ASSERT_OK(DataServiceClient::Create("local:0", &client));
+  int64 dataset_id;
+  TF_ASSERT_OK(client->RegisterDataset(RangeGraph(1), &dataset_id));
+  std::vector<Tensor> components;
+  bool end_of_sequence;
+  TF_ASSERT_OK(client->GetElement(dataset_id, &components, &end_of_sequence));
+  ASSERT_FALSE(end_of_sequence);
+  EXPECT_EQ(0, components[0].scalar<int64>()());
+  DataServiceClient::UnregisterLocalWorker("local:0");
+
+  // Without the gRPC client linked in, other addresses are unreachable.
+  EXPECT_TRUE(errors::IsUnavailable(
+      DataServiceClient::Create("local:0", &client)));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
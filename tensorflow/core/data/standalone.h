@@ -0,0 +1,121 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DATA_STANDALONE_H_
+#define TENSORFLOW_CORE_DATA_STANDALONE_H_
+
+#include <memory>
+
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/process_function_library_runtime.h"
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/function_handle_cache.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace data {
+namespace standalone {
+
+// The purpose of the API in this file is to facilitate standalone execution of
+// a tf.data input pipeline graph, i.e. outside of a TensorFlow session or
+// eager context. It instantiates just enough of the runtime (a single CPU
+// device and its function library) to run the graph that produces the dataset
+// and to drive an iterator over it.
+//
+// Example usage:
+//
+//   GraphDef graph_def;
+//   ...  // Populate `graph_def`, e.g. from the output of `DatasetToGraph`.
+//   std::unique_ptr<Dataset> dataset;
+//   TF_RETURN_IF_ERROR(Dataset::FromGraph({}, graph_def, &dataset));
+//   std::unique_ptr<Iterator> iterator;
+//   TF_RETURN_IF_ERROR(dataset->MakeIterator(&iterator));
+//   bool end_of_input = false;
+//   while (!end_of_input) {
+//     std::vector<Tensor> outputs;
+//     TF_RETURN_IF_ERROR(iterator->GetNext(&outputs, &end_of_input));
+//     ...  // Process `outputs`.
+//   }
+
+class Dataset;
+
+// Represents a standalone iterator. The lifetime of the iterator is tied to
+// the lifetime of the dataset that created it.
+class Iterator {
+ public:
+  // Returns the next element of the input pipeline (if there is one) and an
+  // indication of whether the end of the input pipeline has been reached.
+  //
+  // Not thread safe; external synchronization is required.
+  Status GetNext(std::vector<Tensor>* outputs, bool* end_of_input);
+
+ private:
+  friend class Dataset;
+
+  Iterator(IteratorBase* iterator, IteratorContext* ctx);
+
+  std::unique_ptr<IteratorBase> iterator_;
+  std::unique_ptr<IteratorContext> ctx_;
+};
+
+// Represents a standalone dataset. Iterators created by a dataset must be
+// destroyed before the dataset.
+class Dataset {
+ public:
+  // Parameters for `Dataset` creation (e.g. TensorFlow runtime configuration).
+  struct Params {
+    SessionOptions session_options;
+  };
+
+  // Creates a new `Dataset` instance by running the given dataset graph.
+  static Status FromGraph(Params params, const GraphDef& graph_def,
+                          std::unique_ptr<Dataset>* result);
+
+  ~Dataset();
+
+  // Creates an iterator for this dataset.
+  Status MakeIterator(std::unique_ptr<Iterator>* result);
+
+  // Creates an iterator for this dataset whose transformations record their
+  // performance in `model`, e.g. to profile the input pipeline. The nodes of
+  // the iterator are removed from `model` when the iterator is destroyed.
+  Status MakeIterator(std::shared_ptr<model::Model> model,
+                      std::unique_ptr<Iterator>* result);
+
+ private:
+  Dataset(DatasetBase* dataset, DeviceMgr* device_mgr,
+          ProcessFunctionLibraryRuntime* pflr,
+          FunctionLibraryDefinition* flib_def, thread::ThreadPool* pool);
+
+  DatasetBase* dataset_;  // owned
+  std::unique_ptr<DeviceMgr> device_mgr_;
+  std::unique_ptr<FunctionLibraryDefinition> flib_def_;
+  std::unique_ptr<ProcessFunctionLibraryRuntime> pflr_;
+  std::unique_ptr<thread::ThreadPool> pool_;
+  std::unique_ptr<FunctionHandleCache> function_handle_cache_;
+  std::function<void(std::function<void()>)> runner_;
+  ResourceMgr resource_mgr_;
+  CancellationManager cancellation_manager_;
+};
+
+}  // namespace standalone
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_STANDALONE_H_
@@ -0,0 +1,145 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/standalone.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace standalone {
+namespace {
+
+// A graph equivalent to `tf.data.Dataset.range(10)`, as produced by the
+// `DatasetToGraph` op.
+constexpr const char* const kRangeGraphProto = R"proto(
+  node {
+    name: "start"
+    op: "Const"
+    attr {
+      key: "dtype"
+      value { type: DT_INT64 }
+    }
+    attr {
+      key: "value"
+      value {
+        tensor {
+          dtype: DT_INT64
+          tensor_shape {}
+          int64_val: 0
+        }
+      }
+    }
+  }
+  node {
+    name: "stop"
+    op: "Const"
+    attr {
+      key: "dtype"
+      value { type: DT_INT64 }
+    }
+    attr {
+      key: "value"
+      value {
+        tensor {
+          dtype: DT_INT64
+          tensor_shape {}
+          int64_val: 10
+        }
+      }
+    }
+  }
+  node {
+    name: "step"
+    op: "Const"
+    attr {
+      key: "dtype"
+      value { type: DT_INT64 }
+    }
+    attr {
+      key: "value"
+      value {
+        tensor {
+          dtype: DT_INT64
+          tensor_shape {}
+          int64_val: 1
+        }
+      }
+    }
+  }
+  node {
+    name: "range"
+    op: "RangeDataset"
+    input: "start"
+    input: "stop"
+    input: "step"
+    attr {
+      key: "output_shapes"
+      value { list { shape {} } }
+    }
+    attr {
+      key: "output_types"
+      value { list { type: DT_INT64 } }
+    }
+  }
+  node {
+    name: "dataset"
+    op: "_Retval"
+    input: "range"
+    attr {
+      key: "T"
+      value { type: DT_VARIANT }
+    }
+    attr {
+      key: "index"
+      value { i: 0 }
+    }
+  }
+)proto";
+
+TEST(Standalone, Range) {
+  GraphDef graph_def;
+  ASSERT_TRUE(protobuf::TextFormat::ParseFromString(kRangeGraphProto,
+                                                    &graph_def));
+  std::unique_ptr<Dataset> dataset;
+  TF_ASSERT_OK(Dataset::FromGraph({}, graph_def, &dataset));
+  std::unique_ptr<Iterator> iterator;
+  TF_ASSERT_OK(dataset->MakeIterator(&iterator));
+  for (int64 expected = 0; expected < 10; ++expected) {
+    std::vector<Tensor> outputs;
+    bool end_of_input = false;
+    TF_ASSERT_OK(iterator->GetNext(&outputs, &end_of_input));
+    ASSERT_FALSE(end_of_input);
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_EQ(expected, outputs[0].scalar<int64>()());
+  }
+  std::vector<Tensor> outputs;
+  bool end_of_input = false;
+  TF_ASSERT_OK(iterator->GetNext(&outputs, &end_of_input));
+  EXPECT_TRUE(end_of_input);
+}
+
+TEST(Standalone, MissingRetval) {
+  GraphDef graph_def;
+  std::unique_ptr<Dataset> dataset;
+  EXPECT_TRUE(errors::IsNotFound(Dataset::FromGraph({}, graph_def, &dataset)));
+}
+
+}  // namespace
+}  // namespace standalone
+}  // namespace data
+}  // namespace tensorflow
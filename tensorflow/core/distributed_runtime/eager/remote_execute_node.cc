@@ -23,19 +23,59 @@ limitations under the License.
 namespace tensorflow {
 namespace eager {
 
+namespace {
+
+// The part of a RemoteExecuteNode needed once its operation is done, copied
+// out of the node, which may be destroyed before then if an error aborts the
+// node.
+struct PendingOperation {
+  gtl::InlinedVector<TensorHandle*, 4> inputs;
+  gtl::InlinedVector<TensorHandle*, 2> retvals;
+  Device* device;
+  // The index of the node's operation in the EnqueueRequest, and so of the
+  // shapes of its outputs in the EnqueueResponse.
+  int queue_index;
+};
+
+}  // namespace
+
 void RemoteExecuteNode::RunAsync(StatusCallback done) {
-  EnqueueResponse* response = new EnqueueResponse;
+  RunBatchAsync({}, std::move(done));
+}
+
+void RemoteExecuteNode::RunBatchAsync(
+    const std::vector<AsyncEagerNode*>& others, StatusCallback done) {
+  std::vector<const RemoteExecuteNode*> nodes = {this};
+  for (AsyncEagerNode* other : others) {
+    // Only RemoteExecuteNodes return an EagerClient as BatchKey().
+    nodes.push_back(static_cast<const RemoteExecuteNode*>(other));
+  }
 
-  const gtl::InlinedVector<TensorHandle*, 4>& inputs = inputs_;
-  const gtl::InlinedVector<TensorHandle*, 2>& retvals = retvals_;
-  Device* device = device_;
+  // A single node sends its own request. The operation of each node is the
+  // first item of its request.
+  const EnqueueRequest* request = request_.get();
+  EnqueueRequest batch_request;
+  std::vector<PendingOperation> operations;
+  operations.reserve(nodes.size());
+  for (const RemoteExecuteNode* node : nodes) {
+    operations.push_back({node->inputs_, node->retvals_, node->device_,
+                          others.empty() ? 0 : batch_request.queue_size()});
+    if (!others.empty()) {
+      batch_request.mutable_queue()->MergeFrom(node->request_->queue());
+    }
+  }
+  if (!others.empty()) {
+    batch_request.set_context_id(request_->context_id());
+    request = &batch_request;
+  }
+  EnqueueResponse* response = new EnqueueResponse;
 
   // Filled and used only when VLOG(3) is on.
   string rpc_description;
   if (VLOG_IS_ON(3)) {
     std::vector<string> ops;
-    ops.reserve(request_->queue_size());
-    for (const QueueItem& item : request_->queue()) {
+    ops.reserve(request->queue_size());
+    for (const QueueItem& item : request->queue()) {
       if (item.has_operation()) {
         ops.push_back(item.operation().name());
       } else {
@@ -49,41 +89,47 @@ void RemoteExecuteNode::RunAsync(StatusCallback done) {
   }
   VLOG(3) << "Issuing: " << rpc_description;
 
-  for (auto handle : inputs_) {
-    handle->Ref();
-  }
-  for (auto handle : retvals) {
-    handle->Ref();
+  for (const PendingOperation& operation : operations) {
+    for (auto handle : operation.inputs) {
+      handle->Ref();
+    }
+    for (auto handle : operation.retvals) {
+      handle->Ref();
+    }
   }
 
   eager_client_->StreamingEnqueueAsync(
-      request_.get(), response,
-      [inputs, retvals, response, device, rpc_description,
-       done](const Status& status) {
-        for (auto handle : inputs) {
-          handle->Unref();
-        }
+      request, response,
+      [operations, response, rpc_description, done](const Status& status) {
         if (status.ok()) {
           VLOG(3) << "Completed successfully: " << rpc_description;
         } else {
           VLOG(3) << "Failed: " << rpc_description << " with status "
                   << status.ToString();
         }
-        for (size_t i = 0; i < retvals.size(); ++i) {
-          if (status.ok()) {
-            Status s = retvals[i]->SetRemoteShape(
-                response->queue_response(0).shape(i), device);
-            if (!s.ok()) {
-              LOG(ERROR) << "Ignoring an error encountered when setting "
-                            "remote shape of tensor handle: "
-                         << retvals[i] << " with status: " << status.ToString()
-                         << "\nThis should never happen. "
-                            "Please file an issue with the TensorFlow Team.";
+        for (const PendingOperation& operation : operations) {
+          for (auto handle : operation.inputs) {
+            handle->Unref();
+          }
+          const auto& retvals = operation.retvals;
+          for (size_t i = 0; i < retvals.size(); ++i) {
+            if (status.ok()) {
+              Status s = retvals[i]->SetRemoteShape(
+                  response->queue_response(operation.queue_index).shape(i),
+                  operation.device);
+              if (!s.ok()) {
+                LOG(ERROR) << "Ignoring an error encountered when setting "
+                              "remote shape of tensor handle: "
+                           << retvals[i]
+                           << " with status: " << status.ToString()
+                           << "\nThis should never happen. "
+                              "Please file an issue with the TensorFlow Team.";
+              }
+            } else {
+              retvals[i]->Poison(status);
             }
-          } else {
-            retvals[i]->Poison(status);
+            retvals[i]->Unref();
           }
-          retvals[i]->Unref();
         }
         done(status);
         delete response;
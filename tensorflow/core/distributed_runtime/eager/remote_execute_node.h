@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_REMOTE_EXECUTE_NODE_H_
 
 #include <cstddef>
+#include <vector>
 
 #include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/device.h"
@@ -33,7 +34,9 @@ namespace tensorflow {
 namespace eager {
 
 // RemoteExecuteNode is an implementation of EagerNode which enqueues
-// an operation via RPC in a remote EagerService.
+// an operation via RPC in a remote EagerService. In async mode, consecutive
+// RemoteExecuteNodes for the same remote worker are batched into a single
+// EnqueueRequest.
 class RemoteExecuteNode : public AsyncEagerNode {
  public:
   RemoteExecuteNode(std::unique_ptr<EnqueueRequest> request, Device* device,
@@ -78,6 +81,13 @@ class RemoteExecuteNode : public AsyncEagerNode {
 
   void RunAsync(StatusCallback done) override;
 
+  // Nodes using the same EagerClient enqueue their operations on the same
+  // remote worker and context.
+  const void* BatchKey() const override { return eager_client_; }
+
+  void RunBatchAsync(const std::vector<AsyncEagerNode*>& others,
+                     StatusCallback done) override;
+
   void Abort(Status status) override {
     for (auto handle : retvals_) {
       handle->Poison(status);
@@ -290,6 +290,7 @@ Status GraphMgr::Register(
     const string& handle, const GraphDef& gdef, WorkerSession* session,
     const GraphOptions& graph_options, const DebugOptions& debug_options,
     const ConfigProto& config_proto, int64 collective_graph_key,
+    const std::vector<string>& recv_keys,
     DistributedFunctionLibraryRuntime* cluster_flr, string* graph_handle) {
   Item* item = new Item;
   Status s = InitItem(handle, gdef, session, graph_options, debug_options,
@@ -298,6 +299,7 @@ Status GraphMgr::Register(
     item->Unref();
     return s;
   }
+  item->recv_keys = recv_keys;
 
   // Inserts one item into table_.
   {
@@ -309,6 +311,20 @@ Status GraphMgr::Register(
   return Status::OK();
 }
 
+Status GraphMgr::AddRegisteredRecvKeys(const string& handle,
+                                       NamedTensors* out) {
+  static Tensor empty_tensor(DT_FLOAT);
+  mutex_lock l(mu_);
+  auto iter = table_.find(handle);
+  if (iter == table_.end()) {
+    return errors::Aborted("Graph handle is not found: ", handle);
+  }
+  for (const string& key : iter->second->recv_keys) {
+    out->insert({key, empty_tensor});
+  }
+  return Status::OK();
+}
+
 Status GraphMgr::Deregister(const string& handle) {
   Item* item = nullptr;
   // Removes one item from table_.
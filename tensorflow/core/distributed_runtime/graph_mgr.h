@@ -72,20 +72,27 @@ class GraphMgr {
   explicit GraphMgr(const WorkerEnv* worker_env, DeviceMgr* device_mgr);
   ~GraphMgr();
 
+  typedef std::map<string, Tensor> NamedTensors;
+
   // Registers a graph. Fills in "handle". The registered graph retains a
   // reference to cluster_flr to do cross process function calls.
+  // "recv_keys" are the keys returned by the steps that ask for the
+  // registered keys (see AddRegisteredRecvKeys).
   Status Register(const string& handle, const GraphDef& gdef,
                   WorkerSession* session, const GraphOptions& graph_options,
                   const DebugOptions& debug_options,
                   const ConfigProto& config_proto, int64 collective_graph_key,
+                  const std::vector<string>& recv_keys,
                   DistributedFunctionLibraryRuntime* cluster_flr,
                   string* graph_handle);
 
+  // Adds the keys the graph "handle" was registered with to "out".
+  Status AddRegisteredRecvKeys(const string& handle, NamedTensors* out);
+
   // Executes one step of a registered graph "handle".
   //
   // If "out" is not nullptr, "out" specifies all keys the execution
   // should receive upon finish.
-  typedef std::map<string, Tensor> NamedTensors;
   typedef std::function<void(const Status&)> StatusCallback;
   void ExecuteAsync(const string& handle, const int64 step_id,
                     WorkerSession* session, const ExecutorOpts& opts,
@@ -142,6 +149,9 @@ class GraphMgr {
     GraphMgr* graph_mgr;
 
     int64 collective_graph_key;
+
+    // The rendezvous keys returned by steps that use the registered keys.
+    std::vector<string> recv_keys;
   };
 
   const WorkerEnv* worker_env_;  // Not owned.
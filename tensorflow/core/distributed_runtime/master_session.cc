@@ -20,6 +20,7 @@ limitations under the License.
 #include <unordered_set>
 #include <vector>
 
+#include "tensorflow/core/common_runtime/metrics.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/profile_handler.h"
 #include "tensorflow/core/common_runtime/stats_publisher_interface.h"
@@ -56,9 +57,27 @@ limitations under the License.
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Returns true if the partitions of a step that produce no fetches may keep
+// running after the step has returned to the client. Opt in by setting
+// TF_PIPELINE_TRAILING_PARTITIONS=1.
+bool PipelineTrailingPartitions() {
+  bool pipeline = false;
+  Status status =
+      ReadBoolFromEnvVar("TF_PIPELINE_TRAILING_PARTITIONS", false, &pipeline);
+  if (!status.ok()) {
+    LOG(ERROR) << status.error_message();
+  }
+  return pipeline;
+}
+
+}  // namespace
+
 // MasterSession wraps ClientGraph in a reference counted object.
 // This way, MasterSession can clear up the cache mapping Run requests to
 // compiled graphs while the compiled graph is still being used.
@@ -81,7 +100,8 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
         worker_cache_(worker_cache),
         should_deregister_(should_deregister),
         collective_graph_key_(
-            client_graph_before_register_->collective_graph_key) {
+            client_graph_before_register_->collective_graph_key),
+        pipeline_trailing_partitions_(PipelineTrailingPartitions()) {
     VLOG(1) << "Created ReffedClientGraph for node with "
             << client_graph_before_register_->graph.num_node_ids();
 
@@ -247,6 +267,13 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
   const int64 collective_graph_key_;
   std::atomic<int64> execution_count_ = {0};
 
+  // If true, a step returns as soon as its partitions that produce fetches are
+  // done, and its other "trailing" partitions (e.g. the ones that update
+  // variables on parameter servers) keep running. Each partition of a later
+  // step starts once the same partition of the earlier steps is done, so a
+  // straggling worker only delays the partitions that depend on it.
+  const bool pipeline_trailing_partitions_;
+
   // Graph partitioned into per-location subgraphs.
   struct Part {
     // Worker name.
@@ -265,6 +292,10 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
     // this partition on the worker.
     string graph_handle;
 
+    // True if the worker remembers the keys of key_fetch, which then need
+    // not be sent with every full RunGraph request.
+    bool recv_keys_registered = false;
+
     Part() : feed_key(3), key_fetch(3) {}
   };
 
@@ -283,6 +314,25 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
   // init_result_ remembers the initialization error if any.
   Status init_result_ GUARDED_BY(mu_);
 
+  // The trailing partitions of the pipelined steps that are still running,
+  // keyed by step id.
+  struct TrailingPartitions;
+  std::unordered_map<int64, std::shared_ptr<TrailingPartitions>>
+      trailing_steps_ GUARDED_BY(mu_);
+
+  // For each partition, notified when its latest trailing run is done.
+  std::vector<std::shared_ptr<Notification>> trailing_partition_done_
+      GUARDED_BY(mu_);
+
+  // The error of a trailing partition that failed after its step returned,
+  // which is reported by the next step.
+  Status trailing_status_ GUARDED_BY(mu_);
+
+  // Called when a trailing partition of `step_id`, or the step itself, is
+  // done. Once all of them are, reports errors, unblocks the next steps and
+  // runs the deferred cleanup of the step.
+  void TrailingPartitionDone(int64 step_id, TrailingPartitions* trailing);
+
   std::unique_ptr<StatsPublisherInterface> stats_publisher_;
 
   string DetailText(const NodeDetails& details, const NodeExecStats& stats) {
@@ -477,6 +527,9 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
     *c->req.mutable_debug_options() =
         callable_opts_.run_options().debug_options();
     c->req.set_collective_graph_key(collective_graph_key_);
+    for (const auto& key_fetch : part.key_fetch) {
+      c->req.add_recv_key(key_fetch.first);
+    }
     VLOG(2) << "Register " << c->req.graph_def().DebugString();
     auto cb = [c, &done](const Status& s) {
       c->status = s;
@@ -489,6 +542,7 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
     Call* c = &calls[i];
     s.Update(c->status);
     partitions_[i].graph_handle = c->resp.graph_handle();
+    partitions_[i].recv_keys_registered = c->resp.recv_keys_registered();
   }
   return s;
 }
@@ -505,12 +559,14 @@ class RunManyGraphs {
     CallOptions opts;
     std::unique_ptr<MutableRunGraphRequestWrapper> req;
     std::unique_ptr<MutableRunGraphResponseWrapper> resp;
+    uint64 start_micros = 0;
   };
   Call* get(int index) { return &calls_[index]; }
 
   // When the index-th call is done, updates the overall status.
   void WhenDone(int index, const std::string& worker_name, const Status& s) {
     TRACEPRINTF("Partition %d %s", index, s.ToString().c_str());
+    RecordTime(index, worker_name);
     auto resp = get(index)->resp.get();
     if (resp->status_code() != error::Code::OK) {
       // resp->status_code will only be non-OK if s.ok().
@@ -548,6 +604,23 @@ class RunManyGraphs {
   mutable mutex mu_;
   StatusGroup status_group_ GUARDED_BY(mu_);
   bool cancel_issued_ GUARDED_BY(mu_) = false;
+  int num_done_ GUARDED_BY(mu_) = 0;
+  uint64 first_done_micros_ GUARDED_BY(mu_) = 0;
+
+  // Records the latency of the index-th call, and once all the calls are done,
+  // how long the last one finished after the first one.
+  void RecordTime(int index, const std::string& worker_name) {
+    const uint64 now_micros = Env::Default()->NowMicros();
+    metrics::UpdateWorkerRunGraphTime(worker_name,
+                                      now_micros - get(index)->start_micros);
+    mutex_lock l(mu_);
+    if (num_done_++ == 0) {
+      first_done_micros_ = now_micros;
+    }
+    if (num_done_ == static_cast<int>(calls_.size())) {
+      metrics::UpdateStepStragglerTime(now_micros - first_done_micros_);
+    }
+  }
 
   void ReportBadStatus(const Status& s) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     VLOG(1) << "Master received error status " << s;
@@ -568,6 +641,57 @@ class RunManyGraphs {
   TF_DISALLOW_COPY_AND_ASSIGN(RunManyGraphs);
 };
 
+// The partitions of a pipelined step that produce no fetches, which may still
+// be running after the step has returned.
+struct MasterSession::ReffedClientGraph::TrailingPartitions {
+  TrailingPartitions(std::shared_ptr<RunManyGraphs> calls, int num_trailing)
+      : calls(std::move(calls)), pending(num_trailing + 1) {}
+
+  const std::shared_ptr<RunManyGraphs> calls;
+
+  // The number of trailing partitions that are running, plus one until the
+  // step has returned.
+  std::atomic<int> pending;
+
+  // Notified when the trailing partitions are done.
+  std::vector<std::shared_ptr<Notification>> done;
+
+  // Set by the step before it returns. If the step failed, it has already
+  // reported the errors of its trailing partitions.
+  bool step_failed = false;
+
+  // The cleanup of the step, if it was requested before the trailing
+  // partitions were done. Guarded by the mutex of the ReffedClientGraph.
+  std::function<void()> cleanup;
+};
+
+void MasterSession::ReffedClientGraph::TrailingPartitionDone(
+    int64 step_id, TrailingPartitions* trailing) {
+  if (trailing->pending.fetch_sub(1) != 1) return;
+
+  const Status status = trailing->calls->status();
+  std::function<void()> cleanup;
+  {
+    mutex_lock l(mu_);
+    if (!trailing->step_failed && !status.ok()) {
+      LOG(WARNING) << "A trailing partition of step " << step_id
+                   << " failed after the step returned: " << status;
+      trailing_status_.Update(status);
+    }
+    cleanup = std::move(trailing->cleanup);
+    trailing_steps_.erase(step_id);
+  }
+  for (const auto& done : trailing->done) {
+    done->Notify();
+  }
+  if (cleanup) {
+    cleanup();
+  }
+  // Releases the reference taken when the trailing partitions were started,
+  // which may delete *this.
+  Unref();
+}
+
 namespace {
 Status AddSendFromClientRequest(const RunStepRequestWrapper& client_req,
                                 MutableRunGraphRequestWrapper* worker_req,
@@ -629,12 +753,16 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
     pss->step_stats.resize(partitions_.size());
   }
 
+  // The options are left out of the requests of the common steps that set
+  // none of them.
+  const bool has_exec_opts = exec_opts.ByteSizeLong() > 0;
+
   const int num = partitions_.size();
-  RunManyGraphs calls(num);
+  auto calls = std::make_shared<RunManyGraphs>(num);
 
   for (int i = 0; i < num; ++i) {
     const Part& part = partitions_[i];
-    RunManyGraphs::Call* c = calls.get(i);
+    RunManyGraphs::Call* c = calls->get(i);
     c->req.reset(part.worker->CreateRunGraphRequest());
     c->resp.reset(part.worker->CreateRunGraphResponse());
     if (is_partial_) {
@@ -645,7 +773,9 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
     c->req->set_create_worker_session_called(!should_deregister_);
     c->req->set_graph_handle(part.graph_handle);
     c->req->set_step_id(step_id);
-    *c->req->mutable_exec_opts() = exec_opts;
+    if (has_exec_opts) {
+      *c->req->mutable_exec_opts() = exec_opts;
+    }
     c->req->set_store_errors_in_response_body(true);
     c->req->set_request_id(GetUniqueRequestId());
     // If any feeds are provided, send the feed values together
@@ -687,49 +817,144 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
         TF_RETURN_IF_ERROR(
             AddSendFromClientRequest(req, c->req.get(), feed_index, key));
       }
-      for (const auto& key_fetch : part.key_fetch) {
-        const string& key = key_fetch.first;
-        c->req->add_recv_key(key);
+      if (part.recv_keys_registered) {
+        // The worker fetches the keys it was registered with.
+        c->req->set_use_registered_recv_keys(!part.key_fetch.empty());
+      } else {
+        for (const auto& key_fetch : part.key_fetch) {
+          const string& key = key_fetch.first;
+          c->req->add_recv_key(key);
+        }
       }
     }
   }
 
-  // Issues RunGraph calls.
-  for (int i = 0; i < num; ++i) {
+  // In the pipelined mode, the partitions that produce no fetches trail: the
+  // step does not wait for them, and its cleanup is deferred until they are
+  // done. Steps that need their statistics, partial runs and collectives wait
+  // for all the partitions, as does a step without any fetches.
+  std::vector<bool> trailing(num, false);
+  int num_trailing = 0;
+  if (pipeline_trailing_partitions_ && !is_partial_ && !pss->collect_costs &&
+      !pss->collect_timeline && !pss->collect_rpcs &&
+      !pss->collect_partition_graphs &&
+      collective_graph_key_ == BuildGraphOptions::kNoCollectiveGraphKey) {
+    for (int i = 0; i < num; ++i) {
+      if (partitions_[i].key_fetch.empty()) {
+        trailing[i] = true;
+        ++num_trailing;
+      }
+    }
+    if (num_trailing == num) {
+      trailing.assign(num, false);
+      num_trailing = 0;
+    }
+  }
+
+  // A partition waits for its trailing run in an earlier step to be done.
+  std::vector<std::shared_ptr<Notification>> predecessors(num);
+  std::shared_ptr<TrailingPartitions> trailing_partitions;
+  if (pipeline_trailing_partitions_) {
+    mutex_lock l(mu_);
+    if (!trailing_status_.ok()) {
+      const Status s = trailing_status_;
+      trailing_status_ = Status::OK();
+      return Status(s.code(),
+                    strings::StrCat("A trailing partition of an earlier step "
+                                    "failed after the step returned: ",
+                                    s.error_message()));
+    }
+    trailing_partition_done_.resize(num);
+    if (num_trailing > 0) {
+      trailing_partitions =
+          std::make_shared<TrailingPartitions>(calls, num_trailing);
+    }
+    for (int i = 0; i < num; ++i) {
+      std::shared_ptr<Notification>& done = trailing_partition_done_[i];
+      if (done != nullptr && !done->HasBeenNotified()) {
+        predecessors[i] = done;
+      }
+      if (trailing[i]) {
+        done = std::make_shared<Notification>();
+        trailing_partitions->done.push_back(done);
+      }
+    }
+    if (trailing_partitions != nullptr) {
+      trailing_steps_[step_id] = trailing_partitions;
+      // Keeps the partitions alive until the trailing partitions are done.
+      Ref();
+    }
+  }
+
+  // Issues RunGraph calls, first to the partitions that are not waiting for
+  // an earlier step.
+  BlockingCounter fetch_partitions_done(num - num_trailing);
+  auto issue = [&](int i) {
     const Part& part = partitions_[i];
-    RunManyGraphs::Call* call = calls.get(i);
+    RunManyGraphs::Call* call = calls->get(i);
     TRACEPRINTF("Partition %d %s", i, part.name.c_str());
+    call->start_micros = Env::Default()->NowMicros();
+    StatusCallback done;
+    if (trailing[i]) {
+      done = [this, step_id, calls, trailing_partitions, i,
+              name = part.name](const Status& s) {
+        calls->WhenDone(i, name, s);
+        TrailingPartitionDone(step_id, trailing_partitions.get());
+      };
+    } else {
+      done = [calls, &fetch_partitions_done, i,
+              name = part.name](const Status& s) {
+        calls->WhenDone(i, name, s);
+        fetch_partitions_done.DecrementCount();
+      };
+    }
     part.worker->RunGraphAsync(&call->opts, call->req.get(), call->resp.get(),
-                               std::bind(&RunManyGraphs::WhenDone, &calls, i,
-                                         part.name, std::placeholders::_1));
+                               std::move(done));
+  };
+  for (int i = 0; i < num; ++i) {
+    if (predecessors[i] == nullptr) issue(i);
+  }
+  for (int i = 0; i < num; ++i) {
+    if (predecessors[i] != nullptr) {
+      predecessors[i]->WaitForNotification();
+      issue(i);
+    }
   }
 
   // Waits for the RunGraph calls.
-  call_opts->SetCancelCallback([&calls]() {
+  call_opts->SetCancelCallback([calls]() {
     LOG(INFO) << "Client requested cancellation for RunStep, cancelling "
                   "worker operations.";
-    calls.StartCancel();
+    calls->StartCancel();
   });
   auto token = cm->get_cancellation_token();
   const bool success =
-      cm->RegisterCallback(token, [&calls]() { calls.StartCancel(); });
+      cm->RegisterCallback(token, [calls]() { calls->StartCancel(); });
   if (!success) {
-    calls.StartCancel();
+    calls->StartCancel();
   }
-  calls.Wait();
+  fetch_partitions_done.Wait();
   call_opts->ClearCancelCallback();
   if (success) {
+    // The trailing partitions are not cancelled with the session once the
+    // step has returned, so that Close() lets them finish: it waits for the
+    // cleanup of their step, which is deferred until they are done.
     cm->DeregisterCallback(token);
-  } else {
-    return errors::Cancelled("Step was cancelled");
   }
-  TF_RETURN_IF_ERROR(calls.status());
+  const Status calls_status =
+      success ? calls->status() : errors::Cancelled("Step was cancelled");
+  if (trailing_partitions != nullptr) {
+    trailing_partitions->step_failed = !calls_status.ok();
+    TrailingPartitionDone(step_id, trailing_partitions.get());
+  }
+  TF_RETURN_IF_ERROR(calls_status);
 
   // Collects fetches and metadata.
   Status status;
   for (int i = 0; i < num; ++i) {
+    if (trailing[i]) continue;
     const Part& part = partitions_[i];
-    MutableRunGraphResponseWrapper* run_graph_resp = calls.get(i)->resp.get();
+    MutableRunGraphResponseWrapper* run_graph_resp = calls->get(i)->resp.get();
     for (size_t j = 0; j < run_graph_resp->num_recvs(); ++j) {
       auto iter = part.key_fetch.find(run_graph_resp->recv_key(j));
       if (iter == part.key_fetch.end()) {
@@ -887,6 +1112,18 @@ class CleanupBroadcastHelper {
 
 void MasterSession::ReffedClientGraph::CleanupPartitionsAsync(
     int64 step_id, StatusCallback done) {
+  {
+    mutex_lock l(mu_);
+    auto iter = trailing_steps_.find(step_id);
+    if (iter != trailing_steps_.end()) {
+      // Cleaning up the step would abort the rendezvous of its trailing
+      // partitions, so the cleanup waits for them.
+      iter->second->cleanup = [this, step_id, done]() {
+        CleanupPartitionsAsync(step_id, done);
+      };
+      return;
+    }
+  }
   const int num = partitions_.size();
   // Helper object will be deleted when the final call completes.
   CleanupBroadcastHelper* helper =
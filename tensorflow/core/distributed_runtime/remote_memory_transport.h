@@ -0,0 +1,71 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_REMOTE_MEMORY_TRANSPORT_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_REMOTE_MEMORY_TRANSPORT_H_
+
+#include "google/protobuf/any.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// RemoteMemoryTransport moves the contents of large tensors between
+// workers out of band (e.g. with one-sided RDMA operations), while the
+// RecvTensor RPC only carries the tensor metadata.
+//
+// The receiver marks a RecvTensorRequest with `dma_ok` when the tensor is
+// destined for host memory.  For such requests the sender calls
+// TransportOptionsFromTensor() and, if it succeeds, replies with the dtype
+// and shape of the tensor plus the returned `transport_options` instead of
+// its contents.  The receiver allocates the destination tensor from the
+// device allocator and calls TensorFromTransportOptions() to fill it in.
+//
+// Implementations typically register the host allocator regions with the
+// NIC up front through ProcessState::AddCPUAllocVisitor(), so that both
+// the sent and the received tensors are already in registered memory.
+class RemoteMemoryTransport {
+ public:
+  virtual ~RemoteMemoryTransport() {}
+
+  // Tensors with fewer bytes than this are sent in the RPC response.
+  virtual int64 MinTensorBytes() const { return 64 << 10; }
+
+  // Sender side.  Makes the contents of "tensor" available to the remote
+  // worker that sent a RecvTensorRequest with "request_options", and
+  // describes how to access them in "*transport_options".  The transport
+  // keeps a reference to the tensor until the transfer completes.
+  //
+  // If this returns an error, the tensor is sent in the RPC response.
+  virtual Status TransportOptionsFromTensor(
+      const Tensor& tensor, const ::google::protobuf::Any& request_options,
+      ::google::protobuf::Any* transport_options) = 0;
+
+  // Receiver side.  Fills "*tensor", which has been allocated with the
+  // dtype and shape from the response, with the remote contents described
+  // by "transport_options", then calls "done".
+  virtual void TensorFromTransportOptions(
+      const ::google::protobuf::Any& transport_options, Tensor* tensor,
+      StatusCallback done) = 0;
+
+  // Receiver side.  Optionally describes this worker in "*request_options",
+  // which is sent to the remote worker in the RecvTensorRequest.
+  virtual void FillRequestOptions(::google::protobuf::Any* request_options) {}
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_REMOTE_MEMORY_TRANSPORT_H_
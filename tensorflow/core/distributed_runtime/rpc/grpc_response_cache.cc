@@ -93,6 +93,26 @@ void GrpcResponseCache::OnRequestFinished(int64 request_id,
   }
 }
 
+bool GrpcResponseCache::LookupFinished(int64 request_id, int64 max_bytes,
+                                       Tensor* tensor, bool* is_dead,
+                                       Status* status) {
+  mutex_lock m(mu_);
+  auto it = response_cache_.find(request_id);
+  if (it == response_cache_.end()) {
+    return false;
+  }
+  const ResponseCacheEntry& entry = it->second;
+  if (entry.state != ResponseCacheEntry::State::FINISHED ||
+      entry.tensor.TotalBytes() > max_bytes) {
+    return false;
+  }
+  VLOG(1) << "Reuse cached response for " << request_id;
+  *tensor = entry.tensor;
+  *is_dead = entry.is_dead;
+  *status = entry.response_status;
+  return true;
+}
+
 void GrpcResponseCache::EraseRequestId(int64 request_id) {
   mutex_lock m(mu_);
   response_cache_.erase(request_id);
@@ -58,6 +58,12 @@ class GrpcResponseCache {
   void OnRequestFinished(int64 request_id, const Tensor& tensor, bool is_dead,
                          const Status& status);
 
+  // If the request is finished and its tensor holds at most `max_bytes`,
+  // copies the cached response out and returns true.  Otherwise returns
+  // false and leaves the cache unchanged.
+  bool LookupFinished(int64 request_id, int64 max_bytes, Tensor* tensor,
+                      bool* is_dead, Status* status);
+
   // Erase the cache entry with the given request_id
   void EraseRequestId(int64 request_id);
 
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/master.h"
 #include "tensorflow/core/distributed_runtime/master_env.h"
 #include "tensorflow/core/distributed_runtime/master_session.h"
+#include "tensorflow/core/distributed_runtime/remote_memory_transport.h"
 #include "tensorflow/core/distributed_runtime/rpc/async_service_interface.h"
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_service_impl.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_channel.h"
@@ -91,6 +92,7 @@ GrpcServer::~GrpcServer() {
 
   // Shut down all outstanding rendezvous.
   delete worker_env_.rendezvous_mgr;
+  delete worker_env_.remote_memory_transport;
 
   // We must delete graph_mgr before device_mgr, due to shared
   // ownership of OpKernels in the executors. (The graph_mgr will
@@ -175,6 +177,10 @@ Status GrpcServer::Init(const GrpcServerOptions& opts) {
   worker_env_.rendezvous_mgr = opts.rendezvous_mgr_func == nullptr
                                    ? new RpcRendezvousMgr(&worker_env_)
                                    : opts.rendezvous_mgr_func(&worker_env_);
+  if (opts.remote_memory_transport_func != nullptr) {
+    worker_env_.remote_memory_transport =
+        opts.remote_memory_transport_func(&worker_env_);
+  }
   string unused;
   string default_worker_name;
   if (!DeviceNameUtils::SplitDeviceName(master_env_.local_devices[0]->name(),
@@ -209,8 +215,19 @@ Status GrpcServer::Init(const GrpcServerOptions& opts) {
   master_service_ = NewGrpcMasterService(master_impl_.get(), config, &builder);
   worker_impl_ = opts.worker_func ? opts.worker_func(&worker_env_, config)
                                   : NewGrpcWorker(&worker_env_, config);
+  GrpcWorkerServiceOptions worker_service_options = opts.worker_service_options;
+  if (config.rpc_options().num_worker_service_queues() > 0) {
+    worker_service_options.num_serving_threads =
+        config.rpc_options().num_worker_service_queues();
+  }
+  if (config.rpc_options().num_worker_service_threads_per_queue() > 0) {
+    worker_service_options.num_threads_per_queue =
+        config.rpc_options().num_worker_service_threads_per_queue();
+  }
+  worker_service_options.use_numa_affinity |=
+      config.experimental().use_numa_affinity();
   worker_service_ = NewGrpcWorkerService(worker_impl_.get(), &builder,
-                                         opts.worker_service_options)
+                                         worker_service_options)
                         .release();
   eager_service_ = new eager::GrpcEagerServiceImpl(&worker_env_, &builder);
 
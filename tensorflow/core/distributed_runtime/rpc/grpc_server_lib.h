@@ -45,6 +45,10 @@ class Master;
 typedef std::function<RendezvousMgrInterface*(const WorkerEnv*)>
     RendezvousMgrCreationFunction;
 
+// function that creates a RemoteMemoryTransport.
+typedef std::function<RemoteMemoryTransport*(const WorkerEnv*)>
+    RemoteMemoryTransportCreationFunction;
+
 // function that creates a CollectiveExecutorMgr.
 typedef std::function<CollectiveExecutorMgrInterface*(
     const ConfigProto&, const WorkerEnv*, WorkerCacheInterface*)>
@@ -63,6 +67,7 @@ typedef std::function<std::unique_ptr<GrpcWorker>(WorkerEnv*,
 struct GrpcServerOptions {
   ServiceInitFunction service_func = nullptr;
   RendezvousMgrCreationFunction rendezvous_mgr_func = nullptr;
+  RemoteMemoryTransportCreationFunction remote_memory_transport_func = nullptr;
   CollectiveMgrCreationFunction collective_mgr_func = nullptr;
   WorkerCreationFunction worker_func = nullptr;
   StatsPublisherFactory stats_factory = CreateNoOpStatsPublisher;
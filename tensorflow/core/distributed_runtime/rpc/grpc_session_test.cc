@@ -862,6 +862,73 @@ TEST(SessionTest, SharedVar) {
   }
 }
 
+TEST(SessionTest, PipelinedTrailingPartitions) {
+  // The partition on dev_b produces no fetches, so the steps return without
+  // waiting for it.
+  setenv("TF_PIPELINE_TRAILING_PARTITIONS", "1", 1);
+  std::unique_ptr<test::TestCluster> cluster;
+  TF_CHECK_OK(test::TestCluster::MakeTestCluster(Devices(1, 0), 2, &cluster));
+  unsetenv("TF_PIPELINE_TRAILING_PARTITIONS");
+  const string master = cluster->targets()[0];
+  const string& dev_a = cluster->devices()[0].name();
+  const string& dev_b = cluster->devices()[1].name();
+
+  GraphDef gdef;
+  string init_name;
+  string inc_name;
+  string fetch_name;
+  string get_name;
+  {
+    Graph g(OpRegistry::Global());
+    Tensor one(DT_FLOAT, TensorShape({}));
+    one.scalar<float>()() = 1.0;
+    Node* var = test::graph::Var(&g, DT_FLOAT, one.shape());
+    var->set_assigned_device_name(dev_b);
+    get_name = var->name();
+    Node* b_one = test::graph::Constant(&g, one);
+    b_one->set_assigned_device_name(dev_b);
+    Node* init = test::graph::Assign(&g, var, b_one);
+    init->set_assigned_device_name(dev_b);
+    init_name = init->name();
+    Node* delay = test::graph::Delay(&g, b_one, Microseconds(100000));
+    delay->set_assigned_device_name(dev_b);
+    Node* add = test::graph::Add(&g, var, delay);
+    add->set_assigned_device_name(dev_b);
+    Node* update = test::graph::Assign(&g, var, add);
+    update->set_assigned_device_name(dev_b);
+    inc_name = update->name();
+
+    Node* a_one = test::graph::Constant(&g, one);
+    a_one->set_assigned_device_name(dev_a);
+    Node* fetch = test::graph::Add(&g, a_one, a_one);
+    fetch->set_assigned_device_name(dev_a);
+    fetch_name = fetch->name();
+    test::graph::ToGraphDef(&g, &gdef);
+  }
+
+  {
+    std::unique_ptr<Session> session(NewRemote(Options(master, 1)));
+    TF_CHECK_OK(session->Create(gdef));
+    TF_CHECK_OK(session->Run({}, {}, {init_name}, nullptr));
+    for (int i = 0; i < 5; ++i) {
+      std::vector<Tensor> outputs;
+      TF_CHECK_OK(session->Run({}, {fetch_name}, {inc_name}, &outputs));
+      ASSERT_EQ(1, outputs.size());
+      IsSingleFloatValue(outputs[0], 2.0);
+    }
+    // Closing the session lets the trailing updates finish.
+    TF_CHECK_OK(session->Close());
+  }
+
+  std::unique_ptr<Session> session(NewRemote(Options(master, 1)));
+  TF_CHECK_OK(session->Create(gdef));
+  std::vector<Tensor> outputs;
+  TF_CHECK_OK(session->Run({}, {get_name}, {}, &outputs));
+  ASSERT_EQ(1, outputs.size());
+  IsSingleFloatValue(outputs[0], 6.0);
+  TF_CHECK_OK(session->Close());
+}
+
 void CreateInvalidGraph(const string& graph_def_ascii,
                         const string& error_substring) {
   GraphDef graph;
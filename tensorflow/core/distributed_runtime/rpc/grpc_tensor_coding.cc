@@ -15,10 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 
+#include <memory>
+
 #include "grpcpp/support/byte_buffer.h"
 #include "grpcpp/support/slice.h"
 #include "absl/flags/flag.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/bfloat16.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_reference.h"
@@ -26,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/io/proto_encode_helper.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
 ABSL_FLAG(bool, grpc_deepcopy_tensor_response, false, "Disables mem sharing");
@@ -137,8 +141,47 @@ static void EncodeSkeleton(const Tensor& val, io::ProtoEncodeHelper* e) {
 #endif
 }
 
+// Encodes the contents of "val" with "encoding" into "*encoded".  Returns
+// false if the encoding does not apply to "val" or does not shrink it.
+static bool EncodeTensorContent(const Tensor& val,
+                                RPCOptions::TensorEncoding encoding,
+                                string* encoded) {
+  switch (encoding) {
+    case RPCOptions::FLOAT16: {
+      if (val.dtype() != DT_FLOAT) return false;
+      const int64 n = val.NumElements();
+      encoded->resize(n * sizeof(Eigen::half));
+      Eigen::TensorMap<Eigen::Tensor<Eigen::half, 1, Eigen::RowMajor>> dst(
+          reinterpret_cast<Eigen::half*>(&(*encoded)[0]), n);
+      dst = val.flat<float>().cast<Eigen::half>();
+      return true;
+    }
+    case RPCOptions::BFLOAT16: {
+      if (val.dtype() != DT_FLOAT) return false;
+      const int64 n = val.NumElements();
+      encoded->resize(n * sizeof(bfloat16));
+      FloatToBFloat16(val.flat<float>().data(),
+                      reinterpret_cast<bfloat16*>(&(*encoded)[0]), n);
+      return true;
+    }
+    case RPCOptions::SNAPPY: {
+      StringPiece tdata = val.tensor_data();
+      return port::Snappy_Compress(tdata.data(), tdata.size(), encoded) &&
+             encoded->size() < tdata.size();
+    }
+    default:
+      return false;
+  }
+}
+
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
                               ::grpc::ByteBuffer* result) {
+  EncodeTensorToByteBuffer(is_dead, val, require_ack, RPCOptions::RAW, result);
+}
+
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
+                              RPCOptions::TensorEncoding encoding,
+                              ::grpc::ByteBuffer* result) {
   const int kLargeTensorBytes = 1024;
   RecvTensorResponse response;
   if (is_dead) {
@@ -162,6 +205,18 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
     EncodeSkeleton(val, &e_skeleton);
 
     StringPiece tdata = val.tensor_data();
+    // Holds the encoded contents of "val", if they are encoded.
+    std::unique_ptr<string> encoded;
+    if (encoding != RPCOptions::RAW && !is_dead &&
+        tdata.size() > kLargeTensorBytes) {
+      encoded.reset(new string);
+      if (EncodeTensorContent(val, encoding, encoded.get())) {
+        response.set_tensor_encoding(encoding);
+        tdata = *encoded;
+      } else {
+        encoded.reset();
+      }
+    }
     uint32 overall_tensor_proto_bytesize =
         (e_skeleton.size() +
          VarLengthEncodingSize(TensorProto::kTensorContentFieldNumber,
@@ -225,7 +280,15 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
       num_slices += 1;
     }
 
-    if (share_tensor_slice_memory) {
+    if (share_tensor_slice_memory && encoded != nullptr) {
+      // (E) Encode tensor data, handing the encoded string over to the slice
+      string* backing = encoded.release();
+      slices[1] = ::grpc::Slice(
+          &(*backing)[0], backing->size(),
+          [](void* backing) { delete static_cast<string*>(backing); },
+          backing);
+      num_slices += 1;
+    } else if (share_tensor_slice_memory) {
       // (E) Encode tensor data, but by sharing backing store
       const TensorBuffer* buf = DMAHelper::buffer(&val);
       buf->Ref();
@@ -100,4 +100,44 @@ TEST_F(GrpcTensorCodingTest, Simple) {
 
 TEST_F(GrpcTensorCodingTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+RecvTensorResponse EncodeAndParse(const Tensor& t,
+                                  RPCOptions::TensorEncoding encoding) {
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeTensorToByteBuffer(false, t, false, encoding, &buf);
+  std::vector<::grpc::Slice> slices;
+  (void)buf.Dump(&slices);
+  string tmp;
+  for (const auto& s : slices) {
+    tmp.append(reinterpret_cast<const char*>(s.begin()), s.size());
+  }
+  RecvTensorResponse response;
+  EXPECT_TRUE(response.ParseFromString(tmp));
+  return response;
+}
+
+TEST_F(GrpcTensorCodingTest, EncodedTensor) {
+  Tensor f(DT_FLOAT, TensorShape({4096}));
+  test::FillFn<float>(&f, [](int i) { return i % 16; });
+
+  for (auto encoding : {RPCOptions::FLOAT16, RPCOptions::BFLOAT16}) {
+    RecvTensorResponse response = EncodeAndParse(f, encoding);
+    EXPECT_EQ(response.tensor_encoding(), encoding);
+    EXPECT_EQ(response.tensor().dtype(), DT_FLOAT);
+    EXPECT_EQ(response.tensor().tensor_content().size(), 2 * 4096);
+  }
+
+  // Downcasts only apply to float tensors.
+  Tensor ints(DT_INT32, TensorShape({4096}));
+  test::FillFn<int32>(&ints, [](int i) { return i % 16; });
+  RecvTensorResponse response = EncodeAndParse(ints, RPCOptions::FLOAT16);
+  EXPECT_EQ(response.tensor_encoding(), RPCOptions::RAW);
+  EXPECT_EQ(response.tensor().tensor_content(), ints.tensor_data());
+
+  // Small tensors are sent raw.
+  Tensor small(DT_FLOAT, TensorShape({16}));
+  test::FillFn<float>(&small, [](int i) { return i; });
+  response = EncodeAndParse(small, RPCOptions::SNAPPY);
+  EXPECT_EQ(response.tensor_encoding(), RPCOptions::RAW);
+}
+
 }  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/lib/random/random.h"
 
 namespace tensorflow {
@@ -31,6 +32,25 @@ double GenerateUniformRandomNumberBetween(double a, double b) {
   return a + GenerateUniformRandomNumber() * (b - a);
 }
 
+// A TensorBuffer aliasing part of a received grpc::Slice.  Holding a
+// reference on the slice keeps its memory alive.
+class GrpcSliceBuffer : public TensorBuffer {
+ public:
+  GrpcSliceBuffer(const ::grpc::Slice& slice, const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)), slice_(slice), size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("grpc_slice");
+  }
+
+ private:
+  const ::grpc::Slice slice_;
+  const size_t size_;
+};
+
 }  // namespace
 
 int64 ComputeBackoffMicroseconds(int current_retry_attempt, int64 min_delay,
@@ -91,6 +111,21 @@ bool GrpcMaybeParseProto(::grpc::ByteBuffer* src, protobuf::Message* dst) {
   return dst->ParseFromZeroCopyStream(&reader);
 }
 
+TensorBuffer* GrpcByteSource::ShareBuffer(const char* data, size_t num_bytes) {
+  if (slices_.empty() && !buffer_->Dump(&slices_).ok()) {
+    return nullptr;
+  }
+  for (const ::grpc::Slice& slice : slices_) {
+    const char* begin = reinterpret_cast<const char*>(slice.begin());
+    const char* end = reinterpret_cast<const char*>(slice.end());
+    if (data >= begin && data + num_bytes <= end) {
+      return new GrpcSliceBuffer(slice, data, num_bytes);
+    }
+  }
+  // "data" points into a copy made by the reader, e.g. after decompression.
+  return nullptr;
+}
+
 // Overload of GrpcParseProto so we can decode a TensorResponse without
 // extra copying.  This overload is used by the RPCState class in
 // grpc_state.h.
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_UTIL_H_
 
 #include <memory>
+#include <vector>
 
 #include "grpcpp/grpcpp.h"
 #include "grpcpp/impl/codegen/proto_utils.h"
@@ -39,7 +40,9 @@ int64 ComputeBackoffMicroseconds(int current_retry_attempt,
                                  int64 max_delay = 10000000);
 
 // Thin wrapper around ::grpc::ProtoBufferReader to give TensorResponse an
-// efficient byte reader from which to decode a RecvTensorResponse.
+// efficient byte reader from which to decode a RecvTensorResponse.  Large
+// tensor contents that lie within a single slice of the ByteBuffer are
+// shared with the decoded tensor rather than copied.
 class GrpcByteSource : public TensorResponse::Source {
  public:
   explicit GrpcByteSource(::grpc::ByteBuffer* buffer) : buffer_(buffer) {}
@@ -53,6 +56,8 @@ class GrpcByteSource : public TensorResponse::Source {
     return stream_;
   }
 
+  TensorBuffer* ShareBuffer(const char* data, size_t num_bytes) override;
+
  private:
   void DeleteStream() {
     if (stream_) {
@@ -62,6 +67,7 @@ class GrpcByteSource : public TensorResponse::Source {
 
   ::grpc::ByteBuffer* buffer_;  // Not owned
   Reader* stream_ = nullptr;    // Points into space_ if non-nullptr
+  std::vector<::grpc::Slice> slices_;  // Filled in by ShareBuffer
   char space_[sizeof(Reader)];
 };
 
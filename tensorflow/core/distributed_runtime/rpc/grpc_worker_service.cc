@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service.h"
 
+#include <algorithm>
 #include <deque>
 #include <memory>
 #include <unordered_map>
@@ -32,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/distributed_runtime/graph_mgr.h"
+#include "tensorflow/core/distributed_runtime/remote_memory_transport.h"
 #include "tensorflow/core/distributed_runtime/rendezvous_mgr_interface.h"
 #include "tensorflow/core/distributed_runtime/rpc/async_service_interface.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_call.h"
@@ -52,6 +54,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/protobuf/transport_options.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
@@ -94,28 +97,43 @@ namespace {
   }
 
 // GrpcWorkerService spawns one or more GrpcWorkerServiceThreads to service
-// requests.  Each thread operates on an independent completion queue.
+// requests.  Each GrpcWorkerServiceThread operates on an independent
+// completion queue, which one or more threads poll.
 class GrpcWorkerServiceThread {
  public:
   explicit GrpcWorkerServiceThread(
       GrpcWorker* worker, ::grpc::ServerBuilder* builder,
       std::unordered_map<int, int> queue_depth, GrpcResponseCache* cache,
-      grpc::WorkerService::AsyncService* worker_service)
+      grpc::WorkerService::AsyncService* worker_service, int num_threads,
+      int numa_node)
       : worker_(worker),
         queue_depth_(queue_depth),
         cache_(cache),
         worker_service_(worker_service),
+        num_threads_(num_threads),
+        numa_node_(numa_node),
         is_shutdown_(false) {
     cq_ = builder->AddCompletionQueue();
   }
 
   void Start() {
-    thread_.reset(
-        worker_->env()->env->StartThread(ThreadOptions(), "grpc_worker_service",
-                                         [this]() { HandleRPCsLoop(); }));
+    // The first thread enqueues the requests, and all of them poll.
+    for (int i = 0; i < num_threads_; ++i) {
+      threads_.emplace_back(worker_->env()->env->StartThread(
+          ThreadOptions(), "grpc_worker_service", [this, i]() {
+            if (numa_node_ != port::kNUMANoAffinity) {
+              port::NUMASetThreadNodeAffinity(numa_node_);
+            }
+            if (i == 0) {
+              HandleRPCsLoop();
+            } else {
+              PollCompletionQueue();
+            }
+          }));
+    }
   }
 
-  void Join() { thread_.reset(); }  // Blocks until thread exits
+  void Join() { threads_.clear(); }  // Blocks until the threads exit
 
   void Shutdown() {
     {
@@ -158,6 +176,12 @@ class GrpcWorkerServiceThread {
       EnqueueRecvTensorRequestRaw();
     }
 
+    PollCompletionQueue();
+  }
+
+  // Handles the requests and completions of the completion queue until it
+  // is shut down.
+  void PollCompletionQueue() {
     void* tag;
     bool ok;
 
@@ -265,6 +289,15 @@ class GrpcWorkerServiceThread {
 
   void RecvTensorHandlerRaw(
       WorkerCall<RecvTensorRequest, ::grpc::ByteBuffer>* call) {
+    // Retried requests whose small responses are cached are answered here,
+    // without a round trip through the compute pool.
+    Status cached_status;
+    if (worker_->TryRecvTensorFromCache(&call->request, &call->response,
+                                        &cached_status)) {
+      call->SendResponse(ToGrpcStatus(cached_status));
+      EnqueueRecvTensorRequestRaw();
+      return;
+    }
     Schedule([this, call]() {
       CallOptions* call_opts = new CallOptions;
       call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
@@ -354,10 +387,12 @@ class GrpcWorkerServiceThread {
 
   GrpcWorker* const worker_ = nullptr;  // Not owned.
   std::unique_ptr<::grpc::ServerCompletionQueue> cq_;
-  std::unique_ptr<Thread> thread_;
+  std::vector<std::unique_ptr<Thread>> threads_;
   std::unordered_map<int, int> queue_depth_;
   GrpcResponseCache* cache_;
   grpc::WorkerService::AsyncService* const worker_service_;
+  const int num_threads_;
+  const int numa_node_;
 
   mutex shutdown_mu_;
   bool is_shutdown_ GUARDED_BY(shutdown_mu_);
@@ -371,10 +406,16 @@ class GrpcWorkerService : public AsyncServiceInterface {
       : is_shutdown_(false) {
     builder->RegisterService(&worker_service_);
 
+    const int num_numa_nodes =
+        options.use_numa_affinity && port::NUMAEnabled()
+            ? port::NUMANumNodes()
+            : 0;
     for (int i = 0; i < options.num_serving_threads; i++) {
-      threads_.emplace_back(
-          new GrpcWorkerServiceThread(worker, builder, options.queue_depth,
-                                      cache_.get(), &worker_service_));
+      const int numa_node =
+          num_numa_nodes > 0 ? i % num_numa_nodes : port::kNUMANoAffinity;
+      threads_.emplace_back(new GrpcWorkerServiceThread(
+          worker, builder, options.queue_depth, cache_.get(), &worker_service_,
+          std::max(options.num_threads_per_queue, 1), numa_node));
     }
   }
 
@@ -423,7 +464,8 @@ GrpcWorker::GrpcWorker(WorkerEnv* worker_env, const ConfigProto& config)
       recv_buf_max_chunk_(
           config.experimental().recv_buf_max_chunk() > 0
               ? config.experimental().recv_buf_max_chunk()
-              : (config.experimental().recv_buf_max_chunk() < 0 ? 0 : 4096)) {
+              : (config.experimental().recv_buf_max_chunk() < 0 ? 0 : 4096)),
+      recv_tensor_encoding_(config.rpc_options().recv_tensor_encoding()) {
   if (config.rpc_options().cache_rpc_response()) {
     EnableResponseCache();
   }
@@ -447,11 +489,12 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
 
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
 
-  auto do_response = [response, done, cache_enabled](const Tensor& tensor,
-                                                     bool is_dead,
-                                                     const Status& status) {
+  auto do_response = [this, request, response, done, cache_enabled](
+                         const Tensor& tensor, bool is_dead,
+                         const Status& status) {
     if (status.ok()) {
-      grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
+      EncodeRecvTensorResponse(*request, is_dead, tensor, cache_enabled,
+                               response);
     }
     done(status);
   };
@@ -555,6 +598,69 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
       });
 }
 
+bool GrpcWorker::TryRecvTensorFromCache(const RecvTensorRequest* request,
+                                        ::grpc::ByteBuffer* response,
+                                        Status* status) {
+  // Larger responses are encoded on the compute pool, so that copying them
+  // does not hold up the completion queue.
+  static constexpr int64 kMaxInlineResponseBytes = 4096;
+  if (response_cache_ == nullptr || request->request_id() == 0) {
+    return false;
+  }
+  Tensor tensor;
+  bool is_dead = false;
+  if (!response_cache_->LookupFinished(request->request_id(),
+                                       kMaxInlineResponseBytes, &tensor,
+                                       &is_dead, status)) {
+    return false;
+  }
+  if (status->ok()) {
+    EncodeRecvTensorResponse(*request, is_dead, tensor, /*require_ack=*/true,
+                             response);
+  }
+  return true;
+}
+
+void GrpcWorker::EncodeRecvTensorResponse(const RecvTensorRequest& request,
+                                          bool is_dead, const Tensor& tensor,
+                                          bool require_ack,
+                                          ::grpc::ByteBuffer* response) {
+  if (!MaybeEncodeTensorMetadataToByteBuffer(request, is_dead, tensor,
+                                             require_ack, response)) {
+    grpc::EncodeTensorToByteBuffer(is_dead, tensor, require_ack,
+                                   request.accept_encoded_tensor()
+                                       ? recv_tensor_encoding_
+                                       : RPCOptions::RAW,
+                                   response);
+  }
+}
+
+bool GrpcWorker::MaybeEncodeTensorMetadataToByteBuffer(
+    const RecvTensorRequest& request, bool is_dead, const Tensor& tensor,
+    bool require_ack, ::grpc::ByteBuffer* response) {
+  RemoteMemoryTransport* transport = env_->remote_memory_transport;
+  if (transport == nullptr || !request.dma_ok() || is_dead ||
+      !DataTypeCanUseMemcpy(tensor.dtype()) ||
+      tensor.TotalBytes() < transport->MinTensorBytes()) {
+    return false;
+  }
+  RecvTensorResponse proto;
+  Status s = transport->TransportOptionsFromTensor(
+      tensor, request.transport_options(), proto.mutable_transport_options());
+  if (!s.ok()) {
+    VLOG(1) << "Sending " << request.rendezvous_key()
+            << " in the RecvTensor response: " << s;
+    return false;
+  }
+  proto.set_require_ack(require_ack);
+  proto.set_send_start_micros(Env::Default()->NowMicros());
+  TensorProto* tensor_proto = proto.mutable_tensor();
+  tensor_proto->set_dtype(tensor.dtype());
+  tensor.shape().AsProto(tensor_proto->mutable_tensor_shape());
+  grpc::EncodeRecvTensorResponseToByteBuffer(proto, response);
+  return true;
+}
+
 namespace {
 // If RecvBufRespExtra.tensor_content is a single large string, then gRPC
 // can stall on the recv side when the string buffer needs to be enlarged,
@@ -62,9 +62,31 @@ class GrpcWorker : public Worker {
 
   void RemoveCacheEntryForId(int64 request_id);
 
+  // Fills in "*response" and "*status" and returns true if the response
+  // cache holds a finished response to "request" whose tensor is small
+  // enough to encode on the calling thread.  Returns false otherwise.
+  bool TryRecvTensorFromCache(const RecvTensorRequest* request,
+                              ::grpc::ByteBuffer* response, Status* status);
+
  private:
+  // Encodes "tensor" into "*response" as the answer to "request".
+  void EncodeRecvTensorResponse(const RecvTensorRequest& request,
+                                bool is_dead, const Tensor& tensor,
+                                bool require_ack,
+                                ::grpc::ByteBuffer* response);
+
+  // Encodes only the metadata of "tensor" into "*response" if its contents
+  // are sent through the worker's RemoteMemoryTransport.  Returns false if
+  // the contents have to be sent in the response.
+  bool MaybeEncodeTensorMetadataToByteBuffer(const RecvTensorRequest& request,
+                                             bool is_dead, const Tensor& tensor,
+                                             bool require_ack,
+                                             ::grpc::ByteBuffer* response);
+
   std::unique_ptr<GrpcResponseCache> response_cache_;
   const int32 recv_buf_max_chunk_;
+  // Encoding of tensors sent to receivers that accept encoded tensors.
+  const RPCOptions::TensorEncoding recv_tensor_encoding_;
 };
 
 std::unique_ptr<GrpcWorker> NewGrpcWorker(WorkerEnv* worker_env,
@@ -74,7 +96,13 @@ struct GrpcWorkerServiceOptions {
   // Map from GrpcWorkerMethod id to queue depth.  If set this overrides the
   // default queue depth for a method.
   std::unordered_map<int, int> queue_depth;
+  // The number of completion queues.
   int num_serving_threads = 8;
+  // The number of threads polling each completion queue.
+  int num_threads_per_queue = 1;
+  // If true, the threads of the i-th completion queue run on NUMA node
+  // i % port::NUMANumNodes().
+  bool use_numa_affinity = false;
 };
 
 // Returns an implementation of WorkerService rpc service.
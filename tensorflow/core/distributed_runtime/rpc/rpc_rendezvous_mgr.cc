@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/distributed_runtime/remote_memory_transport.h"
 #include "tensorflow/core/distributed_runtime/request_id.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
@@ -56,10 +57,12 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
 // Used only to retrieve tensors from remote processes.
 class RpcRecvTensorCall : public BaseRecvTensorCall {
  public:
-  RpcRecvTensorCall() : wi_(nullptr), dst_device_(nullptr) {}
+  RpcRecvTensorCall()
+      : wi_(nullptr), dst_device_(nullptr), transport_(nullptr) {}
 
   void Init(WorkerInterface* wi, int64 step_id, StringPiece key,
             AllocatorAttributes alloc_attrs, Device* dst_device,
+            RemoteMemoryTransport* transport,
             const Rendezvous::Args& recv_args, Rendezvous::DoneCallback done) {
     wi_ = wi;
     alloc_attrs_ = alloc_attrs;
@@ -69,6 +72,16 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     req_.set_step_id(step_id);
     req_.set_rendezvous_key(key.data(), key.size());
     req_.set_request_id(GetUniqueRequestId());
+    // TensorResponse decodes any encoding the sender applies.
+    req_.set_accept_encoded_tensor(true);
+    // The transport fills in host memory only; tensors for other devices
+    // are always sent in the RPC response.
+    if (transport != nullptr &&
+        (alloc_attrs.on_host() || dst_device->device_type() == DEVICE_CPU)) {
+      transport_ = transport;
+      req_.set_dma_ok(true);
+      transport_->FillRequestOptions(req_.mutable_transport_options());
+    }
   }
 
   void Reset() {
@@ -79,6 +92,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
 
     alloc_attrs_ = AllocatorAttributes();
     dst_device_ = nullptr;
+    transport_ = nullptr;
     // We don't clear opts_ and assume that Init will set up the state for
     // opts_ appropriately.
     req_.Clear();
@@ -137,6 +151,11 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   void StartRTCall(std::function<void()> recv_done) {
     resp_.InitAlloc(dst_device_, alloc_attrs_);
     auto cb = [this, recv_done = std::move(recv_done)](const Status& s) {
+      if (s.ok() && transport_ != nullptr && !is_dead() &&
+          resp_.metadata().has_transport_options()) {
+        FetchTensorContents(recv_done);
+        return;
+      }
       if (!s.ok()) {
         mutex_lock l(mu_);
         status_.Update(s);
@@ -146,11 +165,28 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     wi_->RecvTensorAsync(&opts_, &req_, &resp_, std::move(cb));
   }
 
+  // The response only carried the metadata of the tensor; fill in its
+  // contents through the out-of-band transport.
+  void FetchTensorContents(std::function<void()> recv_done) {
+    Tensor* tensor = new Tensor(resp_.tensor());
+    transport_->TensorFromTransportOptions(
+        resp_.metadata().transport_options(), tensor,
+        [this, tensor, recv_done = std::move(recv_done)](const Status& s) {
+          delete tensor;
+          if (!s.ok()) {
+            mutex_lock l(mu_);
+            status_.Update(s);
+          }
+          recv_done();
+        });
+  }
+
   string src_worker_;
   string src_rel_device_;
   WorkerInterface* wi_;  // Not owned.
   AllocatorAttributes alloc_attrs_;
   Device* dst_device_;
+  RemoteMemoryTransport* transport_;  // Not owned.
   CallOptions opts_;
   RecvTensorRequest req_;
   TensorResponse resp_;
@@ -247,7 +283,7 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
   }
 
   call->Init(rwi, step_id_, parsed.FullKey(), recv_args.alloc_attrs, dst_device,
-             recv_args, std::move(done));
+             env_->remote_memory_transport, recv_args, std::move(done));
 
   // Record "call" in active_ so that it can be aborted cleanly.
   RegisterCall(call, recv_args);
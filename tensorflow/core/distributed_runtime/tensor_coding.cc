@@ -15,16 +15,100 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include <algorithm>
+
 #include "google/protobuf/any.pb.h"
 
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/framework/bfloat16.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/platform/snappy.h"
 
 namespace tensorflow {
 
+namespace {
+// Tensor contents smaller than this are always copied: sharing them would
+// keep the whole received RPC buffer alive for little gain.
+constexpr int kMinSharedTensorContentBytes = 64 << 10;
+
+// Encoded float contents are decoded through a buffer of this size.
+constexpr int kDecodeChunkBytes = 16 << 10;
+
+// Decodes "num_elements" downcast floats at "encoded" into "dst".
+void DecodeFloats(RPCOptions::TensorEncoding encoding, const char* encoded,
+                  int64 num_elements, float* dst) {
+  if (encoding == RPCOptions::FLOAT16) {
+    Eigen::TensorMap<Eigen::Tensor<const Eigen::half, 1, Eigen::RowMajor>> src(
+        reinterpret_cast<const Eigen::half*>(encoded), num_elements);
+    Eigen::TensorMap<Eigen::Tensor<float, 1, Eigen::RowMajor>> out(
+        dst, num_elements);
+    out = src.cast<float>();
+  } else {
+    DCHECK_EQ(encoding, RPCOptions::BFLOAT16);
+    BFloat16ToFloat(reinterpret_cast<const bfloat16*>(encoded), dst,
+                    num_elements);
+  }
+}
+
+bool IsFloatDowncast(RPCOptions::TensorEncoding encoding) {
+  return encoding == RPCOptions::FLOAT16 || encoding == RPCOptions::BFLOAT16;
+}
+
+// Decodes the "encoded" contents of "*t", which has already been allocated.
+bool DecodeTensorContent(RPCOptions::TensorEncoding encoding,
+                         StringPiece encoded, Tensor* t) {
+  switch (encoding) {
+    case RPCOptions::FLOAT16:
+    case RPCOptions::BFLOAT16:
+      if (t->dtype() != DT_FLOAT ||
+          t->NumElements() * 2 != static_cast<int64>(encoded.size())) {
+        return false;
+      }
+      DecodeFloats(encoding, encoded.data(), t->NumElements(),
+                   t->flat<float>().data());
+      return true;
+    case RPCOptions::SNAPPY: {
+      if (!DataTypeCanUseMemcpy(t->dtype())) return false;
+      size_t length;
+      StringPiece buf = t->tensor_data();
+      return port::Snappy_GetUncompressedLength(encoded.data(), encoded.size(),
+                                                &length) &&
+             length == buf.size() &&
+             port::Snappy_Uncompress(encoded.data(), encoded.size(),
+                                     const_cast<char*>(buf.data()));
+    }
+    default:
+      return false;
+  }
+}
+
+// Replaces encoded tensor contents in "*meta" with the decoded contents.
+Status DecodeTensorProto(RecvTensorResponse* meta) {
+  if (meta->tensor_encoding() == RPCOptions::RAW) return Status::OK();
+  const TensorProto& proto = meta->tensor();
+  if (!DataTypeCanUseMemcpy(proto.dtype()) ||
+      !TensorShape::IsValid(proto.tensor_shape())) {
+    return errors::InvalidArgument("Cannot decode tensor from response");
+  }
+  Tensor decoded(proto.dtype(), TensorShape(proto.tensor_shape()));
+  if (!DecodeTensorContent(meta->tensor_encoding(), proto.tensor_content(),
+                           &decoded)) {
+    return errors::InvalidArgument("Cannot decode tensor from response");
+  }
+  decoded.AsProtoTensorContent(meta->mutable_tensor());
+  meta->set_tensor_encoding(RPCOptions::RAW);
+  return Status::OK();
+}
+}  // namespace
+
 TensorResponse::Source::~Source() {}
 
+TensorBuffer* TensorResponse::Source::ShareBuffer(const char* data,
+                                                  size_t num_bytes) {
+  return nullptr;
+}
+
 void TensorResponse::Clear() {
   on_host_ = false;
   device_ = nullptr;
@@ -51,13 +135,13 @@ void TensorResponse::InitAlloc(DeviceBase* d, const AllocatorAttributes& aa) {
 }
 
 Status TensorResponse::InitFrom(RecvTensorResponse* response) {
-  Status s;
   meta_.Swap(response);
-  if (on_host_) {
+  Status s = DecodeTensorProto(&meta_);
+  if (s.ok() && on_host_) {
     if (!tensor_.FromProto(allocator_, meta_.tensor())) {
       s = errors::InvalidArgument("Cannot parse tensor from response");
     }
-  } else {
+  } else if (s.ok()) {
     s = device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
   }
   {
@@ -88,8 +172,10 @@ Status TensorResponse::ParseFrom(Source* source) {
     if (!meta_.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage()) {
       return errors::InvalidArgument("Cannot parse tensor from response");
     }
-    Status s =
-        device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
+    Status s = DecodeTensorProto(&meta_);
+    if (s.ok()) {
+      s = device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
+    }
     // Reduce memory usage for big tensors.
     {
       TensorProto empty;
@@ -144,8 +230,71 @@ bool ReadNestedMessage(protobuf::io::CodedInputStream* input,
 
 }  // namespace
 
+bool TensorResponse::ReadEncodedTensorContent(
+    protobuf::io::CodedInputStream* input, const TensorShape& shape,
+    DataType dtype, int num_bytes) {
+  const RPCOptions::TensorEncoding encoding = meta_.tensor_encoding();
+  if (!DataTypeCanUseMemcpy(dtype)) return false;
+  Tensor t(allocator_, dtype, shape);
+  if (!IsFloatDowncast(encoding)) {
+    string encoded;
+    if (!input->ReadString(&encoded, num_bytes) ||
+        !DecodeTensorContent(encoding, encoded, &t)) {
+      return false;
+    }
+  } else {
+    // Decode straight from the stream, a chunk at a time.
+    const int kElementBytes = 2;
+    if (dtype != DT_FLOAT || t.NumElements() * kElementBytes != num_bytes) {
+      return false;
+    }
+    float* dst = t.flat<float>().data();
+    char chunk[kDecodeChunkBytes];
+    while (num_bytes > 0) {
+      const int bytes = std::min(num_bytes, kDecodeChunkBytes);
+      if (!input->ReadRaw(chunk, bytes)) return false;
+      DecodeFloats(encoding, chunk, bytes / kElementBytes, dst);
+      dst += bytes / kElementBytes;
+      num_bytes -= bytes;
+    }
+  }
+  tensor_ = std::move(t);
+  return true;
+}
+
+bool TensorResponse::ShareTensorContent(Source* source,
+                                        protobuf::io::CodedInputStream* input,
+                                        const TensorShape& shape,
+                                        DataType dtype, int num_bytes) {
+  // Memory that is later DMA-ed to a device or NIC must come from the
+  // allocator, which may hand out pinned or registered memory.
+  if (num_bytes < kMinSharedTensorContentBytes ||
+      alloc_attrs_.gpu_compatible() || alloc_attrs_.nic_compatible()) {
+    return false;
+  }
+  if (static_cast<int64>(num_bytes) !=
+      shape.num_elements() * DataTypeSize(dtype)) {
+    return false;
+  }
+  const void* data;
+  int size;
+  if (!input->GetDirectBufferPointer(&data, &size) || size < num_bytes ||
+      reinterpret_cast<intptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
+    return false;
+  }
+  TensorBuffer* buf =
+      source->ShareBuffer(static_cast<const char*>(data), num_bytes);
+  if (buf == nullptr) return false;
+  Tensor t(dtype, shape, buf);
+  buf->Unref();
+  if (!input->Skip(num_bytes)) return false;
+  tensor_ = std::move(t);
+  return true;
+}
+
 bool TensorResponse::ParseTensorSubmessage(
-    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta) {
+    Source* source, protobuf::io::CodedInputStream* input,
+    TensorProto* tensor_meta) {
   bool seen_tensor_content = false;
   while (true) {
     auto p = input->ReadTagWithCutoff(127);
@@ -196,12 +345,22 @@ bool TensorResponse::ParseTensorSubmessage(
         if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
         seen_tensor_content = true;
         TensorShape shape(tensor_meta->tensor_shape());
+        if (meta_.tensor_encoding() != RPCOptions::RAW) {
+          if (!ReadEncodedTensorContent(input, shape, tensor_meta->dtype(),
+                                        num_bytes)) {
+            return false;
+          }
+          break;
+        }
+        // Avoid the copy if the received bytes are contiguous, properly
+        // aligned, and can be kept alive by the source.
+        if (ShareTensorContent(source, input, shape, tensor_meta->dtype(),
+                               num_bytes)) {
+          break;
+        }
         Tensor t(allocator_, tensor_meta->dtype(), shape);
         StringPiece buf = t.tensor_data();
         if (static_cast<size_t>(num_bytes) != buf.size()) return false;
-        // TODO(jeff,sanjay): Figure out a way to avoid this copy if
-        // the underlying ZeroCopyInputStream data is properly aligned
-        // and compatible with what allocator_ wants.
         if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes))
           return false;
         tensor_ = std::move(t);
@@ -219,6 +378,7 @@ bool TensorResponse::ParseTensorSubmessage(
 bool TensorResponse::ParseFast(Source* source) {
   protobuf::io::CodedInputStream input(source->contents());
   input.SetTotalBytesLimit(INT_MAX, INT_MAX);  // Unlimited
+  bool seen_tensor = false;
   while (true) {
     auto p = input.ReadTagWithCutoff(127);
     int tag = GetTagFieldNumber(p.first);
@@ -235,12 +395,13 @@ bool TensorResponse::ParseFast(Source* source) {
         std::pair<protobuf::io::CodedInputStream::Limit, int> p =
             input.IncrementRecursionDepthAndPushLimit(length);
         if (p.second < 0 ||
-            !ParseTensorSubmessage(&input, meta_.mutable_tensor())) {
+            !ParseTensorSubmessage(source, &input, meta_.mutable_tensor())) {
           return false;
         }
         if (!input.DecrementRecursionDepthAndPopLimit(p.first)) {
           return false;
         }
+        seen_tensor = true;
         break;
       }
       case RecvTensorResponse::kIsDeadFieldNumber: {
@@ -267,6 +428,16 @@ bool TensorResponse::ParseFast(Source* source) {
         meta_.set_require_ack(v != 0);
         break;
       }
+      case RecvTensorResponse::kTensorEncodingFieldNumber: {
+        // The tensor can only be decoded on the fast path if its encoding
+        // comes first.
+        uint32 v;
+        if ((wt != WIRETYPE_VARINT) || !input.ReadVarint32(&v)) return false;
+        if (seen_tensor) return false;
+        meta_.set_tensor_encoding(
+            static_cast<RPCOptions::TensorEncoding>(static_cast<int>(v)));
+        break;
+      }
       default: {
         // Unknown tag, so don't handle we can't handle on the fast path
         return false;
@@ -281,6 +452,9 @@ bool TensorResponse::ParseSlow(Source* source) {
   if (!meta_.ParseFromZeroCopyStream(source->contents())) {
     return false;
   }
+  if (!DecodeTensorProto(&meta_).ok()) {
+    return false;
+  }
 
   Tensor parsed(meta_.tensor().dtype());
   if (!parsed.FromProto(allocator_, meta_.tensor())) {
@@ -64,6 +64,15 @@ class TensorResponse {
     // Ownership of the returned stream is retained by the Source and
     // should not be deleted by the caller.
     virtual ::tensorflow::protobuf::io::ZeroCopyInputStream* contents() = 0;
+
+    // Returns a TensorBuffer that aliases the "num_bytes" bytes at "data"
+    // and keeps them alive, or nullptr if they cannot be shared.  "data"
+    // points into a buffer yielded by the stream most recently returned by
+    // contents().  The caller owns one reference on the result.
+    //
+    // The default implementation returns nullptr, in which case ParseFrom
+    // copies the tensor contents into memory from the response's allocator.
+    virtual TensorBuffer* ShareBuffer(const char* data, size_t num_bytes);
   };
 
   // Parse the RecvTensorResponse encoded in the data yielded by
@@ -92,8 +101,16 @@ class TensorResponse {
   DeviceBase* device() const { return device_; }
 
  private:
-  bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
+  bool ParseTensorSubmessage(Source* source,
+                             protobuf::io::CodedInputStream* input,
                              TensorProto* tensor_meta);
+  bool ReadEncodedTensorContent(protobuf::io::CodedInputStream* input,
+                                const TensorShape& shape, DataType dtype,
+                                int num_bytes);
+  bool ShareTensorContent(Source* source,
+                          protobuf::io::CodedInputStream* input,
+                          const TensorShape& shape, DataType dtype,
+                          int num_bytes);
   bool ParseFast(Source* source);
   bool ParseSlow(Source* source);
 
@@ -15,14 +15,18 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/bfloat16.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
@@ -156,6 +160,54 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(TensorResponseTest, EncodedTensor) {
+  // Values that are exact in float16 and bfloat16.
+  Tensor src(DT_FLOAT, TensorShape({3, 1000}));
+  test::FillFn<float>(&src, [](int i) { return (i % 128) * 0.5f; });
+  const int64 n = src.NumElements();
+  DummyDevice cpu_device(Env::Default());
+  for (auto encoding :
+       {RPCOptions::FLOAT16, RPCOptions::BFLOAT16, RPCOptions::SNAPPY}) {
+    string content;
+    if (encoding == RPCOptions::FLOAT16) {
+      std::vector<Eigen::half> halves(n);
+      for (int64 i = 0; i < n; ++i) {
+        halves[i] = Eigen::half(src.flat<float>()(i));
+      }
+      content.assign(reinterpret_cast<const char*>(halves.data()), 2 * n);
+    } else if (encoding == RPCOptions::BFLOAT16) {
+      std::vector<bfloat16> halves(n);
+      FloatToBFloat16(src.flat<float>().data(), halves.data(), n);
+      content.assign(reinterpret_cast<const char*>(halves.data()), 2 * n);
+    } else {
+      StringPiece tdata = src.tensor_data();
+      if (!port::Snappy_Compress(tdata.data(), tdata.size(), &content)) {
+        continue;  // Snappy is not available in this build.
+      }
+    }
+    RecvTensorResponse header;
+    header.set_tensor_encoding(encoding);
+    header.set_send_start_micros(123456);
+    RecvTensorResponse body;
+    body.mutable_tensor()->set_dtype(DT_FLOAT);
+    src.shape().AsProto(body.mutable_tensor()->mutable_tensor_shape());
+    body.mutable_tensor()->set_tensor_content(content);
+
+    // The fast path requires the encoding to come before the tensor; the
+    // other order is handled by the slow path.
+    for (const string& encoded :
+         {header.SerializeAsString() + body.SerializeAsString(),
+          body.SerializeAsString() + header.SerializeAsString()}) {
+      StringSource source(&encoded, 1000);
+      TensorResponse response;
+      response.InitAlloc(&cpu_device, AllocatorAttributes());
+      TF_ASSERT_OK(response.ParseFrom(&source));
+      EXPECT_EQ(response.metadata().send_start_micros(), 123456);
+      test::ExpectTensorEqual<float>(src, response.tensor());
+    }
+  }
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
@@ -173,6 +225,98 @@ string MakeFloatTensorTestCase(int num_elems) {
   return encoded;
 }
 
+// A TensorBuffer that aliases memory owned by the test.
+class UnownedBuffer : public TensorBuffer {
+ public:
+  UnownedBuffer(const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)), size_(size) {}
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {}
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const size_t size_;
+};
+
+// Yields "data" as a single block and lets the parsed tensor share it.
+class SharingSource : public TensorResponse::Source {
+ public:
+  SharingSource(const char* data, int size) : data_(data), size_(size) {}
+
+  protobuf::io::ZeroCopyInputStream* contents() override {
+    stream_.reset(new protobuf::io::ArrayInputStream(data_, size_));
+    return stream_.get();
+  }
+
+  TensorBuffer* ShareBuffer(const char* data, size_t num_bytes) override {
+    ++num_shared_;
+    return new UnownedBuffer(data, num_bytes);
+  }
+
+  int num_shared() const { return num_shared_; }
+
+ private:
+  const char* const data_;
+  const int size_;
+  std::unique_ptr<protobuf::io::ArrayInputStream> stream_;
+  int num_shared_ = 0;
+};
+
+TEST(TensorResponseSharingTest, SharesLargeAlignedContents) {
+  const int kNumElems = 128 << 10;
+  string encoded = MakeFloatTensorTestCase(kNumElems);
+  string contents(kNumElems, 0);
+  for (int i = 0; i < kNumElems; i++) {
+    contents[i] = i % 10;
+  }
+  const size_t offset = encoded.find(contents);
+  ASSERT_NE(offset, string::npos);
+
+  // Place the encoding so that the tensor contents are properly aligned.
+  string storage(encoded.size() + EIGEN_MAX_ALIGN_BYTES, 0);
+  const size_t shift =
+      (EIGEN_MAX_ALIGN_BYTES -
+       (reinterpret_cast<uintptr_t>(storage.data()) + offset) %
+           EIGEN_MAX_ALIGN_BYTES) %
+      EIGEN_MAX_ALIGN_BYTES;
+  memcpy(&storage[shift], encoded.data(), encoded.size());
+  const char* data = storage.data() + shift;
+
+  DummyDevice cpu_device(Env::Default());
+  {
+    // Memory that may be DMA-ed to a GPU must come from the allocator.
+    SharingSource source(data, encoded.size());
+    AllocatorAttributes attr;
+    attr.set_gpu_compatible(true);
+    TensorResponse response;
+    response.InitAlloc(&cpu_device, attr);
+    TF_ASSERT_OK(response.ParseFrom(&source));
+    EXPECT_EQ(source.num_shared(), 0);
+    EXPECT_EQ(response.tensor().tensor_data(), contents);
+  }
+  {
+    SharingSource source(data, encoded.size());
+    TensorResponse response;
+    response.InitAlloc(&cpu_device, AllocatorAttributes());
+    TF_ASSERT_OK(response.ParseFrom(&source));
+    EXPECT_EQ(source.num_shared(), 1);
+    EXPECT_EQ(response.tensor().tensor_data().data(), data + offset);
+    EXPECT_EQ(response.tensor().tensor_data(), contents);
+    EXPECT_EQ(response.metadata().send_start_micros(), 123456);
+  }
+  {
+    // Misaligned contents are copied.
+    memmove(&storage[shift + 1], data, encoded.size());
+    SharingSource source(data + 1, encoded.size());
+    TensorResponse response;
+    response.InitAlloc(&cpu_device, AllocatorAttributes());
+    TF_ASSERT_OK(response.ParseFrom(&source));
+    EXPECT_EQ(source.num_shared(), 0);
+    EXPECT_EQ(response.tensor().tensor_data(), contents);
+  }
+}
+
 static void BM_TensorResponse(int iters, int arg) {
   testing::StopTiming();
   string encoded = MakeFloatTensorTestCase(arg);
@@ -81,7 +81,9 @@ void Worker::RegisterGraphAsync(const RegisterGraphRequest* request,
         request->session_handle(), request->graph_def(), session.get(),
         request->graph_options(), request->debug_options(),
         request->config_proto(), request->collective_graph_key(),
+        {request->recv_key().begin(), request->recv_key().end()},
         session->cluster_flr(), response->mutable_graph_handle());
+    response->set_recv_keys_registered(true);
   }
   done(s);
 }
@@ -183,6 +185,10 @@ void Worker::DoRunGraph(CallOptions* opts, RunGraphRequestWrapper* request,
   GraphMgr::NamedTensors in;
   GraphMgr::NamedTensors* out = new GraphMgr::NamedTensors;
   s = PrepareRunGraph(request, &in, out);
+  if (s.ok() && request->use_registered_recv_keys()) {
+    s = session->graph_mgr()->AddRegisteredRecvKeys(request->graph_handle(),
+                                                    out);
+  }
   if (!s.ok()) {
     delete out;
     done(s);
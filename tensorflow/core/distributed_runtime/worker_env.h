@@ -29,6 +29,7 @@ class CollectiveExecutorMgrInterface;
 class Device;
 class DeviceMgr;
 class Env;
+class RemoteMemoryTransport;
 class RendezvousMgrInterface;
 class SessionMgr;
 
@@ -58,6 +59,10 @@ struct WorkerEnv {
   // A set of rendezvous keyed by step ids.
   RendezvousMgrInterface* rendezvous_mgr = nullptr;
 
+  // If set, moves the contents of large tensors between workers out of
+  // band.  See remote_memory_transport.h.
+  RemoteMemoryTransport* remote_memory_transport = nullptr;
+
   // Generates per-step CollectiveExecutors and has access to utilities
   // supporting collective operations.
   CollectiveExecutorMgrInterface* collective_executor_mgr = nullptr;
@@ -32,8 +32,11 @@ thread_local const char* pending_op_name = nullptr;
 thread_local uint64 pending_step_id = 0;
 #endif
 
+thread_local const char* allocating_op_name = nullptr;
+thread_local int64 allocating_step_id = 0;
+
 string AllocatorStats::DebugString() const {
-  return strings::Printf(
+  string result = strings::Printf(
       "Limit:        %20lld\n"
       "InUse:        %20lld\n"
       "MaxInUse:     %20lld\n"
@@ -41,6 +44,13 @@ string AllocatorStats::DebugString() const {
       "MaxAllocSize: %20lld\n",
       this->bytes_limit ? *this->bytes_limit : 0, this->bytes_in_use,
       this->peak_bytes_in_use, this->num_allocs, this->largest_alloc_size);
+  if (this->fragmentation) {
+    strings::Appendf(&result,
+                     "MaxFreeBlock: %20lld\n"
+                     "Fragmentation:%20.4f\n",
+                     this->largest_free_block_bytes, *this->fragmentation);
+  }
+  return result;
 }
 
 constexpr size_t Allocator::kAllocatorAlignment;
@@ -58,7 +68,8 @@ bool CPUAllocatorFullStatsEnabled() { return cpu_allocator_collect_full_stats; }
 string AllocatorAttributes::DebugString() const {
   return strings::StrCat("AllocatorAttributes(on_host=", on_host(),
                          " nic_compatible=", nic_compatible(),
-                         " gpu_compatible=", gpu_compatible(), ")");
+                         " gpu_compatible=", gpu_compatible(),
+                         " step_scoped=", step_scoped(), ")");
 }
 
 Allocator* cpu_allocator_base() {
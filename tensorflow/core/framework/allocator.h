@@ -86,6 +86,12 @@ extern thread_local uint64 pending_step_id;
 #define MEMDEBUG_CACHE_VAL nullptr
 #endif
 
+// The op and step on whose behalf the calling thread last allocated a tensor.
+// Unlike the TENSORFLOW_MEM_DEBUG annotations above, these are always kept, so
+// allocators can attribute the allocation events they report to the profiler.
+extern thread_local const char* allocating_op_name;
+extern thread_local int64 allocating_step_id;
+
 // Runtime statistics collected by an allocator. Exactly the same as
 // stream_executor::AllocatorStats, but independently defined to preserve the
 // mutual independence of StreamExecutor and TensorFlow.
@@ -106,13 +112,21 @@ struct AllocatorStats {
   // if such a limit is known.
   absl::optional<int64> bytes_reservable_limit;
 
+  // Stats for the free memory held by the allocator, if it tracks them.
+  int64 largest_free_block_bytes;  // The largest contiguous free block.
+  // 1 - largest_free_block_bytes / (free bytes held by the allocator), so 0
+  // means all free memory is one contiguous block and values close to 1 mean
+  // it is scattered across many small holes.
+  absl::optional<double> fragmentation;
+
   AllocatorStats()
       : num_allocs(0),
         bytes_in_use(0),
         peak_bytes_in_use(0),
         largest_alloc_size(0),
         bytes_reserved(0),
-        peak_bytes_reserved(0) {}
+        peak_bytes_reserved(0),
+        largest_free_block_bytes(0) {}
 
   string DebugString() const;
 };
@@ -220,6 +234,14 @@ class Allocator {
     return 0;
   }
 
+  // Returns true if moving the contents of the buffer at 'ptr' into a fresh
+  // allocation and freeing 'ptr' would likely reduce fragmentation, e.g.
+  // because the freed memory would coalesce with adjacent free memory.
+  // Returns false for pointers this allocator did not allocate.
+  //
+  // REQUIRES: 'ptr!=nullptr'.
+  virtual bool ShouldRelocate(const void* ptr) const { return false; }
+
   // Fills in 'stats' with statistics collected by this allocator.
   virtual absl::optional<AllocatorStats> GetStats() { return absl::nullopt; }
 
@@ -279,6 +301,10 @@ class AllocatorWrapper : public Allocator {
     return wrapped_->AllocatedSizeSlow(ptr);
   }
 
+  bool ShouldRelocate(const void* ptr) const override {
+    return wrapped_->ShouldRelocate(ptr);
+  }
+
  private:
   Allocator* const wrapped_;
 };
@@ -310,6 +336,10 @@ struct AllocatorAttributes {
   bool nic_compatible() const { return value & (0x1 << 1); }
   void set_gpu_compatible(bool v) { value |= (static_cast<int>(v) << 2); }
   bool gpu_compatible() const { return value & (0x1 << 2); }
+  // EXPERIMENTAL: If true, the tensor is expected to die within the step
+  // that allocates it, and may be served by a step-scoped arena allocator.
+  void set_step_scoped(bool v) { value |= (static_cast<int>(v) << 3); }
+  bool step_scoped() const { return value & (0x1 << 3); }
   void Merge(AllocatorAttributes other) {
     value |= other.value;
     if (scope_id != other.scope_id) {
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/attr_value_util.h"
 
+#include <map>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/protobuf.h"
 
 namespace tensorflow {
@@ -71,6 +73,51 @@ uint64 FastTensorProtoHash(const TensorProto& tp) {
   }
 }
 
+uint64 ProtoFingerprint(const protobuf::MessageLite& proto) {
+  string serialized;
+  SerializeToStringDeterministic(proto, &serialized);
+  return Fingerprint64(serialized);
+}
+
+template <typename T>
+uint64 RepeatedFieldFingerprint(const protobuf::RepeatedField<T>& field) {
+  return Fingerprint64(StringPiece(reinterpret_cast<const char*>(field.data()),
+                                   field.size() * sizeof(T)));
+}
+
+// Fingerprints the fields of `tp` in place. Unlike serializing the proto,
+// this does not copy the contents of large tensors.
+uint64 TensorProtoFingerprint(const TensorProto& tp) {
+  uint64 fp = FingerprintCat64(tp.dtype(), tp.version_number());
+  fp = FingerprintCat64(fp, ProtoFingerprint(tp.tensor_shape()));
+  fp = FingerprintCat64(fp, Fingerprint64(tp.tensor_content()));
+  for (const uint64 field_fp : {RepeatedFieldFingerprint(tp.half_val()),
+                                RepeatedFieldFingerprint(tp.float_val()),
+                                RepeatedFieldFingerprint(tp.double_val()),
+                                RepeatedFieldFingerprint(tp.int_val()),
+                                RepeatedFieldFingerprint(tp.scomplex_val()),
+                                RepeatedFieldFingerprint(tp.int64_val()),
+                                RepeatedFieldFingerprint(tp.bool_val()),
+                                RepeatedFieldFingerprint(tp.dcomplex_val()),
+                                RepeatedFieldFingerprint(tp.uint32_val()),
+                                RepeatedFieldFingerprint(tp.uint64_val())}) {
+    fp = FingerprintCat64(fp, field_fp);
+  }
+  fp = FingerprintCat64(fp, tp.string_val_size());
+  for (const string& s : tp.string_val()) {
+    fp = FingerprintCat64(fp, Fingerprint64(s));
+  }
+  fp = FingerprintCat64(fp, tp.resource_handle_val_size());
+  for (const auto& handle : tp.resource_handle_val()) {
+    fp = FingerprintCat64(fp, ProtoFingerprint(handle));
+  }
+  fp = FingerprintCat64(fp, tp.variant_val_size());
+  for (const auto& variant : tp.variant_val()) {
+    fp = FingerprintCat64(fp, ProtoFingerprint(variant));
+  }
+  return fp;
+}
+
 // There are multiple equivalent representations of attr values containing
 // TensorProtos. Compare them by constructing Tensors and serializing them
 // back. Comparing Tensor objects is pretty tricky. This is unsafe operation,
@@ -590,6 +637,50 @@ uint64 FastAttrValueHash(const AttrValue& a) {
   return AttrValueHash(a, FastTensorProtoHash);
 }
 
+uint64 AttrValueFingerprint(const AttrValue& a) {
+  // The value case keeps e.g. an empty list apart from an empty string.
+  const uint64 value_case = a.value_case();
+  if (a.has_tensor()) {
+    return FingerprintCat64(value_case, TensorProtoFingerprint(a.tensor()));
+  }
+  if (a.has_func()) {
+    const NameAttrList& func = a.func();
+    uint64 fp = FingerprintCat64(value_case, Fingerprint64(func.name()));
+    std::map<StringPiece, const AttrValue*> map;
+    for (const auto& pair : func.attr()) {
+      map.emplace(pair.first, &pair.second);
+    }
+    for (const auto& pair : map) {
+      fp = FingerprintCat64(fp, Fingerprint64(pair.first));
+      fp = FingerprintCat64(fp, AttrValueFingerprint(*pair.second));
+    }
+    return fp;
+  }
+  if (a.has_list() &&
+      (a.list().tensor_size() > 0 || a.list().func_size() > 0)) {
+    AttrValue element;
+    uint64 fp = FingerprintCat64(value_case, a.list().tensor_size());
+    for (const TensorProto& tensor : a.list().tensor()) {
+      fp = FingerprintCat64(fp, TensorProtoFingerprint(tensor));
+    }
+    fp = FingerprintCat64(fp, a.list().func_size());
+    for (const NameAttrList& func : a.list().func()) {
+      *element.mutable_func() = func;
+      fp = FingerprintCat64(fp, AttrValueFingerprint(element));
+    }
+    AttrValue::ListValue* rest = element.mutable_list();
+    *rest->mutable_s() = a.list().s();
+    *rest->mutable_i() = a.list().i();
+    *rest->mutable_f() = a.list().f();
+    *rest->mutable_b() = a.list().b();
+    *rest->mutable_type() = a.list().type();
+    *rest->mutable_shape() = a.list().shape();
+    return FingerprintCat64(fp, ProtoFingerprint(element));
+  }
+  // The other values are small, so their serialization is cheap.
+  return FingerprintCat64(value_case, ProtoFingerprint(a));
+}
+
 bool HasPlaceHolder(const AttrValue& val) {
   switch (val.value_case()) {
     case AttrValue::kList: {
@@ -113,6 +113,13 @@ uint64 AttrValueHash(const AttrValue& a);
 uint64 FastAttrValueHash(const AttrValue& a);
 bool FastAreAttrValuesEqual(const AttrValue& a, const AttrValue& b);
 
+// Returns a fingerprint of `a`. Unlike the hashes above, the fingerprint is
+// stable across binaries, so it can be part of a persistent cache key.
+// Tensors are fingerprinted field by field without being serialized, which
+// keeps large constants cheap. Different TensorProto representations of the
+// same tensor have different fingerprints.
+uint64 AttrValueFingerprint(const AttrValue& a);
+
 // Returns true if "val" has a placeholder.
 bool HasPlaceHolder(const AttrValue& val);
 
@@ -282,6 +282,18 @@ class CollectiveExecutor : public PeerAccessInterface, public core::RefCounted {
         "a CollectiveExecutor has not been provided."));
   }
 
+  // As above, but runs the collective on the given `input` and `output`
+  // rather than on the first input and output of `ctx`, e.g. on a buffer
+  // fusing several tensors of the op.  `input` may equal `output`.
+  virtual void ExecuteAsync(OpKernelContext* ctx,
+                            const CollectiveParams& col_params,
+                            const string& exec_key, const Tensor* input,
+                            Tensor* output, StatusCallback done) {
+    done(errors::Internal(
+        "A collective Op has been called in a context in which "
+        "a CollectiveExecutor has not been provided."));
+  }
+
   virtual void CompleteParamsAsync(const string& device, CollectiveParams* cp,
                                    CancellationManager* cancel_mgr,
                                    StatusCallback done) {
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <ctype.h>
 
+#include <algorithm>
 #include <map>
 #include <unordered_map>
 #include <utility>
@@ -37,6 +38,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/equal_graph_def.h"
 
@@ -898,6 +901,60 @@ uint64 FunctionDefHash(const FunctionDef& fdef) {
   return h;
 }
 
+uint64 FunctionDefFingerprint(const FunctionDef& fdef) {
+  // signature
+  string serialized;
+  SerializeToStringDeterministic(fdef.signature(), &serialized);
+  uint64 fp = Fingerprint64(serialized);
+
+  // attrs
+  std::map<StringPiece, const AttrValue*> attrs;
+  for (const auto& p : fdef.attr()) {
+    attrs.emplace(p.first, &p.second);
+  }
+  fp = FingerprintCat64(fp, attrs.size());
+  for (const auto& p : attrs) {
+    fp = FingerprintCat64(fp, Fingerprint64(p.first));
+    fp = FingerprintCat64(fp, AttrValueFingerprint(*p.second));
+  }
+
+  // arg attrs
+  std::map<uint32, const FunctionDef::ArgAttrs*> arg_attrs;
+  for (const auto& p : fdef.arg_attr()) {
+    arg_attrs.emplace(p.first, &p.second);
+  }
+  fp = FingerprintCat64(fp, arg_attrs.size());
+  for (const auto& p : arg_attrs) {
+    SerializeToStringDeterministic(*p.second, &serialized);
+    fp = FingerprintCat64(fp, p.first);
+    fp = FingerprintCat64(fp, Fingerprint64(serialized));
+  }
+
+  // node defs, in any order
+  std::vector<uint64> node_fps;
+  node_fps.reserve(fdef.node_def_size());
+  for (const NodeDef& ndef : fdef.node_def()) {
+    node_fps.push_back(NodeDefFingerprint(ndef));
+  }
+  std::sort(node_fps.begin(), node_fps.end());
+  fp = FingerprintCat64(fp, node_fps.size());
+  for (const uint64 node_fp : node_fps) {
+    fp = FingerprintCat64(fp, node_fp);
+  }
+
+  // output names and control output names
+  for (const auto* rets : {&fdef.ret(), &fdef.control_ret()}) {
+    std::map<StringPiece, StringPiece> sorted(rets->begin(), rets->end());
+    fp = FingerprintCat64(fp, sorted.size());
+    for (const auto& p : sorted) {
+      fp = FingerprintCat64(fp, Fingerprint64(p.first));
+      fp = FingerprintCat64(fp, Fingerprint64(p.second));
+    }
+  }
+
+  return fp;
+}
+
 static constexpr const char* const kExecutorAttr = "_executor";
 
 /* static */
@@ -1175,6 +1232,24 @@ const FunctionDef* FunctionLibraryDefinition::Find(const string& func) const {
   }
 }
 
+uint64 FunctionLibraryDefinition::Fingerprint(const string& func) const {
+  std::shared_ptr<FunctionDefAndOpRegistration> entry;
+  {
+    tf_shared_lock l(mu_);
+    entry = FindHelper(func);
+  }
+  if (entry == nullptr) {
+    return 0;
+  }
+  // Concurrent callers may both compute the fingerprint, which is harmless.
+  uint64 fp = entry->fingerprint.load(std::memory_order_relaxed);
+  if (fp == 0) {
+    fp = FunctionDefFingerprint(entry->fdef);
+    entry->fingerprint.store(fp, std::memory_order_relaxed);
+  }
+  return fp;
+}
+
 std::shared_ptr<FunctionLibraryDefinition::FunctionDefAndOpRegistration>
 FunctionLibraryDefinition::FindHelper(const string& func) const {
   auto iter = function_defs_.find(func);
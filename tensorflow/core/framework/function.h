@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_FUNCTION_H_
 #define TENSORFLOW_CORE_FRAMEWORK_FUNCTION_H_
 
+#include <atomic>
 #include <vector>
 
 // clang-format off
@@ -266,6 +267,11 @@ bool FunctionDefsEqual(const FunctionDef& f1, const FunctionDef& f2);
 // same.
 uint64 FunctionDefHash(const FunctionDef& fdef);
 
+// Returns a fingerprint of `fdef` that, unlike FunctionDefHash, is stable
+// across binaries. Like FunctionDefsEqual, it ignores the order of the
+// NodeDefs.
+uint64 FunctionDefFingerprint(const FunctionDef& fdef);
+
 class CallFrameInterface {
  public:
   virtual ~CallFrameInterface() {}
@@ -353,6 +359,11 @@ class FunctionLibraryDefinition : public OpRegistryInterface {
   // subsequent call to `ReplaceFunction()` with the given name.
   const FunctionDef* Find(const string& func) const LOCKS_EXCLUDED(mu_);
 
+  // Returns 0 if "func" is not defined in "lib_def". Otherwise, returns the
+  // FunctionDefFingerprint of its definition, which is computed once per
+  // definition and shared by the copies of this library.
+  uint64 Fingerprint(const string& func) const LOCKS_EXCLUDED(mu_);
+
   // Adds function definition 'fdef' to this function library.
   // Returns status 'ok' on success, or error otherwise. This is a no-op if
   // 'fdef' already exists in this function library.
@@ -470,6 +481,8 @@ class FunctionLibraryDefinition : public OpRegistryInterface {
 
     const FunctionDef fdef;
     const OpRegistrationData op_registration_data;
+    // FunctionDefFingerprint(fdef), or 0 until it is first computed.
+    mutable std::atomic<uint64> fingerprint{0};
   };
 
   std::shared_ptr<FunctionDefAndOpRegistration> FindHelper(
@@ -988,6 +988,26 @@ TEST(FunctionLibraryDefinitionTest, Find) {
   EXPECT_EQ(test::function::XTimesTwo().DebugString(), found->DebugString());
 }
 
+TEST(FunctionLibraryDefinitionTest, Fingerprint) {
+  FunctionLibraryDefinition lib_def(OpRegistry::Global(), {});
+  TF_CHECK_OK(lib_def.AddFunctionDef(test::function::XTimesTwo()));
+  TF_CHECK_OK(lib_def.AddFunctionDef(test::function::XTimesFour()));
+
+  EXPECT_EQ(lib_def.Fingerprint("XTimes16"), uint64{0});
+  const uint64 fp = lib_def.Fingerprint("XTimesTwo");
+  EXPECT_EQ(fp, FunctionDefFingerprint(test::function::XTimesTwo()));
+  EXPECT_NE(fp, lib_def.Fingerprint("XTimesFour"));
+
+  // The copy shares the cached fingerprint.
+  FunctionLibraryDefinition copy(lib_def);
+  EXPECT_EQ(fp, copy.Fingerprint("XTimesTwo"));
+
+  // The order of the NodeDefs does not matter.
+  FunctionDef reordered = test::function::XTimesTwo();
+  reordered.mutable_node_def()->SwapElements(0, 1);
+  EXPECT_EQ(fp, FunctionDefFingerprint(reordered));
+}
+
 TEST(FunctionLibraryDefinitionTest, LookUp) {
   FunctionLibraryDefinition lib_def(OpRegistry::Global(), {});
   TF_CHECK_OK(lib_def.AddFunctionDef(test::function::XTimesTwo()));
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/graph_def_util.h"
 
+#include <algorithm>
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
@@ -30,8 +31,10 @@ limitations under the License.
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/fingerprint.h"
 
 namespace tensorflow {
 
@@ -263,4 +266,50 @@ Status StrippedOpListForGraph(const GraphDef& graph_def,
   return Status::OK();
 }
 
+uint64 GraphDefFingerprint(const GraphDef& graph_def,
+                           thread::ThreadPool* pool) {
+  const int num_nodes = graph_def.node_size();
+  const int num_functions = graph_def.library().function_size();
+  std::vector<uint64> fps(num_nodes + num_functions);
+  auto fingerprint_range = [&](int64 begin, int64 end) {
+    for (int64 i = begin; i < end; ++i) {
+      fps[i] = i < num_nodes ? NodeDefFingerprint(graph_def.node(i))
+                             : FunctionDefFingerprint(
+                                   graph_def.library().function(i - num_nodes));
+    }
+  };
+  if (pool != nullptr) {
+    // Roughly the cycles to fingerprint a node.
+    static constexpr int64 kCostPerItem = 1000;
+    pool->ParallelFor(fps.size(), kCostPerItem, fingerprint_range);
+  } else {
+    fingerprint_range(0, fps.size());
+  }
+  std::sort(fps.begin(), fps.begin() + num_nodes);
+  std::sort(fps.begin() + num_nodes, fps.end());
+
+  const VersionDef& versions = graph_def.versions();
+  uint64 fp = FingerprintCat64(versions.producer(), versions.min_consumer());
+  fp = FingerprintCat64(fp, versions.bad_consumers_size());
+  for (const int bad_consumer : versions.bad_consumers()) {
+    fp = FingerprintCat64(fp, bad_consumer);
+  }
+  fp = FingerprintCat64(fp, num_nodes);
+  fp = FingerprintCat64(fp, num_functions);
+  for (const uint64 item_fp : fps) {
+    fp = FingerprintCat64(fp, item_fp);
+  }
+  std::vector<std::pair<StringPiece, StringPiece>> gradients;
+  for (const GradientDef& grad : graph_def.library().gradient()) {
+    gradients.emplace_back(grad.function_name(), grad.gradient_func());
+  }
+  std::sort(gradients.begin(), gradients.end());
+  fp = FingerprintCat64(fp, gradients.size());
+  for (const auto& grad : gradients) {
+    fp = FingerprintCat64(fp, Fingerprint64(grad.first));
+    fp = FingerprintCat64(fp, Fingerprint64(grad.second));
+  }
+  return fp;
+}
+
 }  // namespace tensorflow
@@ -27,6 +27,10 @@ namespace tensorflow {
 class GraphDef;
 class NodeDef;
 
+namespace thread {
+class ThreadPool;
+}  // namespace thread
+
 // Produce a human-readable version of a GraphDef that is more concise
 // than a text-format proto.
 string SummarizeGraphDef(const GraphDef& graph_def);
@@ -130,6 +134,15 @@ Status StrippedOpListForGraph(const GraphDef& graph_def,
                               const OpRegistryInterface& op_registry,
                               OpList* stripped_op_list);
 
+// Returns a fingerprint of `graph_def` for use as a cache key. It covers the
+// versions, nodes (see NodeDefFingerprint) and library (see
+// FunctionDefFingerprint), is stable across binaries, and does not depend on
+// the order of the nodes or functions. Unlike fingerprinting the
+// serialization, it does not copy the graph. If `pool` is not null, the
+// nodes and functions are fingerprinted in parallel on it.
+uint64 GraphDefFingerprint(const GraphDef& graph_def,
+                           thread::ThreadPool* pool = nullptr);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_FRAMEWORK_GRAPH_DEF_UTIL_H_
@@ -21,7 +21,11 @@ limitations under the License.
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_def.pb.h"
 #include "tensorflow/core/framework/op_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/util/equal_graph_def.h"
 
@@ -362,5 +366,64 @@ TEST(StrippedOpListForGraphTest, NestedFunctionTest) {
   }
 }
 
+GraphDef MakeFingerprintTestGraph(int num_nodes) {
+  GraphDef graph_def;
+  graph_def.mutable_versions()->set_producer(27);
+  for (int i = 0; i < num_nodes; ++i) {
+    NodeDef* node = graph_def.add_node();
+    node->set_name(strings::StrCat("n", i));
+    node->set_op("Const");
+    node->set_device("/cpu:0");
+    if (i > 0) node->add_input(strings::StrCat("^n", i - 1));
+    AddNodeAttr("dtype", DT_FLOAT, node);
+    AddNodeAttr("value", test::AsTensor<float>({1.0f * i, 2.0f}), node);
+  }
+  FunctionDef* fdef = graph_def.mutable_library()->add_function();
+  fdef->mutable_signature()->set_name("F");
+  fdef->add_node_def()->set_op("Const");
+  return graph_def;
+}
+
+TEST(GraphDefFingerprintTest, IgnoresOrder) {
+  GraphDef graph_def = MakeFingerprintTestGraph(3);
+  GraphDef reordered = graph_def;
+  reordered.mutable_node()->SwapElements(0, 2);
+  EXPECT_EQ(GraphDefFingerprint(graph_def), GraphDefFingerprint(reordered));
+}
+
+TEST(GraphDefFingerprintTest, DetectsChanges) {
+  const GraphDef graph_def = MakeFingerprintTestGraph(3);
+  const uint64 fp = GraphDefFingerprint(graph_def);
+
+  GraphDef changed = graph_def;
+  test::AsTensor<float>({1.0f, 3.0f})
+      .AsProtoTensorContent(
+          (*changed.mutable_node(1)->mutable_attr())["value"].mutable_tensor());
+  EXPECT_NE(fp, GraphDefFingerprint(changed));
+
+  changed = graph_def;
+  changed.mutable_node(2)->set_device("/gpu:0");
+  EXPECT_NE(fp, GraphDefFingerprint(changed));
+
+  changed = graph_def;
+  changed.mutable_node(2)->add_input("n0");
+  EXPECT_NE(fp, GraphDefFingerprint(changed));
+
+  changed = graph_def;
+  changed.mutable_library()->mutable_function(0)->add_node_def()->set_op("Foo");
+  EXPECT_NE(fp, GraphDefFingerprint(changed));
+
+  changed = graph_def;
+  changed.mutable_versions()->set_producer(28);
+  EXPECT_NE(fp, GraphDefFingerprint(changed));
+}
+
+TEST(GraphDefFingerprintTest, Parallel) {
+  const GraphDef graph_def = MakeFingerprintTestGraph(1000);
+  thread::ThreadPool pool(Env::Default(), "fingerprint", 4);
+  EXPECT_EQ(GraphDefFingerprint(graph_def),
+            GraphDefFingerprint(graph_def, &pool));
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -18,7 +18,10 @@ limitations under the License.
 #include <memory>
 
 #include "absl/time/clock.h"
+#include "tensorflow/core/framework/stats_aggregator.h"
+#include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
 
 namespace tensorflow {
 namespace data {
@@ -720,6 +723,9 @@ void Model::Optimize(AutotuneAlgorithm algorithm, int64 cpu_budget,
     case AutotuneAlgorithm::GRADIENT_DESCENT:
       OptimizeGradientDescent(cpu_budget, ram_budget);
       break;
+    case AutotuneAlgorithm::RAM_BUDGET:
+      OptimizeRamBudget(cpu_budget, ram_budget);
+      break;
   }
 }
 
@@ -740,6 +746,56 @@ int64 Model::NumElements(const string& name) {
   return 0;
 }
 
+std::map<string, NodeProfile> Model::Profile() {
+  std::map<string, NodeProfile> profile;
+  tf_shared_lock l(mu_);
+  for (const auto& pair : lookup_table_) {
+    const Node& node = *pair.second;
+    NodeProfile& node_profile = profile[pair.first];
+    node_profile.num_elements = node.num_elements();
+    node_profile.processing_time = node.SelfProcessingTime();
+    node_profile.parallelism = node.parallelism();
+    node_profile.element_size = node.BufferedElementSize();
+  }
+  return profile;
+}
+
+Status Model::SaveProfile(Env* env, const string& path) {
+  string contents;
+  for (const auto& pair : Profile()) {
+    const NodeProfile& node = pair.second;
+    strings::StrAppend(&contents, pair.first, "\t", node.num_elements, "\t",
+                       node.processing_time, "\t", node.parallelism, "\t",
+                       node.element_size, "\n");
+  }
+  // Write to a temporary file first, so that readers never see a partially
+  // written profile.
+  const string tmp_path = strings::StrCat(path, ".tmp");
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_path, contents));
+  return env->RenameFile(tmp_path, path);
+}
+
+/* static */ Status Model::LoadProfile(Env* env, const string& path,
+                                       std::map<string, NodeProfile>* profile) {
+  string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, path, &contents));
+  for (const string& line :
+       str_util::Split(contents, '\n', str_util::SkipEmpty())) {
+    std::vector<string> fields = str_util::Split(line, '\t');
+    NodeProfile node;
+    if (fields.size() != 5 ||
+        !strings::safe_strto64(fields[1], &node.num_elements) ||
+        !strings::safe_strtod(fields[2], &node.processing_time) ||
+        !strings::safe_strtod(fields[3], &node.parallelism) ||
+        !strings::safe_strtod(fields[4], &node.element_size)) {
+      return errors::DataLoss("Invalid line in input pipeline profile ", path,
+                              ": ", line);
+    }
+    (*profile)[fields[0]] = node;
+  }
+  return Status::OK();
+}
+
 void Model::RecordStart(const string& name, bool stop_output) {
   tf_shared_lock l(mu_);
   auto node = gtl::FindOrNull(lookup_table_, name);
@@ -777,6 +833,75 @@ void Model::RemoveNode(const string& name) {
   lookup_table_.erase(name);
 }
 
+void Model::RecordStats(StatsAggregator* stats_aggregator) {
+  tf_shared_lock l(mu_);
+  const int64 step = output_ ? output_->num_elements() : 0;
+  for (const auto& pair : lookup_table_) {
+    const std::shared_ptr<Node>& node = pair.second;
+    for (double p : {50.0, 90.0, 99.0}) {
+      stats_aggregator->AddScalar(
+          strings::StrCat(node->long_name(), "::processing_time_p", p),
+          node->ElementProcessingTimePercentile(p), step);
+    }
+    stats_aggregator->AddScalar(
+        strings::StrCat(node->long_name(), "::buffered_elements"),
+        node->buffered_elements(), step);
+    stats_aggregator->AddScalar(
+        strings::StrCat(node->long_name(), "::max_buffered_elements"),
+        node->max_buffered_elements(), step);
+  }
+}
+
+string Model::BottleneckReport() {
+  struct Stage {
+    std::shared_ptr<Node> node;
+    // Processing time of the node per thread, accumulated over all the
+    // elements produced by the pipeline so far.
+    double time;
+  };
+  std::vector<Stage> stages;
+  double total_time = 0;
+  int64 num_elements = 0;
+  {
+    tf_shared_lock l(mu_);
+    if (output_) {
+      num_elements = output_->num_elements();
+    }
+    for (const auto& pair : lookup_table_) {
+      const std::shared_ptr<Node>& node = pair.second;
+      const double time = node->processing_time() / node->parallelism();
+      stages.push_back({node, time});
+      total_time += time;
+    }
+  }
+  if (num_elements == 0 || total_time == 0) {
+    return "No processing time has been recorded for the input pipeline.";
+  }
+  std::sort(stages.begin(), stages.end(),
+            [](const Stage& a, const Stage& b) { return a.time > b.time; });
+
+  string result = strings::StrCat("Input pipeline bottleneck report (",
+                                  num_elements, " elements produced):\n");
+  for (const Stage& stage : stages) {
+    const Node& node = *stage.node;
+    strings::StrAppend(
+        &result, "  ", node.long_name(), ": ",
+        strings::Printf("%.1f%%", 100 * stage.time / total_time),
+        " of the time, parallelism=", node.parallelism(),
+        ", processing time per element p50/p90/p99=",
+        strings::Printf("%.1f/%.1f/%.1f us",
+                        node.ElementProcessingTimePercentile(50) / 1000,
+                        node.ElementProcessingTimePercentile(90) / 1000,
+                        node.ElementProcessingTimePercentile(99) / 1000),
+        ", buffered_elements=", node.buffered_elements(), " (max ",
+        node.max_buffered_elements(), ")\n");
+  }
+  strings::StrAppend(&result, "Bottleneck: ", stages[0].node->long_name(),
+                     ". Speeding it up would most improve the throughput of "
+                     "the input pipeline.\n");
+  return result;
+}
+
 std::map<string, std::shared_ptr<Parameter>> Model::CollectTunableParameters(
     std::shared_ptr<Node> node) {
   std::map<string, std::shared_ptr<Parameter>> parameters;
@@ -951,6 +1076,76 @@ void Model::OptimizeHillClimb(int64 cpu_budget, int64 ram_budget) {
   }
 }
 
+void Model::OptimizeRamBudget(int64 cpu_budget, int64 ram_budget) {
+  std::shared_ptr<Node> snapshot;
+  {
+    tf_shared_lock lock(mu_);
+    snapshot = output_->Snapshot(nullptr);
+  }
+  VLOG(2) << "Starting optimization of tunable parameters with RamBudget";
+  const double processing_time = TotalProcessingTime(snapshot);
+  auto parameters = CollectTunableParameters(snapshot);
+  // We add the number of model's buffered bytes because it is excluded from the
+  // memory budget, but it is included in the maximum number of buffered bytes.
+  ram_budget += TotalBufferedBytes(snapshot);
+  // Buffer size parameter will only be incremented if the output latency
+  // improvement is greater than this constant.
+  constexpr double kBufferSizeMinDelta = 1.0L;
+
+  for (auto& pair : parameters) {
+    pair.second->value = pair.second->min;
+  }
+  while (true) {
+    const double output_time = OutputTime(snapshot, /*gradient=*/nullptr);
+    if (output_time < processing_time / cpu_budget) {
+      break;
+    }
+    const double buffered_bytes = TotalMaximumBufferedBytes(snapshot);
+    double best_score = 0;
+    Parameter* best_parameter = nullptr;
+    for (auto& pair : parameters) {
+      if (pair.second->value >= pair.second->max) {
+        continue;
+      }
+      pair.second->value++;
+      const double new_output_time = OutputTime(snapshot, /*gradient=*/nullptr);
+      const double new_buffered_bytes = TotalMaximumBufferedBytes(snapshot);
+      pair.second->value--;
+      if (new_buffered_bytes > ram_budget) {
+        continue;
+      }
+      const double delta = output_time - new_output_time;
+      if (delta <= 0 ||
+          (pair.second->name == kBufferSize && delta <= kBufferSizeMinDelta)) {
+        continue;
+      }
+      // Output time saved per byte of additional buffer memory. Increments
+      // that need (almost) no memory are ranked by the time they save.
+      const double score =
+          delta / std::max(1.0, new_buffered_bytes - buffered_bytes);
+      if (score > best_score) {
+        best_score = score;
+        best_parameter = pair.second.get();
+      }
+    }
+    if (!best_parameter) {
+      VLOG(2) << "No tunable parameter increment fits in the RAM budget of "
+              << ram_budget << " bytes and decreases the output time.";
+      break;
+    }
+    best_parameter->value++;
+  }
+  VLOG(2) << "Number of tunable parameters: " << parameters.size();
+  for (auto& pair : parameters) {
+    auto& parameter = pair.second;
+    VLOG(2) << "Setting tunable parameter " << pair.first << " to "
+            << parameter->value;
+    mutex_lock l(*parameter->state->mu);
+    parameter->state->value = parameter->value;
+    parameter->state->cond_var->notify_all();
+  }
+}
+
 double Model::OutputTime(std::shared_ptr<Node> node,
                          std::map<string, double>* gradient) {
   std::vector<double> input_times(1, 0);
@@ -15,7 +15,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_MODEL_H_
 #define TENSORFLOW_CORE_FRAMEWORK_MODEL_H_
 
+#include <algorithm>
 #include <list>
+#include <map>
 #include <memory>
 #include <string>
 // TODO(b/114492873): Move this include into core/platform.
@@ -33,6 +35,9 @@ limitations under the License.
 
 namespace tensorflow {
 namespace data {
+
+class StatsAggregator;
+
 namespace model {
 
 // A constant that can be used to enable auto-tuning.
@@ -43,6 +48,7 @@ constexpr char kBufferSize[] = "buffer_size";
 enum class AutotuneAlgorithm {
   HILL_CLIMB = 0,
   GRADIENT_DESCENT = 1,
+  RAM_BUDGET = 2,
 };
 
 // Represents thread-safe state that can be shared between an input pipeline and
@@ -170,15 +176,35 @@ class Node {
   // Returns the unique node ID.
   int64 id() const LOCKS_EXCLUDED(mu_) { return id_; }
 
+  // Returns the average size of an element buffered in this node, or 0 if the
+  // node has not buffered any element.
+  double BufferedElementSize() const LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    return AverageBufferedElementSize();
+  }
+
   // Returns the node inputs.
   std::list<std::shared_ptr<Node>> inputs() const LOCKS_EXCLUDED(mu_) {
     tf_shared_lock l(mu_);
     return inputs_;
   }
 
+  // Returns the given percentile (in [0, 100]) of the time, in nanoseconds,
+  // that this node spent producing each of its elements.
+  double ElementProcessingTimePercentile(double p) const LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    return element_processing_times_.Percentile(p);
+  }
+
   // Returns a longer node name that is guaranteed to be unique.
   string long_name() const { return strings::StrCat(name_, "(id:", id_, ")"); }
 
+  // Returns the largest number of elements this node's buffer has held.
+  int64 max_buffered_elements() const LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    return max_buffered_elements_;
+  }
+
   // Returns the node name.
   const string& name() const { return name_; }
 
@@ -191,6 +217,21 @@ class Node {
   // Returns the node output.
   Node* output() const { return output_; }
 
+  // Returns the number of threads the node uses to produce its elements.
+  double parallelism() const LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    auto* parameter = gtl::FindOrNull(parameters_, kParallelism);
+    if (!parameter) return 1.0;
+    // Use the value in effect rather than the model value, which changes
+    // while the model is being optimized.
+    const SharedState& state = *(*parameter)->state;
+    if (state.mu) {
+      mutex_lock l2(*state.mu);
+      return std::max(1.0, state.value);
+    }
+    return std::max(1.0, state.value);
+  }
+
   // Returns the aggregate processing time.
   int64 processing_time() const LOCKS_EXCLUDED(mu_) {
     tf_shared_lock l(mu_);
@@ -203,12 +244,21 @@ class Node {
     mutex_lock l(mu_);
     buffered_bytes_ += bytes_delta;
     buffered_elements_ += elements_delta;
+    if (elements_delta > 0) {
+      enqueued_bytes_ += bytes_delta;
+      enqueued_elements_ += elements_delta;
+    }
+    max_buffered_elements_ =
+        std::max(max_buffered_elements_, buffered_elements_);
   }
 
   // Records that the node produced an element.
   void record_element() LOCKS_EXCLUDED(mu_) {
     mutex_lock l(mu_);
     num_elements_++;
+    element_processing_times_.Add(processing_time_ -
+                                  processing_time_at_last_element_);
+    processing_time_at_last_element_ = processing_time_;
   }
 
   // Records that a node thread has started executing.
@@ -305,6 +355,8 @@ class Node {
       result->autotune_ = autotune_;
       result->buffered_bytes_ = buffered_bytes_;
       result->buffered_elements_ = buffered_elements_;
+      result->enqueued_bytes_ = enqueued_bytes_;
+      result->enqueued_elements_ = enqueued_elements_;
       result->processing_time_ = processing_time_;
       result->num_elements_ = num_elements_;
       result->parameters_ = parameters_;
@@ -390,10 +442,17 @@ class Node {
   virtual std::shared_ptr<Node> Clone(std::shared_ptr<Node> output) const
       SHARED_LOCKS_REQUIRED(mu_) = 0;
 
-  // Returns the average size of an element buffered in this node.
+  // Returns the average size of an element buffered in this node. If the
+  // buffer is empty, returns the average size of all elements that have been
+  // buffered so far, so that an empty buffer is not mistaken for a buffer of
+  // free elements.
   double AverageBufferedElementSize() const SHARED_LOCKS_REQUIRED(mu_) {
     if (buffered_elements_ == 0) {
-      return 0;
+      if (enqueued_elements_ == 0) {
+        return 0;
+      }
+      return static_cast<double>(enqueued_bytes_) /
+             static_cast<double>(enqueued_elements_);
     }
     return static_cast<double>(buffered_bytes_) /
            static_cast<double>(buffered_elements_);
@@ -499,9 +558,18 @@ class Node {
   int64 buffered_elements_ GUARDED_BY(mu_) = 0;
   int64 processing_time_ GUARDED_BY(mu_) = 0;
   int64 num_elements_ GUARDED_BY(mu_) = 0;
+  int64 max_buffered_elements_ GUARDED_BY(mu_) = 0;
+  // Total size and number of the elements ever added to this node's buffer.
+  int64 enqueued_bytes_ GUARDED_BY(mu_) = 0;
+  int64 enqueued_elements_ GUARDED_BY(mu_) = 0;
   std::map<std::thread::id, int64> work_start_ GUARDED_BY(mu_);
   std::map<string, std::shared_ptr<Parameter>> parameters_ GUARDED_BY(mu_);
 
+  // Distribution of the processing time spent on each element, i.e. of the
+  // growth of `processing_time_` between consecutive `record_element()` calls.
+  histogram::Histogram element_processing_times_ GUARDED_BY(mu_);
+  int64 processing_time_at_last_element_ GUARDED_BY(mu_) = 0;
+
   // Statistic of inputs processing time history.
   double input_processing_time_sum_ = 0.0L;
   int64 input_processing_time_count_ = 0;
@@ -548,6 +616,21 @@ std::shared_ptr<Node> MakeUnknownRatioNode(Node::Args args);
 // as pass-through between inputs and output.
 std::shared_ptr<Node> MakeUnknownNode(Node::Args args);
 
+// Statistics of a node of an input pipeline, as saved in a profile by
+// `Model::SaveProfile()`.
+struct NodeProfile {
+  // The number of elements the node produced.
+  int64 num_elements = 0;
+  // The average time, in nanoseconds, the node spent producing an element,
+  // excluding the time spent in its inputs.
+  double processing_time = 0;
+  // The number of threads the node used to produce its elements.
+  double parallelism = 1;
+  // The average size, in bytes, of the elements the node buffered, or 0 if the
+  // node has no buffer.
+  double element_size = 0;
+};
+
 // Abstract representation of a TensorFlow input pipeline that can be used
 // for collecting runtime information and optimizing performance. It collects
 // runtime information about execution of the input pipeline that is used to
@@ -577,6 +660,10 @@ class Model {
   // Indicates whether to collect resource usage.
   bool collect_resource_usage() const { return collect_resource_usage_; }
 
+  // Collects resource usage even if no node has a tunable parameter, e.g. to
+  // profile an input pipeline that is not autotuned.
+  void CollectResourceUsage() { collect_resource_usage_ = true; }
+
   // Adds a node with the given name and given output.
   std::shared_ptr<Node> AddNode(Node::Factory factory, const string& name,
                                 const string& output_name) LOCKS_EXCLUDED(mu_);
@@ -591,9 +678,37 @@ class Model {
   // Records that a node has produced an element.
   void RecordElement(const string& name) LOCKS_EXCLUDED(mu_);
 
+  // Exports the per-element processing time percentiles and the buffer
+  // occupancy of every node to `stats_aggregator`, using the number of
+  // elements produced by the pipeline as the step.
+  //
+  // Processing times are only collected once the model has a tunable
+  // parameter (see `collect_resource_usage()`).
+  void RecordStats(StatsAggregator* stats_aggregator) LOCKS_EXCLUDED(mu_);
+
+  // Returns a human-readable report of where the input pipeline spends its
+  // time. Nodes are ranked by the processing time they add to each element of
+  // the pipeline, divided by their parallelism, and the report names the top
+  // node as the one whose speed-up would most improve the throughput.
+  string BottleneckReport() LOCKS_EXCLUDED(mu_);
+
   // Returns the number of elements that the input pipeline has produced.
   int64 NumElements(const string& name) LOCKS_EXCLUDED(mu_);
 
+  // Returns the statistics of every node, keyed by the prefix of the node's
+  // iterator.
+  std::map<string, NodeProfile> Profile() LOCKS_EXCLUDED(mu_);
+
+  // Writes the statistics of every node to the text file `path`, keyed by the
+  // prefix of the node's iterator, e.g. "Iterator::Model::Map::TensorSlice".
+  // Profiles of a warm-up epoch can be used to rewrite the input pipeline of
+  // later runs (see the `profile_guided_rewrite` tf.data optimization).
+  Status SaveProfile(Env* env, const string& path) LOCKS_EXCLUDED(mu_);
+
+  // Reads a profile written by `SaveProfile()`.
+  static Status LoadProfile(Env* env, const string& path,
+                            std::map<string, NodeProfile>* profile);
+
   // Records that the given node has started work. If `stop_output` is set, it
   // also records that the output of the given node has stopped work.
   void RecordStart(const string& name, bool stop_output) LOCKS_EXCLUDED(mu_);
@@ -636,6 +751,17 @@ class Model {
   // an element divided by CPU budget.
   void OptimizeGradientDescent(int64 cpu_budget, int64 ram_budget);
 
+  // This optimization algorithm tunes parallelism and buffer sizes jointly
+  // without ever letting the maximum buffered memory exceed `ram_budget`. It
+  // starts by setting all tunable parameters to the minimum value. It then
+  // repeatedly increments the parameter that decreases the output time the
+  // most per byte of additional buffer memory, among the increments that fit
+  // in the budget. Increments that need no extra memory are preferred. This
+  // process is repeated until no increment fits in the budget or decreases the
+  // output time, or the projected output time is less than or equal to the
+  // processing time needed to produce an element divided by CPU budget.
+  void OptimizeRamBudget(int64 cpu_budget, int64 ram_budget);
+
   // Collects the output time and if `gradient` is not `nullptr`, the output
   // time gradient w.r.t. tunable parameters of the subtree rooted in the given
   // node and the last input time.
@@ -16,7 +16,10 @@ limitations under the License.
 #include "tensorflow/core/framework/model.h"
 #include <memory>
 
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -450,6 +453,135 @@ TEST(SetterGetterTest, Node) {
   EXPECT_EQ(node->num_elements(), 1);
 }
 
+TEST(ElementProcessingTimeTest, Node) {
+  std::shared_ptr<Node> source = model::MakeSourceNode({0, "source", nullptr});
+  source->add_processing_time(100);
+  source->record_element();
+  source->add_processing_time(300);
+  source->record_element();
+  EXPECT_NEAR(source->ElementProcessingTimePercentile(0), 100, 10);
+  EXPECT_NEAR(source->ElementProcessingTimePercentile(100), 300, 30);
+
+  source->record_buffer_event(0, 3);
+  source->record_buffer_event(0, -2);
+  EXPECT_EQ(source->buffered_elements(), 1);
+  EXPECT_EQ(source->max_buffered_elements(), 3);
+}
+
+TEST(BottleneckReportTest, Model) {
+  Model model([](std::shared_ptr<Node>) {});
+  EXPECT_EQ(model.BottleneckReport(),
+            "No processing time has been recorded for the input pipeline.");
+
+  const int64 parallelism = 4;
+  model.AddNode(
+      [parallelism](Node::Args args) {
+        return model::MakeAsyncKnownRatioNode(
+            std::move(args), /*ratio=*/1,
+            {model::MakeParameter(
+                kParallelism,
+                std::make_shared<SharedState>(parallelism, nullptr, nullptr),
+                1, parallelism)});
+      },
+      "map", "");
+  model.AddNode(
+      [](Node::Args args) { return model::MakeSourceNode(std::move(args)); },
+      "map::source", "map");
+
+  // The map spends twice as much time as the source, but spreads it over four
+  // threads, so the source is the bottleneck.
+  model.AddProcessingTime("map", 8000);
+  model.AddProcessingTime("map::source", 4000);
+  model.RecordElement("map::source");
+  model.RecordElement("map");
+  string report = model.BottleneckReport();
+  EXPECT_TRUE(str_util::StrContains(report, "1 elements produced")) << report;
+  EXPECT_TRUE(str_util::StrContains(report, "Bottleneck: source(id:2)."))
+      << report;
+  EXPECT_LT(report.find("source(id:2): 66.7%"), report.find("map(id:1): 33.3%"))
+      << report;
+}
+
+TEST(ProfileTest, Model) {
+  Model model([](std::shared_ptr<Node>) {});
+  const int64 parallelism = 4;
+  model.AddNode(
+      [parallelism](Node::Args args) {
+        return model::MakeAsyncKnownRatioNode(
+            std::move(args), /*ratio=*/1,
+            {model::MakeParameter(
+                kParallelism,
+                std::make_shared<SharedState>(parallelism, nullptr, nullptr),
+                1, parallelism)});
+      },
+      "map", "");
+  model.AddNode(
+      [](Node::Args args) { return model::MakeSourceNode(std::move(args)); },
+      "map::source", "map");
+  model.AddProcessingTime("map", 8000);
+  model.AddProcessingTime("map::source", 4000);
+  for (int i = 0; i < 2; ++i) {
+    model.RecordElement("map::source");
+    model.RecordElement("map");
+  }
+
+  const string path = io::JoinPath(testing::TmpDir(), "model_profile");
+  TF_ASSERT_OK(model.SaveProfile(Env::Default(), path));
+  std::map<string, NodeProfile> profile;
+  TF_ASSERT_OK(Model::LoadProfile(Env::Default(), path, &profile));
+  ASSERT_EQ(profile.size(), 2);
+  EXPECT_EQ(profile["map"].num_elements, 2);
+  EXPECT_EQ(profile["map"].processing_time, 4000);
+  EXPECT_EQ(profile["map"].parallelism, parallelism);
+  EXPECT_EQ(profile["map::source"].num_elements, 2);
+  EXPECT_EQ(profile["map::source"].processing_time, 2000);
+  EXPECT_EQ(profile["map::source"].parallelism, 1);
+
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), path, "map\t2\tfoo\t1\t0\n"));
+  profile.clear();
+  EXPECT_EQ(Model::LoadProfile(Env::Default(), path, &profile).code(),
+            error::DATA_LOSS);
+}
+
+class RamBudgetTest : public ::testing::TestWithParam<int64> {};
+
+TEST_P(RamBudgetTest, Model) {
+  const int64 ram_budget = GetParam();
+  const int64 element_size = 1000;
+  auto state = std::make_shared<SharedState>(
+      model::kAutotune, std::make_shared<mutex>(),
+      std::make_shared<condition_variable>());
+  Model model([](std::shared_ptr<Node>) {});
+  std::shared_ptr<Node> map = model.AddNode(
+      [state](Node::Args args) {
+        return model::MakeAsyncKnownRatioNode(
+            std::move(args), /*ratio=*/1,
+            {model::MakeParameter(kParallelism, state, 1, 16)});
+      },
+      "map", "");
+  model.AddNode(
+      [](Node::Args args) { return model::MakeSourceNode(std::move(args)); },
+      "map::source", "map");
+  model.AddProcessingTime("map", 100000);
+  model.AddProcessingTime("map::source", 100);
+  model.RecordElement("map::source");
+  model.RecordElement("map");
+  // The buffer is empty when the model is optimized, but the size of the
+  // elements that went through it still counts against the budget.
+  map->record_buffer_event(element_size, 1);
+  map->record_buffer_event(-element_size, -1);
+
+  model.Optimize(AutotuneAlgorithm::RAM_BUDGET, /*cpu_budget=*/16, ram_budget);
+  EXPECT_GE(state->value, 1);
+  EXPECT_LE(state->value * element_size, std::max(ram_budget, element_size));
+  if (ram_budget >= 16 * element_size) {
+    EXPECT_EQ(state->value, 16);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Test, RamBudgetTest,
+                         ::testing::Values(0, 1000, 3500, 8000, 16000, 100000));
+
 // Returns a weighted sum of a prior and the actual processing time.
 double weighted_processing_time(int64 num_elements, double processing_time,
                                 double prior) {
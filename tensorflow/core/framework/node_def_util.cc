@@ -35,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/scanner.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/protobuf.h"
 
 namespace tensorflow {
@@ -120,6 +121,31 @@ string SummarizeAttrs(const NodeDef& node_def) {
   return SummarizeAttrsHelper(node_def, node_def.device());
 }
 
+uint64 NodeDefFingerprint(const NodeDef& node_def) {
+  uint64 fp = FingerprintCat64(Fingerprint64(node_def.name()),
+                               Fingerprint64(node_def.op()));
+  fp = FingerprintCat64(fp, Fingerprint64(node_def.device()));
+  fp = FingerprintCat64(fp, node_def.input_size());
+  for (const string& input : node_def.input()) {
+    fp = FingerprintCat64(fp, Fingerprint64(input));
+  }
+  std::vector<const AttrValueMap::value_type*> attrs;
+  attrs.reserve(node_def.attr_size());
+  for (const auto& attr : node_def.attr()) {
+    attrs.push_back(&attr);
+  }
+  std::sort(attrs.begin(), attrs.end(),
+            [](const AttrValueMap::value_type* a,
+               const AttrValueMap::value_type* b) {
+              return a->first < b->first;
+            });
+  for (const auto* attr : attrs) {
+    fp = FingerprintCat64(fp, Fingerprint64(attr->first));
+    fp = FingerprintCat64(fp, AttrValueFingerprint(attr->second));
+  }
+  return fp;
+}
+
 string FormatNodeForError(const NodeDebugInfo& debug_info) {
   return debug_info.original_node_names.empty()
              ? errors::FormatNodeNameForError(debug_info.name)
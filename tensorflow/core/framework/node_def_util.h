@@ -54,6 +54,11 @@ string SummarizeNodeDef(const NodeDef& node_def);
 string SummarizeAttrs(const NodeDef& node_def);
 string SummarizeAttrsHelper(AttrSlice attrs, StringPiece device);
 
+// Returns a fingerprint of the name, op, device, inputs and attrs of
+// `node_def` (see AttrValueFingerprint), which is stable across binaries.
+// The debug info does not contribute to it.
+uint64 NodeDefFingerprint(const NodeDef& node_def);
+
 // Produces a formatted string pattern from the node which can uniquely identify
 // this node upstream to produce an informative error message. The pattern
 // followed is: {{node <node_name>}}
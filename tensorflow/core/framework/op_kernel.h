@@ -670,6 +670,11 @@ class OpKernelContext {
     // stored in this container..
     ScopedStepContainer* step_container = nullptr;
 
+    // If not null, serves the allocations of this step whose attributes are
+    // step_scoped(): see StepArenaAllocator. allocate_temp() marks its
+    // allocations as step-scoped.
+    Allocator* step_allocator = nullptr;
+
     // Mechanism used by this op kernel invocation to communicate with
     // computations running on other devices.
     Rendezvous* rendezvous = nullptr;
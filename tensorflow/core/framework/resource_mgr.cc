@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 
 #include <atomic>
+#include <vector>
 
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -82,6 +83,7 @@ Status ValidateDevice(OpKernelContext* ctx, const ResourceHandle& p) {
 
 Status ResourceMgr::InsertDebugTypeName(uint64 hash_code,
                                         const string& type_name) {
+  mutex_lock l(debug_type_names_mu_);
   auto iter = debug_type_names_.emplace(hash_code, type_name);
   if (iter.first->second != type_name) {
     return errors::AlreadyExists("Duplicate hash code found for type ",
@@ -90,12 +92,13 @@ Status ResourceMgr::InsertDebugTypeName(uint64 hash_code,
   return Status::OK();
 }
 
-const char* ResourceMgr::DebugTypeName(uint64 hash_code) const {
+string ResourceMgr::DebugTypeName(uint64 hash_code) const {
+  mutex_lock l(debug_type_names_mu_);
   auto type_name_iter = debug_type_names_.find(hash_code);
   if (type_name_iter == debug_type_names_.end()) {
     return "<unknown>";
   } else {
-    return type_name_iter->second.c_str();
+    return type_name_iter->second;
   }
 }
 
@@ -109,56 +112,64 @@ ResourceMgr::~ResourceMgr() { Clear(); }
 void ResourceMgr::Clear() {
   // We do the deallocation outside of the lock to avoid a potential deadlock
   // in case any of the destructors access the resource manager.
-  std::unordered_map<string, Container*> tmp_containers;
-  {
-    mutex_lock l(mu_);
-    tmp_containers = std::move(containers_);
+  std::vector<std::unordered_map<string, Container*>> tmp_containers(
+      kNumShards);
+  for (int i = 0; i < kNumShards; ++i) {
+    mutex_lock l(shards_[i].mu);
+    tmp_containers[i] = std::move(shards_[i].containers);
+    shards_[i].containers.clear();
+    mutex_lock container_shards_lock(container_shards_mu_);
+    for (const auto& p : tmp_containers[i]) {
+      if (--container_shards_[p.first] == 0) {
+        container_shards_.erase(p.first);
+      }
+    }
   }
-  for (const auto& p : tmp_containers) {
-    for (const auto& q : *p.second) {
-      q.second->Unref();
+  generation_.fetch_add(1);
+  for (const auto& containers : tmp_containers) {
+    for (const auto& p : containers) {
+      for (const auto& q : *p.second) {
+        q.second->Unref();
+      }
+      delete p.second;
     }
-    delete p.second;
   }
-  tmp_containers.clear();
 }
 
 string ResourceMgr::DebugString() const {
-  mutex_lock l(mu_);
-  struct Line {
-    const string* container;
-    const string type;
-    const string* resource;
-    const string detail;
-  };
-  std::vector<Line> lines;
-  for (const auto& p : containers_) {
-    const string& container = p.first;
-    for (const auto& q : *p.second) {
-      const Key& key = q.first;
-      const char* type = DebugTypeName(key.first);
-      const string& resource = key.second;
-      Line l{&container, port::Demangle(type), &resource,
-             q.second->DebugString()};
-      lines.push_back(l);
-    }
-  }
   std::vector<string> text;
-  text.reserve(lines.size());
-  for (const Line& line : lines) {
-    text.push_back(strings::Printf(
-        "%-20s | %-40s | %-40s | %-s", line.container->c_str(),
-        line.type.c_str(), line.resource->c_str(), line.detail.c_str()));
+  for (const Shard& shard : shards_) {
+    mutex_lock l(shard.mu);
+    for (const auto& p : shard.containers) {
+      const string& container = p.first;
+      for (const auto& q : *p.second) {
+        const Key& key = q.first;
+        const string type = port::Demangle(DebugTypeName(key.first).c_str());
+        const string& resource = key.second;
+        text.push_back(strings::Printf("%-20s | %-40s | %-40s | %-s",
+                                       container.c_str(), type.c_str(),
+                                       resource.c_str(),
+                                       q.second->DebugString().c_str()));
+      }
+    }
   }
   std::sort(text.begin(), text.end());
   return absl::StrJoin(text, "\n");
 }
 
-Status ResourceMgr::DoCreate(const string& container, TypeIndex type,
-                             const string& name, ResourceBase* resource) {
-  Container** b = &containers_[container];
+bool ResourceMgr::ContainerExists(const string& container) const {
+  mutex_lock l(container_shards_mu_);
+  return container_shards_.count(container) > 0;
+}
+
+Status ResourceMgr::DoCreate(Shard* shard, const string& container,
+                             TypeIndex type, const string& name,
+                             ResourceBase* resource) {
+  Container** b = &shard->containers[container];
   if (*b == nullptr) {
     *b = new Container;
+    mutex_lock l(container_shards_mu_);
+    ++container_shards_[container];
   }
   if ((*b)->insert({{type.hash_code(), name}, resource}).second) {
     TF_RETURN_IF_ERROR(InsertDebugTypeName(type.hash_code(), type.name()));
@@ -169,16 +180,18 @@ Status ResourceMgr::DoCreate(const string& container, TypeIndex type,
                                type.name());
 }
 
-Status ResourceMgr::DoLookup(const string& container, TypeIndex type,
-                             const string& name,
+Status ResourceMgr::DoLookup(const Shard& shard, const string& container,
+                             TypeIndex type, const string& name,
                              ResourceBase** resource) const {
-  const Container* b = gtl::FindPtrOrNull(containers_, container);
-  if (b == nullptr) {
+  const Container* b = gtl::FindPtrOrNull(shard.containers, container);
+  if (b == nullptr && !ContainerExists(container)) {
     return errors::NotFound("Container ", container,
                             " does not exist. (Could not find resource: ",
                             container, "/", name, ")");
   }
-  auto r = gtl::FindPtrOrNull(*b, {type.hash_code(), name});
+  // The container may only have resources in other shards.
+  auto r = b == nullptr ? nullptr
+                        : gtl::FindPtrOrNull(*b, {type.hash_code(), name});
   if (r == nullptr) {
     return errors::NotFound("Resource ", container, "/", name, "/", type.name(),
                             " does not exist.");
@@ -193,19 +206,25 @@ Status ResourceMgr::DoDelete(const string& container, uint64 type_hash_code,
                              const string& type_name) {
   ResourceBase* base = nullptr;
   {
-    mutex_lock l(mu_);
-    Container* b = gtl::FindPtrOrNull(containers_, container);
-    if (b == nullptr) {
+    Shard* shard = &shards_[ShardIndex(type_hash_code, resource_name)];
+    mutex_lock l(shard->mu);
+    Container* b = gtl::FindPtrOrNull(shard->containers, container);
+    if (b == nullptr && !ContainerExists(container)) {
       return errors::NotFound("Container ", container, " does not exist.");
     }
-    auto iter = b->find({type_hash_code, resource_name});
-    if (iter == b->end()) {
+    // The container may only have resources in other shards.
+    auto iter = b == nullptr ? Container::iterator()
+                             : b->find({type_hash_code, resource_name});
+    if (b == nullptr || iter == b->end()) {
       return errors::NotFound("Resource ", container, "/", resource_name, "/",
                               type_name, " does not exist.");
     }
     base = iter->second;
     b->erase(iter);
   }
+  // The generation changes after the resource is removed, so that a lookup
+  // that is cached under the previous generation is not reused.
+  generation_.fetch_add(1);
   CHECK(base != nullptr);
   base->Unref();
   return Status::OK();
@@ -222,29 +241,39 @@ Status ResourceMgr::Delete(const ResourceHandle& handle) {
 }
 
 Status ResourceMgr::Cleanup(const string& container) {
-  {
-    tf_shared_lock l(mu_);
-    if (!gtl::FindOrNull(containers_, container)) {
-      // Nothing to cleanup.
-      return Status::OK();
+  std::vector<Container*> containers;
+  for (Shard& shard : shards_) {
+    {
+      tf_shared_lock l(shard.mu);
+      if (!gtl::FindOrNull(shard.containers, container)) {
+        // Nothing to cleanup.
+        continue;
+      }
     }
-  }
-  Container* b = nullptr;
-  {
-    mutex_lock l(mu_);
-    auto iter = containers_.find(container);
-    if (iter == containers_.end()) {
+    mutex_lock l(shard.mu);
+    auto iter = shard.containers.find(container);
+    if (iter == shard.containers.end()) {
       // Nothing to cleanup, it's OK (concurrent cleanup).
-      return Status::OK();
+      continue;
+    }
+    containers.push_back(iter->second);
+    shard.containers.erase(iter);
+    mutex_lock container_shards_lock(container_shards_mu_);
+    if (--container_shards_[container] == 0) {
+      container_shards_.erase(container);
     }
-    b = iter->second;
-    containers_.erase(iter);
   }
-  CHECK(b != nullptr);
-  for (const auto& p : *b) {
-    p.second->Unref();
+  if (containers.empty()) {
+    return Status::OK();
+  }
+  generation_.fetch_add(1);
+  for (Container* b : containers) {
+    CHECK(b != nullptr);
+    for (const auto& p : *b) {
+      p.second->Unref();
+    }
+    delete b;
   }
-  delete b;
   return Status::OK();
 }
 
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_RESOURCE_MGR_H_
 #define TENSORFLOW_CORE_FRAMEWORK_RESOURCE_MGR_H_
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <typeindex>
@@ -53,6 +54,10 @@ namespace tensorflow {
 // All resources for a given container can be dropped by one call of
 // Cleanup().
 //
+// The resources are sharded by type and name, and each shard is protected by
+// its own lock, so that concurrent lookups of different resources do not
+// contend with each other.
+//
 // E.g.,
 //   struct MyVar : public ResourceBase {
 //     mutex mu;
@@ -142,15 +147,23 @@ class ResourceMgr {
   Status Lookup(const string& container, const string& name,
                 T** resource) const TF_MUST_USE_RESULT;
 
-  // Similar to Lookup, but looks up multiple resources at once, with only a
-  // single lock acquisition.  If containers_and_names[i] is uninitialized
-  // then this function does not modify resources[i].
+  // Similar to Lookup, but looks up multiple resources at once.  If
+  // containers_and_names[i] is uninitialized then this function does not
+  // modify resources[i].
   template <typename T, bool use_dynamic_cast = false>
   Status LookupMany(absl::Span<std::pair<const string*, const string*> const>
                         containers_and_names,
                     std::vector<std::unique_ptr<T, core::RefCountDeleter>>*
                         resources) const TF_MUST_USE_RESULT;
 
+  // Appends every resource of type T, across all containers, to
+  // "*resources". The caller takes the ownership of one ref on each.
+  //
+  // REQUIRES: std::is_base_of<ResourceBase, T>
+  template <typename T>
+  void GetAll(std::vector<std::unique_ptr<T, core::RefCountDeleter>>*
+                  resources) const;
+
   // If "container" has a resource "name", returns it in
   // "*resource". Otherwise, invokes creator() to create the resource.
   // The caller takes the ownership of one ref on "*resource".
@@ -184,6 +197,13 @@ class ResourceMgr {
   // Returns a text description for all resources.
   string DebugString() const;
 
+  // Returns a counter that changes whenever a resource is removed from *this.
+  // A resource that was looked up while generation() returned g is still
+  // registered under the same container and name as long as generation()
+  // returns g, which lets callers cache the results of lookups (see
+  // ResourceLookupCache).
+  uint64 generation() const { return generation_.load(); }
+
  private:
   typedef std::pair<uint64, string> Key;
   struct KeyHash {
@@ -198,22 +218,45 @@ class ResourceMgr {
   };
   typedef std::unordered_map<Key, ResourceBase*, KeyHash, KeyEqual> Container;
 
+  // The resources whose keys hash to the same shard, grouped by container.
+  struct Shard {
+    mutable mutex mu;
+    std::unordered_map<string, Container*> containers GUARDED_BY(mu);
+  };
+  static constexpr int kNumShards = 16;
+
   const string default_container_;
-  mutable mutex mu_;
-  std::unordered_map<string, Container*> containers_ GUARDED_BY(mu_);
+  Shard shards_[kNumShards];
+  std::atomic<uint64> generation_{0};
+
+  // The number of shards that hold each container, which tells a missing
+  // container apart from a container that has no resource in a given shard.
+  // Only acquired while holding at most one shard lock.
+  mutable mutex container_shards_mu_;
+  std::unordered_map<string, int> container_shards_
+      GUARDED_BY(container_shards_mu_);
+
+  // Returns true if any shard holds "container".
+  bool ContainerExists(const string& container) const;
+
+  // Returns the index of the shard that holds the resource with the given
+  // type and name.
+  static int ShardIndex(uint64 type_hash_code, const string& name) {
+    return KeyHash()({type_hash_code, name}) % kNumShards;
+  }
 
   template <typename T, bool use_dynamic_cast = false>
-  Status LookupInternal(const string& container, const string& name,
-                        T** resource) const
-      SHARED_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
+  Status LookupInternal(const Shard& shard, const string& container,
+                        const string& name, T** resource) const
+      SHARED_LOCKS_REQUIRED(shard.mu) TF_MUST_USE_RESULT;
 
-  Status DoCreate(const string& container, TypeIndex type, const string& name,
-                  ResourceBase* resource)
-      EXCLUSIVE_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
+  Status DoCreate(Shard* shard, const string& container, TypeIndex type,
+                  const string& name, ResourceBase* resource)
+      EXCLUSIVE_LOCKS_REQUIRED(shard->mu) TF_MUST_USE_RESULT;
 
-  Status DoLookup(const string& container, TypeIndex type, const string& name,
-                  ResourceBase** resource) const
-      SHARED_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
+  Status DoLookup(const Shard& shard, const string& container, TypeIndex type,
+                  const string& name, ResourceBase** resource) const
+      SHARED_LOCKS_REQUIRED(shard.mu) TF_MUST_USE_RESULT;
 
   Status DoDelete(const string& container, uint64 type_hash_code,
                   const string& resource_name,
@@ -222,17 +265,18 @@ class ResourceMgr {
                   const string& resource_name) TF_MUST_USE_RESULT;
 
   // Inserts the type name for 'hash_code' into the hash_code to type name map.
-  Status InsertDebugTypeName(uint64 hash_code, const string& type_name)
-      EXCLUSIVE_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
+  Status InsertDebugTypeName(uint64 hash_code,
+                             const string& type_name) TF_MUST_USE_RESULT;
 
   // Returns the type name for the 'hash_code'.
   // Returns "<unknown>" if a resource with such a type was never inserted into
   // the container.
-  const char* DebugTypeName(uint64 hash_code) const
-      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  string DebugTypeName(uint64 hash_code) const;
 
   // Map from type hash_code to type name.
-  std::unordered_map<uint64, string> debug_type_names_ GUARDED_BY(mu_);
+  mutable mutex debug_type_names_mu_;
+  std::unordered_map<uint64, string> debug_type_names_
+      GUARDED_BY(debug_type_names_mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(ResourceMgr);
 };
@@ -312,6 +356,38 @@ Status LookupOrCreateResource(OpKernelContext* ctx, const ResourceHandle& p,
                               core::RefCountPtr<T>* value,
                               std::function<Status(T**)> creator);
 
+// Caches the resource that a kernel last looked up from a handle, so that a
+// kernel that accesses the same resource on every step does not look it up
+// in the ResourceMgr each time. A cached resource is reused only while the
+// generation of its ResourceMgr is unchanged, i.e. while no resource has been
+// removed since the lookup.
+//
+// The cache holds a ref on the cached resource, which is released when the
+// kernel looks up another resource, or finds that the generation changed, or
+// is destroyed.
+template <typename T>
+class ResourceLookupCache {
+ public:
+  ResourceLookupCache() {}
+  ~ResourceLookupCache() {
+    if (resource_ != nullptr) resource_->Unref();
+  }
+
+  // Same as LookupResource(ctx, p, value).
+  Status Lookup(OpKernelContext* ctx, const ResourceHandle& p,
+                core::RefCountPtr<T>* value) TF_MUST_USE_RESULT;
+
+ private:
+  mutex mu_;
+  const ResourceMgr* resource_mgr_ GUARDED_BY(mu_) = nullptr;
+  uint64 generation_ GUARDED_BY(mu_) = 0;
+  string container_ GUARDED_BY(mu_);
+  string name_ GUARDED_BY(mu_);
+  T* resource_ GUARDED_BY(mu_) = nullptr;  // owns one ref
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ResourceLookupCache);
+};
+
 // Destroys a resource pointed by a given resource handle.
 template <typename T>
 Status DeleteResource(OpKernelContext* ctx, const ResourceHandle& p);
@@ -530,16 +606,20 @@ Status ResourceMgr::Create(const string& container, const string& name,
                            T* resource) {
   CheckDeriveFromResourceBase<T>();
   CHECK(resource != nullptr);
-  mutex_lock l(mu_);
-  return DoCreate(container, MakeTypeIndex<T>(), name, resource);
+  const TypeIndex type = MakeTypeIndex<T>();
+  Shard* shard = &shards_[ShardIndex(type.hash_code(), name)];
+  mutex_lock l(shard->mu);
+  return DoCreate(shard, container, type, name, resource);
 }
 
 template <typename T, bool use_dynamic_cast>
 Status ResourceMgr::Lookup(const string& container, const string& name,
                            T** resource) const {
   CheckDeriveFromResourceBase<T>();
-  tf_shared_lock l(mu_);
-  return LookupInternal<T, use_dynamic_cast>(container, name, resource);
+  const Shard& shard =
+      shards_[ShardIndex(MakeTypeIndex<T>().hash_code(), name)];
+  tf_shared_lock l(shard.mu);
+  return LookupInternal<T, use_dynamic_cast>(shard, container, name, resource);
 }
 
 template <typename T, bool use_dynamic_cast>
@@ -548,13 +628,15 @@ Status ResourceMgr::LookupMany(
         containers_and_names,
     std::vector<std::unique_ptr<T, core::RefCountDeleter>>* resources) const {
   CheckDeriveFromResourceBase<T>();
-  tf_shared_lock l(mu_);
+  const uint64 type_hash_code = MakeTypeIndex<T>().hash_code();
   resources->resize(containers_and_names.size());
   for (size_t i = 0; i < containers_and_names.size(); ++i) {
+    const string& name = *containers_and_names[i].second;
+    const Shard& shard = shards_[ShardIndex(type_hash_code, name)];
+    tf_shared_lock l(shard.mu);
     T* resource;
     Status s = LookupInternal<T, use_dynamic_cast>(
-        *containers_and_names[i].first, *containers_and_names[i].second,
-        &resource);
+        shard, *containers_and_names[i].first, name, &resource);
     if (s.ok()) {
       (*resources)[i].reset(resource);
     }
@@ -562,6 +644,24 @@ Status ResourceMgr::LookupMany(
   return Status::OK();
 }
 
+template <typename T>
+void ResourceMgr::GetAll(
+    std::vector<std::unique_ptr<T, core::RefCountDeleter>>* resources) const {
+  CheckDeriveFromResourceBase<T>();
+  const uint64 type_hash_code = MakeTypeIndex<T>().hash_code();
+  for (const Shard& shard : shards_) {
+    tf_shared_lock l(shard.mu);
+    for (const auto& container : shard.containers) {
+      for (const auto& entry : *container.second) {
+        if (entry.first.first != type_hash_code) continue;
+        T* resource = static_cast<T*>(entry.second);
+        resource->Ref();
+        resources->emplace_back(resource);
+      }
+    }
+  }
+}
+
 // Simple wrapper to allow conditional dynamic / static casts.
 template <typename T, bool use_dynamic_cast>
 struct TypeCastFunctor {
@@ -574,10 +674,10 @@ struct TypeCastFunctor<T, true> {
 };
 
 template <typename T, bool use_dynamic_cast>
-Status ResourceMgr::LookupInternal(const string& container, const string& name,
-                                   T** resource) const {
+Status ResourceMgr::LookupInternal(const Shard& shard, const string& container,
+                                   const string& name, T** resource) const {
   ResourceBase* found = nullptr;
-  Status s = DoLookup(container, MakeTypeIndex<T>(), name, &found);
+  Status s = DoLookup(shard, container, MakeTypeIndex<T>(), name, &found);
   if (s.ok()) {
     // It's safe to down cast 'found' to T* since
     // typeid(T).hash_code() is part of the map key.
@@ -592,17 +692,19 @@ Status ResourceMgr::LookupOrCreate(const string& container, const string& name,
                                    std::function<Status(T**)> creator) {
   CheckDeriveFromResourceBase<T>();
   *resource = nullptr;
+  const TypeIndex type = MakeTypeIndex<T>();
+  Shard* shard = &shards_[ShardIndex(type.hash_code(), name)];
   Status s;
   {
-    tf_shared_lock l(mu_);
-    s = LookupInternal<T, use_dynamic_cast>(container, name, resource);
+    tf_shared_lock l(shard->mu);
+    s = LookupInternal<T, use_dynamic_cast>(*shard, container, name, resource);
     if (s.ok()) return s;
   }
-  mutex_lock l(mu_);
-  s = LookupInternal<T, use_dynamic_cast>(container, name, resource);
+  mutex_lock l(shard->mu);
+  s = LookupInternal<T, use_dynamic_cast>(*shard, container, name, resource);
   if (s.ok()) return s;
   TF_RETURN_IF_ERROR(creator(resource));
-  s = DoCreate(container, MakeTypeIndex<T>(), name, *resource);
+  s = DoCreate(shard, container, type, name, *resource);
   if (!s.ok()) {
     return errors::Internal("LookupOrCreate failed unexpectedly");
   }
@@ -693,6 +795,46 @@ Status LookupResource(OpKernelContext* ctx, const ResourceHandle& p,
   return Status::OK();
 }
 
+template <typename T>
+Status ResourceLookupCache<T>::Lookup(OpKernelContext* ctx,
+                                      const ResourceHandle& p,
+                                      core::RefCountPtr<T>* value) {
+  TF_RETURN_IF_ERROR(internal::ValidateDeviceAndType<T>(ctx, p));
+  ResourceMgr* resource_mgr = ctx->resource_manager();
+  // The generation is read before the lookup, so that a resource that is
+  // removed concurrently with the lookup is not cached under it.
+  const uint64 generation = resource_mgr->generation();
+  {
+    tf_shared_lock l(mu_);
+    if (resource_ != nullptr && resource_mgr_ == resource_mgr &&
+        generation_ == generation && name_ == p.name() &&
+        container_ == p.container()) {
+      resource_->Ref();
+      value->reset(resource_);
+      return Status::OK();
+    }
+  }
+  T* resource = nullptr;
+  TF_RETURN_IF_ERROR(
+      resource_mgr->Lookup<T>(p.container(), p.name(), &resource));
+  value->reset(resource);
+  resource->Ref();
+  T* evicted = nullptr;
+  {
+    mutex_lock l(mu_);
+    evicted = resource_;
+    resource_mgr_ = resource_mgr;
+    generation_ = generation;
+    container_ = p.container();
+    name_ = p.name();
+    resource_ = resource;
+  }
+  // The last ref on the evicted resource may be released here, which runs its
+  // destructor, so it is done outside of the lock.
+  if (evicted != nullptr) evicted->Unref();
+  return Status::OK();
+}
+
 template <typename T>
 Status LookupResources(OpKernelContext* ctx,
                        absl::Span<ResourceHandle const* const> p,
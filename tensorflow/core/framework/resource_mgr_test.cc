@@ -162,6 +162,54 @@ TEST(ResourceMgrTest, CreateOrLookupRaceCondition) {
   EXPECT_EQ(1, atomic_int);
 }
 
+TEST(ResourceMgrTest, ManyResources) {
+  // The resources of a container are spread over the shards of the manager.
+  ResourceMgr rm;
+  for (int i = 0; i < 100; ++i) {
+    TF_CHECK_OK(rm.Create("foo", strings::StrCat("r", i),
+                          new Resource(strings::StrCat(i))));
+  }
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(strings::StrCat("R/", i),
+              Find<Resource>(rm, "foo", strings::StrCat("r", i)));
+  }
+  std::vector<std::unique_ptr<Resource, core::RefCountDeleter>> all;
+  rm.GetAll(&all);
+  EXPECT_EQ(100, all.size());
+  all.clear();
+  for (int i = 0; i < 100; ++i) {
+    HasError(FindErr<Resource>(rm, "foo", strings::StrCat("xxx", i)),
+             "Not found: Resource foo/xxx");
+    HasError(rm.Delete<Resource>("foo", strings::StrCat("xxx", i)),
+             "Not found: Resource foo/xxx");
+  }
+
+  TF_CHECK_OK(rm.Cleanup("foo"));
+  for (int i = 0; i < 100; ++i) {
+    HasError(FindErr<Resource>(rm, "foo", strings::StrCat("r", i)),
+             "Not found: Container foo");
+  }
+}
+
+TEST(ResourceMgrTest, Generation) {
+  ResourceMgr rm;
+  const uint64 initial = rm.generation();
+  TF_CHECK_OK(rm.Create("foo", "bar", new Resource("cat")));
+  TF_CHECK_OK(rm.Create("foo", "baz", new Resource("dog")));
+  EXPECT_EQ("R/cat", Find<Resource>(rm, "foo", "bar"));
+  EXPECT_EQ(initial, rm.generation());
+
+  TF_CHECK_OK(rm.Delete<Resource>("foo", "bar"));
+  const uint64 after_delete = rm.generation();
+  EXPECT_NE(initial, after_delete);
+
+  // Cleaning up a missing container removes nothing.
+  TF_CHECK_OK(rm.Cleanup("bar"));
+  EXPECT_EQ(after_delete, rm.generation());
+  TF_CHECK_OK(rm.Cleanup("foo"));
+  EXPECT_NE(after_delete, rm.generation());
+}
+
 Status ComputePolicy(const string& attr_container,
                      const string& attr_shared_name,
                      bool use_node_name_as_default, string* result) {
@@ -324,6 +372,49 @@ TEST(ResourceHandleTest, DifferentType) {
   r->Unref();
 }
 
+TEST(ResourceHandleTest, LookupCache) {
+  ResourceMgr resource_mgr("");
+  OpKernelContext::Params params;
+  params.resource_manager = &resource_mgr;
+  StubDevice device("device_name");
+  params.device = &device;
+  OpKernelContext ctx(&params, 0);
+
+  ResourceHandle p = MakeResourceHandle<StubResource>(&ctx, "container", "p");
+  ResourceHandle q = MakeResourceHandle<StubResource>(&ctx, "container", "q");
+  auto* r = new StubResource();
+  r->value_ = 42;
+  TF_ASSERT_OK(CreateResource(&ctx, p, r));
+  auto* s = new StubResource();
+  s->value_ = 43;
+  TF_ASSERT_OK(CreateResource(&ctx, q, s));
+
+  ResourceLookupCache<StubResource> cache;
+  core::RefCountPtr<StubResource> lookup_r;
+  TF_ASSERT_OK(cache.Lookup(&ctx, p, &lookup_r));
+  EXPECT_EQ(lookup_r.get(), r);
+  TF_ASSERT_OK(cache.Lookup(&ctx, p, &lookup_r));
+  EXPECT_EQ(lookup_r.get(), r);
+  TF_ASSERT_OK(cache.Lookup(&ctx, q, &lookup_r));
+  EXPECT_EQ(lookup_r.get(), s);
+  lookup_r.reset();
+
+  // The cache does not return a resource that has been deleted, or replaced.
+  TF_ASSERT_OK(DeleteResource<StubResource>(&ctx, q));
+  EXPECT_TRUE(errors::IsNotFound(cache.Lookup(&ctx, q, &lookup_r)));
+  auto* t = new StubResource();
+  t->value_ = 44;
+  TF_ASSERT_OK(CreateResource(&ctx, q, t));
+  TF_ASSERT_OK(cache.Lookup(&ctx, q, &lookup_r));
+  EXPECT_EQ(lookup_r.get(), t);
+  EXPECT_EQ(44, lookup_r->value_);
+
+  // The handle is validated on every lookup.
+  ResourceHandle wrong_type =
+      MakeResourceHandle<OtherStubResource>(&ctx, "container", "q");
+  EXPECT_FALSE(cache.Lookup(&ctx, wrong_type, &lookup_r).ok());
+}
+
 TEST(ResourceHandleTest, DeleteUsingResourceHandle) {
   ResourceMgr resource_mgr("");
   OpKernelContext::Params params;
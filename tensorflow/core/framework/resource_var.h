@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_RESOURCE_VAR_H_
 #define TENSORFLOW_CORE_FRAMEWORK_RESOURCE_VAR_H_
 
+#include <vector>
+
 #include "tensorflow/core/framework/resource_mgr.h"
 
 namespace tensorflow {
@@ -87,10 +89,73 @@ class Var : public ResourceBase {
   // so desired.
   std::atomic<bool> copy_on_read_mode{false};
 
+  // Tracks the rows (slices in the first dimension) modified since the last
+  // reset, so that delta checkpoints only save those.  Until the first reset,
+  // and after an update whose rows are not known, all rows count as modified.
+  // Updates record their rows while holding mu() in any mode.
+  void RecordModifiedRows(const Tensor& indices) {
+    if (!tracks_modified_rows_.load()) return;
+    if (indices.dtype() == DT_INT32) {
+      RecordIndices<int32>(indices);
+    } else if (indices.dtype() == DT_INT64) {
+      RecordIndices<int64>(indices);
+    } else {
+      RecordAllRowsModified();
+    }
+  }
+  void RecordAllRowsModified() {
+    if (!tracks_modified_rows_.load()) return;
+    mutex_lock l(modified_rows_mu_);
+    all_rows_modified_ = true;
+    modified_rows_.clear();
+  }
+
+  // Returns true if all rows count as modified, or else sets "*rows" to the
+  // modified rows in increasing order.  Then, if "reset" is true, starts
+  // tracking the rows modified from now on.
+  bool GetModifiedRows(bool reset, std::vector<int64>* rows) {
+    mutex_lock l(modified_rows_mu_);
+    const bool all_rows = all_rows_modified_;
+    rows->clear();
+    if (!all_rows) {
+      for (size_t row = 0; row < modified_rows_.size(); ++row) {
+        if (modified_rows_[row]) rows->push_back(row);
+      }
+    }
+    if (reset) {
+      all_rows_modified_ = false;
+      modified_rows_.clear();
+      tracks_modified_rows_.store(true);
+    }
+    return all_rows;
+  }
+
  private:
+  template <typename Index>
+  void RecordIndices(const Tensor& indices) {
+    const int64 num_rows = tensor_.dims() > 0 ? tensor_.dim_size(0) : 0;
+    const auto indices_flat = indices.flat<Index>();
+    mutex_lock l(modified_rows_mu_);
+    if (all_rows_modified_) return;
+    if (modified_rows_.size() < static_cast<size_t>(num_rows)) {
+      modified_rows_.resize(num_rows);
+    }
+    for (int64 i = 0; i < indices_flat.size(); ++i) {
+      const int64 row = indices_flat(i);
+      // Invalid indices fail the update.
+      if (row >= 0 && row < num_rows) modified_rows_[row] = true;
+    }
+  }
+
   mutex mu_;
   Tensor tensor_;
 
+  std::atomic<bool> tracks_modified_rows_{false};
+  mutex modified_rows_mu_;
+  bool all_rows_modified_ GUARDED_BY(modified_rows_mu_) = true;
+  // Indexed by row.
+  std::vector<bool> modified_rows_ GUARDED_BY(modified_rows_mu_);
+
   ~Var() override {}
   TF_DISALLOW_COPY_AND_ASSIGN(Var);
 };
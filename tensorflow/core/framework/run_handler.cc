@@ -23,6 +23,8 @@ limitations under the License.
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/run_handler_util.h"
 #include "tensorflow/core/lib/core/threadpool_interface.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/denormal.h"
@@ -37,6 +39,58 @@ namespace tensorflow {
 namespace {
 static constexpr int32 kMaxConcurrentHandlers = 128;
 
+auto* run_handler_queueing_delay_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/run_handler_queueing_delay_usecs",
+     "The time a run waits in RunHandlerPool::Get() for a handler, in "
+     "microseconds.",
+     "priority"},
+    // Power of 2 with bucket count 24 (> 16 seconds)
+    {monitoring::Buckets::Exponential(1, 2, 24)});
+
+auto* run_handler_pending_requests = monitoring::Gauge<int64, 0>::New(
+    "/tensorflow/core/run_handler_pending_requests",
+    "The number of runs waiting in RunHandlerPool::Get() for a handler.");
+
+// The position of a run in the scheduling order of RunHandlerPool.
+struct SchedulingKey {
+  int64 priority = 0;
+  // Absolute deadline in microseconds, or 0 if the run has none.
+  uint64 deadline_us = 0;
+  // When the run asked for a handler, in microseconds.
+  uint64 request_time_us = 0;
+};
+
+SchedulingKey MakeSchedulingKey(
+    const RunOptions::Experimental::RunHandlerPoolOptions& options) {
+  SchedulingKey key;
+  key.priority = options.priority();
+  key.request_time_us = Env::Default()->NowMicros();
+  if (options.deadline_in_us() > 0) {
+    key.deadline_us = key.request_time_us + options.deadline_in_us();
+  }
+  return key;
+}
+
+// Returns true if the run with key 'a' should be scheduled before the run
+// with key 'b' at time 'now_us'.  Runs that have been waiting or running for
+// at least 'starvation_limit_us' go first, in arrival order; the others are
+// ordered by priority, then earliest deadline, then arrival.
+bool SchedulesBefore(const SchedulingKey& a, const SchedulingKey& b,
+                     uint64 now_us, uint64 starvation_limit_us) {
+  const bool a_starved = now_us - a.request_time_us >= starvation_limit_us;
+  const bool b_starved = now_us - b.request_time_us >= starvation_limit_us;
+  if (a_starved != b_starved) return a_starved;
+  if (!a_starved) {
+    if (a.priority != b.priority) return a.priority > b.priority;
+    if (a.deadline_us != b.deadline_us) {
+      if (a.deadline_us == 0) return false;
+      if (b.deadline_us == 0) return true;
+      return a.deadline_us < b.deadline_us;
+    }
+  }
+  return a.request_time_us < b.request_time_us;
+}
+
 // TODO(azaks): Refactor with thread:ThreadPool
 class RunHandlerEnvironment {
   typedef Thread EnvThread;
@@ -586,13 +640,14 @@ class RunHandler::Impl {
   }
 
   // Stores now time (in microseconds) since unix epoch when the handler is
-  // requested via RunHandlerPool::Get().
+  // handed out by RunHandlerPool::Get().
   uint64 start_time_us() const { return start_time_us_; }
   int64 step_id() const { return step_id_; }
+  const SchedulingKey& scheduling_key() const { return scheduling_key_; }
   void ScheduleInterOpClosure(std::function<void()> fn);
   void ScheduleIntraOpClosure(std::function<void()> fn);
 
-  void Reset(int64 step_id);
+  void Reset(int64 step_id, const SchedulingKey& scheduling_key);
 
   RunHandlerPool::Impl* pool_impl() { return pool_impl_; }
 
@@ -615,6 +670,7 @@ class RunHandler::Impl {
   RunHandlerPool::Impl* pool_impl_;  // NOT OWNED.
   uint64 start_time_us_;
   int64 step_id_;
+  SchedulingKey scheduling_key_;
   std::unique_ptr<thread::ThreadPoolInterface> thread_pool_interface_;
   ThreadWorkSource tws_;
 };
@@ -630,6 +686,8 @@ class RunHandlerPool::Impl {
         run_handler_thread_pool_(new RunHandlerThreadPool(
             num_inter_op_threads, num_intra_op_threads, Env::Default(),
             ThreadOptions(), "tf_run_handler_pool")),
+        starvation_limit_us_(static_cast<uint64>(ParamFromEnvWithDefault(
+            "TF_RUN_HANDLER_STARVATION_LIMIT_US", 100000))),
         iterations_(0) {
     VLOG(1) << "Creating a RunHandlerPool with max handlers: " << max_handlers_;
     for (int i = 0; i < max_handlers_; ++i) {
@@ -654,22 +712,39 @@ class RunHandlerPool::Impl {
     return run_handler_thread_pool_.get();
   }
 
-  std::unique_ptr<RunHandler> Get(int64 step_id) LOCKS_EXCLUDED(mu_) {
-    mutex_lock l(mu_);
-    while (free_handlers_.empty()) {
-      one_handler_free_.wait(l);
+  std::unique_ptr<RunHandler> Get(
+      int64 step_id,
+      const RunOptions::Experimental::RunHandlerPoolOptions& options)
+      LOCKS_EXCLUDED(mu_) {
+    const SchedulingKey key = MakeSchedulingKey(options);
+    RunHandler::Impl* handler_impl;
+    bool wake_next_request;
+    {
+      mutex_lock l(mu_);
+      pending_requests_.push_back(&key);
+      run_handler_pending_requests->GetCell()->Set(pending_requests_.size());
+      while (free_handlers_.empty() || NextPendingRequestLocked() != &key) {
+        one_handler_free_.wait(l);
+      }
+      pending_requests_.erase(std::find(pending_requests_.begin(),
+                                        pending_requests_.end(), &key));
+      run_handler_pending_requests->GetCell()->Set(pending_requests_.size());
+      // Remove the last entry from free_handlers_ and add it to
+      // sorted_active_handlers_, which RecomputePoolStatsLocked() re-sorts.
+      handler_impl = free_handlers_.back();
+      handler_impl->Reset(step_id, key);
+      sorted_active_handlers_.push_back(handler_impl);
+      DCHECK_LE(sorted_active_handlers_.size(), max_handlers_);
+      free_handlers_.pop_back();
+
+      RecomputePoolStatsLocked();
+      wake_next_request = !free_handlers_.empty() && !pending_requests_.empty();
+    }
+    if (wake_next_request) {
+      one_handler_free_.notify_all();
     }
-    // Remove the last entry from free_handlers_ and add to the end of
-    // sorted_active_handlers_.
-    auto* handler_impl = free_handlers_.back();
-    handler_impl->Reset(step_id);
-    // Sortedness isn't violated if we simply add at the end of the list, since
-    // handlers are expected to be obtained in increasing order of time.
-    sorted_active_handlers_.push_back(handler_impl);
-    DCHECK_LE(sorted_active_handlers_.size(), max_handlers_);
-    free_handlers_.pop_back();
-
-    RecomputePoolStatsLocked();
+    run_handler_queueing_delay_usecs->GetCell(strings::StrCat(key.priority))
+        ->Add(Env::Default()->NowMicros() - key.request_time_us);
     return WrapUnique<RunHandler>(new RunHandler(handler_impl));
   }
 
@@ -701,12 +776,17 @@ class RunHandlerPool::Impl {
 
       RecomputePoolStatsLocked();
     }
-    one_handler_free_.notify_one();
+    // Every waiter checks whether it is the next request to be served, so
+    // all of them have to be woken up.
+    one_handler_free_.notify_all();
   }
 
  private:
   void RecomputePoolStatsLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Returns the pending request that should get the next free handler.
+  const SchedulingKey* NextPendingRequestLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Maximum number of handlers pre-created during pool construction time. The
   // number has been chosen expecting each handler might at least want 1
   // inter-op thread for execution (during compute intensive workloads like
@@ -714,10 +794,13 @@ class RunHandlerPool::Impl {
   const int max_handlers_;
 
   std::unique_ptr<RunHandlerThreadPool> run_handler_thread_pool_;
+  // Runs waiting or running for longer than this outrank all others.
+  const uint64 starvation_limit_us_;
   // Thread compatible part used only by lock under RunHandlerPool.
-  // Handlers are sorted by start time.
-  // TODO(azaks): sort by the remaining latency budget.
+  // Handlers are sorted by SchedulesBefore() on their scheduling keys.
   std::vector<RunHandler::Impl*> sorted_active_handlers_ GUARDED_BY(mu_);
+  // Callers of Get() waiting for a free handler.
+  std::vector<const SchedulingKey*> pending_requests_ GUARDED_BY(mu_);
   std::vector<RunHandler::Impl*> free_handlers_ GUARDED_BY(mu_);
   std::vector<std::unique_ptr<RunHandler::Impl>> handlers_ GUARDED_BY(mu_);
   // Histogram of elapsed runtime of every handler (in ms).
@@ -728,9 +811,28 @@ class RunHandlerPool::Impl {
   mutex mu_;
 };
 
+const SchedulingKey* RunHandlerPool::Impl::NextPendingRequestLocked() {
+  DCHECK(!pending_requests_.empty());
+  if (pending_requests_.size() == 1) return pending_requests_[0];
+  const uint64 now = tensorflow::Env::Default()->NowMicros();
+  return *std::min_element(
+      pending_requests_.begin(), pending_requests_.end(),
+      [this, now](const SchedulingKey* a, const SchedulingKey* b) {
+        return SchedulesBefore(*a, *b, now, starvation_limit_us_);
+      });
+}
+
 void RunHandlerPool::Impl::RecomputePoolStatsLocked() {
   int num_active_requests = sorted_active_handlers_.size();
   if (num_active_requests == 0) return;
+
+  const uint64 now_us = tensorflow::Env::Default()->NowMicros();
+  std::stable_sort(
+      sorted_active_handlers_.begin(), sorted_active_handlers_.end(),
+      [this, now_us](const RunHandler::Impl* a, const RunHandler::Impl* b) {
+        return SchedulesBefore(a->scheduling_key(), b->scheduling_key(),
+                               now_us, starvation_limit_us_);
+      });
   Eigen::MaxSizeVector<ThreadWorkSource*> thread_work_sources(
       num_active_requests);
 
@@ -803,7 +905,7 @@ void RunHandler::Impl::ThreadPoolInterfaceWrapper::Schedule(
 RunHandler::Impl::Impl(RunHandlerPool::Impl* pool_impl)
     : pool_impl_(pool_impl) {
   thread_pool_interface_.reset(new ThreadPoolInterfaceWrapper(this));
-  Reset(0);
+  Reset(0, SchedulingKey());
 }
 
 void RunHandler::Impl::ScheduleInterOpClosure(std::function<void()> fn) {
@@ -818,9 +920,11 @@ void RunHandler::Impl::ScheduleIntraOpClosure(std::function<void()> fn) {
                                                         std::move(fn));
 }
 
-void RunHandler::Impl::Reset(int64 step_id) {
+void RunHandler::Impl::Reset(int64 step_id,
+                             const SchedulingKey& scheduling_key) {
   start_time_us_ = tensorflow::Env::Default()->NowMicros();
   step_id_ = step_id;
+  scheduling_key_ = scheduling_key;
   tws_.SetTracemeId(step_id);
 }
 
@@ -833,8 +937,10 @@ RunHandlerPool::RunHandlerPool(int num_inter_op_threads,
 
 RunHandlerPool::~RunHandlerPool() {}
 
-std::unique_ptr<RunHandler> RunHandlerPool::Get(int64 step_id) {
-  return impl_->Get(step_id);
+std::unique_ptr<RunHandler> RunHandlerPool::Get(
+    int64 step_id,
+    const RunOptions::Experimental::RunHandlerPoolOptions& options) {
+  return impl_->Get(step_id, options);
 }
 
 RunHandler::RunHandler(Impl* impl) : impl_(impl) {}
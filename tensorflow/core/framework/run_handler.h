@@ -61,8 +61,18 @@ class RunHandlerPool {
   // and is being used by a client.  It becomes 'inactive' once more when the
   // unique_ptr is destroyed.
   //
-  // Will block unless there is an inactive handler.
-  std::unique_ptr<RunHandler> Get(int64 step_id = 0);
+  // Will block unless there is an inactive handler.  When several callers are
+  // blocked, handlers go to them in the order described below.
+  //
+  // Active handlers are ranked by `options`: a higher priority first, then
+  // the earliest deadline, then the earliest Get() call.  Higher ranked
+  // handlers are preferred by more pool threads.  To keep low priority runs
+  // from starving, a handler that has been active for longer than
+  // TF_RUN_HANDLER_STARVATION_LIMIT_US microseconds outranks all others.
+  std::unique_ptr<RunHandler> Get(
+      int64 step_id = 0,
+      const RunOptions::Experimental::RunHandlerPoolOptions& options =
+          RunOptions::Experimental::RunHandlerPoolOptions());
 
  private:
   class Impl;
@@ -74,7 +84,7 @@ class RunHandlerPool {
 // RunHandler can be used to schedule inter/intra-op closures to run on a global
 // pool shared across all Session::Run(s). The closures are enqueued to a
 // handler specific queue, from which the work is stolen in a priority order
-// (time of the Get() call).
+// (the ranking described in RunHandlerPool::Get()).
 //
 // It can only be created via RunHandlerPool::Get().
 //
@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -72,5 +73,35 @@ TEST(RunHandlerUtilTest, TestBasicScheduling) {
   counter.Wait();
 }
 
+TEST(RunHandlerUtilTest, TestPriorityScheduling) {
+  setenv("TF_RUN_HANDLER_MAX_CONCURRENT_HANDLERS", "1", true);
+  setenv("TF_RUN_HANDLER_STARVATION_LIMIT_US", "1000000000", true);
+  std::unique_ptr<RunHandlerPool> pool(new RunHandlerPool(1, 1));
+  unsetenv("TF_RUN_HANDLER_MAX_CONCURRENT_HANDLERS");
+  unsetenv("TF_RUN_HANDLER_STARVATION_LIMIT_US");
+
+  mutex mu;
+  std::vector<int64> served_steps;
+  auto handler = pool->Get(0);
+  {
+    thread::ThreadPool test_pool(Env::Default(), "test", 3);
+    // Requests are queued in order of increasing priority, and the last one
+    // has a deadline, so they must be served in reverse order.
+    for (int i = 1; i <= 3; ++i) {
+      RunOptions::Experimental::RunHandlerPoolOptions options;
+      options.set_priority(i == 3 ? 2 : i);
+      if (i == 3) options.set_deadline_in_us(1000000);
+      test_pool.Schedule([&pool, &mu, &served_steps, i, options]() {
+        auto waiting_handler = pool->Get(i, options);
+        mutex_lock l(mu);
+        served_steps.push_back(i);
+      });
+      Env::Default()->SleepForMicros(100000);
+    }
+    handler.reset();
+  }
+  EXPECT_EQ(served_steps, std::vector<int64>({3, 2, 1}));
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -18,8 +18,10 @@ limitations under the License.
 #include <cmath>
 #include <vector>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/type_traits.h"
+#include "tensorflow/core/framework/typed_allocator.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -178,6 +180,61 @@ Status Split(const Tensor& tensor, const gtl::ArraySlice<int64>& sizes,
   return Status::OK();
 }
 
+namespace {
+
+// A tstring[n] buffer whose strings may view the bytes of 'parent_', which it
+// keeps alive.
+class StringViewBuffer : public TensorBuffer {
+ public:
+  StringViewBuffer(Allocator* allocator, int64 n, const Tensor& parent)
+      : TensorBuffer(TypedAllocator::Allocate<tstring>(allocator, n,
+                                                       AllocationAttributes())),
+        allocator_(allocator),
+        elem_(n),
+        parent_(parent) {}
+
+  size_t size() const override { return sizeof(tstring) * elem_; }
+
+  TensorBuffer* root_buffer() override { return this; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size());
+    proto->set_allocator_name(allocator_->Name());
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+ private:
+  ~StringViewBuffer() override {
+    // The strings are destroyed before 'parent_', whose bytes they view.
+    if (data()) {
+      TypedAllocator::Deallocate<tstring>(allocator_, base<tstring>(), elem_);
+    }
+  }
+
+  Allocator* const allocator_;
+  const int64 elem_;
+  const Tensor parent_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StringViewBuffer);
+};
+
+}  // namespace
+
+Status MakeStringViewTensor(Allocator* allocator, const TensorShape& shape,
+                            const Tensor& parent, Tensor* result) {
+  const int64 num_elements = shape.num_elements();
+  StringViewBuffer* buf = new StringViewBuffer(allocator, num_elements, parent);
+  if (buf->data() == nullptr && num_elements > 0) {
+    buf->Unref();
+    return errors::ResourceExhausted("OOM when allocating string tensor of ",
+                                     shape.DebugString(), " with allocator ",
+                                     allocator->Name());
+  }
+  *result = Tensor(DT_STRING, shape, buf);
+  buf->Unref();
+  return Status::OK();
+}
+
 namespace internal {
 void SetTensorProtoShape(std::vector<size_t> shape,
                          TensorShapeProto* shape_proto) {
@@ -65,6 +65,17 @@ Status Concat(const gtl::ArraySlice<Tensor>& tensors,
 Status Split(const Tensor& tensor, const gtl::ArraySlice<int64>& sizes,
              std::vector<Tensor>* result) TF_MUST_USE_RESULT;
 
+// Allocates with 'allocator' a DT_STRING tensor of 'shape' whose elements may
+// be views of bytes owned by 'parent' (see tstring::assign_as_view): the
+// result holds a reference to the buffer of 'parent' for as long as it lives,
+// so that an op can output slices of its input strings without copying them.
+// The elements are initially empty.
+//
+// REQUIRES: 'parent' must point to data stored in CPU memory.
+Status MakeStringViewTensor(Allocator* allocator, const TensorShape& shape,
+                            const Tensor& parent,
+                            Tensor* result) TF_MUST_USE_RESULT;
+
 namespace internal {
 void SetTensorProtoShape(std::vector<size_t> shape,
                          TensorShapeProto* shape_proto);
@@ -293,6 +293,41 @@ TEST(TensorUtil, ConcatSplitStrings) {
   }
 }
 
+TEST(TensorUtil, StringViewTensor) {
+  Tensor views;
+  {
+    Tensor parent(DT_STRING, TensorShape({2}));
+    parent.vec<tstring>()(0) = "hello world";
+    parent.vec<tstring>()(1) = "foo";
+    TF_ASSERT_OK(tensor::MakeStringViewTensor(cpu_allocator(),
+                                              TensorShape({3}), parent,
+                                              &views));
+    EXPECT_EQ(TensorShape({3}), views.shape());
+    auto out = views.vec<tstring>();
+    const tstring& hello = parent.vec<tstring>()(0);
+    AssignAsView(&out(0), hello.data(), 5);
+    AssignAsView(&out(1), hello.data() + 6, 5);
+    out(2) = "owned";
+  }
+  // The views outlive the tensor they were made from.
+  test::ExpectTensorEqual<tstring>(
+      views, test::AsTensor<tstring>({"hello", "world", "owned"}));
+  // Copies own their bytes.
+  Tensor copy = tensor::DeepCopy(views);
+  views = Tensor();
+  test::ExpectTensorEqual<tstring>(
+      copy, test::AsTensor<tstring>({"hello", "world", "owned"}));
+}
+
+TEST(TensorUtil, StringViewTensorEmpty) {
+  Tensor parent(DT_STRING, TensorShape({1}));
+  Tensor views;
+  TF_ASSERT_OK(tensor::MakeStringViewTensor(cpu_allocator(), TensorShape({0}),
+                                            parent, &views));
+  EXPECT_EQ(DT_STRING, views.dtype());
+  EXPECT_EQ(0, views.NumElements());
+}
+
 TEST(TensorProtoUtil, CreatesStringTensorProto) {
   std::vector<string> values{"a", "b", "c"};
   std::vector<size_t> shape{1, 3};
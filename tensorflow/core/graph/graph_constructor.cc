@@ -38,11 +38,14 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/tensor_id.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/scanner.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/public/version.h"
@@ -187,11 +190,13 @@ class GraphConstructor {
     TF_RETURN_IF_ERROR(ValidateInputMapAndControlDependencies());
     TF_RETURN_IF_ERROR(BuildNodeIndex());
     TF_RETURN_IF_ERROR(InitFromEdges());
+    TF_RETURN_IF_ERROR(ValidateNodeDefs());
 
     // NOTE: Convert() invokes `consume_node_def()` on each node in the input
     // graph, so `get_node_def()` is no longer usable once it is called.
     TF_RETURN_IF_ERROR(Convert());
 
+    TF_RETURN_IF_ERROR(InferShapes());
     TF_RETURN_IF_ERROR(AddBackEdges());
     TF_RETURN_IF_ERROR(UpdateVersionDef());
     TF_RETURN_IF_ERROR(PopulateReturnTensors());
@@ -207,7 +212,13 @@ class GraphConstructor {
   Status ValidateInputMapAndControlDependencies();
   Status BuildNodeIndex();
   Status InitFromEdges();
+  // Looks up the OpDef of each NodeDef and, unless importing, validates the
+  // NodeDefs. Large graphs are validated in parallel.
+  Status ValidateNodeDefs();
   Status Convert();
+  // Runs the shape inference deferred by Convert() for large graphs, in
+  // parallel.
+  Status InferShapes();
   Status AddBackEdges();
   Status UpdateVersionDef();
   Status PopulateReturnTensors();
@@ -227,6 +238,9 @@ class GraphConstructor {
   Status MakeNode(NodeDef&& node_def, Node** node);
   Status MakeEdge(Node* src, int output_index, Node* dst, int input_index);
   Status ValidateShape(Node* node);
+  // Overrides the inferred output shapes of `node` with its `_output_shapes`
+  // attribute, if any.
+  Status SetOutputShapesFromAttr(Node* node);
   Status ModifyNodeDefForImport(NodeDef* node_def);
   // Modifies node_def's inputs according to opts_.input_map.
   // input_already_exists is a pre-initialized vector of length
@@ -354,6 +368,26 @@ class GraphConstructor {
   // all nodes it outputs to.
   std::vector<gtl::InlinedVector<int, 4>> outputs_;
 
+  // The index within node_defs_ of the source node of each input of each node,
+  // or -1 if the input is mapped by opts_.input_map. The inputs of the i^th
+  // node are at [input_offsets_[i], input_offsets_[i + 1]). Used to connect
+  // the inputs of the nodes when not importing, as their inputs are then not
+  // modified before conversion.
+  std::vector<int> input_offsets_;
+  std::vector<int> input_sources_;
+
+  // Mapping between index within node_defs_ and the converted node, or
+  // nullptr until the NodeDef is converted.
+  std::vector<Node*> converted_nodes_;
+
+  // Mapping between index within node_defs_ and the OpDef of the node. Only
+  // filled when not importing.
+  std::vector<const OpDef*> op_defs_;
+
+  // The converted nodes whose shapes are inferred by InferShapes(), in
+  // topological order. Only used for large graphs.
+  std::vector<const Node*> nodes_to_infer_;
+
   // Used in the conversion from node_defs_ to g_ to represent the ith input
   // of a node.
   struct InputInfo {
@@ -655,6 +689,9 @@ Status GraphConstructor::InitFromEdges() {
   const int num_nodes = node_def_count();
   pending_count_.reserve(num_nodes);
   outputs_.resize(num_nodes);
+  input_offsets_.reserve(num_nodes + 1);
+  input_offsets_.push_back(0);
+  converted_nodes_.resize(num_nodes, nullptr);
   gtl::FlatSet<string> next_iteration_nodes;
   for (int n = 0; n < node_def_count(); ++n) {
     const NodeDef& node_def = get_node_def(n);
@@ -703,17 +740,98 @@ Status GraphConstructor::InitFromEdges() {
                                          node_def.input(i), "'");
         }
         outputs_[iter->second.gdef_index].push_back(n);
+        input_sources_.push_back(iter->second.gdef_index);
       } else {
         // This input is mapped to an existing edge. Therefore this input is
         // as good as being already processed.
         --pending_count;
         DCHECK_GE(pending_count, 0);
+        input_sources_.push_back(-1);
       }
     }
     if (pending_count == 0) {
       ready_.insert(n);
     }
     pending_count_.push_back(pending_count);
+    input_offsets_.push_back(input_sources_.size());
+  }
+  return Status::OK();
+}
+
+namespace {
+
+// The NodeDefs are validated in blocks of this many nodes. The blocks are
+// validated in parallel if there is more than one.
+constexpr int kValidationBlockSize = 4096;
+
+// The shapes of the nodes of graphs with at least this many nodes are inferred
+// in parallel once all the nodes are converted.
+constexpr int kMinNodesForParallelShapeInference = 10000;
+
+// Validates `node_def` as it will be once the missing attrs are set to their
+// default value if `add_default_attributes`.
+Status ValidateNodeDefWithDefaults(const NodeDef& node_def,
+                                   const OpDef& op_def,
+                                   bool add_default_attributes) {
+  if (add_default_attributes) {
+    for (const OpDef::AttrDef& attr_def : op_def.attr()) {
+      if (attr_def.has_default_value() &&
+          node_def.attr().find(attr_def.name()) == node_def.attr().end()) {
+        NodeDef node_def_with_defaults = node_def;
+        AddDefaultsToNodeDef(op_def, &node_def_with_defaults);
+        return ValidateNodeDef(node_def_with_defaults, op_def);
+      }
+    }
+  }
+  return ValidateNodeDef(node_def, op_def);
+}
+
+}  // namespace
+
+Status GraphConstructor::ValidateNodeDefs() {
+  // When importing, the NodeDefs are validated once they are modified for
+  // import in Convert().
+  if (opts_.importing) return Status::OK();
+
+  // Look up each op only once, as registry lookups take a lock.
+  const int num_nodes = node_def_count();
+  op_defs_.resize(num_nodes);
+  gtl::FlatMap<StringPiece, const OpDef*, StringPieceHasher> op_defs_by_name;
+  for (int n = 0; n < num_nodes; ++n) {
+    const NodeDef& node_def = get_node_def(n);
+    const OpDef*& op_def = op_defs_by_name[node_def.op()];
+    if (op_def == nullptr) {
+      TF_RETURN_IF_ERROR(
+          g_->op_registry()->LookUpOpDef(node_def.op(), &op_def));
+    }
+    op_defs_[n] = op_def;
+  }
+  if (!opts_.validate_nodes) return Status::OK();
+
+  const int num_blocks =
+      (num_nodes + kValidationBlockSize - 1) / kValidationBlockSize;
+  std::vector<Status> block_statuses(num_blocks);
+  auto validate_block = [this, num_nodes, &block_statuses](int block) {
+    const int end = std::min(num_nodes, (block + 1) * kValidationBlockSize);
+    for (int n = block * kValidationBlockSize; n < end; ++n) {
+      block_statuses[block] = ValidateNodeDefWithDefaults(
+          get_node_def(n), *op_defs_[n], opts_.add_default_attributes);
+      if (!block_statuses[block].ok()) return;
+    }
+  };
+  if (num_blocks > 1) {
+    // The destructor of the pool waits for all blocks to be validated.
+    thread::ThreadPool pool(Env::Default(), "validate_node_defs",
+                            std::min(num_blocks, port::MaxParallelism()));
+    for (int block = 0; block < num_blocks; ++block) {
+      pool.Schedule([&validate_block, block]() { validate_block(block); });
+    }
+  } else if (num_blocks == 1) {
+    validate_block(0);
+  }
+  // Report the error of the first invalid NodeDef.
+  for (const Status& s : block_statuses) {
+    TF_RETURN_IF_ERROR(s);
   }
   return Status::OK();
 }
@@ -750,11 +868,26 @@ Status GraphConstructor::MakeNode(NodeDef&& node_def, Node** node) {
 Status GraphConstructor::ValidateShape(Node* node) {
   if (!opts_.importing || !opts_.validate_shape) return Status::OK();
   TF_RETURN_IF_ERROR(refiner_->AddNode(node));
+  return SetOutputShapesFromAttr(node);
+}
+
+Status GraphConstructor::InferShapes() {
+  if (nodes_to_infer_.empty()) return Status::OK();
+  thread::ThreadPool pool(Env::Default(), "infer_shapes",
+                          port::MaxParallelism());
+  return refiner_->AddNodes(
+      nodes_to_infer_, &pool, [this](const Node* node) {
+        // The nodes were converted into g_, which is mutable.
+        return SetOutputShapesFromAttr(const_cast<Node*>(node));
+      });
+}
+
+Status GraphConstructor::SetOutputShapesFromAttr(Node* node) {
   // For nodes with the _output_shapes attribute, override the shape.
   std::vector<const TensorShapeProto*> shape_attrs;
   const char* kAttrName = "_output_shapes";
   if (!TryGetNodeAttr(node->attrs(), kAttrName, &shape_attrs)) {
-    // No _output_shapes attribute, the AddNode call above was sufficient.
+    // No _output_shapes attribute, the inferred shapes are kept.
     return Status::OK();
   }
   auto* ic = refiner_->GetContext(node);
@@ -1129,6 +1262,12 @@ Status GraphConstructor::Convert() {
 
   std::vector<bool> input_already_exists;
 
+  // The shapes of the nodes of large graphs are inferred once they are all
+  // converted, so that the independent nodes are inferred in parallel.
+  const bool defer_shape_inference =
+      opts_.importing && opts_.validate_shape &&
+      node_def_count() >= kMinNodesForParallelShapeInference;
+
   // Process the NodeDefs in topological order.
   // (InitFromEdges() sets this up by filling in ready_ with nodes that have no
   // inputs, pending_counts_ with the number of inputs for each node and
@@ -1187,7 +1326,13 @@ Status GraphConstructor::Convert() {
       Node* src_node;
       int src_index;
 
-      if (!input_already_exists[i]) {
+      if (!input_already_exists[i] && !opts_.importing) {
+        // The inputs are not modified when not importing, so their source
+        // nodes were already located by InitFromEdges().
+        src_node = converted_nodes_[input_sources_[input_offsets_[o] + i]];
+        src_index = tensor_id.index();
+        if (src_node == nullptr) has_data_back_edge = true;
+      } else if (!input_already_exists[i]) {
         // Locate input in newly-imported nodes
         auto iter = gdef_nodes_.find(tensor_id.node());
         DCHECK(iter != gdef_nodes_.end()) << tensor_id.node();
@@ -1242,18 +1387,14 @@ Status GraphConstructor::Convert() {
     if (opts_.importing) {
       TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&node_def));
     } else {
-      const OpDef* op_def;
-      TF_RETURN_IF_ERROR(
-          g_->op_registry()->LookUpOpDef(node_def.op(), &op_def));
+      // ValidateNodeDefs() already validated the NodeDef with its defaults.
       if (opts_.add_default_attributes) {
-        AddDefaultsToNodeDef(*op_def, &node_def);
-      }
-      if (opts_.validate_nodes) {
-        TF_RETURN_IF_ERROR(ValidateNodeDef(node_def, *op_def));
+        AddDefaultsToNodeDef(*op_defs_[o], &node_def);
       }
     }
 
     TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node));
+    converted_nodes_[o] = node;
 
     if (opts_.importing) {
       // Use interned original node name so StringPiece remains valid.
@@ -1286,7 +1427,11 @@ Status GraphConstructor::Convert() {
       }
     }
 
-    TF_RETURN_IF_ERROR(ValidateShape(node));
+    if (defer_shape_inference) {
+      nodes_to_infer_.push_back(node);
+    } else {
+      TF_RETURN_IF_ERROR(ValidateShape(node));
+    }
 
     // Update pending_count_ for outputs.
     UpdatePendingCountAndReady(o, node->IsNextIteration());
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/shape_inference.h"
 #include "tensorflow/core/framework/versions.pb.h"
+#include "tensorflow/core/graph/benchmark_testlib.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/kernels/ops_util.h"
@@ -1003,6 +1004,90 @@ TEST_F(GraphConstructorTest, ImportGraphDef_DefaultAttrs) {
   EXPECT_EQ(31415, value);
 }
 
+// Returns a GraphDef with `num_nodes` TestDefaultAttr nodes, which is large
+// enough for its NodeDefs to be validated in parallel.
+GraphDef LargeGraphDef(int num_nodes) {
+  GraphDef def;
+  for (int i = 0; i < num_nodes; ++i) {
+    NodeDef* node = def.add_node();
+    node->set_name(strings::StrCat("n", i));
+    node->set_op("TestDefaultAttr");
+  }
+  return def;
+}
+
+TEST_F(GraphConstructorTest, ConvertLargeGraph) {
+  GraphDef def = LargeGraphDef(10000);
+  (*def.mutable_node(9999)->mutable_attr())["default_int"].set_i(1);
+  TF_ASSERT_OK(ConvertGraphDefToGraph(GraphConstructorOptions(), def, &graph_));
+  EXPECT_EQ(10000 + 2, graph_.num_nodes());  // Including _SOURCE and _SINK.
+  int value = 0;
+  TF_ASSERT_OK(GetNodeAttr(FindNode("n9000")->attrs(), "default_int", &value));
+  EXPECT_EQ(31415, value);
+  TF_ASSERT_OK(GetNodeAttr(FindNode("n9999")->attrs(), "default_int", &value));
+  EXPECT_EQ(1, value);
+}
+
+TEST_F(GraphConstructorTest, ConvertLargeGraph_InvalidNodes) {
+  GraphDef def = LargeGraphDef(10000);
+  (*def.mutable_node(9000)->mutable_attr())["foo"].set_i(1);
+  (*def.mutable_node(5000)->mutable_attr())["default_int"].set_s("bar");
+  const string original_graph_description = GraphDebugString();
+  Status s = ConvertGraphDefToGraph(GraphConstructorOptions(), def, &graph_);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  // The error of the first invalid node is reported.
+  EXPECT_TRUE(s.error_message().find("n5000") != string::npos) << s;
+  EXPECT_EQ(original_graph_description, GraphDebugString());
+}
+
+// Returns a GraphDef with 5000 pairs of TestParams and TestOneInputOneOutput
+// nodes, which is large enough for the shapes of its nodes to be inferred in
+// parallel.
+GraphDef LargeGraphDefWithEdges() {
+  GraphDef def;
+  for (int i = 0; i < 5000; ++i) {
+    NodeDef* params = def.add_node();
+    params->set_name(strings::StrCat("p", i));
+    params->set_op("TestParams");
+    NodeDef* node = def.add_node();
+    node->set_name(strings::StrCat("o", i));
+    node->set_op("TestOneInputOneOutput");
+    node->add_input(params->name());
+    (*node->mutable_attr())["T"].set_type(DT_FLOAT);
+  }
+  return def;
+}
+
+TEST_F(GraphConstructorTest, ImportGraphDef_LargeGraphShapes) {
+  GraphDef def = LargeGraphDefWithEdges();
+  (*def.mutable_node(1)->mutable_attr())["_output_shapes"]
+      .mutable_list()
+      ->add_shape();
+  ShapeRefiner refiner(TF_GRAPH_DEF_VERSION, graph_.op_registry());
+  TF_ASSERT_OK(ImportGraphDef(ImportGraphDefOptions(), def, &graph_, &refiner));
+  for (const string& name : {"o0", "o4999"}) {
+    shape_inference::InferenceContext* c = refiner.GetContext(FindNode(name));
+    ASSERT_NE(c, nullptr) << name;
+    EXPECT_EQ("[]", c->DebugString(c->output(0))) << name;
+  }
+  EXPECT_FALSE(HasNodeAttr(FindNode("o0")->def(), "_output_shapes"));
+}
+
+TEST_F(GraphConstructorTest, ImportGraphDef_LargeGraphInvalidShapes) {
+  GraphDef def = LargeGraphDefWithEdges();
+  (*def.mutable_node(9999)->mutable_attr())["_output_shapes"]
+      .mutable_list()
+      ->add_shape()
+      ->add_dim()
+      ->set_size(2);
+  const string original_graph_description = GraphDebugString();
+  ShapeRefiner refiner(TF_GRAPH_DEF_VERSION, graph_.op_registry());
+  Status s = ImportGraphDef(ImportGraphDefOptions(), def, &graph_, &refiner);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  EXPECT_TRUE(s.error_message().find("inconsistent") != string::npos) << s;
+  EXPECT_EQ(original_graph_description, GraphDebugString());
+}
+
 TEST_F(GraphConstructorTest, ImportGraphDef_Versioning) {
   GraphDef def;
   const ImportGraphDefOptions opts;
@@ -3253,5 +3338,27 @@ TEST_F(GraphConstructorTest, ImportGraphDef_UnknownOps) {
        "when the module is first accessed."});
 }
 
+static void BM_ConvertGraphDefToGraph(int iters, int num_nodes,
+                                      int num_edges_per_node) {
+  testing::StopTiming();
+  const GraphDef graph_def =
+      test::CreateGraphDef(num_nodes, num_edges_per_node);
+  const auto registry = OpRegistry::Global();
+  GraphConstructorOptions opts;
+  int64 sum = 0;
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    Graph graph(registry);
+    TF_CHECK_OK(ConvertGraphDefToGraph(opts, graph_def, &graph));
+    sum += graph.num_node_ids();
+  }
+  VLOG(1) << sum;
+  testing::StopTiming();
+}
+BENCHMARK(BM_ConvertGraphDefToGraph)->ArgPair(1 << 12, 4);
+BENCHMARK(BM_ConvertGraphDefToGraph)->ArgPair(1 << 15, 4);
+BENCHMARK(BM_ConvertGraphDefToGraph)->ArgPair(1 << 18, 4);
+BENCHMARK(BM_ConvertGraphDefToGraph)->ArgPair(1 << 20, 4);
+
 }  // namespace
 }  // namespace tensorflow
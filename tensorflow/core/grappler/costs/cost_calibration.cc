@@ -0,0 +1,125 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/grappler/costs/cost_calibration.h"
+
+#include <unordered_map>
+
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/measuring_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/utils.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+OpCostCalibrator::OpCostCalibrator() {
+  // Fit the factors against the raw analytical predictions.
+  estimator_.SetCorrectionFactors(OpCostCalibration());
+}
+
+Status OpCostCalibrator::AddMeasurements(Cluster* cluster,
+                                         const GrapplerItem& item,
+                                         int measurement_steps) {
+  MeasuringCostEstimator measuring_estimator(cluster, measurement_steps,
+                                             /*measurement_threads=*/0);
+  TF_RETURN_IF_ERROR(measuring_estimator.Initialize(item));
+  RunMetadata run_metadata;
+  Costs costs;
+  TF_RETURN_IF_ERROR(
+      measuring_estimator.PredictCosts(item.graph, &run_metadata, &costs));
+  return AddMeasurements(item, run_metadata.cost_graph());
+}
+
+Status OpCostCalibrator::AddMeasurements(const GrapplerItem& item,
+                                         const CostGraphDef& cost_graph) {
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(
+      properties.InferStatically(/*assume_valid_feeds=*/true,
+                                 /*aggressive_shape_inference=*/false,
+                                 /*include_tensor_values=*/false));
+
+  std::unordered_map<string, const NodeDef*> name_to_node;
+  for (const NodeDef& node : item.graph.node()) {
+    name_to_node[node.name()] = &node;
+  }
+
+  for (const CostGraphDef::Node& cost_node : cost_graph.node()) {
+    auto it = name_to_node.find(cost_node.name());
+    if (it == name_to_node.end()) continue;
+    const NodeDef& node = *it->second;
+
+    // Note that CostGraphDef::Node::compute_cost is in microseconds, while
+    // the predicted costs are in nanoseconds.
+    const double measured = cost_node.compute_cost() * 1e3;
+    if (measured <= 0) continue;
+
+    OpContext op_context;
+    op_context.name = node.name();
+    op_context.device_name = cost_node.device();
+    op_context.function_library = &item.graph.library();
+    OpInfo& op_info = op_context.op_info;
+    op_info = BuildOpInfoWithoutDevice(
+        node, name_to_node, properties.GetInputProperties(node.name()));
+    for (const auto& output : properties.GetOutputProperties(node.name())) {
+      *op_info.add_outputs() = output;
+    }
+    *op_info.mutable_device() = GetDeviceInfo(cost_node);
+
+    const double predicted =
+        estimator_.PredictCosts(op_context).execution_time.count();
+    if (predicted <= 0) continue;
+
+    if (device_.type().empty()) {
+      device_ = op_info.device();
+    }
+    Samples& samples = samples_[node.op()];
+    samples.measured_times_predicted += measured * predicted;
+    samples.predicted_squared += predicted * predicted;
+    VLOG(2) << "Op " << node.op() << " (" << node.name()
+            << "): measured=" << measured << "ns predicted=" << predicted
+            << "ns";
+  }
+  return Status::OK();
+}
+
+OpCostCalibration OpCostCalibrator::Fit() const {
+  OpCostCalibration calibration;
+  *calibration.mutable_device() = device_;
+  auto* factors = calibration.mutable_correction_factors();
+  for (const auto& op_samples : samples_) {
+    const Samples& samples = op_samples.second;
+    if (samples.predicted_squared <= 0) continue;
+    (*factors)[op_samples.first] =
+        samples.measured_times_predicted / samples.predicted_squared;
+  }
+  return calibration;
+}
+
+Status WriteOpCostCalibration(const string& filename,
+                              const OpCostCalibration& calibration) {
+  return WriteBinaryProto(Env::Default(), filename, calibration);
+}
+
+Status ReadOpCostCalibration(const string& filename,
+                             OpCostCalibration* calibration) {
+  return ReadBinaryProto(Env::Default(), filename, calibration);
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
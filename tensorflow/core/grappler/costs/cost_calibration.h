@@ -0,0 +1,81 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_COST_CALIBRATION_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_COST_CALIBRATION_H_
+
+#include <map>
+
+#include "tensorflow/core/framework/cost_graph.pb.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+namespace grappler {
+
+class Cluster;
+struct GrapplerItem;
+
+// Fits per-op correction factors for the OpLevelCostEstimator from measured
+// op execution times. For every op type it finds the factor `f` that minimizes
+// sum((measured - f * predicted)^2) over all the measured nodes of that type.
+//
+// The fitted calibration can be written to a file with
+// WriteOpCostCalibration(). When the TF_GRAPPLER_COST_CALIBRATION_FILE
+// environment variable points to that file, every OpLevelCostEstimator (and
+// therefore every cost-based Grappler pass) applies the correction factors.
+class OpCostCalibrator {
+ public:
+  OpCostCalibrator();
+
+  // Runs `item` on `cluster` for `measurement_steps` steps using the
+  // MeasuringCostEstimator, and records the measured and the predicted
+  // execution time of every op. The cluster must collect cost graphs (e.g. a
+  // SingleMachine cluster).
+  Status AddMeasurements(Cluster* cluster, const GrapplerItem& item,
+                         int measurement_steps);
+
+  // Records the execution times of the nodes of `item` measured in
+  // `cost_graph`, along with their predicted execution times.
+  Status AddMeasurements(const GrapplerItem& item,
+                         const CostGraphDef& cost_graph);
+
+  // Returns the correction factors fitted from all the recorded measurements.
+  OpCostCalibration Fit() const;
+
+ private:
+  struct Samples {
+    double measured_times_predicted = 0.0;
+    double predicted_squared = 0.0;
+  };
+
+  // Estimator without any correction factors.
+  OpLevelCostEstimator estimator_;
+  std::map<string, Samples> samples_;
+  DeviceProperties device_;
+};
+
+// Writes `calibration` to `filename` in the binary proto format.
+Status WriteOpCostCalibration(const string& filename,
+                              const OpCostCalibration& calibration);
+
+// Reads a calibration written by WriteOpCostCalibration().
+Status ReadOpCostCalibration(const string& filename,
+                             OpCostCalibration* calibration);
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_COST_CALIBRATION_H_
@@ -0,0 +1,119 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/grappler/costs/cost_calibration.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/cost_graph.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kCpuDevice[] = "/job:localhost/replica:0/task:0/cpu:0";
+
+GrapplerItem CreateMatMulItem() {
+  Scope s = Scope::NewRootScope().WithDevice(kCpuDevice);
+  auto x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                            ops::Placeholder::Shape({64, 64}));
+  auto matmul = ops::MatMul(s.WithOpName("matmul"), x, x);
+  auto relu = ops::Relu(s.WithOpName("relu"), matmul);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"relu"};
+  return item;
+}
+
+CostGraphDef CreateCostGraph(int64 matmul_micros, int64 relu_micros) {
+  CostGraphDef cost_graph;
+  CostGraphDef::Node* matmul = cost_graph.add_node();
+  matmul->set_name("matmul");
+  matmul->set_device(kCpuDevice);
+  matmul->set_compute_cost(matmul_micros);
+  CostGraphDef::Node* relu = cost_graph.add_node();
+  relu->set_name("relu");
+  relu->set_device(kCpuDevice);
+  relu->set_compute_cost(relu_micros);
+  return cost_graph;
+}
+
+TEST(OpCostCalibratorTest, FitsCorrectionFactors) {
+  const GrapplerItem item = CreateMatMulItem();
+
+  OpCostCalibrator calibrator;
+  TF_ASSERT_OK(calibrator.AddMeasurements(item, CreateCostGraph(100, 10)));
+  const OpCostCalibration calibration = calibrator.Fit();
+  EXPECT_EQ("CPU", calibration.device().type());
+  ASSERT_EQ(1, calibration.correction_factors().count("MatMul"));
+  ASSERT_EQ(1, calibration.correction_factors().count("Relu"));
+
+  // Twice as slow measurements must produce twice as large factors.
+  OpCostCalibrator slow_calibrator;
+  TF_ASSERT_OK(slow_calibrator.AddMeasurements(item, CreateCostGraph(200, 20)));
+  const OpCostCalibration slow_calibration = slow_calibrator.Fit();
+  EXPECT_DOUBLE_EQ(2 * calibration.correction_factors().at("MatMul"),
+                   slow_calibration.correction_factors().at("MatMul"));
+  EXPECT_DOUBLE_EQ(2 * calibration.correction_factors().at("Relu"),
+                   slow_calibration.correction_factors().at("Relu"));
+}
+
+TEST(OpCostCalibratorTest, AveragesMeasurements) {
+  const GrapplerItem item = CreateMatMulItem();
+
+  OpCostCalibrator calibrator;
+  TF_ASSERT_OK(calibrator.AddMeasurements(item, CreateCostGraph(100, 10)));
+  TF_ASSERT_OK(calibrator.AddMeasurements(item, CreateCostGraph(300, 30)));
+
+  OpCostCalibrator expected_calibrator;
+  TF_ASSERT_OK(
+      expected_calibrator.AddMeasurements(item, CreateCostGraph(200, 20)));
+
+  EXPECT_DOUBLE_EQ(
+      expected_calibrator.Fit().correction_factors().at("MatMul"),
+      calibrator.Fit().correction_factors().at("MatMul"));
+}
+
+TEST(OpCostCalibratorTest, SkipsUnmeasuredNodes) {
+  OpCostCalibrator calibrator;
+  TF_ASSERT_OK(
+      calibrator.AddMeasurements(CreateMatMulItem(), CreateCostGraph(100, 0)));
+  const OpCostCalibration calibration = calibrator.Fit();
+  EXPECT_EQ(1, calibration.correction_factors().count("MatMul"));
+  EXPECT_EQ(0, calibration.correction_factors().count("Relu"));
+}
+
+TEST(OpCostCalibratorTest, WriteAndRead) {
+  OpCostCalibration calibration;
+  calibration.mutable_device()->set_type("CPU");
+  (*calibration.mutable_correction_factors())["Conv2D"] = 5.0;
+
+  const string filename =
+      io::JoinPath(testing::TmpDir(), "op_cost_calibration.pb");
+  TF_ASSERT_OK(WriteOpCostCalibration(filename, calibration));
+
+  OpCostCalibration read_calibration;
+  TF_ASSERT_OK(ReadOpCostCalibration(filename, &read_calibration));
+  EXPECT_EQ("CPU", read_calibration.device().type());
+  EXPECT_EQ(5.0, read_calibration.correction_factors().at("Conv2D"));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
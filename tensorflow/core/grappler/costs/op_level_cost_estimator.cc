@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 
+#include <cmath>
+
 #include "third_party/eigen3/Eigen/Core"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/attr_value_util.h"
@@ -23,6 +25,8 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/grappler/clusters/utils.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -204,6 +208,32 @@ bool CheckRepeatedDimensions(const string& dim_str) {
   return false;
 }
 
+// Returns the calibration stored in the file named by the
+// TF_GRAPPLER_COST_CALIBRATION_FILE environment variable, or nullptr if it is
+// not set. The file is read once per process.
+const OpCostCalibration* DefaultCostCalibration() {
+  static const OpCostCalibration* const calibration =
+      []() -> const OpCostCalibration* {
+    string filename;
+    Status s = ReadStringFromEnvVar("TF_GRAPPLER_COST_CALIBRATION_FILE",
+                                    /*default_val=*/"", &filename);
+    if (!s.ok() || filename.empty()) return nullptr;
+
+    auto* calibration = new OpCostCalibration();
+    s = ReadBinaryProto(Env::Default(), filename, calibration);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to read cost calibration from " << filename
+                   << ": " << s;
+      delete calibration;
+      return nullptr;
+    }
+    VLOG(1) << "Loaded " << calibration->correction_factors_size()
+            << " op cost correction factors from " << filename;
+    return calibration;
+  }();
+  return calibration;
+}
+
 }  // namespace
 
 // Return a minimum shape if the shape is unknown. If known, return the original
@@ -461,9 +491,41 @@ OpLevelCostEstimator::OpLevelCostEstimator() {
 
   // By default, use sum of memory_time and compute_time for execution_time.
   compute_memory_overlap_ = false;
+
+  const OpCostCalibration* calibration = DefaultCostCalibration();
+  if (calibration != nullptr) {
+    SetCorrectionFactors(*calibration);
+  }
+}
+
+void OpLevelCostEstimator::SetCorrectionFactors(
+    const OpCostCalibration& calibration) {
+  correction_factors_.clear();
+  for (const auto& factor : calibration.correction_factors()) {
+    if (factor.second > 0) {
+      correction_factors_.emplace(factor.first, factor.second);
+    }
+  }
 }
 
 Costs OpLevelCostEstimator::PredictCosts(const OpContext& op_context) const {
+  Costs costs = PredictUncalibratedCosts(op_context);
+  auto it = correction_factors_.find(op_context.op_info.op());
+  if (it != correction_factors_.end()) {
+    const double factor = it->second;
+    const auto scale = [factor](Costs::Duration duration) {
+      return Costs::Duration(std::llround(duration.count() * factor));
+    };
+    costs.compute_time = scale(costs.compute_time);
+    costs.memory_time = scale(costs.memory_time);
+    costs.intermediate_memory_time = scale(costs.intermediate_memory_time);
+    costs.execution_time = scale(costs.execution_time);
+  }
+  return costs;
+}
+
+Costs OpLevelCostEstimator::PredictUncalibratedCosts(
+    const OpContext& op_context) const {
   const auto& op_info = op_context.op_info;
   auto it = device_cost_impl_.find(op_info.op());
   if (it != device_cost_impl_.end()) {
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_OP_LEVEL_COST_ESTIMATOR_H_
 #define TENSORFLOW_CORE_GRAPPLER_COSTS_OP_LEVEL_COST_ESTIMATOR_H_
 
+#include <unordered_map>
+
 #include "tensorflow/core/grappler/costs/cost_estimator.h"
 #include "tensorflow/core/grappler/costs/op_context.h"
 #include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
@@ -39,7 +41,16 @@ class OpLevelCostEstimator {
   // Returns basic device performance info.
   virtual DeviceInfo GetDeviceInfo(const DeviceProperties& device) const;
 
+  // Scales the predicted costs of the ops listed in `calibration` by their
+  // correction factors. Replaces any previously set factors, including the
+  // ones loaded from the file in the TF_GRAPPLER_COST_CALIBRATION_FILE
+  // environment variable at construction time.
+  void SetCorrectionFactors(const OpCostCalibration& calibration);
+
  protected:
+  // Predicts the cost of an op without applying the correction factors.
+  Costs PredictUncalibratedCosts(const OpContext& op_context) const;
+
   // Predict cost of an op for which no accurate estimator is defined.
   Costs PredictCostOfAnUnknownOp(const OpContext& op_context) const;
 
@@ -199,6 +210,8 @@ class OpLevelCostEstimator {
   // compute_time and memory_time, insteaf of sum of those two.
   bool compute_memory_overlap_;
   std::set<string> persistent_ops_;
+  // Measured over predicted execution time, keyed by op type.
+  std::unordered_map<string, double> correction_factors_;
 
  private:
   friend class OpLevelCostEstimatorTest;
@@ -673,6 +673,23 @@ TEST_F(OpLevelCostEstimatorTest, BiasAddExecutionTime) {
   EXPECT_EQ(0, cost.num_ops_with_unknown_shapes);
 }
 
+TEST_F(OpLevelCostEstimatorTest, CorrectionFactors) {
+  OpCostCalibration calibration;
+  (*calibration.mutable_correction_factors())["BiasAdd"] = 2.0;
+  estimator_.SetCorrectionFactors(calibration);
+
+  auto cost = PredictCosts(DescribeBiasAdd(1000, 10));
+  EXPECT_EQ(Costs::Duration(16800), cost.memory_time);
+  EXPECT_EQ(Costs::Duration(2000), cost.compute_time);
+  EXPECT_EQ(Costs::Duration(18800), cost.execution_time);
+
+  // Ops without a correction factor are not affected.
+  cost = PredictCosts(DescribeUnaryOp("Relu", 1000));
+  estimator_.SetCorrectionFactors(OpCostCalibration());
+  EXPECT_EQ(PredictCosts(DescribeUnaryOp("Relu", 1000)).execution_time,
+            cost.execution_time);
+}
+
 TEST_F(OpLevelCostEstimatorTest, Conv2DExecutionTime) {
   auto cost = PredictCosts(DescribeConvolution(16, 19, 19, 48, 48, 5, 5, 256));
   EXPECT_EQ(Costs::Duration(233780), cost.memory_time);
@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/util/env_var.h"
 
@@ -48,6 +49,7 @@ const std::pair<int, int> kMinGPUArch = {7, 0};
 
 const char kSuffix[] = "AutoMixedPrecision";
 const char kCastToFp16[] = "CastToFp16";
+const char kCastToBf16[] = "CastToBf16";
 const char kCastToFp32[] = "CastToFp32";
 
 // Instances of this class represent unique type attribute identifiers within a
@@ -833,9 +835,12 @@ DataTypeSet AllowedDataTypes(const OpDef& op_def, const TypeAttrId& t_attr_id) {
   return AllowedDataTypes(*attr_def);
 }
 
+// Builds a Cast between float32 and `reduced_dtype`, i.e. float16 or bfloat16.
 NodeDef BuildCastNode(const MutableGraphView::OutputPort& src, bool to_fp16,
-                      const string& device) {
-  const char* cast_string = to_fp16 ? kCastToFp16 : kCastToFp32;
+                      DataType reduced_dtype, const string& device) {
+  const char* cast_string =
+      to_fp16 ? (reduced_dtype == DT_BFLOAT16 ? kCastToBf16 : kCastToFp16)
+              : kCastToFp32;
   string name = strings::StrCat(src.node->name(), "-", src.port_id, "-",
                                 cast_string, "-", kSuffix);
   NodeDef node;
@@ -843,8 +848,8 @@ NodeDef BuildCastNode(const MutableGraphView::OutputPort& src, bool to_fp16,
   node.set_op("Cast");
   node.set_device(device);
   node.add_input(strings::StrCat(src.node->name(), ":", src.port_id));
-  (*node.mutable_attr())["SrcT"].set_type(to_fp16 ? DT_FLOAT : DT_HALF);
-  (*node.mutable_attr())["DstT"].set_type(to_fp16 ? DT_HALF : DT_FLOAT);
+  (*node.mutable_attr())["SrcT"].set_type(to_fp16 ? DT_FLOAT : reduced_dtype);
+  (*node.mutable_attr())["DstT"].set_type(to_fp16 ? reduced_dtype : DT_FLOAT);
   (*node.mutable_attr())["Truncate"].set_b(false);
   return node;
 }
@@ -934,8 +939,12 @@ class AutoMixedPrecisionImpl {
  public:
   AutoMixedPrecisionImpl(Cluster* cluster,
                          const std::unordered_set<string>& nodes_to_preserve,
-                         GraphDef* graph, string id)
-      : virtual_placer_(cluster->GetDevices()),
+                         GraphDef* graph, string id,
+                         AutoMixedPrecisionMode mode)
+      : mode_(mode),
+        target_dtype_(mode == AutoMixedPrecisionMode::CPU ? DT_BFLOAT16
+                                                          : DT_HALF),
+        virtual_placer_(cluster->GetDevices()),
         nodes_to_preserve_(nodes_to_preserve),
         graph_(graph),
         id_(id),
@@ -956,8 +965,9 @@ class AutoMixedPrecisionImpl {
   Status PrintDebugLogs(bool preop, size_t timestamp);
   void LogSkippedNode(const NodeDef& node) const;
   bool MustPreserve(const NodeDef& node) const;
-  bool IsOnGPU(const NodeDef& node) const;
+  bool IsOnDevice(const NodeDef& node, const string& device_type) const;
   bool IsOnSuitableGPUArch(const NodeDef& node) const;
+  bool IsOnSuitableDevice(const NodeDef& node) const;
   bool ShouldProcess(const NodeDef& node) const;
   bool NodeHasFP16KernelForTypeAttr(const NodeDef& node, TypeAttrId taid) const;
   bool NodeImplicitlyReadsNonResourceVariable(const NodeDef& node) const;
@@ -989,6 +999,10 @@ class AutoMixedPrecisionImpl {
       absl::flat_hash_set<int>* white_set) const;
   Status ChangeTypeAttrsAndAddCasts(const absl::flat_hash_set<int>& white_set);
 
+  AutoMixedPrecisionMode mode_;
+  // DT_HALF, or DT_BFLOAT16 for AutoMixedPrecisionMode::CPU. The comments and
+  // names below say fp16 for either.
+  DataType target_dtype_;
   VirtualPlacer virtual_placer_;
   std::unordered_set<string> nodes_to_preserve_;
   GraphDef* graph_;
@@ -1013,7 +1027,7 @@ bool AutoMixedPrecisionImpl::NodeHasFP16KernelForTypeAttr(
     string device_name = virtual_placer_.get_canonical_device_name(node);
     node_copy.set_device(device_name);
   }
-  if (!SetDataType(&node_copy, taid, DataType::DT_HALF)) {
+  if (!SetDataType(&node_copy, taid, target_dtype_)) {
     return false;
   }
   return IsKernelRegisteredForNode(node_copy).ok();
@@ -1050,20 +1064,19 @@ Status AutoMixedPrecisionImpl::PrintDebugLogs(bool preop, size_t timestamp) {
                          strings::StrCat("paintbuckets", suffix, ".txt"));
     f.open(fname.c_str(), std::fstream::out);
     f << "WhiteList:\n";
-    for (auto x :
-         AutoMixedPrecisionLists::WhiteList(cuda_version_, cudnn_version_)) {
+    for (auto x : fp16_whitelist_) {
       f << x << "\n";
     }
     f << "\nBlackList:\n";
-    for (auto x : AutoMixedPrecisionLists::BlackList()) {
+    for (auto x : fp16_blacklist_) {
       f << x << "\n";
     }
     f << "\nGrayList:\n";
-    for (auto x : AutoMixedPrecisionLists::GrayList()) {
+    for (auto x : fp16_graylist_) {
       f << x << "\n";
     }
     f << "\nClearList:\n";
-    for (auto x : AutoMixedPrecisionLists::ClearList()) {
+    for (auto x : fp16_clearlist_) {
       f << x << "\n";
     }
     f.close();
@@ -1073,18 +1086,24 @@ Status AutoMixedPrecisionImpl::PrintDebugLogs(bool preop, size_t timestamp) {
 }
 
 void AutoMixedPrecisionImpl::LogSkippedNode(const NodeDef& node) const {
+  string reason;
+  if (MustPreserve(node)) {
+    reason = "must be preserved";
+  } else if (mode_ == AutoMixedPrecisionMode::CPU) {
+    reason = "is not on the CPU";
+  } else {
+    reason = "is not on the GPU, or the GPU arch is not suitable";
+  }
   VLOG(2) << "Skipping " << node.op() << " node " << node.name()
-          << " because it "
-          << (MustPreserve(node)
-                  ? "must be preserved"
-                  : "is not on the GPU, or the GPU arch is not suitable");
+          << " because it " << reason;
 }
 
 bool AutoMixedPrecisionImpl::MustPreserve(const NodeDef& node) const {
   return nodes_to_preserve_.count(node.name());
 }
 
-bool AutoMixedPrecisionImpl::IsOnGPU(const NodeDef& node) const {
+bool AutoMixedPrecisionImpl::IsOnDevice(const NodeDef& node,
+                                        const string& device_type) const {
   string device_name;
   if (node.device().empty()) {
     device_name = virtual_placer_.get_canonical_device_name(node);
@@ -1095,7 +1114,7 @@ bool AutoMixedPrecisionImpl::IsOnGPU(const NodeDef& node) const {
   string not_used;
   if (DeviceNameUtils::SplitDeviceName(device_name, &not_used, &device) &&
       absl::StrContains(absl::AsciiStrToLower(device),
-                        absl::AsciiStrToLower(DEVICE_GPU))) {
+                        absl::AsciiStrToLower(device_type))) {
     return true;
   }
   return false;
@@ -1147,7 +1166,7 @@ bool AutoMixedPrecisionImpl::SupportsFloat16(
       OpRegistry::Global()->LookUpOpDef(node_type.node->op(), &op_def);
   if (!status.ok()) return false;
   return AllowedDataTypes(*op_def, node_type.type_attr)
-             .Contains(DataType::DT_HALF) &&
+             .Contains(target_dtype_) &&
          NodeHasFP16KernelForTypeAttr(*node_type.node, node_type.type_attr);
 }
 
@@ -1189,6 +1208,16 @@ bool ShouldIgnorePerformance() {
   return is_enabled;
 }
 
+bool AutoMixedPrecisionImpl::IsOnSuitableDevice(const NodeDef& node) const {
+  if (mode_ == AutoMixedPrecisionMode::CPU) {
+    // Whether the CPU has native bfloat16 dot products was checked for the
+    // whole graph, see AutoMixedPrecision::Optimize.
+    return IsOnDevice(node, DEVICE_CPU);
+  }
+  return IsOnDevice(node, DEVICE_GPU) &&
+         (ShouldIgnorePerformance() || IsOnSuitableGPUArch(node));
+}
+
 Status AutoMixedPrecisionImpl::Optimize() {
   string optimization_level;
   TF_RETURN_IF_ERROR(ReadStringFromEnvVar(
@@ -1196,10 +1225,16 @@ Status AutoMixedPrecisionImpl::Optimize() {
   optimization_level = absl::AsciiStrToUpper(optimization_level);
   force_all_fp16_ = optimization_level == "UNSAFE_FORCE_ALL";
 
-  fp16_whitelist_ =
-      AutoMixedPrecisionLists::WhiteList(cuda_version_, cudnn_version_);
-  fp16_blacklist_ = AutoMixedPrecisionLists::BlackList();
-  fp16_graylist_ = AutoMixedPrecisionLists::GrayList();
+  if (mode_ == AutoMixedPrecisionMode::CPU) {
+    fp16_whitelist_ = AutoMixedPrecisionLists::CpuWhiteList();
+    fp16_blacklist_ = AutoMixedPrecisionLists::CpuBlackList();
+    fp16_graylist_ = AutoMixedPrecisionLists::CpuGrayList();
+  } else {
+    fp16_whitelist_ =
+        AutoMixedPrecisionLists::WhiteList(cuda_version_, cudnn_version_);
+    fp16_blacklist_ = AutoMixedPrecisionLists::BlackList();
+    fp16_graylist_ = AutoMixedPrecisionLists::GrayList();
+  }
   fp16_clearlist_ = AutoMixedPrecisionLists::ClearList();
   TF_RETURN_IF_ERROR(ValidateLists(fp16_whitelist_, fp16_blacklist_,
                                    fp16_graylist_, fp16_clearlist_));
@@ -1209,8 +1244,7 @@ Status AutoMixedPrecisionImpl::Optimize() {
 
   VLOG(2) << "Identifying nodes that should be processed";
   for (const NodeDef& node : graph_->node()) {
-    if (!MustPreserve(node) && IsOnGPU(node) &&
-        (ShouldIgnorePerformance() || IsOnSuitableGPUArch(node))) {
+    if (!MustPreserve(node) && IsOnSuitableDevice(node)) {
       should_process_nodes_.insert(&node);
     } else {
       LogSkippedNode(node);
@@ -1809,8 +1843,9 @@ Status AutoMixedPrecisionImpl::ChangeTypeAttrsAndAddCasts(
       bool src_is_white = white_set.count(node_type_idx);
       if (src_is_white) {
         VLOG(1) << "Changing type " << type_attr.DebugString() << " of "
-                << node->op() << " node " << node->name() << " to DT_HALF";
-        if (!SetDataType(node, type_attr, DT_HALF)) {
+                << node->op() << " node " << node->name() << " to "
+                << DataTypeString(target_dtype_);
+        if (!SetDataType(node, type_attr, target_dtype_)) {
           return errors::Internal("Failed to set type attribute");
         }
         ++num_nodes_changed;
@@ -1837,11 +1872,13 @@ Status AutoMixedPrecisionImpl::ChangeTypeAttrsAndAddCasts(
             if (!added_cast_node) {
               bool to_fp16 = dst_is_white;
               VLOG(1) << "Inserting cast to "
-                      << (to_fp16 ? "DT_HALF" : "DT_FLOAT") << " at "
+                      << DataTypeString(to_fp16 ? target_dtype_ : DT_FLOAT)
+                      << " at "
                       << src.node->op() << " " << src.node->name() << ":"
                       << src.port_id;
               added_cast_node = graph_view_.AddNode(
-                  BuildCastNode(src, to_fp16, src.node->device()));
+                  BuildCastNode(src, to_fp16, target_dtype_,
+                                src.node->device()));
               if (to_fp16 && !IsConstant(*node) && !IsVariable(*node) &&
                   !NodeImplicitlyReadsNonResourceVariable(*node)) {
                 ++num_nonvar_casts_to_fp16;
@@ -1855,8 +1892,10 @@ Status AutoMixedPrecisionImpl::ChangeTypeAttrsAndAddCasts(
     }
   }
   LOG(INFO) << "Converted " << num_nodes_changed << "/" << num_nodes_preop
-            << " nodes to float16 precision using " << num_nonvar_casts_to_fp16
-            << " cast(s) to float16 (excluding Const and Variable casts)";
+            << " nodes to " << DataTypeString(target_dtype_)
+            << " precision using " << num_nonvar_casts_to_fp16 << " cast(s) to "
+            << DataTypeString(target_dtype_)
+            << " (excluding Const and Variable casts)";
   return Status::OK();
 }
 
@@ -1874,6 +1913,11 @@ int GetNumGPUs(const Cluster& cluster,
   return num_gpus;
 }
 
+bool HasNativeBFloat16DotProducts() {
+  return port::TestCPUFeature(port::CPUFeature::AVX512_BF16) ||
+         port::TestCPUFeature(port::CPUFeature::AMX_BF16);
+}
+
 }  // end namespace
 
 Status AutoMixedPrecision::Optimize(Cluster* cluster, const GrapplerItem& item,
@@ -1885,18 +1929,28 @@ Status AutoMixedPrecision::Optimize(Cluster* cluster, const GrapplerItem& item,
   // Start by copying input graph to output.
   *output = item.graph;
 
-  int num_gpus = ShouldIgnorePerformance() ? GetNumGPUs(*cluster)
-                                           : GetNumGPUs(*cluster, kMinGPUArch);
-  if (num_gpus < 1) {
-    // AutoMixedPrecision is currently only tuned for GPU.
-    LOG(WARNING) << "No (suitable) GPUs detected, skipping " << name()
-                 << " graph optimizer";
-    return Status::OK();
+  if (mode_ == AutoMixedPrecisionMode::CPU) {
+    // Without native bfloat16 dot products, the CPU kernels convert bfloat16
+    // to float32 and back, which is slower than staying in float32.
+    if (!ShouldIgnorePerformance() && !HasNativeBFloat16DotProducts()) {
+      LOG(WARNING) << "The CPU does not support AVX512_BF16 nor AMX_BF16, "
+                   << "skipping " << name() << " graph optimizer";
+      return Status::OK();
+    }
+  } else {
+    int num_gpus = ShouldIgnorePerformance()
+                       ? GetNumGPUs(*cluster)
+                       : GetNumGPUs(*cluster, kMinGPUArch);
+    if (num_gpus < 1) {
+      LOG(WARNING) << "No (suitable) GPUs detected, skipping " << name()
+                   << " graph optimizer";
+      return Status::OK();
+    }
   }
 
   // Optimize the output graph in-place.
   AutoMixedPrecisionImpl optimizer(cluster, item.NodesToPreserve(), output,
-                                   item.id);
+                                   item.id, mode_);
   if (item.id == "tf_graph") {
     LOG(INFO) << "Running " << name() << " graph optimizer";
   } else {
@@ -22,16 +22,31 @@ limitations under the License.
 namespace tensorflow {
 namespace grappler {
 
-// Convert data types to float16 where appropriate to improve performance on
-// GPUs.
+// The devices and the reduced precision data type that AutoMixedPrecision
+// targets.
+enum class AutoMixedPrecisionMode {
+  // float16 on GPUs with Tensor Cores.
+  CUDA,
+  // bfloat16 on CPUs with native bfloat16 dot products (AVX512_BF16 or
+  // AMX_BF16).
+  CPU,
+};
+
+// Convert data types to float16 (or bfloat16) where appropriate to improve
+// performance on GPUs (or CPUs).
 class AutoMixedPrecision : public GraphOptimizer {
  public:
   explicit AutoMixedPrecision(
-      RewriterConfig::Toggle opt_level = RewriterConfig::ON) {}
+      RewriterConfig::Toggle opt_level = RewriterConfig::ON,
+      AutoMixedPrecisionMode mode = AutoMixedPrecisionMode::CUDA)
+      : mode_(mode) {}
 
   ~AutoMixedPrecision() override {}
 
-  string name() const override { return "auto_mixed_precision"; };
+  string name() const override {
+    return mode_ == AutoMixedPrecisionMode::CPU ? "auto_mixed_precision_cpu"
+                                                : "auto_mixed_precision";
+  };
 
   bool UsesFunctionLibrary() const override { return false; }
 
@@ -40,6 +55,9 @@ class AutoMixedPrecision : public GraphOptimizer {
 
   void Feedback(Cluster* cluster, const GrapplerItem& item,
                 const GraphDef& optimize_output, double result) override;
+
+ private:
+  const AutoMixedPrecisionMode mode_;
 };
 
 }  // end namespace grappler
@@ -172,8 +172,114 @@ class AutoMixedPrecisionLists {
     return list;
   }
 
+  // The lists of AutoMixedPrecisionMode::CPU, for bfloat16. bfloat16 has the
+  // range of float32 but only 8 bits of mantissa, so ops are at risk from
+  // accumulated rounding errors rather than from overflows. The same
+  // environment variables as for the lists above add or remove ops.
+  //
+  // Returns the set of ops that have native bfloat16 dot products on CPUs
+  // that support them, and that are always converted to bfloat16.
+  static gtl::FlatSet<string> CpuWhiteList() {
+    string to_add, to_remove;
+    TF_CHECK_OK(ReadStringFromEnvVar(
+        "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_WHITELIST_ADD", "", &to_add));
+    TF_CHECK_OK(ReadStringFromEnvVar(
+        "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_WHITELIST_REMOVE", "",
+        &to_remove));
+
+    auto list = gtl::FlatSet<string>{
+        "BatchMatMul",
+        "BatchMatMulV2",
+        "Conv2D",
+        "Conv2DBackpropFilter",
+        "Conv2DBackpropInput",
+        "Conv3D",
+        "Conv3DBackpropFilterV2",
+        "Conv3DBackpropInputV2",
+        "MatMul",
+    };
+    UpdateList(&list, to_add, to_remove);
+    return list;
+  }
+
+  // Returns the set of ops that are considered numerically-safe in bfloat16,
+  // but which may be made unsafe by an upstream blacklist op.
+  static gtl::FlatSet<string> CpuGrayList() {
+    if (IsPseudoFastMath()) {
+      return gtl::FlatSet<string>{};
+    }
+    string to_add, to_remove;
+    TF_CHECK_OK(ReadStringFromEnvVar(
+        "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_GRAYLIST_ADD", "", &to_add));
+    TF_CHECK_OK(ReadStringFromEnvVar(
+        "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_GRAYLIST_REMOVE", "",
+        &to_remove));
+
+    auto list = gtl::FlatSet<string>{
+        "Add",
+        "AddN",
+        "AddV2",
+        "AvgPool",
+        "AvgPool3D",
+        "AvgPool3DGrad",
+        "AvgPoolGrad",
+        "BiasAdd",
+        "BiasAddGrad",
+        "BiasAddV1",
+        "Elu",
+        "EluGrad",
+        "FusedBatchNormV2",
+        "FusedBatchNormGradV2",
+        "FusedBatchNormV3",
+        "FusedBatchNormGradV3",
+        "LeakyRelu",
+        "LeakyReluGrad",
+        "Mul",
+        "Sigmoid",
+        "SigmoidGrad",
+        "Sub",
+        "Tanh",
+        "TanhGrad",
+    };
+    UpdateList(&list, to_add, to_remove);
+    return list;
+  }
+
+  // Returns the set of ops that are numerically-dangerous in bfloat16, mostly
+  // reductions and normalizations over many values.
+  static gtl::FlatSet<string> CpuBlackList() {
+    if (IsPseudoFastMath()) {
+      return gtl::FlatSet<string>{};
+    }
+    string to_add, to_remove;
+    TF_CHECK_OK(ReadStringFromEnvVar(
+        "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_BLACKLIST_ADD", "", &to_add));
+    TF_CHECK_OK(ReadStringFromEnvVar(
+        "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_BLACKLIST_REMOVE", "",
+        &to_remove));
+
+    auto list = gtl::FlatSet<string>{
+        "Exp",
+        "Expm1",
+        "L2Loss",
+        "Log",
+        "Log1p",
+        "LogSoftmax",
+        "Mean",
+        "Pow",
+        "SaveV2",
+        "Softmax",
+        "SoftmaxCrossEntropyWithLogits",
+        "SparseSoftmaxCrossEntropyWithLogits",
+        "Sum",
+    };
+    UpdateList(&list, to_add, to_remove);
+    return list;
+  }
+
   // Returns the set of ops that do not have numerically-significant effects
-  // (i.e., they are always considered safe for execution in fp16 precision).
+  // (i.e., they are always considered safe for execution in fp16 or bfloat16
+  // precision).
   static gtl::FlatSet<string> ClearList() {
     if (IsPseudoFastMath()) {
       return gtl::FlatSet<string>{};
@@ -21,6 +21,9 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/grappler/devices.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
@@ -31,6 +34,105 @@ namespace tensorflow {
 namespace grappler {
 const char kAutoParallelPrefix[] = "AutoParallel";
 
+namespace {
+
+// Default value of AutoParallelOptions.model_parallel_min_cost_us.
+constexpr int64 kDefaultMinSplitCostUs = 100;
+// Bandwidth assumed for the copies between two GPUs, in GB/s (roughly that of
+// a PCIe 3.0 x16 link).
+constexpr double kInterDeviceGBPerSec = 12.0;
+
+// The ways of splitting C = MatMul(A, B) across devices.
+enum class MatMulSplit {
+  // Split the rows of A (and C): B is broadcast to every device.
+  kBatch,
+  // Split the columns of B (and C): A is broadcast to every device.
+  kChannel,
+  // Split the reduction dimension of A and B: the partial products are summed.
+  kReduction,
+};
+
+struct MatMulShardingPlan {
+  MatMulSplit split;
+  // Dimension of A and B to split along, or -1 for a broadcast input.
+  int a_split_dim;
+  int b_split_dim;
+};
+
+// Returns the number of bytes copied between devices when splitting a MatMul
+// whose inputs and output take `a_bytes`, `b_bytes` and `c_bytes` into
+// `num_shards` shards. The inputs are assumed to live on the first device, and
+// the result is gathered back there.
+int64 InterDeviceBytes(MatMulSplit split, int64 a_bytes, int64 b_bytes,
+                       int64 c_bytes, int num_shards) {
+  const int64 remote = num_shards - 1;
+  switch (split) {
+    case MatMulSplit::kBatch:
+      return (a_bytes + c_bytes) * remote / num_shards + b_bytes * remote;
+    case MatMulSplit::kChannel:
+      return (b_bytes + c_bytes) * remote / num_shards + a_bytes * remote;
+    case MatMulSplit::kReduction:
+      return (a_bytes + b_bytes) * remote / num_shards + c_bytes * remote;
+  }
+  return 0;
+}
+
+// Returns the names of the GPUs available to the graph, sorted.
+std::vector<string> GetShardingDevices(Cluster* cluster) {
+  std::vector<string> devices;
+  if (cluster != nullptr) {
+    for (const auto& device : cluster->GetDevices()) {
+      if (device.second.type() == "GPU") devices.push_back(device.first);
+    }
+    std::sort(devices.begin(), devices.end());
+  } else {
+    const int num_gpus = GetNumAvailableGPUs();
+    for (int i = 0; i < num_gpus; ++i) {
+      devices.push_back(strings::StrCat("/device:GPU:", i));
+    }
+  }
+  return devices;
+}
+
+NodeDef* AddSplitDimNode(const string& name, int split_dim, GraphDef* graph) {
+  NodeDef* node = graph->add_node();
+  node->set_name(name);
+  node->set_op("Const");
+  AttrValue attr_data_type;
+  attr_data_type.set_type(DT_INT32);
+  node->mutable_attr()->insert({"dtype", attr_data_type});
+  AttrValue attr_tensor;
+  auto tensor = attr_tensor.mutable_tensor();
+  tensor->add_int_val(split_dim);
+  tensor->set_dtype(DT_INT32);
+  node->mutable_attr()->insert({"value", attr_tensor});
+  return node;
+}
+
+// Splits `input` along `split_dim` into `num_shards` tensors, and returns the
+// name of the node producing them.
+string AddSplitNode(const NodeDef& matmul, const string& input,
+                    const string& suffix, int split_dim, int num_shards,
+                    GraphDef* graph) {
+  const string prefix =
+      strings::StrCat(kAutoParallelPrefix, "-Split-", suffix);
+  NodeDef* split_dim_node = AddSplitDimNode(
+      AddPrefixToNodeName(strings::StrCat(matmul.name(), "/dim"), prefix),
+      split_dim, graph);
+  split_dim_node->set_device(matmul.device());
+  NodeDef* split = graph->add_node();
+  split->set_name(AddPrefixToNodeName(matmul.name(), prefix));
+  split->set_op("Split");
+  split->set_device(matmul.device());
+  split->add_input(split_dim_node->name());
+  split->add_input(input);
+  (*split->mutable_attr())["T"] = matmul.attr().at("T");
+  (*split->mutable_attr())["num_split"].set_i(num_shards);
+  return split->name();
+}
+
+}  // namespace
+
 NodeDef* AutoParallel::AddNodeDivConst() {
   NodeDef* node = graph_.add_node();
   node->set_name(strings::StrCat(kAutoParallelPrefix, "-Div-Const"));
@@ -260,8 +362,171 @@ void AutoParallel::BuildGraph(GraphDef* graph) {
   LOG(INFO) << "Parallelized graph size: " << graph->node_size();
 }
 
+Status AutoParallel::ShardModel(Cluster* cluster, const GrapplerItem& item,
+                                GraphDef* output) {
+  const std::vector<string> devices = GetShardingDevices(cluster);
+  const int num_shards = devices.size();
+  if (num_shards < 2) {
+    return errors::Aborted("Nothing to do: model parallelism needs at least ",
+                           "2 GPUs, found ", num_shards);
+  }
+
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically(
+      /*assume_valid_feeds=*/false, /*aggressive_shape_inference=*/false,
+      /*include_tensor_values=*/false));
+
+  DeviceProperties gpu;
+  if (cluster != nullptr) {
+    gpu = cluster->GetDevices().at(devices[0]);
+  } else {
+    gpu = GetDeviceInfo(devices[0]);
+  }
+  OpLevelCostEstimator cost_estimator;
+  const double min_split_cost_ns =
+      1e3 * (min_split_cost_us_ > 0 ? min_split_cost_us_
+                                    : kDefaultMinSplitCostUs);
+
+  *output = item.graph;
+  const int original_size = output->node_size();
+  int num_split = 0;
+  for (int i = 0; i < original_size; ++i) {
+    NodeDef* node = output->mutable_node(i);
+    if (node->op() != "MatMul") continue;
+    const std::vector<OpInfo::TensorProperties>& input_props =
+        properties.GetInputProperties(node->name());
+    const std::vector<OpInfo::TensorProperties>& output_props =
+        properties.GetOutputProperties(node->name());
+    if (input_props.size() != 2 || output_props.size() != 1) continue;
+    const PartialTensorShape a_shape(input_props[0].shape());
+    const PartialTensorShape b_shape(input_props[1].shape());
+    if (!a_shape.IsFullyDefined() || !b_shape.IsFullyDefined() ||
+        a_shape.dims() != 2 || b_shape.dims() != 2) {
+      continue;
+    }
+
+    OpContext op_context;
+    op_context.name = node->name();
+    op_context.device_name = devices[0];
+    OpInfo& op_info = op_context.op_info;
+    op_info.set_op(node->op());
+    *op_info.mutable_attr() = node->attr();
+    *op_info.mutable_device() = gpu;
+    for (const auto& input : input_props) *op_info.add_inputs() = input;
+    *op_info.add_outputs() = output_props[0];
+    const Costs costs = cost_estimator.PredictCosts(op_context);
+    const double cost_ns = costs.execution_time.count();
+    if (cost_ns < min_split_cost_ns) continue;
+
+    const bool transpose_a =
+        node->attr().count("transpose_a") && node->attr().at("transpose_a").b();
+    const bool transpose_b =
+        node->attr().count("transpose_b") && node->attr().at("transpose_b").b();
+    const int m_dim_a = transpose_a ? 1 : 0;
+    const int k_dim_a = 1 - m_dim_a;
+    const int k_dim_b = transpose_b ? 1 : 0;
+    const int n_dim_b = 1 - k_dim_b;
+
+    // Pick the split that copies the fewest bytes between the devices, among
+    // the ones that split the tensors evenly.
+    const std::vector<MatMulShardingPlan> candidates = {
+        {MatMulSplit::kBatch, m_dim_a, -1},
+        {MatMulSplit::kChannel, -1, n_dim_b},
+        {MatMulSplit::kReduction, k_dim_a, k_dim_b}};
+    const int64 a_bytes = CalculateTensorSize(input_props[0]);
+    const int64 b_bytes = CalculateTensorSize(input_props[1]);
+    const int64 c_bytes = CalculateTensorSize(output_props[0]);
+    const MatMulShardingPlan* plan = nullptr;
+    int64 plan_bytes = kint64max;
+    for (const MatMulShardingPlan& candidate : candidates) {
+      if ((candidate.a_split_dim >= 0 &&
+           a_shape.dim_size(candidate.a_split_dim) % num_shards != 0) ||
+          (candidate.b_split_dim >= 0 &&
+           b_shape.dim_size(candidate.b_split_dim) % num_shards != 0)) {
+        continue;
+      }
+      const int64 bytes = InterDeviceBytes(candidate.split, a_bytes, b_bytes,
+                                           c_bytes, num_shards);
+      if (bytes < plan_bytes) {
+        plan = &candidate;
+        plan_bytes = bytes;
+      }
+    }
+    if (plan == nullptr) continue;
+    const double transfer_ns = plan_bytes / kInterDeviceGBPerSec;
+    if (cost_ns / num_shards + transfer_ns >= cost_ns) continue;
+    VLOG(2) << "Splitting " << node->name() << " across " << num_shards
+            << " devices: cost=" << cost_ns << "ns transfer=" << transfer_ns
+            << "ns split=" << static_cast<int>(plan->split);
+
+    // Copy the attributes before the original node gets overwritten below.
+    const NodeDef matmul = *node;
+    std::vector<string> control_inputs;
+    for (const string& input : matmul.input()) {
+      if (IsControlInput(input)) control_inputs.push_back(input);
+    }
+    string a_split;
+    if (plan->a_split_dim >= 0) {
+      a_split = AddSplitNode(matmul, matmul.input(0), "A", plan->a_split_dim,
+                             num_shards, output);
+    }
+    string b_split;
+    if (plan->b_split_dim >= 0) {
+      b_split = AddSplitNode(matmul, matmul.input(1), "B", plan->b_split_dim,
+                             num_shards, output);
+    }
+    std::vector<string> shards;
+    for (int shard = 0; shard < num_shards; ++shard) {
+      NodeDef* shard_node = output->add_node();
+      *shard_node = matmul;
+      shard_node->set_name(AddPrefixToNodeName(
+          matmul.name(),
+          strings::StrCat(kAutoParallelPrefix, "-Shard-", shard)));
+      shard_node->set_device(devices[shard]);
+      shard_node->clear_input();
+      shard_node->add_input(a_split.empty()
+                                ? matmul.input(0)
+                                : strings::StrCat(a_split, ":", shard));
+      shard_node->add_input(b_split.empty()
+                                ? matmul.input(1)
+                                : strings::StrCat(b_split, ":", shard));
+      for (const string& control : control_inputs) {
+        shard_node->add_input(control);
+      }
+      shards.push_back(shard_node->name());
+    }
+
+    // Gather the shards back in place of the original node, so that its
+    // consumers and fetches don't need to be rewired. `node` is still valid
+    // since the repeated field doesn't move its elements.
+    node->clear_input();
+    node->clear_attr();
+    for (const string& shard : shards) node->add_input(shard);
+    (*node->mutable_attr())["T"] = matmul.attr().at("T");
+    (*node->mutable_attr())["N"].set_i(num_shards);
+    if (plan->split == MatMulSplit::kReduction) {
+      node->set_op("AddN");
+    } else {
+      NodeDef* axis = AddSplitDimNode(
+          AddPrefixToNodeName(
+              strings::StrCat(matmul.name(), "/axis"),
+              strings::StrCat(kAutoParallelPrefix, "-Concat")),
+          plan->split == MatMulSplit::kBatch ? 0 : 1, output);
+      axis->set_device(matmul.device());
+      node->set_op("ConcatV2");
+      node->add_input(axis->name());
+      (*node->mutable_attr())["Tidx"].set_type(DT_INT32);
+    }
+    ++num_split;
+  }
+  VLOG(1) << "Split " << num_split << " MatMul ops across " << num_shards
+          << " devices";
+  return Status::OK();
+}
+
 Status AutoParallel::Optimize(Cluster* cluster, const GrapplerItem& item,
                               GraphDef* output) {
+  if (model_parallel_) return ShardModel(cluster, item, output);
   TF_RETURN_IF_ERROR(Initialize(item));
   BuildGraph(output);
   return Status::OK();
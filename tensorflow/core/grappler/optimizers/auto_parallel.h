@@ -19,16 +19,33 @@ limitations under the License.
 #include "tensorflow/core/framework/variable.pb.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
 
 namespace tensorflow {
 namespace grappler {
 
 // Automatically parallelize a graph by splitting in the batch dimension.
+//
+// In model parallel mode, the graph isn't replicated. Instead, the MatMul ops
+// that are expensive enough according to the cost model are split across the
+// GPUs of the cluster, either along the batch dimension, the output channels
+// or the reduction dimension, whichever moves the fewest bytes between the
+// devices. The partial results are gathered back with a concat (or summed
+// with an AddN) on the device of the original op.
 class AutoParallel : public GraphOptimizer {
  public:
-  AutoParallel(int num_replicas) : num_replicas_(num_replicas) {
+  AutoParallel(int num_replicas)
+      : num_replicas_(num_replicas),
+        model_parallel_(false),
+        min_split_cost_us_(0) {
     CHECK(num_replicas_ >= 2);
   }
+  explicit AutoParallel(const AutoParallelOptions& options)
+      : num_replicas_(options.num_replicas()),
+        model_parallel_(options.model_parallel()),
+        min_split_cost_us_(options.model_parallel_min_cost_us()) {
+    CHECK(model_parallel_ || num_replicas_ >= 2);
+  }
   ~AutoParallel() override {}
 
   string name() const override { return "autoparallel"; };
@@ -50,6 +67,8 @@ class AutoParallel : public GraphOptimizer {
   const GrapplerItem* item_;
   int num_replicas_;
   int num_gpus_;
+  bool model_parallel_;
+  int64 min_split_cost_us_;
   Status Initialize(const GrapplerItem& item);
   NodeDef* AddNodeDivConst();
   NodeDef* AddNodeDiv(const string& name, const string& input_a,
@@ -60,6 +79,9 @@ class AutoParallel : public GraphOptimizer {
   void AddSharedNodes(GraphDef* graph);
   void AddOneReplica(GraphDef* graph, int number);
   void BuildGraph(GraphDef* graph);
+  // Splits the expensive MatMul ops of `item` across the GPUs of `cluster`.
+  Status ShardModel(Cluster* cluster, const GrapplerItem& item,
+                    GraphDef* output);
 };
 
 }  // end namespace grappler
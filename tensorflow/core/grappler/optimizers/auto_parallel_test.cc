@@ -16,16 +16,38 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/auto_parallel.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
 namespace grappler {
 namespace {
 
-class AutoParallelTest : public ::testing::Test {};
+class AutoParallelTest : public ::testing::Test {
+ protected:
+  static std::unique_ptr<VirtualCluster> CreateVirtualCluster(int num_gpus) {
+    DeviceProperties cpu_device;
+    cpu_device.set_type("CPU");
+    cpu_device.set_frequency(1000);
+    cpu_device.set_num_cores(4);
+    DeviceProperties gpu_device;
+    gpu_device.set_type("GPU");
+    gpu_device.set_frequency(1000);
+    gpu_device.set_num_cores(2);
+    gpu_device.mutable_environment()->insert({"architecture", "6"});
+    std::unordered_map<string, DeviceProperties> devices;
+    devices["/job:localhost/replica:0/task:0/cpu:0"] = cpu_device;
+    for (int i = 0; i < num_gpus; ++i) {
+      devices[strings::StrCat("/job:localhost/replica:0/task:0/gpu:", i)] =
+          gpu_device;
+    }
+    return std::unique_ptr<VirtualCluster>(new VirtualCluster(devices));
+  }
+};
 
 TEST_F(AutoParallelTest, SimpleParallel) {
   tensorflow::Scope s = tensorflow::Scope::DisabledShapeInferenceScope();
@@ -126,6 +148,85 @@ TEST_F(AutoParallelTest, SimpleParallel) {
   EXPECT_EQ("^AutoParallel-Control-Fetch", node_gradient.input(0));
 }
 
+TEST_F(AutoParallelTest, ModelParallelMatMul) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({1024, 1024}));
+  Output w = ops::Placeholder(s.WithOpName("w"), DT_FLOAT,
+                              ops::Placeholder::Shape({1024, 4096}));
+  Output wide = ops::MatMul(s.WithOpName("wide"), x, w);
+  Output y = ops::Placeholder(s.WithOpName("y"), DT_FLOAT,
+                              ops::Placeholder::Shape({2, 2}));
+  Output small = ops::MatMul(s.WithOpName("small"), y, y);
+
+  GrapplerItem item;
+  item.fetch = {"wide", "small"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  AutoParallelOptions options;
+  options.set_model_parallel(true);
+  AutoParallel parallel(options);
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster(2));
+  GraphDef output;
+  TF_EXPECT_OK(parallel.Optimize(cluster.get(), item, &output));
+
+  // The weights are the largest input and are split along the output
+  // channels, while the activations are broadcast to both GPUs.
+  NodeMap node_map(&output);
+  const NodeDef* concat = node_map.GetNode("wide");
+  ASSERT_NE(nullptr, concat);
+  EXPECT_EQ("ConcatV2", concat->op());
+  ASSERT_EQ(3, concat->input_size());
+  EXPECT_EQ("AutoParallel-Shard-0/wide", concat->input(0));
+  EXPECT_EQ("AutoParallel-Shard-1/wide", concat->input(1));
+  const NodeDef* axis = node_map.GetNode(concat->input(2));
+  ASSERT_NE(nullptr, axis);
+  EXPECT_EQ(1, axis->attr().at("value").tensor().int_val(0));
+
+  const NodeDef* split = node_map.GetNode("AutoParallel-Split-B/wide");
+  ASSERT_NE(nullptr, split);
+  EXPECT_EQ("Split", split->op());
+  EXPECT_EQ("w", split->input(1));
+  EXPECT_EQ(2, split->attr().at("num_split").i());
+
+  for (int i = 0; i < 2; ++i) {
+    const NodeDef* shard =
+        node_map.GetNode(strings::StrCat("AutoParallel-Shard-", i, "/wide"));
+    ASSERT_NE(nullptr, shard);
+    EXPECT_EQ("MatMul", shard->op());
+    EXPECT_EQ(strings::StrCat("/job:localhost/replica:0/task:0/gpu:", i),
+              shard->device());
+    ASSERT_EQ(2, shard->input_size());
+    EXPECT_EQ("x", shard->input(0));
+    EXPECT_EQ(strings::StrCat("AutoParallel-Split-B/wide:", i),
+              shard->input(1));
+  }
+
+  // Cheap MatMuls are left alone.
+  const NodeDef* small_node = node_map.GetNode("small");
+  ASSERT_NE(nullptr, small_node);
+  EXPECT_EQ("MatMul", small_node->op());
+}
+
+TEST_F(AutoParallelTest, ModelParallelNeedsSeveralGPUs) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({1024, 1024}));
+  Output wide = ops::MatMul(s.WithOpName("wide"), x, x);
+
+  GrapplerItem item;
+  item.fetch = {"wide"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  AutoParallelOptions options;
+  options.set_model_parallel(true);
+  AutoParallel parallel(options);
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster(1));
+  GraphDef output;
+  Status status = parallel.Optimize(cluster.get(), item, &output);
+  EXPECT_EQ(error::ABORTED, status.code());
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
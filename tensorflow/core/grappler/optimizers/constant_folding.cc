@@ -40,8 +40,10 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/evaluation_utils.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/symbolic_shapes.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/numbers.h"
@@ -187,11 +189,24 @@ float QuantizedTypeMaxAsFloat(DataType data_type) {
 }  // namespace
 
 ConstantFolding::ConstantFolding(RewriterConfig::Toggle opt_level,
-                                 DeviceBase* cpu_device)
-    : opt_level_(opt_level), cpu_device_(cpu_device) {
+                                 DeviceBase* cpu_device,
+                                 int64 max_constant_size,
+                                 int64 total_constant_budget, int num_threads)
+    : opt_level_(opt_level),
+      cpu_device_(cpu_device),
+      max_constant_size_(max_constant_size > 0 ? max_constant_size
+                                               : kMaxConstantSize),
+      total_constant_budget_(total_constant_budget),
+      materialized_constant_size_(0),
+      num_threads_(num_threads) {
   resource_mgr_.reset(new ResourceMgr());
 }
 
+ConstantFolding::ConstantFolding(RewriterConfig::Toggle opt_level,
+                                 DeviceBase* cpu_device)
+    : ConstantFolding(opt_level, cpu_device, kMaxConstantSize,
+                      /*total_constant_budget=*/0, /*num_threads=*/1) {}
+
 ConstantFolding::ConstantFolding(DeviceBase* cpu_device)
     : ConstantFolding(RewriterConfig::ON, cpu_device) {}
 
@@ -1051,7 +1066,7 @@ bool ConstantFolding::IsFoldable(const NodeDef& node,
       if (output_shape.IsFullyDefined()) {
         const int64 num_bytes =
             output_shape.num_elements() * DataTypeSize(output_prop.dtype());
-        if (num_bytes > input_size_bytes && num_bytes > kMaxConstantSize) {
+        if (num_bytes > input_size_bytes && num_bytes > max_constant_size_) {
           // Do not fold nodes if the in-memory size of output is too large.
           // Notice that this is not exactly the same check used in
           // CreateNodeDef() where the actual encoded size is checked.
@@ -1169,7 +1184,8 @@ bool IsValidConstShapeForMulConvPushDown(
 // static
 Status ConstantFolding::CreateNodeDef(const string& name,
                                       const TensorValue& tensor, NodeDef* node,
-                                      size_t original_size) {
+                                      size_t original_size,
+                                      int64 max_constant_size) {
   node->set_name(name);
   node->set_op("Const");
 
@@ -1248,10 +1264,10 @@ Status ConstantFolding::CreateNodeDef(const string& name,
   }
   node->mutable_attr()->insert({"value", attr_tensor});
 
-  if (encoded_size > original_size && encoded_size >= kMaxConstantSize) {
+  if (encoded_size > original_size && encoded_size >= max_constant_size) {
     return errors::InvalidArgument(
         strings::StrCat("Can't fold ", name, ", its size would be too large (",
-                        encoded_size, " >= ", kMaxConstantSize, " bytes)"));
+                        encoded_size, " >= ", max_constant_size, " bytes)"));
   }
   return Status::OK();
 }
@@ -1313,7 +1329,7 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
     }
     if (output_tensors[i].tensor) {
       Status s = CreateNodeDef(node_name, output_tensors[i], &outputs->at(i),
-                               total_inputs_size);
+                               total_inputs_size, max_constant_size_);
       if (!s.ok()) {
         *result_too_large = true;
         return s;
@@ -1418,21 +1434,14 @@ Status ConstantFolding::FoldMergeNode(NodeDef* node, GraphDef* output_graph) {
   return Status::OK();
 }
 
-Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
-                                 bool* result_too_large) {
-  *result_too_large = false;
-  if (IsMerge(*node)) {
-    return FoldMergeNode(node, output_graph);
-  }
-
-  std::vector<NodeDef> const_nodes;
-  TF_RETURN_IF_ERROR(
-      EvaluateOneFoldable(*node, &const_nodes, result_too_large));
+Status ConstantFolding::FoldNode(NodeDef* node,
+                                 std::vector<NodeDef>* const_nodes,
+                                 GraphDef* output_graph) {
   VLOG(2) << "Folded node: " << SummarizeNodeDef(*node);
 
   NodeDef* constant_output = nullptr;
-  for (int i = 0; i < const_nodes.size(); i++) {
-    NodeDef* const_node = &const_nodes[i];
+  for (int i = 0; i < const_nodes->size(); i++) {
+    NodeDef* const_node = &(*const_nodes)[i];
     VLOG(3) << "Generated constant node: " << SummarizeNodeDef(*const_node);
     if (const_node->name().empty()) {
       // Dead output: we can't create a constant to encode its value, so we'll
@@ -1470,7 +1479,7 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
 
     // We rewrite the existing node if it only has a single output, and
     // create new nodes otherwise.
-    if (const_nodes.size() == 1) {
+    if (const_nodes->size() == 1) {
       node->set_op("Const");
       // Note we need to clear the inputs in NodeMap before we clear the inputs
       // in the node, otherwise NodeMap would see empty inputs and effectively
@@ -1503,7 +1512,7 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
     }
   }
 
-  if (const_nodes.size() > 1) {
+  if (const_nodes->size() > 1) {
     auto outputs = node_map_->GetOutputs(node->name());
     for (NodeDef* output : outputs) {
       for (int i = 0; i < output->input_size(); i++) {
@@ -1518,12 +1527,13 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
                                      constant_output->name());
               *output->mutable_input(i) = AsControlDependency(*constant_output);
             }
-          } else if (port < const_nodes.size() &&
-                     !const_nodes[port].name().empty()) {
+          } else if (port < const_nodes->size() &&
+                     !(*const_nodes)[port].name().empty()) {
             // Replace alive outputs with the corresponding constant.
+            const string& const_name = (*const_nodes)[port].name();
             node_map_->UpdateInput(output->name(), NodeName(output->input(i)),
-                                   const_nodes[port].name());
-            *output->mutable_input(i) = const_nodes[port].name();
+                                   const_name);
+            *output->mutable_input(i) = const_name;
           } else {
             // Leave this edge alone.
             VLOG(3) << "Preserving edge from " << node->name() << ":" << port
@@ -1543,6 +1553,19 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
   return Status::OK();
 }
 
+namespace {
+// Returns the total encoded size of the constants created by
+// EvaluateOneFoldable(), ignoring the placeholders for dead outputs.
+int64 EncodedConstantsSize(const std::vector<NodeDef>& const_nodes) {
+  int64 size = 0;
+  for (const NodeDef& const_node : const_nodes) {
+    if (const_node.name().empty()) continue;
+    size += const_node.attr().at("value").tensor().ByteSizeLong();
+  }
+  return size;
+}
+}  // namespace
+
 Status ConstantFolding::FoldGraph(
     const GraphProperties& properties, GraphDef* output,
     absl::flat_hash_set<string>* nodes_to_not_simplify) {
@@ -1555,34 +1578,91 @@ Status ConstantFolding::FoldGraph(
       queue.push_back(graph_->mutable_node(i));
     }
   }
+  std::unique_ptr<thread::ThreadPool> thread_pool;
+  if (num_threads_ > 1) {
+    thread_pool.reset(new thread::ThreadPool(
+        Env::Default(), "constant_folding", num_threads_));
+  }
   while (!queue.empty()) {
-    NodeDef* node = queue.front();
-    queue.pop_front();
-    if (processed_nodes.count(node->name())) {
-      continue;
-    }
-    // We need to record a copy of output nodes before FoldNode() modifies it.
-    // We also need to ensure that the fanout is sorted deterministically.
-    const std::set<NodeDef*>& outputs = node_map_->GetOutputs(node->name());
-    std::vector<NodeDef*> fanout(outputs.begin(), outputs.end());
-    std::sort(fanout.begin(), fanout.end(),
-              [](const NodeDef* n1, const NodeDef* n2) {
-                return n1->name() < n2->name();
-              });
-
-    bool result_too_large = false;
-    Status s = FoldNode(node, output, &result_too_large);
-    processed_nodes.insert(node->name());
-    if (!s.ok()) {
-      VLOG(1) << "Failed to fold node " << node->DebugString()
-              << "\nError message: " << s;
-      if (result_too_large) {
-        nodes_to_not_simplify->emplace(node->name());
+    // Every node in the queue only has constant inputs, so folding one of them
+    // never changes the inputs of the others. We therefore evaluate all the
+    // queued nodes first (in parallel if we can), and then rewrite the graph
+    // one node at a time, in queue order.
+    std::vector<NodeDef*> batch;
+    absl::flat_hash_set<string> batch_names;
+    for (NodeDef* node : queue) {
+      if (processed_nodes.count(node->name()) ||
+          !batch_names.insert(node->name()).second) {
+        continue;
       }
+      batch.push_back(node);
+    }
+    queue.clear();
+
+    const int batch_size = batch.size();
+    std::vector<std::vector<NodeDef>> const_nodes(batch_size);
+    std::vector<Status> statuses(batch_size);
+    std::unique_ptr<bool[]> result_too_large(new bool[batch_size]());
+    auto evaluate_node = [&](int i) {
+      // Merge nodes are folded without evaluating them.
+      if (IsMerge(*batch[i])) return;
+      statuses[i] =
+          EvaluateOneFoldable(*batch[i], &const_nodes[i], &result_too_large[i]);
+    };
+    if (thread_pool != nullptr && batch_size > 1) {
+      BlockingCounter counter(batch_size);
+      for (int i = 0; i < batch_size; ++i) {
+        thread_pool->Schedule([&evaluate_node, &counter, i]() {
+          evaluate_node(i);
+          counter.DecrementCount();
+        });
+      }
+      counter.Wait();
     } else {
-      for (auto& output : fanout) {
-        if (IsFoldable(*output, &properties)) {
-          queue.push_back(output);
+      for (int i = 0; i < batch_size; ++i) evaluate_node(i);
+    }
+
+    for (int i = 0; i < batch_size; ++i) {
+      NodeDef* node = batch[i];
+      // We need to record a copy of output nodes before FoldNode() modifies
+      // it. We also need to ensure that the fanout is sorted
+      // deterministically.
+      const std::set<NodeDef*>& outputs = node_map_->GetOutputs(node->name());
+      std::vector<NodeDef*> fanout(outputs.begin(), outputs.end());
+      std::sort(fanout.begin(), fanout.end(),
+                [](const NodeDef* n1, const NodeDef* n2) {
+                  return n1->name() < n2->name();
+                });
+
+      Status s = statuses[i];
+      if (IsMerge(*node)) {
+        s = FoldMergeNode(node, output);
+      } else if (s.ok()) {
+        const int64 constants_size = EncodedConstantsSize(const_nodes[i]);
+        if (total_constant_budget_ > 0 &&
+            materialized_constant_size_ + constants_size >
+                total_constant_budget_) {
+          result_too_large[i] = true;
+          s = errors::ResourceExhausted(
+              "Can't fold ", node->name(), ", the folded constants would ",
+              "exceed the budget of ", total_constant_budget_, " bytes");
+        } else {
+          s = FoldNode(node, &const_nodes[i], output);
+          if (s.ok()) materialized_constant_size_ += constants_size;
+        }
+      }
+      processed_nodes.insert(node->name());
+      if (!s.ok()) {
+        VLOG(1) << "Failed to fold node " << node->DebugString()
+                << "\nError message: " << s;
+        if (result_too_large[i]) {
+          nodes_to_not_simplify->emplace(node->name());
+        }
+      } else {
+        for (auto& output : fanout) {
+          if (IsFoldable(*output, &properties)) {
+            queue.push_back(output);
+          }
         }
       }
     }
@@ -3729,6 +3809,7 @@ Status ConstantFolding::Optimize(Cluster* cluster, const GrapplerItem& item,
     cpu_device_ = owned_device_.get();
   }
 
+  materialized_constant_size_ = 0;
   graph_contains_assign_or_inplace_op_ = false;
   for (const NodeDef& node : item.graph.node()) {
     if (ModifiesInputsInPlace(node) || HasRefInput(node)) {
@@ -40,12 +40,20 @@ class ConstantFolding : public GraphOptimizer {
   // The size limit will only be considered if the newly created node is greater
   // than original_size (optional).
   static Status CreateNodeDef(const string& name, const TensorValue& tensor,
-                              NodeDef* node, size_t original_size = 0);
+                              NodeDef* node, size_t original_size = 0,
+                              int64 max_constant_size = kMaxConstantSize);
   static string AddControlDependency(const string& input_name, GraphDef* graph,
                                      NodeMap* node_map);
 
   explicit ConstantFolding(DeviceBase* cpu_device);
   ConstantFolding(RewriterConfig::Toggle opt_level, DeviceBase* cpu_device);
+  // `max_constant_size` bounds the encoded size of every folded constant,
+  // `total_constant_budget` (if positive) bounds the total encoded size of all
+  // the constants materialized by folding, and `num_threads` (if greater than
+  // 1) is the number of threads used to evaluate independent foldable nodes.
+  ConstantFolding(RewriterConfig::Toggle opt_level, DeviceBase* cpu_device,
+                  int64 max_constant_size, int64 total_constant_budget,
+                  int num_threads);
 
   ~ConstantFolding() override {}
 
@@ -90,8 +98,10 @@ class ConstantFolding : public GraphOptimizer {
                              bool* result_too_large);
 
   Status FoldMergeNode(NodeDef* node, GraphDef* output_graph);
-  Status FoldNode(NodeDef* node, GraphDef* output_graph,
-                  bool* result_too_large);
+  // Replaces `node` with the constants in `const_nodes`, previously computed
+  // by EvaluateOneFoldable().
+  Status FoldNode(NodeDef* node, std::vector<NodeDef>* const_nodes,
+                  GraphDef* output_graph);
 
   bool IsOnes(const NodeDef& node) const;
   bool IsZeros(const NodeDef& node) const;
@@ -305,6 +315,11 @@ class ConstantFolding : public GraphOptimizer {
   std::unique_ptr<DeviceBase> owned_device_;
 
   std::unique_ptr<ResourceMgr> resource_mgr_;
+  int64 max_constant_size_;
+  int64 total_constant_budget_;
+  // Total encoded size of the constants materialized by FoldGraph() so far.
+  int64 materialized_constant_size_;
+  int num_threads_;
   GraphDef* graph_;
   std::unique_ptr<NodeMap> node_map_;
   std::unordered_set<string> nodes_to_preserve_;
@@ -3010,6 +3010,110 @@ TEST_F(ConstantFoldingTest, LargeConstantNoSizeIncrease) {
   EXPECT_LT(output.ByteSizeLong(), sizeof(float) * large_constant_size + 500);
 }
 
+TEST_F(ConstantFoldingTest, ParallelFolding) {
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+  GrapplerItem item;
+  for (int i = 0; i < 8; ++i) {
+    const string suffix = strings::StrCat("_", i);
+    Output x = ops::Const(scope.WithOpName("x" + suffix),
+                          static_cast<float>(i), {2, 2});
+    Output y = ops::Const(scope.WithOpName("y" + suffix), 2.0f, {2, 2});
+    Output mul = ops::Mul(scope.WithOpName("mul" + suffix), x, y);
+    Output add = ops::Add(scope.WithOpName("add" + suffix), mul, x);
+    item.fetch.push_back("add" + suffix);
+  }
+  TF_CHECK_OK(scope.ToGraphDef(&item.graph));
+
+  ConstantFolding sequential(RewriterConfig::ON, /*cpu_device=*/nullptr);
+  GraphDef expected;
+  TF_EXPECT_OK(sequential.Optimize(/*cluster=*/nullptr, item, &expected));
+
+  ConstantFolding parallel(RewriterConfig::ON, /*cpu_device=*/nullptr,
+                           kMaxConstantSize, /*total_constant_budget=*/0,
+                           /*num_threads=*/4);
+  GraphDef output;
+  TF_EXPECT_OK(parallel.Optimize(/*cluster=*/nullptr, item, &output));
+
+  // The graph must not depend on the order in which the nodes were evaluated.
+  CompareGraphs(expected, output);
+  for (const auto& node : output.node()) {
+    EXPECT_EQ("Const", node.op()) << node.name();
+  }
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(item.fetch.size(), tensors.size());
+  for (int i = 0; i < item.fetch.size(); ++i) {
+    test::ExpectTensorEqual<float>(tensors_expected[i], tensors[i]);
+  }
+}
+
+TEST_F(ConstantFoldingTest, TotalConstantBudget) {
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+  // Use random values so that the folded constants can't be compressed.
+  Tensor value(DT_FLOAT, TensorShape({1000}));
+  value.flat<float>().setRandom();
+  Output a = ops::Const(scope.WithOpName("a"), Input::Initializer(value));
+  Output b = ops::Const(scope.WithOpName("b"), Input::Initializer(value));
+  Output neg_a = ops::Neg(scope.WithOpName("neg_a"), a);
+  Output neg_b = ops::Neg(scope.WithOpName("neg_b"), b);
+
+  GrapplerItem item;
+  item.fetch = {"neg_a", "neg_b"};
+  TF_CHECK_OK(scope.ToGraphDef(&item.graph));
+
+  // The budget only leaves room for one of the two folded constants.
+  ConstantFolding optimizer(RewriterConfig::ON, /*cpu_device=*/nullptr,
+                            kMaxConstantSize, /*total_constant_budget=*/6000,
+                            /*num_threads=*/1);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(/*cluster=*/nullptr, item, &output));
+
+  int num_folded = 0;
+  for (const auto& node : output.node()) {
+    if (node.name() == "neg_a" || node.name() == "neg_b") {
+      if (node.op() == "Const") ++num_folded;
+    }
+  }
+  EXPECT_EQ(1, num_folded);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(2, tensors.size());
+  for (int i = 0; i < 2; ++i) {
+    test::ExpectTensorEqual<float>(tensors_expected[i], tensors[i]);
+  }
+}
+
+TEST_F(ConstantFoldingTest, MaxConstantSize) {
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+  Tensor value(DT_FLOAT, TensorShape({1000}));
+  value.flat<float>().setRandom();
+  Output a = ops::Const(scope.WithOpName("a"), Input::Initializer(value));
+  Output multiples = ops::Const(scope.WithOpName("multiples"), {4}, {1});
+  Output tile = ops::Tile(scope.WithOpName("tile"), a, multiples);
+
+  GrapplerItem item;
+  item.fetch = {"tile"};
+  TF_CHECK_OK(scope.ToGraphDef(&item.graph));
+
+  for (const int64 max_constant_size : {int64{10000}, kMaxConstantSize}) {
+    ConstantFolding optimizer(RewriterConfig::ON, /*cpu_device=*/nullptr,
+                              max_constant_size,
+                              /*total_constant_budget=*/0,
+                              /*num_threads=*/1);
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(/*cluster=*/nullptr, item, &output));
+    for (const auto& node : output.node()) {
+      if (node.name() == "tile") {
+        // The folded tensor takes 16000 bytes.
+        EXPECT_EQ(max_constant_size == kMaxConstantSize ? "Const" : "Tile",
+                  node.op());
+      }
+    }
+  }
+}
+
 TEST_F(ConstantFoldingTest, MaterializeBroadcastGradientArgs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output a =
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_join.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -121,8 +122,9 @@ FunctionDef* AddVectorizedFunction(const NodeDef& map_node,
   DCHECK_EQ(map_defun_node.op(), "MapDefun");
 
   FunctionDef* result;
+  std::vector<string> unvectorized_ops;
   Status s = vectorization_utils::VectorizeMapDefun(
-      *vectorized_func, map_defun_node, library, &result);
+      *vectorized_func, map_defun_node, library, &result, &unvectorized_ops);
 
   if (!s.ok()) {
     LOG(WARNING) << "VectorizeMapDefun failed. The function will only be "
@@ -130,6 +132,13 @@ FunctionDef* AddVectorizedFunction(const NodeDef& map_node,
                  << s;
     return vectorized_func;
   }
+  if (!unvectorized_ops.empty()) {
+    LOG(WARNING) << "The function " << orig_func.signature().name()
+                 << " will only be partially vectorized, and the rest run "
+                    "with MapDefun, since there are no vectorizers for some "
+                    "of its ops. Ops that could not be vectorized: "
+                 << absl::StrJoin(unvectorized_ops, ", ");
+  }
   return result;
 }
 
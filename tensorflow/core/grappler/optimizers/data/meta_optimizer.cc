@@ -36,7 +36,7 @@ using ConfigMap =
     std::map<string, tensorflow::RewriterConfig_CustomGraphOptimizer>;
 
 // tf.data optimizations, in the order we want to perform them.
-constexpr std::array<const char*, 16> kTFDataOptimizations = {
+constexpr std::array<const char*, 17> kTFDataOptimizations = {
     "make_stateless",
     "noop_elimination",
     "shuffle_and_repeat_fusion",
@@ -52,6 +52,7 @@ constexpr std::array<const char*, 16> kTFDataOptimizations = {
     "make_sloppy",
     "parallel_batch",
     "slack",
+    "profile_guided_rewrite",
     "inject_prefetch"};
 
 // Standard grappler optimizations, in the order we want to perform them.
@@ -69,8 +70,10 @@ Status ToConfigMap(
   auto& options = found->list().s();
   for (const auto& option_string : options) {
     // The option string has the format
-    // <optimizer_name>:<config_key>:<config_value>
-    std::vector<string> split = absl::StrSplit(option_string, ':');
+    // <optimizer_name>:<config_key>:<config_value>, where the value may itself
+    // contain ':', e.g. in a file path.
+    std::vector<string> split =
+        absl::StrSplit(option_string, absl::MaxSplits(':', 2));
     if (split.size() != 3) {
       return errors::Internal(
           "Wrong format for optimizer options. Expect <optimizer name>:<config "
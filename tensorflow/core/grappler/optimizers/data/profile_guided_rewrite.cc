@@ -0,0 +1,350 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/profile_guided_rewrite.h"
+
+#include <array>
+#include <map>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mem.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kCacheDataset[] = "CacheDataset";
+constexpr char kMapDataset[] = "MapDataset";
+constexpr char kParallelMapDataset[] = "ParallelMapDataset";
+constexpr char kPrefetchDataset[] = "PrefetchDataset";
+constexpr char kRetValOp[] = "_Retval";
+
+// Transformations which take a smaller share of the processing time of the
+// input pipeline are not worth rewriting.
+constexpr double kMinCostShare = 0.1;
+
+// Default share of available RAM that can be used for caching.
+constexpr double kRamBudgetShare = 0.5;
+
+// Transformations which produce their elements asynchronously, and so already
+// run concurrently with their consumers.
+constexpr std::array<const char*, 5> kAsyncDatasetOps = {
+    "ExperimentalMapAndBatchDataset", "MapAndBatchDataset",
+    "ParallelInterleaveDatasetV2", "ParallelMapDataset", "PrefetchDataset"};
+
+// Removes a version suffix like "V2" from `name`.
+void StripVersion(absl::string_view* name) {
+  const size_t pos = name->find_last_not_of("0123456789");
+  if (pos != absl::string_view::npos && pos + 1 < name->size() &&
+      (*name)[pos] == 'V') {
+    name->remove_suffix(name->size() - pos);
+  }
+}
+
+bool IsDatasetNode(const NodeDef& node) {
+  absl::string_view op = node.op();
+  StripVersion(&op);
+  return absl::EndsWith(op, "Dataset");
+}
+
+// Returns the name that the iterators of `node` use in their prefix, e.g.
+// "ParallelMap" for a "ParallelMapDatasetV2" node.
+string IteratorName(const NodeDef& node) {
+  absl::string_view op = node.op();
+  absl::ConsumePrefix(&op, "Experimental");
+  StripVersion(&op);
+  absl::ConsumeSuffix(&op, "Dataset");
+  StripVersion(&op);
+  return string(op);
+}
+
+// Returns the statistics of the nodes below the `ModelDataset` of `profile`,
+// keyed by the names of their iterators from the top of the input pipeline,
+// e.g. "Prefetch::Map::TensorSlice".
+std::map<string, data::model::NodeProfile> PipelineProfile(
+    const std::map<string, data::model::NodeProfile>& profile) {
+  std::map<string, data::model::NodeProfile> result;
+  for (const auto& pair : profile) {
+    std::vector<absl::string_view> tokens =
+        absl::StrSplit(pair.first, ':', absl::SkipEmpty());
+    auto it = std::find(tokens.begin(), tokens.end(), "Model");
+    if (it == tokens.end() || ++it == tokens.end()) continue;
+    std::vector<absl::string_view> path(it, tokens.end());
+    for (absl::string_view& token : path) {
+      StripVersion(&token);
+    }
+    result[absl::StrJoin(path, "::")] = pair.second;
+  }
+  return result;
+}
+
+bool IsStatelessFunction(const FunctionLibraryDefinition& library,
+                         const NodeDef& node, const string& attr_name) {
+  const FunctionDef* function =
+      library.Find(node.attr().at(attr_name).func().name());
+  return function != nullptr &&
+         !function_utils::IsFunctionStateful(library, *function, true);
+}
+
+// Returns whether `node` produces the same elements in the same order on every
+// pass over its input.
+bool IsDeterministic(const FunctionLibraryDefinition& library,
+                     const NodeDef& node) {
+  static const auto* ops = new std::map<string, string>({
+      // Maps the deterministic transformations to the name of the attribute
+      // holding their function, if any.
+      {"BatchDataset", ""},
+      {"BatchDatasetV2", ""},
+      {"ExperimentalMapAndBatchDataset", "f"},
+      {"FilterDataset", "predicate"},
+      {"FixedLengthRecordDataset", ""},
+      {"FixedLengthRecordDatasetV2", ""},
+      {"MapAndBatchDataset", "f"},
+      {"MapDataset", "f"},
+      {"PaddedBatchDataset", ""},
+      {"PaddedBatchDatasetV2", ""},
+      {"ParallelMapDataset", "f"},
+      {"PrefetchDataset", ""},
+      {"RangeDataset", ""},
+      {"ShardDataset", ""},
+      {"SkipDataset", ""},
+      {"TakeDataset", ""},
+      {"TensorDataset", ""},
+      {"TensorSliceDataset", ""},
+      {"TextLineDataset", ""},
+      {"TFRecordDataset", ""},
+  });
+  auto it = ops->find(node.op());
+  if (it == ops->end()) return false;
+  if (node.attr().count("sloppy") && node.attr().at("sloppy").b()) {
+    return false;
+  }
+  return it->second.empty() || IsStatelessFunction(library, node, it->second);
+}
+
+// Adds a `op` transformation with the given extra inputs after `input`.
+NodeDef* AddTransformationAfter(const NodeDef& input, const string& op,
+                                const std::vector<string>& extra_inputs,
+                                MutableGraphView* graph) {
+  NodeDef node;
+  graph_utils::SetUniqueGraphNodeName(
+      strings::StrCat("profile_guided/", input.name()), graph->graph(), &node);
+  node.set_op(op);
+  node.add_input(input.name());
+  for (const string& extra_input : extra_inputs) {
+    node.add_input(extra_input);
+  }
+  for (const auto& attr_name : {"output_types", "output_shapes"}) {
+    graph_utils::CopyAttribute(attr_name, input, &node);
+  }
+  return graph->AddNode(std::move(node));
+}
+
+NodeDef MakeParallelMap(const string& name, MutableGraphView* graph) {
+  int index = graph_utils::FindGraphNodeWithName(name, *graph->graph());
+  DCHECK_NE(index, -1) << "Failed to find node " << name
+                       << " in the optimized graph.";
+  NodeDef parallel_map = graph->graph()->node(index);
+  graph_utils::SetUniqueGraphNodeName(kParallelMapDataset, graph->graph(),
+                                      &parallel_map);
+  parallel_map.set_op(kParallelMapDataset);
+  auto* num_parallel_calls = graph_utils::AddScalarConstNode(
+      static_cast<int32>(data::model::kAutotune), graph);
+  parallel_map.add_input(num_parallel_calls->name());
+  return parallel_map;
+}
+
+}  // namespace
+
+Status ProfileGuidedRewrite::OptimizeAndCollectStats(Cluster* cluster,
+                                                     const GrapplerItem& item,
+                                                     GraphDef* output,
+                                                     OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+
+  // Only the main input pipeline is profiled, not those of functions.
+  if (item.fetch.size() != 1) return Status::OK();
+  NodeDef* node = graph.GetNode(item.fetch.at(0));
+  if (node == nullptr || node->op() == kRetValOp) return Status::OK();
+
+  std::map<string, data::model::NodeProfile> profile;
+  Env* env = Env::Default();
+  if (!env->FileExists(profile_path_).ok()) {
+    VLOG(1) << "No input pipeline profile at " << profile_path_;
+    return Status::OK();
+  }
+  Status s = data::model::Model::LoadProfile(env, profile_path_, &profile);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring the input pipeline profile at " << profile_path_
+                 << ": " << s;
+    return Status::OK();
+  }
+  profile = PipelineProfile(profile);
+
+  // Collects the main chain of the input pipeline, from its output to its
+  // source, along with the profile of each of its transformations.
+  std::vector<NodeDef*> chain;
+  std::vector<const data::model::NodeProfile*> chain_profile;
+  string path;
+  while (node != nullptr) {
+    if (IsDatasetNode(*node)) {
+      path = path.empty() ? IteratorName(*node)
+                          : strings::StrCat(path, "::", IteratorName(*node));
+      auto it = profile.find(path);
+      chain.push_back(node);
+      chain_profile.push_back(it == profile.end() ? nullptr : &it->second);
+    } else if (node->op() != "Identity") {
+      break;
+    }
+    if (node->input_size() == 0) break;
+    node = graph_utils::GetInputNode(*node, graph);
+  }
+
+  // The share of the processing time of the pipeline spent in each
+  // transformation.
+  std::vector<double> cost_share(chain.size(), 0);
+  double total_time = 0;
+  for (int i = 0; i < chain.size(); ++i) {
+    if (chain_profile[i] == nullptr) continue;
+    const data::model::NodeProfile& node_profile = *chain_profile[i];
+    cost_share[i] = node_profile.processing_time * node_profile.num_elements /
+                    node_profile.parallelism;
+    total_time += cost_share[i];
+  }
+  if (total_time <= 0) {
+    VLOG(1) << "The input pipeline profile at " << profile_path_
+            << " does not match the input pipeline.";
+    return Status::OK();
+  }
+  for (double& share : cost_share) {
+    share /= total_time;
+  }
+
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+  absl::flat_hash_set<string> nodes_to_delete;
+  for (int i = 0; i < chain.size(); ++i) {
+    const NodeDef& chain_node = *chain[i];
+    if (cost_share[i] < kMinCostShare) continue;
+    if (chain_node.op() == kMapDataset &&
+        IsStatelessFunction(function_library, chain_node, "f")) {
+      VLOG(1) << "Parallelizing " << chain_node.name() << ", which took "
+              << cost_share[i] * 100 << "% of the time";
+      NodeDef* parallel_map =
+          graph.AddNode(MakeParallelMap(chain_node.name(), &graph));
+      TF_RETURN_IF_ERROR(
+          graph.UpdateFanouts(chain_node.name(), parallel_map->name()));
+      nodes_to_delete.insert(chain_node.name());
+      chain[i] = parallel_map;
+      stats->num_changes++;
+      continue;
+    }
+    const bool is_async =
+        std::find(kAsyncDatasetOps.begin(), kAsyncDatasetOps.end(),
+                  chain_node.op()) != kAsyncDatasetOps.end();
+    if (!is_async && (i == 0 || chain[i - 1]->op() != kPrefetchDataset)) {
+      VLOG(1) << "Prefetching the output of " << chain_node.name()
+              << ", which took " << cost_share[i] * 100 << "% of the time";
+      NodeDef* autotune_value =
+          graph_utils::AddScalarConstNode(data::model::kAutotune, &graph);
+      NodeDef* prefetch = AddTransformationAfter(
+          chain_node, kPrefetchDataset, {autotune_value->name()}, &graph);
+      (*prefetch->mutable_attr())["legacy_autotune"].set_b(false);
+      TF_RETURN_IF_ERROR(
+          graph.UpdateFanouts(chain_node.name(), prefetch->name()));
+      stats->num_changes++;
+    }
+  }
+
+  // Caches the output of the highest transformation whose input is
+  // deterministic and finite, takes enough time to be worth caching, and whose
+  // measured elements fit in the budget. Since every transformation in the
+  // chain consumes the elements of the one below it, the processing time
+  // saved by caching the output of transformation `i` is the sum of the
+  // shares of transformations `i` and below.
+  const bool has_cache =
+      std::any_of(chain.begin(), chain.end(), [](const NodeDef* chain_node) {
+        return absl::StartsWith(chain_node->op(), kCacheDataset);
+      });
+  const double ram_budget = ram_budget_ > 0
+                                ? ram_budget_
+                                : kRamBudgetShare * port::AvailableRam();
+  int first_deterministic = chain.size();
+  while (first_deterministic > 0 &&
+         IsDeterministic(function_library, *chain[first_deterministic - 1])) {
+    --first_deterministic;
+  }
+  double cached_share = 0;
+  for (int i = first_deterministic; i < chain.size(); ++i) {
+    cached_share += cost_share[i];
+  }
+  for (int i = first_deterministic; !has_cache && i < chain.size(); ++i) {
+    if (cached_share < kMinCostShare) break;
+    cached_share -= cost_share[i];
+    // Keep prefetching above the cache.
+    if (chain_profile[i] == nullptr || chain[i]->op() == kPrefetchDataset) {
+      continue;
+    }
+    // Only the elements of buffering transformations are measured. Those of
+    // `i` are also those of a prefetch consuming it.
+    double element_size = chain_profile[i]->element_size;
+    if (element_size <= 0 && i > 0 && chain_profile[i - 1] != nullptr &&
+        chain[i - 1]->op() == kPrefetchDataset) {
+      element_size = chain_profile[i - 1]->element_size;
+    }
+    if (element_size <= 0) continue;
+    const double cache_size = element_size * chain_profile[i]->num_elements;
+    if (cache_size > ram_budget) continue;
+    VLOG(1) << "Caching the output of " << chain[i]->name() << ", about "
+            << cache_size << " bytes";
+    NodeDef* filename =
+        graph_utils::AddScalarConstNode<StringPiece>("", &graph);
+    NodeDef* cache = AddTransformationAfter(*chain[i], kCacheDataset,
+                                            {filename->name()}, &graph);
+    TF_RETURN_IF_ERROR(graph.UpdateFanouts(chain[i]->name(), cache->name()));
+    stats->num_changes++;
+    break;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return Status::OK();
+}
+
+void ProfileGuidedRewrite::Feedback(Cluster* cluster, const GrapplerItem& item,
+                                    const GraphDef& optimize_output,
+                                    double result) {
+  // no-op
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(ProfileGuidedRewrite, "profile_guided_rewrite");
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,84 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_PROFILE_GUIDED_REWRITE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_PROFILE_GUIDED_REWRITE_H_
+
+#include "absl/strings/numbers.h"
+#include "tensorflow/core/grappler/optimizers/data/optimizer_base.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// This optimization rewrites the main chain of an input pipeline using a
+// profile of a previous run, as written by `ModelDataset` at the end of its
+// input when given a `profile_path`. Unlike the static rewrites, it only
+// changes the transformations which took a significant share of the measured
+// processing time:
+//
+// - It parallelizes the expensive stateless `map` transformations.
+// - It adds `Prefetch(AUTOTUNE)` after the other expensive synchronous
+//   transformations, so that they run concurrently with their consumers.
+// - It adds an in-memory `cache` above the expensive deterministic and finite
+//   part of the pipeline if the profile shows that its elements fit in the
+//   `ram_budget`.
+//
+// If there is no profile at `profile_path` yet, the pipeline is left as is.
+class ProfileGuidedRewrite : public TFDataOptimizerBase {
+ public:
+  ProfileGuidedRewrite() = default;
+  ~ProfileGuidedRewrite() override = default;
+
+  string name() const override { return "profile_guided_rewrite"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override {
+    if (!config) return errors::InvalidArgument("Config parameter required.");
+
+    const auto& parameters = config->parameter_map();
+    auto it = parameters.find("profile_path");
+    if (it == parameters.end()) {
+      return errors::InvalidArgument("Missing `profile_path` parameter.");
+    }
+    profile_path_ = it->second.s();
+    it = parameters.find("ram_budget");
+    if (it != parameters.end() &&
+        !absl::SimpleAtoi(it->second.s(), &ram_budget_)) {
+      return errors::InvalidArgument("Invalid `ram_budget` parameter: ",
+                                     it->second.s());
+    }
+    return Status::OK();
+  }
+
+  Status OptimizeAndCollectStats(Cluster* cluster, const GrapplerItem& item,
+                                 GraphDef* output,
+                                 OptimizationStats* stats) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimize_output, double result) override;
+
+ private:
+  string profile_path_;
+  // The memory available for caching, in bytes. If 0, half of the available
+  // RAM is used.
+  int64 ram_budget_ = 0;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_PROFILE_GUIDED_REWRITE_H_
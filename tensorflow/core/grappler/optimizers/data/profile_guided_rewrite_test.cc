@@ -0,0 +1,193 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/profile_guided_rewrite.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_test_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+// Returns an input pipeline `range.map(XTimesTwo).batch(2)`.
+GrapplerItem MakeItem() {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("start", "Const", {}, {{"value", 0}, {"dtype", DT_INT64}}),
+       NDef("stop", "Const", {}, {{"value", 10}, {"dtype", DT_INT64}}),
+       NDef("step", "Const", {}, {{"value", 1}, {"dtype", DT_INT64}}),
+       NDef("range", "RangeDataset", {"start", "stop", "step"}, {}),
+       graph_tests_utils::MakeMapNode("map", "range"),
+       NDef("batch_size", "Const", {}, {{"value", 2}, {"dtype", DT_INT64}}),
+       NDef("drop_remainder", "Const", {},
+            {{"value", false}, {"dtype", DT_BOOL}}),
+       NDef("batch", "BatchDatasetV2",
+            {"map", "batch_size", "drop_remainder"},
+            {{"output_shapes", gtl::ArraySlice<TensorShape>{}},
+             {"output_types", gtl::ArraySlice<DataType>{}}}),
+       NDef("Sink", "Identity", {"batch"}, {})},
+      // FunctionLib
+      {
+          test::function::XTimesTwo(),
+      });
+  item.fetch.push_back("Sink");
+  return item;
+}
+
+Status Optimize(const string& profile_path, int64 ram_budget,
+                const GrapplerItem& item, GraphDef* output) {
+  ProfileGuidedRewrite optimizer;
+  tensorflow::RewriterConfig_CustomGraphOptimizer config;
+  (*config.mutable_parameter_map())["profile_path"].set_s(profile_path);
+  (*config.mutable_parameter_map())["ram_budget"].set_s(
+      strings::StrCat(ram_budget));
+  TF_RETURN_IF_ERROR(optimizer.Init(&config));
+  return optimizer.Optimize(nullptr, item, output);
+}
+
+string WriteProfile(const string& name, const string& contents) {
+  const string path = io::JoinPath(testing::TmpDir(), name);
+  TF_CHECK_OK(WriteStringToFile(Env::Default(), path, contents));
+  return path;
+}
+
+TEST(ProfileGuidedRewriteTest, RequiresProfilePath) {
+  ProfileGuidedRewrite optimizer;
+  tensorflow::RewriterConfig_CustomGraphOptimizer config;
+  EXPECT_FALSE(optimizer.Init(&config).ok());
+}
+
+TEST(ProfileGuidedRewriteTest, NoProfile) {
+  GrapplerItem item = MakeItem();
+  GraphDef output;
+  TF_ASSERT_OK(Optimize(io::JoinPath(testing::TmpDir(), "missing_profile"),
+                        /*ram_budget=*/0, item, &output));
+  EXPECT_EQ(output.node_size(), item.graph.node_size());
+}
+
+TEST(ProfileGuidedRewriteTest, InvalidProfile) {
+  GrapplerItem item = MakeItem();
+  GraphDef output;
+  TF_ASSERT_OK(Optimize(WriteProfile("invalid_profile", "foo\n"),
+                        /*ram_budget=*/0, item, &output));
+  EXPECT_EQ(output.node_size(), item.graph.node_size());
+}
+
+TEST(ProfileGuidedRewriteTest, ParallelizesExpensiveMap) {
+  const string path = WriteProfile(
+      "expensive_map",
+      "Iterator::Model\t5\t10\t1\t0\n"
+      "Iterator::Model::BatchV2\t5\t10\t1\t0\n"
+      "Iterator::Model::BatchV2::Map\t10\t1000\t1\t0\n"
+      "Iterator::Model::BatchV2::Map::Range\t10\t10\t1\t0\n");
+  GrapplerItem item = MakeItem();
+  GraphDef output;
+  TF_ASSERT_OK(Optimize(path, /*ram_budget=*/0, item, &output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+  ASSERT_TRUE(graph_utils::ContainsNodeWithOp("ParallelMapDataset", output));
+  const NodeDef& parallel_map = output.node(
+      graph_utils::FindGraphNodeWithOp("ParallelMapDataset", output));
+  EXPECT_EQ(parallel_map.input(0), "range");
+  // The size of the elements of the pipeline is unknown, so it is not cached.
+  EXPECT_FALSE(graph_utils::ContainsNodeWithOp("CacheDataset", output));
+}
+
+TEST(ProfileGuidedRewriteTest, PrefetchesExpensiveBatch) {
+  const string path = WriteProfile(
+      "expensive_batch",
+      "Iterator::Model\t5\t10\t1\t0\n"
+      "Iterator::Model::BatchV2\t5\t1000\t1\t0\n"
+      "Iterator::Model::BatchV2::Map\t10\t10\t1\t0\n"
+      "Iterator::Model::BatchV2::Map::Range\t10\t10\t1\t0\n");
+  GrapplerItem item = MakeItem();
+  GraphDef output;
+  TF_ASSERT_OK(Optimize(path, /*ram_budget=*/0, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  ASSERT_TRUE(graph_utils::ContainsNodeWithOp("PrefetchDataset", output));
+  const NodeDef& prefetch = output.node(
+      graph_utils::FindGraphNodeWithOp("PrefetchDataset", output));
+  EXPECT_EQ(prefetch.input(0), "batch");
+  const NodeDef& sink =
+      output.node(graph_utils::FindGraphNodeWithName("Sink", output));
+  EXPECT_EQ(sink.input(0), prefetch.name());
+}
+
+TEST(ProfileGuidedRewriteTest, CachesExpensiveDeterministicPipeline) {
+  // The prefetch added on the previous run measured the size of the batches.
+  const string path = WriteProfile(
+      "expensive_deterministic",
+      "Iterator::Model\t5\t10\t1\t0\n"
+      "Iterator::Model::Prefetch\t5\t10\t1\t16\n"
+      "Iterator::Model::Prefetch::BatchV2\t5\t10\t1\t0\n"
+      "Iterator::Model::Prefetch::BatchV2::ParallelMapV2\t10\t1000\t4\t0\n"
+      "Iterator::Model::Prefetch::BatchV2::ParallelMapV2::Range\t10\t10\t1\t"
+      "0\n");
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("start", "Const", {}, {{"value", 0}, {"dtype", DT_INT64}}),
+       NDef("stop", "Const", {}, {{"value", 10}, {"dtype", DT_INT64}}),
+       NDef("step", "Const", {}, {{"value", 1}, {"dtype", DT_INT64}}),
+       NDef("range", "RangeDataset", {"start", "stop", "step"}, {}),
+       NDef("num_parallel_calls", "Const", {},
+            {{"value", 4}, {"dtype", DT_INT32}}),
+       graph_tests_utils::MakeParallelMapNode("map", "range",
+                                              "num_parallel_calls", "XTimesTwo",
+                                              /*sloppy=*/false),
+       NDef("batch_size", "Const", {}, {{"value", 2}, {"dtype", DT_INT64}}),
+       NDef("drop_remainder", "Const", {},
+            {{"value", false}, {"dtype", DT_BOOL}}),
+       NDef("batch", "BatchDatasetV2",
+            {"map", "batch_size", "drop_remainder"},
+            {{"output_shapes", gtl::ArraySlice<TensorShape>{}},
+             {"output_types", gtl::ArraySlice<DataType>{}}}),
+       NDef("buffer_size", "Const", {}, {{"value", -1}, {"dtype", DT_INT64}}),
+       NDef("prefetch", "PrefetchDataset", {"batch", "buffer_size"}, {}),
+       NDef("Sink", "Identity", {"prefetch"}, {})},
+      // FunctionLib
+      {
+          test::function::XTimesTwo(),
+      });
+  item.fetch.push_back("Sink");
+
+  GraphDef output;
+  TF_ASSERT_OK(Optimize(path, /*ram_budget=*/1000, item, &output));
+  ASSERT_TRUE(graph_utils::ContainsNodeWithOp("CacheDataset", output));
+  const NodeDef& cache =
+      output.node(graph_utils::FindGraphNodeWithOp("CacheDataset", output));
+  EXPECT_EQ(cache.input(0), "batch");
+  const NodeDef& prefetch =
+      output.node(graph_utils::FindGraphNodeWithName("prefetch", output));
+  EXPECT_EQ(prefetch.input(0), cache.name());
+
+  // The batches do not fit in a smaller budget.
+  output.Clear();
+  TF_ASSERT_OK(Optimize(path, /*ram_budget=*/50, item, &output));
+  EXPECT_FALSE(graph_utils::ContainsNodeWithOp("CacheDataset", output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -226,6 +226,26 @@ REGISTER_VECTORIZER("Tan", UnaryCwiseOpVectorizer);
 REGISTER_VECTORIZER("Cast", UnaryCwiseOpVectorizer);
 REGISTER_VECTORIZER("Identity", UnaryCwiseOpVectorizer);
 
+// String unary
+REGISTER_VECTORIZER("AsString", UnaryCwiseOpVectorizer);
+REGISTER_VECTORIZER("DecodeBase64", UnaryCwiseOpVectorizer);
+REGISTER_VECTORIZER("EncodeBase64", UnaryCwiseOpVectorizer);
+REGISTER_VECTORIZER("StaticRegexFullMatch", UnaryCwiseOpVectorizer);
+REGISTER_VECTORIZER("StaticRegexReplace", UnaryCwiseOpVectorizer);
+REGISTER_VECTORIZER("StringLength", UnaryCwiseOpVectorizer);
+REGISTER_VECTORIZER("StringLower", UnaryCwiseOpVectorizer);
+REGISTER_VECTORIZER("StringStrip", UnaryCwiseOpVectorizer);
+REGISTER_VECTORIZER("StringToHashBucket", UnaryCwiseOpVectorizer);
+REGISTER_VECTORIZER("StringToHashBucketFast", UnaryCwiseOpVectorizer);
+REGISTER_VECTORIZER("StringToHashBucketStrong", UnaryCwiseOpVectorizer);
+REGISTER_VECTORIZER("StringToNumber", UnaryCwiseOpVectorizer);
+REGISTER_VECTORIZER("StringUpper", UnaryCwiseOpVectorizer);
+
+// Image unary. These act on the innermost dimension, which holds the channels
+// of a pixel, so they are component-wise over the batch dimension.
+REGISTER_VECTORIZER("HSVToRGB", UnaryCwiseOpVectorizer);
+REGISTER_VECTORIZER("RGBToHSV", UnaryCwiseOpVectorizer);
+
 // Bitwise binary
 REGISTER_VECTORIZER("BitwiseAnd", BinaryCwiseOpVectorizer);
 REGISTER_VECTORIZER("BitwiseOr", BinaryCwiseOpVectorizer);
@@ -0,0 +1,85 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/framework/ops.h"
+#include "tensorflow/cc/framework/scope_internal.h"
+#include "tensorflow/cc/ops/array_ops.h"
+#include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/cc/ops/math_ops.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/grappler/optimizers/data/vectorization/vectorizer_registry.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+const char* const kReductionPrefix = "vectorized/reduction";
+
+// Vectorizer for reductions over the dimensions given by their second input,
+// e.g. the mean over the pixels of an image. The vectorized reduction is the
+// same op over the same dimensions of each element of the batch.
+class ReductionVectorizer : public Vectorizer {
+ public:
+  Status Vectorize(const Node& node, Graph* outer_scope,
+                   VectorizerInput&& inputs,
+                   VectorizerOutput* outputs) override {
+    Status status;
+    Scope parent = NewInternalScope(outer_scope, &status, nullptr);
+    Scope s = parent.NewSubScope(kReductionPrefix);
+
+    Output tensor, axes;
+    TF_RETURN_IF_ERROR(inputs.stacked(0, &tensor));
+    TF_RETURN_IF_ERROR(inputs.unstacked(1, &axes));
+
+    // Since the vectorized input has an extra leading dimension, non-negative
+    // axes are incremented by 1. Negative axes count from the end, and stay
+    // the same.
+    // axes = axes + tf.cast(axes >= 0, axes.dtype)
+    Output shifted_axes = ops::Add(
+        s, axes,
+        ops::Cast(s, ops::GreaterEqual(s, axes, ops::Cast(s, 0, axes.type())),
+                  axes.type()));
+    TF_RETURN_IF_ERROR(status);
+
+    // Add new node with the same op type and attrs as the original node
+    Node* new_node;
+    auto node_builder =
+        NodeBuilder(s.GetUniqueNameForOp(node.type_string()),
+                    node.type_string())
+            .Input(tensor.node(), tensor.index())
+            .Input(shifted_axes.node(), shifted_axes.index());
+    for (const auto& attr_slice : node.attrs()) {
+      node_builder = node_builder.Attr(attr_slice.first, attr_slice.second);
+    }
+    TF_RETURN_IF_ERROR(node_builder.Finalize(outer_scope, &new_node));
+
+    // Add output mappings
+    outputs->push_back({new_node, 0, true});
+    return Status::OK();
+  }
+};
+
+REGISTER_VECTORIZER("All", ReductionVectorizer);
+REGISTER_VECTORIZER("Any", ReductionVectorizer);
+REGISTER_VECTORIZER("Max", ReductionVectorizer);
+REGISTER_VECTORIZER("Mean", ReductionVectorizer);
+REGISTER_VECTORIZER("Min", ReductionVectorizer);
+REGISTER_VECTORIZER("Prod", ReductionVectorizer);
+REGISTER_VECTORIZER("Sum", ReductionVectorizer);
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
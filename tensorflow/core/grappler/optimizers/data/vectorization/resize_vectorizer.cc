@@ -0,0 +1,101 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/framework/ops.h"
+#include "tensorflow/cc/framework/scope_internal.h"
+#include "tensorflow/cc/ops/array_ops.h"
+#include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/grappler/optimizers/data/vectorization/vectorizer_registry.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+const char* const kResizePrefix = "vectorized/resize";
+
+// Vectorizer for the image resize ops, which take a batch of images of shape
+// [batch, height, width, channels] and the new [height, width].
+class ResizeVectorizer : public Vectorizer {
+ public:
+  Status Vectorize(const Node& node, Graph* outer_scope,
+                   VectorizerInput&& inputs,
+                   VectorizerOutput* outputs) override {
+    Status status;
+    Scope parent = NewInternalScope(outer_scope, &status, nullptr);
+    Scope s = parent.NewSubScope(kResizePrefix);
+
+    // Resizing each element to a different size produces ragged outputs and
+    // cannot be vectorized.
+    Output images, size;
+    TF_RETURN_IF_ERROR(inputs.stacked(0, &images));
+    TF_RETURN_IF_ERROR(inputs.unstacked(1, &size));
+
+    // The stacked images have shape [n, batch, height, width, channels]. They
+    // are merged into a single batch of images, resized, and split back.
+    Output const_vec_0 = ops::Const(s, {0});
+    Output const_vec_1 = ops::Const(s, {1});
+    Output const_vec_2 = ops::Const(s, {2});
+    Output shape = ops::Shape(s, images);
+
+    // images = tf.reshape(images, tf.concat([[-1], shape[2:]], 0))
+    Output image_shape =
+        ops::StridedSlice(s, shape, const_vec_2, const_vec_0, const_vec_1,
+                          ops::StridedSlice::Attrs().EndMask(1));
+    Output merged = ops::Reshape(
+        s, images,
+        ops::Concat(s, {ops::Const(s, {-1}), image_shape}, ops::Const(s, 0)));
+    TF_RETURN_IF_ERROR(status);
+
+    // Add new node with the same op type and attrs as the original node
+    Node* resized;
+    auto node_builder =
+        NodeBuilder(s.GetUniqueNameForOp(node.type_string()),
+                    node.type_string())
+            .Input(merged.node(), merged.index())
+            .Input(size.node(), size.index());
+    for (const auto& attr_slice : node.attrs()) {
+      node_builder = node_builder.Attr(attr_slice.first, attr_slice.second);
+    }
+    TF_RETURN_IF_ERROR(node_builder.Finalize(outer_scope, &resized));
+
+    // tf.reshape(resized, tf.concat([shape[:2], tf.shape(resized)[1:]], 0))
+    Output batch_dims =
+        ops::StridedSlice(s, shape, const_vec_0, const_vec_2, const_vec_1);
+    Output resized_image_shape =
+        ops::StridedSlice(s, ops::Shape(s, Output(resized, 0)), const_vec_1,
+                          const_vec_0, const_vec_1,
+                          ops::StridedSlice::Attrs().EndMask(1));
+    Output vectorized_resize = ops::Reshape(
+        s, Output(resized, 0),
+        ops::Concat(s, {batch_dims, resized_image_shape}, ops::Const(s, 0)));
+
+    TF_RETURN_IF_ERROR(status);
+
+    // Add output mappings
+    outputs->push_back({vectorized_resize.node(), 0, true});
+    return Status::OK();
+  }
+};
+
+REGISTER_VECTORIZER("ResizeArea", ResizeVectorizer);
+REGISTER_VECTORIZER("ResizeBicubic", ResizeVectorizer);
+REGISTER_VECTORIZER("ResizeBilinear", ResizeVectorizer);
+REGISTER_VECTORIZER("ResizeNearestNeighbor", ResizeVectorizer);
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
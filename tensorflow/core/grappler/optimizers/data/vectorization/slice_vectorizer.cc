@@ -0,0 +1,72 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/framework/ops.h"
+#include "tensorflow/cc/framework/scope_internal.h"
+#include "tensorflow/cc/ops/array_ops.h"
+#include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/cc/ops/math_ops.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/grappler/optimizers/data/vectorization/vectorizer_registry.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+const char* const kSlicePrefix = "vectorized/slice";
+
+class SliceVectorizer : public Vectorizer {
+ public:
+  Status Vectorize(const Node& node, Graph* outer_scope,
+                   VectorizerInput&& inputs,
+                   VectorizerOutput* outputs) override {
+    Status status;
+    Scope parent = NewInternalScope(outer_scope, &status, nullptr);
+    Scope s = parent.NewSubScope(kSlicePrefix);
+
+    // Slices with a different begin or size for each element, e.g. random
+    // crops, produce ragged outputs and cannot be vectorized.
+    Output tensor, begin, size;
+    TF_RETURN_IF_ERROR(inputs.stacked(0, &tensor));
+    TF_RETURN_IF_ERROR(inputs.unstacked(1, &begin));
+    TF_RETURN_IF_ERROR(inputs.unstacked(2, &size));
+
+    // The vectorized slice takes all of the leading dimension.
+    // begin = tf.concat([[0], begin], 0)
+    // size = tf.concat([[-1], size], 0)
+    Output begin_prefix = ops::Cast(s, ops::Const(s, {0}), begin.type());
+    Output size_prefix = ops::Cast(s, ops::Const(s, {-1}), size.type());
+    Output vectorized_begin =
+        ops::Concat(s, {begin_prefix, begin}, ops::Const(s, 0));
+    Output vectorized_size =
+        ops::Concat(s, {size_prefix, size}, ops::Const(s, 0));
+
+    Output vectorized_slice =
+        ops::Slice(s, tensor, vectorized_begin, vectorized_size);
+
+    TF_RETURN_IF_ERROR(status);
+
+    // Add output mappings
+    outputs->push_back({vectorized_slice.node(), 0, true});
+    return Status::OK();
+  }
+};
+
+REGISTER_VECTORIZER("Slice", SliceVectorizer);
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
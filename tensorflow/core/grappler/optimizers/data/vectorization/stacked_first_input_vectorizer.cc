@@ -0,0 +1,68 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/grappler/optimizers/data/vectorization/vectorizer_registry.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Vectorizer for ops which apply the same transformation, given by their other
+// inputs, to each element of their first input, e.g. `AdjustHue`. Like for the
+// component-wise ops, the vectorized op is the same as the original, as long as
+// only the first input is stacked.
+class StackedFirstInputVectorizer : public Vectorizer {
+ public:
+  Status Vectorize(const Node& node, Graph* outer_scope,
+                   VectorizerInput&& inputs,
+                   VectorizerOutput* outputs) override {
+    NodeBuilder::NodeOut value;
+    TF_RETURN_IF_ERROR(inputs.stacked(0, &value));
+
+    // Add new node with the same op type and attrs as the original node
+    Node* new_node;
+    auto node_builder = NodeBuilder(strings::StrCat("vectorized/", node.name()),
+                                    node.type_string())
+                            .Input(value);
+    for (size_t i = 1; i < inputs.size(); ++i) {
+      NodeBuilder::NodeOut input;
+      TF_RETURN_IF_ERROR(inputs.unstacked(i, &input));
+      node_builder = node_builder.Input(input);
+    }
+    for (const auto& attr_slice : node.attrs()) {
+      node_builder = node_builder.Attr(attr_slice.first, attr_slice.second);
+    }
+    TF_RETURN_IF_ERROR(node_builder.Finalize(outer_scope, &new_node));
+
+    // Add output mappings
+    outputs->push_back({new_node, 0, true});
+    return Status::OK();
+  }
+};
+
+// Image ops. AdjustContrastv2 acts on the innermost 3 dimensions, i.e. each
+// image, and the others on the innermost dimension, i.e. each pixel.
+REGISTER_VECTORIZER("AdjustContrastv2", StackedFirstInputVectorizer);
+REGISTER_VECTORIZER("AdjustHue", StackedFirstInputVectorizer);
+REGISTER_VECTORIZER("AdjustSaturation", StackedFirstInputVectorizer);
+
+// String ops
+REGISTER_VECTORIZER("RegexFullMatch", StackedFirstInputVectorizer);
+REGISTER_VECTORIZER("RegexReplace", StackedFirstInputVectorizer);
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
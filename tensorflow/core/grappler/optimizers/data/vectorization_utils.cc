@@ -139,9 +139,11 @@ class Vectorization {
   // Adds the vectorized function and new map_defun_fn to lib, and points
   // vectorized_function to the former. Returns an error status if
   // the conversion between FunctionDef -> Graph -> FunctionDef failed anywhere
-  // along the way.
+  // along the way. Sets `unvectorized_ops`, if not null, to the types of the
+  // ops which could not be converted.
   Status Vectorize(const FunctionDef& outer_scope,
-                   const NodeDef& map_defun_node, FunctionDef** result);
+                   const NodeDef& map_defun_node, FunctionDef** result,
+                   std::vector<string>* unvectorized_ops);
 
  private:
   // Converts FunctionDefs to Graphs and adds mappings from
@@ -209,6 +211,8 @@ class Vectorization {
 
   // Unconvertible ret nodes
   std::set<Node*> unconvertible_;
+  // Types of the ops producing the unconvertible ret nodes
+  std::set<string> unconvertible_ops_;
 
   FunctionDefLibrary* lib_;  // Not owned
   FunctionLibraryDefinition lib_def_;
@@ -331,9 +335,14 @@ Status Vectorization::ConvertOutput(int output_position) {
 
 Status Vectorization::Vectorize(const FunctionDef& outer_scope,
                                 const NodeDef& map_defun_node,
-                                FunctionDef** result) {
+                                FunctionDef** result,
+                                std::vector<string>* unvectorized_ops) {
   TF_RETURN_IF_ERROR(Initialize(outer_scope, map_defun_node));
   VectorizeHelper();
+  if (unvectorized_ops != nullptr) {
+    unvectorized_ops->assign(unconvertible_ops_.begin(),
+                             unconvertible_ops_.end());
+  }
   return GetResult(result);
 }
 
@@ -354,6 +363,12 @@ void Vectorization::VectorizeHelper() {
       VLOG(2) << "Could not convert the output at node: "
               << output_node->DebugString() << "\nError: " << s;
       unconvertible_.insert(output_node);
+      // The op producing the output is the one that failed to convert; its
+      // inputs were promoted to outputs and are converted separately.
+      const Edge* ret_edge;
+      if (output_node->input_edge(0, &ret_edge).ok()) {
+        unconvertible_ops_.insert(ret_edge->src()->type_string());
+      }
     }
   }
 
@@ -635,9 +650,11 @@ Status Vectorization::GetResult(FunctionDef** vectorized_function) {
 
 Status VectorizeMapDefun(const FunctionDef& outer_scope,
                          const NodeDef& map_defun_node, FunctionDefLibrary* lib,
-                         FunctionDef** result) {
+                         FunctionDef** result,
+                         std::vector<string>* unvectorized_ops) {
   *result = nullptr;
-  return Vectorization(lib).Vectorize(outer_scope, map_defun_node, result);
+  return Vectorization(lib).Vectorize(outer_scope, map_defun_node, result,
+                                      unvectorized_ops);
 }
 
 }  // namespace vectorization_utils
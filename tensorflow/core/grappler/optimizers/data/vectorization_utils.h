@@ -16,9 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_VECTORIZATION_UTILS_H_
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_VECTORIZATION_UTILS_H_
 
+#include <vector>
+
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -38,6 +41,10 @@ namespace vectorization_utils {
 // function is added to `lib`. The newly vectorized function `result` is also
 // added to `lib`.
 //
+// If `unvectorized_ops` is not null, it is set to the sorted types of the ops
+// which could not be lifted and so remain in the MapDefun function. These are
+// the ops which need a vectorizer for the vectorization to be complete.
+//
 // Returns Status::OK() if the vectorization is completely or partially
 // successful. Otherwise, returns an error, and sets `result` to nullptr.
 //
@@ -88,7 +95,8 @@ namespace vectorization_utils {
 //
 Status VectorizeMapDefun(const FunctionDef& outer_scope,
                          const NodeDef& map_defun_node, FunctionDefLibrary* lib,
-                         FunctionDef** result);
+                         FunctionDef** result,
+                         std::vector<string>* unvectorized_ops = nullptr);
 
 }  // namespace vectorization_utils
 }  // namespace grappler
@@ -94,7 +94,8 @@ Status WrapFunctionWithMapDefun(const FunctionDef& inner, FunctionDef* result) {
 // Wraps the function `fn` in another function with a MapDefun node, then
 // vectorizes the wrapper function with VectorizeMapDefun.
 Status WrapAndVectorize(const FunctionDef& fn, FunctionDefLibrary* lib,
-                        FunctionDef** result) {
+                        FunctionDef** result,
+                        std::vector<string>* unvectorized_ops = nullptr) {
   FunctionDef outer;
   TF_RETURN_IF_ERROR(WrapFunctionWithMapDefun(fn, &outer));
   const NodeDef& map_defun_node = outer.node_def(0);
@@ -102,7 +103,8 @@ Status WrapAndVectorize(const FunctionDef& fn, FunctionDefLibrary* lib,
   *lib->add_function() = outer;
   *lib->add_function() = fn;
 
-  TF_RETURN_IF_ERROR(VectorizeMapDefun(outer, map_defun_node, lib, result));
+  TF_RETURN_IF_ERROR(VectorizeMapDefun(outer, map_defun_node, lib, result,
+                                       unvectorized_ops));
 
   return Status::OK();
 }
@@ -245,13 +247,17 @@ TEST(VectorizeMapDefunTest, VectorizeWithUnvectorizableOp) {
 
   FunctionDefLibrary lib;
   FunctionDef* vectorized;
-  TF_ASSERT_OK(WrapAndVectorize(inner, &lib, &vectorized));
+  std::vector<string> unvectorized_ops;
+  TF_ASSERT_OK(WrapAndVectorize(inner, &lib, &vectorized, &unvectorized_ops));
 
   ASSERT_TRUE(
       function_utils::ContainsFunctionNodeWithOp("MapDefun", *vectorized));
   auto map_defun_node = vectorized->node_def(
       function_utils::FindFunctionNodeWithOp("MapDefun", *vectorized));
 
+  // The MatMul node blocks the full vectorization.
+  EXPECT_EQ(unvectorized_ops, std::vector<string>({"MatMul"}));
+
   // The Cast node should be converted just fine.
   ASSERT_TRUE(function_utils::ContainsFunctionNodeWithOp("Cast", *vectorized));
   auto cast = vectorized->node_def(
@@ -965,6 +971,18 @@ INSTANTIATE_TEST_CASE_P(
                       "Rsqrt", "Selu", "Sigmoid", "Sign", "Sin", "Sinh",
                       "Softplus", "Softsign", "Sqrt", "Square", "Tanh", "Tan"));
 
+class StringUnaryTest : public ::testing::TestWithParam<const char*> {};
+
+TEST_P(StringUnaryTest, VectorizeCwiseStringUnary) {
+  TF_EXPECT_OK(CwiseTestHelper(DT_STRING, GetParam(), 1));
+}
+
+INSTANTIATE_TEST_CASE_P(Test, StringUnaryTest,
+                        ::testing::Values("DecodeBase64", "EncodeBase64",
+                                          "StringLength", "StringLower",
+                                          "StringStrip", "StringToNumber",
+                                          "StringUpper"));
+
 class BitwiseBinaryTest : public ::testing::TestWithParam<const char*> {};
 
 TEST_P(BitwiseBinaryTest, VectorizeCwiseBitwiseBinary) {
@@ -1353,6 +1371,71 @@ TEST(VectorizerTest, VectorizeTranspose) {
       function_utils::ContainsFunctionNodeWithOp("MapDefun", *vectorized));
 }
 
+TEST(VectorizerTest, VectorizeReverseV2) {
+  FunctionDef inner = FunctionDefHelper::Create(
+      /*function_name=*/"inner_function",
+      /*in_def=*/{"arg0: int32"},
+      /*out_def=*/{"out: int32"},
+      /*attr_def=*/{},
+      /*node_def=*/
+      {FunctionDefHelper::Const("Axis", gtl::ArraySlice<int>({-1})),
+       {{"ReverseV2"},
+        "ReverseV2",
+        {"arg0", "Axis:output:0"},
+        {{"T", DT_INT32}, {"Tidx", DT_INT32}}}},
+      /*ret_def=*/{{"out", "ReverseV2:output:0"}});
+
+  FunctionDefLibrary lib;
+  FunctionDef* vectorized;
+  TF_ASSERT_OK(WrapAndVectorize(inner, &lib, &vectorized));
+  EXPECT_FALSE(
+      function_utils::ContainsFunctionNodeWithOp("MapDefun", *vectorized));
+}
+
+TEST(VectorizerTest, VectorizeMean) {
+  FunctionDef inner = FunctionDefHelper::Create(
+      /*function_name=*/"inner_function",
+      /*in_def=*/{"arg0: float"},
+      /*out_def=*/{"out: float"},
+      /*attr_def=*/{},
+      /*node_def=*/
+      {FunctionDefHelper::Const("Axes", gtl::ArraySlice<int>({0, 1})),
+       {{"Mean"},
+        "Mean",
+        {"arg0", "Axes:output:0"},
+        {{"T", DT_FLOAT}, {"Tidx", DT_INT32}, {"keep_dims", true}}}},
+      /*ret_def=*/{{"out", "Mean:output:0"}});
+
+  FunctionDefLibrary lib;
+  FunctionDef* vectorized;
+  TF_ASSERT_OK(WrapAndVectorize(inner, &lib, &vectorized));
+  EXPECT_FALSE(
+      function_utils::ContainsFunctionNodeWithOp("MapDefun", *vectorized));
+}
+
+TEST(VectorizerTest, VectorizeSqueezeWithoutDims) {
+  FunctionDef inner = FunctionDefHelper::Create(
+      /*function_name=*/"inner_function",
+      /*in_def=*/{"arg0: int32"},
+      /*out_def=*/{"out: int32"},
+      /*attr_def=*/{},
+      /*node_def=*/
+      {{{"Squeeze"},
+        "Squeeze",
+        {"arg0"},
+        {{"T", DT_INT32}, {"squeeze_dims", gtl::ArraySlice<int>({})}}}},
+      /*ret_def=*/{{"out", "Squeeze:output:0"}});
+
+  FunctionDefLibrary lib;
+  FunctionDef* vectorized;
+  std::vector<string> unvectorized_ops;
+  TF_ASSERT_OK(WrapAndVectorize(inner, &lib, &vectorized, &unvectorized_ops));
+  // Squeezing all the dimensions of size 1 may squeeze the batch dimension.
+  EXPECT_TRUE(
+      function_utils::ContainsFunctionNodeWithOp("MapDefun", *vectorized));
+  EXPECT_EQ(unvectorized_ops, std::vector<string>({"Squeeze"}));
+}
+
 TEST(VectorizerTest, VectorizeIdentity) {
   FunctionDef inner = FunctionDefHelper::Create(
       /*function_name=*/"inner_function",
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer_transposer.h"
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer_transposer_factory.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/port.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -402,10 +403,10 @@ Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
   }
   const auto num_gpus_and_num_volta = GetNumGPUs(*cluster);
   const int num_gpus = num_gpus_and_num_volta.first;
-  if (num_gpus < 1) {
+  if (num_gpus < 1 && !IsMklEnabled()) {
     return errors::Aborted(
         "No GPUs found: GenericLayoutOptimizer is currently only tuned for "
-        "GPU.");
+        "GPU, and for CPU with MKL.");
   }
 
   const bool is_aggressive = opt_level_ == RewriterConfig::AGGRESSIVE;
@@ -414,10 +415,18 @@ Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
   TF_RETURN_IF_ERROR(
       TransposeContext::InitializeTransposeContext(item, cluster, &context));
 
-  const auto src_dst_formats =
-      GetSrcAndDstDataFormats(context, num_gpus, num_gpus_and_num_volta.second);
-  context.AssignDeviceAndDataFormats(kGPU, src_dst_formats.first,
-                                     src_dst_formats.second);
+  if (num_gpus > 0) {
+    const auto src_dst_formats = GetSrcAndDstDataFormats(
+        context, num_gpus, num_gpus_and_num_volta.second);
+    context.AssignDeviceAndDataFormats(kGPU, src_dst_formats.first,
+                                       src_dst_formats.second);
+  } else {
+    // MKL kernels compute in blocked layouts derived from NCHW (e.g.
+    // NCHW16c). The MKL layout pass keeps tensors in the blocked layout
+    // between consecutive MKL ops, so converting chains of ops to NCHW here
+    // leaves only the reorders at the boundaries of these chains.
+    context.AssignDeviceAndDataFormats(kCPU, kNHWC, kNCHW);
+  }
 
   TransposerFactory transposer_factory;
   TF_RETURN_IF_ERROR(ExpandLayoutSensitiveOp(&context, &transposer_factory));
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/port.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -311,6 +312,63 @@ TEST_F(GenericLayoutOptimizerTest, CPUDevice) {
   VerifyDataFormatAttributeMatch(conv_node, "NHWC");
 }
 
+TEST_F(GenericLayoutOptimizerTest, CPUOnlyClusterWithMkl) {
+  DeviceProperties cpu_device;
+  cpu_device.set_type("CPU");
+  cpu_device.set_frequency(1000);
+  cpu_device.set_num_cores(4);
+  VirtualCluster cpu_cluster({{"/CPU:0", cpu_device}});
+  TF_ASSERT_OK(cpu_cluster.Provision());
+
+  Scope scope = Scope::NewRootScope();
+  auto conv2d = SimpleConv2D(&scope, 4, 2, "VALID", "/CPU:0");
+  auto relu = ops::Relu(scope.WithOpName("Relu").WithDevice("/CPU:0"), conv2d);
+  auto max_pool =
+      ops::MaxPool(scope.WithOpName("MaxPool").WithDevice("/CPU:0"), relu,
+                   {1, 2, 2, 1}, {1, 1, 1, 1}, "VALID");
+  auto depth_to_space = ops::DepthToSpace(
+      scope.WithOpName("DepthToSpace").WithDevice("/CPU:0"), max_pool, 2);
+  auto identity = Identity(scope.WithOpName("Output"), depth_to_space);
+  GrapplerItem item;
+  TF_ASSERT_OK(scope.ToGraphDef(&item.graph));
+
+  GenericLayoutOptimizer optimizer;
+  GraphDef output;
+  Status status = optimizer.Optimize(&cpu_cluster, item, &output);
+  if (!IsMklEnabled()) {
+    EXPECT_EQ(error::ABORTED, status.code());
+    return;
+  }
+  TF_ASSERT_OK(status);
+
+  utils::GraphView graph_view(&output, &status);
+  TF_ASSERT_OK(status);
+  // Conv2D -> Relu -> MaxPool runs in NCHW, with a single transpose on each
+  // side of the chain. DepthToSpace has no NCHW kernel on CPU.
+  auto* conv2d_node = graph_view.GetNode("Conv2D");
+  ASSERT_NE(conv2d_node, nullptr);
+  VerifyDataFormatAttributeMatch(conv2d_node, "NCHW");
+  VerifyRegularFaninMatch(conv2d_node, 0,
+                          "Conv2D-0-TransposeNHWCToNCHW-LayoutOptimizer", 0);
+
+  auto* relu_node = graph_view.GetNode("Relu");
+  ASSERT_NE(relu_node, nullptr);
+  VerifyRegularFaninMatch(relu_node, 0, "Conv2D", 0);
+
+  auto* max_pool_node = graph_view.GetNode("MaxPool");
+  ASSERT_NE(max_pool_node, nullptr);
+  VerifyDataFormatAttributeMatch(max_pool_node, "NCHW");
+  VerifyRegularFaninMatch(max_pool_node, 0, "Relu", 0);
+
+  auto* depth_to_space_node = graph_view.GetNode("DepthToSpace");
+  ASSERT_NE(depth_to_space_node, nullptr);
+  VerifyDataFormatAttributeMatch(depth_to_space_node, "NHWC");
+  VerifyRegularFaninMatch(depth_to_space_node, 0,
+                          "MaxPool-0-0-TransposeNCHWToNHWC-LayoutOptimizer", 0);
+
+  TF_ASSERT_OK(cpu_cluster.Shutdown());
+}
+
 TEST_F(GenericLayoutOptimizerTest, Connectivity) {
 #if !GOOGLE_CUDA
   GTEST_SKIP() << "CUDA is not enabled";
@@ -213,7 +213,11 @@ bool Transposer::ShouldProcess(const TransposeContext& context,
   // Only checks data format for layout sensitive op.
   bool data_format_match = !IsLayoutSensitiveOp(*node_def) ||
                            AttrDataFormatMatch(node, context.src_format);
-  return is_on_target_device && data_format_match &&
+  // Many layout sensitive ops have no CPU kernel for the NCHW data format.
+  bool is_supported_on_device = context.target_device != kCPU ||
+                                !IsLayoutSensitiveOp(*node_def) ||
+                                IsLayoutSensitiveOpSupportedOnCPU(*node_def);
+  return is_on_target_device && data_format_match && is_supported_on_device &&
          !context.nodes_to_preserve.contains(node_def->name()) &&
          !(node.NumRegularFanouts() == 0 && node.NumControlledFanouts() == 0);
 }
@@ -1668,6 +1672,17 @@ bool IsLayoutSensitiveOp(const NodeDef& node) {
          IsMaxPoolGradGradV1(node) || IsMaxPoolGradGradV2(node);
 }
 
+bool IsLayoutSensitiveOpSupportedOnCPU(const NodeDef& node) {
+  static const std::set<string>* cpu_nchw_ops =
+      new std::set<string>({"AvgPool", "AvgPoolGrad", "BiasAdd", "BiasAddGrad",
+                            "Conv2D", "Conv2DBackpropFilter",
+                            "Conv2DBackpropInput", "FusedBatchNorm",
+                            "FusedBatchNormV2", "FusedBatchNormV3",
+                            "FusedBatchNormGrad", "FusedBatchNormGradV2",
+                            "FusedBatchNormGradV3", "MaxPool", "MaxPoolGrad"});
+  return cpu_nchw_ops->find(node.op()) != cpu_nchw_ops->end();
+}
+
 bool IsDefaultLayoutAgnosticOp(const NodeDef& node) {
   std::set<string> agnostic_nodes = {"Abs",          "Acos",
                                      "Acosh",        "Angle",
@@ -41,6 +41,7 @@ constexpr char kAttrSrcFormat[] = "src_format";
 constexpr char kAttrDstFormat[] = "dst_format";
 constexpr char kAttrOutputShape[] = "_output_shapes";
 constexpr char kGPU[] = "GPU";
+constexpr char kCPU[] = "CPU";
 
 // TransposeContext owns all data members. Must initialize GraphProperties,
 // FrameView, GraphDef and MutableGraphView with the same graph. NodeDef
@@ -571,6 +572,10 @@ bool IsDefaultLayoutSensitiveOp(const NodeDef& node);
 
 bool IsLayoutSensitiveOp(const NodeDef& node);
 
+// Returns true iff the CPU (MKL) kernels of the layout sensitive op `node`
+// support the NCHW data format.
+bool IsLayoutSensitiveOpSupportedOnCPU(const NodeDef& node);
+
 bool IsDefaultLayoutAgnosticOp(const NodeDef& node);
 
 bool IsLayoutAgnosticOp(const NodeDef& node);
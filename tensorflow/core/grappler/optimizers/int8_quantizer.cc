@@ -0,0 +1,339 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/int8_quantizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kCalibratedTensors[] = "calibrated_tensors";
+constexpr char kCalibratedMin[] = "calibrated_min";
+constexpr char kCalibratedMax[] = "calibrated_max";
+
+using NodesByName = absl::flat_hash_map<string, const NodeDef*>;
+
+// Returns "node" for "node:0", so that both name the same tensor.
+string CanonicalTensorName(const string& name) {
+  const TensorId id = ParseTensorName(name);
+  return id.index() == 0 ? string(id.node()) : id.ToString();
+}
+
+bool IsOnCpu(const NodeDef& node) {
+  DeviceNameUtils::ParsedName parsed;
+  return DeviceNameUtils::ParseFullName(node.device(), &parsed) &&
+         (!parsed.has_type || parsed.type == DEVICE_CPU);
+}
+
+bool HasFloatType(const NodeDef& node) {
+  const auto it = node.attr().find("T");
+  return it != node.attr().end() && it->second.type() == DT_FLOAT;
+}
+
+// Returns whether the Conv2D `node` is supported by _QuantizedConv2DPerChannel.
+bool IsSupportedConv2D(const NodeDef& node) {
+  const auto& attrs = node.attr();
+  const auto data_format = attrs.find("data_format");
+  if (data_format != attrs.end() && data_format->second.s() != "NHWC") {
+    return false;
+  }
+  const auto padding = attrs.find("padding");
+  if (padding == attrs.end() ||
+      (padding->second.s() != "SAME" && padding->second.s() != "VALID")) {
+    return false;
+  }
+  const auto strides = attrs.find("strides");
+  if (strides == attrs.end() || strides->second.list().i_size() != 4 ||
+      strides->second.list().i(0) != 1 || strides->second.list().i(3) != 1) {
+    return false;
+  }
+  const auto dilations = attrs.find("dilations");
+  if (dilations != attrs.end()) {
+    for (int64 dilation : dilations->second.list().i()) {
+      if (dilation != 1) return false;
+    }
+  }
+  return true;
+}
+
+// Returns the constant float weights of `node` if the int8 quantizer can
+// rewrite it, and nullptr otherwise.
+const NodeDef* QuantizableWeights(const NodeDef& node,
+                                  const NodesByName& nodes) {
+  const bool is_matmul = IsMatMul(node);
+  if (!(is_matmul || (IsConv2D(node) && IsSupportedConv2D(node))) ||
+      !HasFloatType(node) || !IsOnCpu(node) || node.input_size() < 2 ||
+      IsControlInput(node.input(1))) {
+    return nullptr;
+  }
+  const TensorId weights_id = ParseTensorName(node.input(1));
+  const auto weights = nodes.find(string(weights_id.node()));
+  if (weights_id.index() != 0 || weights == nodes.end() ||
+      !IsConstant(*weights->second)) {
+    return nullptr;
+  }
+  const auto value = weights->second->attr().find("value");
+  if (value == weights->second->attr().end() ||
+      value->second.tensor().dtype() != DT_FLOAT ||
+      value->second.tensor().tensor_shape().dim_size() != (is_matmul ? 2 : 4)) {
+    return nullptr;
+  }
+  return weights->second;
+}
+
+NodesByName GetNodesByName(const GraphDef& graph) {
+  NodesByName nodes;
+  for (const NodeDef& node : graph.node()) {
+    nodes[node.name()] = &node;
+  }
+  return nodes;
+}
+
+// Quantizes the float `weights` symmetrically to int8 in [-127, 127], with a
+// scale per index of the dimension `channel_dim`.
+void QuantizeWeights(const Tensor& weights, int channel_dim, Tensor* quantized,
+                     Tensor* scales) {
+  const int64 num_channels = weights.dim_size(channel_dim);
+  int64 inner_size = 1;
+  for (int i = channel_dim + 1; i < weights.dims(); ++i) {
+    inner_size *= weights.dim_size(i);
+  }
+  const int64 outer_size =
+      num_channels * inner_size == 0
+          ? 0
+          : weights.NumElements() / (num_channels * inner_size);
+  auto values = weights.flat<float>();
+  auto index = [&](int64 outer, int64 channel, int64 inner) {
+    return (outer * num_channels + channel) * inner_size + inner;
+  };
+
+  *quantized = Tensor(DT_QINT8, weights.shape());
+  *scales = Tensor(DT_FLOAT, TensorShape({num_channels}));
+  auto quantized_values = quantized->flat<qint8>();
+  auto scale_values = scales->flat<float>();
+  for (int64 channel = 0; channel < num_channels; ++channel) {
+    float max_abs = 0;
+    for (int64 outer = 0; outer < outer_size; ++outer) {
+      for (int64 inner = 0; inner < inner_size; ++inner) {
+        max_abs = std::max(max_abs,
+                           std::fabs(values(index(outer, channel, inner))));
+      }
+    }
+    const float scale = max_abs > 0 ? max_abs / 127.0f : 1.0f;
+    scale_values(channel) = scale;
+    for (int64 outer = 0; outer < outer_size; ++outer) {
+      for (int64 inner = 0; inner < inner_size; ++inner) {
+        const int64 i = index(outer, channel, inner);
+        const float q = std::round(values(i) / scale);
+        quantized_values(i) =
+            static_cast<int8>(std::min(127.0f, std::max(-127.0f, q)));
+      }
+    }
+  }
+}
+
+NodeDef* AddConstNode(const string& name, const string& device,
+                      const Tensor& value, GraphDef* graph) {
+  NodeDef* node = graph->add_node();
+  node->set_name(name);
+  node->set_op("Const");
+  node->set_device(device);
+  (*node->mutable_attr())["dtype"].set_type(value.dtype());
+  value.AsProtoTensorContent((*node->mutable_attr())["value"].mutable_tensor());
+  return node;
+}
+
+}  // namespace
+
+Status Int8Quantizer::Init(
+    const tensorflow::RewriterConfig_CustomGraphOptimizer* config) {
+  ranges_.clear();
+  if (config == nullptr) return Status::OK();
+  const auto& parameters = config->parameter_map();
+  const auto tensors = parameters.find(kCalibratedTensors);
+  if (tensors == parameters.end()) return Status::OK();
+  const auto mins = parameters.find(kCalibratedMin);
+  const auto maxs = parameters.find(kCalibratedMax);
+  if (mins == parameters.end() || maxs == parameters.end()) {
+    return errors::InvalidArgument(kCalibratedMin, " and ", kCalibratedMax,
+                                   " must be given with ", kCalibratedTensors);
+  }
+  const int num_tensors = tensors->second.list().s_size();
+  if (mins->second.list().f_size() != num_tensors ||
+      maxs->second.list().f_size() != num_tensors) {
+    return errors::InvalidArgument(kCalibratedTensors, ", ", kCalibratedMin,
+                                   " and ", kCalibratedMax,
+                                   " must have the same size");
+  }
+  for (int i = 0; i < num_tensors; ++i) {
+    const float min = mins->second.list().f(i);
+    const float max = maxs->second.list().f(i);
+    if (!(min <= max)) {
+      return errors::InvalidArgument("Invalid range of ",
+                                     tensors->second.list().s(i), ": [", min,
+                                     ", ", max, "]");
+    }
+    ranges_[CanonicalTensorName(tensors->second.list().s(i))] = {min, max};
+  }
+  return Status::OK();
+}
+
+Status Int8Quantizer::Optimize(Cluster* cluster, const GrapplerItem& item,
+                               GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  if (ranges_.empty()) return Status::OK();
+  const NodesByName nodes = GetNodesByName(item.graph);
+  std::set<string> replaced_weights;
+
+  const int num_nodes = optimized_graph->node_size();
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef* weights_node =
+        QuantizableWeights(optimized_graph->node(i), nodes);
+    if (weights_node == nullptr) continue;
+    const auto range =
+        ranges_.find(CanonicalTensorName(optimized_graph->node(i).input(0)));
+    if (range == ranges_.end()) continue;
+    const string weights_name =
+        absl::StrCat(optimized_graph->node(i).name(), "/int8_weights");
+    const string scales_name =
+        absl::StrCat(optimized_graph->node(i).name(), "/int8_scales");
+    if (nodes.count(weights_name) || nodes.count(scales_name)) continue;
+
+    Tensor weights;
+    if (!weights.FromProto(weights_node->attr().at("value").tensor())) {
+      return errors::InvalidArgument("Invalid weights in ",
+                                     weights_node->name());
+    }
+    NodeDef* node = optimized_graph->mutable_node(i);
+    const bool is_matmul = IsMatMul(*node);
+    // The output channels are the columns of the MatMul weights, or their rows
+    // if they are transposed, and the last dimension of the Conv2D filter.
+    int channel_dim = 3;
+    if (is_matmul) {
+      const auto transpose_b = node->attr().find("transpose_b");
+      channel_dim =
+          transpose_b != node->attr().end() && transpose_b->second.b() ? 0 : 1;
+    }
+    Tensor quantized_weights;
+    Tensor scales;
+    QuantizeWeights(weights, channel_dim, &quantized_weights, &scales);
+    AddConstNode(weights_name, node->device(), quantized_weights,
+                 optimized_graph);
+    AddConstNode(scales_name, node->device(), scales, optimized_graph);
+    // add_node may have moved the nodes.
+    node = optimized_graph->mutable_node(i);
+
+    VLOG(2) << "Quantizing " << node->op() << " node " << node->name()
+            << " to int8";
+    replaced_weights.insert(weights_node->name());
+    node->set_input(1, weights_name);
+    node->add_input(scales_name);
+    // Moves the scales before the control inputs, if any.
+    for (int j = node->input_size() - 1; j > 2; --j) {
+      node->mutable_input()->SwapElements(j, j - 1);
+    }
+    auto* attrs = node->mutable_attr();
+    attrs->erase("T");
+    if (is_matmul) {
+      node->set_op("_QuantizedMatMulPerChannel");
+      (*attrs)["min_a"].set_f(range->second.first);
+      (*attrs)["max_a"].set_f(range->second.second);
+    } else {
+      node->set_op("_QuantizedConv2DPerChannel");
+      attrs->erase("data_format");
+      attrs->erase("explicit_paddings");
+      attrs->erase("use_cudnn_on_gpu");
+      (*attrs)["min_input"].set_f(range->second.first);
+      (*attrs)["max_input"].set_f(range->second.second);
+    }
+  }
+
+  // Removes the float weights that are no longer used.
+  for (const NodeDef& node : optimized_graph->node()) {
+    for (const string& input : node.input()) {
+      replaced_weights.erase(NodeName(input));
+    }
+  }
+  for (const string& name : item.NodesToPreserve()) {
+    replaced_weights.erase(name);
+  }
+  EraseNodesFromGraph(replaced_weights, optimized_graph);
+  return Status::OK();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(Int8Quantizer, "int8_quantizer");
+
+std::vector<string> Int8CalibrationTensors(const GraphDef& graph) {
+  const NodesByName nodes = GetNodesByName(graph);
+  std::set<string> tensors;
+  for (const NodeDef& node : graph.node()) {
+    if (QuantizableWeights(node, nodes) != nullptr) {
+      tensors.insert(CanonicalTensorName(node.input(0)));
+    }
+  }
+  return std::vector<string>(tensors.begin(), tensors.end());
+}
+
+void Int8CalibrationRanges::Update(const string& tensor, const Tensor& value) {
+  if (value.NumElements() == 0) return;
+  auto values = value.flat<float>();
+  const auto min_max = std::minmax_element(values.data(),
+                                           values.data() + values.size());
+  const string name = CanonicalTensorName(tensor);
+  auto it = ranges_.find(name);
+  if (it == ranges_.end()) {
+    ranges_[name] = {*min_max.first, *min_max.second};
+  } else {
+    it->second.first = std::min(it->second.first, *min_max.first);
+    it->second.second = std::max(it->second.second, *min_max.second);
+  }
+}
+
+void Int8CalibrationRanges::ToConfig(
+    RewriterConfig::CustomGraphOptimizer* config) const {
+  config->set_name("int8_quantizer");
+  auto* parameters = config->mutable_parameter_map();
+  auto* tensors = (*parameters)[kCalibratedTensors].mutable_list();
+  auto* mins = (*parameters)[kCalibratedMin].mutable_list();
+  auto* maxs = (*parameters)[kCalibratedMax].mutable_list();
+  tensors->Clear();
+  mins->Clear();
+  maxs->Clear();
+  for (const auto& range : ranges_) {
+    tensors->add_s(range.first);
+    mins->add_f(range.second.first);
+    maxs->add_f(range.second.second);
+  }
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
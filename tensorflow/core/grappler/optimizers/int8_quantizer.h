@@ -0,0 +1,101 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_INT8_QUANTIZER_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_INT8_QUANTIZER_H_
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Rewrites the float MatMul and Conv2D nodes on CPU with constant weights to
+// per-channel int8 kernels (_QuantizedMatMulPerChannel and
+// _QuantizedConv2DPerChannel), which quantize their activations on the fly with
+// ranges recorded by calibration. Nodes whose activations were not calibrated
+// are left as they are.
+//
+// The optimizer is registered as the custom optimizer "int8_quantizer", and
+// takes the calibrated ranges as three parallel lists in its parameter map:
+// "calibrated_tensors" (e.g. "dense/MatMul" or "split:1"), "calibrated_min"
+// and "calibrated_max". Int8CalibrationRanges fills them in.
+//
+// Example usage:
+//
+//   Int8CalibrationRanges ranges;
+//   const std::vector<string> tensors = Int8CalibrationTensors(graph_def);
+//   for (const auto& feeds : calibration_data) {
+//     std::vector<Tensor> outputs;
+//     TF_RETURN_IF_ERROR(session->Run(feeds, tensors, {}, &outputs));
+//     for (int i = 0; i < tensors.size(); ++i) {
+//       ranges.Update(tensors[i], outputs[i]);
+//     }
+//   }
+//   ranges.ToConfig(rewriter_config.add_custom_optimizers());
+class Int8Quantizer : public CustomGraphOptimizer {
+ public:
+  Int8Quantizer() = default;
+  ~Int8Quantizer() override = default;
+
+  string name() const override { return "int8_quantizer"; }
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override;
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override {}
+
+ private:
+  // The calibrated [min, max] of the activations, by tensor name.
+  std::map<string, std::pair<float, float>> ranges_;
+};
+
+// Returns the tensors to calibrate for the int8 quantizer, the activations of
+// the nodes of `graph` that it can rewrite.
+std::vector<string> Int8CalibrationTensors(const GraphDef& graph);
+
+// The ranges of the values of tensors over calibration runs.
+class Int8CalibrationRanges {
+ public:
+  // Widens the range of `tensor` to the values of the float `value`.
+  void Update(const string& tensor, const Tensor& value);
+
+  // Sets `config` to the configuration of the int8 quantizer for the ranges.
+  void ToConfig(RewriterConfig::CustomGraphOptimizer* config) const;
+
+  const std::map<string, std::pair<float, float>>& ranges() const {
+    return ranges_;
+  }
+
+ private:
+  std::map<string, std::pair<float, float>> ranges_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_INT8_QUANTIZER_H_
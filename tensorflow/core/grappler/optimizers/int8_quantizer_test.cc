@@ -0,0 +1,177 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/int8_quantizer.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class Int8QuantizerTest : public GrapplerTest {
+ protected:
+  // Returns a tensor of values in [-1, 1].
+  static Tensor RandomTensor(const TensorShape& shape) {
+    Tensor tensor(DT_FLOAT, shape);
+    for (int64 i = 0; i < tensor.NumElements(); ++i) {
+      tensor.flat<float>()(i) = (random::New64() % 2001) / 1000.0f - 1.0f;
+    }
+    return tensor;
+  }
+
+  // Builds a graph with a MatMul of the placeholder "x", and a Conv2D of the
+  // placeholder "images", both with constant weights, and feeds them.
+  GrapplerItem MakeItem() {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+    auto x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT);
+    auto weights = ops::Const(s.WithOpName("weights"), RandomTensor({16, 8}));
+    auto matmul = ops::MatMul(s.WithOpName("matmul"), x, weights);
+    auto images = ops::Placeholder(s.WithOpName("images"), DT_FLOAT);
+    auto filter =
+        ops::Const(s.WithOpName("filter"), RandomTensor({3, 3, 3, 4}));
+    auto conv = ops::Conv2D(s.WithOpName("conv"), images, filter, {1, 2, 2, 1},
+                            "SAME");
+    ops::Identity(s.WithOpName("matmul_fetch"), matmul);
+    ops::Identity(s.WithOpName("conv_fetch"), conv);
+
+    GrapplerItem item;
+    item.fetch = {"matmul_fetch", "conv_fetch"};
+    item.feed = {{"x", RandomTensor({4, 16})},
+                 {"images", RandomTensor({2, 7, 7, 3})}};
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+    return item;
+  }
+
+  // Returns the configuration of the quantizer, calibrated on the feeds of
+  // `item`.
+  RewriterConfig::CustomGraphOptimizer CalibratedConfig(
+      const GrapplerItem& item) {
+    Int8CalibrationRanges ranges;
+    for (const auto& feed : item.feed) {
+      ranges.Update(feed.first, feed.second);
+    }
+    RewriterConfig::CustomGraphOptimizer config;
+    ranges.ToConfig(&config);
+    return config;
+  }
+
+  const NodeDef* FindNode(const GraphDef& graph, const string& name) {
+    for (const NodeDef& node : graph.node()) {
+      if (node.name() == name) return &node;
+    }
+    return nullptr;
+  }
+};
+
+TEST_F(Int8QuantizerTest, CalibrationTensors) {
+  const GrapplerItem item = MakeItem();
+  EXPECT_EQ(std::vector<string>({"images", "x"}),
+            Int8CalibrationTensors(item.graph));
+}
+
+TEST_F(Int8QuantizerTest, CalibrationRanges) {
+  Int8CalibrationRanges ranges;
+  ranges.Update("x:0", test::AsTensor<float>({-1.0f, 2.0f}));
+  ranges.Update("x", test::AsTensor<float>({-3.0f, 1.0f}));
+  ranges.Update("y:1", test::AsTensor<float>({0.5f}));
+  EXPECT_EQ(2, ranges.ranges().size());
+  EXPECT_EQ(std::make_pair(-3.0f, 2.0f), ranges.ranges().at("x"));
+  EXPECT_EQ(std::make_pair(0.5f, 0.5f), ranges.ranges().at("y:1"));
+}
+
+TEST_F(Int8QuantizerTest, QuantizesCalibratedNodes) {
+  const GrapplerItem item = MakeItem();
+  const RewriterConfig::CustomGraphOptimizer config = CalibratedConfig(item);
+  Int8Quantizer optimizer;
+  TF_ASSERT_OK(optimizer.Init(&config));
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const NodeDef* matmul = FindNode(output, "matmul");
+  ASSERT_NE(nullptr, matmul);
+  EXPECT_EQ("_QuantizedMatMulPerChannel", matmul->op());
+  ASSERT_EQ(3, matmul->input_size());
+  EXPECT_EQ("x", matmul->input(0));
+  EXPECT_EQ("matmul/int8_weights", matmul->input(1));
+  EXPECT_EQ("matmul/int8_scales", matmul->input(2));
+  const NodeDef* conv = FindNode(output, "conv");
+  ASSERT_NE(nullptr, conv);
+  EXPECT_EQ("_QuantizedConv2DPerChannel", conv->op());
+  // The float weights are no longer used.
+  EXPECT_EQ(nullptr, FindNode(output, "weights"));
+  EXPECT_EQ(nullptr, FindNode(output, "filter"));
+
+  const std::vector<Tensor> expected =
+      EvaluateNodes(item.graph, item.fetch, item.feed);
+  const std::vector<Tensor> actual =
+      EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(2, actual.size());
+  test::ExpectTensorNear<float>(expected[0], actual[0], 0.1);
+  test::ExpectTensorNear<float>(expected[1], actual[1], 0.15);
+}
+
+TEST_F(Int8QuantizerTest, SkipsUncalibratedNodes) {
+  const GrapplerItem item = MakeItem();
+  Int8CalibrationRanges ranges;
+  ranges.Update("x", item.feed[0].second);
+  RewriterConfig::CustomGraphOptimizer config;
+  ranges.ToConfig(&config);
+  Int8Quantizer optimizer;
+  TF_ASSERT_OK(optimizer.Init(&config));
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ("_QuantizedMatMulPerChannel", FindNode(output, "matmul")->op());
+  EXPECT_EQ("Conv2D", FindNode(output, "conv")->op());
+  EXPECT_NE(nullptr, FindNode(output, "filter"));
+}
+
+TEST_F(Int8QuantizerTest, SkipsNodesOnGpu) {
+  GrapplerItem item = MakeItem();
+  for (NodeDef& node : *item.graph.mutable_node()) {
+    if (node.name() == "matmul") node.set_device("/device:GPU:0");
+  }
+  const RewriterConfig::CustomGraphOptimizer config = CalibratedConfig(item);
+  Int8Quantizer optimizer;
+  TF_ASSERT_OK(optimizer.Init(&config));
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ("MatMul", FindNode(output, "matmul")->op());
+  EXPECT_EQ("_QuantizedConv2DPerChannel", FindNode(output, "conv")->op());
+}
+
+TEST_F(Int8QuantizerTest, InvalidConfig) {
+  RewriterConfig::CustomGraphOptimizer config;
+  auto* parameters = config.mutable_parameter_map();
+  (*parameters)["calibrated_tensors"].mutable_list()->add_s("x");
+  (*parameters)["calibrated_min"].mutable_list()->add_f(1.0f);
+  (*parameters)["calibrated_max"].mutable_list()->add_f(-1.0f);
+  Int8Quantizer optimizer;
+  EXPECT_FALSE(optimizer.Init(&config).ok());
+  (*parameters)["calibrated_max"].mutable_list()->Clear();
+  EXPECT_FALSE(optimizer.Init(&config).ok());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
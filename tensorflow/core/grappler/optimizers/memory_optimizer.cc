@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <queue>
 #include <set>
 #include <unordered_map>
@@ -963,6 +965,43 @@ static bool IsSwappable(MutableGraphView::InputPort input) {
   return !IsRefType(dtype);
 }
 
+// Runs the graph on a virtual cluster and records the predicted completion time
+// and, if `op_execution_times` is not null, the execution time of every op.
+static bool EstimateOpTimes(
+    Cluster* cluster, const GrapplerItem& item,
+    std::unordered_map<string, Costs::NanoSeconds>* op_completion_times,
+    std::unordered_map<string, Costs::NanoSeconds>* op_execution_times) {
+  VirtualCluster vcluster(cluster->GetDevices());
+  if (!vcluster.Provision().ok()) {
+    return false;
+  }
+  if (!vcluster.Initialize(item).ok()) {
+    return false;
+  }
+  RunMetadata metadata;
+  Status s = vcluster.Run(item.graph, item.feed, item.fetch, &metadata);
+  if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
+    return false;
+  }
+
+  for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      Costs::NanoSeconds exec_time =
+          Costs::NanoSeconds(1) +
+          Costs::MicroSeconds(node_stats.all_start_micros() +
+                              node_stats.op_end_rel_micros());
+      op_completion_times->emplace(node_stats.node_name(), exec_time);
+      if (op_execution_times != nullptr) {
+        op_execution_times->emplace(
+            node_stats.node_name(),
+            Costs::MicroSeconds(node_stats.op_end_rel_micros() -
+                                node_stats.op_start_rel_micros()));
+      }
+    }
+  }
+  return true;
+}
+
 struct MemInfo {
   MutableGraphView::OutputPort port;
   int64 memory_used;
@@ -1003,29 +1042,9 @@ static bool IdentifySwappingCandidates(
     int64 required_savings = mem_usage.used_memory - prop.memory_size();
 
     std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
-    {
-      VirtualCluster vcluster(cluster->GetDevices());
-      if (!vcluster.Provision().ok()) {
-        return false;
-      }
-      if (!vcluster.Initialize(*item).ok()) {
-        return false;
-      }
-      RunMetadata metadata;
-      Status s = vcluster.Run(item->graph, item->feed, item->fetch, &metadata);
-      if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
-        return false;
-      }
-
-      for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
-        for (const auto& node_stats : dev_stats.node_stats()) {
-          Costs::NanoSeconds exec_time =
-              Costs::NanoSeconds(1) +
-              Costs::MicroSeconds(node_stats.all_start_micros() +
-                                  node_stats.op_end_rel_micros());
-          op_completion_times.emplace(node_stats.node_name(), exec_time);
-        }
-      }
+    if (!EstimateOpTimes(cluster, *item, &op_completion_times,
+                         /*op_execution_times=*/nullptr)) {
+      return false;
     }
 
     Costs::Duration peak_time = -1;
@@ -1137,32 +1156,12 @@ static bool IdentifySwappingCandidates(
   return updated_graph;
 }
 
-bool SwappingPass(RewriterConfig::MemOptType optimization_level,
-                  Cluster* cluster, GrapplerItem* item,
-                  std::unordered_set<string>* skip_list) {
-  std::unordered_map<NodeDef*, SwapInfo> nodes_to_swap;
-  if (optimization_level == RewriterConfig::DEFAULT_MEM_OPT ||
-      optimization_level == RewriterConfig::SWAPPING_HEURISTICS ||
-      optimization_level == RewriterConfig::HEURISTICS) {
-    // Use heuristics to figure out what needs to be swapped;
-    IdentifySwappingCandidates(cluster, item, skip_list, &nodes_to_swap);
-  }
-  // Look for manual annotatations in the graph.
-  for (auto& node : *item->graph.mutable_node()) {
-    if (node.attr().count("_swap_to_host") != 0) {
-      SwapInfo& swap_info = nodes_to_swap[&node];
-      const AttrValue& val = node.attr().at("_swap_to_host");
-      if (val.has_list()) {
-        for (int64 input_id : val.list().i()) {
-          swap_info.inputs_to_swap.push_back(input_id);
-        }
-      } else {
-        int64 input_id = val.i();
-        swap_info.inputs_to_swap.push_back(input_id);
-      }
-    }
-  }
-  if (nodes_to_swap.empty()) {
+// Swaps out the inputs selected in `nodes_to_swap` after they are produced,
+// and swaps them back in right before they are needed.
+bool SwapTensors(Cluster* cluster, GrapplerItem* item,
+                 std::unordered_map<NodeDef*, SwapInfo>* nodes_to_swap,
+                 std::unordered_set<string>* skip_list) {
+  if (nodes_to_swap->empty()) {
     // Nothing to do.
     return false;
   }
@@ -1176,7 +1175,7 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
            .ok()) {
     return false;
   }
-  for (auto& swap : nodes_to_swap) {
+  for (auto& swap : *nodes_to_swap) {
     const NodeDef* node = swap.first;
     const std::vector<OpInfo::TensorProperties>& props =
         properties.GetInputProperties(node->name());
@@ -1203,7 +1202,7 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
 
   bool updated_graph = false;
 
-  for (auto& swap : nodes_to_swap) {
+  for (auto& swap : *nodes_to_swap) {
     NodeDef* node = swap.first;
     const SwapInfo& swap_info = swap.second;
     if (skip_list->find(node->name()) != skip_list->end()) {
@@ -1260,6 +1259,282 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
   return updated_graph;
 }
 
+bool SwappingPass(RewriterConfig::MemOptType optimization_level,
+                  Cluster* cluster, GrapplerItem* item,
+                  std::unordered_set<string>* skip_list) {
+  std::unordered_map<NodeDef*, SwapInfo> nodes_to_swap;
+  if (optimization_level == RewriterConfig::DEFAULT_MEM_OPT ||
+      optimization_level == RewriterConfig::SWAPPING_HEURISTICS ||
+      optimization_level == RewriterConfig::HEURISTICS) {
+    // Use heuristics to figure out what needs to be swapped;
+    IdentifySwappingCandidates(cluster, item, skip_list, &nodes_to_swap);
+  }
+  // Look for manual annotatations in the graph.
+  for (auto& node : *item->graph.mutable_node()) {
+    if (node.attr().count("_swap_to_host") != 0) {
+      SwapInfo& swap_info = nodes_to_swap[&node];
+      const AttrValue& val = node.attr().at("_swap_to_host");
+      if (val.has_list()) {
+        for (int64 input_id : val.list().i()) {
+          swap_info.inputs_to_swap.push_back(input_id);
+        }
+      } else {
+        int64 input_id = val.i();
+        swap_info.inputs_to_swap.push_back(input_id);
+      }
+    }
+  }
+  return SwapTensors(cluster, item, &nodes_to_swap, skip_list);
+}
+
+// Reduction of the peak memory usage obtained by either recomputing a tensor or
+// swapping it to the host memory after the peak.
+struct MemorySavingCandidate {
+  MutableGraphView::OutputPort port;
+  int64 memory_used;
+  std::vector<MutableGraphView::InputPort> uses_left;
+  bool recompute;
+  // Predicted increase of the step time in nanoseconds.
+  double cost;
+
+  // Candidates that save the most memory per unit of cost come first.
+  bool operator<(const MemorySavingCandidate& other) const {
+    const double lhs = cost * other.memory_used;
+    const double rhs = other.cost * memory_used;
+    return lhs < rhs || (lhs == rhs && memory_used > other.memory_used);
+  }
+};
+
+// Picks a set of tensors to recompute or swap using the static peak memory
+// estimates and the timing predicted by the virtual scheduler, so that the
+// peak memory usage of every GPU fits into `memory_budget_bytes`. Candidates
+// are selected greedily by the predicted step time increase per saved byte.
+bool MemoryBudgetPass(RewriterConfig::MemOptType optimization_level,
+                      int64 memory_budget_bytes, Cluster* cluster,
+                      GrapplerItem* item,
+                      std::unordered_set<string>* skip_list) {
+  const bool allow_swapping =
+      optimization_level == RewriterConfig::DEFAULT_MEM_OPT ||
+      optimization_level == RewriterConfig::SWAPPING_HEURISTICS ||
+      optimization_level == RewriterConfig::HEURISTICS;
+  const bool allow_recomputation =
+      optimization_level == RewriterConfig::DEFAULT_MEM_OPT ||
+      optimization_level == RewriterConfig::RECOMPUTATION_HEURISTICS ||
+      optimization_level == RewriterConfig::HEURISTICS;
+  if (!allow_swapping && !allow_recomputation) {
+    return false;
+  }
+
+  // RecomputeSubgraph() relies on a topological numbering of the nodes. Sort
+  // the graph before collecting any NodeDef pointers.
+  if (!TopologicalSort(&item->graph).ok()) {
+    return false;
+  }
+
+  GraphMemory memory(*item);
+  const std::unordered_map<string, DeviceProperties>& devices =
+      cluster->GetDevices();
+  Status s = memory.InferStatically(devices);
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer memory usage: " << s.error_message();
+    return false;
+  }
+
+  std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
+  std::unordered_map<string, Costs::NanoSeconds> op_execution_times;
+  bool estimated_op_times = false;
+
+  std::unordered_set<string> nodes_to_preserve = item->NodesToPreserve();
+  for (const auto& feed : item->feed) {
+    nodes_to_preserve.insert(NodeName(feed.first));
+  }
+  const std::unordered_set<string> cheap_to_recompute_ops =
+      GetCheapToRecomputeOps();
+
+  MutableGraphView graph(&item->graph);
+  NodeMap node_map(&item->graph);
+  std::unordered_map<const NodeDef*, int> topological_numbering;
+  for (int i = 0; i < item->graph.node_size(); ++i) {
+    topological_numbering[item->graph.mutable_node(i)] =
+        item->graph.node_size() - i - 1;
+  }
+
+  std::unordered_map<NodeDef*, SwapInfo> nodes_to_swap;
+  bool updated_graph = false;
+
+  for (const auto& device : devices) {
+    const string& name = device.first;
+    const DeviceProperties& prop = device.second;
+    if (prop.type() != "GPU") {
+      continue;
+    }
+    int64 budget = memory_budget_bytes;
+    if (prop.memory_size() > 0) {
+      budget = std::min(budget, prop.memory_size());
+    }
+    const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
+    if (mem_usage.used_memory <= budget) {
+      continue;
+    }
+    int64 required_savings = mem_usage.used_memory - budget;
+    VLOG(1) << "Peak memory usage of " << name << " is "
+            << mem_usage.used_memory << " bytes, need to save "
+            << required_savings << " bytes to fit into the budget";
+
+    if (!estimated_op_times) {
+      if (!EstimateOpTimes(cluster, *item, &op_completion_times,
+                           &op_execution_times)) {
+        return updated_graph;
+      }
+      estimated_op_times = true;
+    }
+
+    Costs::Duration peak_time = -1;
+    std::unordered_map<string, const GraphMemory::LiveTensor*> live_tensors;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      peak_time = std::max(peak_time, live_tensor.allocation_time);
+      live_tensors[strings::StrCat(live_tensor.node, ":",
+                                   live_tensor.output_id)] = &live_tensor;
+    }
+
+    // Returns true if `node` can be recomputed right before `earliest_use`
+    // without extending the lifetime of its inputs.
+    const auto is_recomputable = [&](const NodeDef& node,
+                                     Costs::Duration earliest_use) {
+      if (nodes_to_preserve.count(node.name()) > 0) return false;
+      if (cheap_to_recompute_ops.count(node.op()) == 0 &&
+          node.attr().count(kRecomputeHint) == 0) {
+        return false;
+      }
+      for (const string& input : node.input()) {
+        if (IsControlInput(input)) continue;
+        int output_id;
+        const string input_node = ParseNodeName(input, &output_id);
+        const NodeDef* input_def = node_map.GetNode(input_node);
+        if (input_def != nullptr && IsConstant(*input_def)) continue;
+        auto it =
+            live_tensors.find(strings::StrCat(input_node, ":", output_id));
+        if (it == live_tensors.end() ||
+            it->second->deallocation_time < earliest_use) {
+          return false;
+        }
+      }
+      return true;
+    };
+
+    std::vector<MemorySavingCandidate> candidates;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      if (live_tensor.memory_used <= 1024) {
+        // Don't bother with small tensors.
+        continue;
+      }
+      if (skip_list->find(live_tensor.node) != skip_list->end()) {
+        continue;
+      }
+      MutableGraphView::OutputPort port =
+          graph.GetOutputPort(live_tensor.node, live_tensor.output_id);
+      if (port.node == nullptr) {
+        continue;
+      }
+
+      MemorySavingCandidate candidate;
+      candidate.port = port;
+      candidate.memory_used = live_tensor.memory_used;
+      Costs::Duration earliest_use(Costs::Duration::infinity());
+      bool valid = true;
+      bool swappable_uses = true;
+      for (MutableGraphView::InputPort input : graph.GetFanout(port)) {
+        auto it = op_completion_times.find(input.node->name());
+        if (it == op_completion_times.end()) {
+          valid = false;
+          break;
+        }
+        if (it->second <= peak_time) {
+          continue;
+        }
+        if (skip_list->find(input.node->name()) != skip_list->end() ||
+            skip_list->find(strings::StrCat(input.node->name(), ":",
+                                            input.port_id)) !=
+                skip_list->end()) {
+          valid = false;
+          break;
+        }
+        swappable_uses &= IsSwappable(input);
+        candidate.uses_left.emplace_back(input);
+        earliest_use = std::min(earliest_use, it->second);
+      }
+      if (!valid || candidate.uses_left.empty()) {
+        continue;
+      }
+
+      // Swapping is free as long as the transfers overlap with the compute
+      // before and after the peak. Let's assume we're going to swap over PCIe
+      // running at 16 GBps.
+      double swap_cost = std::numeric_limits<double>::infinity();
+      if (allow_swapping && swappable_uses && IsSwappable(graph, port)) {
+        const double time_to_swap = live_tensor.memory_used / 16.0;
+        swap_cost =
+            std::max(0.0,
+                     time_to_swap -
+                         (peak_time - live_tensor.allocation_time).count()) +
+            std::max(0.0, time_to_swap - (earliest_use - peak_time).count());
+      }
+
+      // Recomputation reruns the producer once before the remaining uses.
+      double recompute_cost = std::numeric_limits<double>::infinity();
+      if (allow_recomputation && port.port_id == 0 &&
+          is_recomputable(*port.node, earliest_use)) {
+        auto it = op_execution_times.find(port.node->name());
+        if (it != op_execution_times.end()) {
+          recompute_cost = it->second.count();
+        }
+      }
+
+      if (std::isinf(swap_cost) && std::isinf(recompute_cost)) {
+        continue;
+      }
+      candidate.recompute = recompute_cost < swap_cost;
+      candidate.cost = std::min(swap_cost, recompute_cost);
+      candidates.push_back(std::move(candidate));
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+
+    for (const MemorySavingCandidate& candidate : candidates) {
+      if (required_savings <= 0) {
+        break;
+      }
+      NodeDef* producer = candidate.port.node;
+      VLOG(1) << "Will " << (candidate.recompute ? "recompute" : "swap")
+              << " tensor " << producer->name() << ":"
+              << candidate.port.port_id << " of size "
+              << candidate.memory_used << " at a cost of " << candidate.cost
+              << "ns";
+      if (candidate.recompute) {
+        std::unordered_set<NodeDef*> target_nodes;
+        for (const MutableGraphView::InputPort& use : candidate.uses_left) {
+          target_nodes.insert(use.node);
+        }
+        RecomputeSubgraph({producer}, target_nodes, node_map,
+                          topological_numbering, &item->graph);
+        // Don't attempt to reprocess these nodes in a subsequent pass.
+        skip_list->insert(producer->name());
+        skip_list->insert(
+            AddPrefixToNodeName(producer->name(), kRecomputedNodePrefix));
+      } else {
+        for (const MutableGraphView::InputPort& use : candidate.uses_left) {
+          nodes_to_swap[use.node].inputs_to_swap.push_back(use.port_id);
+        }
+      }
+      required_savings -= candidate.memory_used;
+      updated_graph = true;
+    }
+  }
+
+  SwapTensors(cluster, item, &nodes_to_swap, skip_list);
+  return updated_graph;
+}
+
 bool CrossesTaskOrCpuGpuBoundary(const NodeDef& node1, const NodeDef& node2) {
   string task1;
   string device1;
@@ -1400,6 +1675,13 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     for (int i = 0; i < 25 && updated_graph; ++i) {
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
       updated_graph = false;
+      if (memory_budget_bytes_ > 0 && cluster != nullptr) {
+        updated_graph |=
+            MemoryBudgetPass(optimization_level_, memory_budget_bytes_,
+                             cluster, &optimized_item, &skip_list);
+      }
+
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SCHEDULING_HEURISTICS ||
            optimization_level_ == RewriterConfig::HEURISTICS) &&
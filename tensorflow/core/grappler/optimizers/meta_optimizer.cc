@@ -15,10 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
 
+#include <algorithm>
+
+#include "absl/strings/escaping.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/substitute.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/graph_def_util.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/versions.pb.h"
@@ -47,8 +51,16 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/grappler/utils/tpu.h"
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/ptr_util.h"
 #include "tensorflow/core/util/xla_config_registry.h"
@@ -85,7 +97,8 @@ int NumIterations(const RewriterConfig& cfg) {
 // Check if optimizer is allowed to run only once.
 bool IsRunOnceOptimizer(const string& name) {
   return name == "layout" || name == "memory_optimizer" ||
-         name == "loop_optimizer" || name == "auto_mixed_precision";
+         name == "loop_optimizer" || name == "auto_mixed_precision" ||
+         name == "auto_mixed_precision_cpu";
 }
 
 // Creates a function library stub from a real function library: copy only
@@ -117,6 +130,102 @@ uint64 DeadlineMicroSeconds(const RewriterConfig& cfg) {
   }
 }
 
+// Returns a fingerprint of everything that determines the result of optimizing
+// `item` with `cfg`: the graph and its library, the nodes to preserve, the
+// optimization options, the available devices and the config itself.
+uint64 OptimizationCacheKey(const Cluster* cluster, const GrapplerItem& item,
+                            const RewriterConfig& cfg) {
+  uint64 key = GraphDefFingerprint(item.graph);
+
+  string serialized;
+  RewriterConfig cfg_without_cache_dir = cfg;
+  cfg_without_cache_dir.clear_meta_optimizer_cache_dir();
+  SerializeToStringDeterministic(cfg_without_cache_dir, &serialized);
+  key = FingerprintCat64(key, Fingerprint64(serialized));
+
+  const auto add_strings = [&key](const char* tag, std::vector<string> values) {
+    std::sort(values.begin(), values.end());
+    const string joined = strings::StrCat(tag, ":", absl::StrJoin(values, ","));
+    key = FingerprintCat64(key, Fingerprint64(joined));
+  };
+  std::vector<string> feed;
+  for (const auto& feed_tensor : item.feed) {
+    feed.push_back(strings::StrCat(feed_tensor.first, ":",
+                                   DataTypeString(feed_tensor.second.dtype()),
+                                   feed_tensor.second.shape().DebugString()));
+  }
+  add_strings("feed", std::move(feed));
+  add_strings("fetch", item.fetch);
+  add_strings("init_ops", item.init_ops);
+  add_strings("keep_ops", item.keep_ops);
+  add_strings("save_restore",
+              {item.save_op, item.restore_op, item.save_restore_loc_tensor});
+  add_strings("devices", std::vector<string>(item.devices().begin(),
+                                             item.devices().end()));
+  if (cluster) {
+    std::vector<string> cluster_devices;
+    for (const auto& device : cluster->GetDevices()) {
+      SerializeToStringDeterministic(device.second, &serialized);
+      cluster_devices.push_back(strings::StrCat(
+          device.first, "=", absl::BytesToHexString(serialized)));
+    }
+    add_strings("cluster_devices", std::move(cluster_devices));
+  }
+
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  add_strings("options",
+              {strings::StrCat(options.allow_non_differentiable_rewrites,
+                               options.allow_pruning_stateful_and_dataset_ops,
+                               options.optimize_function_library,
+                               options.is_eager_mode)});
+  // Results of different TensorFlow versions are never reused.
+  add_strings("version",
+              {TF_VERSION_STRING, strings::StrCat(TF_GRAPH_DEF_VERSION)});
+  return key;
+}
+
+string OptimizationCacheFilename(const string& cache_dir, uint64 key) {
+  return io::JoinPath(cache_dir,
+                      strings::StrCat(strings::Hex(key, strings::kZeroPad16),
+                                      ".graphdef.pb"));
+}
+
+// Reads a cached optimized graph. Returns false if there is none, or if the
+// cache entry can't be read.
+bool ReadFromOptimizationCache(const string& filename,
+                               GraphDef* optimized_graph) {
+  Env* env = Env::Default();
+  if (!env->FileExists(filename).ok()) return false;
+  const Status status = ReadBinaryProto(env, filename, optimized_graph);
+  if (!status.ok()) {
+    LOG(WARNING) << "Ignoring unreadable meta-optimizer cache entry "
+                 << filename << ": " << status;
+    optimized_graph->Clear();
+    return false;
+  }
+  return true;
+}
+
+// Writes an optimized graph to the cache. The graph is first written to a
+// temporary file and then renamed, so that concurrent readers (e.g. other
+// replicas sharing the cache directory) never see a partially written entry.
+Status WriteToOptimizationCache(const string& filename,
+                                const GraphDef& optimized_graph) {
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(string(io::Dirname(filename))));
+  const string tmp_filename =
+      strings::StrCat(filename, ".tmp", random::New64());
+  Status status = WriteBinaryProto(env, tmp_filename, optimized_graph);
+  if (status.ok()) {
+    status = env->RenameFile(tmp_filename, filename);
+  }
+  if (!status.ok()) {
+    env->DeleteFile(tmp_filename).IgnoreError();
+  }
+  return status;
+}
+
 // A helper function to decide whether to enable the automatic mixed precision
 // optimizer.
 bool AutoMixedPrecisionEnabled(RewriterConfig::Toggle opt_level) {
@@ -175,15 +284,23 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
   MK_OPT("function", new FunctionOptimizer(
                          cfg_.function_optimization(),
                          /*lower_control_flow=*/!IsSingleThreadedExecutor()));
-  MK_OPT("constfold", new ConstantFolding(cpu_device_));
+  MK_OPT("constfold",
+         new ConstantFolding(
+             RewriterConfig::ON, cpu_device_,
+             cfg_.constant_folding_max_constant_size_bytes(),
+             cfg_.constant_folding_total_constant_budget_bytes(),
+             cfg_.constant_folding_num_threads()));
   MK_OPT("shape", new ShapeOptimizer());
   MK_OPT("remap", new Remapper(cfg_.remapping()));
   MK_OPT("layout", new GenericLayoutOptimizer());
   MK_OPT("auto_mixed_precision",
          new AutoMixedPrecision(cfg_.auto_mixed_precision()));
+  MK_OPT("auto_mixed_precision_cpu",
+         new AutoMixedPrecision(cfg_.auto_mixed_precision_cpu(),
+                                AutoMixedPrecisionMode::CPU));
   MK_OPT("memory", new MemoryOptimizer(RewriterConfig::MANUAL));
   MK_OPT("arithmetic", new ArithmeticOptimizer(cfg_.arithmetic_optimization()));
-  MK_OPT("autoparallel", new AutoParallel(cfg_.auto_parallel().num_replicas()));
+  MK_OPT("autoparallel", new AutoParallel(cfg_.auto_parallel()));
   MK_OPT("loop", new LoopOptimizer(cfg_.loop_optimization(), cpu_device_));
   MK_OPT("dependency", new DependencyOptimizer(cfg_.dependency_optimization()));
   MK_OPT("debug_stripper", new DebugStripper());
@@ -226,8 +343,11 @@ Status MetaOptimizer::InitializeOptimizers(
     optimizers->push_back(MakeUnique<DebugStripper>());
   }
   if (cfg_.constant_folding() != RewriterConfig::OFF) {
-    optimizers->push_back(
-        MakeUnique<ConstantFolding>(cfg_.constant_folding(), cpu_device_));
+    optimizers->push_back(MakeUnique<ConstantFolding>(
+        cfg_.constant_folding(), cpu_device_,
+        cfg_.constant_folding_max_constant_size_bytes(),
+        cfg_.constant_folding_total_constant_budget_bytes(),
+        cfg_.constant_folding_num_threads()));
   }
   if (cfg_.shape_optimization() != RewriterConfig::OFF) {
     optimizers->push_back(MakeUnique<ShapeOptimizer>());
@@ -236,6 +356,10 @@ Status MetaOptimizer::InitializeOptimizers(
     optimizers->push_back(
         MakeUnique<AutoMixedPrecision>(cfg_.auto_mixed_precision()));
   }
+  if (AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_cpu())) {
+    optimizers->push_back(MakeUnique<AutoMixedPrecision>(
+        cfg_.auto_mixed_precision_cpu(), AutoMixedPrecisionMode::CPU));
+  }
   if (cfg_.pin_to_host_optimization() == RewriterConfig::ON) {
     optimizers->push_back(MakeUnique<PinToHostOptimizer>());
   }
@@ -261,18 +385,19 @@ Status MetaOptimizer::InitializeOptimizers(
       config_proto_.graph_options().optimizer_options().global_jit_level();
   if (MemoryOptimizerEnabled(cfg_.memory_optimization(), global_jit_level)) {
     if (cfg_.memory_optimizer_target_node_name_scope().empty()) {
-      optimizers->push_back(
+      optimizers->push_back(MakeUnique<MemoryOptimizer>(
           // Use the default target node name prefix "gradients/"
-          MakeUnique<MemoryOptimizer>(cfg_.memory_optimization()));
+          cfg_.memory_optimization(), "gradients/",
+          cfg_.memory_optimizer_memory_budget_bytes()));
     } else {
       optimizers->push_back(MakeUnique<MemoryOptimizer>(
           cfg_.memory_optimization(),
-          cfg_.memory_optimizer_target_node_name_scope()));
+          cfg_.memory_optimizer_target_node_name_scope(),
+          cfg_.memory_optimizer_memory_budget_bytes()));
     }
   }
   if (cfg_.auto_parallel().enable()) {
-    optimizers->push_back(
-        MakeUnique<AutoParallel>(cfg_.auto_parallel().num_replicas()));
+    optimizers->push_back(MakeUnique<AutoParallel>(cfg_.auto_parallel()));
   }
   if (cfg_.scoped_allocator_optimization()) {
     optimizers->push_back(MakeUnique<ScopedAllocatorOptimizer>(
@@ -499,7 +624,10 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, const GrapplerItem& item,
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  {
+    mutex_lock l(mu_);
+    optimization_results_.push_back(optimization_result);
+  }
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -580,8 +708,46 @@ Status MetaOptimizer::RunOptimizer(
 
 Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                GraphDef* optimized_graph) {
+  {
+    mutex_lock l(mu_);
+    optimization_results_.clear();
+  }
+  const string& cache_dir = cfg_.meta_optimizer_cache_dir();
+  if (cache_dir.empty()) {
+    return OptimizeGraphAndFunctions(cluster, item, optimized_graph);
+  }
+
+  const string cache_filename = OptimizationCacheFilename(
+      cache_dir, OptimizationCacheKey(cluster, item, cfg_));
+  if (ReadFromOptimizationCache(cache_filename, optimized_graph)) {
+    VLOG(1) << "Found optimized graph for grappler item " << item.id
+            << " in the cache: " << cache_filename;
+    return Status::OK();
+  }
+
+  TF_RETURN_IF_ERROR(OptimizeGraphAndFunctions(cluster, item, optimized_graph));
+
+  // Do not cache results that depend on transient failures, e.g. an optimizer
+  // that ran out of time.
+  mutex_lock l(mu_);
+  for (const GraphOptimizationResult& graph_result : optimization_results_) {
+    for (const OptimizerResult& result : graph_result.results) {
+      if (!result.status.ok()) return Status::OK();
+    }
+  }
+  const Status status =
+      WriteToOptimizationCache(cache_filename, *optimized_graph);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to cache the optimized graph for grappler item "
+                 << item.id << ": " << status;
+  }
+  return Status::OK();
+}
+
+Status MetaOptimizer::OptimizeGraphAndFunctions(Cluster* cluster,
+                                                const GrapplerItem& item,
+                                                GraphDef* optimized_graph) {
   VLOG(1) << "Starting optimization for grappler item: " << item.id;
-  optimization_results_.clear();
 
   // Constructs a FunctionLibraryDefinition with functions that are reachable
   // from the nodes of the graph.
@@ -666,13 +832,15 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   bool optimize_function_library =
       item.optimization_options().optimize_function_library;
 
+  const bool is_tpu_graph = IsTPUGraphDef(*optimized_graph);
+  const int graph_def_version = trimmed_item.graph.versions().producer();
+
   while (optimize_function_library) {
     optimize_function_library = false;
 
-    int function_idx = 0;
+    // Collect the functions to optimize in this pass over the library.
+    std::vector<const FunctionDef*> funcs_to_optimize;
     for (const FunctionDef& func : optimized_graph->library().function()) {
-      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
-
       const string& func_name = func.signature().name();
 
       // Skip functions that are not reachable from the optimized graph.
@@ -688,93 +856,57 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       // the function optimizer, before we can optimize function body.
       if (IsParametrized(func)) continue;
 
-      VLOG(3) << "Optimize function: function=" << func_name << " ["
-              << function_idx++ << " of "
-              << optimized_graph->library().function_size() << "]";
-
       // Function optimization might specialize nested function calls, so we
       // have to reset the flag and do at least one more pass over the library.
       optimize_function_library = true;
       optimized_funcs.insert(func_name);
+      funcs_to_optimize.push_back(&func);
+    }
 
-      // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
-      TF_RETURN_IF_ERROR(MakeGrapplerFunctionItem(
-          func, flib, trimmed_item.graph.versions().producer(), &func_item));
-
-      // If we need to compute the gradient of optimized function at runtime, we
-      // can't perform non-differentiable rewrites.
-      func_item.optimization_options().allow_non_differentiable_rewrites =
-          !differentiable_functions.contains(func_name);
-
-      // Device set available to the function is defined only by the runtime,
-      // when we instantiate and execute the function. We can't use all devices
-      // available to the main graph, because after partitioning the function
-      // call node might execute on a remote worker.
-      if (!func_item.devices().empty()) {
-        return errors::Internal("GrapplerFunctionItem devices must be empty.");
-      }
-
-      // We are not allowed to prune certain types of ops from the graph
-      // instantiated by the function definition, because we must guarantee
-      // function execution semantics wrt side effects (see
-      // function_optimizer.cc).
-      func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
-          false;
-
-      // TODO(b/129545186): Shape inference in GraphProperties doesn't work well
-      // with _Arg nodes. Replace them with Placeholders with unknown shape.
-      absl::flat_hash_set<absl::string_view> input_nodes;
-      for (auto& input_arg : func_item.inputs()) {
-        input_nodes.insert(input_arg.node_name);
-      }
-      for (NodeDef& func_node : *func_item.graph.mutable_node()) {
-        if (input_nodes.contains(func_node.name())) {
-          func_node.set_op("Placeholder");
-          auto& attrs = *func_node.mutable_attr();
-          attrs["dtype"] = attrs["T"];
-          attrs.erase("index");
-          attrs.erase("T");
-          TensorShapeProto unknown_shape;
-          unknown_shape.set_unknown_rank(true);
-          *(attrs["shape"].mutable_shape()) = unknown_shape;
-        }
-      }
-
-      // Optimize function body graph.
-      GraphDef optimized_func_graph;
-      if (IsTPUGraphDef(*optimized_graph)) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only execption is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        FunctionDefLibrary func_item_function_library;
-        func_item_function_library.Swap(func_item.graph.mutable_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
-      } else {
-        TF_RETURN_IF_ERROR(
-            OptimizeGraph(cluster, func_item, &optimized_func_graph));
+    // Functions in the same pass are independent of each other: they only read
+    // `flib`, which is not modified until all of them are optimized, so they
+    // can be optimized concurrently.
+    const int num_funcs = funcs_to_optimize.size();
+    std::vector<GrapplerFunctionItem> func_items(num_funcs);
+    std::vector<GraphDef> optimized_func_graphs(num_funcs);
+    std::vector<Status> statuses(num_funcs);
+    const auto optimize_function = [&](int i) {
+      const FunctionDef& func = *funcs_to_optimize[i];
+      VLOG(3) << "Optimize function: function=" << func.signature().name()
+              << " [" << i << " of " << num_funcs << "]";
+      statuses[i] = OptimizeFunction(
+          cluster, func, flib, graph_def_version,
+          /*allow_non_differentiable_rewrites=*/
+          !differentiable_functions.contains(func.signature().name()),
+          is_tpu_graph, &func_items[i], &optimized_func_graphs[i]);
+    };
+    const int num_threads = std::min(num_funcs, port::MaxParallelism());
+    if (num_threads > 1) {
+      thread::ThreadPool thread_pool(Env::Default(), "meta_optimizer_functions",
+                                     num_threads);
+      BlockingCounter counter(num_funcs);
+      for (int i = 0; i < num_funcs; ++i) {
+        thread_pool.Schedule([&optimize_function, &counter, i]() {
+          optimize_function(i);
+          counter.DecrementCount();
+        });
       }
+      counter.Wait();
+    } else {
+      for (int i = 0; i < num_funcs; ++i) optimize_function(i);
+    }
+    for (const Status& status : statuses) {
+      TF_RETURN_IF_ERROR(status);
+    }
+    GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
 
+    // Merge the optimized functions in library order, so that the resulting
+    // library does not depend on the order in which the threads finished.
+    for (int i = 0; i < num_funcs; ++i) {
       // Function body optimization might have created new specialized
       // functions for each instantiation context. Add them to the library.
       for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
+           optimized_func_graphs[i].library().function()) {
         if (flib.Find(func_def.signature().name()) == nullptr) {
           TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
         }
@@ -782,11 +914,13 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
 
       // Convert optimized graph back to FunctionDef.
       FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
+      GrapplerFunctionItem& func_item = func_items[i];
+      func_item.SwapFunctionBody(std::move(optimized_func_graphs[i]));
       TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
 
       // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
+      TF_RETURN_IF_ERROR(flib.ReplaceFunction(
+          funcs_to_optimize[i]->signature().name(), optimized_func));
     }
 
     // If optimized at least one function, update the graph library.
@@ -807,7 +941,84 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   return Status::OK();
 }
 
+Status MetaOptimizer::OptimizeFunction(
+    Cluster* cluster, const FunctionDef& func,
+    const FunctionLibraryDefinition& flib, int graph_def_version,
+    bool allow_non_differentiable_rewrites, bool is_tpu_graph,
+    GrapplerFunctionItem* func_item, GraphDef* optimized_func_graph) {
+  // Make a GrapplerItem from a FunctionDef.
+  TF_RETURN_IF_ERROR(
+      MakeGrapplerFunctionItem(func, flib, graph_def_version, func_item));
+
+  // If we need to compute the gradient of optimized function at runtime, we
+  // can't perform non-differentiable rewrites.
+  func_item->optimization_options().allow_non_differentiable_rewrites =
+      allow_non_differentiable_rewrites;
+
+  // Device set available to the function is defined only by the runtime,
+  // when we instantiate and execute the function. We can't use all devices
+  // available to the main graph, because after partitioning the function
+  // call node might execute on a remote worker.
+  if (!func_item->devices().empty()) {
+    return errors::Internal("GrapplerFunctionItem devices must be empty.");
+  }
+
+  // We are not allowed to prune certain types of ops from the graph
+  // instantiated by the function definition, because we must guarantee
+  // function execution semantics wrt side effects (see
+  // function_optimizer.cc).
+  func_item->optimization_options().allow_pruning_stateful_and_dataset_ops =
+      false;
+
+  // TODO(b/129545186): Shape inference in GraphProperties doesn't work well
+  // with _Arg nodes. Replace them with Placeholders with unknown shape.
+  absl::flat_hash_set<absl::string_view> input_nodes;
+  for (auto& input_arg : func_item->inputs()) {
+    input_nodes.insert(input_arg.node_name);
+  }
+  for (NodeDef& func_node : *func_item->graph.mutable_node()) {
+    if (input_nodes.contains(func_node.name())) {
+      func_node.set_op("Placeholder");
+      auto& attrs = *func_node.mutable_attr();
+      attrs["dtype"] = attrs["T"];
+      attrs.erase("index");
+      attrs.erase("T");
+      TensorShapeProto unknown_shape;
+      unknown_shape.set_unknown_rank(true);
+      *(attrs["shape"].mutable_shape()) = unknown_shape;
+    }
+  }
+
+  // Optimize function body graph.
+  if (is_tpu_graph) {
+    // Skip optimizing functions if this is a TPU graph. Currently, Grappler
+    // passes do not handle TPU functions correctly in a variety of ways
+    // (Note that due to the pre-placement TPU graph rewriting passes, the
+    // TPU-related ops are encapsulated away into functions). For example,
+    // TPU graphs contain TPUReplicateMetadata node that carries relevant
+    // TPU metadata and Grappler passes could prune that away. Grappler
+    // passes could also cause issues around shape inference. Since the
+    // desired and existing behavior is to not optimize TPU functions with
+    // Grappler, this check preserves that. The only execption is
+    // implementation selector what is required to swap in some TPU specific
+    // lowering code and is verified the work correctly on TPUs.
+    ImplementationSelector implementation_selector;
+
+    // Implementation selector needs to have access to valid function
+    // signature and attributes, and it doesn't need actual function body.
+    FunctionDefLibrary func_item_function_library;
+    func_item_function_library.Swap(func_item->graph.mutable_library());
+    *func_item->graph.mutable_library() =
+        GetFunctionDefLibraryStub(func_item_function_library);
+
+    return implementation_selector.Optimize(cluster, *func_item,
+                                            optimized_func_graph);
+  }
+  return OptimizeGraph(cluster, *func_item, optimized_func_graph);
+}
+
 void MetaOptimizer::PrintResult() {
+  mutex_lock l(mu_);
   for (const GraphOptimizationResult& graph_result : optimization_results_) {
     LOG(INFO) << "Optimization results for grappler item: " << graph_result.id;
     for (const OptimizerResult& result : graph_result.results) {
@@ -841,6 +1052,7 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
          rewrite_cfg.scoped_allocator_optimization() == RewriterConfig::ON ||
          rewrite_cfg.pin_to_host_optimization() == RewriterConfig::ON ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision()) ||
+         AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision_cpu()) ||
          !rewrite_cfg.optimizers().empty() ||
          !rewrite_cfg.custom_optimizers().empty();
 }
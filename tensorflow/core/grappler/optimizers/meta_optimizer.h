@@ -22,8 +22,10 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/grappler/utils/functions.h"
 #include "tensorflow/core/grappler/verifiers/graph_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/protobuf/verifier_config.pb.h"
@@ -80,6 +82,21 @@ class MetaOptimizer : public GraphOptimizer {
   Status OptimizeGraph(Cluster* cluster, const GrapplerItem& item,
                        GraphDef* optimized_graph);
 
+  // Optimize the main graph of the item and all functions reachable from it.
+  // This is what Optimize() does when the result is not in the cache.
+  Status OptimizeGraphAndFunctions(Cluster* cluster, const GrapplerItem& item,
+                                   GraphDef* optimized_graph);
+
+  // Optimize the body of a single function from the library of the main
+  // graph. Only reads `flib`, so that the functions of the library can be
+  // optimized concurrently.
+  Status OptimizeFunction(Cluster* cluster, const FunctionDef& func,
+                          const FunctionLibraryDefinition& flib,
+                          int graph_def_version,
+                          bool allow_non_differentiable_rewrites,
+                          bool is_tpu_graph, GrapplerFunctionItem* func_item,
+                          GraphDef* optimized_func_graph);
+
   DeviceBase* const cpu_device_;  // may be NULL
   ConfigProto config_proto_;
   RewriterConfig& cfg_;
@@ -100,7 +117,10 @@ class MetaOptimizer : public GraphOptimizer {
                       GrapplerItem* optimized_item, GraphDef* optimized_graph,
                       GraphOptimizationResult* optimization_result);
 
-  std::vector<GraphOptimizationResult> optimization_results_;
+  // Functions of the library are optimized concurrently, and each of them
+  // records its results.
+  mutex mu_;
+  std::vector<GraphOptimizationResult> optimization_results_ GUARDED_BY(mu_);
 };
 
 bool MetaOptimizerEnabled(const ConfigProto& cfg);
@@ -29,6 +29,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -197,6 +199,58 @@ TEST_F(MetaOptimizerTest, RunsCustomOptimizerAndCustomGraphOptimizer) {
   EXPECT_TRUE(TestGraphOptimizer::IsOptimized());
 }
 
+TEST_F(MetaOptimizerTest, ReusesCachedOptimizedGraph) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"CPU:0"});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  const string cache_dir =
+      io::JoinPath(testing::TmpDir(), "meta_optimizer_cache");
+  int64 undeleted_files, undeleted_dirs;
+  Env::Default()
+      ->DeleteRecursively(cache_dir, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("TestOptimizer");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_meta_optimizer_cache_dir(cache_dir);
+
+  TestOptimizer::SetOptimized(false);
+  GraphDef output;
+  {
+    MetaOptimizer optimizer(nullptr, config_proto);
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  }
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+  std::vector<string> cache_entries;
+  TF_EXPECT_OK(Env::Default()->GetChildren(cache_dir, &cache_entries));
+  EXPECT_EQ(cache_entries.size(), 1);
+
+  // An identical item is not optimized again.
+  TestOptimizer::SetOptimized(false);
+  GraphDef cached_output;
+  {
+    MetaOptimizer optimizer(nullptr, config_proto);
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &cached_output));
+  }
+  EXPECT_FALSE(TestOptimizer::IsOptimized());
+  CompareGraphs(output, cached_output);
+
+  // Changing the config invalidates the cached result.
+  rewriter_config.add_optimizers("TestGraphOptimizer");
+  TestOptimizer::SetOptimized(false);
+  {
+    MetaOptimizer optimizer(nullptr, config_proto);
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  }
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+  TF_EXPECT_OK(Env::Default()->GetChildren(cache_dir, &cache_entries));
+  EXPECT_EQ(cache_entries.size(), 2);
+}
+
 TEST_F(MetaOptimizerTest, RunOptimizersTwice) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"CPU:0"});
   GrapplerItem item;
@@ -490,6 +544,65 @@ TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryPruneUnusedOutputs) {
   test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
 }
 
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryConcurrently) {
+  using test::function::NDef;
+  constexpr int kNumFunctions = 16;
+
+  // Tensorflow graph:
+  //   a = Placeholder[T=float]
+  //   call_i = MyMul_i(a) for i in [0, kNumFunctions)
+  //
+  // All MyMul_i functions are marked as `_noinline`, so each call gets its own
+  // specialized function, and all of them are optimized in the same pass.
+  GrapplerItem item;
+  item.id = "tf_graph";
+  std::vector<NodeDef> nodes = {
+      NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice)};
+  std::vector<FunctionDef> function_library;
+  for (int i = 0; i < kNumFunctions; ++i) {
+    const string func_name = absl::StrCat("MyMul_", i);
+    FunctionDef my_mul = FunctionDefHelper::Create(
+        func_name, {"x:T"}, {"z:T"}, {"T: {float, int32}"},
+        {{{"mul"}, "Mul", {"x", "x"}, {{"T", "$T"}}}},
+        /*ret_def=*/
+        {{"z", "mul:z:0"}});
+    (*my_mul.mutable_attr())["_noinline"].set_b(true);
+    function_library.push_back(my_mul);
+    const string call_name = absl::StrCat("call_", i);
+    nodes.push_back(NDef(call_name, func_name, {"a"}, {{"T", DT_FLOAT}},
+                         kDevice));
+    item.fetch.push_back(call_name);
+  }
+  item.graph = test::function::GDef(nodes, function_library);
+
+  ConfigProto config_proto;
+  GraphDef output;
+  {
+    MetaOptimizer optimizer(nullptr, config_proto);
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  }
+
+  FunctionLibraryDefinition optimized_flib(OpRegistry::Global(),
+                                           output.library());
+  for (int i = 0; i < kNumFunctions; ++i) {
+    EXPECT_NE(optimized_flib.Find(
+                  absl::StrCat("MyMul_", i, "_specialized_for_call_", i,
+                               "_at_tf_graph")),
+              nullptr);
+  }
+
+  // The optimized library does not depend on the order in which concurrently
+  // optimized functions finish.
+  for (int run = 0; run < 3; ++run) {
+    MetaOptimizer optimizer(nullptr, config_proto);
+    GraphDef other_output;
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &other_output));
+    CompareGraphs(output, other_output);
+    EXPECT_EQ(output.library().DebugString(),
+              other_output.library().DebugString());
+  }
+}
+
 TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryPruneFunctionBody) {
   using test::function::NDef;
 
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/pin_to_host_optimizer.h"
 
+#include <functional>
+#include <numeric>
+
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/types.h"
@@ -25,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/grappler/utils/tpu.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 
@@ -36,6 +40,11 @@ namespace internal {
 // dynamically determined.
 constexpr int64 kTensorMaxSize = 64;
 
+// The cost of a copy between host and device memory on top of the size of the
+// copied tensor, in bytes. Copies of small tensors are dominated by their
+// latency.
+constexpr int64 kCopyOverheadBytes = 4096;
+
 // All the nodes that should be blacklisted and not swapped.
 bool IsBlacklisted(const NodeDef& node) {
   return
@@ -267,6 +276,81 @@ Status IsNodeHostCandidate(const GraphView& graph, GraphProperties* properties,
   return Status::OK();
 }
 
+// Checks if input (or output if `is_output`) port `port_id` of `node` is in
+// Host memory where `node` is placed. A node without a device is assumed to be
+// placed on GPU if it has a GPU kernel, and on CPU otherwise.
+bool IsNodePortOnHost(const NodeDef& node, int port_id, bool is_output) {
+  if (absl::StrContains(node.device(), DEVICE_CPU)) {
+    return true;
+  }
+  const OpDef* op = nullptr;
+  if (!OpRegistry::Global()->LookUpOpDef(node.op(), &op).ok()) {
+    return false;
+  }
+  const int arg_id = is_output ? OpOutputPortIdToArgId(node, *op, port_id)
+                               : OpInputPortIdToArgId(node, *op, port_id);
+  if (arg_id < 0) {
+    return false;
+  }
+  const KernelDef* kernel = nullptr;
+  if (!TryFindKernelDef({node.device().c_str(), DEVICE_GPU}, node, &kernel)
+           .ok()) {
+    return node.device().empty();
+  }
+  const string& arg_name =
+      is_output ? op->output_arg(arg_id).name() : op->input_arg(arg_id).name();
+  for (const string& host_memory_arg : kernel->host_memory_arg()) {
+    if (arg_name == host_memory_arg) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns the estimated cost, in bytes, of the copies between Host and device
+// memory on the edges into and out of `nodes`, given their current devices.
+int64 EstimateCopyCost(const GraphView& graph, GraphProperties* properties,
+                       const std::vector<NodeDef*>& nodes) {
+  const gtl::FlatSet<const NodeDef*> node_set(nodes.begin(), nodes.end());
+  int64 cost = 0;
+  auto add_edge_cost = [&](const GraphView::OutputPort& fanin,
+                           const GraphView::InputPort& fanout) {
+    if (fanin.node == nullptr ||
+        IsNodePortOnHost(*fanin.node, fanin.port_id, /*is_output=*/true) ==
+            IsNodePortOnHost(*fanout.node, fanout.port_id,
+                             /*is_output=*/false)) {
+      return;
+    }
+    int64 size = -1;
+    const auto& output_properties =
+        properties->GetOutputProperties(fanin.node->name());
+    if (fanin.port_id < output_properties.size()) {
+      const OpInfo::TensorProperties& prop = output_properties[fanin.port_id];
+      size = NumCoefficients(prop.shape()) * DataTypeSize(prop.dtype());
+    }
+    if (size < 0) {
+      size = kTensorMaxSize * sizeof(int64);
+    }
+    cost += kCopyOverheadBytes + size;
+  };
+  for (NodeDef* node : nodes) {
+    // Edges between `nodes` are visited once, from their consumer.
+    for (int i = 0; i < node->input_size(); ++i) {
+      const GraphView::InputPort fanout(node, i);
+      const GraphView::OutputPort fanin = graph.GetRegularFanin(fanout);
+      if (fanin.node == nullptr) break;
+      add_edge_cost(fanin, fanout);
+    }
+    for (const GraphView::InputPort& fanout :
+         graph.GetFanouts(*node, /*include_controlled_nodes=*/false)) {
+      if (node_set.find(fanout.node) == node_set.end()) {
+        add_edge_cost(graph.GetRegularFanin(fanout), fanout);
+      }
+    }
+  }
+  return cost;
+}
+
 // Tries to find a Host device from `devices`. Returns empty string if no
 // matching Host device is found.
 string TryFindHostDevice(const gtl::FlatSet<string>& devices,
@@ -323,6 +407,8 @@ Status PinToHostOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
 
   // All the Const nodes, and their original devices in topological order.
   std::vector<std::pair<NodeDef*, string>> const_nodes;
+  // All the swapped nodes, and their original devices in topological order.
+  std::vector<std::pair<NodeDef*, string>> swapped_nodes;
 
   for (auto& node : *optimized_graph->mutable_node()) {
     GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
@@ -340,11 +426,63 @@ Status PinToHostOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       if (IsConstant(node)) {
         const_nodes.emplace_back(&node, node.device());
       }
+      swapped_nodes.emplace_back(&node, node.device());
       VLOG(2) << "Moving node " << node.name() << " to device " << device;
       *node.mutable_device() = std::move(device);
     }
   }
 
+  // Group the swapped nodes into subgraphs connected by data edges. Each
+  // subgraph is kept on Host only if that does not increase the cost of the
+  // copies between Host and device memory on its edges.
+  std::vector<int> subgraph(swapped_nodes.size());
+  std::iota(subgraph.begin(), subgraph.end(), 0);
+  std::function<int(int)> find_subgraph = [&](int i) {
+    return subgraph[i] == i ? i : subgraph[i] = find_subgraph(subgraph[i]);
+  };
+  gtl::FlatMap<const NodeDef*, int> swapped_index;
+  for (int i = 0; i < swapped_nodes.size(); ++i) {
+    const NodeDef* node = swapped_nodes[i].first;
+    swapped_index[node] = i;
+    for (const GraphView::OutputPort& fanin :
+         graph.GetFanins(*node, /*include_controlling_nodes=*/false)) {
+      auto it = swapped_index.find(fanin.node);
+      if (it != swapped_index.end()) {
+        subgraph[find_subgraph(it->second)] = find_subgraph(i);
+      }
+    }
+  }
+  gtl::FlatMap<int, std::vector<int>> subgraphs;
+  for (int i = 0; i < swapped_nodes.size(); ++i) {
+    subgraphs[find_subgraph(i)].push_back(i);
+  }
+  for (const auto& it : subgraphs) {
+    GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+    std::vector<NodeDef*> nodes;
+    for (int i : it.second) {
+      nodes.push_back(swapped_nodes[i].first);
+    }
+    const int64 host_cost =
+        internal::EstimateCopyCost(graph, &properties, nodes);
+    std::vector<string> host_devices;
+    for (int i : it.second) {
+      host_devices.push_back(swapped_nodes[i].first->device());
+      swapped_nodes[i].first->set_device(swapped_nodes[i].second);
+    }
+    const int64 original_cost =
+        internal::EstimateCopyCost(graph, &properties, nodes);
+    if (host_cost <= original_cost) {
+      for (int j = 0; j < it.second.size(); ++j) {
+        nodes[j]->set_device(host_devices[j]);
+      }
+    } else {
+      VLOG(2) << "Swapping " << nodes.size() << " nodes starting with "
+              << nodes.front()->name()
+              << " back, as pinning them to Host costs " << host_cost
+              << " bytes of copies instead of " << original_cost;
+    }
+  }
+
   // Traverse all `const_nodes`, and map them back to GPU greedily.
   for (auto& it : const_nodes) {
     GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
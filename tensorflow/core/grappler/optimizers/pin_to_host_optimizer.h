@@ -33,9 +33,11 @@ string TryFindHostDevice(const gtl::FlatSet<string>& devices,
 // Optimize TensorFlow ops that should be swapped into the CPU to avoid
 // excessive cpu<->gpu memcpy/sync.
 //
-// TODO(williamchan): The current heuristic will swap any small integer Const to
-// CPU. This may cause a problem cpu->cpu->gpu wherein the original behaviour of
-// gpu->gpu->gpu may have been better/faster. We should probably fix this.
+// Small ops are swapped in topological order, so that whole subgraphs computing
+// small tensors (e.g. shape arithmetic) move to the CPU. A subgraph is then
+// swapped back if the copies on its edges, estimated from the sizes inferred
+// by GraphProperties, cost more than before, e.g. for cpu->cpu->gpu where the
+// original gpu->gpu->gpu needed no copy.
 class PinToHostOptimizer : public GraphOptimizer {
  public:
   PinToHostOptimizer() {}
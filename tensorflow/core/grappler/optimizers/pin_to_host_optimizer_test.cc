@@ -255,6 +255,33 @@ TEST_F(PinToHostOptimizerTest, Identity) {
   EXPECT_EQ(found, 5);
 }
 
+TEST_F(PinToHostOptimizerTest, NoSwapIfCopiesIncrease) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  // `a,b` are small and could be swapped, but then their result would have to
+  // be copied back to GPU for `d`, which is too big to be swapped. Since `a,b`
+  // need no copies on GPU, they should not be swapped.
+  Output a =
+      ops::Const(s.WithOpName("a").WithDevice("/device:GPU:0"), 1.0f, {2});
+  Output b = ops::Neg(s.WithOpName("b").WithDevice("/device:GPU:0"), a);
+  Output c = ops::Const(s.WithOpName("c").WithDevice("/device:GPU:0"), 1.0f,
+                        {1024, 2});
+  Output d = ops::Add(s.WithOpName("d").WithDevice("/device:GPU:0"), b, c);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  GraphDef output;
+  PinToHostOptimizer optimizer(RewriterConfig::ON);
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_EQ(node.device(), "/device:GPU:0");
+    ++found;
+  }
+  EXPECT_EQ(found, 4);
+}
+
 TEST_F(PinToHostOptimizerTest, PortIdToArgId) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output a = ops::Const(s.WithOpName("a"), 1, {1, 2, 3});
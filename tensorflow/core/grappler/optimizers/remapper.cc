@@ -15,9 +15,18 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 
+#include <map>
+#include <set>
+#include <tuple>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/grappler/graph_view.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
@@ -51,6 +60,15 @@ namespace grappler {
 //   (1) FusedBatchNorm + <Activation>
 //   (2) FusedBatchNorm + SideInput + <Activation>
 //
+// Chain of element-wise ops + ... -> _FusedElementwise (CPU only):
+//   (1) <Unary> | <Binary with a scalar or same-shape side input> + ...
+//       if the cost model predicts that the chain is memory bound.
+//
+// Independent element-wise ops of the same kind -> _FusedElementwiseN (GPU
+// only, enabled with TF_GPU_HORIZONTAL_FUSION=1):
+//   (1) N small <Unary> | <Binary with a scalar or same-shape side input>
+//       ops at the same depth of the graph, run in one kernel launch.
+//
 // Both Conv2D and MatMul implemented as Tensor contraction (on CPU), so all the
 // patterns are "ContractionWith...".
 namespace {
@@ -58,12 +76,24 @@ namespace {
 constexpr char kFusedConv2D[] = "_FusedConv2D";
 constexpr char kFusedMatMul[] = "_FusedMatMul";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
+constexpr char kFusedElementwise[] = "_FusedElementwise";
+constexpr char kFusedElementwiseN[] = "_FusedElementwiseN";
 
 constexpr char kDataFormat[] = "data_format";
 constexpr char kIsTraining[] = "is_training";
 
 constexpr int kMissingIndex = -1;
 
+// Element-wise chain is fused only if the predicted execution time of the
+// fused node is at most this fraction of the unfused chain execution time.
+constexpr double kMaxFusedElementwiseCostRatio = 0.9;
+
+// Only element-wise ops with at most this many output elements are fused
+// horizontally: larger ops already amortize their kernel launch.
+constexpr int64 kMaxHorizontalFusionElements = 1 << 14;
+// Maximum number of ops fused into one _FusedElementwiseN node.
+constexpr int kMaxHorizontalFusionSize = 64;
+
 struct RemapperContext {
   explicit RemapperContext(GrapplerItem* item, Status* status)
       : nodes_to_preserve(item->NodesToPreserve()),
@@ -75,6 +105,7 @@ struct RemapperContext {
   utils::MutableGraphView graph_view;
   GraphProperties graph_properties;
   bool inferred_graph_properties;
+  OpLevelCostEstimator cost_estimator;
 };
 
 // FusedBatchNorm that can be replaced with a cheaper set of primitives.
@@ -160,6 +191,16 @@ struct ContractionWithBatchNormAndActivation {
   float epsilon = 0.0;
 };
 
+// Chain of element-wise ops, where each op consumes the output of the previous
+// one. Ops are stored in evaluation order, the last op is the root.
+struct ElementwiseChain {
+  ElementwiseChain() = default;
+
+  std::vector<int> ops;
+  // Position of the side input of a binary op, or -1 for a unary op.
+  std::vector<int> arg_positions;
+};
+
 #ifdef INTEL_MKL
 // Contraction node followed by a BiasAdd and Add.
 struct ContractionWithBiasAddAndAdd {
@@ -843,6 +884,190 @@ bool FindFusedBatchNormEx(const RemapperContext& ctx, int node_index,
   return false;
 }
 
+// WARN: This should be consistent with the ops supported by the
+// _FusedElementwise kernel (see kernels/fused_elementwise_op.cc).
+bool IsFusableUnaryElementwise(const NodeDef& node) {
+  static const auto* fusable_ops = new absl::flat_hash_set<string>(
+      {"Abs", "Exp", "Log", "Neg", "Relu", "Relu6", "Rsqrt", "Sigmoid", "Sqrt",
+       "Square", "Tanh"});
+  return fusable_ops->contains(node.op());
+}
+
+bool IsFusableBinaryElementwise(const NodeDef& node) {
+  static const auto* fusable_ops = new absl::flat_hash_set<string>(
+      {"Add", "AddV2", "Maximum", "Minimum", "Mul", "RealDiv", "Sub"});
+  return fusable_ops->contains(node.op());
+}
+
+bool IsFusableElementwise(const NodeDef& node) {
+  return IsFusableUnaryElementwise(node) || IsFusableBinaryElementwise(node);
+}
+
+// Returns true if the node is an activation that will be fused into the
+// preceding contraction or FusedBatchNorm by one of the other patterns.
+bool IsFusableIntoProducer(const utils::MutableNodeView& node_view) {
+  if (!IsSupportedActivation(*node_view.node())) return false;
+  if (node_view.NumRegularFanins() < 1) return false;
+  const auto* producer = node_view.GetRegularFanin(0).node_view()->node();
+  return IsBiasAdd(*producer) || IsFusedBatchNorm(*producer);
+}
+
+bool FindElementwiseChain(const RemapperContext& ctx, int node_index,
+                          ElementwiseChain* matched) {
+  if (!ctx.inferred_graph_properties) return false;
+
+  const auto* root_view = ctx.graph_view.GetNode(node_index);
+  const auto* root_def = root_view->node();
+  const DataType dtype = GetDataTypeFromAttr(*root_def, "T");
+  if (dtype != DT_FLOAT && dtype != DT_DOUBLE) return false;
+
+  const std::vector<OpInfo::TensorProperties>& root_props =
+      ctx.graph_properties.GetOutputProperties(root_def->name());
+  if (root_props.empty()) return false;
+  // All ops in the chain must produce a tensor of this shape.
+  const TensorShapeProto& shape = root_props[0].shape();
+
+  // Returns true iff the node can be a part of the element-wise chain.
+  const auto is_chain_node = [&](const utils::MutableNodeView& node_view) {
+    const auto* node_def = node_view.node();
+    // TODO(lyandy): Forward controls for patterns with control dependencies.
+    return IsFusableElementwise(*node_def) && NodeIsOnCpu(node_def) &&
+           HasDataType(node_def, dtype) &&
+           !HasControlFaninOrFanout(node_view) &&
+           !IsFusableIntoProducer(node_view);
+  };
+
+  // Returns the input port that carries the output of the previous op in the
+  // chain, or -1 if the node inputs are not compatible with the fused kernel.
+  const auto find_chain_port =
+      [&](const utils::MutableNodeView& node_view) -> int {
+    const auto* node_def = node_view.node();
+    const std::vector<OpInfo::TensorProperties>& input_props =
+        ctx.graph_properties.GetInputProperties(node_def->name());
+    const int num_inputs = input_props.size();
+    if (num_inputs != node_view.NumRegularFanins()) return -1;
+
+    const auto is_chain_input = [&](int port) {
+      return ShapesSymbolicallyEqual(input_props[port].shape(), shape);
+    };
+
+    if (IsFusableUnaryElementwise(*node_def)) {
+      return num_inputs == 1 && is_chain_input(0) ? 0 : -1;
+    }
+
+    if (num_inputs != 2) return -1;
+    // Side input must be a scalar or have the same shape as the chain input.
+    const auto is_side_input = [&](int port) {
+      return Rank(input_props[port].shape()) == 0 || is_chain_input(port);
+    };
+    const auto can_extend = [&](int port) {
+      const auto* producer = node_view.GetRegularFanin(port).node_view();
+      return is_chain_node(*producer) && HasAtMostOneFanoutAtPort0(*producer);
+    };
+
+    const bool port0 = is_chain_input(0) && is_side_input(1);
+    const bool port1 = is_chain_input(1) && is_side_input(0);
+    if (port0 && port1) return can_extend(1) && !can_extend(0) ? 1 : 0;
+    if (port0) return 0;
+    if (port1) return 1;
+    return -1;
+  };
+
+  // The root may have any number of fanouts, because the fused node takes its
+  // name. All other ops in the chain must have a single consumer.
+  if (!is_chain_node(*root_view)) return false;
+
+  std::vector<int> ops;
+  std::vector<int> arg_positions;
+  const utils::MutableNodeView* node_view = root_view;
+  while (true) {
+    const int chain_port = find_chain_port(*node_view);
+    if (chain_port < 0) break;
+
+    ops.push_back(node_view->node_index());
+    arg_positions.push_back(
+        IsFusableUnaryElementwise(*node_view->node()) ? -1 : 1 - chain_port);
+
+    const auto& fanin = node_view->GetRegularFanin(chain_port);
+    const auto* producer = fanin.node_view();
+    if (fanin.index() != 0 || !is_chain_node(*producer) ||
+        !HasAtMostOneFanoutAtPort0(*producer) ||
+        IsInPreserveSet(ctx, producer->node())) {
+      break;
+    }
+    node_view = producer;
+  }
+
+  // Fusing a single op does not save any memory traffic.
+  if (ops.size() < 2) return false;
+
+  std::reverse(ops.begin(), ops.end());
+  std::reverse(arg_positions.begin(), arg_positions.end());
+  matched->ops = std::move(ops);
+  matched->arg_positions = std::move(arg_positions);
+  return true;
+}
+
+// Returns true if the cost model predicts that a fused node is faster than
+// the element-wise chain. Each op in the chain reads its inputs from and writes
+// its output to the main memory, while the fused node keeps the intermediate
+// results in cache, and has the compute cost of all the fused ops.
+bool IsElementwiseChainFusionProfitable(const RemapperContext& ctx,
+                                        const ElementwiseChain& matched) {
+  const GraphDef* graph = ctx.graph_view.graph();
+  const DeviceProperties device =
+      GetDeviceInfo(graph->node(matched.ops.back()).device());
+  if (device.type() != "CPU") return false;
+
+  double unfused_time = 0.0;
+  double fused_compute_time = 0.0;
+  int64 fused_io_bytes = 0;
+
+  for (int i = 0; i < matched.ops.size(); ++i) {
+    const NodeDef& node = graph->node(matched.ops[i]);
+    const std::vector<OpInfo::TensorProperties>& input_props =
+        ctx.graph_properties.GetInputProperties(node.name());
+    const std::vector<OpInfo::TensorProperties>& output_props =
+        ctx.graph_properties.GetOutputProperties(node.name());
+
+    OpContext op_context;
+    op_context.name = node.name();
+    op_context.device_name = node.device();
+    OpInfo& op_info = op_context.op_info;
+    op_info.set_op(node.op());
+    *op_info.mutable_attr() = node.attr();
+    *op_info.mutable_device() = device;
+    for (const auto& input : input_props) *op_info.add_inputs() = input;
+    for (const auto& output : output_props) *op_info.add_outputs() = output;
+
+    const Costs costs = ctx.cost_estimator.PredictCosts(op_context);
+    unfused_time += costs.compute_time.count() + costs.memory_time.count();
+    fused_compute_time += costs.compute_time.count();
+
+    const int arg_position = matched.arg_positions[i];
+    if (i == 0) {
+      const int chain_port = arg_position == -1 ? 0 : 1 - arg_position;
+      fused_io_bytes += CalculateTensorSize(input_props[chain_port]);
+    }
+    if (arg_position != -1) {
+      fused_io_bytes += CalculateTensorSize(input_props[arg_position]);
+    }
+    if (i == matched.ops.size() - 1) {
+      fused_io_bytes += CalculateTensorSize(output_props[0]);
+    }
+  }
+
+  const DeviceInfo device_info = ctx.cost_estimator.GetDeviceInfo(device);
+  const double fused_time =
+      fused_compute_time + std::ceil(fused_io_bytes / device_info.gb_per_sec);
+
+  VLOG(2) << "Element-wise chain of " << matched.ops.size()
+          << " ops: unfused_time=" << unfused_time
+          << "ns fused_time=" << fused_time << "ns";
+
+  return fused_time <= kMaxFusedElementwiseCostRatio * unfused_time;
+}
+
 void CopyConv2DAttributes(const NodeDef& conv2d, NodeDef* fused_conv2d) {
   DCHECK(IsConv2D(conv2d)) << "Input node must be a Conv2D";
 
@@ -1268,6 +1493,55 @@ Status AddFusedBatchNormExNode(RemapperContext* ctx,
   return Status::OK();
 }
 
+Status AddFusedElementwiseNode(RemapperContext* ctx,
+                               const ElementwiseChain& matched,
+                               std::vector<bool>* invalidated_nodes,
+                               std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& first = graph->node(matched.ops.front());
+  const NodeDef& root = graph->node(matched.ops.back());
+
+  NodeDef fused_op;
+  fused_op.set_name(root.name());
+  fused_op.set_op(kFusedElementwise);
+  fused_op.set_device(root.device());
+
+  const int first_arg_position = matched.arg_positions.front();
+  fused_op.add_input(
+      first.input(first_arg_position == -1 ? 0 : 1 - first_arg_position));
+
+  std::vector<string> fused_ops;
+  for (int i = 0; i < matched.ops.size(); ++i) {
+    const NodeDef& node = graph->node(matched.ops[i]);
+    fused_ops.push_back(node.op());
+    if (matched.arg_positions[i] != -1) {
+      fused_op.add_input(node.input(matched.arg_positions[i]));
+    }
+  }
+
+  VLOG(2) << "Fuse element-wise chain: ops=[" << absl::StrJoin(fused_ops, ", ")
+          << "] root=" << root.name() << " first=" << first.name();
+
+  auto* attrs = fused_op.mutable_attr();
+  (*attrs)["T"] = root.attr().at("T");
+  SetAttrValue(fused_op.input_size() - 1, &(*attrs)["num_args"]);
+  SetAttrValue(fused_ops, &(*attrs)["fused_ops"]);
+  SetAttrValue(matched.arg_positions, &(*attrs)["arg_positions"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.ops.back()] = true;
+  for (int i = 0; i < matched.ops.size() - 1; ++i) {
+    (*nodes_to_delete)[matched.ops[i]] = true;
+  }
+
+  return Status::OK();
+}
+
 Status AddBatchNormNodes(RemapperContext* ctx, const FusedBatchNorm& matched) {
   const GraphDef* graph = ctx->graph_view.graph();
   const NodeDef& fused_node = graph->node(matched.fused_batch_norm);
@@ -1455,6 +1729,7 @@ Status AddBatchNormNodes(RemapperContext* ctx, const FusedBatchNorm& matched) {
 // shapes:
 //   (1) Splitting FusedBatchNorm into primitives.
 //   (2) Fusing side input and/or activation into FusedBatchNorm.
+//   (3) Fusing a chain of element-wise ops.
 bool RequiresInferredShapes(const RemapperContext& ctx, int node_index) {
   // Candidate for a FusedBatchNorm splitting.
   const auto* node_view = ctx.graph_view.GetNode(node_index);
@@ -1500,7 +1775,183 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index) {
     return false;
   };
 
-  return is_batch_norm_candidate() || is_batch_norm_fusion_candidate();
+  // Candidate for an element-wise chain fusion.
+  const auto is_elementwise_chain_candidate = [&]() -> bool {
+    if (!IsFusableElementwise(*node_def) || !NodeIsOnCpu(node_def)) {
+      return false;
+    }
+    for (int i = 0; i < node_view->NumRegularFanins(); ++i) {
+      const auto* fanin_node_view = node_view->GetRegularFanin(i).node_view();
+      if (IsFusableElementwise(*fanin_node_view->node())) return true;
+    }
+    return false;
+  };
+
+  return is_batch_norm_candidate() || is_batch_norm_fusion_candidate() ||
+         is_elementwise_chain_candidate();
+}
+
+bool HorizontalElementwiseFusionEnabled() {
+  static bool is_enabled = [] {
+    bool is_enabled = false;
+    TF_CHECK_OK(tensorflow::ReadBoolFromEnvVar("TF_GPU_HORIZONTAL_FUSION",
+                                               /*default_val=*/false,
+                                               &is_enabled));
+    return is_enabled;
+  }();
+  return is_enabled;
+}
+
+// WARN: This should be consistent with the ops supported by the
+// _FusedElementwiseN kernel (see kernels/fused_elementwise_n_op.cc).
+bool IsHorizontallyFusableElementwise(const NodeDef& node) {
+  return IsFusableElementwise(node) && node.op() != "Relu6";
+}
+
+// Returns true if `node` is a small element-wise GPU op that can be computed by
+// a _FusedElementwiseN kernel together with other ops of the same kind.
+bool IsHorizontalFusionCandidate(const GraphProperties& properties,
+                                 const std::unordered_set<string>& preserve,
+                                 const NodeDef& node) {
+  if (!IsHorizontallyFusableElementwise(node) || !NodeIsOnGpu(&node)) {
+    return false;
+  }
+  if (preserve.count(node.name()) > 0) return false;
+  const DataType dtype = GetDataTypeFromAttr(node, "T");
+  if (dtype != DT_FLOAT && dtype != DT_DOUBLE) return false;
+
+  const auto& outputs = properties.GetOutputProperties(node.name());
+  const auto& inputs = properties.GetInputProperties(node.name());
+  const int num_inputs = IsFusableBinaryElementwise(node) ? 2 : 1;
+  if (outputs.size() != 1 || inputs.size() != static_cast<size_t>(num_inputs)) {
+    return false;
+  }
+
+  const TensorShapeProto& shape = outputs[0].shape();
+  if (!PartialTensorShape(shape).IsFullyDefined() ||
+      NumCoefficients(shape) > kMaxHorizontalFusionElements) {
+    return false;
+  }
+  // The first input must not be broadcast, and the second one is either a
+  // scalar or has the same shape.
+  if (!ShapesSymbolicallyEqual(inputs[0].shape(), shape)) return false;
+  if (num_inputs == 2 && Rank(inputs[1].shape()) != 0 &&
+      !ShapesSymbolicallyEqual(inputs[1].shape(), shape)) {
+    return false;
+  }
+  return true;
+}
+
+// Replaces groups of independent small element-wise GPU ops of the same kind
+// with _FusedElementwiseN nodes, so that each group runs in a single kernel
+// launch instead of one launch per op. Ops are independent if they are at the
+// same depth of the graph. Each fused op is replaced by an Identity of the
+// matching _FusedElementwiseN output, which keeps its fanouts intact.
+Status AddHorizontalElementwiseFusions(GrapplerItem* item,
+                                       bool assume_valid_feeds) {
+  GraphDef* graph = &item->graph;
+  for (const NodeDef& node : graph->node()) {
+    // Depth is not a safe independence criterion in loops.
+    if (IsControlFlow(node)) return Status::OK();
+  }
+
+  GraphProperties properties(*item);
+  TF_RETURN_IF_ERROR(properties.InferStatically(
+      assume_valid_feeds,
+      /*aggressive_shape_inference=*/false,
+      /*include_input_tensor_values=*/false,
+      /*include_output_tensor_values=*/false));
+
+  std::vector<const NodeDef*> topo_order;
+  TF_RETURN_IF_ERROR(ComputeTopologicalOrder(*graph, &topo_order));
+
+  // Nodes at the same depth can not depend on each other. Groups are keyed by
+  // (depth, op, dtype, device) and hold the names of their nodes.
+  using GroupKey = std::tuple<int, string, DataType, string>;
+  std::map<GroupKey, std::vector<string>> groups;
+  const std::unordered_set<string> preserve = item->NodesToPreserve();
+  absl::flat_hash_map<string, int> depth;
+  for (const NodeDef* node : topo_order) {
+    int node_depth = 0;
+    for (const string& input : node->input()) {
+      const auto it = depth.find(NodeName(input));
+      if (it != depth.end()) node_depth = std::max(node_depth, it->second + 1);
+    }
+    depth[node->name()] = node_depth;
+    if (IsHorizontalFusionCandidate(properties, preserve, *node)) {
+      groups[GroupKey(node_depth, node->op(), GetDataTypeFromAttr(*node, "T"),
+                      node->device())]
+          .push_back(node->name());
+    }
+  }
+
+  absl::flat_hash_map<string, NodeDef*> node_map;
+  for (NodeDef& node : *graph->mutable_node()) {
+    node_map[node.name()] = &node;
+  }
+
+  for (const auto& group : groups) {
+    const std::vector<string>& names = group.second;
+    const int num_names = names.size();
+    for (int begin = 0; begin < num_names; begin += kMaxHorizontalFusionSize) {
+      const int size = std::min(kMaxHorizontalFusionSize, num_names - begin);
+      if (size < 2) break;
+
+      std::vector<NodeDef*> members(size);
+      for (int k = 0; k < size; ++k) members[k] = node_map[names[begin + k]];
+      const NodeDef& first = *members[0];
+      const bool is_binary = IsFusableBinaryElementwise(first);
+
+      string fused_name =
+          strings::StrCat(first.name(), "/", kFusedElementwiseN);
+      while (node_map.count(fused_name) > 0) {
+        fused_name = strings::StrCat(fused_name, "_");
+      }
+      NodeDef fused;
+      fused.set_name(fused_name);
+      fused.set_op(kFusedElementwiseN);
+      fused.set_device(first.device());
+      // Inputs are all x, then all args, then the control inputs of all ops.
+      std::vector<string> args;
+      std::set<string> control_inputs;
+      for (const NodeDef* member : members) {
+        int regular_input = 0;
+        for (const string& input : member->input()) {
+          if (IsControlInput(input)) {
+            control_inputs.insert(input);
+          } else if (regular_input++ == 0) {
+            fused.add_input(input);
+          } else {
+            args.push_back(input);
+          }
+        }
+      }
+      for (const string& arg : args) fused.add_input(arg);
+      for (const string& input : control_inputs) fused.add_input(input);
+
+      auto* attr = fused.mutable_attr();
+      (*attr)["T"] = first.attr().at("T");
+      SetAttrValue(size, &(*attr)["N"]);
+      SetAttrValue(is_binary ? size : 0, &(*attr)["num_args"]);
+      SetAttrValue(first.op(), &(*attr)["fused_op"]);
+
+      for (int k = 0; k < size; ++k) {
+        NodeDef* member = members[k];
+        const AttrValue dtype = member->attr().at("T");
+        member->set_op("Identity");
+        member->clear_input();
+        member->add_input(strings::StrCat(fused_name, ":", k));
+        member->clear_attr();
+        (*member->mutable_attr())["T"] = dtype;
+      }
+
+      VLOG(2) << "Fuse " << size << " " << first.op() << " nodes into "
+              << fused_name;
+      node_map[fused_name] = graph->add_node();
+      *node_map[fused_name] = std::move(fused);
+    }
+  }
+  return Status::OK();
 }
 
 }  // namespace
@@ -1645,6 +2096,16 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       TF_RETURN_IF_ERROR(AddBatchNormNodes(&ctx, fused_batch_norm));
       continue;
     }
+
+    // Remap memory bound chain of element-wise ops into the _FusedElementwise.
+    ElementwiseChain elementwise_chain;
+    if (allow_non_differentiable_rewrites &&
+        FindElementwiseChain(ctx, i, &elementwise_chain) &&
+        IsElementwiseChainFusionProfitable(ctx, elementwise_chain)) {
+      TF_RETURN_IF_ERROR(AddFusedElementwiseNode(
+          &ctx, elementwise_chain, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
   }
 
   // Remove invalidated nodes.
@@ -1656,6 +2117,14 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
   }
   TF_RETURN_IF_ERROR(mutation->Apply());
 
+  // Fuse independent small element-wise GPU ops into the _FusedElementwiseN.
+  if (allow_non_differentiable_rewrites &&
+      HorizontalElementwiseFusionEnabled()) {
+    TF_RETURN_IF_ERROR(AddHorizontalElementwiseFusions(
+        &mutable_item,
+        /*assume_valid_feeds=*/opt_level_ == RewriterConfig::AGGRESSIVE));
+  }
+
   *optimized_graph = mutable_item.graph;
 
   return Status::OK();
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
 
 #if GOOGLE_CUDA
@@ -36,6 +37,8 @@ class RemapperTest : public GrapplerTest {
   void SetUp() override {
     // This is a requirement for fusing FusedBatchNorm + SideInput + Activation.
     setenv("TF_USE_CUDNN_BATCHNORM_SPATIAL_PERSISTENT", "1", 1 /* replace */);
+    // This is a requirement for fusing independent element-wise ops.
+    setenv("TF_GPU_HORIZONTAL_FUSION", "1", 1 /* replace */);
   }
 };
 
@@ -852,5 +855,151 @@ TEST_F(RemapperTest, FuseConv2DWithSqueezeAndBias) {
   test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
 }
 
+TEST_F(RemapperTest, FuseElementwiseChain) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto input_shape = ops::Placeholder::Shape({8, 64});
+
+  auto x = Placeholder(s.WithOpName("x"), DT_FLOAT, input_shape);
+  auto y = Placeholder(s.WithOpName("y"), DT_FLOAT, input_shape);
+  auto scale = ops::Const(s.WithOpName("scale"), 2.0f, {});
+
+  auto mul = ops::Mul(s.WithOpName("mul"), x, scale);
+  auto relu = ops::Relu(s.WithOpName("relu"), mul);
+  auto sub = ops::Sub(s.WithOpName("sub"), y, relu);
+  auto tanh = ops::Tanh(s.WithOpName("tanh"), sub);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), tanh);
+
+  auto x_t = GenerateRandomTensor<DT_FLOAT>({8, 64});
+  auto y_t = GenerateRandomTensor<DT_FLOAT>({8, 64});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"x", x_t}, {"y", y_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "mul");
+    EXPECT_NE(node.name(), "relu");
+    EXPECT_NE(node.name(), "sub");
+    if (node.name() == "tanh") {
+      EXPECT_EQ(node.op(), "_FusedElementwise");
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "x");
+      EXPECT_EQ(node.input(1), "scale");
+      EXPECT_EQ(node.input(2), "y");
+      EXPECT_EQ(node.attr().at("num_args").i(), 2);
+
+      const auto fused_ops = node.attr().at("fused_ops").list().s();
+      ASSERT_EQ(fused_ops.size(), 4);
+      EXPECT_EQ(fused_ops[0], "Mul");
+      EXPECT_EQ(fused_ops[1], "Relu");
+      EXPECT_EQ(fused_ops[2], "Sub");
+      EXPECT_EQ(fused_ops[3], "Tanh");
+
+      const auto arg_positions = node.attr().at("arg_positions").list().i();
+      ASSERT_EQ(arg_positions.size(), 4);
+      EXPECT_EQ(arg_positions[0], 1);
+      EXPECT_EQ(arg_positions[1], -1);
+      EXPECT_EQ(arg_positions[2], 0);
+      EXPECT_EQ(arg_positions[3], -1);
+      found++;
+    }
+  }
+  EXPECT_EQ(1, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
+TEST_F(RemapperTest, FuseIndependentElementwiseOps) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto scale = ops::Const(s.WithOpName("scale"), 2.0f, {});
+  std::vector<string> fetch;
+  for (int i = 0; i < 3; ++i) {
+    auto x = Placeholder(s.WithOpName(strings::StrCat("x", i)), DT_FLOAT,
+                         ops::Placeholder::Shape({4, i + 1}));
+    auto relu = ops::Relu(s.WithOpName(strings::StrCat("relu", i)), x);
+    auto mul = ops::Mul(s.WithOpName(strings::StrCat("mul", i)), relu, scale);
+    fetch.push_back(strings::StrCat("fetch", i));
+    ops::Identity(s.WithOpName(fetch.back()), mul);
+  }
+  // Too large to benefit from the fusion.
+  auto large = Placeholder(s.WithOpName("large"), DT_FLOAT,
+                           ops::Placeholder::Shape({1024, 1024}));
+  ops::Relu(s.WithOpName("large_relu"), large);
+
+  GrapplerItem item;
+  item.fetch = fetch;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on GPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:GPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "relu0/_FusedElementwiseN") {
+      EXPECT_EQ(node.op(), "_FusedElementwiseN");
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "x0");
+      EXPECT_EQ(node.input(1), "x1");
+      EXPECT_EQ(node.input(2), "x2");
+      EXPECT_EQ(node.attr().at("N").i(), 3);
+      EXPECT_EQ(node.attr().at("num_args").i(), 0);
+      EXPECT_EQ(node.attr().at("fused_op").s(), "Relu");
+      found++;
+    } else if (node.name() == "mul0/_FusedElementwiseN") {
+      EXPECT_EQ(node.op(), "_FusedElementwiseN");
+      ASSERT_EQ(node.input_size(), 6);
+      EXPECT_EQ(node.input(0), "relu0");
+      EXPECT_EQ(node.input(1), "relu1");
+      EXPECT_EQ(node.input(2), "relu2");
+      for (int i = 3; i < 6; ++i) EXPECT_EQ(node.input(i), "scale");
+      EXPECT_EQ(node.attr().at("N").i(), 3);
+      EXPECT_EQ(node.attr().at("num_args").i(), 3);
+      EXPECT_EQ(node.attr().at("fused_op").s(), "Mul");
+      found++;
+    } else if (node.name() == "relu1") {
+      EXPECT_EQ(node.op(), "Identity");
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "relu0/_FusedElementwiseN:1");
+      found++;
+    } else if (node.name() == "mul2") {
+      EXPECT_EQ(node.op(), "Identity");
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "mul0/_FusedElementwiseN:2");
+      found++;
+    } else if (node.name() == "large_relu") {
+      EXPECT_EQ(node.op(), "Relu");
+      found++;
+    }
+  }
+  EXPECT_EQ(5, found);
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
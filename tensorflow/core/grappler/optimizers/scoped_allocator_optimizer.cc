@@ -19,6 +19,8 @@ limitations under the License.
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -332,6 +334,61 @@ Status GetDataInputs(GraphDef* graph, NodeMap* node_map, NodeDef* op,
   return Status::OK();
 }
 
+// Build the ScopedAllocator node that will be assigned to allocate
+// the output tensors of inputs, one field for each input.
+Status ConstructScopedAllocatorNode(
+    ScopedAllocatorOptimizer* sa_opti, GraphDef* graph, NodeMap* node_map,
+    const string& device_name, DataType dtype, int sa_id,
+    const string& sa_name, const std::vector<TensorShape>& input_shapes,
+    const std::vector<InputDesc>& inputs, const TensorShape& sa_shape) {
+  VLOG(2) << "ConstructScopedAllocatorNode " << sa_name;
+  NodeDefBuilder sa_builder(sa_name, "_ScopedAllocator");
+  sa_builder.Device(device_name);
+  sa_builder.Attr("sa_name", sa_name);
+  sa_builder.Attr("T", dtype);
+  sa_builder.Attr("id", sa_id);
+  sa_builder.Attr("shapes", input_shapes);
+  sa_builder.Attr("shape", sa_shape);
+  sa_builder.Attr("expected_call_count", static_cast<int64>(inputs.size()));
+  NodeDef* sa_node = graph->add_node();
+  LOG_WARNING_AND_RETURN_IF_ERROR(sa_builder.Finalize(sa_node));
+  node_map->AddNode(sa_name, sa_node);
+
+  // Add control edges from the ScopedAllocatorOp to all of the
+  // input nodes and mark them for allocation from backing tensor.
+  for (int i = 0; i < inputs.size(); ++i) {
+    auto& nd = inputs[i];
+    VLOG(2) << "To input " << i << ": " << nd.from_node_def->name()
+            << " add control input "
+            << "^" << sa_name;
+    nd.from_node_def->add_input(strings::StrCat("^", sa_name));
+    // This attribute says: allocate output_slot from
+    // ScopedAllocator instance sa_id + 1 + i.
+    ScopedAllocatorOptimizer::ExtendNodeAttr(kScopedAllocatorAttrName,
+                                             {nd.output_slot, sa_id + 1 + i},
+                                             nd.from_node_def);
+    node_map->AddOutput(sa_name, nd.from_node_def->name());
+  }
+
+  // We add control edges in order to delay execution of the ScopedAllocatorOp
+  // until just before first use in order to conserve memory.
+  {
+    auto& nd = inputs[0];
+    std::vector<InputDesc> inputs_to_first;
+    LOG_WARNING_AND_RETURN_IF_ERROR(GetDataInputs(
+        graph, sa_opti->node_map(), nd.from_node_def, &inputs_to_first));
+    for (int i = 0; i < inputs_to_first.size(); ++i) {
+      sa_node->add_input(
+          strings::StrCat("^", inputs_to_first[i].from_node_def->name()));
+      VLOG(2) << "Adding control dependency from "
+              << inputs_to_first[i].from_node_def->name() << " to "
+              << sa_node->name();
+    }
+  }
+
+  return Status::OK();
+}
+
 void DumpGraphToVLOG(const GraphDef& graph, int log_level) {
   if (VLOG_IS_ON(log_level)) {
     // VLOG may truncate lines so we print line by line.
@@ -462,62 +519,6 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
     return Status::OK();
   }
 
-  // Build the ScopedAllocator node that will be assigned to allocate
-  // the output tensors of the input node set.
-  Status ConstructScopedAllocatorNode(
-      ScopedAllocatorOptimizer* sa_opti, GraphDef* graph, NodeMap* node_map,
-      const std::vector<NodeDef*>& ops, const string& device_name,
-      DataType dtype, int sa_id, const string& sa_name,
-      const std::vector<TensorShape>& input_shapes,
-      const std::vector<InputDesc>& inputs, const TensorShape& sa_shape) {
-    VLOG(2) << "ConstructScopedAllocatorNode " << sa_name;
-    NodeDefBuilder sa_builder(sa_name, "_ScopedAllocator");
-    sa_builder.Device(device_name);
-    sa_builder.Attr("sa_name", sa_name);
-    sa_builder.Attr("T", dtype);
-    sa_builder.Attr("id", sa_id);
-    sa_builder.Attr("shapes", input_shapes);
-    sa_builder.Attr("shape", sa_shape);
-    sa_builder.Attr("expected_call_count", static_cast<int64>(ops.size()));
-    NodeDef* sa_node = graph->add_node();
-    LOG_WARNING_AND_RETURN_IF_ERROR(sa_builder.Finalize(sa_node));
-    node_map->AddNode(sa_name, sa_node);
-
-    // Add control edges from the ScopedAllocatorOp to all of the
-    // input nodes and mark them for allocation from backing tensor.
-    for (int i = 0; i < inputs.size(); ++i) {
-      auto& nd = inputs[i];
-      VLOG(2) << "To input " << i << ": " << nd.from_node_def->name()
-              << " add control input "
-              << "^" << sa_name;
-      nd.from_node_def->add_input(strings::StrCat("^", sa_name));
-      // This attribute says: allocate output_slot from
-      // ScopedAllocator instance sa_id + 1 + i.
-      ScopedAllocatorOptimizer::ExtendNodeAttr(kScopedAllocatorAttrName,
-                                               {nd.output_slot, sa_id + 1 + i},
-                                               nd.from_node_def);
-      node_map->AddOutput(sa_name, nd.from_node_def->name());
-    }
-
-    // We add control edges in order to delay execution of the ScopedAllocatorOp
-    // until just before first use in order to conserve memory.
-    {
-      auto& nd = inputs[0];
-      std::vector<InputDesc> inputs_to_first;
-      LOG_WARNING_AND_RETURN_IF_ERROR(GetDataInputs(
-          graph, sa_opti->node_map(), nd.from_node_def, &inputs_to_first));
-      for (int i = 0; i < inputs_to_first.size(); ++i) {
-        sa_node->add_input(
-            strings::StrCat("^", inputs_to_first[i].from_node_def->name()));
-        VLOG(2) << "Adding control dependency from "
-                << inputs_to_first[i].from_node_def->name() << " to "
-                << sa_node->name();
-      }
-    }
-
-    return Status::OK();
-  }
-
   Status BuildSAConcatNode(GraphDef* graph, NodeMap* node_map,
                            const std::vector<NodeDef*>& ops,
                            const std::set<string>& op_instance_names,
@@ -770,7 +771,7 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
     string sa_name =
         strings::StrCat("scoped_allocator_", sa_id, "_", invocation_count);
     TF_RETURN_IF_ERROR(ConstructScopedAllocatorNode(
-        sa_opti, graph, node_map, ops, device_name, dtype, sa_id, sa_name,
+        sa_opti, graph, node_map, device_name, dtype, sa_id, sa_name,
         input_shapes, inputs, sa_shape));
 
     // Build a ScopedAllocatorConcat below all of the input nodes.
@@ -804,12 +805,274 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
   }
 };
 
+// Rewrites a ConcatV2 whose output is its inputs laid end to end in memory,
+// i.e. one along an axis with no dimension of size > 1 before it.  The
+// producers of its inputs allocate them from one ScopedAllocator, back to
+// back, and a _ScopedAllocatorConcat outputs the backing tensor in the shape
+// of the concatenation, so the concatenation copies nothing.  The ConcatV2
+// node itself becomes an Identity of the _ScopedAllocatorConcat, so that its
+// consumers and fetches are unchanged.
+//
+// Each input but the last must fill a whole number of allocator alignments,
+// since the ScopedAllocator pads its fields to them.  Each producer must be
+// on the same device, outside of any loop, and have the ConcatV2 as its only
+// consumer, so that nothing else can observe or modify its output in the
+// backing tensor.  ConcatV2 nodes that do not qualify are left as they are.
+class ConcatRewriter : public ScopedAllocatorOptimizer::Rewriter {
+ public:
+  ~ConcatRewriter() override {}
+
+  bool MergesNodes() const override { return false; }
+
+  Status Rewrite(ScopedAllocatorOptimizer* sa_opti, int64 invocation_count,
+                 GraphDef* graph, const string& op_name,
+                 const std::vector<NodeDef*>& ops, bool* applied) override {
+    for (NodeDef* op : ops) {
+      std::vector<InputDesc> inputs;
+      std::vector<TensorShape> input_shapes;
+      DataType dtype;
+      TensorShape output_shape;
+      Status s = AnalyzeConcat(sa_opti->node_map(), op, &inputs, &input_shapes,
+                               &dtype, &output_shape);
+      if (!s.ok()) {
+        VLOG(1) << "Not rewriting " << op->name() << ": " << s;
+        continue;
+      }
+      TF_RETURN_IF_ERROR(RewriteConcat(sa_opti, invocation_count, graph, op,
+                                       inputs, input_shapes, dtype,
+                                       output_shape));
+      *applied = true;
+    }
+    return Status::OK();
+  }
+
+ private:
+  // Returns OK if `op` can be rewritten, and then its data inputs other than
+  // the axis in `inputs`, their shapes in `input_shapes`, its type in `dtype`
+  // and the shape of its output in `output_shape`.  Does not modify the graph.
+  Status AnalyzeConcat(NodeMap* node_map, NodeDef* op,
+                       std::vector<InputDesc>* inputs,
+                       std::vector<TensorShape>* input_shapes, DataType* dtype,
+                       TensorShape* output_shape) {
+    int num_inputs;
+    TF_RETURN_IF_ERROR(GetNodeAttr(*op, "N", &num_inputs));
+    TF_RETURN_IF_ERROR(GetNodeAttr(*op, "T", dtype));
+    // int32 tensors are kept in host memory on GPUs, unlike the backing
+    // tensor.
+    if (!DataTypeCanUseMemcpy(*dtype) || *dtype == DT_INT32 ||
+        Allocator::kAllocatorAlignment % DataTypeSize(*dtype) != 0) {
+      return errors::Unimplemented("Unsupported type ",
+                                   DataTypeString(*dtype));
+    }
+    if (op->device().empty()) {
+      return errors::FailedPrecondition("Node is not placed");
+    }
+    if (!graph_properties_->HasInputProperties(op->name()) ||
+        !graph_properties_->HasOutputProperties(op->name())) {
+      return errors::FailedPrecondition("Node lacks shapes");
+    }
+    const auto& input_props = graph_properties_->GetInputProperties(op->name());
+    const auto& output_props =
+        graph_properties_->GetOutputProperties(op->name());
+    if (input_props.size() != num_inputs + 1 || output_props.size() != 1 ||
+        !TensorShape::IsValid(output_props[0].shape())) {
+      return errors::FailedPrecondition("Complete shape not known");
+    }
+    *output_shape = TensorShape(output_props[0].shape());
+    if (op->input_size() <= num_inputs) {
+      return errors::Internal("Node ", op->name(), " lacks its axis input");
+    }
+
+    // The concatenation is contiguous if there is no dimension of size > 1
+    // before the axis.
+    int64 axis;
+    TF_RETURN_IF_ERROR(GetConstantAxis(node_map, op->input(num_inputs), &axis));
+    const int rank = output_shape->dims();
+    if (axis < -rank || axis >= rank) {
+      return errors::InvalidArgument("Invalid axis ", axis);
+    }
+    if (axis < 0) axis += rank;
+    for (int d = 0; d < axis; ++d) {
+      if (output_shape->dim_size(d) > 1) {
+        return errors::Unimplemented("Concatenation along axis ", axis,
+                                     " is not contiguous");
+      }
+    }
+
+    std::set<string> seen_inputs;
+    for (int i = 0; i < num_inputs; ++i) {
+      const string& input_name = op->input(i);
+      if (IsControlInput(input_name) ||
+          !TensorShape::IsValid(input_props[i].shape())) {
+        return errors::FailedPrecondition("Complete shape not known for input ",
+                                          i);
+      }
+      const TensorShape shape(input_props[i].shape());
+      const int64 num_bytes = shape.num_elements() * DataTypeSize(*dtype);
+      if (num_bytes == 0 || (i < num_inputs - 1 &&
+                             num_bytes % Allocator::kAllocatorAlignment != 0)) {
+        return errors::Unimplemented("Input ", i, " of ", num_bytes,
+                                     " bytes would be padded");
+      }
+      int output_slot;
+      const string node_name = ParseNodeName(input_name, &output_slot);
+      if (!seen_inputs.insert(strings::StrCat(node_name, ":", output_slot))
+               .second) {
+        return errors::Unimplemented("Repeated input ", input_name);
+      }
+      NodeDef* from = node_map->GetNode(node_name);
+      if (from == nullptr) {
+        return errors::Internal("Did not find node ", input_name);
+      }
+      TF_RETURN_IF_ERROR(CheckProducer(node_map, *op, *from, output_slot));
+      input_shapes->push_back(shape);
+      inputs->emplace_back(from, output_slot, op);
+    }
+    return Status::OK();
+  }
+
+  // Returns the value of the constant scalar axis input `input_name`.
+  Status GetConstantAxis(NodeMap* node_map, const string& input_name,
+                         int64* axis) {
+    const NodeDef* axis_node = node_map->GetNode(input_name);
+    if (axis_node == nullptr || !IsConstant(*axis_node)) {
+      return errors::Unimplemented("Axis is not a constant");
+    }
+    Tensor axis_tensor;
+    if (!axis_tensor.FromProto(axis_node->attr().at("value").tensor()) ||
+        axis_tensor.NumElements() != 1) {
+      return errors::InvalidArgument("Invalid axis in ", axis_node->name());
+    }
+    if (axis_tensor.dtype() == DT_INT32) {
+      *axis = axis_tensor.flat<int32>()(0);
+    } else if (axis_tensor.dtype() == DT_INT64) {
+      *axis = axis_tensor.flat<int64>()(0);
+    } else {
+      return errors::InvalidArgument("Invalid axis type in ",
+                                     axis_node->name());
+    }
+    return Status::OK();
+  }
+
+  // Returns OK if output `output_slot` of `from` can be allocated from the
+  // ScopedAllocator of the concatenation `op`.
+  Status CheckProducer(NodeMap* node_map, const NodeDef& op,
+                       const NodeDef& from, int output_slot) {
+    if (from.device() != op.device()) {
+      return errors::Unimplemented("Input ", from.name(),
+                                   " is on another device");
+    }
+    if (IsControlFlow(from) || IsConstant(from)) {
+      return errors::Unimplemented("Input ", from.name(), " is a ", from.op());
+    }
+    const OpDef* op_def = nullptr;
+    TF_RETURN_IF_ERROR(OpRegistry::Global()->LookUpOpDef(from.op(), &op_def));
+    DataType output_type;
+    TF_RETURN_IF_ERROR(
+        OutputTypeForNode(from, *op_def, output_slot, &output_type));
+    if (IsRefType(output_type)) {
+      return errors::Unimplemented("Input ", from.name(), " is a reference");
+    }
+    for (const NodeDef* output : node_map->GetOutputs(from.name())) {
+      if (output != &op) {
+        return errors::Unimplemented("Input ", from.name(),
+                                     " has another consumer ", output->name());
+      }
+    }
+    std::vector<int32> scope_ids;
+    if (GetNodeAttr(from, kScopedAllocatorAttrName, &scope_ids).ok()) {
+      for (int i = 0; i + 1 < scope_ids.size(); i += 2) {
+        if (scope_ids[i] == output_slot) {
+          return errors::Unimplemented("Input ", from.name(), ":",
+                                       output_slot,
+                                       " is already scope allocated");
+        }
+      }
+    }
+    return Status::OK();
+  }
+
+  // Inserts the ScopedAllocator and the _ScopedAllocatorConcat of `op`, and
+  // turns `op` into an Identity of the latter.
+  Status RewriteConcat(ScopedAllocatorOptimizer* sa_opti,
+                       int64 invocation_count, GraphDef* graph, NodeDef* op,
+                       const std::vector<InputDesc>& inputs,
+                       const std::vector<TensorShape>& input_shapes,
+                       DataType dtype, const TensorShape& output_shape) {
+    VLOG(1) << "ConcatRewriter::Rewrite " << op->name();
+    NodeMap* node_map = sa_opti->node_map();
+    std::vector<ScopedAllocator::Field> sa_fields;
+    const int64 num_bytes = ScopedAllocatorMgr::PopulateFields(
+        0 /*scope_id*/, input_shapes, dtype, &sa_fields);
+    const TensorShape sa_shape({num_bytes / DataTypeSize(dtype)});
+
+    const int sa_id = sa_opti->NewScopedAllocatorId(input_shapes.size());
+    const string sa_name =
+        strings::StrCat("scoped_allocator_", sa_id, "_", invocation_count);
+    TF_RETURN_IF_ERROR(ConstructScopedAllocatorNode(
+        sa_opti, graph, node_map, op->device(), dtype, sa_id, sa_name,
+        input_shapes, inputs, sa_shape));
+
+    // The backing tensor may be longer than the concatenation by the padding
+    // of its last field, so the _ScopedAllocatorConcat reshapes a prefix of
+    // it.
+    const string sac_name = strings::StrCat("scoped_allocator_concat_", sa_id,
+                                            "_", invocation_count);
+    std::vector<NodeDefBuilder::NodeOut> sac_inputs;
+    std::vector<string> ctl_inputs;
+    for (const string& input_name : op->input()) {
+      const string node_name = NodeName(input_name);
+      node_map->RemoveOutput(node_name, op->name());
+      if (IsControlInput(input_name)) {
+        ctl_inputs.push_back(input_name);
+      }
+    }
+    for (const InputDesc& nd : inputs) {
+      sac_inputs.push_back(NodeDefBuilder::NodeOut(nd.from_node_def->name(),
+                                                   nd.output_slot, dtype));
+    }
+    NodeDefBuilder sac_builder(sac_name, "_ScopedAllocatorConcat");
+    sac_builder.Device(op->device());
+    sac_builder.Attr("sa_name", sa_name);
+    sac_builder.Attr("id", sa_id);
+    sac_builder.Attr("T", dtype);
+    sac_builder.Attr("shape", output_shape);
+    sac_builder.Attr("reshape", true);
+    sac_builder.Attr("N", static_cast<int>(sac_inputs.size()));
+    sac_builder.Input(NodeDefBuilder::NodeOut(sa_name, 0, dtype));
+    sac_builder.Input(sac_inputs);
+    NodeDef* sac_node = graph->add_node();
+    LOG_WARNING_AND_RETURN_IF_ERROR(sac_builder.Finalize(sac_node));
+    node_map->AddNode(sac_name, sac_node);
+    node_map->AddOutput(sa_name, sac_name);
+    for (const NodeDefBuilder::NodeOut& input : sac_inputs) {
+      node_map->AddOutput(input.node, sac_name);
+    }
+    for (const string& ctl_input : ctl_inputs) {
+      sac_node->add_input(ctl_input);
+      node_map->AddOutput(NodeName(ctl_input), sac_name);
+    }
+
+    // Keep the other attrs, e.g. the _scoped_allocator of another rewrite
+    // consuming op.
+    op->set_op("Identity");
+    op->clear_input();
+    op->add_input(sac_name);
+    op->mutable_attr()->erase("N");
+    op->mutable_attr()->erase("Tidx");
+    node_map->AddOutput(sac_name, op->name());
+    return Status::OK();
+  }
+};
+
 ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
     RewriterConfig::Toggle opt_level, const ScopedAllocatorOptions& opts)
     : opt_level_(opt_level) {
   VLOG(1) << "ScopedAllocatorOptimizer::ScopedAllocatorOptimizer";
   Rewriter* r = new UnaryElementwiseRewriter();
   to_delete_.push_back(r);
+  Rewriter* concat_rewriter = new ConcatRewriter();
+  to_delete_.push_back(concat_rewriter);
   if (opts.enable_op_size() == 0) {
     // Opts handled by default:
     for (const auto& op_name : {"CollectiveReduce"}) {
@@ -819,7 +1082,7 @@ ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
   } else {
     for (const auto& op_name : opts.enable_op()) {
       op_name_set_.insert(op_name);
-      rewriters_[op_name] = r;
+      rewriters_[op_name] = op_name == "ConcatV2" ? concat_rewriter : r;
     }
   }
 }
@@ -1025,6 +1288,28 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
           continue;
         }
         rewriter->SetGraphProperties(graph_properties);
+        if (!rewriter->MergesNodes()) {
+          // Rewrite each of the nodes outside of loops on its own.
+          std::vector<NodeDef*> nodes;
+          for (NodeDef* n : it.second) {
+            if (frame_view.Frames(*n).empty()) {
+              nodes.push_back(n);
+            }
+          }
+          if (!nodes.empty()) {
+            bool applied = false;
+            status = OrderNodeSet(&nodes);
+            if (status.ok()) {
+              VLOG(1) << "Applying Rewriter for " << op_name;
+              status = rewriter->Rewrite(this, invocation_count, graph,
+                                         op_name, nodes, &applied);
+            }
+          }
+          if (!status.ok()) {
+            break;
+          }
+          continue;
+        }
         std::unique_ptr<Tree> root(ComputeScopeTree(it.first, it.second));
         // Record outputs that are inputs to multiple Tree nodes.
         absl::flat_hash_set<string> seen_outputs;
@@ -96,6 +96,13 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
                            const std::vector<NodeDef*>& nodes,
                            bool* applied) = 0;
 
+    // Returns true if Rewrite replaces a set of logically parallel nodes by a
+    // single one, in which case it is applied to the sets of two or more nodes
+    // with a common name scope and loop structure.  Otherwise Rewrite
+    // rewrites each of the nodes on its own, and is applied to all of the
+    // nodes outside of loops.
+    virtual bool MergesNodes() const { return true; }
+
     void SetGraphProperties(const GraphProperties& graph_properties) {
       graph_properties_ = &graph_properties;
       CHECK(graph_properties_);
@@ -153,6 +153,40 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     TF_CHECK_OK(root_scope.ToGraphDef(graph_def));
   }
 
+  // Constructs the following graph.
+  //
+  // The intended optimization is to have s1 and s2 allocate from a new
+  // ScopedAllocator, back to back, and to replace the copy of concat by a
+  // ScopedAllocatorConcat of the backing buffer.  If extra_consumer is true,
+  // s2 is also an input to n, which prevents the optimization.
+  /*
+        a   b   c
+         \ /    |
+         s1    s2--(n)
+           \  /
+          concat
+            |
+            r
+  */
+  void BuildConcatGraph(GraphDef* graph_def, bool extra_consumer) {
+    Scope s = Scope::NewRootScope();
+    s = s.WithDevice("/job:localhost/replica:0/task:0/device:CPU:0");
+
+    Tensor a_values(DT_FLOAT, TensorShape({2, 8}));
+    for (int i = 0; i < 16; ++i) a_values.flat<float>()(i) = i;
+    Output a = ops::Const(s.WithOpName("a"), a_values);
+    Output b = ops::Const<float>(s.WithOpName("b"), 1.0f, {2, 8});
+    Output c = ops::Const<float>(s.WithOpName("c"), 2.0f, {1, 8});
+    Output s1 = ops::Add(s.WithOpName("s1"), a, b);
+    Output s2 = ops::Square(s.WithOpName("s2"), c);
+    if (extra_consumer) {
+      ops::Neg(s.WithOpName("n"), s2);
+    }
+    Output concat = ops::Concat(s.WithOpName("concat"), {s1, s2}, 0);
+    Output r = ops::Reshape(s.WithOpName("r"), concat, {24});
+    TF_CHECK_OK(s.ToGraphDef(graph_def));
+  }
+
   void SetShapes(GraphDef* graph_def) {
     TensorShapeProto shape_proto;
     shape_proto.add_dim()->set_size(2);
@@ -169,7 +203,8 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
   // returns the outputs specifed by `output_names` in `outputs`.
   void ExecuteGraph(const GraphDef& graph_def,
                     const std::vector<string>& output_names,
-                    std::vector<Tensor>* outputs) {
+                    std::vector<Tensor>* outputs,
+                    const string& enable_op = "Abs") {
     // Turn off all optimization except the ScopedAllocatorOptimizer
     // to avoid anything that would alter the expected graph input/output,
     // e.g. by constant folding away all calculations.
@@ -183,7 +218,7 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     RewriterConfig* rwcfg = gopt->mutable_rewrite_options();
     rwcfg->clear_optimizers();
     (*rwcfg->add_optimizers()) = "scoped_allocator";
-    rwcfg->mutable_scoped_allocator_opts()->add_enable_op("Abs");
+    rwcfg->mutable_scoped_allocator_opts()->add_enable_op(enable_op);
     std::unique_ptr<Session> session(CreateSession(graph_def, config));
 
     std::vector<std::pair<string, Tensor>> inputs;
@@ -324,6 +359,66 @@ TEST_F(ScopedAllocatorOptimizerTest, ForwardInputToOutput) {
   ValidateValues(outputs, /*expected=*/{{2, 2, 3, 3}, {4, 4, 3, 2}});
 }
 
+TEST_F(ScopedAllocatorOptimizerTest, ConcatRewriteOnly) {
+  GrapplerItem item;
+  BuildConcatGraph(&item.graph, /*extra_consumer=*/false);
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("ConcatV2");
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+  // concat is now an Identity of a ScopedAllocatorConcat of s1 and s2, which
+  // are allocated from the ScopedAllocator.
+  NodeMap node_map(&optimized_graph);
+  const NodeDef* concat = node_map.GetNode("concat");
+  ASSERT_TRUE(concat);
+  EXPECT_EQ("Identity", concat->op());
+  ASSERT_EQ(1, concat->input_size());
+  const NodeDef* sac = node_map.GetNode(concat->input(0));
+  ASSERT_TRUE(sac);
+  EXPECT_EQ("_ScopedAllocatorConcat", sac->op());
+  ASSERT_EQ(3, sac->input_size());
+  EXPECT_EQ("s1", sac->input(1));
+  EXPECT_EQ("s2", sac->input(2));
+  const NodeDef* sa = node_map.GetNode(sac->input(0));
+  ASSERT_TRUE(sa);
+  EXPECT_EQ("_ScopedAllocator", sa->op());
+  for (const string& name : {"s1", "s2"}) {
+    NodeDef* producer = node_map.GetNode(name);
+    EXPECT_TRUE(HasNodeAttr(*producer, "_scoped_allocator"));
+    EXPECT_EQ(1, node_map.GetOutputs(sa->name()).count(producer));
+  }
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, ConcatExecute) {
+  GraphDef graph_def;
+  BuildConcatGraph(&graph_def, /*extra_consumer=*/false);
+  std::vector<Tensor> outputs;
+  ExecuteGraph(graph_def, /*output_names=*/{"r:0"}, &outputs,
+               /*enable_op=*/"ConcatV2");
+  // a + b == 1, 2, ..., 16, followed by c * c == 4, ..., 4.
+  std::vector<float> expected(24, 4.0f);
+  for (int i = 0; i < 16; ++i) expected[i] = i + 1;
+  ValidateValues(outputs, {expected});
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, ConcatWithSharedInputNotRewritten) {
+  GrapplerItem item;
+  BuildConcatGraph(&item.graph, /*extra_consumer=*/true);
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("ConcatV2");
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+  NodeMap node_map(&optimized_graph);
+  EXPECT_EQ("ConcatV2", node_map.GetNode("concat")->op());
+  EXPECT_FALSE(HasNodeAttr(*node_map.GetNode("s1"), "_scoped_allocator"));
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
@@ -15,9 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/static_schedule.h"
 
+#include <algorithm>
 #include <deque>
+#include <unordered_set>
 
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/grappler/costs/virtual_placer.h"
@@ -199,5 +204,162 @@ Status EstimateRequiredTimes(
   return Status::OK();
 }
 
+namespace {
+
+// Returns "node:port" for the tensor named `tensor_name`, including port 0.
+string TensorKey(const string& tensor_name) {
+  const TensorId tensor = ParseTensorName(tensor_name);
+  return strings::StrCat(tensor.node(), ":", tensor.index());
+}
+
+bool BuffersOverlapInTime(const PlannedBuffer& a, const PlannedBuffer& b) {
+  return a.first_use <= b.last_use && b.first_use <= a.last_use;
+}
+
+// Assigns offsets to the buffers of a device, largest buffers first. Each
+// buffer goes to the smallest gap between the already placed buffers that are
+// live at the same time and that is big enough, or after all of them. This is
+// the greedy by size strategy of the TFLite arena planner.
+void AssignOffsets(DeviceMemoryPlan* plan) {
+  std::vector<PlannedBuffer>& buffers = plan->buffers;
+  std::sort(buffers.begin(), buffers.end(),
+            [](const PlannedBuffer& a, const PlannedBuffer& b) {
+              if (a.size != b.size) return a.size > b.size;
+              return a.first_use < b.first_use;
+            });
+  // Indices of the placed buffers, sorted by offset.
+  std::vector<int> placed;
+  for (int i = 0; i < buffers.size(); ++i) {
+    PlannedBuffer& buffer = buffers[i];
+    int64 best_offset = -1;
+    int64 best_gap = kint64max;
+    int64 current_offset = 0;
+    for (int j : placed) {
+      const PlannedBuffer& other = buffers[j];
+      if (!BuffersOverlapInTime(buffer, other)) continue;
+      const int64 gap = other.offset - current_offset;
+      if (gap >= buffer.size && gap < best_gap) {
+        best_offset = current_offset;
+        best_gap = gap;
+      }
+      current_offset = std::max(current_offset, other.offset + other.size);
+    }
+    buffer.offset = best_offset >= 0 ? best_offset : current_offset;
+    plan->arena_size = std::max(plan->arena_size, buffer.offset + buffer.size);
+    plan->total_buffer_size += buffer.size;
+    auto it = std::upper_bound(placed.begin(), placed.end(), i,
+                               [&buffers](int a, int b) {
+                                 return buffers[a].offset < buffers[b].offset;
+                               });
+    placed.insert(it, i);
+  }
+}
+
+}  // namespace
+
+Status ComputeStaticMemoryPlan(const GrapplerItem& item, const Cluster* cluster,
+                               StaticMemoryPlan* plan) {
+  for (const NodeDef& node : item.graph.node()) {
+    if (IsNextIteration(node)) {
+      return errors::InvalidArgument(
+          "Static memory plans aren't supported for graphs with loops: ",
+          node.name());
+    }
+  }
+
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> completion_times;
+  TF_RETURN_IF_ERROR(
+      EstimateEarliestExecutionTimes(item, cluster, &completion_times));
+  plan->schedule.clear();
+  for (const NodeDef& node : item.graph.node()) {
+    if (completion_times.find(&node) == completion_times.end()) {
+      return errors::InvalidArgument("Node ", node.name(),
+                                     " is never scheduled");
+    }
+    plan->schedule.push_back(&node);
+  }
+  std::stable_sort(plan->schedule.begin(), plan->schedule.end(),
+                   [&completion_times](const NodeDef* a, const NodeDef* b) {
+                     return completion_times[a] < completion_times[b];
+                   });
+  const int schedule_end = plan->schedule.size();
+  std::unordered_map<string, int> positions;
+  for (int i = 0; i < schedule_end; ++i) {
+    positions[plan->schedule[i]->name()] = i;
+  }
+
+  // The tensors stay live until their last consumer executes. Fetched tensors
+  // are returned to the caller, and stay live until the end of the step.
+  std::unordered_map<string, int> last_uses;
+  for (const NodeDef& node : item.graph.node()) {
+    for (const string& input : node.input()) {
+      if (IsControlInput(input)) continue;
+      int& last_use = last_uses[TensorKey(input)];
+      last_use = std::max(last_use, positions[node.name()]);
+    }
+  }
+  for (const string& fetch : item.fetch) {
+    last_uses[TensorKey(fetch)] = schedule_end;
+  }
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item.feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(
+      properties.InferStatically(/*assume_valid_feeds=*/true,
+                                 /*aggressive_shape_inference=*/false,
+                                 /*include_tensor_values=*/false));
+  VirtualPlacer placer(cluster->GetDevices());
+
+  plan->devices.clear();
+  plan->unplanned_tensors.clear();
+  for (int i = 0; i < schedule_end; ++i) {
+    const NodeDef* node = plan->schedule[i];
+    // These tensors outlive the step, or aren't allocated by the step.
+    if (IsConstant(*node) || IsVariable(*node) || IsPlaceholder(*node) ||
+        feeds.count(node->name()) > 0) {
+      continue;
+    }
+    const std::vector<OpInfo::TensorProperties>& outputs =
+        properties.GetOutputProperties(node->name());
+    DeviceMemoryPlan* device_plan = nullptr;
+    for (int port = 0; port < outputs.size(); ++port) {
+      const OpInfo::TensorProperties& output = outputs[port];
+      if (IsRefType(output.dtype())) continue;
+      const PartialTensorShape shape(output.shape());
+      const int64 element_size = DataTypeSize(output.dtype());
+      if (!shape.IsFullyDefined() || element_size == 0) {
+        plan->unplanned_tensors.emplace_back(node, port);
+        continue;
+      }
+      if (device_plan == nullptr) {
+        device_plan = &plan->devices[placer.get_canonical_device_name(*node)];
+      }
+      const int64 alignment = Allocator::kAllocatorAlignment;
+      PlannedBuffer buffer;
+      buffer.node = node;
+      buffer.port = port;
+      buffer.offset = 0;
+      buffer.size = (shape.num_elements() * element_size + alignment - 1) /
+                    alignment * alignment;
+      buffer.first_use = i;
+      auto it = last_uses.find(strings::StrCat(node->name(), ":", port));
+      buffer.last_use = it != last_uses.end() ? it->second : i;
+      device_plan->buffers.push_back(buffer);
+    }
+  }
+
+  for (auto& device_plan : plan->devices) {
+    AssignOffsets(&device_plan.second);
+    VLOG(1) << "Static memory plan for " << device_plan.first << ": "
+            << device_plan.second.buffers.size() << " buffers in an arena of "
+            << device_plan.second.arena_size << " bytes (instead of "
+            << device_plan.second.total_buffer_size << " bytes)";
+  }
+  return Status::OK();
+}
+
 }  // end namespace grappler
 }  // end namespace tensorflow
@@ -17,6 +17,8 @@ limitations under the License.
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_STATIC_SCHEDULE_H_
 
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
@@ -44,6 +46,48 @@ Status EstimateRequiredTimes(
         execution_times,
     std::unordered_map<const NodeDef*, Costs::NanoSeconds>* required_times);
 
+// The location of one node output in the arena of its device.
+struct PlannedBuffer {
+  const NodeDef* node;
+  int port;
+  // Offset from the start of the arena, in bytes.
+  int64 offset;
+  // Size of the buffer in bytes, rounded up to the allocator alignment.
+  int64 size;
+  // Positions in the schedule of the node producing the tensor and of its last
+  // consumer.
+  int first_use;
+  int last_use;
+};
+
+struct DeviceMemoryPlan {
+  // Size of the arena that holds all the planned buffers of the device.
+  int64 arena_size = 0;
+  // Size the buffers would take if none of them were reused.
+  int64 total_buffer_size = 0;
+  std::vector<PlannedBuffer> buffers;
+};
+
+// Static memory plan of a graph: every intermediate tensor of known size gets
+// a fixed offset in a single arena per device, and tensors whose lifetimes
+// don't overlap share memory.
+struct StaticMemoryPlan {
+  // The nodes in the order in which the plan assumes they execute.
+  std::vector<const NodeDef*> schedule;
+  // Plans keyed by canonical device name.
+  std::unordered_map<string, DeviceMemoryPlan> devices;
+  // Intermediate tensors that can't be planned statically (unknown size or
+  // data type without a fixed size) and must be allocated at run time.
+  std::vector<std::pair<const NodeDef*, int>> unplanned_tensors;
+};
+
+// Computes a static memory plan for the intermediate tensors of the graph, in
+// the execution order predicted by EstimateEarliestExecutionTimes. Constants,
+// variables, feeds and their outputs are not planned. Fetched tensors stay
+// live until the end of the step. Only graphs without loops are supported.
+Status ComputeStaticMemoryPlan(const GrapplerItem& item, const Cluster* cluster,
+                               StaticMemoryPlan* plan);
+
 }  // namespace grappler
 }  // end namespace tensorflow
 
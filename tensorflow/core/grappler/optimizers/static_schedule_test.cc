@@ -159,6 +159,54 @@ TEST_F(StaticScheduleTest, RequiredTimes) {
   }
 }
 
+TEST_F(StaticScheduleTest, StaticMemoryPlan) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {100, 100});
+  Output b = ops::Sqrt(s.WithOpName("b"), a);
+  Output c = ops::Sqrt(s.WithOpName("c"), b);
+  Output d = ops::Sqrt(s.WithOpName("d"), c);
+  Output e = ops::Sqrt(s.WithOpName("e"), d);
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT);
+  Output y = ops::Sqrt(s.WithOpName("y"), x);
+
+  GrapplerItem item;
+  item.fetch = {"e", "y"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+  StaticMemoryPlan plan;
+  TF_EXPECT_OK(ComputeStaticMemoryPlan(item, cluster.get(), &plan));
+
+  EXPECT_EQ(item.graph.node_size(), plan.schedule.size());
+  // The size of y is unknown.
+  ASSERT_EQ(1, plan.unplanned_tensors.size());
+  EXPECT_EQ("y", plan.unplanned_tensors[0].first->name());
+
+  ASSERT_EQ(1, plan.devices.size());
+  const DeviceMemoryPlan& device_plan = plan.devices.begin()->second;
+  ASSERT_EQ(4, device_plan.buffers.size());
+  // Each tensor only lives until its consumer runs, so two 40000 bytes
+  // buffers are enough for the whole chain.
+  EXPECT_EQ(4 * 40000, device_plan.total_buffer_size);
+  EXPECT_EQ(2 * 40000, device_plan.arena_size);
+
+  for (const PlannedBuffer& buffer : device_plan.buffers) {
+    EXPECT_EQ(40000, buffer.size);
+    if (buffer.node->name() == "e") {
+      EXPECT_EQ(plan.schedule.size(), buffer.last_use);
+    }
+    for (const PlannedBuffer& other : device_plan.buffers) {
+      if (&buffer == &other) continue;
+      const bool live_together = buffer.first_use <= other.last_use &&
+                                 other.first_use <= buffer.last_use;
+      const bool share_memory = buffer.offset < other.offset + other.size &&
+                                other.offset < buffer.offset + buffer.size;
+      EXPECT_FALSE(live_together && share_memory)
+          << buffer.node->name() << " and " << other.node->name();
+    }
+  }
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
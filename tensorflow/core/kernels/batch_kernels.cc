@@ -20,12 +20,15 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/batching_util/adaptive_shared_batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/periodic_function.h"
 #include "tensorflow/core/kernels/batching_util/shared_batch_scheduler.h"
 #include "tensorflow/core/kernels/concat_lib.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/kernels/split_lib.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/macros.h"
@@ -38,6 +41,28 @@ typedef Eigen::GpuDevice GPUDevice;
 typedef Eigen::SyclDevice SYCLDevice;
 #endif  // TENSORFLOW_USE_SYCL
 
+namespace {
+
+auto* batch_queueing_delay_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/serving/batching/queueing_delay_usecs",
+     "The time an input of a batching op waits in its queue before being "
+     "processed in a batch, in microseconds.",
+     "op"},
+    // Power of 2 with bucket count 24 (> 16 seconds)
+    {monitoring::Buckets::Exponential(1, 2, 24)});
+
+auto* batch_size = monitoring::Sampler<1>::New(
+    {"/tensorflow/serving/batching/batch_size",
+     "The number of inputs processed together by a batching op.", "op"},
+    // Power of 2 with bucket count 16 (> 32768)
+    {monitoring::Buckets::Exponential(1, 2, 16)});
+
+auto* batch_queue_depth = monitoring::Gauge<int64, 1>::New(
+    "/tensorflow/serving/batching/queue_depth",
+    "The number of inputs enqueued in the queue of a batching op.", "op");
+
+}  // namespace
+
 // Concatenates 'inputs' into a single tensor along the zeroth dimension.
 // Requires that all elements of 'inputs' have element type T. Writes to the
 // op's output at position 'output_index', using 'context' for the allocation to
@@ -214,22 +239,43 @@ class BatchResource : public ResourceBase {
   static Status Create(int32 num_batch_threads, int32 max_batch_size,
                        int32 batch_timeout_micros, int32 max_enqueued_batches,
                        const std::vector<int32>& allowed_batch_sizes,
+                       int64 target_p99_latency_micros,
+                       bool enable_ragged_batching,
                        FunctionLibraryRuntime::Handle fhandle,
                        std::unique_ptr<BatchResource>* resource) {
     std::unique_ptr<BatchResource> new_resource(new BatchResource);
 
-    Batcher::Options batcher_options;
-    batcher_options.num_batch_threads = num_batch_threads;
-    TF_RETURN_IF_ERROR(
-        Batcher::Create(batcher_options, &new_resource->batcher_));
+    if (target_p99_latency_micros > 0) {
+      // The adaptive scheduler treats the batch timeout and size as upper
+      // bounds, and tunes them to the latency target.
+      AdaptiveBatcher::Options batcher_options;
+      batcher_options.num_batch_threads = num_batch_threads;
+      batcher_options.initial_in_flight_batches_limit = num_batch_threads;
+      batcher_options.target_p99_latency_micros = target_p99_latency_micros;
+      TF_RETURN_IF_ERROR(AdaptiveBatcher::Create(
+          batcher_options, &new_resource->adaptive_batcher_));
+
+      new_resource->adaptive_batcher_queue_options_.max_batch_size =
+          max_batch_size;
+      new_resource->adaptive_batcher_queue_options_.max_enqueued_batches =
+          max_enqueued_batches;
+      new_resource->adaptive_batcher_queue_options_.batch_timeout_micros =
+          batch_timeout_micros;
+    } else {
+      Batcher::Options batcher_options;
+      batcher_options.num_batch_threads = num_batch_threads;
+      TF_RETURN_IF_ERROR(
+          Batcher::Create(batcher_options, &new_resource->batcher_));
 
-    new_resource->batcher_queue_options_.max_batch_size = max_batch_size;
-    new_resource->batcher_queue_options_.max_enqueued_batches =
-        max_enqueued_batches;
-    new_resource->batcher_queue_options_.batch_timeout_micros =
-        batch_timeout_micros;
+      new_resource->batcher_queue_options_.max_batch_size = max_batch_size;
+      new_resource->batcher_queue_options_.max_enqueued_batches =
+          max_enqueued_batches;
+      new_resource->batcher_queue_options_.batch_timeout_micros =
+          batch_timeout_micros;
+    }
 
     new_resource->allowed_batch_sizes_ = allowed_batch_sizes;
+    new_resource->enable_ragged_batching_ = enable_ragged_batching;
 
     new_resource->fhandle_ = fhandle;
 
@@ -273,11 +319,15 @@ class BatchResource : public ResourceBase {
     }
     batch_components->context = context;
     batch_components->done_callback = std::move(done_callback);
+    batch_components->enqueue_time_micros = Env::Default()->NowMicros();
 
     BatcherQueue* batcher_queue;
     TF_RETURN_IF_ERROR(
         LookupOrCreateBatcherQueue(batcher_queue_name, &batcher_queue));
-    return batcher_queue->Schedule(&batch_components);
+    TF_RETURN_IF_ERROR(batcher_queue->Schedule(&batch_components));
+    batch_queue_depth->GetCell(context->op_kernel().name())
+        ->Set(batcher_queue->NumEnqueuedTasks());
+    return Status::OK();
   }
 
  private:
@@ -295,10 +345,14 @@ class BatchResource : public ResourceBase {
     OpKernelContext* context;
     AsyncOpKernel::DoneCallback done_callback;
 
+    // When the input was enqueued, in microseconds.
+    uint64 enqueue_time_micros;
+
     size_t size() const override { return inputs[0].shape().dim_size(0); }
   };
 
   using Batcher = serving::SharedBatchScheduler<BatchTask>;
+  using AdaptiveBatcher = serving::AdaptiveSharedBatchScheduler<BatchTask>;
   using BatcherQueue = serving::BatchScheduler<BatchTask>;
   using Batch = serving::Batch<BatchTask>;
 
@@ -389,6 +443,12 @@ class BatchResource : public ResourceBase {
         }
       }
 
+      // A lone tensor is passed through as is, saving a copy.
+      if (to_concatenate.size() == 1) {
+        concatenated_tensors->push_back(to_concatenate[0]);
+        continue;
+      }
+
       const DataType type = to_concatenate[0].dtype();
       Status concat_status;
       Tensor concatenated_tensor;
@@ -411,6 +471,19 @@ class BatchResource : public ResourceBase {
     return Status::OK();
   }
 
+  // Returns the row splits of a ragged batch, i.e. the offsets of the tasks in
+  // the concatenated input tensors, followed by the total size.
+  static Tensor RowSplits(const Batch& batch) {
+    Tensor row_splits(DT_INT64, TensorShape({batch.num_tasks() + 1}));
+    auto row_splits_flat = row_splits.vec<int64>();
+    row_splits_flat(0) = 0;
+    for (int task_idx = 0; task_idx < batch.num_tasks(); ++task_idx) {
+      row_splits_flat(task_idx + 1) =
+          row_splits_flat(task_idx) + batch.task(task_idx).size();
+    }
+    return row_splits;
+  }
+
   Status SplitOutputTensors(const std::vector<Tensor>& combined_outputs,
                             Batch* batch) const {
     DCHECK_GE(batch->num_tasks(), 1);
@@ -430,6 +503,10 @@ class BatchResource : public ResourceBase {
       task_sizes_plus_optional_padding.push_back(padding_size);
     }
 
+    // With ragged batching, outputs may also have one row per task, e.g. when
+    // the function reduces over the sequence of each task.
+    const std::vector<int64> task_rows(batch->num_tasks(), 1);
+
     // For each output tensor name, a divided-up tensor with one entry per task.
     std::map<string, std::vector<Tensor>> split_tensors;
 
@@ -445,26 +522,31 @@ class BatchResource : public ResourceBase {
         return errors::FailedPrecondition(
             "Batched output tensor has 0 dimensions");
       }
-      if (output_tensor.shape().dim_size(0) != batch->size() + padding_size) {
+      const bool is_per_task_output =
+          enable_ragged_batching_ &&
+          output_tensor.shape().dim_size(0) == batch->num_tasks();
+      if (!is_per_task_output &&
+          output_tensor.shape().dim_size(0) != batch->size() + padding_size) {
         return errors::FailedPrecondition(
             "Batched output tensor's 0th dimension does not equal the sum of "
             "the 0th dimension sizes of the input tensors");
       }
+      const std::vector<int64>& split_sizes =
+          is_per_task_output ? task_rows : task_sizes_plus_optional_padding;
 
       std::vector<Tensor> split_tensor;
-      const Status split_status = tensor::Split(
-          output_tensor, task_sizes_plus_optional_padding, &split_tensor);
+      const Status split_status =
+          tensor::Split(output_tensor, split_sizes, &split_tensor);
       DCHECK(split_status.ok()) << split_status.ToString();
       if (!split_status.ok()) {
         return errors::Internal("Tensor split operation failed: ",
                                 split_status.ToString());
       }
-      DCHECK_EQ(split_tensor.size(), task_sizes_plus_optional_padding.size());
-      if (split_tensor.size() != task_sizes_plus_optional_padding.size()) {
+      DCHECK_EQ(split_tensor.size(), split_sizes.size());
+      if (split_tensor.size() != split_sizes.size()) {
         return errors::Internal(
             "Tensor split operation did not work as expected; got ",
-            split_tensor.size(), " splits; expected ",
-            task_sizes_plus_optional_padding.size());
+            split_tensor.size(), " splits; expected ", split_sizes.size());
       }
 
       for (int j = 0; j < batch->num_tasks(); ++j) {
@@ -477,10 +559,22 @@ class BatchResource : public ResourceBase {
     return Status::OK();
   }
 
+  // Records the metrics of a batch that starts being processed.
+  static void RecordBatchMetrics(const Batch& batch) {
+    const string& op = batch.task(0).context->op_kernel().name();
+    const uint64 now = Env::Default()->NowMicros();
+    auto* queueing_delay_cell = batch_queueing_delay_usecs->GetCell(op);
+    for (int i = 0; i < batch.num_tasks(); ++i) {
+      queueing_delay_cell->Add(now - batch.task(i).enqueue_time_micros);
+    }
+    batch_size->GetCell(op)->Add(batch.size());
+  }
+
   void ProcessFuncBatch(std::unique_ptr<Batch> batch) const {
     if (batch->empty()) {
       return;
     }
+    RecordBatchMetrics(*batch);
 
     // We use the 'propagated_context' from one of the threads which setup one
     // of the tasks. This will propagate any common context over all the threads
@@ -531,6 +625,9 @@ class BatchResource : public ResourceBase {
     Notification done;
     std::vector<Tensor> args(concatenated_tensors.begin(),
                              concatenated_tensors.end());
+    if (enable_ragged_batching_) {
+      args.push_back(RowSplits(*batch));
+    }
     const auto& captured_inputs =
         batch->task(batch->num_tasks() - 1).captured_inputs;
     args.insert(args.end(), captured_inputs.begin(), captured_inputs.end());
@@ -568,6 +665,7 @@ class BatchResource : public ResourceBase {
     if (batch->empty()) {
       return;
     }
+    RecordBatchMetrics(*batch);
 
     WithContext wc(batch->task(batch->num_tasks() - 1).propagated_context);
 
@@ -679,8 +777,14 @@ class BatchResource : public ResourceBase {
         ProcessFuncBatch(std::move(batch));
       }
     };
-    TF_RETURN_IF_ERROR(batcher_->AddQueue(batcher_queue_options_,
-                                          process_batch_callback, &new_queue));
+    if (adaptive_batcher_) {
+      TF_RETURN_IF_ERROR(adaptive_batcher_->AddQueue(
+          adaptive_batcher_queue_options_, process_batch_callback,
+          &new_queue));
+    } else {
+      TF_RETURN_IF_ERROR(batcher_->AddQueue(
+          batcher_queue_options_, process_batch_callback, &new_queue));
+    }
     *queue = new_queue.get();
     batcher_queues_[queue_name] = std::move(new_queue);
     return Status::OK();
@@ -690,6 +794,10 @@ class BatchResource : public ResourceBase {
   std::shared_ptr<Batcher> batcher_;
   Batcher::QueueOptions batcher_queue_options_;
 
+  // Used instead of batcher_ if a latency target is set.
+  std::shared_ptr<AdaptiveBatcher> adaptive_batcher_;
+  AdaptiveBatcher::QueueOptions adaptive_batcher_queue_options_;
+
   // A collection of batcher queues, keyed on queue name.
   // TODO(olston): Garbage-collect unused queues (perhaps simply remove empty
   // ones (with a time delay?); it's okay if they get recreated later).
@@ -698,6 +806,9 @@ class BatchResource : public ResourceBase {
       GUARDED_BY(batcher_queues_mu_);
 
   std::vector<int32> allowed_batch_sizes_;
+  // Whether the batched function takes the row splits of the concatenated
+  // inputs, instead of inputs padded to one of allowed_batch_sizes_.
+  bool enable_ragged_batching_ = false;
   FunctionLibraryRuntime::Handle fhandle_;
 };
 
@@ -720,6 +831,17 @@ class BatchFunctionKernel : public AsyncOpKernel {
                    c->GetAttr("max_enqueued_batches", &max_enqueued_batches_));
     OP_REQUIRES_OK(c, c->GetAttr("allowed_batch_sizes", &allowed_batch_sizes_));
     OP_REQUIRES_OK(c, ValidateAllowedBatchSizes());
+    OP_REQUIRES_OK(c, c->GetAttr("target_p99_latency_micros",
+                                 &target_p99_latency_micros_));
+    OP_REQUIRES(c, target_p99_latency_micros_ >= 0,
+                errors::InvalidArgument(
+                    "target_p99_latency_micros can't be negative; was ",
+                    target_p99_latency_micros_));
+    OP_REQUIRES_OK(c, c->GetAttr("enable_ragged_batching",
+                                 &enable_ragged_batching_));
+    OP_REQUIRES(c, !enable_ragged_batching_ || allowed_batch_sizes_.empty(),
+                errors::InvalidArgument("allowed_batch_sizes must be empty "
+                                        "when enable_ragged_batching is set"));
 
     auto lib = c->function_library();
     OP_REQUIRES(c, lib != nullptr, errors::Internal("No function library"));
@@ -738,7 +860,10 @@ class BatchFunctionKernel : public AsyncOpKernel {
       TF_RETURN_IF_ERROR(
           BatchResource::Create(num_batch_threads_, max_batch_size_,
                                 batch_timeout_micros_, max_enqueued_batches_,
-                                allowed_batch_sizes_, fhandle_, &new_resource));
+                                allowed_batch_sizes_,
+                                target_p99_latency_micros_,
+                                enable_ragged_batching_, fhandle_,
+                                &new_resource));
       *r = new_resource.release();
       return Status::OK();
     };
@@ -784,6 +909,8 @@ class BatchFunctionKernel : public AsyncOpKernel {
   int32 batch_timeout_micros_;
   int32 max_enqueued_batches_;
   std::vector<int32> allowed_batch_sizes_;
+  int64 target_p99_latency_micros_;
+  bool enable_ragged_batching_;
   FunctionLibraryRuntime::Handle fhandle_;
 };
 
@@ -817,8 +944,9 @@ class BatchKernel : public AsyncOpKernel {
       std::unique_ptr<BatchResource> new_resource;
       TF_RETURN_IF_ERROR(BatchResource::Create(
           num_batch_threads_, max_batch_size_, batch_timeout_micros_,
-          max_enqueued_batches_, allowed_batch_sizes_, kInvalidHandle,
-          &new_resource));
+          max_enqueued_batches_, allowed_batch_sizes_,
+          /*target_p99_latency_micros=*/0, /*enable_ragged_batching=*/false,
+          kInvalidHandle, &new_resource));
       *r = new_resource.release();
       return Status::OK();
     };
@@ -20,6 +20,7 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -31,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/framework/type_traits.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/fill_functor.h"
+#include "tensorflow/core/kernels/ruy_gemm.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/logging.h"
@@ -145,6 +147,49 @@ struct ParallelMatMulKernel<Scalar, false> {
   }
 };
 
+// Batch matmul kernel that runs the matrix multiplies one after another, each
+// on all the threads, with ruy. Run() returns false, and does nothing, for the
+// types ruy does not support.
+template <typename Scalar>
+struct RuyMatMulKernel {
+  static bool Run(const OpKernelContext* context, const Tensor& in_x,
+                  const Tensor& in_y, bool adj_x, bool adj_y,
+                  const MatMulBCast& bcast, Tensor* out) {
+    return false;
+  }
+};
+
+#ifdef TENSORFLOW_USE_RUY_GEMM
+template <>
+struct RuyMatMulKernel<float> {
+  static bool Run(const OpKernelContext* context, const Tensor& in_x,
+                  const Tensor& in_y, bool adj_x, bool adj_y,
+                  const MatMulBCast& bcast, Tensor* out) {
+    const int64 m = out->dim_size(1);
+    const int64 n = out->dim_size(2);
+    const int64 k = in_x.dim_size(adj_x ? 1 : 2);
+    if (std::max({m, n, k}) > kint32max) {
+      return false;
+    }
+    const int num_threads =
+        context->device()->tensorflow_cpu_worker_threads()->num_threads;
+    const bool should_bcast = bcast.IsBroadcastingRequired();
+    const auto& x_batch_indices = bcast.x_batch_indices();
+    const auto& y_batch_indices = bcast.y_batch_indices();
+    const float* x = in_x.flat<float>().data();
+    const float* y = in_y.flat<float>().data();
+    float* z = out->flat<float>().data();
+    for (int64 i = 0; i < bcast.output_batch_size(); ++i) {
+      const int64 x_batch_index = should_bcast ? x_batch_indices[i] : i;
+      const int64 y_batch_index = should_bcast ? y_batch_indices[i] : i;
+      RuyGemm(num_threads, adj_x, adj_y, m, n, k, x + x_batch_index * m * k,
+              y + y_batch_index * k * n, z + i * m * n);
+    }
+    return true;
+  }
+};
+#endif  // TENSORFLOW_USE_RUY_GEMM
+
 // Sequential batch matmul kernel that calls the regular Eigen matmul.
 // We prefer this over the tensor contraction because it performs
 // better on vector-matrix and matrix-vector products.
@@ -224,9 +269,12 @@ struct LaunchBatchMatMul<CPUDevice, Scalar> {
       // Parallelize over inner dims.
       // For large matrix products it is counter-productive to parallelize
       // over the batch dimension.
-      ParallelMatMulKernel::Run(context, in_x, in_y, adj_x, adj_y, bcast, out,
-                                0, batch_size);
-      conjugate_result = adj_x;
+      if (!RuyMatMulKernel<Scalar>::Run(context, in_x, in_y, adj_x, adj_y,
+                                        bcast, out)) {
+        ParallelMatMulKernel::Run(context, in_x, in_y, adj_x, adj_y, bcast,
+                                  out, 0, batch_size);
+        conjugate_result = adj_x;
+      }
     } else {
       // Parallelize over outer dims. For small matrices and large batches, it
       // is counter-productive to parallelize the inner matrix multiplies.
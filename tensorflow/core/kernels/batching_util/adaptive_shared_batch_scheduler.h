@@ -69,6 +69,13 @@ class ASBSQueue;
 // CPU utilization - If the batch processing is cpu dominated, you can reap
 //   latency gains when underutilized by increasing the processing rate, but
 //   back the rate off when the load increases to avoid overload.
+//
+// Optionally, ASBS can also target a 99th percentile latency (see
+// Options::target_p99_latency_micros). The batch timeout and maximum batch size
+// of the queues then become upper bounds, which are scaled down whenever the
+// observed tail latency exceeds the target, and back up while it is met. This
+// batches requests as much as the latency budget allows under load, while
+// limiting how long requests wait for a batch to fill when the load is light.
 
 template <typename TaskType>
 class AdaptiveSharedBatchScheduler
@@ -112,6 +119,13 @@ class AdaptiveSharedBatchScheduler
     // numbers will give less noisy latency measurements, but will be less
     // responsive to changes in workload.
     int64 batches_to_average_over = 1000;
+    // If positive, the 99th percentile latency (from batch creation to the end
+    // of its processing) to target. Every batches_to_average_over batches, the
+    // batch timeout and maximum batch size of all queues are scaled down
+    // multiplicatively if the target was missed, and up additively if it was
+    // met with some headroom. Since the scales are shared by all queues, this
+    // works best when the queues process batches of similar cost.
+    int64 target_p99_latency_micros = 0;
   };
 
   // Ownership is shared between the caller of Create() and any queues created
@@ -143,8 +157,22 @@ class AdaptiveSharedBatchScheduler
     return in_flight_batches_limit_;
   }
 
+  // Fraction of the configured batch timeout of the queues currently in use.
+  // Only tuned if Options::target_p99_latency_micros is set.
+  double batch_timeout_scale() {
+    mutex_lock l(mu_);
+    return batch_timeout_scale_;
+  }
+
+  // Fraction of the configured maximum batch size of the queues currently in
+  // use. Only tuned if Options::target_p99_latency_micros is set.
+  double batch_size_scale() {
+    mutex_lock l(mu_);
+    return batch_size_scale_;
+  }
+
  private:
-  // access to AddBatch, RemoveQueue, GetEnv.
+  // access to AddBatch, RemoveQueue, GetBatchLimits, GetEnv.
   friend class internal::ASBSQueue<TaskType>;
 
   explicit AdaptiveSharedBatchScheduler(const Options& options);
@@ -153,6 +181,16 @@ class AdaptiveSharedBatchScheduler
   void CallbackWrapper(const internal::ASBSBatch<TaskType>* batch,
                        BatchProcessor callback, bool is_express);
 
+  // Records the latency of a batch and its processing time, and adjusts the
+  // batch timeout and size scales once enough batches have been recorded.
+  void TuneForTargetLatency(int64 latency_micros, int64 processing_micros)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns the batch timeout and maximum size to use for the next batch of a
+  // queue created with 'options'.
+  void GetBatchLimits(const QueueOptions& options, int64* batch_timeout_micros,
+                      int* max_batch_size);
+
   // Schedules batch if in_flight_batches_limit_ is not met.
   void MaybeScheduleNextBatch() EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
@@ -219,6 +257,17 @@ class AdaptiveSharedBatchScheduler
   // Current adjustment size (as a fraction of in_flight_batches_limit_).
   double step_size_multiplier_ GUARDED_BY(mu_) = kMaxStepSizeMultiplier;
 
+  // Fields controlling the tuning for options_.target_p99_latency_micros.
+  // Latencies and processing times of the batches since the last adjustment.
+  std::vector<int64> recent_latencies_micros_ GUARDED_BY(mu_);
+  std::vector<int64> recent_processing_micros_ GUARDED_BY(mu_);
+  // Fractions of the configured batch timeout and maximum batch size in use.
+  double batch_timeout_scale_ GUARDED_BY(mu_) = 1.0;
+  double batch_size_scale_ GUARDED_BY(mu_) = 1.0;
+  // Scale increase when the target is met by at least kLatencyHeadroom.
+  constexpr static double kScaleIncrement = 0.125;  // 1/8
+  constexpr static double kLatencyHeadroom = 0.9;
+
   TF_DISALLOW_COPY_AND_ASSIGN(AdaptiveSharedBatchScheduler);
 };
 
@@ -301,6 +350,12 @@ constexpr double AdaptiveSharedBatchScheduler<TaskType>::kMaxStepSizeMultiplier;
 template <typename TaskType>
 constexpr double AdaptiveSharedBatchScheduler<TaskType>::kMinStepSizeMultiplier;
 
+template <typename TaskType>
+constexpr double AdaptiveSharedBatchScheduler<TaskType>::kScaleIncrement;
+
+template <typename TaskType>
+constexpr double AdaptiveSharedBatchScheduler<TaskType>::kLatencyHeadroom;
+
 template <typename TaskType>
 Status AdaptiveSharedBatchScheduler<TaskType>::Create(
     const Options& options,
@@ -344,6 +399,11 @@ Status AdaptiveSharedBatchScheduler<TaskType>::Create(
         "greater than or equal to 1; was ",
         options.batches_to_average_over);
   }
+  if (options.target_p99_latency_micros < 0) {
+    return errors::InvalidArgument(
+        "target_p99_latency_micros can't be negative; was ",
+        options.target_p99_latency_micros);
+  }
   scheduler->reset(new AdaptiveSharedBatchScheduler<TaskType>(options));
   return Status::OK();
 }
@@ -467,10 +527,15 @@ void AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper(
     AdaptiveSharedBatchScheduler<TaskType>::BatchProcessor callback,
     bool is_express) {
   int64 start_time = batch->creation_time_micros();
+  int64 processing_start_time = GetEnv()->NowMicros();
   callback(std::unique_ptr<Batch<TaskType>>(
       const_cast<internal::ASBSBatch<TaskType>*>(batch)));
   int64 end_time = GetEnv()->NowMicros();
   mutex_lock l(mu_);
+  if (options_.target_p99_latency_micros > 0) {
+    TuneForTargetLatency(end_time - start_time,
+                         end_time - processing_start_time);
+  }
   if (is_express) {
     in_flight_express_batches_--;
     MaybeScheduleClosedBatch();
@@ -518,6 +583,54 @@ void AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper(
   MaybeScheduleNextBatch();
 }
 
+template <typename TaskType>
+void AdaptiveSharedBatchScheduler<TaskType>::TuneForTargetLatency(
+    int64 latency_micros, int64 processing_micros) {
+  recent_latencies_micros_.push_back(latency_micros);
+  recent_processing_micros_.push_back(processing_micros);
+  if (static_cast<int64>(recent_latencies_micros_.size()) <
+      options_.batches_to_average_over) {
+    return;
+  }
+  auto p99 = [](std::vector<int64>* values) {
+    auto it = values->begin() + (values->size() * 99 - 1) / 100;
+    std::nth_element(values->begin(), it, values->end());
+    return *it;
+  };
+  const double target = options_.target_p99_latency_micros;
+  const int64 p99_latency = p99(&recent_latencies_micros_);
+  const int64 p99_processing = p99(&recent_processing_micros_);
+  if (p99_processing > target) {
+    // Batches miss the target even if they don't wait at all, so they must get
+    // smaller. Assume that processing time is roughly linear in batch size.
+    batch_size_scale_ *= std::max(0.5, target / p99_processing);
+    batch_timeout_scale_ *= 0.5;
+  } else if (p99_latency > target) {
+    // Requests wait too long for their batch to be scheduled.
+    batch_timeout_scale_ *= 0.5;
+  } else if (p99_latency < target * kLatencyHeadroom) {
+    // Spend some of the headroom on larger batches, favoring throughput.
+    batch_timeout_scale_ = std::min(1.0, batch_timeout_scale_ + kScaleIncrement);
+    batch_size_scale_ = std::min(1.0, batch_size_scale_ + kScaleIncrement);
+  }
+  recent_latencies_micros_.clear();
+  recent_processing_micros_.clear();
+}
+
+template <typename TaskType>
+void AdaptiveSharedBatchScheduler<TaskType>::GetBatchLimits(
+    const QueueOptions& options, int64* batch_timeout_micros,
+    int* max_batch_size) {
+  *batch_timeout_micros = options.batch_timeout_micros;
+  *max_batch_size = options.max_batch_size;
+  if (options_.target_p99_latency_micros <= 0) return;
+  mutex_lock l(mu_);
+  *batch_timeout_micros =
+      static_cast<int64>(options.batch_timeout_micros * batch_timeout_scale_);
+  *max_batch_size = std::max(
+      1, static_cast<int>(options.max_batch_size * batch_size_scale_));
+}
+
 // ---------------- ASBSQueue ----------------
 
 namespace internal {
@@ -552,12 +665,16 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
                                    " is larger than maximum batch size ",
                                    options_.max_batch_size);
   }
+  // Must be called outside of lock, since the scheduler lock is taken before
+  // the queue lock when releasing batches.
+  int64 batch_timeout_micros;
+  int max_batch_size;
+  scheduler_->GetBatchLimits(options_, &batch_timeout_micros, &max_batch_size);
   bool is_old_batch_closed = false;
   {
     mutex_lock l(mu_);
     // Current batch is full, create another if allowed.
-    if (current_batch_ &&
-        current_batch_->size() + size > options_.max_batch_size) {
+    if (current_batch_ && current_batch_->size() + size > max_batch_size) {
       if (num_enqueued_batches_ >= options_.max_enqueued_batches) {
         return errors::Unavailable("The batch scheduling queue is full");
       }
@@ -569,7 +686,7 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
       num_enqueued_batches_++;
       current_batch_ = new_batch =
           new ASBSBatch<TaskType>(this, scheduler_->GetEnv()->NowMicros(),
-                                  options_.batch_timeout_micros);
+                                  batch_timeout_micros);
     }
     current_batch_->AddTask(std::move(*task));
     num_enqueued_tasks_++;
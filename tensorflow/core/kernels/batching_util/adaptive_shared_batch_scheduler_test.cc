@@ -92,6 +92,9 @@ TEST(AdaptiveSharedBatchSchedulerTest, BadOptions) {
   options.min_in_flight_batches_limit = 2;
   options.num_batch_threads = 3;
   EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
+  options = Scheduler::Options();
+  options.target_p99_latency_micros = -1;
+  EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
 }
 
 TEST(AdaptiveSharedBatchSchedulerTest, InFlightBatchesLimit) {
@@ -192,6 +195,49 @@ TEST(AdaptiveSharedBatchSchedulerTest, InFlightBatchesLimitTuning) {
   stop_teardown.Notify();
 }
 
+TEST(AdaptiveSharedBatchSchedulerTest, TargetLatencyTuning) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+  {
+    AdaptiveSharedBatchScheduler<FakeTask>::Options options;
+    options.env = &env;
+    options.batches_to_average_over = 1;
+    options.target_p99_latency_micros = 100;
+    // Processing time is 100us per task.
+    auto queue_callback = [&env](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      env.AdvanceByMicroseconds(100 * batch->size());
+    };
+    std::shared_ptr<AdaptiveSharedBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(
+        AdaptiveSharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    std::unique_ptr<BatchScheduler<FakeTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue({}, queue_callback, &queue));
+
+    TF_ASSERT_OK(ScheduleTask(4, queue.get()));
+    while (scheduler->batch_size_scale() == 1.0) {
+    }
+    // Processing alone exceeded the target -> smaller batches, shorter wait.
+    EXPECT_DOUBLE_EQ(scheduler->batch_size_scale(), 0.5);
+    EXPECT_DOUBLE_EQ(scheduler->batch_timeout_scale(), 0.5);
+    TF_ASSERT_OK(ScheduleTask(0, queue.get()));
+    while (scheduler->batch_size_scale() == 0.5) {
+    }
+    // Target met with headroom -> grow again.
+    EXPECT_DOUBLE_EQ(scheduler->batch_size_scale(), 0.625);
+    EXPECT_DOUBLE_EQ(scheduler->batch_timeout_scale(), 0.625);
+    TF_ASSERT_OK(ScheduleTask(0, queue.get()));
+    while (scheduler->batch_size_scale() == 0.625) {
+    }
+    EXPECT_DOUBLE_EQ(scheduler->batch_size_scale(), 0.75);
+    EXPECT_DOUBLE_EQ(scheduler->batch_timeout_scale(), 0.75);
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
 TEST(AdaptiveSharedBatchSchedulerTest, FullBatchSchedulingBoostMicros) {
   test_util::FakeClockEnv env(Env::Default());
   Notification start_teardown, stop_teardown;
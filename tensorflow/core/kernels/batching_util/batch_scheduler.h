@@ -62,6 +62,14 @@ class BatchTask {
   // Returns the size of the task, in terms of how much it contributes to the
   // size of a batch. (A batch's size is the sum of its task sizes.)
   virtual size_t size() const = 0;
+
+  enum class Priority { kLow, kHigh };
+
+  // Returns the priority of the task. Schedulers that support priorities (see
+  // SharedBatchScheduler) only use low-priority tasks to fill the capacity of
+  // batches left over by high-priority tasks. Tasks are high-priority unless
+  // overridden.
+  virtual Priority priority() const { return Priority::kHigh; }
 };
 
 // A thread-safe collection of BatchTasks, to be executed together in some
@@ -93,6 +93,13 @@ namespace serving {
 // For bulk processing jobs and throughput-oriented benchmarks, you may want to
 // set the maximum queue size to a large value.
 //
+// Within a queue, tasks whose priority() is BatchTask::Priority::kLow are kept
+// in a separate lane. They are only added to a batch once it has been formed
+// from the high-priority tasks, filling the capacity they left over, or to an
+// otherwise empty batch once they have waited for the batch timeout. So bulk
+// traffic can share a queue with interactive traffic without delaying it. The
+// low-priority lane holds up to 'max_enqueued_batches' batches worth of tasks.
+//
 // TODO(b/26539183): Support queue servicing policies other than round-robin.
 // E.g. let each queue specify a "share" (an int >= 1), so e.g. with queues A
 // and B having shares 1 and 2 respectively, the servicing pattern is ABBABB...
@@ -220,7 +227,8 @@ namespace internal {
 //
 // Submitted tasks are added to the open batch. If that batch doesn't have room
 // but the queue isn't full, then that batch is closed and a new open batch is
-// started.
+// started. Low-priority tasks are instead added to 'low_priority_tasks_', from
+// which they are moved to the open batch right before it is closed.
 //
 // Batch pull requests are handled by dequeuing the front-most batch if it is
 // closed. If the front-most batch is open (i.e. the queue contains only one
@@ -279,10 +287,20 @@ class Queue {
   // Same as IsEmpty(), but assumes the caller already holds a lock on 'mu_'.
   bool IsEmptyInternal() const EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
-  // Closes the open batch residing at the back of 'batches_', and inserts a
-  // fresh open batch behind it.
+  // Fills the open batch residing at the back of 'batches_' with low-priority
+  // tasks as far as it has room, closes it, and inserts a fresh open batch
+  // behind it.
   void StartNewBatch() EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Adds a high-priority task to the open batch, starting a new batch if
+  // needed.
+  Status ScheduleHighPriorityTask(std::unique_ptr<TaskType>* task)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Adds a low-priority task to 'low_priority_tasks_'.
+  Status ScheduleLowPriorityTask(std::unique_ptr<TaskType>* task)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Determines whether the open batch residing at the back of 'batches_' is
   // currently schedulable.
   bool IsOpenBatchSchedulable() const EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -314,6 +332,14 @@ class Queue {
   // in 'batches_'. Valid iff that batch contains at least one task.
   uint64 open_batch_start_time_micros_ GUARDED_BY(mu_);
 
+  // The enqueued low-priority tasks, in order of arrival, along with the time
+  // at which they were enqueued.
+  std::deque<std::pair<uint64, std::unique_ptr<TaskType>>> low_priority_tasks_
+      GUARDED_BY(mu_);
+
+  // The sum of the sizes of the tasks in 'low_priority_tasks_'.
+  size_t low_priority_tasks_size_ GUARDED_BY(mu_) = 0;
+
   // Whether this queue contains a batch that is eligible to be scheduled. Used
   // to keep track of when to call 'schedulable_batch_callback_'.
   bool schedulable_batch_ GUARDED_BY(mu_) = false;
@@ -542,18 +568,9 @@ Status Queue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
 
     DCHECK(!closed_);
 
-    if (batches_.back()->size() + (*task)->size() > options_.max_batch_size) {
-      if (batches_.size() >= options_.max_enqueued_batches) {
-        return errors::Unavailable(
-            "The batch scheduling queue to which this task was submitted is "
-            "full");
-      }
-      StartNewBatch();
-    }
-    if (batches_.back()->empty()) {
-      open_batch_start_time_micros_ = env_->NowMicros();
-    }
-    batches_.back()->AddTask(std::move(*task));
+    TF_RETURN_IF_ERROR((*task)->priority() == BatchTask::Priority::kLow
+                           ? ScheduleLowPriorityTask(task)
+                           : ScheduleHighPriorityTask(task));
 
     if (!schedulable_batch_) {
       if (batches_.size() > 1 || IsOpenBatchSchedulable()) {
@@ -570,10 +587,42 @@ Status Queue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
   return Status::OK();
 }
 
+template <typename TaskType>
+Status Queue<TaskType>::ScheduleHighPriorityTask(
+    std::unique_ptr<TaskType>* task) {
+  if (batches_.back()->size() + (*task)->size() > options_.max_batch_size) {
+    if (batches_.size() >= options_.max_enqueued_batches) {
+      return errors::Unavailable(
+          "The batch scheduling queue to which this task was submitted is "
+          "full");
+    }
+    StartNewBatch();
+  }
+  if (batches_.back()->empty()) {
+    open_batch_start_time_micros_ = env_->NowMicros();
+  }
+  batches_.back()->AddTask(std::move(*task));
+  return Status::OK();
+}
+
+template <typename TaskType>
+Status Queue<TaskType>::ScheduleLowPriorityTask(
+    std::unique_ptr<TaskType>* task) {
+  if (low_priority_tasks_size_ + (*task)->size() >
+      options_.max_enqueued_batches * options_.max_batch_size) {
+    return errors::Unavailable(
+        "The low-priority lane of the batch scheduling queue to which this "
+        "task was submitted is full");
+  }
+  low_priority_tasks_size_ += (*task)->size();
+  low_priority_tasks_.emplace_back(env_->NowMicros(), std::move(*task));
+  return Status::OK();
+}
+
 template <typename TaskType>
 size_t Queue<TaskType>::NumEnqueuedTasks() const {
   mutex_lock l(mu_);
-  size_t num_enqueued_tasks = 0;
+  size_t num_enqueued_tasks = low_priority_tasks_.size();
   for (const auto& batch : batches_) {
     num_enqueued_tasks += batch->num_tasks();
   }
@@ -658,24 +707,38 @@ void Queue<TaskType>::CloseAndWaitUntilEmpty() {
 template <typename TaskType>
 bool Queue<TaskType>::IsEmptyInternal() const {
   return num_batches_being_processed_ == 0 && batches_.size() == 1 &&
-         batches_.back()->empty();
+         batches_.back()->empty() && low_priority_tasks_.empty();
 }
 
 template <typename TaskType>
 void Queue<TaskType>::StartNewBatch() {
-  batches_.back()->Close();
+  Batch<TaskType>* open_batch = batches_.back().get();
+  while (!low_priority_tasks_.empty() &&
+         open_batch->size() + low_priority_tasks_.front().second->size() <=
+             options_.max_batch_size) {
+    low_priority_tasks_size_ -= low_priority_tasks_.front().second->size();
+    open_batch->AddTask(std::move(low_priority_tasks_.front().second));
+    low_priority_tasks_.pop_front();
+  }
+  open_batch->Close();
   batches_.emplace_back(new Batch<TaskType>);
 }
 
 template <typename TaskType>
 bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   Batch<TaskType>* open_batch = batches_.back().get();
-  if (open_batch->empty()) {
+  if (open_batch->empty() && low_priority_tasks_.empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= options_.max_batch_size ||
-         env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+  if (closed_ || open_batch->size() >= options_.max_batch_size) {
+    return true;
+  }
+  // The timeout runs from the first high-priority task, if any, so that
+  // low-priority tasks don't cut high-priority batches short.
+  const uint64 start_time_micros = open_batch->empty()
+                                       ? low_priority_tasks_.front().first
+                                       : open_batch_start_time_micros_;
+  return env_->NowMicros() >= start_time_micros + options_.batch_timeout_micros;
 }
 
 template <typename TaskType>
@@ -28,22 +28,28 @@ namespace {
 
 class FakeTask : public BatchTask {
  public:
-  explicit FakeTask(size_t size) : size_(size) {}
+  explicit FakeTask(size_t size, Priority priority = Priority::kHigh)
+      : size_(size), priority_(priority) {}
 
   ~FakeTask() override = default;
 
   size_t size() const override { return size_; }
 
+  Priority priority() const override { return priority_; }
+
  private:
   const size_t size_;
+  const Priority priority_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(FakeTask);
 };
 
 // Creates a FakeTask of size 'task_size', and calls 'scheduler->Schedule()' on
 // that task. Returns the resulting status.
-Status ScheduleTask(size_t task_size, BatchScheduler<FakeTask>* scheduler) {
-  std::unique_ptr<FakeTask> task(new FakeTask(task_size));
+Status ScheduleTask(
+    size_t task_size, BatchScheduler<FakeTask>* scheduler,
+    BatchTask::Priority priority = BatchTask::Priority::kHigh) {
+  std::unique_ptr<FakeTask> task(new FakeTask(task_size, priority));
   Status status = scheduler->Schedule(&task);
   // Schedule() should have consumed 'task' iff it returned Status::OK.
   CHECK_EQ(status.ok(), task == nullptr);
@@ -186,6 +192,63 @@ TEST(SharedBatchSchedulerTest, ObeyBatchSizeConstraint) {
   EXPECT_EQ((std::vector<size_t>{3, 1, 6}), callback_data_b);
 }
 
+TEST(SharedBatchSchedulerTest, LowPriorityTasksFillLeftoverCapacity) {
+  // Set up a callback that captures the batches' task sizes.
+  mutex mu;
+  std::vector<std::vector<size_t>> callback_data;
+  auto callback = [&mu,
+                   &callback_data](std::unique_ptr<Batch<FakeTask>> batch) {
+    ASSERT_TRUE(batch->IsClosed());
+    std::vector<size_t> batch_data;
+    batch_data.reserve(batch->num_tasks());
+    for (int i = 0; i < batch->num_tasks(); ++i) {
+      batch_data.push_back(batch->mutable_task(i)->size());
+    }
+    {
+      mutex_lock l(mu);
+      callback_data.push_back(batch_data);
+    }
+  };
+
+  // Run a batch scheduler and inject some tasks.
+  {
+    SharedBatchScheduler<FakeTask>::Options options;
+    options.num_batch_threads = 1;
+    std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.max_batch_size = 10;
+    queue_options.batch_timeout_micros = 10 * 1000 * 1000;  // 10 seconds
+    queue_options.max_enqueued_batches = 2;
+    std::unique_ptr<BatchScheduler<FakeTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, callback, &queue));
+
+    // Low-priority tasks wait for high-priority ones, even if they arrive
+    // first.
+    TF_ASSERT_OK(ScheduleTask(4, queue.get(), BatchTask::Priority::kLow));
+    TF_ASSERT_OK(ScheduleTask(4, queue.get(), BatchTask::Priority::kLow));
+    TF_ASSERT_OK(ScheduleTask(3, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(5, queue.get()));
+    EXPECT_EQ(4, queue->NumEnqueuedTasks());
+
+    // Closes the first batch, which has no room left for low-priority tasks.
+    TF_ASSERT_OK(ScheduleTask(6, queue.get()));
+
+    // The low-priority lane holds up to two batches worth of tasks.
+    TF_ASSERT_OK(ScheduleTask(10, queue.get(), BatchTask::Priority::kLow));
+    EXPECT_FALSE(ScheduleTask(3, queue.get(), BatchTask::Priority::kLow).ok());
+
+    // Closing the queue fills the second batch with a low-priority task, and
+    // schedules the remaining ones in batches of their own.
+  }
+
+  ASSERT_EQ(4, callback_data.size());
+  EXPECT_EQ((std::vector<size_t>{3, 5}), callback_data[0]);
+  EXPECT_EQ((std::vector<size_t>{6, 4}), callback_data[1]);
+  EXPECT_EQ((std::vector<size_t>{4}), callback_data[2]);
+  EXPECT_EQ((std::vector<size_t>{10}), callback_data[3]);
+}
+
 TEST(SharedBatchSchedulerTest, ObeysTimeout) {
   // Set up a fake clock, which only advances when we explicitly tell it to.
   test_util::FakeClockEnv env(Env::Default());
@@ -0,0 +1,214 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/bfloat16_gemm.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+// The AVX512_BF16 code is compiled with a target attribute rather than with
+// -mavx512bf16 for the whole binary, so that the binary still runs on CPUs
+// without these instructions. CanUseNativeBFloat16Gemm checks the CPU at
+// runtime.
+#if defined(__x86_64__) &&                           \
+    ((defined(__clang__) && __clang_major__ >= 9) || \
+     (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 10))
+#define TF_BFLOAT16_GEMM_AVX512_BF16 1
+#include <immintrin.h>
+#endif
+
+namespace tensorflow {
+
+#ifdef TF_BFLOAT16_GEMM_AVX512_BF16
+
+namespace {
+
+#define TF_AVX512_BF16_TARGET __attribute__((target("avx512f,avx512bf16")))
+
+// Each dot product instruction multiplies 16 pairs of bfloat16 values of a row
+// of op(a) by 16 pairs of values of a column of op(b), one pair per float32
+// lane: a pair holds two consecutive elements along k, the first in the low
+// half of the lane.
+//
+// op(b) is packed into panels of kPanelCols columns, each the kPanelCols pairs
+// of every pair of rows of op(b) in turn, padded with zeros. Blocks of
+// kBlockRows rows of op(a) are packed as their pairs along k, row after row.
+constexpr int kPanelCols = 16;
+constexpr int kBlockRows = 8;
+
+inline uint32 MakePair(bfloat16 first, bfloat16 second) {
+  return static_cast<uint32>(first.value) |
+         (static_cast<uint32>(second.value) << 16);
+}
+
+// Accessors of op(a) and op(b), returning zero past the end of k so that an
+// odd k pads the last pair.
+struct OperandA {
+  const bfloat16* data;
+  bool transpose;
+  int m;
+  int k;
+  bfloat16 operator()(int row, int depth) const {
+    if (depth >= k) return bfloat16();
+    return transpose ? data[static_cast<int64>(depth) * m + row]
+                     : data[static_cast<int64>(row) * k + depth];
+  }
+};
+
+struct OperandB {
+  const bfloat16* data;
+  bool transpose;
+  int k;
+  int n;
+  bfloat16 operator()(int depth, int col) const {
+    if (depth >= k || col >= n) return bfloat16();
+    return transpose ? data[static_cast<int64>(col) * k + depth]
+                     : data[static_cast<int64>(depth) * n + col];
+  }
+};
+
+// Computes the rows [row, row + kRows) of c from the packed rows of op(a).
+template <int kRows>
+TF_AVX512_BF16_TARGET void ComputeRows(const uint32* packed_a,
+                                       const uint32* packed_b, int num_pairs,
+                                       int n, int row, bfloat16* c) {
+  const int num_panels = (n + kPanelCols - 1) / kPanelCols;
+  for (int panel = 0; panel < num_panels; ++panel) {
+    const uint32* panel_b = packed_b + panel * num_pairs * kPanelCols;
+    __m512 acc[kRows];
+    for (int r = 0; r < kRows; ++r) {
+      acc[r] = _mm512_setzero_ps();
+    }
+    for (int pair = 0; pair < num_pairs; ++pair) {
+      const __m512bh b_pairs =
+          (__m512bh)_mm512_loadu_si512(panel_b + pair * kPanelCols);
+      for (int r = 0; r < kRows; ++r) {
+        const __m512bh a_pair =
+            (__m512bh)_mm512_set1_epi32(packed_a[r * num_pairs + pair]);
+        acc[r] = _mm512_dpbf16_ps(acc[r], a_pair, b_pairs);
+      }
+    }
+    const int col = panel * kPanelCols;
+    const int num_cols = std::min(kPanelCols, n - col);
+    for (int r = 0; r < kRows; ++r) {
+      const __m256i result = (__m256i)_mm512_cvtneps_pbh(acc[r]);
+      bfloat16* dst = c + static_cast<int64>(row + r) * n + col;
+      if (num_cols == kPanelCols) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), result);
+      } else {
+        bfloat16 tail[kPanelCols];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(tail), result);
+        std::memcpy(dst, tail, num_cols * sizeof(bfloat16));
+      }
+    }
+  }
+}
+
+void ComputeBlock(int num_rows, const uint32* packed_a, const uint32* packed_b,
+                  int num_pairs, int n, int row, bfloat16* c) {
+  switch (num_rows) {
+#define TF_COMPUTE_ROWS_CASE(R)                               \
+  case R:                                                     \
+    ComputeRows<R>(packed_a, packed_b, num_pairs, n, row, c); \
+    break;
+    TF_COMPUTE_ROWS_CASE(1)
+    TF_COMPUTE_ROWS_CASE(2)
+    TF_COMPUTE_ROWS_CASE(3)
+    TF_COMPUTE_ROWS_CASE(4)
+    TF_COMPUTE_ROWS_CASE(5)
+    TF_COMPUTE_ROWS_CASE(6)
+    TF_COMPUTE_ROWS_CASE(7)
+    TF_COMPUTE_ROWS_CASE(8)
+#undef TF_COMPUTE_ROWS_CASE
+    default:
+      LOG(FATAL) << "Unexpected number of rows: " << num_rows;
+  }
+}
+
+#undef TF_AVX512_BF16_TARGET
+
+}  // namespace
+
+bool CanUseNativeBFloat16Gemm() {
+  static const bool can_use =
+      port::TestCPUFeature(port::CPUFeature::AVX512_BF16);
+  return can_use;
+}
+
+void NativeBFloat16Gemm(const DeviceBase::CpuWorkerThreads& workers,
+                        bool transpose_a, bool transpose_b, int m, int n,
+                        int k, const bfloat16* a, const bfloat16* b,
+                        bfloat16* c) {
+  DCHECK(CanUseNativeBFloat16Gemm());
+  const OperandA op_a{a, transpose_a, m, k};
+  const OperandB op_b{b, transpose_b, k, n};
+  const int num_pairs = (k + 1) / 2;
+  const int num_panels = (n + kPanelCols - 1) / kPanelCols;
+
+  std::vector<uint32> packed_b(static_cast<int64>(num_panels) * num_pairs *
+                               kPanelCols);
+  for (int panel = 0; panel < num_panels; ++panel) {
+    uint32* dst = packed_b.data() +
+                  static_cast<int64>(panel) * num_pairs * kPanelCols;
+    for (int pair = 0; pair < num_pairs; ++pair) {
+      for (int i = 0; i < kPanelCols; ++i) {
+        const int col = panel * kPanelCols + i;
+        *dst++ = MakePair(op_b(2 * pair, col), op_b(2 * pair + 1, col));
+      }
+    }
+  }
+
+  const int num_blocks = (m + kBlockRows - 1) / kBlockRows;
+  // About one dot product instruction per cycle.
+  const int64 cost_per_block =
+      static_cast<int64>(kBlockRows) * num_panels * num_pairs;
+  Shard(workers.num_threads, workers.workers, num_blocks, cost_per_block,
+        [&](int64 begin, int64 end) {
+          std::vector<uint32> packed_a(kBlockRows * num_pairs);
+          for (int64 block = begin; block < end; ++block) {
+            const int row = block * kBlockRows;
+            const int num_rows = std::min(kBlockRows, m - row);
+            uint32* dst = packed_a.data();
+            for (int r = 0; r < num_rows; ++r) {
+              for (int pair = 0; pair < num_pairs; ++pair) {
+                *dst++ = MakePair(op_a(row + r, 2 * pair),
+                                  op_a(row + r, 2 * pair + 1));
+              }
+            }
+            ComputeBlock(num_rows, packed_a.data(), packed_b.data(),
+                         num_pairs, n, row, c);
+          }
+        });
+}
+
+#else  // TF_BFLOAT16_GEMM_AVX512_BF16
+
+bool CanUseNativeBFloat16Gemm() { return false; }
+
+void NativeBFloat16Gemm(const DeviceBase::CpuWorkerThreads& workers,
+                        bool transpose_a, bool transpose_b, int m, int n,
+                        int k, const bfloat16* a, const bfloat16* b,
+                        bfloat16* c) {
+  LOG(FATAL) << "NativeBFloat16Gemm is not supported by this build";
+}
+
+#endif  // TF_BFLOAT16_GEMM_AVX512_BF16
+
+}  // namespace tensorflow
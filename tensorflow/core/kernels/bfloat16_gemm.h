@@ -0,0 +1,44 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BFLOAT16_GEMM_H_
+#define TENSORFLOW_CORE_KERNELS_BFLOAT16_GEMM_H_
+
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/platform/types.h"
+
+// Multiplies bfloat16 matrices on CPU with native bfloat16 dot products
+// (AVX512_BF16), which read the bfloat16 operands directly instead of first
+// converting them to float32, halving the memory traffic of the operands.
+
+namespace tensorflow {
+
+// Returns whether the CPU supports, and this binary was compiled with, the
+// instructions that NativeBFloat16Gemm needs.
+bool CanUseNativeBFloat16Gemm();
+
+// Computes c = op(a) * op(b) on the threads of `workers`, where op(a) is
+// m x k, op(b) is k x n, op(x) transposes x if `transpose_x`, and all the
+// matrices are row major. The products are accumulated in float32 and rounded
+// to bfloat16 once, at the end. Must only be called if
+// CanUseNativeBFloat16Gemm().
+void NativeBFloat16Gemm(const DeviceBase::CpuWorkerThreads& workers,
+                        bool transpose_a, bool transpose_b, int m, int n,
+                        int k, const bfloat16* a, const bfloat16* b,
+                        bfloat16* c);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BFLOAT16_GEMM_H_
@@ -0,0 +1,230 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/boosted_trees/flat_tree_ensemble.h"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+
+#include "tensorflow/core/kernels/boosted_trees/boosted_trees.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Number of examples that are stepped through a tree together. Large enough
+// that the loads for different examples overlap, small enough that their node
+// ids stay in registers or L1.
+constexpr int32 kBlockSize = 16;
+
+}  // namespace
+
+Status FlatTreeEnsemble::Create(
+    const boosted_trees::TreeEnsemble& ensemble, const int32 logits_dimension,
+    std::unique_ptr<FlatTreeEnsemble>* flat_ensemble) {
+  const int32 num_trees = ensemble.trees_size();
+  if (ensemble.tree_weights_size() < num_trees) {
+    return errors::InvalidArgument("Ensemble has ", num_trees,
+                                   " trees but only ",
+                                   ensemble.tree_weights_size(), " weights.");
+  }
+  std::unique_ptr<FlatTreeEnsemble> result(new FlatTreeEnsemble);
+  result->logits_dimension_ = logits_dimension;
+  result->tree_root_.reserve(num_trees);
+  result->tree_depth_.reserve(num_trees);
+
+  std::map<std::pair<int32, int32>, int32> column_ids;
+  // Proto node ids in breadth-first order, and the depth of each of them.
+  std::vector<int32> queue;
+  std::vector<int32> queue_depth;
+  // Maps proto node ids of the current tree to flat node ids.
+  std::vector<int32> flat_ids;
+  for (int32 tree_id = 0; tree_id < num_trees; ++tree_id) {
+    const auto& tree = ensemble.trees(tree_id);
+    const float tree_weight = ensemble.tree_weights(tree_id);
+    if (tree.nodes_size() == 0) {
+      return errors::InvalidArgument("Tree ", tree_id, " has no nodes.");
+    }
+    // Flat node ids of this tree are root + the position in the queue.
+    const int32 root = result->left_.size();
+    result->tree_root_.push_back(root);
+    flat_ids.assign(tree.nodes_size(), -1);
+    flat_ids[0] = root;
+    queue.assign(1, 0);
+    queue_depth.assign(1, 0);
+    int32 tree_depth = 0;
+    for (size_t position = 0; position < queue.size(); ++position) {
+      const int32 node_id = queue[position];
+      const auto& node = tree.nodes(node_id);
+      tree_depth = std::max(tree_depth, queue_depth[position]);
+
+      if (node.node_case() == boosted_trees::Node::kLeaf) {
+        const auto& leaf = node.leaf();
+        const int32 size = leaf.has_vector() ? leaf.vector().value_size() : 1;
+        if (size != logits_dimension) {
+          return errors::InvalidArgument(
+              "Leaf ", node_id, " of tree ", tree_id, " has ", size,
+              " values, expected logits_dimension = ", logits_dimension, ".");
+        }
+        result->column_.push_back(0);
+        result->threshold_.push_back(std::numeric_limits<int32>::max());
+        result->is_categorical_.push_back(0);
+        result->left_.push_back(root + position);
+        result->value_offset_.push_back(result->values_.size());
+        for (int32 i = 0; i < size; ++i) {
+          const float value =
+              leaf.has_vector() ? leaf.vector().value(i) : leaf.scalar();
+          result->values_.push_back(tree_weight * value);
+        }
+        continue;
+      }
+
+      int32 feature_id, dimension_id, threshold, left_id, right_id;
+      bool is_categorical;
+      switch (node.node_case()) {
+        case boosted_trees::Node::kBucketizedSplit: {
+          const auto& split = node.bucketized_split();
+          feature_id = split.feature_id();
+          dimension_id = split.dimension_id();
+          threshold = split.threshold();
+          left_id = split.left_id();
+          right_id = split.right_id();
+          is_categorical = false;
+          break;
+        }
+        case boosted_trees::Node::kCategoricalSplit: {
+          const auto& split = node.categorical_split();
+          feature_id = split.feature_id();
+          dimension_id = split.dimension_id();
+          threshold = split.value();
+          left_id = split.left_id();
+          right_id = split.right_id();
+          is_categorical = true;
+          break;
+        }
+        default:
+          return errors::InvalidArgument("Node ", node_id, " of tree ",
+                                         tree_id, " has unsupported type ",
+                                         node.node_case(), ".");
+      }
+      if (feature_id < 0 || dimension_id < 0) {
+        return errors::InvalidArgument("Node ", node_id, " of tree ", tree_id,
+                                       " splits on feature ", feature_id,
+                                       " dimension ", dimension_id, ".");
+      }
+      for (const int32 child_id : {left_id, right_id}) {
+        if (child_id < 0 || child_id >= tree.nodes_size() ||
+            flat_ids[child_id] != -1) {
+          return errors::InvalidArgument("Node ", node_id, " of tree ",
+                                         tree_id, " has invalid child ",
+                                         child_id, ".");
+        }
+        flat_ids[child_id] = root + queue.size();
+        queue.push_back(child_id);
+        queue_depth.push_back(queue_depth[position] + 1);
+      }
+
+      const auto column_key = std::make_pair(feature_id, dimension_id);
+      auto column_it = column_ids.find(column_key);
+      if (column_it == column_ids.end()) {
+        column_it =
+            column_ids.emplace(column_key, result->columns_.size()).first;
+        result->columns_.push_back(column_key);
+      }
+      result->column_.push_back(column_it->second);
+      result->threshold_.push_back(threshold);
+      result->is_categorical_.push_back(is_categorical);
+      result->left_.push_back(flat_ids[left_id]);
+      result->value_offset_.push_back(0);
+    }
+    result->tree_depth_.push_back(tree_depth);
+  }
+  *flat_ensemble = std::move(result);
+  return Status::OK();
+}
+
+Status FlatTreeEnsemble::ValidateFeatures(
+    const std::vector<TTypes<int32>::ConstMatrix>& bucketized_features,
+    const int32 batch_size) const {
+  for (const auto& column : columns_) {
+    if (static_cast<size_t>(column.first) >= bucketized_features.size()) {
+      return errors::InvalidArgument(
+          "The ensemble splits on feature ", column.first, " but only ",
+          bucketized_features.size(), " bucketized features were given.");
+    }
+    const auto& feature = bucketized_features[column.first];
+    if (feature.dimension(0) != batch_size) {
+      return errors::InvalidArgument("Bucketized feature ", column.first,
+                                     " has ", feature.dimension(0),
+                                     " rows, expected ", batch_size, ".");
+    }
+    if (column.second >= feature.dimension(1)) {
+      return errors::InvalidArgument(
+          "The ensemble splits on dimension ", column.second, " of feature ",
+          column.first, " which only has ", feature.dimension(1),
+          " dimensions.");
+    }
+  }
+  return Status::OK();
+}
+
+void FlatTreeEnsemble::Predict(
+    const std::vector<TTypes<int32>::ConstMatrix>& bucketized_features,
+    const int32 example_start, const int32 example_end, const int32 tree_start,
+    const int32 tree_end, float* logits) const {
+  std::vector<const int32*> column_data(columns_.size());
+  std::vector<int64> column_stride(columns_.size());
+  for (size_t i = 0; i < columns_.size(); ++i) {
+    const auto& feature = bucketized_features[columns_[i].first];
+    column_data[i] = feature.data() + columns_[i].second;
+    column_stride[i] = feature.dimension(1);
+  }
+
+  int32 nodes[kBlockSize];
+  for (int32 block_start = example_start; block_start < example_end;
+       block_start += kBlockSize) {
+    const int32 block_size = std::min(kBlockSize, example_end - block_start);
+    for (int32 tree_id = tree_start; tree_id < tree_end; ++tree_id) {
+      std::fill_n(nodes, block_size, tree_root_[tree_id]);
+      // Examples that reach a leaf early stay on it, so after depth steps
+      // every example of the block is on its leaf.
+      for (int32 depth = 0; depth < tree_depth_[tree_id]; ++depth) {
+        for (int32 k = 0; k < block_size; ++k) {
+          const int32 node = nodes[k];
+          const int32 column = column_[node];
+          const int32 value =
+              column_data[column][static_cast<int64>(block_start + k) *
+                                  column_stride[column]];
+          const int32 threshold = threshold_[node];
+          const bool go_right =
+              is_categorical_[node] ? value != threshold : value > threshold;
+          nodes[k] = left_[node] + go_right;
+        }
+      }
+      for (int32 k = 0; k < block_size; ++k) {
+        const float* leaf_values = values_.data() + value_offset_[nodes[k]];
+        float* example_logits =
+            logits + static_cast<int64>(block_start + k) * logits_dimension_;
+        for (int32 j = 0; j < logits_dimension_; ++j) {
+          example_logits[j] += leaf_values[j];
+        }
+      }
+    }
+  }
+}
+
+}  // namespace tensorflow
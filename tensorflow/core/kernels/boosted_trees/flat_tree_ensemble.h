@@ -0,0 +1,102 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BOOSTED_TREES_FLAT_TREE_ENSEMBLE_H_
+#define TENSORFLOW_CORE_KERNELS_BOOSTED_TREES_FLAT_TREE_ENSEMBLE_H_
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Forward declaration for proto class TreeEnsemble
+namespace boosted_trees {
+class TreeEnsemble;
+}  // namespace boosted_trees
+
+// A read-only copy of a tree ensemble laid out for batched inference.
+//
+// Walking the TreeEnsemble proto costs several dependent loads and a switch on
+// the node type for every visited node. Here the nodes of all trees are stored
+// in parallel arrays instead, renumbered breadth first so that the top levels
+// of each tree are contiguous and the two children of a split are adjacent.
+// Leaves are encoded as splits that always lead back to themselves, so every
+// example can be advanced through a tree for a fixed number of steps (the
+// depth of the tree) without checking whether it already reached a leaf. That
+// lets Predict() step a whole block of examples through a level at once.
+class FlatTreeEnsemble {
+ public:
+  // Compiles `ensemble`, whose leaves must hold `logits_dimension` values.
+  // Returns an error if the ensemble uses split types that inference doesn't
+  // support or isn't a valid set of trees.
+  static Status Create(const boosted_trees::TreeEnsemble& ensemble,
+                       const int32 logits_dimension,
+                       std::unique_ptr<FlatTreeEnsemble>* flat_ensemble);
+
+  int32 num_trees() const { return tree_root_.size(); }
+
+  int32 logits_dimension() const { return logits_dimension_; }
+
+  // Checks that the bucketized features have the rows and the columns that
+  // the splits of the ensemble read.
+  Status ValidateFeatures(
+      const std::vector<TTypes<int32>::ConstMatrix>& bucketized_features,
+      const int32 batch_size) const;
+
+  // Adds the weighted leaf values that examples [example_start, example_end)
+  // reach in trees [tree_start, tree_end) to `logits`, a row-major
+  // [batch_size, logits_dimension] array. Trees are accumulated in order, so
+  // predicting all trees at once matches walking the proto tree by tree.
+  void Predict(
+      const std::vector<TTypes<int32>::ConstMatrix>& bucketized_features,
+      const int32 example_start, const int32 example_end,
+      const int32 tree_start, const int32 tree_end, float* logits) const;
+
+ private:
+  FlatTreeEnsemble() {}
+
+  int32 logits_dimension_ = 0;
+
+  // Indexed by tree id.
+  std::vector<int32> tree_root_;
+  std::vector<int32> tree_depth_;
+
+  // Indexed by flat node id. The right child of a split is left_[node] + 1.
+  // Leaves have left_[node] == node and a condition that never holds.
+  std::vector<int32> column_;
+  std::vector<int32> threshold_;
+  std::vector<uint8> is_categorical_;
+  std::vector<int32> left_;
+  std::vector<int32> value_offset_;
+
+  // Leaf values, already multiplied by the weight of their tree.
+  std::vector<float> values_;
+
+  // The (feature_id, dimension_id) pairs that splits read, referenced by
+  // column_.
+  std::vector<std::pair<int32, int32>> columns_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FlatTreeEnsemble);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BOOSTED_TREES_FLAT_TREE_ENSEMBLE_H_
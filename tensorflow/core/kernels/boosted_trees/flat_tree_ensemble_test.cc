@@ -0,0 +1,164 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/boosted_trees/flat_tree_ensemble.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/boosted_trees/boosted_trees.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// A bias tree followed by a tree whose node ids are not in breadth-first
+// order and that splits on both feature types:
+//   node 0: feature 0 <= 2 ? node 2 : node 1
+//   node 1: feature 1, dimension 1 == 7 ? node 3 : node 4
+constexpr char kEnsemble[] = R"(
+  trees { nodes { leaf { scalar: 0.5 } } }
+  trees {
+    nodes {
+      bucketized_split { feature_id: 0 threshold: 2 left_id: 2 right_id: 1 }
+    }
+    nodes {
+      categorical_split {
+        feature_id: 1 dimension_id: 1 value: 7 left_id: 3 right_id: 4
+      }
+    }
+    nodes { leaf { scalar: 1 } }
+    nodes { leaf { scalar: 10 } }
+    nodes { leaf { scalar: 100 } }
+  }
+  tree_weights: 1
+  tree_weights: 0.5
+)";
+
+class FlatTreeEnsembleTest : public ::testing::Test {
+ protected:
+  // Fills in batch_size examples that cycle through the three leaves of the
+  // second tree, whose expected logits are 1, 5.5 and 50.5.
+  void MakeFeatures(int32 batch_size) {
+    feature_0_ = Tensor(DT_INT32, {batch_size, 1});
+    feature_1_ = Tensor(DT_INT32, {batch_size, 2});
+    expected_logits_.clear();
+    for (int32 i = 0; i < batch_size; ++i) {
+      const int32 kFeature0[] = {1, 5, 3};
+      const int32 kFeature1[] = {0, 7, 6};
+      const float kLogits[] = {1.0, 5.5, 50.5};
+      feature_0_.matrix<int32>()(i, 0) = kFeature0[i % 3];
+      feature_1_.matrix<int32>()(i, 0) = 0;
+      feature_1_.matrix<int32>()(i, 1) = kFeature1[i % 3];
+      expected_logits_.push_back(kLogits[i % 3]);
+    }
+    const Tensor& feature_0 = feature_0_;
+    const Tensor& feature_1 = feature_1_;
+    features_.clear();
+    features_.push_back(feature_0.matrix<int32>());
+    features_.push_back(feature_1.matrix<int32>());
+  }
+
+  std::unique_ptr<FlatTreeEnsemble> Compile(const char* text,
+                                            int32 logits_dimension) {
+    boosted_trees::TreeEnsemble ensemble;
+    CHECK(protobuf::TextFormat::ParseFromString(text, &ensemble));
+    std::unique_ptr<FlatTreeEnsemble> flat_ensemble;
+    TF_CHECK_OK(
+        FlatTreeEnsemble::Create(ensemble, logits_dimension, &flat_ensemble));
+    return flat_ensemble;
+  }
+
+  Tensor feature_0_;
+  Tensor feature_1_;
+  std::vector<TTypes<int32>::ConstMatrix> features_;
+  std::vector<float> expected_logits_;
+};
+
+TEST_F(FlatTreeEnsembleTest, PredictsAllTrees) {
+  // More examples than fit in one block.
+  const int32 kBatchSize = 40;
+  MakeFeatures(kBatchSize);
+  auto flat_ensemble = Compile(kEnsemble, 1);
+  EXPECT_EQ(2, flat_ensemble->num_trees());
+  TF_EXPECT_OK(flat_ensemble->ValidateFeatures(features_, kBatchSize));
+
+  std::vector<float> logits(kBatchSize, 0);
+  flat_ensemble->Predict(features_, 0, kBatchSize, 0, 2, logits.data());
+  EXPECT_EQ(expected_logits_, logits);
+}
+
+TEST_F(FlatTreeEnsembleTest, PredictsRangesOfExamplesAndTrees) {
+  MakeFeatures(3);
+  auto flat_ensemble = Compile(kEnsemble, 1);
+
+  std::vector<float> logits(3, 0);
+  flat_ensemble->Predict(features_, 1, 3, 0, 1, logits.data());
+  EXPECT_EQ(std::vector<float>({0, 0.5, 0.5}), logits);
+  flat_ensemble->Predict(features_, 1, 3, 1, 2, logits.data());
+  EXPECT_EQ(std::vector<float>({0, 5.5, 50.5}), logits);
+}
+
+TEST_F(FlatTreeEnsembleTest, PredictsMultipleLogits) {
+  MakeFeatures(2);
+  auto flat_ensemble = Compile(R"(
+    trees {
+      nodes {
+        bucketized_split { feature_id: 0 threshold: 2 left_id: 1 right_id: 2 }
+      }
+      nodes { leaf { vector { value: 1 value: 2 } } }
+      nodes { leaf { vector { value: 3 value: 4 } } }
+    }
+    tree_weights: 2
+  )",
+                               2);
+
+  std::vector<float> logits(4, 0);
+  flat_ensemble->Predict(features_, 0, 2, 0, 1, logits.data());
+  EXPECT_EQ(std::vector<float>({2, 4, 6, 8}), logits);
+}
+
+TEST_F(FlatTreeEnsembleTest, ValidatesFeatures) {
+  MakeFeatures(3);
+  auto flat_ensemble = Compile(kEnsemble, 1);
+  EXPECT_FALSE(flat_ensemble->ValidateFeatures(features_, 4).ok());
+  features_.pop_back();
+  EXPECT_FALSE(flat_ensemble->ValidateFeatures(features_, 3).ok());
+}
+
+TEST_F(FlatTreeEnsembleTest, RejectsInvalidEnsembles) {
+  std::unique_ptr<FlatTreeEnsemble> flat_ensemble;
+  boosted_trees::TreeEnsemble ensemble;
+  // Leaves must hold logits_dimension values.
+  ASSERT_TRUE(protobuf::TextFormat::ParseFromString(kEnsemble, &ensemble));
+  EXPECT_FALSE(FlatTreeEnsemble::Create(ensemble, 2, &flat_ensemble).ok());
+  // Children must exist and have a single parent.
+  ASSERT_TRUE(protobuf::TextFormat::ParseFromString(R"(
+    trees {
+      nodes {
+        bucketized_split { feature_id: 0 threshold: 2 left_id: 1 right_id: 1 }
+      }
+      nodes { leaf { scalar: 1 } }
+    }
+    tree_weights: 1
+  )",
+                                                    &ensemble));
+  EXPECT_FALSE(FlatTreeEnsemble::Create(ensemble, 1, &flat_ensemble).ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/boosted_trees/boosted_trees.pb.h"
+#include "tensorflow/core/kernels/boosted_trees/flat_tree_ensemble.h"
 #include "tensorflow/core/kernels/boosted_trees/resources.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/refcount.h"
@@ -196,6 +197,11 @@ class BoostedTreesTrainingPredictOp : public OpKernel {
 REGISTER_KERNEL_BUILDER(Name("BoostedTreesTrainingPredict").Device(DEVICE_CPU),
                         BoostedTreesTrainingPredictOp);
 
+// Number of examples per unit of work in BoostedTreesPredictOp.
+constexpr int32 kExamplesPerUnit = 64;
+// Fewest trees worth giving a thread of their own in BoostedTreesPredictOp.
+constexpr int32 kMinTreesPerGroup = 16;
+
 // The Op to get the predictions at the evaluation/inference time.
 class BoostedTreesPredictOp : public OpKernel {
  public:
@@ -235,46 +241,85 @@ class BoostedTreesPredictOp : public OpKernel {
       return;
     }
 
-    const int32 last_tree = resource->num_trees() - 1;
-    auto do_work = [&resource, &bucketized_features, &output_logits, last_tree,
-                    this](int32 start, int32 end) {
-      for (int32 i = start; i < end; ++i) {
-        std::vector<float> tree_logits(logits_dimension_, 0.0);
-        int32 tree_id = 0;
-        int32 node_id = 0;
-        while (true) {
-          if (resource->is_leaf(tree_id, node_id)) {
-            const float tree_weight = resource->GetTreeWeight(tree_id);
-            const auto& leaf_logits = resource->node_value(tree_id, node_id);
-            DCHECK_EQ(leaf_logits.size(), logits_dimension_);
-            for (int32 j = 0; j < logits_dimension_; ++j) {
-              tree_logits[j] += tree_weight * leaf_logits[j];
-            }
-            // Stop if it was the last tree.
-            if (tree_id == last_tree) {
-              break;
-            }
-            // Move onto other trees.
-            ++tree_id;
-            node_id = 0;
-          } else {
-            node_id =
-                resource->next_node(tree_id, node_id, i, bucketized_features);
-          }
-        }
-        for (int32 j = 0; j < logits_dimension_; ++j) {
-          output_logits(i, j) = tree_logits[j];
-        }
+    std::shared_ptr<const FlatTreeEnsemble> flat_ensemble;
+    OP_REQUIRES_OK(context, resource->GetFlatTreeEnsemble(logits_dimension_,
+                                                           &flat_ensemble));
+    OP_REQUIRES_OK(context, flat_ensemble->ValidateFeatures(bucketized_features,
+                                                            batch_size));
+    const int32 num_trees = flat_ensemble->num_trees();
+
+    // Work is split into units of up to kExamplesPerUnit examples and
+    // trees_per_group trees. Sharding over examples alone leaves most threads
+    // idle for small batches, so then the trees are split into groups too,
+    // each accumulating into its own copy of the logits, which are summed
+    // at the end.
+    thread::ThreadPool* const worker_threads =
+        context->device()->tensorflow_cpu_worker_threads()->workers;
+    const int64 num_threads = worker_threads->NumThreads();
+    const int64 num_example_blocks =
+        (batch_size + kExamplesPerUnit - 1) / kExamplesPerUnit;
+    int64 num_tree_groups = 1;
+    if (num_example_blocks > 0 && num_example_blocks < num_threads) {
+      num_tree_groups = std::max<int64>(
+          1, std::min<int64>(
+                 (num_threads + num_example_blocks - 1) / num_example_blocks,
+                 num_trees / kMinTreesPerGroup));
+    }
+    const int32 trees_per_group =
+        (num_trees + num_tree_groups - 1) / num_tree_groups;
+
+    float* logits = output_logits.data();
+    Tensor partial_logits_t;
+    if (num_tree_groups > 1) {
+      OP_REQUIRES_OK(context,
+                     context->allocate_temp(
+                         DT_FLOAT,
+                         {num_tree_groups, batch_size, logits_dimension_},
+                         &partial_logits_t));
+      logits = partial_logits_t.flat<float>().data();
+      partial_logits_t.flat<float>().setZero();
+    } else {
+      output_logits.setZero();
+    }
+
+    auto do_work = [&flat_ensemble, &bucketized_features, logits, batch_size,
+                    num_trees, num_example_blocks, trees_per_group,
+                    this](int64 start, int64 end) {
+      for (int64 unit = start; unit < end; ++unit) {
+        const int64 group = unit / num_example_blocks;
+        const int32 example_start =
+            (unit % num_example_blocks) * kExamplesPerUnit;
+        const int32 example_end =
+            std::min(example_start + kExamplesPerUnit, batch_size);
+        const int32 tree_start = group * trees_per_group;
+        const int32 tree_end =
+            std::min(tree_start + trees_per_group, num_trees);
+        float* group_logits =
+            logits + group * static_cast<int64>(batch_size) * logits_dimension_;
+        flat_ensemble->Predict(bucketized_features, example_start, example_end,
+                               tree_start, tree_end, group_logits);
       }
     };
     // 10 is the magic number. The actual number might depend on (the number of
     // layers in the trees) and (cpu cycles spent on each layer), but this
     // value would work for many cases. May be tuned later.
-    const int64 cost = (last_tree + 1) * 10;
-    thread::ThreadPool* const worker_threads =
-        context->device()->tensorflow_cpu_worker_threads()->workers;
-    Shard(worker_threads->NumThreads(), worker_threads, batch_size,
+    const int64 cost =
+        static_cast<int64>(trees_per_group) * kExamplesPerUnit * 10;
+    Shard(num_threads, worker_threads, num_example_blocks * num_tree_groups,
           /*cost_per_unit=*/cost, do_work);
+
+    if (num_tree_groups > 1) {
+      const auto partial_logits = partial_logits_t.tensor<float, 3>();
+      for (int32 i = 0; i < batch_size; ++i) {
+        for (int32 j = 0; j < logits_dimension_; ++j) {
+          float sum = 0;
+          for (int64 group = 0; group < num_tree_groups; ++group) {
+            sum += partial_logits(group, i, j);
+          }
+          output_logits(i, j) = sum;
+        }
+      }
+    }
   }
 
  private:
@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/kernels/boosted_trees/boosted_trees.pb.h"
 #include "tensorflow/core/kernels/boosted_trees/tree_helper.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf.h"
 
@@ -27,7 +28,8 @@ namespace tensorflow {
 BoostedTreesEnsembleResource::BoostedTreesEnsembleResource()
     : tree_ensemble_(
           protobuf::Arena::CreateMessage<boosted_trees::TreeEnsemble>(
-              &arena_)) {}
+              &arena_)),
+      flat_ensemble_stamp_(-1) {}
 
 string BoostedTreesEnsembleResource::DebugString() const {
   return strings::StrCat("TreeEnsemble[size=", tree_ensemble_->trees_size(),
@@ -375,6 +377,26 @@ void BoostedTreesEnsembleResource::Reset() {
   CHECK_EQ(0, arena_.SpaceAllocated());
   tree_ensemble_ =
       protobuf::Arena::CreateMessage<boosted_trees::TreeEnsemble>(&arena_);
+
+  mutex_lock l(flat_ensemble_mu_);
+  flat_ensemble_.reset();
+}
+
+Status BoostedTreesEnsembleResource::GetFlatTreeEnsemble(
+    const int32 logits_dimension,
+    std::shared_ptr<const FlatTreeEnsemble>* flat_ensemble) {
+  tf_shared_lock l(mu_);
+  mutex_lock flat_l(flat_ensemble_mu_);
+  if (flat_ensemble_ == nullptr || flat_ensemble_stamp_ != stamp() ||
+      flat_ensemble_->logits_dimension() != logits_dimension) {
+    std::unique_ptr<FlatTreeEnsemble> compiled;
+    TF_RETURN_IF_ERROR(
+        FlatTreeEnsemble::Create(*tree_ensemble_, logits_dimension, &compiled));
+    flat_ensemble_ = std::move(compiled);
+    flat_ensemble_stamp_ = stamp();
+  }
+  *flat_ensemble = flat_ensemble_;
+  return Status::OK();
 }
 
 void BoostedTreesEnsembleResource::PostPruneTree(const int32 current_tree,
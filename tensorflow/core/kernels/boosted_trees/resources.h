@@ -16,8 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_BOOSTED_TREES_RESOURCES_H_
 #define TENSORFLOW_CORE_KERNELS_BOOSTED_TREES_RESOURCES_H_
 
+#include <memory>
+
 #include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/kernels/boosted_trees/flat_tree_ensemble.h"
 #include "tensorflow/core/kernels/boosted_trees/tree_helper.h"
+#include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf.h"
 
@@ -152,6 +156,14 @@ class BoostedTreesEnsembleResource : public StampedResource {
                               std::vector<float>* logit_updates) const;
   mutex* get_mutex() { return &mu_; }
 
+  // Returns the ensemble compiled for batched inference, compiling it first if
+  // the stamp changed since the last call. This relies on every op that
+  // modifies the ensemble also advancing the stamp, as the training ops do.
+  // The returned copy stays valid after the ensemble is modified.
+  Status GetFlatTreeEnsemble(
+      const int32 logits_dimension,
+      std::shared_ptr<const FlatTreeEnsemble>* flat_ensemble);
+
  private:
   // Helper method to check whether a node is a terminal node in that it
   // only has leaf nodes as children.
@@ -176,6 +188,12 @@ class BoostedTreesEnsembleResource : public StampedResource {
   mutex mu_;
   boosted_trees::TreeEnsemble* tree_ensemble_;
 
+  // Cache for GetFlatTreeEnsemble(), cleared by Reset(). Acquired after mu_.
+  mutex flat_ensemble_mu_;
+  std::shared_ptr<const FlatTreeEnsemble> flat_ensemble_
+      GUARDED_BY(flat_ensemble_mu_);
+  int64 flat_ensemble_stamp_ GUARDED_BY(flat_ensemble_mu_);
+
   boosted_trees::Node* AddLeafNodes(
       int32 tree_id,
       const std::pair<int32, boosted_trees::SplitCandidate>& split_entry,
@@ -12,11 +12,18 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 
@@ -269,6 +276,145 @@ REGISTER_KERNEL_BUILDER(Name("CollectiveReduce").Device(DEVICE_CPU),
 REGISTER_KERNEL_BUILDER(Name("CollectiveReduce").Device(DEVICE_GPU),
                         CollectiveReduceOpKernel);
 
+// Reduces N tensors with a single collective instance.  The inputs are copied
+// into one fused buffer, each at an aligned offset, the buffer is reduced in
+// place, and each output aliases the slice of the buffer holding its input.
+// The padding between slices is reduced along with the data and ignored.
+class CollectiveReduceNOpKernel : public CollectiveReduceOpKernel {
+ public:
+  explicit CollectiveReduceNOpKernel(OpKernelConstruction* c)
+      : CollectiveReduceOpKernel(c) {}
+
+  void ComputeAsync(OpKernelContext* c, DoneCallback done) override {
+    CollectiveExecutor* col_exec = c->collective_executor();
+    OP_REQUIRES_ASYNC(
+        c, col_exec,
+        errors::Internal(
+            "Failed to get CollectiveExecutor from OpKernelContext for Op ",
+            col_params_.name),
+        done);
+    // Allocate the fused buffer and the outputs on the first pass through this
+    // function, while we're still in the executor thread, as in
+    // CollectiveReduceOpKernel.  The buffer is kept until `done` is called.
+    if (c->mutable_output(0) == nullptr) {
+      Tensor fused;
+      OP_REQUIRES_OK_ASYNC(c, AllocateFused(c, &fused), done);
+      {
+        mutex_lock l(mu_);
+        fused_[c] = fused;
+      }
+      done = [this, c, done]() {
+        {
+          mutex_lock l(mu_);
+          fused_.erase(c);
+        }
+        done();
+      };
+    }
+    if (!CanProceedWithCompute(c, col_exec, done)) return;
+
+    Tensor* fused;
+    {
+      mutex_lock l(mu_);
+      fused = &fused_[c];
+    }
+    if (fused->NumElements() == 0) {
+      done();
+      return;
+    }
+    auto actual_done = [c, done](const Status& s) {
+      VLOG(1) << "CollectiveReduceNOpKernel ExecuteAsync done for collective "
+              << c->op_kernel().name() << " device " << c->device()->name()
+              << " status " << s;
+      OP_REQUIRES_OK_ASYNC(c, s, done);
+      done();
+    };
+    // Copy the inputs into the fused buffer, then reduce it once all of the
+    // copies are done.  On GPU the copies are queued on the compute stream,
+    // ahead of the reduction.
+    struct CopyState {
+      std::atomic<int> pending;
+      mutex mu;
+      Status status GUARDED_BY(mu);
+    };
+    auto state = std::make_shared<CopyState>();
+    state->pending = c->num_inputs();
+    const string exec_key = GetCollectiveKey(c);
+    auto copy_done = [this, c, col_exec, fused, exec_key, state,
+                      actual_done](const Status& s) {
+      if (!s.ok()) {
+        mutex_lock l(state->mu);
+        state->status.Update(s);
+      }
+      if (--state->pending > 0) return;
+      Status status;
+      {
+        mutex_lock l(state->mu);
+        status = state->status;
+      }
+      if (!status.ok()) {
+        actual_done(status);
+        return;
+      }
+      VLOG(1) << "CollectiveReduceNOpKernel ExecuteAsync start for collective "
+              << col_params_.name << " device " << c->device()->name()
+              << " group " << col_params_.group.group_key << " instance "
+              << col_params_.instance.instance_key << " fused elements "
+              << fused->NumElements();
+      col_exec->ExecuteAsync(c, col_params_, exec_key, fused, fused,
+                             actual_done);
+    };
+    for (int i = 0; i < c->num_inputs(); ++i) {
+      if (c->input(i).NumElements() == 0) {
+        copy_done(Status::OK());
+      } else {
+        c->device()->CopyTensorInSameDevice(&c->input(i), c->mutable_output(i),
+                                            c->op_device_context(), copy_done);
+      }
+    }
+  }
+
+ private:
+  // Allocates `fused` to hold every input at an offset aligned to
+  // Allocator::kAllocatorAlignment, and sets each output to its slice.
+  Status AllocateFused(OpKernelContext* c, Tensor* fused) {
+    const int64 align = Allocator::kAllocatorAlignment /
+                        DataTypeSize(col_params_.instance.data_type);
+    std::vector<int64> offsets;
+    int64 num_elements = 0;
+    for (int i = 0; i < c->num_inputs(); ++i) {
+      offsets.push_back(num_elements);
+      num_elements += (c->input(i).NumElements() + align - 1) / align * align;
+    }
+    TF_RETURN_IF_ERROR(c->allocate_temp(col_params_.instance.data_type,
+                                        TensorShape({num_elements}), fused));
+    for (int i = 0; i < c->num_inputs(); ++i) {
+      const Tensor& input = c->input(i);
+      Tensor output;
+      if (!output.CopyFrom(
+              fused->Slice(offsets[i], offsets[i] + input.NumElements()),
+              input.shape())) {
+        return errors::Internal("Failed to slice the fused buffer for input ",
+                                i);
+      }
+      c->set_output(i, output);
+    }
+    col_params_.instance.shape = fused->shape();
+    return Status::OK();
+  }
+
+  mutex mu_;
+  // The fused buffer of each running step, by OpKernelContext.
+  std::unordered_map<OpKernelContext*, Tensor> fused_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(CollectiveReduceNOpKernel);
+};
+
+REGISTER_KERNEL_BUILDER(Name("CollectiveReduceN").Device(DEVICE_CPU),
+                        CollectiveReduceNOpKernel);
+REGISTER_KERNEL_BUILDER(Name("CollectiveReduceN").Device(DEVICE_GPU),
+                        CollectiveReduceNOpKernel);
+
 class CollectiveBcastSendOpKernel : public CollectiveOpKernel {
  public:
   explicit CollectiveBcastSendOpKernel(OpKernelConstruction* c)
@@ -26,9 +26,12 @@ limitations under the License.
 
 #include <string.h>
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <map>
 #include <mutex>  // NOLINT(build/c++11): only using std::call_once, not mutex.
+#include <unordered_map>
 #include <vector>
 
 #include "tensorflow/core/framework/allocator.h"
@@ -36,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/framework/numeric_op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_slice.h"
@@ -47,8 +51,10 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/padding.h"
 #include "tensorflow/core/util/tensor_format.h"
 #include "tensorflow/core/util/use_cudnn.h"
@@ -224,12 +230,51 @@ class LaunchDeepConvOp {
                   int filter_cols, int pad_rows, int pad_cols, int out_rows,
                   int /*out_cols*/, int /*out_depth*/, int /*dilation_rows*/,
                   int /*dilation_cols*/, int /*stride_rows*/,
-                  int /*stride_cols*/, Tensor* /*output*/,
+                  int /*stride_cols*/, const Padding& /*padding*/,
+                  bool /*use_autotune*/, Tensor* /*output*/,
                   TensorFormat /*data_format*/) {
     return false;
   }
 };
 
+// CPU Conv2D implementations the autotuner times against each other.
+enum class CpuConv2DAlgorithm { kEigen, kWinograd2x2, kWinograd4x4 };
+
+// Caches the fastest CPU Conv2D implementation of each convolution shape
+// autotuned so far, keyed by the fields of its Conv2DArgs.
+class CpuConv2DAutotuneMap {
+ public:
+  typedef std::array<int, 9> Key;
+
+  static CpuConv2DAutotuneMap* Global() {
+    static CpuConv2DAutotuneMap* map = new CpuConv2DAutotuneMap;
+    return map;
+  }
+
+  static Key MakeKey(const Conv2DArgs& args) {
+    return {{args.batch, args.in_rows, args.in_cols, args.in_depth,
+             args.pad_rows, args.pad_cols, args.out_rows, args.out_cols,
+             args.out_depth}};
+  }
+
+  bool Find(const Key& key, CpuConv2DAlgorithm* algorithm) const {
+    mutex_lock lock(mu_);
+    auto it = algorithms_.find(key);
+    if (it == algorithms_.end()) return false;
+    *algorithm = it->second;
+    return true;
+  }
+
+  void Insert(const Key& key, CpuConv2DAlgorithm algorithm) {
+    mutex_lock lock(mu_);
+    algorithms_.emplace(key, algorithm);
+  }
+
+ private:
+  mutable mutex mu_;
+  std::map<Key, CpuConv2DAlgorithm> algorithms_ GUARDED_BY(mu_);
+};
+
 // Conditionally launches DeepConv operation based on convolution parameters.
 template <>
 class LaunchDeepConvOp<CPUDevice, float> {
@@ -240,11 +285,21 @@ class LaunchDeepConvOp<CPUDevice, float> {
                   int filter_cols, int pad_rows, int pad_cols, int out_rows,
                   int out_cols, int out_depth, int dilation_rows,
                   int dilation_cols, int stride_rows, int stride_cols,
-                  Tensor* output, TensorFormat data_format) {
+                  const Padding& padding, bool use_autotune, Tensor* output,
+                  TensorFormat data_format) {
     if (data_format != FORMAT_NHWC || dilation_rows != 1 ||
-        dilation_cols != 1 ||
-        !CanUseDeepConv2D(stride_rows, stride_cols, filter_rows, filter_cols,
-                          in_depth, out_depth, out_rows, out_cols)) {
+        dilation_cols != 1) {
+      return false;
+    }
+    DeepConv2DAlgorithm algorithm = DeepConv2DAlgorithm::kWinograd2x2;
+    if (use_autotune) {
+      if (!DeepConv2DSupportsParams(stride_rows, stride_cols, filter_rows,
+                                    filter_cols)) {
+        return false;
+      }
+    } else if (!CanUseDeepConv2D(stride_rows, stride_cols, filter_rows,
+                                 filter_cols, in_depth, out_depth, out_rows,
+                                 out_cols, &algorithm)) {
       return false;
     }
 
@@ -261,13 +316,86 @@ class LaunchDeepConvOp<CPUDevice, float> {
     args.out_cols = out_cols;
     args.out_depth = out_depth;
 
+    if (use_autotune) {
+      const CpuConv2DAutotuneMap::Key key = CpuConv2DAutotuneMap::MakeKey(args);
+      CpuConv2DAlgorithm best;
+      if (!CpuConv2DAutotuneMap::Global()->Find(key, &best)) {
+        // The timed runs leave the convolution computed in 'output'.
+        best = Autotune(ctx, input, filter, stride_rows, stride_cols, padding,
+                        args, output);
+        if (ctx->status().ok()) {
+          CpuConv2DAutotuneMap::Global()->Insert(key, best);
+        }
+        return true;
+      }
+      if (best == CpuConv2DAlgorithm::kEigen) return false;
+      algorithm = best == CpuConv2DAlgorithm::kWinograd4x4
+                      ? DeepConv2DAlgorithm::kWinograd4x4
+                      : DeepConv2DAlgorithm::kWinograd2x2;
+    }
+    args.algorithm = algorithm;
+    Launch(ctx, input, filter, args, output);
+    return true;
+  }
+
+ private:
+  static void Launch(OpKernelContext* ctx, const Tensor& input,
+                     const Tensor& filter, const Conv2DArgs& args,
+                     Tensor* output) {
     auto input_ptr = input.template flat<float>().data();
     auto filter_ptr = filter.template flat<float>().data();
     auto output_ptr = output->template flat<float>().data();
 
     functor::DeepConv2D<CPUDevice, float>()(ctx, args, input_ptr, filter_ptr,
                                             output_ptr);
-    return true;
+  }
+
+  // Times the generic Eigen convolution and both Winograd transforms on the
+  // convolution in 'args', and returns the fastest. Each is run twice and
+  // timed by its faster run, so that one-time costs such as first-touch page
+  // faults on the output do not decide the choice.
+  static CpuConv2DAlgorithm Autotune(OpKernelContext* ctx, const Tensor& input,
+                                     const Tensor& filter, int stride_rows,
+                                     int stride_cols, const Padding& padding,
+                                     Conv2DArgs args, Tensor* output) {
+    static constexpr int kNumRuns = 2;
+    static constexpr CpuConv2DAlgorithm kAlgorithms[] = {
+        CpuConv2DAlgorithm::kEigen, CpuConv2DAlgorithm::kWinograd2x2,
+        CpuConv2DAlgorithm::kWinograd4x4};
+
+    CpuConv2DAlgorithm best = CpuConv2DAlgorithm::kEigen;
+    uint64 best_micros = kuint64max;
+    for (CpuConv2DAlgorithm algorithm : kAlgorithms) {
+      uint64 micros = kuint64max;
+      for (int run = 0; run < kNumRuns; ++run) {
+        const uint64 start_micros = Env::Default()->NowMicros();
+        if (algorithm == CpuConv2DAlgorithm::kEigen) {
+          LaunchGeneric<CPUDevice, float>()(
+              ctx, input, filter, stride_rows, stride_cols,
+              /*row_dilation=*/1, /*col_dilation=*/1, padding,
+              /*explicit_paddings=*/{}, output, FORMAT_NHWC);
+        } else {
+          args.algorithm = algorithm == CpuConv2DAlgorithm::kWinograd4x4
+                               ? DeepConv2DAlgorithm::kWinograd4x4
+                               : DeepConv2DAlgorithm::kWinograd2x2;
+          Launch(ctx, input, filter, args, output);
+        }
+        if (!ctx->status().ok()) return best;
+        micros = std::min(micros, Env::Default()->NowMicros() - start_micros);
+      }
+      VLOG(2) << "Conv2D autotune: algorithm " << static_cast<int>(algorithm)
+              << " took " << micros << "us";
+      if (micros < best_micros) {
+        best = algorithm;
+        best_micros = micros;
+      }
+    }
+    VLOG(1) << "Conv2D autotune: batch = " << args.batch
+            << ", in_rows = " << args.in_rows << ", in_cols = " << args.in_cols
+            << ", in_depth = " << args.in_depth
+            << ", out_depth = " << args.out_depth
+            << ", chose algorithm " << static_cast<int>(best);
+    return best;
   }
 };
 
@@ -514,6 +642,7 @@ class Conv2DOp : public BinaryOp<T> {
     OP_REQUIRES_OK(context, context->GetAttr("use_cudnn_on_gpu", &use_cudnn_));
     use_cudnn_ &= CanUseCudnn();
     cudnn_use_autotune_ = CudnnUseAutotune();
+    cpu_use_autotune_ = DeepConv2DAutotuneEnable();
   }
 
   void Compute(OpKernelContext* context) override {
@@ -577,7 +706,8 @@ class Conv2DOp : public BinaryOp<T> {
             dimensions.pad_cols_before, dimensions.out_rows,
             dimensions.out_cols, dimensions.out_depth, dimensions.dilation_rows,
             dimensions.dilation_cols, dimensions.stride_rows,
-            dimensions.stride_cols, output, params_.data_format)) {
+            dimensions.stride_cols, params_.padding, cpu_use_autotune_, output,
+            params_.data_format)) {
       return;
     }
 
@@ -591,6 +721,7 @@ class Conv2DOp : public BinaryOp<T> {
   Conv2DParameters params_;
   bool use_cudnn_;
   bool cudnn_use_autotune_;
+  bool cpu_use_autotune_;
 
   LaunchConv2DOp<Device, T> launcher_;
 
@@ -635,6 +766,72 @@ int64 GetDnnWorkspaceLimit(const string& envvar_in_mb,
   return default_value_in_bytes;
 }
 
+namespace {
+
+// The workspaces shared by the DNN kernels of each stream of a device.
+class DnnWorkspacePool : public ResourceBase {
+ public:
+  explicit DnnWorkspacePool(int64 limit) : limit_(limit) {}
+
+  bool Get(OpKernelContext* context, int64 byte_size, Tensor* workspace) {
+    if (byte_size > limit_) return false;
+    mutex_lock l(mu_);
+    Tensor& pooled = workspaces_[context->op_device_context()->stream()];
+    if (!pooled.IsInitialized() || pooled.NumElements() < byte_size) {
+      // Grows geometrically, so that growing workspaces are not reallocated
+      // for each larger size. A replaced workspace is released once the
+      // kernels that hold it have been launched.
+      const int64 size =
+          std::min(limit_, std::max(byte_size, 2 * pooled.NumElements()));
+      AllocationAttributes allocation_attr;
+      allocation_attr.no_retry_on_failure = true;
+      Tensor grown;
+      if (!context
+               ->allocate_temp(DT_UINT8, TensorShape({size}), &grown,
+                               AllocatorAttributes(), allocation_attr)
+               .ok()) {
+        return false;
+      }
+      VLOG(1) << "Growing the DNN workspace of a stream from "
+              << pooled.NumElements() << " to " << size << " bytes.";
+      pooled = grown;
+    }
+    *workspace = pooled;
+    return true;
+  }
+
+  string DebugString() const override { return "DnnWorkspacePool"; }
+
+ private:
+  const int64 limit_;
+  mutex mu_;
+  // The workspace of each stream.
+  std::unordered_map<const se::Stream*, Tensor> workspaces_
+      GUARDED_BY(mu_);
+};
+
+}  // namespace
+
+bool GetPooledDnnWorkspace(OpKernelContext* context, int64 byte_size,
+                           Tensor* workspace) {
+  static const int64 pool_limit =
+      GetDnnWorkspaceLimit("TF_CUDNN_WORKSPACE_POOL_LIMIT_IN_MB", 0);
+  if (pool_limit <= 0 || byte_size > pool_limit) return false;
+  DnnWorkspacePool* pool;
+  Status status = context->resource_manager()->LookupOrCreate<DnnWorkspacePool>(
+      "DnnScratchAllocator", "dnn_workspace_pool", &pool,
+      [](DnnWorkspacePool** pool) {
+        *pool = new DnnWorkspacePool(pool_limit);
+        return Status::OK();
+      });
+  if (!status.ok()) {
+    LOG(WARNING) << "Not pooling the DNN workspace: " << status;
+    return false;
+  }
+  core::ScopedUnref unref(pool);
+  return pool->Get(context, byte_size, workspace);
+}
+
 // A dummy type to group forward convolution autotune results together.
 struct ConvAutoTuneGroup {
   static string name() { return "Conv"; }
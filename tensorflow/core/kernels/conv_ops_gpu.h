@@ -43,9 +43,26 @@ inline bool IsVoltaOrLater(const se::StreamExecutor& stream_exec) {
 int64 GetDnnWorkspaceLimit(const string& envvar_in_mb,
                            int64 default_value_in_bytes);
 
+// Sets "*workspace" to the workspace that the DNN kernels launched on the
+// stream of "context" share, grown to at least "byte_size" bytes, and returns
+// true. Returns false if the workspaces are not pooled, or if "byte_size" is
+// above the limit of the pool or cannot be allocated.
+//
+// The workspaces are pooled when the TF_CUDNN_WORKSPACE_POOL_LIMIT_IN_MB
+// environment variable is set to a positive limit. A workspace stays allocated
+// between launches, and only grows when a kernel needs more, instead of being
+// allocated for each launch, where fragmentation can make the allocation of the
+// workspace of the fastest algorithms fail. As the kernels of a stream run in
+// order, they can all use the same workspace.
+bool GetPooledDnnWorkspace(OpKernelContext* context, int64 byte_size,
+                           Tensor* workspace);
+
 // A class to provide scratch-space allocator for Stream-Executor Cudnn
 // callback. TensorFlow is responsible for releasing the temporary buffers after
 // the kernel finishes.
+//
+// The first allocation uses the pooled workspace of the stream, if any (see
+// GetPooledDnnWorkspace), as it is the workspace of the kernel.
 class DnnScratchAllocator : public se::ScratchAllocator {
  public:
   virtual ~DnnScratchAllocator() {}
@@ -62,6 +79,15 @@ class DnnScratchAllocator : public se::ScratchAllocator {
     if (byte_size > memory_limit_) {
       return se::port::StatusOr<se::DeviceMemory<uint8>>();
     }
+    if (allocated_tensors_.empty() &&
+        GetPooledDnnWorkspace(context_, byte_size, &temporary_memory)) {
+      // Hold the reference of the workspace until the end of the allocator,
+      // in case the pool replaces it by a larger one.
+      allocated_tensors_.push_back(temporary_memory);
+      total_byte_size_ += byte_size;
+      return se::port::StatusOr<se::DeviceMemory<uint8>>(
+          AsDeviceMemory(temporary_memory.flat<uint8>().data(), byte_size));
+    }
     AllocationAttributes allocation_attr;
     allocation_attr.no_retry_on_failure = true;
     Status allocation_status(context_->allocate_temp(
@@ -0,0 +1,190 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks of the core CPU and GPU kernels over the shapes of
+// kernel_benchmark_shapes.h. Each benchmark reports the bytes it reads and
+// writes, and its floating point operations as processed items (or its output
+// elements, for kernels that mostly move data), labelled with the shape name.
+//
+// To track regressions, run with
+//   TEST_REPORT_FILE_PREFIX=<dir>/ TEST_REPORT_FILE_FORMAT=json
+// to get a JSON entry per benchmark, with its time per iteration and its
+// "bytes_per_second" and "items_per_second".
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/kernels/kernel_benchmark_shapes.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+using benchmark_shapes::ActivationShape;
+using benchmark_shapes::Conv2DShape;
+using benchmark_shapes::kActivationShapes;
+using benchmark_shapes::kConv2DShapes;
+using benchmark_shapes::kMatMulShapes;
+using benchmark_shapes::kReductionShapes;
+using benchmark_shapes::MatMulShape;
+using benchmark_shapes::NumShapes;
+using benchmark_shapes::ReductionShape;
+
+Node* RandomConstant(Graph* g, const TensorShape& shape) {
+  Tensor t(DT_FLOAT, shape);
+  t.flat<float>().setRandom();
+  return test::graph::Constant(g, t);
+}
+
+void Report(int iters, const char* label, int64 bytes, int64 items) {
+  testing::BytesProcessed(static_cast<int64>(iters) * bytes);
+  testing::ItemsProcessed(static_cast<int64>(iters) * items);
+  testing::SetLabel(label);
+}
+
+TensorShape ActivationTensorShape(const ActivationShape& shape) {
+  return TensorShape({shape.batch, shape.height, shape.width, shape.depth});
+}
+
+void RunMatMul(const string& device, int iters, int index) {
+  const MatMulShape& shape = kMatMulShapes[index];
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Matmul(g, RandomConstant(g, TensorShape({shape.m, shape.k})),
+                      RandomConstant(g, TensorShape({shape.k, shape.n})),
+                      false, false);
+  const int64 m = shape.m, k = shape.k, n = shape.n;
+  Report(iters, shape.name, sizeof(float) * (m * k + k * n + m * n),
+         2 * m * k * n);
+  test::Benchmark(device, g).Run(iters);
+}
+
+void RunConv2D(const string& device, int iters, int index) {
+  const Conv2DShape& shape = kConv2DShapes[index];
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* input = RandomConstant(
+      g, TensorShape({shape.batch, shape.height, shape.width, shape.in_depth}));
+  Node* filter =
+      RandomConstant(g, TensorShape({shape.filter_height, shape.filter_width,
+                                     shape.in_depth, shape.out_depth}));
+  TF_CHECK_OK(NodeBuilder(g->NewName("conv"), "Conv2D")
+                  .Input(input)
+                  .Input(filter)
+                  .Attr("T", DT_FLOAT)
+                  .Attr("strides", {1, shape.stride, shape.stride, 1})
+                  .Attr("padding", "SAME")
+                  .Finalize(g, nullptr));
+  const int64 out_height = (shape.height + shape.stride - 1) / shape.stride;
+  const int64 out_width = (shape.width + shape.stride - 1) / shape.stride;
+  const int64 input_size = static_cast<int64>(shape.batch) * shape.height *
+                           shape.width * shape.in_depth;
+  const int64 filter_size = static_cast<int64>(shape.filter_height) *
+                            shape.filter_width * shape.in_depth *
+                            shape.out_depth;
+  const int64 output_size =
+      shape.batch * out_height * out_width * shape.out_depth;
+  Report(iters, shape.name,
+         sizeof(float) * (input_size + filter_size + output_size),
+         2 * output_size * shape.filter_height * shape.filter_width *
+             shape.in_depth);
+  test::Benchmark(device, g).Run(iters);
+}
+
+void RunAdd(const string& device, int iters, int index) {
+  const ActivationShape& shape = kActivationShapes[index];
+  const TensorShape tensor_shape = ActivationTensorShape(shape);
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Binary(g, "Add", RandomConstant(g, tensor_shape),
+                      RandomConstant(g, tensor_shape));
+  const int64 n = tensor_shape.num_elements();
+  Report(iters, shape.name, 3 * sizeof(float) * n, n);
+  test::Benchmark(device, g).Run(iters);
+}
+
+void RunRelu(const string& device, int iters, int index) {
+  const ActivationShape& shape = kActivationShapes[index];
+  const TensorShape tensor_shape = ActivationTensorShape(shape);
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Unary(g, "Relu", RandomConstant(g, tensor_shape));
+  const int64 n = tensor_shape.num_elements();
+  Report(iters, shape.name, 2 * sizeof(float) * n, n);
+  test::Benchmark(device, g).Run(iters);
+}
+
+// Upsamples by 2x in each spatial dimension.
+void RunResizeBilinear(const string& device, int iters, int index) {
+  const ActivationShape& shape = kActivationShapes[index];
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor size(DT_INT32, TensorShape({2}));
+  size.flat<int32>()(0) = 2 * shape.height;
+  size.flat<int32>()(1) = 2 * shape.width;
+  TF_CHECK_OK(NodeBuilder(g->NewName("resize"), "ResizeBilinear")
+                  .Input(RandomConstant(g, ActivationTensorShape(shape)))
+                  .Input(test::graph::Constant(g, size))
+                  .Finalize(g, nullptr));
+  const int64 input_size = ActivationTensorShape(shape).num_elements();
+  const int64 output_size = 4 * input_size;
+  Report(iters, shape.name, sizeof(float) * (input_size + output_size),
+         output_size);
+  test::Benchmark(device, g).Run(iters);
+}
+
+void RunSum(const string& device, int iters, int index, int axis) {
+  const ReductionShape& shape = kReductionShapes[index];
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor axes(DT_INT32, TensorShape({}));
+  axes.scalar<int32>()() = axis;
+  test::graph::Reduce(g, "Sum",
+                      RandomConstant(g, TensorShape({shape.rows, shape.cols})),
+                      test::graph::Constant(g, axes));
+  const int64 input_size = static_cast<int64>(shape.rows) * shape.cols;
+  const int64 output_size = axis == 0 ? shape.cols : shape.rows;
+  Report(iters, shape.name, sizeof(float) * (input_size + output_size),
+         input_size);
+  test::Benchmark(device, g).Run(iters);
+}
+
+void RunRowSum(const string& device, int iters, int index) {
+  RunSum(device, iters, index, 1);
+}
+
+void RunColumnSum(const string& device, int iters, int index) {
+  RunSum(device, iters, index, 0);
+}
+
+#define BM_KERNEL_OVER_SHAPES(KERNEL, CATALOG, DEVICE)                 \
+  static void BM_##KERNEL##_##DEVICE(int iters, int index) {           \
+    Run##KERNEL(#DEVICE, iters, index);                                \
+  }                                                                    \
+  BENCHMARK(BM_##KERNEL##_##DEVICE)->DenseRange(0, NumShapes(CATALOG) - 1)
+
+#if GOOGLE_CUDA
+#define BM_KERNEL(KERNEL, CATALOG)             \
+  BM_KERNEL_OVER_SHAPES(KERNEL, CATALOG, cpu); \
+  BM_KERNEL_OVER_SHAPES(KERNEL, CATALOG, gpu)
+#else
+#define BM_KERNEL(KERNEL, CATALOG) BM_KERNEL_OVER_SHAPES(KERNEL, CATALOG, cpu)
+#endif  // GOOGLE_CUDA
+
+BM_KERNEL(MatMul, kMatMulShapes);
+BM_KERNEL(Conv2D, kConv2DShapes);
+BM_KERNEL(Add, kActivationShapes);
+BM_KERNEL(Relu, kActivationShapes);
+BM_KERNEL(ResizeBilinear, kActivationShapes);
+BM_KERNEL(RowSum, kReductionShapes);
+BM_KERNEL(ColumnSum, kReductionShapes);
+
+}  // namespace
+}  // namespace tensorflow
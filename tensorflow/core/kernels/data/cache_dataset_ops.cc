@@ -35,12 +35,15 @@ namespace data {
 /* static */ constexpr const char* const CacheDatasetOp::kFileName;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputTypes;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const CacheDatasetOp::kShared;
 
 constexpr char kKeyStrFormat[] = "%%%zuzu_%%%zuzu";
 constexpr char kPaddingSizeStrFormat[] = "%zu";
 constexpr char kFileDatasetPrefix[] = "File";
 constexpr char kMode[] = "Mode";
 constexpr char kLockFileSuffix[] = ".lockfile";
+constexpr char kClaimSuffix[] = ".claim";
+constexpr char kPassThrough[] = "pass_through";
 constexpr char kIterationCompleted[] = "iteration_completed";
 constexpr char kCurIndex[] = "cur_index";
 constexpr char kShardId[] = "shard_id";
@@ -57,13 +60,22 @@ constexpr char kIndex[] = "index";
 constexpr char kImpl[] = "Impl";
 constexpr char kCacheDataset[] = "CacheDataset";
 
+// Cache files align the data of each tensor so that FileReaderIterator can
+// hand out tensors that alias the memory-mapped file.
+BundleWriter::Options BundleWriterOptions() {
+  BundleWriter::Options options;
+  options.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+  return options;
+}
+
 class CacheDatasetOp::FileDataset : public DatasetBase {
  public:
   explicit FileDataset(OpKernelContext* ctx, const DatasetBase* input,
-                       string filename, Env* env)
+                       string filename, bool shared, Env* env)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         filename_(std::move(filename)),
+        shared_(shared),
         env_(env),
         num_tensors_(input->output_dtypes().size()),
         tensor_index_padding_size_(StringPaddingSize(num_tensors_)),
@@ -113,12 +125,31 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
     TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph));
     Node* filename = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(filename_, &filename));
-    TF_RETURN_IF_ERROR(b->AddDataset(this, {input_graph, filename}, output));
+    TF_RETURN_IF_ERROR(
+        b->AddDataset(this, {input_graph, filename}, Attrs(b), output));
     return Status::OK();
   }
 
+  // Returns the attributes of the dataset node. `shared` is only added when it
+  // is set, so that the graphs of the datasets that do not use it can be run
+  // by servers that predate it.
+  std::vector<std::pair<StringPiece, AttrValue>> Attrs(
+      DatasetGraphDefBuilder* b) const {
+    std::vector<std::pair<StringPiece, AttrValue>> attrs;
+    if (shared_) {
+      AttrValue shared_attr;
+      b->BuildAttrValue(shared_, &shared_attr);
+      attrs.emplace_back(kShared, shared_attr);
+    }
+    return attrs;
+  }
+
   const DatasetBase* const input_;
   const tstring filename_;
+  // Whether processes on the same host share the cache: the first iterator to
+  // claim it writes it, and the others pass their input through until it is
+  // complete. See `FileWriterIterator::EnsureLockFileExists()`.
+  const bool shared_;
 
  private:
   static size_t StringPaddingSize(size_t num_tensors) {
@@ -212,6 +243,13 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
     // partial cache gets flushed to disk in files with prefix
     // <filename>_<shard_id> where shard_id is unique for each checkpoint.
     // When all elements have been produced, these shards get coalesced.
+    //
+    // If the dataset is `shared`, the iterators of several processes may
+    // start writing the same cache. Only the one which claims the cache
+    // writes it, the others pass the elements of their input through, and
+    // read the cache once it is complete. As the reads alias the pages of the
+    // cache files, processes which share a cache on a memory-backed
+    // filesystem such as /dev/shm hold a single copy of it in host memory.
     class FileWriterIterator : public DatasetIterator<FileDataset> {
      public:
       explicit FileWriterIterator(const Params& params)
@@ -222,9 +260,26 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
                 strings::StrCat(params.dataset->filename_, "_", shard_id_)),
             lockfile_(strings::StrCat(filename_, kLockFileSuffix)),
             lockfile_created_(false),
-            iteration_completed_(false) {}
+            iteration_completed_(false),
+            claimed_(false),
+            pass_through_(false) {}
 
       ~FileWriterIterator() override {
+        if (pass_through_) {
+          // The cache files belong to the iterator which claimed the cache.
+          return;
+        }
+        if (claimed_ &&
+            !dataset()->env_->FileExists(MetaFilename(dataset()->filename_))
+                 .ok()) {
+          // Release the claim on the incomplete cache, so that another
+          // iterator can write it.
+          Status s = dataset()->env_->DeleteDir(ClaimDirname());
+          if (!s.ok()) {
+            LOG(WARNING) << "Failed to delete " << ClaimDirname() << " : "
+                         << s.ToString();
+          }
+        }
         if (!dataset()->env_->FileExists(MetaFilename(filename_)).ok()) {
           std::vector<string> cache_files;
           Status s = dataset()->env_->GetMatchingPaths(
@@ -256,6 +311,9 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
         if (*end_of_sequence) {
           return Status::OK();
         }
+        if (pass_through_) {
+          return input_impl_->GetNext(ctx, out_tensors, end_of_sequence);
+        }
         TF_RETURN_IF_ERROR(writer_->status());
         if (cur_index_ >= kMaxItems) {
           // As a courtesy, close the [truncated] cache file.
@@ -311,6 +369,13 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
               writer->WriteScalar(full_name(kIterationCompleted), ""));
           return Status::OK();
         }
+        if (claimed_) {
+          TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kCacheClaimed), ""));
+        }
+        if (pass_through_) {
+          TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kPassThrough), ""));
+          return SaveInput(writer, input_impl_);
+        }
 
         // lockfile is created on the first call to GetNextInternal. The
         // absence of a lockfile means that GetNextInternal was not called
@@ -354,6 +419,11 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
           iteration_completed_ = true;
           return Status::OK();
         }
+        claimed_ = reader->Contains(full_name(kCacheClaimed));
+        if (reader->Contains(full_name(kPassThrough))) {
+          pass_through_ = true;
+          return RestoreInput(ctx, reader, input_impl_);
+        }
 
         TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
 
@@ -368,7 +438,8 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
         }
         filename_ = strings::StrCat(dataset()->filename_, "_", shard_id_);
         lockfile_ = strings::StrCat(filename_, kLockFileSuffix);
-        writer_ = absl::make_unique<BundleWriter>(dataset()->env_, filename_);
+        writer_ = absl::make_unique<BundleWriter>(dataset()->env_, filename_,
+                                                  BundleWriterOptions());
         return Status::OK();
       }
 
@@ -379,10 +450,28 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
           *end_of_sequence = true;
           return Status::OK();
         }
-        if (lockfile_created_) {
+        if (lockfile_created_ || pass_through_) {
           return Status::OK();
         }
 
+        // A shared cache is claimed by creating a directory, which, unlike
+        // the lockfile below, fails atomically if another process has
+        // already done so. The claim is kept once the cache is complete.
+        if (dataset()->shared_ && !claimed_) {
+          Status s = dataset()->env_->CreateDir(ClaimDirname());
+          if (errors::IsAlreadyExists(s)) {
+            LOG(INFO) << "The cache " << dataset()->filename_
+                      << " is being written by another iterator. Passing "
+                      << "the input through until it is complete. If no "
+                      << "other iterator is running, delete "
+                      << ClaimDirname() << ".";
+            pass_through_ = true;
+            return Status::OK();
+          }
+          TF_RETURN_IF_ERROR(s);
+          claimed_ = true;
+        }
+
         // Perform rudimentary locking to help catch concurrent writes to the
         // same cache files.
 
@@ -430,7 +519,8 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
         // conditions are not met since BundleWriter's constructor creates
         // new temp files which can delete the temp files created by a
         // BundleWriter in another Session.
-        writer_ = absl::make_unique<BundleWriter>(dataset()->env_, filename_);
+        writer_ = absl::make_unique<BundleWriter>(dataset()->env_, filename_,
+                                                  BundleWriterOptions());
         lockfile_created_ = true;
         return Status::OK();
       }
@@ -464,6 +554,10 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
         return Status::OK();
       }
 
+      string ClaimDirname() const {
+        return strings::StrCat(dataset()->filename_, kClaimSuffix);
+      }
+
       mutex mu_;
       size_t cur_index_ GUARDED_BY(mu_);
       // Index of the current shard. This gets incremented whenever a new
@@ -477,6 +571,11 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
       string lockfile_ GUARDED_BY(mu_);
       bool lockfile_created_ GUARDED_BY(mu_);
       bool iteration_completed_ GUARDED_BY(mu_);
+      // Whether this iterator claimed the shared cache.
+      bool claimed_ GUARDED_BY(mu_);
+      // Whether another iterator claimed the shared cache, in which case this
+      // one only passes its input through.
+      bool pass_through_ GUARDED_BY(mu_);
     };  // FileWriterIterator
 
     class FileReaderIterator : public DatasetIterator<FileDataset> {
@@ -516,7 +615,8 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
           }
           StringPiece key = reader_.key();
           DCHECK_EQ(key, dataset()->FormatName(cur_index_, i));
-          TF_RETURN_IF_ERROR(reader_.ReadCurrent(&(*out_tensors)[i]));
+          // Fixed-size tensors alias the memory-mapped cache file.
+          TF_RETURN_IF_ERROR(reader_.ReadCurrentMapped(&(*out_tensors)[i]));
           TF_RETURN_IF_ERROR(reader_.status());
         }
         cur_index_++;
@@ -606,9 +706,9 @@ class CacheDatasetOp::FileDataset : public DatasetBase {
 class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDataset {
  public:
   explicit FileDatasetV2(OpKernelContext* ctx, const DatasetBase* input,
-                         string filename, Env* env,
+                         string filename, bool shared, Env* env,
                          const Tensor& resource_handle)
-      : FileDataset(ctx, input, filename, env),
+      : FileDataset(ctx, input, filename, shared, env),
         resource_handle_(resource_handle) {}
 
  protected:
@@ -621,8 +721,9 @@ class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDataset {
     TF_RETURN_IF_ERROR(b->AddScalar(filename_, &filename_node));
     Node* resource_handle_node = nullptr;
     TF_RETURN_IF_ERROR(b->AddTensor(resource_handle_, &resource_handle_node));
-    TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {input_node, filename_node, resource_handle_node}, output));
+    TF_RETURN_IF_ERROR(
+        b->AddDataset(this, {input_node, filename_node, resource_handle_node},
+                      Attrs(b), output));
     return Status::OK();
   }
 
@@ -1009,7 +1110,11 @@ class CacheDatasetOp::MemoryDatasetV2 : public CacheDatasetOp::MemoryDataset {
 
 CacheDatasetOp::CacheDatasetOp(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {
+  if (ctx->HasAttr(kShared)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kShared, &shared_));
+  }
+}
 
 void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                                  DatasetBase** output) {
@@ -1018,6 +1123,10 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
   OP_REQUIRES_OK(ctx, ParseScalarArgument<tstring>(ctx, kFileName, &filename));
 
   if (filename.empty()) {
+    OP_REQUIRES(ctx, !shared_,
+                errors::InvalidArgument(
+                    "A shared cache requires a `filename`, e.g. a path on "
+                    "/dev/shm."));
     if (op_version_ == 2) {
       MemoryCache* cache = nullptr;
       OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 2), &cache));
@@ -1035,10 +1144,10 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
     }
   } else {
     if (op_version_ == 2) {
-      *output =
-          new FileDatasetV2(ctx, input, filename, ctx->env(), ctx->input(2));
+      *output = new FileDatasetV2(ctx, input, filename, shared_, ctx->env(),
+                                  ctx->input(2));
     } else {
-      *output = new FileDataset(ctx, input, filename, ctx->env());
+      *output = new FileDataset(ctx, input, filename, shared_, ctx->env());
     }
   }
 }
@@ -30,6 +30,7 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
   static constexpr const char* const kFileName = "filename";
   static constexpr const char* const kOutputTypes = "output_types";
   static constexpr const char* const kOutputShapes = "output_shapes";
+  static constexpr const char* const kShared = "shared";
 
   explicit CacheDatasetOp(OpKernelConstruction* ctx);
 
@@ -42,6 +43,7 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
   class MemoryDatasetV2;
 
   int op_version_;
+  bool shared_ = false;
 };
 
 }  // namespace data
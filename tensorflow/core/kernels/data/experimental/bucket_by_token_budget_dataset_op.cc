@@ -0,0 +1,558 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/input_colocation_exemption_registry.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/kernels/data/captured_function.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+// See documentation in ../../ops/experimental_dataset_ops.cc for a
+// high-level description of the following op.
+
+class BucketByTokenBudgetDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  explicit BucketByTokenBudgetDatasetOp(OpKernelConstruction* ctx)
+      : UnaryDatasetOpKernel(ctx) {
+    FunctionMetadata::Params params;
+    params.is_multi_device_function = true;
+    OP_REQUIRES_OK(ctx, FunctionMetadata::Create(ctx, "length_func", params,
+                                                 &length_func_metadata_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("parallel_copy", &parallel_copy_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override {
+    std::unique_ptr<CapturedFunction> captured_length_func;
+    OP_REQUIRES_OK(ctx, CapturedFunction::Create(
+                            ctx, length_func_metadata_,
+                            "length_func_other_arguments",
+                            &captured_length_func));
+
+    const Tensor* bucket_boundaries_t;
+    OP_REQUIRES_OK(ctx, ctx->input("bucket_boundaries", &bucket_boundaries_t));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(bucket_boundaries_t->shape()),
+                errors::InvalidArgument("bucket_boundaries must be a vector"));
+    const auto bucket_boundaries_vec = bucket_boundaries_t->vec<int64>();
+    std::vector<int64> bucket_boundaries(
+        bucket_boundaries_vec.data(),
+        bucket_boundaries_vec.data() + bucket_boundaries_vec.size());
+    OP_REQUIRES(ctx,
+                std::is_sorted(bucket_boundaries.begin(),
+                               bucket_boundaries.end(),
+                               std::less_equal<int64>()),
+                errors::InvalidArgument(
+                    "bucket_boundaries must be strictly increasing"));
+
+    int64 token_budget;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "token_budget",
+                                                   &token_budget));
+    OP_REQUIRES(ctx, token_budget > 0,
+                errors::InvalidArgument(
+                    "token_budget must be greater than zero."));
+
+    int64 max_buffered_elements;
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument<int64>(ctx, "max_buffered_elements",
+                                              &max_buffered_elements));
+    OP_REQUIRES(ctx, max_buffered_elements > 0 || max_buffered_elements == -1,
+                errors::InvalidArgument(
+                    "max_buffered_elements must be greater than zero, or -1 "
+                    "for no limit."));
+
+    OpInputList padding_values_list;
+    OP_REQUIRES_OK(ctx,
+                   ctx->input_list("padding_values", &padding_values_list));
+    OP_REQUIRES(ctx,
+                padding_values_list.size() == input->output_dtypes().size(),
+                errors::InvalidArgument(
+                    "Number of padding values (", padding_values_list.size(),
+                    ") must match the number of components in the input "
+                    "dataset's elements (",
+                    input->output_dtypes().size(), ")"));
+    std::vector<Tensor> padding_values;
+    for (int i = 0; i < padding_values_list.size(); ++i) {
+      const Tensor& padding_value_t = padding_values_list[i];
+      OP_REQUIRES(
+          ctx, TensorShapeUtils::IsScalar(padding_value_t.shape()),
+          errors::InvalidArgument("All padding values must be scalars"));
+      OP_REQUIRES(ctx, padding_value_t.dtype() == input->output_dtypes()[i],
+                  errors::InvalidArgument(
+                      "Mismatched type between padding value ", i,
+                      " and input dataset's component ", i, ": ",
+                      DataTypeString(padding_value_t.dtype()), " vs. ",
+                      DataTypeString(input->output_dtypes()[i])));
+      padding_values.push_back(tensor::DeepCopy(padding_value_t));
+    }
+
+    *output = new Dataset(ctx, input, std::move(captured_length_func),
+                          std::move(bucket_boundaries), token_budget,
+                          max_buffered_elements, std::move(padding_values),
+                          parallel_copy_, output_shapes_);
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, const DatasetBase* input,
+            std::unique_ptr<CapturedFunction> captured_length_func,
+            std::vector<int64> bucket_boundaries, int64 token_budget,
+            int64 max_buffered_elements, std::vector<Tensor> padding_values,
+            bool parallel_copy,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : DatasetBase(DatasetContext(ctx)),
+          input_(input),
+          captured_length_func_(std::move(captured_length_func)),
+          bucket_boundaries_(std::move(bucket_boundaries)),
+          token_budget_(token_budget),
+          max_buffered_elements_(max_buffered_elements),
+          padding_values_(std::move(padding_values)),
+          parallel_copy_(parallel_copy),
+          output_shapes_(output_shapes) {
+      input_->Ref();
+    }
+
+    ~Dataset() override { input_->Unref(); }
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return absl::make_unique<Iterator>(Iterator::Params{
+          this, strings::StrCat(prefix, "::BucketByTokenBudget")});
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return input_->output_dtypes();
+    }
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() const override {
+      return "BucketByTokenBudgetDatasetOp::Dataset";
+    }
+
+    Status CheckExternalState() const override {
+      TF_RETURN_IF_ERROR(captured_length_func_->CheckExternalState());
+      return input_->CheckExternalState();
+    }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* input_graph_node = nullptr;
+      TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+
+      std::vector<Node*> length_func_other_arguments;
+      DataTypeVector length_func_other_arguments_types;
+      TF_RETURN_IF_ERROR(captured_length_func_->AddToGraph(
+          ctx, b, &length_func_other_arguments,
+          &length_func_other_arguments_types));
+
+      Node* bucket_boundaries = nullptr;
+      TF_RETURN_IF_ERROR(b->AddVector(bucket_boundaries_, &bucket_boundaries));
+      Node* token_budget = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(token_budget_, &token_budget));
+      Node* max_buffered_elements = nullptr;
+      TF_RETURN_IF_ERROR(
+          b->AddScalar(max_buffered_elements_, &max_buffered_elements));
+      std::vector<Node*> padding_values;
+      padding_values.reserve(padding_values_.size());
+      for (const Tensor& t : padding_values_) {
+        Node* node;
+        TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+        padding_values.emplace_back(node);
+      }
+
+      AttrValue length_func;
+      b->BuildAttrValue(captured_length_func_->func(), &length_func);
+      AttrValue length_func_other_arguments_types_attr;
+      b->BuildAttrValue(length_func_other_arguments_types,
+                        &length_func_other_arguments_types_attr);
+      AttrValue parallel_copy;
+      b->BuildAttrValue(parallel_copy_, &parallel_copy);
+      AttrValue output_types;
+      b->BuildAttrValue(output_dtypes(), &output_types);
+
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this,
+          {{0, input_graph_node},
+           {2, bucket_boundaries},
+           {3, token_budget},
+           {4, max_buffered_elements}},
+          {{1, length_func_other_arguments}, {5, padding_values}},
+          {{"length_func", length_func},
+           {"Tlength_func_other_arguments",
+            length_func_other_arguments_types_attr},
+           {"parallel_copy", parallel_copy},
+           {"Toutput_types", output_types}},
+          output));
+      return Status::OK();
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params),
+            buckets_(params.dataset->bucket_boundaries_.size() + 1) {}
+
+      Status Initialize(IteratorContext* ctx) override {
+        TF_RETURN_IF_ERROR(
+            dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_));
+        return dataset()->captured_length_func_->Instantiate(
+            ctx, &instantiated_length_func_);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        std::vector<std::vector<Tensor>> batch_elements;
+        {
+          mutex_lock l(mu_);
+          while (ready_batches_.empty() && !end_of_input_) {
+            std::vector<Tensor> element;
+            TF_RETURN_IF_ERROR(
+                input_impl_->GetNext(ctx, &element, &end_of_input_));
+            if (!end_of_input_) {
+              TF_RETURN_IF_ERROR(AddElement(ctx, std::move(element)));
+            }
+          }
+          if (ready_batches_.empty()) {
+            // We have consumed all of the input, so flush the remaining
+            // buckets, shortest sequences first.
+            for (int i = 0; i < buckets_.size(); ++i) {
+              if (!buckets_[i].elements.empty()) {
+                FlushBucket(i);
+                break;
+              }
+            }
+          }
+          if (ready_batches_.empty()) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+          batch_elements = std::move(ready_batches_.front());
+          ready_batches_.pop_front();
+        }
+        *end_of_sequence = false;
+        return PadBatch(ctx, batch_elements, out_tensors);
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeUnknownRatioNode(std::move(args));
+      }
+
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(SaveInput(writer, input_impl_));
+        if (end_of_input_) {
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name("end_of_input"), ""));
+        }
+        for (int i = 0; i < buckets_.size(); ++i) {
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name(strings::StrCat("buckets[", i,
+                                                            "]_max_length")),
+                                  buckets_[i].max_length));
+          TF_RETURN_IF_ERROR(SaveElements(
+              writer, full_name(strings::StrCat("buckets[", i, "]")),
+              buckets_[i].elements));
+        }
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("ready_batches_size"),
+                                               ready_batches_.size()));
+        for (int i = 0; i < ready_batches_.size(); ++i) {
+          TF_RETURN_IF_ERROR(SaveElements(
+              writer, full_name(strings::StrCat("ready_batches[", i, "]")),
+              ready_batches_[i]));
+        }
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+        end_of_input_ = reader->Contains(full_name("end_of_input"));
+        num_buffered_elements_ = 0;
+        for (int i = 0; i < buckets_.size(); ++i) {
+          TF_RETURN_IF_ERROR(
+              reader->ReadScalar(full_name(strings::StrCat("buckets[", i,
+                                                           "]_max_length")),
+                                 &buckets_[i].max_length));
+          TF_RETURN_IF_ERROR(RestoreElements(
+              reader, full_name(strings::StrCat("buckets[", i, "]")),
+              &buckets_[i].elements));
+          num_buffered_elements_ += buckets_[i].elements.size();
+        }
+        int64 ready_batches_size;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("ready_batches_size"),
+                                              &ready_batches_size));
+        ready_batches_.clear();
+        ready_batches_.resize(ready_batches_size);
+        for (int i = 0; i < ready_batches_size; ++i) {
+          TF_RETURN_IF_ERROR(RestoreElements(
+              reader, full_name(strings::StrCat("ready_batches[", i, "]")),
+              &ready_batches_[i]));
+        }
+        return Status::OK();
+      }
+
+     private:
+      struct Bucket {
+        std::vector<std::vector<Tensor>> elements;
+        // The largest length of `elements`, to which they are all padded.
+        int64 max_length = 0;
+      };
+
+      // Adds `element` to the bucket of its length, and moves the buckets which
+      // cannot take any more elements to `ready_batches_`.
+      Status AddElement(IteratorContext* ctx, std::vector<Tensor> element)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        std::vector<Tensor> length_func_output;
+        TF_RETURN_IF_ERROR(instantiated_length_func_->RunWithBorrowedArgs(
+            ctx, element, &length_func_output));
+        if (length_func_output.size() != 1 ||
+            length_func_output[0].dtype() != DT_INT64 ||
+            length_func_output[0].NumElements() != 1) {
+          return errors::InvalidArgument(
+              "`length_func` must return a scalar int64.");
+        }
+        const int64 length = length_func_output[0].scalar<int64>()();
+        if (length < 0) {
+          return errors::InvalidArgument(
+              "`length_func` must return a non-negative length, but got ",
+              length, ".");
+        }
+        const std::vector<int64>& boundaries = dataset()->bucket_boundaries_;
+        const int index =
+            std::upper_bound(boundaries.begin(), boundaries.end(), length) -
+            boundaries.begin();
+        Bucket& bucket = buckets_[index];
+
+        // Elements are padded to the longest element of their batch, so a
+        // batch of `n` elements takes `n * max_length` tokens of the budget.
+        const int64 max_length = std::max(bucket.max_length, length);
+        if (!bucket.elements.empty() &&
+            NumTokens(bucket.elements.size() + 1, max_length) >
+                dataset()->token_budget_) {
+          FlushBucket(index);
+        }
+        bucket.elements.push_back(std::move(element));
+        bucket.max_length = std::max(bucket.max_length, length);
+        ++num_buffered_elements_;
+        if (NumTokens(bucket.elements.size() + 1, bucket.max_length) >
+            dataset()->token_budget_) {
+          // Any further element would exceed the budget.
+          FlushBucket(index);
+        }
+
+        if (dataset()->max_buffered_elements_ != -1 &&
+            num_buffered_elements_ > dataset()->max_buffered_elements_) {
+          // Bound the memory held by partial batches by emitting the one
+          // closest to the budget.
+          int fullest = 0;
+          for (int i = 1; i < buckets_.size(); ++i) {
+            if (NumTokens(buckets_[i].elements.size(), buckets_[i].max_length) >
+                NumTokens(buckets_[fullest].elements.size(),
+                          buckets_[fullest].max_length)) {
+              fullest = i;
+            }
+          }
+          FlushBucket(fullest);
+        }
+        return Status::OK();
+      }
+
+      static int64 NumTokens(size_t num_elements, int64 max_length) {
+        return static_cast<int64>(num_elements) * max_length;
+      }
+
+      void FlushBucket(int index) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        Bucket& bucket = buckets_[index];
+        num_buffered_elements_ -= bucket.elements.size();
+        ready_batches_.push_back(std::move(bucket.elements));
+        bucket.elements.clear();
+        bucket.max_length = 0;
+      }
+
+      // Copies `batch_elements` into one output tensor per tuple component,
+      // padding every dimension to the largest size in the batch.
+      Status PadBatch(IteratorContext* ctx,
+                      const std::vector<std::vector<Tensor>>& batch_elements,
+                      std::vector<Tensor>* out_tensors) {
+        const size_t num_tuple_components = batch_elements[0].size();
+        const int64 num_batch_elements = batch_elements.size();
+        for (size_t component_index = 0;
+             component_index < num_tuple_components; ++component_index) {
+          const TensorShape& first_shape =
+              batch_elements[0][component_index].shape();
+          TensorShape component_shape = first_shape;
+          for (int64 i = 1; i < num_batch_elements; ++i) {
+            const TensorShape& element_shape =
+                batch_elements[i][component_index].shape();
+            if (element_shape.dims() != first_shape.dims()) {
+              return errors::InvalidArgument(
+                  "All elements in a batch must have the same rank for "
+                  "component ",
+                  component_index, ", but got ranks ", first_shape.dims(),
+                  " and ", element_shape.dims());
+            }
+            for (int dim = 0; dim < element_shape.dims(); ++dim) {
+              if (element_shape.dim_size(dim) >
+                  component_shape.dim_size(dim)) {
+                component_shape.set_dim(dim, element_shape.dim_size(dim));
+              }
+            }
+          }
+          TensorShape batch_component_shape({num_batch_elements});
+          batch_component_shape.AppendShape(component_shape);
+
+          out_tensors->emplace_back(ctx->allocator({}),
+                                    output_dtypes()[component_index],
+                                    batch_component_shape);
+          Tensor& batch_component = out_tensors->back();
+          TF_RETURN_IF_ERROR(batch_util::SetElementZero(
+              &batch_component, dataset()->padding_values_[component_index]));
+
+          auto copy_element_fn = [component_index, &batch_elements,
+                                  &batch_component,
+                                  &component_shape](int index) {
+            // Take the fast path if possible.
+            if (batch_elements[index][component_index].shape() ==
+                component_shape) {
+              return batch_util::CopyElementToSlice(
+                  batch_elements[index][component_index], &batch_component,
+                  index);
+            }
+            return batch_util::CopyElementToLargerSlice(
+                batch_elements[index][component_index], &batch_component,
+                index);
+          };
+          BlockingCounter counter(num_batch_elements);
+          Status status;
+          mutex status_mu;
+          for (size_t i = 0; i < num_batch_elements; ++i) {
+            if (TF_PREDICT_FALSE(dataset()->parallel_copy_)) {
+              (*ctx->runner())(
+                  [i, &status, &status_mu, &counter, &copy_element_fn]() {
+                    Status s = copy_element_fn(i);
+                    {
+                      mutex_lock l(status_mu);
+                      status.Update(s);
+                    }
+                    counter.DecrementCount();
+                  });
+            } else {
+              status.Update(copy_element_fn(i));
+              counter.DecrementCount();
+            }
+          }
+          counter.Wait();
+          TF_RETURN_IF_ERROR(status);
+        }
+        return Status::OK();
+      }
+
+      Status SaveElements(IteratorStateWriter* writer, const string& name,
+                          const std::vector<std::vector<Tensor>>& elements)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(strings::StrCat(name, "_size"),
+                                               elements.size()));
+        for (int i = 0; i < elements.size(); ++i) {
+          TF_RETURN_IF_ERROR(writer->WriteScalar(
+              strings::StrCat(name, "[", i, "]_size"), elements[i].size()));
+          for (int j = 0; j < elements[i].size(); ++j) {
+            TF_RETURN_IF_ERROR(writer->WriteTensor(
+                strings::StrCat(name, "[", i, "][", j, "]"), elements[i][j]));
+          }
+        }
+        return Status::OK();
+      }
+
+      Status RestoreElements(IteratorStateReader* reader, const string& name,
+                             std::vector<std::vector<Tensor>>* elements)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        int64 num_elements;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(strings::StrCat(name, "_size"),
+                                              &num_elements));
+        elements->clear();
+        elements->resize(num_elements);
+        for (int i = 0; i < num_elements; ++i) {
+          int64 num_components;
+          TF_RETURN_IF_ERROR(reader->ReadScalar(
+              strings::StrCat(name, "[", i, "]_size"), &num_components));
+          (*elements)[i].resize(num_components);
+          for (int j = 0; j < num_components; ++j) {
+            TF_RETURN_IF_ERROR(
+                reader->ReadTensor(strings::StrCat(name, "[", i, "][", j, "]"),
+                                   &(*elements)[i][j]));
+          }
+        }
+        return Status::OK();
+      }
+
+      mutex mu_;
+      std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
+      bool end_of_input_ GUARDED_BY(mu_) = false;
+      // One bucket per interval between consecutive bucket boundaries.
+      std::vector<Bucket> buckets_ GUARDED_BY(mu_);
+      int64 num_buffered_elements_ GUARDED_BY(mu_) = 0;
+      // The batches which cannot take any more elements, in the order in
+      // which they were completed.
+      std::deque<std::vector<std::vector<Tensor>>> ready_batches_
+          GUARDED_BY(mu_);
+      std::unique_ptr<InstantiatedCapturedFunction> instantiated_length_func_;
+    };
+
+    const DatasetBase* const input_;
+    const std::unique_ptr<CapturedFunction> captured_length_func_;
+    const std::vector<int64> bucket_boundaries_;
+    const int64 token_budget_;
+    const int64 max_buffered_elements_;
+    const std::vector<Tensor> padding_values_;
+    const bool parallel_copy_;
+    const std::vector<PartialTensorShape> output_shapes_;
+  };
+
+  std::shared_ptr<FunctionMetadata> length_func_metadata_ = nullptr;
+  bool parallel_copy_ = false;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("BucketByTokenBudgetDataset").Device(DEVICE_CPU),
+                        BucketByTokenBudgetDatasetOp);
+
+REGISTER_INPUT_COLOCATION_EXEMPTION("BucketByTokenBudgetDataset");
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -127,6 +127,13 @@ class WrapperDataset : public DatasetBase {
 // branches are expected to be stateless. For each iterator that can be produced
 // by a functions output, it is expected to call the input dataset's
 // MakeIterator method at most once; otherwise, undefined behavior may occur.
+//
+// If `reevaluation_period` is positive, the experiments are run again after
+// every `reevaluation_period` elements produced by the selected branch, so
+// that the choice follows changes in the relative speed of the branches, e.g.
+// as caches warm up. The overhead of the experiments is then bounded by the
+// share `num_elements_per_branch * num_branches / reevaluation_period` of the
+// elements.
 class ChooseFastestBranchDatasetOp : public UnaryDatasetOpKernel {
  public:
   explicit ChooseFastestBranchDatasetOp(OpKernelConstruction* ctx)
@@ -145,6 +152,13 @@ class ChooseFastestBranchDatasetOp : public UnaryDatasetOpKernel {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("other_arguments_lengths",
                                      &other_arguments_lengths_));
+    if (ctx->HasAttr("reevaluation_period")) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("reevaluation_period",
+                                       &reevaluation_period_));
+      OP_REQUIRES(ctx, reevaluation_period_ >= 0,
+                  errors::InvalidArgument(
+                      "`reevaluation_period` must be non-negative."));
+    }
 
     OP_REQUIRES(
         ctx, func_metadatas_.size() == other_arguments_lengths_.size(),
@@ -167,6 +181,9 @@ class ChooseFastestBranchDatasetOp : public UnaryDatasetOpKernel {
     OP_REQUIRES(ctx, num_elements_per_branch_ % ratio_denominator_ == 0,
                 errors::InvalidArgument("`num_elements_per_branch` must be "
                                         "divisible by `ratio_denominator`."));
+    OP_REQUIRES(ctx, reevaluation_period_ % ratio_denominator_ == 0,
+                errors::InvalidArgument("`reevaluation_period` must be "
+                                        "divisible by `ratio_denominator`."));
 
     std::vector<std::unique_ptr<CapturedFunction>> captured_funcs(
         func_metadatas_.size());
@@ -188,7 +205,8 @@ class ChooseFastestBranchDatasetOp : public UnaryDatasetOpKernel {
     }
     *output = new Dataset(ctx, input, std::move(captured_funcs), output_types_,
                           output_shapes_, num_elements_per_branch_,
-                          ratio_numerator_, ratio_denominator_);
+                          ratio_numerator_, ratio_denominator_,
+                          reevaluation_period_);
   }
 
  private:
@@ -199,7 +217,7 @@ class ChooseFastestBranchDatasetOp : public UnaryDatasetOpKernel {
             const DataTypeVector& output_types,
             const std::vector<PartialTensorShape>& output_shapes,
             int64 num_elements_per_branch, int64 ratio_numerator,
-            int64 ratio_denominator)
+            int64 ratio_denominator, int64 reevaluation_period)
         : DatasetBase(DatasetContext(ctx)),
           input_(input),
           captured_funcs_(std::move(captured_funcs)),
@@ -207,7 +225,8 @@ class ChooseFastestBranchDatasetOp : public UnaryDatasetOpKernel {
           output_shapes_(output_shapes),
           num_elements_per_branch_(num_elements_per_branch),
           ratio_numerator_(ratio_numerator),
-          ratio_denominator_(ratio_denominator) {
+          ratio_denominator_(ratio_denominator),
+          reevaluation_period_(reevaluation_period) {
       input_->Ref();
     }
 
@@ -300,27 +319,37 @@ class ChooseFastestBranchDatasetOp : public UnaryDatasetOpKernel {
       AttrValue other_arguments_lengths_attr;
       b->BuildAttrValue(other_arguments_lengths, &other_arguments_lengths_attr);
 
+      std::vector<std::pair<StringPiece, AttrValue>> attrs = {
+          std::make_pair("Targuments", other_arguments_types_attr),
+          std::make_pair("num_elements_per_branch",
+                         num_elements_per_branch_attr),
+          std::make_pair("branches", branches_attr),
+          std::make_pair("other_arguments_lengths",
+                         other_arguments_lengths_attr)};
+      // reevaluation_period, which is only added when it is set so that the
+      // graphs of the datasets that do not use it can be run by servers that
+      // predate it.
+      if (reevaluation_period_ > 0) {
+        AttrValue reevaluation_period_attr;
+        b->BuildAttrValue(reevaluation_period_, &reevaluation_period_attr);
+        attrs.emplace_back("reevaluation_period", reevaluation_period_attr);
+      }
+
       return b->AddDataset(
           this,
           /*inputs=*/
           {std::make_pair(0, input_graph_node),
            std::make_pair(1, ratio_numerator_node),
            std::make_pair(2, ratio_denominator_node)},
-          /*list_inputs=*/{std::make_pair(3, other_arguments)},
-          /*attrs=*/
-          {std::make_pair("Targuments", other_arguments_types_attr),
-           std::make_pair("num_elements_per_branch",
-                          num_elements_per_branch_attr),
-           std::make_pair("branches", branches_attr),
-           std::make_pair("other_arguments_lengths",
-                          other_arguments_lengths_attr)},
-          output);
+          /*list_inputs=*/{std::make_pair(3, other_arguments)}, attrs, output);
     }
 
    private:
     // This iterator picks the fastest of dataset branches by running
     // experiments for the first dataset()->num_elements_per_branch_ *
-    // num_branches iterations.
+    // num_branches iterations, and again after every
+    // dataset()->reevaluation_period_ iterations of the selected branch if it
+    // is positive.
     class ChooseFastestIterator : public DatasetIterator<Dataset> {
      public:
       explicit ChooseFastestIterator(const Params& params)
@@ -374,6 +403,27 @@ class ChooseFastestBranchDatasetOp : public UnaryDatasetOpKernel {
             TF_RETURN_IF_ERROR(MakeCurrentIterator(ctx, fastest_index_,
                                                    /*is_experiment=*/false));
           }
+          if (dataset()->reevaluation_period_ > 0) {
+            // The selected branch is replaced once it has produced
+            // `reevaluation_period_` elements, so its iterator is only used
+            // under the lock.
+            TF_RETURN_IF_ERROR(
+                current_iterator_->GetNext(ctx, out_tensors, end_of_sequence));
+            if (!*end_of_sequence) return Status::OK();
+            // The selected branch has produced all its elements, or the input
+            // is exhausted, in which case the experiments end the sequence
+            // too.
+            VLOG(1) << "Reevaluating the branches.";
+            branch_index_ = 0;
+            experiment_counter_ = 0;
+            for (auto& histogram : histograms_) {
+              histogram.Clear();
+            }
+            current_iterator_.reset();
+          }
+        }
+        if (dataset()->reevaluation_period_ > 0) {
+          return GetNextInternal(ctx, out_tensors, end_of_sequence);
         }
 
         return current_iterator_->GetNext(ctx, out_tensors, end_of_sequence);
@@ -495,17 +545,20 @@ class ChooseFastestBranchDatasetOp : public UnaryDatasetOpKernel {
             new WrapperDataset(std::move(params), &dataset()->output_types_,
                                &dataset()->output_shapes_, input_impl_.get());
 
-        if (is_experiment) {
-          // When running experiment iterations, we add a TakeDataset in between
-          // the input and the function datasets. This is so that function
-          // datasets with prefetching behavior won't consume more input
-          // elements than they actually use to produce output.
+        // When running experiment iterations, or the selected branch until the
+        // next reevaluation, we add a TakeDataset in between the input and the
+        // function datasets. This is so that function datasets with
+        // prefetching behavior won't consume more input elements than they
+        // actually use to produce output, and another branch can take over.
+        const int64 num_elements = is_experiment
+                                       ? dataset()->num_elements_per_branch_
+                                       : dataset()->reevaluation_period_;
+        if (num_elements > 0) {
           DatasetContext::Params take_dataset_params;
           take_dataset_params.type_string = "ChooseFastestBranch_Take";
           take_dataset_params.node_name =
               strings::StrCat(take_dataset_params.type_string, branch_index);
-          int64 count = dataset()->num_elements_per_branch_ *
-                        dataset()->ratio_numerator_ /
+          int64 count = num_elements * dataset()->ratio_numerator_ /
                         dataset()->ratio_denominator_;
           temp_dataset = new TakeDataset(std::move(take_dataset_params), count,
                                          temp_dataset);
@@ -545,11 +598,13 @@ class ChooseFastestBranchDatasetOp : public UnaryDatasetOpKernel {
     const int64 num_elements_per_branch_;
     const int64 ratio_numerator_;
     const int64 ratio_denominator_;
+    const int64 reevaluation_period_;
   };  // class Dataset
 
   int64 ratio_numerator_;
   int64 ratio_denominator_;
   int64 num_elements_per_branch_;
+  int64 reevaluation_period_ = 0;
   std::vector<std::shared_ptr<FunctionMetadata>> func_metadatas_;
   DataTypeVector output_types_;
   std::vector<PartialTensorShape> output_shapes_;
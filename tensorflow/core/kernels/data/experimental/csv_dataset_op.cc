@@ -12,6 +12,8 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <cstring>
+
 #include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/op.h"
@@ -26,6 +28,36 @@ namespace data {
 namespace experimental {
 namespace {
 
+constexpr uint64 kLowBits = 0x0101010101010101ULL;
+constexpr uint64 kHighBits = 0x8080808080808080ULL;
+
+// Returns the position of the first character in [begin, end) which is one of
+// `chars`, or `end` if there is none. Eight characters are compared at a time
+// in a 64-bit word, which skips over the bulk of long fields much faster than
+// comparing them one by one.
+const char* FindFirstOf(const char* begin, const char* end,
+                        const std::vector<char>& chars) {
+  const char* p = begin;
+  while (end - p >= 8) {
+    uint64 word;
+    std::memcpy(&word, p, sizeof(word));
+    bool found = false;
+    for (char c : chars) {
+      // A byte of `matches` is zero iff the corresponding character is `c`.
+      const uint64 matches = word ^ (kLowBits * static_cast<uint8>(c));
+      found |= ((matches - kLowBits) & ~matches & kHighBits) != 0;
+    }
+    if (found) break;
+    p += 8;
+  }
+  for (; p < end; ++p) {
+    for (char c : chars) {
+      if (*p == c) return p;
+    }
+  }
+  return end;
+}
+
 class CSVDatasetOp : public DatasetOpKernel {
  public:
   explicit CSVDatasetOp(OpKernelConstruction* ctx) : DatasetOpKernel(ctx) {
@@ -154,7 +186,10 @@ class CSVDatasetOp : public DatasetOpKernel {
           na_value_(std::move(na_value)),
           use_compression_(!compression_type.empty()),
           compression_type_(std::move(compression_type)),
-          options_(options) {}
+          options_(options) {
+      unquoted_field_ends_ = {delim_, '\n', '\r'};
+      if (use_quote_delim_) unquoted_field_ends_.push_back('"');
+    }
 
     std::unique_ptr<IteratorBase> MakeIteratorInternal(
         const string& prefix) const override {
@@ -444,7 +479,7 @@ class CSVDatasetOp : public DatasetOpKernel {
         pos_++;  // Starting quotation mark
 
         Status parse_result;
-        while (true) {  // Each iter reads 1 char, filling buffer if necessary
+        while (true) {  // Each iter reads up to a quote, filling the buffer
           if (pos_ >= buffer_.size()) {
             Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
             if (errors::IsOutOfRange(s)) {
@@ -456,49 +491,52 @@ class CSVDatasetOp : public DatasetOpKernel {
             }
           }
 
-          char ch = buffer_[pos_];
-          if (ch == '"') {
-            // When we encounter a quote, we look ahead to the next character to
-            // decide what to do
-            pos_++;
-            if (pos_ >= buffer_.size()) {
-              Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
-              if (errors::IsOutOfRange(s)) {
-                // This was the last field. We are done
-                *end_of_record = true;
-                parse_result.Update(QuotedFieldToOutput(
-                    ctx, StringPiece(), out_tensors, earlier_pieces, include));
-                return parse_result;
-              } else if (!s.ok()) {
-                return s;
-              }
-            }
-
-            char next = buffer_[pos_];
-            pos_++;
-            if (next == dataset()->delim_) {
-              parse_result.Update(QuotedFieldToOutput(
-                  ctx, StringPiece(&buffer_[start], pos_ - 1 - start),
-                  out_tensors, earlier_pieces, include));
-              return parse_result;
+          // Skip to the next quote, the only character that can end the field
+          const void* quote =
+              std::memchr(&buffer_[pos_], '"', buffer_.size() - pos_);
+          if (quote == nullptr) {
+            pos_ = buffer_.size();
+            continue;
+          }
+          pos_ = static_cast<const char*>(quote) - buffer_.data();
 
-            } else if (next == '\n' || next == '\r') {
+          // When we encounter a quote, we look ahead to the next character to
+          // decide what to do
+          pos_++;
+          if (pos_ >= buffer_.size()) {
+            Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
+            if (errors::IsOutOfRange(s)) {
+              // This was the last field. We are done
               *end_of_record = true;
               parse_result.Update(QuotedFieldToOutput(
-                  ctx, StringPiece(&buffer_[start], pos_ - 1 - start),
-                  out_tensors, earlier_pieces, include));
-              if (next == '\r') SkipNewLineIfNecessary();
+                  ctx, StringPiece(), out_tensors, earlier_pieces, include));
               return parse_result;
-            } else if (next != '"') {
-              // Take note of the error, but keep going to end of field.
-              include = false;  // So we don't get funky errors when trying to
-                                // unescape the quotes.
-              parse_result.Update(errors::InvalidArgument(
-                  "Quote inside a string has to be escaped by another quote"));
+            } else if (!s.ok()) {
+              return s;
             }
+          }
 
-          } else {
-            pos_++;
+          char next = buffer_[pos_];
+          pos_++;
+          if (next == dataset()->delim_) {
+            parse_result.Update(QuotedFieldToOutput(
+                ctx, StringPiece(&buffer_[start], pos_ - 1 - start),
+                out_tensors, earlier_pieces, include));
+            return parse_result;
+
+          } else if (next == '\n' || next == '\r') {
+            *end_of_record = true;
+            parse_result.Update(QuotedFieldToOutput(
+                ctx, StringPiece(&buffer_[start], pos_ - 1 - start),
+                out_tensors, earlier_pieces, include));
+            if (next == '\r') SkipNewLineIfNecessary();
+            return parse_result;
+          } else if (next != '"') {
+            // Take note of the error, but keep going to end of field.
+            include = false;  // So we don't get funky errors when trying to
+                              // unescape the quotes.
+            parse_result.Update(errors::InvalidArgument(
+                "Quote inside a string has to be escaped by another quote"));
           }
         }
       }
@@ -576,7 +614,7 @@ class CSVDatasetOp : public DatasetOpKernel {
         size_t start = pos_;
         Status parse_result;
 
-        while (true) {  // Each iter reads 1 char, filling buffer if necessary
+        while (true) {  // Each iter reads up to a special char, filling buffer
           if (pos_ >= buffer_.size()) {
             Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
             // Handle errors
@@ -592,6 +630,13 @@ class CSVDatasetOp : public DatasetOpKernel {
             }
           }
 
+          // Skip to the next character that may end the field
+          const char* buffer_end = buffer_.data() + buffer_.size();
+          pos_ = FindFirstOf(&buffer_[pos_], buffer_end,
+                             dataset()->unquoted_field_ends_) -
+                 buffer_.data();
+          if (pos_ >= buffer_.size()) continue;
+
           char ch = buffer_[pos_];
 
           if (ch == dataset()->delim_) {
@@ -851,6 +896,9 @@ class CSVDatasetOp : public DatasetOpKernel {
     const bool use_compression_;
     const tstring compression_type_;
     const io::ZlibCompressionOptions options_;
+    // The characters at which parsing an unquoted field stops: the delimiter,
+    // line breaks, and quotes, which are an error in unquoted fields.
+    std::vector<char> unquoted_field_ends_;
   };  // class Dataset
 
   DataTypeVector output_types_;
@@ -0,0 +1,179 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/client.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/name_utils.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+// See documentation in ../../ops/experimental_dataset_ops.cc for a high-level
+// description of the following op.
+
+constexpr char kDatasetType[] = "DataService";
+constexpr char kOutputTypes[] = "output_types";
+constexpr char kOutputShapes[] = "output_shapes";
+
+class DataServiceDatasetOp : public DatasetOpKernel {
+ public:
+  explicit DataServiceDatasetOp(OpKernelConstruction* ctx)
+      : DatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
+    tstring address;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<tstring>(ctx, "address", &address));
+    OP_REQUIRES(ctx, !address.empty(),
+                errors::InvalidArgument("`address` must not be empty."));
+
+    tstring dataset_graph;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<tstring>(ctx, "dataset_graph",
+                                                     &dataset_graph));
+
+    *output = new Dataset(ctx, address, dataset_graph, output_types_,
+                          output_shapes_);
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, const string& address,
+            const string& dataset_graph, const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : DatasetBase(DatasetContext(ctx)),
+          address_(address),
+          dataset_graph_(dataset_graph),
+          output_types_(output_types),
+          output_shapes_(output_shapes) {}
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return absl::make_unique<Iterator>(Iterator::Params{
+          this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() const override {
+      return name_utils::DatasetDebugString(kDatasetType);
+    }
+
+    // The elements are produced by the worker, outside of this process'
+    // control.
+    Status CheckExternalState() const override {
+      return errors::FailedPrecondition(
+          DebugString(), " depends on an external data service worker.");
+    }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* address = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(address_, &address));
+      Node* dataset_graph = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(dataset_graph_, &dataset_graph));
+      TF_RETURN_IF_ERROR(
+          b->AddDataset(this, {address, dataset_graph}, output));
+      return Status::OK();
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      Status Initialize(IteratorContext* ctx) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            DataServiceClient::Create(dataset()->address_, &client_));
+        return client_->RegisterDataset(dataset()->dataset_graph_,
+                                        &dataset_id_);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            client_->GetElement(dataset_id_, out_tensors, end_of_sequence));
+        if (*end_of_sequence) {
+          out_tensors->clear();
+          return Status::OK();
+        }
+        if (out_tensors->size() != dataset()->output_types_.size()) {
+          return errors::InvalidArgument(
+              "Data service worker produced an element with ",
+              out_tensors->size(), " components, but ",
+              dataset()->output_types_.size(), " were expected.");
+        }
+        return Status::OK();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeSourceNode(std::move(args));
+      }
+
+      // The position of the iterator is owned by the worker, and shared with
+      // the other consumers of the same dataset.
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        return errors::Unimplemented(
+            "Checkpointing is not supported for ", dataset()->DebugString());
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        return errors::Unimplemented(
+            "Checkpointing is not supported for ", dataset()->DebugString());
+      }
+
+     private:
+      mutex mu_;
+      std::unique_ptr<DataServiceClient> client_ GUARDED_BY(mu_);
+      int64 dataset_id_ GUARDED_BY(mu_) = -1;
+    };
+
+    const tstring address_;
+    const tstring dataset_graph_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+  };
+
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DataServiceDataset").Device(DEVICE_CPU),
+                        DataServiceDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,375 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <deque>
+#include <vector>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+// See documentation in ../../ops/experimental_dataset_ops.cc for a
+// high-level description of the following op.
+
+constexpr char kDatasetType[] = "ExternalShuffle";
+constexpr char kBufferSize[] = "buffer_size";
+constexpr char kMemoryBufferSize[] = "memory_buffer_size";
+constexpr char kSpillDirectory[] = "spill_directory";
+constexpr char kSeed[] = "seed";
+constexpr char kSeed2[] = "seed2";
+
+// Number of elements read back from a spill file at a time.
+constexpr int64 kSpillReadBatchSize = 64;
+// Size of the read buffer used for each spill file.
+constexpr int64 kSpillReadBufferSize = 256 << 10;  // 256 kB
+
+class ExternalShuffleDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  using UnaryDatasetOpKernel::UnaryDatasetOpKernel;
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override {
+    int64 buffer_size;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<int64>(ctx, kBufferSize, &buffer_size));
+    OP_REQUIRES(
+        ctx, buffer_size > 0,
+        errors::InvalidArgument("buffer_size must be greater than zero."));
+
+    int64 memory_buffer_size;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, kMemoryBufferSize,
+                                                   &memory_buffer_size));
+    OP_REQUIRES(ctx, memory_buffer_size > 0,
+                errors::InvalidArgument(
+                    "memory_buffer_size must be greater than zero."));
+
+    tstring spill_directory;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<tstring>(ctx, kSpillDirectory,
+                                                     &spill_directory));
+    OP_REQUIRES(
+        ctx, !spill_directory.empty(),
+        errors::InvalidArgument("spill_directory must not be empty."));
+
+    int64 seed;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, kSeed, &seed));
+    int64 seed2;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, kSeed2, &seed2));
+    // If both seeds are unspecified, use completely random seeds.
+    if (seed == 0 && seed2 == 0) {
+      seed = random::New64();
+      seed2 = random::New64();
+    }
+
+    *output = new Dataset(ctx, input, buffer_size, memory_buffer_size,
+                          spill_directory, seed, seed2);
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, const DatasetBase* input, int64 buffer_size,
+            int64 memory_buffer_size, const tstring& spill_directory,
+            int64 seed, int64 seed2)
+        : DatasetBase(DatasetContext(ctx)),
+          input_(input),
+          buffer_size_(buffer_size),
+          memory_buffer_size_(std::min(memory_buffer_size, buffer_size)),
+          spill_directory_(spill_directory),
+          seed_(seed),
+          seed2_(seed2) {
+      input_->Ref();
+    }
+
+    ~Dataset() override { input_->Unref(); }
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return absl::make_unique<Iterator>(
+          Iterator::Params{this, strings::StrCat(prefix, "::", kDatasetType)});
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return input_->output_dtypes();
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return input_->output_shapes();
+    }
+
+    string DebugString() const override {
+      return "ExternalShuffleDatasetOp::Dataset";
+    }
+
+    int64 Cardinality() const override { return input_->Cardinality(); }
+
+    Status CheckExternalState() const override {
+      return input_->CheckExternalState();
+    }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* input_graph_node = nullptr;
+      TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+      Node* buffer_size = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(buffer_size_, &buffer_size));
+      Node* memory_buffer_size = nullptr;
+      TF_RETURN_IF_ERROR(
+          b->AddScalar(memory_buffer_size_, &memory_buffer_size));
+      Node* spill_directory = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(spill_directory_, &spill_directory));
+      Node* seed = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(seed_, &seed));
+      Node* seed2 = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(seed2_, &seed2));
+      return b->AddDataset(this,
+                           {input_graph_node, buffer_size, memory_buffer_size,
+                            spill_directory, seed, seed2},
+                           output);
+    }
+
+   private:
+    // Keeps at most `memory_buffer_size` elements of the shuffle buffer in
+    // memory. When the in-memory reservoir is full, it is shuffled and written
+    // sequentially to a new spill file in `spill_directory`. Every output
+    // element is drawn uniformly at random from the whole buffer: if it falls
+    // into a spill file, the next element of that file is produced instead,
+    // which is equivalent because the contents of each spill file are already
+    // in random order. Spill files are read back `kSpillReadBatchSize`
+    // elements at a time and deleted as soon as they are exhausted.
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params),
+            spill_file_prefix_(strings::StrCat("shuffle_spill_",
+                                               random::New64(), "_")),
+            parent_generator_(params.dataset->seed_, params.dataset->seed2_),
+            generator_(&parent_generator_) {}
+
+      ~Iterator() override {
+        for (auto& spill_file : spill_files_) {
+          spill_file->reader.reset();
+          spill_file->file.reset();
+          env_->DeleteFile(spill_file->filename).IgnoreError();
+        }
+      }
+
+      Status Initialize(IteratorContext* ctx) override {
+        env_ = ctx->env();
+        TF_RETURN_IF_ERROR(
+            env_->RecursivelyCreateDir(dataset()->spill_directory_));
+        return dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        while (input_impl_ && num_elements_ < dataset()->buffer_size_) {
+          std::vector<Tensor> element;
+          bool end_of_input_sequence = false;
+          TF_RETURN_IF_ERROR(
+              input_impl_->GetNext(ctx, &element, &end_of_input_sequence));
+          if (end_of_input_sequence) {
+            input_impl_.reset();
+            break;
+          }
+          if (static_cast<int64>(reservoir_.size()) >=
+              dataset()->memory_buffer_size_) {
+            TF_RETURN_IF_ERROR(SpillReservoir(ctx));
+          }
+          RecordBufferEnqueue(ctx, element);
+          reservoir_.push_back(std::move(element));
+          num_elements_++;
+        }
+        if (num_elements_ == 0) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        *end_of_sequence = false;
+        int64 index = Random() % num_elements_;
+        num_elements_--;
+        if (index < static_cast<int64>(reservoir_.size())) {
+          *out_tensors = std::move(reservoir_[index]);
+          RecordBufferDequeue(ctx, *out_tensors);
+          std::swap(reservoir_[index], reservoir_.back());
+          reservoir_.pop_back();
+          return Status::OK();
+        }
+        index -= reservoir_.size();
+        auto it = spill_files_.begin();
+        while (index >= (*it)->num_elements) {
+          index -= (*it)->num_elements;
+          ++it;
+        }
+        SpillFile* spill_file = it->get();
+        if (spill_file->batch.empty()) {
+          TF_RETURN_IF_ERROR(ReadBatch(spill_file));
+        }
+        *out_tensors = std::move(spill_file->batch.front());
+        spill_file->batch.pop_front();
+        spill_file->num_elements--;
+        if (spill_file->num_elements == 0) {
+          spill_file->reader.reset();
+          spill_file->file.reset();
+          TF_RETURN_IF_ERROR(env_->DeleteFile(spill_file->filename));
+          spill_files_.erase(it);
+        }
+        return Status::OK();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeKnownRatioNode(std::move(args),
+                                         /*ratio=*/1);
+      }
+
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        return errors::Unimplemented(
+            "ExternalShuffleDataset does not support checkpointing.");
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        return errors::Unimplemented(
+            "ExternalShuffleDataset does not support checkpointing.");
+      }
+
+     private:
+      // The part of the shuffle buffer that has been written to disk.
+      struct SpillFile {
+        string filename;
+        std::unique_ptr<RandomAccessFile> file;
+        std::unique_ptr<io::SequentialRecordReader> reader;
+        // Elements read from `file` that have not been produced yet.
+        std::deque<std::vector<Tensor>> batch;
+        // Number of elements that have not been produced yet, including the
+        // ones in `batch`.
+        int64 num_elements = 0;
+      };
+
+      random::SingleSampleAdapter<random::PhiloxRandom>::ResultType Random()
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        return generator_();
+      }
+
+      // Shuffles the in-memory reservoir and moves its elements to a new
+      // spill file, writing one record per component.
+      Status SpillReservoir(IteratorContext* ctx)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        for (int64 i = reservoir_.size() - 1; i > 0; --i) {
+          std::swap(reservoir_[i], reservoir_[Random() % (i + 1)]);
+        }
+        auto spill_file = absl::make_unique<SpillFile>();
+        spill_file->filename =
+            io::JoinPath(dataset()->spill_directory_,
+                         strings::StrCat(spill_file_prefix_, num_spills_++));
+        {
+          std::unique_ptr<WritableFile> file;
+          TF_RETURN_IF_ERROR(
+              env_->NewWritableFile(spill_file->filename, &file));
+          io::RecordWriter writer(file.get());
+          string record;
+          for (const std::vector<Tensor>& element : reservoir_) {
+            for (const Tensor& component : element) {
+              TensorProto proto;
+              component.AsProtoTensorContent(&proto);
+              proto.SerializeToString(&record);
+              TF_RETURN_IF_ERROR(writer.WriteRecord(record));
+            }
+            RecordBufferDequeue(ctx, element);
+          }
+          TF_RETURN_IF_ERROR(writer.Close());
+          TF_RETURN_IF_ERROR(file->Close());
+        }
+        TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(spill_file->filename,
+                                                     &spill_file->file));
+        io::RecordReaderOptions options;
+        options.buffer_size = kSpillReadBufferSize;
+        spill_file->reader = absl::make_unique<io::SequentialRecordReader>(
+            spill_file->file.get(), options);
+        spill_file->num_elements = reservoir_.size();
+        spill_files_.push_back(std::move(spill_file));
+        reservoir_.clear();
+        return Status::OK();
+      }
+
+      // Reads the next batch of elements of `spill_file` into memory.
+      Status ReadBatch(SpillFile* spill_file) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const int64 num_components = dataset()->output_dtypes().size();
+        const int64 batch_size =
+            std::min(kSpillReadBatchSize, spill_file->num_elements);
+        tstring record;
+        for (int64 i = 0; i < batch_size; ++i) {
+          std::vector<Tensor> element(num_components);
+          for (int64 j = 0; j < num_components; ++j) {
+            TF_RETURN_IF_ERROR(spill_file->reader->ReadRecord(&record));
+            TensorProto proto;
+            if (!proto.ParseFromArray(record.data(), record.size()) ||
+                !element[j].FromProto(proto)) {
+              return errors::DataLoss("Corrupted shuffle spill file: ",
+                                      spill_file->filename);
+            }
+          }
+          spill_file->batch.push_back(std::move(element));
+        }
+        return Status::OK();
+      }
+
+      const string spill_file_prefix_;
+      Env* env_ = nullptr;
+
+      mutex mu_;
+      std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
+      // Number of buffered elements, in memory and on disk.
+      int64 num_elements_ GUARDED_BY(mu_) = 0;
+      std::vector<std::vector<Tensor>> reservoir_ GUARDED_BY(mu_);
+      std::deque<std::unique_ptr<SpillFile>> spill_files_ GUARDED_BY(mu_);
+      int64 num_spills_ GUARDED_BY(mu_) = 0;
+      random::PhiloxRandom parent_generator_ GUARDED_BY(mu_);
+      random::SingleSampleAdapter<random::PhiloxRandom> generator_
+          GUARDED_BY(mu_);
+    };
+
+    const DatasetBase* const input_;
+    const int64 buffer_size_;
+    const int64 memory_buffer_size_;
+    const tstring spill_directory_;
+    const int64 seed_;
+    const int64 seed2_;
+  };
+};
+
+REGISTER_KERNEL_BUILDER(Name("ExternalShuffleDataset").Device(DEVICE_CPU),
+                        ExternalShuffleDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
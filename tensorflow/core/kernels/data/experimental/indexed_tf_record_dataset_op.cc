@@ -0,0 +1,310 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/metrics.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/name_utils.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+// See documentation in ../../ops/experimental_dataset_ops.cc for a high-level
+// description of the following op.
+
+constexpr char kDatasetType[] = "IndexedTFRecord";
+constexpr char kCurrentFileIndex[] = "current_file_index";
+constexpr char kNextRecord[] = "next_record";
+
+class IndexedTFRecordDatasetOp : public DatasetOpKernel {
+ public:
+  using DatasetOpKernel::DatasetOpKernel;
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
+    const Tensor* filenames_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("filenames", &filenames_tensor));
+    OP_REQUIRES(
+        ctx, filenames_tensor->dims() <= 1,
+        errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+
+    std::vector<string> filenames;
+    filenames.reserve(filenames_tensor->NumElements());
+    for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+      filenames.push_back(filenames_tensor->flat<tstring>()(i));
+    }
+
+    int64 num_shards;
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument<int64>(ctx, "num_shards", &num_shards));
+    OP_REQUIRES(ctx, num_shards > 0,
+                errors::InvalidArgument("`num_shards` must be > 0"));
+
+    int64 shard_index;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<int64>(ctx, "shard_index", &shard_index));
+    OP_REQUIRES(
+        ctx, shard_index >= 0 && shard_index < num_shards,
+        errors::InvalidArgument("`shard_index` must be in [0, num_shards)"));
+
+    int64 buffer_size;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<int64>(ctx, "buffer_size", &buffer_size));
+    OP_REQUIRES(ctx, buffer_size >= 0,
+                errors::InvalidArgument(
+                    "`buffer_size` must be >= 0 (0 == no buffering)"));
+
+    *output = new Dataset(ctx, std::move(filenames), num_shards, shard_index,
+                          buffer_size);
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+            int64 num_shards, int64 shard_index, int64 buffer_size)
+        : DatasetBase(DatasetContext(ctx)),
+          filenames_(std::move(filenames)),
+          num_shards_(num_shards),
+          shard_index_(shard_index) {
+      options_.buffer_size = buffer_size;
+    }
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return absl::make_unique<Iterator>(Iterator::Params{
+          this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      static DataTypeVector* dtypes = new DataTypeVector({DT_STRING});
+      return *dtypes;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      static std::vector<PartialTensorShape>* shapes =
+          new std::vector<PartialTensorShape>({{}});
+      return *shapes;
+    }
+
+    string DebugString() const override {
+      return name_utils::DatasetDebugString(kDatasetType);
+    }
+
+    Status CheckExternalState() const override { return Status::OK(); }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* filenames = nullptr;
+      TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+      Node* num_shards = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(num_shards_, &num_shards));
+      Node* shard_index = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(shard_index_, &shard_index));
+      Node* buffer_size = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(options_.buffer_size, &buffer_size));
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this, {filenames, num_shards, shard_index, buffer_size}, output));
+      return Status::OK();
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        do {
+          // We are currently processing a file, so try to read the next
+          // record of our shard.
+          if (reader_) {
+            if (next_record_ < shard_end_) {
+              out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
+                                        TensorShape({}));
+              uint64 offset = offsets_[next_record_];
+              Status s = reader_->ReadRecord(
+                  &offset, &out_tensors->back().scalar<tstring>()());
+              if (s.ok()) {
+                metrics::RecordTFDataBytesRead(
+                    kDatasetType,
+                    out_tensors->back().scalar<tstring>()().size());
+                ++next_record_;
+                *end_of_sequence = false;
+                return Status::OK();
+              }
+              out_tensors->pop_back();
+              if (errors::IsOutOfRange(s)) {
+                s = errors::DataLoss(
+                    "Record index of ",
+                    dataset()->filenames_[current_file_index_],
+                    " points past the end of the file");
+              }
+              // Move forward the file index so that it works with
+              // ignore_errors. Otherwise the same file will repeat.
+              ResetStreamsLocked();
+              ++current_file_index_;
+              return s;
+            }
+
+            // We have read our shard of the current file, so maybe move on
+            // to the next file.
+            ResetStreamsLocked();
+            ++current_file_index_;
+          }
+
+          // Iteration ends when there are no more files to process.
+          if (current_file_index_ == dataset()->filenames_.size()) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+
+          TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+        } while (true);
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeSourceNode(std::move(args));
+      }
+
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kCurrentFileIndex),
+                                               current_file_index_));
+        if (reader_) {
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name(kNextRecord), next_record_));
+        }
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        ResetStreamsLocked();
+        int64 current_file_index;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kCurrentFileIndex),
+                                              &current_file_index));
+        current_file_index_ = size_t(current_file_index);
+        if (reader->Contains(full_name(kNextRecord))) {
+          int64 next_record;
+          TF_RETURN_IF_ERROR(
+              reader->ReadScalar(full_name(kNextRecord), &next_record));
+          TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+          // The index lets us resume directly at the saved record, without
+          // scanning the records that precede it.
+          if (next_record < shard_begin_ || next_record > shard_end_) {
+            return errors::InvalidArgument(
+                "Saved record ", next_record, " is outside of shard [",
+                shard_begin_, ", ", shard_end_, ") of ",
+                dataset()->filenames_[current_file_index_]);
+          }
+          next_record_ = next_record;
+        }
+        return Status::OK();
+      }
+
+     private:
+      // Sets up reader streams to read from the file at `current_file_index_`
+      // and positions them at the first record of our shard.
+      Status SetupStreamsLocked(Env* env) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (current_file_index_ >= dataset()->filenames_.size()) {
+          return errors::InvalidArgument(
+              "current_file_index_:", current_file_index_,
+              " >= filenames_.size():", dataset()->filenames_.size());
+        }
+
+        const string& filename = dataset()->filenames_[current_file_index_];
+        const string index_filename =
+            strings::StrCat(filename, io::RecordWriter::kIndexSuffix);
+        std::unique_ptr<RandomAccessFile> index_file;
+        Status s = env->NewRandomAccessFile(index_filename, &index_file);
+        if (errors::IsNotFound(s)) {
+          return errors::NotFound(
+              "Could not find the record index ", index_filename, " of ",
+              filename, ". Write the file with RecordWriterOptions::"
+              "build_index set to produce one.");
+        }
+        TF_RETURN_IF_ERROR(s);
+        TF_RETURN_IF_ERROR(
+            io::RecordReader::ReadIndex(index_file.get(), &offsets_));
+
+        // Split the records of the file into `num_shards` contiguous ranges
+        // of (almost) equal size. The last entry of `offsets_` is the end of
+        // the file rather than a record.
+        const int64 num_records = offsets_.size() - 1;
+        shard_begin_ =
+            num_records * dataset()->shard_index_ / dataset()->num_shards_;
+        shard_end_ = num_records * (dataset()->shard_index_ + 1) /
+                     dataset()->num_shards_;
+        next_record_ = shard_begin_;
+
+        TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file_));
+        reader_ = absl::make_unique<io::RecordReader>(file_.get(),
+                                                      dataset()->options_);
+        return Status::OK();
+      }
+
+      // Resets all reader streams.
+      void ResetStreamsLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        reader_.reset();
+        file_.reset();
+        offsets_.clear();
+        shard_begin_ = 0;
+        shard_end_ = 0;
+        next_record_ = 0;
+      }
+
+      mutex mu_;
+      size_t current_file_index_ GUARDED_BY(mu_) = 0;
+
+      // Record offsets of the current file, and the range of records that
+      // belong to our shard.
+      std::vector<uint64> offsets_ GUARDED_BY(mu_);
+      int64 shard_begin_ GUARDED_BY(mu_) = 0;
+      int64 shard_end_ GUARDED_BY(mu_) = 0;
+      int64 next_record_ GUARDED_BY(mu_) = 0;
+
+      // `reader_` will borrow the object that `file_` points to, so
+      // we must destroy `reader_` before `file_`.
+      std::unique_ptr<RandomAccessFile> file_ GUARDED_BY(mu_);
+      std::unique_ptr<io::RecordReader> reader_ GUARDED_BY(mu_);
+    };
+
+    const std::vector<string> filenames_;
+    const int64 num_shards_;
+    const int64 shard_index_;
+    io::RecordReaderOptions options_;
+  };
+};
+
+REGISTER_KERNEL_BUILDER(Name("IndexedTFRecordDataset").Device(DEVICE_CPU),
+                        IndexedTFRecordDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -327,12 +327,22 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
           thread::ThreadPool* device_threadpool =
               ctx->flr()->device()->tensorflow_cpu_worker_threads()->workers;
           std::vector<tstring> slice_vec;
-          for (const Tensor& t : input) {
-            auto serialized_t = t.flat<tstring>();
-            gtl::ArraySlice<tstring> slice(serialized_t.data(),
-                                           serialized_t.size());
-            for (auto it = slice.begin(); it != slice.end(); it++)
-              slice_vec.push_back(*it);
+          gtl::ArraySlice<tstring> serialized;
+          if (input.size() == 1) {
+            // Parse the batch of serialized examples in place, rather than
+            // copying every one of them first.
+            auto serialized_t = input[0].flat<tstring>();
+            serialized = gtl::ArraySlice<tstring>(serialized_t.data(),
+                                                  serialized_t.size());
+          } else {
+            for (const Tensor& t : input) {
+              auto serialized_t = t.flat<tstring>();
+              gtl::ArraySlice<tstring> slice(serialized_t.data(),
+                                             serialized_t.size());
+              for (auto it = slice.begin(); it != slice.end(); it++)
+                slice_vec.push_back(*it);
+            }
+            serialized = slice_vec;
           }
           example::FastParseExampleConfig config = dataset_->config_;
           // local copy of config_ for modification.
@@ -341,7 +351,7 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
             config.collect_feature_stats = true;
           }
           example::Result example_result;
-          Status s = FastParseExample(config, slice_vec, {}, device_threadpool,
+          Status s = FastParseExample(config, serialized, {}, device_threadpool,
                                       &example_result);
           if (s.ok()) {
             (*output).resize(dataset_->key_to_output_index_.size());
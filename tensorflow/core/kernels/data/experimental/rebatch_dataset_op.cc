@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
+#include "tensorflow/core/lib/math/math_util.h"
 
 namespace tensorflow {
 namespace data {
@@ -148,6 +149,7 @@ class RebatchDatasetOp : public UnaryDatasetOpKernel {
                 CeilDiv(original_batch_dim, dataset()->num_replicas_);
             input_descriptors_.push_back(
                 {std::move(input_tensors[i]), original_batch_dim, interval});
+            AlignSlices(ctx, &input_descriptors_.back());
           }
         }
 
@@ -166,6 +168,12 @@ class RebatchDatasetOp : public UnaryDatasetOpKernel {
             // the remaining iterations that correspond to this batch.
             start = end;
           }
+          if (input_desc.aligned_interval > 0) {
+            const int64 offset = input_desc.aligned_interval * slice_number_;
+            out_tensors->push_back(input_desc.aligned_tensor.Slice(
+                offset, offset + end - start));
+            continue;
+          }
           Tensor slice = input_desc.whole_tensor.Slice(start, end);
           if (slice.IsAligned()) {
             out_tensors->push_back(std::move(slice));
@@ -223,6 +231,7 @@ class RebatchDatasetOp : public UnaryDatasetOpKernel {
             input_descriptors_[i].interval =
                 CeilDiv(input_descriptors_[i].original_batch_dim,
                         dataset()->num_replicas_);
+            AlignSlices(ctx, &input_descriptors_[i]);
           }
         }
         return Status::OK();
@@ -241,8 +250,57 @@ class RebatchDatasetOp : public UnaryDatasetOpKernel {
         Tensor whole_tensor;
         int64 original_batch_dim;
         int64 interval;
+        // If the slices of `whole_tensor` are not all aligned, a copy of
+        // `whole_tensor` in which the slice of each replica starts at a
+        // multiple of `aligned_interval` rows, which is aligned.
+        Tensor aligned_tensor;
+        int64 aligned_interval = 0;
       };
 
+      // Slices of a tensor alias its buffer, but they can only be returned if
+      // they are aligned. Most components, e.g. images, have rows whose size
+      // is a multiple of the alignment, so that all their slices are aligned
+      // and returned without copying. Otherwise, rather than copying each
+      // unaligned slice into its own buffer, the component is copied once
+      // into a buffer which is padded so that every slice starts aligned.
+      void AlignSlices(IteratorContext* ctx, InputDescriptor* desc) {
+        desc->aligned_tensor = Tensor();
+        desc->aligned_interval = 0;
+        const Tensor& tensor = desc->whole_tensor;
+        if (!DataTypeCanUseMemcpy(tensor.dtype()) ||
+            desc->original_batch_dim == 0) {
+          return;
+        }
+        const uint64 row_bytes = tensor.TotalBytes() / desc->original_batch_dim;
+        if (row_bytes == 0) return;
+        if (tensor.IsAligned() &&
+            (desc->interval * row_bytes) % EIGEN_MAX_ALIGN_BYTES == 0) {
+          return;
+        }
+        // The number of rows whose size is a multiple of the alignment.
+        const int64 rows_per_alignment =
+            EIGEN_MAX_ALIGN_BYTES /
+            MathUtil::GCD<uint64>(row_bytes, EIGEN_MAX_ALIGN_BYTES);
+        const int64 aligned_interval =
+            MathUtil::CeilOfRatio(desc->interval, rows_per_alignment) *
+            rows_per_alignment;
+        TensorShape shape = tensor.shape();
+        shape.set_dim(0, aligned_interval * dataset()->num_replicas_);
+        Tensor aligned_tensor(ctx->allocator({}), tensor.dtype(), shape);
+        const char* src = tensor.tensor_data().data();
+        char* dst = const_cast<char*>(aligned_tensor.tensor_data().data());
+        for (int64 i = 0; i < dataset()->num_replicas_; ++i) {
+          const int64 start =
+              std::min(desc->interval * i, desc->original_batch_dim);
+          const int64 end =
+              std::min(start + desc->interval, desc->original_batch_dim);
+          memcpy(dst + aligned_interval * i * row_bytes,
+                 src + start * row_bytes, (end - start) * row_bytes);
+        }
+        desc->aligned_tensor = std::move(aligned_tensor);
+        desc->aligned_interval = aligned_interval;
+      }
+
       mutex mu_;
       std::unique_ptr<IteratorBase> input_impl_;
       std::vector<InputDescriptor> input_descriptors_ GUARDED_BY(mu_);
@@ -60,6 +60,10 @@ const int64 kDefaultShardSizeBytes = 10LL * 1024 * 1024 * 1024;
 
 const int64 kSnappyBufferSizeBytes = 256 << 10;  // 256 KB
 
+// Read-ahead used for uncompressed snapshot files, so that each reader thread
+// issues large sequential reads instead of one small read per record.
+const int64 kReaderReadAheadBytes = 8 << 20;  // 8 MB
+
 const size_t kHeaderSize = sizeof(uint64);
 
 constexpr char kSnapshotFilename[] = "snapshot.metadata";
@@ -163,6 +167,12 @@ class SnapshotReader {
       : file_(file),
         input_stream_(new io::RandomAccessInputStream(file)),
         compression_type_(compression_type) {
+    if (compression_type_ == io::compression::kNone) {
+      input_stream_ = absl::make_unique<io::BufferedInputStream>(
+          input_stream_.release(), kReaderReadAheadBytes,
+          /*owns_input_stream=*/true);
+      read_ahead_ = true;
+    }
 #if defined(IS_SLIM_BUILD)
     if (compression_type_ != io::compression::kNone) {
       LOG(ERROR) << "Compression is unsupported on mobile platforms. Turning "
@@ -202,7 +212,7 @@ class SnapshotReader {
     TF_RETURN_IF_ERROR(input_stream_->ReadNBytes(kHeaderSize, &header));
     uint64 length = core::DecodeFixed64(header.data());
 
-    if (compression_type_ == io::compression::kNone) {
+    if (compression_type_ == io::compression::kNone && !read_ahead_) {
       return input_stream_->ReadNBytes(length, record);
     } else {
       tstring tmp_str;
@@ -217,6 +227,9 @@ class SnapshotReader {
   RandomAccessFile* file_;
   std::unique_ptr<io::InputStreamInterface> input_stream_;
   const string compression_type_;
+  // True if input_stream_ is a BufferedInputStream, which only supports
+  // reading into strings.
+  bool read_ahead_ = false;
 };
 
 Status WriteMetadataFile(const string& hash_dir,
@@ -328,9 +341,21 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
     }
 
     if (num_reader_threads_ == -1) num_reader_threads_ = 1;
-    if (reader_buffer_size_ == -1) reader_buffer_size_ = 1;
     if (num_writer_threads_ == -1) num_writer_threads_ = 1;
-    if (writer_buffer_size_ == -1) writer_buffer_size_ = 1;
+    // By default, buffer one element per background thread so that every
+    // reader can read ahead and every writer can compress while the iterator
+    // thread is busy producing or consuming the next element.
+    if (reader_buffer_size_ == -1) reader_buffer_size_ = num_reader_threads_;
+    if (writer_buffer_size_ == -1) writer_buffer_size_ = num_writer_threads_;
+
+    OP_REQUIRES(ctx, num_reader_threads_ > 0 && num_writer_threads_ > 0,
+                errors::InvalidArgument(
+                    "num_reader_threads and num_writer_threads must be "
+                    "positive or -1."));
+    OP_REQUIRES(ctx, reader_buffer_size_ > 0 && writer_buffer_size_ > 0,
+                errors::InvalidArgument(
+                    "reader_buffer_size and writer_buffer_size must be "
+                    "positive or -1."));
 
     OP_REQUIRES(
         ctx,
@@ -678,7 +703,8 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
         // Reads one file end to end.
         Status ReadFile(const string& filename) {
           std::unique_ptr<RandomAccessFile> file;
-          TF_CHECK_OK(Env::Default()->NewRandomAccessFile(filename, &file));
+          TF_RETURN_IF_ERROR(
+              Env::Default()->NewRandomAccessFile(filename, &file));
           std::unique_ptr<SnapshotReader> reader(
               new SnapshotReader(file.get(), dataset()->compression_));
 
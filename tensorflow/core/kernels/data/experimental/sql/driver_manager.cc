@@ -13,21 +13,64 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/experimental/sql/driver_manager.h"
+
+#include <map>
+
 #include "tensorflow/core/kernels/data/experimental/sql/sqlite_query_connection.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 namespace data {
 namespace experimental {
 namespace sql {
+namespace {
+
+mutex* get_drivers_lock() {
+  static mutex drivers_lock(LINKER_INITIALIZED);
+  return &drivers_lock;
+}
+
+std::map<string, DriverManager::Factory>* drivers() {
+  // The `sqlite` driver is registered here rather than with
+  // `REGISTER_SQL_DRIVER`, so that it is available even if the linker drops
+  // its registration.
+  static auto* drivers = new std::map<string, DriverManager::Factory>(
+      {{"sqlite", []() {
+          return std::unique_ptr<QueryConnection>(new SqliteQueryConnection());
+        }}});
+  return drivers;
+}
+
+}  // namespace
+
+void DriverManager::RegisterDriver(const string& driver_name,
+                                   Factory factory) {
+  mutex_lock l(*get_drivers_lock());
+  if (!drivers()->emplace(driver_name, std::move(factory)).second) {
+    LOG(WARNING) << "Ignoring the registration of a second SQL driver for "
+                 << driver_name << ".";
+  }
+}
+
+std::vector<string> DriverManager::RegisteredDrivers() {
+  mutex_lock l(*get_drivers_lock());
+  std::vector<string> result;
+  for (const auto& driver : *drivers()) {
+    result.push_back(driver.first);
+  }
+  return result;
+}
 
 std::unique_ptr<QueryConnection> DriverManager::CreateQueryConnection(
     const string& driver_name) {
-  if (driver_name == "sqlite") {
-    return std::unique_ptr<SqliteQueryConnection>(new SqliteQueryConnection());
-  } else {  // TODO(b/64276826, b/64276995) Add support for other db types.
-            // Change to registry pattern.
-    return nullptr;
+  Factory factory;
+  {
+    mutex_lock l(*get_drivers_lock());
+    auto it = drivers()->find(driver_name);
+    if (it == drivers()->end()) return nullptr;
+    factory = it->second;
   }
+  return factory();
 }
 
 }  // namespace sql
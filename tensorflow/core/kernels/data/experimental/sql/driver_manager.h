@@ -15,7 +15,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_SQL_DRIVER_MANAGER_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_SQL_DRIVER_MANAGER_H_
 
+#include <functional>
+#include <memory>
+#include <vector>
+
 #include "tensorflow/core/kernels/data/experimental/sql/query_connection.h"
+#include "tensorflow/core/platform/macros.h"
 
 namespace tensorflow {
 namespace data {
@@ -25,16 +30,43 @@ namespace sql {
 // A factory class for creating `QueryConnection` instances.
 class DriverManager {
  public:
+  using Factory = std::function<std::unique_ptr<QueryConnection>()>;
+
+  // Registers `factory` as the factory of the connections of the
+  // `driver_name` database type. The `sqlite` driver is always registered.
+  static void RegisterDriver(const string& driver_name, Factory factory);
+
+  // Returns the sorted names of the registered database types.
+  static std::vector<string> RegisteredDrivers();
+
   // A factory method for creating `QueryConnection` instances.
   //
   // `driver_name` is the database type (e.g. 'sqlite'). `driver_name`
   // corresponds to a `QueryConnection` subclass. For example, if `driver_name`
   // == `sqlite`, then `CreateQueryConnection` will create a
-  // `SqliteQueryConnection` instance.
+  // `SqliteQueryConnection` instance. Returns `nullptr` if no driver is
+  // registered under `driver_name`.
   static std::unique_ptr<QueryConnection> CreateQueryConnection(
       const string& driver_name);
 };
 
+// Registers a driver for the `driver_name` database type, whose connections
+// are instances of the `QueryConnection` subclass `connection_class`.
+#define REGISTER_SQL_DRIVER(driver_name, connection_class) \
+  REGISTER_SQL_DRIVER_UNIQ_HELPER(__COUNTER__, driver_name, connection_class)
+#define REGISTER_SQL_DRIVER_UNIQ_HELPER(ctr, driver_name, connection_class) \
+  REGISTER_SQL_DRIVER_UNIQ(ctr, driver_name, connection_class)
+#define REGISTER_SQL_DRIVER_UNIQ(ctr, driver_name, connection_class)         \
+  static bool sql_driver_registration_##ctr TF_ATTRIBUTE_UNUSED = []() {    \
+    ::tensorflow::data::experimental::sql::DriverManager::RegisterDriver(   \
+        driver_name, []() {                                                 \
+          return std::unique_ptr<                                           \
+              ::tensorflow::data::experimental::sql::QueryConnection>(      \
+              new connection_class());                                      \
+        });                                                                 \
+    return true;                                                            \
+  }()
+
 }  // namespace sql
 }  // namespace experimental
 }  // namespace data
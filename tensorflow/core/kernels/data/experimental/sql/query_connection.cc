@@ -0,0 +1,55 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/sql/query_connection.h"
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace sql {
+
+Status QueryConnection::GetNextBatch(IteratorContext* ctx, int64 batch_size,
+                                     std::vector<Tensor>* out_tensors,
+                                     int64* num_rows) {
+  std::vector<std::vector<Tensor>> rows;
+  bool end_of_sequence = false;
+  while (static_cast<int64>(rows.size()) < batch_size) {
+    std::vector<Tensor> row;
+    TF_RETURN_IF_ERROR(GetNext(ctx, &row, &end_of_sequence));
+    if (end_of_sequence) break;
+    rows.push_back(std::move(row));
+  }
+  *num_rows = rows.size();
+  if (rows.empty()) return Status::OK();
+
+  out_tensors->clear();
+  out_tensors->reserve(rows[0].size());
+  for (int i = 0; i < rows[0].size(); ++i) {
+    out_tensors->emplace_back(ctx->allocator({}), rows[0][i].dtype(),
+                              TensorShape({*num_rows}));
+    for (int64 j = 0; j < *num_rows; ++j) {
+      TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
+          std::move(rows[j][i]), &out_tensors->back(), j));
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace sql
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
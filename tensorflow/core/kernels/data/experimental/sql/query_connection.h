@@ -63,6 +63,23 @@ class QueryConnection {
   // undefined.
   virtual Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
                          bool* end_of_sequence) = 0;
+
+  // Retrieves up to `batch_size` of the next rows of the result set of the
+  // query from the most recent call to `Open()`.
+  //
+  // The columns of the rows will be stored in `*out_tensors` as vectors of
+  // `*num_rows` elements. If there are no more rows in the result set, then
+  // `0` will be stored in `*num_rows`, and the content of `*out_tensors` will
+  // be undefined. Fewer than `batch_size` rows are only returned at the end of
+  // the result set.
+  //
+  // The default implementation calls `GetNext()` for each row. Drivers which
+  // can produce the values of a column for many rows at once, e.g. those of
+  // columnar databases, should override it to write them directly into the
+  // output tensors.
+  virtual Status GetNextBatch(IteratorContext* ctx, int64 batch_size,
+                              std::vector<Tensor>* out_tensors,
+                              int64* num_rows);
 };
 
 }  // namespace sql
@@ -60,12 +60,47 @@ Status SqliteQueryConnection::GetNext(IteratorContext* ctx,
       DataType dt = output_types_[i];
       // TODO(mrry): Pass in the `IteratorContext::allocator()`.
       out_tensors->emplace_back(ctx->allocator({}), dt, TensorShape({}));
-      FillTensorWithResultSetEntry(dt, i, &out_tensors->back());
+      FillTensorWithResultSetEntry(dt, i, 0, &out_tensors->back());
     }
   }
   return Status::OK();
 }
 
+Status SqliteQueryConnection::GetNextBatch(IteratorContext* ctx,
+                                           int64 batch_size,
+                                           std::vector<Tensor>* out_tensors,
+                                           int64* num_rows) {
+  if (!stmt_) TF_RETURN_IF_ERROR(PrepareQuery());
+  std::vector<Tensor> columns;
+  columns.reserve(column_count_);
+  for (int i = 0; i < column_count_; i++) {
+    columns.emplace_back(ctx->allocator({}), output_types_[i],
+                         TensorShape({batch_size}));
+  }
+  *num_rows = 0;
+  bool end_of_sequence = false;
+  while (*num_rows < batch_size) {
+    TF_RETURN_IF_ERROR(stmt_.Step(&end_of_sequence));
+    if (end_of_sequence) break;
+    for (int i = 0; i < column_count_; i++) {
+      FillTensorWithResultSetEntry(output_types_[i], i, *num_rows,
+                                   &columns[i]);
+    }
+    ++*num_rows;
+  }
+  if (*num_rows == 0) return Status::OK();
+  out_tensors->clear();
+  out_tensors->reserve(column_count_);
+  for (Tensor& column : columns) {
+    // A prefix of a tensor is aligned, so the last, partial batch can share the
+    // buffer of the full one.
+    out_tensors->push_back(*num_rows < batch_size
+                               ? column.Slice(0, *num_rows)
+                               : std::move(column));
+  }
+  return Status::OK();
+}
+
 Status SqliteQueryConnection::PrepareQuery() {
   TF_RETURN_IF_ERROR(db_->Prepare(query_, &stmt_));
   int column_count = stmt_.ColumnCount();
@@ -81,10 +116,10 @@ Status SqliteQueryConnection::PrepareQuery() {
 }
 
 void SqliteQueryConnection::FillTensorWithResultSetEntry(
-    const DataType& data_type, int column_index, Tensor* tensor) {
-#define CASE(T, M)                                                 \
-  case DataTypeToEnum<T>::value:                                   \
-    tensor->scalar<T>()() = static_cast<T>(stmt_.M(column_index)); \
+    const DataType& data_type, int column_index, int64 index, Tensor* tensor) {
+#define CASE(T, M)                                                     \
+  case DataTypeToEnum<T>::value:                                       \
+    tensor->flat<T>()(index) = static_cast<T>(stmt_.M(column_index)); \
     break;
 #define INT_CASE(T) CASE(T, ColumnInt)
 #define DOUBLE_CASE(T) CASE(T, ColumnDouble)
@@ -103,7 +138,7 @@ void SqliteQueryConnection::FillTensorWithResultSetEntry(
     TF_CALL_double(DOUBLE_CASE)
     TF_CALL_tstring(STRING_CASE)
     case DT_BOOL:
-      tensor->scalar<bool>()() = stmt_.ColumnInt(column_index) != 0;
+      tensor->flat<bool>()(index) = stmt_.ColumnInt(column_index) != 0;
       break;
     // Error preemptively thrown by SqlDatasetOp::MakeDataset in this case.
     default:
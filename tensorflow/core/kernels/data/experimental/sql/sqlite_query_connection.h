@@ -35,14 +35,17 @@ class SqliteQueryConnection : public QueryConnection {
   Status Close() override;
   Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
                  bool* end_of_sequence) override;
+  Status GetNextBatch(IteratorContext* ctx, int64 batch_size,
+                      std::vector<Tensor>* out_tensors,
+                      int64* num_rows) override;
 
  private:
   // Prepares the query string `query_`.
   Status PrepareQuery();
-  // Fills `tensor` with the column_index_th element of the current row of
-  // `stmt_`.
+  // Fills the `index`th element of `tensor` with the column_index_th element
+  // of the current row of `stmt_`.
   void FillTensorWithResultSetEntry(const DataType& data_type, int column_index,
-                                    Tensor* tensor);
+                                    int64 index, Tensor* tensor);
   Sqlite* db_ = nullptr;
   SqliteStatement stmt_;
   int column_count_ = 0;
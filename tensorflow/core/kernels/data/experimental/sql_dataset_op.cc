@@ -12,6 +12,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
 #include <utility>
 
 #include "tensorflow/core/framework/dataset.h"
@@ -21,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/experimental/sql/query_connection.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 
 namespace tensorflow {
@@ -43,10 +45,24 @@ class SqlDatasetOp : public DatasetOpKernel {
                       "DT_STRING, DT_INT8, DT_INT16, DT_INT32, DT_INT64, "
                       "DT_UINT8, DT_UINT16, DT_BOOL, DT_DOUBLE "));
     }
-    for (const PartialTensorShape& pts : output_shapes_) {
-      OP_REQUIRES(ctx, pts.dims() == 0,
+    if (ctx->HasAttr("batch_size")) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("batch_size", &batch_size_));
+      OP_REQUIRES(ctx, batch_size_ >= 0,
                   errors::InvalidArgument(
-                      "Each element of `output_shapes_` must be a scalar."));
+                      "`batch_size` must be non-negative but is ",
+                      batch_size_, "."));
+    }
+    for (const PartialTensorShape& pts : output_shapes_) {
+      if (batch_size_ == 0) {
+        OP_REQUIRES(ctx, pts.dims() == 0,
+                    errors::InvalidArgument(
+                        "Each element of `output_shapes_` must be a scalar."));
+      } else {
+        OP_REQUIRES(
+            ctx, pts.dims() == 1,
+            errors::InvalidArgument("Each element of `output_shapes_` must be "
+                                    "a vector when `batch_size` is set."));
+      }
     }
   }
   void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
@@ -61,16 +77,19 @@ class SqlDatasetOp : public DatasetOpKernel {
     tstring query;
     OP_REQUIRES_OK(ctx, ParseScalarArgument<tstring>(ctx, "query", &query));
 
-    // TODO(b/64276826) Change this check when we add support for other
-    // databases.
-    OP_REQUIRES(ctx, driver_name == "sqlite",
+    const std::vector<string> drivers =
+        sql::DriverManager::RegisteredDrivers();
+    OP_REQUIRES(ctx,
+                std::find(drivers.begin(), drivers.end(), driver_name) !=
+                    drivers.end(),
                 errors::InvalidArgument(tensorflow::strings::Printf(
                     "The database type, %s, is not supported by SqlDataset. "
-                    "The set of supported databases is: {'sqlite'}.",
-                    driver_name.c_str())));
+                    "The set of supported databases is: {'%s'}.",
+                    driver_name.c_str(),
+                    str_util::Join(drivers, "', '").c_str())));
 
     *output = new Dataset(ctx, driver_name, data_source_name, query,
-                          output_types_, output_shapes_);
+                          batch_size_, output_types_, output_shapes_);
   }
 
  private:
@@ -78,12 +97,13 @@ class SqlDatasetOp : public DatasetOpKernel {
    public:
     Dataset(OpKernelContext* ctx, const string& driver_name,
             const string& data_source_name, const string& query,
-            const DataTypeVector& output_types,
+            int64 batch_size, const DataTypeVector& output_types,
             const std::vector<PartialTensorShape>& output_shapes)
         : DatasetBase(DatasetContext(ctx)),
           driver_name_(driver_name),
           data_source_name_(data_source_name),
           query_(query),
+          batch_size_(batch_size),
           output_types_(output_types),
           output_shapes_(output_shapes) {}
 
@@ -116,8 +136,17 @@ class SqlDatasetOp : public DatasetOpKernel {
           b->AddScalar(data_source_name_, &data_source_name_node));
       Node* query_node;
       TF_RETURN_IF_ERROR(b->AddScalar(query_, &query_node));
+      if (batch_size_ == 0) {
+        TF_RETURN_IF_ERROR(b->AddDataset(
+            this, {driver_name_node, data_source_name_node, query_node},
+            output));
+        return Status::OK();
+      }
+      AttrValue batch_size;
+      b->BuildAttrValue(batch_size_, &batch_size);
       TF_RETURN_IF_ERROR(b->AddDataset(
-          this, {driver_name_node, data_source_name_node, query_node}, output));
+          this, {driver_name_node, data_source_name_node, query_node},
+          {{"batch_size", batch_size}}, output));
       return Status::OK();
     }
 
@@ -145,8 +174,7 @@ class SqlDatasetOp : public DatasetOpKernel {
         Status status = Status::OK();
         if (!end_of_sequence_) {
           next_calls_++;
-          status =
-              query_connection_->GetNext(ctx, out_tensors, &end_of_sequence_);
+          status = GetNextFromConnection(ctx, out_tensors);
         }
         *end_of_sequence = end_of_sequence_;
         return status;
@@ -178,8 +206,7 @@ class SqlDatasetOp : public DatasetOpKernel {
           std::vector<Tensor> out_tensors;
           end_of_sequence_ = false;
           while (rem_next_calls--) {
-            TF_RETURN_IF_ERROR(query_connection_->GetNext(ctx, &out_tensors,
-                                                          &end_of_sequence_));
+            TF_RETURN_IF_ERROR(GetNextFromConnection(ctx, &out_tensors));
             out_tensors.clear();
           }
         } else {
@@ -190,6 +217,22 @@ class SqlDatasetOp : public DatasetOpKernel {
       }
 
      private:
+      // Reads the next row, or the next batch of rows if `batch_size` is set,
+      // from `query_connection_` into `out_tensors`.
+      Status GetNextFromConnection(IteratorContext* ctx,
+                                   std::vector<Tensor>* out_tensors)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (dataset()->batch_size_ == 0) {
+          return query_connection_->GetNext(ctx, out_tensors,
+                                            &end_of_sequence_);
+        }
+        int64 num_rows;
+        TF_RETURN_IF_ERROR(query_connection_->GetNextBatch(
+            ctx, dataset()->batch_size_, out_tensors, &num_rows));
+        end_of_sequence_ = num_rows == 0;
+        return Status::OK();
+      }
+
       Status InitializeQueryConnection() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         query_connection_initialized_ = true;
         end_of_sequence_ = false;
@@ -216,9 +259,11 @@ class SqlDatasetOp : public DatasetOpKernel {
     const tstring driver_name_;
     const tstring data_source_name_;
     const tstring query_;
+    const int64 batch_size_;
     const DataTypeVector output_types_;
     const std::vector<PartialTensorShape> output_shapes_;
   };
+  int64 batch_size_ = 0;
   DataTypeVector output_types_;
   std::vector<PartialTensorShape> output_shapes_;
 };
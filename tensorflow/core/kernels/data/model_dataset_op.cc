@@ -50,12 +50,26 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
     OP_REQUIRES(ctx, cpu_budget_ > 0,
                 errors::InvalidArgument("CPU budget must be positive but is ",
                                         cpu_budget_, "."));
-    ram_budget_ = kRamBudgetShare * port::AvailableRam();
+    if (ctx->HasAttr("ram_budget")) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("ram_budget", &ram_budget_));
+    } else {
+      ram_budget_ = 0;
+    }
+    if (ram_budget_ == 0) {
+      ram_budget_ = kRamBudgetShare * port::AvailableRam();
+    }
+    OP_REQUIRES(ctx, ram_budget_ > 0,
+                errors::InvalidArgument("RAM budget must be positive but is ",
+                                        ram_budget_, "."));
+    if (ctx->HasAttr("profile_path")) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("profile_path", &profile_path_));
+    }
   }
 
   void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                    DatasetBase** output) override {
-    *output = new Dataset(ctx, input, algorithm_, cpu_budget_, ram_budget_);
+    *output = new Dataset(ctx, input, algorithm_, cpu_budget_, ram_budget_,
+                          profile_path_);
   }
 
  private:
@@ -63,12 +77,13 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
    public:
     Dataset(OpKernelContext* ctx, const DatasetBase* input,
             model::AutotuneAlgorithm algorithm, int64 cpu_budget,
-            int64 ram_budget)
+            int64 ram_budget, const string& profile_path)
         : DatasetBase(DatasetContext(ctx)),
           input_(input),
           algorithm_(algorithm),
           cpu_budget_(cpu_budget),
-          ram_budget_(ram_budget) {
+          ram_budget_(ram_budget),
+          profile_path_(profile_path) {
       input_->Ref();
     }
 
@@ -140,8 +155,12 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
           TF_RETURN_IF_ERROR(EnsureOptimizeThreadStarted(ctx));
           params.model = model_;
         }
-        return input_impl_->GetNext(IteratorContext(std::move(params)),
-                                    out_tensors, end_of_sequence);
+        TF_RETURN_IF_ERROR(input_impl_->GetNext(
+            IteratorContext(std::move(params)), out_tensors, end_of_sequence));
+        if (*end_of_sequence && !dataset()->profile_path_.empty()) {
+          MaybeSaveProfile(ctx);
+        }
+        return Status::OK();
       }
 
      protected:
@@ -165,6 +184,24 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
       }
 
      private:
+      // Saves the profile of the first iterator to reach the end of its input
+      // unless a profile exists, so that the profile keeps describing the
+      // pipeline before the rewrites it leads to.
+      void MaybeSaveProfile(IteratorContext* ctx) LOCKS_EXCLUDED(mu_) {
+        mutex_lock l(mu_);
+        if (profile_saved_) return;
+        profile_saved_ = true;
+        const string& path = dataset()->profile_path_;
+        if (ctx->env()->FileExists(path).ok()) return;
+        Status s = model_->SaveProfile(ctx->env(), path);
+        if (s.ok()) {
+          VLOG(1) << "Saved the input pipeline profile to " << path;
+        } else {
+          LOG(WARNING) << "Failed to save the input pipeline profile to "
+                       << path << ": " << s;
+        }
+      }
+
       Status EnsureOptimizeThreadStarted(IteratorContext* ctx)
           EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         if (!optimize_thread_) {
@@ -198,6 +235,13 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
           }
           model_->Optimize(dataset()->algorithm_, dataset()->cpu_budget_,
                            dataset()->ram_budget_);
+          auto stats_aggregator = ctx->stats_aggregator();
+          if (stats_aggregator) {
+            model_->RecordStats(stats_aggregator.get());
+          }
+          if (VLOG_IS_ON(1)) {
+            LOG(INFO) << model_->BottleneckReport();
+          }
           // Exponentially increase the period of running the optimization
           // until a threshold is reached.
           if (optimization_period_ms != kOptimizationPeriodThresholdMs) {
@@ -214,6 +258,7 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
       std::shared_ptr<model::Model> model_;
       std::unique_ptr<Thread> optimize_thread_ GUARDED_BY(mu_);
       bool cancelled_ GUARDED_BY(mu_) = false;
+      bool profile_saved_ GUARDED_BY(mu_) = false;
       std::unique_ptr<IteratorBase> input_impl_;
     };
 
@@ -221,11 +266,13 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
     const model::AutotuneAlgorithm algorithm_;
     const int64 cpu_budget_;
     const int64 ram_budget_;
+    const string profile_path_;
   };
 
   model::AutotuneAlgorithm algorithm_;
   int64 cpu_budget_;
   int64 ram_budget_;
+  string profile_path_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("ModelDataset").Device(DEVICE_CPU),
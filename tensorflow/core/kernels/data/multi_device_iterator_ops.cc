@@ -12,10 +12,13 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <cstring>
 #include <deque>
 
+#include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/input_colocation_exemption_registry.h"
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/function.h"
@@ -49,6 +52,23 @@ struct HostBufferElement {
 using MultiDeviceIteratorCallback =
     std::function<void(const HostBufferElement&)>;
 
+// Replaces the tensors of `value` which can be copied to a device with DMA by
+// copies in memory allocated with `allocator`. Tensors for which the memory
+// cannot be allocated are left as they are.
+void CopyToPinnedHostMemory(Allocator* allocator, std::vector<Tensor>* value) {
+  for (Tensor& tensor : *value) {
+    if (!DataTypeCanUseMemcpy(tensor.dtype()) || tensor.NumElements() == 0) {
+      continue;
+    }
+    Tensor pinned(allocator, tensor.dtype(), tensor.shape());
+    if (!pinned.IsInitialized()) continue;
+    StringPiece src = tensor.tensor_data();
+    StringPiece dst = pinned.tensor_data();
+    std::memcpy(const_cast<char*>(dst.data()), src.data(), src.size());
+    tensor = std::move(pinned);
+  }
+}
+
 class MultiDeviceIterator : public ResourceBase {
  public:
   MultiDeviceIterator(
@@ -94,7 +114,7 @@ class MultiDeviceIterator : public ResourceBase {
 
     multi_device_buffer_ = absl::make_unique<MultiDeviceBuffer>(
         devices_.size(), max_buffer_size, incarnation_id_, std::move(iterator),
-        this);
+        GetPinnedHostAllocators(), this);
     return Status::OK();
   }
 
@@ -146,18 +166,45 @@ class MultiDeviceIterator : public ResourceBase {
   CancellationManager* cancellation_manager() { return &cancellation_manager_; }
 
  private:
+  // Returns, for each device, the allocator of host memory pinned for DMA to
+  // the device if it is a local GPU, and nullptr otherwise.
+  std::vector<Allocator*> GetPinnedHostAllocators() const {
+    std::vector<Allocator*> allocators(devices_.size(), nullptr);
+    const DeviceMgr* device_mgr = flr_->device_mgr();
+    if (device_mgr == nullptr) return allocators;
+    for (size_t i = 0; i < devices_.size(); ++i) {
+      Device* device;
+      if (!device_mgr->LookupDevice(devices_[i], &device).ok() ||
+          device->tensorflow_gpu_device_info() == nullptr) {
+        continue;
+      }
+      AllocatorAttributes attr;
+      attr.set_on_host(true);
+      attr.set_gpu_compatible(true);
+      allocators[i] = device->GetAllocator(attr);
+    }
+    return allocators;
+  }
+
   // A private class that uses a background thread to keep a per device buffer
   // full.
+  //
+  // The elements for local GPUs are copied to pinned host memory by the
+  // background thread. Their copies to the GPUs, which the per device datasets
+  // prefetch, are then asynchronous DMAs on the host-to-device streams of the
+  // GPUs, instead of synchronous copies from pageable memory.
   class MultiDeviceBuffer {
    public:
     MultiDeviceBuffer(size_t size, int64 max_buffer_size, int64 incarnation_id,
                       std::unique_ptr<IteratorBase> host_iterator,
+                      std::vector<Allocator*> pinned_host_allocators,
                       MultiDeviceIterator* parent)
         : buffer_(size),
           size_(size),
           max_buffer_size_(max_buffer_size),
           incarnation_id_(incarnation_id),
           host_iterator_(std::move(host_iterator)),
+          pinned_host_allocators_(std::move(pinned_host_allocators)),
           parent_(parent) {}
 
     ~MultiDeviceBuffer() {
@@ -312,6 +359,10 @@ class MultiDeviceIterator : public ResourceBase {
 
         if (elem.status.ok() && elem.end_of_sequence) {
           end_of_iterator = true;
+        } else if (elem.status.ok() &&
+                   pinned_host_allocators_[shard_to_fetch] != nullptr) {
+          CopyToPinnedHostMemory(pinned_host_allocators_[shard_to_fetch],
+                                 &elem.value);
         }
 
         {
@@ -366,6 +417,8 @@ class MultiDeviceIterator : public ResourceBase {
     const int64 max_buffer_size_;
     const int64 incarnation_id_;
     const std::unique_ptr<IteratorBase> host_iterator_;
+    // Allocators of pinned host memory of each device, or nullptr.
+    const std::vector<Allocator*> pinned_host_allocators_;  // Not owned.
     MultiDeviceIterator* const parent_;  // Not owned.
   };
 
@@ -103,6 +103,11 @@ constexpr double kPerIteratorPrefetchFactor = 2.0L;
 // auto-tuning) without changing the cycle length (which would change the order
 // in which elements are produced).
 //
+// When outputs may be produced in non-deterministic order (`sloppy`), results
+// are also taken from the prefetched future cycle elements whenever none of
+// the current cycle elements has one, so that inputs with a long-tail latency
+// (e.g. cold files on remote storage) do not stall the iterator.
+//
 // Furthermore, this class favors modularity over extended functionality. In
 // particular, it refrains from implementing configurable buffering of output
 // elements and prefetching of input iterators.
@@ -481,6 +486,24 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         }
         AdvanceToNextInCycle();
       }
+      // None of the elements in the cycle has a result available, e.g. because
+      // their inputs are slow to open or read. Rather than waiting for them,
+      // take a result the future workers have already produced for an element
+      // of a later cycle, so that slow inputs do not hold up the fast ones.
+      return ConsumeFutureElementResult(result);
+    }
+
+    // Consumes a result of an element in `future_elements_` (if available),
+    // returning an indication of whether a result is available.
+    bool ConsumeFutureElementResult(std::shared_ptr<Result>* result)
+        EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (const auto& element : future_elements_) {
+        if (!element->results.empty()) {
+          std::swap(*result, element->results.front());
+          element->results.pop_front();
+          return true;
+        }
+      }
       return false;
     }
 
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DEBUG_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_DEBUG_OPS_H_
 
+#include <atomic>
+
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #endif
@@ -27,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/util/debug_events_writer.h"
 
@@ -124,6 +127,12 @@ class BaseDebugOp : public OpKernel {
       : OpKernel(context), debug_op_name_(debug_op_name) {
     OP_REQUIRES_OK(context, context->GetAttr("debug_urls", &debug_urls_));
     OP_REQUIRES_OK(context, context->GetAttr("gated_grpc", &gated_grpc_));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("sample_interval", &sample_interval_));
+    OP_REQUIRES(context, sample_interval_ >= 1,
+                errors::InvalidArgument("sample_interval must be positive, ",
+                                        "got ", sample_interval_));
+    OP_REQUIRES_OK(context, context->GetAttr("async_publish", &async_publish_));
 
     string device_name;
     string tensor_name;
@@ -163,13 +172,25 @@ class BaseDebugOp : public OpKernel {
                            debug_watch_key_->debug_node_name, debug_urls_)) {
       // The entire node is gated off: Output an empty tensor and avoid
       // expensive computation.
-      Tensor* output_tensor;
-      TensorShape shape({0});
-      if (!context->allocate_output(0, shape, &output_tensor).ok()) {
-        LOG(ERROR) << "Debug node of watch key "
-                   << debug_watch_key_->debug_node_name
-                   << " failed to allocate empty tensor under gated-off state.";
-      }
+      AllocateEmptyOutput(context, "gated-off");
+      return false;
+    } else {
+      return true;
+    }
+  }
+
+  // Apply sampling (if sample_interval_ attribute is greater than 1).
+  //
+  // Returns false if and only if the current execution of the debug op is not
+  // one of every sample_interval_ executions, in which case the debug op will
+  // emit an empty (size {0}) tensor of undefined data type, as it does when
+  // gated off.
+  bool ApplySampling(OpKernelContext* context) {
+    if (sample_interval_ > 1 &&
+        execution_count_.fetch_add(1, std::memory_order_relaxed) %
+                sample_interval_ !=
+            0) {
+      AllocateEmptyOutput(context, "unsampled");
       return false;
     } else {
       return true;
@@ -178,9 +199,31 @@ class BaseDebugOp : public OpKernel {
 
   // Publish a tensor to all debug URLs of the debug op.
   // Log an error if the publishing failed.
+  //
+  // If async_publish_ attribute is true, the tensor is published in the
+  // background, in the order of the calls, and the returned status is always
+  // OK.
   Status PublishTensor(const Tensor& tensor) {
     if (debug_urls_.empty()) {
       return Status::OK();
+    } else if (async_publish_) {
+      const DebugNodeKey debug_watch_key = *debug_watch_key_;
+      const uint64 wall_time_us = Env::Default()->NowMicros();
+      const std::vector<string> debug_urls = debug_urls_;
+      const bool gated_grpc = gated_grpc_;
+      AsyncPublishThreadPool()->Schedule(
+          [debug_watch_key, tensor, wall_time_us, debug_urls, gated_grpc]() {
+            Status status = DebugIO::PublishDebugTensor(
+                debug_watch_key, tensor, wall_time_us, debug_urls, gated_grpc);
+            if (!status.ok()) {
+              LOG(ERROR) << "Debug node of watch key "
+                         << debug_watch_key.debug_node_name
+                         << " failed to publish debug tensor data to all URLs "
+                         << str_util::Join(debug_urls, ", ")
+                         << ", due to: " << status.error_message();
+            }
+          });
+      return Status::OK();
     } else {
       Status status = DebugIO::PublishDebugTensor(*debug_watch_key_, tensor,
                                                   Env::Default()->NowMicros(),
@@ -197,10 +240,32 @@ class BaseDebugOp : public OpKernel {
   }
 
  private:
+  void AllocateEmptyOutput(OpKernelContext* context, const char* state) {
+    Tensor* output_tensor;
+    TensorShape shape({0});
+    if (!context->allocate_output(0, shape, &output_tensor).ok()) {
+      LOG(ERROR) << "Debug node of watch key "
+                 << debug_watch_key_->debug_node_name
+                 << " failed to allocate empty tensor under " << state
+                 << " state.";
+    }
+  }
+
+  // A single thread, so that the debug tensors of asynchronously publishing
+  // debug ops are published in order.
+  static thread::ThreadPool* AsyncPublishThreadPool() {
+    static thread::ThreadPool* pool =
+        new thread::ThreadPool(Env::Default(), "debug_publish", 1);
+    return pool;
+  }
+
   const string debug_op_name_;
   std::unique_ptr<DebugNodeKey> debug_watch_key_;
   std::vector<string> debug_urls_;
   bool gated_grpc_;
+  int64 sample_interval_;
+  bool async_publish_;
+  std::atomic<int64> execution_count_{0};
 };
 
 // Identity op for debugging.
@@ -213,7 +278,7 @@ class DebugIdentityOp : public BaseDebugOp {
       : BaseDebugOp("DebugIdentity", context) {}
 
   void Compute(OpKernelContext* context) override {
-    if (!ApplyGrpcGating(context)) {
+    if (!ApplySampling(context) || !ApplyGrpcGating(context)) {
       return;
     }
 
@@ -230,7 +295,7 @@ class DebugNanCountOp : public BaseDebugOp {
       : BaseDebugOp("DebugNanCount", context) {}
 
   void Compute(OpKernelContext* context) override {
-    if (!ApplyGrpcGating(context)) {
+    if (!ApplySampling(context) || !ApplyGrpcGating(context)) {
       return;
     }
 
@@ -273,7 +338,7 @@ class DebugNumericSummaryOp : public BaseDebugOp {
   }
 
   void Compute(OpKernelContext* context) override {
-    if (!ApplyGrpcGating(context)) {
+    if (!ApplySampling(context) || !ApplyGrpcGating(context)) {
       return;
     }
 
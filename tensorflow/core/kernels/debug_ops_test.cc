@@ -628,6 +628,40 @@ TEST_F(DebugNumericSummaryOpTest, DisabledDueToNonMatchingWatchKey) {
 }
 #endif
 
+class DebugNumericSummaryOpSampledTest : public OpsTestBase {
+ protected:
+  Status Init(DataType input_type, int sample_interval) {
+    TF_CHECK_OK(NodeDefBuilder("op", "DebugNumericSummary")
+                    .Input(FakeInput(input_type))
+                    .Attr("tensor_name", "FakeTensor:0")
+                    .Attr("sample_interval", sample_interval)
+                    .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(DebugNumericSummaryOpSampledTest, SummarizesEveryIntervalExecutions) {
+  TF_ASSERT_OK(Init(DT_FLOAT, 3));
+  AddInputFromArray<float>(TensorShape({2, 2}), {1.0, 3.0, 3.0, 7.0});
+
+  Tensor expected_unsampled(allocator(), DT_DOUBLE, TensorShape({0}));
+  for (int i = 0; i < 7; ++i) {
+    TF_ASSERT_OK(RunOpKernel());
+    if (i % 3 == 0) {
+      ASSERT_EQ(16, GetOutput(0)->NumElements());
+      // Element count, and maximum of non-inf and non-nan elements.
+      EXPECT_EQ(4.0, GetOutput(0)->vec<double>()(1));
+      EXPECT_EQ(7.0, GetOutput(0)->vec<double>()(9));
+    } else {
+      test::ExpectTensorEqual<double>(expected_unsampled, *GetOutput(0));
+    }
+  }
+}
+
+TEST_F(DebugNumericSummaryOpSampledTest, InvalidSampleInterval) {
+  EXPECT_FALSE(Init(DT_FLOAT, 0).ok());
+}
+
 // Tests for DebugNumericSummaryOp
 class DebugNumericSummaryOpCustomLowerBoundTest : public OpsTestBase {
  protected:
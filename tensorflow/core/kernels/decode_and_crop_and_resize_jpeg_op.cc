@@ -0,0 +1,287 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+
+namespace tensorflow {
+namespace {
+
+// Where one output coordinate samples the decoded window.
+struct Interpolation {
+  int64 lower;
+  int64 upper;
+  float lerp;
+};
+
+// Returns the largest libjpeg scaling denominator that keeps the crop window
+// at least as large as the output. libjpeg then downscales in the DCT domain,
+// which skips most of the IDCT work, and the bilinear resize only downsamples
+// the rest of the way.
+int ChooseRatio(int64 crop_height, int64 crop_width, int64 out_height,
+                int64 out_width) {
+  for (int ratio = 8; ratio > 1; ratio /= 2) {
+    if (crop_height >= out_height * ratio && crop_width >= out_width * ratio) {
+      return ratio;
+    }
+  }
+  return 1;
+}
+
+// Computes the interpolation of one axis. The output samples
+// [crop_start, crop_start + crop_size) of the full-resolution image with half
+// pixel centers, as ResizeBilinear with half_pixel_centers does, from an image
+// decoded at 1/ratio of the full resolution, `scaled_size` pixels long.
+// Returns the window of the scaled image that the samples touch in
+// `*decode_start` and `*decode_size`, and the samples relative to it.
+void ComputeInterpolation(int64 crop_start, int64 crop_size, int64 out_size,
+                          int ratio, int64 scaled_size, int64* decode_start,
+                          int64* decode_size,
+                          std::vector<Interpolation>* interpolation) {
+  const float scale = static_cast<float>(crop_size) / out_size;
+  std::vector<float> in(out_size);
+  for (int64 i = 0; i < out_size; ++i) {
+    in[i] = (crop_start + (i + 0.5f) * scale) / ratio - 0.5f;
+  }
+  const int64 start = std::max<int64>(0, std::floor(in.front()));
+  const int64 limit = std::min<int64>(
+      scaled_size, static_cast<int64>(std::ceil(in.back())) + 1);
+  interpolation->resize(out_size);
+  for (int64 i = 0; i < out_size; ++i) {
+    const float in_pos = std::max(0.0f, in[i]);
+    const int64 lower = std::min<int64>(std::floor(in_pos), limit - 1);
+    Interpolation& sample = (*interpolation)[i];
+    sample.lower = lower - start;
+    sample.upper = std::min(lower + 1, limit - 1) - start;
+    sample.lerp = in_pos - std::floor(in_pos);
+  }
+  *decode_start = start;
+  *decode_size = limit - start;
+}
+
+// Resizes `image` into `output`. Each input row is interpolated horizontally
+// once, and the vertical blend of two interpolated rows, which is most of the
+// work, is an Eigen array expression over the whole output row, so it runs on
+// SIMD packets.
+template <int kChannels>
+void ResizeBilinear(const uint8* image, int64 in_width,
+                    const std::vector<Interpolation>& xs,
+                    const std::vector<Interpolation>& ys, float* output) {
+  const int64 out_width = xs.size();
+  const int64 row_size = out_width * kChannels;
+  // The rows of consecutive input lines go to different slots, so the two
+  // rows blended for an output row never evict each other.
+  std::vector<float> rows[2] = {std::vector<float>(row_size),
+                                std::vector<float>(row_size)};
+  int64 cached[2] = {-1, -1};
+  auto interpolated_row = [&](int64 y) -> const float* {
+    const int slot = y & 1;
+    float* row = rows[slot].data();
+    if (cached[slot] != y) {
+      const uint8* in_row = image + y * in_width * kChannels;
+      for (int64 x = 0; x < out_width; ++x) {
+        const uint8* left = in_row + xs[x].lower * kChannels;
+        const uint8* right = in_row + xs[x].upper * kChannels;
+        for (int c = 0; c < kChannels; ++c) {
+          row[x * kChannels + c] =
+              left[c] + (static_cast<float>(right[c]) - left[c]) * xs[x].lerp;
+        }
+      }
+      cached[slot] = y;
+    }
+    return row;
+  };
+  for (int64 y = 0; y < static_cast<int64>(ys.size()); ++y) {
+    Eigen::Map<const Eigen::ArrayXf> top(interpolated_row(ys[y].lower),
+                                         row_size);
+    Eigen::Map<const Eigen::ArrayXf> bottom(interpolated_row(ys[y].upper),
+                                            row_size);
+    Eigen::Map<Eigen::ArrayXf>(output + y * row_size, row_size) =
+        top + (bottom - top) * ys[y].lerp;
+  }
+}
+
+// Decodes a window of a JPEG image, crops and resizes it with bilinear
+// interpolation, without materializing the full-resolution image.
+class DecodeAndCropAndResizeJpegOp : public OpKernel {
+ public:
+  explicit DecodeAndCropAndResizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context, channels_ == 0 || channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument("channels must be 0, 1, or 3, got ",
+                                        channels_));
+    flags_.components = channels_;
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+
+    // The TensorFlow-chosen default for jpeg decoding is IFAST, sacrificing
+    // image quality for speed.
+    flags_.dct_method = JDCT_IFAST;
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    if (dct_method == "INTEGER_ACCURATE") {
+      flags_.dct_method = JDCT_ISLOW;
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(contents.shape()),
+                errors::InvalidArgument("contents must be scalar, got shape ",
+                                        contents.shape().DebugString()));
+    const StringPiece input = contents.scalar<tstring>()();
+    OP_REQUIRES(context, input.size() <= std::numeric_limits<int>::max(),
+                errors::InvalidArgument("JPEG contents are too large for int: ",
+                                        input.size()));
+
+    const Tensor& crop_window = context->input(1);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(crop_window.shape()) &&
+                    crop_window.dim_size(0) == 4,
+                errors::InvalidArgument(
+                    "crop_window must be 1-D with four elements, got shape ",
+                    crop_window.shape().DebugString()));
+    const auto crop_window_vec = crop_window.vec<int32>();
+    const int64 crop_y = crop_window_vec(0);
+    const int64 crop_x = crop_window_vec(1);
+    const int64 crop_height = crop_window_vec(2);
+    const int64 crop_width = crop_window_vec(3);
+
+    const Tensor& size = context->input(2);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(size.shape()) &&
+                    size.dim_size(0) == 2,
+                errors::InvalidArgument(
+                    "size must be 1-D with two elements, got shape ",
+                    size.shape().DebugString()));
+    const int64 out_height = size.vec<int32>()(0);
+    const int64 out_width = size.vec<int32>()(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("size must be positive, got ",
+                                        out_height, "x", out_width));
+
+    int image_width, image_height;
+    OP_REQUIRES(context,
+                jpeg::GetImageInfo(input.data(), input.size(), &image_width,
+                                   &image_height, nullptr),
+                errors::InvalidArgument("Invalid JPEG data, data size ",
+                                        input.size()));
+    OP_REQUIRES(
+        context,
+        crop_height > 0 && crop_width > 0 && crop_y >= 0 && crop_x >= 0 &&
+            crop_y + crop_height <= image_height &&
+            crop_x + crop_width <= image_width,
+        errors::InvalidArgument("Invalid crop window: y=", crop_y,
+                                ", x=", crop_x, ", h=", crop_height,
+                                ", w=", crop_width, " for image of ",
+                                image_height, "x", image_width));
+
+    // libjpeg rounds the scaled size up.
+    const int ratio = ChooseRatio(crop_height, crop_width, out_height,
+                                  out_width);
+    const int64 scaled_height = (image_height + ratio - 1) / ratio;
+    const int64 scaled_width = (image_width + ratio - 1) / ratio;
+    std::vector<Interpolation> xs, ys;
+    int64 decode_x, decode_y, decode_width, decode_height;
+    ComputeInterpolation(crop_x, crop_width, out_width, ratio, scaled_width,
+                         &decode_x, &decode_width, &xs);
+    ComputeInterpolation(crop_y, crop_height, out_height, ratio,
+                         scaled_height, &decode_y, &decode_height, &ys);
+
+    // Use local copy of flags to avoid race condition as the class member is
+    // shared among different invocations.
+    jpeg::UncompressFlags flags = flags_;
+    flags.ratio = ratio;
+    flags.crop = true;
+    flags.crop_x = decode_x;
+    flags.crop_y = decode_y;
+    flags.crop_width = decode_width;
+    flags.crop_height = decode_height;
+
+    // Decode the window, allocating it once the number of channels is known.
+    Tensor decoded;
+    OP_REQUIRES(
+        context,
+        jpeg::Uncompress(
+            input.data(), input.size(), flags, nullptr /* nwarn */,
+            [context, &decoded](int width, int height,
+                                int channels) -> uint8* {
+              Status status(context->allocate_temp(
+                  DT_UINT8, TensorShape({height, width, channels}),
+                  &decoded));
+              if (!status.ok()) {
+                VLOG(1) << status;
+                context->SetStatus(status);
+                return nullptr;
+              }
+              return decoded.flat<uint8>().data();
+            }),
+        errors::InvalidArgument("Invalid JPEG data or crop window, data size ",
+                                input.size()));
+    const int64 channels = decoded.dim_size(2);
+    OP_REQUIRES(context,
+                decoded.dim_size(0) == decode_height &&
+                    decoded.dim_size(1) == decode_width,
+                errors::Internal("Decoded window is ", decoded.dim_size(0),
+                                 "x", decoded.dim_size(1), ", expected ",
+                                 decode_height, "x", decode_width));
+    OP_REQUIRES(context, channels == 1 || channels == 3,
+                errors::InvalidArgument(
+                    "Decoded JPEG has an unsupported number of channels: ",
+                    channels));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({out_height, out_width, channels}),
+                       &output));
+    if (channels == 1) {
+      ResizeBilinear<1>(decoded.flat<uint8>().data(), decode_width, xs, ys,
+                        output->flat<float>().data());
+    } else {
+      ResizeBilinear<3>(decoded.flat<uint8>().data(), decode_width, xs, ys,
+                        output->flat<float>().data());
+    }
+  }
+
+ private:
+  int channels_;
+  jpeg::UncompressFlags flags_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DecodeAndCropAndResizeJpeg").Device(DEVICE_CPU),
+                        DecodeAndCropAndResizeJpegOp);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,130 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kImageSize = 64;
+
+// Returns a kImageSize x kImageSize RGB JPEG whose value at column x is
+// `value(x)` in all channels.
+template <typename Fn>
+tstring MakeJpeg(Fn value) {
+  std::vector<uint8> pixels(kImageSize * kImageSize * 3);
+  for (int y = 0; y < kImageSize; ++y) {
+    for (int x = 0; x < kImageSize; ++x) {
+      for (int c = 0; c < 3; ++c) {
+        pixels[(y * kImageSize + x) * 3 + c] = value(x);
+      }
+    }
+  }
+  jpeg::CompressFlags flags;
+  flags.format = jpeg::FORMAT_RGB;
+  flags.quality = 100;
+  return jpeg::Compress(pixels.data(), kImageSize, kImageSize, flags);
+}
+
+class DecodeAndCropAndResizeJpegOpTest : public OpsTestBase {
+ protected:
+  Status MakeOp(int channels) {
+    TF_RETURN_IF_ERROR(
+        NodeDefBuilder("decode", "DecodeAndCropAndResizeJpeg")
+            .Input(FakeInput(DT_STRING))
+            .Input(FakeInput(DT_INT32))
+            .Input(FakeInput(DT_INT32))
+            .Attr("channels", channels)
+            .Attr("dct_method", "INTEGER_ACCURATE")
+            .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(DecodeAndCropAndResizeJpegOpTest, ConstantImage) {
+  TF_ASSERT_OK(MakeOp(3));
+  AddInputFromArray<tstring>(TensorShape({}),
+                             {MakeJpeg([](int x) { return 100; })});
+  AddInputFromArray<int32>(TensorShape({4}), {8, 16, 48, 32});
+  AddInputFromArray<int32>(TensorShape({2}), {5, 7});
+  TF_ASSERT_OK(RunOpKernel());
+
+  const Tensor& image = *GetOutput(0);
+  EXPECT_EQ(TensorShape({5, 7, 3}), image.shape());
+  for (int64 i = 0; i < image.NumElements(); ++i) {
+    EXPECT_NEAR(100.0f, image.flat<float>()(i), 2.0f);
+  }
+}
+
+TEST_F(DecodeAndCropAndResizeJpegOpTest, SamplesWithHalfPixelCenters) {
+  TF_ASSERT_OK(MakeOp(1));
+  AddInputFromArray<tstring>(TensorShape({}),
+                             {MakeJpeg([](int x) { return 4 * x; })});
+  AddInputFromArray<int32>(TensorShape({4}), {0, 0, 64, 64});
+  AddInputFromArray<int32>(TensorShape({2}), {4, 4});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Output column j is centered on column 16 * j + 7.5 of the image, whether
+  // or not the decoder downscaled it first.
+  const Tensor& image = *GetOutput(0);
+  EXPECT_EQ(TensorShape({4, 4, 1}), image.shape());
+  const auto pixels = image.tensor<float, 3>();
+  for (int y = 0; y < 4; ++y) {
+    for (int x = 0; x < 4; ++x) {
+      EXPECT_NEAR(64 * x + 30, pixels(y, x, 0), 4.0f) << y << ", " << x;
+    }
+  }
+}
+
+TEST_F(DecodeAndCropAndResizeJpegOpTest, Upsamples) {
+  TF_ASSERT_OK(MakeOp(3));
+  AddInputFromArray<tstring>(TensorShape({}),
+                             {MakeJpeg([](int x) { return 100; })});
+  AddInputFromArray<int32>(TensorShape({4}), {60, 60, 4, 4});
+  AddInputFromArray<int32>(TensorShape({2}), {16, 16});
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_EQ(TensorShape({16, 16, 3}), GetOutput(0)->shape());
+}
+
+TEST_F(DecodeAndCropAndResizeJpegOpTest, InvalidCropWindow) {
+  TF_ASSERT_OK(MakeOp(3));
+  AddInputFromArray<tstring>(TensorShape({}),
+                             {MakeJpeg([](int x) { return 100; })});
+  AddInputFromArray<int32>(TensorShape({4}), {32, 32, 48, 16});
+  AddInputFromArray<int32>(TensorShape({2}), {8, 8});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+TEST_F(DecodeAndCropAndResizeJpegOpTest, InvalidSize) {
+  TF_ASSERT_OK(MakeOp(3));
+  AddInputFromArray<tstring>(TensorShape({}),
+                             {MakeJpeg([](int x) { return 100; })});
+  AddInputFromArray<int32>(TensorShape({4}), {0, 0, 64, 64});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 8});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -90,17 +90,35 @@ static bool ReadBoolFromEnvVar(const char* env_var_name, bool default_val) {
   return default_val;
 }
 
+// Returns the approximate cost of computing the convolution with 'transform'.
+template <typename T>
+static int64 GetTransformCost(const DeepConv2DTransform<T>& transform,
+                              int in_depth, int out_depth, int out_rows,
+                              int out_cols) {
+  return GetDeepConvCost(
+      transform.input_shape().rows, transform.input_shape().cols,
+      transform.output_shape().rows, transform.output_shape().cols, in_depth,
+      out_depth, out_rows, out_cols);
+}
+
+// TODO(andydavis) Add support for multiple filter sizes and strides.
+bool DeepConv2DSupportsParams(int stride_rows, int stride_cols,
+                              int filter_rows, int filter_cols) {
+  return stride_rows == 1 && stride_cols == 1 && filter_rows == 3 &&
+         filter_cols == 3;
+}
+
 // Returns true if convolution can be computed efficiently by DeepConv2D,
 // returns false otherwise.
-// TODO(andydavis) Add support for other filter sizes and strides.
-// TODO(andydavis) Add support for autotuning.
+// Conv2D can also time DeepConv2D against its other implementations per
+// shape instead of relying on these cost models (see conv_ops.cc).
 bool CanUseDeepConv2D(int stride_rows, int stride_cols, int filter_rows,
                       int filter_cols, int in_depth, int out_depth,
-                      int out_rows, int out_cols) {
+                      int out_rows, int out_cols,
+                      DeepConv2DAlgorithm* algorithm) {
   // Check if convolution parameters are supported.
-  // TODO(andydavis) Add support for multiple filter sizes and strides.
-  if (stride_rows > 1 || stride_cols > 1 || filter_rows != 3 ||
-      filter_cols != 3) {
+  if (!DeepConv2DSupportsParams(stride_rows, stride_cols, filter_rows,
+                                filter_cols)) {
     return false;
   }
 
@@ -110,11 +128,19 @@ bool CanUseDeepConv2D(int stride_rows, int stride_cols, int filter_rows,
     return false;
   }
 
+  // Pick the cheaper transform. The larger output tile of F(4x4, 3x3) only
+  // pays for its larger input and output transforms when the spatial
+  // dimensions are large enough to waste little of the tiles at boundaries.
+  const int64 winograd_2x2_cost = GetTransformCost(
+      WinogradTransform<float>(), in_depth, out_depth, out_rows, out_cols);
+  const int64 winograd_4x4_cost = GetTransformCost(
+      Winograd4x4Transform<float>(), in_depth, out_depth, out_rows, out_cols);
+  *algorithm = winograd_4x4_cost < winograd_2x2_cost
+                   ? DeepConv2DAlgorithm::kWinograd4x4
+                   : DeepConv2DAlgorithm::kWinograd2x2;
+
   // Check if flop cost of deep convolution is less than direct convolution.
-  WinogradTransform<float> t;
-  const int64 deep_conv_cost = GetDeepConvCost(
-      t.input_shape().rows, t.input_shape().cols, t.output_shape().rows,
-      t.output_shape().cols, in_depth, out_depth, out_rows, out_cols);
+  const int64 deep_conv_cost = std::min(winograd_2x2_cost, winograd_4x4_cost);
   const int64 direct_conv_cost = GetDirectConvCost(
       filter_rows, filter_cols, in_depth, out_depth, out_rows, out_cols);
 
@@ -123,10 +149,17 @@ bool CanUseDeepConv2D(int stride_rows, int stride_cols, int filter_rows,
           << " direct_conv_cost: " << direct_conv_cost << " deep_direct_ratio: "
           << (static_cast<float>(deep_conv_cost) /
               static_cast<float>(direct_conv_cost))
-          << " use_deep_conv: " << (deep_conv_cost < direct_conv_cost);
+          << " use_deep_conv: " << (deep_conv_cost < direct_conv_cost)
+          << " use_winograd_4x4: "
+          << (*algorithm == DeepConv2DAlgorithm::kWinograd4x4);
   return deep_conv_cost < direct_conv_cost;
 }
 
+bool DeepConv2DAutotuneEnable() {
+  // NOTE: IF this environment variable name changes, update conv_ops_test.py.
+  return ReadBoolFromEnvVar("TF_CPU_CONV2D_AUTOTUNE", false);
+}
+
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
 // Copies data from 'filter_in' to 'filter_buf' along 'in_depth' dimension.
@@ -937,8 +970,12 @@ template <typename T>
 struct DeepConv2D<CPUDevice, T> {
   void operator()(OpKernelContext* ctx, const Conv2DArgs& args, const T* input,
                   const T* filter, T* output) {
-    // TODO(andydavis) Add function to select transform based on conv params.
-    std::unique_ptr<DeepConv2DTransform<T>> transform(new WinogradTransform<T>);
+    std::unique_ptr<DeepConv2DTransform<T>> transform;
+    if (args.algorithm == DeepConv2DAlgorithm::kWinograd4x4) {
+      transform.reset(new Winograd4x4Transform<T>);
+    } else {
+      transform.reset(new WinogradTransform<T>);
+    }
 
     const int64 in_depth = args.in_depth;
     const int64 out_depth = args.out_depth;
@@ -63,6 +63,13 @@ class DeepConv2DTransform {
   virtual const Shape& output_shape() const = 0;
 };
 
+// Transforms DeepConv2D can compute a convolution with, named by the sizes of
+// their output and filter tiles.
+enum class DeepConv2DAlgorithm {
+  kWinograd2x2,  // Winograd F(2x2, 3x3).
+  kWinograd4x4,  // Winograd F(4x4, 3x3).
+};
+
 // Conv2D arguments used by DeepConv2D implementation.
 struct Conv2DArgs {
   // Input layer dimensions
@@ -80,6 +87,9 @@ struct Conv2DArgs {
   int out_cols;
   int out_depth;
 
+  // Transform to compute the convolution with.
+  DeepConv2DAlgorithm algorithm;
+
   Conv2DArgs()
       : batch(0),
         in_rows(0),
@@ -91,15 +101,29 @@ struct Conv2DArgs {
         pad_cols(0),
         out_rows(0),
         out_cols(0),
-        out_depth(0) {}
+        out_depth(0),
+        algorithm(DeepConv2DAlgorithm::kWinograd2x2) {}
 };
 
+// Returns true if DeepConv2D implements convolutions with these strides and
+// filter sizes, regardless of their cost or whether DeepConv2D is enabled.
+bool DeepConv2DSupportsParams(int stride_rows, int stride_cols,
+                              int filter_rows, int filter_cols);
+
 // Returns true if convolution operation specified by function arguments
 // can use DeepConv2D implementation, and false otherwise.
 // May return false based on parameters, cost, or whether feature is disabled.
+// On success, stores the cheapest transform for the convolution in
+// 'algorithm'.
 bool CanUseDeepConv2D(int stride_rows, int stride_cols, int filter_rows,
                       int filter_cols, int in_depth, int out_depth,
-                      int out_rows, int out_cols);
+                      int out_rows, int out_cols,
+                      DeepConv2DAlgorithm* algorithm);
+
+// Returns true if Conv2D should time DeepConv2D against its other CPU
+// implementations for each convolution shape and use the fastest, instead of
+// relying on CanUseDeepConv2D.
+bool DeepConv2DAutotuneEnable();
 
 namespace functor {
 
@@ -155,5 +155,55 @@ TEST(DeepConv2DTransformTest, WingradOutputTransformMatrix) {
   }
 }
 
+TEST(DeepConv2DTransformTest, Winograd4x4ComputesConvolution) {
+  // Test that y = C[Ad * Bg] computes the 4x4 output tile of the 3x3 filter
+  // 'g' correlated with the 6x6 input tile 'd'.
+  Winograd4x4Transform<float> t;
+  const int tile_size = 36;
+  const int filter_size = 9;
+  const int out_tile_size = 16;
+
+  float filter_matrix[tile_size * filter_size];
+  float input_matrix[tile_size * tile_size];
+  float output_matrix[out_tile_size * tile_size];
+  t.GetFilterTransformMatrix(tile_size, filter_size, &filter_matrix[0]);
+  t.GetInputTransformMatrix(tile_size, tile_size, &input_matrix[0]);
+  t.GetOutputTransformMatrix(out_tile_size, tile_size, &output_matrix[0]);
+
+  float d[tile_size];
+  float g[filter_size];
+  for (int i = 0; i < tile_size; ++i) d[i] = (i * 7) % 11 - 5;
+  for (int i = 0; i < filter_size; ++i) g[i] = (i * 5) % 7 - 3;
+
+  float product[tile_size];
+  for (int i = 0; i < tile_size; ++i) {
+    float ad = 0;
+    for (int j = 0; j < tile_size; ++j) {
+      ad += input_matrix[i * tile_size + j] * d[j];
+    }
+    float bg = 0;
+    for (int j = 0; j < filter_size; ++j) {
+      bg += filter_matrix[i * filter_size + j] * g[j];
+    }
+    product[i] = ad * bg;
+  }
+
+  for (int r = 0; r < 4; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      float y = 0;
+      for (int j = 0; j < tile_size; ++j) {
+        y += output_matrix[(r * 4 + c) * tile_size + j] * product[j];
+      }
+      float expected = 0;
+      for (int fr = 0; fr < 3; ++fr) {
+        for (int fc = 0; fc < 3; ++fc) {
+          expected += d[(r + fr) * 6 + c + fc] * g[fr * 3 + fc];
+        }
+      }
+      EXPECT_NEAR(expected, y, 1e-3) << r << ", " << c;
+    }
+  }
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -15,6 +15,9 @@ limitations under the License.
 
 // See docs in ../ops/data_flow_ops.cc.
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <vector>
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -23,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -97,6 +101,11 @@ class DynamicPartitionOp : public DynamicPartitionOp_Shared {
 
     auto e_partitions = partitions->flat<int32>();
     const int64 N = e_partitions.dimension(0);
+    if (DataTypeCanUseMemcpy(DataTypeToEnum<T>::v()) &&
+        data->TotalBytes() >= kParallelCopyMinBytes) {
+      PartitionInParallel(c, *data, *partitions, &outputs);
+      return;
+    }
     gtl::InlinedVector<int, 32> output_index(num_partitions_);
 
     if (partitions->dims() == data->dims()) {
@@ -156,8 +165,93 @@ class DynamicPartitionOp : public DynamicPartitionOp_Shared {
       }
     }
   }
+
+ private:
+  // Data of at least this many bytes is partitioned in parallel.
+  static constexpr int64 kParallelCopyMinBytes = 256 << 10;
+
+  // Partitions the slices of data in blocks, one per worker thread. Each block
+  // counts its slices per partition, and a prefix sum of the counts over the
+  // blocks gives the offset of the first slice of each block in each output,
+  // so that the blocks scatter their slices concurrently and keep their order.
+  void PartitionInParallel(OpKernelContext* c, const Tensor& data,
+                           const Tensor& partitions, OpOutputList* outputs) {
+    auto e_partitions = partitions.flat<int32>();
+    const int64 N = e_partitions.dimension(0);
+    const int64 slice_size = data.NumElements() / N;
+    const size_t slice_bytes = slice_size * sizeof(T);
+    const T* data_base = data.flat<T>().data();
+
+    auto worker_threads = c->device()->tensorflow_cpu_worker_threads();
+    const int64 num_blocks =
+        std::min<int64>(std::max(worker_threads->num_threads, 1), N);
+    const int64 block_size = (N + num_blocks - 1) / num_blocks;
+    // offsets[b * num_partitions_ + p] is the count of the slices of block b
+    // in partition p, then the index of its first slice in output p.
+    std::vector<int64> offsets(num_blocks * num_partitions_, 0);
+    std::atomic<bool> out_of_range(false);
+    auto for_blocks = [&](std::function<void(int64, int64, int64*)> fn) {
+      Shard(worker_threads->num_threads, worker_threads->workers, num_blocks,
+            block_size * slice_bytes, [&](int64 start, int64 limit) {
+              for (int64 b = start; b < limit; ++b) {
+                fn(b * block_size, std::min(N, (b + 1) * block_size),
+                   &offsets[b * num_partitions_]);
+              }
+            });
+    };
+
+    for_blocks([&](int64 begin, int64 end, int64* block_offsets) {
+      for (int64 i = begin; i < end; ++i) {
+        const int32 p = internal::SubtleMustCopy(e_partitions(i));
+        if (!FastBoundsCheck(p, num_partitions_)) {
+          out_of_range = true;
+          return;
+        }
+        ++block_offsets[p];
+      }
+    });
+    OP_REQUIRES(c, !out_of_range,
+                errors::InvalidArgument(
+                    "partitions has been asynchronously overwritten and is no "
+                    "longer in range!"));
+    for (int p = 0; p < num_partitions_; ++p) {
+      int64 offset = 0;
+      for (int64 b = 0; b < num_blocks; ++b) {
+        const int64 count = offsets[b * num_partitions_ + p];
+        offsets[b * num_partitions_ + p] = offset;
+        offset += count;
+      }
+    }
+
+    std::vector<T*> out_base(num_partitions_);
+    std::vector<int64> out_rows(num_partitions_);
+    for (int p = 0; p < num_partitions_; ++p) {
+      out_base[p] = (*outputs)[p]->flat<T>().data();
+      out_rows[p] = (*outputs)[p]->NumElements() / slice_size;
+    }
+    for_blocks([&](int64 begin, int64 end, int64* block_offsets) {
+      for (int64 i = begin; i < end; ++i) {
+        const int32 p = internal::SubtleMustCopy(e_partitions(i));
+        if (!FastBoundsCheck(p, num_partitions_) ||
+            !FastBoundsCheck(block_offsets[p], out_rows[p])) {
+          out_of_range = true;
+          return;
+        }
+        memcpy(out_base[p] + block_offsets[p] * slice_size,
+               data_base + i * slice_size, slice_bytes);
+        ++block_offsets[p];
+      }
+    });
+    OP_REQUIRES(c, !out_of_range,
+                errors::InvalidArgument(
+                    "partitions has been asynchronously overwritten and is no "
+                    "longer in range!"));
+  }
 };
 
+template <class T>
+constexpr int64 DynamicPartitionOp<T>::kParallelCopyMinBytes;
+
 #define REGISTER_DYNAMIC_PARTITION(T)                                     \
   REGISTER_KERNEL_BUILDER(                                                \
       Name("DynamicPartition").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
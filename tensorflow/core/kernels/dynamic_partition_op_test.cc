@@ -15,6 +15,7 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -146,6 +147,36 @@ TEST_F(DynamicPartitionOpTest, SomeOutputsEmpty) {
   }
 }
 
+TEST_F(DynamicPartitionOpTest, Large_ParallelCopy) {
+  MakeOp();
+
+  // Large enough to partition the rows in parallel.
+  const int kRows = 1024;
+  const int kCols = 128;
+  std::vector<float> data(kRows * kCols);
+  std::vector<int32> partitions(kRows);
+  std::vector<std::vector<float>> expected_values(4);
+  for (int row = 0; row < kRows; ++row) {
+    partitions[row] = (row * 7) % 3 + (row % 5 == 0 ? 1 : 0);
+    for (int col = 0; col < kCols; ++col) {
+      data[row * kCols + col] = row * kCols + col;
+      expected_values[partitions[row]].push_back(row * kCols + col);
+    }
+  }
+  AddInputFromArray<float>(TensorShape({kRows, kCols}), data);
+  AddInputFromArray<int32>(TensorShape({kRows}), partitions);
+  TF_ASSERT_OK(RunOpKernel());
+
+  for (int p = 0; p < 4; ++p) {
+    Tensor expected(
+        allocator(), DT_FLOAT,
+        TensorShape({static_cast<int64>(expected_values[p].size()) / kCols,
+                     kCols}));
+    test::FillValues<float>(&expected, expected_values[p]);
+    test::ExpectTensorEqual<float>(expected, *GetOutput(p));
+  }
+}
+
 TEST_F(DynamicPartitionOpTest, Error_IndexOutOfRange) {
   MakeOp();
 
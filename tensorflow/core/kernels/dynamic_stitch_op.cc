@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/kernels/gpu_device_array.h"
@@ -77,6 +78,18 @@ class DynamicStitchOpImplBase : public OpKernel {
                                   OpInputList* data_inputs, int* first_dim_size,
                                   int* data_elements_size,
                                   Tensor** result_ptr) {
+    TensorShape result_shape;
+    CheckArgsAndGetResultShape(c, indices_inputs, data_inputs, first_dim_size,
+                               data_elements_size, &result_shape);
+    if (!c->status().ok()) return;
+    OP_REQUIRES_OK(c, c->allocate_output(0, result_shape, result_ptr));
+  }
+
+  void CheckArgsAndGetResultShape(OpKernelContext* c,
+                                  OpInputList* indices_inputs,
+                                  OpInputList* data_inputs, int* first_dim_size,
+                                  int* data_elements_size,
+                                  TensorShape* result_shape) {
     // Find maximum index in the indices vectors
     OP_REQUIRES_OK(c, c->input_list("indices", indices_inputs));
 
@@ -122,14 +135,12 @@ class DynamicStitchOpImplBase : public OpKernel {
               "].shape = ", indices.shape().DebugString()));
     }
 
-    // Allocate result tensor of shape
+    // The result tensor has shape
     //   [*first_dim_size] + data.shape[indices.dims:]
-    TensorShape result_shape;
-    result_shape.AddDim(*first_dim_size);
+    result_shape->AddDim(*first_dim_size);
     for (int d = indices0.dims(); d < data0.dims(); d++) {
-      result_shape.AddDim(data0.dim_size(d));
+      result_shape->AddDim(data0.dim_size(d));
     }
-    OP_REQUIRES_OK(c, c->allocate_output(0, result_shape, result_ptr));
   }
 };
 
@@ -236,14 +247,16 @@ class DynamicStitchOpImplCPU : public DynamicStitchOpImplBase<T> {
     OpInputList indices_inputs;
     OpInputList data_inputs;
     int first_dim_size;
-    Tensor* merged = nullptr;
-    this->CheckArgsAndAllocateResult(c, &indices_inputs, &data_inputs,
-                                     &first_dim_size, nullptr, &merged);
-    if (!c->status().ok()) {
-      // Avoid segmentation faults if merged cannot be allocated and an error is
-      // passed back in the context.
+    TensorShape result_shape;
+    this->CheckArgsAndGetResultShape(c, &indices_inputs, &data_inputs,
+                                     &first_dim_size, nullptr, &result_shape);
+    if (!c->status().ok()) return;
+    if (MaybeForwardInput(c, indices_inputs, data_inputs, first_dim_size,
+                          result_shape)) {
       return;
     }
+    Tensor* merged = nullptr;
+    OP_REQUIRES_OK(c, c->allocate_output(0, result_shape, &merged));
 
     // TODO(jeff): Currently we leave uninitialized any portions of
     // merged that aren't covered by an index in indices.  What should we do?
@@ -251,6 +264,12 @@ class DynamicStitchOpImplCPU : public DynamicStitchOpImplBase<T> {
       auto merged_flat = merged->flat_outer_dims<T>();
       const int slice_size = merged_flat.dimension(1);
       const size_t slice_bytes = slice_size * sizeof(T);
+      if (DataTypeCanUseMemcpy(DataTypeToEnum<T>::v()) &&
+          merged->TotalBytes() >= kParallelCopyMinBytes) {
+        CopyRowsInParallel(c, indices_inputs, data_inputs, first_dim_size,
+                           slice_size, merged_flat.data());
+        return;
+      }
       auto OnInputNumber = [&](int input_num) {
         const Tensor& indices = indices_inputs[input_num];
         auto indices_vec = indices.flat<int32>();
@@ -310,8 +329,73 @@ class DynamicStitchOpImplCPU : public DynamicStitchOpImplBase<T> {
       }
     }
   }
+
+ private:
+  // Outputs of at least this many bytes are copied by rows in parallel.
+  static constexpr int64 kParallelCopyMinBytes = 256 << 10;
+
+  // If the last input with indices has the indices 0, 1, ...,
+  // first_dim_size - 1, its slices overwrite those of all of the other
+  // inputs: forwards its data as the output, and returns true.
+  bool MaybeForwardInput(OpKernelContext* c, const OpInputList& indices_inputs,
+                         const OpInputList& data_inputs, int first_dim_size,
+                         const TensorShape& result_shape) {
+    int input_num = indices_inputs.size() - 1;
+    while (input_num >= 0 && indices_inputs[input_num].NumElements() == 0) {
+      --input_num;
+    }
+    if (input_num < 0 ||
+        indices_inputs[input_num].NumElements() != first_dim_size) {
+      return false;
+    }
+    auto indices_vec = indices_inputs[input_num].flat<int32>();
+    for (int i = 0; i < first_dim_size; ++i) {
+      if (indices_vec(i) != i) return false;
+    }
+    Tensor merged;
+    if (!merged.CopyFrom(data_inputs[input_num], result_shape)) return false;
+    c->set_output(0, merged);
+    return true;
+  }
+
+  // Copies the slices of the data to the rows of merged in parallel.  The
+  // slice of each row is picked first, so that it is the last one in the
+  // order of the inputs as in the sequential copy, even for duplicate indices.
+  void CopyRowsInParallel(OpKernelContext* c,
+                          const OpInputList& indices_inputs,
+                          const OpInputList& data_inputs, int first_dim_size,
+                          int slice_size, T* merged_base) {
+    // The slice of each row of merged, or nullptr for the rows not covered by
+    // any index.
+    std::vector<const T*> row_slices(first_dim_size, nullptr);
+    for (int input_num = 0; input_num < indices_inputs.size(); input_num++) {
+      auto indices_vec = indices_inputs[input_num].flat<int32>();
+      const T* data_base = data_inputs[input_num].flat<T>().data();
+      for (int i = 0; i < indices_vec.size(); i++) {
+        int32 index = internal::SubtleMustCopy(indices_vec(i));
+        OP_REQUIRES(
+            c, FastBoundsCheck(index, first_dim_size),
+            errors::InvalidArgument("indices[", i, "] is out of range"));
+        row_slices[index] = data_base + static_cast<int64>(i) * slice_size;
+      }
+    }
+    const size_t slice_bytes = slice_size * sizeof(T);
+    auto worker_threads = c->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, first_dim_size,
+          slice_bytes, [&](int64 start, int64 limit) {
+            for (int64 row = start; row < limit; ++row) {
+              if (row_slices[row] != nullptr) {
+                memcpy(merged_base + row * slice_size, row_slices[row],
+                       slice_bytes);
+              }
+            }
+          });
+  }
 };
 
+template <class T, bool Parallel>
+constexpr int64 DynamicStitchOpImplCPU<T, Parallel>::kParallelCopyMinBytes;
+
 // Using inheritance rather than a typedef so that these classes might have more
 // functionality later.
 
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/fake_input.h"
@@ -80,6 +81,64 @@ TEST_F(DynamicStitchOpTest, Simple_TwoD) {
   test::ExpectTensorEqual<float>(expected, *GetOutput(0));
 }
 
+TEST_F(DynamicStitchOpTest, ForwardsCoveringInput) {
+  MakeOp(2, DT_FLOAT);
+
+  // The last input overwrites all of the slices of the first one.
+  AddInputFromArray<int32>(TensorShape({2}), {3, 1});
+  AddInputFromArray<int32>(TensorShape({4}), {0, 1, 2, 3});
+  AddInputFromArray<float>(TensorShape({2, 2}), {30, 31, 10, 11});
+  AddInputFromArray<float>(TensorShape({4, 2}), {0, 1, 2, 3, 4, 5, 6, 7});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({4, 2}));
+  test::FillValues<float>(&expected, {0, 1, 2, 3, 4, 5, 6, 7});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+  EXPECT_TRUE(GetOutput(0)->SharesBufferWith(GetInput(3)));
+}
+
+TEST_F(DynamicStitchOpTest, Large_ParallelCopy) {
+  MakeOp(2, DT_FLOAT);
+
+  // Large enough to copy the rows in parallel, with the odd rows in both
+  // inputs.
+  const int kRows = 1024;
+  const int kCols = 128;
+  std::vector<int32> indices0, indices1;
+  std::vector<float> data0, data1, expected_values(kRows * kCols);
+  for (int row = 0; row < kRows; ++row) {
+    std::vector<float> values(kCols);
+    for (int col = 0; col < kCols; ++col) {
+      values[col] = expected_values[row * kCols + col] = row * kCols + col;
+    }
+    if (row % 2 == 1) {
+      // Overwritten by the second input.
+      indices0.push_back(row);
+      data0.insert(data0.end(), kCols, -1.0f);
+    }
+    if (row % 4 == 0) {
+      indices0.push_back(row);
+      data0.insert(data0.end(), values.begin(), values.end());
+    } else {
+      indices1.push_back(row);
+      data1.insert(data1.end(), values.begin(), values.end());
+    }
+  }
+  AddInputFromArray<int32>(TensorShape({static_cast<int64>(indices0.size())}),
+                           indices0);
+  AddInputFromArray<int32>(TensorShape({static_cast<int64>(indices1.size())}),
+                           indices1);
+  AddInputFromArray<float>(
+      TensorShape({static_cast<int64>(indices0.size()), kCols}), data0);
+  AddInputFromArray<float>(
+      TensorShape({static_cast<int64>(indices1.size()), kCols}), data1);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({kRows, kCols}));
+  test::FillValues<float>(&expected, expected_values);
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
 TEST_F(DynamicStitchOpTest, Error_IndicesMultiDimensional) {
   MakeOp(2, DT_FLOAT);
 
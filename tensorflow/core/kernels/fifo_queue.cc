@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <deque>
+#include <thread>
 #include <vector>
 
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/batch_util.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -38,6 +40,90 @@ FIFOQueue::FIFOQueue(int capacity, const DataTypeVector& component_dtypes,
                      const string& name)
     : TypedQueue(capacity, component_dtypes, component_shapes, name) {}
 
+Status FIFOQueue::Initialize() {
+  TF_RETURN_IF_ERROR(TypedQueue::Initialize());
+  bool lock_free;
+  TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_ENABLE_LOCK_FREE_FIFO_QUEUE",
+                                        false, &lock_free));
+  if (lock_free && capacity_ > 0 && capacity_ <= kMaxLockFreeCapacity) {
+    ring_.reset(new MpmcRingBuffer<std::vector<PersistentTensor>>(capacity_));
+    lock_free_enabled_ = true;
+  }
+  return Status::OK();
+}
+
+void FIFOQueue::BeginFlushLocked() {
+  if (ring_ == nullptr) return;
+  // Together with the order of the operations in TryEnqueueLockFree(), this
+  // ensures that every lock-free operation either has finished or will see
+  // lock_free_enabled_ == false.
+  lock_free_enabled_ = false;
+  while (lock_free_ops_ > 0) {
+    std::this_thread::yield();
+  }
+  std::vector<PersistentTensor> element;
+  while (ring_->TryPop(&element)) {
+    for (int i = 0; i < num_components(); ++i) {
+      queues_[i].push_back(std::move(element[i]));
+    }
+  }
+}
+
+void FIFOQueue::EndFlushLocked() {
+  if (ring_ == nullptr || closed_ || !enqueue_attempts_.empty() ||
+      !dequeue_attempts_.empty() ||
+      queues_[0].size() > static_cast<size_t>(ring_->capacity())) {
+    return;
+  }
+  std::vector<PersistentTensor> element;
+  while (!queues_[0].empty()) {
+    element.resize(num_components());
+    for (int i = 0; i < num_components(); ++i) {
+      element[i] = std::move(queues_[i].front());
+      queues_[i].pop_front();
+    }
+    CHECK(ring_->TryPush(&element));
+  }
+  lock_free_enabled_ = true;
+}
+
+bool FIFOQueue::TryEnqueueLockFree(const Tuple& tuple, OpKernelContext* ctx) {
+  if (ring_ == nullptr || ctx->cancellation_manager()->IsCancelled()) {
+    return false;
+  }
+  bool pushed = false;
+  ++lock_free_ops_;
+  if (lock_free_enabled_) {
+    std::vector<PersistentTensor> element;
+    element.reserve(num_components());
+    for (int i = 0; i < num_components(); ++i) {
+      element.emplace_back(tuple[i]);
+    }
+    pushed = ring_->TryPush(&element);
+  }
+  --lock_free_ops_;
+  return pushed;
+}
+
+bool FIFOQueue::TryDequeueLockFree(OpKernelContext* ctx, Tuple* tuple) {
+  if (ring_ == nullptr || ctx->cancellation_manager()->IsCancelled()) {
+    return false;
+  }
+  std::vector<PersistentTensor> element;
+  bool popped = false;
+  ++lock_free_ops_;
+  if (lock_free_enabled_) {
+    popped = ring_->TryPop(&element);
+  }
+  --lock_free_ops_;
+  if (!popped) return false;
+  tuple->reserve(num_components());
+  for (int i = 0; i < num_components(); ++i) {
+    tuple->push_back(*element[i].AccessTensor(ctx));
+  }
+  return true;
+}
+
 void FIFOQueue::DequeueLocked(OpKernelContext* ctx, Tuple* tuple) {
   DCHECK_GT(queues_[0].size(), size_t{0});
   (*tuple).reserve(num_components());
@@ -49,6 +135,11 @@ void FIFOQueue::DequeueLocked(OpKernelContext* ctx, Tuple* tuple) {
 
 void FIFOQueue::TryEnqueue(const Tuple& tuple, OpKernelContext* ctx,
                            DoneCallback callback) {
+  if (TryEnqueueLockFree(tuple, ctx)) {
+    callback();
+    return;
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -153,6 +244,14 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
 }
 
 void FIFOQueue::TryDequeue(OpKernelContext* ctx, CallbackWithTuple callback) {
+  {
+    Tuple tuple;
+    if (TryDequeueLockFree(ctx, &tuple)) {
+      callback(tuple);
+      return;
+    }
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -16,13 +16,16 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_FIFO_QUEUE_H_
 #define TENSORFLOW_CORE_KERNELS_FIFO_QUEUE_H_
 
+#include <atomic>
 #include <deque>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/mpmc_ring_buffer.h"
 #include "tensorflow/core/kernels/queue_op.h"
 #include "tensorflow/core/kernels/typed_queue.h"
 #include "tensorflow/core/platform/macros.h"
@@ -31,12 +34,23 @@ limitations under the License.
 
 namespace tensorflow {
 
+// If the TF_ENABLE_LOCK_FREE_FIFO_QUEUE environment variable is true, a
+// FIFOQueue with a capacity of at most kMaxLockFreeCapacity serves
+// single-element Enqueue and Dequeue without taking mu_ while no other
+// operation is waiting on the queue: the elements then live in a lock-free
+// ring buffer instead of queues_. Any operation that does need mu_ moves them
+// back to queues_ in BeginFlushLocked(), so blocking, batched, closing and
+// cancelled operations behave exactly as without the ring buffer.
 class FIFOQueue : public TypedQueue<std::deque<PersistentTensor> > {
  public:
+  static const int32 kMaxLockFreeCapacity = 1 << 16;
+
   FIFOQueue(int32 capacity, const DataTypeVector& component_dtypes,
             const std::vector<TensorShape>& component_shapes,
             const string& name);
 
+  Status Initialize() override;
+
   // Implementations of QueueInterface methods --------------------------------
 
   void TryEnqueue(const Tuple& tuple, OpKernelContext* ctx,
@@ -51,7 +65,7 @@ class FIFOQueue : public TypedQueue<std::deque<PersistentTensor> > {
 
   int32 size() const override {
     mutex_lock lock(mu_);
-    return queues_[0].size();
+    return queues_[0].size() + (ring_ == nullptr ? 0 : ring_->size());
   }
 
  protected:
@@ -61,12 +75,33 @@ class FIFOQueue : public TypedQueue<std::deque<PersistentTensor> > {
   void DequeueLocked(OpKernelContext* ctx, Tuple* tuple)
       EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Moves the elements from ring_ to queues_ and keeps TryEnqueue() and
+  // TryDequeue() from touching ring_ until EndFlushLocked() finds that the
+  // queue is idle and moves them back.
+  void BeginFlushLocked() override EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void EndFlushLocked() override EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Lock-free versions of TryEnqueue() and TryDequeue(). Return false if the
+  // operation has to go through the attempt queues instead.
+  bool TryEnqueueLockFree(const Tuple& tuple, OpKernelContext* ctx);
+  bool TryDequeueLockFree(OpKernelContext* ctx, Tuple* tuple);
+
   static Status GetElementComponentFromBatch(const Tuple& tuple, int64 index,
                                              int component,
                                              OpKernelContext* ctx,
                                              PersistentTensor* out_element);
 
  private:
+  // Holds the elements, one tuple per slot, while lock_free_enabled_ is true.
+  // Null unless the lock-free path is enabled.
+  std::unique_ptr<MpmcRingBuffer<std::vector<PersistentTensor>>> ring_;
+  // Set by EndFlushLocked() when the lock-free path may be used, and cleared
+  // by BeginFlushLocked().
+  std::atomic<bool> lock_free_enabled_{false};
+  // Number of TryEnqueueLockFree() and TryDequeueLockFree() calls that may
+  // be accessing ring_.
+  std::atomic<int32> lock_free_ops_{0};
+
   TF_DISALLOW_COPY_AND_ASSIGN(FIFOQueue);
 };
 
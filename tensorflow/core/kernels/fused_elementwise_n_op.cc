@@ -0,0 +1,196 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#define EIGEN_USE_GPU
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#include "tensorflow/core/kernels/fused_elementwise_n_op.h"
+
+#include <unordered_map>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace functor {
+
+template <typename T>
+struct FusedElementwiseN<CPUDevice, T> {
+  void operator()(const CPUDevice& d, ElementwiseNOp op,
+                  const FusedElementwiseNArgs<T>& args) {
+    for (size_t i = 0; i < args.x.size(); ++i) {
+      typename TTypes<T>::ConstFlat x(args.x[i], args.sizes[i]);
+      typename TTypes<T>::Flat z(args.z[i], args.sizes[i]);
+      if (!IsBinary(op)) {
+        VisitUnaryElementwiseNOp<T>(
+            op, [&](auto func) { z.device(d) = x.unaryExpr(func); });
+      } else if (args.y_is_scalar[i]) {
+        const T y = *args.y[i];
+        VisitBinaryElementwiseNOp<T>(op, [&](auto func) {
+          z.device(d) = x.binaryExpr(x.constant(y), func);
+        });
+      } else {
+        typename TTypes<T>::ConstFlat y(args.y[i], args.sizes[i]);
+        VisitBinaryElementwiseNOp<T>(
+            op, [&](auto func) { z.device(d) = x.binaryExpr(y, func); });
+      }
+    }
+  }
+};
+
+}  // namespace functor
+
+namespace {
+
+// WARN: This should be consistent with the fusable ops in remapper.cc.
+bool GetFusedElementwiseNOp(const string& name,
+                            functor::ElementwiseNOp* op) {
+  using functor::ElementwiseNOp;
+  static const auto* ops =
+      new std::unordered_map<string, ElementwiseNOp>({
+          {"Abs", ElementwiseNOp::kAbs},
+          {"Exp", ElementwiseNOp::kExp},
+          {"Log", ElementwiseNOp::kLog},
+          {"Neg", ElementwiseNOp::kNeg},
+          {"Relu", ElementwiseNOp::kRelu},
+          {"Rsqrt", ElementwiseNOp::kRsqrt},
+          {"Sigmoid", ElementwiseNOp::kSigmoid},
+          {"Sqrt", ElementwiseNOp::kSqrt},
+          {"Square", ElementwiseNOp::kSquare},
+          {"Tanh", ElementwiseNOp::kTanh},
+          {"Add", ElementwiseNOp::kAdd},
+          {"AddV2", ElementwiseNOp::kAdd},
+          {"Maximum", ElementwiseNOp::kMaximum},
+          {"Minimum", ElementwiseNOp::kMinimum},
+          {"Mul", ElementwiseNOp::kMul},
+          {"RealDiv", ElementwiseNOp::kRealDiv},
+          {"Sub", ElementwiseNOp::kSub},
+      });
+  const auto it = ops->find(name);
+  if (it == ops->end()) return false;
+  *op = it->second;
+  return true;
+}
+
+}  // namespace
+
+template <typename Device, typename T>
+class FusedElementwiseNOp : public OpKernel {
+ public:
+  explicit FusedElementwiseNOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    string fused_op;
+    OP_REQUIRES_OK(context, context->GetAttr("fused_op", &fused_op));
+    OP_REQUIRES(context, GetFusedElementwiseNOp(fused_op, &op_),
+                errors::InvalidArgument(
+                    "Unsupported op in fused elementwise N op: ", fused_op));
+    int n;
+    OP_REQUIRES_OK(context, context->GetAttr("N", &n));
+    int num_args;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+    const int expected_num_args = functor::IsBinary(op_) ? n : 0;
+    OP_REQUIRES(context, num_args == expected_num_args,
+                errors::InvalidArgument(fused_op, " takes ", expected_num_args,
+                                        " args, but num_args is ", num_args));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    OpInputList x;
+    OP_REQUIRES_OK(ctx, ctx->input_list("x", &x));
+    OpInputList args;
+    OP_REQUIRES_OK(ctx, ctx->input_list("args", &args));
+
+    functor::FusedElementwiseNArgs<T> fused_args;
+    for (int i = 0; i < x.size(); ++i) {
+      Tensor* out = nullptr;
+      OP_REQUIRES_OK(ctx, ctx->forward_input_or_allocate_output(
+                              {i}, i, x[i].shape(), &out));
+      bool y_is_scalar = false;
+      if (!args.empty()) {
+        y_is_scalar = TensorShapeUtils::IsScalar(args[i].shape());
+        OP_REQUIRES(ctx, y_is_scalar || args[i].shape() == x[i].shape(),
+                    errors::InvalidArgument(
+                        "Arg ", i, " of a fused elementwise N op must be a "
+                        "scalar or have the shape of x ",
+                        x[i].shape().DebugString(), ", got ",
+                        args[i].shape().DebugString()));
+      }
+      if (x[i].NumElements() == 0) continue;
+      fused_args.x.push_back(x[i].flat<T>().data());
+      fused_args.z.push_back(out->flat<T>().data());
+      fused_args.sizes.push_back(x[i].NumElements());
+      if (!args.empty()) {
+        fused_args.y.push_back(args[i].flat<T>().data());
+        fused_args.y_is_scalar.push_back(y_is_scalar);
+      }
+    }
+    if (fused_args.x.empty()) return;
+    functor::FusedElementwiseN<Device, T>()(ctx->eigen_device<Device>(), op_,
+                                            fused_args);
+  }
+
+ private:
+  functor::ElementwiseNOp op_;
+};
+
+#define REGISTER_CPU(T)                                                     \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("_FusedElementwiseN").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedElementwiseNOp<CPUDevice, T>);
+
+REGISTER_CPU(float);
+REGISTER_CPU(double);
+
+#undef REGISTER_CPU
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+namespace functor {
+#define DECLARE_GPU_SPEC(T)                                                  \
+  template <>                                                                \
+  void FusedElementwiseN<GPUDevice, T>::operator()(                          \
+      const GPUDevice& d, ElementwiseNOp op,                                 \
+      const FusedElementwiseNArgs<T>& args);                                 \
+  extern template struct FusedElementwiseN<GPUDevice, T>;
+
+DECLARE_GPU_SPEC(float);
+DECLARE_GPU_SPEC(double);
+
+#undef DECLARE_GPU_SPEC
+}  // namespace functor
+
+#define REGISTER_GPU(T)                                                     \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("_FusedElementwiseN").Device(DEVICE_GPU).TypeConstraint<T>("T"), \
+      FusedElementwiseNOp<GPUDevice, T>);
+
+REGISTER_GPU(float);
+REGISTER_GPU(double);
+
+#undef REGISTER_GPU
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+}  // namespace tensorflow
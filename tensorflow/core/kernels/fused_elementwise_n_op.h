@@ -0,0 +1,131 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_FUSED_ELEMENTWISE_N_OP_H_
+#define TENSORFLOW_CORE_KERNELS_FUSED_ELEMENTWISE_N_OP_H_
+
+#include <vector>
+
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/cwise_ops.h"
+
+namespace tensorflow {
+namespace functor {
+
+// The element-wise ops supported by _FusedElementwiseN. Binary ops follow
+// kAdd.
+// WARN: This should be consistent with the fusable ops in remapper.cc.
+enum class ElementwiseNOp {
+  kAbs,
+  kExp,
+  kLog,
+  kNeg,
+  kRelu,
+  kRsqrt,
+  kSigmoid,
+  kSqrt,
+  kSquare,
+  kTanh,
+  kAdd,
+  kMaximum,
+  kMinimum,
+  kMul,
+  kRealDiv,
+  kSub,
+};
+
+inline bool IsBinary(ElementwiseNOp op) {
+  return op >= ElementwiseNOp::kAdd;
+}
+
+// The tensors of a _FusedElementwiseN op: z[i] = op(x[i]) for unary ops, and
+// z[i] = op(x[i], y[i]) for binary ops, where y[i] is broadcast if it is a
+// scalar. Each x[i] and z[i] has sizes[i] elements.
+template <typename T>
+struct FusedElementwiseNArgs {
+  std::vector<const T*> x;
+  std::vector<const T*> y;
+  std::vector<bool> y_is_scalar;
+  std::vector<T*> z;
+  std::vector<int64> sizes;
+};
+
+template <typename Device, typename T>
+struct FusedElementwiseN {
+  void operator()(const Device& d, ElementwiseNOp op,
+                  const FusedElementwiseNArgs<T>& args);
+};
+
+template <typename T>
+struct relu_op {
+  EIGEN_DEVICE_FUNC EIGEN_STRONG_INLINE T operator()(const T& x) const {
+    return x > static_cast<T>(0) ? x : static_cast<T>(0);
+  }
+};
+
+// Calls `fn` with the scalar functor of the unary `op`.
+template <typename T, typename Fn>
+void VisitUnaryElementwiseNOp(ElementwiseNOp op, Fn fn) {
+  switch (op) {
+    case ElementwiseNOp::kAbs:
+      return fn(typename abs<T>::func());
+    case ElementwiseNOp::kExp:
+      return fn(typename exp<T>::func());
+    case ElementwiseNOp::kLog:
+      return fn(typename log<T>::func());
+    case ElementwiseNOp::kNeg:
+      return fn(typename neg<T>::func());
+    case ElementwiseNOp::kRelu:
+      return fn(relu_op<T>());
+    case ElementwiseNOp::kRsqrt:
+      return fn(typename rsqrt<T>::func());
+    case ElementwiseNOp::kSigmoid:
+      return fn(typename sigmoid<T>::func());
+    case ElementwiseNOp::kSqrt:
+      return fn(typename sqrt<T>::func());
+    case ElementwiseNOp::kSquare:
+      return fn(typename square<T>::func());
+    case ElementwiseNOp::kTanh:
+      return fn(typename tanh<T>::func());
+    default:
+      LOG(FATAL) << "Not a unary op: " << static_cast<int>(op);
+  }
+}
+
+// Calls `fn` with the scalar functor of the binary `op`.
+template <typename T, typename Fn>
+void VisitBinaryElementwiseNOp(ElementwiseNOp op, Fn fn) {
+  switch (op) {
+    case ElementwiseNOp::kAdd:
+      return fn(typename add<T>::func());
+    case ElementwiseNOp::kMaximum:
+      return fn(typename maximum<T>::func());
+    case ElementwiseNOp::kMinimum:
+      return fn(typename minimum<T>::func());
+    case ElementwiseNOp::kMul:
+      return fn(typename mul<T>::func());
+    case ElementwiseNOp::kRealDiv:
+      return fn(typename div<T>::func());
+    case ElementwiseNOp::kSub:
+      return fn(typename sub<T>::func());
+    default:
+      LOG(FATAL) << "Not a binary op: " << static_cast<int>(op);
+  }
+}
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_FUSED_ELEMENTWISE_N_OP_H_
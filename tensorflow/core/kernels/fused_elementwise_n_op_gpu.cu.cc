@@ -0,0 +1,127 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include <algorithm>
+
+#include "tensorflow/core/kernels/fused_elementwise_n_op.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace functor {
+namespace {
+
+// The tensors of one launch are passed by value as a kernel parameter, which
+// must stay below 4KB.
+constexpr int kMaxTensorsPerLaunch = 48;
+
+template <typename T>
+struct LaunchArgs {
+  const T* x[kMaxTensorsPerLaunch];
+  const T* y[kMaxTensorsPerLaunch];
+  T* z[kMaxTensorsPerLaunch];
+  // Tensor t covers elements [offsets[t], offsets[t + 1]) of the launch.
+  int64 offsets[kMaxTensorsPerLaunch + 1];
+  bool y_is_scalar[kMaxTensorsPerLaunch];
+  int num_tensors;
+};
+
+// Returns the tensor of the launch holding element `i`, starting the search
+// from tensor `t`. Each thread visits increasing elements, so the search only
+// moves forward.
+template <typename T>
+__device__ EIGEN_STRONG_INLINE int FindTensor(const LaunchArgs<T>& args,
+                                              int64 i, int t) {
+  while (i >= args.offsets[t + 1]) ++t;
+  return t;
+}
+
+template <typename T, typename Functor>
+__global__ void FusedUnaryNKernel(const LaunchArgs<T> args, Functor func) {
+  int t = 0;
+  for (int64 i : GpuGridRangeX<int64>(args.offsets[args.num_tensors])) {
+    t = FindTensor(args, i, t);
+    const int64 j = i - args.offsets[t];
+    args.z[t][j] = func(ldg(args.x[t] + j));
+  }
+}
+
+template <typename T, typename Functor>
+__global__ void FusedBinaryNKernel(const LaunchArgs<T> args, Functor func) {
+  int t = 0;
+  for (int64 i : GpuGridRangeX<int64>(args.offsets[args.num_tensors])) {
+    t = FindTensor(args, i, t);
+    const int64 j = i - args.offsets[t];
+    const T y = ldg(args.y[t] + (args.y_is_scalar[t] ? 0 : j));
+    args.z[t][j] = func(ldg(args.x[t] + j), y);
+  }
+}
+
+}  // namespace
+
+template <typename T>
+struct FusedElementwiseN<GPUDevice, T> {
+  void operator()(const GPUDevice& d, ElementwiseNOp op,
+                  const FusedElementwiseNArgs<T>& args) {
+    const int num_tensors = args.x.size();
+    for (int begin = 0; begin < num_tensors; begin += kMaxTensorsPerLaunch) {
+      LaunchArgs<T> launch_args;
+      launch_args.num_tensors =
+          std::min(kMaxTensorsPerLaunch, num_tensors - begin);
+      launch_args.offsets[0] = 0;
+      for (int t = 0; t < launch_args.num_tensors; ++t) {
+        launch_args.x[t] = args.x[begin + t];
+        launch_args.z[t] = args.z[begin + t];
+        launch_args.offsets[t + 1] =
+            launch_args.offsets[t] + args.sizes[begin + t];
+        if (IsBinary(op)) {
+          launch_args.y[t] = args.y[begin + t];
+          launch_args.y_is_scalar[t] = args.y_is_scalar[begin + t];
+        }
+      }
+      const int64 total = launch_args.offsets[launch_args.num_tensors];
+      if (total == 0) continue;
+      GpuLaunchConfig config = GetGpuLaunchConfig(total, d);
+      if (IsBinary(op)) {
+        VisitBinaryElementwiseNOp<T>(op, [&](auto func) {
+          TF_CHECK_OK(GpuLaunchKernel(
+              FusedBinaryNKernel<T, decltype(func)>, config.block_count,
+              config.thread_per_block, 0, d.stream(), launch_args, func));
+        });
+      } else {
+        VisitUnaryElementwiseNOp<T>(op, [&](auto func) {
+          TF_CHECK_OK(GpuLaunchKernel(
+              FusedUnaryNKernel<T, decltype(func)>, config.block_count,
+              config.thread_per_block, 0, d.stream(), launch_args, func));
+        });
+      }
+    }
+  }
+};
+
+template struct FusedElementwiseN<GPUDevice, float>;
+template struct FusedElementwiseN<GPUDevice, double>;
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -0,0 +1,95 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedElementwiseNOpTest : public OpsTestBase {
+ protected:
+  template <typename T>
+  Status MakeFusedOp(const string& fused_op, int n, int num_args) {
+    TF_RETURN_IF_ERROR(
+        NodeDefBuilder("fused_elementwise_n", "_FusedElementwiseN")
+            .Input(FakeInput(n, DataTypeToEnum<T>::v()))
+            .Input(FakeInput(num_args, DataTypeToEnum<T>::v()))
+            .Attr("T", DataTypeToEnum<T>::v())
+            .Attr("N", n)
+            .Attr("num_args", num_args)
+            .Attr("fused_op", fused_op)
+            .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedElementwiseNOpTest, Unary) {
+  TF_ASSERT_OK(MakeFusedOp<float>("Relu", 3, 0));
+  AddInputFromArray<float>(TensorShape({2}), {-1.0f, 2.0f});
+  AddInputFromArray<float>(TensorShape({0}), {});
+  AddInputFromArray<float>(TensorShape({2, 2}), {3.0f, -4.0f, 5.0f, -6.0f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected0(allocator(), DT_FLOAT, TensorShape({2}));
+  test::FillValues<float>(&expected0, {0.0f, 2.0f});
+  test::ExpectClose(expected0, *GetOutput(0));
+  EXPECT_EQ(TensorShape({0}), GetOutput(1)->shape());
+  Tensor expected2(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected2, {3.0f, 0.0f, 5.0f, 0.0f});
+  test::ExpectClose(expected2, *GetOutput(2));
+}
+
+TEST_F(FusedElementwiseNOpTest, BinaryWithScalarAndTensorArgs) {
+  TF_ASSERT_OK(MakeFusedOp<double>("Sub", 2, 2));
+  AddInputFromArray<double>(TensorShape({3}), {1.0, 2.0, 3.0});
+  AddInputFromArray<double>(TensorShape({2}), {10.0, 20.0});
+  AddInputFromArray<double>(TensorShape({}), {1.0});
+  AddInputFromArray<double>(TensorShape({2}), {1.0, 2.0});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected0(allocator(), DT_DOUBLE, TensorShape({3}));
+  test::FillValues<double>(&expected0, {0.0, 1.0, 2.0});
+  test::ExpectClose(expected0, *GetOutput(0));
+  Tensor expected1(allocator(), DT_DOUBLE, TensorShape({2}));
+  test::FillValues<double>(&expected1, {9.0, 18.0});
+  test::ExpectClose(expected1, *GetOutput(1));
+}
+
+TEST_F(FusedElementwiseNOpTest, ArgShapeMismatch) {
+  TF_ASSERT_OK(MakeFusedOp<float>("Mul", 1, 1));
+  AddInputFromArray<float>(TensorShape({4}), {1.0f, 2.0f, 3.0f, 4.0f});
+  AddInputFromArray<float>(TensorShape({2}), {1.0f, 2.0f});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+TEST_F(FusedElementwiseNOpTest, WrongNumArgs) {
+  Status s = MakeFusedOp<float>("Tanh", 2, 2);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+TEST_F(FusedElementwiseNOpTest, UnsupportedOp) {
+  Status s = MakeFusedOp<float>("Sin", 1, 0);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
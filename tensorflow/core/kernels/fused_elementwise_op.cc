@@ -0,0 +1,293 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <unordered_map>
+
+#include "absl/strings/str_join.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/cwise_ops.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+// Number of elements every fused op processes at a time, so that the
+// intermediate results of the chain stay in cache between the ops.
+constexpr int64 kFusedBlockSize = 1024;
+
+template <typename T>
+using ConstFlat = typename TTypes<T>::ConstFlat;
+
+template <typename T>
+using Flat = typename TTypes<T>::Flat;
+
+template <typename T>
+using UnaryFn = void (*)(const T* in, T* out, int64 size);
+
+// A binary function broadcasts an operand with `*_is_scalar` set.
+template <typename T>
+using BinaryFn = void (*)(const T* lhs, bool lhs_is_scalar, const T* rhs,
+                          bool rhs_is_scalar, T* out, int64 size);
+
+template <typename Functor>
+constexpr int FunctorCost() {
+  return Eigen::internal::functor_traits<typename Functor::func>::Cost;
+}
+
+template <typename T, typename Functor>
+void ComputeUnary(const T* in, T* out, int64 size) {
+  Flat<T>(out, size) =
+      ConstFlat<T>(in, size).unaryExpr(typename Functor::func());
+}
+
+template <typename T>
+void ComputeRelu(const T* in, T* out, int64 size) {
+  Flat<T>(out, size) = ConstFlat<T>(in, size).cwiseMax(static_cast<T>(0));
+}
+
+template <typename T>
+void ComputeRelu6(const T* in, T* out, int64 size) {
+  Flat<T>(out, size) = ConstFlat<T>(in, size)
+                           .cwiseMax(static_cast<T>(0))
+                           .cwiseMin(static_cast<T>(6));
+}
+
+template <typename T, typename Functor>
+void ComputeBinary(const T* lhs, bool lhs_is_scalar, const T* rhs,
+                   bool rhs_is_scalar, T* out, int64 size) {
+  typename Functor::func func;
+  Flat<T> out_flat(out, size);
+  if (lhs_is_scalar) {
+    ConstFlat<T> rhs_flat(rhs, size);
+    out_flat = rhs_flat.constant(*lhs).binaryExpr(rhs_flat, func);
+  } else if (rhs_is_scalar) {
+    ConstFlat<T> lhs_flat(lhs, size);
+    out_flat = lhs_flat.binaryExpr(lhs_flat.constant(*rhs), func);
+  } else {
+    out_flat =
+        ConstFlat<T>(lhs, size).binaryExpr(ConstFlat<T>(rhs, size), func);
+  }
+}
+
+// WARN: This should be consistent with the fusable ops in remapper.cc.
+template <typename T>
+bool GetUnaryFn(const string& op, UnaryFn<T>* fn, int* cost) {
+  static const auto* fns =
+      new std::unordered_map<string, std::pair<UnaryFn<T>, int>>({
+          {"Abs", {ComputeUnary<T, functor::abs<T>>,
+                   FunctorCost<functor::abs<T>>()}},
+          {"Exp", {ComputeUnary<T, functor::exp<T>>,
+                   FunctorCost<functor::exp<T>>()}},
+          {"Log", {ComputeUnary<T, functor::log<T>>,
+                   FunctorCost<functor::log<T>>()}},
+          {"Neg", {ComputeUnary<T, functor::neg<T>>,
+                   FunctorCost<functor::neg<T>>()}},
+          {"Rsqrt", {ComputeUnary<T, functor::rsqrt<T>>,
+                     FunctorCost<functor::rsqrt<T>>()}},
+          {"Sigmoid", {ComputeUnary<T, functor::sigmoid<T>>,
+                       FunctorCost<functor::sigmoid<T>>()}},
+          {"Sqrt", {ComputeUnary<T, functor::sqrt<T>>,
+                    FunctorCost<functor::sqrt<T>>()}},
+          {"Square", {ComputeUnary<T, functor::square<T>>,
+                      FunctorCost<functor::square<T>>()}},
+          {"Tanh", {ComputeUnary<T, functor::tanh<T>>,
+                    FunctorCost<functor::tanh<T>>()}},
+          {"Relu", {ComputeRelu<T>, FunctorCost<functor::maximum<T>>()}},
+          {"Relu6", {ComputeRelu6<T>, FunctorCost<functor::maximum<T>>() +
+                                          FunctorCost<functor::minimum<T>>()}},
+      });
+  const auto it = fns->find(op);
+  if (it == fns->end()) return false;
+  *fn = it->second.first;
+  *cost = it->second.second;
+  return true;
+}
+
+// WARN: This should be consistent with the fusable ops in remapper.cc.
+template <typename T>
+bool GetBinaryFn(const string& op, BinaryFn<T>* fn, int* cost) {
+  static const auto* fns =
+      new std::unordered_map<string, std::pair<BinaryFn<T>, int>>({
+          {"Add", {ComputeBinary<T, functor::add<T>>,
+                   FunctorCost<functor::add<T>>()}},
+          {"AddV2", {ComputeBinary<T, functor::add<T>>,
+                     FunctorCost<functor::add<T>>()}},
+          {"Sub", {ComputeBinary<T, functor::sub<T>>,
+                   FunctorCost<functor::sub<T>>()}},
+          {"Mul", {ComputeBinary<T, functor::mul<T>>,
+                   FunctorCost<functor::mul<T>>()}},
+          {"RealDiv", {ComputeBinary<T, functor::div<T>>,
+                       FunctorCost<functor::div<T>>()}},
+          {"Maximum", {ComputeBinary<T, functor::maximum<T>>,
+                       FunctorCost<functor::maximum<T>>()}},
+          {"Minimum", {ComputeBinary<T, functor::minimum<T>>,
+                       FunctorCost<functor::minimum<T>>()}},
+      });
+  const auto it = fns->find(op);
+  if (it == fns->end()) return false;
+  *fn = it->second.first;
+  *cost = it->second.second;
+  return true;
+}
+
+}  // namespace
+
+template <typename T>
+class FusedElementwiseOp : public OpKernel {
+ public:
+  explicit FusedElementwiseOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::vector<string> fused_ops;
+    OP_REQUIRES_OK(context, context->GetAttr("fused_ops", &fused_ops));
+    std::vector<int32> arg_positions;
+    OP_REQUIRES_OK(context, context->GetAttr("arg_positions", &arg_positions));
+    int num_args;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+
+    OP_REQUIRES(context, !fused_ops.empty(),
+                errors::InvalidArgument(
+                    "Fused elementwise op must have at least one op"));
+    OP_REQUIRES(context, fused_ops.size() == arg_positions.size(),
+                errors::InvalidArgument(
+                    "fused_ops and arg_positions must have the same size, got ",
+                    fused_ops.size(), " and ", arg_positions.size()));
+
+    int arg_index = 0;
+    for (int i = 0; i < fused_ops.size(); ++i) {
+      Step step;
+      step.arg_position = arg_positions[i];
+      int cost = 0;
+      if (step.arg_position == -1) {
+        OP_REQUIRES(context, GetUnaryFn<T>(fused_ops[i], &step.unary_fn, &cost),
+                    errors::InvalidArgument(
+                        "Unsupported unary op in fused elementwise op: ",
+                        fused_ops[i]));
+      } else {
+        OP_REQUIRES(context, step.arg_position == 0 || step.arg_position == 1,
+                    errors::InvalidArgument(
+                        "Argument position must be -1, 0 or 1, got ",
+                        step.arg_position));
+        OP_REQUIRES(
+            context, GetBinaryFn<T>(fused_ops[i], &step.binary_fn, &cost),
+            errors::InvalidArgument(
+                "Unsupported binary op in fused elementwise op: ",
+                fused_ops[i]));
+        step.arg_index = arg_index++;
+      }
+      cost_ += cost;
+      steps_.push_back(step);
+    }
+    OP_REQUIRES(context, arg_index == num_args,
+                errors::InvalidArgument("Fused ops consume ", arg_index,
+                                        " args, but num_args is ", num_args));
+
+    VLOG(2) << "Fused elementwise op: [" << absl::StrJoin(fused_ops, ", ")
+            << "]; cost=" << cost_;
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& x = ctx->input(0);
+    OpInputList args;
+    OP_REQUIRES_OK(ctx, ctx->input_list("args", &args));
+
+    std::vector<const T*> arg_data(args.size());
+    std::vector<bool> arg_is_scalar(args.size());
+    for (int i = 0; i < args.size(); ++i) {
+      const Tensor& arg = args[i];
+      arg_is_scalar[i] = TensorShapeUtils::IsScalar(arg.shape());
+      OP_REQUIRES(ctx, arg_is_scalar[i] || arg.shape() == x.shape(),
+                  errors::InvalidArgument(
+                      "Args of a fused elementwise op must be scalars or have "
+                      "the shape of x ",
+                      x.shape().DebugString(), ", got ",
+                      arg.shape().DebugString()));
+      arg_data[i] = arg.flat<T>().data();
+    }
+
+    Tensor* out = nullptr;
+    OP_REQUIRES_OK(
+        ctx, ctx->forward_input_or_allocate_output({0}, 0, x.shape(), &out));
+    const T* in_data = x.flat<T>().data();
+    T* out_data = out->flat<T>().data();
+
+    // Apply all the ops to one block of elements before moving to the next, so
+    // that intermediate results never leave the cache. After the first op the
+    // chain is evaluated in place in the output buffer.
+    auto compute_fn = [&](int64 begin, int64 end) {
+      for (int64 block_begin = begin; block_begin < end;
+           block_begin += kFusedBlockSize) {
+        const int64 size = std::min(kFusedBlockSize, end - block_begin);
+        const T* in_block = in_data + block_begin;
+        T* out_block = out_data + block_begin;
+        for (const Step& step : steps_) {
+          if (step.arg_position == -1) {
+            step.unary_fn(in_block, out_block, size);
+          } else {
+            const bool is_scalar = arg_is_scalar[step.arg_index];
+            const T* arg_block = is_scalar
+                                     ? arg_data[step.arg_index]
+                                     : arg_data[step.arg_index] + block_begin;
+            if (step.arg_position == 0) {
+              step.binary_fn(arg_block, is_scalar, in_block, false, out_block,
+                             size);
+            } else {
+              step.binary_fn(in_block, false, arg_block, is_scalar, out_block,
+                             size);
+            }
+          }
+          in_block = out_block;
+        }
+      }
+    };
+
+    const CPUDevice& device = ctx->eigen_device<CPUDevice>();
+    Eigen::TensorOpCost cost(/*bytes_loaded=*/sizeof(T) * (1 + args.size()),
+                             /*bytes_stored=*/sizeof(T), cost_);
+    device.parallelFor(x.NumElements(), cost, std::move(compute_fn));
+  }
+
+ private:
+  struct Step {
+    // Position of the argument among the inputs of a binary op, or -1 for a
+    // unary op.
+    int arg_position = -1;
+    int arg_index = -1;
+    UnaryFn<T> unary_fn = nullptr;
+    BinaryFn<T> binary_fn = nullptr;
+  };
+
+  std::vector<Step> steps_;
+  int cost_ = 0;
+};
+
+#define REGISTER_CPU(T)                                                  \
+  REGISTER_KERNEL_BUILDER(                                               \
+      Name("_FusedElementwise").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedElementwiseOp<T>);
+
+REGISTER_CPU(float);
+REGISTER_CPU(double);
+
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
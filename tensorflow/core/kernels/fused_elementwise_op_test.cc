@@ -0,0 +1,102 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <cmath>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedElementwiseOpTest : public OpsTestBase {
+ protected:
+  template <typename T>
+  Status MakeFusedOp(const std::vector<string>& fused_ops,
+                     const std::vector<int32>& arg_positions, int num_args) {
+    TF_RETURN_IF_ERROR(
+        NodeDefBuilder("fused_elementwise", "_FusedElementwise")
+            .Input(FakeInput(DataTypeToEnum<T>::v()))
+            .Input(FakeInput(num_args, DataTypeToEnum<T>::v()))
+            .Attr("T", DataTypeToEnum<T>::v())
+            .Attr("num_args", num_args)
+            .Attr("fused_ops", fused_ops)
+            .Attr("arg_positions", arg_positions)
+            .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedElementwiseOpTest, UnaryChain) {
+  TF_ASSERT_OK(MakeFusedOp<float>({"Neg", "Relu", "Sqrt"}, {-1, -1, -1}, 0));
+  AddInputFromArray<float>(TensorShape({4}), {-4.0f, -9.0f, 1.0f, -16.0f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({4}));
+  test::FillValues<float>(&expected, {2.0f, 3.0f, 0.0f, 4.0f});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, BinaryChainWithScalarAndTensorArgs) {
+  // (x * 2) -> Relu -> (y - _)
+  TF_ASSERT_OK(MakeFusedOp<double>({"Mul", "Relu", "Sub"}, {1, -1, 0}, 2));
+  AddInputFromArray<double>(TensorShape({2, 2}), {1.0, -2.0, 3.0, 4.0});
+  AddInputFromArray<double>(TensorShape({}), {2.0});
+  AddInputFromArray<double>(TensorShape({2, 2}), {10.0, 10.0, 10.0, 10.0});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_DOUBLE, TensorShape({2, 2}));
+  test::FillValues<double>(&expected, {8.0, 10.0, 4.0, 2.0});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, MultipleBlocks) {
+  const int kSize = 5000;
+  TF_ASSERT_OK(MakeFusedOp<float>({"Square", "AddV2"}, {-1, 1}, 1));
+  std::vector<float> x(kSize);
+  std::vector<float> expected_values(kSize);
+  for (int i = 0; i < kSize; ++i) {
+    x[i] = static_cast<float>(i);
+    expected_values[i] = static_cast<float>(i) * i + 1.0f;
+  }
+  AddInputFromArray<float>(TensorShape({kSize}), x);
+  AddInputFromArray<float>(TensorShape({}), {1.0f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({kSize}));
+  test::FillValues<float>(&expected, expected_values);
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, ArgShapeMismatch) {
+  TF_ASSERT_OK(MakeFusedOp<float>({"Add", "Tanh"}, {1, -1}, 1));
+  AddInputFromArray<float>(TensorShape({4}), {1.0f, 2.0f, 3.0f, 4.0f});
+  AddInputFromArray<float>(TensorShape({2}), {1.0f, 2.0f});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+TEST_F(FusedElementwiseOpTest, UnsupportedOp) {
+  Status s = MakeFusedOp<float>({"Sin"}, {-1}, 0);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,115 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_KERNEL_BENCHMARK_SHAPES_H_
+#define TENSORFLOW_CORE_KERNELS_KERNEL_BENCHMARK_SHAPES_H_
+
+// A catalog of the operand shapes of common models, shared by the kernel
+// benchmarks so that their results are comparable across kernels, devices and
+// releases. A benchmark over a catalog takes the index of the shape as its
+// argument, and labels its results with the shape name.
+//
+// Adding shapes is fine, but changing or reordering existing ones breaks the
+// comparison with earlier results, so append new shapes at the end.
+
+#include <cstddef>
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace benchmark_shapes {
+
+// [m, k] x [k, n] matrix multiplications.
+struct MatMulShape {
+  const char* name;
+  int m;
+  int k;
+  int n;
+};
+
+constexpr MatMulShape kMatMulShapes[] = {
+    {"square_128", 128, 128, 128},
+    {"square_1024", 1024, 1024, 1024},
+    {"gemv_1024", 1, 1024, 1024},
+    {"resnet50_logits", 32, 2048, 1000},
+    {"bert_base_attention", 4096, 768, 768},
+    {"bert_base_ffn_in", 4096, 768, 3072},
+    {"bert_base_ffn_out", 4096, 3072, 768},
+    {"lstm_1024_gates", 64, 2048, 4096},
+};
+
+// NHWC convolutions with SAME padding and HWIO filters.
+struct Conv2DShape {
+  const char* name;
+  int batch;
+  int height;
+  int width;
+  int in_depth;
+  int filter_height;
+  int filter_width;
+  int out_depth;
+  int stride;
+};
+
+constexpr Conv2DShape kConv2DShapes[] = {
+    {"resnet50_conv1", 32, 224, 224, 3, 7, 7, 64, 2},
+    {"resnet50_conv2_3x3", 32, 56, 56, 64, 3, 3, 64, 1},
+    {"resnet50_conv3_1x1", 32, 28, 28, 512, 1, 1, 128, 1},
+    {"resnet50_conv4_3x3", 32, 14, 14, 256, 3, 3, 256, 1},
+    {"resnet50_conv5_3x3", 32, 7, 7, 512, 3, 3, 512, 1},
+    {"mobilenet_v1_pointwise", 32, 14, 14, 512, 1, 1, 512, 1},
+    {"inception_v3_5x5", 32, 35, 35, 48, 5, 5, 64, 1},
+};
+
+// NHWC activations, for element-wise and image kernels.
+struct ActivationShape {
+  const char* name;
+  int batch;
+  int height;
+  int width;
+  int depth;
+};
+
+constexpr ActivationShape kActivationShapes[] = {
+    {"imagenet_input", 32, 224, 224, 3},
+    {"resnet50_conv2", 32, 56, 56, 256},
+    {"resnet50_conv5", 32, 7, 7, 2048},
+    {"hd_frame", 1, 1080, 1920, 3},
+};
+
+// [rows, cols] matrices, for reductions along either dimension.
+struct ReductionShape {
+  const char* name;
+  int rows;
+  int cols;
+};
+
+constexpr ReductionShape kReductionShapes[] = {
+    {"resnet50_logits", 32, 1000},
+    {"bert_base_layer_norm", 4096, 768},
+    {"wide_rows", 64, 1 << 16},
+    {"tall_columns", 1 << 16, 64},
+};
+
+// Returns the number of shapes in 'catalog'.
+template <typename Shape, size_t N>
+constexpr int NumShapes(const Shape (&catalog)[N]) {
+  return N;
+}
+
+}  // namespace benchmark_shapes
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_KERNEL_BENCHMARK_SHAPES_H_
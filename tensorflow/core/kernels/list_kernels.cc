@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <cstring>
 #include <limits>
 
 #include "tensorflow/core/framework/allocator.h"
@@ -32,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/list_kernels.h"
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
@@ -42,6 +44,20 @@ TensorList::~TensorList() {
   if (tensors_) tensors_->Unref();
 }
 
+bool TensorList::GetContiguousRows(int64 start, int64 end,
+                                   Tensor* rows) const {
+  const TensorListRowBuffer* buffer = row_buffer();
+  if (buffer == nullptr || start < 0 || start >= end ||
+      end > static_cast<int64>(tensors().size()) || end > buffer->num_rows()) {
+    return false;
+  }
+  for (int64 i = start; i < end; ++i) {
+    if (!buffer->IsRow(tensors()[i], i)) return false;
+  }
+  *rows = buffer->Rows(start, end);
+  return true;
+}
+
 void TensorList::Encode(VariantTensorData* data) const {
   data->set_type_name(TypeName());
   std::vector<size_t> invalid_indices;
@@ -188,6 +204,59 @@ Status GetInputList(OpKernelContext* c, int index, const TensorList** list) {
   return Status::OK();
 }
 
+Tensor MaybeCopyToRowBuffer(const TensorList& list, int64 index,
+                            const Tensor& value) {
+  TensorListRowBuffer* buffer = list.row_buffer();
+  if (buffer == nullptr || index < 0 || index >= buffer->num_rows() ||
+      value.dtype() != buffer->dtype() ||
+      value.shape() != buffer->row_shape() || !buffer->ClaimRow(index)) {
+    return value;
+  }
+  Tensor row = buffer->Row(index);
+  std::memcpy(const_cast<char*>(row.tensor_data().data()),
+              value.tensor_data().data(), value.TotalBytes());
+  return row;
+}
+
+namespace {
+
+// Returns whether the CPU kernels creating lists of a known size should give
+// them a TensorListRowBuffer.
+Status ReadPreallocateTensorLists(OpKernelConstruction* c, bool* preallocate) {
+  *preallocate = false;
+  if (c->device_type() != DEVICE_CPU) return Status::OK();
+  return ReadBoolFromEnvVar("TF_PREALLOCATE_TENSOR_LISTS", false,
+                            preallocate);
+}
+
+// Gives `list` a TensorListRowBuffer with room for `num_rows` elements if its
+// element shape is fully defined and each row stays aligned. Lists that don't
+// qualify, or whose buffer can't be allocated, just go without one.
+void MaybeAllocateRowBuffer(OpKernelContext* c, int64 num_rows,
+                            TensorList* list) {
+  TensorShape element_shape;
+  if (num_rows <= 0 || !DataTypeCanUseMemcpy(list->element_dtype) ||
+      !list->element_shape.AsTensorShape(&element_shape)) {
+    return;
+  }
+  const int64 row_bytes =
+      element_shape.num_elements() * DataTypeSize(list->element_dtype);
+  if (row_bytes == 0 || row_bytes % EIGEN_MAX_ALIGN_BYTES != 0) return;
+  TensorShape rows_shape = element_shape;
+  rows_shape.InsertDim(0, num_rows);
+  Tensor rows;
+  AllocatorAttributes attr;
+  attr.set_on_host(true);
+  if (!c->allocate_temp(list->element_dtype, rows_shape, &rows, attr).ok()) {
+    return;
+  }
+  TensorListRowBuffer* buffer = new TensorListRowBuffer(rows);
+  list->set_row_buffer(buffer);
+  buffer->Unref();
+}
+
+}  // namespace
+
 Status ForwardInputOrCreateNewList(OpKernelContext* c, int32 input_index,
                                    int32 output_index,
                                    const TensorList& input_list,
@@ -230,6 +299,7 @@ class EmptyTensorList : public OpKernel {
  public:
   explicit EmptyTensorList(OpKernelConstruction* ctx) : OpKernel(ctx) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("element_dtype", &element_dtype_));
+    OP_REQUIRES_OK(ctx, ReadPreallocateTensorLists(ctx, &preallocate_));
   }
 
   void Compute(OpKernelContext* ctx) override {
@@ -249,11 +319,15 @@ class EmptyTensorList : public OpKernel {
     PartialTensorShape element_shape;
     OP_REQUIRES_OK(ctx, TensorShapeFromTensor(ctx->input(0), &element_shape));
     empty.element_shape = element_shape;
+    if (preallocate_) {
+      MaybeAllocateRowBuffer(ctx, empty.max_num_elements, &empty);
+    }
     result->scalar<Variant>()() = std::move(empty);
   }
 
  private:
   DataType element_dtype_;
+  bool preallocate_;
 };
 
 const char TensorList::kTypeName[] = "tensorflow::TensorList";
@@ -275,6 +349,7 @@ class TensorListPushBack : public OpKernel {
  public:
   explicit TensorListPushBack(OpKernelConstruction* c) : OpKernel(c) {
     OP_REQUIRES_OK(c, c->GetAttr("element_dtype", &element_dtype_));
+    on_cpu_ = c->device_type() == DEVICE_CPU;
   }
 
   ~TensorListPushBack() override {}
@@ -311,11 +386,17 @@ class TensorListPushBack : public OpKernel {
 
     TensorList* output_list = nullptr;
     OP_REQUIRES_OK(c, ForwardInputOrCreateNewList(c, 0, 0, *l, &output_list));
-    output_list->tensors().push_back(input);
+    if (on_cpu_) {
+      output_list->tensors().push_back(MaybeCopyToRowBuffer(
+          *output_list, output_list->tensors().size(), input));
+    } else {
+      output_list->tensors().push_back(input);
+    }
   }
 
  private:
   DataType element_dtype_;
+  bool on_cpu_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("TensorListPushBack").Device(DEVICE_CPU),
@@ -398,6 +479,7 @@ class TensorListReserve : public OpKernel {
  public:
   explicit TensorListReserve(OpKernelConstruction* c) : OpKernel(c) {
     OP_REQUIRES_OK(c, c->GetAttr("element_dtype", &element_dtype_));
+    OP_REQUIRES_OK(c, ReadPreallocateTensorLists(c, &preallocate_));
   }
 
   void Compute(OpKernelContext* c) override {
@@ -408,6 +490,9 @@ class TensorListReserve : public OpKernel {
     output.element_shape = element_shape;
     output.element_dtype = element_dtype_;
     output.tensors().resize(num_elements, Tensor(DT_INVALID));
+    if (preallocate_) {
+      MaybeAllocateRowBuffer(c, num_elements, &output);
+    }
     Tensor* result;
     AllocatorAttributes attr;
     attr.set_on_host(true);
@@ -417,6 +502,7 @@ class TensorListReserve : public OpKernel {
 
  private:
   DataType element_dtype_;
+  bool preallocate_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("TensorListReserve").Device(DEVICE_CPU),
@@ -497,6 +583,7 @@ class TensorListSetItem : public OpKernel {
  public:
   explicit TensorListSetItem(OpKernelConstruction* c) : OpKernel(c) {
     OP_REQUIRES_OK(c, c->GetAttr("element_dtype", &element_dtype_));
+    on_cpu_ = c->device_type() == DEVICE_CPU;
   }
 
   void Compute(OpKernelContext* c) override {
@@ -521,11 +608,17 @@ class TensorListSetItem : public OpKernel {
                     " list shape: ", l->element_shape.DebugString()));
     TensorList* output_list = nullptr;
     OP_REQUIRES_OK(c, ForwardInputOrCreateNewList(c, 0, 0, *l, &output_list));
-    output_list->tensors()[index] = value;
+    if (on_cpu_) {
+      output_list->tensors()[index] =
+          MaybeCopyToRowBuffer(*output_list, index, value);
+    } else {
+      output_list->tensors()[index] = value;
+    }
   }
 
  private:
   DataType element_dtype_;
+  bool on_cpu_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("TensorListSetItem").Device(DEVICE_CPU),
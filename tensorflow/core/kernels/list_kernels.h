@@ -20,6 +20,9 @@ limitations under the License.
 #define EIGEN_USE_GPU
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+#include <atomic>
+#include <memory>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -41,6 +44,56 @@ namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
+// Contiguous host storage for the elements of a TensorList with a known
+// maximum size and a fully defined element shape, shared by the list and all
+// lists copied from it. CPU kernels that add an element to such a list copy it
+// into its row and store a view of the row in the list, so that Stack and
+// Gather can return a slice of the buffer instead of concatenating elements.
+//
+// Each row is written at most once (see ClaimRow()), so a list element that is
+// a view of row `i` holds whatever was first written there, no matter which of
+// the lists sharing the buffer wrote it.
+class TensorListRowBuffer : public core::RefCounted {
+ public:
+  explicit TensorListRowBuffer(const Tensor& rows)
+      : rows_(rows),
+        row_shape_(rows.shape()),
+        row_bytes_(rows.TotalBytes() / rows.dim_size(0)),
+        claimed_(new std::atomic<bool>[rows.dim_size(0)]) {
+    row_shape_.RemoveDim(0);
+    for (int64 i = 0; i < num_rows(); ++i) {
+      claimed_[i] = false;
+    }
+  }
+
+  int64 num_rows() const { return rows_.dim_size(0); }
+  DataType dtype() const { return rows_.dtype(); }
+  const TensorShape& row_shape() const { return row_shape_; }
+
+  // Returns true if row `index` was not claimed before. The caller must then
+  // write the row before publishing Row(index).
+  bool ClaimRow(int64 index) { return !claimed_[index].exchange(true); }
+
+  // Returns a view of row `index`, shaped like a list element.
+  Tensor Row(int64 index) const { return rows_.SubSlice(index); }
+
+  // Returns a view of rows [start, end).
+  Tensor Rows(int64 start, int64 end) const { return rows_.Slice(start, end); }
+
+  // Returns true if `t` is a view of row `index`.
+  bool IsRow(const Tensor& t, int64 index) const {
+    return t.dtype() == rows_.dtype() && t.shape() == row_shape_ &&
+           t.tensor_data().data() ==
+               rows_.tensor_data().data() + index * row_bytes_;
+  }
+
+ private:
+  const Tensor rows_;
+  TensorShape row_shape_;
+  const int64 row_bytes_;
+  std::unique_ptr<std::atomic<bool>[]> claimed_;
+};
+
 // Variant compatible type for a list of tensors. This is mutable but instances
 // should never be mutated after stored in a variant tensor.
 //
@@ -151,6 +204,7 @@ class TensorList {
     out.max_num_elements = max_num_elements;
     // This performs a copy of the std::vector.
     out.tensors_->values_ = tensors_->values_;
+    out.set_row_buffer(row_buffer());
     return out;
   }
 
@@ -158,10 +212,28 @@ class TensorList {
   // container?
   bool RefCountIsOne() const { return tensors_->RefCountIsOne(); }
 
+  // The preallocated storage for the elements, or nullptr if there is none.
+  // Shared with the lists returned by Copy().
+  TensorListRowBuffer* row_buffer() const { return tensors_->row_buffer_; }
+  void set_row_buffer(TensorListRowBuffer* row_buffer) {
+    if (row_buffer != nullptr) row_buffer->Ref();
+    if (tensors_->row_buffer_ != nullptr) tensors_->row_buffer_->Unref();
+    tensors_->row_buffer_ = row_buffer;
+  }
+
+  // If elements [start, end) are views of rows [start, end) of row_buffer(),
+  // returns true and sets `*rows` to those rows.
+  bool GetContiguousRows(int64 start, int64 end, Tensor* rows) const;
+
  private:
   class Tensors : public core::RefCounted {
    public:
+    ~Tensors() override {
+      if (row_buffer_ != nullptr) row_buffer_->Unref();
+    }
+
     std::vector<Tensor> values_;
+    TensorListRowBuffer* row_buffer_ = nullptr;
   };
   Tensors* tensors_;
 };
@@ -185,6 +257,12 @@ Status ForwardInputOrCreateNewList(OpKernelContext* c, int32 input_index,
                                    const TensorList& input_list,
                                    TensorList** output_list);
 
+// Returns the tensor a CPU kernel should store as element `index` of `list`
+// for `value`: a view of row `index` of `list.row_buffer()` holding a copy of
+// `value` if that row is still free, and `value` itself otherwise.
+Tensor MaybeCopyToRowBuffer(const TensorList& list, int64 index,
+                            const Tensor& value);
+
 template <typename Device, typename T>
 class TensorListStack : public OpKernel {
  public:
@@ -243,6 +321,15 @@ class TensorListStack : public OpKernel {
                     partial_element_shape.DebugString()));
     TensorShape output_shape = element_shape;
     output_shape.InsertDim(0, tensor_list->tensors().size());
+    if (std::is_same<Device, CPUDevice>::value) {
+      Tensor rows;
+      if (tensor_list->GetContiguousRows(0, tensor_list->tensors().size(),
+                                         &rows) &&
+          rows.shape() == output_shape) {
+        c->set_output(0, rows);
+        return;
+      }
+    }
     Tensor* output;
     OP_REQUIRES_OK(c, c->allocate_output(0, output_shape, &output));
     if (output->NumElements() == 0) {
@@ -726,6 +813,26 @@ class TensorListGather : public OpKernel {
                                 partial_element_shape.DebugString()));
     TensorShape output_shape = element_shape;
     output_shape.InsertDim(0, indices.NumElements());
+    if (std::is_same<Device, CPUDevice>::value && indices.NumElements() > 0) {
+      // Gathering a run of consecutive rows can return a slice of them.
+      const auto indices_flat = indices.flat<int32>();
+      bool consecutive = true;
+      for (int index = 1; index < indices.NumElements(); ++index) {
+        if (indices_flat(index) != indices_flat(0) + index) {
+          consecutive = false;
+          break;
+        }
+      }
+      Tensor rows;
+      if (consecutive &&
+          tensor_list->GetContiguousRows(
+              indices_flat(0), indices_flat(0) + indices.NumElements(),
+              &rows) &&
+          rows.shape() == output_shape) {
+        c->set_output(0, rows);
+        return;
+      }
+    }
     Tensor* output;
     OP_REQUIRES_OK(c, c->allocate_output(0, output_shape, &output));
     if (output->NumElements() == 0) {
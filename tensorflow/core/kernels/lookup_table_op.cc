@@ -16,14 +16,18 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <memory>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
+#include "tensorflow/core/kernels/memory_mapped_table_file.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
 
@@ -312,6 +316,11 @@ TensorShape MaybeVectorizeShape(const TensorShape& shape) {
 }  // namespace
 
 // Modeled after densehashtable in https://github.com/sparsehash/sparsehash
+//
+// The buckets are split into a power of 2 number of shards, selected by the
+// key hash, each with its own lock. Lookups only take shared locks, and each
+// shard grows on its own, so growing the table only blocks the operations on
+// the keys of one shard, for a fraction of the time a full rehash would take.
 template <class K, class V>
 class MutableDenseHashTable final : public LookupInterface {
  public:
@@ -369,19 +378,43 @@ class MutableDenseHashTable final : public LookupInterface {
           errors::InvalidArgument("Empty and deleted keys cannot be equal"));
     }
 
+    // The MutableDenseHashTable op (V1) has no num_shards attr.
+    int64 num_shards = 1;
+    TryGetNodeAttr(kernel->def(), "num_shards", &num_shards);
+    OP_REQUIRES(ctx, num_shards >= 1 && (num_shards & (num_shards - 1)) == 0,
+                errors::InvalidArgument(
+                    "num_shards must be a positive power of 2, got: ",
+                    num_shards));
+    while ((int64{1} << num_shard_bits_) < num_shards) {
+      ++num_shard_bits_;
+    }
+
     int64 initial_num_buckets;
     OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "initial_num_buckets",
                                     &initial_num_buckets));
-    OP_REQUIRES_OK(ctx, AllocateBuckets(ctx, initial_num_buckets));
+    OP_REQUIRES(ctx, initial_num_buckets >= 4 * num_shards,
+                errors::InvalidArgument(
+                    "Number of buckets must be at least 4 per shard, got: ",
+                    initial_num_buckets, " for ", num_shards, " shards"));
+    for (int64 i = 0; i < num_shards; ++i) {
+      shards_.emplace_back(new Shard);
+      mutex_lock l(shards_[i]->mu);
+      OP_REQUIRES_OK(ctx, AllocateBuckets(ctx, shards_[i].get(),
+                                          initial_num_buckets / num_shards));
+    }
   }
 
-  size_t size() const override LOCKS_EXCLUDED(mu_) {
-    tf_shared_lock l(mu_);
-    return num_entries_;
+  size_t size() const override {
+    size_t num_entries = 0;
+    for (const auto& shard : shards_) {
+      tf_shared_lock l(shard->mu);
+      num_entries += shard->num_entries;
+    }
+    return num_entries;
   }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
-              const Tensor& default_value) override LOCKS_EXCLUDED(mu_) {
+              const Tensor& default_value) override {
     const int64 num_elements = (key.dims() == 0) ? 1 : key.dim_size(0);
     const int64 key_size = key_shape_.num_elements();
     const int64 value_size = value_shape_.num_elements();
@@ -396,53 +429,52 @@ class MutableDenseHashTable final : public LookupInterface {
     auto value_matrix = value->shaped<V, 2>({num_elements, value_size});
     const auto default_flat = default_value.flat<V>();
 
-    tf_shared_lock l(mu_);
-    const auto key_buckets_matrix =
-        key_buckets_.AccessTensor(ctx)->template matrix<K>();
-    const auto value_buckets_matrix =
-        value_buckets_.AccessTensor(ctx)->template matrix<V>();
+    std::vector<uint64> key_hashes;
+    std::vector<std::vector<int64>> keys_by_shard;
+    TF_RETURN_IF_ERROR(HashAndShardKeys(ctx, key_matrix,
+                                        /*ignore_empty_and_deleted_key=*/false,
+                                        &key_hashes, &keys_by_shard));
     const auto empty_key_matrix =
         empty_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
-    const auto deleted_key_matrix =
-        deleted_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
-    const int64 bit_mask = num_buckets_ - 1;
     // TODO(andreasst): parallelize using work_sharder
-    for (int64 i = 0; i < num_elements; ++i) {
-      const uint64 key_hash = HashKey(key_matrix, i);
-      if (empty_key_hash_ == key_hash &&
-          IsEqualKey(empty_key_matrix, 0, key_matrix, i)) {
-        return errors::InvalidArgument(
-            "Using the empty_key as a table key is not allowed");
+    for (int64 s = 0; s < shards_.size(); ++s) {
+      if (keys_by_shard[s].empty()) {
+        continue;
       }
-      if (deleted_key_hash_ == key_hash &&
-          IsEqualKey(deleted_key_matrix, 0, key_matrix, i)) {
-        return errors::InvalidArgument(
-            "Using the deleted_key as a table key is not allowed");
-      }
-      int64 bucket_index = key_hash & bit_mask;
-      int64 num_probes = 0;
-      while (true) {
-        if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
-          for (int64 j = 0; j < value_size; ++j) {
-            // TODO(andreasst): check if we can get rid of SubtleMustCopy
-            // here and elsewhere in this file.
-            value_matrix(i, j) =
-                SubtleMustCopyIfIntegral(value_buckets_matrix(bucket_index, j));
+      Shard* shard = shards_[s].get();
+      tf_shared_lock l(shard->mu);
+      const auto key_buckets_matrix =
+          shard->key_buckets.AccessTensor(ctx)->template matrix<K>();
+      const auto value_buckets_matrix =
+          shard->value_buckets.AccessTensor(ctx)->template matrix<V>();
+      const int64 bit_mask = shard->num_buckets - 1;
+      for (const int64 i : keys_by_shard[s]) {
+        int64 bucket_index = key_hashes[i] & bit_mask;
+        int64 num_probes = 0;
+        while (true) {
+          if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
+            for (int64 j = 0; j < value_size; ++j) {
+              // TODO(andreasst): check if we can get rid of SubtleMustCopy
+              // here and elsewhere in this file.
+              value_matrix(i, j) = SubtleMustCopyIfIntegral(
+                  value_buckets_matrix(bucket_index, j));
+            }
+            break;
           }
-          break;
-        }
-        if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_matrix, 0)) {
-          for (int64 j = 0; j < value_size; ++j) {
-            value_matrix(i, j) = SubtleMustCopyIfIntegral(default_flat(j));
+          if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_matrix,
+                         0)) {
+            for (int64 j = 0; j < value_size; ++j) {
+              value_matrix(i, j) = SubtleMustCopyIfIntegral(default_flat(j));
+            }
+            break;
+          }
+          ++num_probes;
+          bucket_index =
+              (bucket_index + num_probes) & bit_mask;  // quadratic probing
+          if (num_probes >= shard->num_buckets) {
+            return errors::Internal(
+                "Internal error in MutableDenseHashTable lookup");
           }
-          break;
-        }
-        ++num_probes;
-        bucket_index =
-            (bucket_index + num_probes) & bit_mask;  // quadratic probing
-        if (num_probes >= num_buckets_) {
-          return errors::Internal(
-              "Internal error in MutableDenseHashTable lookup");
         }
       }
     }
@@ -450,7 +482,7 @@ class MutableDenseHashTable final : public LookupInterface {
   }
 
   Status Insert(OpKernelContext* ctx, const Tensor& key,
-                const Tensor& value) override LOCKS_EXCLUDED(mu_) {
+                const Tensor& value) override {
     const int64 batch_size = (key.dims() == 0) ? 1 : key.dim_size(0);
     if (key.NumElements() != batch_size * key_shape_.num_elements()) {
       TensorShape expected_shape({batch_size});
@@ -459,24 +491,42 @@ class MutableDenseHashTable final : public LookupInterface {
                                      expected_shape.DebugString(), " got ",
                                      key.shape().DebugString());
     }
-    mutex_lock l(mu_);
-    // For simplicity we assume that all keys in the input result in inserts
-    // rather than updates. That means we may grow the table even though we
-    // don't need to. As long as the number of keys inserted in one call is
-    // small compared to the size of the map, the impact of this is minimal.
-    const int64 pending_num_entries = num_entries_ + batch_size;
-    if (pending_num_entries > num_buckets_ * max_load_factor_) {
-      int64 new_num_buckets = num_buckets_;
-      do {
-        new_num_buckets <<= 1;
-      } while (pending_num_entries > new_num_buckets * max_load_factor_);
-      TF_RETURN_IF_ERROR(Rebucket(ctx, new_num_buckets));
+    const auto key_matrix =
+        key.shaped<K, 2>({batch_size, key_shape_.num_elements()});
+    const auto value_matrix =
+        value.shaped<V, 2>({batch_size, value_shape_.num_elements()});
+    std::vector<uint64> key_hashes;
+    std::vector<std::vector<int64>> keys_by_shard;
+    TF_RETURN_IF_ERROR(HashAndShardKeys(ctx, key_matrix,
+                                        /*ignore_empty_and_deleted_key=*/false,
+                                        &key_hashes, &keys_by_shard));
+    for (int64 s = 0; s < shards_.size(); ++s) {
+      if (keys_by_shard[s].empty()) {
+        continue;
+      }
+      Shard* shard = shards_[s].get();
+      mutex_lock l(shard->mu);
+      // For simplicity we assume that all keys in the input result in inserts
+      // rather than updates. That means we may grow the shard even though we
+      // don't need to. As long as the number of keys inserted in one call is
+      // small compared to the size of the shard, the impact of this is
+      // minimal.
+      const int64 pending_num_entries =
+          shard->num_entries + keys_by_shard[s].size();
+      if (pending_num_entries > shard->num_buckets * max_load_factor_) {
+        int64 new_num_buckets = shard->num_buckets;
+        do {
+          new_num_buckets <<= 1;
+        } while (pending_num_entries > new_num_buckets * max_load_factor_);
+        TF_RETURN_IF_ERROR(Rebucket(ctx, shard, new_num_buckets));
+      }
+      TF_RETURN_IF_ERROR(DoInsert(ctx, shard, key_matrix, value_matrix,
+                                  key_hashes, keys_by_shard[s]));
     }
-    return DoInsert(ctx, key, value, false);
+    return Status::OK();
   }
 
-  Status Remove(OpKernelContext* ctx, const Tensor& key) override
-      LOCKS_EXCLUDED(mu_) {
+  Status Remove(OpKernelContext* ctx, const Tensor& key) override {
     if (key.NumElements() != key.dim_size(0) * key_shape_.num_elements()) {
       TensorShape expected_shape({key.dim_size(0)});
       expected_shape.AppendShape(key_shape_);
@@ -484,41 +534,99 @@ class MutableDenseHashTable final : public LookupInterface {
                                      expected_shape.DebugString(), " got ",
                                      key.shape().DebugString());
     }
-    mutex_lock l(mu_);
-    return DoRemove(ctx, key);
+    const auto key_matrix =
+        key.shaped<K, 2>({key.dim_size(0), key_shape_.num_elements()});
+    std::vector<uint64> key_hashes;
+    std::vector<std::vector<int64>> keys_by_shard;
+    TF_RETURN_IF_ERROR(HashAndShardKeys(ctx, key_matrix,
+                                        /*ignore_empty_and_deleted_key=*/false,
+                                        &key_hashes, &keys_by_shard));
+    for (int64 s = 0; s < shards_.size(); ++s) {
+      if (keys_by_shard[s].empty()) {
+        continue;
+      }
+      Shard* shard = shards_[s].get();
+      mutex_lock l(shard->mu);
+      TF_RETURN_IF_ERROR(
+          DoRemove(ctx, shard, key_matrix, key_hashes, keys_by_shard[s]));
+    }
+    return Status::OK();
   }
 
   Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
-                      const Tensor& values) override LOCKS_EXCLUDED(mu_) {
-    mutex_lock l(mu_);
-    num_buckets_ = keys.dim_size(0);
-    key_buckets_ = PersistentTensor(keys);
-    value_buckets_ = PersistentTensor(values);
-    // Count the number of keys that are not the empty_key or deleted_key.
-    // This requires iterating through the whole table but that is OK as we
-    // only execute it during checkpoint restore.
-    num_entries_ = 0;
-    const auto empty_key_tensor =
-        empty_key_.AccessTensor(ctx)->template shaped<K, 2>(
-            {1, key_shape_.num_elements()});
-    const auto deleted_key_tensor =
-        deleted_key_.AccessTensor(ctx)->template shaped<K, 2>(
-            {1, key_shape_.num_elements()});
-    const auto key_buckets_tensor =
-        key_buckets_.AccessTensor(ctx)->template matrix<K>();
-    for (int64 i = 0; i < num_buckets_; ++i) {
-      if (!IsEqualKey(key_buckets_tensor, i, empty_key_tensor, 0) &&
-          !IsEqualKey(key_buckets_tensor, i, deleted_key_tensor, 0)) {
-        ++num_entries_;
+                      const Tensor& values) override {
+    if (shards_.size() == 1) {
+      // The exported buckets are used as is.
+      Shard* shard = shards_[0].get();
+      mutex_lock l(shard->mu);
+      shard->num_buckets = keys.dim_size(0);
+      shard->key_buckets = PersistentTensor(keys);
+      shard->value_buckets = PersistentTensor(values);
+      // Count the number of keys that are not the empty_key or deleted_key.
+      // This requires iterating through the whole table but that is OK as we
+      // only execute it during checkpoint restore.
+      shard->num_entries = 0;
+      const auto empty_key_tensor =
+          empty_key_.AccessTensor(ctx)->template shaped<K, 2>(
+              {1, key_shape_.num_elements()});
+      const auto deleted_key_tensor =
+          deleted_key_.AccessTensor(ctx)->template shaped<K, 2>(
+              {1, key_shape_.num_elements()});
+      const auto key_buckets_tensor =
+          shard->key_buckets.AccessTensor(ctx)->template matrix<K>();
+      for (int64 i = 0; i < shard->num_buckets; ++i) {
+        if (!IsEqualKey(key_buckets_tensor, i, empty_key_tensor, 0) &&
+            !IsEqualKey(key_buckets_tensor, i, deleted_key_tensor, 0)) {
+          ++shard->num_entries;
+        }
+      }
+      return Status::OK();
+    }
+
+    // The keys may have been exported with a different number of shards, so
+    // they are rehashed. Each shard gets an equal part of the buckets, unless
+    // it needs more for its keys.
+    const auto key_matrix = keys.matrix<K>();
+    const auto value_matrix = values.matrix<V>();
+    std::vector<uint64> key_hashes;
+    std::vector<std::vector<int64>> keys_by_shard;
+    TF_RETURN_IF_ERROR(HashAndShardKeys(ctx, key_matrix,
+                                        /*ignore_empty_and_deleted_key=*/true,
+                                        &key_hashes, &keys_by_shard));
+    const int64 num_exported_buckets = keys.dim_size(0);
+    for (int64 s = 0; s < shards_.size(); ++s) {
+      int64 num_buckets = 4;
+      while (num_buckets * shards_.size() < num_exported_buckets ||
+             keys_by_shard[s].size() > num_buckets * max_load_factor_) {
+        num_buckets <<= 1;
       }
+      Shard* shard = shards_[s].get();
+      mutex_lock l(shard->mu);
+      TF_RETURN_IF_ERROR(AllocateBuckets(ctx, shard, num_buckets));
+      TF_RETURN_IF_ERROR(DoInsert(ctx, shard, key_matrix, value_matrix,
+                                  key_hashes, keys_by_shard[s]));
     }
     return Status::OK();
   }
 
-  Status ExportValues(OpKernelContext* ctx) override LOCKS_EXCLUDED(mu_) {
-    tf_shared_lock l(mu_);
-    Tensor key_buckets_tensor = *key_buckets_.AccessTensor(ctx);
-    Tensor value_buckets_tensor = *value_buckets_.AccessTensor(ctx);
+  Status ExportValues(OpKernelContext* ctx) override {
+    std::vector<Tensor> key_buckets;
+    std::vector<Tensor> value_buckets;
+    for (const auto& shard : shards_) {
+      tf_shared_lock l(shard->mu);
+      key_buckets.push_back(*shard->key_buckets.AccessTensor(ctx));
+      value_buckets.push_back(*shard->value_buckets.AccessTensor(ctx));
+    }
+    if (shards_.size() == 1) {
+      TF_RETURN_IF_ERROR(ctx->set_output("keys", key_buckets[0]));
+      TF_RETURN_IF_ERROR(ctx->set_output("values", value_buckets[0]));
+      return Status::OK();
+    }
+    // The shards are exported one after the other.
+    Tensor key_buckets_tensor;
+    Tensor value_buckets_tensor;
+    TF_RETURN_IF_ERROR(tensor::Concat(key_buckets, &key_buckets_tensor));
+    TF_RETURN_IF_ERROR(tensor::Concat(value_buckets, &value_buckets_tensor));
     TF_RETURN_IF_ERROR(ctx->set_output("keys", key_buckets_tensor));
     TF_RETURN_IF_ERROR(ctx->set_output("values", value_buckets_tensor));
     return Status::OK();
@@ -529,7 +637,7 @@ class MutableDenseHashTable final : public LookupInterface {
     TF_RETURN_IF_ERROR(CheckKeyAndValueTypes(keys, values));
     TF_RETURN_IF_ERROR(CheckKeyShape(keys.shape()));
 
-    // The storage format in key_buckets_ and value_buckets_ is always vectors,
+    // The storage format in key_buckets and value_buckets is always vectors,
     // even if the inputs are scalars. This is what eventually gets exported
     // and is expected by the import method as well.
     TensorShape key_shape = MaybeVectorizeShape(key_shape_);
@@ -558,30 +666,51 @@ class MutableDenseHashTable final : public LookupInterface {
   TensorShape value_shape() const override { return value_shape_; }
 
   int64 MemoryUsed() const override {
-    tf_shared_lock l(mu_);
-    return sizeof(MutableDenseHashTable) + key_buckets_.AllocatedBytes() +
-           value_buckets_.AllocatedBytes() + empty_key_.AllocatedBytes();
+    int64 memory_used = sizeof(MutableDenseHashTable) + empty_key_.AllocatedBytes();
+    for (const auto& shard : shards_) {
+      tf_shared_lock l(shard->mu);
+      memory_used += sizeof(Shard) + shard->key_buckets.AllocatedBytes() +
+                     shard->value_buckets.AllocatedBytes();
+    }
+    return memory_used;
   }
 
  private:
-  Status DoInsert(OpKernelContext* ctx, const Tensor& key, const Tensor& value,
-                  bool ignore_empty_and_deleted_key)
-      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    const int64 num_elements = (key.dims() == 0) ? 1 : key.dim_size(0);
-    const int64 value_size = value_shape_.num_elements();
-    const int64 key_size = key_shape_.num_elements();
-    const auto key_matrix = key.shaped<K, 2>({num_elements, key_size});
-    auto value_matrix = value.shaped<V, 2>({num_elements, value_size});
+  // A part of the buckets, holding the keys whose hash selects it.
+  struct Shard {
+    mutable mutex mu;
+    int64 num_entries GUARDED_BY(mu);
+    int64 num_buckets GUARDED_BY(mu);
+    PersistentTensor key_buckets GUARDED_BY(mu);
+    PersistentTensor value_buckets GUARDED_BY(mu);
+  };
+
+  // Returns the index of the shard holding the key with the given hash. The
+  // hash is mixed first, since it is the identity for integer keys, and the
+  // low bits are used for the bucket index within the shard.
+  int64 ShardIndex(uint64 key_hash) const {
+    if (num_shard_bits_ == 0) {
+      return 0;
+    }
+    return (key_hash * 0x9E3779B97F4A7C15ULL) >> (64 - num_shard_bits_);
+  }
 
-    auto key_buckets_matrix =
-        key_buckets_.AccessTensor(ctx)->template matrix<K>();
-    auto value_buckets_matrix =
-        value_buckets_.AccessTensor(ctx)->template matrix<V>();
+  // Computes the hash of each key in 'key_matrix' and groups the key indices
+  // by shard. Fails on the empty or deleted key, unless
+  // 'ignore_empty_and_deleted_key' is set, in which case they are skipped.
+  Status HashAndShardKeys(OpKernelContext* ctx,
+                          typename TTypes<K>::ConstMatrix key_matrix,
+                          bool ignore_empty_and_deleted_key,
+                          std::vector<uint64>* key_hashes,
+                          std::vector<std::vector<int64>>* keys_by_shard) {
+    const int64 num_elements = key_matrix.dimension(0);
+    const int64 key_size = key_shape_.num_elements();
     const auto empty_key_tensor =
         empty_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
     const auto deleted_key_tensor =
         deleted_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
-    const int64 bit_mask = num_buckets_ - 1;
+    key_hashes->resize(num_elements);
+    keys_by_shard->assign(shards_.size(), {});
     for (int64 i = 0; i < num_elements; ++i) {
       const uint64 key_hash = HashKey(key_matrix, i);
       if (empty_key_hash_ == key_hash &&
@@ -600,7 +729,34 @@ class MutableDenseHashTable final : public LookupInterface {
         return errors::InvalidArgument(
             "Using the deleted_key as a table key is not allowed");
       }
-      int64 bucket_index = key_hash & bit_mask;
+      (*key_hashes)[i] = key_hash;
+      (*keys_by_shard)[ShardIndex(key_hash)].push_back(i);
+    }
+    return Status::OK();
+  }
+
+  // Inserts or updates the keys of 'key_matrix' at 'indices', all of which
+  // belong to 'shard'.
+  Status DoInsert(OpKernelContext* ctx, Shard* shard,
+                  typename TTypes<K>::ConstMatrix key_matrix,
+                  typename TTypes<V>::ConstMatrix value_matrix,
+                  const std::vector<uint64>& key_hashes,
+                  const std::vector<int64>& indices)
+      EXCLUSIVE_LOCKS_REQUIRED(shard->mu) {
+    const int64 value_size = value_shape_.num_elements();
+    const int64 key_size = key_shape_.num_elements();
+
+    auto key_buckets_matrix =
+        shard->key_buckets.AccessTensor(ctx)->template matrix<K>();
+    auto value_buckets_matrix =
+        shard->value_buckets.AccessTensor(ctx)->template matrix<V>();
+    const auto empty_key_tensor =
+        empty_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
+    const auto deleted_key_tensor =
+        deleted_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
+    const int64 bit_mask = shard->num_buckets - 1;
+    for (const int64 i : indices) {
+      int64 bucket_index = key_hashes[i] & bit_mask;
       int64 num_probes = 0;
       while (true) {
         if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
@@ -613,7 +769,7 @@ class MutableDenseHashTable final : public LookupInterface {
         if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_tensor, 0) ||
             IsEqualKey(key_buckets_matrix, bucket_index, deleted_key_tensor,
                        0)) {
-          ++num_entries_;
+          ++shard->num_entries;
           for (int64 j = 0; j < key_size; ++j) {
             key_buckets_matrix(bucket_index, j) =
                 SubtleMustCopyIfIntegral(key_matrix(i, j));
@@ -627,7 +783,7 @@ class MutableDenseHashTable final : public LookupInterface {
         ++num_probes;
         bucket_index =
             (bucket_index + num_probes) & bit_mask;  // quadratic probing
-        if (num_probes >= num_buckets_) {
+        if (num_probes >= shard->num_buckets) {
           return errors::Internal(
               "Internal error in MutableDenseHashTable insert");
         }
@@ -636,38 +792,28 @@ class MutableDenseHashTable final : public LookupInterface {
     return Status::OK();
   }
 
-  Status DoRemove(OpKernelContext* ctx, const Tensor& key)
-      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    const int64 num_elements = key.dim_size(0);
+  // Removes the keys of 'key_matrix' at 'indices', all of which belong to
+  // 'shard'.
+  Status DoRemove(OpKernelContext* ctx, Shard* shard,
+                  typename TTypes<K>::ConstMatrix key_matrix,
+                  const std::vector<uint64>& key_hashes,
+                  const std::vector<int64>& indices)
+      EXCLUSIVE_LOCKS_REQUIRED(shard->mu) {
     const int64 key_size = key_shape_.num_elements();
-    const auto key_matrix = key.shaped<K, 2>({num_elements, key_size});
 
     auto key_buckets_matrix =
-        key_buckets_.AccessTensor(ctx)->template matrix<K>();
+        shard->key_buckets.AccessTensor(ctx)->template matrix<K>();
     const auto empty_key_tensor =
         empty_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
-    const auto deleted_key_tensor =
-        deleted_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
     const auto deleted_key_flat =
         deleted_key_.AccessTensor(ctx)->template flat<K>();
-    const int64 bit_mask = num_buckets_ - 1;
-    for (int64 i = 0; i < num_elements; ++i) {
-      const uint64 key_hash = HashKey(key_matrix, i);
-      if (empty_key_hash_ == key_hash &&
-          IsEqualKey(empty_key_tensor, 0, key_matrix, i)) {
-        return errors::InvalidArgument(
-            "Using the empty_key as a table key is not allowed");
-      }
-      if (deleted_key_hash_ == key_hash &&
-          IsEqualKey(deleted_key_tensor, 0, key_matrix, i)) {
-        return errors::InvalidArgument(
-            "Using the deleted_key as a table key is not allowed");
-      }
-      int64 bucket_index = key_hash & bit_mask;
+    const int64 bit_mask = shard->num_buckets - 1;
+    for (const int64 i : indices) {
+      int64 bucket_index = key_hashes[i] & bit_mask;
       int64 num_probes = 0;
       while (true) {
         if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
-          --num_entries_;
+          --shard->num_entries;
           for (int64 j = 0; j < key_size; ++j) {
             key_buckets_matrix(bucket_index, j) =
                 SubtleMustCopyIfIntegral(deleted_key_flat(j));
@@ -680,7 +826,7 @@ class MutableDenseHashTable final : public LookupInterface {
         ++num_probes;
         bucket_index =
             (bucket_index + num_probes) & bit_mask;  // quadratic probing
-        if (num_probes >= num_buckets_) {
+        if (num_probes >= shard->num_buckets) {
           return errors::Internal(
               "Internal error in MutableDenseHashTable remove");
         }
@@ -689,26 +835,27 @@ class MutableDenseHashTable final : public LookupInterface {
     return Status::OK();
   }
 
-  Status AllocateBuckets(OpKernelContext* ctx, int64 new_num_buckets)
-      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  Status AllocateBuckets(OpKernelContext* ctx, Shard* shard,
+                         int64 new_num_buckets)
+      EXCLUSIVE_LOCKS_REQUIRED(shard->mu) {
     if (new_num_buckets < 4 ||
         ((new_num_buckets & (new_num_buckets - 1)) != 0)) {
       return errors::InvalidArgument(
           "Number of buckets must be at least 4 and a power of 2, got: ",
           new_num_buckets);
     }
-    num_buckets_ = new_num_buckets;
-    num_entries_ = 0;
+    shard->num_buckets = new_num_buckets;
+    shard->num_entries = 0;
 
     const int64 key_size = key_shape_.num_elements();
     Tensor* key_buckets_tensor;
     TF_RETURN_IF_ERROR(ctx->allocate_persistent(
-        key_dtype(), TensorShape({num_buckets_, key_size}), &key_buckets_,
-        &key_buckets_tensor));
+        key_dtype(), TensorShape({new_num_buckets, key_size}),
+        &shard->key_buckets, &key_buckets_tensor));
     auto key_buckets_matrix = key_buckets_tensor->matrix<K>();
     const auto empty_key_flat =
         empty_key_.AccessTensor(ctx)->template flat<K>();
-    for (int64 i = 0; i < num_buckets_; ++i) {
+    for (int64 i = 0; i < new_num_buckets; ++i) {
       for (int64 j = 0; j < key_size; ++j) {
         key_buckets_matrix(i, j) = empty_key_flat(j);
       }
@@ -717,10 +864,10 @@ class MutableDenseHashTable final : public LookupInterface {
     const int64 value_size = value_shape_.num_elements();
     Tensor* value_buckets_tensor;
     TF_RETURN_IF_ERROR(ctx->allocate_persistent(
-        value_dtype(), TensorShape({num_buckets_, value_size}), &value_buckets_,
-        &value_buckets_tensor));
+        value_dtype(), TensorShape({new_num_buckets, value_size}),
+        &shard->value_buckets, &value_buckets_tensor));
     auto value_buckets_matrix = value_buckets_tensor->matrix<V>();
-    for (int64 i = 0; i < num_buckets_; ++i) {
+    for (int64 i = 0; i < new_num_buckets; ++i) {
       for (int64 j = 0; j < value_size; ++j) {
         // Initialize values to the default value for the type to avoid
         // exposing uninitialized memory in ExportValues().
@@ -730,12 +877,25 @@ class MutableDenseHashTable final : public LookupInterface {
     return Status::OK();
   }
 
-  Status Rebucket(OpKernelContext* ctx, int64 num_new_buckets)
-      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    Tensor old_key_buckets = *key_buckets_.AccessTensor(ctx);
-    Tensor old_value_buckets = *value_buckets_.AccessTensor(ctx);
-    TF_RETURN_IF_ERROR(AllocateBuckets(ctx, num_new_buckets));
-    return DoInsert(ctx, old_key_buckets, old_value_buckets, true);
+  Status Rebucket(OpKernelContext* ctx, Shard* shard, int64 num_new_buckets)
+      EXCLUSIVE_LOCKS_REQUIRED(shard->mu) {
+    const Tensor old_key_buckets = *shard->key_buckets.AccessTensor(ctx);
+    const Tensor old_value_buckets = *shard->value_buckets.AccessTensor(ctx);
+    TF_RETURN_IF_ERROR(AllocateBuckets(ctx, shard, num_new_buckets));
+    std::vector<uint64> key_hashes;
+    std::vector<std::vector<int64>> keys_by_shard;
+    TF_RETURN_IF_ERROR(HashAndShardKeys(ctx, old_key_buckets.matrix<K>(),
+                                        /*ignore_empty_and_deleted_key=*/true,
+                                        &key_hashes, &keys_by_shard));
+    // All the keys belong to this shard.
+    for (const auto& indices : keys_by_shard) {
+      if (!indices.empty()) {
+        TF_RETURN_IF_ERROR(DoInsert(ctx, shard, old_key_buckets.matrix<K>(),
+                                    old_value_buckets.matrix<V>(), key_hashes,
+                                    indices));
+      }
+    }
+    return Status::OK();
   }
 
   uint64 HashKey(typename TTypes<K>::ConstMatrix key, int64 index) const {
@@ -765,17 +925,105 @@ class MutableDenseHashTable final : public LookupInterface {
   TensorShape key_shape_;
   TensorShape value_shape_;
   float max_load_factor_;
-  mutable mutex mu_;
-  int64 num_entries_ GUARDED_BY(mu_);
-  int64 num_buckets_ GUARDED_BY(mu_);
-  PersistentTensor key_buckets_ GUARDED_BY(mu_);
-  PersistentTensor value_buckets_ GUARDED_BY(mu_);
+  int num_shard_bits_ = 0;
+  std::vector<std::unique_ptr<Shard>> shards_;
   PersistentTensor empty_key_;
   uint64 empty_key_hash_;
   PersistentTensor deleted_key_;
   uint64 deleted_key_hash_;
 };
 
+// Read-only lookup table backed by a file written by
+// WriteMemoryMappedTableFile(), which is memory-mapped rather than loaded, so
+// creating the table is cheap and its pages are shared by all the processes
+// serving it. The table cannot be modified.
+template <class K, class V>
+class MemoryMappedTable final : public LookupInterface {
+ public:
+  MemoryMappedTable(OpKernelContext* ctx, OpKernel* kernel) {
+    string filename;
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "filename", &filename));
+    OP_REQUIRES_OK(ctx,
+                   MemoryMappedTableFile::Open(ctx->env(), filename, &file_));
+    OP_REQUIRES(ctx,
+                file_->key_dtype() == key_dtype() &&
+                    file_->value_dtype() == value_dtype(),
+                errors::InvalidArgument(
+                    "Memory-mapped table ", filename, " maps ",
+                    DataTypeString(file_->key_dtype()), " to ",
+                    DataTypeString(file_->value_dtype()), ", expected ",
+                    DataTypeString(key_dtype()), " to ",
+                    DataTypeString(value_dtype())));
+  }
+
+  size_t size() const override { return file_->size(); }
+
+  Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
+              const Tensor& default_value) override {
+    const V default_val = default_value.flat<V>()(0);
+    const auto key_values = key.flat<K>();
+    auto value_values = value->flat<V>();
+    for (int64 i = 0; i < key_values.size(); ++i) {
+      const int64 index = FindIndex(SubtleMustCopyIfIntegral(key_values(i)));
+      value_values(i) =
+          index < 0 ? default_val : file_->template ValueAt<V>(index);
+    }
+    return Status::OK();
+  }
+
+  Status Insert(OpKernelContext* ctx, const Tensor& keys,
+                const Tensor& values) override {
+    return errors::Unimplemented("Insert not supported by MemoryMappedTable");
+  }
+
+  Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
+    return errors::Unimplemented("Remove not supported by MemoryMappedTable");
+  }
+
+  Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
+                      const Tensor& values) override {
+    return errors::Unimplemented(
+        "ImportValues not supported by MemoryMappedTable");
+  }
+
+  Status ExportValues(OpKernelContext* ctx) override {
+    const int64 size = file_->size();
+    Tensor* keys;
+    Tensor* values;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("keys", TensorShape({size}), &keys));
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("values", TensorShape({size}), &values));
+    auto keys_data = keys->flat<K>();
+    auto values_data = values->flat<V>();
+    for (int64 i = 0; i < size; ++i) {
+      keys_data(i) = file_->template KeyAt<K>(i);
+      values_data(i) = file_->template ValueAt<V>(i);
+    }
+    return Status::OK();
+  }
+
+  DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
+
+  DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
+
+  TensorShape key_shape() const override { return TensorShape(); }
+
+  TensorShape value_shape() const override { return TensorShape(); }
+
+  // The mapped file is not counted, as it is not allocated by the table.
+  int64 MemoryUsed() const override { return sizeof(MemoryMappedTable); }
+
+ private:
+  int64 FindIndex(int64 key) const { return file_->Find(key); }
+
+  int64 FindIndex(const tstring& key) const {
+    return file_->Find(StringPiece(key.data(), key.size()));
+  }
+
+  std::unique_ptr<MemoryMappedTableFile> file_;
+};
+
 }  // namespace lookup
 
 // Table lookup op. Perform the lookup operation on the given table.
@@ -962,6 +1210,26 @@ REGISTER_KERNEL_BUILDER(Name("LookupTableImport").Device(DEVICE_CPU),
 REGISTER_KERNEL_BUILDER(Name("LookupTableImportV2").Device(DEVICE_CPU),
                         LookupTableImportOp);
 
+// Op that writes keys and values to a file read by MemoryMappedTable.
+class WriteMemoryMappedTableOp : public OpKernel {
+ public:
+  explicit WriteMemoryMappedTableOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& filename = ctx->input(0);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(filename.shape()),
+                errors::InvalidArgument("filename must be a scalar, got shape ",
+                                        filename.shape().DebugString()));
+    OP_REQUIRES_OK(ctx, lookup::WriteMemoryMappedTableFile(
+                            ctx->env(), filename.scalar<tstring>()(),
+                            ctx->input(1), ctx->input(2)));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("WriteMemoryMappedTable").Device(DEVICE_CPU),
+                        WriteMemoryMappedTableOp);
+
 // Register the HashTable op with the currently supported key and value types.
 #define REGISTER_KERNEL(key_dtype, value_dtype)                           \
   REGISTER_KERNEL_BUILDER(                                                \
@@ -1098,4 +1366,29 @@ REGISTER_KERNEL(tstring, int64);
 
 #undef REGISTER_KERNEL
 
+// Register the MemoryMappedTable op.
+#define REGISTER_KERNEL(key_dtype, value_dtype)                        \
+  REGISTER_KERNEL_BUILDER(                                             \
+      Name("MemoryMappedTable")                                        \
+          .Device(DEVICE_CPU)                                          \
+          .TypeConstraint<key_dtype>("key_dtype")                      \
+          .TypeConstraint<value_dtype>("value_dtype"),                 \
+      LookupTableOp<lookup::MemoryMappedTable<key_dtype, value_dtype>, \
+                    key_dtype, value_dtype>)
+
+REGISTER_KERNEL(int64, bool);
+REGISTER_KERNEL(int64, double);
+REGISTER_KERNEL(int64, float);
+REGISTER_KERNEL(int64, int32);
+REGISTER_KERNEL(int64, int64);
+REGISTER_KERNEL(int64, tstring);
+REGISTER_KERNEL(tstring, bool);
+REGISTER_KERNEL(tstring, double);
+REGISTER_KERNEL(tstring, float);
+REGISTER_KERNEL(tstring, int32);
+REGISTER_KERNEL(tstring, int64);
+REGISTER_KERNEL(tstring, tstring);
+
+#undef REGISTER_KERNEL
+
 }  // namespace tensorflow
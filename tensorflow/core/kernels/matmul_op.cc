@@ -19,10 +19,14 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/matmul_op.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/kernels/bfloat16_gemm.h"
 #include "tensorflow/core/kernels/fill_functor.h"
+#include "tensorflow/core/kernels/ruy_gemm.h"
 #include "tensorflow/core/util/matmul_autotune.h"
 #if GOOGLE_CUDA
 #include "third_party/gpus/cuda/include/cuda.h"
@@ -145,6 +149,30 @@ struct LaunchMatMulBase {
 template <typename T>
 struct LaunchMatMulCPU : LaunchMatMulBase<CPUDevice, T> {};
 
+#ifdef TENSORFLOW_USE_RUY_GEMM
+template <>
+struct LaunchMatMulCPU<float> : LaunchMatMulBase<CPUDevice, float> {
+  static void launch(
+      OpKernelContext* ctx, const Tensor& a, const Tensor& b,
+      const Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1>& dim_pair,
+      std::vector<AlgorithmType>* algorithms, bool use_autotune, Tensor* out) {
+    const int64 m = out->dim_size(0);
+    const int64 n = out->dim_size(1);
+    const int64 k = a.dim_size(dim_pair[0].first);
+    // Matrix-vector products are left to the explicit Eigen kernels.
+    if (m == 1 || n == 1 || std::max({m, n, k}) > kint32max) {
+      LaunchMatMulBase<CPUDevice, float>::launch(ctx, a, b, dim_pair,
+                                                 algorithms, use_autotune, out);
+      return;
+    }
+    RuyGemm(ctx->device()->tensorflow_cpu_worker_threads()->num_threads,
+            dim_pair[0].first == 0, dim_pair[0].second == 1, m, n, k,
+            a.flat<float>().data(), b.flat<float>().data(),
+            out->flat<float>().data());
+  }
+};
+#endif  // TENSORFLOW_USE_RUY_GEMM
+
 template <typename T, bool USE_CUBLAS>
 struct LaunchMatMul<CPUDevice, T, USE_CUBLAS> : public LaunchMatMulCPU<T> {};
 
@@ -498,6 +526,16 @@ class MatMulOp : public OpKernel {
       bool is_cpu = std::is_same<Device, CPUDevice>::value;
       OP_REQUIRES(ctx, is_cpu,
                   errors::Internal("bfloat16 matmul is not supported by GPU"));
+      const int64 m = out->dim_size(0);
+      const int64 n = out->dim_size(1);
+      const int64 k = a.dim_size(dim_pair[0].first);
+      if (CanUseNativeBFloat16Gemm() && std::max({m, n, k}) <= kint32max) {
+        NativeBFloat16Gemm(*ctx->device()->tensorflow_cpu_worker_threads(),
+                           transpose_a_, transpose_b_, m, n, k,
+                           a.flat<bfloat16>().data(), b.flat<bfloat16>().data(),
+                           out->flat<bfloat16>().data());
+        return;
+      }
       Tensor a_float, b_float, out_float;
       OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, a.shape(), &a_float));
       OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, b.shape(), &b_float));
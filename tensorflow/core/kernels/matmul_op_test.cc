@@ -16,6 +16,8 @@ limitations under the License.
 #include "absl/algorithm/container.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
@@ -337,6 +339,71 @@ using FusedBiasAddDataTypes = ::testing::Types<float>;
 INSTANTIATE_TYPED_TEST_SUITE_P(Test, FusedMatMulWithBiasOpTest,
                                FusedBiasAddDataTypes);
 
+// Checks bfloat16 MatMul, which uses native bfloat16 dot products on CPUs that
+// support them and float32 otherwise, against a float32 computation.
+class BFloat16MatMulOpTest : public OpsTestBase {
+ protected:
+  void RunMatMul(int m, int k, int n, bool transpose_a, bool transpose_b) {
+    TF_EXPECT_OK(NodeDefBuilder("matmul", "MatMul")
+                     .Input(FakeInput(DT_BFLOAT16))
+                     .Input(FakeInput(DT_BFLOAT16))
+                     .Attr("transpose_a", transpose_a)
+                     .Attr("transpose_b", transpose_b)
+                     .Finalize(node_def()));
+    TF_EXPECT_OK(InitOp());
+
+    std::vector<bfloat16> a(m * k);
+    std::vector<bfloat16> b(k * n);
+    for (int i = 0; i < m * k; ++i) {
+      a[i] = bfloat16(static_cast<float>(i % 17 - 8) / 8);
+    }
+    for (int i = 0; i < k * n; ++i) {
+      b[i] = bfloat16(static_cast<float>(i % 13 - 6) / 4);
+    }
+    AddInputFromArray<bfloat16>(
+        transpose_a ? TensorShape({k, m}) : TensorShape({m, k}), a);
+    AddInputFromArray<bfloat16>(
+        transpose_b ? TensorShape({n, k}) : TensorShape({k, n}), b);
+    TF_ASSERT_OK(RunOpKernel());
+
+    const Tensor& output = *GetOutput(0);
+    ASSERT_EQ(output.shape(), TensorShape({m, n}));
+    const auto out = output.matrix<bfloat16>();
+    for (int i = 0; i < m; ++i) {
+      for (int j = 0; j < n; ++j) {
+        float expected = 0;
+        for (int l = 0; l < k; ++l) {
+          const float a_il = static_cast<float>(
+              transpose_a ? a[l * m + i] : a[i * k + l]);
+          const float b_lj = static_cast<float>(
+              transpose_b ? b[j * k + l] : b[l * n + j]);
+          expected += a_il * b_lj;
+        }
+        // The output is rounded to bfloat16, with an 8 bit mantissa.
+        EXPECT_NEAR(static_cast<float>(out(i, j)), expected,
+                    1e-2 * (1 + std::abs(expected)))
+            << "at " << i << ", " << j;
+      }
+    }
+  }
+};
+
+TEST_F(BFloat16MatMulOpTest, Square) { RunMatMul(32, 32, 32, false, false); }
+
+TEST_F(BFloat16MatMulOpTest, OddSizes) { RunMatMul(13, 7, 21, false, false); }
+
+TEST_F(BFloat16MatMulOpTest, TransposeA) {
+  RunMatMul(19, 33, 17, true, false);
+}
+
+TEST_F(BFloat16MatMulOpTest, TransposeB) {
+  RunMatMul(9, 40, 35, false, true);
+}
+
+TEST_F(BFloat16MatMulOpTest, MatrixTimesVector) {
+  RunMatMul(64, 31, 1, true, true);
+}
+
 //----------------------------------------------------------------------------//
 // Performance benchmarks are below.                                          //
 //----------------------------------------------------------------------------//
@@ -0,0 +1,262 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/memory_mapped_table_file.h"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace lookup {
+namespace {
+
+constexpr char kMagic[8] = {'T', 'F', 'M', 'M', 'T', 'B', 'L', '1'};
+
+struct Header {
+  char magic[8];
+  uint32 key_dtype;
+  uint32 value_dtype;
+  uint64 num_entries;
+  uint64 reserved;
+};
+static_assert(sizeof(Header) == 32, "Unexpected Header size");
+
+bool IsValidKeyDtype(DataType dtype) {
+  return dtype == DT_INT64 || dtype == DT_STRING;
+}
+
+bool IsValidValueDtype(DataType dtype) {
+  switch (dtype) {
+    case DT_BOOL:
+    case DT_INT32:
+    case DT_INT64:
+    case DT_FLOAT:
+    case DT_DOUBLE:
+    case DT_STRING:
+      return true;
+    default:
+      return false;
+  }
+}
+
+uint64 RoundUpTo8(uint64 n) { return (n + 7) & ~uint64{7}; }
+
+// Appends the elements of `t` in the given order to `out`, in the column
+// format described in the header, padded to a multiple of 8 bytes.
+void AppendColumn(const Tensor& t, const std::vector<int64>& order,
+                  string* out) {
+  if (t.dtype() == DT_STRING) {
+    const auto flat = t.flat<tstring>();
+    std::vector<uint64> offsets(order.size() + 1, 0);
+    for (size_t i = 0; i < order.size(); ++i) {
+      offsets[i + 1] = offsets[i] + flat(order[i]).size();
+    }
+    out->append(reinterpret_cast<const char*>(offsets.data()),
+                offsets.size() * sizeof(uint64));
+    for (const int64 index : order) {
+      out->append(flat(index).data(), flat(index).size());
+    }
+  } else {
+    const int64 element_size = DataTypeSize(t.dtype());
+    const char* data = t.tensor_data().data();
+    for (const int64 index : order) {
+      out->append(data + index * element_size, element_size);
+    }
+  }
+  out->resize(RoundUpTo8(out->size()), '\0');
+}
+
+}  // namespace
+
+Status MemoryMappedTableFile::Open(
+    Env* env, const string& filename,
+    std::unique_ptr<MemoryMappedTableFile>* file) {
+  std::unique_ptr<MemoryMappedTableFile> result(new MemoryMappedTableFile);
+  TF_RETURN_IF_ERROR(
+      env->NewReadOnlyMemoryRegionFromFile(filename, &result->region_));
+  const char* data = static_cast<const char*>(result->region_->data());
+  const uint64 length = result->region_->length();
+  if (length < sizeof(Header)) {
+    return errors::DataLoss("Memory-mapped table ", filename,
+                            " is too short: ", length, " bytes");
+  }
+  Header header;
+  std::memcpy(&header, data, sizeof(Header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    return errors::DataLoss(filename, " is not a memory-mapped table");
+  }
+  result->key_dtype_ = static_cast<DataType>(header.key_dtype);
+  result->value_dtype_ = static_cast<DataType>(header.value_dtype);
+  if (!IsValidKeyDtype(result->key_dtype_) ||
+      !IsValidValueDtype(result->value_dtype_)) {
+    return errors::DataLoss("Memory-mapped table ", filename,
+                            " has unsupported dtypes ", header.key_dtype,
+                            " and ", header.value_dtype);
+  }
+  if (header.num_entries > length) {
+    return errors::DataLoss("Memory-mapped table ", filename,
+                            " is truncated");
+  }
+  result->num_entries_ = header.num_entries;
+
+  uint64 offset = sizeof(Header);
+  Status s = result->ParseColumn(result->key_dtype_, &offset, &result->keys_);
+  if (s.ok()) {
+    s = result->ParseColumn(result->value_dtype_, &offset, &result->values_);
+  }
+  if (!s.ok()) {
+    return errors::DataLoss("Memory-mapped table ", filename,
+                            " is corrupted: ", s.error_message());
+  }
+  *file = std::move(result);
+  return Status::OK();
+}
+
+Status MemoryMappedTableFile::ParseColumn(DataType dtype, uint64* offset,
+                                          Column* column) const {
+  const char* data = static_cast<const char*>(region_->data());
+  const uint64 length = region_->length();
+  if (*offset > length) {
+    return errors::DataLoss("column starts past the end of the file");
+  }
+  if (dtype != DT_STRING) {
+    const uint64 column_size = num_entries_ * DataTypeSize(dtype);
+    if (column_size > length - *offset) {
+      return errors::DataLoss("column ends past the end of the file");
+    }
+    column->data = data + *offset;
+    *offset = RoundUpTo8(*offset + column_size);
+    return Status::OK();
+  }
+  const uint64 offsets_size = (num_entries_ + 1) * sizeof(uint64);
+  if (offsets_size > length - *offset) {
+    return errors::DataLoss("column offsets end past the end of the file");
+  }
+  column->offsets = reinterpret_cast<const uint64*>(data + *offset);
+  column->data = data + *offset + offsets_size;
+  // Checks the offsets once here, so that lookups need not check them.
+  if (column->offsets[0] != 0) {
+    return errors::DataLoss("first string offset is not 0");
+  }
+  for (int64 i = 0; i < num_entries_; ++i) {
+    if (column->offsets[i + 1] < column->offsets[i]) {
+      return errors::DataLoss("string offsets are not sorted");
+    }
+  }
+  const uint64 strings_size = column->offsets[num_entries_];
+  if (strings_size > length - *offset - offsets_size) {
+    return errors::DataLoss("strings end past the end of the file");
+  }
+  *offset = RoundUpTo8(*offset + offsets_size + strings_size);
+  return Status::OK();
+}
+
+int64 MemoryMappedTableFile::Find(int64 key) const {
+  // The int64 keys are 8 byte aligned, as the file is mapped at a page
+  // boundary and the column starts at a multiple of 8 bytes.
+  const int64* begin = reinterpret_cast<const int64*>(keys_.data);
+  const int64* end = begin + num_entries_;
+  const int64* it = std::lower_bound(begin, end, key);
+  if (it == end || *it != key) {
+    return -1;
+  }
+  return it - begin;
+}
+
+int64 MemoryMappedTableFile::Find(StringPiece key) const {
+  int64 low = 0;
+  int64 high = num_entries_;
+  while (low < high) {
+    const int64 mid = low + (high - low) / 2;
+    if (StringAt(keys_, mid) < key) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  if (low == num_entries_ || StringAt(keys_, low) != key) {
+    return -1;
+  }
+  return low;
+}
+
+Status WriteMemoryMappedTableFile(Env* env, const string& filename,
+                                  const Tensor& keys, const Tensor& values) {
+  if (!IsValidKeyDtype(keys.dtype())) {
+    return errors::InvalidArgument(
+        "Memory-mapped table keys must be int64 or string, got ",
+        DataTypeString(keys.dtype()));
+  }
+  if (!IsValidValueDtype(values.dtype())) {
+    return errors::InvalidArgument(
+        "Memory-mapped table values must be bool, int32, int64, float, double "
+        "or string, got ",
+        DataTypeString(values.dtype()));
+  }
+  if (keys.dims() != 1 || !keys.shape().IsSameSize(values.shape())) {
+    return errors::InvalidArgument(
+        "Keys and values must be vectors of the same size, got shapes ",
+        keys.shape().DebugString(), " and ", values.shape().DebugString());
+  }
+
+  const int64 num_entries = keys.NumElements();
+  std::vector<int64> order(num_entries);
+  std::iota(order.begin(), order.end(), 0);
+  if (keys.dtype() == DT_STRING) {
+    const auto flat = keys.flat<tstring>();
+    auto key_at = [&flat](int64 i) {
+      return StringPiece(flat(i).data(), flat(i).size());
+    };
+    std::sort(order.begin(), order.end(),
+              [&key_at](int64 a, int64 b) { return key_at(a) < key_at(b); });
+    for (int64 i = 1; i < num_entries; ++i) {
+      if (key_at(order[i - 1]) == key_at(order[i])) {
+        return errors::InvalidArgument("Duplicate key ", key_at(order[i]),
+                                       " in memory-mapped table");
+      }
+    }
+  } else {
+    const auto flat = keys.flat<int64>();
+    std::sort(order.begin(), order.end(),
+              [&flat](int64 a, int64 b) { return flat(a) < flat(b); });
+    for (int64 i = 1; i < num_entries; ++i) {
+      if (flat(order[i - 1]) == flat(order[i])) {
+        return errors::InvalidArgument("Duplicate key ", flat(order[i]),
+                                       " in memory-mapped table");
+      }
+    }
+  }
+
+  Header header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.key_dtype = keys.dtype();
+  header.value_dtype = values.dtype();
+  header.num_entries = num_entries;
+  header.reserved = 0;
+  string contents(reinterpret_cast<const char*>(&header), sizeof(Header));
+  AppendColumn(keys, order, &contents);
+  AppendColumn(values, order, &contents);
+
+  const string tmp_filename = strings::StrCat(filename, ".tmp");
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_filename, contents));
+  return env->RenameFile(tmp_filename, filename);
+}
+
+}  // namespace lookup
+}  // namespace tensorflow
@@ -0,0 +1,121 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_MEMORY_MAPPED_TABLE_FILE_H_
+#define TENSORFLOW_CORE_KERNELS_MEMORY_MAPPED_TABLE_FILE_H_
+
+#include <cstring>
+#include <memory>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace lookup {
+
+// A read-only table of scalar keys and values, stored in a file that is
+// memory-mapped rather than parsed, so that loading it costs no more than
+// validating its layout, and the processes serving the same table share its
+// pages through the page cache.
+//
+// The file, written in the host byte order, consists of a 32 byte header
+// (magic, key dtype, value dtype, number of entries, reserved) followed by a
+// key column and a value column, each starting at a multiple of 8 bytes. A
+// column of fixed-width values is a plain array; a column of strings is an
+// array of num_entries + 1 uint64 offsets followed by the string bytes. Keys
+// are sorted (strings bytewise) and unique, and are found by binary search.
+//
+// Keys may be int64 or string; values may be bool, int32, int64, float, double
+// or string.
+class MemoryMappedTableFile {
+ public:
+  // Maps the file written by WriteMemoryMappedTableFile() to `filename`.
+  static Status Open(Env* env, const string& filename,
+                     std::unique_ptr<MemoryMappedTableFile>* file);
+
+  DataType key_dtype() const { return key_dtype_; }
+  DataType value_dtype() const { return value_dtype_; }
+  int64 size() const { return num_entries_; }
+
+  // Returns the index of `key`, or -1 if it is not in the table.
+  int64 Find(int64 key) const;
+  int64 Find(StringPiece key) const;
+
+  // Returns the key and value at `index`, which must be in [0, size()). T must
+  // match the dtype of the column.
+  template <typename T>
+  T KeyAt(int64 index) const {
+    return At<T>(keys_, index);
+  }
+  template <typename T>
+  T ValueAt(int64 index) const {
+    return At<T>(values_, index);
+  }
+
+ private:
+  // A column of the table, pointing into the mapped file.
+  struct Column {
+    const char* data = nullptr;
+    // Only set for string columns.
+    const uint64* offsets = nullptr;
+  };
+
+  MemoryMappedTableFile() = default;
+
+  static StringPiece StringAt(const Column& column, int64 index) {
+    return StringPiece(column.data + column.offsets[index],
+                       column.offsets[index + 1] - column.offsets[index]);
+  }
+
+  template <typename T>
+  static T At(const Column& column, int64 index) {
+    T value;
+    std::memcpy(&value, column.data + index * sizeof(T), sizeof(T));
+    return value;
+  }
+
+  // Checks the column of `dtype` starting at `*offset` and advances `*offset`
+  // past it.
+  Status ParseColumn(DataType dtype, uint64* offset, Column* column) const;
+
+  std::unique_ptr<ReadOnlyMemoryRegion> region_;
+  DataType key_dtype_ = DT_INVALID;
+  DataType value_dtype_ = DT_INVALID;
+  int64 num_entries_ = 0;
+  Column keys_;
+  Column values_;
+};
+
+template <>
+inline tstring MemoryMappedTableFile::At<tstring>(const Column& column,
+                                                  int64 index) {
+  const StringPiece value = StringAt(column, index);
+  return tstring(value.data(), value.size());
+}
+
+// Writes `keys` and `values`, vectors of the same length, to `filename` in the
+// format read by MemoryMappedTableFile. Fails if a key is repeated. The file is
+// written under a temporary name and then renamed, so that a table never maps
+// a partially written file.
+Status WriteMemoryMappedTableFile(Env* env, const string& filename,
+                                  const Tensor& keys, const Tensor& values);
+
+}  // namespace lookup
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_MEMORY_MAPPED_TABLE_FILE_H_
@@ -0,0 +1,132 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_MPMC_RING_BUFFER_H_
+#define TENSORFLOW_CORE_KERNELS_MPMC_RING_BUFFER_H_
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A bounded FIFO of T that any number of threads may push to and pop from
+// without taking a lock (Dmitry Vyukov's bounded MPMC queue).
+//
+// Producers and consumers claim a position with a compare-and-swap on
+// enqueue_pos_ / dequeue_pos_, and hand the slot over to each other through
+// its sequence number: a slot at position `pos` is free for the producer of
+// `pos` when its sequence is `pos`, holds a value for the consumer of `pos`
+// when its sequence is `pos + 1`, and is free for the producer of
+// `pos + capacity` once that consumer sets it to `pos + capacity`.
+//
+// TryPush() and TryPop() never block. They may report the buffer as full
+// (resp. empty) while another thread is in the middle of a pop (resp. push)
+// of the slot they need.
+template <typename T>
+class MpmcRingBuffer {
+ public:
+  explicit MpmcRingBuffer(int64 capacity)
+      : capacity_(capacity),
+        slots_(new Slot[capacity]),
+        enqueue_pos_(0),
+        dequeue_pos_(0) {
+    CHECK_GT(capacity, 0);
+    for (uint64 i = 0; i < capacity_; ++i) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  int64 capacity() const { return capacity_; }
+
+  // Moves *value into the buffer and returns true, or returns false and
+  // leaves *value untouched if the buffer is full.
+  bool TryPush(T* value) {
+    uint64 pos = enqueue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot* slot = &slots_[pos % capacity_];
+      const uint64 sequence = slot->sequence.load(std::memory_order_acquire);
+      const int64 diff = static_cast<int64>(sequence - pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          slot->value = std::move(*value);
+          slot->sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Moves the oldest element into *value and returns true, or returns false
+  // if the buffer is empty.
+  bool TryPop(T* value) {
+    uint64 pos = dequeue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot* slot = &slots_[pos % capacity_];
+      const uint64 sequence = slot->sequence.load(std::memory_order_acquire);
+      const int64 diff = static_cast<int64>(sequence - (pos + 1));
+      if (diff == 0) {
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          *value = std::move(slot->value);
+          slot->value = T();
+          slot->sequence.store(pos + capacity_, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Returns the number of elements. Only exact when no push or pop is in
+  // progress.
+  int64 size() const {
+    const uint64 dequeue_pos = dequeue_pos_.load(std::memory_order_acquire);
+    const uint64 enqueue_pos = enqueue_pos_.load(std::memory_order_acquire);
+    const int64 size = static_cast<int64>(enqueue_pos - dequeue_pos);
+    if (size < 0) return 0;
+    return size > static_cast<int64>(capacity_) ? capacity_ : size;
+  }
+
+ private:
+  struct Slot {
+    std::atomic<uint64> sequence;
+    T value;
+  };
+
+  const uint64 capacity_;
+  std::unique_ptr<Slot[]> slots_;
+  // Kept on separate cache lines so producers and consumers don't contend.
+  alignas(64) std::atomic<uint64> enqueue_pos_;
+  alignas(64) std::atomic<uint64> dequeue_pos_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MpmcRingBuffer);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_MPMC_RING_BUFFER_H_
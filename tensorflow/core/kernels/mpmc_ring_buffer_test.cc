@@ -0,0 +1,108 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/mpmc_ring_buffer.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(MpmcRingBufferTest, FifoOrderAndBounds) {
+  MpmcRingBuffer<int> ring(3);
+  int value = 0;
+  EXPECT_FALSE(ring.TryPop(&value));
+  for (int round = 0; round < 5; ++round) {
+    for (int i = 0; i < 3; ++i) {
+      value = round * 10 + i;
+      EXPECT_TRUE(ring.TryPush(&value));
+    }
+    value = -1;
+    EXPECT_FALSE(ring.TryPush(&value));
+    EXPECT_EQ(-1, value);
+    EXPECT_EQ(3, ring.size());
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_TRUE(ring.TryPop(&value));
+      EXPECT_EQ(round * 10 + i, value);
+    }
+    EXPECT_FALSE(ring.TryPop(&value));
+    EXPECT_EQ(0, ring.size());
+  }
+}
+
+TEST(MpmcRingBufferTest, MovesValues) {
+  MpmcRingBuffer<std::unique_ptr<int>> ring(2);
+  std::unique_ptr<int> value(new int(7));
+  EXPECT_TRUE(ring.TryPush(&value));
+  EXPECT_EQ(nullptr, value);
+  EXPECT_TRUE(ring.TryPop(&value));
+  ASSERT_NE(nullptr, value);
+  EXPECT_EQ(7, *value);
+}
+
+TEST(MpmcRingBufferTest, ConcurrentProducersAndConsumers) {
+  constexpr int kNumThreads = 4;
+  constexpr int kValuesPerProducer = 10000;
+  MpmcRingBuffer<int> ring(16);
+  std::vector<std::atomic<int>> seen(kNumThreads * kValuesPerProducer);
+  for (auto& count : seen) count = 0;
+  std::atomic<int> num_popped(0);
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int t = 0; t < kNumThreads; ++t) {
+      threads.emplace_back(Env::Default()->StartThread(
+          ThreadOptions(), "producer", [&ring, t]() {
+            // Each producer pushes its values in increasing order.
+            for (int i = 0; i < kValuesPerProducer; ++i) {
+              int value = t * kValuesPerProducer + i;
+              while (!ring.TryPush(&value)) {
+                std::this_thread::yield();
+              }
+            }
+          }));
+      threads.emplace_back(Env::Default()->StartThread(
+          ThreadOptions(), "consumer", [&ring, &seen, &num_popped]() {
+            std::vector<int> last(kNumThreads, -1);
+            while (num_popped < kNumThreads * kValuesPerProducer) {
+              int value;
+              if (!ring.TryPop(&value)) {
+                std::this_thread::yield();
+                continue;
+              }
+              ++num_popped;
+              ++seen[value];
+              // Values of one producer come out in the order pushed.
+              const int producer = value / kValuesPerProducer;
+              EXPECT_LT(last[producer], value);
+              last[producer] = value;
+            }
+          }));
+    }
+  }
+  for (const auto& count : seen) {
+    EXPECT_EQ(1, count);
+  }
+  EXPECT_EQ(0, ring.size());
+}
+
+}  // namespace
+}  // namespace tensorflow
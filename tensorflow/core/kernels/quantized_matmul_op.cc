@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/meta_support.h"
 #include "tensorflow/core/kernels/quantization_utils.h"
 #include "tensorflow/core/kernels/reference_gemm.h"
+#include "tensorflow/core/kernels/ruy_gemm.h"
 #include "tensorflow/core/lib/core/errors.h"
 
 namespace tensorflow {
@@ -63,6 +64,36 @@ void GemmlowpMultiply(OpKernelContext* op_context, const quint8* a_data,
   TF_ANNOTATE_MEMORY_IS_INITIALIZED(c_data_as_int32, m * n * sizeof(int32));
 }
 
+// Multiplies the matrices with ruy, in builds with ruy, when it supports the
+// types and offsets. Returns false, and does nothing, otherwise.
+template <class T1, class T2, class Toutput>
+bool RuyMultiply(OpKernelContext* op_context, bool transpose_a,
+                 bool transpose_b, const T1* a_data, const T2* b_data,
+                 Toutput* c_data, int m, int n, int k, int offset_a,
+                 int offset_b) {
+  return false;
+}
+
+#ifdef TENSORFLOW_USE_RUY_GEMM
+template <>
+bool RuyMultiply<quint8, quint8, qint32>(OpKernelContext* op_context,
+                                         bool transpose_a, bool transpose_b,
+                                         const quint8* a_data,
+                                         const quint8* b_data, qint32* c_data,
+                                         int m, int n, int k, int offset_a,
+                                         int offset_b) {
+  // ruy takes the offsets as uint8 zero points, which cannot both be 0.
+  if (offset_a < 0 || offset_a > 255 || offset_b < 0 || offset_b > 255 ||
+      (offset_a == 0 && offset_b == 0)) {
+    return false;
+  }
+  RuyGemm(op_context->device()->tensorflow_cpu_worker_threads()->num_threads,
+          transpose_a, transpose_b, m, n, k, &(a_data->value), offset_a,
+          &(b_data->value), offset_b, &(c_data->value));
+  return true;
+}
+#endif  // TENSORFLOW_USE_RUY_GEMM
+
 template <class T1, class T2, class Toutput>
 class QuantizedMatMulOp : public OpKernel {
  public:
@@ -132,7 +163,10 @@ class QuantizedMatMulOp : public OpKernel {
     const size_t ldb = b.dim_size(1);
     const size_t ldc = n;
 
-    if (meta::IsSupportedAndEnabled() && std::is_same<T1, quint8>() &&
+    if (RuyMultiply(context, transpose_a_, transpose_b_, a_data, b_data, c_data,
+                    m, n, k, offset_a, offset_b)) {
+      // ruy multiplied the matrices.
+    } else if (meta::IsSupportedAndEnabled() && std::is_same<T1, quint8>() &&
         std::is_same<T2, quint8>() && std::is_same<Toutput, qint32>() &&
         (offset_c == 0) && (mult_c == 1) && (shift_c == 0) &&
         (transpose_c == false) && (k <= 2048)) {
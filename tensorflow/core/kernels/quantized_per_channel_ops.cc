@@ -0,0 +1,412 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Implements the per-channel int8 versions of MatMul and Conv2D that the int8
+// quantizer (grappler/optimizers/int8_quantizer.h) rewrites graphs to.
+//
+// The float activations are quantized on the fly to asymmetric int8, with the
+// range that calibration recorded for them. The weights are symmetric int8
+// with a scale per output channel. The products are accumulated in 32 bits and
+// dequantized to float, so that the ops replace their float versions in place.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#define GEMMLOWP_ALLOW_SLOW_SCALAR_FALLBACK
+#include "public/gemmlowp.h"
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/kernels/quantization_utils.h"
+#include "tensorflow/core/kernels/ruy_gemm.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/padding.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The quantization of the activations, value = scale * (q - zero_point).
+struct ActivationQuantization {
+  float scale;
+  float inverse_scale;
+  int32 zero_point;
+};
+
+// Returns the quantization of [min, max], widened to include 0 so that 0, and
+// hence the padding of convolutions, is exact.
+ActivationQuantization ChooseActivationQuantization(float min, float max) {
+  min = std::min(min, 0.0f);
+  max = std::max(max, 0.0f);
+  ActivationQuantization result;
+  result.scale = max > min ? (max - min) / 255.0f : 1.0f;
+  result.inverse_scale = 1.0f / result.scale;
+  const float zero_point = std::round(-128.0f - min / result.scale);
+  result.zero_point =
+      static_cast<int32>(std::min(127.0f, std::max(-128.0f, zero_point)));
+  return result;
+}
+
+inline int8 QuantizeActivation(const ActivationQuantization& quantization,
+                               float value) {
+  const float q = std::round(value * quantization.inverse_scale) +
+                  quantization.zero_point;
+  return static_cast<int8>(std::min(127.0f, std::max(-128.0f, q)));
+}
+
+#ifndef TENSORFLOW_USE_RUY_GEMM
+template <gemmlowp::MapOrder kRhsOrder>
+void GemmlowpMultiply(const DeviceBase::CpuWorkerThreads& worker_threads,
+                      int m, int n, int k, const uint8* a, int32 offset_a,
+                      const uint8* b, int32 offset_b, int32* c) {
+  gemmlowp::MatrixMap<const std::uint8_t, gemmlowp::MapOrder::RowMajor> lhs(
+      a, m, k);
+  gemmlowp::MatrixMap<const std::uint8_t, kRhsOrder> rhs(b, k, n);
+  gemmlowp::MatrixMap<std::int32_t, gemmlowp::MapOrder::RowMajor> result(c, m,
+                                                                         n);
+  const std::tuple<> empty_pipeline = {};
+  TensorflowGemmContext context(worker_threads.num_threads,
+                                worker_threads.workers);
+  gemmlowp::GemmWithOutputPipeline<std::uint8_t, std::int32_t,
+                                   gemmlowp::DefaultL8R8BitDepthParams>(
+      &context, lhs, rhs, &result, offset_a, offset_b, empty_pipeline);
+  // Since gemmlowp uses assembly to write to the output, msan won't detect
+  // the output buffer as written to, so we mark it manually.
+  TF_ANNOTATE_MEMORY_IS_INITIALIZED(c, m * n * sizeof(int32));
+}
+
+// Flips the sign bits of `values`, i.e. adds 128 to them as uint8.
+std::vector<uint8> ToUint8(const int8* values, int64 size) {
+  std::vector<uint8> result(size);
+  for (int64 i = 0; i < size; ++i) {
+    result[i] = static_cast<uint8>(values[i]) ^ 0x80;
+  }
+  return result;
+}
+#endif  // TENSORFLOW_USE_RUY_GEMM
+
+// Computes c = (a - a_zero_point) * op(b), accumulated in 32 bits, where a is
+// m x k, op(b) is k x n, op(b) transposes b if `transpose_b`, and all the
+// matrices are row major.
+void Int8Gemm(OpKernelContext* context, int m, int n, int k, const int8* a,
+              int32 a_zero_point, bool transpose_b, const int8* b, int32* c) {
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+#ifdef TENSORFLOW_USE_RUY_GEMM
+  RuyGemm(worker_threads.num_threads, /*transpose_a=*/false, transpose_b, m, n,
+          k, a, static_cast<int8>(a_zero_point), b, /*b_zero_point=*/0, c);
+#else
+  // gemmlowp only multiplies uint8 matrices, so both operands are offset by
+  // 128, and their offsets compensate.
+  const std::vector<uint8> a_uint8 = ToUint8(a, static_cast<int64>(m) * k);
+  const std::vector<uint8> b_uint8 = ToUint8(b, static_cast<int64>(k) * n);
+  const int32 offset_a = -(a_zero_point + 128);
+  const int32 offset_b = -128;
+  if (transpose_b) {
+    GemmlowpMultiply<gemmlowp::MapOrder::ColMajor>(
+        worker_threads, m, n, k, a_uint8.data(), offset_a, b_uint8.data(),
+        offset_b, c);
+  } else {
+    GemmlowpMultiply<gemmlowp::MapOrder::RowMajor>(
+        worker_threads, m, n, k, a_uint8.data(), offset_a, b_uint8.data(),
+        offset_b, c);
+  }
+#endif  // TENSORFLOW_USE_RUY_GEMM
+}
+
+// Stores the m x n products `c` in `output`, dequantized with the scale of the
+// activations and the scales of the columns.
+void Dequantize(int64 m, int n, const int32* c, float a_scale,
+                const float* b_scales, float* output) {
+  std::vector<float> scales(n);
+  for (int j = 0; j < n; ++j) {
+    scales[j] = a_scale * b_scales[j];
+  }
+  for (int64 i = 0; i < m; ++i) {
+    for (int j = 0; j < n; ++j) {
+      output[i * n + j] = c[i * n + j] * scales[j];
+    }
+  }
+}
+
+}  // namespace
+
+class QuantizedMatMulPerChannelOp : public OpKernel {
+ public:
+  explicit QuantizedMatMulPerChannelOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_a", &transpose_a_));
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_b", &transpose_b_));
+    float min_a;
+    float max_a;
+    OP_REQUIRES_OK(context, context->GetAttr("min_a", &min_a));
+    OP_REQUIRES_OK(context, context->GetAttr("max_a", &max_a));
+    OP_REQUIRES(context, min_a <= max_a,
+                errors::InvalidArgument("min_a must not be larger than max_a: ",
+                                        min_a, " vs ", max_a));
+    quantization_ = ChooseActivationQuantization(min_a, max_a);
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& a = context->input(0);
+    const Tensor& b = context->input(1);
+    const Tensor& b_scales = context->input(2);
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(a.shape()),
+                errors::InvalidArgument("In[0] is not a matrix"));
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(b.shape()),
+                errors::InvalidArgument("In[1] is not a matrix"));
+    const int64 m = a.dim_size(transpose_a_ ? 1 : 0);
+    const int64 k = a.dim_size(transpose_a_ ? 0 : 1);
+    const int64 n = b.dim_size(transpose_b_ ? 0 : 1);
+    OP_REQUIRES(context, k == b.dim_size(transpose_b_ ? 1 : 0),
+                errors::InvalidArgument("Matrix size-incompatible: In[0]: ",
+                                        a.shape().DebugString(),
+                                        ", In[1]: ", b.shape().DebugString()));
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(b_scales.shape()) &&
+                    b_scales.NumElements() == n,
+                errors::InvalidArgument("b_scales must have ", n,
+                                        " elements: ",
+                                        b_scales.shape().DebugString()));
+    OP_REQUIRES(context,
+                FastBoundsCheck(m, kint32max) &&
+                    FastBoundsCheck(k, kint32max) &&
+                    FastBoundsCheck(n, kint32max),
+                errors::InvalidArgument("Matrix dimensions too large"));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, {m, n}, &output));
+    if (output->NumElements() == 0) return;
+    if (k == 0) {
+      output->flat<float>().setZero();
+      return;
+    }
+
+    // Quantizes op(a), row major.
+    Tensor quantized_a;
+    OP_REQUIRES_OK(context,
+                   context->allocate_temp(DT_INT8, {m, k}, &quantized_a));
+    auto a_matrix = a.matrix<float>();
+    auto quantized_a_matrix = quantized_a.matrix<int8>();
+    for (int64 i = 0; i < m; ++i) {
+      for (int64 j = 0; j < k; ++j) {
+        quantized_a_matrix(i, j) = QuantizeActivation(
+            quantization_, transpose_a_ ? a_matrix(j, i) : a_matrix(i, j));
+      }
+    }
+
+    Tensor product;
+    OP_REQUIRES_OK(context, context->allocate_temp(DT_INT32, {m, n}, &product));
+    Int8Gemm(context, m, n, k, quantized_a.flat<int8>().data(),
+             quantization_.zero_point, transpose_b_,
+             reinterpret_cast<const int8*>(b.flat<qint8>().data()),
+             product.flat<int32>().data());
+    Dequantize(m, n, product.flat<int32>().data(), quantization_.scale,
+               b_scales.flat<float>().data(), output->flat<float>().data());
+  }
+
+ private:
+  bool transpose_a_;
+  bool transpose_b_;
+  ActivationQuantization quantization_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("_QuantizedMatMulPerChannel").Device(DEVICE_CPU),
+                        QuantizedMatMulPerChannelOp);
+
+class QuantizedConv2DPerChannelOp : public OpKernel {
+ public:
+  explicit QuantizedConv2DPerChannelOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("strides", &strides_));
+    OP_REQUIRES(context, strides_.size() == 4,
+                errors::InvalidArgument("Sliding window strides field must "
+                                        "specify 4 dimensions"));
+    OP_REQUIRES(
+        context, (strides_[0] == 1 && strides_[3] == 1),
+        errors::InvalidArgument("Current implementation does not yet support "
+                                "strides in the batch and depth dimensions."));
+    std::vector<int32> dilations;
+    OP_REQUIRES_OK(context, context->GetAttr("dilations", &dilations));
+    OP_REQUIRES(context,
+                dilations.size() == 4 &&
+                    std::all_of(dilations.begin(), dilations.end(),
+                                [](int32 d) { return d == 1; }),
+                errors::InvalidArgument(
+                    "Current implementation does not yet support dilations."));
+    OP_REQUIRES_OK(context, context->GetAttr("padding", &padding_));
+    float min_input;
+    float max_input;
+    OP_REQUIRES_OK(context, context->GetAttr("min_input", &min_input));
+    OP_REQUIRES_OK(context, context->GetAttr("max_input", &max_input));
+    OP_REQUIRES(context, min_input <= max_input,
+                errors::InvalidArgument(
+                    "min_input must not be larger than max_input: ", min_input,
+                    " vs ", max_input));
+    quantization_ = ChooseActivationQuantization(min_input, max_input);
+  }
+
+  void Compute(OpKernelContext* context) override {
+    // [ batch, in_rows, in_cols, in_depth ]
+    const Tensor& input = context->input(0);
+    // [ filter_rows, filter_cols, in_depth, out_depth ]
+    const Tensor& filter = context->input(1);
+    const Tensor& filter_scales = context->input(2);
+    OP_REQUIRES(context, input.dims() == 4,
+                errors::InvalidArgument("input must be 4-dimensional: ",
+                                        input.shape().DebugString()));
+    OP_REQUIRES(context, filter.dims() == 4,
+                errors::InvalidArgument("filter must be 4-dimensional: ",
+                                        filter.shape().DebugString()));
+    const int64 batch = input.dim_size(0);
+    const int64 input_rows = input.dim_size(1);
+    const int64 input_cols = input.dim_size(2);
+    const int64 in_depth = input.dim_size(3);
+    const int64 filter_rows = filter.dim_size(0);
+    const int64 filter_cols = filter.dim_size(1);
+    const int64 out_depth = filter.dim_size(3);
+    OP_REQUIRES(context, in_depth == filter.dim_size(2),
+                errors::InvalidArgument(
+                    "input and filter must have the same depth: ", in_depth,
+                    " vs ", filter.dim_size(2)));
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(filter_scales.shape()) &&
+                    filter_scales.NumElements() == out_depth,
+                errors::InvalidArgument("filter_scales must have ", out_depth,
+                                        " elements: ",
+                                        filter_scales.shape().DebugString()));
+
+    const int stride_rows = strides_[1];
+    const int stride_cols = strides_[2];
+    int64 out_rows = 0, out_cols = 0, pad_rows = 0, pad_cols = 0;
+    OP_REQUIRES_OK(context,
+                   GetWindowedOutputSize(input_rows, filter_rows, stride_rows,
+                                         padding_, &out_rows, &pad_rows));
+    OP_REQUIRES_OK(context,
+                   GetWindowedOutputSize(input_cols, filter_cols, stride_cols,
+                                         padding_, &out_cols, &pad_cols));
+    const int64 patch_size = filter_rows * filter_cols * in_depth;
+    OP_REQUIRES(context,
+                FastBoundsCheck(patch_size, kint32max) &&
+                    FastBoundsCheck(out_depth, kint32max),
+                errors::InvalidArgument("filter too large"));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, {batch, out_rows, out_cols, out_depth}, &output));
+    if (output->NumElements() == 0) return;
+    if (patch_size == 0) {
+      output->flat<float>().setZero();
+      return;
+    }
+
+    Tensor quantized_input;
+    OP_REQUIRES_OK(context, context->allocate_temp(DT_INT8, input.shape(),
+                                                   &quantized_input));
+    const float* input_data = input.flat<float>().data();
+    int8* quantized_input_data = quantized_input.flat<int8>().data();
+    for (int64 i = 0; i < input.NumElements(); ++i) {
+      quantized_input_data[i] =
+          QuantizeActivation(quantization_, input_data[i]);
+    }
+
+    // The convolution is the product of the m x patch_size matrix of the
+    // patches of the input, one per output pixel, by the patch_size x out_depth
+    // filter. A 1x1 convolution with unit strides multiplies the input itself,
+    // otherwise the patches are copied (im2col) in chunks of bounded size.
+    const int64 m = batch * out_rows * out_cols;
+    const bool is_pointwise = filter_rows == 1 && filter_cols == 1 &&
+                              stride_rows == 1 && stride_cols == 1;
+    const int64 chunk_rows =
+        is_pointwise ? m : std::max<int64>(1, kMaxChunkSize / patch_size);
+    Tensor patches;
+    if (!is_pointwise) {
+      OP_REQUIRES_OK(context,
+                     context->allocate_temp(
+                         DT_INT8, {std::min(chunk_rows, m), patch_size},
+                         &patches));
+    }
+    Tensor product;
+    OP_REQUIRES_OK(context,
+                   context->allocate_temp(
+                       DT_INT32, {std::min(chunk_rows, m), out_depth},
+                       &product));
+    const int8* filter_data =
+        reinterpret_cast<const int8*>(filter.flat<qint8>().data());
+    const float* filter_scales_data = filter_scales.flat<float>().data();
+    float* output_data = output->flat<float>().data();
+    const int8 padding_value = static_cast<int8>(quantization_.zero_point);
+
+    for (int64 chunk_start = 0; chunk_start < m; chunk_start += chunk_rows) {
+      const int64 num_rows = std::min(chunk_rows, m - chunk_start);
+      const int8* lhs = quantized_input_data + chunk_start * in_depth;
+      if (!is_pointwise) {
+        int8* patch = patches.flat<int8>().data();
+        for (int64 row = chunk_start; row < chunk_start + num_rows; ++row) {
+          const int64 out_col = row % out_cols;
+          const int64 out_row = (row / out_cols) % out_rows;
+          const int64 b = row / (out_cols * out_rows);
+          const int64 in_row_origin = out_row * stride_rows - pad_rows;
+          const int64 in_col_origin = out_col * stride_cols - pad_cols;
+          for (int64 filter_row = 0; filter_row < filter_rows; ++filter_row) {
+            const int64 in_row = in_row_origin + filter_row;
+            for (int64 filter_col = 0; filter_col < filter_cols;
+                 ++filter_col) {
+              const int64 in_col = in_col_origin + filter_col;
+              if (in_row < 0 || in_row >= input_rows || in_col < 0 ||
+                  in_col >= input_cols) {
+                std::fill(patch, patch + in_depth, padding_value);
+              } else {
+                const int8* pixel =
+                    quantized_input_data +
+                    ((b * input_rows + in_row) * input_cols + in_col) *
+                        in_depth;
+                std::copy(pixel, pixel + in_depth, patch);
+              }
+              patch += in_depth;
+            }
+          }
+        }
+        lhs = patches.flat<int8>().data();
+      }
+      Int8Gemm(context, num_rows, out_depth, patch_size, lhs,
+               quantization_.zero_point, /*transpose_b=*/false, filter_data,
+               product.flat<int32>().data());
+      Dequantize(num_rows, out_depth, product.flat<int32>().data(),
+                 quantization_.scale, filter_scales_data,
+                 output_data + chunk_start * out_depth);
+    }
+  }
+
+ private:
+  // The maximum size of the chunks of patches, in bytes.
+  static constexpr int64 kMaxChunkSize = 1024 * 1024;
+
+  std::vector<int32> strides_;
+  Padding padding_;
+  ActivationQuantization quantization_;
+};
+
+constexpr int64 QuantizedConv2DPerChannelOp::kMaxChunkSize;
+
+REGISTER_KERNEL_BUILDER(Name("_QuantizedConv2DPerChannel").Device(DEVICE_CPU),
+                        QuantizedConv2DPerChannelOp);
+
+}  // namespace tensorflow
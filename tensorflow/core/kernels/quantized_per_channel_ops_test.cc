@@ -0,0 +1,221 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+
+// The tests use activations in [min, min + 255], which quantize exactly with a
+// scale of 1, and integer weights, so that the outputs are exact.
+class QuantizedPerChannelOpsTest : public OpsTestBase {
+ protected:
+  // Returns the integers of [min, min + 255] in a pseudo-random order.
+  static std::vector<float> Activations(int size, int min) {
+    std::vector<float> result(size);
+    for (int i = 0; i < size; ++i) {
+      result[i] = min + (i * 37) % 256;
+    }
+    return result;
+  }
+
+  // Returns small integers in [-127, 127], of both signs.
+  static std::vector<qint8> Weights(int size) {
+    std::vector<qint8> result(size);
+    for (int i = 0; i < size; ++i) {
+      result[i] = (i * 23) % 255 - 127;
+    }
+    return result;
+  }
+};
+
+TEST_F(QuantizedPerChannelOpsTest, MatMul) {
+  TF_ASSERT_OK(
+      NodeDefBuilder("quantized_mat_mul_op", "_QuantizedMatMulPerChannel")
+          .Input(FakeInput(DT_FLOAT))
+          .Input(FakeInput(DT_QINT8))
+          .Input(FakeInput(DT_FLOAT))
+          .Attr("min_a", 0.0f)
+          .Attr("max_a", 255.0f)
+          .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  // A matrix is:
+  // |  1 |  2 |  3 |
+  // |  4 |  5 |  6 |
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 2, 3, 4, 5, 6});
+  // B matrix is:
+  // |  7 |  8 |  -9 |  10 |
+  // | 11 | 12 | -13 |  14 |
+  // | 15 | 16 | -17 | -18 |
+  AddInputFromArray<qint8>(TensorShape({3, 4}),
+                           {7, 8, -9, 10, 11, 12, -13, 14, 15, 16, -17, -18});
+  AddInputFromArray<float>(TensorShape({4}), {1.0f, 0.5f, 2.0f, 0.25f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_FLOAT, TensorShape({2, 4}));
+  test::FillValues<float>(&expected, {74, 40, -172, -4, 173, 94, -406, 0.5f});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(QuantizedPerChannelOpsTest, MatMulTransposed) {
+  TF_ASSERT_OK(
+      NodeDefBuilder("quantized_mat_mul_op", "_QuantizedMatMulPerChannel")
+          .Input(FakeInput(DT_FLOAT))
+          .Input(FakeInput(DT_QINT8))
+          .Input(FakeInput(DT_FLOAT))
+          .Attr("transpose_a", true)
+          .Attr("transpose_b", true)
+          .Attr("min_a", -100.0f)
+          .Attr("max_a", 155.0f)
+          .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  const int m = 5;
+  const int k = 17;
+  const int n = 3;
+  const std::vector<float> a = Activations(k * m, -100);
+  const std::vector<qint8> b = Weights(n * k);
+  const std::vector<float> b_scales = {1.0f, 0.5f, 4.0f};
+  AddInputFromArray<float>(TensorShape({k, m}), a);
+  AddInputFromArray<qint8>(TensorShape({n, k}), b);
+  AddInputFromArray<float>(TensorShape({n}), b_scales);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_FLOAT, TensorShape({m, n}));
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < n; ++j) {
+      float sum = 0;
+      for (int l = 0; l < k; ++l) {
+        sum += a[l * m + i] * b[j * k + l].value * b_scales[j];
+      }
+      expected.matrix<float>()(i, j) = sum;
+    }
+  }
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(QuantizedPerChannelOpsTest, MatMulClampsToRange) {
+  TF_ASSERT_OK(
+      NodeDefBuilder("quantized_mat_mul_op", "_QuantizedMatMulPerChannel")
+          .Input(FakeInput(DT_FLOAT))
+          .Input(FakeInput(DT_QINT8))
+          .Input(FakeInput(DT_FLOAT))
+          .Attr("min_a", 0.0f)
+          .Attr("max_a", 255.0f)
+          .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInputFromArray<float>(TensorShape({1, 2}), {-3, 1000});
+  AddInputFromArray<qint8>(TensorShape({2, 1}), {1, 1});
+  AddInputFromArray<float>(TensorShape({1}), {1.0f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_FLOAT, TensorShape({1, 1}));
+  test::FillValues<float>(&expected, {255});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+class QuantizedConv2DPerChannelTest
+    : public QuantizedPerChannelOpsTest,
+      public ::testing::WithParamInterface<std::tuple<int, int, string>> {};
+
+// Compares the convolution with a float one, for a filter size, stride and
+// padding.
+TEST_P(QuantizedConv2DPerChannelTest, Conv2D) {
+  const int filter_size = std::get<0>(GetParam());
+  const int stride = std::get<1>(GetParam());
+  const string padding = std::get<2>(GetParam());
+  TF_ASSERT_OK(
+      NodeDefBuilder("quantized_conv_op", "_QuantizedConv2DPerChannel")
+          .Input(FakeInput(DT_FLOAT))
+          .Input(FakeInput(DT_QINT8))
+          .Input(FakeInput(DT_FLOAT))
+          .Attr("strides", {1, stride, stride, 1})
+          .Attr("padding", padding)
+          .Attr("min_input", -10.0f)
+          .Attr("max_input", 245.0f)
+          .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  const int batch = 2;
+  const int rows = 5;
+  const int cols = 4;
+  const int in_depth = 3;
+  const int out_depth = 2;
+  const std::vector<float> input =
+      Activations(batch * rows * cols * in_depth, -10);
+  const std::vector<qint8> filter =
+      Weights(filter_size * filter_size * in_depth * out_depth);
+  const std::vector<float> filter_scales = {0.5f, 2.0f};
+  AddInputFromArray<float>(TensorShape({batch, rows, cols, in_depth}), input);
+  AddInputFromArray<qint8>(
+      TensorShape({filter_size, filter_size, in_depth, out_depth}), filter);
+  AddInputFromArray<float>(TensorShape({out_depth}), filter_scales);
+  TF_ASSERT_OK(RunOpKernel());
+
+  const bool same = padding == "SAME";
+  const int out_rows =
+      same ? (rows + stride - 1) / stride : (rows - filter_size) / stride + 1;
+  const int out_cols =
+      same ? (cols + stride - 1) / stride : (cols - filter_size) / stride + 1;
+  const int pad_rows =
+      same ? std::max(0, (out_rows - 1) * stride + filter_size - rows) / 2 : 0;
+  const int pad_cols =
+      same ? std::max(0, (out_cols - 1) * stride + filter_size - cols) / 2 : 0;
+  Tensor expected(DT_FLOAT,
+                  TensorShape({batch, out_rows, out_cols, out_depth}));
+  auto expected_values = expected.tensor<float, 4>();
+  for (int b = 0; b < batch; ++b) {
+    for (int out_row = 0; out_row < out_rows; ++out_row) {
+      for (int out_col = 0; out_col < out_cols; ++out_col) {
+        for (int o = 0; o < out_depth; ++o) {
+          float sum = 0;
+          for (int fr = 0; fr < filter_size; ++fr) {
+            for (int fc = 0; fc < filter_size; ++fc) {
+              const int row = out_row * stride - pad_rows + fr;
+              const int col = out_col * stride - pad_cols + fc;
+              if (row < 0 || row >= rows || col < 0 || col >= cols) continue;
+              for (int i = 0; i < in_depth; ++i) {
+                const int input_index =
+                    ((b * rows + row) * cols + col) * in_depth + i;
+                const int filter_index =
+                    ((fr * filter_size + fc) * in_depth + i) * out_depth + o;
+                sum += input[input_index] * filter[filter_index].value *
+                       filter_scales[o];
+              }
+            }
+          }
+          expected_values(b, out_row, out_col, o) = sum;
+        }
+      }
+    }
+  }
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    FiltersStridesAndPaddings, QuantizedConv2DPerChannelTest,
+    ::testing::Combine(::testing::Values(1, 3), ::testing::Values(1, 2),
+                       ::testing::Values("SAME", "VALID")));
+
+}  // namespace tensorflow
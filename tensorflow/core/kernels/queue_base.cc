@@ -316,11 +316,13 @@ void QueueBase::FlushUnlocked() {
   Ref();
   {
     mutex_lock lock(mu_);
+    BeginFlushLocked();
     bool changed;
     do {
       changed = TryAttemptLocked(kEnqueue, &clean_up);
       changed = TryAttemptLocked(kDequeue, &clean_up) || changed;
     } while (changed);
+    EndFlushLocked();
   }
   Unref();
   for (const auto& to_clean : clean_up) {
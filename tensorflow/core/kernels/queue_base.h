@@ -132,6 +132,12 @@ class QueueBase : public QueueInterface {
   // of the *_attempts_ queues.
   void FlushUnlocked();
 
+  // Called with mu_ held before and after FlushUnlocked() runs the attempts.
+  // Implementations that also touch their elements without holding mu_ use
+  // these to take exclusive ownership of them for the attempts.
+  virtual void BeginFlushLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {}
+  virtual void EndFlushLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {}
+
   ~QueueBase() override;
 
   // Helpers for implementing MatchesNodeDef().
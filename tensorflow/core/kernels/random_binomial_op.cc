@@ -418,6 +418,7 @@ class RandomBinomialOp : public OpKernel {
     // Each worker has the fudge factor for samples_per_batch, so use it here.
     OP_REQUIRES_OK(ctx, PrepareToUpdateVariable<Device, StateElementType>(
                             ctx, var_tensor, var->copy_on_read_mode.load()));
+    var->RecordAllRowsModified();
     auto var_data = var_tensor_flat.data();
     auto philox = GetPhiloxRandomFromMem(var_data);
     UpdateMemWithPhiloxRandom(
@@ -21,6 +21,7 @@ limitations under the License.
 #include <algorithm>
 #include <cmath>
 #include <memory>
+#include <type_traits>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -73,6 +74,51 @@ struct FillPhiloxRandom {
   }
 };
 
+// A generator that returns the groups of a PhiloxRandom, which it computes
+// kBatchSize at a time with PhiloxRandom::NextBatch.
+class BatchedPhiloxRandom {
+ public:
+  using ResultType = PhiloxRandom::ResultType;
+  using ResultElementType = PhiloxRandom::ResultElementType;
+  static const int kResultElementCount = PhiloxRandom::kResultElementCount;
+  static const int kElementCost = PhiloxRandom::kElementCost;
+
+  explicit BatchedPhiloxRandom(PhiloxRandom* gen)
+      : gen_(gen), next_(kBatchSize) {}
+
+  ResultType operator()() {
+    if (next_ == kBatchSize) {
+      gen_->NextBatch<kBatchSize>(batch_);
+      next_ = 0;
+    }
+    return batch_[next_++];
+  }
+
+ private:
+  static const int kBatchSize = 16;
+
+  PhiloxRandom* gen_;
+  ResultType batch_[kBatchSize];
+  int next_;
+};
+
+// BatchedDistribution<Distribution>::type is Distribution with the generator
+// BatchedPhiloxRandom, when the groups can be computed in batches: the
+// distribution has no state to carry over, and NextBatch is faster than
+// PhiloxRandom::operator(), which needs AVX2.
+template <class Distribution>
+struct BatchedDistribution {
+  static const bool kSupported = false;
+};
+
+#if defined(__AVX2__)
+template <template <class, typename> class D, typename T>
+struct BatchedDistribution<D<PhiloxRandom, T>> {
+  static const bool kSupported = std::is_empty<D<PhiloxRandom, T>>::value;
+  using type = D<BatchedPhiloxRandom, T>;
+};
+#endif
+
 // A class to fill a specified range of random groups
 template <class Distribution, bool VariableSamplesPerOutput>
 struct FillPhiloxRandomTask;
@@ -84,15 +130,26 @@ struct FillPhiloxRandomTask<Distribution, false> {
   typedef typename Distribution::ResultElementType T;
   static void Run(random::PhiloxRandom gen, T* data, int64 size,
                   int64 start_group, int64 limit_group, Distribution dist) {
+    gen.Skip(start_group);
+    // The batched generator returns the same groups as `gen`, so the results
+    // do not depend on whether the distribution supports it.
+    FillGroups(&gen, data, size, start_group, limit_group, dist,
+               std::integral_constant<
+                   bool, BatchedDistribution<Distribution>::kSupported>());
+  }
+
+ private:
+  template <class Generator, class Dist>
+  static void FillGroups(Generator* gen, T* data, int64 size,
+                         int64 start_group, int64 limit_group, Dist dist) {
     const int kGroupSize = Distribution::kResultElementCount;
 
-    gen.Skip(start_group);
     int64 offset = start_group * kGroupSize;
 
     // First fill all the full-size groups
     int64 limit_group_full = std::min(limit_group, size / kGroupSize);
     for (int64 index = start_group; index < limit_group_full; ++index) {
-      auto samples = dist(&gen);
+      auto samples = dist(gen);
       std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
       offset += kGroupSize;
     }
@@ -100,10 +157,24 @@ struct FillPhiloxRandomTask<Distribution, false> {
     // If there are any remaining elements that need to be filled, process them
     if (limit_group_full < limit_group) {
       int64 remaining_size = size - limit_group_full * kGroupSize;
-      auto samples = dist(&gen);
+      auto samples = dist(gen);
       std::copy(&samples[0], &samples[0] + remaining_size, data + offset);
     }
   }
+
+  static void FillGroups(PhiloxRandom* gen, T* data, int64 size,
+                         int64 start_group, int64 limit_group,
+                         Distribution dist, std::false_type) {
+    FillGroups(gen, data, size, start_group, limit_group, dist);
+  }
+
+  static void FillGroups(PhiloxRandom* gen, T* data, int64 size,
+                         int64 start_group, int64 limit_group,
+                         Distribution dist, std::true_type) {
+    BatchedPhiloxRandom batched_gen(gen);
+    FillGroups(&batched_gen, data, size, start_group, limit_group,
+               typename BatchedDistribution<Distribution>::type());
+  }
 };
 
 // Specialization for distribution that takes a variable number of samples for
@@ -51,6 +51,7 @@ limitations under the License.
 #define EIGEN_USE_GPU
 #endif
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -130,7 +131,7 @@ Status CopyVariable(int output_idx, OpKernelContext* ctx, const Tensor* t) {
 void ReadVariableOp::Compute(OpKernelContext* ctx) {
   core::RefCountPtr<Var> variable;
   const ResourceHandle& handle = HandleFromInput(ctx, 0);
-  const auto status = LookupResource(ctx, handle, &variable);
+  const auto status = variable_cache_.Lookup(ctx, handle, &variable);
   OP_REQUIRES(ctx, status.ok(),
               errors::FailedPrecondition(
                   "Error while reading resource variable ", handle.name(),
@@ -341,6 +342,47 @@ REGISTER_KERNEL_BUILDER(Name("VariableShape")
 
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+class VariableModifiedRowsOp : public OpKernel {
+ public:
+  explicit VariableModifiedRowsOp(OpKernelConstruction* c) : OpKernel(c) {
+    OP_REQUIRES_OK(c, c->GetAttr("reset", &reset_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<Var> variable;
+    OP_REQUIRES_OK(ctx,
+                   LookupResource(ctx, HandleFromInput(ctx, 0), &variable));
+    std::vector<int64> rows;
+    const bool all_rows = variable->GetModifiedRows(reset_, &rows);
+    Tensor* rows_output;
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_output(0, TensorShape({static_cast<int64>(
+                                                rows.size())}),
+                                        &rows_output));
+    std::copy(rows.begin(), rows.end(), rows_output->flat<int64>().data());
+    Tensor* all_rows_output;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(1, {}, &all_rows_output));
+    all_rows_output->scalar<bool>()() = all_rows;
+  }
+
+ private:
+  bool reset_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("VariableModifiedRows").Device(DEVICE_CPU),
+                        VariableModifiedRowsOp);
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+REGISTER_KERNEL_BUILDER(Name("VariableModifiedRows")
+                            .Device(DEVICE_GPU)
+                            .HostMemory("resource")
+                            .HostMemory("rows")
+                            .HostMemory("all_rows"),
+                        VariableModifiedRowsOp);
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 DestroyResourceOp::DestroyResourceOp(OpKernelConstruction* ctx)
     : OpKernel(ctx) {
   OP_REQUIRES_OK(ctx,
@@ -421,6 +463,7 @@ class AssignVariableOp : public OpKernel {
       *variable->tensor() = value;
     }
     variable->is_initialized = true;
+    variable->RecordAllRowsModified();
   }
 
  private:
@@ -474,6 +517,7 @@ class AssignVariableOp<Device, Variant> : public OpKernel {
                     DataTypeString(variable->tensor()->dtype()), " got ",
                     DataTypeString(DT_VARIANT)));
     variable->is_initialized = true;
+    variable->RecordAllRowsModified();
     *variable->tensor() = Tensor(DT_VARIANT, value.shape());
 
     if (input_alias) {
@@ -536,8 +580,9 @@ class AssignUpdateVariableOp : public OpKernel {
 
   void Compute(OpKernelContext* context) override {
     core::RefCountPtr<Var> variable;
-    OP_REQUIRES_OK(context, LookupResource(context, HandleFromInput(context, 0),
-                                           &variable));
+    OP_REQUIRES_OK(context, variable_cache_.Lookup(context,
+                                                   HandleFromInput(context, 0),
+                                                   &variable));
 
     const Tensor& value = context->input(1);
     // TODO(apassos): We could possibly avoid the copy done by
@@ -554,10 +599,14 @@ class AssignUpdateVariableOp : public OpKernel {
     OP_REQUIRES_OK(
         context, PrepareToUpdateVariable<Device, T>(
                      context, var_tensor, variable->copy_on_read_mode.load()));
+    variable->RecordAllRowsModified();
     functor::DenseUpdate<Device, T, Op> update_functor;
     update_functor(context->eigen_device<Device>(), var_tensor->flat<T>(),
                    value.flat<T>());
   }
+
+ private:
+  ResourceLookupCache<Var> variable_cache_;
 };
 
 #define REGISTER_KERNELS(type)                                     \
@@ -633,7 +682,7 @@ class ResourceGatherOp : public OpKernel {
 
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
-    OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
+    OP_REQUIRES_OK(c, variable_cache_.Lookup(c, HandleFromInput(c, 0), &v));
     OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
     // NOTE: We hold the lock for the whole gather operation instead
     // of increasing the reference count of v->tensor() to avoid a
@@ -741,6 +790,7 @@ class ResourceGatherOp : public OpKernel {
   }
 
   int32 batch_dims_ = 0;
+  ResourceLookupCache<Var> variable_cache_;
 };
 
 #define REGISTER_GATHER_FULL(dev, type, index_type)                    \
@@ -885,6 +935,7 @@ class ResourceScatterUpdateOp : public OpKernel {
     Tensor* params = v->tensor();
     const Tensor& indices = c->input(1);
     const Tensor& updates = c->input(2);
+    RecordSparseVariableUpdate<Device>(v.get(), indices);
 
     // Check that we have enough index space
     const int64 N_big = indices.NumElements();
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/resource_var.h"
 
 namespace tensorflow {
 
@@ -43,6 +44,7 @@ class ReadVariableOp : public OpKernel {
 
  private:
   DataType dtype_;
+  ResourceLookupCache<Var> variable_cache_;
 };
 
 class ReadVariablesOp : public OpKernel {
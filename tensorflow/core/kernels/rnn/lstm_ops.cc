@@ -823,6 +823,150 @@ class SliceHelper {
   const Device& device_;
 };
 
+// Runs the forward pass of BlockLSTM over the whole sequence at once, instead
+// of one LSTMBlockCellFprop per time step. Only implemented for float on CPU;
+// other devices and types leave kSupported false and use the per-step path.
+template <typename Device, typename T, GateLayout gate_layout>
+struct BlockLSTMSequenceFprop {
+  static constexpr bool kSupported = false;
+
+  void operator()(OpKernelContext* ctx, const Device& d,
+                  const float forget_bias, const float cell_clip,
+                  const bool use_peephole, const int64 seq_len_max,
+                  const Tensor& x, const Tensor& cs_prev, const Tensor& h_prev,
+                  const Tensor& w, const Tensor& wci, const Tensor& wcf,
+                  const Tensor& wco, const Tensor& b, Tensor* gates,
+                  Tensor* i_out, Tensor* cs_out, Tensor* f_out, Tensor* o_out,
+                  Tensor* ci_out, Tensor* co_out, Tensor* h_out) {}
+};
+
+// The input projections x[t] * w_x + b of all time steps don't depend on the
+// recurrence, so they are computed up front in one large GEMM into `gates`,
+// a [seq_len_max * batch_size, cell_size * 4] temporary. Each step then only
+// adds h[t - 1] * w_h, where w_h is the contiguous bottom block of w and needs
+// no repacking, and computes all gates of one batch row in a single pass
+// while its values are still in cache.
+template <GateLayout gate_layout>
+struct BlockLSTMSequenceFprop<CPUDevice, float, gate_layout> {
+  static constexpr bool kSupported = true;
+
+  void operator()(OpKernelContext* ctx, const CPUDevice& d,
+                  const float forget_bias, const float cell_clip,
+                  const bool use_peephole, const int64 seq_len_max,
+                  const Tensor& x, const Tensor& cs_prev, const Tensor& h_prev,
+                  const Tensor& w, const Tensor& wci, const Tensor& wcf,
+                  const Tensor& wco, const Tensor& b, Tensor* gates,
+                  Tensor* i_out, Tensor* cs_out, Tensor* f_out, Tensor* o_out,
+                  Tensor* ci_out, Tensor* co_out, Tensor* h_out) {
+    typedef TTypes<float>::UnalignedConstMatrix ConstMatrix;
+    typedef TTypes<float>::UnalignedMatrix Matrix;
+    typedef TTypes<float>::UnalignedConstFlat ConstFlat;
+    typedef TTypes<float>::UnalignedFlat Flat;
+
+    const int64 batch_size = x.dim_size(1);
+    const int64 input_size = x.dim_size(2);
+    const int64 cell_size = cs_prev.dim_size(1);
+    const int64 gates_size = cell_size * 4;
+    const int64 c_offset = gate_c_offset(gate_layout, cell_size);
+    const int64 f_offset = gate_f_offset(gate_layout, cell_size);
+    const int64 o_offset = cell_size * 3;
+
+    const float* w_data = w.flat<float>().data();
+    ConstMatrix w_x(w_data, input_size, gates_size);
+    ConstMatrix w_h(w_data + input_size * gates_size, cell_size, gates_size);
+    const Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1> contract_pairs{
+        Eigen::IndexPair<Eigen::DenseIndex>(1, 0)};
+
+    // gates = x * w_x + b for all steps.
+    const int64 num_rows = seq_len_max * batch_size;
+    ConstMatrix x_rows(x.flat<float>().data(), num_rows, input_size);
+    Matrix gates_rows(gates->flat<float>().data(), num_rows, gates_size);
+    const Eigen::array<Eigen::DenseIndex, 2> b_shape({1, gates_size});
+    const Eigen::array<Eigen::DenseIndex, 2> b_broadcast({num_rows, 1});
+    gates_rows.device(d) =
+        x_rows.contract(w_x, contract_pairs) +
+        b.vec<float>().reshape(b_shape).broadcast(b_broadcast);
+
+    const float* wci_data = wci.flat<float>().data();
+    const float* wcf_data = wcf.flat<float>().data();
+    const float* wco_data = wco.flat<float>().data();
+    const int64 step_size = batch_size * cell_size;
+    const Eigen::TensorOpCost cost(
+        sizeof(float) * (gates_size + cell_size * 4),  // ld bytes
+        sizeof(float) * cell_size * 7,                 // st bytes
+        cell_size * 60);                               // compute cycles
+    for (int64 t = 0; t < seq_len_max; ++t) {
+      const float* cs_prev_data = t == 0
+                                      ? cs_prev.flat<float>().data()
+                                      : cs_out->flat<float>().data() +
+                                            (t - 1) * step_size;
+      const float* h_prev_data =
+          t == 0 ? h_prev.flat<float>().data()
+                 : h_out->flat<float>().data() + (t - 1) * step_size;
+      float* gates_data =
+          gates->flat<float>().data() + t * batch_size * gates_size;
+
+      // gates[t] += h[t - 1] * w_h
+      Matrix gates_t(gates_data, batch_size, gates_size);
+      gates_t.device(d) +=
+          ConstMatrix(h_prev_data, batch_size, cell_size)
+              .contract(w_h, contract_pairs);
+
+      const int64 offset = t * step_size;
+      float* i_data = i_out->flat<float>().data() + offset;
+      float* cs_data = cs_out->flat<float>().data() + offset;
+      float* f_data = f_out->flat<float>().data() + offset;
+      float* o_data = o_out->flat<float>().data() + offset;
+      float* ci_data = ci_out->flat<float>().data() + offset;
+      float* co_data = co_out->flat<float>().data() + offset;
+      float* h_data = h_out->flat<float>().data() + offset;
+      auto compute_rows = [&](int64 start, int64 end) {
+        ConstFlat wci_row(wci_data, cell_size);
+        ConstFlat wcf_row(wcf_data, cell_size);
+        ConstFlat wco_row(wco_data, cell_size);
+        for (int64 row = start; row < end; ++row) {
+          const float* gates_row = gates_data + row * gates_size;
+          const int64 cell_row = row * cell_size;
+          ConstFlat gate_i(gates_row, cell_size);
+          ConstFlat gate_c(gates_row + c_offset, cell_size);
+          ConstFlat gate_f(gates_row + f_offset, cell_size);
+          ConstFlat gate_o(gates_row + o_offset, cell_size);
+          ConstFlat cs_prev_row(cs_prev_data + cell_row, cell_size);
+          Flat i(i_data + cell_row, cell_size);
+          Flat cs(cs_data + cell_row, cell_size);
+          Flat f(f_data + cell_row, cell_size);
+          Flat o(o_data + cell_row, cell_size);
+          Flat ci(ci_data + cell_row, cell_size);
+          Flat co(co_data + cell_row, cell_size);
+          Flat h(h_data + cell_row, cell_size);
+
+          if (use_peephole) {
+            i = (gate_i + cs_prev_row * wci_row).sigmoid();
+            f = (gate_f + forget_bias + cs_prev_row * wcf_row).sigmoid();
+          } else {
+            i = gate_i.sigmoid();
+            f = (gate_f + forget_bias).sigmoid();
+          }
+          ci = gate_c.tanh();
+          cs = i * ci + f * cs_prev_row;
+          if (cell_clip > 0.0f) {
+            cs = cs.binaryExpr(cs.constant(cell_clip),
+                               Eigen::scalar_clip_op<float>());
+          }
+          co = cs.tanh();
+          if (use_peephole) {
+            o = (gate_o + cs * wco_row).sigmoid();
+          } else {
+            o = gate_o.sigmoid();
+          }
+          h = o * co;
+        }
+      };
+      d.parallelFor(batch_size, cost, compute_rows);
+    }
+  }
+};
+
 }  // namespace
 
 template <typename Device, typename T, bool USE_CUBLAS, GateLayout gate_layout>
@@ -955,6 +1099,64 @@ class BlockLSTMOp : public OpKernel {
     Tensor* h_out;
     OP_REQUIRES_OK(ctx, ctx->allocate_output("h", batch_cell_shape, &h_out));
 
+    const Device& device = ctx->eigen_device<Device>();
+
+    const int64 seq_len_max = seq_len_max_tensor->scalar<int64>()();
+    OP_REQUIRES(ctx, seq_len_max >= 0 && seq_len_max <= timelen,
+                errors::InvalidArgument("seq_len_max must be in [0, ", timelen,
+                                        "], got ", seq_len_max));
+
+    typedef BlockLSTMSequenceFprop<Device, T, gate_layout> SequenceFprop;
+    if (SequenceFprop::kSupported) {
+      Tensor gates_tensor;
+      OP_REQUIRES_OK(ctx, ctx->allocate_temp(
+                              DataTypeToEnum<T>::v(),
+                              TensorShape({seq_len_max * batch_size,
+                                           cell_size * 4}),
+                              &gates_tensor));
+      SequenceFprop()(ctx, device, forget_bias_, cell_clip_, use_peephole_,
+                      seq_len_max, *x, *cs_prev_tensor, *h_prev_tensor,
+                      *w_tensor, *wci_tensor, *wcf_tensor, *wco_tensor,
+                      *b_tensor, &gates_tensor, i_out, cs_out, f_out, o_out,
+                      ci_out, co_out, h_out);
+    } else {
+      ComputePerStep(ctx, seq_len_max, *x, *cs_prev_tensor, *h_prev_tensor,
+                     *w_tensor, *wci_tensor, *wcf_tensor, *wco_tensor,
+                     *b_tensor, i_out, cs_out, f_out, o_out, ci_out, co_out,
+                     h_out);
+    }
+
+    if (seq_len_max < timelen) {
+      Tensor cs_tensor = cs_out->Slice(seq_len_max, timelen);
+      Tensor h_tensor = h_out->Slice(seq_len_max, timelen);
+
+      functor::TensorUnalignedZero<Device, T>()(device,
+                                                cs_tensor.unaligned_flat<T>());
+      functor::TensorUnalignedZero<Device, T>()(device,
+                                                h_tensor.unaligned_flat<T>());
+    }
+  }
+
+ private:
+  // Runs one LSTMBlockCellFprop per time step.
+  void ComputePerStep(OpKernelContext* ctx, const int64 seq_len_max,
+                      const Tensor& x, const Tensor& cs_prev,
+                      const Tensor& h_prev, const Tensor& w, const Tensor& wci,
+                      const Tensor& wcf, const Tensor& wco, const Tensor& b,
+                      Tensor* i_out, Tensor* cs_out, Tensor* f_out,
+                      Tensor* o_out, Tensor* ci_out, Tensor* co_out,
+                      Tensor* h_out) {
+    const int64 batch_size = x.dim_size(1);
+    const int64 input_size = x.dim_size(2);
+    const int64 cell_size = cs_prev.dim_size(1);
+    const Tensor* cs_prev_tensor = &cs_prev;
+    const Tensor* h_prev_tensor = &h_prev;
+    const Tensor* w_tensor = &w;
+    const Tensor* wci_tensor = &wci;
+    const Tensor* wcf_tensor = &wcf;
+    const Tensor* wco_tensor = &wco;
+    const Tensor* b_tensor = &b;
+
     Tensor xh_tensor;
     OP_REQUIRES_OK(ctx, ctx->allocate_temp(
                             DataTypeToEnum<T>::v(),
@@ -969,10 +1171,9 @@ class BlockLSTMOp : public OpKernel {
 
     const Device& device = ctx->eigen_device<Device>();
 
-    const int64 seq_len_max = seq_len_max_tensor->scalar<int64>()();
     SliceHelper<Device, T> slicer(ctx);
     for (int64 t = 0; t < seq_len_max; ++t) {
-      const Tensor x_tensor = slicer.InputSlice(*x, t, "x");
+      const Tensor x_tensor = slicer.InputSlice(x, t, "x");
       const Tensor& cs_prev_tensor2 =
           t == 0 ? *cs_prev_tensor
                  : slicer.OutputSlice(cs_out, t - 1, "cs_prev");
@@ -999,19 +1200,8 @@ class BlockLSTMOp : public OpKernel {
           gates_tensor.matrix<T>(), h_tensor.matrix<T>());
       slicer.FinishTimeStep();
     }
-
-    if (seq_len_max < timelen) {
-      Tensor cs_tensor = cs_out->Slice(seq_len_max, timelen);
-      Tensor h_tensor = h_out->Slice(seq_len_max, timelen);
-
-      functor::TensorUnalignedZero<Device, T>()(device,
-                                                cs_tensor.unaligned_flat<T>());
-      functor::TensorUnalignedZero<Device, T>()(device,
-                                                h_tensor.unaligned_flat<T>());
-    }
   }
 
- private:
   float forget_bias_;
   float cell_clip_;
   bool use_peephole_;
@@ -0,0 +1,116 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/ruy_gemm.h"
+
+#ifdef TENSORFLOW_USE_RUY_GEMM
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/lite/experimental/ruy/ruy.h"
+
+namespace tensorflow {
+
+namespace {
+
+// A ruy context owns ruy's threads and packing buffers, and cannot run two
+// multiplications at once, so each multiplication takes an idle context.
+class RuyContextPool {
+ public:
+  static RuyContextPool* Global() {
+    static RuyContextPool* pool = new RuyContextPool;
+    return pool;
+  }
+
+  std::unique_ptr<ruy::Context> Acquire() LOCKS_EXCLUDED(mu_) {
+    {
+      mutex_lock l(mu_);
+      if (!idle_.empty()) {
+        std::unique_ptr<ruy::Context> context = std::move(idle_.back());
+        idle_.pop_back();
+        return context;
+      }
+    }
+    return std::unique_ptr<ruy::Context>(new ruy::Context);
+  }
+
+  void Release(std::unique_ptr<ruy::Context> context) LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    idle_.push_back(std::move(context));
+  }
+
+ private:
+  mutex mu_;
+  std::vector<std::unique_ptr<ruy::Context>> idle_ GUARDED_BY(mu_);
+};
+
+// ruy computes column-major destinations, so this computes the column-major
+// transpose of c, op(b)^T * op(a)^T. The row-major op(b) (resp. op(a)) is the
+// column-major op(b)^T, or the row-major op(b)^T when b is transposed.
+template <typename AccumScalar, typename Scalar, typename DstScalar>
+void Multiply(int num_threads, bool transpose_a, bool transpose_b, int m,
+              int n, int k, const Scalar* a, Scalar a_zero_point,
+              const Scalar* b, Scalar b_zero_point, DstScalar* c) {
+  ruy::Matrix<Scalar> lhs;
+  ruy::MakeSimpleLayout(
+      n, k, transpose_b ? ruy::Order::kRowMajor : ruy::Order::kColMajor,
+      &lhs.layout);
+  lhs.data = b;
+  lhs.zero_point = b_zero_point;
+  ruy::Matrix<Scalar> rhs;
+  ruy::MakeSimpleLayout(
+      k, m, transpose_a ? ruy::Order::kRowMajor : ruy::Order::kColMajor,
+      &rhs.layout);
+  rhs.data = a;
+  rhs.zero_point = a_zero_point;
+  ruy::Matrix<DstScalar> dst;
+  ruy::MakeSimpleLayout(n, m, ruy::Order::kColMajor, &dst.layout);
+  dst.data = c;
+
+  ruy::BasicSpec<AccumScalar, DstScalar> spec;
+  std::unique_ptr<ruy::Context> context = RuyContextPool::Global()->Acquire();
+  context->max_num_threads = num_threads;
+  ruy::Mul<ruy::kAllPaths>(lhs, rhs, spec, context.get(), &dst);
+  RuyContextPool::Global()->Release(std::move(context));
+}
+
+}  // namespace
+
+void RuyGemm(int num_threads, bool transpose_a, bool transpose_b, int m, int n,
+             int k, const float* a, const float* b, float* c) {
+  Multiply<float>(num_threads, transpose_a, transpose_b, m, n, k, a, 0.0f, b,
+                  0.0f, c);
+}
+
+void RuyGemm(int num_threads, bool transpose_a, bool transpose_b, int m, int n,
+             int k, const uint8* a, uint8 a_zero_point, const uint8* b,
+             uint8 b_zero_point, int32* c) {
+  Multiply<int32>(num_threads, transpose_a, transpose_b, m, n, k, a,
+                  a_zero_point, b, b_zero_point, c);
+}
+
+void RuyGemm(int num_threads, bool transpose_a, bool transpose_b, int m, int n,
+             int k, const int8* a, int8 a_zero_point, const int8* b,
+             int8 b_zero_point, int32* c) {
+  Multiply<int32>(num_threads, transpose_a, transpose_b, m, n, k, a,
+                  a_zero_point, b, b_zero_point, c);
+}
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_USE_RUY_GEMM
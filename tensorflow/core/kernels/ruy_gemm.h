@@ -0,0 +1,49 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_RUY_GEMM_H_
+#define TENSORFLOW_CORE_KERNELS_RUY_GEMM_H_
+
+#include "tensorflow/core/platform/types.h"
+
+// Builds with "--define tensorflow_ruy=1" define TENSORFLOW_USE_RUY_GEMM, and
+// multiply matrices on CPU with ruy (tensorflow/lite/experimental/ruy) rather
+// than Eigen or gemmlowp, for the types below.
+
+#ifdef TENSORFLOW_USE_RUY_GEMM
+
+namespace tensorflow {
+
+// Computes c = op(a) * op(b) with ruy, on up to `num_threads` threads, where
+// op(a) is m x k, op(b) is k x n, op(x) transposes x if `transpose_x`, and all
+// the matrices are row major.
+void RuyGemm(int num_threads, bool transpose_a, bool transpose_b, int m, int n,
+             int k, const float* a, const float* b, float* c);
+
+// As above, for the products of `a` minus `a_zero_point` and `b` minus
+// `b_zero_point`, accumulated in 32 bits. The zero points must not both be
+// the lowest value of the type, i.e. 0 for uint8 and -128 for int8.
+void RuyGemm(int num_threads, bool transpose_a, bool transpose_b, int m, int n,
+             int k, const uint8* a, uint8 a_zero_point, const uint8* b,
+             uint8 b_zero_point, int32* c);
+void RuyGemm(int num_threads, bool transpose_a, bool transpose_b, int m, int n,
+             int k, const int8* a, int8 a_zero_point, const int8* b,
+             int8 b_zero_point, int32* c);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_USE_RUY_GEMM
+
+#endif  // TENSORFLOW_CORE_KERNELS_RUY_GEMM_H_
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/kernels/save_restore_tensor.h"
+#include <algorithm>
 #include <numeric>
 #include <unordered_map>
 #include <utility>
@@ -29,7 +30,9 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -237,6 +240,49 @@ namespace {
 // Tensors larger than this threshold will be restored from a thread-pool.
 const int64 kLargeShapeThreshold = 16 << 20;  // 16M
 
+// The default number of threads restoring tensors in parallel.
+const int64 kDefaultNumRestoreThreads = 8;
+
+// Returns the number of threads restoring tensors in parallel, which can be
+// set with the TF_RESTORE_V2_NUM_THREADS environment variable, e.g. to read
+// more data files at once from high-latency storage.
+int64 NumRestoreThreads() {
+  static const int64 num_threads = [] {
+    int64 num_threads;
+    Status s = ReadInt64FromEnvVar("TF_RESTORE_V2_NUM_THREADS",
+                                   kDefaultNumRestoreThreads, &num_threads);
+    if (!s.ok() || num_threads < 1) {
+      LOG(WARNING) << "Ignoring invalid TF_RESTORE_V2_NUM_THREADS: "
+                   << s.error_message();
+      num_threads = kDefaultNumRestoreThreads;
+    }
+    return num_threads;
+  }();
+  return num_threads;
+}
+
+// Returns true if RestoreV2 aliases full tensors to the memory-mapped data
+// files where possible, instead of reading them into memory, which is enabled
+// by setting the TF_RESTORE_V2_MEMORY_MAP environment variable to true.  The
+// pages of such tensors are then read on first access, e.g. by the lookups of
+// a large embedding, so that restoring them is nearly free and their resident
+// memory follows the rows in use.  As the mapped tensors are read-only,
+// variables restored from them copy them on their first update.
+bool MapRestoredTensors() {
+  static const bool map_tensors = [] {
+    bool map_tensors;
+    Status s = ReadBoolFromEnvVar("TF_RESTORE_V2_MEMORY_MAP",
+                                  /*default_val=*/false, &map_tensors);
+    if (!s.ok()) {
+      LOG(WARNING) << "Ignoring invalid TF_RESTORE_V2_MEMORY_MAP: "
+                   << s.error_message();
+      map_tensors = false;
+    }
+    return map_tensors;
+  }();
+  return map_tensors;
+}
+
 // A restore operation for a single tensor.  Small tensors may be restored
 // directly from the op thread to improve read locality.  Large tensors can be
 // restored from a thread pool: this requires creating a separate BundleReader
@@ -275,6 +321,16 @@ struct RestoreOp {
             << restored_full_shape.num_elements();
     Tensor* restored_tensor;
     if (shape_and_slice.empty()) {
+      if (MapRestoredTensors()) {
+        Tensor mapped_tensor;
+        bool mapped = false;
+        TF_RETURN_IF_ERROR(
+            reader->LookupMapped(tensor_name, &mapped_tensor, &mapped));
+        if (mapped) {
+          context->set_output(idx, mapped_tensor);
+          return Status::OK();
+        }
+      }
       // Lookup the full tensor.
       TF_RETURN_IF_ERROR(
           context->allocate_output(idx, restored_full_shape, &restored_tensor));
@@ -313,6 +369,19 @@ struct RestoreOp {
   ::tensorflow::Status status;
 };
 
+// A batch of restore operations run one after the other by a single thread,
+// with its own BundleReader.
+struct RestoreTask {
+  void run_with_new_reader() {
+    BundleReader reader(Env::Default(), ops.front()->reader_prefix);
+    for (RestoreOp* op : ops) {
+      op->status = reader.status().ok() ? op->run(&reader) : reader.status();
+    }
+  }
+
+  std::vector<RestoreOp*> ops;
+};
+
 }  // namespace
 
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
@@ -332,9 +401,6 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
               return tensor_names_flat(a) < tensor_names_flat(b);
             });
 
-  std::vector<std::unique_ptr<RestoreOp> > pool_restore_ops;
-  std::vector<std::unique_ptr<RestoreOp> > direct_restore_ops;
-
   BundleReader default_reader(Env::Default(), prefix_string);
   TF_RETURN_IF_ERROR(default_reader.status());
 
@@ -358,38 +424,53 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     return errors::InvalidArgument(error_msg);
   }
 
+  // Large tensors are each restored by a separate task. Small tensors are
+  // restored by one task per data file, in key order, so that each file is
+  // read sequentially while the files are read in parallel.
+  std::vector<std::unique_ptr<RestoreOp> > restore_ops;
+  std::vector<RestoreTask> tasks;
+  std::unordered_map<int32, size_t> task_of_shard;
   for (auto i : sorted_name_idx) {
     const string& tensor_name = tensor_names_flat(i);
     const string& shape_and_slice = shape_and_slices_flat(i);
     auto op =
         new RestoreOp{context, i, tensor_name, shape_and_slice, prefix_string};
+    restore_ops.emplace_back(op);
     if (op->should_run_in_pool(&default_reader)) {
-      pool_restore_ops.emplace_back(op);
+      tasks.push_back(RestoreTask{{op}});
+      continue;
+    }
+    int32 shard_id = -1;
+    // Ignore status here; we'll catch the error later.
+    default_reader.LookupDataShard(tensor_name, &shard_id).IgnoreError();
+    auto it = task_of_shard.find(shard_id);
+    if (it == task_of_shard.end()) {
+      task_of_shard.emplace(shard_id, tasks.size());
+      tasks.push_back(RestoreTask{{op}});
     } else {
-      direct_restore_ops.emplace_back(op);
+      tasks[it->second].ops.push_back(op);
     }
   }
 
-  {
-    // Schedule any threaded operations first, skipping thread pool creation if
-    // we don't have any expensive operations.
-    std::unique_ptr<thread::ThreadPool> reader_pool;
-    if (!pool_restore_ops.empty()) {
-      reader_pool.reset(
-          new thread::ThreadPool(Env::Default(), "restore_tensors", 8));
-      for (auto& op : pool_restore_ops) {
-        reader_pool->Schedule([&op]() { op->run_with_new_reader(); });
-      }
-    }
-
-    // Read small tensors from the op thread
-    for (auto& op : direct_restore_ops) {
+  if (tasks.size() == 1 && task_of_shard.size() == 1) {
+    // Read small tensors from the op thread, skipping thread pool creation if
+    // they are all in the same data file.
+    for (RestoreOp* op : tasks.front().ops) {
       TF_RETURN_IF_ERROR(op->run(&default_reader));
     }
+  } else if (!tasks.empty()) {
+    const int num_threads =
+        std::min<int64>(NumRestoreThreads(), tasks.size());
+    // The pool shuts down when it goes out of scope, after all the tasks ran.
+    thread::ThreadPool reader_pool(Env::Default(), "restore_tensors",
+                                   num_threads);
+    for (auto& task : tasks) {
+      reader_pool.Schedule([&task]() { task.run_with_new_reader(); });
+    }
   }
 
-  // Check status of pool ops; this must come after the pool shuts down.
-  for (auto& op : pool_restore_ops) {
+  // Check status of the restore ops, in key order.
+  for (auto& op : restore_ops) {
     TF_RETURN_IF_ERROR(op->status);
   }
 
@@ -406,4 +487,103 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   return Status::OK();
 }
 
+namespace {
+
+// The number of threads writing checkpoints in the background.
+const int kNumCheckpointWriteThreads = 4;
+
+// The background writes of a checkpoint prefix.
+struct CheckpointWrite {
+  bool pending = false;
+  // The status of the last write, once it is no longer pending.
+  Status status;
+  std::vector<std::function<void(const Status&)>> callbacks;
+};
+
+struct CheckpointWrites {
+  mutex mu;
+  // Notified whenever a write completes.
+  condition_variable cv;
+  // Only holds the prefixes whose last write is pending or failed.
+  std::unordered_map<string, CheckpointWrite> writes GUARDED_BY(mu);
+  thread::ThreadPool pool{Env::Default(), "checkpoint_writes",
+                          kNumCheckpointWriteThreads};
+};
+
+CheckpointWrites* GetCheckpointWrites() {
+  static CheckpointWrites* writes = new CheckpointWrites;
+  return writes;
+}
+
+}  // namespace
+
+void ScheduleCheckpointWrite(const string& prefix,
+                             std::function<Status()> write) {
+  CheckpointWrites* writes = GetCheckpointWrites();
+  {
+    mutex_lock l(writes->mu);
+    while (writes->writes[prefix].pending) {
+      writes->cv.wait(l);
+    }
+    CheckpointWrite& w = writes->writes[prefix];
+    w.pending = true;
+    w.status = Status::OK();
+  }
+  writes->pool.Schedule([writes, prefix, write]() {
+    const Status s = write();
+    if (!s.ok()) {
+      LOG(ERROR) << "Failed to write checkpoint " << prefix << ": " << s;
+    }
+    std::vector<std::function<void(const Status&)>> callbacks;
+    {
+      mutex_lock l(writes->mu);
+      auto it = writes->writes.find(prefix);
+      callbacks.swap(it->second.callbacks);
+      if (s.ok()) {
+        writes->writes.erase(it);
+      } else {
+        it->second.pending = false;
+        it->second.status = s;
+      }
+    }
+    writes->cv.notify_all();
+    for (const auto& done : callbacks) {
+      done(s);
+    }
+  });
+}
+
+void OnCheckpointWritten(const string& prefix,
+                         std::function<void(const Status&)> done) {
+  CheckpointWrites* writes = GetCheckpointWrites();
+  Status s;
+  {
+    mutex_lock l(writes->mu);
+    auto it = writes->writes.find(prefix);
+    if (it != writes->writes.end()) {
+      if (it->second.pending) {
+        it->second.callbacks.push_back(std::move(done));
+        return;
+      }
+      s = it->second.status;
+    }
+  }
+  done(s);
+}
+
+Status WaitForCheckpointWrite(const string& prefix) {
+  CheckpointWrites* writes = GetCheckpointWrites();
+  mutex_lock l(writes->mu);
+  while (true) {
+    auto it = writes->writes.find(prefix);
+    if (it == writes->writes.end()) {
+      return Status::OK();
+    }
+    if (!it->second.pending) {
+      return it->second.status;
+    }
+    writes->cv.wait(l);
+  }
+}
+
 }  // namespace tensorflow
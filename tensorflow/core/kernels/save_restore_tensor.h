@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_SAVE_RESTORE_TENSOR_H_
 #define TENSORFLOW_CORE_KERNELS_SAVE_RESTORE_TENSOR_H_
 
+#include <functional>
+
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_writer.h"
 
@@ -68,6 +70,23 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                         const Tensor& shape_and_slices,
                         gtl::ArraySlice<DataType> dtypes);
 
+// Runs "write", which writes the V2 checkpoint "prefix", in a background
+// thread.  Blocks while a previous write of "prefix" is pending, so that the
+// writes of the same prefix complete in order.  Failures are logged, and
+// reported by the functions below.
+void ScheduleCheckpointWrite(const string& prefix,
+                             std::function<Status()> write);
+
+// Calls "done" with the status of the background write of "prefix" once it
+// completes, or right away if there is none.  The status of the last write is
+// reported until the next write of "prefix" starts, if it failed.
+void OnCheckpointWritten(const string& prefix,
+                         std::function<void(const Status&)> done);
+
+// Blocks until the background write of "prefix", if any, completes, and
+// returns its status like OnCheckpointWritten().
+Status WaitForCheckpointWrite(const string& prefix);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_KERNELS_SAVE_RESTORE_TENSOR_H_
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/save_restore_tensor.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -85,12 +86,46 @@ void ValidateInputs(bool is_save_op, OpKernelContext* context,
   }
 }
 
+// A tensor to save, with its parsed shape and slice specification.
+struct TensorToSave {
+  string name;
+  Tensor tensor;
+  bool is_slice = false;
+  TensorShape full_shape;
+  TensorSlice slice;
+};
+
+// Writes "tensors" to the V2 checkpoint "prefix".
+Status WriteTensors(const string& prefix,
+                    const std::vector<TensorToSave>& tensors) {
+  // Aligns the tensor data, so that RestoreV2 can alias it to the mapped data
+  // files (see TF_RESTORE_V2_MEMORY_MAP), at the cost of a few bytes of
+  // padding per tensor.
+  BundleWriter::Options options;
+  options.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+  BundleWriter writer(Env::Default(), prefix, options);
+  TF_RETURN_IF_ERROR(writer.status());
+  VLOG(1) << "BundleWriter, prefix_string: " << prefix;
+
+  for (const TensorToSave& t : tensors) {
+    if (t.is_slice) {
+      TF_RETURN_IF_ERROR(
+          writer.AddSlice(t.name, t.full_shape, t.slice, t.tensor));
+    } else {
+      TF_RETURN_IF_ERROR(writer.Add(t.name, t.tensor));
+    }
+  }
+  return writer.Finish();
+}
+
 }  // namespace
 
 // Saves a list of named tensors using the tensor bundle library.
 class SaveV2 : public OpKernel {
  public:
-  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {}
+  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("async_write", &async_write_));
+  }
 
   void Compute(OpKernelContext* context) override {
     const Tensor& prefix = context->input(0);
@@ -105,39 +140,122 @@ class SaveV2 : public OpKernel {
     const auto& tensor_names_flat = tensor_names.flat<tstring>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
-    OP_REQUIRES_OK(context, writer.status());
-    VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
-
+    std::vector<TensorToSave> tensors(num_tensors);
     for (int i = 0; i < num_tensors; ++i) {
-      const string& tensor_name = tensor_names_flat(i);
+      TensorToSave& t = tensors[i];
+      t.name = tensor_names_flat(i);
       const Tensor& tensor = context->input(i + kFixedInputs);
 
       if (!shape_and_slices_flat(i).empty()) {
         const string& shape_spec = shape_and_slices_flat(i);
-        TensorShape shape;
-        TensorSlice slice(tensor.dims());
+        t.is_slice = true;
+        t.slice = TensorSlice(tensor.dims());
         TensorShape slice_shape;
 
-        OP_REQUIRES_OK(context, checkpoint::ParseShapeAndSlice(
-                                    shape_spec, &shape, &slice, &slice_shape));
+        OP_REQUIRES_OK(context,
+                       checkpoint::ParseShapeAndSlice(shape_spec, &t.full_shape,
+                                                      &t.slice, &slice_shape));
         OP_REQUIRES(context, slice_shape.IsSameSize(tensor.shape()),
                     errors::InvalidArgument("Slice in shape_and_slice "
                                             "specification does not match the "
                                             "shape of the tensor to  save: ",
                                             shape_spec, ", tensor: ",
                                             tensor.shape().DebugString()));
+      }
+      // The inputs of a background write are copied, as they may alias
+      // variables that are updated in place by the next training steps.
+      t.tensor = async_write_ ? tensor::DeepCopy(tensor) : tensor;
+    }
+
+    if (async_write_) {
+      ScheduleCheckpointWrite(
+          prefix_string,
+          [prefix_string, tensors]() {
+            return WriteTensors(prefix_string, tensors);
+          });
+    } else {
+      // Keeps a pending background write from replacing this checkpoint.
+      WaitForCheckpointWrite(prefix_string).IgnoreError();
+      OP_REQUIRES_OK(context, WriteTensors(prefix_string, tensors));
+    }
+  }
+
+ private:
+  // Whether to write the checkpoint in the background.
+  bool async_write_;
+};
+REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
+
+// Saves the rows of variables modified since a base checkpoint was written
+// (see VariableModifiedRows) as a delta bundle against that checkpoint.
+class SaveDeltaV2 : public OpKernel {
+ public:
+  explicit SaveDeltaV2(OpKernelConstruction* context) : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& prefix = context->input(0);
+    const Tensor& base_prefix = context->input(1);
+    const Tensor& tensor_names = context->input(2);
+    const Tensor& all_rows = context->input(3);
+    OpInputList rows;
+    OP_REQUIRES_OK(context, context->input_list("rows", &rows));
+    OpInputList tensors;
+    OP_REQUIRES_OK(context, context->input_list("tensors", &tensors));
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsScalar(prefix.shape()) &&
+                    TensorShapeUtils::IsScalar(base_prefix.shape()),
+                errors::InvalidArgument(
+                    "Inputs prefix and base_prefix should be scalars, got ",
+                    prefix.shape().DebugString(), " and ",
+                    base_prefix.shape().DebugString(), " instead."));
+    const int num_tensors = rows.size();
+    OP_REQUIRES(context,
+                tensor_names.NumElements() == num_tensors &&
+                    all_rows.NumElements() == num_tensors &&
+                    tensors.size() == num_tensors,
+                errors::InvalidArgument(
+                    "Expected ", num_tensors, " tensor names, all_rows flags "
+                    "and tensors, got ", tensor_names.NumElements(), ", ",
+                    all_rows.NumElements(), " and ", tensors.size()));
 
+    const string& prefix_string = prefix.scalar<tstring>()();
+    const string& base_prefix_string = base_prefix.scalar<tstring>()();
+    OP_REQUIRES(context, !base_prefix_string.empty(),
+                errors::InvalidArgument("Input base_prefix is empty"));
+    // The base checkpoint must be complete before it is referenced.
+    StringPiece scheme, host, path;
+    io::ParseURI(base_prefix_string, &scheme, &host, &path);
+    const string resolved_base_prefix =
+        scheme.empty() && !io::IsAbsolutePath(base_prefix_string)
+            ? io::JoinPath(io::Dirname(prefix_string), base_prefix_string)
+            : base_prefix_string;
+    OP_REQUIRES_OK(context, WaitForCheckpointWrite(resolved_base_prefix));
+    WaitForCheckpointWrite(prefix_string).IgnoreError();
+
+    BundleWriter::Options options;
+    options.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    options.base_prefix = base_prefix_string;
+    BundleWriter writer(Env::Default(), prefix_string, options);
+    OP_REQUIRES_OK(context, writer.status());
+    const auto& tensor_names_flat = tensor_names.flat<tstring>();
+    const auto& all_rows_flat = all_rows.flat<bool>();
+    for (int i = 0; i < num_tensors; ++i) {
+      if (all_rows_flat(i)) {
+        OP_REQUIRES_OK(context, writer.Add(tensor_names_flat(i), tensors[i]));
+      } else if (rows[i].NumElements() > 0) {
+        // Tensors without modified rows, which may be scalars, are entirely
+        // read from the base checkpoint.
+        const auto& rows_flat = rows[i].flat<int64>();
         OP_REQUIRES_OK(context,
-                       writer.AddSlice(tensor_name, shape, slice, tensor));
-      } else {
-        OP_REQUIRES_OK(context, writer.Add(tensor_name, tensor));
+                       writer.AddRows(tensor_names_flat(i), tensors[i],
+                                      gtl::ArraySlice<int64>(
+                                          rows_flat.data(), rows_flat.size())));
       }
     }
     OP_REQUIRES_OK(context, writer.Finish());
   }
 };
-REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
+REGISTER_KERNEL_BUILDER(Name("SaveDeltaV2").Device(DEVICE_CPU), SaveDeltaV2);
 
 // Restores a list of named tensors from a tensor bundle (V2 checkpoint format).
 class RestoreV2 : public OpKernel {
@@ -158,6 +276,7 @@ class RestoreV2 : public OpKernel {
                    shape_and_slices);
 
     const string& prefix_string = prefix.scalar<tstring>()();
+    OP_REQUIRES_OK(context, WaitForCheckpointWrite(prefix_string));
 
     // Intention: we plan to use the RestoreV2 op as a backward-compatible
     // reader as we upgrade to the V2 format.  This allows transparent upgrade.
@@ -216,6 +335,9 @@ class MergeV2Checkpoints : public OpKernel {
         gtl::ArraySlice<tstring>(checkpoint_prefixes.flat<tstring>());
     Env* env = Env::Default();
     const string& merged_prefix = destination_prefix.scalar<tstring>()();
+    for (const string& input_prefix : input_prefixes) {
+      OP_REQUIRES_OK(context, WaitForCheckpointWrite(input_prefix));
+    }
     OP_REQUIRES_OK(
         context, tensorflow::MergeBundles(env, input_prefixes, merged_prefix));
 
@@ -19,10 +19,13 @@ limitations under the License.
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/save_restore_tensor.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/env.h"
@@ -339,5 +342,120 @@ TEST_F(SaveV2OpTest, Simple) {
   }
 }
 
+class AsyncSaveV2OpTest : public OpsTestBase {
+ protected:
+  void MakeOp() {
+    TF_ASSERT_OK(NodeDefBuilder("myop", "SaveV2")
+                     .Input(FakeInput())  // prefix
+                     .Input(FakeInput())  // tensor_names
+                     .Input(FakeInput())  // shape_and_slices
+                     .Input(FakeInput({DT_INT32, DT_FLOAT}))  // tensors
+                     .Attr("async_write", true)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(AsyncSaveV2OpTest, WritesSnapshotInBackground) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "tensor_async");
+  MakeOp();
+  AddInputFromArray<tstring>(TensorShape({}), {prefix});
+  AddInputFromArray<tstring>(TensorShape({2}), {"tensor_int", "tensor_float"});
+  AddInputFromArray<tstring>(TensorShape({2}), {"", "4 0,2"});
+  AddInputFromArray<int32>(TensorShape({3}), {1, 2, 3});
+  AddInputFromArray<float>(TensorShape({2}), {0.5f, 1.5f});
+  TF_ASSERT_OK(RunOpKernel());
+  // Updating the inputs in place does not change what is saved.
+  mutable_input(3).tensor->flat<int32>().setZero();
+
+  Notification written;
+  OnCheckpointWritten(prefix, [&written](const Status& s) {
+    TF_EXPECT_OK(s);
+    written.Notify();
+  });
+  TF_ASSERT_OK(WaitForCheckpointWrite(prefix));
+  written.WaitForNotification();
+
+  BundleReader reader(Env::Default(), prefix);
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  TF_ASSERT_OK(reader.Lookup("tensor_int", &val));
+  test::ExpectTensorEqual<int32>(
+      val, test::AsTensor<int32>({1, 2, 3}, TensorShape({3})));
+  TensorShape shape;
+  TF_ASSERT_OK(reader.LookupTensorShape("tensor_float", &shape));
+  EXPECT_EQ(shape, TensorShape({4}));
+}
+
+TEST_F(AsyncSaveV2OpTest, ReportsFailedWrite) {
+  // The prefix cannot be written, as its parent is a file.
+  const string file = io::JoinPath(testing::TmpDir(), "async_file");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), file, "contents"));
+  const string prefix = io::JoinPath(file, "ckpt");
+  MakeOp();
+  AddInputFromArray<tstring>(TensorShape({}), {prefix});
+  AddInputFromArray<tstring>(TensorShape({2}), {"tensor_int", "tensor_float"});
+  AddInputFromArray<tstring>(TensorShape({2}), {"", ""});
+  AddInputFromArray<int32>(TensorShape({1}), {1});
+  AddInputFromArray<float>(TensorShape({1}), {0.5f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  EXPECT_FALSE(WaitForCheckpointWrite(prefix).ok());
+  // The error is reported until the next write of the prefix.
+  Notification written;
+  OnCheckpointWritten(prefix, [&written](const Status& s) {
+    EXPECT_FALSE(s.ok());
+    written.Notify();
+  });
+  written.WaitForNotification();
+}
+
+class SaveDeltaV2OpTest : public OpsTestBase {
+ protected:
+  void MakeOp() {
+    TF_ASSERT_OK(NodeDefBuilder("myop", "SaveDeltaV2")
+                     .Input(FakeInput())                      // prefix
+                     .Input(FakeInput())                      // base_prefix
+                     .Input(FakeInput())                      // tensor_names
+                     .Input(FakeInput())                      // all_rows
+                     .Input(FakeInput(2))                     // rows
+                     .Input(FakeInput({DT_FLOAT, DT_INT32}))  // tensors
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(SaveDeltaV2OpTest, SavesModifiedRows) {
+  const string base_prefix = io::JoinPath(testing::TmpDir(), "delta_base");
+  {
+    BundleWriter writer(Env::Default(), base_prefix);
+    TF_ASSERT_OK(writer.Add(
+        "matrix", test::AsTensor<float>({0, 1, 2, 3, 4, 5}, {3, 2})));
+    TF_ASSERT_OK(writer.Add("scalar", test::AsScalar<int32>(7)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  const string prefix = io::JoinPath(testing::TmpDir(), "delta");
+  MakeOp();
+  AddInputFromArray<tstring>(TensorShape({}), {prefix});
+  AddInputFromArray<tstring>(TensorShape({}), {"delta_base"});
+  AddInputFromArray<tstring>(TensorShape({2}), {"matrix", "scalar"});
+  AddInputFromArray<bool>(TensorShape({2}), {false, true});
+  AddInputFromArray<int64>(TensorShape({1}), {1});
+  AddInputFromArray<int64>(TensorShape({0}), {});
+  AddInputFromArray<float>(TensorShape({3, 2}), {0, 0, 12, 13, 0, 0});
+  AddInputFromArray<int32>(TensorShape({}), {8});
+  TF_ASSERT_OK(RunOpKernel());
+
+  BundleReader reader(Env::Default(), prefix);
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  TF_ASSERT_OK(reader.Lookup("matrix", &val));
+  test::ExpectTensorEqual<float>(
+      val, test::AsTensor<float>({0, 1, 12, 13, 4, 5}, TensorShape({3, 2})));
+  TF_ASSERT_OK(reader.Lookup("scalar", &val));
+  test::ExpectTensorEqual<int32>(val, test::AsScalar<int32>(8));
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -119,7 +119,13 @@ class ScopedAllocatorConcatOp : public OpKernel {
                                         shape_.num_elements()));
     Tensor output(dtype_);
     if (reshape_) {
-      CHECK(output.CopyFrom(backing_tensor, shape_));
+      // The backing tensor may be longer than shape_ by the alignment padding
+      // of its last field.
+      const Tensor backing_prefix =
+          backing_tensor.NumElements() == shape_.num_elements()
+              ? backing_tensor
+              : backing_tensor.Slice(0, shape_.num_elements());
+      CHECK(output.CopyFrom(backing_prefix, shape_));
     } else {
       CHECK(output.CopyFrom(backing_tensor, backing_tensor.shape()));
     }
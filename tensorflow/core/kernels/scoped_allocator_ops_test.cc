@@ -183,10 +183,10 @@ class ScopedAllocatorConcatOpTest : public OpsTestBase {
     const Tensor& output = *(output_list[0]);
     CHECK_EQ(DMAHelper::base(&input), DMAHelper::base(&output));
     CHECK_EQ(input.dtype(), output.dtype());
-    CHECK_EQ(input.NumElements(), output.NumElements());
     if (reshape_) {
       CHECK_EQ(shape_, output.shape());
     } else {
+      CHECK_EQ(input.NumElements(), output.NumElements());
       TensorShape expected_shape({input.NumElements()});
       CHECK_EQ(expected_shape, output.shape());
     }
@@ -218,13 +218,18 @@ TEST_F(ScopedAllocatorConcatOpTest, Success3) {
 TEST_F(ScopedAllocatorConcatOpTest, Reshape) {
   MakeOp({2, 2, 4}, DT_DOUBLE, true, "test", 120, 2);
 
-  // The elements of the third parameter to ExecOp must be multiples of
-  // Allocator::kAllocatorAlignment in size.  If they are not, the backing
-  // tensor allocated by PrepOp will have too many elements and reshaping
-  // will fail.
   ExecOp(DT_DOUBLE, 120, {{2, 4}, {2, 4}});
 }
 
+TEST_F(ScopedAllocatorConcatOpTest, ReshapePaddedBacking) {
+  MakeOp({11}, DT_DOUBLE, true, "test", 120, 2);
+
+  // The last field is not a multiple of Allocator::kAllocatorAlignment in
+  // size, so the backing tensor allocated by PrepOp has 16 elements, and the
+  // output is a reshape of its first 11.
+  ExecOp(DT_DOUBLE, 120, {{8}, {3}});
+}
+
 TEST_F(ScopedAllocatorConcatOpTest, NoReshapeAttr) {
   BuildNodeDef({3, 4, 4}, DT_HALF, "test", 120, 3);
   TF_EXPECT_OK(InitOp());
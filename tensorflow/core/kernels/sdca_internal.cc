@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sdca_internal.h"
 
+#include <atomic>
 #include <limits>
 #include <numeric>
 #include <random>
@@ -36,59 +37,74 @@ namespace sdca {
 using UnalignedFloatVector = TTypes<const float>::UnalignedConstVec;
 using UnalignedInt64Vector = TTypes<const int64>::UnalignedConstVec;
 
+namespace {
+
+// Adds `value` to `*delta`, with an atomic compare-and-swap if `atomic` is
+// true. The sum is computed in the type of `value`.
+template <typename T>
+inline void AddToDelta(const T value, const bool atomic, float* const delta) {
+  if (!atomic) {
+    *delta += value;
+    return;
+  }
+  static_assert(sizeof(std::atomic<float>) == sizeof(float),
+                "std::atomic<float> must have the layout of a float");
+  std::atomic<float>* const atomic_delta =
+      reinterpret_cast<std::atomic<float>*>(delta);
+  float expected = atomic_delta->load(std::memory_order_relaxed);
+  while (!atomic_delta->compare_exchange_weak(
+      expected, static_cast<float>(expected + value),
+      std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace
+
 void FeatureWeightsDenseStorage::UpdateDenseDeltaWeights(
-    const Eigen::ThreadPoolDevice& device,
     const Example::DenseVector& dense_vector,
-    const std::vector<double>& normalized_bounded_dual_delta) {
-  const size_t num_weight_vectors = normalized_bounded_dual_delta.size();
-  if (num_weight_vectors == 1) {
-    deltas_.device(device) =
-        deltas_ + dense_vector.RowAsMatrix() *
-                      deltas_.constant(normalized_bounded_dual_delta[0]);
-  } else {
-    // Transform the dual vector into a column matrix.
-    const Eigen::TensorMap<Eigen::Tensor<const double, 2, Eigen::RowMajor>>
-        dual_matrix(normalized_bounded_dual_delta.data(), num_weight_vectors,
-                    1);
-    const Eigen::array<Eigen::IndexPair<int>, 1> product_dims = {
-        Eigen::IndexPair<int>(1, 0)};
+    const std::vector<double>& normalized_bounded_dual_delta,
+    const bool atomic_updates) {
+  const auto row = dense_vector.Row();
+  for (size_t l = 0; l < normalized_bounded_dual_delta.size(); ++l) {
     // This computes delta_w += delta_vector / \lamdba * N.
-    deltas_.device(device) =
-        (deltas_.cast<double>() +
-         dual_matrix.contract(dense_vector.RowAsMatrix().cast<double>(),
-                              product_dims))
-            .cast<float>();
+    const float dual_delta = normalized_bounded_dual_delta[l];
+    for (int64 k = 0; k < row.size(); ++k) {
+      AddToDelta(row(k) * dual_delta, atomic_updates, &deltas_(l, k));
+    }
   }
 }
 
 void FeatureWeightsSparseStorage::UpdateSparseDeltaWeights(
-    const Eigen::ThreadPoolDevice& device,
     const Example::SparseFeatures& sparse_features,
-    const std::vector<double>& normalized_bounded_dual_delta) {
+    const std::vector<double>& normalized_bounded_dual_delta,
+    const bool atomic_updates) {
   for (int64 k = 0; k < sparse_features.indices->size(); ++k) {
     const double feature_value =
         sparse_features.values == nullptr ? 1.0 : (*sparse_features.values)(k);
     auto it = indices_to_id_.find((*sparse_features.indices)(k));
     for (size_t l = 0; l < normalized_bounded_dual_delta.size(); ++l) {
-      deltas_(l, it->second) +=
-          feature_value * normalized_bounded_dual_delta[l];
+      AddToDelta(feature_value * normalized_bounded_dual_delta[l],
+                 atomic_updates, &deltas_(l, it->second));
     }
   }
 }
 
 void ModelWeights::UpdateDeltaWeights(
-    const Eigen::ThreadPoolDevice& device, const Example& example,
-    const std::vector<double>& normalized_bounded_dual_delta) {
+    const Example& example,
+    const std::vector<double>& normalized_bounded_dual_delta,
+    const bool atomic_updates) {
   // Sparse weights.
   for (size_t j = 0; j < sparse_weights_.size(); ++j) {
-    sparse_weights_[j].UpdateSparseDeltaWeights(
-        device, example.sparse_features_[j], normalized_bounded_dual_delta);
+    sparse_weights_[j].UpdateSparseDeltaWeights(example.sparse_features_[j],
+                                                normalized_bounded_dual_delta,
+                                                atomic_updates);
   }
 
   // Dense weights.
   for (size_t j = 0; j < dense_weights_.size(); ++j) {
-    dense_weights_[j].UpdateDenseDeltaWeights(
-        device, *example.dense_vectors_[j], normalized_bounded_dual_delta);
+    dense_weights_[j].UpdateDenseDeltaWeights(*example.dense_vectors_[j],
+                                              normalized_bounded_dual_delta,
+                                              atomic_updates);
   }
 }
 
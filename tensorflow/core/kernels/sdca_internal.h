@@ -212,11 +212,14 @@ class FeatureWeightsDenseStorage {
   TTypes<float>::Matrix deltas() const { return deltas_; }
 
   // Updates delta weights based on active dense features in the example and
-  // the corresponding dual residual.
+  // the corresponding dual residual, atomically if `atomic_updates` is true.
+  //
+  // The update runs on the calling thread, which is one of the threads that
+  // train on a shard of the examples.
   void UpdateDenseDeltaWeights(
-      const Eigen::ThreadPoolDevice& device,
       const Example::DenseVector& dense_vector,
-      const std::vector<double>& normalized_bounded_dual_delta);
+      const std::vector<double>& normalized_bounded_dual_delta,
+      bool atomic_updates);
 
  private:
   // The nominal value of the weight for a feature (indexed by its id).
@@ -258,11 +261,11 @@ class FeatureWeightsSparseStorage {
   }
 
   // Updates delta weights based on active sparse features in the example and
-  // the corresponding dual residual.
+  // the corresponding dual residual, atomically if `atomic_updates` is true.
   void UpdateSparseDeltaWeights(
-      const Eigen::ThreadPoolDevice& device,
       const Example::SparseFeatures& sparse_features,
-      const std::vector<double>& normalized_bounded_dual_delta);
+      const std::vector<double>& normalized_bounded_dual_delta,
+      bool atomic_updates);
 
  private:
   // The nominal value of the weight for a feature (indexed by its id).
@@ -289,9 +292,17 @@ class ModelWeights {
 
   // Go through all the features present in the example, and update the
   // weights based on the dual delta.
+  //
+  // The threads that train on different examples update the weights without
+  // locks, in the style of Hogwild!. If `atomic_updates` is false, concurrent
+  // updates of the same weight may overwrite each other; if it is true, each
+  // weight is updated with an atomic compare-and-swap, so that no update is
+  // lost, at the cost of slower updates of the weights shared by many
+  // examples.
   void UpdateDeltaWeights(
-      const Eigen::ThreadPoolDevice& device, const Example& example,
-      const std::vector<double>& normalized_bounded_dual_delta);
+      const Example& example,
+      const std::vector<double>& normalized_bounded_dual_delta,
+      bool atomic_updates);
 
   Status Initialize(OpKernelContext* const context);
 
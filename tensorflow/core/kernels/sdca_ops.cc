@@ -52,6 +52,7 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
@@ -112,6 +113,12 @@ struct ComputeOptions {
     OP_REQUIRES_OK(context, context->GetAttr("num_inner_iterations",
                                              &num_inner_iterations));
     OP_REQUIRES_OK(context, regularizations.Initialize(context));
+    // Setting TF_SDCA_ATOMIC_WEIGHT_UPDATES to true makes the threads update
+    // the weights with atomic compare-and-swaps, so that the updates of the
+    // weights shared by many examples are not lost when many threads train.
+    OP_REQUIRES_OK(context,
+                   ReadBoolFromEnvVar("TF_SDCA_ATOMIC_WEIGHT_UPDATES",
+                                      /*default_val=*/false, &atomic_updates));
   }
 
   std::unique_ptr<DualLossUpdater> loss_updater;
@@ -121,6 +128,7 @@ struct ComputeOptions {
   int num_inner_iterations = 0;
   int num_loss_partitions = 0;
   bool adaptive = true;
+  bool atomic_updates = false;
   Regularizations regularizations;
 };
 
@@ -204,8 +212,8 @@ void DoCompute(const ComputeOptions& options, OpKernelContext* const context) {
           (new_dual - dual) * example_weight /
           options.regularizations.symmetric_l2();
       model_weights.UpdateDeltaWeights(
-          context->eigen_cpu_device(), example,
-          std::vector<double>{normalized_bounded_dual_delta});
+          example, std::vector<double>{normalized_bounded_dual_delta},
+          options.atomic_updates);
 
       // Update example data.
       example_state_data(example_index, 0) = new_dual;
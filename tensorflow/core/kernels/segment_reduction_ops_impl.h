@@ -23,6 +23,7 @@ limitations under the License.
 #define EIGEN_USE_GPU
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+#include <algorithm>
 #include <vector>
 
 #include "third_party/eigen3/Eigen/Core"
@@ -37,7 +38,10 @@ limitations under the License.
 #include "tensorflow/core/kernels/segment_reduction_ops.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -310,7 +314,21 @@ class SegmentSumGPUOp : public AsyncOpKernel {
 
 namespace functor {
 
+// Unsorted segment reductions of at least this many elements of data run in
+// parallel on CPU.
+constexpr int64 kParallelUnsortedSegmentMinSize = 32768;
+
+// Unsorted segment reductions of unsorted segment ids split the segments into
+// this many ranges per thread.
+constexpr int64 kUnsortedSegmentShardsPerThread = 4;
+
 // The ReductionFunctor implementation for CPU.
+//
+// Large reductions run in parallel, and each output row still reduces its
+// rows in order, so the results do not depend on the number of threads. When
+// the segment ids are sorted, shards of rows, extended to whole segments, are
+// reduced in parallel. Otherwise the rows are bucketed by ranges of segments
+// that are reduced in parallel.
 template <typename T, typename Index, typename InitialValueF,
           typename ReductionF>
 struct UnsortedSegmentFunctor<CPUDevice, T, Index, InitialValueF, ReductionF> {
@@ -318,24 +336,105 @@ struct UnsortedSegmentFunctor<CPUDevice, T, Index, InitialValueF, ReductionF> {
                   typename TTypes<Index>::ConstFlat segment_ids,
                   typename TTypes<T, 2>::ConstTensor data,
                   typename TTypes<T, 2>::Tensor output) {
-    output.setConstant(InitialValueF()());
+    output.device(ctx->eigen_device<CPUDevice>()) =
+        output.constant(InitialValueF()());
     if (data.size() == 0) {
       return;
     }
     const int64 N = segment_ids.dimension(0);
     const int64 num_segments = output.dimension(0);
     ReductionF reduction;
-    for (int64 i = 0; i < N; ++i) {
-      Index j = internal::SubtleMustCopy(segment_ids(i));
-      if (j < 0) {
-        continue;
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    if (worker_threads->num_threads <= 1 ||
+        data.size() < kParallelUnsortedSegmentMinSize) {
+      for (int64 i = 0; i < N; ++i) {
+        Index j = internal::SubtleMustCopy(segment_ids(i));
+        if (j < 0) {
+          continue;
+        }
+        OP_REQUIRES(ctx, FastBoundsCheck(j, num_segments),
+                    errors::InvalidArgument(
+                        "segment_ids", SliceDebugString(segment_ids_shape, i),
+                        " = ", j, " is out of range [0, ", num_segments, ")"));
+        reduction(data.template chip<0>(i), output.template chip<0>(j));
       }
-      OP_REQUIRES(ctx, FastBoundsCheck(j, num_segments),
+      return;
+    }
+
+    // Validate a copy of the segment ids, which the shards then read.
+    std::vector<Index> ids(N);
+    bool sorted = true;
+    for (int64 i = 0; i < N; ++i) {
+      const Index j = internal::SubtleMustCopy(segment_ids(i));
+      OP_REQUIRES(ctx, j < 0 || FastBoundsCheck(j, num_segments),
                   errors::InvalidArgument(
                       "segment_ids", SliceDebugString(segment_ids_shape, i),
                       " = ", j, " is out of range [0, ", num_segments, ")"));
-      reduction(data.template chip<0>(i), output.template chip<0>(j));
+      ids[i] = j;
+      sorted = sorted && (i == 0 || ids[i - 1] <= j);
+    }
+    const int64 row_size = data.dimension(1);
+
+    if (sorted) {
+      // A segment belongs to the shard of its first row.
+      auto segment_start = [&ids, N](int64 i) {
+        while (i > 0 && i < N && ids[i] == ids[i - 1]) {
+          ++i;
+        }
+        return i;
+      };
+      auto reduce_rows = [&](int64 begin, int64 end) {
+        const int64 limit = segment_start(end);
+        for (int64 i = segment_start(begin); i < limit; ++i) {
+          if (ids[i] >= 0) {
+            reduction(data.template chip<0>(i),
+                      output.template chip<0>(ids[i]));
+          }
+        }
+      };
+      Shard(worker_threads->num_threads, worker_threads->workers, N, row_size,
+            reduce_rows);
+      return;
     }
+
+    if (num_segments == 0) {
+      // All the segment ids are negative.
+      return;
+    }
+
+    // Bucket the rows, in order, by the range of segments they reduce into.
+    const int64 num_shards =
+        std::min(num_segments,
+                 kUnsortedSegmentShardsPerThread * worker_threads->num_threads);
+    const int64 segments_per_shard =
+        (num_segments + num_shards - 1) / num_shards;
+    std::vector<int64> shard_starts(num_shards + 1, 0);
+    for (int64 i = 0; i < N; ++i) {
+      if (ids[i] >= 0) {
+        ++shard_starts[ids[i] / segments_per_shard + 1];
+      }
+    }
+    for (int64 s = 0; s < num_shards; ++s) {
+      shard_starts[s + 1] += shard_starts[s];
+    }
+    std::vector<int64> rows(shard_starts.back());
+    std::vector<int64> next(shard_starts.begin(), shard_starts.end() - 1);
+    for (int64 i = 0; i < N; ++i) {
+      if (ids[i] >= 0) {
+        rows[next[ids[i] / segments_per_shard]++] = i;
+      }
+    }
+    auto reduce_shards = [&](int64 begin, int64 end) {
+      for (int64 s = begin; s < end; ++s) {
+        for (int64 k = shard_starts[s]; k < shard_starts[s + 1]; ++k) {
+          const int64 i = rows[k];
+          reduction(data.template chip<0>(i), output.template chip<0>(ids[i]));
+        }
+      }
+    };
+    const int64 cost_per_shard = (rows.size() / num_shards + 1) * row_size;
+    Shard(worker_threads->num_threads, worker_threads->workers, num_shards,
+          cost_per_shard, reduce_shards);
   }
 };
 
@@ -502,12 +601,14 @@ class SparseSegmentReductionOpBase : public OpKernel {
                 errors::InvalidArgument("segment ids must be >= 0"));
     auto output_flat = output->flat_outer_dims<T>();
 
-    int64 start = 0, end = 1;
-    // Index from which the output is not initialized.
-    OutputRow uninitialized_index = 0;
+    // Find the segments first, so that they can then be reduced in parallel.
+    // segment_starts[k] is the offset in indices of the k-th segment, which is
+    // reduced into the output row segment_rows[k].
+    std::vector<int64> segment_starts;
+    std::vector<OutputRow> segment_rows;
+    int64 start = 0;
     OutputRow out_index = internal::SubtleMustCopy(segment_vec(start));
-
-    while (true) {
+    for (int64 end = 1;; ++end) {
       // We initialize next_index to 0 to avoid "warning: 'next_index' may be
       // used uninitialized in this function" in the Mac build (since the
       // compiler isn't smart enough to realize the code is safe).
@@ -515,7 +616,6 @@ class SparseSegmentReductionOpBase : public OpKernel {
       if (end < num_indices) {
         next_index = internal::SubtleMustCopy(segment_vec(end));
         if (out_index == next_index) {
-          ++end;
           continue;
         }
         // We have a new segment here.  Verify that the segment ids are growing.
@@ -528,34 +628,62 @@ class SparseSegmentReductionOpBase : public OpKernel {
           errors::InvalidArgument(
               "Segment id ", out_index, " out of range [0, ", output_rows,
               "), possibly because 'segment_ids' input is not sorted."));
-
-      // If there is a gap between two indices, we need to set that gap to the
-      // default value.
-      if (out_index > uninitialized_index) {
-        Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-            out_index - uninitialized_index, num_col);
-        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-            gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-        gap_slice.setConstant(default_value_);
-      }
-
-      auto out = output_flat.template chip<0>(out_index);
-      const int bad_offset =
-          Reduce(input_flat, indices_vec, start, end - start, out);
-      OP_REQUIRES(context, bad_offset < 0,
-                  errors::InvalidArgument(
-                      "Bad: indices[", start + bad_offset,
-                      "] == ", indices_vec(start + bad_offset),
-                      " out of range [0, ", input_flat.dimension(0), ")"));
-
+      segment_starts.push_back(start);
+      segment_rows.push_back(out_index);
+      if (end == num_indices) break;
       start = end;
-      ++end;
-      uninitialized_index = out_index + 1;
       out_index = next_index;
-      if (end > num_indices) break;
     }
+    segment_starts.push_back(num_indices);
+    const int64 num_segments = segment_rows.size();
+
+    mutex mu;
+    // The position of the first out of range index, if any.
+    int64 bad_position = num_indices;
+    auto reduce_segments = [&](int64 begin, int64 end) {
+      for (int64 k = begin; k < end; ++k) {
+        // If there is a gap between two segments, we need to set that gap to
+        // the default value.
+        const OutputRow uninitialized_index =
+            k == 0 ? 0 : segment_rows[k - 1] + 1;
+        if (segment_rows[k] > uninitialized_index) {
+          Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
+              segment_rows[k] - uninitialized_index, num_col);
+          Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
+                           Eigen::Unaligned>
+              gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
+          gap_slice.setConstant(default_value_);
+        }
+
+        if (k + 1 < end) {
+          PrefetchRows(input_flat, indices_vec, segment_starts[k + 1],
+                       segment_starts[k + 2]);
+        }
+        auto out = output_flat.template chip<0>(segment_rows[k]);
+        const int64 bad_offset =
+            Reduce(input_flat, indices_vec, segment_starts[k],
+                   segment_starts[k + 1] - segment_starts[k], out);
+        if (bad_offset >= 0) {
+          mutex_lock l(mu);
+          bad_position =
+              std::min(bad_position, segment_starts[k] + bad_offset);
+        }
+      }
+    };
+    // Each segment costs about one pass over a row per index.
+    const int64 cost_per_segment =
+        (num_indices / num_segments + 1) * num_col * sizeof(T);
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_segments,
+          cost_per_segment, reduce_segments);
+    OP_REQUIRES(context, bad_position == num_indices,
+                errors::InvalidArgument(
+                    "Bad: indices[", bad_position,
+                    "] == ", indices_vec(bad_position), " out of range [0, ",
+                    input_flat.dimension(0), ")"));
 
     // Fill the gap at the end with the default value.
+    const OutputRow uninitialized_index = segment_rows.back() + 1;
     if (uninitialized_index < output_rows) {
       Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
           output_rows - uninitialized_index, num_col);
@@ -568,6 +696,24 @@ class SparseSegmentReductionOpBase : public OpKernel {
  private:
   typedef int32 Index;
 
+  // The number of rows of the next segment prefetched while reducing a
+  // segment. The hardware prefetcher loads the rest of each row once its first
+  // cache line is requested.
+  static constexpr int64 kMaxPrefetchedRows = 8;
+
+  void PrefetchRows(const typename TTypes<T>::ConstMatrix& input_flat,
+                    const typename TTypes<Index>::ConstVec& indices_vec,
+                    int64 start, int64 end) const {
+    end = std::min(end, start + kMaxPrefetchedRows);
+    for (int64 i = start; i < end; ++i) {
+      const Index index = indices_vec(i);
+      if (FastBoundsCheck(index, input_flat.dimension(0))) {
+        port::prefetch<port::PREFETCH_HINT_T0>(
+            reinterpret_cast<const void*>(&input_flat(index, 0)));
+      }
+    }
+  }
+
   int64 Reduce(const typename TTypes<T>::ConstMatrix& input_flat,
                const typename TTypes<Index>::ConstVec& indices_vec, int64 start,
                int64 num,
@@ -113,6 +113,73 @@ BM_Reduce_Arg(64, 32, 2);
 BM_Reduce_Arg(4096, 32, 2);
 BM_Reduce_Arg(4096, 128, 2);
 
+static void BM_UnsortedSegmentSum(int iters, int num_rows, int num_cols,
+                                  int num_segments, bool sorted) {
+  testing::StopTiming();
+  std::unique_ptr<Device> device(
+      DeviceFactory::NewDevice("CPU", {}, "/job:a/replica:0/task:0"));
+
+  // Create inputs
+  gtl::InlinedVector<TensorValue, 4> reduction_inputs;
+  Tensor data(DT_FLOAT, TensorShape({num_rows, num_cols}));
+  data.flat<float>().setRandom();
+  reduction_inputs.push_back({nullptr, &data});
+
+  Tensor segment_ids(DT_INT32, TensorShape({num_rows}));
+  test::FillFn<int32>(&segment_ids, [&](int i) -> int32 {
+    return sorted ? static_cast<int64>(i) * num_segments / num_rows
+                  : (i * 7919) % num_segments;
+  });
+  reduction_inputs.push_back({nullptr, &segment_ids});
+
+  Tensor num_segments_t(DT_INT32, TensorShape({}));
+  num_segments_t.scalar<int32>()() = num_segments;
+  reduction_inputs.push_back({nullptr, &num_segments_t});
+
+  NodeDef reduction_node_def;
+  TF_CHECK_OK(NodeDefBuilder("UnsortedSegmentSum", "UnsortedSegmentSum")
+                  .Input(FakeInput(DT_FLOAT))
+                  .Input(FakeInput(DT_INT32))
+                  .Input(FakeInput(DT_INT32))
+                  .Finalize(&reduction_node_def));
+  Status status;
+  std::unique_ptr<OpKernel> reduction_op(
+      CreateOpKernel(DEVICE_CPU, device.get(), cpu_allocator(),
+                     reduction_node_def, TF_GRAPH_DEF_VERSION, &status));
+  OpKernelContext::Params params;
+  params.device = device.get();
+  params.frame_iter = FrameAndIter(0, 0);
+  params.inputs = &reduction_inputs;
+  params.op_kernel = reduction_op.get();
+  std::vector<AllocatorAttributes> attrs;
+  test::SetOutputAttrs(&params, &attrs);
+
+  std::unique_ptr<OpKernelContext> reduction_context(
+      new OpKernelContext(&params));
+
+  reduction_op->Compute(reduction_context.get());
+  TF_CHECK_OK(reduction_context->status());
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    delete reduction_context->release_output(0).tensor;
+    reduction_op->Compute(reduction_context.get());
+  }
+  int64 bytes_per_iter =
+      static_cast<int64>(num_rows * num_cols * sizeof(float));
+  testing::BytesProcessed(bytes_per_iter * iters);
+}
+
+static void BM_UnsortedSegmentSum_Sorted(int iters, int num_rows) {
+  BM_UnsortedSegmentSum(iters, num_rows, 64, num_rows / 8, true);
+}
+
+static void BM_UnsortedSegmentSum_Unsorted(int iters, int num_rows) {
+  BM_UnsortedSegmentSum(iters, num_rows, 64, num_rows / 8, false);
+}
+
+BENCHMARK(BM_UnsortedSegmentSum_Sorted)->Arg(1024)->Arg(65536);
+BENCHMARK(BM_UnsortedSegmentSum_Unsorted)->Arg(1024)->Arg(65536);
+
 static void SparseSegmentMeanGradHelper(int iters, float uniqueness, int size) {
   testing::StopTiming();
   Graph* g = new Graph(OpRegistry::Global());
@@ -151,7 +151,9 @@ class CSRMatMulOp : public OpKernel {
 // Uses Eigen SparseMatrix to compute the sparse-dense multiplication between
 // a CSR SparseMatrix `a` and dense Tensor `b`. If intra-op parallelism is
 // available, the implementation parallelizes the computation across each row
-// of the sparse matrix.
+// of the sparse matrix. The rows are split into shards with about the same
+// number of nonzeros, so that a few dense rows (e.g. the hubs of a power-law
+// graph) do not end up in a single shard.
 template <typename T>
 class CSRMatMulCPUOp : public CSRMatMulOp<CPUDevice, T> {
   using SparseMatrix = Eigen::SparseMatrix<T, Eigen::RowMajor>;
@@ -282,6 +284,45 @@ class CSRMatMulCPUOp : public CSRMatMulOp<CPUDevice, T> {
         csr_matrix.values_vec<T>(batch_index).data() + row_offset);
   }
 
+  // Splits the range [0, batch_size * num_rows) of the rows of all the batches
+  // of `matrix` into `num_shards` contiguous shards, such that each shard has
+  // about the same number of rows plus nonzeros. The matmul of a row costs its
+  // number of nonzeros, plus one for writing the output row. Returns the
+  // num_shards + 1 boundaries of the shards; some shards may be empty.
+  std::vector<int64> BalancedRowShards(const CSRSparseMatrix& matrix,
+                                       const int64 batch_size,
+                                       const int64 num_rows,
+                                       const int64 num_shards) {
+    // The cost of the rows before the global row `g`, which is nondecreasing.
+    const auto cost_before = [&](int64 g) -> int64 {
+      const int64 batch_idx = std::min(g / num_rows, batch_size - 1);
+      const int64 row = g - batch_idx * num_rows;
+      return g + matrix.batch_offset(batch_idx) +
+             matrix.row_pointers_vec(batch_idx)(row);
+    };
+    const int64 total_rows = batch_size * num_rows;
+    if (total_rows == 0) return std::vector<int64>(num_shards + 1, 0);
+    const int64 total_cost = cost_before(total_rows);
+    std::vector<int64> boundaries(num_shards + 1, total_rows);
+    boundaries[0] = 0;
+    for (int64 shard = 1; shard < num_shards; ++shard) {
+      const int64 target = total_cost * shard / num_shards;
+      // Find the first row whose prefix cost reaches `target`.
+      int64 lo = boundaries[shard - 1];
+      int64 hi = total_rows;
+      while (lo < hi) {
+        const int64 mid = lo + (hi - lo) / 2;
+        if (cost_before(mid) < target) {
+          lo = mid + 1;
+        } else {
+          hi = mid;
+        }
+      }
+      boundaries[shard] = lo;
+    }
+    return boundaries;
+  }
+
   // Sparse-Dense Matrix Multiplication between a CSRSparseMatrix (LHS) and a
   // dense Tensor (RHS).
   void SparseDenseMatMulWithoutTransposedLHS(
@@ -291,19 +332,21 @@ class CSRMatMulCPUOp : public CSRMatMulOp<CPUDevice, T> {
     // rows in each batch.
     auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
     const int32 num_threads = worker_threads.num_threads;
-    const int64 block_size =
-        num_lhs_rows / std::max(kMaxShards, kNumShardsPerThread * num_threads);
+    const int64 num_shards =
+        std::max(kMaxShards, kNumShardsPerThread * num_threads);
+    const std::vector<int64> shards =
+        BalancedRowShards(lhs, batch_size, num_lhs_rows, num_shards);
     const int64 num_rhs_rows = rhs.dim_size(rhs.dims() - 2);
     const int64 num_rhs_cols = rhs.dim_size(rhs.dims() - 1);
     worker_threads.workers->ParallelFor(
-        batch_size * num_lhs_rows /* total */,
+        num_shards /* total */,
         thread::ThreadPool::SchedulingParams(
             thread::ThreadPool::SchedulingStrategy::
                 kFixedBlockSize /* strategy */,
-            absl::nullopt /* cost_per_unit */, block_size),
-        [&](int64 batch_and_row_begin, int64 batch_and_row_end) {
+            absl::nullopt /* cost_per_unit */, 1 /* block_size */),
+        [&](int64 shard_begin, int64 shard_end) {
           HandleBatchAndRowRange(
-              num_lhs_rows, batch_and_row_begin, batch_and_row_end,
+              num_lhs_rows, shards[shard_begin], shards[shard_end],
               [&](int64 batch_idx, int64 row_begin, int64 row_end) {
                 const int64 num_shard_rows = row_end - row_begin;
 
@@ -364,17 +407,19 @@ class CSRMatMulCPUOp : public CSRMatMulOp<CPUDevice, T> {
 
     // Parallelize matrix multiplication across batch dimensions and across
     // columns of A^T in each batch. These correspond to rows of A.
-    const int64 block_size =
-        num_lhs_cols / std::max(kMaxShards, kNumShardsPerThread * num_threads);
+    const int64 num_shards =
+        std::max(kMaxShards, kNumShardsPerThread * num_threads);
+    const std::vector<int64> shards =
+        BalancedRowShards(lhs, batch_size, num_lhs_cols, num_shards);
     worker_threads.workers->ParallelForWithWorkerId(
-        batch_size * num_lhs_cols /* total */,
+        num_shards /* total */,
         thread::ThreadPool::SchedulingParams(
             thread::ThreadPool::SchedulingStrategy::
                 kFixedBlockSize /* strategy */,
-            absl::nullopt /* cost_per_unit */, block_size),
-        [&](int64 batch_and_row_begin, int64 batch_and_row_end, int tid) {
+            absl::nullopt /* cost_per_unit */, 1 /* block_size */),
+        [&](int64 shard_begin, int64 shard_end, int tid) {
           HandleBatchAndRowRange(
-              num_lhs_cols, batch_and_row_begin, batch_and_row_end,
+              num_lhs_cols, shards[shard_begin], shards[shard_end],
               [&](int64 batch_idx, int64 row_begin, int64 row_end) {
                 const int64 num_shard_rows = row_end - row_begin;
 
@@ -426,6 +471,7 @@ class CSRMatMulCPUOp : public CSRMatMulOp<CPUDevice, T> {
       const int64 num_rows, const int64 batch_and_row_begin,
       const int64 batch_and_row_end,
       const std::function<void(int64, int64, int64)>& fn) {
+    if (batch_and_row_begin == batch_and_row_end) return;
     // Obtain the batch indices overlapping with the current shard.
     const int64 batch_begin = batch_and_row_begin / num_rows;
     const int64 batch_end_inclusive = batch_and_row_end / num_rows;
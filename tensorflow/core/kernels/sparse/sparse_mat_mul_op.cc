@@ -19,8 +19,12 @@ limitations under the License.
 #define EIGEN_USE_GPU
 #endif
 
+#include <algorithm>
+#include <functional>
+#include <limits>
 #include <memory>
 #include <numeric>
+#include <vector>
 
 #include "third_party/eigen3/Eigen/SparseCore"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -33,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/dense_update_functor.h"
 #include "tensorflow/core/kernels/sparse/kernels.h"
 #include "tensorflow/core/kernels/sparse/sparse_matrix.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA
@@ -57,6 +62,10 @@ void SwapDimSizes(const int dim_a, const int dim_b, TensorShape* shape) {
   shape->set_dim(dim_b, size_a);
 }
 
+// Number of shards allocated to each thread when a single product is split
+// across rows.
+constexpr int64 kNumRowShardsPerThread = 4;
+
 }  // namespace
 
 // Op to compute the matrix multiplication of two CSR Sparse Matrices.
@@ -73,9 +82,11 @@ void SwapDimSizes(const int dim_a, const int dim_b, TensorShape* shape) {
 // TODO(anudhyan): Consider exposing whether to prune zeros as an attribute in
 // the op's interface.
 //
-// If multiple threads are available, we parallelize across multiple batches
-// using Eigen ThreadPool. Within a single batch, we run in single threaded mode
-// because Eigen's Sparse-Sparse matmul doesn't support multithreading.
+// If there are at least as many batches as threads, we parallelize across
+// batches using Eigen's Sparse-Sparse matmul, which is single threaded.
+// Otherwise, each product is computed with Gustavson's row-by-row algorithm,
+// parallelized across shards of rows of `a` with about the same number of
+// multiplications each.
 //
 // TODO(b/126472741): Due to the multiple batches of a 3D CSRSparseMatrix being
 // laid out in contiguous memory, this implementation allocates memory to store
@@ -181,29 +192,45 @@ class CSRSparseMatMulCPUOp : public OpKernel {
     const int64 matmul_cost_per_batch =
         num_output_rows * (avg_nnz_per_row_a * avg_nnz_per_row_b);
 
-    // Parallelize matrix multiplication across batches.
-    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
-          matmul_cost_per_batch, [&](int64 batch_begin, int64 batch_end) {
-            for (int64 batch_idx = batch_begin; batch_idx < batch_end;
-                 ++batch_idx) {
-              // For each batch, map the CSRSparseMatrix as Eigen SparseMatrix
-              // without copying the underlying data.
-              auto a_ref = GetSparseMatrixRef(*input_matrix_a, rank, batch_idx,
-                                              transpose_a_, adjoint_a_);
-              auto b_ref = GetSparseMatrixRef(*input_matrix_b, rank, batch_idx,
-                                              transpose_b_, adjoint_b_);
-
-              // Matrix multiply while *not* pruning numerical zeros on the fly.
-              // Allocates output SparseMatrix and moves it to our list of
-              // output_matrices.
-              output_matrices[batch_idx] = a_ref * b_ref;
-
-              // For now, batch_ptr contains the number of nonzeros in each
-              // batch.
-              batch_ptr_vec(batch_idx + 1) =
-                  output_matrices[batch_idx].nonZeros();
-            }
-          });
+    if (batch_size < worker_threads.num_threads) {
+      // Parallelize matrix multiplication across rows of each batch.
+      for (int64 batch_idx = 0; batch_idx < batch_size; ++batch_idx) {
+        auto a_ref = GetSparseMatrixRef(*input_matrix_a, rank, batch_idx,
+                                        transpose_a_, adjoint_a_);
+        auto b_ref = GetSparseMatrixRef(*input_matrix_b, rank, batch_idx,
+                                        transpose_b_, adjoint_b_);
+        OP_REQUIRES_OK(ctx,
+                       RowParallelMatMul(worker_threads, a_ref, b_ref,
+                                         &output_matrices[batch_idx]));
+        batch_ptr_vec(batch_idx + 1) = output_matrices[batch_idx].nonZeros();
+      }
+    } else {
+      // Parallelize matrix multiplication across batches.
+      Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+            matmul_cost_per_batch, [&](int64 batch_begin, int64 batch_end) {
+              for (int64 batch_idx = batch_begin; batch_idx < batch_end;
+                   ++batch_idx) {
+                // For each batch, map the CSRSparseMatrix as Eigen
+                // SparseMatrix without copying the underlying data.
+                auto a_ref = GetSparseMatrixRef(*input_matrix_a, rank,
+                                                batch_idx, transpose_a_,
+                                                adjoint_a_);
+                auto b_ref = GetSparseMatrixRef(*input_matrix_b, rank,
+                                                batch_idx, transpose_b_,
+                                                adjoint_b_);
+
+                // Matrix multiply while *not* pruning numerical zeros on the
+                // fly. Allocates output SparseMatrix and moves it to our list
+                // of output_matrices.
+                output_matrices[batch_idx] = a_ref * b_ref;
+
+                // For now, batch_ptr contains the number of nonzeros in each
+                // batch.
+                batch_ptr_vec(batch_idx + 1) =
+                    output_matrices[batch_idx].nonZeros();
+              }
+            });
+    }
 
     // Compute the cumulative sum to obtain the batch pointers.
     std::partial_sum(batch_ptr_vec.data(),
@@ -260,6 +287,119 @@ class CSRSparseMatMulCPUOp : public OpKernel {
   }
 
  private:
+  // Computes `c = a * b` with Gustavson's algorithm: row i of c is the sum of
+  // the rows of b selected by the nonzeros of row i of a. The rows are split
+  // into shards with about the same number of multiplications, and each shard
+  // is computed in two passes over its rows: the first counts the nonzeros of
+  // each row of c, to lay out the output, and the second accumulates the
+  // products in a dense row and gathers them in column order. Like Eigen's
+  // product, numeric zeros are kept.
+  Status RowParallelMatMul(
+      const DeviceBase::CpuWorkerThreads& worker_threads,
+      const Eigen::Ref<const SparseMatrix>& a,
+      const Eigen::Ref<const SparseMatrix>& b, SparseMatrix* c) {
+    const int64 num_rows = a.rows();
+    const int64 num_cols = b.cols();
+    const int* a_row_ptr = a.outerIndexPtr();
+    const int* a_col_ind = a.innerIndexPtr();
+    const T* a_values = a.valuePtr();
+    const int* b_row_ptr = b.outerIndexPtr();
+    const int* b_col_ind = b.innerIndexPtr();
+    const T* b_values = b.valuePtr();
+
+    // Shard the rows by the prefix sums of their number of multiplications,
+    // plus one per row for its bookkeeping.
+    std::vector<int64> flops(num_rows + 1, 0);
+    for (int64 i = 0; i < num_rows; ++i) {
+      int64 row_flops = 1;
+      for (int j = a_row_ptr[i]; j < a_row_ptr[i + 1]; ++j) {
+        row_flops += b_row_ptr[a_col_ind[j] + 1] - b_row_ptr[a_col_ind[j]];
+      }
+      flops[i + 1] = flops[i] + row_flops;
+    }
+    const int64 num_shards = std::max<int64>(
+        1, std::min(num_rows, kNumRowShardsPerThread *
+                                  worker_threads.num_threads));
+    std::vector<int64> shards(num_shards + 1);
+    for (int64 shard = 0; shard <= num_shards; ++shard) {
+      shards[shard] =
+          std::lower_bound(flops.begin(), flops.end(),
+                           flops[num_rows] * shard / num_shards) -
+          flops.begin();
+    }
+    shards[num_shards] = num_rows;
+    const auto parallel_for_shards =
+        [&](const std::function<void(int64, int64)>& fn) {
+          worker_threads.workers->ParallelFor(
+              num_shards,
+              thread::ThreadPool::SchedulingParams(
+                  thread::ThreadPool::SchedulingStrategy::kFixedBlockSize,
+                  absl::nullopt /* cost_per_unit */, 1 /* block_size */),
+              [&](int64 shard_begin, int64 shard_end) {
+                fn(shards[shard_begin], shards[shard_end]);
+              });
+        };
+
+    // Count the nonzeros of each row of c.
+    std::vector<int64> c_row_nnz(num_rows + 1, 0);
+    parallel_for_shards([&](int64 row_begin, int64 row_end) {
+      std::vector<int64> last_row(num_cols, -1);
+      for (int64 i = row_begin; i < row_end; ++i) {
+        for (int j = a_row_ptr[i]; j < a_row_ptr[i + 1]; ++j) {
+          const int k = a_col_ind[j];
+          for (int l = b_row_ptr[k]; l < b_row_ptr[k + 1]; ++l) {
+            if (last_row[b_col_ind[l]] != i) {
+              last_row[b_col_ind[l]] = i;
+              ++c_row_nnz[i + 1];
+            }
+          }
+        }
+      }
+    });
+    std::partial_sum(c_row_nnz.begin(), c_row_nnz.end(), c_row_nnz.begin());
+    const int64 c_nnz = c_row_nnz[num_rows];
+    if (c_nnz > std::numeric_limits<int>::max()) {
+      return errors::InvalidArgument(
+          "The product of the sparse matrices has too many nonzeros: ", c_nnz);
+    }
+
+    c->resize(num_rows, num_cols);
+    c->resizeNonZeros(c_nnz);
+    std::copy(c_row_nnz.begin(), c_row_nnz.end(), c->outerIndexPtr());
+    int* c_col_ind = c->innerIndexPtr();
+    T* c_values = c->valuePtr();
+
+    // Accumulate each row of c in a dense row, then gather it.
+    parallel_for_shards([&](int64 row_begin, int64 row_end) {
+      std::vector<int64> last_row(num_cols, -1);
+      std::vector<T> row_values(num_cols);
+      for (int64 i = row_begin; i < row_end; ++i) {
+        int* cols = c_col_ind + c_row_nnz[i];
+        int64 row_nnz = 0;
+        for (int j = a_row_ptr[i]; j < a_row_ptr[i + 1]; ++j) {
+          const int k = a_col_ind[j];
+          const T a_value = a_values[j];
+          for (int l = b_row_ptr[k]; l < b_row_ptr[k + 1]; ++l) {
+            const int col = b_col_ind[l];
+            if (last_row[col] != i) {
+              last_row[col] = i;
+              cols[row_nnz++] = col;
+              row_values[col] = a_value * b_values[l];
+            } else {
+              row_values[col] += a_value * b_values[l];
+            }
+          }
+        }
+        std::sort(cols, cols + row_nnz);
+        T* values = c_values + c_row_nnz[i];
+        for (int64 j = 0; j < row_nnz; ++j) {
+          values[j] = row_values[cols[j]];
+        }
+      }
+    });
+    return Status::OK();
+  }
+
   // Returns an Eigen::Ref expression of a SparseMatrix; which points to the
   // underlying memory of the given CSRSparseMatrix.
   Eigen::Ref<const SparseMatrix> GetSparseMatrixRef(
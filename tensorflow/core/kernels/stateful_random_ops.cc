@@ -96,6 +96,7 @@ Status UpdateVariableAndFill(
     TF_RETURN_IF_ERROR(CheckPhiloxState(*var_tensor, alg_tag_skip));
     TF_RETURN_IF_ERROR(PrepareToUpdateVariable<Device, StateElementType>(
         ctx, var_tensor, var->copy_on_read_mode.load()));
+    var->RecordAllRowsModified();
     UpdateVariableAndFill_Philox<Device, Distribution>()(
         ctx, ctx->eigen_device<Device>(), dist, output_size, alg_tag_skip,
         &state_var_guard, var_tensor, output_data);
@@ -247,6 +248,7 @@ class RngSkipOp : public OpKernel {
       OP_REQUIRES_OK(ctx, CheckPhiloxState(*var_tensor));
       OP_REQUIRES_OK(ctx, PrepareToUpdateVariable<Device, StateElementType>(
                               ctx, var_tensor, var->copy_on_read_mode.load()));
+      var->RecordAllRowsModified();
       RngSkip_Philox<Device>()(ctx->eigen_device<Device>(), delta, var_tensor);
     } else {
       OP_REQUIRES(ctx, false,
@@ -13,12 +13,14 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <locale>
 #include <string>
 
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace text {
@@ -95,7 +97,33 @@ class StringNGramsOp : public tensorflow::OpKernel {
             0, TensorShape({ngrams_splits_data[num_batch_items]}), &ngrams));
     auto ngrams_data = ngrams->flat<tstring>().data();
 
-    for (int i = 0; i < num_batch_items; ++i) {
+    // The batch items write disjoint ngrams, so they are built in parallel.
+    // Building an ngram costs about its number of tokens times a few tens of
+    // cycles.
+    int max_ngram_width = 1;
+    for (int ngram_width : ngram_widths_) {
+      max_ngram_width = std::max(max_ngram_width, ngram_width);
+    }
+    const int64 cost_per_item =
+        50 * max_ngram_width *
+        (1 + ngrams_splits_data[num_batch_items] /
+                 std::max(1, num_batch_items));
+    auto worker_threads =
+        *(context->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, num_batch_items,
+          cost_per_item, [&](int64 begin, int64 end) {
+            CreateBatchItemNgrams(input_data, splits_vec, ngrams_splits_data,
+                                  ngrams_data, begin, end);
+          });
+  }
+
+  // Builds the ngrams of the batch items [begin, end).
+  void CreateBatchItemNgrams(
+      const tstring* input_data,
+      const typename TTypes<SPLITS_TYPE>::ConstFlat& splits_vec,
+      const SPLITS_TYPE* ngrams_splits_data, tstring* ngrams_data,
+      const int64 begin, const int64 end) const {
+    for (int i = begin; i < end; ++i) {
       auto data_start = &input_data[splits_vec(i)];
       int output_start_idx = ngrams_splits_data[i];
       for (int ngram_width : ngram_widths_) {
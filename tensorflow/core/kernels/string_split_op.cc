@@ -15,92 +15,111 @@ limitations under the License.
 
 // See docs in ../ops/string_ops.cc.
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/kernel_def_builder.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/string_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
-// Split input string `str` based on a character delimiter.
-// Returns a vector of StringPieces which are valid as long as input `str`
-// is valid.
+
+// Number of inputs of a shard when splitting a batch in parallel.
+constexpr int64 kBatchShardSize = 256;
+
+// A set of delimiter characters. Membership is a table lookup, instead of a
+// search of the delimiter string for every character of the input.
+class CharSet {
+ public:
+  explicit CharSet(StringPiece chars) {
+    for (const char c : chars) {
+      contains_[static_cast<uint8>(c)] = true;
+    }
+  }
+
+  bool Contains(char c) const { return contains_[static_cast<uint8>(c)]; }
+
+ private:
+  bool contains_[256] = {};
+};
+
+// Split input string `str` based on a character delimiter, and append the
+// tokens to `result`. The StringPieces are valid as long as input `str` is
+// valid.
 // Note: The single character delimiter is a common case and is implemented as
-// a series of finds in the input string, making it much more effcient than
-// SplitOnCharSet.
+// a series of finds in the input string, which use memchr, making it much more
+// efficient than SplitOnCharSet.
 template <typename Predicate>
-std::vector<StringPiece> SplitOnChar(const tstring& str, const char delim,
-                                     Predicate p) {
-  std::vector<StringPiece> result;
+void SplitOnChar(const tstring& str, const char delim, Predicate p,
+                 std::vector<StringPiece>* result) {
   StringPiece text(str);
   auto f = text.find(delim);
   while (f != StringPiece::npos) {
     StringPiece token = text.substr(0, f);
     if (p(token)) {
-      result.emplace_back(token);
+      result->emplace_back(token);
     }
     text.remove_prefix(f + 1);
     f = text.find(delim);
   }
   if (p(text)) {
-    result.push_back(text);
+    result->push_back(text);
   }
-  return result;
 }
 
-// Split input string `str` based on a set of character delimiters.
-// Returns a vector of StringPieces which are valid as long as input `str`
+// Split input string `str` based on a set of character delimiters, and append
+// the tokens to `result`. The StringPieces are valid as long as input `str`
 // is valid.
 // Based on str_util::Split.
 template <typename Predicate>
-std::vector<StringPiece> SplitOnCharSet(const tstring& str,
-                                        const tstring& delim_set, Predicate p) {
-  std::vector<StringPiece> result;
+void SplitOnCharSet(const tstring& str, const CharSet& delims, Predicate p,
+                    std::vector<StringPiece>* result) {
   StringPiece text(str);
-  StringPiece delims(delim_set);
   size_t token_start = 0;
   for (size_t i = 0; i < text.size() + 1; i++) {
-    if ((i == text.size()) || (delims.find(text[i]) != StringPiece::npos)) {
+    if ((i == text.size()) || delims.Contains(text[i])) {
       StringPiece token(text.data() + token_start, i - token_start);
       if (p(token)) {
-        result.emplace_back(token);
+        result->emplace_back(token);
       }
       token_start = i + 1;
     }
   }
-  return result;
 }
 
-// Split input string `str` based on given delimiter.
-// Returns a vector of StringPieces which are valid as long as input `str`
-// is valid.
+// Split input string `str` based on given delimiter, whose characters are
+// `delimiter_set`, and append the tokens to `result`. The StringPieces are
+// valid as long as input `str` is valid.
 template <typename Predicate>
-std::vector<StringPiece> Split(const tstring& str, const tstring& delimiter,
-                               Predicate predicate) {
+void Split(const tstring& str, const tstring& delimiter,
+           const CharSet& delimiter_set, Predicate predicate,
+           std::vector<StringPiece>* result) {
   if (str.empty()) {
-    return std::vector<StringPiece>();
+    return;
   }
   if (delimiter.empty()) {
-    std::vector<StringPiece> result;
-    result.resize(str.size());
     for (size_t i = 0; i < str.size(); ++i) {
-      result[i] = StringPiece(str.data() + i, 1);
+      result->emplace_back(str.data() + i, 1);
     }
-    return result;
+    return;
   }
   if (delimiter.size() == 1) {
-    return SplitOnChar(str, delimiter[0], predicate);
+    SplitOnChar(str, delimiter[0], predicate, result);
+    return;
   }
-  return SplitOnCharSet(str, delimiter, predicate);
+  SplitOnCharSet(str, delimiter_set, predicate, result);
 }
 
-std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
-                                 int maxsplit) {
+void SplitV2(const tstring& str, StringPiece sep, int maxsplit,
+             std::vector<StringPiece>* result) {
   // This SplitV2 method matches the behavior of python's str.split:
   //   If sep is given, consecutive delimiters are not grouped together
   //   and are deemed to delimit empty strings (for example, '1,,2'.split(',')
@@ -115,12 +134,10 @@ std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
   //   splitting an empty string or a string consisting of just whitespace
   //   with a None separator returns [].
 
-  std::vector<StringPiece> result;
-
   StringPiece text(str);
   if (maxsplit == 0) {
-    result.emplace_back(text);
-    return result;
+    result->emplace_back(text);
+    return;
   }
 
   if (sep.empty()) {
@@ -129,32 +146,111 @@ std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
     str_util::RemoveLeadingWhitespace(&text);
     int split = 0;
     while (str_util::ConsumeNonWhitespace(&text, &token)) {
-      result.push_back(token);
+      result->push_back(token);
       str_util::RemoveLeadingWhitespace(&text);
       ++split;
       if (maxsplit > 0 && split == maxsplit) {
-        result.push_back(text);
-        return result;
+        result->push_back(text);
+        return;
       }
     }
-    return result;
+    return;
   }
-  auto p = std::search(text.begin(), text.end(), sep.begin(), sep.end());
+  auto p = text.find(sep);
   int split = 0;
-  while (p != text.end()) {
-    StringPiece token = text.substr(0, p - text.begin());
-    result.push_back(token);
-    text.remove_prefix(token.size());
-    text.remove_prefix(sep.size());
+  while (p != StringPiece::npos) {
+    result->push_back(text.substr(0, p));
+    text.remove_prefix(p + sep.size());
     ++split;
     if (maxsplit > 0 && split == maxsplit) {
-      result.push_back(StringPiece(text));
-      return result;
+      result->push_back(text);
+      return;
     }
-    p = std::search(text.begin(), text.end(), sep.begin(), sep.end());
+    p = text.find(sep);
   }
-  result.push_back(text);
-  return result;
+  result->push_back(text);
+}
+
+// Splits the `batch_size` inputs with `split(i, &tokens)`, which appends the
+// tokens of input i to `tokens`, and outputs them as a SparseTensor of shape
+// [batch_size, max number of tokens of an input]. Shards of the batch are
+// split, and their tokens copied to the outputs, in parallel; the tokens of a
+// shard are gathered in a single vector, so no input allocates its own. The
+// tokens must be slices of the strings of `input`, which the output tokens
+// view rather than copy when tstring supports it.
+template <typename SplitFn>
+void SplitBatch(OpKernelContext* ctx, const Tensor& input,
+                const int64 batch_size, const SplitFn& split) {
+  const int64 num_shards = (batch_size + kBatchShardSize - 1) / kBatchShardSize;
+  std::vector<std::vector<StringPiece>> shard_tokens(num_shards);
+  std::vector<int64> num_indices(batch_size);
+  // Guess that splitting an input and copying its tokens costs a few hundred
+  // cycles.
+  const int64 cost_per_shard = kBatchShardSize * 500;
+  auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+  Shard(worker_threads.num_threads, worker_threads.workers, num_shards,
+        cost_per_shard, [&](int64 shard_begin, int64 shard_end) {
+          for (int64 shard = shard_begin; shard < shard_end; ++shard) {
+            std::vector<StringPiece>* tokens = &shard_tokens[shard];
+            // Guess that we'll be unpacking a handful of tokens per example.
+            static constexpr int kReserveSize = 4;
+            tokens->reserve(kBatchShardSize * kReserveSize);
+            const int64 limit =
+                std::min(batch_size, (shard + 1) * kBatchShardSize);
+            for (int64 i = shard * kBatchShardSize; i < limit; ++i) {
+              const size_t num_tokens = tokens->size();
+              split(i, tokens);
+              num_indices[i] = tokens->size() - num_tokens;
+            }
+          }
+        });
+
+  int64 output_size = 0;
+  std::vector<int64> shard_offsets(num_shards);
+  for (int64 shard = 0; shard < num_shards; ++shard) {
+    shard_offsets[shard] = output_size;
+    output_size += shard_tokens[shard].size();
+  }
+  const int64 max_num_entries =
+      batch_size == 0
+          ? 0
+          : *std::max_element(num_indices.begin(), num_indices.end());
+
+  Tensor* sp_indices_t;
+  OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({output_size, 2}),
+                                           &sp_indices_t));
+  Tensor* sp_tokens_t;
+  OP_REQUIRES_OK(ctx, AllocateStringViewOutput(ctx, 1,
+                                               TensorShape({output_size}),
+                                               input, &sp_tokens_t));
+  Tensor* sp_shape_t;
+  OP_REQUIRES_OK(ctx, ctx->allocate_output(2, TensorShape({2}), &sp_shape_t));
+
+  auto sp_indices = sp_indices_t->matrix<int64>();
+  auto sp_tokens = sp_tokens_t->vec<tstring>();
+  auto sp_shape = sp_shape_t->vec<int64>();
+  sp_shape(0) = batch_size;
+  sp_shape(1) = max_num_entries;
+  Shard(worker_threads.num_threads, worker_threads.workers, num_shards,
+        cost_per_shard, [&](int64 shard_begin, int64 shard_end) {
+          for (int64 shard = shard_begin; shard < shard_end; ++shard) {
+            const std::vector<StringPiece>& tokens = shard_tokens[shard];
+            int64 c = shard_offsets[shard];
+            size_t t = 0;
+            const int64 limit =
+                std::min(batch_size, (shard + 1) * kBatchShardSize);
+            for (int64 i = shard * kBatchShardSize; i < limit; ++i) {
+              for (int64 j = 0; j < num_indices[i]; ++j) {
+                sp_indices(c, 0) = i;
+                sp_indices(c, 1) = j;
+                AssignAsView(&sp_tokens(c), tokens[t].data(),
+                             tokens[t].size());
+                ++c;
+                ++t;
+              }
+            }
+          }
+        });
 }
 
 }  // namespace
@@ -188,50 +284,21 @@ class StringSplitOp : public OpKernel {
         errors::InvalidArgument("delimiter must be a scalar, got shape: ",
                                 delimiter_tensor->shape().DebugString()));
     const auto delimiter_vec = delimiter_tensor->flat<tstring>();
-    const tstring& delimiter = delimiter_vec(0);
     // Empty delimiter means split the input character by character.
-    std::vector<StringPiece> tokens;
-    // Guess that we'll be unpacking a handful of tokens per example.
-    static constexpr int kReserveSize = 4;
-    tokens.reserve(batch_size * kReserveSize);
-
-    int64 output_size = 0;
-    int64 max_num_entries = 0;
-    std::vector<int64> num_indices(batch_size);
-    for (int64 i = 0; i < batch_size; ++i) {
-      std::vector<StringPiece> parts =
-          skip_empty_ ? Split(input_vec(i), delimiter, str_util::SkipEmpty())
-                      : Split(input_vec(i), delimiter, str_util::AllowEmpty());
-      int64 n_entries = parts.size();
-      num_indices[i] = n_entries;
-      output_size += n_entries;
-      max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), std::make_move_iterator(parts.begin()),
-                    std::make_move_iterator(parts.end()));
-    }
-
-    Tensor* sp_indices_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({output_size, 2}),
-                                             &sp_indices_t));
-    Tensor* sp_tokens_t;
-    OP_REQUIRES_OK(
-        ctx, ctx->allocate_output(1, TensorShape({output_size}), &sp_tokens_t));
-    Tensor* sp_shape_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(2, TensorShape({2}), &sp_shape_t));
-
-    auto sp_indices = sp_indices_t->matrix<int64>();
-    auto sp_tokens = sp_tokens_t->vec<tstring>();
-    auto sp_shape = sp_shape_t->vec<int64>();
-    sp_shape(0) = batch_size;
-    sp_shape(1) = max_num_entries;
-    size_t c = 0;
-    for (size_t i = 0; i < batch_size; ++i) {
-      for (size_t j = 0; j < num_indices[i]; ++j) {
-        sp_indices(c, 0) = i;
-        sp_indices(c, 1) = j;
-        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
-        ++c;
-      }
+    const tstring& delimiter = delimiter_vec(0);
+    const CharSet delimiter_set(delimiter);
+    if (skip_empty_) {
+      SplitBatch(ctx, *input_tensor, batch_size,
+                 [&](int64 i, std::vector<StringPiece>* tokens) {
+                   Split(input_vec(i), delimiter, delimiter_set,
+                         str_util::SkipEmpty(), tokens);
+                 });
+    } else {
+      SplitBatch(ctx, *input_tensor, batch_size,
+                 [&](int64 i, std::vector<StringPiece>* tokens) {
+                   Split(input_vec(i), delimiter, delimiter_set,
+                         str_util::AllowEmpty(), tokens);
+                 });
     }
   }
 
@@ -263,46 +330,10 @@ class StringSplitV2Op : public OpKernel {
                                         sep_tensor->shape().DebugString()));
     const auto sep_vec = sep_tensor->flat<tstring>();
     StringPiece sep(sep_vec(0));
-    std::vector<StringPiece> tokens;
-    // Guess that we'll be unpacking a handful of tokens per example.
-    static constexpr int kReserveSize = 4;
-    tokens.reserve(batch_size * kReserveSize);
-
-    int64 output_size = 0;
-    int64 max_num_entries = 0;
-    std::vector<int64> num_indices(batch_size);
-    for (int64 i = 0; i < batch_size; ++i) {
-      std::vector<StringPiece> parts = SplitV2(input_vec(i), sep, maxsplit_);
-      int64 n_entries = parts.size();
-      num_indices[i] = n_entries;
-      output_size += n_entries;
-      max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), parts.begin(), parts.end());
-    }
-
-    Tensor* sp_indices_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({output_size, 2}),
-                                             &sp_indices_t));
-    Tensor* sp_tokens_t;
-    OP_REQUIRES_OK(
-        ctx, ctx->allocate_output(1, TensorShape({output_size}), &sp_tokens_t));
-    Tensor* sp_shape_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(2, TensorShape({2}), &sp_shape_t));
-
-    auto sp_indices = sp_indices_t->matrix<int64>();
-    auto sp_tokens = sp_tokens_t->vec<tstring>();
-    auto sp_shape = sp_shape_t->vec<int64>();
-    sp_shape(0) = batch_size;
-    sp_shape(1) = max_num_entries;
-    size_t c = 0;
-    for (size_t i = 0; i < batch_size; ++i) {
-      for (size_t j = 0; j < num_indices[i]; ++j) {
-        sp_indices(c, 0) = i;
-        sp_indices(c, 1) = j;
-        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
-        ++c;
-      }
-    }
+    SplitBatch(ctx, *input_tensor, batch_size,
+               [&](int64 i, std::vector<StringPiece>* tokens) {
+                 SplitV2(input_vec(i), sep, maxsplit_, tokens);
+               });
   }
 
  private:
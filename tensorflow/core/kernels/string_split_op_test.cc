@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -64,6 +65,71 @@ Tensor GetTestTensor(int batch) {
   return t;
 }
 
+class StringSplitOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(const string& op) {
+    TF_ASSERT_OK(NodeDefBuilder("string_split_op", op)
+                     .Input(FakeInput(DT_STRING))
+                     .Input(FakeInput(DT_STRING))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  void CheckLargeBatch();
+};
+
+// Input i has i % 5 tokens, so a large batch is split in several shards that
+// each hold a different number of tokens.
+void StringSplitOpTest::CheckLargeBatch() {
+  const int batch_size = 1000;
+  std::vector<tstring> inputs;
+  std::vector<int64> expected_indices;
+  std::vector<tstring> expected_tokens;
+  for (int i = 0; i < batch_size; ++i) {
+    tstring input;
+    for (int j = 0; j < i % 5; ++j) {
+      const string token = strings::StrCat(i, "_", j);
+      input.append(j == 0 ? token : strings::StrCat(" ", token));
+      expected_indices.push_back(i);
+      expected_indices.push_back(j);
+      expected_tokens.push_back(token);
+    }
+    inputs.push_back(input);
+  }
+  AddInputFromArray<tstring>(TensorShape({batch_size}), inputs);
+  AddInputFromArray<tstring>(TensorShape({}), {" "});
+  TF_ASSERT_OK(RunOpKernel());
+
+  const int64 num_tokens = expected_tokens.size();
+  test::ExpectTensorEqual<int64>(
+      *GetOutput(0), test::AsTensor<int64>(expected_indices, {num_tokens, 2}));
+  test::ExpectTensorEqual<tstring>(*GetOutput(1),
+                                   test::AsTensor<tstring>(expected_tokens));
+  test::ExpectTensorEqual<int64>(*GetOutput(2),
+                                 test::AsTensor<int64>({batch_size, 4}));
+}
+
+TEST_F(StringSplitOpTest, LargeBatch) {
+  MakeOp("StringSplit");
+  CheckLargeBatch();
+}
+
+TEST_F(StringSplitOpTest, LargeBatchV2) {
+  MakeOp("StringSplitV2");
+  CheckLargeBatch();
+}
+
+TEST_F(StringSplitOpTest, CharSetDelimiter) {
+  MakeOp("StringSplit");
+  AddInputFromArray<tstring>(TensorShape({2}), {"a,b c", ", ,x"});
+  AddInputFromArray<tstring>(TensorShape({}), {", "});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<int64>(
+      *GetOutput(0), test::AsTensor<int64>({0, 0, 0, 1, 0, 2, 1, 0}, {4, 2}));
+  test::ExpectTensorEqual<tstring>(
+      *GetOutput(1), test::AsTensor<tstring>({"a", "b", "c", "x"}));
+}
+
 Graph* SetupStringSplitGraph(const Tensor& input) {
   Graph* g = new Graph(OpRegistry::Global());
   Tensor delim(DT_STRING, TensorShape({}));
@@ -93,7 +159,27 @@ BENCHMARK(BM_StringSplit)
     ->Arg(32)
     ->Arg(64)
     ->Arg(128)
-    ->Arg(256);
+    ->Arg(256)
+    ->Arg(4096)
+    ->Arg(65536);
+
+void BM_StringSplitCharSet(int iters, int batch_size) {
+  testing::StopTiming();
+  testing::ItemsProcessed(static_cast<int64>(iters));
+  testing::UseRealTime();
+  Tensor input = GetTestTensor(batch_size);
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor delim(DT_STRING, TensorShape({}));
+  delim.flat<tstring>().setConstant(" ,.()");
+  TF_CHECK_OK(NodeBuilder("string_split_op", "StringSplit")
+                  .Input(test::graph::Constant(g, input))
+                  .Input(test::graph::Constant(g, delim))
+                  .Finalize(g, nullptr /* node */));
+  testing::StartTiming();
+  test::Benchmark("cpu", g).Run(iters);
+}
+
+BENCHMARK(BM_StringSplitCharSet)->Arg(256)->Arg(4096)->Arg(65536);
 
 Graph* SetupStringSplitV2Graph(const Tensor& input) {
   Graph* g = new Graph(OpRegistry::Global());
@@ -124,6 +210,8 @@ BENCHMARK(BM_StringSplitV2)
     ->Arg(32)
     ->Arg(64)
     ->Arg(128)
-    ->Arg(256);
+    ->Arg(256)
+    ->Arg(4096)
+    ->Arg(65536);
 
 }  // end namespace tensorflow
@@ -41,15 +41,18 @@ class LegacyStringToHashBucketOp : public OpKernel {
                                             &output_tensor));
     auto output_flat = output_tensor->flat<int64>();
 
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = Hash64(input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64>(bucket_id);
-    }
+    ComputeHashBuckets(context, input_flat, output_flat,
+                       [this](const tstring& input) {
+                         // Hash the bytes in place rather than through a
+                         // temporary string.
+                         const uint64 input_hash =
+                             Hash64(input.data(), input.size());
+                         const uint64 bucket_id = input_hash % num_buckets_;
+                         // The number of buckets is always in the positive
+                         // range of int64 so is the resulting bucket_id.
+                         // Casting the bucket_id from uint64 to int64 is safe.
+                         return static_cast<int64>(bucket_id);
+                       });
   }
 
  private:
@@ -23,9 +23,34 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
+// Computes `output(i) = bucket(input(i))` for every string of `input`, in
+// parallel for large inputs. The cost of an element is proportional to the
+// average length of the strings, which the hash functions read once.
+template <typename BucketFn>
+void ComputeHashBuckets(OpKernelContext* context,
+                        const typename TTypes<tstring>::ConstFlat& input,
+                        typename TTypes<int64>::Flat output,
+                        const BucketFn& bucket) {
+  const int64 size = input.size();
+  if (size == 0) return;
+  int64 total_bytes = 0;
+  for (int64 i = 0; i < size; ++i) {
+    total_bytes += input(i).size();
+  }
+  const int64 cost_per_unit = 20 + total_bytes / size;
+  auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+  Shard(worker_threads.num_threads, worker_threads.workers, size,
+        cost_per_unit, [&input, &output, &bucket](int64 begin, int64 end) {
+          for (int64 i = begin; i < end; ++i) {
+            output(i) = bucket(input(i));
+          }
+        });
+}
+
 template <uint64 hash(StringPiece)>
 class StringToHashBucketOp : public OpKernel {
  public:
@@ -44,15 +69,16 @@ class StringToHashBucketOp : public OpKernel {
                                             &output_tensor));
     auto output_flat = output_tensor->flat<int64>();
 
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = hash(input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64>(bucket_id);
-    }
+    const uint64 num_buckets = num_buckets_;
+    ComputeHashBuckets(context, input_flat, output_flat,
+                       [num_buckets](const tstring& input) {
+                         const uint64 input_hash = hash(input);
+                         const uint64 bucket_id = input_hash % num_buckets;
+                         // The number of buckets is always in the positive
+                         // range of int64 so is the resulting bucket_id.
+                         // Casting the bucket_id from uint64 to int64 is safe.
+                         return static_cast<int64>(bucket_id);
+                       });
   }
 
  private:
@@ -86,15 +112,15 @@ class StringToKeyedHashBucketOp : public OpKernel {
                                             &output_tensor));
     auto output_flat = output_tensor->flat<int64>();
 
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = hash(key_, input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64>(bucket_id);
-    }
+    ComputeHashBuckets(context, input_flat, output_flat,
+                       [this](const tstring& input) {
+                         const uint64 input_hash = hash(key_, input);
+                         const uint64 bucket_id = input_hash % num_buckets_;
+                         // The number of buckets is always in the positive
+                         // range of int64 so is the resulting bucket_id.
+                         // Casting the bucket_id from uint64 to int64 is safe.
+                         return static_cast<int64>(bucket_id);
+                       });
   }
 
  private:
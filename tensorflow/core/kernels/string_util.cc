@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/string_util.h"
 
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 
 namespace tensorflow {
@@ -61,4 +63,19 @@ int32 UTF8StrLen(const string& str) {
   return result;
 }
 
+Status AllocateStringViewOutput(OpKernelContext* ctx, int index,
+                                const TensorShape& shape, const Tensor& parent,
+                                Tensor** output) {
+  if (!kTStringHasViews) {
+    return ctx->allocate_output(index, shape, output);
+  }
+  Tensor views;
+  TF_RETURN_IF_ERROR(tensor::MakeStringViewTensor(
+      ctx->get_allocator(ctx->output_alloc_attr(index)), shape, parent,
+      &views));
+  ctx->set_output(index, views);
+  *output = ctx->mutable_output(index);
+  return Status::OK();
+}
+
 }  // namespace tensorflow
@@ -19,6 +19,10 @@ limitations under the License.
 
 namespace tensorflow {
 
+class OpKernelContext;
+class Tensor;
+class TensorShape;
+
 // Enumeration for unicode encodings.  Used by ops such as
 // tf.strings.unicode_encode and tf.strings.unicode_decode.
 enum class UnicodeEncoding { UTF8, UTF16BE, UTF32BE };
@@ -41,6 +45,14 @@ Status ParseCharUnit(const string& str, CharUnit* unit);
 // Result may be incorrect if the input string is not valid UTF-8.
 int32 UTF8StrLen(const string& str);
 
+// Allocates output `index` of `ctx`, a string tensor of `shape` whose elements
+// may be set with AssignAsView() to slices of the strings of `parent`, without
+// copying them: the output keeps `parent` alive. When tstring does not support
+// views, this allocates the output as usual and AssignAsView() copies.
+Status AllocateStringViewOutput(OpKernelContext* ctx, int index,
+                                const TensorShape& shape, const Tensor& parent,
+                                Tensor** output);
+
 // Get the next UTF8 character position starting at the given position and
 // skipping the given number of characters. Position is a byte offset, and
 // should never be `null`. The function return true if successful. However, if
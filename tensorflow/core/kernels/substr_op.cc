@@ -62,9 +62,9 @@ class SubstrOp : public OpKernel {
       auto input = input_tensor.flat<tstring>();
       // Allocate output
       Tensor* output_tensor = nullptr;
-      OP_REQUIRES_OK(context,
-                     context->allocate_output("output", input_tensor.shape(),
-                                              &output_tensor));
+      OP_REQUIRES_OK(context, AllocateStringViewOutput(
+                                  context, 0, input_tensor.shape(),
+                                  input_tensor, &output_tensor));
       auto output = output_tensor->flat<tstring>();
       if (is_scalar) {
         // Perform Op with scalar pos/len
@@ -91,7 +91,7 @@ class SubstrOp : public OpKernel {
                                           "string b'", in, "' at index ", i));
           }
           StringPiece sub_in = in.substr(byte_pos, byte_len);
-          output(i).assign(sub_in.data(), sub_in.size());
+          AssignAsView(&output(i), sub_in.data(), sub_in.size());
         }
       } else {
         // Perform Op element-wise with tensor pos/len
@@ -118,7 +118,7 @@ class SubstrOp : public OpKernel {
                                           "string b'", in, "' at index ", i));
           }
           StringPiece sub_in = in.substr(byte_pos, byte_len);
-          output(i).assign(sub_in.data(), sub_in.size());
+          AssignAsView(&output(i), sub_in.data(), sub_in.size());
         }
       }
     } else {
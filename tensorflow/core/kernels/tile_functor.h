@@ -42,6 +42,19 @@ template <typename T>
 void TileSimple(const Eigen::SyclDevice& d, Tensor* out, const Tensor& in);
 #endif
 
+// Tiles by copying contiguous runs of the input, in parallel. Returns false if
+// the device or the shape is not supported.
+template <typename T, typename Tmultiples>
+bool TileUsingCopies(const Eigen::ThreadPoolDevice& d, Tensor* out,
+                     const Tensor& in,
+                     const gtl::ArraySlice<Tmultiples>& broadcast_array);
+
+template <typename T, typename Device, typename Tmultiples>
+bool TileUsingCopies(const Device& d, Tensor* out, const Tensor& in,
+                     const gtl::ArraySlice<Tmultiples>& broadcast_array) {
+  return false;
+}
+
 template <typename Device, typename T, typename Tmultiples, int NDIM>
 void TileUsingEigen(const Device& d, Tensor* out, const Tensor& in,
                     const gtl::ArraySlice<Tmultiples>& broadcast_array) {
@@ -77,6 +90,7 @@ template <typename Device, typename T, typename Tmultiples>
 struct Tile {
   void operator()(const Device& d, Tensor* out, const Tensor& in,
                   const gtl::ArraySlice<Tmultiples> broadcast_array) const {
+    if (internal::TileUsingCopies<T>(d, out, in, broadcast_array)) return;
     switch (in.dims()) {
       case 0:
         internal::TileUsingEigen<Device, T, Tmultiples>(d, out, in,
@@ -15,6 +15,8 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/kernels/ops_util.h"
@@ -51,6 +53,57 @@ void TileSimple(const Eigen::ThreadPoolDevice& d, Tensor* out,
                 const Tensor& in) {
   return TileSimpleImpl<Eigen::ThreadPoolDevice, T>(d, out, in);
 }
+
+// The innermost input dimensions whose multiples are 1, and the dimension
+// before them, form runs that are contiguous in the input and repeated
+// back to back in the output. Each output run is filled with copies of its
+// input run.
+template <typename T, typename Tmultiples>
+bool TileUsingCopies(const Eigen::ThreadPoolDevice& d, Tensor* out,
+                     const Tensor& in,
+                     const gtl::ArraySlice<Tmultiples>& broadcast_array) {
+  const int ndims = in.dims();
+  if (ndims == 0) return false;
+  if (out->NumElements() == 0) return true;
+
+  int run_dim = ndims - 1;
+  int64 run_size = in.dim_size(run_dim);
+  while (run_dim > 0 && broadcast_array[run_dim] == 1) {
+    --run_dim;
+    run_size *= in.dim_size(run_dim);
+  }
+  const int64 repeats = broadcast_array[run_dim];
+  const int64 out_run_size = run_size * repeats;
+  gtl::InlinedVector<int64, 8> in_strides = ComputeStride<int64>(in.shape());
+  const T* p = in.flat<T>().data();
+  T* q = out->flat<T>().data();
+
+  auto tile_runs = [&](int64 begin, int64 end) {
+    for (int64 run = begin; run < end; ++run) {
+      int64 in_offset = 0;
+      int64 index = run;
+      for (int i = run_dim - 1; i >= 0; --i) {
+        const int64 out_dim_size = out->dim_size(i);
+        in_offset += index % out_dim_size % in.dim_size(i) * in_strides[i];
+        index /= out_dim_size;
+      }
+      const T* src = p + in_offset;
+      T* dst = q + run * out_run_size;
+      if (run_size == 1) {
+        std::fill(dst, dst + repeats, *src);
+      } else {
+        for (int64 i = 0; i < repeats; ++i) {
+          std::copy(src, src + run_size, dst + i * run_size);
+        }
+      }
+    }
+  };
+  Eigen::TensorOpCost cost(/*bytes_loaded=*/run_size * sizeof(T),
+                           /*bytes_stored=*/out_run_size * sizeof(T),
+                           run_dim * 2 * Eigen::TensorOpCost::DivCost<int64>());
+  d.parallelFor(out->NumElements() / out_run_size, cost, std::move(tile_runs));
+  return true;
+}
 #ifdef TENSORFLOW_USE_SYCL
 template <typename T>
 void TileSimple(const Eigen::SyclDevice& d, Tensor* out, const Tensor& in) {
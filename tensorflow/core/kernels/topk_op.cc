@@ -99,6 +99,11 @@ class TopK : public OpKernel {
 
 namespace functor {
 
+// For k above 1/kPartitionTopKRatio of the row, the rows are partitioned with
+// std::nth_element instead of being pushed through a TopN heap: the partition
+// is linear in the row size, while the heap costs log(k) per element.
+constexpr int64 kPartitionTopKRatio = 16;
+
 template <typename T>
 struct TopKFunctor<CPUDevice, T> {
   static EIGEN_ALWAYS_INLINE Status
@@ -137,6 +142,7 @@ struct TopKFunctor<CPUDevice, T> {
     }
 
     auto SortIndices = [&](int start_batch, int limit_batch) {
+      std::vector<int32> candidates;
       for (int32 b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
         const auto stable_comp = [input_data](const int32 a, const int32 b) {
@@ -151,11 +157,6 @@ struct TopKFunctor<CPUDevice, T> {
         const auto comp = [input_data](const int32 a, const int32 b) {
           return input_data[b] < input_data[a];
         };
-        // TODO(ebrevdo): For large k < num_cols, instead of using
-        // TopN, it may be faster to create a temporary vector of
-        // values 0..num_cols - 1 and then use std::partial_sort_copy
-        // of this into indices. Choosing the appropriate minimum k or
-        // ratio of k/num_cols will require some experimentation.
         if (k == num_cols) {
           auto* begin = &indices(b, 0);
           auto* end = &indices(b, k);
@@ -178,6 +179,18 @@ struct TopKFunctor<CPUDevice, T> {
             }
             run_begin = run_end;
           }
+        } else if (k * kPartitionTopKRatio > num_cols) {
+          // Partitioning with stable_comp selects the same elements as TopN,
+          // ties included.
+          candidates.resize(num_cols);
+          std::iota(candidates.begin(), candidates.end(), 0);
+          std::nth_element(candidates.begin(), candidates.begin() + k,
+                           candidates.end(), stable_comp);
+          if (sorted) {
+            std::sort(candidates.begin(), candidates.begin() + k, stable_comp);
+          }
+          std::copy(candidates.begin(), candidates.begin() + k,
+                    &indices(b, 0));
         } else {
           // Use the TopN heap object to sort.
           gtl::TopN<int32, decltype(stable_comp)> filter(k, stable_comp);
@@ -208,7 +221,8 @@ struct TopKFunctor<CPUDevice, T> {
     };
 
     // Guesstimate of cost; 4*N*log(K) where N == num_cols.
-    // If K == N, assume the cost is N*log(K + 1).
+    // If K == N, assume the cost is N*log(K + 1). Partitioning is cheaper than
+    // the heap, but the estimate stays an upper bound.
     const double cmp_cost = 3 * Eigen::TensorOpCost::AddCost<int32>() +
                             Eigen::TensorOpCost::AddCost<T>();
     const double base_cost =
@@ -23,6 +23,7 @@ limitations under the License.
 #include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "third_party/cub/block/block_scan.cuh"
 #include "third_party/cub/device/device_segmented_radix_sort.cuh"
 #include "third_party/cub/iterator/counting_input_iterator.cuh"
 #include "third_party/cub/iterator/transform_input_iterator.cuh"
@@ -431,55 +432,28 @@ struct ColumnIndexCreator {
   int num_cols_;
 };
 
+// Sorts each of the 'num_rows' rows of 'num_cols' (value, index) pairs in
+// 'input' and 'input_indices' by descending value into 'sorted_values' and
+// 'sorted_indices'. The sort is stable, so equal values keep their order.
 template <typename T>
-Status LaunchSortKernel(OpKernelContext* ctx, const T* input, int num_rows,
-                        int num_cols, int k,
-                        typename TTypes<T, 2>::Tensor values,
-                        TTypes<int, 2>::Tensor indices) {
-  const GPUDevice& d = ctx->eigen_device<GPUDevice>();
+Status SortRowsDescending(OpKernelContext* ctx, const T* input,
+                          const int* input_indices, int num_rows, int num_cols,
+                          T* sorted_values, int* sorted_indices) {
   const auto& cu_stream = GetGpuStream(ctx);
   size_t temp_storage_bytes = -1;
 
-  // TODO(ebrevdo): Once cub supports iterators for ValueT replace that tensor
-  // with an iterator that directly returns the correct value.
-  Tensor input_indices;
-  TF_RETURN_IF_ERROR(ctx->allocate_temp(
-      DT_INT32, TensorShape({num_rows, num_cols}), &input_indices));
-  auto input_indices_t = To32Bit(input_indices.flat<int32>());
-  input_indices_t.device(d) =
-      input_indices_t.generate(ColumnIndexCreator(num_cols));
-
   cub::CountingInputIterator<int> counting_iter(0);
   cub::TransformInputIterator<int, SegmentOffsetCreator,
                               cub::CountingInputIterator<int>>
       segment_offsets_t(counting_iter, SegmentOffsetCreator(num_cols));
 
-  Tensor temp_values;
-  Tensor temp_indices;
-  T* sorted_values_ptr;
-  int* sorted_indices_ptr;
-  if (k == num_cols) {
-    // Doing a full sort, no intermediate values needed.
-    sorted_values_ptr = values.data();
-    sorted_indices_ptr = indices.data();
-  } else {
-    // Need to create intermediate values for sorting.
-    TF_RETURN_IF_ERROR(ctx->allocate_temp(
-        DT_INT32, TensorShape({num_rows, num_cols}), &temp_indices));
-    TF_RETURN_IF_ERROR(ctx->allocate_temp(DataTypeToEnum<T>::value,
-                                          TensorShape({num_rows, num_cols}),
-                                          &temp_values));
-    sorted_indices_ptr = temp_indices.flat<int32>().data();
-    sorted_values_ptr = temp_values.flat<T>().data();
-  }
-
   auto err = cub::DeviceSegmentedRadixSort::SortPairsDescending(
       /* d_temp_storage */ nullptr,
       /* temp_storage_bytes */ temp_storage_bytes,
       /* d_keys_in */ input,
-      /* d_keys_out */ sorted_values_ptr,
-      /* d_values_in */ input_indices_t.data(),
-      /* d_values_out */ sorted_indices_ptr,
+      /* d_keys_out */ sorted_values,
+      /* d_values_in */ input_indices,
+      /* d_values_out */ sorted_indices,
       /* num_items */ num_cols * num_rows,
       /* num_segments */ num_rows,
       /* d_begin_offsets */ segment_offsets_t,
@@ -502,9 +476,9 @@ Status LaunchSortKernel(OpKernelContext* ctx, const T* input, int num_rows,
       /* d_temp_storage */ temp_storage.flat<int8>().data(),
       /* temp_storage_bytes */ temp_storage_bytes,
       /* d_keys_in */ input,
-      /* d_keys_out */ sorted_values_ptr,
-      /* d_values_in */ input_indices_t.data(),
-      /* d_values_out */ sorted_indices_ptr,
+      /* d_keys_out */ sorted_values,
+      /* d_values_in */ input_indices,
+      /* d_values_out */ sorted_indices,
       /* num_items */ num_cols * num_rows,
       /* num_segments */ num_rows,
       /* d_begin_offsets */ segment_offsets_t,
@@ -519,6 +493,47 @@ Status LaunchSortKernel(OpKernelContext* ctx, const T* input, int num_rows,
         "temp_storage_bytes: ",
         temp_storage_bytes, ", status: ", cudaGetErrorString(err));
   }
+  return Status::OK();
+}
+
+template <typename T>
+Status LaunchSortKernel(OpKernelContext* ctx, const T* input, int num_rows,
+                        int num_cols, int k,
+                        typename TTypes<T, 2>::Tensor values,
+                        TTypes<int, 2>::Tensor indices) {
+  const GPUDevice& d = ctx->eigen_device<GPUDevice>();
+
+  // TODO(ebrevdo): Once cub supports iterators for ValueT replace that tensor
+  // with an iterator that directly returns the correct value.
+  Tensor input_indices;
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(
+      DT_INT32, TensorShape({num_rows, num_cols}), &input_indices));
+  auto input_indices_t = To32Bit(input_indices.flat<int32>());
+  input_indices_t.device(d) =
+      input_indices_t.generate(ColumnIndexCreator(num_cols));
+
+  Tensor temp_values;
+  Tensor temp_indices;
+  T* sorted_values_ptr;
+  int* sorted_indices_ptr;
+  if (k == num_cols) {
+    // Doing a full sort, no intermediate values needed.
+    sorted_values_ptr = values.data();
+    sorted_indices_ptr = indices.data();
+  } else {
+    // Need to create intermediate values for sorting.
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(
+        DT_INT32, TensorShape({num_rows, num_cols}), &temp_indices));
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(DataTypeToEnum<T>::value,
+                                          TensorShape({num_rows, num_cols}),
+                                          &temp_values));
+    sorted_indices_ptr = temp_indices.flat<int32>().data();
+    sorted_values_ptr = temp_values.flat<T>().data();
+  }
+
+  TF_RETURN_IF_ERROR(SortRowsDescending(ctx, input, input_indices_t.data(),
+                                        num_rows, num_cols, sorted_values_ptr,
+                                        sorted_indices_ptr));
   if (k < num_cols) {
     // Need to copy subsets of sorted_indices and sorted_outputs to
     // indices and outputs.
@@ -532,6 +547,147 @@ Status LaunchSortKernel(OpKernelContext* ctx, const T* input, int num_rows,
   return Status::OK();
 }
 
+// Radix select computes the top k of each row without sorting the row. One
+// block per row narrows down the k-th largest key one digit at a time, from
+// the most significant, with a shared memory histogram of the digits of the
+// keys that still match the digits chosen so far. It then compacts the
+// elements above that key, and the first elements equal to it, in index
+// order. Only these k elements need sorting afterwards.
+constexpr int kRadixSelectThreads = 512;
+constexpr int kRadixSelectBits = 8;
+constexpr int kRadixSelectBins = 1 << kRadixSelectBits;
+
+// Returns the key of 'value' that cub's radix sort orders by, whose unsigned
+// order is the order of the values.
+template <typename T>
+__device__ EIGEN_STRONG_INLINE typename cub::Traits<T>::UnsignedBits
+RadixSelectKey(T value) {
+  typedef typename cub::Traits<T>::UnsignedBits UnsignedBits;
+  return cub::Traits<T>::TwiddleIn(
+      *reinterpret_cast<const UnsignedBits*>(&value));
+}
+
+template <typename T>
+__global__ void RadixSelectTopKKernel(const T* __restrict__ input, int length,
+                                      int k, T* __restrict__ output,
+                                      int* __restrict__ indices) {
+  typedef typename cub::Traits<T>::UnsignedBits UnsignedBits;
+  typedef cub::BlockScan<int, kRadixSelectThreads> BlockScan;
+  __shared__ int histogram[kRadixSelectBins];
+  __shared__ typename BlockScan::TempStorage scan_storage;
+  __shared__ UnsignedBits shared_prefix;
+  __shared__ int shared_remaining;
+
+  const T* row = input + static_cast<int64>(blockIdx.x) * length;
+  T* row_output = output + static_cast<int64>(blockIdx.x) * k;
+  int* row_indices = indices + static_cast<int64>(blockIdx.x) * k;
+
+  // Find the k-th largest key. 'remaining' counts how many of the keys that
+  // match 'prefix' under 'mask' are still part of the top k.
+  UnsignedBits prefix = 0;
+  UnsignedBits mask = 0;
+  int remaining = k;
+  for (int shift = sizeof(UnsignedBits) * 8 - kRadixSelectBits; shift >= 0;
+       shift -= kRadixSelectBits) {
+    for (int i = threadIdx.x; i < kRadixSelectBins; i += blockDim.x) {
+      histogram[i] = 0;
+    }
+    __syncthreads();
+    for (int i = threadIdx.x; i < length; i += blockDim.x) {
+      const UnsignedBits key = RadixSelectKey(row[i]);
+      if ((key & mask) == prefix) {
+        atomicAdd(&histogram[(key >> shift) & (kRadixSelectBins - 1)], 1);
+      }
+    }
+    __syncthreads();
+    if (threadIdx.x == 0) {
+      int bin = kRadixSelectBins - 1;
+      while (histogram[bin] < remaining) {
+        remaining -= histogram[bin];
+        --bin;
+      }
+      shared_prefix = prefix | (static_cast<UnsignedBits>(bin) << shift);
+      shared_remaining = remaining;
+    }
+    __syncthreads();
+    prefix = shared_prefix;
+    remaining = shared_remaining;
+    mask |= static_cast<UnsignedBits>(kRadixSelectBins - 1) << shift;
+  }
+
+  // Keep every key above the k-th largest, and the first 'remaining' keys
+  // equal to it, so that ties prefer lower indices.
+  int greater_before = 0;
+  int equal_before = 0;
+  for (int base = 0; base < length; base += blockDim.x) {
+    const int i = base + threadIdx.x;
+    int is_greater = 0;
+    int is_equal = 0;
+    T value;
+    if (i < length) {
+      value = row[i];
+      const UnsignedBits key = RadixSelectKey(value);
+      is_greater = key > prefix;
+      is_equal = key == prefix;
+    }
+    int greater_rank, greater_count, equal_rank, equal_count;
+    BlockScan(scan_storage).ExclusiveSum(is_greater, greater_rank,
+                                         greater_count);
+    __syncthreads();
+    BlockScan(scan_storage).ExclusiveSum(is_equal, equal_rank, equal_count);
+    __syncthreads();
+    equal_rank += equal_before;
+    if (is_greater || (is_equal && equal_rank < remaining)) {
+      const int position =
+          greater_before + greater_rank + min(equal_rank, remaining);
+      row_output[position] = value;
+      row_indices[position] = i;
+    }
+    greater_before += greater_count;
+    equal_before += equal_count;
+  }
+}
+
+template <typename T>
+Status LaunchRadixSelectKernel(OpKernelContext* ctx, const T* input,
+                               int num_rows, int num_cols, int k, bool sorted,
+                               typename TTypes<T, 2>::Tensor values,
+                               TTypes<int, 2>::Tensor indices) {
+  const auto& cu_stream = GetGpuStream(ctx);
+  if (!sorted) {
+    TF_CHECK_OK(GpuLaunchKernel(RadixSelectTopKKernel<T>, num_rows,
+                                kRadixSelectThreads, 0, cu_stream, input,
+                                num_cols, k, values.data(), indices.data()));
+    auto err = cudaGetLastError();
+    if (err != cudaSuccess) {
+      return errors::Internal("Could not launch RadixSelectTopKKernel: ",
+                              cudaGetErrorString(err), ".");
+    }
+    return Status::OK();
+  }
+
+  Tensor temp_values;
+  Tensor temp_indices;
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(
+      DataTypeToEnum<T>::value, TensorShape({num_rows, k}), &temp_values));
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(DT_INT32, TensorShape({num_rows, k}),
+                                        &temp_indices));
+  TF_CHECK_OK(GpuLaunchKernel(RadixSelectTopKKernel<T>, num_rows,
+                              kRadixSelectThreads, 0, cu_stream, input,
+                              num_cols, k, temp_values.flat<T>().data(),
+                              temp_indices.flat<int32>().data()));
+  auto err = cudaGetLastError();
+  if (err != cudaSuccess) {
+    return errors::Internal("Could not launch RadixSelectTopKKernel: ",
+                            cudaGetErrorString(err), ".");
+  }
+  // The selected elements are in index order, so the stable sort keeps
+  // preferring lower indices among equal values.
+  return SortRowsDescending(ctx, temp_values.flat<T>().data(),
+                            temp_indices.flat<int32>().data(), num_rows, k,
+                            values.data(), indices.data());
+}
+
 }  // end namespace impl
 
 namespace functor {
@@ -544,12 +700,18 @@ struct TopKFunctor<GPUDevice, T> {
           const int64 num_cols, typename TTypes<T, 2>::Tensor values,
           typename TTypes<int, 2>::Tensor indices) {
     // For small k, use the heap implementation.  For larger k, use
-    // the in-place cub sort.  For k == num_cols, always use the
-    // in-place cub sort.  The thresholds for n and k were determined
+    // radix select, which only sorts the k selected elements, unless most
+    // of the row is kept anyway; then use the in-place cub sort.  For
+    // k == num_cols, always use the in-place cub sort.  The thresholds for
+    // n and for k between the heap and the sorts were determined
     // empirically.
-    if (num_cols <= 1000 || k == num_cols || k >= 100) {
+    if (num_cols <= 1000 || k == num_cols || (k >= 100 && 2 * k > num_cols)) {
       return impl::LaunchSortKernel(context, input.data(), num_rows, num_cols,
                                     k, values, indices);
+    } else if (k >= 100) {
+      return impl::LaunchRadixSelectKernel(context, input.data(), num_rows,
+                                           num_cols, k, sorted, values,
+                                           indices);
     } else {
       const auto& cu_stream = GetGpuStream(context);
       auto err = impl::LaunchTopKKernel(cu_stream, /* num_shards */ 0,
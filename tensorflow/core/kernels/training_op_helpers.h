@@ -228,6 +228,18 @@ Status PrepareToUpdateVariable(OpKernelContext* ctx, Tensor* tensor,
   return Status::OK();
 }
 
+// Records the rows of "var" updated at "indices", for delta checkpoints.
+// Indices in device memory are not read back; updates with those mark all
+// rows as modified.
+template <typename Device>
+void RecordSparseVariableUpdate(Var* var, const Tensor& indices) {
+  if (std::is_same<Device, Eigen::ThreadPoolDevice>::value) {
+    var->RecordModifiedRows(indices);
+  } else {
+    var->RecordAllRowsModified();
+  }
+}
+
 // This gives you `*out`, a tensor you can update, corresponding to a variable
 // passed as input index `input`.  This handles the differences between
 // reference and resource variables. For reference variables we can just grab
@@ -244,11 +256,18 @@ Status GetInputTensorFromVariable(OpKernelContext* ctx, int input,
     TF_RETURN_IF_ERROR(LookupResource(ctx, HandleFromInput(ctx, input), &var));
     if (sparse) {
       TF_RETURN_IF_ERROR(EnsureSparseVariableAccess<Device, T>(ctx, var.get()));
+      const Tensor* indices;
+      if (ctx->input("indices", &indices).ok()) {
+        RecordSparseVariableUpdate<Device>(var.get(), *indices);
+      } else {
+        var->RecordAllRowsModified();
+      }
       *out = *var->tensor();
       return Status::OK();
     }
     TF_RETURN_IF_ERROR(PrepareToUpdateVariable<Device, T>(
         ctx, var->tensor(), var->copy_on_read_mode.load()));
+    var->RecordAllRowsModified();
     *out = *var->tensor();
     return Status::OK();
   }
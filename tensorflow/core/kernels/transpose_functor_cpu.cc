@@ -15,6 +15,7 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <complex>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -65,12 +66,178 @@ void TransposeSimple(const CPUDevice& device, const Tensor& in,
   device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
 }
 
+// Maps an index over some of the dimensions of the output to the offsets of
+// the element it denotes in the input and the output.
+struct TransposeOffsets {
+  gtl::InlinedVector<int64, 8> sizes;
+  gtl::InlinedVector<int64, 8> in_strides;
+  gtl::InlinedVector<int64, 8> out_strides;
+
+  void Add(int64 size, int64 in_stride, int64 out_stride) {
+    sizes.push_back(size);
+    in_strides.push_back(in_stride);
+    out_strides.push_back(out_stride);
+  }
+
+  void Get(int64 index, int64* in_offset, int64* out_offset) const {
+    *in_offset = 0;
+    *out_offset = 0;
+    for (int i = sizes.size() - 1; i >= 0; --i) {
+      const int64 quotient = index / sizes[i];
+      const int64 remainder = index - quotient * sizes[i];
+      *in_offset += remainder * in_strides[i];
+      *out_offset += remainder * out_strides[i];
+      index = quotient;
+    }
+  }
+};
+
+// The side of the square tiles that TransposeTiled copies: a row of a tile
+// spans a cache line, and tiles are at least 8x8.
+template <typename T>
+constexpr int64 TransposeTileSize() {
+  return sizeof(T) >= 8 ? 8 : 64 / sizeof(T);
+}
+
+// Copies a kSize x kSize tile of `out` from the transposed tile of `in`. The
+// constant bounds let the compiler unroll and vectorize the loops.
+template <typename T, int64 kSize>
+inline void TransposeFullTile(const T* in, int64 in_stride, T* out,
+                              int64 out_stride) {
+  for (int64 i = 0; i < kSize; ++i) {
+    for (int64 j = 0; j < kSize; ++j) {
+      out[i * out_stride + j] = in[j * in_stride + i];
+    }
+  }
+}
+
+// Like TransposeFullTile, for the `rows` x `cols` tiles at the edges of
+// `out`.
+template <typename T>
+inline void TransposePartialTile(const T* in, int64 in_stride, int64 rows,
+                                 int64 cols, T* out, int64 out_stride) {
+  for (int64 i = 0; i < rows; ++i) {
+    for (int64 j = 0; j < cols; ++j) {
+      out[i * out_stride + j] = in[j * in_stride + i];
+    }
+  }
+}
+
+// Transposes with contiguous reads and writes, in parallel. Dimensions that
+// stay adjacent are merged first. If the innermost dimension stays innermost,
+// the output is made of runs of the input, which are copied whole. Otherwise
+// the two innermost dimensions of the input and of the output are copied in
+// square tiles that fit in L1, so that both the reads along the input rows
+// and the writes along the output rows use whole cache lines.
+template <typename T>
+void TransposeTiled(const CPUDevice& device, const Tensor& in,
+                    const gtl::ArraySlice<int32> perm, Tensor* out) {
+  if (in.NumElements() == 0) return;
+  internal::TransposePermsVec out_positions;
+  internal::TransposeDimsVec new_dims;
+  internal::ReduceTransposeDimensions(in.shape(), perm, &out_positions,
+                                      &new_dims);
+  const int ndims = new_dims.size();
+  // ReduceTransposeDimensions returns the output position of each merged
+  // input dimension, the inverse of the permutation.
+  internal::TransposePermsVec new_perm(ndims);
+  for (int i = 0; i < ndims; ++i) new_perm[out_positions[i]] = i;
+  const T* p = reinterpret_cast<const T*>(in.tensor_data().data());
+  T* q = reinterpret_cast<T*>(const_cast<char*>((out->tensor_data().data())));
+
+  // The strides of each input dimension in the input and in the output.
+  gtl::InlinedVector<int64, 8> in_strides(ndims);
+  gtl::InlinedVector<int64, 8> out_strides(ndims);
+  int64 stride = 1;
+  for (int i = ndims - 1; i >= 0; --i) {
+    in_strides[i] = stride;
+    stride *= new_dims[i];
+  }
+  stride = 1;
+  for (int i = ndims - 1; i >= 0; --i) {
+    out_strides[new_perm[i]] = stride;
+    stride *= new_dims[new_perm[i]];
+  }
+  const double offset_cycles =
+      ndims * (Eigen::TensorOpCost::DivCost<int64>() +
+               2 * Eigen::TensorOpCost::MulCost<int64>() +
+               2 * Eigen::TensorOpCost::AddCost<int64>());
+
+  // The input dimensions that are innermost in the input and in the output.
+  const int in_inner = ndims - 1;
+  const int out_inner = new_perm[ndims - 1];
+  if (in_inner == out_inner) {
+    const int64 run_size = new_dims[in_inner];
+    TransposeOffsets runs;
+    for (int i = 0; i < ndims - 1; ++i) {
+      runs.Add(new_dims[new_perm[i]], in_strides[new_perm[i]],
+               out_strides[new_perm[i]]);
+    }
+    auto copy_runs = [&runs, p, q, run_size](int64 begin, int64 end) {
+      for (int64 run = begin; run < end; ++run) {
+        int64 in_offset, out_offset;
+        runs.Get(run, &in_offset, &out_offset);
+        std::copy(p + in_offset, p + in_offset + run_size, q + out_offset);
+      }
+    };
+    Eigen::TensorOpCost cost(/*bytes_loaded=*/run_size * sizeof(T),
+                             /*bytes_stored=*/run_size * sizeof(T),
+                             offset_cycles);
+    device.parallelFor(in.NumElements() / run_size, cost,
+                       std::move(copy_runs));
+    return;
+  }
+
+  constexpr int64 kTile = TransposeTileSize<T>();
+  const int64 in_inner_size = new_dims[in_inner];
+  const int64 out_inner_size = new_dims[out_inner];
+  const int64 in_inner_tiles = (in_inner_size + kTile - 1) / kTile;
+  const int64 out_inner_tiles = (out_inner_size + kTile - 1) / kTile;
+  const int64 in_stride = in_strides[out_inner];
+  const int64 out_stride = out_strides[in_inner];
+  TransposeOffsets planes;
+  for (int i = 0; i < ndims; ++i) {
+    if (new_perm[i] != in_inner && new_perm[i] != out_inner) {
+      planes.Add(new_dims[new_perm[i]], in_strides[new_perm[i]],
+                 out_strides[new_perm[i]]);
+    }
+  }
+  auto transpose_tiles = [=, &planes](int64 begin, int64 end) {
+    for (int64 tile = begin; tile < end; ++tile) {
+      const int64 plane = tile / (in_inner_tiles * out_inner_tiles);
+      const int64 row = tile / out_inner_tiles % in_inner_tiles * kTile;
+      const int64 col = tile % out_inner_tiles * kTile;
+      int64 in_offset, out_offset;
+      planes.Get(plane, &in_offset, &out_offset);
+      const T* src = p + in_offset + row + col * in_stride;
+      T* dst = q + out_offset + row * out_stride + col;
+      const int64 rows = std::min(kTile, in_inner_size - row);
+      const int64 cols = std::min(kTile, out_inner_size - col);
+      if (rows == kTile && cols == kTile) {
+        TransposeFullTile<T, kTile>(src, in_stride, dst, out_stride);
+      } else {
+        TransposePartialTile(src, in_stride, rows, cols, dst, out_stride);
+      }
+    }
+  };
+  Eigen::TensorOpCost cost(/*bytes_loaded=*/kTile * kTile * sizeof(T),
+                           /*bytes_stored=*/kTile * kTile * sizeof(T),
+                           offset_cycles);
+  const int64 num_planes = in.NumElements() / (in_inner_size * out_inner_size);
+  device.parallelFor(num_planes * in_inner_tiles * out_inner_tiles, cost,
+                     std::move(transpose_tiles));
+}
+
 }  // namespace
 
 template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const gtl::ArraySlice<int32> perm, Tensor* out) {
+    if (!conjugate) {
+      TransposeTiled<T>(d, in, perm, out);
+      return;
+    }
     switch (in.dims()) {
       case 2:
         internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
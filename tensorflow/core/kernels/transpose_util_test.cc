@@ -13,10 +13,17 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#define EIGEN_USE_THREADS
+
+#include <vector>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/kernels/transpose_functor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 
@@ -35,6 +42,40 @@ class TransposeUtilTest : public ::testing::Test {
     EXPECT_EQ(computed_perm, expected_perm);
     EXPECT_EQ(computed_dims, expected_dims);
   }
+
+  // Checks DoTranspose on CPU against indexing the input element by element.
+  template <typename T>
+  void TestTranspose(const TensorShape& shape, const std::vector<int32>& perm) {
+    Tensor in(DataTypeToEnum<T>::v(), shape);
+    test::FillFn<T>(&in, [](int i) { return static_cast<T>(i % 101); });
+    TensorShape out_shape;
+    for (int32 d : perm) out_shape.AddDim(shape.dim_size(d));
+    Tensor out(DataTypeToEnum<T>::v(), out_shape);
+    Eigen::ThreadPool threads(4);
+    Eigen::ThreadPoolDevice device(&threads, 4);
+    TF_ASSERT_OK(DoTranspose(device, in, perm, &out));
+
+    const int ndims = shape.dims();
+    std::vector<int64> in_strides(ndims);
+    int64 stride = 1;
+    for (int i = ndims - 1; i >= 0; --i) {
+      in_strides[i] = stride;
+      stride *= shape.dim_size(i);
+    }
+    Tensor expected(DataTypeToEnum<T>::v(), out_shape);
+    auto in_flat = in.flat<T>();
+    auto expected_flat = expected.flat<T>();
+    for (int64 o = 0; o < out_shape.num_elements(); ++o) {
+      int64 index = o;
+      int64 i = 0;
+      for (int d = ndims - 1; d >= 0; --d) {
+        i += index % out_shape.dim_size(d) * in_strides[perm[d]];
+        index /= out_shape.dim_size(d);
+      }
+      expected_flat(o) = in_flat(i);
+    }
+    test::ExpectTensorEqual<T>(expected, out);
+  }
 };
 
 TEST_F(TransposeUtilTest, NormalDimensionReduction) {
@@ -98,6 +139,29 @@ TEST_F(TransposeUtilTest, LargeDimensionReduction) {
                          {0, 1, 2, 3, 4, 5, 6, 7, 8, 9}, {0}, {72576000});
 }
 
+TEST_F(TransposeUtilTest, Transpose) {
+  const std::vector<std::pair<TensorShape, std::vector<int32>>> cases = {
+      {{37, 53}, {1, 0}},
+      {{5, 17, 33}, {0, 2, 1}},
+      {{5, 17, 33}, {2, 1, 0}},
+      {{5, 17, 33}, {1, 2, 0}},
+      {{4, 6, 7, 9}, {0, 3, 1, 2}},
+      {{4, 6, 7, 9}, {0, 2, 3, 1}},
+      {{2, 3, 4, 5}, {1, 0, 2, 3}},
+      {{3, 4, 5, 6, 7}, {4, 0, 2, 1, 3}},
+      {{1, 70, 1, 90}, {3, 2, 1, 0}},
+      {{2, 0, 3}, {2, 1, 0}},
+      {{2, 3, 2, 3, 2, 3, 2, 3, 2}, {8, 0, 7, 1, 6, 2, 5, 3, 4}},
+  };
+  for (const auto& c : cases) {
+    TestTranspose<int8>(c.first, c.second);
+    TestTranspose<bfloat16>(c.first, c.second);
+    TestTranspose<float>(c.first, c.second);
+    TestTranspose<int64>(c.first, c.second);
+    TestTranspose<complex128>(c.first, c.second);
+  }
+}
+
 TEST_F(TransposeUtilTest, NonSingletonDimensionAlignment) {
   // Non-singleton dims 0, 2
   EXPECT_TRUE(internal::NonSingletonDimensionsAlign({2, 1, 2}, {1, 0, 2}));
@@ -130,4 +194,43 @@ TEST_F(TransposeUtilTest, NonSingletonDimensionAlignment) {
                                                      {0, 1, 2, 5, 4, 3}));
 }
 
+template <typename T>
+static void Transpose(int iters, const TensorShape& shape,
+                      const std::vector<int32>& perm) {
+  testing::StopTiming();
+  Tensor in(DataTypeToEnum<T>::v(), shape);
+  in.flat<T>().setZero();
+  TensorShape out_shape;
+  for (int32 d : perm) out_shape.AddDim(shape.dim_size(d));
+  Tensor out(DataTypeToEnum<T>::v(), out_shape);
+  Eigen::ThreadPool threads(4);
+  Eigen::ThreadPoolDevice device(&threads, 4);
+  testing::BytesProcessed(static_cast<int64>(iters) * 2 * in.TotalBytes());
+  testing::UseRealTime();
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    TF_CHECK_OK(DoTranspose(device, in, perm, &out));
+  }
+}
+
+#define BM_TRANSPOSE(T)                                                   \
+  static void BM_TransposeNHWCToNCHW_##T(int iters, int size) {           \
+    Transpose<T>(iters, {8, size, size, 32}, {0, 3, 1, 2});               \
+  }                                                                       \
+  BENCHMARK(BM_TransposeNHWCToNCHW_##T)->Arg(16)->Arg(64)->Arg(256);      \
+  static void BM_TransposeNDHWCToNCDHW_##T(int iters, int size) {         \
+    Transpose<T>(iters, {4, size, size, size, 16}, {0, 4, 1, 2, 3});      \
+  }                                                                       \
+  BENCHMARK(BM_TransposeNDHWCToNCDHW_##T)->Arg(8)->Arg(32)->Arg(64);      \
+  static void BM_TransposeMatrix_##T(int iters, int size) {               \
+    Transpose<T>(iters, {size, size}, {1, 0});                            \
+  }                                                                       \
+  BENCHMARK(BM_TransposeMatrix_##T)->Arg(64)->Arg(1024)->Arg(4096);
+
+BM_TRANSPOSE(int8);
+BM_TRANSPOSE(bfloat16);
+BM_TRANSPOSE(float);
+
+#undef BM_TRANSPOSE
+
 }  // namespace tensorflow
@@ -13,9 +13,12 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -24,11 +27,188 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
+namespace {
+
+// 1-D inputs of integers with at least this many elements are uniquified by
+// sorting them, which runs in parallel and allocates a few flat arrays
+// instead of a node per unique value.
+constexpr int64 kMinUniqueBySortingSize = 1 << 16;
+
+// Each thread of the radix sort handles at least this many elements.
+constexpr int64 kMinRadixSortChunkSize = 1 << 14;
+
+template <typename T>
+struct CanUniqueBySorting {
+  static constexpr bool value =
+      std::is_integral<T>::value && !std::is_same<T, bool>::value;
+};
+
+// Maps an integer to an unsigned integer of the same order.
+template <typename T>
+uint64 RadixKey(T value) {
+  using U = typename std::make_unsigned<T>::type;
+  U bits = static_cast<U>(value);
+  if (std::is_signed<T>::value) {
+    bits ^= static_cast<U>(U(1) << (sizeof(T) * 8 - 1));
+  }
+  return bits;
+}
+
+// Sorts `keys` by their low `num_bytes` bytes and permutes `values` alike,
+// stably, with a least significant digit radix sort. Each pass splits the
+// keys into contiguous chunks, which count their digits and then scatter
+// their keys in parallel. Passes over a digit that all keys share are
+// skipped.
+void ParallelRadixSort(OpKernelContext* context, int num_bytes,
+                       std::vector<uint64>* keys, std::vector<int32>* values) {
+  const int64 n = keys->size();
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  const int64 num_chunks = std::max<int64>(
+      1, std::min<int64>(worker_threads.num_threads,
+                         n / kMinRadixSortChunkSize));
+  const int64 chunk_size = (n + num_chunks - 1) / num_chunks;
+  auto for_each_chunk = [&](std::function<void(int64, int64, int64)> fn) {
+    Shard(worker_threads.num_threads, worker_threads.workers, num_chunks,
+          10 * chunk_size, [&fn, n, chunk_size](int64 start, int64 limit) {
+            for (int64 chunk = start; chunk < limit; ++chunk) {
+              fn(chunk, chunk * chunk_size,
+                 std::min(n, (chunk + 1) * chunk_size));
+            }
+          });
+  };
+
+  constexpr int kRadix = 256;
+  std::vector<uint64> sorted_keys(n);
+  std::vector<int32> sorted_values(n);
+  // offsets[chunk * kRadix + digit] is where the chunk scatters its next key
+  // with this digit.
+  std::vector<int64> offsets(num_chunks * kRadix);
+  for (int shift = 0; shift < num_bytes * 8; shift += 8) {
+    std::fill(offsets.begin(), offsets.end(), 0);
+    for_each_chunk([&](int64 chunk, int64 begin, int64 end) {
+      int64* counts = &offsets[chunk * kRadix];
+      for (int64 i = begin; i < end; ++i) {
+        ++counts[((*keys)[i] >> shift) & (kRadix - 1)];
+      }
+    });
+    bool shared_digit = false;
+    int64 offset = 0;
+    for (int digit = 0; digit < kRadix; ++digit) {
+      const int64 digit_start = offset;
+      for (int64 chunk = 0; chunk < num_chunks; ++chunk) {
+        const int64 count = offsets[chunk * kRadix + digit];
+        offsets[chunk * kRadix + digit] = offset;
+        offset += count;
+      }
+      if (offset - digit_start == n) shared_digit = true;
+    }
+    if (shared_digit) continue;
+    for_each_chunk([&](int64 chunk, int64 begin, int64 end) {
+      int64* next = &offsets[chunk * kRadix];
+      for (int64 i = begin; i < end; ++i) {
+        const int64 pos = next[((*keys)[i] >> shift) & (kRadix - 1)]++;
+        sorted_keys[pos] = (*keys)[i];
+        sorted_values[pos] = (*values)[i];
+      }
+    });
+    keys->swap(sorted_keys);
+    values->swap(sorted_values);
+  }
+}
+
+// Uniquifies a large 1-D input of integers. The input is sorted with the
+// positions of its elements, so that the elements of each unique value are
+// adjacent and the first one is its first occurrence. Unique values are then
+// numbered in the order of their first occurrences, as with the hash map.
+template <typename T, typename TIndex>
+void UniqueBySorting(OpKernelContext* context, const Tensor& input,
+                     int64 axis, typename TTypes<TIndex>::Vec idx_vec,
+                     bool with_counts) {
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  auto Tin = input.flat<T>();
+  const int64 n = Tin.size();
+  std::vector<uint64> keys(n);
+  std::vector<int32> positions(n);
+  Shard(worker_threads.num_threads, worker_threads.workers, n, 10,
+        [&](int64 start, int64 limit) {
+          for (int64 i = start; i < limit; ++i) {
+            keys[i] = RadixKey(Tin(i));
+            positions[i] = i;
+          }
+        });
+  ParallelRadixSort(context, sizeof(T), &keys, &positions);
+
+  std::vector<bool> is_first(n, false);
+  for (int64 j = 0; j < n; ++j) {
+    if (j == 0 || keys[j] != keys[j - 1]) is_first[positions[j]] = true;
+  }
+  // ids[i] is the id of the value first occurring at i.
+  std::vector<TIndex> ids(n);
+  TIndex uniq_size = 0;
+  for (int64 i = 0; i < n; ++i) {
+    if (is_first[i]) ids[i] = uniq_size++;
+  }
+
+  TensorShape output_shape(input.shape());
+  output_shape.set_dim(axis, uniq_size);
+  Tensor* output = nullptr;
+  OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+  auto Tout = output->flat<T>();
+  Tensor* count_output = nullptr;
+  if (with_counts) {
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(2, TensorShape({uniq_size}),
+                                            &count_output));
+  }
+  // The id of the value of each sorted element, overwriting the keys.
+  std::vector<uint64>& sorted_ids = keys;
+  for (int64 j = 0, start = 0; j < n; ++j) {
+    if (is_first[positions[j]]) {
+      const TIndex id = ids[positions[j]];
+      Tout(id) = Tin(positions[j]);
+      start = j;
+    }
+    sorted_ids[j] = ids[positions[start]];
+    if (with_counts && (j + 1 == n || is_first[positions[j + 1]])) {
+      count_output->vec<TIndex>()(sorted_ids[j]) = j + 1 - start;
+    }
+  }
+  Shard(worker_threads.num_threads, worker_threads.workers, n, 10,
+        [&](int64 start, int64 limit) {
+          for (int64 j = start; j < limit; ++j) {
+            idx_vec(positions[j]) = sorted_ids[j];
+          }
+        });
+}
+
+// Uniquifies `input` with UniqueBySorting and returns true if its type and
+// size allow.
+template <typename T, typename TIndex>
+typename std::enable_if<CanUniqueBySorting<T>::value, bool>::type
+MaybeUniqueBySorting(OpKernelContext* context, const Tensor& input, int64 axis,
+                     typename TTypes<TIndex>::Vec idx_vec, bool with_counts) {
+  if (input.NumElements() < kMinUniqueBySortingSize) return false;
+  UniqueBySorting<T, TIndex>(context, input, axis, idx_vec, with_counts);
+  return true;
+}
+
+template <typename T, typename TIndex>
+typename std::enable_if<!CanUniqueBySorting<T>::value, bool>::type
+MaybeUniqueBySorting(OpKernelContext* context, const Tensor& input, int64 axis,
+                     typename TTypes<TIndex>::Vec idx_vec, bool with_counts) {
+  return false;
+}
+
+}  // namespace
+
 template <typename T, typename TIndex>
 class UniqueOp : public OpKernel {
  public:
@@ -98,6 +278,12 @@ class UniqueOp : public OpKernel {
                                 1, TensorShape({new_sizes[1]}), &idx));
     auto idx_vec = idx->template vec<TIndex>();
 
+    if (new_sizes[0] == 1 && new_sizes[2] == 1 &&
+        MaybeUniqueBySorting<T, TIndex>(context, input, axis, idx_vec,
+                                        num_outputs() > 2)) {
+      return;
+    }
+
     int64 uniq_size;
     if (new_sizes[0] == 1 && new_sizes[2] == 1) {
       // Specialized and faster implementation when unique is run over single
@@ -15,10 +15,15 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/node_builder.h"
@@ -35,6 +40,71 @@ namespace {
 
 const int kMaxStrLen = 40;
 
+class UniqueOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(DataType type) {
+    TF_ASSERT_OK(NodeDefBuilder("unique", "UniqueWithCounts")
+                     .Input(FakeInput(type))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Runs the op on `values` and compares it with a hash-based reference.
+  template <typename T>
+  void Check(const std::vector<T>& values) {
+    std::vector<T> expected_uniq;
+    std::vector<int32> expected_idx;
+    std::vector<int32> expected_count;
+    std::unordered_map<T, int32> ids;
+    for (const T value : values) {
+      const int32 next_id = expected_uniq.size();
+      auto it = ids.emplace(value, next_id).first;
+      if (it->second == next_id) {
+        expected_uniq.push_back(value);
+        expected_count.push_back(0);
+      }
+      expected_idx.push_back(it->second);
+      ++expected_count[it->second];
+    }
+
+    AddInputFromArray<T>(TensorShape({static_cast<int64>(values.size())}),
+                         values);
+    TF_ASSERT_OK(RunOpKernel());
+    test::ExpectTensorEqual<T>(*GetOutput(0),
+                               test::AsTensor<T>(expected_uniq));
+    test::ExpectTensorEqual<int32>(*GetOutput(1),
+                                   test::AsTensor<int32>(expected_idx));
+    test::ExpectTensorEqual<int32>(*GetOutput(2),
+                                   test::AsTensor<int32>(expected_count));
+  }
+};
+
+TEST_F(UniqueOpTest, Small) {
+  MakeOp(DT_INT64);
+  Check<int64>({3, -1, 3, 7, -1, 0});
+}
+
+// Large integer inputs are deduplicated by sorting; the outputs must still be
+// in order of first occurrence.
+TEST_F(UniqueOpTest, LargeInt64) {
+  MakeOp(DT_INT64);
+  std::vector<int64> values(1 << 18);
+  for (int64& value : values) {
+    value = (std::rand() % 5000 - 2500) * (int64{1} << 40);
+  }
+  Check<int64>(values);
+}
+
+TEST_F(UniqueOpTest, LargeInt32AllDistinct) {
+  MakeOp(DT_INT32);
+  const int32 size = 1 << 17;
+  std::vector<int32> values(size);
+  for (int32 i = 0; i < size; ++i) {
+    values[i] = (size - i) * ((i & 1) ? 1 : -1);
+  }
+  Check<int32>(values);
+}
+
 TensorProto GetRandomInt32TensorProto(int dim, int max_int) {
   TensorProto tensor_proto;
   tensor_proto.set_dtype(DT_INT32);
@@ -102,6 +172,28 @@ static void BM_Unique_INT32_Repeat(int iters, int dim, int max_int) {
   test::Benchmark("cpu", g).Run(iters);
 }
 
+static void BM_Unique_INT64(int iters, int dim, int max_int) {
+  testing::StopTiming();
+  Graph* g = new Graph(OpRegistry::Global());
+
+  Tensor input(DT_INT64, TensorShape({dim}));
+  auto input_flat = input.flat<int64>();
+  for (int i = 0; i < dim; ++i) {
+    input_flat(i) = std::rand() % max_int;
+  }
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Unique")
+                  .Input(test::graph::Constant(g, input))
+                  .Attr("T", DT_INT64)
+                  .Finalize(g, &node));
+
+  testing::BytesProcessed(static_cast<int64>(iters) * dim * sizeof(int64));
+  testing::UseRealTime();
+  testing::StartTiming();
+  test::Benchmark("cpu", g).Run(iters);
+}
+
 TensorProto GetRandomStringsTensorProto(int dim, int max_str_len) {
   TensorProto tensor_proto;
   tensor_proto.set_dtype(DT_STRING);
@@ -180,6 +272,13 @@ BENCHMARK(BM_Unique_INT32_Repeat)
     ->ArgPair(64 * 1024, 64 * 1024 * 1024)
     ->ArgPair(1024 * 1024, 64 * 1024 * 1024);
 
+BENCHMARK(BM_Unique_INT64)
+    ->ArgPair(64 * 1024, 1024)
+    ->ArgPair(64 * 1024, 1024 * 1024)
+    ->ArgPair(1024 * 1024, 1024)
+    ->ArgPair(1024 * 1024, 1024 * 1024)
+    ->ArgPair(4 * 1024 * 1024, 64 * 1024 * 1024);
+
 BENCHMARK(BM_Unique_STRING)
     ->Arg(32)
     ->Arg(256)
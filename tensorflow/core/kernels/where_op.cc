@@ -277,6 +277,66 @@ class WhereGPUOp : public AsyncOpKernel {
   template <typename Tindex>
   void ComputeAsyncType(const Tensor& input, const int input_dims,
                         OpKernelContext* context, DoneCallback done) {
+    const int64 upper_bound_bytes =
+        input.NumElements() * input_dims * sizeof(int64);
+    if (input.NumElements() > 0 &&
+        upper_bound_bytes <= kMaxUpperBoundOutputBytes) {
+      ComputeAsyncUpperBound<Tindex>(input, input_dims, context, done);
+    } else {
+      ComputeAsyncExact<Tindex>(input, input_dims, context, done);
+    }
+  }
+
+  // Selects the indices into a buffer with a row for every input element,
+  // in the same pass that counts them, and only copies the count to the
+  // host, which then exposes the filled rows as the output.  No kernel waits
+  // on the host, so the stream never stalls on the copy.  The output keeps
+  // the whole buffer alive, which is why this is limited to small inputs.
+  template <typename Tindex>
+  void ComputeAsyncUpperBound(const Tensor& input, const int input_dims,
+                              OpKernelContext* context, DoneCallback done) {
+    Tensor num_true;
+    OP_REQUIRES_OK_ASYNC(context,
+                         context->allocate_temp(DataTypeToEnum<Tindex>::v(),
+                                                TensorShape({}), &num_true),
+                         done);
+    Tensor indices;
+    OP_REQUIRES_OK_ASYNC(
+        context,
+        context->allocate_temp(
+            DT_INT64, TensorShape({input.NumElements(), input_dims}),
+            &indices),
+        done);
+
+    auto num_true_t = num_true.scalar<Tindex>();
+    OP_REQUIRES_OK_ASYNC(context,
+                         LaunchWhere<Tindex>(context, input, input_dims,
+                                             &indices, num_true_t.data()),
+                         done);
+
+    // Copy num_true to host;
+    se::DeviceMemoryBase num_true_ptr(static_cast<void*>(num_true_t.data()));
+    ScratchSpace<Tindex> num_true_host(context, 1, /* on_host */ true);
+    auto stream = context->op_device_context()->stream();
+    OP_REQUIRES_ASYNC(
+        context,
+        stream
+            ->ThenMemcpy(num_true_host.mutable_data(), num_true_ptr,
+                         sizeof(Tindex))
+            .ok(),
+        errors::Internal("WhereOp: failed to copy num_true from device"), done);
+
+    auto set_output = [context, indices, num_true_host, done]() {
+      context->set_output(0, indices.Slice(0, *num_true_host.data()));
+      done();
+    };
+    context->device()->tensorflow_gpu_device_info()->event_mgr->ThenExecute(
+        stream, set_output);
+  }
+
+  template <typename Tindex>
+  void ComputeAsyncExact(const Tensor& input, const int input_dims,
+                         OpKernelContext* context, DoneCallback done) {
     // Step 0: alloc nnz
     // Step 1: call nnz kernel
     // Step 2: copy nnz to host
@@ -309,53 +369,30 @@ class WhereGPUOp : public AsyncOpKernel {
             .ok(),
         errors::Internal("WhereOp: failed to copy num_true from device"), done);
 
-    auto create_and_check_output = [context, &d, &input, input_dims,
-                                    num_true_host, done]() {
+    // The count on the device is no longer needed once it is on the host, so
+    // the copy reuses it for the number of elements it finds.
+    Tindex* found_true = num_true_t.data();
+    auto create_and_check_output = [context, &input, input_dims, num_true,
+                                    found_true, num_true_host, done]() {
       // Ensure that within the callback, the proper GPU settings are
       // configured.
       auto stream = context->op_device_context()->stream();
       ScopedActivateExecutorContext scoped_activation{stream->parent()};
 
-      Tindex num_true = *num_true_host.data();
-
-      // TODO(ebrevdo): Properly copy back found_true value to CPU for
-      // validation checking.  Currently Where<GPUDevice>::Compute()
-      // does not perform this copy back to CPU.
-      Tindex found_true = -1;
+      Tindex num_true_value = *num_true_host.data();
 
       // Step 1: Allocate the output and perform the selection/copy.
       Tensor* output;
-      OP_REQUIRES_OK_ASYNC(context,
-                           context->allocate_output(
-                               0, TensorShape({num_true, input_dims}), &output),
-                           done);
-
-#define HANDLE_DIM(NDIM)                                              \
-  case NDIM: {                                                        \
-    Status s = functor::Where<GPUDevice, NDIM, T, Tindex>::Compute(   \
-        context, d, input.tensor<T, NDIM>(), output->matrix<int64>(), \
-        &found_true);                                                 \
-    OP_REQUIRES_OK_ASYNC(context, s, done);                           \
-  } break;
+      OP_REQUIRES_OK_ASYNC(
+          context,
+          context->allocate_output(
+              0, TensorShape({num_true_value, input_dims}), &output),
+          done);
 
-      switch (input_dims) {
-        HANDLE_DIM(1);
-        HANDLE_DIM(2);
-        HANDLE_DIM(3);
-        HANDLE_DIM(4);
-        HANDLE_DIM(5);
-        HANDLE_DIM(6);
-        HANDLE_DIM(7);
-        HANDLE_DIM(8);
-
-        default:
-          OP_REQUIRES_ASYNC(
-              context, false,
-              errors::InvalidArgument("WhereOp: Unhandled input dimensions: ",
-                                      input_dims),
-              done);
-      }
-#undef HANDLE_DIM
+      OP_REQUIRES_OK_ASYNC(
+          context,
+          LaunchWhere<Tindex>(context, input, input_dims, output, found_true),
+          done);
 
       // TODO(ebrevdo): Fix the copy back to host.
 
@@ -374,6 +411,40 @@ class WhereGPUOp : public AsyncOpKernel {
         stream, create_and_check_output);
   }
 
+  // Copies the indices of the true elements of 'input' into 'output', and
+  // their number into the device scalar 'found_true'.
+  template <typename Tindex>
+  static Status LaunchWhere(OpKernelContext* context, const Tensor& input,
+                            const int input_dims, Tensor* output,
+                            Tindex* found_true) {
+    const GPUDevice& d = context->eigen_device<GPUDevice>();
+
+#define HANDLE_DIM(NDIM)                                              \
+  case NDIM:                                                          \
+    return functor::Where<GPUDevice, NDIM, T, Tindex>::Compute(       \
+        context, d, input.tensor<T, NDIM>(), output->matrix<int64>(), \
+        found_true);
+
+    switch (input_dims) {
+      HANDLE_DIM(1);
+      HANDLE_DIM(2);
+      HANDLE_DIM(3);
+      HANDLE_DIM(4);
+      HANDLE_DIM(5);
+      HANDLE_DIM(6);
+      HANDLE_DIM(7);
+      HANDLE_DIM(8);
+
+      default:
+        return errors::InvalidArgument("WhereOp: Unhandled input dimensions: ",
+                                       input_dims);
+    }
+#undef HANDLE_DIM
+  }
+
+  // Largest output buffer, in bytes, that ComputeAsyncUpperBound allocates.
+  static constexpr int64 kMaxUpperBoundOutputBytes = 64 << 20;
+
  private:
   TF_DISALLOW_COPY_AND_ASSIGN(WhereGPUOp);
 };
@@ -46,12 +46,17 @@ struct NumTrue {
 
 template <typename Device, int NDIM, typename T, typename TIndex>
 struct Where {
-  // Copies indices of true values in input into output.  The pointer
-  // found_true should sit on the host.  Compute should copy the
-  // number of true elements found into it.  At the end, if
+  // Copies indices of true values in input into output.  Compute
+  // should copy the number of true elements found into found_true.  At
+  // the end, if
   //   *found_true != output.dimension(0),
   // then the input may have changed between the initial counting of
   // the true values and the call to Where.
+  //
+  // On the CPU, found_true should sit on the host.  On the GPU, it sits
+  // on the device, and output may have more rows than there are true
+  // elements; Compute then only fills the first *found_true rows, so
+  // the count and the copy take a single pass over the input.
   EIGEN_ALWAYS_INLINE static Status Compute(
       OpKernelContext* ctx, const Device& d,
       typename TTypes<T, NDIM>::ConstTensor input,
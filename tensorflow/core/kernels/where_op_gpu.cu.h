@@ -49,14 +49,19 @@ typedef Eigen::GpuDevice GPUDevice;
 
 namespace functor {
 
+// Converts the first min(output_rows, *found_true) flat indices in 'output'
+// into coordinates.  Reading the number of rows on the device lets 'output'
+// be an upper bound on the rows.
 template <int NDIM, typename TIndex>
 __global__ void PropagateWhereIndicesKernel(
     const TIndex output_rows, const typename Eigen::array<TIndex, NDIM> strides,
-    int64* __restrict__ output) {
+    const TIndex* __restrict__ found_true, int64* __restrict__ output) {
+  const TIndex found_rows = ldg(found_true);
+  const TIndex num_rows = found_rows < output_rows ? found_rows : output_rows;
   // TODO(ebrevdo): Use a multi-dimensional loop, increasing the
   // dimensions of individual indices manually, instead of relying on
   // a scalar loop variable and using integer division.
-  GPU_1D_KERNEL_LOOP(i, output_rows) {
+  GPU_1D_KERNEL_LOOP(i, num_rows) {
     TIndex index_value = ldg(output + NDIM * i);
 #pragma unroll
     for (int c = 0; c < NDIM; ++c) {
@@ -271,7 +276,7 @@ struct Where<GPUDevice, NDIM, T, TIndex> {
   EIGEN_ALWAYS_INLINE static Status Compute(
       OpKernelContext* ctx, const GPUDevice& d,
       typename TTypes<T, NDIM>::ConstTensor input,
-      typename TTypes<int64>::Matrix output, TIndex* found_true_host) {
+      typename TTypes<int64>::Matrix output, TIndex* found_true_device) {
     if (output.dimension(0) == 0) {
       // Nothing to do.
       return Status::OK();
@@ -281,11 +286,6 @@ struct Where<GPUDevice, NDIM, T, TIndex> {
 
     std::size_t temp_storage_bytes = 0;
 
-    Tensor found_true_t;
-    TF_RETURN_IF_ERROR(ctx->allocate_temp(DataTypeToEnum<TIndex>::v(),
-                                          TensorShape({}), &found_true_t));
-    TIndex* found_true_device = found_true_t.scalar<TIndex>().data();
-
     WhereOutputIterator<NDIM> output_iterator(
         output.data(),
         /* max_row */ output.dimension(0));
@@ -329,9 +329,6 @@ struct Where<GPUDevice, NDIM, T, TIndex> {
           GpuGetErrorString(second_success));
     }
 
-    // TODO(ebrevdo): Find a way to synchronously copy back data from
-    // found_true_device to *found_true_host.
-
     const Eigen::array<TIndex, NDIM> strides =
         CalculateStrides<TIndex, T, NDIM>(input);
     const TIndex output_rows = output.dimension(0);
@@ -339,7 +336,7 @@ struct Where<GPUDevice, NDIM, T, TIndex> {
     TF_CHECK_OK(GpuLaunchKernel(PropagateWhereIndicesKernel<NDIM, TIndex>,
                                 config.block_count, config.thread_per_block, 0,
                                 d.stream(), output_rows, strides,
-                                output.data()));
+                                found_true_device, output.data()));
 
     return Status::OK();
   }
@@ -20,7 +20,7 @@ limitations under the License.
 
 namespace tensorflow {
 
-// Winograd DeepConv2DTransform implementation for 3x3 filters.
+// Winograd F(2x2, 3x3) DeepConv2DTransform implementation for 3x3 filters.
 // Details:
 // *) Arithmetic complexity of computations: Shmuel Winograd
 // *) Fast Algorithms for Convolutional Neural Networks: Lavin, Gray
@@ -372,6 +372,145 @@ void WinogradTransform<T>::GetOutputTransformMatrix(const int64 rows,
   transform_matrix[3 * cols + 15] = T(1.0);
 };
 
+// Winograd F(4x4, 3x3) DeepConv2DTransform implementation for 3x3 filters.
+// Each 6x6 input tile produces a 4x4 output tile, so the element-wise products
+// per output are 36/16 instead of the 16/4 of WinogradTransform, at the cost
+// of larger input and output transforms and less exact transform constants.
+// The transform matrices are the kronecker products 'M * M' of the 1-D
+// matrices 'M' of Lavin and Gray.
+
+template <typename T>
+class Winograd4x4Transform : public DeepConv2DTransform<T> {
+ public:
+  typedef typename DeepConv2DTransform<T>::Shape Shape;
+
+  Winograd4x4Transform()
+      : filter_shape_(3, 3), input_shape_(6, 6), output_shape_(4, 4) {}
+
+  virtual void GetFilterTransformMatrix(const int64 rows, const int64 cols,
+                                        T* transform_matrix) const;
+
+  virtual void GetInputTransformMatrix(const int64 rows, const int64 cols,
+                                       T* transform_matrix) const;
+
+  virtual void GetOutputTransformMatrix(const int64 rows, const int64 cols,
+                                        T* transform_matrix) const;
+
+  virtual const Shape& filter_shape() const { return filter_shape_; }
+  virtual const Shape& input_shape() const { return input_shape_; }
+  virtual const Shape& output_shape() const { return output_shape_; }
+
+ private:
+  // Stores the kronecker product 'M * M' of the [m_rows, m_cols] row-major
+  // matrix 'm' in the [m_rows * m_rows, m_cols * m_cols] 'transform_matrix'.
+  static void KroneckerSquare(const double* m, const int64 m_rows,
+                              const int64 m_cols, const int64 rows,
+                              const int64 cols, T* transform_matrix);
+
+  const Shape filter_shape_;
+  const Shape input_shape_;
+  const Shape output_shape_;
+};
+
+template <typename T>
+void Winograd4x4Transform<T>::KroneckerSquare(const double* m,
+                                              const int64 m_rows,
+                                              const int64 m_cols,
+                                              const int64 rows,
+                                              const int64 cols,
+                                              T* transform_matrix) {
+  CHECK_EQ(rows, m_rows * m_rows);
+  CHECK_EQ(cols, m_cols * m_cols);
+  for (int64 r0 = 0; r0 < m_rows; ++r0) {
+    for (int64 r1 = 0; r1 < m_rows; ++r1) {
+      T* row = transform_matrix + (r0 * m_rows + r1) * cols;
+      for (int64 c0 = 0; c0 < m_cols; ++c0) {
+        for (int64 c1 = 0; c1 < m_cols; ++c1) {
+          row[c0 * m_cols + c1] =
+              T(m[r0 * m_cols + c0] * m[r1 * m_cols + c1]);
+        }
+      }
+    }
+  }
+}
+
+// The filter transform matrix is the kronecker product 'M * M' of the
+// following matrix 'M':
+//
+//   [ 1/4    0     0   ]
+//   [-1/6  -1/6  -1/6  ]
+//   [-1/6   1/6  -1/6  ]
+//   [ 1/24  1/12  1/6  ]
+//   [ 1/24 -1/12  1/6  ]
+//   [ 0     0     1    ]
+//
+// The data layout of 'transform_matrix':
+//   [input_tile_spatial_size, filter_spatial_size]
+//
+template <typename T>
+void Winograd4x4Transform<T>::GetFilterTransformMatrix(
+    const int64 rows, const int64 cols, T* transform_matrix) const {
+  static const double kMatrix[6 * 3] = {
+      1.0 / 4,  0.0,       0.0,       //
+      -1.0 / 6, -1.0 / 6,  -1.0 / 6,  //
+      -1.0 / 6, 1.0 / 6,   -1.0 / 6,  //
+      1.0 / 24, 1.0 / 12,  1.0 / 6,   //
+      1.0 / 24, -1.0 / 12, 1.0 / 6,   //
+      0.0,      0.0,       1.0,       //
+  };
+  KroneckerSquare(kMatrix, 6, 3, rows, cols, transform_matrix);
+}
+
+// The input transform matrix is the kronecker product 'M * M' of the
+// following matrix 'M':
+//
+//   [4   0  -5   0   1   0]
+//   [0  -4  -4   1   1   0]
+//   [0   4  -4  -1   1   0]
+//   [0  -2  -1   2   1   0]
+//   [0   2  -1  -2   1   0]
+//   [0   4   0  -5   0   1]
+//
+// Data layout of 'transform_matrix':
+//   [tile_spatial_size, tile_spatial_size]
+//
+template <typename T>
+void Winograd4x4Transform<T>::GetInputTransformMatrix(
+    const int64 rows, const int64 cols, T* transform_matrix) const {
+  static const double kMatrix[6 * 6] = {
+      4, 0,  -5, 0,  1, 0,  //
+      0, -4, -4, 1,  1, 0,  //
+      0, 4,  -4, -1, 1, 0,  //
+      0, -2, -1, 2,  1, 0,  //
+      0, 2,  -1, -2, 1, 0,  //
+      0, 4,  0,  -5, 0, 1,  //
+  };
+  KroneckerSquare(kMatrix, 6, 6, rows, cols, transform_matrix);
+}
+
+// The output transform matrix is the kronecker product 'M * M' of the
+// following matrix 'M':
+//
+//   [1  1  1  1  1  0]
+//   [0  1 -1  2 -2  0]
+//   [0  1  1  4  4  0]
+//   [0  1 -1  8 -8  1]
+//
+// Data layout of 'transform_matrix':
+//   [out_tile_spatial_size, tile_spatial_size]
+//
+template <typename T>
+void Winograd4x4Transform<T>::GetOutputTransformMatrix(
+    const int64 rows, const int64 cols, T* transform_matrix) const {
+  static const double kMatrix[4 * 6] = {
+      1, 1, 1,  1, 1,  0,  //
+      0, 1, -1, 2, -2, 0,  //
+      0, 1, 1,  4, 4,  0,  //
+      0, 1, -1, 8, -8, 1,  //
+  };
+  KroneckerSquare(kMatrix, 4, 6, rows, cols, transform_matrix);
+}
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_KERNELS_WINOGRAD_TRANSFORM_H_
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 
 #include <atomic>
+#include <vector>
 
 #include "absl/synchronization/barrier.h"
 #include "absl/synchronization/blocking_counter.h"
@@ -352,6 +353,36 @@ TEST(ThreadPool, ParallelForWithWorkerId) {
   }
 }
 
+TEST(ThreadPool, ParallelForWithWorkStealing) {
+  Context outer_context(ContextKind::kThread);
+  ThreadPool::WorkStealingOptions options;
+  options.numa_aware = true;
+  options.max_spin_nanos = 1000;
+  for (int64 cost_measurement_nanos : {0, 1000}) {
+    options.cost_measurement_nanos = cost_measurement_nanos;
+    for (int num_threads = 1; num_threads < kNumThreads; num_threads++) {
+      fprintf(stderr, "Testing with %d threads\n", num_threads);
+      ThreadPool pool(Env::Default(), ThreadOptions(), "test", num_threads,
+                      /*low_latency_hint=*/true, options);
+      for (int64 total : {0, 1, 15, 1000}) {
+        std::vector<std::atomic<bool>> work(total);
+        for (auto& done : work) done = false;
+        pool.ParallelFor(total, /*cost_per_unit=*/1000,
+                         [&outer_context, &work](int64 begin, int64 end) {
+                           Context inner_context(ContextKind::kThread);
+                           ASSERT_EQ(outer_context, inner_context);
+                           for (int64 i = begin; i < end; ++i) {
+                             ASSERT_FALSE(work[i].exchange(true));
+                           }
+                         });
+        for (const auto& done : work) {
+          ASSERT_TRUE(done);
+        }
+      }
+    }
+  }
+}
+
 TEST(ThreadPool, Parallelism) {
   // Test that if we have N threads and schedule N tasks,
   // all tasks will be scheduled at the same time.
@@ -113,6 +113,18 @@ void Histogram::Add(double value) {
   sum_squares_ += (value * value);
 }
 
+void Histogram::Merge(const Histogram& other) {
+  DCHECK_EQ(bucket_limits_.size(), other.bucket_limits_.size());
+  for (size_t i = 0; i < buckets_.size(); i++) {
+    buckets_[i] += other.buckets_[i];
+  }
+  if (min_ > other.min_) min_ = other.min_;
+  if (max_ < other.max_) max_ = other.max_;
+  num_ += other.num_;
+  sum_ += other.sum_;
+  sum_squares_ += other.sum_squares_;
+}
+
 double Histogram::Median() const { return Percentile(50.0); }
 
 // Linearly map the variable x from [x0, x1] unto [y0, y1]
@@ -54,6 +54,10 @@ class Histogram {
   void Clear();
   void Add(double value);
 
+  // Adds the values of `other` to this histogram.
+  // REQUIRES: `other` has the same bucket boundaries.
+  void Merge(const Histogram& other);
+
   // Save the current state of the histogram to "*proto".  If
   // "preserve_zero_buckets" is false, only non-zero bucket values and
   // ranges are saved, and the bucket boundaries of zero-valued buckets
@@ -112,6 +112,18 @@ TEST(Histogram, Basic) {
   Validate(h);
 }
 
+TEST(Histogram, Merge) {
+  Histogram h;
+  Histogram h1;
+  Histogram h2;
+  for (int i = 0; i < 100; i++) {
+    h.Add(i);
+    (i % 2 == 0 ? h1 : h2).Add(i);
+  }
+  h1.Merge(h2);
+  EXPECT_EQ(h.ToString(), h1.ToString());
+}
+
 TEST(ThreadSafeHistogram, Basic) {
   // Fill a normal histogram.
   Histogram h;
@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <limits.h>
 
+#include <algorithm>
+
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
@@ -46,6 +48,12 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
                << " No compression will be used.";
 #else
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
+#endif  // IS_SLIM_BUILD
+  } else if (compression_type == compression::kSnappy) {
+    options.compression_type = io::RecordReaderOptions::SNAPPY_COMPRESSION;
+#if defined(IS_SLIM_BUILD)
+    LOG(ERROR) << "Compression is not supported but compression_type is set."
+               << " No compression will be used.";
 #endif  // IS_SLIM_BUILD
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
@@ -71,6 +79,23 @@ RecordReader::RecordReader(RandomAccessFile* file,
     input_stream_.reset(new ZlibInputStream(
         input_stream_.release(), options.zlib_options.input_buffer_size,
         options.zlib_options.output_buffer_size, options.zlib_options, true));
+#endif  // IS_SLIM_BUILD
+  } else if (options.compression_type ==
+             RecordReaderOptions::SNAPPY_COMPRESSION) {
+#if defined(IS_SLIM_BUILD)
+    LOG(FATAL) << "Snappy compression is unsupported on mobile platforms.";
+#else   // IS_SLIM_BUILD
+    // Snappy blocks are read straight from the file, so any read buffering
+    // configured via buffer_size is subsumed by the input buffer. The input
+    // buffer has to hold a whole compressed block, which may be slightly
+    // larger than the uncompressed block for incompressible data.
+    const SnappyCompressionOptions& snappy_options = options.snappy_options;
+    input_stream_.reset(new SnappyInputBuffer(
+        file,
+        std::max(snappy_options.input_buffer_size,
+                 SnappyCompressionOptions::MaxCompressedBlockSize(
+                     snappy_options.output_buffer_size)),
+        snappy_options.output_buffer_size));
 #endif  // IS_SLIM_BUILD
   } else if (options.compression_type == RecordReaderOptions::NONE) {
     // Nothing to do.
@@ -198,6 +223,30 @@ Status RecordReader::ReadRecord(uint64* offset, tstring* record) {
   return Status::OK();
 }
 
+/* static */
+Status RecordReader::ReadIndex(RandomAccessFile* index_file,
+                               std::vector<uint64>* offsets) {
+  RecordReader reader(index_file);
+  uint64 offset = 0;
+  tstring index;
+  TF_RETURN_IF_ERROR(reader.ReadRecord(&offset, &index));
+  if (index.empty() || index.size() % sizeof(uint64) != 0) {
+    return errors::DataLoss("Malformed record index of size ", index.size());
+  }
+  const size_t num_offsets = index.size() / sizeof(uint64);
+  offsets->clear();
+  offsets->reserve(num_offsets);
+  for (size_t i = 0; i < num_offsets; ++i) {
+    offsets->push_back(core::DecodeFixed64(index.data() + i * sizeof(uint64)));
+    if (i > 0 &&
+        (*offsets)[i] < (*offsets)[i - 1] + kHeaderSize + kFooterSize) {
+      return errors::DataLoss("Record index offsets are not increasing at ",
+                              i);
+    }
+  }
+  return Status::OK();
+}
+
 SequentialRecordReader::SequentialRecordReader(
     RandomAccessFile* file, const RecordReaderOptions& options)
     : underlying_(file, options), offset_(0) {}
@@ -23,6 +23,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
@@ -41,6 +43,9 @@ io::RecordReaderOptions GetMatchingReaderOptions(
   if (options.compression_type == io::RecordWriterOptions::ZLIB_COMPRESSION) {
     return io::RecordReaderOptions::CreateRecordReaderOptions("ZLIB");
   }
+  if (options.compression_type == io::RecordWriterOptions::SNAPPY_COMPRESSION) {
+    return io::RecordReaderOptions::CreateRecordReaderOptions("SNAPPY");
+  }
   return io::RecordReaderOptions::CreateRecordReaderOptions("");
 }
 
@@ -117,6 +122,12 @@ TEST(RecordReaderWriterTest, TestZlibSyncFlush) {
   VerifyFlush(options);
 }
 
+TEST(RecordReaderWriterTest, TestSnappyFlush) {
+  io::RecordWriterOptions options =
+      io::RecordWriterOptions::CreateRecordWriterOptions("SNAPPY");
+  VerifyFlush(options);
+}
+
 TEST(RecordReaderWriterTest, TestBasics) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_test";
@@ -196,6 +207,119 @@ TEST(RecordReaderWriterTest, TestZlib) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestSnappy) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_snappy_test";
+
+  // A record that is larger than the compression buffers and does not
+  // compress, so it has to be split across several blocks.
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  string large_record(3 * 1024 + 7, '\0');
+  for (char& c : large_record) {
+    c = static_cast<char>(rnd.Uniform(256));
+  }
+
+  for (auto buf_size : {64, 1024, 65536}) {
+    {
+      std::unique_ptr<WritableFile> file;
+      TF_CHECK_OK(env->NewWritableFile(fname, &file));
+
+      io::RecordWriterOptions options =
+          io::RecordWriterOptions::CreateRecordWriterOptions("SNAPPY");
+      options.snappy_options.input_buffer_size = buf_size;
+      options.snappy_options.output_buffer_size = buf_size;
+      io::RecordWriter writer(file.get(), options);
+      TF_EXPECT_OK(writer.WriteRecord("abc"));
+      TF_EXPECT_OK(writer.WriteRecord(large_record));
+      TF_EXPECT_OK(writer.WriteRecord("defg"));
+      TF_CHECK_OK(writer.Close());
+      TF_CHECK_OK(file->Close());
+    }
+
+    {
+      std::unique_ptr<RandomAccessFile> read_file;
+      // Read it back with the RecordReader.
+      TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+      io::RecordReaderOptions options =
+          io::RecordReaderOptions::CreateRecordReaderOptions("SNAPPY");
+      options.snappy_options.input_buffer_size = buf_size;
+      options.snappy_options.output_buffer_size = buf_size;
+      io::RecordReader reader(read_file.get(), options);
+      uint64 offset = 0;
+      tstring record;
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ("abc", record);
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ(large_record, record);
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ("defg", record);
+      EXPECT_EQ(reader.ReadRecord(&offset, &record).code(),
+                error::OUT_OF_RANGE);
+
+      io::RecordReader::Metadata md;
+      TF_ASSERT_OK(reader.GetMetadata(&md));
+      EXPECT_EQ(3, md.stats.entries);
+      EXPECT_EQ(large_record.size() + 7, md.stats.data_size);
+    }
+  }
+}
+
+TEST(RecordReaderWriterTest, TestIndex) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_index_test";
+  string index_fname = fname + io::RecordWriter::kIndexSuffix;
+  std::vector<string> records = {"abc", "", "defghij", string(1000, 'x')};
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriterOptions options;
+    options.build_index = true;
+    io::RecordWriter writer(file.get(), options);
+    for (const string& record : records) {
+      TF_EXPECT_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+
+    std::unique_ptr<WritableFile> index_file;
+    TF_CHECK_OK(env->NewWritableFile(index_fname, &index_file));
+    TF_CHECK_OK(writer.WriteIndex(index_file.get()));
+    TF_CHECK_OK(index_file->Close());
+  }
+
+  std::unique_ptr<RandomAccessFile> index_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(index_fname, &index_file));
+  std::vector<uint64> offsets;
+  TF_ASSERT_OK(io::RecordReader::ReadIndex(index_file.get(), &offsets));
+  ASSERT_EQ(records.size() + 1, offsets.size());
+  EXPECT_EQ(GetFileSize(fname), offsets.back());
+
+  // Read the records back in reverse order, seeking directly to each one.
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::RecordReader reader(read_file.get());
+  for (int i = records.size() - 1; i >= 0; --i) {
+    uint64 offset = offsets[i];
+    tstring record;
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ(records[i], record);
+    EXPECT_EQ(offsets[i + 1], offset);
+  }
+}
+
+TEST(RecordReaderWriterTest, TestIndexRequiresBuildIndex) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_no_index_test";
+  std::unique_ptr<WritableFile> file;
+  TF_CHECK_OK(env->NewWritableFile(fname, &file));
+  io::RecordWriter writer(file.get());
+  TF_EXPECT_OK(writer.WriteRecord("abc"));
+  EXPECT_EQ(error::FAILED_PRECONDITION,
+            writer.WriteIndex(file.get()).code());
+}
+
 TEST(RecordReaderWriterTest, TestUseAfterClose) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_flush_close_test";
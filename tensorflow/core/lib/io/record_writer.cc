@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_writer.h"
 
 #include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/platform/env.h"
@@ -23,11 +24,17 @@ limitations under the License.
 namespace tensorflow {
 namespace io {
 namespace {
-bool IsZlibCompressed(RecordWriterOptions options) {
+bool IsZlibCompressed(const RecordWriterOptions& options) {
   return options.compression_type == RecordWriterOptions::ZLIB_COMPRESSION;
 }
+
+bool IsSnappyCompressed(const RecordWriterOptions& options) {
+  return options.compression_type == RecordWriterOptions::SNAPPY_COMPRESSION;
+}
 }  // namespace
 
+/* static */ constexpr const char* const RecordWriter::kIndexSuffix;
+
 RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
     const string& compression_type) {
   RecordWriterOptions options;
@@ -46,6 +53,12 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
                << " No compression will be used.";
 #else
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
+#endif  // IS_SLIM_BUILD
+  } else if (compression_type == compression::kSnappy) {
+    options.compression_type = io::RecordWriterOptions::SNAPPY_COMPRESSION;
+#if defined(IS_SLIM_BUILD)
+    LOG(ERROR) << "Compression is not supported but compression_type is set."
+               << " No compression will be used.";
 #endif  // IS_SLIM_BUILD
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
@@ -71,12 +84,26 @@ RecordWriter::RecordWriter(WritableFile* dest,
                  << s.ToString();
     }
     dest_ = zlib_output_buffer;
+#endif  // IS_SLIM_BUILD
+  } else if (IsSnappyCompressed(options)) {
+#if defined(IS_SLIM_BUILD)
+    LOG(FATAL) << "Snappy compression is unsupported on mobile platforms.";
+#else   // IS_SLIM_BUILD
+    dest_ = new SnappyOutputBuffer(dest,
+                                   options.snappy_options.input_buffer_size,
+                                   options.snappy_options.output_buffer_size);
 #endif  // IS_SLIM_BUILD
   } else if (options.compression_type == RecordWriterOptions::NONE) {
     // Nothing to do
   } else {
     LOG(FATAL) << "Unspecified compression type :" << options.compression_type;
   }
+  if (options.build_index &&
+      options.compression_type != RecordWriterOptions::NONE) {
+    LOG(ERROR) << "Record indices are only supported for uncompressed files."
+               << " No index will be built.";
+    options_.build_index = false;
+  }
 }
 
 RecordWriter::~RecordWriter() {
@@ -104,7 +131,12 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   PopulateFooter(footer, data.data(), data.size());
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  if (options_.build_index) {
+    record_offsets_.push_back(next_record_offset_);
+    next_record_offset_ += kHeaderSize + data.size() + kFooterSize;
+  }
+  return Status::OK();
 }
 
 #if defined(PLATFORM_GOOGLE)
@@ -124,14 +156,19 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
   PopulateFooter(footer, data);
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  if (options_.build_index) {
+    record_offsets_.push_back(next_record_offset_);
+    next_record_offset_ += kHeaderSize + data.size() + kFooterSize;
+  }
+  return Status::OK();
 }
 #endif
 
 Status RecordWriter::Close() {
   if (dest_ == nullptr) return Status::OK();
 #if !defined(IS_SLIM_BUILD)
-  if (IsZlibCompressed(options_)) {
+  if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
     Status s = dest_->Close();
     delete dest_;
     dest_ = nullptr;
@@ -141,6 +178,25 @@ Status RecordWriter::Close() {
   return Status::OK();
 }
 
+Status RecordWriter::WriteIndex(WritableFile* index_file) const {
+  if (!options_.build_index) {
+    return errors::FailedPrecondition(
+        "RecordWriter was not created with build_index set");
+  }
+  string index;
+  index.resize((record_offsets_.size() + 1) * sizeof(uint64));
+  char* dst = &index[0];
+  for (uint64 offset : record_offsets_) {
+    core::EncodeFixed64(dst, offset);
+    dst += sizeof(uint64);
+  }
+  core::EncodeFixed64(dst, next_record_offset_);
+
+  RecordWriter index_writer(index_file);
+  TF_RETURN_IF_ERROR(index_writer.WriteRecord(index));
+  return index_writer.Close();
+}
+
 Status RecordWriter::Flush() {
   if (dest_ == nullptr) {
     return Status(::tensorflow::error::FAILED_PRECONDITION,
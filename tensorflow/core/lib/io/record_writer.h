@@ -16,11 +16,15 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_LIB_IO_RECORD_WRITER_H_
 #define TENSORFLOW_CORE_LIB_IO_RECORD_WRITER_H_
 
+#include <vector>
+
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
 #if !defined(IS_SLIM_BUILD)
+#include "tensorflow/core/lib/io/snappy/snappy_compression_options.h"
+#include "tensorflow/core/lib/io/snappy/snappy_outputbuffer.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
 #endif  // IS_SLIM_BUILD
@@ -36,15 +40,28 @@ namespace io {
 
 class RecordWriterOptions {
  public:
-  enum CompressionType { NONE = 0, ZLIB_COMPRESSION = 1 };
+  enum CompressionType {
+    NONE = 0,
+    ZLIB_COMPRESSION = 1,
+    SNAPPY_COMPRESSION = 2
+  };
   CompressionType compression_type = NONE;
 
   static RecordWriterOptions CreateRecordWriterOptions(
       const string& compression_type);
 
+  // If true, the writer remembers the offset of every record it writes so
+  // that a sidecar index can be produced with RecordWriter::WriteIndex().
+  // Only supported without compression, since record offsets must be file
+  // offsets for the index to allow random access.
+  bool build_index = false;
+
 // Options specific to zlib compression.
 #if !defined(IS_SLIM_BUILD)
   tensorflow::io::ZlibCompressionOptions zlib_options;
+
+  // Options specific to snappy compression.
+  tensorflow::io::SnappyCompressionOptions snappy_options;
 #endif  // IS_SLIM_BUILD
 };
 
@@ -58,6 +75,10 @@ class RecordWriter {
   static const size_t kHeaderSize = sizeof(uint64) + sizeof(uint32);
   static const size_t kFooterSize = sizeof(uint32);
 
+  // Suffix appended to the name of a TFRecord file to get the name of its
+  // index file. See WriteIndex().
+  static constexpr const char* const kIndexSuffix = ".index";
+
   // Create a writer that will append data to "*dest".
   // "*dest" must be initially empty.
   // "*dest" must remain live while this Writer is in use.
@@ -87,6 +108,15 @@ class RecordWriter {
   // are invalid.
   Status Close();
 
+  // Writes an index of all records written so far to "*index_file", which
+  // must be initially empty. The index is a TFRecord file holding a single
+  // record: the little-endian fixed64 offsets of every record in the data
+  // file, followed by the offset one past the last record. It can be read
+  // back with RecordReader::ReadIndex().
+  //
+  // REQUIRES: options.build_index was set when creating this writer.
+  Status WriteIndex(WritableFile* index_file) const;
+
   // Utility method to populate TFRecord headers.  Populates record-header in
   // "header[0,kHeaderSize-1]".  The record-header is based on data[0, n-1].
   inline static void PopulateHeader(char* header, const char* data, size_t n);
@@ -104,6 +134,11 @@ class RecordWriter {
   WritableFile* dest_;
   RecordWriterOptions options_;
 
+  // Offsets of the records written so far, and the offset of the next one.
+  // Only maintained if options_.build_index is set.
+  std::vector<uint64> record_offsets_;
+  uint64 next_record_offset_ = 0;
+
   inline static uint32 MaskedCrc(const char* data, size_t n) {
     return crc32c::Mask(crc32c::Value(data, n));
   }
@@ -0,0 +1,53 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_SNAPPY_SNAPPY_COMPRESSION_OPTIONS_H_
+#define TENSORFLOW_CORE_LIB_IO_SNAPPY_SNAPPY_COMPRESSION_OPTIONS_H_
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+// Buffer sizes used by SnappyInputBuffer and SnappyOutputBuffer.
+//
+// Snappy streams are framed as a sequence of independently compressed blocks,
+// each prefixed by its compressed length, so a block never references data of
+// a previous block.
+struct SnappyCompressionOptions {
+  // On the writer side, the number of uncompressed bytes compressed into a
+  // single block. On the reader side, the size of the buffer used to cache
+  // data read from the file; it must be able to hold the largest compressed
+  // block (see MaxCompressedBlockSize()).
+  int64 input_buffer_size = 256 << 10;
+
+  // On the writer side, the size of the buffer caching compressed blocks
+  // before they are appended to the file. On the reader side, the size of the
+  // buffer holding one decompressed block; it must be at least the writer's
+  // input_buffer_size.
+  int64 output_buffer_size = 256 << 10;
+
+  // Returns an upper bound on the framed size of a block produced from
+  // `input_bytes` uncompressed bytes. Mirrors snappy::MaxCompressedLength and
+  // adds the 4 byte block length header.
+  static int64 MaxCompressedBlockSize(int64 input_bytes) {
+    return 32 + input_bytes + input_bytes / 6 + 4;
+  }
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_SNAPPY_SNAPPY_COMPRESSION_OPTIONS_H_
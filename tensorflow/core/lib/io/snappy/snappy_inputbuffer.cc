@@ -47,16 +47,14 @@ Status SnappyInputBuffer::ReadNBytes(int64 bytes_to_read, tstring* result) {
   return Status::OK();
 }
 
-int64 SnappyInputBuffer::Tell() const {
-  // TODO(srbs): Implement this.
-  return -1;
-}
+int64 SnappyInputBuffer::Tell() const { return bytes_read_; }
 
 Status SnappyInputBuffer::Reset() {
   file_pos_ = 0;
   avail_in_ = 0;
   avail_out_ = 0;
   next_in_ = input_buffer_.get();
+  bytes_read_ = 0;
 
   return Status::OK();
 }
@@ -68,6 +66,7 @@ size_t SnappyInputBuffer::ReadBytesFromCache(size_t bytes_to_read,
     result->append(next_out_, can_read_bytes);
     next_out_ += can_read_bytes;
     avail_out_ -= can_read_bytes;
+    bytes_read_ += can_read_bytes;
   }
 
   return can_read_bytes;
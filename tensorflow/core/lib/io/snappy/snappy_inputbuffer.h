@@ -56,6 +56,7 @@ class SnappyInputBuffer : public InputStreamInterface {
   //   If reading from file failed.
   Status ReadNBytes(int64 bytes_to_read, tstring* result) override;
 
+  // Returns the number of uncompressed bytes read so far.
   int64 Tell() const override;
 
   Status Reset() override;
@@ -119,6 +120,9 @@ class SnappyInputBuffer : public InputStreamInterface {
   // Number of unread bytes bytes available at `next_out_` in `output_buffer_`.
   size_t avail_out_ = 0;
 
+  // Number of *uncompressed* bytes that have been read from this stream.
+  int64 bytes_read_ = 0;
+
   TF_DISALLOW_COPY_AND_ASSIGN(SnappyInputBuffer);
 };
 
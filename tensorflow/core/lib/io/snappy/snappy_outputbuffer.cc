@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/lib/io/snappy/snappy_outputbuffer.h"
 
+#include <algorithm>
+
 namespace tensorflow {
 namespace io {
 
@@ -97,12 +99,19 @@ Status SnappyOutputBuffer::Write(StringPiece data) {
   // `data` is too large to fit in input buffer so we deflate it directly.
   // Note that at this point we have already deflated all existing input so
   // we do not need to backup next_in and avail_in.
-  next_in_ = const_cast<char*>(data.data());
-  avail_in_ = bytes_to_write;
-
-  TF_RETURN_IF_ERROR(Deflate());
-
-  DCHECK_EQ(avail_in_, 0);  // All input will be used up.
+  // We deflate in chunks of at most `input_buffer_capacity_` bytes so that no
+  // block decompresses to more than a reader with matching buffer sizes can
+  // hold.
+  while (!data.empty()) {
+    size_t chunk_size = std::min(data.size(), input_buffer_capacity_);
+    next_in_ = const_cast<char*>(data.data());
+    avail_in_ = chunk_size;
+
+    TF_RETURN_IF_ERROR(Deflate());
+
+    DCHECK_EQ(avail_in_, 0);  // All input will be used up.
+    data.remove_prefix(chunk_size);
+  }
 
   next_in_ = input_buffer_.get();
 
@@ -38,6 +38,10 @@ limitations under the License.
 
 #include <math.h>
 
+#if defined(__AVX2__) && !defined(__CUDA_ARCH__)
+#include <immintrin.h>
+#endif
+
 namespace tensorflow {
 namespace random {
 
@@ -190,6 +194,25 @@ class PhiloxRandom {
     return counter;
   }
 
+  // Fills 'results' with the groups of the next 'kCount' calls of operator().
+  // With AVX2, the rounds run for eight counters at a time; the results are
+  // the same as the ones of operator() either way.
+  template <int kCount>
+  void NextBatch(ResultType* results) {
+    int begin = 0;
+#if defined(__AVX2__) && !defined(__CUDA_ARCH__)
+    // The eight counters only differ in their first word, unless it wraps
+    // around, which the scalar loop handles.
+    for (; begin + 8 <= kCount && counter_[0] <= ~uint32{0} - 8; begin += 8) {
+      ComputeEightAvx2(results + begin);
+      counter_[0] += 8;
+    }
+#endif
+    for (int i = begin; i < kCount; ++i) {
+      results[i] = (*this)();
+    }
+  }
+
  private:
   // We use the same constants as recommended by the original paper.
   static const uint32 kPhiloxW32A = 0x9E3779B9;
@@ -247,6 +270,68 @@ class PhiloxRandom {
     (*key)[1] += kPhiloxW32B;
   }
 
+#if defined(__AVX2__) && !defined(__CUDA_ARCH__)
+  // Returns the lower and higher 32-bits of the products of 'a' with the
+  // eight 32-bit integers of 'b'.
+  static void MultiplyHighLowAvx2(uint32 a, __m256i b, __m256i* result_low,
+                                  __m256i* result_high) {
+    const __m256i multiplier = _mm256_set1_epi32(a);
+    // The products of the even and of the odd integers, as 64-bit integers.
+    const __m256i even = _mm256_mul_epu32(multiplier, b);
+    const __m256i odd =
+        _mm256_mul_epu32(multiplier, _mm256_srli_epi64(b, 32));
+    *result_low = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+    *result_high = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+  }
+
+  // Fills 'results' with the groups of the counters 'counter_' to
+  // 'counter_' + 7, whose first words must not wrap around.
+  void ComputeEightAvx2(ResultType* results) const {
+    __m256i counter0 = _mm256_add_epi32(_mm256_set1_epi32(counter_[0]),
+                                        _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6,
+                                                          7));
+    __m256i counter1 = _mm256_set1_epi32(counter_[1]);
+    __m256i counter2 = _mm256_set1_epi32(counter_[2]);
+    __m256i counter3 = _mm256_set1_epi32(counter_[3]);
+    uint32 key0 = key_[0];
+    uint32 key1 = key_[1];
+    for (int round = 0; round < 10; ++round) {
+      if (round > 0) {
+        key0 += kPhiloxW32A;
+        key1 += kPhiloxW32B;
+      }
+      __m256i lo0, hi0, lo1, hi1;
+      MultiplyHighLowAvx2(kPhiloxM4x32A, counter0, &lo0, &hi0);
+      MultiplyHighLowAvx2(kPhiloxM4x32B, counter2, &lo1, &hi1);
+      counter0 = _mm256_xor_si256(_mm256_xor_si256(hi1, counter1),
+                                  _mm256_set1_epi32(key0));
+      counter1 = lo1;
+      counter2 = _mm256_xor_si256(_mm256_xor_si256(hi0, counter3),
+                                  _mm256_set1_epi32(key1));
+      counter3 = lo0;
+    }
+    // Transposes the words, from word-major to counter-major.
+    const __m256i words01_lo = _mm256_unpacklo_epi32(counter0, counter1);
+    const __m256i words01_hi = _mm256_unpackhi_epi32(counter0, counter1);
+    const __m256i words23_lo = _mm256_unpacklo_epi32(counter2, counter3);
+    const __m256i words23_hi = _mm256_unpackhi_epi32(counter2, counter3);
+    // Counters 0 and 4, 1 and 5, 2 and 6, and 3 and 7.
+    const __m256i groups04 = _mm256_unpacklo_epi64(words01_lo, words23_lo);
+    const __m256i groups15 = _mm256_unpackhi_epi64(words01_lo, words23_lo);
+    const __m256i groups26 = _mm256_unpacklo_epi64(words01_hi, words23_hi);
+    const __m256i groups37 = _mm256_unpackhi_epi64(words01_hi, words23_hi);
+    __m256i* output = reinterpret_cast<__m256i*>(results);
+    _mm256_storeu_si256(output,
+                        _mm256_permute2x128_si256(groups04, groups15, 0x20));
+    _mm256_storeu_si256(output + 1,
+                        _mm256_permute2x128_si256(groups26, groups37, 0x20));
+    _mm256_storeu_si256(output + 2,
+                        _mm256_permute2x128_si256(groups04, groups15, 0x31));
+    _mm256_storeu_si256(output + 3,
+                        _mm256_permute2x128_si256(groups26, groups37, 0x31));
+  }
+#endif
+
  private:
   ResultType counter_;
   Key key_;
@@ -68,6 +68,25 @@ TEST(PhiloxRandomTest, SkipMatchTest) {
   }
 }
 
+// This test checks that NextBatch returns the same groups as operator(),
+// including when the first word of the counter wraps around.
+TEST(PhiloxRandomTest, NextBatchMatchTest) {
+  constexpr int kCount = 16;
+  PhiloxRandom gen1(GetTestSeed(), ~uint64{0});
+  gen1.Skip(~uint32{0} - 2 * kCount - 5);
+  PhiloxRandom gen2 = gen1;
+  for (int batch = 0; batch < 8; ++batch) {
+    PhiloxRandom::ResultType results[kCount];
+    gen1.NextBatch<kCount>(results);
+    for (int i = 0; i < kCount; ++i) {
+      const PhiloxRandom::ResultType expected = gen2();
+      for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+        ASSERT_EQ(expected[j], results[i][j]);
+      }
+    }
+  }
+}
+
 }  // namespace
 }  // namespace random
 }  // namespace tensorflow
@@ -51,6 +51,8 @@ REGISTER_OP("DebugIdentity")
     .Attr("tensor_name: string = ''")
     .Attr("debug_urls: list(string) = []")
     .Attr("gated_grpc: bool = false")
+    .Attr("sample_interval: int = 1")
+    .Attr("async_publish: bool = false")
     .SetAllowsUninitializedInput()
     .SetShapeFn(shape_inference::UnchangedShape);
 
@@ -62,6 +64,8 @@ REGISTER_OP("DebugNanCount")
     .Attr("tensor_name: string = ''")
     .Attr("debug_urls: list(string) = []")
     .Attr("gated_grpc: bool = false")
+    .Attr("sample_interval: int = 1")
+    .Attr("async_publish: bool = false")
     .SetAllowsUninitializedInput()
     .SetShapeFn(shape_inference::ScalarShape);
 
@@ -76,6 +80,8 @@ REGISTER_OP("DebugNumericSummary")
     .Attr("upper_bound: float = inf")
     .Attr("mute_if_healthy: bool = false")
     .Attr("gated_grpc: bool = false")
+    .Attr("sample_interval: int = 1")
+    .Attr("async_publish: bool = false")
     .SetAllowsUninitializedInput()
     // Note: this could return a more specific shape if needed in future.
     .SetShapeFn(shape_inference::UnknownShape);
@@ -63,6 +63,7 @@ REGISTER_OP("SaveV2")
     .Input("shape_and_slices: string")
     .Input("tensors: dtypes")
     .Attr("dtypes: list(type)")
+    .Attr("async_write: bool = false")
     .SetIsStateful()
     .SetShapeFn([](InferenceContext* c) {
       ShapeHandle unused;
@@ -83,6 +84,42 @@ REGISTER_OP("SaveV2")
       return Status::OK();
     });
 
+REGISTER_OP("SaveDeltaV2")
+    .Input("prefix: string")
+    .Input("base_prefix: string")
+    .Input("tensor_names: string")
+    .Input("all_rows: bool")
+    .Input("rows: N * int64")
+    .Input("tensors: dtypes")
+    .Attr("N: int >= 1")
+    .Attr("dtypes: list(type)")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      ShapeHandle s;
+      DimensionHandle unused_dim;
+
+      int n;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+      // Validate prefix and base_prefix.
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+
+      // Validate tensor_names, all_rows and rows.
+      for (int i = 2; i <= 3; ++i) {
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 1, &s));
+        TF_RETURN_IF_ERROR(c->WithValue(c->Dim(s, 0), n, &unused_dim));
+      }
+      for (int i = 4; i < 4 + n; ++i) {
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 1, &unused));
+      }
+      if (c->num_inputs() != 4 + 2 * n) {
+        return errors::InvalidArgument("Expected ", n, " tensors, got ",
+                                       c->num_inputs() - 4 - n);
+      }
+      return Status::OK();
+    });
+
 REGISTER_OP("RestoreV2")
     .Input("prefix: string")
     .Input("tensor_names: string")
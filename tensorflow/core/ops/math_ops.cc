@@ -316,6 +316,52 @@ REGISTER_OP("_UnaryOpsComposition")
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_FusedElementwise")
+    .Input("x: T")
+    .Input("args: num_args * T")
+    .Output("y: T")
+    .Attr("T: {float, double}")
+    .Attr("num_args: int >= 0")
+    .Attr("fused_ops: list(string)")
+    .Attr("arg_positions: list(int)")
+    .SetShapeFn(shape_inference::UnchangedShape)
+    .Doc(R"doc(
+Applies a chain of element-wise ops to `x` in a single pass over memory.
+
+Each entry of `fused_ops` is applied to the result of the previous one (to `x`
+for the first entry). Binary ops consume the next tensor in `args`, which must
+be a scalar or have the same shape as `x`; `arg_positions` holds the input
+position of that tensor for binary ops (0 or 1), and -1 for unary ops.
+
+*NOTE*: Do not invoke this operator directly in Python. Graph rewrite pass is
+expected to create these operators.
+)doc");
+
+REGISTER_OP("_FusedElementwiseN")
+    .Input("x: N * T")
+    .Input("args: num_args * T")
+    .Output("z: N * T")
+    .Attr("T: {float, double}")
+    .Attr("N: int >= 1")
+    .Attr("num_args: int >= 0")
+    .Attr("fused_op: string")
+    .SetShapeFn([](InferenceContext* c) {
+      for (int i = 0; i < c->num_outputs(); ++i) {
+        c->set_output(i, c->input(i));
+      }
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Applies the element-wise op `fused_op` to N independent tensors in one launch.
+
+For unary ops, `z[i] = fused_op(x[i])` and `num_args` is 0. For binary ops,
+`z[i] = fused_op(x[i], args[i])` and `num_args` is N, where `args[i]` must be
+a scalar or have the same shape as `x[i]`.
+
+*NOTE*: Do not invoke this operator directly in Python. Graph rewrite pass is
+expected to create these operators.
+)doc");
+
 #undef UNARY
 #undef UNARY_REAL
 #undef UNARY_COMPLEX
@@ -1680,6 +1726,30 @@ REGISTER_OP("QuantizedMatMul")
       return Status::OK();
     });
 
+REGISTER_OP("_QuantizedMatMulPerChannel")
+    .Input("a: float")
+    .Input("b: qint8")
+    .Input("b_scales: float")
+    .Output("product: float")
+    .Attr("transpose_a: bool = false")
+    .Attr("transpose_b: bool = false")
+    .Attr("min_a: float")
+    .Attr("max_a: float")
+    .SetShapeFn([](InferenceContext* c) {
+      TF_RETURN_IF_ERROR(shape_inference::MatMulShape(c));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &unused));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Multiplies float `a`, quantized to int8 with the range [`min_a`, `max_a`], by
+the int8 `b`, whose columns (the outputs) are quantized symmetrically with the
+scales `b_scales`, and returns the float product.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
 // Note: This op is not commutative w.r.t. to all its inputs.
 REGISTER_OP("QuantizedMul")
     .Input("x: T1")
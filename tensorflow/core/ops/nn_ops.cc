@@ -1487,6 +1487,32 @@ REGISTER_OP("QuantizedConv2D")
       return Status::OK();
     });
 
+REGISTER_OP("_QuantizedConv2DPerChannel")
+    .Input("input: float")
+    .Input("filter: qint8")
+    .Input("filter_scales: float")
+    .Output("output: float")
+    .Attr("strides: list(int)")
+    .Attr(GetPaddingAttrString())
+    .Attr("dilations: list(int) = [1, 1, 1, 1]")
+    .Attr("min_input: float")
+    .Attr("max_input: float")
+    .SetShapeFn([](InferenceContext* c) {
+      TF_RETURN_IF_ERROR(shape_inference::Conv2DShape(c));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &unused));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Convolves the NHWC float `input`, quantized to int8 with the range
+[`min_input`, `max_input`], with the int8 `filter`, whose output channels are
+quantized symmetrically with the scales `filter_scales`, and returns the float
+output.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
 REGISTER_OP("QuantizedMaxPool")
     .Input("input: T")
     .Input("min_input: float")
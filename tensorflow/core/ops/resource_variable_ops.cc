@@ -233,6 +233,18 @@ REGISTER_OP("VariableShape")
     .Attr("out_type: {int32, int64} = DT_INT32")
     .SetShapeFn(VariableShapeShapeFn);
 
+REGISTER_OP("VariableModifiedRows")
+    .Input("resource: resource")
+    .Output("rows: int64")
+    .Output("all_rows: bool")
+    .Attr("reset: bool = false")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      c->set_output(0, c->Vector(InferenceContext::kUnknownDim));
+      c->set_output(1, c->Scalar());
+      return Status::OK();
+    });
+
 REGISTER_OP("ResourceGather")
     .Input("resource: resource")
     .Input("indices: Tindices")
@@ -76,7 +76,8 @@ that allocate their outputs from the same ScopedAllocator.
 'shape' is the shape of the output, which will usually be the same shape as
 the input backing tensor.
 'reshape' is true iff the output shape is to be different from that of
-the input backing tensor.
+the input backing tensor.  The output is then the first elements of the
+backing tensor, which may be longer by the alignment padding of its last field.
 'sa_name' is the Node name of the upstream ScopedAllocator.
 'id' is the scope_id identifying the upstream ScopedAllocator.
 'N' is the number of nominal inputs to be concatenated.
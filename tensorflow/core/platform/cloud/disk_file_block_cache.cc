@@ -0,0 +1,254 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cloud/disk_file_block_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Each block file starts with the time it was fetched at, in seconds.
+constexpr size_t kHeaderSize = sizeof(uint64);
+
+// Evict once the blocks written since the last eviction reach this fraction of
+// the maximum size of the cache.
+constexpr size_t kEvictionFraction = 16;
+
+}  // namespace
+
+DiskFileBlockCache::DiskFileBlockCache(const string& cache_dir,
+                                       size_t block_size, size_t max_bytes,
+                                       uint64 max_staleness,
+                                       BlockFetcher block_fetcher, Env* env)
+    : cache_dir_(cache_dir),
+      block_size_(block_size),
+      max_bytes_(max_bytes),
+      max_staleness_(max_staleness),
+      block_fetcher_(std::move(block_fetcher)),
+      env_(env) {
+  VLOG(1) << "Disk file block cache in " << cache_dir_ << " is "
+          << (IsCacheEnabled() ? "enabled" : "disabled");
+}
+
+string DiskFileBlockCache::FilePrefix(const string& filename) const {
+  return strings::StrCat(strings::Hex(Hash64(filename)), "_");
+}
+
+string DiskFileBlockCache::BlockPath(const string& filename,
+                                     size_t offset) const {
+  int64 signature = 0;
+  {
+    mutex_lock l(mu_);
+    const auto it = file_signature_map_.find(filename);
+    if (it != file_signature_map_.end()) {
+      signature = it->second;
+    }
+  }
+  return io::JoinPath(cache_dir_, strings::StrCat(FilePrefix(filename),
+                                                  signature, "_", offset));
+}
+
+Status DiskFileBlockCache::LoadBlock(const string& path, string* data) const {
+  string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env_, path, &contents));
+  if (contents.size() < kHeaderSize) {
+    return errors::NotFound("Truncated block ", path);
+  }
+  const uint64 fetch_time = core::DecodeFixed64(contents.data());
+  if (max_staleness_ > 0 && env_->NowSeconds() - fetch_time > max_staleness_) {
+    return errors::NotFound("Stale block ", path);
+  }
+  *data = contents.substr(kHeaderSize);
+  return Status::OK();
+}
+
+Status DiskFileBlockCache::FetchBlock(const string& filename, size_t offset,
+                                      const string& path, string* data) {
+  string contents(kHeaderSize + block_size_, '\0');
+  core::EncodeFixed64(&contents[0], env_->NowSeconds());
+  size_t bytes_transferred = 0;
+  TF_RETURN_IF_ERROR(block_fetcher_(filename, offset, block_size_,
+                                    &contents[kHeaderSize],
+                                    &bytes_transferred));
+  contents.resize(kHeaderSize + bytes_transferred);
+  *data = contents.substr(kHeaderSize);
+
+  // Publish the block atomically. Failing to store it only costs a later
+  // fetch.
+  const string tmp_path =
+      strings::StrCat(path, ".tmp", strings::Hex(random::New64()));
+  Status status = WriteStringToFile(env_, tmp_path, contents);
+  if (status.ok()) {
+    status = env_->RenameFile(tmp_path, path);
+  }
+  if (!status.ok()) {
+    VLOG(1) << "Could not store block " << path << ": " << status;
+    env_->DeleteFile(tmp_path).IgnoreError();
+    return Status::OK();
+  }
+
+  bool evict = false;
+  {
+    mutex_lock l(mu_);
+    bytes_since_eviction_ += contents.size();
+    if (bytes_since_eviction_ >= max_bytes_ / kEvictionFraction) {
+      bytes_since_eviction_ = 0;
+      evict = true;
+    }
+  }
+  if (evict) {
+    Evict();
+  }
+  return Status::OK();
+}
+
+Status DiskFileBlockCache::Read(const string& filename, size_t offset,
+                                size_t n, char* buffer,
+                                size_t* bytes_transferred) {
+  *bytes_transferred = 0;
+  if (n == 0) {
+    return Status::OK();
+  }
+  if (!IsCacheEnabled() || (n > max_bytes_)) {
+    // The cache is effectively disabled, so we pass the read through to the
+    // fetcher without breaking it up into blocks.
+    return block_fetcher_(filename, offset, n, buffer, bytes_transferred);
+  }
+  // Calculate the block-aligned start and end of the read.
+  size_t start = block_size_ * (offset / block_size_);
+  size_t finish = block_size_ * ((offset + n) / block_size_);
+  if (finish < offset + n) {
+    finish += block_size_;
+  }
+  size_t total_bytes_transferred = 0;
+  // Now iterate through the blocks, reading them one at a time.
+  for (size_t pos = start; pos < finish; pos += block_size_) {
+    const string path = BlockPath(filename, pos);
+    string data;
+    if (!LoadBlock(path, &data).ok()) {
+      TF_RETURN_IF_ERROR(FetchBlock(filename, pos, path, &data));
+    }
+    if (offset >= pos + data.size()) {
+      // The requested offset is at or beyond the end of the file.
+      *bytes_transferred = total_bytes_transferred;
+      return errors::OutOfRange("EOF at offset ", offset, " in file ", filename,
+                                " at position ", pos, " with data size ",
+                                data.size());
+    }
+    const size_t begin = offset > pos ? offset - pos : 0;
+    const size_t end = std::min(data.size(), offset + n - pos);
+    if (begin < end) {
+      memcpy(&buffer[total_bytes_transferred], data.data() + begin,
+             end - begin);
+      total_bytes_transferred += end - begin;
+    }
+    if (data.size() < block_size_) {
+      // The block was a partial block and thus signals EOF at its upper bound.
+      break;
+    }
+  }
+  *bytes_transferred = total_bytes_transferred;
+  return Status::OK();
+}
+
+bool DiskFileBlockCache::ValidateAndUpdateFileSignature(const string& filename,
+                                                        int64 file_signature) {
+  mutex_lock l(mu_);
+  auto it = file_signature_map_.find(filename);
+  if (it != file_signature_map_.end()) {
+    if (it->second == file_signature) {
+      return true;
+    }
+    it->second = file_signature;
+    return false;
+  }
+  file_signature_map_[filename] = file_signature;
+  return true;
+}
+
+void DiskFileBlockCache::RemoveFile(const string& filename) {
+  RemoveBlocks(FilePrefix(filename));
+}
+
+void DiskFileBlockCache::Flush() {
+  RemoveBlocks("");
+  mutex_lock l(mu_);
+  bytes_since_eviction_ = 0;
+}
+
+void DiskFileBlockCache::RemoveBlocks(const string& prefix) {
+  std::vector<string> children;
+  if (!env_->GetChildren(cache_dir_, &children).ok()) return;
+  for (const string& child : children) {
+    if (str_util::StartsWith(child, prefix)) {
+      env_->DeleteFile(io::JoinPath(cache_dir_, child)).IgnoreError();
+    }
+  }
+}
+
+size_t DiskFileBlockCache::CacheSize() const {
+  std::vector<string> children;
+  if (!env_->GetChildren(cache_dir_, &children).ok()) return 0;
+  size_t size = 0;
+  for (const string& child : children) {
+    FileStatistics stat;
+    if (env_->Stat(io::JoinPath(cache_dir_, child), &stat).ok()) {
+      size += stat.length;
+    }
+  }
+  return size;
+}
+
+void DiskFileBlockCache::Evict() {
+  std::vector<string> children;
+  if (!env_->GetChildren(cache_dir_, &children).ok()) return;
+  // (modification time, size, path) of every file of the cache, including the
+  // temporary files of other processes, which are deleted once they get old.
+  std::vector<std::tuple<int64, size_t, string>> blocks;
+  size_t size = 0;
+  for (const string& child : children) {
+    const string path = io::JoinPath(cache_dir_, child);
+    FileStatistics stat;
+    if (env_->Stat(path, &stat).ok() && !stat.is_directory) {
+      blocks.emplace_back(stat.mtime_nsec, stat.length, path);
+      size += stat.length;
+    }
+  }
+  if (size <= max_bytes_) return;
+  std::sort(blocks.begin(), blocks.end());
+  for (const auto& block : blocks) {
+    if (size <= max_bytes_) break;
+    // Another process may delete the same block concurrently.
+    if (env_->DeleteFile(std::get<2>(block)).ok()) {
+      size -= std::get<1>(block);
+    }
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,134 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
+#define TENSORFLOW_CORE_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
+
+#include <map>
+#include <string>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/cloud/file_block_cache.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+/// \brief A block cache of file contents stored in a local directory, keyed by
+/// {filename, file signature, offset}.
+///
+/// Each block is a file of the cache directory, so the cache outlives the
+/// process and is shared by all the processes of a host that use the same
+/// directory (e.g. the trainers reading the same dataset from GCS). Blocks are
+/// published by atomically renaming a fully written temporary file, so
+/// processes never see partial blocks and need no locking: the directory
+/// itself is the shared index. A block that several processes miss at once
+/// may be fetched more than once.
+///
+/// When the blocks written by this process since the last check exceed a
+/// fraction of `max_bytes`, the oldest blocks of the directory are deleted
+/// until it holds at most `max_bytes`.
+class DiskFileBlockCache : public FileBlockCache {
+ public:
+  /// `cache_dir` must exist.
+  DiskFileBlockCache(const string& cache_dir, size_t block_size,
+                     size_t max_bytes, uint64 max_staleness,
+                     BlockFetcher block_fetcher, Env* env = Env::Default());
+
+  /// Read `n` bytes from `filename` starting at `offset` into `out`. This
+  /// method will return:
+  ///
+  /// 1) The error from the remote filesystem, if the read from the remote
+  ///    filesystem failed.
+  /// 2) OUT_OF_RANGE if the read from the remote filesystem succeeded, but
+  ///    the file contents do not extend past `offset` and thus nothing was
+  ///    placed in `out`.
+  /// 3) OK otherwise (i.e. the read succeeded, and at least one byte was placed
+  ///    in `out`).
+  Status Read(const string& filename, size_t offset, size_t n, char* buffer,
+              size_t* bytes_transferred) override;
+
+  // Validate the given file signature with the existing file signature in the
+  // cache. Returns true if the signature doesn't change or the file did not
+  // exist before. Blocks are keyed by signature, so the blocks of an older
+  // version of the file are never read again and age out of the cache.
+  bool ValidateAndUpdateFileSignature(const string& filename,
+                                      int64 file_signature) override
+      LOCKS_EXCLUDED(mu_);
+
+  /// Remove all cached blocks for `filename`, in all processes.
+  void RemoveFile(const string& filename) override LOCKS_EXCLUDED(mu_);
+
+  /// Remove all cached data, in all processes.
+  void Flush() override LOCKS_EXCLUDED(mu_);
+
+  /// Accessors for cache parameters.
+  size_t block_size() const override { return block_size_; }
+  size_t max_bytes() const override { return max_bytes_; }
+  uint64 max_staleness() const override { return max_staleness_; }
+
+  /// The current size (in bytes) of the cache directory.
+  size_t CacheSize() const override;
+
+  // Returns true if the cache is enabled. If false, the BlockFetcher callback
+  // is always executed during Read.
+  bool IsCacheEnabled() const override {
+    return block_size_ > 0 && max_bytes_ > 0;
+  }
+
+ private:
+  /// Returns the path of the block of `filename` at `offset`.
+  string BlockPath(const string& filename, size_t offset) const
+      LOCKS_EXCLUDED(mu_);
+
+  /// Returns the prefix of the names of all blocks of `filename`.
+  string FilePrefix(const string& filename) const;
+
+  /// Reads the block at `path` into `data`. Returns NOT_FOUND if the block is
+  /// missing or stale.
+  Status LoadBlock(const string& path, string* data) const;
+
+  /// Fetches the block of `filename` at `offset` into `data`, and stores it
+  /// at `path`.
+  Status FetchBlock(const string& filename, size_t offset, const string& path,
+                    string* data) LOCKS_EXCLUDED(mu_);
+
+  /// Deletes the oldest blocks until the cache holds at most max_bytes_.
+  void Evict() LOCKS_EXCLUDED(mu_);
+
+  /// Deletes the blocks whose name starts with `prefix`.
+  void RemoveBlocks(const string& prefix);
+
+  const string cache_dir_;
+  const size_t block_size_;
+  const size_t max_bytes_;
+  const uint64 max_staleness_;
+  const BlockFetcher block_fetcher_;
+  Env* const env_;
+
+  mutable mutex mu_;
+
+  /// Bytes of the blocks written by this process since the last eviction.
+  size_t bytes_since_eviction_ GUARDED_BY(mu_) = 0;
+
+  /// The signatures of the files read by this process.
+  std::map<string, int64> file_signature_map_ GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
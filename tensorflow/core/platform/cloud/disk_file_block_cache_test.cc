@@ -0,0 +1,214 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cloud/disk_file_block_cache.h"
+#include <algorithm>
+#include <cstring>
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/cloud/now_seconds_env.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+Status ReadCache(DiskFileBlockCache* cache, const string& filename,
+                 size_t offset, size_t n, std::vector<char>* out) {
+  out->clear();
+  out->resize(n, 0);
+  size_t bytes_transferred = 0;
+  Status status =
+      cache->Read(filename, offset, n, out->data(), &bytes_transferred);
+  EXPECT_LE(bytes_transferred, n);
+  out->resize(bytes_transferred, n);
+  return status;
+}
+
+// Returns a new empty cache directory for the test `name`.
+string CacheDir(const string& name) {
+  const string dir =
+      io::JoinPath(testing::TmpDir(), "disk_file_block_cache_test", name);
+  int64 undeleted_files, undeleted_dirs;
+  Env::Default()
+      ->DeleteRecursively(dir, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+  TF_CHECK_OK(Env::Default()->RecursivelyCreateDir(dir));
+  return dir;
+}
+
+TEST(DiskFileBlockCacheTest, IsCacheEnabled) {
+  auto fetcher = [](const string& filename, size_t offset, size_t n,
+                    char* buffer, size_t* bytes_transferred) {
+    // Do nothing.
+    return Status::OK();
+  };
+  const string dir = CacheDir("IsCacheEnabled");
+  DiskFileBlockCache cache1(dir, 0, 0, 0, fetcher);
+  DiskFileBlockCache cache2(dir, 16, 0, 0, fetcher);
+  DiskFileBlockCache cache3(dir, 0, 32, 0, fetcher);
+  DiskFileBlockCache cache4(dir, 16, 32, 0, fetcher);
+
+  EXPECT_FALSE(cache1.IsCacheEnabled());
+  EXPECT_FALSE(cache2.IsCacheEnabled());
+  EXPECT_FALSE(cache3.IsCacheEnabled());
+  EXPECT_TRUE(cache4.IsCacheEnabled());
+}
+
+TEST(DiskFileBlockCacheTest, SharedAcrossCaches) {
+  int calls = 0;
+  auto fetcher = [&calls](const string& filename, size_t offset, size_t n,
+                          char* buffer, size_t* bytes_transferred) {
+    calls++;
+    memset(buffer, 'a' + offset / n, n);
+    *bytes_transferred = n;
+    return Status::OK();
+  };
+  const string dir = CacheDir("SharedAcrossCaches");
+  DiskFileBlockCache cache1(dir, 8, 1024, 0, fetcher);
+  DiskFileBlockCache cache2(dir, 8, 1024, 0, fetcher);
+  std::vector<char> out;
+
+  TF_EXPECT_OK(ReadCache(&cache1, "file", 4, 8, &out));
+  EXPECT_EQ(out, std::vector<char>({'a', 'a', 'a', 'a', 'b', 'b', 'b', 'b'}));
+  EXPECT_EQ(calls, 2);
+  // The second cache reads the blocks stored by the first one.
+  TF_EXPECT_OK(ReadCache(&cache2, "file", 0, 16, &out));
+  EXPECT_EQ(out, std::vector<char>({'a', 'a', 'a', 'a', 'a', 'a', 'a', 'a',
+                                    'b', 'b', 'b', 'b', 'b', 'b', 'b', 'b'}));
+  EXPECT_EQ(calls, 2);
+  EXPECT_EQ(cache2.CacheSize(), 2 * (8 + sizeof(uint64)));
+}
+
+TEST(DiskFileBlockCacheTest, PartialBlock) {
+  auto fetcher = [](const string& filename, size_t offset, size_t n,
+                    char* buffer, size_t* bytes_transferred) {
+    // The file is 12 bytes long.
+    const size_t file_size = 12;
+    if (offset >= file_size) {
+      *bytes_transferred = 0;
+      return Status::OK();
+    }
+    *bytes_transferred = std::min(n, file_size - offset);
+    memset(buffer, 'x', *bytes_transferred);
+    return Status::OK();
+  };
+  const string dir = CacheDir("PartialBlock");
+  DiskFileBlockCache cache(dir, 8, 1024, 0, fetcher);
+  std::vector<char> out;
+
+  TF_EXPECT_OK(ReadCache(&cache, "file", 6, 16, &out));
+  EXPECT_EQ(out.size(), 6);
+  Status status = ReadCache(&cache, "file", 12, 4, &out);
+  EXPECT_TRUE(errors::IsOutOfRange(status)) << status;
+  EXPECT_TRUE(out.empty());
+}
+
+TEST(DiskFileBlockCacheTest, ValidateAndUpdateFileSignature) {
+  int calls = 0;
+  auto fetcher = [&calls](const string& filename, size_t offset, size_t n,
+                          char* buffer, size_t* bytes_transferred) {
+    calls++;
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return Status::OK();
+  };
+  const string dir = CacheDir("ValidateAndUpdateFileSignature");
+  DiskFileBlockCache cache(dir, 16, 1024, 0, fetcher);
+  std::vector<char> out;
+
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("file", 123));
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+  EXPECT_EQ(calls, 1);
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("file", 123));
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+  EXPECT_EQ(calls, 1);
+  // The file changed, so its blocks are fetched again.
+  EXPECT_FALSE(cache.ValidateAndUpdateFileSignature("file", 321));
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 16, &out));
+  EXPECT_EQ(calls, 2);
+}
+
+TEST(DiskFileBlockCacheTest, RemoveFile) {
+  int calls = 0;
+  auto fetcher = [&calls](const string& filename, size_t offset, size_t n,
+                          char* buffer, size_t* bytes_transferred) {
+    calls++;
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return Status::OK();
+  };
+  const string dir = CacheDir("RemoveFile");
+  DiskFileBlockCache cache(dir, 16, 1024, 0, fetcher);
+  std::vector<char> out;
+
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "b", 0, 16, &out));
+  EXPECT_EQ(calls, 2);
+  cache.RemoveFile("a");
+  TF_EXPECT_OK(ReadCache(&cache, "b", 0, 16, &out));
+  EXPECT_EQ(calls, 2);
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  EXPECT_EQ(calls, 3);
+  cache.Flush();
+  EXPECT_EQ(cache.CacheSize(), 0);
+}
+
+TEST(DiskFileBlockCacheTest, MaxStaleness) {
+  int calls = 0;
+  auto fetcher = [&calls](const string& filename, size_t offset, size_t n,
+                          char* buffer, size_t* bytes_transferred) {
+    calls++;
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return Status::OK();
+  };
+  const string dir = CacheDir("MaxStaleness");
+  std::unique_ptr<NowSecondsEnv> env(new NowSecondsEnv);
+  DiskFileBlockCache cache(dir, 8, 1024, 2, fetcher, env.get());
+  std::vector<char> out;
+
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 8, &out));
+  EXPECT_EQ(calls, 1);
+  env->SetNowSeconds(3);
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 8, &out));
+  EXPECT_EQ(calls, 1);
+  // The block is now older than the max staleness.
+  env->SetNowSeconds(4);
+  TF_EXPECT_OK(ReadCache(&cache, "file", 0, 8, &out));
+  EXPECT_EQ(calls, 2);
+}
+
+TEST(DiskFileBlockCacheTest, Eviction) {
+  auto fetcher = [](const string& filename, size_t offset, size_t n,
+                    char* buffer, size_t* bytes_transferred) {
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return Status::OK();
+  };
+  const string dir = CacheDir("Eviction");
+  const size_t max_bytes = 4 * (8 + sizeof(uint64));
+  DiskFileBlockCache cache(dir, 8, max_bytes, 0, fetcher);
+  std::vector<char> out;
+
+  for (size_t offset = 0; offset < 128; offset += 8) {
+    TF_EXPECT_OK(ReadCache(&cache, "file", offset, 8, &out));
+    EXPECT_LE(cache.CacheSize(), max_bytes);
+  }
+  EXPECT_GT(cache.CacheSize(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
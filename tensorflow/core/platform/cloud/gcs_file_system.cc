@@ -20,7 +20,9 @@ limitations under the License.
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
 #include <fstream>
+#include <memory>
 #include <vector>
 #ifdef _WIN32
 #include <io.h>  // for _mktemp
@@ -28,6 +30,7 @@ limitations under the License.
 #include "absl/base/macros.h"
 #include "include/json/json.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/lib/io/path.h"
@@ -35,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/cloud/curl_http_request.h"
+#include "tensorflow/core/platform/cloud/disk_file_block_cache.h"
 #include "tensorflow/core/platform/cloud/file_block_cache.h"
 #include "tensorflow/core/platform/cloud/google_auth_provider.h"
 #include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
@@ -120,6 +124,26 @@ constexpr char kThrottleBucket[] = "GCS_THROTTLE_BUCKET_SIZE";
 constexpr char kTokensPerRequest[] = "GCS_TOKENS_PER_REQUEST";
 // The environment variable to configure the initial tokens (format: <int64>)
 constexpr char kInitialTokens[] = "GCS_INITIAL_TOKENS";
+// The environment variable that enables the adaptive read-ahead of uncached
+// reads, and sets the maximum number of concurrent ranged reads of a file
+// (format: <int32>). A value of 0 (the default) disables the read-ahead.
+constexpr char kReadAheadMaxParallelReads[] =
+    "GCS_READ_AHEAD_MAX_PARALLEL_READS";
+// The environment variable that overrides the size of each ranged read of the
+// read-ahead. Specified in MB.
+constexpr char kReadAheadChunkSize[] = "GCS_READ_AHEAD_CHUNK_SIZE_MB";
+constexpr size_t kDefaultReadAheadChunkSize = 16 * 1024 * 1024;
+// The environment variable that enables the parallel composite upload of new
+// files, and sets the size of each uploaded part. Specified in MB. A value of
+// 0 (the default) disables the composite upload.
+constexpr char kCompositeUploadPartSize[] = "GCS_COMPOSITE_UPLOAD_PART_SIZE_MB";
+// The environment variable that overrides the maximum number of parts of a file
+// being uploaded concurrently (format: <int32>).
+constexpr char kCompositeUploadMaxParallelParts[] =
+    "GCS_COMPOSITE_UPLOAD_MAX_PARALLEL_PARTS";
+constexpr int kDefaultCompositeUploadMaxParallelParts = 8;
+// The maximum number of source objects of a GCS compose request.
+constexpr size_t kMaxComposeSources = 32;
 
 // The environment variable to customize which GCS bucket locations are allowed,
 // if the list is empty defaults to using the region of the zone (format, comma
@@ -402,6 +426,169 @@ class BufferedGcsRandomAccessFile : public RandomAccessFile {
   mutable string buffer_ GUARDED_BY(buffer_mutex_);
 };
 
+/// \brief A GCS-based implementation of a random access file with an adaptive
+/// read-ahead.
+///
+/// Reads are served from a sliding window of consecutive chunks, each fetched
+/// by its own ranged read on `pool`. The window starts with a single chunk
+/// whenever a read falls outside of it, and doubles (up to `max_chunks`) on
+/// every read that it serves, so that a sequential reader soon has
+/// `max_chunks` ranged reads in flight while a random reader fetches one chunk
+/// at a time.
+class ReadAheadGcsRandomAccessFile : public RandomAccessFile {
+ public:
+  using ReadFn =
+      std::function<Status(const string& filename, uint64 offset, size_t n,
+                           StringPiece* result, char* scratch)>;
+
+  // Provided read_fn should be thread safe.
+  ReadAheadGcsRandomAccessFile(const string& filename, size_t chunk_size,
+                               int max_chunks, thread::ThreadPool* pool,
+                               ReadFn read_fn)
+      : filename_(filename),
+        read_fn_(std::move(read_fn)),
+        chunk_size_(chunk_size),
+        max_chunks_(max_chunks),
+        pool_(pool) {}
+
+  ~ReadAheadGcsRandomAccessFile() override {
+    // The pending chunk reads refer to this file.
+    mutex_lock l(mu_);
+    while (num_pending_ > 0) {
+      cv_.wait(l);
+    }
+  }
+
+  Status Name(StringPiece* result) const override {
+    *result = filename_;
+    return Status::OK();
+  }
+
+  /// The implementation of reads with a read-ahead window. Thread safe.
+  /// Returns `OUT_OF_RANGE` if fewer than n bytes were stored in `*result`
+  /// because of EOF.
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    mutex_lock l(mu_);
+    size_t copy_size = 0;
+    while (copy_size < n) {
+      const uint64 position = offset + copy_size;
+      while (!window_.empty() &&
+             position >= window_.front()->offset + chunk_size_) {
+        window_.pop_front();
+      }
+      if (window_.empty() || position < window_.front()->offset) {
+        // Restart the window at `position`. The dropped chunks still being
+        // read are freed once their read completes.
+        window_.clear();
+        next_chunk_offset_ = position;
+        file_size_ = std::numeric_limits<uint64>::max();
+        num_chunks_ = 1;
+      } else if (copy_size == 0) {
+        num_chunks_ = std::min(2 * num_chunks_, max_chunks_);
+      }
+      FillWindow();
+
+      std::shared_ptr<Chunk> chunk = window_.front();
+      while (!chunk->done) {
+        cv_.wait(l);
+      }
+      if (!chunk->status.ok()) {
+        // Drop the window to avoid caching bad reads.
+        const Status status = chunk->status;
+        window_.clear();
+        return status;
+      }
+      const uint64 chunk_offset = position - chunk->offset;
+      if (chunk_offset >= chunk->data.size()) break;  // EOF
+      const size_t size =
+          std::min(n - copy_size,
+                   static_cast<size_t>(chunk->data.size() - chunk_offset));
+      memcpy(scratch + copy_size, chunk->data.data() + chunk_offset, size);
+      copy_size += size;
+    }
+    *result = StringPiece(scratch, copy_size);
+    if (copy_size < n) {
+      return errors::OutOfRange("EOF reached. Requested to read ", n,
+                                " bytes from ", offset, " but only got ",
+                                copy_size, " bytes.");
+    }
+    return Status::OK();
+  }
+
+ private:
+  struct Chunk {
+    uint64 offset;
+    string data;
+    Status status;
+    bool done = false;
+  };
+
+  // Starts reading the chunks that follow the window until it holds
+  // num_chunks_ chunks, or reaches the end of the file.
+  void FillWindow() const EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    while (window_.size() < static_cast<size_t>(num_chunks_) &&
+           next_chunk_offset_ < file_size_) {
+      auto chunk = std::make_shared<Chunk>();
+      chunk->offset = next_chunk_offset_;
+      chunk->data.resize(chunk_size_);
+      next_chunk_offset_ += chunk_size_;
+      window_.push_back(chunk);
+      ++num_pending_;
+      pool_->Schedule([this, chunk]() {
+        StringPiece piece;
+        Status status = read_fn_(filename_, chunk->offset, chunk_size_, &piece,
+                                 &chunk->data[0]);
+        mutex_lock l(mu_);
+        chunk->data.resize(piece.size());
+        if (errors::IsOutOfRange(status)) {
+          status = Status::OK();
+          file_size_ = std::min(file_size_, chunk->offset + piece.size());
+        }
+        chunk->status = status;
+        chunk->done = true;
+        --num_pending_;
+        cv_.notify_all();
+      });
+    }
+  }
+
+  // The filename of this file.
+  const string filename_;
+
+  // The implementation of the read operation (provided by the GCSFileSystem).
+  const ReadFn read_fn_;
+
+  // Size of each ranged read.
+  const size_t chunk_size_;
+
+  // Maximum number of chunks of the window.
+  const int max_chunks_;
+
+  // Runs the chunk reads. Not owned.
+  thread::ThreadPool* const pool_;
+
+  // The following members are mutable in order to provide a const Read.
+  mutable mutex mu_;
+  mutable condition_variable cv_;
+
+  // Consecutive chunks, starting with the one holding the last read position.
+  mutable std::deque<std::shared_ptr<Chunk>> window_ GUARDED_BY(mu_);
+
+  // Current target size of the window, in chunks.
+  mutable int num_chunks_ GUARDED_BY(mu_) = 1;
+
+  // Offset of the chunk that follows the window.
+  mutable uint64 next_chunk_offset_ GUARDED_BY(mu_) = 0;
+
+  // Size of the file if a chunk of the window reached its end.
+  mutable uint64 file_size_ GUARDED_BY(mu_) =
+      std::numeric_limits<uint64>::max();
+
+  // Number of chunk reads in flight.
+  mutable int num_pending_ GUARDED_BY(mu_) = 0;
+};
+
 /// \brief GCS-based implementation of a writeable file.
 ///
 /// Since GCS objects are immutable, this implementation writes to a local
@@ -694,6 +881,251 @@ class GcsWritableFile : public WritableFile {
   RetryConfig retry_config_;
 };
 
+/// \brief GCS-based implementation of a writeable file that uploads its
+/// content while it is being written.
+///
+/// Appended data is buffered in memory, and every full part of `part_size`
+/// bytes is uploaded as a temporary object on `pool` while writing goes on,
+/// with at most `max_pending_parts` parts of the file in flight. Sync() uploads
+/// the last partial part and composes the parts uploaded so far into the
+/// object, then deletes them. A file that fits in one part is uploaded
+/// directly.
+class GcsCompositeWritableFile : public WritableFile {
+ public:
+  GcsCompositeWritableFile(const string& bucket, const string& object,
+                           GcsFileSystem* filesystem,
+                           GcsFileSystem::TimeoutConfig* timeouts,
+                           std::function<void()> file_cache_erase,
+                           RetryConfig retry_config, size_t part_size,
+                           int max_pending_parts, thread::ThreadPool* pool)
+      : bucket_(bucket),
+        object_(object),
+        filesystem_(filesystem),
+        timeouts_(timeouts),
+        file_cache_erase_(std::move(file_cache_erase)),
+        retry_config_(retry_config),
+        part_size_(part_size),
+        max_pending_parts_(max_pending_parts),
+        pool_(pool),
+        part_prefix_(strings::StrCat(object, ".part-")) {}
+
+  ~GcsCompositeWritableFile() override {
+    Close().IgnoreError();
+    // The pending part uploads refer to this file.
+    WaitForParts().IgnoreError();
+  }
+
+  Status Append(StringPiece data) override {
+    TF_RETURN_IF_ERROR(CheckWritable());
+    sync_needed_ = true;
+    while (!data.empty()) {
+      const size_t size = std::min(data.size(), part_size_ - buffer_.size());
+      buffer_.append(data.data(), size);
+      data.remove_prefix(size);
+      position_ += size;
+      if (buffer_.size() == part_size_) {
+        TF_RETURN_IF_ERROR(StartPartUpload());
+      }
+    }
+    return Status::OK();
+  }
+
+  Status Close() override {
+    if (!closed_) {
+      TF_RETURN_IF_ERROR(Sync());
+      closed_ = true;
+    }
+    return Status::OK();
+  }
+
+  Status Flush() override { return Sync(); }
+
+  Status Name(StringPiece* result) const override {
+    return errors::Unimplemented("GCSWritableFile does not support Name()");
+  }
+
+  Status Sync() override {
+    TF_RETURN_IF_ERROR(CheckWritable());
+    if (!sync_needed_) {
+      return Status::OK();
+    }
+    if (!object_uploaded_ && parts_.empty()) {
+      // The whole file is in the buffer.
+      TF_RETURN_IF_ERROR(RetryingUtils::CallWithRetries(
+          [this]() { return UploadObject(object_, buffer_); }, retry_config_));
+      buffer_.clear();
+      object_uploaded_ = true;
+    } else {
+      if (!buffer_.empty()) {
+        TF_RETURN_IF_ERROR(StartPartUpload());
+      }
+      TF_RETURN_IF_ERROR(WaitForParts());
+      TF_RETURN_IF_ERROR(ComposeParts());
+    }
+    // Erase the file from the file cache on every successful write.
+    file_cache_erase_();
+    sync_needed_ = false;
+    return Status::OK();
+  }
+
+  Status Tell(int64* position) override {
+    *position = position_;
+    return Status::OK();
+  }
+
+ private:
+  Status CheckWritable() const {
+    if (closed_) {
+      return errors::FailedPrecondition("The file ", GetGcsPath(),
+                                        " is closed.");
+    }
+    return Status::OK();
+  }
+
+  /// Starts uploading the buffer as the next part, once fewer than
+  /// max_pending_parts_ parts are in flight.
+  Status StartPartUpload() {
+    mutex_lock l(mu_);
+    while (num_pending_parts_ >= max_pending_parts_) {
+      cv_.wait(l);
+    }
+    TF_RETURN_IF_ERROR(upload_status_);
+    const string part = strings::StrCat(part_prefix_, next_part_index_++);
+    parts_.push_back(part);
+    auto data = std::make_shared<string>(std::move(buffer_));
+    buffer_.clear();
+    ++num_pending_parts_;
+    pool_->Schedule([this, part, data]() {
+      const Status status = RetryingUtils::CallWithRetries(
+          [this, &part, &data]() { return UploadObject(part, *data); },
+          retry_config_);
+      mutex_lock l(mu_);
+      upload_status_.Update(status);
+      --num_pending_parts_;
+      cv_.notify_all();
+    });
+    return Status::OK();
+  }
+
+  /// Waits for all the part uploads, and returns the first error, if any.
+  Status WaitForParts() {
+    mutex_lock l(mu_);
+    while (num_pending_parts_ > 0) {
+      cv_.wait(l);
+    }
+    return upload_status_;
+  }
+
+  /// Uploads `data` to the object `name` in a single request.
+  Status UploadObject(const string& name, const string& data) {
+    std::unique_ptr<HttpRequest> request;
+    TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+    request->SetUri(strings::StrCat(kGcsUploadUriBase, "b/", bucket_,
+                                    "/o?uploadType=media&name=",
+                                    request->EscapeString(name)));
+    request->SetPostFromBuffer(data.data(), data.size());
+    std::vector<char> output_buffer;
+    request->SetResultBuffer(&output_buffer);
+    request->SetTimeouts(timeouts_->connect, timeouts_->idle, timeouts_->write);
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when uploading gs://",
+                                    bucket_, "/", name);
+    return Status::OK();
+  }
+
+  /// Composes the uploaded parts into the object, appending them to its
+  /// current content if it was already uploaded, and deletes them.
+  Status ComposeParts() {
+    while (!parts_.empty()) {
+      std::vector<string> sources;
+      if (object_uploaded_) {
+        sources.push_back(object_);
+      }
+      const size_t num_parts =
+          std::min(parts_.size(), kMaxComposeSources - sources.size());
+      sources.insert(sources.end(), parts_.begin(),
+                     parts_.begin() + num_parts);
+      TF_RETURN_IF_ERROR(RetryingUtils::CallWithRetries(
+          [this, &sources]() { return ComposeObject(sources); },
+          retry_config_));
+      object_uploaded_ = true;
+      composed_parts_.insert(composed_parts_.end(), parts_.begin(),
+                             parts_.begin() + num_parts);
+      parts_.erase(parts_.begin(), parts_.begin() + num_parts);
+    }
+    while (!composed_parts_.empty()) {
+      const string path =
+          strings::StrCat("gs://", bucket_, "/", composed_parts_.back());
+      TF_RETURN_IF_ERROR(RetryingUtils::DeleteWithRetries(
+          [this, &path]() { return filesystem_->DeleteFile(path); },
+          retry_config_));
+      composed_parts_.pop_back();
+    }
+    return Status::OK();
+  }
+
+  /// Replaces the object with the concatenation of the `sources` objects.
+  Status ComposeObject(const std::vector<string>& sources) {
+    Json::Value root;
+    for (const string& source : sources) {
+      Json::Value source_object;
+      source_object["name"] = source;
+      root["sourceObjects"].append(source_object);
+    }
+    Json::FastWriter writer;
+    writer.omitEndingLineFeed();
+    const string body = writer.write(root);
+
+    std::unique_ptr<HttpRequest> request;
+    TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+    request->SetUri(strings::StrCat(kGcsUriBase, "b/", bucket_, "/o/",
+                                    request->EscapeString(object_),
+                                    "/compose"));
+    request->AddHeader("Content-Type", "application/json");
+    request->SetPostFromBuffer(body.data(), body.size());
+    std::vector<char> output_buffer;
+    request->SetResultBuffer(&output_buffer);
+    request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                         timeouts_->metadata);
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when composing ",
+                                    GetGcsPath());
+    return Status::OK();
+  }
+
+  string GetGcsPath() const {
+    return strings::StrCat("gs://", bucket_, "/", object_);
+  }
+
+  const string bucket_;
+  const string object_;
+  GcsFileSystem* const filesystem_;  // Not owned.
+  GcsFileSystem::TimeoutConfig* timeouts_;
+  std::function<void()> file_cache_erase_;
+  const RetryConfig retry_config_;
+  const size_t part_size_;
+  const int max_pending_parts_;
+  thread::ThreadPool* const pool_;  // Not owned.
+  // Names of the parts start with this prefix.
+  const string part_prefix_;
+
+  // The data appended since the last uploaded part.
+  string buffer_;
+  int64 position_ = 0;
+  // The parts uploaded or being uploaded, but not composed yet.
+  std::vector<string> parts_;
+  // The parts composed into the object, but not deleted yet.
+  std::vector<string> composed_parts_;
+  int next_part_index_ = 0;
+  // Whether the object holds the content of the previous Sync().
+  bool object_uploaded_ = false;
+  bool sync_needed_ = true;
+  bool closed_ = false;
+
+  mutex mu_;
+  condition_variable cv_;
+  int num_pending_parts_ GUARDED_BY(mu_) = 0;
+  Status upload_status_ GUARDED_BY(mu_);
+};
+
 class GcsReadOnlyMemoryRegion : public ReadOnlyMemoryRegion {
  public:
   GcsReadOnlyMemoryRegion(std::unique_ptr<char[]> data, uint64 length)
@@ -762,6 +1194,17 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   if (!make_default_cache) {
     max_bytes = 0;
   }
+  const char* disk_cache_dir = std::getenv(kDiskCacheDir);
+  if (disk_cache_dir != nullptr && max_bytes > 0) {
+    Status status = Env::Default()->RecursivelyCreateDir(disk_cache_dir);
+    if (status.ok()) {
+      block_cache_disk_dir_ = disk_cache_dir;
+    } else {
+      LOG(WARNING) << "Caching GCS reads in memory, as the disk cache "
+                   << "directory " << disk_cache_dir
+                   << " could not be created: " << status;
+    }
+  }
   VLOG(1) << "GCS cache max size = " << max_bytes << " ; "
           << "block size = " << block_size_ << " ; "
           << "max staleness = " << max_staleness;
@@ -877,6 +1320,30 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
 
   GetEnvVar(kAllowedBucketLocations, SplitByCommaToLowercaseSet,
             &allowed_locations_);
+
+  int32 max_parallel_reads;
+  if (GetEnvVar(kReadAheadMaxParallelReads, strings::safe_strto32,
+                &max_parallel_reads) &&
+      max_parallel_reads > 0) {
+    size_t chunk_size = kDefaultReadAheadChunkSize;
+    if (GetEnvVar(kReadAheadChunkSize, strings::safe_strtou64, &value)) {
+      chunk_size = value * 1024 * 1024;
+    }
+    VLOG(1) << "GCS read-ahead ENABLED. Chunk size = " << chunk_size
+            << " ; max parallel reads = " << max_parallel_reads;
+    SetReadAheadConfig(chunk_size, max_parallel_reads);
+  }
+
+  if (GetEnvVar(kCompositeUploadPartSize, strings::safe_strtou64, &value) &&
+      value > 0) {
+    int32 max_parallel_parts = kDefaultCompositeUploadMaxParallelParts;
+    GetEnvVar(kCompositeUploadMaxParallelParts, strings::safe_strto32,
+              &max_parallel_parts);
+    VLOG(1) << "GCS composite upload ENABLED. Part size = " << value
+            << " MB ; max parallel parts = " << max_parallel_parts;
+    SetCompositeUploadConfig(value * 1024 * 1024,
+                             std::max(max_parallel_parts, 1));
+  }
 }
 
 GcsFileSystem::GcsFileSystem(
@@ -914,6 +1381,21 @@ Status GcsFileSystem::NewRandomAccessFile(
     mutex_lock l(block_cache_lock_);
     cache_enabled = file_block_cache_->IsCacheEnabled();
   }
+  const auto uncached_read_fn = [this](const string& fname, uint64 offset,
+                                       size_t n, StringPiece* result,
+                                       char* scratch) {
+    *result = StringPiece();
+    size_t bytes_transferred;
+    TF_RETURN_IF_ERROR(
+        LoadBufferFromGCS(fname, offset, n, scratch, &bytes_transferred));
+    *result = StringPiece(scratch, bytes_transferred);
+    if (bytes_transferred < n) {
+      return errors::OutOfRange("EOF reached, ", result->size(),
+                                " bytes were read out of ", n,
+                                " bytes requested.");
+    }
+    return Status::OK();
+  };
   if (cache_enabled) {
     result->reset(new GcsRandomAccessFile(fname, [this, bucket, object](
                                                      const string& fname,
@@ -945,27 +1427,33 @@ Status GcsFileSystem::NewRandomAccessFile(
       }
       return Status::OK();
     }));
+  } else if (read_ahead_pool_ != nullptr) {
+    result->reset(new ReadAheadGcsRandomAccessFile(
+        fname, read_ahead_chunk_size_, read_ahead_max_parallel_reads_,
+        read_ahead_pool_.get(), uncached_read_fn));
   } else {
-    result->reset(new BufferedGcsRandomAccessFile(
-        fname, block_size_,
-        [this, bucket, object](const string& fname, uint64 offset, size_t n,
-                               StringPiece* result, char* scratch) {
-          *result = StringPiece();
-          size_t bytes_transferred;
-          TF_RETURN_IF_ERROR(
-              LoadBufferFromGCS(fname, offset, n, scratch, &bytes_transferred));
-          *result = StringPiece(scratch, bytes_transferred);
-          if (bytes_transferred < n) {
-            return errors::OutOfRange("EOF reached, ", result->size(),
-                                      " bytes were read out of ", n,
-                                      " bytes requested.");
-          }
-          return Status::OK();
-        }));
+    result->reset(
+        new BufferedGcsRandomAccessFile(fname, block_size_, uncached_read_fn));
   }
   return Status::OK();
 }
 
+void GcsFileSystem::SetReadAheadConfig(size_t chunk_size,
+                                       int max_parallel_reads) {
+  read_ahead_chunk_size_ = chunk_size;
+  read_ahead_max_parallel_reads_ = max_parallel_reads;
+  read_ahead_pool_.reset(new thread::ThreadPool(
+      Env::Default(), "gcs_read_ahead", max_parallel_reads));
+}
+
+void GcsFileSystem::SetCompositeUploadConfig(size_t part_size,
+                                             int max_parallel_parts) {
+  composite_upload_part_size_ = part_size;
+  composite_upload_max_parallel_parts_ = max_parallel_parts;
+  composite_upload_pool_.reset(new thread::ThreadPool(
+      Env::Default(), "gcs_composite_upload", max_parallel_parts));
+}
+
 void GcsFileSystem::ResetFileBlockCache(size_t block_size_bytes,
                                         size_t max_bytes,
                                         uint64 max_staleness_secs) {
@@ -980,13 +1468,19 @@ void GcsFileSystem::ResetFileBlockCache(size_t block_size_bytes,
 // A helper function to build a FileBlockCache for GcsFileSystem.
 std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
     size_t block_size, size_t max_bytes, uint64 max_staleness) {
-  std::unique_ptr<FileBlockCache> file_block_cache(new RamFileBlockCache(
-      block_size, max_bytes, max_staleness,
-      [this](const string& filename, size_t offset, size_t n, char* buffer,
-             size_t* bytes_transferred) {
-        return LoadBufferFromGCS(filename, offset, n, buffer,
-                                 bytes_transferred);
-      }));
+  auto block_fetcher = [this](const string& filename, size_t offset, size_t n,
+                              char* buffer, size_t* bytes_transferred) {
+    return LoadBufferFromGCS(filename, offset, n, buffer, bytes_transferred);
+  };
+  std::unique_ptr<FileBlockCache> file_block_cache;
+  if (!block_cache_disk_dir_.empty() && max_bytes > 0) {
+    file_block_cache.reset(
+        new DiskFileBlockCache(block_cache_disk_dir_, block_size, max_bytes,
+                               max_staleness, block_fetcher));
+  } else {
+    file_block_cache.reset(new RamFileBlockCache(block_size, max_bytes,
+                                                 max_staleness, block_fetcher));
+  }
   return file_block_cache;
 }
 
@@ -1056,6 +1550,14 @@ Status GcsFileSystem::NewWritableFile(const string& fname,
                                       std::unique_ptr<WritableFile>* result) {
   string bucket, object;
   TF_RETURN_IF_ERROR(ParseGcsPath(fname, false, &bucket, &object));
+  if (composite_upload_pool_ != nullptr) {
+    result->reset(new GcsCompositeWritableFile(
+        bucket, object, this, &timeouts_,
+        [this, fname]() { ClearFileCaches(fname); }, retry_config_,
+        composite_upload_part_size_, composite_upload_max_parallel_parts_,
+        composite_upload_pool_.get()));
+    return Status::OK();
+  }
   result->reset(new GcsWritableFile(bucket, object, this, &timeouts_,
                                     [this, fname]() { ClearFileCaches(fname); },
                                     retry_config_));
@@ -1352,10 +1854,27 @@ Status GcsFileSystem::GetMatchingPaths(const string& pattern,
           return errors::InvalidArgument(
               "A GCS pattern doesn't have a bucket name: ", pattern);
         }
+        // Only list the objects starting with the fixed prefix, rather than
+        // all the objects under 'dir'.
+        string bucket, object_prefix, dir_prefix;
+        TF_RETURN_IF_ERROR(
+            ParseGcsPath(fixed_prefix, true, &bucket, &object_prefix));
+        TF_RETURN_IF_ERROR(
+            ParseGcsPath(MaybeAppendSlash(dir), true, &bucket, &dir_prefix));
+        std::vector<string> names;
+        TF_RETURN_IF_ERROR(ListObjects(bucket, object_prefix, &names));
         std::vector<string> all_files;
-        TF_RETURN_IF_ERROR(GetChildrenBounded(
-            dir, UINT64_MAX, &all_files, true /* recursively */,
-            false /* include_self_directory_marker */));
+        for (const string& name : names) {
+          StringPiece relative_path(name);
+          if (!absl::ConsumePrefix(&relative_path, dir_prefix)) {
+            return errors::Internal(
+                "Unexpected response: the returned file name ", name,
+                " doesn't match the prefix ", dir_prefix);
+          }
+          if (!relative_path.empty()) {
+            all_files.emplace_back(relative_path);
+          }
+        }
 
         const auto& files_and_folders = AddAllSubpaths(all_files);
 
@@ -1490,6 +2009,78 @@ Status GcsFileSystem::GetChildrenBounded(const string& dirname,
   }
 }
 
+Status GcsFileSystem::ListObjects(const string& bucket, const string& prefix,
+                                  std::vector<string>* names) {
+  const bool cache_stats = stat_cache_->max_age() > 0;
+  string nextPageToken;
+  while (true) {  // A loop over multiple result pages.
+    std::vector<char> output_buffer;
+    std::unique_ptr<HttpRequest> request;
+    TF_RETURN_IF_ERROR(CreateHttpRequest(&request));
+    auto uri = strings::StrCat(kGcsUriBase, "b/", bucket, "/o");
+    if (cache_stats) {
+      uri = strings::StrCat(uri,
+                            "?fields=items%28name%2Csize%2Cgeneration%2Cupdated"
+                            "%29%2CnextPageToken");
+    } else {
+      uri = strings::StrCat(uri, "?fields=items%2Fname%2CnextPageToken");
+    }
+    if (!prefix.empty()) {
+      uri = strings::StrCat(uri, "&prefix=", request->EscapeString(prefix));
+    }
+    if (!nextPageToken.empty()) {
+      uri = strings::StrCat(
+          uri, "&pageToken=", request->EscapeString(nextPageToken));
+    }
+    request->SetUri(uri);
+    request->SetResultBuffer(&output_buffer);
+    request->SetTimeouts(timeouts_.connect, timeouts_.idle, timeouts_.metadata);
+
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when listing gs://",
+                                    bucket, "/", prefix);
+    Json::Value root;
+    TF_RETURN_IF_ERROR(ParseJson(output_buffer, &root));
+    const auto items = root.get("items", Json::Value::null);
+    if (!items.isNull()) {
+      if (!items.isArray()) {
+        return errors::Internal(
+            "Expected an array 'items' in the GCS response.");
+      }
+      for (size_t i = 0; i < items.size(); i++) {
+        const auto item = items.get(i, Json::Value::null);
+        if (!item.isObject()) {
+          return errors::Internal(
+              "Unexpected JSON format: 'items' should be a list of objects.");
+        }
+        string name;
+        TF_RETURN_IF_ERROR(GetStringValue(item, "name", &name));
+        if (cache_stats) {
+          GcsFileStat stat;
+          TF_RETURN_IF_ERROR(GetInt64Value(item, "size", &stat.base.length));
+          TF_RETURN_IF_ERROR(
+              GetInt64Value(item, "generation", &stat.generation_number));
+          string updated;
+          TF_RETURN_IF_ERROR(GetStringValue(item, "updated", &updated));
+          TF_RETURN_IF_ERROR(ParseRfc3339Time(updated, &stat.base.mtime_nsec));
+          stat.base.is_directory = str_util::EndsWith(name, "/");
+          stat_cache_->Insert(strings::StrCat("gs://", bucket, "/", name),
+                              stat);
+        }
+        names->push_back(std::move(name));
+      }
+    }
+    const auto token = root.get("nextPageToken", Json::Value::null);
+    if (token.isNull()) {
+      return Status::OK();
+    }
+    if (!token.isString()) {
+      return errors::Internal(
+          "Unexpected response: nextPageToken is not a string");
+    }
+    nextPageToken = token.asString();
+  }
+}
+
 Status GcsFileSystem::Stat(const string& fname, FileStatistics* stat) {
   if (!stat) {
     return errors::Internal("'stat' cannot be nullptr.");
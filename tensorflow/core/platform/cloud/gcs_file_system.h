@@ -22,6 +22,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/cloud/auth_provider.h"
 #include "tensorflow/core/platform/cloud/compute_engine_metadata_client.h"
 #include "tensorflow/core/platform/cloud/compute_engine_zone_provider.h"
@@ -50,6 +51,10 @@ constexpr size_t kDefaultMaxCacheSize = 0;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that stores the blocks of the cache in a local
+// directory instead of in memory. The directory is shared by all processes of
+// the host that set it, and is bounded by GCS_READ_CACHE_MAX_SIZE_MB.
+constexpr char kDiskCacheDir[] = "GCS_READ_CACHE_DISK_DIR";
 
 // Helper function to extract an environment variable and convert it into a
 // value of type T.
@@ -253,6 +258,23 @@ class GcsFileSystem : public FileSystem {
   void ResetFileBlockCache(size_t block_size_bytes, size_t max_bytes,
                            uint64 max_staleness_secs);
 
+  /// \brief Enables the adaptive read-ahead of files opened afterwards while
+  /// the block cache is disabled.
+  ///
+  /// Sequential reads of a file are served by up to `max_parallel_reads`
+  /// concurrent ranged reads of `chunk_size` bytes each. Must not be called
+  /// while files are open.
+  void SetReadAheadConfig(size_t chunk_size, int max_parallel_reads);
+
+  /// \brief Enables the parallel composite upload of files opened afterwards
+  /// with NewWritableFile().
+  ///
+  /// The content of a file is uploaded in parts of `part_size` bytes while it
+  /// is being written, with up to `max_parallel_parts` concurrent uploads per
+  /// file, and the parts are composed into the object on Sync() and Close().
+  /// Must not be called while files are open.
+  void SetCompositeUploadConfig(size_t part_size, int max_parallel_parts);
+
  protected:
   virtual std::unique_ptr<FileBlockCache> MakeFileBlockCache(
       size_t block_size, size_t max_bytes, uint64 max_staleness);
@@ -319,6 +341,14 @@ class GcsFileSystem : public FileSystem {
                             std::vector<string>* result, bool recursively,
                             bool include_self_directory_marker);
 
+  /// \brief Lists the names of all objects in `bucket` starting with `prefix`.
+  ///
+  /// If the stat cache is enabled, the statistics of the listed objects are
+  /// retrieved by the same requests and added to it, so that the callers
+  /// opening or checking the matched files do not need a request per file.
+  Status ListObjects(const string& bucket, const string& prefix,
+                     std::vector<string>* names);
+
   /// Retrieves file statistics assuming fname points to a GCS object. The data
   /// may be read from cache or from GCS directly.
   Status StatForObject(const string& fname, const string& bucket,
@@ -340,6 +370,9 @@ class GcsFileSystem : public FileSystem {
   // Reads smaller than block_size_ will trigger a read of block_size_.
   uint64 block_size_;
 
+  // If set, the block cache is stored in this local directory.
+  string block_cache_disk_dir_;
+
   // block_cache_lock_ protects the file_block_cache_ pointer (Note that
   // FileBlockCache instances are themselves threadsafe).
   mutex block_cache_lock_;
@@ -348,6 +381,17 @@ class GcsFileSystem : public FileSystem {
   std::unique_ptr<GcsDnsCache> dns_cache_;
   GcsThrottle throttle_;
 
+  // The configuration of the read-ahead, enabled iff read_ahead_pool_ is set.
+  size_t read_ahead_chunk_size_ = 0;
+  int read_ahead_max_parallel_reads_ = 0;
+  std::unique_ptr<thread::ThreadPool> read_ahead_pool_;
+
+  // The configuration of the composite upload, enabled iff
+  // composite_upload_pool_ is set.
+  size_t composite_upload_part_size_ = 0;
+  int composite_upload_max_parallel_parts_ = 0;
+  std::unique_ptr<thread::ThreadPool> composite_upload_pool_;
+
   using StatCache = ExpiringLRUCache<GcsFileStat>;
   std::unique_ptr<StatCache> stat_cache_;
 
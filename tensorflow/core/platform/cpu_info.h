@@ -122,6 +122,13 @@ enum CPUFeature {
   AVX512IFMA = 35,     // Integer multiply-add
   AVX512_4VNNIW = 36,  // Integer neural network
   AVX512_4FMAPS = 37,  // Floating point neural network
+  AVX512_BF16 = 38,    // Bfloat16 conversions and dot products
+
+  // Advanced Matrix Extensions: tile registers (Sapphire Rapids and later).
+  // The OS must also grant the process the permission to use the tile data,
+  // e.g. with arch_prctl(ARCH_REQ_XCOMP_PERM) on Linux.
+  AMX_TILE = 39,  // Tile configuration and loads/stores
+  AMX_BF16 = 40,  // Bfloat16 tile dot products
 };
 
 // Checks whether the current processor supports one of the features above.
@@ -20,7 +20,9 @@ limitations under the License.
 #include <stdio.h>
 #include <sys/mman.h>
 #if defined(__linux__)
+#include <linux/aio_abi.h>
 #include <sys/sendfile.h>
+#include <sys/syscall.h>
 #endif
 #include <sys/stat.h>
 #include <sys/time.h>
@@ -28,12 +30,18 @@ limitations under the License.
 #include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <vector>
+
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/default/posix_file_system.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/error.h"
 #include "tensorflow/core/platform/file_system_helper.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 
@@ -42,6 +50,15 @@ namespace tensorflow {
 // 128KB of copy buffer
 constexpr size_t kPosixCopyFileBufferSize = 128 * 1024;
 
+#if defined(__linux__)
+// The reads of PosixAioRandomAccessFile::Read() are split into chunks of 1MB.
+constexpr size_t kPosixAioChunkSize = 1 << 20;
+// The maximum number of reads of a batch in flight at once.
+constexpr size_t kPosixAioMaxInFlight = 64;
+// The alignment of the offsets, sizes and buffers of O_DIRECT reads.
+constexpr size_t kPosixDirectAlignment = 4096;
+#endif
+
 // pread() based random-access
 class PosixRandomAccessFile : public RandomAccessFile {
  private:
@@ -90,6 +107,243 @@ class PosixRandomAccessFile : public RandomAccessFile {
   }
 };
 
+#if defined(__linux__)
+// Linux AIO based random-access, which keeps all the reads of a batch in
+// flight at once. Read() splits large reads into chunks read as a batch, so
+// that a single reader thread keeps the device busy.
+//
+// Linux AIO only runs asynchronously on files opened with O_DIRECT, which
+// also bypasses the page cache. Reads of such files go through bounce buffers
+// aligned as O_DIRECT requires.
+class PosixAioRandomAccessFile : public RandomAccessFile {
+ public:
+  PosixAioRandomAccessFile(const string& fname, int fd, bool direct)
+      : filename_(fname), fd_(fd), direct_(direct) {}
+  ~PosixAioRandomAccessFile() override { close(fd_); }
+
+  Status Name(StringPiece* result) const override {
+    *result = filename_;
+    return Status::OK();
+  }
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    std::vector<ReadRequest> requests;
+    for (size_t done = 0; done < n; done += kPosixAioChunkSize) {
+      requests.emplace_back();
+      requests.back().offset = offset + done;
+      requests.back().n = std::min(kPosixAioChunkSize, n - done);
+      requests.back().scratch = scratch + done;
+    }
+    ReadBatch(&requests);
+    // The result ends at the first chunk cut short by an error or EOF.
+    Status s;
+    size_t bytes_read = 0;
+    for (const ReadRequest& request : requests) {
+      bytes_read += request.result.size();
+      if (!request.status.ok()) {
+        s = request.status;
+        break;
+      }
+    }
+    *result = StringPiece(scratch, bytes_read);
+    return s;
+  }
+
+  void ReadBatch(std::vector<ReadRequest>* requests) const override {
+    std::vector<Op> ops(requests->size());
+    for (size_t i = 0; i < ops.size(); ++i) {
+      ops[i].request = &(*requests)[i];
+    }
+    if (ops.size() == 1) {
+      // Not worth an AIO context.
+      ReadSync(&ops[0]);
+      return;
+    }
+    const size_t max_events = std::min(ops.size(), kPosixAioMaxInFlight);
+    aio_context_t context = 0;
+    if (syscall(__NR_io_setup, static_cast<long>(max_events), &context) < 0) {
+      // AIO is unavailable, e.g. because the system-wide limit on AIO
+      // contexts was reached.
+      VLOG(1) << "Reading " << filename_
+              << " synchronously, as io_setup failed: " << strerror(errno);
+      for (Op& op : ops) ReadSync(&op);
+      return;
+    }
+
+    std::deque<Op*> queue;
+    for (Op& op : ops) queue.push_back(&op);
+    size_t in_flight = 0;
+    std::vector<struct iocb*> iocbs;
+    std::vector<struct io_event> events(max_events);
+    while (!queue.empty() || in_flight > 0) {
+      iocbs.clear();
+      while (!queue.empty() && in_flight + iocbs.size() < max_events) {
+        Op* op = queue.front();
+        queue.pop_front();
+        Prepare(op);
+        memset(&op->cb, 0, sizeof(op->cb));
+        op->cb.aio_data = reinterpret_cast<uint64>(op);
+        op->cb.aio_lio_opcode = IOCB_CMD_PREAD;
+        op->cb.aio_fildes = fd_;
+        op->cb.aio_buf = reinterpret_cast<uint64>(op->buffer);
+        op->cb.aio_nbytes = op->read_size;
+        op->cb.aio_offset = op->read_offset;
+        iocbs.push_back(&op->cb);
+      }
+      if (!iocbs.empty()) {
+        long submitted = syscall(__NR_io_submit, context,
+                                 static_cast<long>(iocbs.size()), iocbs.data());
+        if (submitted < 0) {
+          if (errno != EAGAIN && errno != EINTR) {
+            const Status error = IOError(filename_, errno);
+            for (struct iocb* cb : iocbs) {
+              Fail(reinterpret_cast<Op*>(cb->aio_data), error);
+            }
+            continue;
+          }
+          submitted = 0;
+        }
+        in_flight += submitted;
+        // Retry the reads the kernel did not accept once some complete.
+        for (size_t i = submitted; i < iocbs.size(); ++i) {
+          queue.push_front(reinterpret_cast<Op*>(iocbs[i]->aio_data));
+        }
+        if (in_flight == 0) {
+          // Nothing to wait for, so the kernel cannot take any read.
+          while (!queue.empty()) {
+            Fail(queue.front(), IOError(filename_, EAGAIN));
+            queue.pop_front();
+          }
+          continue;
+        }
+      }
+      const long completed =
+          syscall(__NR_io_getevents, context, 1L, static_cast<long>(max_events),
+                  events.data(), nullptr);
+      if (completed < 0) {
+        if (errno == EINTR) continue;
+        const Status error = IOError(filename_, errno);
+        for (Op& op : ops) {
+          if (op.request->status.ok() && op.done < op.request->n) {
+            Fail(&op, error);
+          }
+        }
+        break;
+      }
+      for (long i = 0; i < completed; ++i) {
+        Op* op = reinterpret_cast<Op*>(events[i].data);
+        --in_flight;
+        if (Complete(op, events[i].res)) {
+          queue.push_back(op);
+        }
+      }
+    }
+    // Waits for any read still in flight after an error.
+    syscall(__NR_io_destroy, context);
+  }
+
+ private:
+  struct AlignedFree {
+    void operator()(char* p) const { port::AlignedFree(p); }
+  };
+
+  // The state of a request, which may take several reads when they come back
+  // short.
+  struct Op {
+    ReadRequest* request = nullptr;
+    // The bytes of the request read so far.
+    size_t done = 0;
+    // The current read.
+    uint64 read_offset = 0;
+    size_t read_size = 0;
+    char* buffer = nullptr;
+    // The bounce buffer of O_DIRECT reads.
+    std::unique_ptr<char, AlignedFree> bounce;
+    size_t bounce_size = 0;
+    struct iocb cb;
+  };
+
+  // Sets up the read of the rest of the request of `op`.
+  void Prepare(Op* op) const {
+    const uint64 offset = op->request->offset + op->done;
+    const size_t n = op->request->n - op->done;
+    if (!direct_) {
+      op->read_offset = offset;
+      op->read_size = n;
+      op->buffer = op->request->scratch + op->done;
+      return;
+    }
+    op->read_offset = offset / kPosixDirectAlignment * kPosixDirectAlignment;
+    op->read_size =
+        (offset + n + kPosixDirectAlignment - 1) / kPosixDirectAlignment *
+            kPosixDirectAlignment -
+        op->read_offset;
+    if (op->bounce_size < op->read_size) {
+      op->bounce.reset(static_cast<char*>(
+          port::AlignedMalloc(op->read_size, kPosixDirectAlignment)));
+      op->bounce_size = op->read_size;
+    }
+    op->buffer = op->bounce.get();
+  }
+
+  // Accounts for a read of `op` that returned `res` (a byte count, or a
+  // negated errno). Returns true if the rest of the request must be read.
+  bool Complete(Op* op, int64 res) const {
+    if (res < 0) {
+      Fail(op, IOError(filename_, -res));
+      return false;
+    }
+    size_t bytes_read = res;
+    if (direct_) {
+      const size_t skip = op->request->offset + op->done - op->read_offset;
+      bytes_read = bytes_read > skip
+                       ? std::min(bytes_read - skip, op->request->n - op->done)
+                       : 0;
+      memcpy(op->request->scratch + op->done, op->buffer + skip, bytes_read);
+    }
+    op->done += bytes_read;
+    op->request->result = StringPiece(op->request->scratch, op->done);
+    if (op->done == op->request->n) {
+      op->request->status = Status::OK();
+      return false;
+    }
+    if (bytes_read == 0) {
+      op->request->status =
+          Status(error::OUT_OF_RANGE, "Read less bytes than requested");
+      return false;
+    }
+    return true;
+  }
+
+  void Fail(Op* op, const Status& status) const {
+    op->request->result = StringPiece(op->request->scratch, op->done);
+    op->request->status = status;
+  }
+
+  // Performs the request of `op` with blocking reads.
+  void ReadSync(Op* op) const {
+    while (true) {
+      Prepare(op);
+      const ssize_t r = pread(fd_, op->buffer, op->read_size, op->read_offset);
+      if (r < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+      if (!Complete(op, r < 0 ? -errno : r)) return;
+    }
+  }
+
+  string filename_;
+  int fd_;
+  bool direct_;
+};
+
+// Returns true if the environment variable `name` is set to a true value.
+bool ReadBoolFromEnv(const char* name) {
+  const char* value = getenv(name);
+  return value != nullptr &&
+         (strcmp(value, "1") == 0 || strcasecmp(value, "true") == 0);
+}
+#endif  // defined(__linux__)
+
 class PosixWritableFile : public WritableFile {
  private:
   string filename_;
@@ -177,6 +431,23 @@ Status PosixFileSystem::NewRandomAccessFile(
     const string& fname, std::unique_ptr<RandomAccessFile>* result) {
   string translated_fname = TranslateName(fname);
   Status s;
+#if defined(__linux__)
+  if (ReadBoolFromEnv("TF_POSIX_AIO_READS")) {
+    bool direct = ReadBoolFromEnv("TF_POSIX_AIO_DIRECT_READS");
+    int fd = open(translated_fname.c_str(), O_RDONLY | (direct ? O_DIRECT : 0));
+    if (fd < 0 && direct && errno == EINVAL) {
+      // The file system does not support O_DIRECT, e.g. tmpfs.
+      direct = false;
+      fd = open(translated_fname.c_str(), O_RDONLY);
+    }
+    if (fd < 0) {
+      s = IOError(fname, errno);
+    } else {
+      result->reset(new PosixAioRandomAccessFile(translated_fname, fd, direct));
+    }
+    return s;
+  }
+#endif
   int fd = open(translated_fname.c_str(), O_RDONLY);
   if (fd < 0) {
     s = IOError(fname, errno);
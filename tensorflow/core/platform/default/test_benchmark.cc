@@ -97,6 +97,15 @@ Benchmark* Benchmark::Range(int lo, int hi) {
   return this;
 }
 
+Benchmark* Benchmark::DenseRange(int lo, int hi) {
+  CHECK_GE(lo, 0);
+  CHECK_GE(hi, lo);
+  for (int arg = lo; arg <= hi; ++arg) {
+    Arg(arg);
+  }
+  return this;
+}
+
 Benchmark* Benchmark::RangePair(int lo1, int hi1, int lo2, int hi2) {
   std::vector<int> args1;
   std::vector<int> args2;
@@ -186,6 +195,15 @@ void Benchmark::Run(const char* pattern) {
       }
       s = reporter.Benchmark(iters, 0.0, seconds,
                              items_processed * 1e-6 / seconds);
+      if (s.ok() && bytes_processed > 0) {
+        s = reporter.SetProperty("bytes_per_second", bytes_processed / seconds);
+      }
+      if (s.ok() && items_processed > 0) {
+        s = reporter.SetProperty("items_per_second", items_processed / seconds);
+      }
+      if (s.ok() && !label.empty()) {
+        s = reporter.SetProperty("label", label);
+      }
       if (!s.ok()) {
         LOG(ERROR) << s.ToString();
         exit(EXIT_FAILURE);
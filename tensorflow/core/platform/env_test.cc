@@ -90,6 +90,46 @@ TEST_F(DefaultEnvTest, IncompleteReadOutOfRange) {
   EXPECT_EQ(input, result);
 }
 
+#if defined(__linux__)
+TEST_F(DefaultEnvTest, AioReads) {
+  const string filename = io::JoinPath(BaseDir(), "aio_reads");
+  const int length = (3 << 20) + 5;
+  const string input = CreateTestFile(env_, filename, length);
+  for (const char* direct : {"0", "1"}) {
+    setenv("TF_POSIX_AIO_READS", "1", 1);
+    setenv("TF_POSIX_AIO_DIRECT_READS", direct, 1);
+    std::unique_ptr<RandomAccessFile> f;
+    TF_EXPECT_OK(env_->NewRandomAccessFile(filename, &f));
+    unsetenv("TF_POSIX_AIO_READS");
+    unsetenv("TF_POSIX_AIO_DIRECT_READS");
+
+    string scratch(length + 1, 0);
+    StringPiece result;
+    TF_EXPECT_OK(f->Read(0, length, &result, &scratch[0]));
+    EXPECT_EQ(input, result);
+    EXPECT_EQ(error::OUT_OF_RANGE,
+              f->Read(7, length, &result, &scratch[0]).code());
+    EXPECT_EQ(input.substr(7), result);
+
+    std::vector<RandomAccessFile::ReadRequest> requests(3);
+    std::vector<string> scratches(3, string(4096, 0));
+    const uint64 offsets[] = {12345, 1 << 20, length - 100};
+    for (int i = 0; i < 3; ++i) {
+      requests[i].offset = offsets[i];
+      requests[i].n = 4096;
+      requests[i].scratch = &scratches[i][0];
+    }
+    f->ReadBatch(&requests);
+    TF_EXPECT_OK(requests[0].status);
+    EXPECT_EQ(input.substr(12345, 4096), requests[0].result);
+    TF_EXPECT_OK(requests[1].status);
+    EXPECT_EQ(input.substr(1 << 20, 4096), requests[1].result);
+    EXPECT_EQ(error::OUT_OF_RANGE, requests[2].status.code());
+    EXPECT_EQ(input.substr(length - 100), requests[2].result);
+  }
+}
+#endif  // defined(__linux__)
+
 TEST_F(DefaultEnvTest, ReadFileToString) {
   for (const int length : {0, 1, 1212, 2553, 4928, 8196, 9000, (1 << 20) - 1,
                            1 << 20, (1 << 20) + 1, (256 << 20) + 100}) {
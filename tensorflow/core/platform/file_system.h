@@ -263,6 +263,31 @@ class RandomAccessFile {
   virtual Status Read(uint64 offset, size_t n, StringPiece* result,
                       char* scratch) const = 0;
 
+  /// \brief One of the reads of a ReadBatch() call.
+  struct ReadRequest {
+    uint64 offset = 0;
+    size_t n = 0;
+    char* scratch = nullptr;
+
+    /// Set by ReadBatch(), as `*result` and the returned status of Read().
+    StringPiece result;
+    Status status;
+  };
+
+  /// \brief Performs all the reads of `requests`, in any order.
+  ///
+  /// Implementations may keep all the reads of the batch in flight at once,
+  /// so that a single thread can saturate devices that need many concurrent
+  /// requests. The default implementation calls Read() for each request.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual void ReadBatch(std::vector<ReadRequest>* requests) const {
+    for (ReadRequest& request : *requests) {
+      request.status =
+          Read(request.offset, request.n, &request.result, request.scratch);
+    }
+  }
+
   // TODO(ebrevdo): Remove this ifdef when absl is updated.
 #if defined(PLATFORM_GOOGLE)
   /// \brief Read up to `n` bytes from the file starting at `offset`.
@@ -14,29 +14,41 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/platform/s3/s3_file_system.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
-#include "tensorflow/core/platform/file_system_helper.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/s3/aws_crypto.h"
 #include "tensorflow/core/platform/s3/aws_logging.h"
 
 #include <aws/core/Aws.h>
 #include <aws/core/config/AWSProfileConfigLoader.h>
+#include <aws/core/http/HttpResponse.h>
 #include <aws/core/utils/FileSystemUtils.h>
 #include <aws/core/utils/StringUtils.h>
 #include <aws/core/utils/logging/AWSLogging.h>
 #include <aws/core/utils/logging/LogSystemInterface.h>
+#include <aws/core/utils/threading/Executor.h>
 #include <aws/s3/S3Client.h>
 #include <aws/s3/S3Errors.h>
+#include <aws/s3/model/AbortMultipartUploadRequest.h>
+#include <aws/s3/model/CompleteMultipartUploadRequest.h>
+#include <aws/s3/model/CompletedMultipartUpload.h>
+#include <aws/s3/model/CompletedPart.h>
 #include <aws/s3/model/CopyObjectRequest.h>
+#include <aws/s3/model/CreateMultipartUploadRequest.h>
 #include <aws/s3/model/DeleteObjectRequest.h>
 #include <aws/s3/model/GetObjectRequest.h>
 #include <aws/s3/model/HeadBucketRequest.h>
 #include <aws/s3/model/HeadObjectRequest.h>
 #include <aws/s3/model/ListObjectsRequest.h>
 #include <aws/s3/model/PutObjectRequest.h>
+#include <aws/s3/model/UploadPartRequest.h>
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <set>
 
 namespace tensorflow {
 
@@ -44,6 +56,26 @@ namespace {
 static const char* kS3FileSystemAllocationTag = "S3FileSystemAllocation";
 static const size_t kS3ReadAppendableFileBufferSize = 1024 * 1024;
 static const int kS3GetChildrenMaxKeys = 100;
+static const int kS3ListObjectsMaxKeys = 1000;
+static const size_t kS3DefaultReadAheadSize = 8 * 1024 * 1024;
+// S3 requires all the parts of a multipart upload but the last to be at least
+// 5MB.
+static const size_t kS3DefaultMultipartUploadPartSize = 8 * 1024 * 1024;
+static const size_t kS3MinMultipartUploadPartSize = 5 * 1024 * 1024;
+// The number of parts of a file uploaded concurrently, which also bounds the
+// memory held by an upload.
+static const size_t kS3MultipartUploadMaxParallelParts = 8;
+
+// Returns the size in bytes set in MB by the environment variable `name`, or
+// `default_value` if it is not set.
+size_t GetSizeFromEnv(const char* name, size_t default_value) {
+  const char* value = getenv(name);
+  int64 mb;
+  if (value && strings::safe_strto64(value, &mb) && mb >= 0) {
+    return mb * 1024 * 1024;
+  }
+  return default_value;
+}
 
 Aws::Client::ClientConfiguration& GetDefaultClientConfig() {
   static mutex cfg_lock(LINKER_INITIALIZED);
@@ -123,6 +155,20 @@ Aws::Client::ClientConfiguration& GetDefaultClientConfig() {
         cfg.requestTimeoutMs = timeout;
       }
     }
+    const char* max_connections = getenv("S3_MAX_CONNECTIONS");
+    if (max_connections) {
+      int64 connections;
+
+      if (strings::safe_strto64(max_connections, &connections) &&
+          connections > 0) {
+        cfg.maxConnections = connections;
+      }
+    }
+    // Asynchronous requests run on a pool with one thread per connection,
+    // rather than on a new thread each.
+    cfg.executor =
+        Aws::MakeShared<Aws::Utils::Threading::PooledThreadExecutor>(
+            kS3FileSystemAllocationTag, cfg.maxConnections);
 
     init = true;
   }
@@ -167,8 +213,20 @@ Status ParseS3Path(const string& fname, bool empty_object_ok, string* bucket,
 class S3RandomAccessFile : public RandomAccessFile {
  public:
   S3RandomAccessFile(const string& bucket, const string& object,
-                     std::shared_ptr<Aws::S3::S3Client> s3_client)
-      : bucket_(bucket), object_(object), s3_client_(s3_client) {}
+                     std::shared_ptr<Aws::S3::S3Client> s3_client,
+                     size_t read_ahead_size)
+      : bucket_(bucket),
+        object_(object),
+        s3_client_(s3_client),
+        read_ahead_size_(read_ahead_size) {}
+
+  ~S3RandomAccessFile() override {
+    // Do not let a pending read-ahead outlive the file.
+    mutex_lock l(mu_);
+    if (prefetch_.valid()) {
+      prefetch_.wait();
+    }
+  }
 
   Status Name(StringPiece* result) const override {
     return errors::Unimplemented("S3RandomAccessFile does not support Name()");
@@ -176,6 +234,27 @@ class S3RandomAccessFile : public RandomAccessFile {
 
   Status Read(uint64 offset, size_t n, StringPiece* result,
               char* scratch) const override {
+    if (n >= read_ahead_size_) {
+      return ReadDirect(offset, n, result, scratch);
+    }
+    mutex_lock l(mu_);
+    size_t copied = CopyFromBuffer(offset, n, scratch);
+    // A short buffer ends at the end of the file, so there is nothing left to
+    // fetch once it has been copied from.
+    if (copied < n && (copied == 0 || buffer_.size() == read_ahead_size_)) {
+      TF_RETURN_IF_ERROR(FillBuffer(offset + copied));
+      copied += CopyFromBuffer(offset + copied, n - copied, scratch + copied);
+    }
+    *result = StringPiece(scratch, copied);
+    if (copied < n) {
+      return errors::OutOfRange("Read less bytes than requested");
+    }
+    return Status::OK();
+  }
+
+ private:
+  Aws::S3::Model::GetObjectRequest RangeRequest(uint64 offset,
+                                                size_t n) const {
     Aws::S3::Model::GetObjectRequest getObjectRequest;
     getObjectRequest.WithBucket(bucket_.c_str()).WithKey(object_.c_str());
     string bytes = strings::StrCat("bytes=", offset, "-", offset + n - 1);
@@ -183,7 +262,15 @@ class S3RandomAccessFile : public RandomAccessFile {
     getObjectRequest.SetResponseStreamFactory([]() {
       return Aws::New<Aws::StringStream>(kS3FileSystemAllocationTag);
     });
-    auto getObjectOutcome = this->s3_client_->GetObject(getObjectRequest);
+    return getObjectRequest;
+  }
+
+  // Reads a range directly into `scratch`, for reads that would not fit in
+  // the read-ahead buffer.
+  Status ReadDirect(uint64 offset, size_t n, StringPiece* result,
+                    char* scratch) const {
+    auto getObjectOutcome =
+        this->s3_client_->GetObject(RangeRequest(offset, n));
     if (!getObjectOutcome.IsSuccess()) {
       n = 0;
       *result = StringPiece(scratch, n);
@@ -196,19 +283,89 @@ class S3RandomAccessFile : public RandomAccessFile {
     return Status::OK();
   }
 
- private:
+  // Copies the part of [offset, offset + n) held by the buffer, if the buffer
+  // holds `offset`, and returns the number of bytes copied.
+  size_t CopyFromBuffer(uint64 offset, size_t n, char* scratch) const
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (offset < buffer_offset_ || offset >= buffer_offset_ + buffer_.size()) {
+      return 0;
+    }
+    const size_t begin = offset - buffer_offset_;
+    const size_t copy_size = std::min(n, buffer_.size() - begin);
+    memcpy(scratch, buffer_.data() + begin, copy_size);
+    return copy_size;
+  }
+
+  // Moves the body of a ranged read into `data`. A range that starts past the
+  // end of the file reads as empty.
+  static Status ReadBody(Aws::S3::Model::GetObjectOutcome* outcome,
+                         string* data) {
+    data->clear();
+    if (!outcome->IsSuccess()) {
+      if (outcome->GetError().GetResponseCode() ==
+          Aws::Http::HttpResponseCode::REQUESTED_RANGE_NOT_SATISFIABLE) {
+        return Status::OK();
+      }
+      return errors::Unknown(outcome->GetError().GetExceptionName(), ": ",
+                             outcome->GetError().GetMessage());
+    }
+    data->resize(outcome->GetResult().GetContentLength());
+    outcome->GetResult().GetBody().read(&(*data)[0], data->size());
+    return Status::OK();
+  }
+
+  // Fills the buffer with the range starting at `offset`, taking it from the
+  // pending read-ahead if it fetched this range.
+  Status FillBuffer(uint64 offset) const EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const bool sequential = offset == buffer_offset_ + buffer_.size();
+    buffer_offset_ = offset;
+    bool filled = false;
+    if (prefetch_.valid()) {
+      Aws::S3::Model::GetObjectOutcome outcome = prefetch_.get();
+      if (prefetch_offset_ == offset) {
+        TF_RETURN_IF_ERROR(ReadBody(&outcome, &buffer_));
+        filled = true;
+      }
+    }
+    if (!filled) {
+      Aws::S3::Model::GetObjectOutcome outcome =
+          s3_client_->GetObject(RangeRequest(offset, read_ahead_size_));
+      TF_RETURN_IF_ERROR(ReadBody(&outcome, &buffer_));
+    }
+    // Fetch the next range in the background for sequential readers, so that
+    // it is in flight while the caller consumes this one.
+    if (sequential && buffer_.size() == read_ahead_size_) {
+      prefetch_offset_ = offset + buffer_.size();
+      prefetch_ = s3_client_->GetObjectCallable(
+          RangeRequest(prefetch_offset_, read_ahead_size_));
+    }
+    return Status::OK();
+  }
+
   string bucket_;
   string object_;
   std::shared_ptr<Aws::S3::S3Client> s3_client_;
+  const size_t read_ahead_size_;
+
+  mutable mutex mu_;
+  // The buffer holds the range of the file starting at buffer_offset_.
+  mutable string buffer_ GUARDED_BY(mu_);
+  mutable uint64 buffer_offset_ GUARDED_BY(mu_) = 0;
+  // The pending read-ahead of the range starting at prefetch_offset_, if
+  // valid.
+  mutable Aws::S3::Model::GetObjectOutcomeCallable prefetch_ GUARDED_BY(mu_);
+  mutable uint64 prefetch_offset_ GUARDED_BY(mu_) = 0;
 };
 
 class S3WritableFile : public WritableFile {
  public:
   S3WritableFile(const string& bucket, const string& object,
-                 std::shared_ptr<Aws::S3::S3Client> s3_client)
+                 std::shared_ptr<Aws::S3::S3Client> s3_client,
+                 size_t multipart_upload_part_size)
       : bucket_(bucket),
         object_(object),
         s3_client_(s3_client),
+        multipart_upload_part_size_(multipart_upload_part_size),
         sync_needed_(true),
         outfile_(Aws::MakeShared<Aws::Utils::TempFile>(
             kS3FileSystemAllocationTag, "/tmp/s3_filesystem_XXXXXX",
@@ -251,9 +408,16 @@ class S3WritableFile : public WritableFile {
     if (!sync_needed_) {
       return Status::OK();
     }
+    long offset = outfile_->tellp();
+    if (multipart_upload_part_size_ > 0 &&
+        static_cast<size_t>(offset) > multipart_upload_part_size_) {
+      Status status = MultipartUpload(offset);
+      outfile_->clear();
+      outfile_->seekp(offset);
+      return status;
+    }
     Aws::S3::Model::PutObjectRequest putObjectRequest;
     putObjectRequest.WithBucket(bucket_.c_str()).WithKey(object_.c_str());
-    long offset = outfile_->tellp();
     outfile_->seekg(0);
     putObjectRequest.SetBody(outfile_);
     putObjectRequest.SetContentLength(offset);
@@ -268,9 +432,98 @@ class S3WritableFile : public WritableFile {
   }
 
  private:
+  // Uploads the first `size` bytes of the temporary file as a multipart
+  // upload, with up to kS3MultipartUploadMaxParallelParts parts in flight.
+  Status MultipartUpload(long size) {
+    Aws::S3::Model::CreateMultipartUploadRequest createRequest;
+    createRequest.WithBucket(bucket_.c_str()).WithKey(object_.c_str());
+    auto createOutcome = this->s3_client_->CreateMultipartUpload(createRequest);
+    if (!createOutcome.IsSuccess()) {
+      return errors::Unknown(createOutcome.GetError().GetExceptionName(), ": ",
+                             createOutcome.GetError().GetMessage());
+    }
+    const Aws::String uploadId = createOutcome.GetResult().GetUploadId();
+
+    Status status;
+    Aws::S3::Model::CompletedMultipartUpload completedUpload;
+    // The parts in flight, in increasing part number order, which is the
+    // order S3 requires them to be listed in on completion.
+    std::deque<std::pair<int, Aws::S3::Model::UploadPartOutcomeCallable>>
+        pending;
+    auto waitForOldestPart = [&]() {
+      auto uploadOutcome = pending.front().second.get();
+      if (!uploadOutcome.IsSuccess()) {
+        status.Update(
+            errors::Unknown(uploadOutcome.GetError().GetExceptionName(), ": ",
+                            uploadOutcome.GetError().GetMessage()));
+      } else {
+        completedUpload.AddParts(
+            Aws::S3::Model::CompletedPart()
+                .WithPartNumber(pending.front().first)
+                .WithETag(uploadOutcome.GetResult().GetETag()));
+      }
+      pending.pop_front();
+    };
+
+    string part(multipart_upload_part_size_, '\0');
+    outfile_->seekg(0);
+    long uploaded = 0;
+    for (int partNumber = 1; uploaded < size && status.ok(); ++partNumber) {
+      const long partSize =
+          std::min<long>(multipart_upload_part_size_, size - uploaded);
+      if (!outfile_->read(&part[0], partSize)) {
+        status.Update(errors::Internal(
+            "Could not read from the internal temporary file."));
+        break;
+      }
+      auto body =
+          Aws::MakeShared<Aws::StringStream>(kS3FileSystemAllocationTag);
+      body->write(part.data(), partSize);
+      Aws::S3::Model::UploadPartRequest uploadRequest;
+      uploadRequest.WithBucket(bucket_.c_str())
+          .WithKey(object_.c_str())
+          .WithUploadId(uploadId)
+          .WithPartNumber(partNumber)
+          .WithContentLength(partSize);
+      uploadRequest.SetBody(body);
+      pending.emplace_back(partNumber,
+                           this->s3_client_->UploadPartCallable(uploadRequest));
+      uploaded += partSize;
+      if (pending.size() >= kS3MultipartUploadMaxParallelParts) {
+        waitForOldestPart();
+      }
+    }
+    while (!pending.empty()) {
+      waitForOldestPart();
+    }
+
+    if (status.ok()) {
+      Aws::S3::Model::CompleteMultipartUploadRequest completeRequest;
+      completeRequest.WithBucket(bucket_.c_str())
+          .WithKey(object_.c_str())
+          .WithUploadId(uploadId)
+          .WithMultipartUpload(completedUpload);
+      auto completeOutcome =
+          this->s3_client_->CompleteMultipartUpload(completeRequest);
+      if (completeOutcome.IsSuccess()) {
+        return Status::OK();
+      }
+      status = errors::Unknown(completeOutcome.GetError().GetExceptionName(),
+                               ": ", completeOutcome.GetError().GetMessage());
+    }
+    // Release the storage of the parts already uploaded.
+    Aws::S3::Model::AbortMultipartUploadRequest abortRequest;
+    abortRequest.WithBucket(bucket_.c_str())
+        .WithKey(object_.c_str())
+        .WithUploadId(uploadId);
+    this->s3_client_->AbortMultipartUpload(abortRequest);
+    return status;
+  }
+
   string bucket_;
   string object_;
   std::shared_ptr<Aws::S3::S3Client> s3_client_;
+  const size_t multipart_upload_part_size_;
   bool sync_needed_;
   std::shared_ptr<Aws::Utils::TempFile> outfile_;
 };
@@ -290,7 +543,18 @@ class S3ReadOnlyMemoryRegion : public ReadOnlyMemoryRegion {
 }  // namespace
 
 S3FileSystem::S3FileSystem()
-    : s3_client_(nullptr, ShutdownClient), client_lock_() {}
+    : s3_client_(nullptr, ShutdownClient),
+      client_lock_(),
+      read_ahead_size_(
+          GetSizeFromEnv("S3_READ_AHEAD_SIZE_MB", kS3DefaultReadAheadSize)),
+      multipart_upload_part_size_(
+          GetSizeFromEnv("S3_MULTIPART_UPLOAD_PART_SIZE_MB",
+                         kS3DefaultMultipartUploadPartSize)) {
+  if (multipart_upload_part_size_ > 0 &&
+      multipart_upload_part_size_ < kS3MinMultipartUploadPartSize) {
+    multipart_upload_part_size_ = kS3MinMultipartUploadPartSize;
+  }
+}
 
 S3FileSystem::~S3FileSystem() {}
 
@@ -328,7 +592,8 @@ Status S3FileSystem::NewRandomAccessFile(
     const string& fname, std::unique_ptr<RandomAccessFile>* result) {
   string bucket, object;
   TF_RETURN_IF_ERROR(ParseS3Path(fname, false, &bucket, &object));
-  result->reset(new S3RandomAccessFile(bucket, object, this->GetS3Client()));
+  result->reset(new S3RandomAccessFile(bucket, object, this->GetS3Client(),
+                                       read_ahead_size_));
   return Status::OK();
 }
 
@@ -336,7 +601,8 @@ Status S3FileSystem::NewWritableFile(const string& fname,
                                      std::unique_ptr<WritableFile>* result) {
   string bucket, object;
   TF_RETURN_IF_ERROR(ParseS3Path(fname, false, &bucket, &object));
-  result->reset(new S3WritableFile(bucket, object, this->GetS3Client()));
+  result->reset(new S3WritableFile(bucket, object, this->GetS3Client(),
+                                   multipart_upload_part_size_));
   return Status::OK();
 }
 
@@ -351,7 +617,8 @@ Status S3FileSystem::NewAppendableFile(const string& fname,
 
   string bucket, object;
   TF_RETURN_IF_ERROR(ParseS3Path(fname, false, &bucket, &object));
-  result->reset(new S3WritableFile(bucket, object, this->GetS3Client()));
+  result->reset(new S3WritableFile(bucket, object, this->GetS3Client(),
+                                   multipart_upload_part_size_));
 
   while (true) {
     status = reader->Read(offset, kS3ReadAppendableFileBufferSize, &read_chunk,
@@ -499,7 +766,70 @@ Status S3FileSystem::Stat(const string& fname, FileStatistics* stats) {
 
 Status S3FileSystem::GetMatchingPaths(const string& pattern,
                                       std::vector<string>* results) {
-  return internal::GetMatchingPaths(this, Env::Default(), pattern, results);
+  results->clear();
+  // Find the fixed prefix by looking for the first wildcard.
+  const string fixed_prefix = pattern.substr(0, pattern.find_first_of("*?[\\"));
+  const string dir(io::Dirname(fixed_prefix));
+  if (dir.empty()) {
+    return errors::InvalidArgument("An S3 pattern doesn't have a bucket name: ",
+                                   pattern);
+  }
+  string bucket, object_prefix, dir_prefix;
+  TF_RETURN_IF_ERROR(ParseS3Path(fixed_prefix, true, &bucket, &object_prefix));
+  TF_RETURN_IF_ERROR(ParseS3Path(dir, true, &bucket, &dir_prefix));
+  if (!dir_prefix.empty() && dir_prefix.back() != '/') {
+    dir_prefix.push_back('/');
+  }
+
+  // List all the objects starting with the fixed prefix in pages, instead of
+  // walking the directories and checking each candidate with a request.
+  Aws::S3::Model::ListObjectsRequest listObjectsRequest;
+  listObjectsRequest.WithBucket(bucket.c_str())
+      .WithPrefix(object_prefix.c_str())
+      .WithMaxKeys(kS3ListObjectsMaxKeys);
+  listObjectsRequest.SetResponseStreamFactory(
+      []() { return Aws::New<Aws::StringStream>(kS3FileSystemAllocationTag); });
+
+  // The paths relative to 'dir' of the objects and of their parent
+  // directories.
+  std::set<string> paths;
+  Aws::S3::Model::ListObjectsResult listObjectsResult;
+  do {
+    auto listObjectsOutcome =
+        this->GetS3Client()->ListObjects(listObjectsRequest);
+    if (!listObjectsOutcome.IsSuccess()) {
+      return errors::Unknown(listObjectsOutcome.GetError().GetExceptionName(),
+                             ": ", listObjectsOutcome.GetError().GetMessage());
+    }
+
+    listObjectsResult = listObjectsOutcome.GetResult();
+    for (const auto& object : listObjectsResult.GetContents()) {
+      StringPiece path(object.GetKey().c_str(), object.GetKey().size());
+      if (!absl::ConsumePrefix(&path, dir_prefix)) {
+        continue;
+      }
+      // Directory markers stand for their directory.
+      absl::ConsumeSuffix(&path, "/");
+      while (!path.empty()) {
+        paths.emplace(path);
+        path = io::Dirname(path);
+      }
+    }
+    // Without a delimiter, S3 returns no next marker and the listing
+    // continues after the last key.
+    if (!listObjectsResult.GetContents().empty()) {
+      listObjectsRequest.SetMarker(
+          listObjectsResult.GetContents().back().GetKey());
+    }
+  } while (listObjectsResult.GetIsTruncated());
+
+  for (const string& path : paths) {
+    const string full_path = io::JoinPath(dir, path);
+    if (Env::Default()->MatchPath(full_path, pattern)) {
+      results->push_back(full_path);
+    }
+  }
+  return Status::OK();
 }
 
 Status S3FileSystem::DeleteFile(const string& fname) {
@@ -73,11 +73,23 @@ class S3FileSystem : public FileSystem {
   // HTTPS is used.
   // This S3 Client does not support Virtual Hosted–Style Method
   // for a bucket.
+  // All files share the connection pool of this client, whose size is
+  // controlled by `S3_MAX_CONNECTIONS`, and its pool of threads for
+  // asynchronous requests.
   std::shared_ptr<Aws::S3::S3Client> GetS3Client();
 
   std::shared_ptr<Aws::S3::S3Client> s3_client_;
   // Lock held when checking for s3_client_ initialization.
   mutex client_lock_;
+
+  // Reads smaller than this are served from a buffer of this size, and the
+  // next range is fetched asynchronously for sequential readers. Controlled
+  // by `S3_READ_AHEAD_SIZE_MB`, 0 disables the buffering.
+  size_t read_ahead_size_;
+  // Files larger than this are uploaded in parts of this size in parallel.
+  // Controlled by `S3_MULTIPART_UPLOAD_PART_SIZE_MB`, 0 disables multipart
+  // uploads.
+  size_t multipart_upload_part_size_;
 };
 
 }  // namespace tensorflow
@@ -91,6 +91,33 @@ TEST_F(S3FileSystemTest, NewRandomAccessFile) {
   EXPECT_EQ(content.substr(2, 4), result);
 }
 
+TEST_F(S3FileSystemTest, NewRandomAccessFile_SequentialReads) {
+  const string fname = TmpDir("SequentialReads");
+  // Several read-ahead buffers of content.
+  string content(20 * 1024 * 1024, 'x');
+  for (size_t i = 0; i < content.size(); i += 4096) {
+    content[i] = 'a' + (i / 4096) % 26;
+  }
+  TF_ASSERT_OK(WriteString(fname, content));
+
+  std::unique_ptr<RandomAccessFile> reader;
+  TF_ASSERT_OK(s3fs.NewRandomAccessFile(fname, &reader));
+  // Reads straddling the read-ahead buffers.
+  const size_t read_size = 3 * 1024 * 1024 + 17;
+  string got(read_size, 0);
+  StringPiece result;
+  uint64 offset = 0;
+  Status status;
+  while ((status = reader->Read(offset, read_size, &result,
+                                gtl::string_as_array(&got)))
+             .ok()) {
+    EXPECT_EQ(content.substr(offset, read_size), result);
+    offset += result.size();
+  }
+  EXPECT_EQ(error::OUT_OF_RANGE, status.code());
+  EXPECT_EQ(content.substr(offset), result);
+}
+
 TEST_F(S3FileSystemTest, NewWritableFile) {
   std::unique_ptr<WritableFile> writer;
   const string fname = TmpDir("WritableFile");
@@ -106,6 +133,20 @@ TEST_F(S3FileSystemTest, NewWritableFile) {
   EXPECT_EQ("content1,content2", content);
 }
 
+TEST_F(S3FileSystemTest, NewWritableFile_MultipartUpload) {
+  const string fname = TmpDir("MultipartUpload");
+  // Spans several upload parts.
+  string content(20 * 1024 * 1024 + 17, 'x');
+  for (size_t i = 0; i < content.size(); i += 4096) {
+    content[i] = 'a' + (i / 4096) % 26;
+  }
+  TF_ASSERT_OK(WriteString(fname, content));
+
+  string got;
+  TF_EXPECT_OK(ReadAll(fname, &got));
+  EXPECT_EQ(content, got);
+}
+
 TEST_F(S3FileSystemTest, NewAppendableFile) {
   std::unique_ptr<WritableFile> writer;
 
@@ -157,6 +198,25 @@ TEST_F(S3FileSystemTest, GetChildren) {
   EXPECT_EQ(std::vector<string>({"SubDir", "TestFile.csv"}), children);
 }
 
+TEST_F(S3FileSystemTest, GetMatchingPaths) {
+  const string base = TmpDir("GetMatchingPaths");
+  TF_EXPECT_OK(WriteString(io::JoinPath(base, "shard-0"), "test"));
+  TF_EXPECT_OK(WriteString(io::JoinPath(base, "shard-1"), "test"));
+  TF_EXPECT_OK(WriteString(io::JoinPath(base, "other"), "test"));
+  TF_EXPECT_OK(WriteString(io::JoinPath(base, "SubDir", "shard-2"), "test"));
+
+  std::vector<string> results;
+  TF_EXPECT_OK(s3fs.GetMatchingPaths(io::JoinPath(base, "shard-*"), &results));
+  EXPECT_EQ(std::vector<string>({io::JoinPath(base, "shard-0"),
+                                 io::JoinPath(base, "shard-1")}),
+            results);
+  TF_EXPECT_OK(s3fs.GetMatchingPaths(io::JoinPath(base, "*"), &results));
+  EXPECT_EQ(std::vector<string>(
+                {io::JoinPath(base, "SubDir"), io::JoinPath(base, "other"),
+                 io::JoinPath(base, "shard-0"), io::JoinPath(base, "shard-1")}),
+            results);
+}
+
 TEST_F(S3FileSystemTest, DeleteFile) {
   const string fname = TmpDir("DeleteFile");
   TF_ASSERT_OK(WriteString(fname, "test"));
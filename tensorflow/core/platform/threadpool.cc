@@ -17,11 +17,15 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <atomic>
+
 #include "absl/types/optional.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/denormal.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/numa.h"
@@ -31,6 +35,14 @@ limitations under the License.
 namespace tensorflow {
 namespace thread {
 
+namespace {
+
+// The work-stealing ParallelFor sizes blocks to cost at least this many
+// nanoseconds, as Shard() does.
+constexpr int64 kMinCostPerBlock = 10000;
+
+}  // namespace
+
 struct EigenEnvironment {
   typedef Thread EnvThread;
   struct TaskImpl {
@@ -45,19 +57,28 @@ struct EigenEnvironment {
   Env* const env_;
   const ThreadOptions thread_options_;
   const string name_;
+  // The NUMA node of each thread, in the order the pool creates them, if the
+  // threads are spread over the nodes.
+  std::vector<int> thread_numa_nodes_;
+  size_t num_threads_created_ = 0;
 
   EigenEnvironment(Env* env, const ThreadOptions& thread_options,
                    const string& name)
       : env_(env), thread_options_(thread_options), name_(name) {}
 
   EnvThread* CreateThread(std::function<void()> f) {
+    int numa_node = thread_options_.numa_node;
+    if (num_threads_created_ < thread_numa_nodes_.size()) {
+      numa_node = thread_numa_nodes_[num_threads_created_];
+    }
+    ++num_threads_created_;
     return env_->StartThread(thread_options_, name_, [=]() {
       // Set the processor flag to flush denormals to zero.
       port::ScopedFlushDenormal flush;
       // Set the processor rounding mode to ROUND TO NEAREST.
       port::ScopedSetRound round(FE_TONEAREST);
-      if (thread_options_.numa_node != port::kNUMANoAffinity) {
-        port::NUMASetThreadNodeAffinity(thread_options_.numa_node);
+      if (numa_node != port::kNUMANoAffinity) {
+        port::NUMASetThreadNodeAffinity(numa_node);
       }
       f();
     });
@@ -105,6 +126,38 @@ ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
                                                        num_threads, allocator));
 }
 
+ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
+                       const string& name, int num_threads,
+                       bool low_latency_hint,
+                       const WorkStealingOptions& work_stealing_options,
+                       Eigen::Allocator* allocator)
+    : work_stealing_options_(work_stealing_options) {
+  CHECK_GE(num_threads, 1);
+  EigenEnvironment eigen_env(env, thread_options, "tf_" + name);
+  const int num_numa_nodes = port::NUMANumNodes();
+  if (work_stealing_options.numa_aware &&
+      thread_options.numa_node == port::kNUMANoAffinity &&
+      num_numa_nodes > 1 && num_threads > 1) {
+    numa_partitions_.resize(num_threads);
+    for (int node = 0; node < num_numa_nodes; ++node) {
+      const unsigned start = node * num_threads / num_numa_nodes;
+      const unsigned limit = (node + 1) * num_threads / num_numa_nodes;
+      for (unsigned i = start; i < limit; ++i) {
+        eigen_env.thread_numa_nodes_.push_back(node);
+        numa_partitions_[i] = {start, limit};
+      }
+    }
+  }
+  eigen_threadpool_.reset(new Eigen::ThreadPoolTempl<EigenEnvironment>(
+      num_threads, low_latency_hint, std::move(eigen_env)));
+  if (!numa_partitions_.empty()) {
+    eigen_threadpool_->SetStealPartitions(numa_partitions_);
+  }
+  underlying_threadpool_ = eigen_threadpool_.get();
+  threadpool_device_.reset(new Eigen::ThreadPoolDevice(underlying_threadpool_,
+                                                       num_threads, allocator));
+}
+
 ThreadPool::ThreadPool(thread::ThreadPoolInterface* user_threadpool) {
   underlying_threadpool_ = user_threadpool;
   threadpool_device_.reset(new Eigen::ThreadPoolDevice(
@@ -204,6 +257,10 @@ void ThreadPool::ParallelFor(int64 total, int64 cost_per_unit,
                              const std::function<void(int64, int64)>& fn) {
   CHECK_GE(total, 0);
   CHECK_EQ(total, (int64)(Eigen::Index)total);
+  if (work_stealing_options_) {
+    ParallelForWithWorkStealing(total, cost_per_unit, fn);
+    return;
+  }
   threadpool_device_->parallelFor(
       total, Eigen::TensorOpCost(0, 0, cost_per_unit),
       [&fn](Eigen::Index first, Eigen::Index last) { fn(first, last); });
@@ -214,6 +271,13 @@ void ThreadPool::ParallelForWithWorkerId(
     const std::function<void(int64, int64, int)>& fn) {
   CHECK_GE(total, 0);
   CHECK_EQ(total, (int64)(Eigen::Index)total);
+  if (work_stealing_options_) {
+    ParallelForWithWorkStealing(
+        total, cost_per_unit, [this, &fn](int64 start, int64 limit) {
+          fn(start, limit, CurrentThreadId() + 1);
+        });
+    return;
+  }
 
   threadpool_device_->parallelFor(total,
                                   Eigen::TensorOpCost(0, 0, cost_per_unit),
@@ -228,6 +292,77 @@ void ThreadPool::ParallelForWithWorkerId(
                                   });
 }
 
+void ThreadPool::ParallelForWithWorkStealing(
+    int64 total, int64 cost_per_unit,
+    const std::function<void(int64, int64)>& fn) {
+  int64 first = 0;
+  if (work_stealing_options_->cost_measurement_nanos > 0) {
+    // Run batches of doubling size on this thread until the budget is spent.
+    const uint64 start_nanos = EnvTime::Default()->NowNanos();
+    uint64 elapsed_nanos = 0;
+    for (int64 batch = 1; first < total &&
+                          elapsed_nanos < static_cast<uint64>(
+                              work_stealing_options_->cost_measurement_nanos);
+         batch *= 2) {
+      const int64 last = std::min(total, first + batch);
+      fn(first, last);
+      first = last;
+      elapsed_nanos = EnvTime::Default()->NowNanos() - start_nanos;
+    }
+    if (first > 0) {
+      cost_per_unit = std::max<int64>(1, elapsed_nanos / first);
+    }
+  }
+  if (first == total) return;
+
+  const int64 block_size =
+      std::max<int64>(1, kMinCostPerBlock / std::max<int64>(1, cost_per_unit));
+  const int64 num_blocks = (total - first + block_size - 1) / block_size;
+  const int num_helpers = std::min<int64>(NumThreads(), num_blocks - 1);
+  if (num_helpers <= 0) {
+    fn(first, total);
+    return;
+  }
+
+  // The blocks are claimed in order by this thread and the helpers.
+  std::atomic<int64> next_block(first);
+  auto run_blocks = [&next_block, &fn, total, block_size]() {
+    int64 start;
+    while ((start = next_block.fetch_add(block_size)) < total) {
+      fn(start, std::min(total, start + block_size));
+    }
+  };
+  std::atomic<int> num_running_helpers(num_helpers);
+  BlockingCounter counter(num_helpers);
+  for (int i = 0; i < num_helpers; ++i) {
+    ScheduleNearby([&run_blocks, &num_running_helpers, &counter]() {
+      run_blocks();
+      num_running_helpers.fetch_sub(1, std::memory_order_release);
+      counter.DecrementCount();
+    });
+  }
+  run_blocks();
+
+  if (work_stealing_options_->max_spin_nanos > 0) {
+    const uint64 deadline_nanos = EnvTime::Default()->NowNanos() +
+                                  work_stealing_options_->max_spin_nanos;
+    while (num_running_helpers.load(std::memory_order_acquire) > 0 &&
+           EnvTime::Default()->NowNanos() < deadline_nanos) {
+    }
+  }
+  counter.Wait();
+}
+
+void ThreadPool::ScheduleNearby(std::function<void()> fn) {
+  const int id = CurrentThreadId();
+  if (id >= 0 && !numa_partitions_.empty()) {
+    ScheduleWithHint(std::move(fn), numa_partitions_[id].first,
+                     numa_partitions_[id].second);
+  } else {
+    Schedule(std::move(fn));
+  }
+}
+
 void ThreadPool::ParallelForWithWorkerId(
     int64 total, const SchedulingParams& scheduling_params,
     const std::function<void(int64, int64, int)>& fn) {
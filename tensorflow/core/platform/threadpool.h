@@ -18,6 +18,8 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/types/optional.h"
 #include "tensorflow/core/platform/env.h"
@@ -99,6 +101,29 @@ class ThreadPool {
     absl::optional<int64> block_size_;
   };
 
+  // Options of the work-stealing mode of a pool, for machines with many cores
+  // where ParallelFor calls with little work each spend more time waking
+  // threads than working.
+  //
+  // In this mode ParallelFor splits the work into blocks that the calling
+  // thread and the woken threads claim one at a time, so threads that start
+  // late find no work left instead of delaying the call.
+  struct WorkStealingOptions {
+    // If true, the threads are spread over the NUMA nodes in contiguous
+    // blocks, and ParallelFor and idle threads keep work within the node of
+    // the scheduling thread before stealing from the others. Ignored when
+    // ThreadOptions::numa_node pins the whole pool to a node.
+    bool numa_aware = false;
+    // If positive, ParallelFor first runs units of work on the calling thread
+    // for about this many nanoseconds, and sizes the blocks of the remaining
+    // units with their measured cost instead of "cost_per_unit". Calls that
+    // complete within this budget never wake a thread.
+    int64 cost_measurement_nanos = 0;
+    // The number of nanoseconds the caller of ParallelFor spins waiting for
+    // the other threads to finish their blocks before it blocks.
+    int64 max_spin_nanos = 0;
+  };
+
   // Constructs a pool that contains "num_threads" threads with specified
   // "name". env->StartThread() is used to create individual threads with the
   // given ThreadOptions. If "low_latency_hint" is true the thread pool
@@ -112,6 +137,12 @@ class ThreadPool {
              int num_threads, bool low_latency_hint,
              Eigen::Allocator* allocator = nullptr);
 
+  // Constructs a pool as above, in work-stealing mode.
+  ThreadPool(Env* env, const ThreadOptions& thread_options, const string& name,
+             int num_threads, bool low_latency_hint,
+             const WorkStealingOptions& work_stealing_options,
+             Eigen::Allocator* allocator = nullptr);
+
   // Constructs a pool for low-latency ops that contains "num_threads" threads
   // with specified "name". env->StartThread() is used to create individual
   // threads.
@@ -227,6 +258,20 @@ class ThreadPool {
       const int64 total, const int64 block_size,
       const std::function<void(int64, int64)>& fn);
 
+  // ParallelFor of the work-stealing mode.
+  void ParallelForWithWorkStealing(int64 total, int64 cost_per_unit,
+                                   const std::function<void(int64, int64)>& fn);
+
+  // Schedules fn() on a thread of the NUMA node of the calling thread, if
+  // the pool is NUMA-aware and the calling thread is one of its threads.
+  void ScheduleNearby(std::function<void()> fn);
+
+  // The work-stealing options, if the pool is in work-stealing mode.
+  absl::optional<WorkStealingOptions> work_stealing_options_;
+  // The threads of the NUMA node of each thread, as [start, limit) ranges,
+  // if the pool is NUMA-aware.
+  std::vector<std::pair<unsigned, unsigned>> numa_partitions_;
+
   // underlying_threadpool_ is the user_threadpool if user_threadpool is
   // provided in the constructor. Otherwise it is the eigen_threadpool_.
   Eigen::ThreadPoolInterface* underlying_threadpool_;
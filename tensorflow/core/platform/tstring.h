@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PLATFORM_TSTRING_H_
 #define TENSORFLOW_CORE_PLATFORM_TSTRING_H_
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 
 // TODO(b/138799229): Used to toggle until global presubmits pass.
@@ -50,9 +52,20 @@ namespace tensorflow {
 // The underlying implementation of tstring will be replaced with the one
 // defined in [1] once the migration in tensorflow/ is complete.
 //
+// A tstring is either owned, or a view of bytes owned by someone else, set
+// with assign_as_view(), which copies nothing. The viewed bytes must outlive
+// the view; string tensors use this to refer to slices of another tensor that
+// they keep alive (see tensor::MakeStringViewTensor). As in [1], the view is
+// read only: any mutation first copies the bytes, and so does copying the
+// tstring, so that copies never outlive the bytes. Moving and swapping keep
+// views. The c_str() of a view is not NUL-terminated.
+//
 // [1] https://github.com/tensorflow/community/pull/91
 class tstring {
   std::string str_;
+  // The viewed bytes, or nullptr if the string is owned.
+  const char* view_ = nullptr;
+  size_t view_size_ = 0;
 
   template <typename T, typename = void>
   struct ResizeUninitialized {
@@ -67,10 +80,40 @@ class tstring {
     }
   };
 
+  // Copies the viewed bytes, if any, so that the string owns them.
+  void Materialize() {
+    if (view_ != nullptr) {
+      str_.assign(view_, view_size_);
+      view_ = nullptr;
+      view_size_ = 0;
+    }
+  }
+
+  // Drops the view, if any, before the string is overwritten.
+  void DropView() {
+    view_ = nullptr;
+    view_size_ = 0;
+  }
+
+  static int Compare(const char* a, size_t a_size, const char* b,
+                     size_t b_size) {
+    const int cmp = std::memcmp(a, b, std::min(a_size, b_size));
+    if (cmp != 0) return cmp;
+    return a_size < b_size ? -1 : (a_size > b_size ? 1 : 0);
+  }
+
+  int Compare(const tstring& o) const {
+    return Compare(data(), size(), o.data(), o.size());
+  }
+
+  int Compare(const char* o) const {
+    return Compare(data(), size(), o, std::strlen(o));
+  }
+
  public:
   tstring() = default;
 
-  tstring(const tstring&) = default;
+  tstring(const tstring& str) : str_(str.data(), str.size()) {}
 
   tstring(const std::string& str) : str_(str) {}
 
@@ -95,9 +138,16 @@ class tstring {
 
   ~tstring() = default;
 
-  tstring& operator=(const tstring& str) = default;
+  tstring& operator=(const tstring& str) {
+    if (this != &str) {
+      assign(str.data(), str.size());
+    }
+
+    return *this;
+  }
 
   tstring& operator=(const std::string& str) {
+    DropView();
     str_ = str;
 
     return *this;
@@ -107,7 +157,7 @@ class tstring {
             typename std::enable_if<std::is_same<T, absl::string_view>::value,
                                     T>::type* = nullptr>
   tstring& operator=(const T& str) {
-    str_.assign(str.data(), str.size());
+    assign(str.data(), str.size());
 
     return *this;
   }
@@ -116,6 +166,7 @@ class tstring {
   template <typename T, typename std::enable_if<std::is_same<T, Cord>::value,
                                                 T>::type* = nullptr>
   tstring& operator=(const T& cord) {
+    DropView();
     str_ = string(cord);
 
     return *this;
@@ -123,6 +174,7 @@ class tstring {
 #endif  // PLATFORM_GOOGLE
 
   tstring& operator=(const char* str) {
+    DropView();
     str_ = str;
 
     return *this;
@@ -130,97 +182,147 @@ class tstring {
 
   tstring& operator=(tstring&&) noexcept = default;
 
-  bool operator<(const tstring& o) const { return str_ < o.str_; }
+  bool operator<(const tstring& o) const { return Compare(o) < 0; }
 
-  bool operator>(const tstring& o) const { return str_ > o.str_; }
+  bool operator>(const tstring& o) const { return Compare(o) > 0; }
 
-  bool operator==(const char* o) const { return str_ == o; }
+  bool operator==(const char* o) const { return Compare(o) == 0; }
 
-  bool operator==(const tstring& o) const { return str_ == o.str_; }
+  bool operator==(const tstring& o) const {
+    return size() == o.size() && Compare(o) == 0;
+  }
 
-  bool operator!=(const char* o) const { return str_ != o; }
+  bool operator!=(const char* o) const { return !(*this == o); }
 
-  bool operator!=(const tstring& o) const { return str_ != o.str_; }
+  bool operator!=(const tstring& o) const { return !(*this == o); }
 
-  operator std::string() const { return str_; }
+  operator std::string() const { return std::string(data(), size()); }
 
   template <typename T,
             typename std::enable_if<std::is_same<T, absl::string_view>::value,
                                     T>::type* = nullptr>
   operator T() const {
-    return T(str_.data(), str_.size());
+    return T(data(), size());
   }
 
-  bool empty() const { return str_.empty(); }
+  bool empty() const { return size() == 0; }
 
-  size_t length() const { return str_.length(); }
+  size_t length() const { return size(); }
 
-  size_t size() const { return str_.size(); }
+  size_t size() const { return view_ != nullptr ? view_size_ : str_.size(); }
 
-  size_t capacity() const { return str_.capacity(); }
+  size_t capacity() const {
+    return view_ != nullptr ? view_size_ : str_.capacity();
+  }
 
-  const char* c_str() const { return str_.c_str(); }
+  const char* c_str() const { return view_ != nullptr ? view_ : str_.c_str(); }
 
-  const char* data() const { return str_.data(); }
+  const char* data() const { return view_ != nullptr ? view_ : str_.data(); }
 
-  char back() const { return str_.back(); }
+  char back() const { return data()[size() - 1]; }
 
-  const char& operator[](size_t i) const { return str_[i]; }
+  const char& operator[](size_t i) const { return data()[i]; }
 
-  char* data() { return &str_[0]; }
+  char* data() {
+    Materialize();
+    return &str_[0];
+  }
 
-  char& operator[](size_t i) { return str_[i]; }
+  char& operator[](size_t i) {
+    Materialize();
+    return str_[i];
+  }
 
-  void clear() noexcept { str_.clear(); }
+  // Returns true if the string is a view of bytes it does not own.
+  bool is_view() const { return view_ != nullptr; }
 
-  void resize(size_t new_size) { str_.resize(new_size); }
+  void clear() noexcept {
+    DropView();
+    str_.clear();
+  }
+
+  void resize(size_t new_size) {
+    Materialize();
+    str_.resize(new_size);
+  }
 
   void resize_uninitialized(size_t new_size) {
+    Materialize();
     ResizeUninitialized<decltype(str_)>::Resize(str_, new_size);
   }
 
-  void reserve(size_t n) { str_.reserve(n); }
+  void reserve(size_t n) {
+    Materialize();
+    str_.reserve(n);
+  }
 
   tstring& assign(const char* str, size_t len) {
+    DropView();
     str_.assign(str, len);
 
     return *this;
   }
 
   tstring& assign(const char* str) {
+    DropView();
     str_.assign(str);
 
     return *this;
   }
 
+  // Makes the string a view of the `len` bytes at `str`, which must outlive
+  // it, without copying them.
+  tstring& assign_as_view(const char* str, size_t len) {
+    str_.clear();
+    view_ = str;
+    view_size_ = str == nullptr ? 0 : len;
+
+    return *this;
+  }
+
+  tstring& assign_as_view(const tstring& str) {
+    return assign_as_view(str.data(), str.size());
+  }
+
   tstring& append(const tstring& str) {
-    str_.append(str);
+    Materialize();
+    str_.append(str.data(), str.size());
 
     return *this;
   }
 
   tstring& append(const char* str, size_t len) {
+    Materialize();
     str_.append(str, len);
 
     return *this;
   }
 
   tstring& append(const char* str) {
+    Materialize();
     str_.append(str);
 
     return *this;
   }
 
-  void swap(tstring& str) { str_.swap(str.str_); }
+  void swap(tstring& str) {
+    str_.swap(str.str_);
+    std::swap(view_, str.view_);
+    std::swap(view_size_, str.view_size_);
+  }
 
   tstring& insert(size_t pos, const tstring& str, size_t subpos,
                   size_t sublen) {
-    str_.insert(pos, str.str_, subpos, sublen);
+    Materialize();
+    str_.insert(pos, std::string(str), subpos, sublen);
 
     return *this;
   }
 
-  void push_back(char ch) { str_.push_back(ch); }
+  void push_back(char ch) {
+    Materialize();
+    str_.push_back(ch);
+  }
 
   friend const tstring operator+(const tstring& a, const tstring& b);
   friend bool operator==(const char* a, const tstring& b);
@@ -229,18 +331,30 @@ class tstring {
   friend std::hash<tstring>;
 };
 
-inline bool operator==(const char* a, const tstring& b) { return a == b.str_; }
+inline bool operator==(const char* a, const tstring& b) { return b == a; }
 
 inline bool operator==(const std::string& a, const tstring& b) {
-  return a == b.str_;
+  return a.size() == b.size() &&
+         a.compare(0, a.size(), b.data(), b.size()) == 0;
 }
 
 inline const tstring operator+(const tstring& a, const tstring& b) {
-  return tstring(a.str_ + b.str_);
+  tstring result(a);
+  result.append(b);
+  return result;
 }
 
 inline std::ostream& operator<<(std::ostream& o, const tstring& str) {
-  return o << str.str_;
+  return o.write(str.data(), str.size());
+}
+
+// Whether tstring supports views (tstring::assign_as_view).
+constexpr bool kTStringHasViews = true;
+
+// Sets `*dst` to the `len` bytes at `str`, as a view of them, which must
+// outlive it.
+inline void AssignAsView(tstring* dst, const char* str, size_t len) {
+  dst->assign_as_view(str, len);
 }
 
 }  // namespace tensorflow
@@ -250,7 +364,7 @@ template <>
 struct hash<tensorflow::tstring> {
   size_t operator()(const tensorflow::tstring& o) const {
     std::hash<std::string> fn;
-    return fn(o.str_);
+    return fn(std::string(o));
   }
 };
 }  // namespace std
@@ -261,6 +375,14 @@ namespace tensorflow {
 
 typedef std::string tstring;
 
+// Whether tstring supports views; std::string does not.
+constexpr bool kTStringHasViews = false;
+
+// Sets `*dst` to a copy of the `len` bytes at `str`.
+inline void AssignAsView(tstring* dst, const char* str, size_t len) {
+  dst->assign(str, len);
+}
+
 }  // namespace tensorflow
 
 #endif  // USE_TSTRING
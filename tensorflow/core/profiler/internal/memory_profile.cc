@@ -0,0 +1,197 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/internal/memory_profile.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/profiler/internal/parse_annotation.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+// The number of ops listed for each peak by MemoryProfileToString.
+constexpr size_t kMaxOpsPerPeak = 5;
+
+struct MemoryEvent {
+  uint64 time = 0;
+  bool is_allocation = false;
+  uint64 addr = 0;
+  int64 bytes = 0;
+  string op;
+  int64 step_id = 0;
+};
+
+// Parses an allocation event recorded by an allocator. Returns false if
+// `event` is not one.
+bool ParseMemoryEvent(const TraceMeRecorder::Event& event, string* allocator,
+                      MemoryEvent* memory_event) {
+  Annotation annotation = ParseAnnotation(event.name);
+  if (annotation.name == "MemoryAllocation") {
+    memory_event->is_allocation = true;
+  } else if (annotation.name != "MemoryDeallocation") {
+    return false;
+  }
+  memory_event->time = event.start_time;
+  bool has_addr = false;
+  for (const auto& metadata : annotation.metadata) {
+    if (metadata.key == "allocator_name") {
+      *allocator = string(metadata.value);
+    } else if (metadata.key == "addr") {
+      has_addr = absl::SimpleAtoi(metadata.value, &memory_event->addr);
+    } else if (metadata.key == "bytes_requested") {
+      absl::SimpleAtoi(metadata.value, &memory_event->bytes);
+    } else if (metadata.key == "tf_op") {
+      memory_event->op = string(metadata.value);
+    } else if (metadata.key == "step_id") {
+      absl::SimpleAtoi(metadata.value, &memory_event->step_id);
+    }
+  }
+  return has_addr && !allocator->empty();
+}
+
+// Replays the events of one allocator, in time order, to build its steps.
+std::vector<StepMemoryProfile> BuildSteps(
+    const std::vector<MemoryEvent>& events) {
+  std::vector<StepMemoryProfile> steps;
+  std::unordered_map<int64, size_t> step_index;
+  std::vector<size_t> event_step(events.size());
+  // The event at which each step peaked.
+  std::vector<size_t> peak_event;
+
+  // First pass: find the peak of each step.
+  std::unordered_map<uint64, const MemoryEvent*> live;
+  int64 bytes_in_use = 0;
+  for (size_t i = 0; i < events.size(); ++i) {
+    const MemoryEvent& event = events[i];
+    if (!event.is_allocation) {
+      // Memory allocated before the trace started is ignored.
+      auto it = live.find(event.addr);
+      if (it != live.end()) {
+        bytes_in_use -= it->second->bytes;
+        live.erase(it);
+      }
+      continue;
+    }
+    live[event.addr] = &event;
+    bytes_in_use += event.bytes;
+    auto inserted = step_index.emplace(event.step_id, steps.size());
+    if (inserted.second) {
+      steps.emplace_back();
+      steps.back().step_id = event.step_id;
+      peak_event.push_back(i);
+    }
+    StepMemoryProfile& step = steps[inserted.first->second];
+    if (bytes_in_use > step.peak_bytes_in_use) {
+      step.peak_bytes_in_use = bytes_in_use;
+      step.peak_time = event.time;
+      peak_event[inserted.first->second] = i;
+    }
+  }
+  for (const auto& entry : live) {
+    const MemoryEvent& event = *entry.second;
+    steps[step_index[event.step_id]].retained_bytes_by_op[event.op] +=
+        event.bytes;
+  }
+
+  // Second pass: break down the memory in use at each peak by op.
+  std::unordered_map<size_t, std::vector<size_t>> steps_peaking_at;
+  for (size_t step = 0; step < steps.size(); ++step) {
+    steps_peaking_at[peak_event[step]].push_back(step);
+  }
+  live.clear();
+  std::map<string, int64> bytes_by_op;
+  for (size_t i = 0; i < events.size(); ++i) {
+    const MemoryEvent& event = events[i];
+    if (event.is_allocation) {
+      live[event.addr] = &event;
+      bytes_by_op[event.op] += event.bytes;
+    } else {
+      auto it = live.find(event.addr);
+      if (it != live.end()) {
+        auto op = bytes_by_op.find(it->second->op);
+        op->second -= it->second->bytes;
+        if (op->second == 0) bytes_by_op.erase(op);
+        live.erase(it);
+      }
+    }
+    auto peaking = steps_peaking_at.find(i);
+    if (peaking != steps_peaking_at.end()) {
+      for (size_t step : peaking->second) {
+        steps[step].peak_bytes_by_op = bytes_by_op;
+      }
+    }
+  }
+  return steps;
+}
+
+}  // namespace
+
+MemoryProfile BuildMemoryProfile(const TraceMeRecorder::Events& events) {
+  std::map<string, std::vector<MemoryEvent>> events_by_allocator;
+  for (const auto& thread : events) {
+    for (const auto& event : thread.events) {
+      string allocator;
+      MemoryEvent memory_event;
+      if (ParseMemoryEvent(event, &allocator, &memory_event)) {
+        events_by_allocator[allocator].push_back(std::move(memory_event));
+      }
+    }
+  }
+  MemoryProfile profile;
+  for (auto& entry : events_by_allocator) {
+    std::vector<MemoryEvent>& allocator_events = entry.second;
+    std::stable_sort(allocator_events.begin(), allocator_events.end(),
+                     [](const MemoryEvent& a, const MemoryEvent& b) {
+                       return a.time < b.time;
+                     });
+    profile[entry.first] = BuildSteps(allocator_events);
+  }
+  return profile;
+}
+
+string MemoryProfileToString(const MemoryProfile& profile) {
+  string result;
+  for (const auto& entry : profile) {
+    absl::StrAppend(&result, "Allocator ", entry.first, ":\n");
+    for (const StepMemoryProfile& step : entry.second) {
+      absl::StrAppend(&result, "  Step ", step.step_id, ": peak ",
+                      step.peak_bytes_in_use, " bytes at ", step.peak_time,
+                      "\n");
+      std::vector<std::pair<int64, string>> ops;
+      for (const auto& op : step.peak_bytes_by_op) {
+        ops.emplace_back(op.second, op.first);
+      }
+      std::sort(ops.rbegin(), ops.rend());
+      if (ops.size() > kMaxOpsPerPeak) ops.resize(kMaxOpsPerPeak);
+      for (const auto& op : ops) {
+        absl::StrAppend(&result, "    ", op.first, " bytes: ", op.second,
+                        "\n");
+      }
+      for (const auto& op : step.retained_bytes_by_op) {
+        absl::StrAppend(&result, "    retained ", op.second, " bytes: ",
+                        op.first, "\n");
+      }
+    }
+  }
+  return result;
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
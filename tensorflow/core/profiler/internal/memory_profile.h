@@ -0,0 +1,60 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_PROFILER_INTERNAL_MEMORY_PROFILE_H_
+#define TENSORFLOW_CORE_PROFILER_INTERNAL_MEMORY_PROFILE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/internal/traceme_recorder.h"
+
+namespace tensorflow {
+namespace profiler {
+
+// Memory usage of one allocator during one step, built from the
+// "MemoryAllocation" and "MemoryDeallocation" events that allocators record
+// with TraceMe (see BFCAllocator::AllocateRaw). Only the memory allocated
+// while the profiler was recording is accounted for.
+struct StepMemoryProfile {
+  int64 step_id = 0;
+  // The largest number of bytes in use right after an allocation of the step,
+  // and when it was reached, in ns since the Unix epoch.
+  int64 peak_bytes_in_use = 0;
+  uint64 peak_time = 0;
+  // The bytes in use at the peak, keyed by the op that allocated them. Ops of
+  // other steps may hold memory at the peak, too.
+  std::map<string, int64> peak_bytes_by_op;
+  // The bytes allocated during the step and not freed by the end of the
+  // trace, keyed by op: leaks, or state such as variables.
+  std::map<string, int64> retained_bytes_by_op;
+};
+
+// The steps of each allocator in the order they first allocated memory, keyed
+// by allocator name. Memory allocated outside of any op is in step 0.
+using MemoryProfile = std::map<string, std::vector<StepMemoryProfile>>;
+
+// Builds the memory profile of the allocation events among `events`.
+MemoryProfile BuildMemoryProfile(const TraceMeRecorder::Events& events);
+
+// Returns a human-readable timeline of the peaks of `profile`, with the ops
+// holding the most memory at each peak.
+string MemoryProfileToString(const MemoryProfile& profile);
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_INTERNAL_MEMORY_PROFILE_H_
@@ -0,0 +1,90 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/internal/memory_profile.h"
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+TraceMeRecorder::Event Allocation(uint64 time, uint64 addr, int64 bytes,
+                                  const string& op, int64 step_id) {
+  return {0,
+          absl::StrCat("MemoryAllocation#allocator_name=cpu,addr=", addr,
+                       ",bytes_requested=", bytes, ",tf_op=", op,
+                       ",step_id=", step_id, "#"),
+          time, time};
+}
+
+TraceMeRecorder::Event Deallocation(uint64 time, uint64 addr) {
+  return {0,
+          absl::StrCat("MemoryDeallocation#allocator_name=cpu,addr=", addr,
+                       "#"),
+          time, time};
+}
+
+TEST(MemoryProfileTest, PeaksAndRetainedMemory) {
+  TraceMeRecorder::Events events(2);
+  events[0].events = {
+      Deallocation(1, 99),  // Allocated before the trace.
+      Allocation(10, 1, 100, "a", 1),
+      Deallocation(30, 1),
+      Deallocation(50, 2),
+  };
+  events[1].events = {
+      {0, "Compute", 5, 100},
+      Allocation(20, 2, 50, "b", 1),
+      Allocation(40, 3, 30, "c", 2),
+      Allocation(60, 4, 10, "d", 2),
+  };
+
+  MemoryProfile profile = BuildMemoryProfile(events);
+  ASSERT_EQ(profile.size(), 1);
+  const std::vector<StepMemoryProfile>& steps = profile["cpu"];
+  ASSERT_EQ(steps.size(), 2);
+
+  EXPECT_EQ(steps[0].step_id, 1);
+  EXPECT_EQ(steps[0].peak_bytes_in_use, 150);
+  EXPECT_EQ(steps[0].peak_time, 20);
+  EXPECT_EQ(steps[0].peak_bytes_by_op,
+            (std::map<string, int64>{{"a", 100}, {"b", 50}}));
+  EXPECT_TRUE(steps[0].retained_bytes_by_op.empty());
+
+  // Step 2 peaks while b, from step 1, is still in use.
+  EXPECT_EQ(steps[1].step_id, 2);
+  EXPECT_EQ(steps[1].peak_bytes_in_use, 80);
+  EXPECT_EQ(steps[1].peak_time, 40);
+  EXPECT_EQ(steps[1].peak_bytes_by_op,
+            (std::map<string, int64>{{"b", 50}, {"c", 30}}));
+  EXPECT_EQ(steps[1].retained_bytes_by_op,
+            (std::map<string, int64>{{"c", 30}, {"d", 10}}));
+
+  EXPECT_EQ(MemoryProfileToString(profile),
+            "Allocator cpu:\n"
+            "  Step 1: peak 150 bytes at 20\n"
+            "    100 bytes: a\n"
+            "    50 bytes: b\n"
+            "  Step 2: peak 80 bytes at 40\n"
+            "    50 bytes: b\n"
+            "    30 bytes: c\n"
+            "    retained 30 bytes: c\n"
+            "    retained 10 bytes: d\n");
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
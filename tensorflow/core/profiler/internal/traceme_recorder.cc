@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/internal/traceme_recorder.h"
 
 #include <cstddef>
+#include <utility>
 
 #include "tensorflow/core/platform/env.h"
 
@@ -23,6 +24,9 @@ namespace profiler {
 
 std::atomic<int> TraceMeRecorder::trace_level_ =
     ATOMIC_VAR_INIT(TraceMeRecorder::kTracingDisabled);
+std::atomic<int> TraceMeRecorder::sampling_level_ =
+    ATOMIC_VAR_INIT(TraceMeRecorder::kTracingDisabled);
+std::atomic<int> TraceMeRecorder::sample_period_ = ATOMIC_VAR_INIT(1);
 
 // Implementation of TraceMeRecorder::trace_level_ must be lock-free for faster
 // execution of the TraceMe() public API. This can be commented (if compilation
@@ -31,6 +35,22 @@ static_assert(ATOMIC_INT_LOCK_FREE == 2, "Assumed atomic<int> was lock free");
 
 namespace {
 
+// The number of activities of this thread to skip before the next sample.
+thread_local int sample_countdown = 0;
+
+// Merges the histograms of `from` into `to`.
+void MergeSamples(TraceMeRecorder::Samples&& from,
+                  TraceMeRecorder::Samples* to) {
+  for (auto& entry : from) {
+    auto& histogram = (*to)[entry.first];
+    if (histogram == nullptr) {
+      histogram = std::move(entry.second);
+    } else {
+      histogram->Merge(*entry.second);
+    }
+  }
+}
+
 // A single-producer single-consumer queue of Events.
 //
 // Implemented as a linked-list of blocks containing numbered slots, with start
@@ -168,11 +188,34 @@ class TraceMeRecorder::ThreadLocalRecorder {
   }
 
   // The destructor is called when the thread shuts down early.
-  ~ThreadLocalRecorder() { TraceMeRecorder::Get()->UnregisterThread(Clear()); }
+  ~ThreadLocalRecorder() {
+    TraceMeRecorder::Get()->UnregisterThread(Clear(), TakeSamples());
+  }
 
   // Record is only called from the owner thread.
   void Record(TraceMeRecorder::Event&& event) { queue_.Push(std::move(event)); }
 
+  // AddSample is only called from the owner thread, so the mutex is only
+  // contended while samples are being collected.
+  void AddSample(const TraceMeRecorder::Event& event) {
+    const string name = event.name.substr(0, event.name.find('#'));
+    mutex_lock lock(samples_mutex_);
+    auto& durations = samples_[name];
+    if (durations == nullptr) {
+      durations.reset(new histogram::Histogram);
+    }
+    durations->Add(event.end_time - event.start_time);
+  }
+
+  // TakeSamples is called from the thread collecting samples, or from the
+  // owner thread when it shuts down.
+  TraceMeRecorder::Samples TakeSamples() {
+    TraceMeRecorder::Samples samples;
+    mutex_lock lock(samples_mutex_);
+    std::swap(samples_, samples);
+    return samples;
+  }
+
   // Clear is called from the control thread when tracing starts/stops, or from
   // the owner thread when it shuts down (see destructor).
   TraceMeRecorder::ThreadEvents Clear() { return {info_, queue_.PopAll()}; }
@@ -180,6 +223,8 @@ class TraceMeRecorder::ThreadLocalRecorder {
  private:
   TraceMeRecorder::ThreadInfo info_;
   EventQueue queue_;
+  mutex samples_mutex_;
+  TraceMeRecorder::Samples samples_ GUARDED_BY(samples_mutex_);
 };
 
 /*static*/ TraceMeRecorder* TraceMeRecorder::Get() {
@@ -192,10 +237,12 @@ void TraceMeRecorder::RegisterThread(int32 tid, ThreadLocalRecorder* thread) {
   threads_.emplace(tid, thread);
 }
 
-void TraceMeRecorder::UnregisterThread(TraceMeRecorder::ThreadEvents&& events) {
+void TraceMeRecorder::UnregisterThread(TraceMeRecorder::ThreadEvents&& events,
+                                       TraceMeRecorder::Samples&& samples) {
   mutex_lock lock(mutex_);
   threads_.erase(events.thread.tid);
   orphaned_events_.push_back(std::move(events));
+  MergeSamples(std::move(samples), &orphaned_samples_);
 }
 
 // This method is performance critical and should be kept fast. It is called
@@ -228,9 +275,49 @@ bool TraceMeRecorder::StartRecording(int level) {
 
 void TraceMeRecorder::Record(Event event) {
   static thread_local ThreadLocalRecorder thread_local_recorder;
+  if (Sampling() && event.start_time != 0 && event.end_time != 0) {
+    thread_local_recorder.AddSample(event);
+    sample_countdown = sample_period_.load(std::memory_order_relaxed) - 1;
+    // Sampled events are only kept while recording.
+    if (!Active()) return;
+  }
   thread_local_recorder.Record(std::move(event));
 }
 
+/*static*/ bool TraceMeRecorder::SampleThisThread() {
+  if (sample_countdown > 0) {
+    --sample_countdown;
+    return false;
+  }
+  return true;
+}
+
+bool TraceMeRecorder::StartSamplingImpl(int level, int sample_period) {
+  level = std::max(0, level);
+  mutex_lock lock(mutex_);
+  if (sampling_level_.load(std::memory_order_relaxed) != kTracingDisabled) {
+    return false;
+  }
+  sample_period_.store(std::max(1, sample_period), std::memory_order_relaxed);
+  sampling_level_.store(level, std::memory_order_release);
+  return true;
+}
+
+void TraceMeRecorder::StopSamplingImpl() {
+  mutex_lock lock(mutex_);
+  sampling_level_.store(kTracingDisabled, std::memory_order_release);
+}
+
+TraceMeRecorder::Samples TraceMeRecorder::CollectSamplesImpl() {
+  TraceMeRecorder::Samples samples;
+  mutex_lock lock(mutex_);
+  std::swap(orphaned_samples_, samples);
+  for (const auto& entry : threads_) {
+    MergeSamples(entry.second->TakeSamples(), &samples);
+  }
+  return samples;
+}
+
 TraceMeRecorder::Events TraceMeRecorder::StopRecording() {
   TraceMeRecorder::Events events;
   mutex_lock lock(mutex_);
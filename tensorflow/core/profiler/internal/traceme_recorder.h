@@ -17,11 +17,14 @@ limitations under the License.
 
 #include <atomic>
 #include <cstddef>
+#include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "absl/base/optimization.h"
+#include "tensorflow/core/lib/histogram/histogram.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
 
@@ -39,6 +42,12 @@ namespace profiler {
 // events, and the destructor records end events.
 // The profiler then stops the recorder and finds start/end pairs. (Unpaired
 // start/end events are discarded at that point).
+//
+// Independently of recording, the recorder can sample TraceMe activities: each
+// thread times one in every N activities, and aggregates their durations into
+// a histogram per activity name instead of keeping the events. This bounds
+// memory and keeps the overhead low enough to leave sampling always on, e.g.
+// in servers, and to export the histograms periodically with CollectSamples().
 class TraceMeRecorder {
  public:
   // An Event is either the start of a TraceMe, the end of a TraceMe, or both.
@@ -58,6 +67,9 @@ class TraceMeRecorder {
     std::vector<Event> events;
   };
   using Events = std::vector<ThreadEvents>;
+  // Histograms of activity durations in ns, keyed by activity name without
+  // its "#metadata#" suffix.
+  using Samples = std::map<string, std::unique_ptr<histogram::Histogram>>;
 
   // Starts recording of TraceMe().
   // Only traces <= level will be recorded.
@@ -74,6 +86,34 @@ class TraceMeRecorder {
                               level);
   }
 
+  // Starts sampling of TraceMe(): one in every `sample_period` activities of
+  // each thread with level <= `level` is timed. Returns false if sampling was
+  // already started.
+  static bool StartSampling(int level, int sample_period) {
+    return Get()->StartSamplingImpl(level, sample_period);
+  }
+
+  // Stops sampling. The samples aggregated so far remain collectable.
+  static void StopSampling() { Get()->StopSamplingImpl(); }
+
+  // Returns whether we're currently sampling activities of `level`.
+  static inline bool Sampling(int level = 1) {
+    return ABSL_PREDICT_FALSE(
+        sampling_level_.load(std::memory_order_relaxed) >= level);
+  }
+
+  // Returns whether an activity of `level` starting now on this thread should
+  // be recorded: always while recording, and once per sample period while
+  // sampling. The decision holds until the thread records a complete event,
+  // so a caller may check before constructing a TraceMe that checks again.
+  static inline bool Sample(int level = 1) {
+    if (Active(level)) return true;
+    return Sampling(level) && SampleThisThread();
+  }
+
+  // Returns the samples aggregated since the previous call, and resets them.
+  static Samples CollectSamples() { return Get()->CollectSamplesImpl(); }
+
   // Records an event. Non-blocking.
   static void Record(Event event);
 
@@ -81,6 +121,9 @@ class TraceMeRecorder {
   // Default value for trace_level_ when tracing is disabled
   static constexpr int kTracingDisabled = -1;
 
+  // Counts down the activities of the calling thread until the next sample.
+  static bool SampleThisThread();
+
   class ThreadLocalRecorder;
 
   // Returns singleton.
@@ -93,11 +136,15 @@ class TraceMeRecorder {
   TraceMeRecorder& operator=(const TraceMeRecorder&) = delete;
 
   void RegisterThread(int32 tid, ThreadLocalRecorder* thread);
-  void UnregisterThread(ThreadEvents&& events);
+  void UnregisterThread(ThreadEvents&& events, Samples&& samples);
 
   bool StartRecording(int level);
   Events StopRecording();
 
+  bool StartSamplingImpl(int level, int sample_period);
+  void StopSamplingImpl();
+  Samples CollectSamplesImpl();
+
   // Gathers events from all active threads, and clears their buffers.
   Events Clear() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
@@ -106,12 +153,18 @@ class TraceMeRecorder {
   // Modified by TraceMeRecorder singleton when tracing starts/stops.
   static std::atomic<int> trace_level_;
 
+  // Current sampling level, and the number of activities per sample.
+  static std::atomic<int> sampling_level_;
+  static std::atomic<int> sample_period_;
+
   mutex mutex_;
   // Map of the static container instances (thread_local storage) for each
   // thread. While active, a ThreadLocalRecorder stores trace events.
   std::unordered_map<int32, ThreadLocalRecorder*> threads_ GUARDED_BY(mutex_);
   // Events from threads that died during recording.
   TraceMeRecorder::Events orphaned_events_ GUARDED_BY(mutex_);
+  // Samples from threads that died since the last CollectSamples().
+  Samples orphaned_samples_ GUARDED_BY(mutex_);
 };
 
 }  // namespace profiler
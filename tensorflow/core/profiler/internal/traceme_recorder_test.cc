@@ -17,6 +17,7 @@ limitations under the License.
 #include <atomic>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/notification.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/env_time.h"
@@ -46,6 +47,30 @@ TEST(RecorderTest, SingleThreaded) {
               ::testing::ElementsAre(Named("during1"), Named("during2")));
 }
 
+TEST(RecorderTest, Sampling) {
+  ASSERT_TRUE(TraceMeRecorder::StartSampling(/*level=*/1, /*sample_period=*/4));
+  EXPECT_FALSE(TraceMeRecorder::StartSampling(/*level=*/1, 4));
+  EXPECT_FALSE(TraceMeRecorder::Sample(/*level=*/2));
+  int sampled = 0;
+  for (int i = 0; i < 100; i++) {
+    if (TraceMeRecorder::Sample(/*level=*/1)) {
+      sampled++;
+      TraceMeRecorder::Record(
+          {0, absl::StrCat("sampled#id=", i, "#"), 100, 100 + uint64(i)});
+    }
+  }
+  TraceMeRecorder::StopSampling();
+  EXPECT_FALSE(TraceMeRecorder::Sample(/*level=*/1));
+  EXPECT_EQ(sampled, 25);
+
+  // Samples are aggregated by name, without metadata.
+  auto samples = TraceMeRecorder::CollectSamples();
+  ASSERT_EQ(samples.size(), 1);
+  ASSERT_EQ(samples.count("sampled"), 1);
+  EXPECT_EQ(samples["sampled"]->Average(), 48);  // 0, 4, ..., 96.
+  EXPECT_TRUE(TraceMeRecorder::CollectSamples().empty());
+}
+
 void SpinNanos(int nanos) {
   uint64 deadline = Env::Default()->NowNanos() + nanos;
   while (Env::Default()->NowNanos() < deadline) {
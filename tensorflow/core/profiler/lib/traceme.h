@@ -79,7 +79,7 @@ class TraceMe {
   // out their host traces based on verbosity.
   explicit TraceMe(absl::string_view activity_name, int level = 1) {
     DCHECK_GE(level, 1);
-    if (TraceMeRecorder::Active(level)) {
+    if (TraceMeRecorder::Sample(level)) {
       new (&no_init_.name) string(activity_name);
       start_time_ = EnvTime::Default()->NowNanos();
     } else {
@@ -94,7 +94,7 @@ class TraceMe {
   // constructor so we avoid copying them when tracing is disabled.
   explicit TraceMe(string &&activity_name, int level = 1) {
     DCHECK_GE(level, 1);
-    if (TraceMeRecorder::Active(level)) {
+    if (TraceMeRecorder::Sample(level)) {
       new (&no_init_.name) string(std::move(activity_name));
       start_time_ = EnvTime::Default()->NowNanos();
     } else {
@@ -124,7 +124,7 @@ class TraceMe {
   template <typename NameGeneratorT>
   explicit TraceMe(NameGeneratorT name_generator, int level = 1) {
     DCHECK_GE(level, 1);
-    if (TraceMeRecorder::Active(level)) {
+    if (TraceMeRecorder::Sample(level)) {
       new (&no_init_.name) string(name_generator());
       start_time_ = EnvTime::Default()->NowNanos();
     } else {
@@ -140,12 +140,13 @@ class TraceMe {
     // - If tracing wasn't active to start with, we have kUntracedActivity.
     // - If tracing was active and was stopped, we have
     //   TraceMeRecorder::Active().
+    // - If the activity was sampled, it is recorded while sampling.
     // - If tracing was active and was restarted at a lower level, we may
     //   spuriously record the event. This is extremely rare, and acceptable as
     //   event will be discarded when its start timestamp fall outside of the
     //   start/stop session timestamp.
     if (start_time_ != kUntracedActivity) {
-      if (TraceMeRecorder::Active()) {
+      if (TraceMeRecorder::Active() || TraceMeRecorder::Sampling()) {
         TraceMeRecorder::Record({kCompleteActivity, std::move(no_init_.name),
                                  start_time_, EnvTime::Default()->NowNanos()});
       }
@@ -265,6 +265,30 @@ class Session {
     return errors::Unimplemented(
         "ReleaseCallable is not supported for this session.");
   }
+
+  /// \brief A feed/fetch/target signature of `Run`, with representative
+  /// values of its feeds, for `WarmUp`.
+  struct WarmUpSignature {
+    std::vector<std::pair<string, Tensor> > inputs;
+    std::vector<string> output_tensor_names;
+    std::vector<string> target_node_names;
+  };
+
+  /// \brief Prepares the session to `Run` each of `signatures`, so that the
+  /// first calls to `Run` with the same feeds, fetches and targets do not
+  /// prune, partition, optimize and instantiate their graph, nor autotune
+  /// their kernels.
+  ///
+  /// Each signature is run once with its representative inputs, and the
+  /// signatures are run concurrently. The runs have the side effects of the
+  /// stateful ops they execute, e.g. they update variables, so the
+  /// signatures should be read-only, or warmed up before the state is
+  /// initialized for serving. Later runs with inputs of other shapes may
+  /// still autotune their kernels.
+  ///
+  /// Returns the first error of the runs, if any.
+  /// NOTE: This API is still experimental and may change.
+  virtual Status WarmUp(const std::vector<WarmUpSignature>& signatures);
 };
 
 /// \brief Create a new session with the given options.
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/summary/summary_file_writer.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/summary/summary_converter.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -21,12 +23,18 @@ limitations under the License.
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/events_writer.h"
 #include "tensorflow/core/util/ptr_util.h"
 
 namespace tensorflow {
 namespace {
 
+// When TF_ASYNC_SUMMARY_FILE_WRITER is set, queued events are written and
+// flushed by a background thread instead of by the op that queued them, so a
+// slow (e.g. remote) file system does not stall the training step. Writers
+// only block once more than kMaxPendingBytes of events are waiting.
 class SummaryFileWriter : public SummaryWriterInterface {
  public:
   SummaryFileWriter(int max_queue, int flush_millis, Env* env)
@@ -44,26 +52,49 @@ class SummaryFileWriter : public SummaryWriterInterface {
       }
       TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(logdir));
     }
+    bool async;
+    TF_RETURN_IF_ERROR(
+        ReadBoolFromEnvVar("TF_ASYNC_SUMMARY_FILE_WRITER", false, &async));
+    {
+      mutex_lock wl(writer_mu_);
+      events_writer_ =
+          tensorflow::MakeUnique<EventsWriter>(io::JoinPath(logdir, "events"));
+      TF_RETURN_WITH_CONTEXT_IF_ERROR(
+          events_writer_->InitWithSuffix(filename_suffix),
+          "Could not initialize events writer.");
+    }
     mutex_lock ml(mu_);
-    events_writer_ =
-        tensorflow::MakeUnique<EventsWriter>(io::JoinPath(logdir, "events"));
-    TF_RETURN_WITH_CONTEXT_IF_ERROR(
-        events_writer_->InitWithSuffix(filename_suffix),
-        "Could not initialize events writer.");
     last_flush_ = env_->NowMicros();
     is_initialized_ = true;
+    if (async) {
+      writer_thread_.reset(env_->StartThread(
+          ThreadOptions(), "summary_file_writer", [this]() { WriterLoop(); }));
+    }
     return Status::OK();
   }
 
   Status Flush() override {
-    mutex_lock ml(mu_);
-    if (!is_initialized_) {
-      return errors::FailedPrecondition("Class was not properly initialized.");
+    {
+      mutex_lock ml(mu_);
+      if (!is_initialized_) {
+        return errors::FailedPrecondition(
+            "Class was not properly initialized.");
+      }
+      TF_RETURN_IF_ERROR(TakeAsyncStatus());
     }
     return InternalFlush();
   }
 
   ~SummaryFileWriter() override {
+    if (writer_thread_ != nullptr) {
+      {
+        mutex_lock ml(mu_);
+        shutdown_ = true;
+      }
+      writer_cv_.notify_all();
+      space_cv_.notify_all();
+      writer_thread_.reset();  // Joins the thread.
+    }
     (void)Flush();  // Ignore errors.
   }
 
@@ -139,13 +170,28 @@ class SummaryFileWriter : public SummaryWriterInterface {
   }
 
   Status WriteEvent(std::unique_ptr<Event> event) override {
-    mutex_lock ml(mu_);
-    queue_.emplace_back(std::move(event));
-    if (queue_.size() > max_queue_ ||
-        env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
-      return InternalFlush();
+    {
+      mutex_lock ml(mu_);
+      if (writer_thread_ != nullptr) {
+        while (pending_bytes_ > kMaxPendingBytes && !shutdown_) {
+          flush_requested_ = true;
+          writer_cv_.notify_one();
+          space_cv_.wait(ml);
+        }
+        pending_bytes_ += event->ByteSizeLong();
+      }
+      queue_.emplace_back(std::move(event));
+      if (queue_.size() <= max_queue_ &&
+          env_->NowMicros() - last_flush_ <= 1000 * flush_millis_) {
+        return Status::OK();
+      }
+      if (writer_thread_ != nullptr) {
+        flush_requested_ = true;
+        writer_cv_.notify_one();
+        return TakeAsyncStatus();
+      }
     }
-    return Status::OK();
+    return InternalFlush();
   }
 
   string DebugString() const override { return "SummaryFileWriter"; }
@@ -155,26 +201,81 @@ class SummaryFileWriter : public SummaryWriterInterface {
     return static_cast<double>(env_->NowMicros()) / 1.0e6;
   }
 
-  Status InternalFlush() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    for (const std::unique_ptr<Event>& e : queue_) {
+  // Writes and flushes every queued event. Callers hold neither lock, so
+  // events can keep being queued while the file is written.
+  Status InternalFlush() LOCKS_EXCLUDED(mu_, writer_mu_) {
+    mutex_lock wl(writer_mu_);
+    std::vector<std::unique_ptr<Event>> batch;
+    {
+      mutex_lock ml(mu_);
+      batch.swap(queue_);
+      pending_bytes_ = 0;
+    }
+    space_cv_.notify_all();
+    for (const std::unique_ptr<Event>& e : batch) {
       events_writer_->WriteEvent(*e);
     }
-    queue_.clear();
-    TF_RETURN_WITH_CONTEXT_IF_ERROR(events_writer_->Flush(),
-                                    "Could not flush events file.");
-    last_flush_ = env_->NowMicros();
+    const Status s = events_writer_->Flush();
+    {
+      mutex_lock ml(mu_);
+      last_flush_ = env_->NowMicros();
+    }
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(s, "Could not flush events file.");
     return Status::OK();
   }
 
+  // Body of writer_thread_. Flushes when asked to by WriteEvent, and at least
+  // every flush_millis_ while events are queued.
+  void WriterLoop() {
+    const int64 wait_millis = std::max(flush_millis_, 1);
+    while (true) {
+      {
+        mutex_lock ml(mu_);
+        while (!shutdown_ && !flush_requested_ &&
+               (queue_.empty() ||
+                env_->NowMicros() - last_flush_ <= 1000 * flush_millis_)) {
+          WaitForMilliseconds(&ml, &writer_cv_, wait_millis);
+        }
+        // The destructor flushes whatever is left.
+        if (shutdown_) return;
+        flush_requested_ = false;
+      }
+      const Status s = InternalFlush();
+      if (!s.ok()) {
+        mutex_lock ml(mu_);
+        async_status_.Update(s);
+      }
+    }
+  }
+
+  // Returns, and clears, the first error hit by writer_thread_.
+  Status TakeAsyncStatus() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    Status s = async_status_;
+    async_status_ = Status::OK();
+    return s;
+  }
+
+  static constexpr int64 kMaxPendingBytes = 64 << 20;
+
   bool is_initialized_;
   const int max_queue_;
   const int flush_millis_;
-  uint64 last_flush_;
+  uint64 last_flush_ GUARDED_BY(mu_);
   Env* env_;
   mutex mu_;
   std::vector<std::unique_ptr<Event>> queue_ GUARDED_BY(mu_);
+  // Serializes writes to the events file; acquired before mu_.
+  mutex writer_mu_ ACQUIRED_BEFORE(mu_);
   // A pointer to allow deferred construction.
-  std::unique_ptr<EventsWriter> events_writer_ GUARDED_BY(mu_);
+  std::unique_ptr<EventsWriter> events_writer_ GUARDED_BY(writer_mu_);
+  // Only set when writing asynchronously.
+  std::unique_ptr<Thread> writer_thread_;
+  condition_variable writer_cv_;
+  condition_variable space_cv_;
+  bool flush_requested_ GUARDED_BY(mu_) = false;
+  bool shutdown_ GUARDED_BY(mu_) = false;
+  int64 pending_bytes_ GUARDED_BY(mu_) = 0;
+  Status async_status_ GUARDED_BY(mu_);
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       GUARDED_BY(mu_);
 };
@@ -231,5 +231,46 @@ TEST_F(SummaryFileWriterTest, WallTime) {
       [](const Event& e) { EXPECT_EQ(e.wall_time(), 7.023); }));
 }
 
+TEST_F(SummaryFileWriterTest, AsyncWriter) {
+  setenv("TF_ASYNC_SUMMARY_FILE_WRITER", "1", 1);
+  SummaryWriterInterface* writer;
+  TF_CHECK_OK(CreateSummaryFileWriter(1, 1, testing::TmpDir(), "async_test",
+                                      &env_, &writer));
+  unsetenv("TF_ASYNC_SUMMARY_FILE_WRITER");
+  constexpr int kNumEvents = 100;
+  for (int i = 0; i < kNumEvents; ++i) {
+    Tensor value(DT_FLOAT, TensorShape({}));
+    value.scalar<float>()() = i;
+    TF_CHECK_OK(writer->WriteScalar(i, value, "name"));
+  }
+  // Releasing the writer flushes what the background thread has not written.
+  writer->Unref();
+
+  std::vector<string> files;
+  TF_CHECK_OK(env_.GetChildren(testing::TmpDir(), &files));
+  int num_files = 0;
+  for (const string& f : files) {
+    if (!absl::StrContains(f, "async_test")) continue;
+    ++num_files;
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env_.NewRandomAccessFile(io::JoinPath(testing::TmpDir(), f),
+                                         &read_file));
+    io::RecordReader reader(read_file.get(), io::RecordReaderOptions());
+    tstring record;
+    uint64 offset = 0;
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));  // The file version.
+    for (int i = 0; i < kNumEvents; ++i) {
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      Event e;
+      e.ParseFromString(record);
+      EXPECT_EQ(i, e.step());
+      ASSERT_EQ(1, e.summary().value_size());
+      EXPECT_EQ(i, e.summary().value(0).simple_value());
+    }
+    EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&offset, &record)));
+  }
+  EXPECT_EQ(1, num_files);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -60,6 +60,49 @@ uint8 PeekTag(protobuf::io::CodedInputStream* stream) {
   return *static_cast<const uint8*>(ptr);
 }
 
+// Decodes the packed varints in [begin, end) and appends them to `int64_list`.
+// Returns false if the data does not end with a complete varint, or if a
+// varint is longer than 10 bytes.
+template <typename Result>
+bool ParsePackedVarint64s(const uint8* begin, const uint8* end,
+                          Result* int64_list) {
+  if (begin == end) return true;
+  if (end[-1] & 0x80) return false;
+
+  // Every varint ends with the only one of its bytes that has the
+  // continuation bit cleared, so counting those bytes yields the number of
+  // values. This loop has no dependencies between iterations and is
+  // vectorized by the compiler.
+  size_t num_values = 0;
+  for (const uint8* p = begin; p < end; ++p) {
+    num_values += (*p < 0x80);
+  }
+
+  const size_t initial_size = int64_list->size();
+  int64_list->resize(initial_size + num_values);
+  // Can be less than `num_values` in case of a LimitedArraySlice.
+  const size_t num_to_write = int64_list->size() - initial_size;
+  auto* out = int64_list->data() + initial_size;
+
+  // The last byte terminates a varint, so none of the loops below can read
+  // past `end`.
+  const uint8* p = begin;
+  for (size_t i = 0; i < num_to_write; ++i) {
+    uint64 value = *p++;
+    if (value >= 0x80) {
+      value &= 0x7f;
+      for (int shift = 7;; shift += 7) {
+        if (shift > 63) return false;
+        const uint8 byte = *p++;
+        value |= static_cast<uint64>(byte & 0x7f) << shift;
+        if (byte < 0x80) break;
+      }
+    }
+    out[i] = static_cast<int64>(value);
+  }
+  return true;
+}
+
 constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
@@ -240,10 +283,24 @@ class Feature {
         if (!stream.ReadVarint32(&packed_length)) return false;
         auto packed_limit = stream.PushLimit(packed_length);
 
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64>(n));
+        // Decode the values straight out of the serialized buffer, which
+        // avoids the per-value overhead of the stream.
+        const void* packed_data = nullptr;
+        int packed_size = 0;
+        if (packed_length > 0 &&
+            stream.GetDirectBufferPointer(&packed_data, &packed_size) &&
+            static_cast<uint32>(packed_size) == packed_length) {
+          const uint8* begin = static_cast<const uint8*>(packed_data);
+          if (!ParsePackedVarint64s(begin, begin + packed_length, int64_list)) {
+            return false;
+          }
+          if (!stream.Skip(packed_length)) return false;
+        } else {
+          while (!stream.ExpectAtEnd()) {
+            protobuf_uint64 n;  // There is no API for int64
+            if (!stream.ReadVarint64(&n)) return false;
+            int64_list->push_back(static_cast<int64>(n));
+          }
         }
 
         stream.PopLimit(packed_limit);
@@ -971,46 +1028,36 @@ void CopyOrMoveBlock(const tstring* b, const tstring* e, tstring* t) {
 }
 
 template <typename T>
-void FillAndCopyVarLen(
-    const int d, const size_t num_elements,
-    const size_t num_elements_per_minibatch, const Config& config,
-    const std::vector<std::vector<SparseBuffer>>& varlen_dense_buffers,
-    Tensor* values) {
+void FillAndCopyVarLen(const int d, const size_t num_elements_per_example,
+                       const Config& config, const SparseBuffer& buffer,
+                       T* data) {
   const Tensor& default_value = config.dense[d].default_value;
+  // Number of examples being stored in this buffer
+  const auto& end_indices = buffer.example_end_indices;
+  const size_t examples_in_buffer = end_indices.size();
 
-  // Copy-fill the tensors (creating the zero/fill-padding)
-  std::fill(values->flat<T>().data(), values->flat<T>().data() + num_elements,
+  // Copy-fill the rows of these examples (creating the zero/fill-padding)
+  std::fill(data, data + examples_in_buffer * num_elements_per_example,
             default_value.flat<T>()(0));
 
   // Data is [batch_size, max_num_elements, data_stride_size]
-  //   and num_elements_per_minibatch = max_num_elements * data_stride_size
-  auto data = values->flat<T>().data();
-
-  // Iterate over minibatch elements
-  for (size_t i = 0; i < varlen_dense_buffers.size(); ++i) {
-    const SparseBuffer& buffer = varlen_dense_buffers[i][d];
-    // Number of examples being stored in this buffer
-    const auto& end_indices = buffer.example_end_indices;
-    const size_t examples_in_buffer = end_indices.size();
-    // const size_t stride_size = config.dense[d].elements_per_stride;
-
-    const auto& list = GetListFromBuffer<T>(buffer);
-    auto list_ptr = list.begin();
-
-    size_t elements_tally = 0;
-    // Iterate through all the examples stored in this buffer.
-    for (size_t j = 0; j < examples_in_buffer; ++j) {
-      // Number of elements stored for this example.
-      const size_t num_elems = end_indices[j] - elements_tally;
-      CopyOrMoveBlock(list_ptr, list_ptr + num_elems, data);
-      // Move forward this many elements in the varlen buffer.
-      list_ptr += num_elems;
-      // Move forward to the next minibatch entry in the values output.
-      data += num_elements_per_minibatch;
-      elements_tally = end_indices[j];
-    }
-    DCHECK(elements_tally == list.size());
-  }
+  //   and num_elements_per_example = max_num_elements * data_stride_size
+  const auto& list = GetListFromBuffer<T>(buffer);
+  auto list_ptr = list.begin();
+
+  size_t elements_tally = 0;
+  // Iterate through all the examples stored in this buffer.
+  for (size_t j = 0; j < examples_in_buffer; ++j) {
+    // Number of elements stored for this example.
+    const size_t num_elems = end_indices[j] - elements_tally;
+    CopyOrMoveBlock(list_ptr, list_ptr + num_elems, data);
+    // Move forward this many elements in the varlen buffer.
+    list_ptr += num_elems;
+    // Move forward to the next example entry in the values output.
+    data += num_elements_per_example;
+    elements_tally = end_indices[j];
+  }
+  DCHECK(elements_tally == list.size());
 }
 
 // Thin vector like interface wrapper around a Tensor. This enable us to
@@ -1063,6 +1110,20 @@ void CountSparseFeatures(
   }
 }
 
+// Returns the offset at which the values of every minibatch start in the
+// concatenated values of feature `d`.
+std::vector<size_t> MinibatchValueOffsets(
+    const std::vector<std::vector<SparseBuffer>>& buffers, size_t d) {
+  std::vector<size_t> offsets(buffers.size());
+  size_t offset = 0;
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    offsets[i] = offset;
+    const std::vector<size_t>& end_indices = buffers[i][d].example_end_indices;
+    if (!end_indices.empty()) offset += end_indices.back();
+  }
+  return offsets;
+}
+
 void CopySparseBufferToTensor(DataType dtype, size_t offset, SparseBuffer* src,
                               Tensor* dst) {
   switch (dtype) {
@@ -1217,9 +1278,12 @@ Status FastParseExample(const Config& config,
     result->dense_values.push_back(std::move(fixed_dense_values[d]));
   }
 
-  // Merge SparseBuffers from all minibatches for every config.sparse.
-  auto MergeSparseMinibatches = [&](size_t d) {
-    // Loop over minibatches
+  // Allocate the batch outputs of sparse, ragged and variable-length dense
+  // features, now that the number of values of every minibatch is known.
+  // Every minibatch then moves its buffers straight into its own slice of
+  // these tensors, in parallel, the same way as fixed length dense values.
+  std::vector<std::vector<size_t>> sparse_offsets(config.sparse.size());
+  for (size_t d = 0; d < config.sparse.size(); ++d) {
     size_t total_num_features = 0;
     size_t max_num_features = 0;
     CountSparseFeatures(sparse_buffers, d, &total_num_features,
@@ -1229,47 +1293,21 @@ Status FastParseExample(const Config& config,
     indices_shape.AddDim(total_num_features);
     indices_shape.AddDim(2);
     result->sparse_indices.emplace_back(DT_INT64, indices_shape);
-    Tensor* indices = &result->sparse_indices.back();
 
     TensorShape values_shape;
     values_shape.AddDim(total_num_features);
     result->sparse_values.emplace_back(config.sparse[d].dtype, values_shape);
-    Tensor* values = &result->sparse_values.back();
 
     result->sparse_shapes.emplace_back(DT_INT64, TensorShape({2}));
     auto shapes_shape_t = result->sparse_shapes.back().vec<int64>();
     shapes_shape_t(0) = serialized.size();
     shapes_shape_t(1) = max_num_features;
 
-    size_t offset = 0;
-    for (size_t i = 0; i < sparse_buffers.size(); ++i) {
-      SparseBuffer& buffer = sparse_buffers[i][d];
-
-      // Update indices.
-      int64* ix_p = &indices->matrix<int64>()(offset, 0);
-      size_t delta = 0;
-      size_t example_index = first_example_of_minibatch(i);
-      for (size_t example_end_index : buffer.example_end_indices) {
-        size_t feature_index = 0;
-        for (; delta < example_end_index; ++delta) {
-          // Column 0: example index
-          *ix_p = example_index;
-          // Column 1: the feature index buffer example
-          *(ix_p + 1) = feature_index;
-          ix_p += 2;
-          ++feature_index;
-        }
-        ++example_index;
-      }
-
-      CopySparseBufferToTensor(config.sparse[d].dtype, offset, &buffer, values);
-      offset += delta;
-    }
-  };
+    sparse_offsets[d] = MinibatchValueOffsets(sparse_buffers, d);
+  }
 
-  // Merge SparseBuffers from all minibatches for every config.ragged.
-  auto MergeRaggedMinibatches = [&](size_t d) {
-    // Loop over minibatches
+  std::vector<std::vector<size_t>> ragged_offsets(config.ragged.size());
+  for (size_t d = 0; d < config.ragged.size(); ++d) {
     size_t total_num_features = 0;
     size_t max_num_features = 0;
     CountSparseFeatures(ragged_buffers, d, &total_num_features,
@@ -1289,43 +1327,16 @@ Status FastParseExample(const Config& config,
     TensorShape values_shape;
     values_shape.AddDim(total_num_features);
     result->ragged_values.emplace_back(config.ragged[d].dtype, values_shape);
-    Tensor* values = &result->ragged_values.back();
-
-    size_t values_offset = 0;
-    size_t splits_offset = 0;
-    for (size_t i = 0; i < ragged_buffers.size(); ++i) {
-      SparseBuffer& buffer = ragged_buffers[i][d];
-      if (buffer.example_end_indices.empty()) continue;
-
-      // Update row_splits.  row_splits are formed by concatenating the example
-      // end_indices (adjusting each to start after the previous one ends).
-      if (config.ragged[d].splits_dtype == DT_INT64) {
-        int64* row_splits_out = &row_splits->flat<int64>()(splits_offset);
-        int64 start = *row_splits_out;
-        for (size_t example_end_index : buffer.example_end_indices) {
-          *++row_splits_out = start + example_end_index;
-        }
-      } else {
-        int32* row_splits_out = &row_splits->flat<int32>()(splits_offset);
-        int32 start = *row_splits_out;
-        for (size_t example_end_index : buffer.example_end_indices) {
-          *++row_splits_out = start + example_end_index;
-        }
-      }
 
-      CopySparseBufferToTensor(config.ragged[d].dtype, values_offset, &buffer,
-                               values);
-      values_offset += buffer.example_end_indices.back();
-      splits_offset += buffer.example_end_indices.size();
-    }
-  };
+    ragged_offsets[d] = MinibatchValueOffsets(ragged_buffers, d);
+  }
 
-  // Merge SparseBuffers from all minibatches for every config.dense having
-  // variable_length.
-  auto MergeDenseVarLenMinibatches = [&](size_t d) {
-    if (!config.dense[d].variable_length) return;
+  // Number of output elements per example of every variable-length dense
+  // feature, i.e. max_num_elements * data_stride_size.
+  std::vector<size_t> varlen_elements_per_example(config.dense.size(), 0);
+  for (size_t d = 0; d < config.dense.size(); ++d) {
+    if (!config.dense[d].variable_length) continue;
 
-    // Loop over minibatches
     size_t max_num_features = 0;
     for (auto& dense_values_tmp : varlen_dense_buffers) {
       std::vector<size_t>& end_indices =
@@ -1347,47 +1358,100 @@ Status FastParseExample(const Config& config,
     for (int i = 1; i < config.dense[d].shape.dims(); ++i) {
       values_shape.AddDim(config.dense[d].shape.dim_size(i));
     }
-    Tensor values(config.dense[d].dtype, values_shape);
-    result->dense_values[d] = values;
-    const size_t num_elements = values.NumElements();
-
-    // Nothing to write, exit early.
-    if (num_elements == 0) return;
+    result->dense_values[d] = Tensor(config.dense[d].dtype, values_shape);
+    const size_t num_elements = result->dense_values[d].NumElements();
+    if (num_elements > 0) {
+      varlen_elements_per_example[d] = num_elements / batch_size;
+    }
+  }
 
-    const size_t num_elements_per_minibatch = num_elements / batch_size;
+  auto MergeMiniBatch = [&](size_t minibatch) {
+    const size_t first_example = first_example_of_minibatch(minibatch);
 
-    switch (config.dense[d].dtype) {
-      case DT_INT64: {
-        FillAndCopyVarLen<int64>(d, num_elements, num_elements_per_minibatch,
-                                 config, varlen_dense_buffers, &values);
-        break;
-      }
-      case DT_FLOAT: {
-        FillAndCopyVarLen<float>(d, num_elements, num_elements_per_minibatch,
-                                 config, varlen_dense_buffers, &values);
-        break;
+    for (size_t d = 0; d < config.dense.size(); ++d) {
+      const size_t num_elements_per_example = varlen_elements_per_example[d];
+      // Fixed length, or nothing to write.
+      if (num_elements_per_example == 0) continue;
+
+      const SparseBuffer& buffer = varlen_dense_buffers[minibatch][d];
+      Tensor* values = &result->dense_values[d];
+      const size_t offset = first_example * num_elements_per_example;
+      switch (config.dense[d].dtype) {
+        case DT_INT64: {
+          FillAndCopyVarLen<int64>(d, num_elements_per_example, config, buffer,
+                                   values->flat<int64>().data() + offset);
+          break;
+        }
+        case DT_FLOAT: {
+          FillAndCopyVarLen<float>(d, num_elements_per_example, config, buffer,
+                                   values->flat<float>().data() + offset);
+          break;
+        }
+        case DT_STRING: {
+          FillAndCopyVarLen<tstring>(d, num_elements_per_example, config,
+                                     buffer,
+                                     values->flat<tstring>().data() + offset);
+          break;
+        }
+        default:
+          ReportUnexpectedDataType(config.dense[d].dtype);
       }
-      case DT_STRING: {
-        FillAndCopyVarLen<tstring>(d, num_elements, num_elements_per_minibatch,
-                                   config, varlen_dense_buffers, &values);
-        break;
+    }
+
+    for (size_t d = 0; d < config.sparse.size(); ++d) {
+      SparseBuffer& buffer = sparse_buffers[minibatch][d];
+      const size_t offset = sparse_offsets[d][minibatch];
+
+      // Update indices.
+      int64* ix_p = result->sparse_indices[d].flat<int64>().data() + 2 * offset;
+      size_t delta = 0;
+      size_t example_index = first_example;
+      for (size_t example_end_index : buffer.example_end_indices) {
+        size_t feature_index = 0;
+        for (; delta < example_end_index; ++delta) {
+          // Column 0: example index
+          *ix_p = example_index;
+          // Column 1: the feature index buffer example
+          *(ix_p + 1) = feature_index;
+          ix_p += 2;
+          ++feature_index;
+        }
+        ++example_index;
       }
-      default:
-        ReportUnexpectedDataType(config.dense[d].dtype);
+
+      CopySparseBufferToTensor(config.sparse[d].dtype, offset, &buffer,
+                               &result->sparse_values[d]);
     }
-  };
 
-  for (size_t d = 0; d < config.dense.size(); ++d) {
-    MergeDenseVarLenMinibatches(d);
-  }
+    for (size_t d = 0; d < config.ragged.size(); ++d) {
+      SparseBuffer& buffer = ragged_buffers[minibatch][d];
+      if (buffer.example_end_indices.empty()) continue;
+      const size_t offset = ragged_offsets[d][minibatch];
 
-  for (size_t d = 0; d < config.sparse.size(); ++d) {
-    MergeSparseMinibatches(d);
-  }
+      // Update row_splits.  row_splits are formed by concatenating the example
+      // end_indices (adjusting each to start after the previous minibatch
+      // ends).
+      Tensor* row_splits = &result->ragged_splits[d];
+      if (config.ragged[d].splits_dtype == DT_INT64) {
+        int64* row_splits_out =
+            row_splits->flat<int64>().data() + first_example;
+        for (size_t example_end_index : buffer.example_end_indices) {
+          *++row_splits_out = offset + example_end_index;
+        }
+      } else {
+        int32* row_splits_out =
+            row_splits->flat<int32>().data() + first_example;
+        for (size_t example_end_index : buffer.example_end_indices) {
+          *++row_splits_out = offset + example_end_index;
+        }
+      }
 
-  for (size_t d = 0; d < config.ragged.size(); ++d) {
-    MergeRaggedMinibatches(d);
-  }
+      CopySparseBufferToTensor(config.ragged[d].dtype, offset, &buffer,
+                               &result->ragged_values[d]);
+    }
+  };
+
+  ParallelFor(MergeMiniBatch, num_minibatches, thread_pool);
 
   return Status::OK();
 }
@@ -19,8 +19,11 @@ limitations under the License.
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -423,6 +426,143 @@ TEST(TestFastParseExample, Empty) {
   EXPECT_TRUE(status.ok()) << status;
 }
 
+// Uses enough examples to split the batch into several minibatches, which are
+// merged into the outputs in parallel.
+TEST(TestFastParseExample, ManyMinibatches) {
+  constexpr int kNumExamples = 100;
+  std::vector<tstring> serialized;
+  for (int i = 0; i < kNumExamples; ++i) {
+    Example example;
+    auto* features = example.mutable_features()->mutable_feature();
+    auto* varlen = (*features)["varlen"].mutable_int64_list();
+    for (int j = 0; j < i % 4; ++j) varlen->add_value(i);
+    auto* sparse = (*features)["sparse"].mutable_float_list();
+    for (int j = 0; j < i % 3; ++j) sparse->add_value(j);
+    auto* ragged = (*features)["ragged"].mutable_bytes_list();
+    for (int j = 0; j < i % 5; ++j) ragged->add_value(strings::StrCat(i));
+    serialized.push_back(Serialize(example));
+  }
+
+  FastParseExampleConfig config;
+  Tensor default_value(DT_INT64, TensorShape({}));
+  default_value.scalar<int64>()() = -1;
+  config.dense.push_back({"varlen", DT_INT64, PartialTensorShape({-1}),
+                          default_value, /*variable_length=*/true,
+                          /*elements_per_stride=*/1});
+  config.sparse.push_back({"sparse", DT_FLOAT});
+  config.ragged.push_back({"ragged", DT_STRING, DT_INT64});
+
+  thread::ThreadPool thread_pool(Env::Default(), "test", 4);
+  Result result;
+  TF_ASSERT_OK(FastParseExample(config, serialized, {}, &thread_pool,
+                                &result));
+
+  const Tensor& varlen = result.dense_values[0];
+  ASSERT_EQ(TensorShape({kNumExamples, 3}), varlen.shape());
+  auto varlen_t = varlen.matrix<int64>();
+  int64 num_sparse = 0;
+  for (int i = 0; i < kNumExamples; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      EXPECT_EQ(j < i % 4 ? i : -1, varlen_t(i, j));
+    }
+    num_sparse += i % 3;
+  }
+
+  ASSERT_EQ(num_sparse, result.sparse_values[0].NumElements());
+  auto indices_t = result.sparse_indices[0].matrix<int64>();
+  auto sparse_t = result.sparse_values[0].vec<float>();
+  int64 k = 0;
+  for (int i = 0; i < kNumExamples; ++i) {
+    for (int j = 0; j < i % 3; ++j, ++k) {
+      EXPECT_EQ(i, indices_t(k, 0));
+      EXPECT_EQ(j, indices_t(k, 1));
+      EXPECT_EQ(static_cast<float>(j), sparse_t(k));
+    }
+  }
+  EXPECT_EQ(kNumExamples, result.sparse_shapes[0].vec<int64>()(0));
+  EXPECT_EQ(2, result.sparse_shapes[0].vec<int64>()(1));
+
+  auto splits_t = result.ragged_splits[0].vec<int64>();
+  auto ragged_t = result.ragged_values[0].vec<tstring>();
+  ASSERT_EQ(kNumExamples + 1, splits_t.size());
+  EXPECT_EQ(0, splits_t(0));
+  for (int i = 0; i < kNumExamples; ++i) {
+    ASSERT_EQ(i % 5, splits_t(i + 1) - splits_t(i));
+    for (int64 v = splits_t(i); v < splits_t(i + 1); ++v) {
+      EXPECT_EQ(strings::StrCat(i), ragged_t(v));
+    }
+  }
+}
+
+TEST(TestFastParseExample, PackedInt64) {
+  // Covers varints of every length, from 1 to 10 bytes.
+  std::vector<int64> values = {0, 1, 127, 128, 300, -1, -300};
+  for (int shift = 7; shift < 64; shift += 7) {
+    values.push_back(int64{1} << shift);
+    values.push_back((int64{1} << shift) - 1);
+  }
+  Example example;
+  auto* list = (*example.mutable_features()->mutable_feature())["ints"]
+                   .mutable_int64_list();
+  for (int64 value : values) list->add_value(value);
+  std::vector<tstring> serialized = {Serialize(example)};
+
+  FastParseExampleConfig config;
+  config.sparse.push_back({"ints", DT_INT64});
+  Result result;
+  TF_ASSERT_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+  auto values_t = result.sparse_values[0].vec<int64>();
+  ASSERT_EQ(values.size(), values_t.size());
+  for (int i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(values[i], values_t(i));
+  }
+}
+
+// Returns `batch_size` serialized Examples holding a single feature of
+// `num_values` packed int64 or float values.
+std::vector<tstring> MakePackedExamples(int batch_size, int num_values,
+                                        DataType dtype) {
+  random::PhiloxRandom philox(1337);
+  random::SimplePhilox rng(&philox);
+  Example example;
+  Feature& feature = (*example.mutable_features()->mutable_feature())["x"];
+  for (int i = 0; i < num_values; ++i) {
+    if (dtype == DT_INT64) {
+      feature.mutable_int64_list()->add_value(rng.Rand64() >> rng.Uniform(64));
+    } else {
+      feature.mutable_float_list()->add_value(rng.RandFloat());
+    }
+  }
+  return std::vector<tstring>(batch_size, Serialize(example));
+}
+
+static void BM_ParsePacked(int iters, DataType dtype, int num_values) {
+  testing::StopTiming();
+  constexpr int kBatchSize = 128;
+  std::vector<tstring> serialized =
+      MakePackedExamples(kBatchSize, num_values, dtype);
+  FastParseExampleConfig config;
+  config.dense.push_back({"x", dtype, PartialTensorShape({num_values}),
+                          Tensor(), /*variable_length=*/false,
+                          /*elements_per_stride=*/size_t(num_values)});
+  testing::ItemsProcessed(static_cast<int64>(iters) * kBatchSize * num_values);
+  testing::StartTiming();
+  while (iters--) {
+    Result result;
+    TF_CHECK_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+  }
+}
+
+static void BM_ParsePackedInt64(int iters, int num_values) {
+  BM_ParsePacked(iters, DT_INT64, num_values);
+}
+BENCHMARK(BM_ParsePackedInt64)->Arg(10)->Arg(1000)->Arg(10000);
+
+static void BM_ParsePackedFloat(int iters, int num_values) {
+  BM_ParsePacked(iters, DT_FLOAT, num_values);
+}
+BENCHMARK(BM_ParsePackedFloat)->Arg(10)->Arg(1000)->Arg(10000);
+
 }  // namespace
 }  // namespace example
 }  // namespace tensorflow
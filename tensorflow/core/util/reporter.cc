@@ -15,12 +15,83 @@ limitations under the License.
 
 #include "tensorflow/core/util/reporter.h"
 
+#include <cmath>
+#include <map>
+
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 
+namespace {
+
+void AppendJsonString(StringPiece s, string* out) {
+  out->push_back('"');
+  for (const char c : s) {
+    switch (c) {
+      case '"':
+        out->append("\\\"");
+        break;
+      case '\\':
+        out->append("\\\\");
+        break;
+      case '\n':
+        out->append("\\n");
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          strings::Appendf(out, "\\u%04x", static_cast<int>(c));
+        } else {
+          out->push_back(c);
+        }
+    }
+  }
+  out->push_back('"');
+}
+
+void AppendJsonNumber(double value, string* out) {
+  if (std::isfinite(value)) {
+    strings::Appendf(out, "%.17g", value);
+  } else {
+    out->append("null");
+  }
+}
+
+}  // namespace
+
+string BenchmarkEntryToJson(const BenchmarkEntry& entry) {
+  string json = "{\"name\":";
+  AppendJsonString(entry.name(), &json);
+  strings::StrAppend(&json, ",\"iters\":", entry.iters(), ",\"cpu_time\":");
+  AppendJsonNumber(entry.cpu_time(), &json);
+  json.append(",\"wall_time\":");
+  AppendJsonNumber(entry.wall_time(), &json);
+  json.append(",\"throughput\":");
+  AppendJsonNumber(entry.throughput(), &json);
+  json.append(",\"extras\":{");
+  // Sorts the extras for a stable output.
+  std::map<string, const EntryValue*> extras;
+  for (const auto& extra : entry.extras()) {
+    extras.emplace(extra.first, &extra.second);
+  }
+  bool first = true;
+  for (const auto& extra : extras) {
+    if (!first) json.push_back(',');
+    first = false;
+    AppendJsonString(extra.first, &json);
+    json.push_back(':');
+    if (extra.second->kind_case() == EntryValue::kStringValue) {
+      AppendJsonString(extra.second->string_value(), &json);
+    } else {
+      AppendJsonNumber(extra.second->double_value(), &json);
+    }
+  }
+  json.append("}}");
+  return json;
+}
+
 TestReportFile::TestReportFile(const string& fname, const string& test_name)
     : closed_(true), fname_(fname), test_name_(test_name) {}
 
@@ -53,17 +124,23 @@ Status TestReportFile::Initialize() {
   return Status::OK();
 }
 
-TestReporter::TestReporter(const string& fname, const string& test_name)
-    : report_file_(fname, test_name) {
+TestReporter::TestReporter(const string& fname, const string& test_name,
+                           Format format)
+    : format_(format), report_file_(fname, test_name) {
   benchmark_entry_.set_name(test_name);
 }
 
 Status TestReporter::Close() {
   if (report_file_.IsClosed()) return Status::OK();
 
-  BenchmarkEntries entries;
-  *entries.add_entry() = benchmark_entry_;
-  TF_RETURN_IF_ERROR(report_file_.Append(entries.SerializeAsString()));
+  if (format_ == Format::kJson) {
+    TF_RETURN_IF_ERROR(report_file_.Append(
+        strings::StrCat(BenchmarkEntryToJson(benchmark_entry_), "\n")));
+  } else {
+    BenchmarkEntries entries;
+    *entries.add_entry() = benchmark_entry_;
+    TF_RETURN_IF_ERROR(report_file_.Append(entries.SerializeAsString()));
+  }
   benchmark_entry_.Clear();
 
   return report_file_.Close();
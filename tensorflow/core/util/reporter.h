@@ -58,7 +58,9 @@ class TestReportFile {
 };
 
 // The TestReporter writes test / benchmark output to binary Protobuf files when
-// the environment variable "TEST_REPORT_FILE_PREFIX" is defined.
+// the environment variable "TEST_REPORT_FILE_PREFIX" is defined. If the
+// environment variable "TEST_REPORT_FILE_FORMAT" is "json", the entries are
+// written as JSON objects, one per line, instead.
 //
 // If this environment variable is not defined, no logging is performed.
 //
@@ -80,13 +82,18 @@ class TestReportFile {
 class TestReporter {
  public:
   static constexpr const char* kTestReporterEnv = "TEST_REPORT_FILE_PREFIX";
+  static constexpr const char* kTestReporterFormatEnv =
+      "TEST_REPORT_FILE_FORMAT";
+
+  enum class Format { kProto, kJson };
 
   // Create a TestReporter with the test name 'test_name'.
   explicit TestReporter(const string& test_name)
-      : TestReporter(GetLogEnv(), test_name) {}
+      : TestReporter(GetLogEnv(), test_name, GetFormatEnv()) {}
 
   // Provide a prefix filename, mostly used for testing this class.
-  TestReporter(const string& fname, const string& test_name);
+  TestReporter(const string& fname, const string& test_name,
+               Format format = Format::kProto);
 
   // Initialize the TestReporter.  If the reporting env flag is set,
   // try to create the reporting file.  Fails if the file already exists.
@@ -119,11 +126,22 @@ class TestReporter {
     const char* fname_ptr = getenv(kTestReporterEnv);
     return (fname_ptr != nullptr) ? fname_ptr : "";
   }
+  static Format GetFormatEnv() {
+    const char* format_ptr = getenv(kTestReporterFormatEnv);
+    return (format_ptr != nullptr && string(format_ptr) == "json")
+               ? Format::kJson
+               : Format::kProto;
+  }
+  const Format format_;
   TestReportFile report_file_;
   BenchmarkEntry benchmark_entry_;
   TF_DISALLOW_COPY_AND_ASSIGN(TestReporter);
 };
 
+// Returns 'entry' as a single-line JSON object, with the fields named as in
+// the proto. Non-finite numbers are written as null.
+string BenchmarkEntryToJson(const BenchmarkEntry& entry);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_UTIL_REPORTER_H_
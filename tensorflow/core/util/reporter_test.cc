@@ -15,6 +15,7 @@ limitations under the License.
 
 #define _XOPEN_SOURCE  // for setenv, unsetenv
 #include <cstdlib>
+#include <limits>
 
 #include "tensorflow/core/util/reporter.h"
 
@@ -138,5 +139,35 @@ TEST(TestReporter, SetProperties) {
   EXPECT_EQ(4.0, extras.at("double_prop").double_value());
 }
 
+TEST(TestReporter, JsonFormat) {
+  string fname =
+      strings::StrCat(testing::TmpDir(), "/test_reporter_benchmarks_json_");
+  TestReporter test_reporter(fname, "b3/4", TestReporter::Format::kJson);
+  TF_EXPECT_OK(test_reporter.Initialize());
+  TF_EXPECT_OK(test_reporter.Benchmark(2, 1.0, 3.0, 4.5));
+  TF_EXPECT_OK(test_reporter.SetProperty("label", "a \"b\""));
+  TF_EXPECT_OK(test_reporter.SetProperty("bytes_per_second", 8.0));
+  TF_EXPECT_OK(test_reporter.Close());
+
+  string read;
+  TF_EXPECT_OK(
+      ReadFileToString(Env::Default(), strings::StrCat(fname, "b3__4"), &read));
+  EXPECT_EQ(read,
+            "{\"name\":\"b3/4\",\"iters\":2,\"cpu_time\":0.5,"
+            "\"wall_time\":1.5,\"throughput\":4.5,"
+            "\"extras\":{\"bytes_per_second\":8,\"label\":\"a \\\"b\\\"\"}}\n");
+}
+
+TEST(TestReporter, JsonWritesNonFiniteNumbersAsNull) {
+  BenchmarkEntry entry;
+  entry.set_name("b4");
+  entry.set_throughput(std::numeric_limits<double>::quiet_NaN());
+  (*entry.mutable_extras())["inf"].set_double_value(
+      std::numeric_limits<double>::infinity());
+  EXPECT_EQ(BenchmarkEntryToJson(entry),
+            "{\"name\":\"b4\",\"iters\":0,\"cpu_time\":0,"
+            "\"wall_time\":0,\"throughput\":null,\"extras\":{\"inf\":null}}");
+}
+
 }  // namespace
 }  // namespace tensorflow
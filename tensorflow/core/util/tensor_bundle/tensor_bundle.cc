@@ -19,8 +19,10 @@ limitations under the License.
 #include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <set>
 #include <utility>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -50,7 +52,10 @@ namespace tensorflow {
 // Versioning of the tensor bundle format.
 const int kTensorBundleMinProducer = 0;
 const int kTensorBundleMinConsumer = 0;
-const int kTensorBundleVersion = 1;
+const int kTensorBundleVersion = 2;
+
+// The consumer version needed to read delta bundles.
+static const int kTensorBundleMinDeltaConsumer = 2;
 
 // Size of our input buffer for streaming reads
 static const int kBufferSize = 1024 * 1024;
@@ -499,6 +504,64 @@ Status BundleWriter::AddSlice(StringPiece full_tensor_key,
   return status_;
 }
 
+Status BundleWriter::AddRows(StringPiece key, const Tensor& val,
+                             gtl::ArraySlice<int64> rows) {
+  if (!status_.ok()) return status_;
+  CHECK_NE(key, kHeaderEntryKey);
+  if (options_.base_prefix.empty()) {
+    status_ = errors::FailedPrecondition("Adding rows of ", key,
+                                         " to a bundle without a base bundle");
+    return status_;
+  }
+  if (!DataTypeCanUseMemcpy(val.dtype()) || val.dims() == 0) {
+    status_ = errors::InvalidArgument(
+        "Cannot add rows of ", key, ", a ", DataTypeString(val.dtype()),
+        " tensor of shape ", val.shape().DebugString());
+    return status_;
+  }
+  const int64 num_rows = val.dim_size(0);
+  for (const int64 row : rows) {
+    if (row < 0 || row >= num_rows) {
+      status_ = errors::InvalidArgument("Row ", row, " of ", key,
+                                        " is not in [0, ", num_rows, ")");
+      return status_;
+    }
+  }
+  if (rows.empty()) return status_;
+  const string key_string(key);
+  if (entries_.find(key_string) != entries_.end()) {
+    status_ = errors::InvalidArgument("Adding duplicate key: ", key);
+    return status_;
+  }
+
+  BundleEntryProto* entry = &entries_[key_string];
+  entry->set_dtype(val.dtype());
+  val.shape().AsProto(entry->mutable_shape());
+  entry->set_shard_id(0);
+  entry->set_offset(size_);
+  entry->set_num_delta_rows(rows.size());
+
+  // Appends the row indices, then the rows.
+  const size_t row_bytes = val.TotalBytes() / num_rows;
+  const char* data = GetBackingBuffer(val);
+  out_->clear_crc32c();
+  status_ = out_->Append(StringPiece(reinterpret_cast<const char*>(rows.data()),
+                                     rows.size() * sizeof(int64)));
+  for (const int64 row : rows) {
+    if (!status_.ok()) break;
+    status_ = out_->Append(StringPiece(data + row * row_bytes, row_bytes));
+  }
+
+  if (status_.ok()) {
+    const size_t data_bytes_written = rows.size() * (sizeof(int64) + row_bytes);
+    entry->set_size(data_bytes_written);
+    entry->set_crc32c(crc32c::Mask(out_->crc32c()));
+    size_ += data_bytes_written;
+    status_ = PadAlignment(out_.get(), options_.data_alignment, &size_);
+  }
+  return status_;
+}
+
 // TODO(zongheng): on metadata write failure or !status_.ok(), consider removing
 // the orphaned data file.
 Status BundleWriter::Finish() {
@@ -531,6 +594,10 @@ Status BundleWriter::Finish() {
     VersionDef* version = header.mutable_version();
     version->set_producer(kTensorBundleVersion);
     version->set_min_consumer(kTensorBundleMinConsumer);
+    if (!options_.base_prefix.empty()) {
+      header.set_base_prefix(options_.base_prefix);
+      version->set_min_consumer(kTensorBundleMinDeltaConsumer);
+    }
 
     builder.Add(kHeaderEntryKey, header.SerializeAsString());
 
@@ -566,6 +633,8 @@ struct MergeState {
   bool seen_first_bundle = false;
   BundleHeaderProto_Endianness endianness;
   VersionDef version;
+  // Likewise for the "base_prefix" of delta bundles.
+  string base_prefix;
 
   // Tensor key -> BundleEntryProto.
   std::map<string, BundleEntryProto> entries;
@@ -607,6 +676,7 @@ static Status MergeOneBundle(Env* env, StringPiece prefix,
       merge_state->seen_first_bundle = true;
       merge_state->endianness = header.endianness();
       merge_state->version = header.version();
+      merge_state->base_prefix = header.base_prefix();
     } else {
       // Validates "endianness".
       if (merge_state->endianness != header.endianness()) {
@@ -622,6 +692,13 @@ static Status MergeOneBundle(Env* env, StringPiece prefix,
             "Merging bundles with different format versions: merged ",
             merge_version, " vs. curr ", curr_version);
       }
+      // Validates "base_prefix".
+      if (merge_state->base_prefix != header.base_prefix()) {
+        return errors::InvalidArgument(
+            "Merging bundles with different base bundles: merged \"",
+            merge_state->base_prefix, "\" vs. curr \"", header.base_prefix(),
+            "\"");
+      }
     }
     num_shards = header.num_shards();
     iter->Next();
@@ -705,6 +782,7 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
     header.set_num_shards(merge.num_shards);
     header.set_endianness(merge.endianness);
     *header.mutable_version() = merge.version;
+    header.set_base_prefix(merge.base_prefix);
     builder.Add(kHeaderEntryKey, header.SerializeAsString());
     // All others.
     for (const auto& p : merge.entries) {
@@ -723,6 +801,53 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
   return status;
 }
 
+Status AlignBundle(Env* env, StringPiece prefix, StringPiece output_prefix,
+                   int data_alignment) {
+  BundleReader reader(env, prefix);
+  TF_RETURN_IF_ERROR(reader.status());
+  // The keys of the tensors, including the ones that a delta bundle reads from
+  // its base bundles.  The keys of slices are skipped, as AddSlice() writes
+  // them along with their full tensors.
+  std::set<string> keys;
+  for (BundleReader* r = &reader; r != nullptr; r = r->base_.get()) {
+    for (r->Seek(kHeaderEntryKey), r->Next(); r->Valid(); r->Next()) {
+      string name;
+      TensorSlice slice;
+      if (checkpoint::DecodeTensorNameSlice(string(r->key()), &name, &slice)
+              .ok()) {
+        continue;
+      }
+      keys.insert(string(r->key()));
+    }
+  }
+
+  BundleWriter::Options options;
+  options.data_alignment = data_alignment;
+  BundleWriter writer(env, output_prefix, options);
+  TF_RETURN_IF_ERROR(writer.status());
+  for (const string& key : keys) {
+    DataType dtype;
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(reader.LookupDtypeAndShape(key, &dtype, &shape));
+    std::vector<TensorSlice> slices;
+    TF_RETURN_IF_ERROR(reader.LookupTensorSlices(key, &slices));
+    if (slices.empty()) {
+      Tensor val(dtype, shape);
+      TF_RETURN_IF_ERROR(reader.Lookup(key, &val));
+      TF_RETURN_IF_ERROR(writer.Add(key, val));
+      continue;
+    }
+    for (const TensorSlice& slice : slices) {
+      TensorShape slice_shape;
+      TF_RETURN_IF_ERROR(slice.SliceTensorShape(shape, &slice_shape));
+      Tensor val(dtype, slice_shape);
+      TF_RETURN_IF_ERROR(reader.LookupSlice(key, slice, &val));
+      TF_RETURN_IF_ERROR(writer.AddSlice(key, shape, slice, val));
+    }
+  }
+  return writer.Finish();
+}
+
 // Interface for reading a tensor bundle.
 
 BundleReader::BundleReader(Env* env, StringPiece prefix)
@@ -767,6 +892,21 @@ BundleReader::BundleReader(Env* env, StringPiece prefix)
   }
   status_ = CheckVersions(header.version(), kTensorBundleVersion,
                           kTensorBundleMinProducer, "Checkpoint", "checkpoint");
+  if (!status_.ok() || header.base_prefix().empty()) return;
+
+  // Opens the base bundle of a delta bundle.
+  string base_prefix = header.base_prefix();
+  StringPiece scheme, host, path;
+  io::ParseURI(base_prefix, &scheme, &host, &path);
+  if (scheme.empty() && !io::IsAbsolutePath(base_prefix)) {
+    base_prefix = io::JoinPath(io::Dirname(prefix_), base_prefix);
+  }
+  if (base_prefix == prefix_) {
+    status_ = errors::DataLoss("Bundle ", prefix_, " is its own base bundle");
+    return;
+  }
+  base_.reset(new BundleReader(env_, base_prefix));
+  status_ = base_->status();
 }
 
 BundleReader::~BundleReader() {
@@ -804,7 +944,24 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
   return Status::OK();
 }
 
+Status BundleReader::GetDataFile(int32 shard_id, io::InputBuffer** file) {
+  io::InputBuffer*& buffered_file = data_[shard_id];
+  if (buffered_file == nullptr) {
+    std::unique_ptr<RandomAccessFile> f;
+    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
+        DataFilename(prefix_, shard_id, num_shards_), &f));
+    // The InputBuffer and RandomAccessFile objects are both released in dtor.
+    buffered_file = new io::InputBuffer(f.release(), kBufferSize);
+  }
+  *file = buffered_file;
+  return Status::OK();
+}
+
 Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
+  if (entry.num_delta_rows() != 0) {
+    // Callers position the iterator at the entry they read.
+    return GetDeltaValue(string(key()), entry, val);
+  }
   Tensor* ret = val;
   const TensorShape stored_shape(TensorShape(entry.shape()));
   if (val->NumElements() == 0) {
@@ -833,17 +990,8 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     }
   }
 
-  // Open the data file if it has not been opened.
-  io::InputBuffer* buffered_file = data_[entry.shard_id()];
-  if (buffered_file == nullptr) {
-    std::unique_ptr<RandomAccessFile> file = nullptr;
-    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
-        DataFilename(prefix_, entry.shard_id(), num_shards_), &file));
-    buffered_file = new io::InputBuffer(file.release(), kBufferSize);
-    // The InputBuffer and RandomAccessFile objects are both released in dtor.
-    data_[entry.shard_id()] = buffered_file;
-  }
-  CHECK(buffered_file != nullptr);
+  io::InputBuffer* buffered_file;
+  TF_RETURN_IF_ERROR(GetDataFile(entry.shard_id(), &buffered_file));
 
   TF_RETURN_IF_ERROR(buffered_file->Seek(entry.offset()));
   uint32 actual_crc32c = 0;
@@ -899,8 +1047,157 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   return Status::OK();
 }
 
+Status BundleReader::GetDeltaValue(const string& key,
+                                   const BundleEntryProto& entry, Tensor* val) {
+  if (base_ == nullptr) {
+    return errors::DataLoss("Delta entry ", key, " in bundle ", prefix_,
+                            ", which has no base bundle");
+  }
+  const TensorShape shape(entry.shape());
+  const int64 num_rows = entry.num_delta_rows();
+  if (!DataTypeCanUseMemcpy(entry.dtype()) || shape.dims() == 0 ||
+      num_rows < 0 || num_rows > shape.dim_size(0)) {
+    return errors::DataLoss("Invalid delta entry ", key, " in bundle ",
+                            prefix_);
+  }
+  const int64 row_bytes = shape.num_elements() / shape.dim_size(0) *
+                          DataTypeSize(entry.dtype());
+  const int64 expected_size = num_rows * (sizeof(int64) + row_bytes);
+  if (entry.size() != expected_size) {
+    return errors::DataLoss("Invalid size in delta entry: key ", key,
+                            "; stored size ", entry.size(), "; expected size ",
+                            expected_size);
+  }
+  if (need_to_swap_bytes_) {
+    return errors::Unimplemented(
+        "TensorBundle at ", prefix_,
+        " is of a different endianness than this machine's hardware, and "
+        "byte-swapping of delta entries is not implemented.");
+  }
+
+  // Reads the tensor from the base bundle, which may itself be a delta bundle.
+  DataType base_dtype;
+  TensorShape base_shape;
+  TF_RETURN_IF_ERROR(base_->LookupDtypeAndShape(key, &base_dtype, &base_shape));
+  if (base_dtype != entry.dtype() || base_shape != shape) {
+    return errors::DataLoss(
+        "Delta entry ", key, " in bundle ", prefix_, " is a ",
+        DataTypeString(entry.dtype()), " tensor of shape ", shape.DebugString(),
+        ", but its base bundle holds a ", DataTypeString(base_dtype),
+        " tensor of shape ", base_shape.DebugString());
+  }
+  if (val->NumElements() == 0) {
+    *val = Tensor(entry.dtype(), shape);
+  }
+  TF_RETURN_IF_ERROR(base_->Lookup(key, val));
+
+  // Overwrites the rows stored in this bundle.
+  io::InputBuffer* buffered_file;
+  TF_RETURN_IF_ERROR(GetDataFile(entry.shard_id(), &buffered_file));
+  std::unique_ptr<char[]> scratch(new char[entry.size()]);
+  StringPiece data;
+  TF_RETURN_IF_ERROR(buffered_file->file()->Read(entry.offset(), entry.size(),
+                                                 &data, scratch.get()));
+  if (data.size() != static_cast<size_t>(entry.size())) {
+    return errors::DataLoss("Truncated delta entry ", key, " in bundle ",
+                            prefix_);
+  }
+  const uint32 actual_crc32c = crc32c::Value(data.data(), data.size());
+  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+    return errors::DataLoss(
+        "Checksum does not match: stored ",
+        strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+        " vs. calculated on the restored bytes ", actual_crc32c);
+  }
+  const char* rows = data.data() + num_rows * sizeof(int64);
+  char* backing_buffer = const_cast<char*>(val->tensor_data().data());
+  for (int64 i = 0; i < num_rows; ++i) {
+    int64 row;
+    std::memcpy(&row, data.data() + i * sizeof(int64), sizeof(int64));
+    if (row < 0 || row >= shape.dim_size(0)) {
+      return errors::DataLoss("Row ", row, " of delta entry ", key,
+                              " is not in [0, ", shape.dim_size(0), ")");
+    }
+    std::memcpy(backing_buffer + row * row_bytes, rows + i * row_bytes,
+                row_bytes);
+  }
+  return Status::OK();
+}
+
+namespace {
+// A TensorBuffer aliasing part of a memory-mapped bundle data file.  The
+// mapping is read-only, so the buffer reports that it does not own its
+// memory; this keeps kernels from forwarding it as a writable output.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("mmap");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+}  // namespace
+
+Status BundleReader::GetMappedValue(const BundleEntryProto& entry,
+                                    bool verify_checksum, Tensor* val,
+                                    bool* mapped) {
+  if (!entry.slices().empty() || entry.num_delta_rows() != 0 ||
+      need_to_swap_bytes_ || entry.size() == 0 ||
+      !DataTypeCanUseMemcpy(entry.dtype())) {
+    return Status::OK();
+  }
+  auto it = mapped_data_.find(entry.shard_id());
+  if (it == mapped_data_.end()) {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    Status s = env_->NewReadOnlyMemoryRegionFromFile(
+        DataFilename(prefix_, entry.shard_id(), num_shards_), &region);
+    if (!s.ok()) {
+      VLOG(1) << "Not memory-mapping bundle " << prefix_ << ": " << s;
+    }
+    it = mapped_data_.emplace(entry.shard_id(), std::move(region)).first;
+  }
+  const std::shared_ptr<ReadOnlyMemoryRegion>& region = it->second;
+  if (region == nullptr || entry.offset() < 0 ||
+      static_cast<uint64>(entry.offset() + entry.size()) > region->length()) {
+    return Status::OK();
+  }
+  const TensorShape shape(entry.shape());
+  const char* data = static_cast<const char*>(region->data()) + entry.offset();
+  if (reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0 ||
+      entry.size() != shape.num_elements() * DataTypeSize(entry.dtype())) {
+    return Status::OK();
+  }
+  if (verify_checksum) {
+    const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+    if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+      return errors::DataLoss(
+          "Checksum does not match: stored ",
+          strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+          " vs. calculated on the restored bytes ", actual_crc32c);
+    }
+  }
+  MappedTensorBuffer* buf = new MappedTensorBuffer(region, data, entry.size());
+  *val = Tensor(entry.dtype(), shape, buf);
+  buf->Unref();
+  *mapped = true;
+  return Status::OK();
+}
+
 Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   CHECK(val != nullptr);
+  if (InBase(key)) return base_->Lookup(key, val);
   BundleEntryProto entry;
   TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
 
@@ -931,8 +1228,31 @@ Status BundleReader::ReadCurrent(Tensor* val) {
   }
 }
 
+Status BundleReader::ReadCurrentMapped(Tensor* val) {
+  CHECK(val != nullptr);
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(ParseEntryProto(iter_->key(), iter_->value(), &entry));
+  if (!TensorShape::IsValid(entry.shape())) {
+    return errors::DataLoss("Invalid tensor shape: ", iter_->key(), " ",
+                            entry.shape().ShortDebugString());
+  }
+  bool mapped = false;
+  TF_RETURN_IF_ERROR(
+      GetMappedValue(entry, /*verify_checksum=*/true, val, &mapped));
+  return mapped ? Status::OK() : ReadCurrent(val);
+}
+
+Status BundleReader::LookupMapped(StringPiece key, Tensor* val, bool* mapped) {
+  CHECK(val != nullptr);
+  if (InBase(key)) return base_->LookupMapped(key, val, mapped);
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  return GetMappedValue(entry, /*verify_checksum=*/false, val, mapped);
+}
+
 Status BundleReader::LookupTensorSlices(StringPiece key,
                                         std::vector<TensorSlice>* slices) {
+  if (InBase(key)) return base_->LookupTensorSlices(key, slices);
   slices->clear();
   BundleEntryProto entry;
   TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
@@ -946,6 +1266,9 @@ Status BundleReader::LookupTensorSlices(StringPiece key,
 Status BundleReader::LookupSlice(StringPiece full_tensor_key,
                                  const TensorSlice& slice_spec, Tensor* val) {
   CHECK(val != nullptr);
+  if (InBase(full_tensor_key)) {
+    return base_->LookupSlice(full_tensor_key, slice_spec, val);
+  }
   BundleEntryProto entry;
   TF_RETURN_IF_ERROR(GetBundleEntryProto(full_tensor_key, &entry));
   return GetSliceValue(full_tensor_key, entry, slice_spec, val);
@@ -1066,13 +1389,18 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
   return Status::OK();
 }
 
-bool BundleReader::Contains(StringPiece key) {
+bool BundleReader::HasEntry(StringPiece key) {
   Seek(key);
   return Valid() && (this->key() == key);
 }
 
+bool BundleReader::Contains(StringPiece key) {
+  return HasEntry(key) || (base_ != nullptr && base_->Contains(key));
+}
+
 Status BundleReader::LookupDtypeAndShape(StringPiece key, DataType* dtype,
                                          TensorShape* shape) {
+  if (InBase(key)) return base_->LookupDtypeAndShape(key, dtype, shape);
   BundleEntryProto entry;
   TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
   *dtype = entry.dtype();
@@ -1085,6 +1413,18 @@ Status BundleReader::LookupTensorShape(StringPiece key, TensorShape* shape) {
   return LookupDtypeAndShape(key, &ignored, shape);
 }
 
+Status BundleReader::LookupDataShard(StringPiece key, int32* shard_id) {
+  if (InBase(key)) {
+    TF_RETURN_IF_ERROR(base_->LookupDataShard(key, shard_id));
+    *shard_id = -1;
+    return Status::OK();
+  }
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  *shard_id = entry.slices().empty() ? entry.shard_id() : -1;
+  return Status::OK();
+}
+
 string BundleReader::DebugString() {
   // Format used below emulates that of TensorSliceReader::DebugString().
   string shape_str;
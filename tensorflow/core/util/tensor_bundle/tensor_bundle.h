@@ -57,6 +57,11 @@ limitations under the License.
 //        "/fs/model/train/ckpt-step/tmp/worker1-step"},
 //       "/fs/model/train/ckpt-step/ckpt" /* merged prefix */);
 //
+// A delta bundle, written with BundleWriter::Options::base_prefix, only holds
+// the tensors, or the rows of tensors (see BundleWriter::AddRows()), that
+// changed since its base bundle was written.  BundleReader transparently reads
+// the rest from the base bundle, which may itself be a delta bundle.
+//
 
 #ifndef TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_TENSOR_BUNDLE_H_
 #define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_TENSOR_BUNDLE_H_
@@ -64,6 +69,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/tensor_bundle.pb.h"
 
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -91,6 +97,7 @@ class FileOutputBuffer;
 // History:
 // 0. Any tensor bundles produced before this field was added.
 // 1. Added this field (2016-09-14).
+// 2. Added delta bundles, which require consumer version 2 (2026-10-15).
 extern const int kTensorBundleMinProducer;
 extern const int kTensorBundleMinConsumer;
 extern const int kTensorBundleVersion;
@@ -112,6 +119,10 @@ class BundleWriter {
     // Alignment, in bytes, for tensor data.
     // Must be >= 1. The default size of 1 densely packs tensors.
     int data_alignment{1};
+    // If non-empty, writes a delta bundle against the bundle with this prefix,
+    // which is resolved relative to the directory of "prefix" unless it is an
+    // absolute path or a URI.
+    std::string base_prefix;
   };
   BundleWriter(Env* env, StringPiece prefix,
                const Options& options = Options());
@@ -140,6 +151,15 @@ class BundleWriter {
                   const TensorShape& full_tensor_shape,
                   const TensorSlice& slice_spec, const Tensor& slice_tensor);
 
+  // Delta bundles support: adds the given "rows" (indices in the first
+  // dimension) of the tensor "val" under key "key".  Its other rows are read
+  // from the base bundle, which must hold "key" with the same dtype and shape.
+  // If "rows" is empty, adds nothing, so that all of "key" is read from the
+  // base bundle.  "val" must have a fixed-size dtype and at least 1 dimension.
+  // REQUIRES: Options::base_prefix is non-empty.
+  Status AddRows(StringPiece key, const Tensor& val,
+                 gtl::ArraySlice<int64> rows);
+
   // Finishes the writer and flushes.
   Status Finish() TF_MUST_USE_RESULT;
 
@@ -175,10 +195,22 @@ class BundleWriter {
 Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
                     StringPiece merged_prefix);
 
+// Writes the tensors of the bundle with prefix "prefix" to a new, single-shard
+// bundle with prefix "output_prefix", whose tensor data is aligned to
+// "data_alignment" bytes.  Aligning existing checkpoints, e.g. to the page
+// size, lets BundleReader::LookupMapped() alias their tensors to the mapped
+// data file.  Partitioned tensors keep their slices, and a delta bundle is
+// written in full, without its base bundle.
+Status AlignBundle(Env* env, StringPiece prefix, StringPiece output_prefix,
+                   int data_alignment);
+
 // On construction, silently attempts to read the metadata associated with
 // "prefix".  If caller intends to call any function afterwards, "status()"
 // must be checked.
 // All threads accessing the same BundleReader must synchronize.
+//
+// The lookups of a delta bundle fall back to its base bundle, which is opened
+// on construction.  Iterating only visits the entries of the bundle itself.
 class BundleReader {
  public:
   BundleReader(Env* const env, StringPiece prefix);
@@ -204,6 +236,18 @@ class BundleReader {
   Status LookupTensorShape(StringPiece key,
                            TensorShape* shape) TF_MUST_USE_RESULT;
 
+  // Looks up the index of the data file holding the tensor keyed by "key", or
+  // -1 if it is a partitioned tensor, whose slices may be in several files, or
+  // if it is read from the base bundle of a delta bundle.
+  // Reads from different data files can proceed in parallel, through separate
+  // readers.
+  // REQUIRES: status().ok()
+  Status LookupDataShard(StringPiece key, int32* shard_id) TF_MUST_USE_RESULT;
+
+  // Returns the number of data files of the bundle.
+  // REQUIRES: status().ok()
+  int num_shards() const { return num_shards_; }
+
   // Looks up the tensor keyed by "key".  If "key" refers to a partitioned
   // tensor, attempts to look up the full contents using all stored slices.
   //
@@ -226,6 +270,29 @@ class BundleReader {
   // REQUIRES: status().ok() && Valid()
   Status ReadCurrent(Tensor* val) TF_MUST_USE_RESULT;
 
+  // Like ReadCurrent(), but if the tensor has a fixed-size type and its data
+  // is suitably aligned in a data file that can be memory-mapped, "*val"
+  // aliases the mapped file instead of holding a copy.  Such tensors do not
+  // own their memory, so kernels never update them in place.  Bundles
+  // written with BundleWriter::Options::data_alignment of at least
+  // EIGEN_MAX_ALIGN_BYTES can be read this way throughout.
+  //
+  // Validates the stored crc32c checksum against the mapped bytes.
+  // REQUIRES: status().ok() && Valid()
+  Status ReadCurrentMapped(Tensor* val) TF_MUST_USE_RESULT;
+
+  // Points "*val" at the mapped data of the tensor keyed by "key" and sets
+  // "*mapped" to true, under the same conditions as ReadCurrentMapped().
+  // Otherwise leaves both alone, and the caller falls back to Lookup().
+  //
+  // Unlike ReadCurrentMapped(), does not validate the checksum, which would
+  // read the whole tensor: pages of the data file are only read when the
+  // tensor is first accessed, so a large tensor costs no memory until then,
+  // and then only as much as the pages in use.
+  // REQUIRES: status().ok()
+  Status LookupMapped(StringPiece key, Tensor* val,
+                      bool* mapped) TF_MUST_USE_RESULT;
+
   // Looks up the slices of the tensor keyed by "key".  On OK, "slices"
   // is non-empty if and only if the tensor is a partitioned tensor.
   //
@@ -263,6 +330,17 @@ class BundleReader {
   string DebugString();
 
  private:
+  // Returns whether this bundle itself, rather than its base bundle, has an
+  // entry keyed by "key".  Calls Seek() internally.
+  bool HasEntry(StringPiece key);
+
+  // Returns whether lookups of "key" fall back to the base bundle.
+  bool InBase(StringPiece key) { return base_ != nullptr && !HasEntry(key); }
+
+  // Opens the data file "shard_id" if it has not been opened.
+  Status GetDataFile(int32 shard_id,
+                     io::InputBuffer** file) TF_MUST_USE_RESULT;
+
   // Seeks for "key" and reads the metadata proto.
   // On non-OK return, clears "entry" for the caller.
   // REQUIRES: status().ok()
@@ -274,6 +352,18 @@ class BundleReader {
   Status GetValue(const BundleEntryProto& entry,
                   Tensor* val) TF_MUST_USE_RESULT;
 
+  // Reads the delta entry "entry" keyed by "key": reads the tensor from the
+  // base bundle, then overwrites the rows stored in this bundle.
+  // REQUIRES: entry.num_delta_rows() > 0
+  Status GetDeltaValue(const string& key, const BundleEntryProto& entry,
+                       Tensor* val) TF_MUST_USE_RESULT;
+
+  // Points "*val" at the mapped data of the tensor described by "entry" and
+  // sets "*mapped" to true, or leaves both alone if that is not possible.
+  // Validates the checksum of the mapped bytes if "verify_checksum" is true.
+  Status GetMappedValue(const BundleEntryProto& entry, bool verify_checksum,
+                        Tensor* val, bool* mapped) TF_MUST_USE_RESULT;
+
   // Reads the slice described by "slice_spec".  The corresponding full tensor
   // has key "ful_tensor_key" and metadata proto "full_tensor_entry".
   // REQUIRES: full_tensor_entry.slices_size() > 0
@@ -291,6 +381,10 @@ class BundleReader {
   table::Iterator* iter_;
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
+  // Memory-mapped data files, or nullptr for those that cannot be mapped.
+  // Populated on-demand by ReadCurrentMapped() and LookupMapped().
+  std::unordered_map<int32, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
 
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
@@ -304,7 +398,12 @@ class BundleReader {
   // differs from that of the current system's processor architecture.
   bool need_to_swap_bytes_;
 
+  // The reader of the base bundle, iff this is a delta bundle.
+  std::unique_ptr<BundleReader> base_;
+
   friend class TensorBundleAlignmentTest;  // For testing data alignment.
+  friend Status AlignBundle(Env* env, StringPiece prefix,
+                            StringPiece output_prefix, int data_alignment);
 
   TF_DISALLOW_COPY_AND_ASSIGN(BundleReader);
 };
@@ -18,6 +18,8 @@ limitations under the License.
 #include <random>
 #include <vector>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -260,6 +262,14 @@ void TestBasic() {
     Expect<T>(&reader, "foo_001", Constant_2x3(T(1)));
     Expect<T>(&reader, "foo_002", Constant_2x3(T(2)));
     Expect<T>(&reader, "foo_003", Constant_2x3(T(3)));
+
+    // The data files keep the order of the merged bundles.
+    EXPECT_EQ(reader.num_shards(), 2);
+    int32 shard_id;
+    TF_EXPECT_OK(reader.LookupDataShard("foo_001", &shard_id));
+    EXPECT_EQ(shard_id, 0);
+    TF_EXPECT_OK(reader.LookupDataShard("bar_001", &shard_id));
+    EXPECT_EQ(shard_id, 1);
   }
   {
     BundleReader reader(Env::Default(), Prefix("merged"));
@@ -1113,6 +1123,206 @@ TEST_F(TensorBundleAlignmentTest, AlignmentTest) {
   }
 }
 
+// Returns the name of the allocator that owns the buffer of "t".
+string AllocatorName(const Tensor& t) {
+  TensorDescription description;
+  t.FillDescription(&description);
+  return description.allocation_description().allocator_name();
+}
+
+TEST(TensorBundleTest, ReadCurrentMapped) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    BundleWriter writer(Env::Default(), Prefix("foo"), opts);
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_2x3<float>(0)));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3<tstring>("1")));
+    TF_EXPECT_OK(writer.Add("foo_002", Constant(7, TensorShape({3}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("foo"));
+  TF_ASSERT_OK(reader.status());
+  reader.Next();  // The first entry in the table is a header.
+  Tensor val;
+  TF_ASSERT_OK(reader.ReadCurrentMapped(&val));
+  test::ExpectTensorEqual<float>(val, Constant_2x3<float>(0));
+  // Filesystems without memory-mapping support fall back to copying.
+  const bool mapped = AllocatorName(val) == "mmap";
+
+  // String tensors are always copied.
+  reader.Next();
+  TF_ASSERT_OK(reader.ReadCurrentMapped(&val));
+  test::ExpectTensorEqual<tstring>(val, Constant_2x3<tstring>("1"));
+  EXPECT_NE(AllocatorName(val), "mmap");
+
+  reader.Next();
+  TF_ASSERT_OK(reader.ReadCurrentMapped(&val));
+  test::ExpectTensorEqual<int>(val, Constant(7, TensorShape({3})));
+  EXPECT_EQ(AllocatorName(val) == "mmap", mapped);
+}
+
+TEST(TensorBundleTest, LookupMapped) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    BundleWriter writer(Env::Default(), Prefix("foo"), opts);
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_2x3<float>(0)));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3<tstring>("1")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("foo"));
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  bool mapped = false;
+  TF_ASSERT_OK(reader.LookupMapped("foo_000", &val, &mapped));
+  // Filesystems without memory-mapping support leave the tensor alone.
+  if (mapped) {
+    test::ExpectTensorEqual<float>(val, Constant_2x3<float>(0));
+    EXPECT_EQ(AllocatorName(val), "mmap");
+    EXPECT_FALSE(val.RefCountIsOne());
+  }
+
+  // String tensors are never mapped.
+  mapped = false;
+  Tensor string_val;
+  TF_ASSERT_OK(reader.LookupMapped("foo_001", &string_val, &mapped));
+  EXPECT_FALSE(mapped);
+  EXPECT_FALSE(string_val.IsInitialized());
+
+  EXPECT_TRUE(errors::IsNotFound(reader.LookupMapped("bar", &val, &mapped)));
+}
+
+TEST(TensorBundleTest, DeltaBundles) {
+  const Tensor base_foo =
+      test::AsTensor<float>({0, 1, 2, 3, 4, 5, 6, 7}, TensorShape({4, 2}));
+  {
+    BundleWriter writer(Env::Default(), Prefix("delta_base"));
+    TF_EXPECT_OK(writer.Add("foo", base_foo));
+    TF_EXPECT_OK(writer.Add("bar", Constant<int32>(1, TensorShape({3}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  Tensor foo = tensor::DeepCopy(base_foo);
+  foo.matrix<float>()(1, 0) = 10;
+  foo.matrix<float>()(3, 1) = 20;
+  {
+    BundleWriter::Options opts;
+    opts.base_prefix = "delta_base";  // Relative to the directory of "delta".
+    BundleWriter writer(Env::Default(), Prefix("delta"), opts);
+    TF_EXPECT_OK(writer.AddRows("foo", foo, {3, 1}));
+    // Without rows, the base tensor is read.
+    TF_EXPECT_OK(writer.AddRows("bar", Constant<int32>(2, TensorShape({3})),
+                                {}));
+    TF_EXPECT_OK(writer.Add("baz", Constant_2x3<double>(3)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleReader reader(Env::Default(), Prefix("delta"));
+    TF_ASSERT_OK(reader.status());
+    Expect<float>(&reader, "foo", foo);
+    Expect<int32>(&reader, "bar", Constant<int32>(1, TensorShape({3})));
+    Expect<double>(&reader, "baz", Constant_2x3<double>(3));
+    EXPECT_FALSE(reader.Contains("qux"));
+    // Iterating only visits the entries of the delta bundle.
+    EXPECT_EQ(AllTensorKeys(&reader), std::vector<string>({"baz", "foo"}));
+    int32 shard_id;
+    TF_EXPECT_OK(reader.LookupDataShard("bar", &shard_id));
+    EXPECT_EQ(shard_id, -1);
+  }
+
+  // A delta of a delta bundle.
+  foo.matrix<float>()(0, 1) = 30;
+  {
+    BundleWriter::Options opts;
+    opts.base_prefix = Prefix("delta");
+    BundleWriter writer(Env::Default(), Prefix("delta2"), opts);
+    TF_EXPECT_OK(writer.AddRows("foo", foo, {0}));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleReader reader(Env::Default(), Prefix("delta2"));
+    TF_ASSERT_OK(reader.status());
+    Expect<float>(&reader, "foo", foo);
+    Expect<int32>(&reader, "bar", Constant<int32>(1, TensorShape({3})));
+    Expect<double>(&reader, "baz", Constant_2x3<double>(3));
+  }
+}
+
+TEST(TensorBundleTest, InvalidDeltaRows) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("no_base"));
+    EXPECT_TRUE(errors::IsFailedPrecondition(
+        writer.AddRows("foo", Constant_2x3<float>(0), {0})));
+  }
+  BundleWriter::Options opts;
+  opts.base_prefix = "delta_base";
+  {
+    BundleWriter writer(Env::Default(), Prefix("bad_rows"), opts);
+    EXPECT_TRUE(errors::IsInvalidArgument(
+        writer.AddRows("foo", Constant_2x3<float>(0), {2})));
+  }
+  {
+    BundleWriter writer(Env::Default(), Prefix("bad_dtype"), opts);
+    EXPECT_TRUE(errors::IsInvalidArgument(
+        writer.AddRows("foo", Constant_2x3<tstring>("0"), {0})));
+  }
+}
+
+TEST(TensorBundleTest, AlignBundle) {
+  const TensorShape kFullShape({5, 10});
+  {
+    BundleWriter writer(Env::Default(), Prefix("unaligned_base"));
+    TF_EXPECT_OK(writer.Add("foo", Constant_2x3<float>(1)));
+    TF_EXPECT_OK(writer.Add("bar", Constant_2x3<tstring>("2")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter::Options opts;
+    opts.base_prefix = "unaligned_base";
+    BundleWriter writer(Env::Default(), Prefix("unaligned"), opts);
+    TF_EXPECT_OK(writer.AddRows("foo", Constant_2x3<float>(3), {1}));
+    TF_EXPECT_OK(writer.AddSlice("baz", kFullShape,
+                                 TensorSlice::ParseOrDie("-:0,1"),
+                                 Constant<int32>(4, TensorShape({5, 1}))));
+    TF_EXPECT_OK(writer.AddSlice("baz", kFullShape,
+                                 TensorSlice::ParseOrDie("-:1,9"),
+                                 Constant<int32>(5, TensorShape({5, 9}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  TF_ASSERT_OK(AlignBundle(Env::Default(), Prefix("unaligned"),
+                           Prefix("aligned"), 4096));
+
+  // The aligned bundle does not need the base bundle.
+  TF_ASSERT_OK(Env::Default()->DeleteFile(MetaFilename(Prefix("unaligned"))));
+  TF_ASSERT_OK(
+      Env::Default()->DeleteFile(MetaFilename(Prefix("unaligned_base"))));
+
+  BundleReader reader(Env::Default(), Prefix("aligned"));
+  TF_ASSERT_OK(reader.status());
+  Tensor foo = Constant_2x3<float>(1);
+  foo.matrix<float>()(1, 0) = 3;
+  foo.matrix<float>()(1, 1) = 3;
+  foo.matrix<float>()(1, 2) = 3;
+  Expect<float>(&reader, "foo", foo);
+  Expect<tstring>(&reader, "bar", Constant_2x3<tstring>("2"));
+  std::vector<TensorSlice> slices;
+  // The slices of "baz" are kept.
+  TF_ASSERT_OK(reader.LookupTensorSlices("baz", &slices));
+  EXPECT_EQ(slices.size(), 2);
+  Tensor expected_baz(DT_INT32, kFullShape);
+  test::FillFn<int32>(&expected_baz, [](int offset) -> int32 {
+    return offset % 10 == 0 ? 4 : 5;
+  });
+  Expect<int32>(&reader, "baz", expected_baz);
+
+  Tensor val;
+  bool mapped = false;
+  TF_ASSERT_OK(reader.LookupMapped("foo", &val, &mapped));
+  // Filesystems without memory-mapping support leave the tensor alone.
+  if (mapped) {
+    test::ExpectTensorEqual<float>(val, foo);
+  }
+}
+
 static void BM_BundleAlignmentByteOff(int iters, int alignment,
                                       int tensor_size) {
   testing::StopTiming();
@@ -117,6 +117,22 @@ func NewTensor(value interface{}) (*Tensor, error) {
 //
 // See also WriteContentsTo.
 func ReadTensor(dataType DataType, shape []int64, r io.Reader) (*Tensor, error) {
+	t, err := AllocateTensor(dataType, shape)
+	if err != nil {
+		return nil, err
+	}
+	raw := tensorData(t.c)
+	if _, err := io.ReadFull(r, raw); err != nil {
+		return nil, err
+	}
+	return t, nil
+}
+
+// AllocateTensor returns a Tensor with the provided type and shape, whose
+// uninitialized contents are to be filled in through Bytes. Unlike NewTensor,
+// it lets callers write large inputs directly into the memory of the Tensor
+// rather than copying them from a Go value.
+func AllocateTensor(dataType DataType, shape []int64) (*Tensor, error) {
 	if err := isTensorSerializable(dataType); err != nil {
 		return nil, err
 	}
@@ -130,10 +146,6 @@ func ReadTensor(dataType DataType, shape []int64, r io.Reader) (*Tensor, error)
 		shape: shape,
 	}
 	runtime.SetFinalizer(t, (*Tensor).finalize)
-	raw := tensorData(t.c)
-	if _, err := io.ReadFull(r, raw); err != nil {
-		return nil, err
-	}
 	return t, nil
 }
 
@@ -185,6 +197,18 @@ func (t *Tensor) Value() interface{} {
 	return reflect.Indirect(val).Interface()
 }
 
+// Bytes returns the contents of t in the format used by ReadTensor, without
+// copying them: the returned slice refers to the memory of t, and is only valid
+// as long as t is. Writes to the slice change the contents of t.
+//
+// Bytes returns nil for DataTypes that are not serializable (e.g., String).
+func (t *Tensor) Bytes() []byte {
+	if err := isTensorSerializable(t.DataType()); err != nil {
+		return nil
+	}
+	return tensorData(t.c)
+}
+
 // WriteContentsTo writes the serialized contents of t to w.
 //
 // Returns the number of bytes written. See ReadTensor for
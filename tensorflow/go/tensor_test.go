@@ -203,6 +203,35 @@ func TestReadTensorDoesNotReadBeyondContent(t *testing.T) {
 	}
 }
 
+func TestAllocateTensorBytes(t *testing.T) {
+	tensor, err := AllocateTensor(Int32, []int64{2, 2})
+	if err != nil {
+		t.Fatal(err)
+	}
+	raw := tensor.Bytes()
+	if len(raw) != 16 {
+		t.Fatalf("Got %d bytes, want 16", len(raw))
+	}
+	for i, v := range []int32{1, 2, 3, 4} {
+		nativeEndian.PutUint32(raw[4*i:], uint32(v))
+	}
+	// The writes to the slice are visible in the tensor.
+	want := [][]int32{{1, 2}, {3, 4}}
+	if got := tensor.Value().([][]int32); !reflect.DeepEqual(got, want) {
+		t.Errorf("Got %v, want %v", got, want)
+	}
+	if _, err := AllocateTensor(String, []int64{1}); err == nil {
+		t.Error("AllocateTensor should have failed for a String tensor")
+	}
+	str, err := NewTensor("abcd")
+	if err != nil {
+		t.Fatal(err)
+	}
+	if raw := str.Bytes(); raw != nil {
+		t.Errorf("Got %v, want nil for the bytes of a String tensor", raw)
+	}
+}
+
 func TestTensorSerializationErrors(t *testing.T) {
 	// String tensors cannot be serialized
 	t1, err := NewTensor("abcd")
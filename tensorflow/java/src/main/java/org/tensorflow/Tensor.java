@@ -266,6 +266,46 @@ public final class Tensor<T> implements AutoCloseable {
     return t;
   }
 
+  /**
+   * Create a Tensor of a primitive type that uses the given direct buffer as its data, without
+   * copying it.
+   *
+   * <p>The Tensor uses the {@code data.remaining()} bytes from the position of {@code data}, which
+   * must be encoded in native byte order. Changes to those bytes are visible to the Tensor, so they
+   * must not be modified while the Tensor is in use. The Tensor keeps a reference to the buffer
+   * until it is closed and TensorFlow releases its data. The data is copied if it is not aligned
+   * to 64 bytes, as required by TensorFlow kernels.
+   *
+   * @param <T> the tensor element type
+   * @param type the tensor element type, represented as a class object.
+   * @param shape the tensor shape.
+   * @param data a direct buffer containing the tensor data.
+   * @throws IllegalArgumentException If {@code data} is not a direct buffer, or if the tensor
+   *     datatype or shape is not compatible with the buffer
+   */
+  public static <T> Tensor<T> wrap(Class<T> type, long[] shape, ByteBuffer data) {
+    DataType dtype = DataType.fromClass(type);
+    if (dtype == DataType.STRING) {
+      throw new IllegalArgumentException("cannot wrap a buffer in a STRING Tensor");
+    }
+    if (!data.isDirect()) {
+      throw new IllegalArgumentException("cannot wrap a non-direct buffer in a Tensor");
+    }
+    int elemBytes = elemByteSize(dtype);
+    if (data.remaining() != numElements(shape) * elemBytes) {
+      throw new IllegalArgumentException(
+          String.format(
+              "ByteBuffer with %d bytes is not compatible with a %s Tensor with shape %s",
+              data.remaining(), dtype.toString(), Arrays.toString(shape)));
+    }
+    Tensor<T> t = new Tensor<T>(dtype);
+    t.shapeCopy = Arrays.copyOf(shape, shape.length);
+    long nativeHandle =
+        allocateDirect(t.dtype.c(), t.shapeCopy, data, data.position(), data.remaining());
+    t.nativeRef = new NativeReference(nativeHandle);
+    return t;
+  }
+
   /**
    * Returns this Tensor object with the type {@code Tensor<U>}. This method is useful when given a
    * value of type {@code Tensor<?>}.
@@ -524,6 +564,16 @@ public final class Tensor<T> implements AutoCloseable {
     dst.put(src);
   }
 
+  /**
+   * Returns a read-only view of the tensor data, without copying it.
+   *
+   * <p>The buffer is in native byte order for primitive types, and holds the encoding of the C API
+   * for STRING tensors. It must not be used after the Tensor is closed.
+   */
+  public ByteBuffer asReadOnlyBuffer() {
+    return buffer().asReadOnlyBuffer().order(ByteOrder.nativeOrder());
+  }
+
   /** Returns a string describing the type and shape of the Tensor. */
   @Override
   public String toString() {
@@ -806,6 +856,9 @@ public final class Tensor<T> implements AutoCloseable {
 
   private static native long allocate(int dtype, long[] shape, long byteSize);
 
+  private static native long allocateDirect(
+      int dtype, long[] shape, ByteBuffer data, long offset, long byteSize);
+
   private static native long allocateScalarBytes(byte[] value);
 
   private static native long allocateNonScalarBytes(long[] shape, Object[] value);
@@ -321,6 +321,35 @@ void readNDStringArray(JNIEnv* env, StringTensorReader* reader, int dims_left,
     if (TF_GetCode(status) != TF_OK) return;
   }
 }
+// The Java direct buffer backing a TF_Tensor created by allocateDirect.
+struct DirectBuffer {
+  JavaVM* vm;
+  jobject buffer;  // Global reference.
+};
+
+// Deallocator of the TF_Tensors created by allocateDirect: releases the
+// reference to their direct buffer. Tensors may be released on any thread.
+void releaseDirectBuffer(void* data, size_t len, void* arg) {
+  DirectBuffer* direct_buffer = static_cast<DirectBuffer*>(arg);
+  JNIEnv* env = nullptr;
+  bool attached = false;
+  if (direct_buffer->vm->GetEnv(reinterpret_cast<void**>(&env),
+                                JNI_VERSION_1_6) == JNI_EDETACHED) {
+    if (direct_buffer->vm->AttachCurrentThreadAsDaemon(
+            reinterpret_cast<void**>(&env), nullptr) != JNI_OK) {
+      env = nullptr;
+    }
+    attached = env != nullptr;
+  }
+  if (env != nullptr) {
+    env->DeleteGlobalRef(direct_buffer->buffer);
+  }
+  if (attached) {
+    direct_buffer->vm->DetachCurrentThread();
+  }
+  delete direct_buffer;
+}
+
 }  // namespace
 
 JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocate(JNIEnv* env,
@@ -362,6 +391,49 @@ JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocate(JNIEnv* env,
   return reinterpret_cast<jlong>(t);
 }
 
+JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocateDirect(
+    JNIEnv* env, jclass clazz, jint dtype, jlongArray shape, jobject buffer,
+    jlong offset, jlong sizeInBytes) {
+  char* address = static_cast<char*>(env->GetDirectBufferAddress(buffer));
+  if (address == nullptr) {
+    throwException(env, kIllegalArgumentException,
+                   "the buffer is not a direct buffer");
+    return 0;
+  }
+  if (offset < 0 || sizeInBytes < 0 ||
+      offset + sizeInBytes > env->GetDirectBufferCapacity(buffer)) {
+    throwException(env, kIllegalArgumentException,
+                   "%lld bytes at offset %lld are out of the buffer",
+                   static_cast<long long>(sizeInBytes),
+                   static_cast<long long>(offset));
+    return 0;
+  }
+  int num_dims = static_cast<int>(env->GetArrayLength(shape));
+  std::unique_ptr<int64_t[]> dims(new int64_t[num_dims]);
+  if (num_dims > 0) {
+    jlong* shape_elems = env->GetLongArrayElements(shape, nullptr);
+    for (int i = 0; i < num_dims; ++i) {
+      dims[i] = static_cast<int64_t>(shape_elems[i]);
+    }
+    env->ReleaseLongArrayElements(shape, shape_elems, JNI_ABORT);
+  }
+  DirectBuffer* direct_buffer = new DirectBuffer;
+  env->GetJavaVM(&direct_buffer->vm);
+  direct_buffer->buffer = env->NewGlobalRef(buffer);
+  // TF_NewTensor copies the data, and releases the buffer right away, if the
+  // address is not aligned enough for TensorFlow kernels.
+  TF_Tensor* t = TF_NewTensor(static_cast<TF_DataType>(dtype), dims.get(),
+                              num_dims, address + offset,
+                              static_cast<size_t>(sizeInBytes),
+                              releaseDirectBuffer, direct_buffer);
+  if (t == nullptr) {
+    throwException(env, kIllegalArgumentException,
+                   "the buffer is too small for the Tensor");
+    return 0;
+  }
+  return reinterpret_cast<jlong>(t);
+}
+
 JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocateScalarBytes(
     JNIEnv* env, jclass clazz, jbyteArray value) {
   // TF_STRING tensors are encoded with a table of 8-byte offsets followed by
@@ -164,6 +164,51 @@ public class TensorTest {
     }
   }
 
+  @Test
+  public void wrapDirectByteBuffer() {
+    float[] floats = {1f, 2f, 3f, 4f, 5f, 6f};
+    ByteBuffer buf = ByteBuffer.allocateDirect(4 * floats.length).order(ByteOrder.nativeOrder());
+    buf.asFloatBuffer().put(floats);
+    try (Tensor<Float> t = Tensor.wrap(Float.class, new long[] {2, 3}, buf)) {
+      assertArrayEquals(new long[] {2, 3}, t.shape());
+      float[][] actual = new float[2][3];
+      t.copyTo(actual);
+      assertArrayEquals(new float[] {1f, 2f, 3f}, actual[0], EPSILON_F);
+      assertArrayEquals(new float[] {4f, 5f, 6f}, actual[1], EPSILON_F);
+    }
+
+    // validate buffer- and shape-checking
+    try (Tensor<Float> t = Tensor.wrap(Float.class, new long[] {2}, ByteBuffer.allocate(8))) {
+      fail("should have failed on non-direct buffer");
+    } catch (IllegalArgumentException e) {
+      // expected
+    }
+    try (Tensor<Float> t = Tensor.wrap(Float.class, new long[] {7}, buf)) {
+      fail("should have failed on incompatible buffer");
+    } catch (IllegalArgumentException e) {
+      // expected
+    }
+    try (Tensor<String> t = Tensor.wrap(String.class, new long[] {}, buf)) {
+      fail("should have failed on STRING tensor");
+    } catch (IllegalArgumentException e) {
+      // expected
+    }
+  }
+
+  @Test
+  public void asReadOnlyBuffer() {
+    long[] longs = {1L, 2L, 3L};
+    try (Tensor<Long> t = Tensors.create(longs)) {
+      ByteBuffer buf = t.asReadOnlyBuffer();
+      assertTrue(buf.isReadOnly());
+      assertEquals(t.numBytes(), buf.remaining());
+      LongBuffer actual = buf.asLongBuffer();
+      for (int i = 0; i < longs.length; ++i) {
+        assertEquals(longs[i], actual.get(i));
+      }
+    }
+  }
+
   @Test
   public void writeTo() {
     int[] ints = {1, 2, 3};
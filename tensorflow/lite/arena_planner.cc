@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/arena_planner.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <utility>
 
@@ -31,14 +32,16 @@ struct AllocationInfo {
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
                            std::unique_ptr<GraphInfo> graph_info,
                            bool preserve_inputs, bool preserve_intermediates,
-                           int tensor_alignment)
+                           int tensor_alignment, int max_cached_plans)
     : context_(context),
       graph_info_(std::move(graph_info)),
       arena_(kDefaultArenaAlignment),
       persistent_arena_(kDefaultArenaAlignment),
       preserve_inputs_(preserve_inputs),
       preserve_intermediates_(preserve_intermediates),
-      tensor_alignment_(tensor_alignment) {}
+      tensor_alignment_(tensor_alignment),
+      max_cached_plans_(max_cached_plans),
+      allocations_reset_(true) {}
 
 ArenaPlanner::~ArenaPlanner() {}
 
@@ -57,6 +60,7 @@ TfLiteStatus ArenaPlanner::ResetAllocations() {
   TF_LITE_ENSURE_STATUS(persistent_arena_.Clear());
   allocs_.clear();
   allocs_.resize(graph_info_->num_tensors());
+  allocations_reset_ = true;
   // Note that we only clear the alloc_queue_ when re-planning allocations, as
   // it should only change when the graph topology itself changes.
   return kTfLiteOk;
@@ -68,6 +72,8 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
   // The alloc_queue_ is specific to the graph topology, and will be
   // completely reconstructed from graph data here.
   alloc_queue_.clear();
+  // So are the cached plans.
+  cached_plans_.clear();
 
   // Keeps track of references to each tensor.
   std::vector<int> refcounts(graph_info_->num_tensors(), 0);
@@ -95,7 +101,10 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
       return kTfLiteOk;
     }
     TF_LITE_ENSURE(context_, !deallocated[tensor]);
-    alloc_queue_.push_back({node, tensor, AllocationInfo::DEALLOC});
+    // Tensors used by a group of nodes are held until the whole group is done,
+    // as its nodes may run concurrently.
+    alloc_queue_.push_back({static_cast<int>(graph_info_->node_group_end(node)),
+                            tensor, AllocationInfo::DEALLOC});
     return kTfLiteOk;
   };
 
@@ -181,6 +190,16 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
     }
   }
 
+  // Deallocations postponed to the end of a group must come after the
+  // allocations of the nodes in between. Without groups the queue is already
+  // in this order.
+  std::stable_sort(alloc_queue_.begin(), alloc_queue_.end(),
+                   [](const AllocationInfo& a, const AllocationInfo& b) {
+                     if (a.node != b.node) return a.node < b.node;
+                     return a.type == AllocationInfo::ALLOC &&
+                            b.type == AllocationInfo::DEALLOC;
+                   });
+
   // Note that graph outputs will never be scheduled for deallocation. We
   // could do that here for completeness, but it won't have any effect.
   return kTfLiteOk;
@@ -192,7 +211,22 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
   TF_LITE_ENSURE(context_, graph_info_->num_tensors() >= allocs_.size());
   allocs_.resize(graph_info_->num_tensors());
 
-  TF_LITE_ENSURE_STATUS(CalculateAllocations(first_node, last_node));
+  // Allocations calculated for the whole graph right after a reset only
+  // depend on the tensor sizes, so they can be cached. Incremental steps
+  // depend on the previous ones and are always calculated.
+  const bool whole_graph =
+      allocations_reset_ && first_node == 0 &&
+      last_node + 1 >= static_cast<int>(graph_info_->num_nodes());
+  allocations_reset_ = false;
+  if (whole_graph && max_cached_plans_ > 0) {
+    std::vector<size_t> key = PlanCacheKey();
+    if (!RestoreCachedPlan(key)) {
+      TF_LITE_ENSURE_STATUS(CalculateAllocations(first_node, last_node));
+      CachePlan(std::move(key));
+    }
+  } else {
+    TF_LITE_ENSURE_STATUS(CalculateAllocations(first_node, last_node));
+  }
   TF_LITE_ENSURE_STATUS(Commit());
 
   for (int i = 0; i < static_cast<int>(graph_info_->num_tensors()); ++i) {
@@ -206,6 +240,44 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
   return kTfLiteOk;
 }
 
+std::vector<size_t> ArenaPlanner::PlanCacheKey() {
+  std::vector<size_t> key;
+  key.reserve(2 * graph_info_->num_tensors());
+  for (size_t i = 0; i < graph_info_->num_tensors(); ++i) {
+    const TfLiteTensor& tensor = *graph_info_->tensor(i);
+    key.push_back(tensor.allocation_type);
+    // The size of tensors that don't live in the arenas is irrelevant.
+    if (tensor.allocation_type == kTfLiteArenaRw ||
+        tensor.allocation_type == kTfLiteArenaRwPersistent) {
+      key.push_back(tensor.bytes);
+    } else {
+      key.push_back(0);
+    }
+  }
+  return key;
+}
+
+bool ArenaPlanner::RestoreCachedPlan(const std::vector<size_t>& key) {
+  for (auto it = cached_plans_.begin(); it != cached_plans_.end(); ++it) {
+    if (it->key != key) continue;
+    cached_plans_.splice(cached_plans_.begin(), cached_plans_, it);
+    const CachedPlan& plan = cached_plans_.front();
+    allocs_ = plan.allocs;
+    arena_.RestoreLayout(plan.arena_layout);
+    persistent_arena_.RestoreLayout(plan.persistent_arena_layout);
+    return true;
+  }
+  return false;
+}
+
+void ArenaPlanner::CachePlan(std::vector<size_t> key) {
+  cached_plans_.push_front({std::move(key), allocs_, arena_.GetLayout(),
+                            persistent_arena_.GetLayout()});
+  if (cached_plans_.size() > static_cast<size_t>(max_cached_plans_)) {
+    cached_plans_.pop_back();
+  }
+}
+
 TfLiteStatus ArenaPlanner::Commit() {
   TF_LITE_ENSURE_STATUS(arena_.Commit(context_));
   TF_LITE_ENSURE_STATUS(persistent_arena_.Commit(context_));
@@ -214,6 +286,9 @@ TfLiteStatus ArenaPlanner::Commit() {
 
 TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
   int active_node = first_node;
+  // The first node of the current group. Temporaries are kept until all the
+  // nodes of their group are done.
+  int group_first_node = first_node;
   // When dynamic tensors are present this method is called multiple times.
   // The items in the alloc_queue_ referring to nodes before first_node were
   // processed previously and should be skipped. Entries after last_node are
@@ -224,9 +299,12 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
     if (alloc_info.node == active_node) {
       // This is the first allocation/deallocation for a given node.  It is
       // time to deallocate the previous temporaries and allocate new ones.
-      if (active_node != first_node) {
-        TF_LITE_ENSURE_STATUS(
-            CalculateDeallocationOfInternalTensors(active_node - 1));
+      if (active_node != first_node &&
+          graph_info_->node_group_end(active_node - 1) ==
+              static_cast<size_t>(active_node - 1)) {
+        TF_LITE_ENSURE_STATUS(CalculateDeallocationOfInternalTensors(
+            group_first_node, active_node - 1));
+        group_first_node = active_node;
       }
       TF_LITE_ENSURE_STATUS(CalculateAllocationOfInternalTensors(active_node));
       ++active_node;
@@ -244,8 +322,8 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
   // cases
   if (active_node > 0) {
     // Don't forget to deallocate temporaries of last node.
-    TF_LITE_ENSURE_STATUS(
-        CalculateDeallocationOfInternalTensors(active_node - 1));
+    TF_LITE_ENSURE_STATUS(CalculateDeallocationOfInternalTensors(
+        std::min(group_first_node, active_node - 1), active_node - 1));
   }
 
   return kTfLiteOk;
@@ -303,8 +381,9 @@ TfLiteStatus ArenaPlanner::CalculateAllocationOfInternalTensors(
 }
 
 TfLiteStatus ArenaPlanner::CalculateDeallocationOfInternalTensors(
-    int node_index) {
-  if (node_index < static_cast<int>(graph_info_->num_nodes())) {
+    int first_node, int last_node) {
+  for (int node_index = first_node; node_index <= last_node; ++node_index) {
+    if (node_index >= static_cast<int>(graph_info_->num_nodes())) break;
     const TfLiteNode& node = graph_info_->node(static_cast<size_t>(node_index));
     TfLiteIntArray* node_temporaries = node.temporaries;
     for (int i = 0; i < node_temporaries->size; ++i) {
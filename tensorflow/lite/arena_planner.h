@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_LITE_ARENA_PLANNER_H_
 
 #include <cstdint>
+#include <list>
 #include <memory>
 #include <vector>
 
@@ -29,6 +30,7 @@ namespace tflite {
 // Memory allocation tuning
 constexpr const int kDefaultArenaAlignment = 64;
 constexpr const int kDefaultTensorAlignment = 64;
+constexpr const int kDefaultMaxCachedPlans = 4;
 
 struct AllocationInfo;
 
@@ -46,6 +48,11 @@ struct AllocationInfo;
 // corresponding operation is executed, this class supports incremental
 // planning.
 //
+// Plans computed for the whole graph are cached, keyed by the sizes of all
+// tensors, so that switching back and forth between a few input shapes (e.g.
+// after Interpreter::ResizeInputTensor) neither recomputes the plan nor
+// reallocates the arenas, which only ever grow.
+//
 // TODO(b/127354079): Remove the constrain below when the issue is fixed.
 // WARNING: MemoryPlanner's behavior must be deterministic. If the first N
 // nodes are unchanged, it must produce exactly the same allocation plan for
@@ -55,10 +62,13 @@ class ArenaPlanner : public MemoryPlanner {
   // Ownership of 'context' is not taken and it must remain util the
   // ArenaPlanner is destroyed. If 'preserve_inputs' is true the inputs to the
   // graph will not share memory with any other tensor, effectively preserving
-  // them until the end of inference.
+  // them until the end of inference. At most 'max_cached_plans' plans are
+  // cached, the least recently used one being evicted first; 0 disables the
+  // cache.
   ArenaPlanner(TfLiteContext* context, std::unique_ptr<GraphInfo> graph_info,
                bool preserve_inputs, bool preserve_intermediates,
-               int tensor_alignment = kDefaultTensorAlignment);
+               int tensor_alignment = kDefaultTensorAlignment,
+               int max_cached_plans = kDefaultMaxCachedPlans);
   ~ArenaPlanner() override;
   ArenaPlanner(const ArenaPlanner&) = delete;
   ArenaPlanner& operator=(const ArenaPlanner&) = delete;
@@ -71,6 +81,25 @@ class ArenaPlanner : public MemoryPlanner {
   std::intptr_t BasePointer(TfLiteAllocationType type);
 
  private:
+  // The allocations of all tensors for one set of tensor sizes.
+  struct CachedPlan {
+    std::vector<size_t> key;
+    std::vector<ArenaAlloc> allocs;
+    SimpleMemoryArena::Layout arena_layout;
+    SimpleMemoryArena::Layout persistent_arena_layout;
+  };
+
+  // Returns the key identifying plans computed for the current tensor sizes.
+  std::vector<size_t> PlanCacheKey();
+
+  // Restores the cached plan for 'key', if any, and returns whether it was
+  // found.
+  bool RestoreCachedPlan(const std::vector<size_t>& key);
+
+  // Caches the current allocations under 'key', evicting the least recently
+  // used plan if the cache is full.
+  void CachePlan(std::vector<size_t> key);
+
   // Make sure all the arenas have reserved enough memory to store all their
   // tensors.
   TfLiteStatus Commit();
@@ -93,9 +122,10 @@ class ArenaPlanner : public MemoryPlanner {
   // 'node_index'.
   TfLiteStatus CalculateAllocationOfInternalTensors(int node_index);
 
-  // Register a deallocation for all internal (temporary) tensors of
-  // 'node_index'.
-  TfLiteStatus CalculateDeallocationOfInternalTensors(int node_index);
+  // Register a deallocation for all internal (temporary) tensors of the nodes
+  // in the interval [first_node, last_node].
+  TfLiteStatus CalculateDeallocationOfInternalTensors(int first_node,
+                                                      int last_node);
 
   TfLiteContext* context_;
   std::unique_ptr<GraphInfo> graph_info_;
@@ -126,6 +156,13 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Number of bytes that tensor buffers should be aligned to.
   int tensor_alignment_;
+
+  // Cached plans for the current graph topology, most recently used first.
+  std::list<CachedPlan> cached_plans_;
+  int max_cached_plans_;
+
+  // True if no allocations were calculated since the last reset.
+  bool allocations_reset_;
 };
 
 }  // namespace tflite
@@ -109,12 +109,19 @@ class TestGraph {
     variables_ = variables;
   }
 
+  // Sets, for each node, the index of the last node in its group.
+  void SetGroupEnds(const std::vector<int>& group_ends) {
+    group_ends_ = group_ends;
+  }
+  const std::vector<int>& group_ends() { return group_ends_; }
+
   void Swap(TestGraph* other) {
     std::swap(nodes_, other->nodes_);
     std::swap(tensors_, other->tensors_);
     std::swap(inputs_, other->inputs_);
     std::swap(outputs_, other->outputs_);
     std::swap(variables_, other->variables_);
+    std::swap(group_ends_, other->group_ends_);
   }
 
  private:
@@ -123,6 +130,7 @@ class TestGraph {
   std::vector<int> inputs_;
   std::vector<int> outputs_;
   std::vector<int> variables_;
+  std::vector<int> group_ends_;
 };
 
 // The GraphInfo for a TestGraph.
@@ -144,6 +152,10 @@ class TestGraphInfo : public GraphInfo {
   const std::vector<int>& variables() const override {
     return graph_->variables();
   }
+  size_t node_group_end(size_t index) const override {
+    if (graph_->group_ends().empty()) return index;
+    return graph_->group_ends()[index];
+  }
 
  private:
   TestGraph* graph_;
@@ -163,12 +175,14 @@ void ReportError(TfLiteContext* context, const char* format, ...) {
 
 class ArenaPlannerTest : public ::testing::Test {
  protected:
-  void SetGraph(TestGraph* graph, bool preserve_inputs = false) {
+  void SetGraph(TestGraph* graph, bool preserve_inputs = false,
+                int max_cached_plans = kDefaultMaxCachedPlans) {
     graph_ = graph;
     context_.ReportError = ReportError;
     planner_.reset(new ArenaPlanner(
         &context_, std::unique_ptr<GraphInfo>(new TestGraphInfo(graph)),
-        preserve_inputs, /*preserve intermediates*/ false, kTensorAlignment));
+        preserve_inputs, /*preserve intermediates*/ false, kTensorAlignment,
+        max_cached_plans));
     CHECK(planner_->ResetAllocations() == kTfLiteOk);
     CHECK(planner_->PlanAllocations() == kTfLiteOk);
   }
@@ -273,6 +287,42 @@ TEST_F(ArenaPlannerTest, SimpleGraph) {
   EXPECT_EQ(GetOffset(3), 0);
 }
 
+TEST_F(ArenaPlannerTest, GroupedNodesDoNotShareMemory) {
+  auto make_graph = [] {
+    return TestGraph({0},
+                     {
+                         /* in, out, tmp */
+                         {{0}, {1}, {5}},     // First op
+                         {{0}, {2}, {4}},     // Second op
+                         {{1, 2}, {3}, {}}    // Third op
+                     },
+                     {3});
+  };
+
+  // Executed one after the other the second op reuses the space of the
+  // temporary of the first op.
+  TestGraph sequential_graph = make_graph();
+  SetGraph(&sequential_graph);
+  Execute(0, 10);
+  EXPECT_EQ(GetOffset(4), GetOffset(5));
+
+  // The first two ops may run concurrently, so everything they use is kept
+  // apart.
+  TestGraph grouped_graph = make_graph();
+  grouped_graph.SetGroupEnds({1, 1, 2});
+  SetGraph(&grouped_graph);
+  Execute(0, 10);
+  std::vector<int> group_tensors = {0, 1, 2, 4, 5};
+  for (int a : group_tensors) {
+    for (int b : group_tensors) {
+      if (a == b) continue;
+      EXPECT_TRUE(GetOffsetAfter(a) <= GetOffset(b) ||
+                  GetOffsetAfter(b) <= GetOffset(a))
+          << "tensors " << a << " and " << b << " overlap";
+    }
+  }
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphInputsPreserved) {
   TestGraph graph({0, 1},
                   {
@@ -548,6 +598,80 @@ TEST_F(ArenaPlannerTest, ModifiedGraph) {
   EXPECT_EQ(GetOffset(3), GetOffsetAfter(1));
 }
 
+TEST_F(ArenaPlannerTest, CachedPlans) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+
+  auto resize = [&graph](int bytes) {
+    for (int i : {0, 2, 4, 5}) {
+      (*graph.tensors())[i].bytes = bytes;
+    }
+  };
+  auto offsets = [this]() {
+    std::vector<std::ptrdiff_t> result;
+    for (int i = 0; i < 6; ++i) result.push_back(GetOffset(i));
+    return result;
+  };
+
+  resize(1000);
+  Execute(0, 10);
+  const std::vector<std::ptrdiff_t> large_offsets = offsets();
+  const std::intptr_t base_pointer = planner_->BasePointer(kTfLiteArenaRw);
+
+  resize(8);
+  CHECK(planner_->ResetAllocations() == kTfLiteOk);
+  Execute(0, 10);
+  const std::vector<std::ptrdiff_t> small_offsets = offsets();
+  EXPECT_NE(small_offsets, large_offsets);
+
+  // Switching back and forth reuses both the cached plans and the arena.
+  resize(1000);
+  CHECK(planner_->ResetAllocations() == kTfLiteOk);
+  Execute(0, 10);
+  EXPECT_EQ(offsets(), large_offsets);
+  EXPECT_EQ(planner_->BasePointer(kTfLiteArenaRw), base_pointer);
+
+  resize(8);
+  CHECK(planner_->ResetAllocations() == kTfLiteOk);
+  Execute(0, 10);
+  EXPECT_EQ(offsets(), small_offsets);
+  EXPECT_EQ(planner_->BasePointer(kTfLiteArenaRw), base_pointer);
+}
+
+TEST_F(ArenaPlannerTest, CachedPlanAfterStepwiseAllocation) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph, /*preserve_inputs=*/false, /*max_cached_plans=*/1);
+
+  Execute(0, 10);
+  const std::ptrdiff_t offset = GetOffset(5);
+
+  // Stepwise allocations are not cached, and don't affect the cached plan.
+  CHECK(planner_->ResetAllocations() == kTfLiteOk);
+  (*graph.tensors())[2].bytes = 100;
+  Execute(0, 0);
+  Execute(1, 10);
+  EXPECT_NE(GetOffset(5), offset);
+
+  (*graph.tensors())[2].bytes = 3 * 3;
+  CHECK(planner_->ResetAllocations() == kTfLiteOk);
+  Execute(0, 10);
+  EXPECT_EQ(GetOffset(5), offset);
+}
+
 }  // namespace
 }  // namespace tflite
 
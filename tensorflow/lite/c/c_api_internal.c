@@ -99,12 +99,25 @@ void TfLiteQuantizationFree(TfLiteQuantization* quantization) {
   quantization->type = kTfLiteNoQuantization;
 }
 
+void TfLiteBlockSparsityFree(TfLiteBlockSparsity* sparsity) {
+  if (sparsity == NULL) {
+    return;
+  }
+  if (sparsity->block_shape) TfLiteIntArrayFree(sparsity->block_shape);
+  if (sparsity->row_segments) TfLiteIntArrayFree(sparsity->row_segments);
+  if (sparsity->col_indices) TfLiteIntArrayFree(sparsity->col_indices);
+  free(sparsity);
+}
+
 void TfLiteTensorFree(TfLiteTensor* t) {
   TfLiteTensorDataFree(t);
   if (t->dims) TfLiteIntArrayFree(t->dims);
   t->dims = NULL;
 
   TfLiteQuantizationFree(&t->quantization);
+
+  TfLiteBlockSparsityFree(t->sparsity);
+  t->sparsity = NULL;
 }
 
 void TfLiteTensorReset(TfLiteType type, const char* name, TfLiteIntArray* dims,
@@ -48,7 +48,8 @@ typedef enum {
   kTfLiteGemmLowpContext = 1,    // include gemm_support.h to use.
   kTfLiteEdgeTpuContext = 2,     // Placeholder for Edge TPU support.
   kTfLiteCpuBackendContext = 3,  // include cpu_backend_support.h to use.
-  kTfLiteMaxExternalContexts = 4
+  kTfLiteSharedConstantsContext = 4,  // include shared_constants_context.h.
+  kTfLiteMaxExternalContexts = 5
 } TfLiteExternalContextType;
 
 // Forward declare so dependent structs and methods can reference these types
@@ -261,6 +262,18 @@ typedef struct {
   int32_t quantized_dimension;
 } TfLiteAffineQuantization;
 
+// Block compressed sparse row encoding of a constant tensor, seen as a matrix
+// whose rows are its first dimension. Only the blocks holding a nonzero value
+// are stored, one after the other in row-major order. The nonzero blocks of
+// block row i are those in [row_segments[i], row_segments[i + 1]), and
+// col_indices holds the block column of each of them.
+typedef struct {
+  // The number of rows and columns of a block.
+  TfLiteIntArray* block_shape;
+  TfLiteIntArray* row_segments;
+  TfLiteIntArray* col_indices;
+} TfLiteBlockSparsity;
+
 // A union of pointers that points to memory for a given tensor.
 typedef union {
   int32_t* i32;
@@ -349,6 +362,12 @@ typedef struct {
 
   // Quantization information. Replaces params field above.
   TfLiteQuantization quantization;
+
+  // The encoding of a sparse tensor, or NULL if the tensor is dense. If set,
+  // `data` only holds the values described by it, while `dims` is still the
+  // shape of the dense tensor. Owned by the tensor.
+  // WARNING: This is an experimental interface that is subject to change.
+  TfLiteBlockSparsity* sparsity;
 } TfLiteTensor;
 
 // Free data memory of tensor `t`.
@@ -357,6 +376,9 @@ void TfLiteTensorDataFree(TfLiteTensor* t);
 // Free quantization data.
 void TfLiteQuantizationFree(TfLiteQuantization* quantization);
 
+// Free block sparsity data.
+void TfLiteBlockSparsityFree(TfLiteBlockSparsity* sparsity);
+
 // Free memory of tensor `t`.
 void TfLiteTensorFree(TfLiteTensor* t);
 
@@ -482,6 +504,14 @@ typedef struct TfLiteContext {
 
   // Pointer to the op-level profiler, if set; nullptr otherwise.
   void* profiler;
+
+  // Flag for keeping the data of constant tensors where the model holds it
+  // (e.g. in the memory-mapped flatbuffer): when set, kernels avoid creating
+  // per-interpreter copies of constant tensors in another layout, even at the
+  // cost of a slower kernel.
+  // default: false.
+  // WARNING: This is an experimental API and subject to change.
+  bool keep_constants_in_place;
 } TfLiteContext;
 
 typedef struct TfLiteRegistration {
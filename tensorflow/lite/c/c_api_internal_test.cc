@@ -94,6 +94,7 @@ TEST(Quantization, TestQuantizationFree) {
   // Set these values, otherwise TfLiteTensorFree has uninitialized values.
   t.allocation_type = kTfLiteArenaRw;
   t.dims = nullptr;
+  t.sparsity = nullptr;
   t.quantization.type = kTfLiteAffineQuantization;
   auto* params = reinterpret_cast<TfLiteAffineQuantization*>(
       malloc(sizeof(TfLiteAffineQuantization)));
@@ -103,6 +104,19 @@ TEST(Quantization, TestQuantizationFree) {
   TfLiteTensorFree(&t);
 }
 
+TEST(Sparsity, TestBlockSparsityFree) {
+  TfLiteTensor t = {};
+  t.allocation_type = kTfLiteArenaRw;
+  auto* sparsity = reinterpret_cast<TfLiteBlockSparsity*>(
+      malloc(sizeof(TfLiteBlockSparsity)));
+  sparsity->block_shape = TfLiteIntArrayCreate(2);
+  sparsity->row_segments = TfLiteIntArrayCreate(3);
+  sparsity->col_indices = TfLiteIntArrayCreate(2);
+  t.sparsity = sparsity;
+  TfLiteTensorFree(&t);
+  EXPECT_EQ(t.sparsity, nullptr);
+}
+
 }  // namespace tflite
 
 int main(int argc, char** argv) {
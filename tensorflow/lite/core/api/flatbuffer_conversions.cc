@@ -127,6 +127,80 @@ TfLiteStatus ConvertTensorType(TensorType tensor_type, TfLiteType* type,
   return kTfLiteOk;
 }
 
+TfLiteStatus ConvertBlockSparsity(const BlockSparsity& src, int num_dims,
+                                  const int* dims,
+                                  TfLiteBlockSparsity** sparsity,
+                                  int* num_values,
+                                  ErrorReporter* error_reporter) {
+  *sparsity = nullptr;
+  auto report_error = [error_reporter](const char* message) {
+    error_reporter->Report("Invalid block sparsity: %s.\n", message);
+    return kTfLiteError;
+  };
+  if (num_dims < 2) {
+    return report_error("sparse tensors must have at least 2 dimensions");
+  }
+  const int rows = dims[0];
+  int cols = 1;
+  for (int i = 1; i < num_dims; ++i) {
+    cols *= dims[i];
+  }
+
+  const auto* block_shape = src.block_shape();
+  const auto* row_segments = src.row_segments();
+  const auto* col_indices = src.col_indices();
+  if (!block_shape || block_shape->size() != 2) {
+    return report_error("block_shape must have 2 entries");
+  }
+  const int block_rows = block_shape->Get(0);
+  const int block_cols = block_shape->Get(1);
+  if (block_rows <= 0 || block_cols <= 0 || rows % block_rows != 0 ||
+      cols % block_cols != 0) {
+    return report_error("block_shape must divide the shape of the tensor");
+  }
+  const int num_block_rows = rows / block_rows;
+  const int num_block_cols = cols / block_cols;
+  const int num_blocks = col_indices ? col_indices->size() : 0;
+  if (!row_segments ||
+      static_cast<int>(row_segments->size()) != num_block_rows + 1 ||
+      row_segments->Get(0) != 0 ||
+      row_segments->Get(num_block_rows) != num_blocks) {
+    return report_error("row_segments does not match col_indices");
+  }
+  for (int i = 0; i < num_block_rows; ++i) {
+    const int begin = row_segments->Get(i);
+    const int end = row_segments->Get(i + 1);
+    if (begin > end) {
+      return report_error("row_segments must be non-decreasing");
+    }
+    for (int j = begin; j < end; ++j) {
+      const int col = col_indices->Get(j);
+      if (col < 0 || col >= num_block_cols ||
+          (j > begin && col <= col_indices->Get(j - 1))) {
+        return report_error(
+            "col_indices must be increasing and in range in each block row");
+      }
+    }
+  }
+
+  auto copy = [](const flatbuffers::Vector<int32_t>* src) {
+    const int size = src ? src->size() : 0;
+    TfLiteIntArray* result = TfLiteIntArrayCreate(size);
+    for (int i = 0; i < size; ++i) {
+      result->data[i] = src->Get(i);
+    }
+    return result;
+  };
+  TfLiteBlockSparsity* result =
+      static_cast<TfLiteBlockSparsity*>(malloc(sizeof(TfLiteBlockSparsity)));
+  result->block_shape = copy(block_shape);
+  result->row_segments = copy(row_segments);
+  result->col_indices = copy(col_indices);
+  *sparsity = result;
+  *num_values = num_blocks * block_rows * block_cols;
+  return kTfLiteOk;
+}
+
 // Parse the appropriate data out of the op.
 //
 // This handles builtin data explicitly as there are flatbuffer schemas.
@@ -63,6 +63,17 @@ TfLiteStatus ParseOpData(const Operator* op, BuiltinOperator op_type,
 TfLiteStatus ConvertTensorType(TensorType tensor_type, TfLiteType* type,
                                ErrorReporter* error_reporter);
 
+// Converts the block sparsity of a tensor of shape `dims` to the
+// representation used by the runtime, after checking that it is consistent
+// with that shape. On success, `sparsity` must be released with
+// TfLiteBlockSparsityFree() and `num_values` is the number of values the
+// tensor's buffer must hold.
+TfLiteStatus ConvertBlockSparsity(const BlockSparsity& src, int num_dims,
+                                  const int* dims,
+                                  TfLiteBlockSparsity** sparsity,
+                                  int* num_values,
+                                  ErrorReporter* error_reporter);
+
 }  // namespace tflite
 
 #endif  // TENSORFLOW_LITE_CORE_API_FLATBUFFER_CONVERSIONS_H_
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/lite/core/api/flatbuffer_conversions.h"
 
 #include <cstring>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -161,6 +162,33 @@ TEST_F(FlatbufferConversionsTest, TestConvertTensorTypeFloat16) {
   EXPECT_EQ(kTfLiteFloat16, type);
 }
 
+TEST_F(FlatbufferConversionsTest, TestConvertBlockSparsity) {
+  const std::vector<int32_t> block_shape = {2, 2};
+  const std::vector<int32_t> row_segments = {0, 1, 3};
+  const std::vector<int32_t> col_indices = {1, 0, 1};
+  builder_.Finish(CreateBlockSparsityDirect(builder_, &block_shape,
+                                            &row_segments, &col_indices));
+  const auto* src =
+      flatbuffers::GetRoot<BlockSparsity>(builder_.GetBufferPointer());
+
+  const int dims[] = {4, 4};
+  TfLiteBlockSparsity* sparsity = nullptr;
+  int num_values = 0;
+  ASSERT_EQ(kTfLiteOk, ConvertBlockSparsity(*src, 2, dims, &sparsity,
+                                            &num_values, &mock_reporter_));
+  EXPECT_EQ(12, num_values);
+  EXPECT_EQ(3, sparsity->col_indices->size);
+  EXPECT_EQ(0, sparsity->col_indices->data[1]);
+  EXPECT_EQ(3, sparsity->row_segments->size);
+  TfLiteBlockSparsityFree(sparsity);
+
+  // A [6, 4] tensor has one more block row.
+  const int bad_dims[] = {6, 4};
+  EXPECT_EQ(kTfLiteError, ConvertBlockSparsity(*src, 2, bad_dims, &sparsity,
+                                               &num_values, &mock_reporter_));
+  EXPECT_EQ(nullptr, sparsity);
+}
+
 }  // namespace tflite
 
 int main(int argc, char** argv) {
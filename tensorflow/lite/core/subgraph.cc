@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/lite/core/subgraph.h"
 
 #include <algorithm>
+#include <set>
 
 #include "tensorflow/lite/arena_planner.h"
 #include "tensorflow/lite/c/c_api_internal.h"
@@ -40,6 +41,13 @@ struct TfLiteQuantizationDeleter {
 using ScopedTfLiteQuantization =
     std::unique_ptr<TfLiteQuantization, TfLiteQuantizationDeleter>;
 
+struct TfLiteBlockSparsityDeleter {
+  void operator()(TfLiteBlockSparsity* s) { TfLiteBlockSparsityFree(s); }
+};
+
+using ScopedTfLiteBlockSparsity =
+    std::unique_ptr<TfLiteBlockSparsity, TfLiteBlockSparsityDeleter>;
+
 TfLiteStatus ReportOpError(TfLiteContext* context, const TfLiteNode& node,
                            const TfLiteRegistration& registration,
                            int node_index, const char* message) {
@@ -116,6 +124,10 @@ TfLiteQuantizationParams GetLegacyQuantization(
   return legacy_quantization;
 }
 
+// The cpu backend context of the node running on this thread as part of a
+// group of concurrent nodes, which overrides the one of the subgraph.
+thread_local TfLiteExternalContext* inter_op_cpu_backend_context = nullptr;
+
 }  // namespace
 
 // A trivial implementation of GraphInfo around the Interpreter.
@@ -150,6 +162,9 @@ class InterpreterInfo : public GraphInfo {
   const std::vector<int>& variables() const override {
     return subgraph_->variables();
   }
+  size_t node_group_end(size_t index) const override {
+    return subgraph_->node_group_end(index);
+  }
 
  public:
   Subgraph* subgraph_;
@@ -176,6 +191,7 @@ Subgraph::Subgraph(ErrorReporter* error_reporter,
   context_.GetExternalContext = GetExternalContext;
   context_.SetExternalContext = SetExternalContext;
   context_.profiler = nullptr;
+  context_.keep_constants_in_place = false;
 
   // Reserve some space for the tensors to avoid excessive resizing.
   tensors_.reserve(kTensorsReservedCapacity);
@@ -365,6 +381,9 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
 
 TfLiteExternalContext* Subgraph::GetExternalContext(
     TfLiteExternalContextType type) {
+  if (type == kTfLiteCpuBackendContext && inter_op_cpu_backend_context) {
+    return inter_op_cpu_backend_context;
+  }
   if (static_cast<int>(type) >= 0 && type < kTfLiteMaxExternalContexts) {
     return external_contexts_[type];
   }
@@ -438,6 +457,79 @@ void Subgraph::SetCancellationFunction(void* data,
   check_cancelled_func_ = check_cancelled_func;
 }
 
+void Subgraph::SetAllowInterOpParallelism(bool allow) {
+  if (allow_inter_op_parallelism_ == allow) return;
+  allow_inter_op_parallelism_ = allow;
+  // The memory plan depends on the groups of nodes.
+  if (memory_planner_) {
+    state_ = kStateUninvokable;
+    PlanNodeGroups();
+    memory_planner_->PlanAllocations();
+  }
+}
+
+void Subgraph::PlanNodeGroups() {
+  node_group_ends_.clear();
+  if (!allow_inter_op_parallelism_) return;
+
+  // Delegate nodes and nodes using variable tensors may have side effects
+  // that are not visible through their outputs.
+  auto can_be_grouped = [this](const TfLiteNode& node) {
+    if (node.delegate != nullptr) return false;
+    for (const TfLiteIntArray* tensors : {node.inputs, node.outputs}) {
+      for (int tensor_index : TfLiteIntArrayView(tensors)) {
+        if (tensor_index != kOptionalTensor &&
+            tensors_[tensor_index].is_variable) {
+          return false;
+        }
+      }
+    }
+    return true;
+  };
+
+  node_group_ends_.resize(execution_plan_.size());
+  for (size_t first = 0; first < execution_plan_.size();) {
+    size_t last = first;
+    const TfLiteNode& first_node =
+        nodes_and_registration_[execution_plan_[first]].first;
+    if (can_be_grouped(first_node)) {
+      // The outputs of the nodes of the group, and all the tensors they use.
+      std::set<int> outputs, used;
+      auto add_to_group = [&](const TfLiteNode& node) {
+        for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+          if (tensor_index != kOptionalTensor) used.insert(tensor_index);
+        }
+        for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+          if (tensor_index == kOptionalTensor) continue;
+          outputs.insert(tensor_index);
+          used.insert(tensor_index);
+        }
+      };
+      auto is_independent = [&](const TfLiteNode& node) {
+        for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+          if (outputs.count(tensor_index)) return false;
+        }
+        for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+          if (used.count(tensor_index)) return false;
+        }
+        return true;
+      };
+      add_to_group(first_node);
+      while (last + 1 < execution_plan_.size()) {
+        const TfLiteNode& node =
+            nodes_and_registration_[execution_plan_[last + 1]].first;
+        if (!can_be_grouped(node) || !is_independent(node)) break;
+        add_to_group(node);
+        ++last;
+      }
+    }
+    for (size_t i = first; i <= last; ++i) {
+      node_group_ends_[i] = last;
+    }
+    first = last + 1;
+  }
+}
+
 void Subgraph::ReserveNodes(int count) {
   nodes_and_registration_.reserve(count);
 }
@@ -687,6 +779,7 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
     memory_planner_.reset(new ArenaPlanner(
         &context_, std::unique_ptr<GraphInfo>(new InterpreterInfo(this)),
         /*preserve_inputs=*/true, /*preserve_intermediates*/ false));
+    PlanNodeGroups();
     memory_planner_->PlanAllocations();
   }
 
@@ -735,6 +828,20 @@ TfLiteStatus Subgraph::Invoke() {
       TF_LITE_ENSURE(&context_, next_execution_plan_index_to_prepare_ >=
                                     execution_plan_index);
     }
+
+    // Independent nodes run concurrently once all the tensors have their
+    // final size.
+    const int group_end =
+        static_cast<int>(node_group_end(execution_plan_index));
+    if (group_end > execution_plan_index && !has_dynamic_tensors_ &&
+        next_execution_plan_index_to_prepare_ ==
+            static_cast<int>(execution_plan_.size()) &&
+        !profiler_ && context_.recommended_num_threads > 1) {
+      TF_LITE_ENSURE_STATUS(InvokeNodeGroup(execution_plan_index, group_end));
+      execution_plan_index = group_end;
+      continue;
+    }
+
     int node_index = execution_plan_[execution_plan_index];
     TfLiteNode& node = nodes_and_registration_[node_index].first;
     const TfLiteRegistration& registration =
@@ -797,6 +904,86 @@ TfLiteStatus Subgraph::Invoke() {
   return status;
 }
 
+TfLiteStatus Subgraph::InvokeNodeGroup(int first_execution_plan_index,
+                                       int last_execution_plan_index) {
+  const int num_nodes =
+      last_execution_plan_index - first_execution_plan_index + 1;
+  const int num_tasks = std::min(num_nodes, context_.recommended_num_threads);
+
+  for (int execution_plan_index = first_execution_plan_index;
+       execution_plan_index <= last_execution_plan_index;
+       ++execution_plan_index) {
+    const TfLiteNode& node =
+        nodes_and_registration_[execution_plan_[execution_plan_index]].first;
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index == kOptionalTensor) {
+        continue;
+      }
+      TfLiteTensor* tensor = &tensors_[tensor_index];
+      if (tensor->delegate && tensor->data_is_stale) {
+        TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+      }
+    }
+  }
+
+  if (check_cancelled_func_ != nullptr &&
+      check_cancelled_func_(cancellation_data_)) {
+    ReportError("Client requested cancel during Invoke()");
+    return kTfLiteError;
+  }
+
+  // Each task runs its share of the nodes with a cpu backend context of its
+  // own, as the gemm contexts are not thread-safe. The shared one is not used,
+  // so that ops running subgraphs do not reenter its threadpool.
+  while (inter_op_backend_contexts_.size() < static_cast<size_t>(num_tasks)) {
+    inter_op_backend_contexts_.emplace_back(new ExternalCpuBackendContext());
+  }
+  auto* cpu_backend_context = static_cast<ExternalCpuBackendContext*>(
+      GetExternalContext(kTfLiteCpuBackendContext));
+  if (cpu_backend_context) {
+    for (auto& backend_context : inter_op_backend_contexts_) {
+      backend_context->set_cpu_affinity(cpu_backend_context->cpu_affinity());
+    }
+  }
+  EnsureTensorsVectorCapacity();
+  tensor_resized_since_op_invoke_ = false;
+  std::vector<TfLiteStatus> statuses(num_nodes, kTfLiteOk);
+  auto task = [&](int task_index) {
+    TfLiteExternalContext* previous_context = inter_op_cpu_backend_context;
+    TfLiteExternalContext* backend_context =
+        inter_op_backend_contexts_[task_index].get();
+    inter_op_cpu_backend_context = backend_context;
+    backend_context->Refresh(&context_);
+    for (int i = task_index; i < num_nodes; i += num_tasks) {
+      const int node_index =
+          execution_plan_[first_execution_plan_index + i];
+      statuses[i] = OpInvoke(nodes_and_registration_[node_index].second,
+                             &nodes_and_registration_[node_index].first);
+    }
+    inter_op_cpu_backend_context = previous_context;
+  };
+
+  if (cpu_backend_context &&
+      cpu_backend_context->internal_backend_context()) {
+    cpu_backend_context->internal_backend_context()->ExecuteTasks(num_tasks,
+                                                                  task);
+  } else {
+    for (int task_index = 0; task_index < num_tasks; ++task_index) {
+      task(task_index);
+    }
+  }
+
+  for (int i = 0; i < num_nodes; ++i) {
+    if (statuses[i] == kTfLiteError) {
+      const int node_index = execution_plan_[first_execution_plan_index + i];
+      return ReportOpError(&context_, nodes_and_registration_[node_index].first,
+                           nodes_and_registration_[node_index].second,
+                           node_index, "failed to invoke");
+    }
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
@@ -879,9 +1066,10 @@ TfLiteStatus Subgraph::GetNodeAndRegistration(
 TfLiteStatus Subgraph::SetTensorParametersReadOnly(
     int tensor_index, TfLiteType type, const char* name, const size_t rank,
     const int* dims, TfLiteQuantization quantization, const char* buffer,
-    size_t bytes, const Allocation* allocation) {
-  // Ensure quantization cleanup on failure.
+    size_t bytes, const Allocation* allocation, TfLiteBlockSparsity* sparsity) {
+  // Ensure quantization and sparsity cleanup on failure.
   ScopedTfLiteQuantization scoped_quantization(&quantization);
+  ScopedTfLiteBlockSparsity scoped_sparsity(sparsity);
   if (state_ == kStateInvokableAndImmutable) {
     ReportError(
         "SetTensorParametersReadOnly is disallowed when graph is immutable.");
@@ -895,8 +1083,17 @@ TfLiteStatus Subgraph::SetTensorParametersReadOnly(
   // because their sizes change with the contents of the individual strings.
   if (type != kTfLiteString) {
     size_t required_bytes;
-    TF_LITE_ENSURE_OK(&context_,
-                      BytesRequired(type, dims, rank, &required_bytes));
+    if (sparsity) {
+      // Only the values of the nonzero blocks are stored.
+      const int num_values = sparsity->col_indices->size *
+                             sparsity->block_shape->data[0] *
+                             sparsity->block_shape->data[1];
+      TF_LITE_ENSURE_OK(&context_,
+                        BytesRequired(type, &num_values, 1, &required_bytes));
+    } else {
+      TF_LITE_ENSURE_OK(&context_,
+                        BytesRequired(type, dims, rank, &required_bytes));
+    }
     TF_LITE_ENSURE_EQ(&context_, required_bytes, bytes);
   }
 
@@ -910,6 +1107,8 @@ TfLiteStatus Subgraph::SetTensorParametersReadOnly(
     if (!tensor.dims) tensor.dims = ConvertArrayToTfLiteIntArray(rank, dims);
     tensor.params = GetLegacyQuantization(quantization);
     tensor.quantization = *scoped_quantization.release();
+    TfLiteBlockSparsityFree(tensor.sparsity);
+    tensor.sparsity = scoped_sparsity.release();
     tensor.allocation_type = kTfLiteMmapRo;
     tensor.allocation = allocation;
   } else {
@@ -921,6 +1120,7 @@ TfLiteStatus Subgraph::SetTensorParametersReadOnly(
     // TODO(suharshs): Update TfLiteTensorReset to include the new quantization
     // if there are other required callers.
     tensor.quantization = *scoped_quantization.release();
+    tensor.sparsity = scoped_sparsity.release();
   }
   return kTfLiteOk;
 }
@@ -1105,6 +1305,7 @@ TfLiteStatus Subgraph::RedoAllDelegates() {
 TfLiteStatus Subgraph::EnsureMemoryAllocations() {
   if (memory_planner_) {
     state_ = kStateUninvokable;
+    PlanNodeGroups();
     TF_LITE_ENSURE_OK(&context_, memory_planner_->PlanAllocations());
   }
   TF_LITE_ENSURE_OK(&context_, AllocateTensors());
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstdlib>
 #include <map>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -25,6 +26,7 @@ limitations under the License.
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/delegates/nnapi/nnapi_delegate.h"
 #include "tensorflow/lite/experimental/resource_variable/resource_variable.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/util.h"
 
@@ -91,19 +93,22 @@ class Subgraph {
   // This variant assumes an external buffer has been allocated of size
   // bytes. The lifetime of buffer must be ensured to be greater or equal
   // to Interpreter. `quantization` ownership is passed to the subgraph.
+  // If `sparsity` is not null, the tensor is sparse and `buffer` only holds
+  // the values it describes. Its ownership is passed to the subgraph too.
   inline TfLiteStatus SetTensorParametersReadOnly(
       int tensor_index, TfLiteType type, const char* name,
       const std::vector<int>& dims, TfLiteQuantization quantization,
-      const char* buffer, size_t bytes,
-      const Allocation* allocation = nullptr) {
+      const char* buffer, size_t bytes, const Allocation* allocation = nullptr,
+      TfLiteBlockSparsity* sparsity = nullptr) {
     return SetTensorParametersReadOnly(tensor_index, type, name, dims.size(),
                                        dims.data(), quantization, buffer, bytes,
-                                       allocation);
+                                       allocation, sparsity);
   }
   TfLiteStatus SetTensorParametersReadOnly(
       int tensor_index, TfLiteType type, const char* name, const size_t rank,
       const int* dims, TfLiteQuantization quantization, const char* buffer,
-      size_t bytes, const Allocation* allocation = nullptr);
+      size_t bytes, const Allocation* allocation = nullptr,
+      TfLiteBlockSparsity* sparsity = nullptr);
 
   // Set description of inputs/outputs/data/fptrs for node `node_index`.
   // This variant assumes an external buffer has been allocated of size
@@ -251,6 +256,27 @@ class Subgraph {
   // WARNING: This is an experimental API and subject to change.
   void SetCancellationFunction(void* data, bool (*check_cancelled_func)(void*));
 
+  // Allows Invoke() to run independent nodes of the execution plan
+  // concurrently, on the threads of the cpu backend context. Consecutive nodes
+  // of the plan that do not depend on each other form a group, and the memory
+  // plan keeps the tensors of a group apart. Concurrent nodes use cpu backend
+  // contexts of their own. Nodes run one at a time when the graph has dynamic
+  // tensors, when a profiler is set or with fewer than two threads. Delegate
+  // nodes and nodes using variable tensors always run on their own. Kernels
+  // must not share mutable state other than through their tensors.
+  // default: not allow.
+  // WARNING: This is an experimental API and subject to change.
+  void SetAllowInterOpParallelism(bool allow);
+
+  // Returns the index in the execution plan of the last node of the group
+  // containing the node at 'execution_plan_index'. See
+  // SetAllowInterOpParallelism().
+  size_t node_group_end(size_t execution_plan_index) const {
+    return execution_plan_index < node_group_ends_.size()
+               ? node_group_ends_[execution_plan_index]
+               : execution_plan_index;
+  }
+
   // Ensure the data in `tensor.data` is readable. In case delegate is used,
   // it might require to copy the data from delegate buffer to raw memory.
   // WARNING: This is an experimental API and subject to change.
@@ -508,6 +534,16 @@ class Subgraph {
   // Ensures the memory required is planned and allocated.
   TfLiteStatus EnsureMemoryAllocations();
 
+  // Splits the execution plan into groups of consecutive independent nodes
+  // and stores them in `node_group_ends_`. Must be called before the memory
+  // planner plans allocations.
+  void PlanNodeGroups();
+
+  // Invokes the nodes of the execution plan in [first_execution_plan_index,
+  // last_execution_plan_index], which form a group, concurrently.
+  TfLiteStatus InvokeNodeGroup(int first_execution_plan_index,
+                               int last_execution_plan_index);
+
   // The state of the Interpreter.
   enum State {
     // The interpreter isn't ready to be invoked.
@@ -633,6 +669,18 @@ class Subgraph {
   // A map of resource variables. Owned by interpreter and shared by multiple
   // subgraphs.
   ResourceVariableMap* resource_variables_ = nullptr;
+
+  // Whether independent nodes may run concurrently.
+  bool allow_inter_op_parallelism_ = false;
+
+  // For each node of the execution plan, the execution plan index of the last
+  // node of its group. Empty when every node is a group of its own.
+  std::vector<size_t> node_group_ends_;
+
+  // The cpu backend contexts used by the nodes of a group running
+  // concurrently, one per thread.
+  std::vector<std::unique_ptr<ExternalCpuBackendContext>>
+      inter_op_backend_contexts_;
 };
 
 }  // namespace tflite
@@ -0,0 +1,87 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/cpu_topology.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace tflite {
+
+std::vector<int64_t> GetCpuMaxFrequencies() {
+  std::vector<int64_t> frequencies;
+#ifdef __linux__
+  const long num_cpus = sysconf(_SC_NPROCESSORS_CONF);
+  bool any_known = false;
+  for (long cpu = 0; cpu < num_cpus; ++cpu) {
+    char path[128];
+    snprintf(path, sizeof(path),
+             "/sys/devices/system/cpu/cpu%ld/cpufreq/cpuinfo_max_freq", cpu);
+    long long frequency = 0;
+    if (FILE* file = fopen(path, "r")) {
+      if (fscanf(file, "%lld", &frequency) != 1) frequency = 0;
+      fclose(file);
+    }
+    any_known |= frequency > 0;
+    frequencies.push_back(frequency);
+  }
+  if (!any_known) frequencies.clear();
+#endif
+  return frequencies;
+}
+
+std::vector<int> GetBigCpus() {
+  const std::vector<int64_t> frequencies = GetCpuMaxFrequencies();
+  int64_t slowest = 0;
+  for (int64_t frequency : frequencies) {
+    if (frequency > 0 && (slowest == 0 || frequency < slowest)) {
+      slowest = frequency;
+    }
+  }
+  std::vector<int> big_cpus;
+  std::vector<int> known_cpus;
+  for (int cpu = 0; cpu < static_cast<int>(frequencies.size()); ++cpu) {
+    if (frequencies[cpu] > slowest) big_cpus.push_back(cpu);
+    if (frequencies[cpu] > 0) known_cpus.push_back(cpu);
+  }
+  return big_cpus.empty() ? known_cpus : big_cpus;
+}
+
+int GetCpuSpeedRatioLog2(const std::vector<int>& cpus) {
+  const std::vector<int64_t> frequencies = GetCpuMaxFrequencies();
+  int64_t slowest = 0;
+  int64_t fastest = 0;
+  const int num_cpus = cpus.empty() ? frequencies.size() : cpus.size();
+  for (int i = 0; i < num_cpus; ++i) {
+    const int cpu = cpus.empty() ? i : cpus[i];
+    if (cpu < 0 || cpu >= static_cast<int>(frequencies.size()) ||
+        frequencies[cpu] == 0) {
+      continue;
+    }
+    slowest = slowest == 0 ? frequencies[cpu]
+                           : std::min(slowest, frequencies[cpu]);
+    fastest = std::max(fastest, frequencies[cpu]);
+  }
+  int ratio_log2 = 0;
+  while (slowest > 0 && (slowest << ratio_log2) < fastest) {
+    ++ratio_log2;
+  }
+  return ratio_log2;
+}
+
+}  // namespace tflite
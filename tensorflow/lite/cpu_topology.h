@@ -0,0 +1,42 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CPU_TOPOLOGY_H_
+#define TENSORFLOW_LITE_CPU_TOPOLOGY_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace tflite {
+
+// Returns the maximum frequency, in kHz, of each CPU indexed by CPU number, as
+// reported by Linux cpufreq, with 0 for the CPUs whose frequency is unknown.
+// Returns an empty vector if cpufreq is not available.
+std::vector<int64_t> GetCpuMaxFrequencies();
+
+// Returns the CPUs that are faster than the slowest ones, i.e. the big cores of
+// an ARM big.LITTLE CPU, judging by their maximum frequency. Returns all CPUs
+// if they are all alike, and an empty vector if their frequencies are unknown.
+std::vector<int> GetBigCpus();
+
+// Returns ceil(log2(f_max / f_min)), where f_max and f_min are the highest and
+// lowest maximum frequencies of the given CPUs, or of all CPUs if `cpus` is
+// empty. This is a lower bound of how much faster threads may run on some of
+// these CPUs than on others, as little cores also do less work per cycle.
+// Returns 0 if the frequencies are unknown.
+int GetCpuSpeedRatioLog2(const std::vector<int>& cpus);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CPU_TOPOLOGY_H_
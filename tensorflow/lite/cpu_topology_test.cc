@@ -0,0 +1,56 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/cpu_topology.h"
+
+#include <vector>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace {
+
+// The topology depends on the machine running the test, so these only check
+// that the results are consistent with each other.
+TEST(CpuTopology, BigCpusHaveKnownFrequencies) {
+  const std::vector<int64_t> frequencies = GetCpuMaxFrequencies();
+  const std::vector<int> big_cpus = GetBigCpus();
+  if (frequencies.empty()) {
+    EXPECT_TRUE(big_cpus.empty());
+    return;
+  }
+  EXPECT_FALSE(big_cpus.empty());
+  for (int cpu : big_cpus) {
+    ASSERT_GE(cpu, 0);
+    ASSERT_LT(cpu, frequencies.size());
+    EXPECT_GT(frequencies[cpu], 0);
+  }
+}
+
+TEST(CpuTopology, SpeedRatio) {
+  EXPECT_GE(GetCpuSpeedRatioLog2({}), 0);
+  // The big CPUs are no more different from each other than all CPUs are.
+  EXPECT_LE(GetCpuSpeedRatioLog2(GetBigCpus()), GetCpuSpeedRatioLog2({}));
+  // A single CPU has the same speed as itself, and unknown CPUs are ignored.
+  EXPECT_EQ(GetCpuSpeedRatioLog2({0}), 0);
+  EXPECT_EQ(GetCpuSpeedRatioLog2({-1, 1 << 20}), 0);
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
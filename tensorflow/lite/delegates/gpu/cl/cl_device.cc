@@ -351,6 +351,14 @@ std::string CLDevice::GetPlatformVersion() const {
   return GetPlatformInfo(platform_id_, CL_PLATFORM_VERSION);
 }
 
+std::string CLDevice::GetDeviceName() const {
+  return GetDeviceInfo<std::string>(id_, CL_DEVICE_NAME);
+}
+
+std::string CLDevice::GetDriverVersion() const {
+  return GetDeviceInfo<std::string>(id_, CL_DRIVER_VERSION);
+}
+
 bool CLDevice::IsAdreno() const { return info_.vendor == Vendor::QUALCOMM; }
 
 bool CLDevice::IsAdreno3xx() const {
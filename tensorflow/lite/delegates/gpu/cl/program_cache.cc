@@ -93,12 +93,19 @@ Status ProgramCache::AddSerializedCache(
   }
 
   auto model = data::GetCompiledCache(serialized_cache.data());
-  std::string platform_version(model->driver_version()->c_str(),
-                               model->driver_version()->size());
-
-  if (device.GetPlatformVersion() != platform_version) {
+  auto matches = [](const flatbuffers::String* serialized,
+                    const std::string& expected) {
+    return serialized && serialized->str() == expected;
+  };
+  if (!matches(model->driver_version(), device.GetPlatformVersion()) ||
+      !matches(model->device_name(), device.GetDeviceName()) ||
+      !matches(model->device_driver_version(), device.GetDriverVersion())) {
     return InvalidArgumentError(
-        "OpenCL driver changed, cache invalid, should be regenerated");
+        "OpenCL device or driver changed, cache invalid, should be "
+        "regenerated");
+  }
+  if (!model->programs()) {
+    return OkStatus();
   }
 
   use_fingerprints_ = true;
@@ -133,10 +140,14 @@ Status ProgramCache::GetSerializedCache(
     serialized_programs.push_back(program_builder.Finish());
   }
   auto driver_version = builder.CreateString(device.GetPlatformVersion());
+  auto device_name = builder.CreateString(device.GetDeviceName());
+  auto device_driver_version = builder.CreateString(device.GetDriverVersion());
   auto programs_s = builder.CreateVector(serialized_programs);
   data::CompiledCacheBuilder cache_builder(builder);
   cache_builder.add_driver_version(driver_version);
   cache_builder.add_programs(programs_s);
+  cache_builder.add_device_name(device_name);
+  cache_builder.add_device_driver_version(device_driver_version);
   data::FinishCompiledCacheBuffer(builder, cache_builder.Finish());
   size_t next_element = serialized_cache->size();
   serialized_cache->resize(serialized_cache->size() + builder.GetSize());
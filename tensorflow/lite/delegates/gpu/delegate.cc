@@ -16,7 +16,10 @@ limitations under the License.
 #include "tensorflow/lite/delegates/gpu/delegate.h"
 
 #include <cstdint>
+#include <cstdio>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "absl/types/span.h"
@@ -40,10 +43,58 @@ namespace {
 // Forward declarations.
 TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate);
 
+// Reads the whole file, leaving `data` empty if it cannot be read.
+void ReadFile(const char* path, std::vector<uint8_t>* data) {
+  data->clear();
+  FILE* file = fopen(path, "rb");
+  if (!file) return;
+  if (fseek(file, 0, SEEK_END) == 0) {
+    const long size = ftell(file);
+    if (size > 0 && fseek(file, 0, SEEK_SET) == 0) {
+      data->resize(size);
+      if (fread(data->data(), 1, size, file) != static_cast<size_t>(size)) {
+        data->clear();
+      }
+    }
+  }
+  fclose(file);
+}
+
+// Replaces the file with `data`. It is written to a temporary file first, so
+// that a concurrent reader never sees a partially written file.
+Status WriteFile(const char* path, const std::vector<uint8_t>& data) {
+  const std::string temp_path = std::string(path) + ".tmp";
+  FILE* file = fopen(temp_path.c_str(), "wb");
+  if (!file) {
+    return UnavailableError("Could not open " + temp_path);
+  }
+  const bool written =
+      fwrite(data.data(), 1, data.size(), file) == data.size();
+  if (fclose(file) != 0 || !written ||
+      rename(temp_path.c_str(), path) != 0) {
+    remove(temp_path.c_str());
+    return UnavailableError(std::string("Could not write ") + path);
+  }
+  return OkStatus();
+}
+
 class Delegate {
  public:
   explicit Delegate(const TfLiteGpuDelegateOptionsV2* options) {
     options_ = options ? *options : TfLiteGpuDelegateOptionsV2Default();
+    if (options_.serialized_binary_cache_path) {
+      serialized_binary_cache_path_ = options_.serialized_binary_cache_path;
+      options_.serialized_binary_cache_path = nullptr;
+    }
+  }
+
+  Status BindGlBufferToTensor(GLuint buffer, int tensor_index) {
+    if (runner_) {
+      return FailedPreconditionError(
+          "Buffers must be bound before the delegate is applied.");
+    }
+    gl_buffers_[tensor_index] = OpenGlBuffer(buffer);
+    return OkStatus();
   }
 
   Status Prepare(TfLiteContext* context,
@@ -82,6 +133,7 @@ class Delegate {
     if (!status.ok()) {
       context->ReportError(context, "%s", status.error_message().c_str());
       context->ReportError(context, "Falling back to OpenGL");
+      cl_environment_.reset();
       RETURN_IF_ERROR(InitializeOpenGlApi(&graph, &builder));
     }
 
@@ -102,7 +154,9 @@ class Delegate {
                                                   GetObjectDef(tensor_index)));
     }
 
-    return builder->Build(&runner_);
+    RETURN_IF_ERROR(builder->Build(&runner_));
+    SaveSerializedBinaryCache();
+    return OkStatus();
   }
 
   Status SetInputsAndOutputs(TfLiteContext* context) {
@@ -128,12 +182,18 @@ class Delegate {
     ObjectDef default_object_def;
     default_object_def.data_type = DataType::FLOAT32;
     default_object_def.data_layout = DataLayout::BHWC;
-    default_object_def.object_type = ObjectType::CPU_MEMORY;
+    default_object_def.object_type = gl_buffers_.count(index)
+                                         ? ObjectType::OPENGL_SSBO
+                                         : ObjectType::CPU_MEMORY;
     default_object_def.user_provided = true;
     return default_object_def;
   }
 
   TensorObject GetTensorObject(int index, TfLiteContext* context) const {
+    auto it = gl_buffers_.find(index);
+    if (it != gl_buffers_.end()) {
+      return it->second;
+    }
     auto& tensor = context->tensors[index];
     return MakeCpuMemory(absl::MakeSpan(tensor.data.raw, tensor.bytes));
   }
@@ -144,6 +204,22 @@ class Delegate {
   Status InitializeOpenClApi(GraphFloat32* graph,
                              std::unique_ptr<InferenceBuilder>* builder) {
     cl::InferenceEnvironmentOptions env_options;
+    if (!gl_buffers_.empty()) {
+      // Bound GL buffers are shared with OpenCL, which requires an OpenCL
+      // context created for the caller's GL context. Reads and writes of the
+      // shared buffers are then synchronized with GL through EGL fences.
+      env_options.egl_display = eglGetCurrentDisplay();
+      env_options.egl_context = eglGetCurrentContext();
+      if (!env_options.IsGlAware()) {
+        return FailedPreconditionError(
+            "GL buffers are bound, but no GL context is current.");
+      }
+    }
+    if (!serialized_binary_cache_path_.empty()) {
+      ReadFile(serialized_binary_cache_path_.c_str(),
+               &serialized_binary_cache_);
+      env_options.serialized_binary_cache = serialized_binary_cache_;
+    }
     cl::InferenceEnvironmentProperties properties;
     RETURN_IF_ERROR(cl::NewInferenceEnvironment(env_options, &cl_environment_,
                                                 &properties));
@@ -177,6 +253,21 @@ class Delegate {
     return OkStatus();
   }
 
+  // Stores the programs compiled by the OpenCL environment, unless the file
+  // already holds the same ones. Failing to do so only affects later inits.
+  void SaveSerializedBinaryCache() {
+    if (!cl_environment_ || serialized_binary_cache_path_.empty()) return;
+    const std::vector<uint8_t> data =
+        cl_environment_->GetSerializedBinaryCache();
+    if (data.empty() || data == serialized_binary_cache_) return;
+    const Status status =
+        WriteFile(serialized_binary_cache_path_.c_str(), data);
+    if (!status.ok()) {
+      TFLITE_LOG_PROD(tflite::TFLITE_LOG_WARNING, "%s",
+                      status.error_message().c_str());
+    }
+  }
+
   TfLiteDelegate delegate_ = {
       reinterpret_cast<void*>(this),  // .data_
       DelegatePrepare,                // .Prepare
@@ -187,6 +278,11 @@ class Delegate {
   };
 
   TfLiteGpuDelegateOptionsV2 options_;
+  // The serialized binary cache file and the contents read from it at init.
+  std::string serialized_binary_cache_path_;
+  std::vector<uint8_t> serialized_binary_cache_;
+  // GL buffers bound to input and output tensors, by tensor index.
+  std::unordered_map<int, OpenGlBuffer> gl_buffers_;
   std::unique_ptr<cl::InferenceEnvironment> cl_environment_;
   std::unique_ptr<gl::InferenceEnvironment> gl_environment_;
   std::unique_ptr<InferenceRunner> runner_;
@@ -265,6 +361,7 @@ TfLiteGpuDelegateOptionsV2 TfLiteGpuDelegateOptionsV2Default() {
   options.is_precision_loss_allowed = 0;
   options.inference_preference =
       TFLITE_GPU_INFERENCE_PREFERENCE_FAST_SINGLE_ANSWER;
+  options.serialized_binary_cache_path = nullptr;
   return options;
 }
 
@@ -279,3 +376,13 @@ TfLiteDelegate* TfLiteGpuDelegateV2Create(
 void TfLiteGpuDelegateV2Delete(TfLiteDelegate* delegate) {
   delete tflite::gpu::GetDelegate(delegate);
 }
+
+TfLiteStatus TfLiteGpuDelegateV2BindGlBufferToTensor(TfLiteDelegate* delegate,
+                                                     GLuint buffer,
+                                                     int tensor_index) {
+  auto* gpu_delegate = tflite::gpu::GetDelegate(delegate);
+  return gpu_delegate &&
+                 gpu_delegate->BindGlBufferToTensor(buffer, tensor_index).ok()
+             ? kTfLiteOk
+             : kTfLiteError;
+}
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <stdint.h>
 
+#include <GLES3/gl31.h>
 #include "tensorflow/lite/c/c_api_internal.h"
 
 #ifdef SWIG
@@ -61,11 +62,20 @@ typedef struct {
 
   // Preference is defined in TfLiteGpuInferencePreference.
   int32_t inference_preference;
+
+  // When set, compiled OpenCL programs are loaded from this file at init and
+  // the file is rewritten with the programs compiled for the model, so that
+  // later delegates using the same file skip kernel compilation. Programs
+  // stored for another device or driver version are discarded. The file must
+  // be writable by the app, e.g. in its cache directory. Ignored when the
+  // delegate falls back to OpenGL.
+  const char* serialized_binary_cache_path;
 } TfLiteGpuDelegateOptionsV2;
 
 // Populates TfLiteGpuDelegateOptionsV2 as follows:
 //   is_precision_loss_allowed = false
 //   inference_preference = TFLITE_GPU_INFERENCE_PREFERENCE_FAST_SINGLE_ANSWER
+//   serialized_binary_cache_path = nullptr
 TFL_CAPI_EXPORT TfLiteGpuDelegateOptionsV2 TfLiteGpuDelegateOptionsV2Default();
 
 // Creates a new delegate instance that need to be destroyed with
@@ -81,6 +91,21 @@ TFL_CAPI_EXPORT TfLiteDelegate* TfLiteGpuDelegateV2Create(
 // Destroys a delegate created with `TfLiteGpuDelegateV2Create` call.
 TFL_CAPI_EXPORT void TfLiteGpuDelegateV2Delete(TfLiteDelegate* delegate);
 
+// Binds GL shader storage buffer object to an input or an output tensor, so
+// that the delegate reads the input from, or writes the output to, the buffer
+// instead of the tensor's CPU memory. The buffer holds the float32 elements of
+// the tensor in BHWC order and is not owned by the delegate.
+//
+// The GL context the buffer belongs to must be current on the thread calling
+// `Interpreter::ModifyGraphWithDelegate` and `Interpreter::Invoke`. GL commands
+// issued before Invoke are complete before the delegate reads an input buffer,
+// and the delegate's writes to the output buffers are complete when Invoke
+// returns.
+//
+// *** Must be called *before* `Interpreter::ModifyGraphWithDelegate`. ***
+TFL_CAPI_EXPORT TfLiteStatus TfLiteGpuDelegateV2BindGlBufferToTensor(
+    TfLiteDelegate* delegate, GLuint buffer, int tensor_index);
+
 #ifdef __cplusplus
 }
 #endif  // __cplusplus
@@ -22,6 +22,7 @@ limitations under the License.
 #include <functional>
 #include <initializer_list>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <memory>
 #include <string>
@@ -48,6 +49,7 @@ limitations under the License.
 #include "tensorflow/lite/context_util.h"
 #include "tensorflow/lite/delegates/nnapi/nnapi_delegate_kernel.h"
 #include "tensorflow/lite/delegates/nnapi/quant_lstm_sup.h"
+#include "tensorflow/lite/delegates/utils.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/minimal_logging.h"
 #include "tensorflow/lite/nnapi/nnapi_implementation.h"
@@ -1152,6 +1154,14 @@ inline bool ExpectOpVersion(int curr_version, int max_version,
                    "OP Version different from %d", max_version);
 }
 
+inline bool ExpectDenseFilter(const TfLiteContext* context,
+                              const TfLiteNode* node,
+                              OpValidationContext* val_ctx) {
+  const auto& filter = context->tensors[node->inputs->data[1]];
+  return Expect(filter.sparsity == nullptr, "Sparse filters are not supported",
+                val_ctx);
+}
+
 inline bool ExpectIsFloatOperator(const TfLiteContext* context,
                                   const TfLiteNode* node,
                                   OpValidationContext* val_ctx) {
@@ -1283,6 +1293,7 @@ bool NNAPIDelegateKernel::Validate(const TfLiteContext* context,
     } break;
     case kTfLiteBuiltinConv2d: {
       ExpectMaxOpVersion(version, 3, &val_ctx);
+      ExpectDenseFilter(context, node, &val_ctx);
       if (android_sdk_version < kMinSdkVersionForNNAPI12) {
         Expect(!IsHybridOperator(context, builtin_code, node),
                "Hybrid operators not supported before NNAPI 1.2", &val_ctx);
@@ -1340,6 +1351,7 @@ bool NNAPIDelegateKernel::Validate(const TfLiteContext* context,
       Expect(
           node->inputs->size == 3 && node->inputs->data[2] != kOptionalTensor,
           "FullyConnected with no bias not supported", &val_ctx);
+      ExpectDenseFilter(context, node, &val_ctx);
       const auto output_type = context->tensors[node->outputs->data[0]].type;
       Expect(output_type != kTfLiteInt16,
              "Unsupported output of type kTfLiteInt16", &val_ctx);
@@ -2852,6 +2864,16 @@ TfLiteStatus NNAPIDelegateKernel::Init(TfLiteContext* context,
     RETURN_TFLITE_ERROR_IF_NN_ERROR(context, finish_result, nnapi_errno);
     nn_compilation_.reset(compilation);
   }
+
+  if (!nn_burst_ && delegate_options.use_burst_computation &&
+      nnapi_->android_sdk_version >= kMinSdkVersionForNNAPI12) {
+    ANeuralNetworksBurst* burst = nullptr;
+    RETURN_TFLITE_ERROR_IF_NN_ERROR(
+        context,
+        nnapi_->ANeuralNetworksBurst_create(nn_compilation_.get(), &burst),
+        nnapi_errno);
+    nn_burst_.reset(burst);
+  }
   return kTfLiteOk;
 }
 
@@ -3018,6 +3040,15 @@ TfLiteStatus NNAPIDelegateKernel::Invoke(TfLiteContext* context,
     const int wait_result = nnapi_->ANeuralNetworksEvent_wait(event);
     nnapi_->ANeuralNetworksEvent_free(event);
     RETURN_TFLITE_ERROR_IF_NN_ERROR(context, wait_result, nnapi_errno);
+  } else if (nn_burst_) {
+    // An execution can only be computed once, but the burst keeps the memory
+    // pools of the inputs and outputs mapped in the driver, as they are bound
+    // to the same shared memory on every invocation.
+    RETURN_TFLITE_ERROR_IF_NN_ERROR(
+        context,
+        nnapi_->ANeuralNetworksExecution_burstCompute(execution,
+                                                      nn_burst_.get()),
+        nnapi_errno);
   } else {
     // Use synchronous execution for NNAPI 1.2+.
     RETURN_TFLITE_ERROR_IF_NN_ERROR(
@@ -3462,8 +3493,11 @@ using ::tflite::delegate::nnapi::NNAPIDelegateKernel;
 
 StatefulNnApiDelegate::StatefulNnApiDelegate(Options options)
     : TfLiteDelegate(TfLiteDelegateCreate()),
-      delegate_data_(
-          Data{.execution_preference = options.execution_preference}) {
+      delegate_data_(Data{
+          .execution_preference = options.execution_preference,
+          .min_partition_size = options.min_partition_size,
+          .use_partition_cost_model = options.use_partition_cost_model,
+          .use_burst_computation = options.use_burst_computation}) {
   if (options.accelerator_name) {
     delegate_data_.accelerator_name = options.accelerator_name;
   }
@@ -3499,6 +3533,9 @@ const StatefulNnApiDelegate::Options StatefulNnApiDelegate::GetOptions(
   options.model_token = delegate_data->model_token.empty()
                             ? nullptr
                             : delegate_data->model_token.c_str();
+  options.min_partition_size = delegate_data->min_partition_size;
+  options.use_partition_cost_model = delegate_data->use_partition_cost_model;
+  options.use_burst_computation = delegate_data->use_burst_computation;
   return options;
 }
 
@@ -3633,6 +3670,25 @@ TfLiteStatus StatefulNnApiDelegate::DoPrepare(TfLiteContext* context,
   // First element in vector must be the number of actual nodes.
   supported_nodes[0] = supported_nodes.size() - 1;
 
+  const Options options = GetOptions(delegate);
+  if (supported_nodes[0] &&
+      (options.min_partition_size > 1 || options.use_partition_cost_model)) {
+    delegates::SubsetCostModel model;
+    model.min_subset_size = options.min_partition_size;
+    if (!options.use_partition_cost_model) {
+      // Only the size of the partitions matters.
+      model.delegate_speedup = std::numeric_limits<float>::infinity();
+      model.transfer_cost_per_byte = 0.0f;
+      model.invoke_cost = 0.0f;
+    }
+    std::vector<int> nodes(supported_nodes.begin() + 1, supported_nodes.end());
+    TF_LITE_ENSURE_STATUS(
+        delegates::PruneUnprofitableSubsets(context, model, &nodes));
+    supported_nodes.resize(1);
+    supported_nodes.insert(supported_nodes.end(), nodes.begin(), nodes.end());
+    supported_nodes[0] = nodes.size();
+  }
+
   // If there are no delegated nodes, short-circuit node replacement.
   if (!supported_nodes[0]) {
     return kTfLiteOk;
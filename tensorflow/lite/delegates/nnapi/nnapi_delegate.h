@@ -63,6 +63,26 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
     // NOTE: when using compilation caching, it is not recommended to use the
     // same delegate instance for multiple models.
     const char* model_token = nullptr;
+
+    // The minimum number of nodes of a partition delegated to NNAPI; smaller
+    // partitions run on the CPU.
+    // Default to 1, which delegates all the partitions.
+    int min_partition_size = 1;
+
+    // Whether to only delegate the partitions that the cost model of
+    // delegates::PruneUnprofitableSubsets() expects to run at least as fast
+    // on NNAPI, including the copies of their inputs and outputs.
+    // Default to false, which delegates all the partitions.
+    bool use_partition_cost_model = false;
+
+    // Whether to run the delegated partitions with NNAPI burst computation
+    // (ANeuralNetworksBurst), which reuses the same channel to the driver and
+    // lets it cache the memory pools of the inputs and outputs across
+    // invocations. This reduces the latency of models invoked repeatedly,
+    // e.g. on the frames of a video. Only supported from Android 10 (NNAPI
+    // 1.2); ignored before.
+    // Default to false.
+    bool use_burst_computation = false;
   };
 
   // Uses default options.
@@ -131,6 +151,12 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
     std::string cache_dir;
     // The unique token string for NNAPI model.
     std::string model_token;
+    // The minimum number of nodes of a delegated partition.
+    int min_partition_size;
+    // Whether to only delegate the partitions that pay off.
+    bool use_partition_cost_model;
+    // Whether to use burst computation.
+    bool use_burst_computation;
     // Tensor to ANeuralNetworksMemory mapping.
     std::vector<MemoryRegistration> tensor_memory_map;
     // Constains a non zero value if any NNAPI method call
@@ -0,0 +1,133 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/c_api_internal.h"
+#include "tensorflow/lite/delegates/nnapi/nnapi_delegate.h"
+#include "tensorflow/lite/delegates/nnapi/nnapi_delegate_mock_test.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/nnapi/NeuralNetworksTypes.h"
+#include "tensorflow/lite/nnapi/nnapi_implementation.h"
+
+namespace tflite {
+namespace {
+
+class FloatAddOpModel : public SingleOpModel {
+ public:
+  FloatAddOpModel(const TensorData& input1, const TensorData& input2,
+                  const TensorData& output,
+                  StatefulNnApiDelegate::Options options) {
+    stateful_delegate_.reset(new StatefulNnApiDelegate(options));
+    auto* delegate = stateful_delegate_.get();
+    SetApplyDelegate([delegate](Interpreter* interpreter) {
+      interpreter->ModifyGraphWithDelegate(delegate);
+    });
+    input1_ = AddInput(input1);
+    input2_ = AddInput(input2);
+    output_ = AddOutput(output);
+    SetBuiltinOp(
+        BuiltinOperator_ADD, BuiltinOptions_AddOptions,
+        CreateAddOptions(builder_, ActivationFunctionType_NONE).Union());
+    BuildInterpreter({GetShape(input1_), GetShape(input2_)});
+  }
+
+  int input1() { return input1_; }
+  int input2() { return input2_; }
+
+  TfLiteStatus InvokeWithoutAssert() { return interpreter_->Invoke(); }
+
+ private:
+  std::unique_ptr<StatefulNnApiDelegate> stateful_delegate_;
+  int input1_;
+  int input2_;
+  int output_;
+};
+
+struct NnApiBurstTest : ::tflite::delegate::nnapi::NnApiDelegateMockTest {
+  void SetUp() override {
+    NnApiDelegateMockTest::SetUp();
+    bursts_created = 0;
+    burst_computations = 0;
+    computations = 0;
+    nnapi_->ANeuralNetworksBurst_create =
+        [](ANeuralNetworksCompilation* compilation,
+           ANeuralNetworksBurst** burst) {
+          ++bursts_created;
+          *burst = reinterpret_cast<ANeuralNetworksBurst*>(1);
+          return 0;
+        };
+    nnapi_->ANeuralNetworksExecution_burstCompute =
+        [](ANeuralNetworksExecution* execution, ANeuralNetworksBurst* burst) {
+          ++burst_computations;
+          return 0;
+        };
+    nnapi_->ANeuralNetworksExecution_compute =
+        [](ANeuralNetworksExecution* execution) {
+          ++computations;
+          return 0;
+        };
+  }
+
+  // Invokes a model with 'options' 3 times.
+  void InvokeThreeTimes(StatefulNnApiDelegate::Options options) {
+    FloatAddOpModel m({TensorType_FLOAT32, {1, 2, 2, 1}},
+                      {TensorType_FLOAT32, {1, 2, 2, 1}},
+                      {TensorType_FLOAT32, {}}, options);
+    m.PopulateTensor<float>(m.input1(), {-2.0, 0.2, 0.7, 0.8});
+    m.PopulateTensor<float>(m.input2(), {0.1, 0.2, 0.3, 0.5});
+    for (int i = 0; i < 3; ++i) {
+      ASSERT_EQ(m.InvokeWithoutAssert(), kTfLiteOk);
+    }
+  }
+
+  static int bursts_created;
+  static int burst_computations;
+  static int computations;
+};
+
+int NnApiBurstTest::bursts_created;
+int NnApiBurstTest::burst_computations;
+int NnApiBurstTest::computations;
+
+TEST_F(NnApiBurstTest, ReusesBurstAcrossInvocations) {
+  StatefulNnApiDelegate::Options options;
+  options.use_burst_computation = true;
+  StatefulNnApiDelegate delegate(options);
+  EXPECT_TRUE(
+      StatefulNnApiDelegate::GetOptions(&delegate).use_burst_computation);
+  InvokeThreeTimes(options);
+
+  EXPECT_EQ(bursts_created, 1);
+  EXPECT_EQ(burst_computations, 3);
+  EXPECT_EQ(computations, 0);
+}
+
+TEST_F(NnApiBurstTest, DoesNotUseBurstByDefault) {
+  InvokeThreeTimes(StatefulNnApiDelegate::Options());
+
+  EXPECT_EQ(bursts_created, 0);
+  EXPECT_EQ(burst_computations, 0);
+  EXPECT_EQ(computations, 3);
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
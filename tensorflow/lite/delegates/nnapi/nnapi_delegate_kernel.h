@@ -124,6 +124,12 @@ struct NNFreeCompilation {
     NnApiImplementation()->ANeuralNetworksCompilation_free(model);
   }
 };
+// RAII NN API Burst Destructor for use with std::unique_ptr
+struct NNFreeBurst {
+  void operator()(ANeuralNetworksBurst* burst) {
+    NnApiImplementation()->ANeuralNetworksBurst_free(burst);
+  }
+};
 
 // Manage NNAPI shared memory handle
 class NNMemory {
@@ -224,6 +230,9 @@ class NNAPIDelegateKernel {
   std::unique_ptr<ANeuralNetworksModel, NNFreeModel> nn_model_;
   std::unique_ptr<ANeuralNetworksCompilation, NNFreeCompilation>
       nn_compilation_;
+  // Burst object shared by all the invocations, if burst computation is
+  // enabled. Declared after the compilation, which must outlive it.
+  std::unique_ptr<ANeuralNetworksBurst, NNFreeBurst> nn_burst_;
   // Node indices that this delegate is responsible for. Indices here
   // indexes into the nodes array in the TfLiteContext.
   std::vector<int> nodes_;
@@ -154,6 +154,24 @@ class NnApiMock {
         [](ANeuralNetworksExecution* execution) { return Value; };
   }
 
+  template <int Value>
+  void BurstCreateReturns() {
+    nnapi_->ANeuralNetworksBurst_create =
+        [](ANeuralNetworksCompilation* compilation,
+           ANeuralNetworksBurst** burst) {
+          *burst = reinterpret_cast<ANeuralNetworksBurst*>(1);
+          return Value;
+        };
+  }
+
+  template <int Value>
+  void ExecutionBurstComputeReturns() {
+    nnapi_->ANeuralNetworksExecution_burstCompute =
+        [](ANeuralNetworksExecution* execution, ANeuralNetworksBurst* burst) {
+          return Value;
+        };
+  }
+
   explicit NnApiMock(NnApi* nnapi, int android_sdk_version = 29)
       : nnapi_(nnapi), prev_nnapi_(*nnapi) {
     nnapi_->nnapi_exists = true;
@@ -165,6 +183,7 @@ class NnApiMock {
     nnapi_->ANeuralNetworksModel_free = [](ANeuralNetworksModel* model) {};
     nnapi_->ANeuralNetworksExecution_free =
         [](ANeuralNetworksExecution* execution) {};
+    nnapi_->ANeuralNetworksBurst_free = [](ANeuralNetworksBurst* burst) {};
     nnapi_->ASharedMemory_create = [](const char* name, size_t size) -> int {
       return open("/dev/zero", O_RDWR);
     };
@@ -184,6 +203,8 @@ class NnApiMock {
     ExecutionSetInputFromMemoryReturns<0>();
     ExecutionSetOutputFromMemoryReturns<0>();
     ExecutionComputeReturns<0>();
+    BurstCreateReturns<0>();
+    ExecutionBurstComputeReturns<0>();
   }
 
   ~NnApiMock() {
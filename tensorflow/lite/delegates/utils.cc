@@ -16,11 +16,96 @@ limitations under the License.
 #include "tensorflow/lite/delegates/utils.h"
 
 #include <algorithm>
+#include <cstdint>
 
+#include "tensorflow/lite/builtin_ops.h"
 #include "tensorflow/lite/c/c_api_internal.h"
+#include "tensorflow/lite/graph_info.h"
 
 namespace tflite {
 namespace delegates {
+namespace {
+
+// Presents the nodes of the execution plan of a TfLiteContext as a graph, for
+// the partitioner of the interpreter.
+class ExecutionPlanInfo : public GraphInfo {
+ public:
+  ExecutionPlanInfo(TfLiteContext* context, const TfLiteIntArray* plan)
+      : context_(context), plan_(plan) {}
+
+  // Looks up the nodes of the plan, and the outputs of the graph they form.
+  TfLiteStatus Init() {
+    std::vector<bool> consumed(context_->tensors_size, false);
+    std::vector<bool> produced(context_->tensors_size, false);
+    for (int i = 0; i < plan_->size; ++i) {
+      TfLiteNode* node;
+      TfLiteRegistration* registration;
+      TF_LITE_ENSURE_STATUS(context_->GetNodeAndRegistration(
+          context_, plan_->data[i], &node, &registration));
+      nodes_.push_back(node);
+      registrations_.push_back(registration);
+      for (int j = 0; j < node->inputs->size; ++j) {
+        if (node->inputs->data[j] != kOptionalTensor) {
+          consumed[node->inputs->data[j]] = true;
+        }
+      }
+      for (int j = 0; j < node->outputs->size; ++j) {
+        produced[node->outputs->data[j]] = true;
+      }
+    }
+    // The context does not know the outputs of the graph; the tensors that no
+    // node consumes are the best guess.
+    for (int i = 0; i < context_->tensors_size; ++i) {
+      if (produced[i] && !consumed[i]) outputs_.push_back(i);
+    }
+    return kTfLiteOk;
+  }
+
+  const TfLiteRegistration& registration(size_t index) const {
+    return *registrations_[index];
+  }
+
+  size_t num_tensors() const override { return context_->tensors_size; }
+  TfLiteTensor* tensor(size_t index) override {
+    return &context_->tensors[index];
+  }
+  size_t num_nodes() const override { return nodes_.size(); }
+  const TfLiteNode& node(size_t index) const override {
+    return *nodes_[index];
+  }
+  size_t node_index(size_t index) const override {
+    return plan_->data[index];
+  }
+  const std::vector<int>& inputs() const override { return inputs_; }
+  const std::vector<int>& outputs() const override { return outputs_; }
+  const std::vector<int>& variables() const override { return variables_; }
+
+ private:
+  TfLiteContext* context_;
+  const TfLiteIntArray* plan_;
+  std::vector<TfLiteNode*> nodes_;
+  std::vector<TfLiteRegistration*> registrations_;
+  std::vector<int> inputs_;
+  std::vector<int> outputs_;
+  std::vector<int> variables_;
+};
+
+int64_t NumElements(const TfLiteTensor& tensor) {
+  if (!tensor.dims) return 0;
+  int64_t count = 1;
+  for (int i = 0; i < tensor.dims->size; ++i) count *= tensor.dims->data[i];
+  return count;
+}
+
+// Returns the product of dimensions 'begin' to 'end' (excluded) of 'tensor'.
+int64_t DimsProduct(const TfLiteTensor& tensor, int begin, int end) {
+  if (!tensor.dims || tensor.dims->size < end) return 1;
+  int64_t product = 1;
+  for (int i = begin; i < end; ++i) product *= tensor.dims->data[i];
+  return product;
+}
+
+}  // namespace
 
 TfLiteStatus PruneContinuousSubsets(TfLiteContext* context,
                                     const int max_subsets,
@@ -66,5 +151,115 @@ TfLiteStatus PruneContinuousSubsets(TfLiteContext* context,
   return kTfLiteOk;
 }
 
+float EstimateNodeCost(const TfLiteContext* context, const TfLiteNode& node,
+                       const TfLiteRegistration& registration) {
+  auto input = [&](int i) -> const TfLiteTensor& {
+    return context->tensors[node.inputs->data[i]];
+  };
+  int64_t output_elements = 0;
+  for (int i = 0; i < node.outputs->size; ++i) {
+    output_elements += NumElements(context->tensors[node.outputs->data[i]]);
+  }
+  switch (registration.builtin_code) {
+    case kTfLiteBuiltinConv2d:
+      // Filters are [output_depth, height, width, input_depth].
+      return output_elements * DimsProduct(input(1), 1, 4);
+    case kTfLiteBuiltinDepthwiseConv2d:
+      // Filters are [1, height, width, output_depth].
+      return output_elements * DimsProduct(input(1), 1, 3);
+    case kTfLiteBuiltinFullyConnected:
+      // Weights are [num_units, input_size].
+      return output_elements * DimsProduct(input(1), 1, 2);
+    case kTfLiteBuiltinTransposeConv:
+      // Weights are [output_depth, height, width, input_depth], and every
+      // element of the input is multiplied by the filters of all outputs.
+      return NumElements(input(2)) * DimsProduct(input(1), 0, 3);
+    default:
+      // Element-wise ops and the like; about one operation per output.
+      return output_elements;
+  }
+}
+
+TfLiteStatus PruneUnprofitableSubsets(TfLiteContext* context,
+                                      const SubsetCostModel& model,
+                                      std::vector<int>* indices) {
+  if (!indices) {
+    context->ReportError(context, "indices cannot be nullptr");
+    return kTfLiteError;
+  }
+  if (indices->empty()) return kTfLiteOk;
+
+  TfLiteIntArray* plan;
+  TF_LITE_ENSURE_STATUS(context->GetExecutionPlan(context, &plan));
+  ExecutionPlanInfo info(context, plan);
+  TF_LITE_ENSURE_STATUS(info.Init());
+
+  // The partitioner identifies nodes by their position in the plan.
+  std::vector<int> position_of_node;
+  for (int i = 0; i < plan->size; ++i) {
+    const int node_index = plan->data[i];
+    if (node_index >= position_of_node.size()) {
+      position_of_node.resize(node_index + 1, -1);
+    }
+    position_of_node[node_index] = i;
+  }
+  std::vector<int> positions(1);
+  for (const int idx : *indices) {
+    if (idx < 0 || idx >= position_of_node.size() ||
+        position_of_node[idx] < 0) {
+      context->ReportError(context, "Node %d is not in the execution plan",
+                           idx);
+      return kTfLiteError;
+    }
+    positions.push_back(position_of_node[idx]);
+  }
+  // First element in vector must be the number of actual nodes.
+  positions[0] = positions.size() - 1;
+  std::vector<NodeSubset> node_subsets;
+  PartitionGraphIntoIndependentNodeSubsets(
+      &info, reinterpret_cast<TfLiteIntArray*>(positions.data()),
+      &node_subsets);
+
+  indices->clear();
+  for (const NodeSubset& subset : node_subsets) {
+    if (subset.type != NodeSubset::kTfPartition ||
+        subset.nodes.size() < model.min_subset_size) {
+      continue;
+    }
+    double compute_cost = 0;
+    for (const int node_index : subset.nodes) {
+      auto measured = model.measured_node_costs.find(node_index);
+      if (measured != model.measured_node_costs.end()) {
+        compute_cost += measured->second;
+      } else {
+        const int position = position_of_node[node_index];
+        compute_cost += EstimateNodeCost(context, info.node(position),
+                                         info.registration(position));
+      }
+    }
+    // Constant inputs are copied to the delegate once, when it is prepared.
+    int64_t transfer_bytes = 0;
+    for (const int tensor_index : subset.input_tensors) {
+      const TfLiteTensor& tensor = context->tensors[tensor_index];
+      if (tensor.allocation_type != kTfLiteMmapRo) {
+        transfer_bytes += tensor.bytes;
+      }
+    }
+    for (const int tensor_index : subset.output_tensors) {
+      transfer_bytes += context->tensors[tensor_index].bytes;
+    }
+    const double saving = compute_cost * (1.0 - 1.0 / model.delegate_speedup);
+    const double overhead =
+        model.invoke_cost + transfer_bytes * model.transfer_cost_per_byte;
+    if (saving >= overhead) {
+      indices->insert(indices->end(), subset.nodes.begin(),
+                      subset.nodes.end());
+    }
+  }
+  std::sort(indices->begin(), indices->end());
+
+  return kTfLiteOk;
+}
+
 }  // namespace delegates
 }  // namespace tflite
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_DELEGATES_UTILS_H_
 #define TENSORFLOW_LITE_DELEGATES_UTILS_H_
 
+#include <unordered_map>
 #include <vector>
 
 #include "tensorflow/lite/c/c_api_internal.h"
@@ -33,6 +34,40 @@ TfLiteStatus PruneContinuousSubsets(TfLiteContext* context,
                                     const int max_subsets,
                                     std::vector<int>* indices);
 
+// The model PruneUnprofitableSubsets() uses to decide whether delegating a
+// node subset pays off. Costs are counted in multiply-accumulates on the CPU.
+struct SubsetCostModel {
+  // Subsets with fewer nodes than this are not delegated.
+  int min_subset_size = 1;
+  // How many times faster the delegate computes than the CPU.
+  float delegate_speedup = 4.0f;
+  // The cost of copying one byte between the CPU and the delegate.
+  float transfer_cost_per_byte = 1.0f;
+  // The fixed cost of invoking a delegated subset, e.g. of synchronizing
+  // with the accelerator.
+  float invoke_cost = 100000.0f;
+  // The costs of nodes measured on the device (e.g. with a profiler), by node
+  // index. Other nodes get the estimate of EstimateNodeCost().
+  std::unordered_map<int, float> measured_node_costs;
+};
+
+// Returns an estimate of the cost of running 'node' on the CPU, in
+// multiply-accumulates, from its op and the sizes of its tensors.
+float EstimateNodeCost(const TfLiteContext* context, const TfLiteNode& node,
+                       const TfLiteRegistration& registration);
+
+// Given the indices of the nodes of the execution plan that a delegate
+// supports, modifies them in-place to only contain the node subsets that
+// 'model' expects to run at least as fast on the delegate, with the copies of
+// their inputs and outputs between the CPU and the delegate. Subsets are built
+// as in ReplaceNodeSubsetsWithDelegateKernels(). Resulting vector is sorted.
+//
+// This util can be used by delegates to avoid small subsets whose transfers
+// outweigh their gains.
+TfLiteStatus PruneUnprofitableSubsets(TfLiteContext* context,
+                                      const SubsetCostModel& model,
+                                      std::vector<int>* indices);
+
 }  // namespace delegates
 }  // namespace tflite
 
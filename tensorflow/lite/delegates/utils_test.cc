@@ -18,7 +18,9 @@ limitations under the License.
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "tensorflow/lite/builtin_ops.h"
 #include "tensorflow/lite/c/c_api_internal.h"
+#include "tensorflow/lite/interpreter.h"
 
 namespace tflite {
 namespace delegates {
@@ -101,6 +103,110 @@ TEST(UtilsTest, PruneContinuousSubsets_UnsortedIndices) {
   ASSERT_TRUE(indices.empty());
 }
 
+// Builds a chain of 'num_nodes' nodes over float tensors of 'tensor_size'
+// elements: tensor i is the input of node i, and tensor i + 1 its output.
+void BuildChain(int num_nodes, int tensor_size, Interpreter* interpreter) {
+  static TfLiteRegistration registration = {nullptr, nullptr, nullptr,
+                                            nullptr};
+  registration.builtin_code = kTfLiteBuiltinAdd;
+  ASSERT_EQ(interpreter->AddTensors(num_nodes + 1), kTfLiteOk);
+  ASSERT_EQ(interpreter->SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter->SetOutputs({num_nodes}), kTfLiteOk);
+  TfLiteQuantizationParams quant = {0.0f, 0};
+  for (int i = 0; i <= num_nodes; ++i) {
+    ASSERT_EQ(interpreter->SetTensorParametersReadWrite(
+                  i, kTfLiteFloat32, "", {tensor_size}, quant),
+              kTfLiteOk);
+  }
+  for (int i = 0; i < num_nodes; ++i) {
+    ASSERT_EQ(interpreter->AddNodeWithParameters({i}, {i + 1}, nullptr, 0,
+                                                 nullptr, &registration),
+              kTfLiteOk);
+  }
+}
+
+struct PruneArgs {
+  SubsetCostModel model;
+  std::vector<int> indices;
+};
+
+// Returns the nodes of 'supported' that PruneUnprofitableSubsets() keeps, as
+// called by a delegate on 'interpreter'.
+std::vector<int> Prune(Interpreter* interpreter, const SubsetCostModel& model,
+                       const std::vector<int>& supported) {
+  PruneArgs args{model, supported};
+  TfLiteDelegate delegate = TfLiteDelegateCreate();
+  delegate.data_ = &args;
+  delegate.Prepare = [](TfLiteContext* context,
+                        TfLiteDelegate* delegate) -> TfLiteStatus {
+    auto* args = static_cast<PruneArgs*>(delegate->data_);
+    return PruneUnprofitableSubsets(context, args->model, &args->indices);
+  };
+  EXPECT_EQ(interpreter->ModifyGraphWithDelegate(&delegate), kTfLiteOk);
+  return args.indices;
+}
+
+TEST(UtilsTest, PruneUnprofitableSubsets_MeasuredCosts) {
+  Interpreter interpreter;
+  BuildChain(5, 1000, &interpreter);
+  // 2 subsets: (0), (2, 3). Each transfers 8000 bytes.
+  SubsetCostModel model;
+  model.measured_node_costs = {{0, 1e5f}, {2, 1e6f}, {3, 1e6f}};
+  EXPECT_THAT(Prune(&interpreter, model, {0, 2, 3}),
+              ElementsAreArray({2, 3}));
+
+  model.measured_node_costs[0] = 1e6f;
+  EXPECT_THAT(Prune(&interpreter, model, {3, 2, 0}),
+              ElementsAreArray({0, 2, 3}));
+
+  // Only subsets of two nodes or more are delegated.
+  model.min_subset_size = 2;
+  EXPECT_THAT(Prune(&interpreter, model, {0, 2, 3}),
+              ElementsAreArray({2, 3}));
+
+  // Transfers are too expensive for any subset.
+  model.transfer_cost_per_byte = 1000.0f;
+  EXPECT_TRUE(Prune(&interpreter, model, {0, 2, 3}).empty());
+}
+
+TEST(UtilsTest, PruneUnprofitableSubsets_EstimatedCosts) {
+  Interpreter interpreter;
+  BuildChain(3, 1000, &interpreter);
+  // Element-wise nodes are not worth the transfers of their tensors.
+  SubsetCostModel model;
+  EXPECT_TRUE(Prune(&interpreter, model, {0, 1, 2}).empty());
+
+  model.transfer_cost_per_byte = 0.0f;
+  model.invoke_cost = 0.0f;
+  EXPECT_THAT(Prune(&interpreter, model, {0, 1, 2}),
+              ElementsAreArray({0, 1, 2}));
+}
+
+TEST(UtilsTest, EstimateNodeCost) {
+  // A convolution of a 1x8x8x3 input with 16 3x3 filters.
+  int input_dims[] = {4, 1, 8, 8, 3};
+  int filter_dims[] = {4, 16, 3, 3, 3};
+  int output_dims[] = {4, 1, 8, 8, 16};
+  TfLiteTensor tensors[3];
+  tensors[0].dims = reinterpret_cast<TfLiteIntArray*>(input_dims);
+  tensors[1].dims = reinterpret_cast<TfLiteIntArray*>(filter_dims);
+  tensors[2].dims = reinterpret_cast<TfLiteIntArray*>(output_dims);
+  TfLiteContext context;
+  context.tensors = tensors;
+  context.tensors_size = 3;
+  int inputs[] = {2, 0, 1};
+  int outputs[] = {1, 2};
+  TfLiteNode node;
+  node.inputs = reinterpret_cast<TfLiteIntArray*>(inputs);
+  node.outputs = reinterpret_cast<TfLiteIntArray*>(outputs);
+  TfLiteRegistration registration = {nullptr, nullptr, nullptr, nullptr};
+
+  registration.builtin_code = kTfLiteBuiltinConv2d;
+  EXPECT_EQ(EstimateNodeCost(&context, node, registration), 1024 * 27);
+  registration.builtin_code = kTfLiteBuiltinRelu;
+  EXPECT_EQ(EstimateNodeCost(&context, node, registration), 1024);
+}
+
 }  // namespace
 }  // namespace delegates
 }  // namespace tflite
@@ -48,7 +48,8 @@ typedef enum {
   kTfLiteGemmLowpContext = 1,    // include gemm_support.h to use.
   kTfLiteEdgeTpuContext = 2,     // Placeholder for Edge TPU support.
   kTfLiteCpuBackendContext = 3,  // include cpu_backend_support.h to use.
-  kTfLiteMaxExternalContexts = 4
+  kTfLiteSharedConstantsContext = 4,  // include shared_constants_context.h.
+  kTfLiteMaxExternalContexts = 5
 } TfLiteExternalContextType;
 
 // Forward declare so dependent structs and methods can reference these types
@@ -482,6 +483,14 @@ typedef struct TfLiteContext {
 
   // Pointer to the op-level profiler, if set; nullptr otherwise.
   void* profiler;
+
+  // Flag for keeping the data of constant tensors where the model holds it
+  // (e.g. in the memory-mapped flatbuffer): when set, kernels avoid creating
+  // per-interpreter copies of constant tensors in another layout, even at the
+  // cost of a slower kernel.
+  // default: false.
+  // WARNING: This is an experimental API and subject to change.
+  bool keep_constants_in_place;
 } TfLiteContext;
 
 typedef struct TfLiteRegistration {
@@ -15,9 +15,11 @@ limitations under the License.
 
 #include "tensorflow/lite/experimental/kernels/gru_cell.h"
 
+#include <cstring>
 #include <vector>
 
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/lite/kernels/internal/tensor_utils.h"
 
 namespace tflite {
 namespace ops {
@@ -29,6 +31,30 @@ using optimized_ops::FullyConnected;
 using optimized_ops::MapAsArrayWithLastDimAsRows;
 using reference_ops::Concatenation;
 
+namespace {
+
+// result = bias + quantized(vectors) * weight, for each of the 'n_batch'
+// vectors of size 'm_cols'. The vectors are quantized once for all the rows
+// of the weight.
+void HybridFullyConnected(const float* vectors, int n_batch, int m_cols,
+                          const int8_t* weight, float weight_scale, int m_rows,
+                          const float* bias, int8_t* quantized_vectors,
+                          float* scaling_factors, float* result) {
+  float unused_min, unused_max;
+  for (int b = 0; b < n_batch; ++b) {
+    tensor_utils::SymmetricQuantizeFloats(
+        vectors + b * m_cols, m_cols, quantized_vectors + b * m_cols,
+        &unused_min, &unused_max, &scaling_factors[b]);
+    scaling_factors[b] *= weight_scale;
+  }
+  tensor_utils::VectorBatchVectorAssign(bias, m_rows, n_batch, result);
+  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+      weight, m_rows, m_cols, quantized_vectors, scaling_factors, n_batch,
+      result, /*result_stride=*/1);
+}
+
+}  // namespace
+
 void GruCell(const RuntimeShape& input_shape, const float* input,
              const RuntimeShape& state_shape, const float* input_state,
              const RuntimeShape& gate_weight_shape, const float* gate_weight,
@@ -88,6 +114,61 @@ void GruCell(const RuntimeShape& input_shape, const float* input,
   memcpy(output_state, output, n_batch * n_output * sizeof(float));
 }
 
+void GruCell(const RuntimeShape& input_shape, const float* input,
+             const RuntimeShape& state_shape, const float* input_state,
+             const RuntimeShape& gate_weight_shape, const int8_t* gate_weight,
+             float gate_weight_scale, const RuntimeShape& gate_bias_shape,
+             const float* gate_bias,
+             const RuntimeShape& candidate_weight_shape,
+             const int8_t* candidate_weight, float candidate_weight_scale,
+             const RuntimeShape& candidate_bias_shape,
+             const float* candidate_bias, const RuntimeShape& output_shape,
+             float* output, float* output_state,
+             const RuntimeShape& activation_shape, float* activation,
+             const RuntimeShape& concat_shape, float* concat,
+             int8_t* quantized_concat, float* scaling_factors) {
+  const int n_batch = input_shape.Dims(0);
+  const int n_input = input_shape.Dims(1);
+  const int n_output = state_shape.Dims(1);
+  const int n_concat = n_input + n_output;
+
+  // [x h] = concat(input, state)
+  for (int b = 0; b < n_batch; ++b) {
+    memcpy(concat + b * n_concat, input + b * n_input,
+           n_input * sizeof(float));
+    memcpy(concat + b * n_concat + n_input, input_state + b * n_output,
+           n_output * sizeof(float));
+  }
+
+  // [r u] = [x h] * gate_weight + gate_bias
+  HybridFullyConnected(concat, n_batch, n_concat, gate_weight,
+                       gate_weight_scale, 2 * n_output, gate_bias,
+                       quantized_concat, scaling_factors, activation);
+
+  // [r u] = sigmoid([r u])
+  auto ru = MapAsArrayWithLastDimAsRows(activation, activation_shape);
+  ru = ru.unaryExpr(Eigen::internal::scalar_logistic_op<float>());
+  auto r = ru.block(0 * n_output, 0, n_output, n_batch);
+  auto u = ru.block(1 * n_output, 0, n_output, n_batch);
+
+  // hr = h .* r
+  auto h = MapAsArrayWithLastDimAsRows(input_state, state_shape);
+  auto xh = MapAsArrayWithLastDimAsRows(concat, concat_shape);
+  auto hr = xh.block(n_input, 0, n_output, n_batch);
+  hr = h * r;
+
+  // c = [x hr] * candidate_weight + candidate_bias
+  HybridFullyConnected(concat, n_batch, n_concat, candidate_weight,
+                       candidate_weight_scale, n_output, candidate_bias,
+                       quantized_concat, scaling_factors, output);
+
+  auto c = MapAsArrayWithLastDimAsRows(output, output_shape);
+  // output = (1 - u) .* tanh(c) + u .* h
+  c = (1.0 - u) * c.tanh() + u * h;
+
+  memcpy(output_state, output, n_batch * n_output * sizeof(float));
+}
+
 }  // namespace gru_cell
 }  // namespace experimental
 }  // namespace ops
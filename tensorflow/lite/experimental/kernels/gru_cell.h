@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_EXPERIMENTAL_KERNELS_GRU_CELL_H_
 #define TENSORFLOW_LITE_EXPERIMENTAL_KERNELS_GRU_CELL_H_
 
+#include <cstdint>
+
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/tensor.h"
 
@@ -38,6 +40,23 @@ void GruCell(const RuntimeShape& input_shape, const float* input,
              const tflite::FullyConnectedParams& fc_params,
              tflite::CpuBackendContext* cpu_backend_context);
 
+// Same as above but with symmetrically quantized weights. The rows of [x h]
+// and [x hr] are quantized into 'quantized_concat', of the same shape as
+// 'concat', with their scaling factors in 'scaling_factors', of size 'n_batch'.
+void GruCell(const RuntimeShape& input_shape, const float* input,
+             const RuntimeShape& state_shape, const float* input_state,
+             const RuntimeShape& gate_weight_shape, const int8_t* gate_weight,
+             float gate_weight_scale, const RuntimeShape& gate_bias_shape,
+             const float* gate_bias,
+             const RuntimeShape& candidate_weight_shape,
+             const int8_t* candidate_weight, float candidate_weight_scale,
+             const RuntimeShape& candidate_bias_shape,
+             const float* candidate_bias, const RuntimeShape& output_shape,
+             float* output, float* output_state,
+             const RuntimeShape& activation_shape, float* activation,
+             const RuntimeShape& concat_shape, float* concat,
+             int8_t* quantized_concat, float* scaling_factors);
+
 }  // namespace gru_cell
 }  // namespace experimental
 }  // namespace ops
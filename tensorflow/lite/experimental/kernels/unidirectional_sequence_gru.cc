@@ -76,6 +76,60 @@ void GruImpl(const TfLiteTensor* input, const TfLiteTensor* input_state,
   }
 }
 
+void HybridGruImpl(const TfLiteTensor* input, const TfLiteTensor* input_state,
+                   const TfLiteTensor* gate_weight,
+                   const TfLiteTensor* gate_bias,
+                   const TfLiteTensor* candidate_weight,
+                   const TfLiteTensor* candidate_bias, TfLiteTensor* output,
+                   TfLiteTensor* output_state, TfLiteTensor* activation,
+                   TfLiteTensor* concat, TfLiteTensor* quantized_concat,
+                   TfLiteTensor* scaling_factors) {
+  const int n_time = input->dims->data[0];
+  const int n_batch = input->dims->data[1];
+  const int n_input = input->dims->data[2];
+  const int n_output = output->dims->data[2];
+  const int n_batch_input = n_batch * n_input;
+  const int n_batch_output = n_batch * n_output;
+  const RuntimeShape input_shape({n_batch, n_input});
+  const float* input_data = GetTensorData<float>(input);
+  const RuntimeShape state_shape = GetTensorShape(input_state);
+  const float* input_state_data = GetTensorData<float>(input_state);
+  const RuntimeShape gate_weight_shape = GetTensorShape(gate_weight);
+  // Weights quantized to uint8 hold int8 values, see quantize_weights.
+  const int8_t* gate_weight_data =
+      reinterpret_cast<const int8_t*>(gate_weight->data.raw);
+  const RuntimeShape gate_bias_shape = GetTensorShape(gate_bias);
+  const float* gate_bias_data = GetTensorData<float>(gate_bias);
+  const RuntimeShape candidate_weight_shape = GetTensorShape(candidate_weight);
+  const int8_t* candidate_weight_data =
+      reinterpret_cast<const int8_t*>(candidate_weight->data.raw);
+  const RuntimeShape candidate_bias_shape = GetTensorShape(candidate_bias);
+  const float* candidate_bias_data = GetTensorData<float>(candidate_bias);
+  const RuntimeShape activation_shape = GetTensorShape(activation);
+  const RuntimeShape output_shape = RuntimeShape({n_batch, n_output});
+  float* output_data = GetTensorData<float>(output);
+  float* output_state_data = GetTensorData<float>(output_state);
+  float* activation_data = GetTensorData<float>(activation);
+  const RuntimeShape concat_shape = GetTensorShape(concat);
+  float* concat_data = GetTensorData<float>(concat);
+  int8_t* quantized_concat_data =
+      reinterpret_cast<int8_t*>(quantized_concat->data.raw);
+  float* scaling_factors_data = GetTensorData<float>(scaling_factors);
+  for (int i = 0; i < n_time; ++i) {
+    gru_cell::GruCell(
+        input_shape, input_data, state_shape, input_state_data,
+        gate_weight_shape, gate_weight_data, gate_weight->params.scale,
+        gate_bias_shape, gate_bias_data, candidate_weight_shape,
+        candidate_weight_data, candidate_weight->params.scale,
+        candidate_bias_shape, candidate_bias_data, output_shape, output_data,
+        output_state_data, activation_shape, activation_data, concat_shape,
+        concat_data, quantized_concat_data, scaling_factors_data);
+    input_data += n_batch_input;
+    output_data += n_batch_output;
+    input_state_data = output_state_data;
+  }
+}
+
 }  // namespace
 
 enum InputTensor {
@@ -107,7 +161,11 @@ enum TemporaryTensor {
   kActivation = 0,
   // Scratch buffer for activation of size [n_batch, n_input+n_output]
   kConcat = 1,
-  kTemporaryNum = 2
+  // Scratch buffers for the quantized concat and its per batch scaling factors,
+  // only used with quantized weights.
+  kQuantizedConcat = 2,
+  kScalingFactors = 3,
+  kTemporaryNum = 4
 };
 
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
@@ -158,6 +216,9 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_EQ(context, candidate_weight->dims->data[1],
                     n_input + n_output);
 
+  TF_LITE_ENSURE_EQ(context, candidate_weight->type, gate_weight->type);
+  const bool is_hybrid = IsHybridOp(input, gate_weight);
+
   // candidate_bias' dim = [n_output]
   const TfLiteTensor* candidate_bias = GetInput(context, node, kCandidateBias);
   TF_LITE_ENSURE_EQ(context, candidate_bias->dims->size, 1);
@@ -179,7 +240,8 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
                                      TfLiteIntArrayCopy(input_state->dims)));
 
   TfLiteIntArrayFree(node->temporaries);
-  node->temporaries = TfLiteIntArrayCreate(kTemporaryNum);
+  node->temporaries =
+      TfLiteIntArrayCreate(is_hybrid ? kTemporaryNum : kConcat + 1);
 
   // activation's dim = [n_batch, 2 * n_output]
   node->temporaries->data[kActivation] = *scratch_tensor_index;
@@ -203,6 +265,31 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_OK(context,
                     context->ResizeTensor(context, concat, concat_size));
 
+  if (is_hybrid) {
+    // quantized_concat's dim  = [n_batch, n_input + n_output]
+    node->temporaries->data[kQuantizedConcat] =
+        (*scratch_tensor_index) + kQuantizedConcat;
+    TfLiteTensor* quantized_concat =
+        GetTemporary(context, node, kQuantizedConcat);
+    quantized_concat->type = gate_weight->type;
+    quantized_concat->allocation_type = kTfLiteArenaRw;
+    TF_LITE_ENSURE_OK(context,
+                      context->ResizeTensor(context, quantized_concat,
+                                            TfLiteIntArrayCopy(concat->dims)));
+
+    // scaling_factors' dim = [n_batch]
+    node->temporaries->data[kScalingFactors] =
+        (*scratch_tensor_index) + kScalingFactors;
+    TfLiteTensor* scaling_factors =
+        GetTemporary(context, node, kScalingFactors);
+    scaling_factors->type = kTfLiteFloat32;
+    scaling_factors->allocation_type = kTfLiteArenaRw;
+    TfLiteIntArray* scaling_factors_size = TfLiteIntArrayCreate(1);
+    scaling_factors_size->data[0] = n_batch;
+    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scaling_factors,
+                                                     scaling_factors_size));
+  }
+
   return kTfLiteOk;
 }
 
@@ -224,6 +311,14 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
     GruImpl(input, input_state, gate_weight, gate_bias, candidate_weight,
             candidate_bias, output, output_state, activation, concat,
             cpu_backend_context);
+  } else if (IsHybridOp(input, gate_weight)) {
+    TfLiteTensor* quantized_concat =
+        GetTemporary(context, node, kQuantizedConcat);
+    TfLiteTensor* scaling_factors =
+        GetTemporary(context, node, kScalingFactors);
+    HybridGruImpl(input, input_state, gate_weight, gate_bias, candidate_weight,
+                  candidate_bias, output, output_state, activation, concat,
+                  quantized_concat, scaling_factors);
   } else {
     context->ReportError(context,
                          "Unsupported combination of data types for GruCell");
@@ -34,13 +34,16 @@ class GRUOpModel : public SingleOpModel {
   explicit GRUOpModel(int n_batch, int n_input, int n_output,
                       const std::vector<std::vector<int>>& input_shapes,
                       const TensorType& weight_type = TensorType_FLOAT32)
-      : n_batch_(n_batch), n_input_(n_input), n_output_(n_output) {
+      : n_batch_(n_batch),
+        n_input_(n_input),
+        n_output_(n_output),
+        weight_type_(weight_type) {
     input_ = AddInput(TensorType_FLOAT32);
     input_state_ =
         AddInput(TensorData{TensorType_FLOAT32, {n_batch, n_output}}, true);
-    gate_weight_ = AddInput(TensorType_FLOAT32);
+    gate_weight_ = AddInput(weight_type);
     gate_bias_ = AddInput(TensorType_FLOAT32);
-    candidate_weight_ = AddInput(TensorType_FLOAT32);
+    candidate_weight_ = AddInput(weight_type);
     candidate_bias_ = AddInput(TensorType_FLOAT32);
 
     output_ = AddOutput(TensorType_FLOAT32);
@@ -58,7 +61,7 @@ class GRUOpModel : public SingleOpModel {
   }
 
   void SetGateWeight(const std::vector<float>& f) {
-    PopulateTensor(gate_weight_, f);
+    SetWeight(gate_weight_, f);
   }
 
   void SetGateBias(const std::vector<float>& f) {
@@ -66,7 +69,7 @@ class GRUOpModel : public SingleOpModel {
   }
 
   void SetCandidateWeight(const std::vector<float>& f) {
-    PopulateTensor(candidate_weight_, f);
+    SetWeight(candidate_weight_, f);
   }
 
   void SetCandidateBias(const std::vector<float>& f) {
@@ -82,6 +85,14 @@ class GRUOpModel : public SingleOpModel {
   int num_outputs() { return n_output_; }
 
  private:
+  void SetWeight(int index, const std::vector<float>& f) {
+    if (weight_type_ == TensorType_FLOAT32) {
+      PopulateTensor(index, f);
+    } else {
+      SymmetricQuantizeAndPopulate(index, f);
+    }
+  }
+
   int input_;
   int input_state_;
   int gate_weight_;
@@ -94,9 +105,10 @@ class GRUOpModel : public SingleOpModel {
   int n_batch_;
   int n_input_;
   int n_output_;
+  TensorType weight_type_;
 };
 
-TEST(GRUTest, SimpleTest) {
+void RunGruTest(TensorType weight_type, float tolerance) {
   const int n_time = 2;
   const int n_batch = 2;
   const int n_input = 2;
@@ -108,7 +120,8 @@ TEST(GRUTest, SimpleTest) {
                 {2 * n_output, n_input + n_output},
                 {2 * n_output},
                 {n_output, n_input + n_output},
-                {n_output}});
+                {n_output}},
+               weight_type);
   // All data is randomly generated.
   m.SetInput({0.89495724, 0.34482682, 0.68505806, 0.7135783, 0.3167085,
               0.93647677, 0.47361764, 0.39643127});
@@ -135,9 +148,14 @@ TEST(GRUTest, SimpleTest) {
               ElementsAreArray(ArrayFloatNear(
                   {0.20112592, 0.45286041, 0.80842507, 0.59567153, 0.2619998,
                    0.22922856, 0.27715868, 0.5247152, 0.82300174, 0.65812796,
-                   0.38217607, 0.3401444})));
+                   0.38217607, 0.3401444},
+                  tolerance)));
 }
 
+TEST(GRUTest, SimpleTest) { RunGruTest(TensorType_FLOAT32, 1e-5); }
+
+TEST(GRUTest, HybridTest) { RunGruTest(TensorType_UINT8, 5e-3); }
+
 }  // namespace
 }  // namespace experimental
 }  // namespace ops
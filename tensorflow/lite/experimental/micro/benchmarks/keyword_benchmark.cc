@@ -0,0 +1,79 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Measures how long the micro_speech keyword spotting model takes to run, per
+// inference and per operator. Build it with the CMSIS-NN tags (for example
+// TAGS="cmsis-nn") to compare the optimized kernels against the reference
+// ones on the same target.
+
+#include <cstring>
+
+#include "tensorflow/lite/experimental/micro/benchmarks/micro_benchmark.h"
+#include "tensorflow/lite/experimental/micro/examples/micro_speech/micro_features/tiny_conv_micro_features_model_data.h"
+#include "tensorflow/lite/experimental/micro/examples/micro_speech/micro_features/yes_micro_features_data.h"
+#include "tensorflow/lite/experimental/micro/kernels/all_ops_resolver.h"
+#include "tensorflow/lite/experimental/micro/micro_error_reporter.h"
+#include "tensorflow/lite/experimental/micro/micro_interpreter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/version.h"
+
+namespace {
+
+constexpr int kTensorArenaSize = 10 * 1024;
+constexpr size_t kMaxOperators = 16;
+constexpr int kNumRuns = 10;
+
+uint8_t tensor_arena[kTensorArenaSize];
+int32_t op_ticks[kMaxOperators];
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  tflite::MicroErrorReporter micro_error_reporter;
+  tflite::ErrorReporter* error_reporter = &micro_error_reporter;
+
+  const tflite::Model* model =
+      tflite::GetModel(g_tiny_conv_micro_features_model_data);
+  if (model->version() != TFLITE_SCHEMA_VERSION) {
+    error_reporter->Report(
+        "Model provided is schema version %d not equal "
+        "to supported version %d.\n",
+        model->version(), TFLITE_SCHEMA_VERSION);
+    return 1;
+  }
+
+  tflite::ops::micro::AllOpsResolver resolver;
+  tflite::MicroInterpreter interpreter(model, resolver, tensor_arena,
+                                       kTensorArenaSize, error_reporter);
+  if (interpreter.AllocateTensors() != kTfLiteOk) {
+    return 1;
+  }
+  if (interpreter.operators_size() > kMaxOperators) {
+    error_reporter->Report("Model has %d operators, at most %d supported",
+                           static_cast<int>(interpreter.operators_size()),
+                           static_cast<int>(kMaxOperators));
+    return 1;
+  }
+
+  TfLiteTensor* input = interpreter.input(0);
+  std::memcpy(input->data.uint8, g_yes_micro_f2e59fea_nohash_1_data,
+              input->bytes);
+
+  if (tflite::RunMicroBenchmark("keyword", model, &interpreter, kNumRuns,
+                                op_ticks) != kTfLiteOk) {
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,86 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/micro/benchmarks/micro_benchmark.h"
+
+#include "tensorflow/lite/experimental/micro/micro_time.h"
+
+namespace tflite {
+namespace {
+
+// Converts a tick count to microseconds, or returns -1 if the platform
+// doesn't report its timer frequency.
+int TicksToMicroseconds(int32_t ticks) {
+  const int32_t frequency = ticks_per_second();
+  if (frequency <= 0) {
+    return -1;
+  }
+  return static_cast<int>(static_cast<int64_t>(ticks) * 1000000 / frequency);
+}
+
+}  // namespace
+
+TfLiteStatus RunMicroBenchmark(const char* name, const Model* model,
+                               MicroInterpreter* interpreter, int num_runs,
+                               int32_t* op_ticks) {
+  ErrorReporter* error_reporter = interpreter->error_reporter();
+  if (num_runs <= 0) {
+    error_reporter->Report("%s: num_runs must be positive, got %d", name,
+                           num_runs);
+    return kTfLiteError;
+  }
+
+  const size_t operators_size = interpreter->operators_size();
+  for (size_t i = 0; i < operators_size; ++i) {
+    op_ticks[i] = 0;
+  }
+
+  // The first run is a warm-up, so caches and lazily initialized state don't
+  // skew the measurements.
+  TF_LITE_ENSURE_STATUS(interpreter->Invoke());
+
+  interpreter->SetOpTicks(op_ticks);
+  const int32_t start_ticks = GetCurrentTimeTicks();
+  for (int run = 0; run < num_runs; ++run) {
+    const TfLiteStatus invoke_status = interpreter->Invoke();
+    if (invoke_status != kTfLiteOk) {
+      interpreter->SetOpTicks(nullptr);
+      return invoke_status;
+    }
+  }
+  const int32_t total_ticks = GetCurrentTimeTicks() - start_ticks;
+  interpreter->SetOpTicks(nullptr);
+
+  error_reporter->Report("%s: %d runs, %d ticks/run (%d us/run)", name,
+                         num_runs, total_ticks / num_runs,
+                         TicksToMicroseconds(total_ticks / num_runs));
+
+  const auto* operators = (*model->subgraphs())[0]->operators();
+  const auto* opcodes = model->operator_codes();
+  for (size_t i = 0; i < operators_size; ++i) {
+    const auto* opcode = opcodes->Get(operators->Get(i)->opcode_index());
+    const char* op_name =
+        opcode->builtin_code() == BuiltinOperator_CUSTOM
+            ? opcode->custom_code()->c_str()
+            : EnumNameBuiltinOperator(opcode->builtin_code());
+    error_reporter->Report("%s: op %d %s: %d ticks/run (%d us/run)", name,
+                           static_cast<int>(i), op_name,
+                           op_ticks[i] / num_runs,
+                           TicksToMicroseconds(op_ticks[i] / num_runs));
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
@@ -0,0 +1,40 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_MICRO_BENCHMARKS_MICRO_BENCHMARK_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_MICRO_BENCHMARKS_MICRO_BENCHMARK_H_
+
+#include "tensorflow/lite/c/c_api_internal.h"
+#include "tensorflow/lite/experimental/micro/micro_interpreter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+// Invokes the interpreter num_runs times and reports, through its error
+// reporter, the average number of ticks per run for the whole model and for
+// each of its operators. Ticks come from GetCurrentTimeTicks(), so on a target
+// that implements it with a cycle counter these are cycle counts.
+//
+// op_ticks is caller-provided scratch space for the per-operator totals, since
+// nothing here allocates memory. It must hold interpreter->operators_size()
+// entries. The interpreter must already have its tensors allocated and its
+// inputs filled in.
+TfLiteStatus RunMicroBenchmark(const char* name, const Model* model,
+                               MicroInterpreter* interpreter, int num_runs,
+                               int32_t* op_ticks);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_MICRO_BENCHMARKS_MICRO_BENCHMARK_H_
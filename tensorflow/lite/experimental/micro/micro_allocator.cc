@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/lite/experimental/micro/micro_allocator.h"
 
+#include <cstring>
+
 #include "tensorflow/lite/c/c_api_internal.h"
 #include "tensorflow/lite/core/api/flatbuffer_conversions.h"
 #include "tensorflow/lite/core/api/tensor_utils.h"
@@ -122,106 +124,143 @@ TfLiteStatus MicroAllocator::AllocateTensors() {
     }
   }
 
-  // First go through the inputs and figure out if they need to be allocated.
-  for (size_t i = 0; i < subgraph_->inputs()->size(); ++i) {
-    const int tensor_index = subgraph_->inputs()->Get(i);
-    TensorInfo* current = &tensor_info[tensor_index];
-    // Check for pre-allocated inputs.
-    current->needs_allocating = (current->runtime_tensor->data.raw == nullptr);
-    current->first_created = 0;
-  }
+  const int32_t* offline_plan = nullptr;
+  TF_LITE_ENSURE_STATUS(GetOfflineMemoryPlan(&offline_plan));
 
-  // Mark all outputs as persistent to the end of the invocation.
-  for (size_t i = 0; i < subgraph_->outputs()->size(); ++i) {
-    const int tensor_index = subgraph_->outputs()->Get(i);
-    TensorInfo* current = &tensor_info[tensor_index];
-    current->last_used = operators_->size() - 1;
-  }
+  uint8_t* aligned_arena = AlignPointerUp(arena_, kBufferAlignment);
+  const size_t alignment_loss = (aligned_arena - arena_);
 
-  // Figure out when the first and last use of each tensor is.
-  for (int i = (operators_->size() - 1); i >= 0; --i) {
-    const auto* op = operators_->Get(i);
-    for (size_t n = 0; n < op->inputs()->size(); ++n) {
-      const int tensor_index = op->inputs()->Get(n);
-      TensorInfo* current = &tensor_info[tensor_index];
-      if ((current->last_used == -1) || (current->last_used > i)) {
-        current->last_used = i;
+  int remaining_arena_size =
+      arena_size_ - (memory_allocator_.GetDataSize() + alignment_loss);
+
+  if (offline_plan != nullptr) {
+    // The arena was planned offline, so every tensor that lives in the arena
+    // already has an offset and there are no lifetimes to work out.
+    int arena_size_needed = 0;
+    for (size_t i = 0; i < tensors_size; ++i) {
+      TensorInfo* current = &tensor_info[i];
+      const int32_t offset = offline_plan[i];
+      if ((offset < 0) || (current->runtime_tensor->data.raw != nullptr)) {
+        continue;
       }
-    }
-    for (size_t n = 0; n < op->outputs()->size(); ++n) {
-      const int tensor_index = op->outputs()->Get(n);
-      TensorInfo* current = &tensor_info[tensor_index];
-      if ((current->first_created == -1) || (current->first_created < i)) {
-        current->first_created = i;
+      const int end = offset + AlignSizeUp(current->runtime_tensor->bytes,
+                                           kBufferAlignment);
+      if (end > arena_size_needed) {
+        arena_size_needed = end;
       }
+      current->runtime_tensor->data.uint8 = aligned_arena + offset;
     }
-  }
-
-  // Work out which tensors need to be allocated.
-  for (size_t i = 0; i < tensors_->size(); ++i) {
-    TensorInfo* current = &tensor_info[i];
-    const bool is_read_only =
-        (current->first_created == -1) && (current->last_used != -1);
-    const bool is_preallocated_input =
-        (current->runtime_tensor->data.raw != nullptr);
-    const bool has_partial_lifetime =
-        !is_read_only &&
-        ((current->first_created == -1) || (current->last_used == -1));
-    if (has_partial_lifetime) {
+    if (arena_size_needed > remaining_arena_size) {
       error_reporter_->Report(
-          "Logic error in memory planner, tensor %d has an invalid lifetime",
-          i);
+          "Arena size is too small for the offline planned activation "
+          "buffers. Needed %d but only %d was available.",
+          arena_size_needed, remaining_arena_size);
       return kTfLiteError;
     }
-    if (!is_read_only && !is_preallocated_input) {
-      current->needs_allocating = true;
+  } else {
+    // First go through the inputs and figure out if they need to be allocated.
+    for (size_t i = 0; i < subgraph_->inputs()->size(); ++i) {
+      const int tensor_index = subgraph_->inputs()->Get(i);
+      TensorInfo* current = &tensor_info[tensor_index];
+      // Check for pre-allocated inputs.
+      current->needs_allocating =
+          (current->runtime_tensor->data.raw == nullptr);
+      current->first_created = 0;
     }
-  }
 
-  uint8_t* aligned_arena = AlignPointerUp(arena_, kBufferAlignment);
-  const size_t alignment_loss = (aligned_arena - arena_);
+    // Mark all outputs as persistent to the end of the invocation.
+    for (size_t i = 0; i < subgraph_->outputs()->size(); ++i) {
+      const int tensor_index = subgraph_->outputs()->Get(i);
+      TensorInfo* current = &tensor_info[tensor_index];
+      current->last_used = operators_->size() - 1;
+    }
 
-  int remaining_arena_size =
-      arena_size_ - (memory_allocator_.GetDataSize() + alignment_loss);
-  GreedyMemoryPlanner planner(aligned_arena, remaining_arena_size);
+    // Figure out when the first and last use of each tensor is.
+    for (int i = (operators_->size() - 1); i >= 0; --i) {
+      const auto* op = operators_->Get(i);
+      for (size_t n = 0; n < op->inputs()->size(); ++n) {
+        const int tensor_index = op->inputs()->Get(n);
+        TensorInfo* current = &tensor_info[tensor_index];
+        if ((current->last_used == -1) || (current->last_used > i)) {
+          current->last_used = i;
+        }
+      }
+      for (size_t n = 0; n < op->outputs()->size(); ++n) {
+        const int tensor_index = op->outputs()->Get(n);
+        TensorInfo* current = &tensor_info[tensor_index];
+        if ((current->first_created == -1) || (current->first_created < i)) {
+          current->first_created = i;
+        }
+      }
+    }
 
-  // Add the tensors to our allocation plan.
-  for (size_t i = 0; i < tensors_->size(); ++i) {
-    TensorInfo* current = &tensor_info[i];
-    if (current->needs_allocating) {
-      size_t bytes_required;
-      size_t type_size;
-      TF_LITE_ENSURE_STATUS(BytesRequiredForTensor(*current->flatbuffer_tensor,
-                                                   &bytes_required, &type_size,
-                                                   error_reporter_));
-      size_t aligned_bytes_required =
-          AlignSizeUp(bytes_required, kBufferAlignment);
-      planner.AddBuffer(error_reporter_, aligned_bytes_required,
-                        current->first_created, current->last_used);
+    // Work out which tensors need to be allocated.
+    for (size_t i = 0; i < tensors_->size(); ++i) {
+      TensorInfo* current = &tensor_info[i];
+      const bool is_read_only =
+          (current->first_created == -1) && (current->last_used != -1);
+      const bool is_preallocated_input =
+          (current->runtime_tensor->data.raw != nullptr);
+      const bool has_partial_lifetime =
+          !is_read_only &&
+          ((current->first_created == -1) || (current->last_used == -1));
+      if (has_partial_lifetime) {
+        error_reporter_->Report(
+            "Logic error in memory planner, tensor %d has an invalid lifetime",
+            i);
+        return kTfLiteError;
+      }
+      if (!is_read_only && !is_preallocated_input) {
+        current->needs_allocating = true;
+      }
     }
-  }
 
-  // Make sure we have enough room.
-  if (planner.GetMaximumMemorySize() > remaining_arena_size) {
-    error_reporter_->Report(
-        "Arena size is too small for activation buffers. Needed %d but only %d "
-        "was available.",
-        planner.GetMaximumMemorySize(), remaining_arena_size);
-    return kTfLiteError;
+    GreedyMemoryPlanner planner(aligned_arena, remaining_arena_size);
+
+    // Add the tensors to our allocation plan.
+    for (size_t i = 0; i < tensors_->size(); ++i) {
+      TensorInfo* current = &tensor_info[i];
+      if (current->needs_allocating) {
+        size_t bytes_required;
+        size_t type_size;
+        TF_LITE_ENSURE_STATUS(
+            BytesRequiredForTensor(*current->flatbuffer_tensor,
+                                   &bytes_required, &type_size,
+                                   error_reporter_));
+        size_t aligned_bytes_required =
+            AlignSizeUp(bytes_required, kBufferAlignment);
+        planner.AddBuffer(error_reporter_, aligned_bytes_required,
+                          current->first_created, current->last_used);
+      }
+    }
+
+    // Make sure we have enough room.
+    if (planner.GetMaximumMemorySize() > remaining_arena_size) {
+      error_reporter_->Report(
+          "Arena size is too small for activation buffers. Needed %d but only "
+          "%d was available.",
+          planner.GetMaximumMemorySize(), remaining_arena_size);
+      return kTfLiteError;
+    }
+
+    // Figure out the actual memory addresses for each buffer, based on the
+    // plan.
+    int planner_index = 0;
+    for (size_t i = 0; i < tensors_->size(); ++i) {
+      TensorInfo* current = &tensor_info[i];
+      if (current->needs_allocating) {
+        int offset;
+        TF_LITE_ENSURE_STATUS(planner.GetOffsetForBuffer(
+            error_reporter_, planner_index, &offset));
+        current->runtime_tensor->data.uint8 = aligned_arena + offset;
+        ++planner_index;
+      }
+    }
   }
 
-  // Figure out the actual memory addresses for each buffer, based on the plan.
-  int planner_index = 0;
+  // Set default value for variable tensors:
   for (size_t i = 0; i < tensors_->size(); ++i) {
     TensorInfo* current = &tensor_info[i];
-    if (current->needs_allocating) {
-      int offset;
-      TF_LITE_ENSURE_STATUS(
-          planner.GetOffsetForBuffer(error_reporter_, planner_index, &offset));
-      current->runtime_tensor->data.uint8 = aligned_arena + offset;
-      ++planner_index;
-    }
-    // Set default value for variable tensors:
     if (current->flatbuffer_tensor->is_variable()) {
       if (current->runtime_tensor->data.uint8 == nullptr) {
         error_reporter_->Report("Variable is not allocated");
@@ -234,6 +273,44 @@ TfLiteStatus MicroAllocator::AllocateTensors() {
   return kTfLiteOk;
 }
 
+TfLiteStatus MicroAllocator::GetOfflineMemoryPlan(
+    const int32_t** offline_plan) {
+  *offline_plan = nullptr;
+  const auto* metadata = model_->metadata();
+  if (metadata == nullptr) {
+    return kTfLiteOk;
+  }
+  for (size_t i = 0; i < metadata->size(); ++i) {
+    const auto* entry = metadata->Get(i);
+    if ((entry->name() == nullptr) ||
+        (strcmp(entry->name()->c_str(), kOfflineMemoryPlanMetadataName) != 0)) {
+      continue;
+    }
+    const auto* buffers = model_->buffers();
+    const flatbuffers::Vector<uint8_t>* data =
+        (entry->buffer() < buffers->size())
+            ? buffers->Get(entry->buffer())->data()
+            : nullptr;
+    // Buffer data is 16-byte aligned, so it can be read as int32 directly.
+    const int32_t* plan =
+        (data != nullptr) ? reinterpret_cast<const int32_t*>(data->data())
+                          : nullptr;
+    const size_t plan_size =
+        (data != nullptr) ? data->size() / sizeof(int32_t) : 0;
+    if ((plan_size < static_cast<size_t>(kOfflineMemoryPlanHeaderSize)) ||
+        (plan[0] != kOfflineMemoryPlanVersion) || (plan[1] != 0) ||
+        (static_cast<size_t>(plan[2]) != tensors_->size()) ||
+        (plan_size != kOfflineMemoryPlanHeaderSize + tensors_->size())) {
+      error_reporter_->Report(
+          "Offline memory plan in the model doesn't match the model.");
+      return kTfLiteError;
+    }
+    *offline_plan = plan + kOfflineMemoryPlanHeaderSize;
+    return kTfLiteOk;
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus MicroAllocator::InitializeRuntimeTensor(
     const tflite::Tensor& flatbuffer_tensor,
     const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers,
@@ -245,6 +322,12 @@ TfLiteStatus MicroAllocator::InitializeRuntimeTensor(
                                           &result->type, error_reporter));
   // Make sure we remember if the serialized tensor is designated as a variable.
   result->is_variable = flatbuffer_tensor.is_variable();
+  // Sparse tensors aren't supported by the micro kernels.
+  if (flatbuffer_tensor.sparsity()) {
+    error_reporter->Report("Sparse tensors are not supported.");
+    return kTfLiteError;
+  }
+  result->sparsity = nullptr;
 
   // We need to figure out where the actual contents of this tensor are stored
   // in memory. We'll check to see if there's a serialized buffer (pretty much
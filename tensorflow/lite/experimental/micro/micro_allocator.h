@@ -22,6 +22,15 @@ limitations under the License.
 
 namespace tflite {
 
+// Name of the model metadata entry holding an arena plan computed offline by
+// tools/offline_memory_planner. The metadata buffer holds int32 values:
+//   [version, subgraph index, number of tensors, offset of tensor 0, ...]
+// Offsets are in bytes from the start of the arena after aligning it to 16
+// bytes, or -1 for tensors that don't live in the arena.
+constexpr char kOfflineMemoryPlanMetadataName[] = "OfflineMemoryAllocation";
+constexpr int kOfflineMemoryPlanVersion = 1;
+constexpr int kOfflineMemoryPlanHeaderSize = 3;
+
 // Allocator responsible for allocating memory for all intermediate tensors
 // necessary to invoke a model.
 class MicroAllocator {
@@ -55,10 +64,15 @@ class MicroAllocator {
 
   // Run through the model and allocate all necessary input, output and
   // intermediate tensors except for those already provided via calls to
-  // registerPreallocatedInput.
+  // registerPreallocatedInput. If the model carries an offline arena plan, the
+  // tensors are placed at its offsets instead of planning the arena here.
   TfLiteStatus AllocateTensors();
 
  private:
+  // Sets 'offline_plan' to the offsets of the arena plan in the model
+  // metadata, or to null if the model doesn't have one.
+  TfLiteStatus GetOfflineMemoryPlan(const int32_t** offline_plan);
+
   const Model* model_;
   SimpleMemoryAllocator memory_allocator_;
   ErrorReporter* error_reporter_;
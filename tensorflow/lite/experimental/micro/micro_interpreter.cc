@@ -17,6 +17,7 @@ limitations under the License.
 #include "tensorflow/lite/c/c_api_internal.h"
 #include "tensorflow/lite/core/api/flatbuffer_conversions.h"
 #include "tensorflow/lite/experimental/micro/compatibility.h"
+#include "tensorflow/lite/experimental/micro/micro_time.h"
 
 namespace tflite {
 namespace {
@@ -70,7 +71,8 @@ MicroInterpreter::MicroInterpreter(const Model* model,
       context_(),
       allocator_(&context_, model_, tensor_arena, tensor_arena_size,
                  error_reporter_),
-      tensors_allocated_(false) {
+      tensors_allocated_(false),
+      op_ticks_(nullptr) {
   auto* subgraphs = model->subgraphs();
   if (subgraphs->size() != 1) {
     error_reporter->Report("Only 1 subgraph is currently supported.\n");
@@ -251,7 +253,11 @@ TfLiteStatus MicroInterpreter::Invoke() {
     }
 
     if (registration->invoke) {
+      const int32_t start_ticks = op_ticks_ ? GetCurrentTimeTicks() : 0;
       TfLiteStatus invoke_status = registration->invoke(&context_, &node);
+      if (op_ticks_) {
+        op_ticks_[i] += GetCurrentTimeTicks() - start_ticks;
+      }
       if (invoke_status != kTfLiteOk) {
         error_reporter_->Report(
             "Node %s (number %d) failed to invoke with status %d",
@@ -64,6 +64,15 @@ class MicroInterpreter {
   TfLiteTensor* output(size_t index);
   size_t outputs_size() const { return subgraph_->outputs()->Length(); }
 
+  size_t operators_size() const { return operators_->size(); }
+
+  // Enables per-operator profiling. Every Invoke() adds the ticks (see
+  // micro_time.h) spent in operator i's invoke function to op_ticks[i], so
+  // the array must hold operators_size() entries, should be zeroed by the
+  // caller, and must stay valid until profiling is disabled again by passing
+  // nullptr.
+  void SetOpTicks(int32_t* op_ticks) { op_ticks_ = op_ticks; }
+
   TfLiteStatus initialization_status() const { return initialization_status_; }
 
   ErrorReporter* error_reporter() { return error_reporter_; }
@@ -86,6 +95,8 @@ class MicroInterpreter {
   const flatbuffers::Vector<flatbuffers::Offset<Operator>>* operators_;
 
   const SubGraph* subgraph_;
+
+  int32_t* op_ticks_;
 };
 
 }  // namespace tflite
@@ -0,0 +1,39 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Reference implementation of the timer functions used to profile TensorFlow
+// Lite for Microcontrollers. Unlike DebugLog(), these are optional: a
+// platform that returns 0 from ticks_per_second() still runs models, it just
+// can't report how long they took.
+//
+// This version relies on the C library's clock(), which is fine on hosts but
+// usually has very coarse resolution, or isn't implemented at all, on bare
+// metal targets. To use a hardware cycle counter instead, for example the DWT
+// CYCCNT register on Arm Cortex-M3 and above, create your own implementation
+// file in a subfolder named after the target, in the same way as
+// tensorflow/lite/experimental/micro/bluepill/debug_log.cc replaces
+// debug_log.cc.
+
+#include "tensorflow/lite/experimental/micro/micro_time.h"
+
+#include <ctime>
+
+namespace tflite {
+
+int32_t ticks_per_second() { return CLOCKS_PER_SEC; }
+
+int32_t GetCurrentTimeTicks() { return static_cast<int32_t>(std::clock()); }
+
+}  // namespace tflite
@@ -0,0 +1,88 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/micro/tools/offline_memory_planner.h"
+
+#include <memory>
+
+#include "tensorflow/lite/experimental/micro/memory_helpers.h"
+#include "tensorflow/lite/experimental/micro/micro_allocator.h"
+
+namespace tflite {
+namespace {
+
+// MicroAllocator aligns the arena to 16 bytes before planning it, so planning
+// an arena that is already aligned gives offsets from its start.
+constexpr int kArenaAlignment = 16;
+
+}  // namespace
+
+TfLiteStatus AddOfflineMemoryPlan(const Model* model, size_t arena_size,
+                                  ErrorReporter* error_reporter,
+                                  std::vector<uint8_t>* planned_model) {
+  if ((model->subgraphs() == nullptr) || (model->subgraphs()->size() != 1)) {
+    error_reporter->Report("Only 1 subgraph is currently supported.\n");
+    return kTfLiteError;
+  }
+
+  // Run the allocator the device will run, and read the plan back from where
+  // it put the tensors.
+  std::vector<uint8_t> arena(arena_size + kArenaAlignment);
+  uint8_t* aligned_arena = AlignPointerUp(arena.data(), kArenaAlignment);
+  TfLiteContext context = {};
+  MicroAllocator allocator(&context, model, aligned_arena, arena_size,
+                           error_reporter);
+  TF_LITE_ENSURE_STATUS(allocator.AllocateTensors());
+
+  std::vector<int32_t> plan = {kOfflineMemoryPlanVersion, 0,
+                               static_cast<int32_t>(context.tensors_size)};
+  for (size_t i = 0; i < context.tensors_size; ++i) {
+    const TfLiteTensor& tensor = context.tensors[i];
+    const bool in_arena = (tensor.allocation_type == kTfLiteArenaRw) &&
+                          (tensor.data.uint8 >= aligned_arena) &&
+                          (tensor.data.uint8 < aligned_arena + arena_size);
+    plan.push_back(in_arena ? static_cast<int32_t>(tensor.data.uint8 -
+                                                   aligned_arena)
+                            : -1);
+  }
+
+  // Store the plan in the model, replacing the plan of an earlier run if
+  // there is one.
+  std::unique_ptr<ModelT> model_t(model->UnPack());
+  MetadataT* plan_metadata = nullptr;
+  for (auto& metadata : model_t->metadata) {
+    if (metadata->name == kOfflineMemoryPlanMetadataName) {
+      plan_metadata = metadata.get();
+    }
+  }
+  if (plan_metadata == nullptr) {
+    model_t->metadata.emplace_back(new MetadataT);
+    plan_metadata = model_t->metadata.back().get();
+    plan_metadata->name = kOfflineMemoryPlanMetadataName;
+    plan_metadata->buffer = model_t->buffers.size();
+    model_t->buffers.emplace_back(new BufferT);
+  }
+  const uint8_t* plan_bytes = reinterpret_cast<const uint8_t*>(plan.data());
+  model_t->buffers[plan_metadata->buffer]->data.assign(
+      plan_bytes, plan_bytes + plan.size() * sizeof(int32_t));
+
+  flatbuffers::FlatBufferBuilder builder;
+  FinishModelBuffer(builder, Model::Pack(builder, model_t.get()));
+  planned_model->assign(builder.GetBufferPointer(),
+                        builder.GetBufferPointer() + builder.GetSize());
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
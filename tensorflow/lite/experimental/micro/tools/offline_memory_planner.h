@@ -0,0 +1,39 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_MICRO_TOOLS_OFFLINE_MEMORY_PLANNER_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_MICRO_TOOLS_OFFLINE_MEMORY_PLANNER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/lite/c/c_api_internal.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+// Plans the tensor arena of 'model' on the host, with the same greedy memory
+// planner MicroAllocator runs on the device, and writes a copy of the model
+// that carries the plan in its metadata to 'planned_model'. MicroAllocator
+// places the tensors of the planned model at the planned offsets instead of
+// planning the arena when the model is loaded. 'arena_size' is the size of
+// the tensor arena the model will be given on the device.
+TfLiteStatus AddOfflineMemoryPlan(const Model* model, size_t arena_size,
+                                  ErrorReporter* error_reporter,
+                                  std::vector<uint8_t>* planned_model);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_MICRO_TOOLS_OFFLINE_MEMORY_PLANNER_H_
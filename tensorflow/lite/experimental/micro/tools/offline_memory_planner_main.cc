@@ -0,0 +1,69 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Adds an offline arena plan to a TensorFlow Lite model for microcontrollers.
+//
+// Usage: offline_memory_planner <input.tflite> <output.tflite> <arena size>
+//
+// The arena size is the size of the tensor arena the model will be given on
+// the device, in bytes.
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "tensorflow/lite/experimental/micro/micro_error_reporter.h"
+#include "tensorflow/lite/experimental/micro/tools/offline_memory_planner.h"
+
+int main(int argc, char** argv) {
+  if (argc != 4) {
+    fprintf(stderr, "Usage: %s <input.tflite> <output.tflite> <arena size>\n",
+            argv[0]);
+    return 1;
+  }
+  std::ifstream input(argv[1], std::ios::binary);
+  if (!input) {
+    fprintf(stderr, "Could not read %s\n", argv[1]);
+    return 1;
+  }
+  const std::vector<char> model_data((std::istreambuf_iterator<char>(input)),
+                                     std::istreambuf_iterator<char>());
+  flatbuffers::Verifier verifier(
+      reinterpret_cast<const uint8_t*>(model_data.data()), model_data.size());
+  if (!tflite::VerifyModelBuffer(verifier)) {
+    fprintf(stderr, "%s is not a valid model\n", argv[1]);
+    return 1;
+  }
+  const size_t arena_size = strtoul(argv[3], nullptr, 10);
+
+  tflite::MicroErrorReporter error_reporter;
+  std::vector<uint8_t> planned_model;
+  if (tflite::AddOfflineMemoryPlan(tflite::GetModel(model_data.data()),
+                                   arena_size, &error_reporter,
+                                   &planned_model) != kTfLiteOk) {
+    return 1;
+  }
+
+  std::ofstream output(argv[2], std::ios::binary);
+  output.write(reinterpret_cast<const char*>(planned_model.data()),
+               planned_model.size());
+  if (!output) {
+    fprintf(stderr, "Could not write %s\n", argv[2]);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,80 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/micro/tools/offline_memory_planner.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/lite/experimental/micro/micro_allocator.h"
+#include "tensorflow/lite/experimental/micro/test_helpers.h"
+#include "tensorflow/lite/experimental/micro/testing/micro_test.h"
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestPlannedModelKeepsRuntimePlan) {
+  const tflite::Model* model = tflite::testing::GetMockModel();
+  constexpr size_t arena_size = 1024;
+  std::vector<uint8_t> planned_model_data;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, tflite::AddOfflineMemoryPlan(model, arena_size,
+                                              micro_test::reporter,
+                                              &planned_model_data));
+  const tflite::Model* planned_model =
+      tflite::GetModel(planned_model_data.data());
+  TF_LITE_MICRO_EXPECT_NE(nullptr, planned_model->metadata());
+  TF_LITE_MICRO_EXPECT_EQ(1, planned_model->metadata()->size());
+  TF_LITE_MICRO_EXPECT_EQ(
+      0, tflite::testing::TestStrcmp(
+             tflite::kOfflineMemoryPlanMetadataName,
+             planned_model->metadata()->Get(0)->name()->c_str()));
+
+  // Planning the model again replaces its plan.
+  std::vector<uint8_t> replanned_model_data;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, tflite::AddOfflineMemoryPlan(planned_model, arena_size,
+                                              micro_test::reporter,
+                                              &replanned_model_data));
+  TF_LITE_MICRO_EXPECT_EQ(
+      1, tflite::GetModel(replanned_model_data.data())->metadata()->size());
+
+  // Tensors of the planned model end up where the runtime planner puts the
+  // tensors of the original model.
+  TfLiteContext context;
+  alignas(16) uint8_t arena[arena_size];
+  tflite::MicroAllocator allocator(&context, model, arena, arena_size,
+                                   micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, allocator.AllocateTensors());
+
+  TfLiteContext planned_context;
+  alignas(16) uint8_t planned_arena[arena_size];
+  tflite::MicroAllocator planned_allocator(&planned_context, planned_model,
+                                           planned_arena, arena_size,
+                                           micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, planned_allocator.AllocateTensors());
+
+  TF_LITE_MICRO_EXPECT_EQ(context.tensors_size, planned_context.tensors_size);
+  for (size_t i = 0; i < context.tensors_size; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(context.tensors[i].allocation_type,
+                            planned_context.tensors[i].allocation_type);
+    if (context.tensors[i].allocation_type == kTfLiteArenaRw) {
+      TF_LITE_MICRO_EXPECT_EQ(context.tensors[i].data.uint8 - arena,
+                              planned_context.tensors[i].data.uint8 -
+                                  planned_arena);
+    }
+  }
+}
+
+TF_LITE_MICRO_TESTS_END
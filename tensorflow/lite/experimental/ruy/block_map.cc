@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstdint>
+#include <limits>
 
 #ifdef RUY_MAKEBLOCKMAP_DEBUG
 #include <cstdio>
@@ -129,8 +130,13 @@ void GetRectangularness(int rows, int cols, int kernel_rows, int kernel_cols,
 // be at least as many tiles as there are threads, and hopefully
 // substantially more than that, so we benefit from ruy's ability to
 // dispatch fine-grained workloads to threads.
+//
+// With threads of different speeds, the slowest thread should get a
+// proportionally smaller share of the blocks, so we aim for more blocks per
+// thread.
 int GetMultithreadingScore(int block_size_log2, int rows, int cols,
-                           int tentative_thread_count) {
+                           int tentative_thread_count,
+                           int thread_speed_ratio_log2) {
   const int num_full_blocks_of_rows = rows >> block_size_log2;
   const int num_full_blocks_of_cols = cols >> block_size_log2;
   const int candidate_num_full_blocks_log2 = floor_log2(
@@ -141,8 +147,9 @@ int GetMultithreadingScore(int block_size_log2, int rows, int cols,
   if (tentative_thread_count == 1) {
     return 0;
   } else {
-    const int blocks_per_thread_log2 =
-        candidate_num_full_blocks_log2 - ceil_log2(tentative_thread_count);
+    const int blocks_per_thread_log2 = candidate_num_full_blocks_log2 -
+                                       ceil_log2(tentative_thread_count) -
+                                       thread_speed_ratio_log2;
     if (blocks_per_thread_log2 < 0) {
       return -64;
     } else if (blocks_per_thread_log2 == 0) {
@@ -238,11 +245,26 @@ int GetKernelAmortizationScore(int block_size_log2, int rows, int cols,
 
 }  // namespace
 
-void MakeBlockMap(int rows, int cols, int depth, int kernel_rows,
-                  int kernel_cols, int lhs_scalar_size, int rhs_scalar_size,
-                  int tentative_thread_count, Path path,
-                  int cache_friendly_traversal_threshold, BlockMap* block_map) {
-  gemmlowp::ScopedProfilingLabel label("MakeBlockMap");
+void GetBlockSizeLog2Range(int rows, int cols, int kernel_rows,
+                           int kernel_cols, int* min_block_size_log2,
+                           int* max_block_size_log2) {
+  const int kernel_size_log2 =
+      std::max(pot_log2(kernel_cols), pot_log2(kernel_rows));
+  const int size_log2 =
+      std::max(kernel_size_log2, floor_log2(std::min(rows, cols)));
+  // Blocks larger than 2^kMaxKernelsPerBlockLog2 kernel tiles do not amortize
+  // the kernel overhead any further, see GetKernelAmortizationScore.
+  static constexpr int kMaxKernelsPerBlockLog2 = 6;
+  *min_block_size_log2 = kernel_size_log2;
+  *max_block_size_log2 =
+      std::min(size_log2, kernel_size_log2 + kMaxKernelsPerBlockLog2);
+}
+
+int GetBlockSizeLog2(int rows, int cols, int depth, int kernel_rows,
+                     int kernel_cols, int lhs_scalar_size, int rhs_scalar_size,
+                     int tentative_thread_count, int thread_speed_ratio_log2,
+                     Path path) {
+  gemmlowp::ScopedProfilingLabel label("GetBlockSizeLog2");
 
 #ifdef RUY_MAKEBLOCKMAP_DEBUG
 #if RUY_MAKEBLOCKMAP_DEBUG >= 2
@@ -261,28 +283,8 @@ void MakeBlockMap(int rows, int cols, int depth, int kernel_rows,
   }
 #endif
 
-  RUY_DCHECK_GE(rows, kernel_rows);
-  RUY_DCHECK_GE(cols, kernel_cols);
-  RUY_DCHECK_EQ(rows % kernel_rows, 0);
-  RUY_DCHECK_EQ(cols % kernel_cols, 0);
-
-  block_map->traversal_order =
-      GetTraversalOrder(rows, cols, depth, lhs_scalar_size, rhs_scalar_size,
-                        cache_friendly_traversal_threshold);
-
-  int rows_rectangularness_log2 = 0;
-  int cols_rectangularness_log2 = 0;
-  GetRectangularness(rows, cols, kernel_rows, kernel_cols,
-                     &rows_rectangularness_log2, &cols_rectangularness_log2);
-
   const int kernel_rows_log2 = pot_log2(kernel_rows);
   const int kernel_cols_log2 = pot_log2(kernel_cols);
-  const int kernel_size_log2 = std::max(kernel_cols_log2, kernel_rows_log2);
-
-  const int size = std::min(rows, cols);
-  const int size_log2 = std::max(kernel_size_log2, floor_log2(size));
-
-  RUY_DCHECK_GE(size_log2, kernel_size_log2);
 
   // We are going to try candidate values for block_size_log2 ranging from
   // kernel_size_log2 to (kernel_size_log2 + kMaxKernelsPerBlockLog2).
@@ -295,15 +297,18 @@ void MakeBlockMap(int rows, int cols, int depth, int kernel_rows,
   // and tune this as needed to achieve good performance elsewhere. Use
   // the unit test, block_map_test, to encode values that should be preserved
   // on specific architectures. Use RUY_MAKEBLOCKMAP_DEBUG to help tuning this.
-  static constexpr int kMaxKernelsPerBlockLog2 = 6;
-  const int max_block_size_log2 =
-      std::min(size_log2, kernel_size_log2 + kMaxKernelsPerBlockLog2);
+  // Context::tuning_cache can also measure the candidates at runtime instead.
+  int min_block_size_log2 = 0;
+  int max_block_size_log2 = 0;
+  GetBlockSizeLog2Range(rows, cols, kernel_rows, kernel_cols,
+                        &min_block_size_log2, &max_block_size_log2);
   int best_score = std::numeric_limits<int>::min();
   int best_score_block_size_log2 = -1;
-  for (int block_size_log2 = kernel_size_log2;
+  for (int block_size_log2 = min_block_size_log2;
        block_size_log2 <= max_block_size_log2; block_size_log2++) {
-    const int multithreading_score = GetMultithreadingScore(
-        block_size_log2, rows, cols, tentative_thread_count);
+    const int multithreading_score =
+        GetMultithreadingScore(block_size_log2, rows, cols,
+                               tentative_thread_count, thread_speed_ratio_log2);
     const int cache_locality_score =
         GetCacheLocalityScore(block_size_log2, rows, cols, depth,
                               lhs_scalar_size, rhs_scalar_size, path);
@@ -344,7 +349,40 @@ void MakeBlockMap(int rows, int cols, int depth, int kernel_rows,
   firsttime = false;
 #endif
 
-  int num_blocks_base_log2 = size_log2 - best_score_block_size_log2;
+  return best_score_block_size_log2;
+}
+
+void MakeBlockMapWithBlockSize(int rows, int cols, int depth, int kernel_rows,
+                               int kernel_cols, int lhs_scalar_size,
+                               int rhs_scalar_size, int tentative_thread_count,
+                               int block_size_log2,
+                               int cache_friendly_traversal_threshold,
+                               BlockMap* block_map) {
+  gemmlowp::ScopedProfilingLabel label("MakeBlockMapWithBlockSize");
+
+  RUY_DCHECK_GE(rows, kernel_rows);
+  RUY_DCHECK_GE(cols, kernel_cols);
+  RUY_DCHECK_EQ(rows % kernel_rows, 0);
+  RUY_DCHECK_EQ(cols % kernel_cols, 0);
+
+  block_map->traversal_order =
+      GetTraversalOrder(rows, cols, depth, lhs_scalar_size, rhs_scalar_size,
+                        cache_friendly_traversal_threshold);
+
+  int rows_rectangularness_log2 = 0;
+  int cols_rectangularness_log2 = 0;
+  GetRectangularness(rows, cols, kernel_rows, kernel_cols,
+                     &rows_rectangularness_log2, &cols_rectangularness_log2);
+
+  const int kernel_size_log2 =
+      std::max(pot_log2(kernel_cols), pot_log2(kernel_rows));
+  const int size = std::min(rows, cols);
+  const int size_log2 = std::max(kernel_size_log2, floor_log2(size));
+
+  RUY_DCHECK_GE(size_log2, kernel_size_log2);
+  RUY_DCHECK_GE(block_size_log2, kernel_size_log2);
+
+  int num_blocks_base_log2 = size_log2 - block_size_log2;
   RUY_DCHECK_GE(num_blocks_base_log2, 0);
 
   const int num_blocks_of_rows_log2 =
@@ -379,6 +417,21 @@ void MakeBlockMap(int rows, int cols, int depth, int kernel_rows,
       std::min(tentative_thread_count, NumBlocks(*block_map));
 }
 
+void MakeBlockMap(int rows, int cols, int depth, int kernel_rows,
+                  int kernel_cols, int lhs_scalar_size, int rhs_scalar_size,
+                  int tentative_thread_count, int thread_speed_ratio_log2,
+                  Path path, int cache_friendly_traversal_threshold,
+                  BlockMap* block_map) {
+  gemmlowp::ScopedProfilingLabel label("MakeBlockMap");
+  const int block_size_log2 = GetBlockSizeLog2(
+      rows, cols, depth, kernel_rows, kernel_cols, lhs_scalar_size,
+      rhs_scalar_size, tentative_thread_count, thread_speed_ratio_log2, path);
+  MakeBlockMapWithBlockSize(rows, cols, depth, kernel_rows, kernel_cols,
+                            lhs_scalar_size, rhs_scalar_size,
+                            tentative_thread_count, block_size_log2,
+                            cache_friendly_traversal_threshold, block_map);
+}
+
 void GetBlockMatrixCoords(Side side, const BlockMap& block_map, int block,
                           int* start, int* end) {
   gemmlowp::ScopedProfilingLabel label("GetBlockMatrixCoords");
@@ -105,10 +105,39 @@ struct BlockMap {
 
 // Create a BlockMap suitable for tiling the destination matrix in a
 // matrix multiplication with the given parameters.
+//
+// thread_speed_ratio_log2 is the log2 of how much faster the fastest thread
+// may be than the slowest one, e.g. 1 when threads may run on the big or the
+// little cores of an ARM big.LITTLE CPU that are up to twice as slow. Blocks
+// are dispatched dynamically to threads, so more, smaller blocks let the
+// fast threads take over the work the slow ones would otherwise finish last.
 void MakeBlockMap(int rows, int cols, int depth, int kernel_rows,
                   int kernel_cols, int lhs_scalar_size, int rhs_scalar_size,
-                  int tentative_thread_count, Path path,
-                  int cache_friendly_traversal_threshold, BlockMap* block_map);
+                  int tentative_thread_count, int thread_speed_ratio_log2,
+                  Path path, int cache_friendly_traversal_threshold,
+                  BlockMap* block_map);
+
+// The range of block sizes, as log2 of the number of rows and columns of a
+// block, that MakeBlockMap chooses from.
+void GetBlockSizeLog2Range(int rows, int cols, int kernel_rows,
+                           int kernel_cols, int* min_block_size_log2,
+                           int* max_block_size_log2);
+
+// Returns the block size that MakeBlockMap chooses by its heuristics.
+int GetBlockSizeLog2(int rows, int cols, int depth, int kernel_rows,
+                     int kernel_cols, int lhs_scalar_size, int rhs_scalar_size,
+                     int tentative_thread_count, int thread_speed_ratio_log2,
+                     Path path);
+
+// As MakeBlockMap, but with the given block size instead of the heuristic
+// one, e.g. a block size measured to be faster for this shape. block_size_log2
+// must be within the range of GetBlockSizeLog2Range.
+void MakeBlockMapWithBlockSize(int rows, int cols, int depth, int kernel_rows,
+                               int kernel_cols, int lhs_scalar_size,
+                               int rhs_scalar_size, int tentative_thread_count,
+                               int block_size_log2,
+                               int cache_friendly_traversal_threshold,
+                               BlockMap* block_map);
 
 // Maps an integer index to a block position in the grid.
 void GetBlockByIndex(const BlockMap& block_map, int index,
@@ -33,7 +33,8 @@ void MakeBlockMapTuningTest(int rows, int cols, int depth, int kernel_rows,
                             int expected_rectangularness_log2) {
   BlockMap block_map;
   MakeBlockMap(rows, cols, depth, kernel_rows, kernel_cols, lhs_scalar_size,
-               rhs_scalar_size, tentative_thread_count, path,
+               rhs_scalar_size, tentative_thread_count,
+               /* thread_speed_ratio_log2 */ 0, path,
                /* cache_friendly_traversal_threshold */ 32768, &block_map);
   EXPECT_EQ(block_map.num_blocks_base_log2, expected_num_blocks_base_log2);
   EXPECT_EQ(std::min(block_map.rectangularness_log2[Side::kLhs],
@@ -134,6 +135,42 @@ TEST(BlockMapTest, MakeBlockMapTuningTestRectangular) {
 }
 #endif
 
+TEST(BlockMapTest, MoreBlocksForThreadsOfDifferentSpeeds) {
+  int previous_num_blocks = 0;
+  for (int thread_speed_ratio_log2 = 0; thread_speed_ratio_log2 <= 2;
+       ++thread_speed_ratio_log2) {
+    BlockMap block_map;
+    MakeBlockMap(512, 512, 512, 8, 8, 1, 1, /* tentative_thread_count */ 4,
+                 thread_speed_ratio_log2, Path::kStandardCpp,
+                 /* cache_friendly_traversal_threshold */ 32768, &block_map);
+    EXPECT_GE(NumBlocks(block_map), previous_num_blocks);
+    previous_num_blocks = NumBlocks(block_map);
+  }
+}
+
+TEST(BlockMapTest, ExplicitBlockSize) {
+  int min_block_size_log2 = 0;
+  int max_block_size_log2 = 0;
+  GetBlockSizeLog2Range(512, 256, 8, 8, &min_block_size_log2,
+                        &max_block_size_log2);
+  EXPECT_EQ(min_block_size_log2, 3);
+  EXPECT_EQ(max_block_size_log2, 8);
+  // Halving the block size quadruples the number of blocks.
+  int previous_num_blocks = 0;
+  for (int block_size_log2 = max_block_size_log2;
+       block_size_log2 >= min_block_size_log2; --block_size_log2) {
+    BlockMap block_map;
+    MakeBlockMapWithBlockSize(512, 256, 512, 8, 8, 1, 1,
+                              /* tentative_thread_count */ 4, block_size_log2,
+                              /* cache_friendly_traversal_threshold */ 32768,
+                              &block_map);
+    if (previous_num_blocks) {
+      EXPECT_EQ(NumBlocks(block_map), 4 * previous_num_blocks);
+    }
+    previous_num_blocks = NumBlocks(block_map);
+  }
+}
+
 }  // namespace
 }  // namespace ruy
 
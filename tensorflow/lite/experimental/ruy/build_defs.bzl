@@ -2,6 +2,7 @@
 
 def ruy_visibility():
     return [
+        "//tensorflow/core/kernels:__pkg__",
         "//tensorflow/lite/kernels:__subpackages__",
     ]
 
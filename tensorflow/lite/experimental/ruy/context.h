@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/lite/experimental/ruy/thread_pool.h"
 #include "tensorflow/lite/experimental/ruy/trace.h"
 #include "tensorflow/lite/experimental/ruy/tune.h"
+#include "tensorflow/lite/experimental/ruy/tuning_cache.h"
 
 namespace ruy {
 
@@ -49,9 +50,15 @@ struct Context final {
   // TODO(benoitjacob) rename that thread_pool. Current name is gemmlowp legacy.
   ThreadPool workers_pool;
   int max_num_threads = 1;
+  // The log2 of how much faster the fastest thread may be than the slowest,
+  // e.g. because of ARM big.LITTLE cores. See MakeBlockMap.
+  int thread_speed_ratio_log2 = 0;
   // State for each thread in the thread pool. Entry 0 is the main thread.
   std::vector<std::unique_ptr<PerThreadState>> per_thread_states;
   TracingContext tracing;
+  // Block sizes and kernel tunings per shape, measured or loaded from a file.
+  // Disabled by default. See tuning_cache.h.
+  TuningCache tuning_cache;
 
   Allocator* GetMainAllocator() {
     if (!main_allocator_) {
@@ -42,6 +42,7 @@ limitations under the License.
 #include "tensorflow/lite/experimental/ruy/check_macros.h"
 #include "tensorflow/lite/experimental/ruy/common.h"
 #include "tensorflow/lite/experimental/ruy/context.h"
+#include "tensorflow/lite/experimental/ruy/epilogue.h"
 #include "tensorflow/lite/experimental/ruy/internal_matrix.h"
 #include "tensorflow/lite/experimental/ruy/kernel.h"
 #include "tensorflow/lite/experimental/ruy/kernel_common.h"
@@ -122,6 +123,14 @@ void EnforceDstSpecSupport(const Spec& spec, DstScalar dst_zero_point) {
   RUY_DCHECK_EQ(spec.multiplier_exponent_perchannel, nullptr);
 }
 
+template <typename Spec>
+void EnforceEpilogueSupport(const Spec& spec) {
+  if (std::is_floating_point<typename Spec::DstScalar>::value) return;
+
+  // See epilogue.h.
+  RUY_DCHECK(!HasEpilogue(spec));
+}
+
 inline bool IsColMajorTrMul(const TrMulParams& params) {
   return IsColMajor(params.src[Side::kLhs].layout) &&
          IsColMajor(params.src[Side::kRhs].layout) &&
@@ -337,6 +346,7 @@ template <typename LhsScalar, typename RhsScalar, typename DstScalar,
 void ReferenceMul(const Matrix<LhsScalar>& lhs, const Matrix<RhsScalar>& rhs,
                   const Spec& spec, Matrix<DstScalar>* dst) {
   gemmlowp::ScopedProfilingLabel label("ReferenceMul");
+  const bool has_epilogue = HasEpilogue(spec);
   for (int i = 0; i < lhs.layout.rows; i++) {
     for (int j = 0; j < rhs.layout.cols; j++) {
       using AccumScalar = typename Spec::AccumScalar;
@@ -351,11 +361,16 @@ void ReferenceMul(const Matrix<LhsScalar>& lhs, const Matrix<RhsScalar>& rhs,
       }
       ApplyMultiplier(spec, i, &accum);
       accum += dst->zero_point;
-      accum = std::min<AccumScalar>(accum, spec.clamp_max);
-      accum = std::max<AccumScalar>(accum, spec.clamp_min);
+      if (!has_epilogue) {
+        accum = std::min<AccumScalar>(accum, spec.clamp_max);
+        accum = std::max<AccumScalar>(accum, spec.clamp_min);
+      }
       *ElementPtr(dst, i, j) = static_cast<DstScalar>(accum);
     }
   }
+  if (has_epilogue) {
+    ApplyEpilogue(spec, 0, 0, dst->layout.rows, dst->layout.cols, dst);
+  }
 }
 
 // Compile-time dispatch to ReferenceMul. This allows us to statically ensure
@@ -396,6 +411,7 @@ void DispatchMul(const Matrix<LhsScalar>& lhs, const Matrix<RhsScalar>& rhs,
   EnforceZeroPointSupport<Spec>(lhs.zero_point, rhs.zero_point,
                                 dst->zero_point);
   EnforceDstSpecSupport<Spec>(spec, dst->zero_point);
+  EnforceEpilogueSupport(spec);
 
   // This should be a constant, for a given machine and CompiledPaths.
   // There is a back door to override it for testing, but in production it will
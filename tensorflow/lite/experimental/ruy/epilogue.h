@@ -0,0 +1,127 @@
+/* Copyright 2019 Google LLC. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// The epilogue described by the channel_scale, channel_shift, residual and
+// activation fields of BasicSpec.
+//
+// Kernels only apply the bias, the multiplier and the clamp in-register.
+// The epilogue is applied to each block of the destination matrix right after
+// the kernel has written it, while the block is still in the local data cache
+// of the thread that computed it. That avoids the separate pass over the
+// whole destination matrix that callers would otherwise make, at the cost of
+// a pass over the cache-hot block.
+
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_RUY_EPILOGUE_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_RUY_EPILOGUE_H_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+#include "profiling/instrumentation.h"
+#include "tensorflow/lite/experimental/ruy/check_macros.h"
+#include "tensorflow/lite/experimental/ruy/internal_matrix.h"
+#include "tensorflow/lite/experimental/ruy/matrix.h"
+#include "tensorflow/lite/experimental/ruy/spec.h"
+
+namespace ruy {
+
+template <typename Spec>
+bool HasEpilogue(const Spec& spec) {
+  return spec.channel_scale || spec.channel_shift || spec.residual ||
+         spec.activation != Activation::kNone;
+}
+
+// Returns the spec to pass to the kernels when the epilogue is applied after
+// them: the clamp has to come last, so it moves to the epilogue.
+template <typename Spec>
+Spec KernelSpecForEpilogue(const Spec& spec) {
+  using DstScalar = typename Spec::DstScalar;
+  Spec kernel_spec = spec;
+  kernel_spec.clamp_min = -std::numeric_limits<DstScalar>::infinity();
+  kernel_spec.clamp_max = std::numeric_limits<DstScalar>::infinity();
+  return kernel_spec;
+}
+
+template <typename Scalar>
+Scalar ApplyActivation(Activation activation, Scalar x) {
+  switch (activation) {
+    case Activation::kTanh:
+      return std::tanh(x);
+    case Activation::kLogistic:
+      return 1 / (1 + std::exp(-x));
+    default:
+      return x;
+  }
+}
+
+// Only floating-point destinations have an epilogue: on quantized values,
+// neither the per-channel affine transform nor the activations are
+// meaningful without the quantization parameters of their inputs.
+template <typename Spec, bool IsApplicable = std::is_floating_point<
+                             typename Spec::DstScalar>::value>
+struct ApplyEpilogueImpl {};
+
+template <typename Spec>
+struct ApplyEpilogueImpl<Spec, false> {
+  using DstScalar = typename Spec::DstScalar;
+  static void Run(const Spec& spec, int, int, int, int, Matrix<DstScalar>*) {
+    RUY_DCHECK(!HasEpilogue(spec));
+  }
+};
+
+template <typename Spec>
+struct ApplyEpilogueImpl<Spec, true> {
+  using DstScalar = typename Spec::DstScalar;
+  static void Run(const Spec& spec, int start_row, int start_col, int end_row,
+                  int end_col, Matrix<DstScalar>* dst) {
+    gemmlowp::ScopedProfilingLabel label("ApplyEpilogue");
+    // As in kernels, end_row and end_col may be larger than dst dimensions.
+    const int clamped_end_row = std::min(end_row, dst->layout.rows);
+    const int clamped_end_col = std::min(end_col, dst->layout.cols);
+    for (int col = start_col; col < clamped_end_col; col++) {
+      for (int row = start_row; row < clamped_end_row; row++) {
+        const int offset = Offset(dst->layout, row, col);
+        DstScalar value = dst->data.get()[offset];
+        if (spec.channel_scale) {
+          value *= spec.channel_scale[row];
+        }
+        if (spec.channel_shift) {
+          value += spec.channel_shift[row];
+        }
+        if (spec.residual) {
+          value += spec.residual[offset];
+        }
+        value = ApplyActivation(spec.activation, value);
+        value = std::min(value, spec.clamp_max);
+        value = std::max(value, spec.clamp_min);
+        dst->data.get()[offset] = value;
+      }
+    }
+  }
+};
+
+// Applies the epilogue of `spec` to the given block of `dst`.
+template <typename Spec>
+void ApplyEpilogue(const Spec& spec, int start_row, int start_col, int end_row,
+                   int end_col, Matrix<typename Spec::DstScalar>* dst) {
+  ApplyEpilogueImpl<Spec>::Run(spec, start_row, start_col, end_row, end_col,
+                               dst);
+}
+
+}  // namespace ruy
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_RUY_EPILOGUE_H_
@@ -0,0 +1,156 @@
+/* Copyright 2019 Google LLC. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/experimental/ruy/context.h"
+#include "tensorflow/lite/experimental/ruy/matrix.h"
+#include "tensorflow/lite/experimental/ruy/path.h"
+#include "tensorflow/lite/experimental/ruy/ruy.h"
+#include "tensorflow/lite/experimental/ruy/spec.h"
+
+namespace ruy {
+namespace {
+
+using Spec = BasicSpec<float, float>;
+
+// Odd sizes, so that the blocks of the destination are not all full.
+constexpr int kRows = 37;
+constexpr int kDepth = 19;
+constexpr int kCols = 23;
+
+std::vector<float> Iota(int size, float scale) {
+  std::vector<float> result(size);
+  for (int i = 0; i < size; i++) {
+    result[i] = scale * ((i * 7) % 13 - 6);
+  }
+  return result;
+}
+
+class EpilogueTest : public ::testing::TestWithParam<Path> {
+ protected:
+  EpilogueTest()
+      : lhs_data_(Iota(kRows * kDepth, 0.05f)),
+        rhs_data_(Iota(kDepth * kCols, 0.03f)),
+        bias_(Iota(kRows, 0.1f)),
+        channel_scale_(Iota(kRows, 0.2f)),
+        channel_shift_(Iota(kRows, 0.3f)),
+        residual_(Iota(kRows * kCols, 0.07f)) {
+    MakeSimpleLayout(kRows, kDepth, Order::kRowMajor, &lhs_.layout);
+    lhs_.data = lhs_data_.data();
+    MakeSimpleLayout(kDepth, kCols, Order::kColMajor, &rhs_.layout);
+    rhs_.data = rhs_data_.data();
+    spec_.bias = bias_.data();
+  }
+
+  // Returns the result of Mul for `spec_`, in column-major order.
+  std::vector<float> Mul() {
+    std::vector<float> dst_data(kRows * kCols);
+    Matrix<float> dst;
+    MakeSimpleLayout(kRows, kCols, Order::kColMajor, &dst.layout);
+    dst.data = dst_data.data();
+    Context context;
+    context.SetRuntimeEnabledPaths(GetParam());
+    ruy::Mul<kAllPaths>(lhs_, rhs_, spec_, &context, &dst);
+    EXPECT_EQ(context.last_taken_path, GetParam());
+    return dst_data;
+  }
+
+  // Returns the accumulator, bias included, at (row, col).
+  float Accum(int row, int col) const {
+    float accum = bias_[row];
+    for (int k = 0; k < kDepth; k++) {
+      accum += lhs_data_[row * kDepth + k] * rhs_data_[col * kDepth + k];
+    }
+    return accum;
+  }
+
+  std::vector<float> lhs_data_;
+  std::vector<float> rhs_data_;
+  std::vector<float> bias_;
+  std::vector<float> channel_scale_;
+  std::vector<float> channel_shift_;
+  std::vector<float> residual_;
+  Matrix<float> lhs_;
+  Matrix<float> rhs_;
+  Spec spec_;
+};
+
+TEST_P(EpilogueTest, ScaleShiftResidual) {
+  spec_.channel_scale = channel_scale_.data();
+  spec_.channel_shift = channel_shift_.data();
+  spec_.residual = residual_.data();
+  const std::vector<float> dst = Mul();
+  for (int col = 0; col < kCols; col++) {
+    for (int row = 0; row < kRows; row++) {
+      const float expected = channel_scale_[row] * Accum(row, col) +
+                             channel_shift_[row] +
+                             residual_[col * kRows + row];
+      EXPECT_NEAR(dst[col * kRows + row], expected, 1e-4f);
+    }
+  }
+}
+
+TEST_P(EpilogueTest, TanhAppliesBeforeClamp) {
+  spec_.activation = Activation::kTanh;
+  spec_.clamp_min = -0.5f;
+  spec_.clamp_max = 0.25f;
+  const std::vector<float> dst = Mul();
+  for (int col = 0; col < kCols; col++) {
+    for (int row = 0; row < kRows; row++) {
+      const float expected =
+          std::min(0.25f, std::max(-0.5f, std::tanh(Accum(row, col))));
+      EXPECT_NEAR(dst[col * kRows + row], expected, 1e-5f);
+    }
+  }
+}
+
+TEST_P(EpilogueTest, Logistic) {
+  spec_.residual = residual_.data();
+  spec_.activation = Activation::kLogistic;
+  const std::vector<float> dst = Mul();
+  for (int col = 0; col < kCols; col++) {
+    for (int row = 0; row < kRows; row++) {
+      const float x = Accum(row, col) + residual_[col * kRows + row];
+      EXPECT_NEAR(dst[col * kRows + row], 1 / (1 + std::exp(-x)), 1e-5f);
+    }
+  }
+}
+
+std::vector<Path> EnabledPaths() {
+  const Path enabled_paths = kAllPaths & Context().GetRuntimeEnabledPaths();
+  std::vector<Path> paths;
+  for (int bit = 0; bit < 8; bit++) {
+    const Path path = static_cast<Path>(1 << bit);
+    if ((enabled_paths & path) != Path::kNone) {
+      paths.push_back(path);
+    }
+  }
+  return paths;
+}
+
+INSTANTIATE_TEST_SUITE_P(AllPaths, EpilogueTest,
+                         ::testing::ValuesIn(EnabledPaths()));
+
+}  // namespace
+}  // namespace ruy
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -24,6 +24,7 @@ limitations under the License.
 #include "profiling/instrumentation.h"
 #include "tensorflow/lite/experimental/ruy/check_macros.h"
 #include "tensorflow/lite/experimental/ruy/common.h"
+#include "tensorflow/lite/experimental/ruy/epilogue.h"
 #include "tensorflow/lite/experimental/ruy/internal_matrix.h"
 #include "tensorflow/lite/experimental/ruy/matrix.h"
 #include "tensorflow/lite/experimental/ruy/opt_set.h"
@@ -84,11 +85,22 @@ void RunKernel(Tuning tuning, const SidePair<PMatrix>& src, void* spec,
                const SidePair<int>& start, const SidePair<int>& end,
                DMatrix* dst) {
   Matrix<DstScalar> mdst = ToMatrix<DstScalar>(*dst);
+  const Spec& typed_spec = *static_cast<const Spec*>(spec);
+  if (!HasEpilogue(typed_spec)) {
+    RunKernelTyped<ThePath, LhsScalar, RhsScalar, DstScalar, Spec>(
+        tuning, ToPackedMatrix<LhsScalar>(src[Side::kLhs]),
+        ToPackedMatrix<RhsScalar>(src[Side::kRhs]), typed_spec,
+        start[Side::kLhs], start[Side::kRhs], end[Side::kLhs],
+        end[Side::kRhs], &mdst);
+    return;
+  }
   RunKernelTyped<ThePath, LhsScalar, RhsScalar, DstScalar, Spec>(
       tuning, ToPackedMatrix<LhsScalar>(src[Side::kLhs]),
       ToPackedMatrix<RhsScalar>(src[Side::kRhs]),
-      *static_cast<const Spec*>(spec), start[Side::kLhs], start[Side::kRhs],
+      KernelSpecForEpilogue(typed_spec), start[Side::kLhs], start[Side::kRhs],
       end[Side::kLhs], end[Side::kRhs], &mdst);
+  ApplyEpilogue(typed_spec, start[Side::kLhs], start[Side::kRhs],
+                end[Side::kLhs], end[Side::kRhs], &mdst);
 }
 
 // Copied from TF Lite code.
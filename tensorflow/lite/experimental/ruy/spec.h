@@ -48,6 +48,11 @@ enum class ZeroPointSupport { kGeneral, kSymmetric };
 //    - Destination is ColMajor
 enum class LayoutSupport { kGeneral, kRCC };
 
+// Activation functions that the epilogue may apply, see BasicSpec. Piecewise
+// linear activations such as ReLU6 are better expressed with clamp_min and
+// clamp_max, which the kernels apply in-register.
+enum class Activation { kNone, kTanh, kLogistic };
+
 // A Spec describes all about a matrix multiplication operation that isn't
 // encoded in the LHS, RHS and destination matrices. Some of that information
 // is encoded as compile-time constants and types (for instance, the choice
@@ -90,6 +95,23 @@ struct BasicSpec {
   DstScalar clamp_max = std::is_floating_point<DstScalar>::value
                             ? std::numeric_limits<DstScalar>::infinity()
                             : std::numeric_limits<DstScalar>::max();
+  // The epilogue, only for floating-point destinations. If any of the
+  // following fields is set, each destination value becomes
+  //   clamp(activation(channel_scale[row] * accum + channel_shift[row] +
+  //                    residual(row, col)))
+  // where accum includes the bias. It is applied to each block of the
+  // destination right after the kernel has written it, see epilogue.h.
+  //
+  // Per-channel multiplier, if not nullptr, e.g. a folded batch normalization
+  // scale. Must have as many values as there are rows in the destination.
+  const DstScalar* channel_scale = nullptr;
+  // Per-channel addend, if not nullptr. Must have as many values as there are
+  // rows in the destination.
+  const DstScalar* channel_shift = nullptr;
+  // Matrix to add elementwise, if not nullptr, e.g. the shortcut of a residual
+  // block. Must have the same layout as the destination.
+  const DstScalar* residual = nullptr;
+  Activation activation = Activation::kNone;
   // See above enum LoopStructure
   static constexpr LoopStructure kLoopStructure = LoopStructure::kAuto;
   // See above enum LayoutSupport
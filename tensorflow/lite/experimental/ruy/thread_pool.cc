@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/lite/experimental/ruy/thread_pool.h"
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>              // NOLINT(build/c++11)
 #include <condition_variable>  // NOLINT(build/c++11)
@@ -24,11 +25,47 @@ limitations under the License.
 #include <mutex>               // NOLINT(build/c++11)
 #include <thread>              // NOLINT(build/c++11)
 
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #include "tensorflow/lite/experimental/ruy/check_macros.h"
 #include "tensorflow/lite/experimental/ruy/wait.h"
 
 namespace ruy {
 
+namespace {
+
+// Restricts the calling thread to the given CPUs, or to all CPUs if empty.
+void ApplyCpuAffinity(const std::vector<int>& cpus) {
+#ifdef __linux__
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  if (cpus.empty()) {
+    const int num_cpus =
+        std::min<int>(CPU_SETSIZE, sysconf(_SC_NPROCESSORS_CONF));
+    for (int cpu = 0; cpu < num_cpus; ++cpu) {
+      CPU_SET(cpu, &cpu_set);
+    }
+  } else {
+    for (int cpu : cpus) {
+      if (cpu >= 0 && cpu < CPU_SETSIZE) {
+        CPU_SET(cpu, &cpu_set);
+      }
+    }
+  }
+  // Errors, e.g. for CPUs that are offline, are ignored: the thread then
+  // keeps its current affinity, which is still correct, if slower. The thread
+  // id is used rather than pthread_setaffinity_np, which Android lacks.
+  syscall(__NR_sched_setaffinity, syscall(__NR_gettid), sizeof(cpu_set),
+          &cpu_set);
+#endif
+}
+
+}  // namespace
+
 // A worker thread.
 class Thread {
  public:
@@ -39,10 +76,12 @@ class Thread {
     ExitAsSoonAsPossible  // Should exit at earliest convenience.
   };
 
-  explicit Thread(BlockingCounter* counter_to_decrement_when_ready)
+  Thread(BlockingCounter* counter_to_decrement_when_ready,
+         const CpuAffinity* cpu_affinity)
       : task_(nullptr),
         state_(State::Startup),
-        counter_to_decrement_when_ready_(counter_to_decrement_when_ready) {
+        counter_to_decrement_when_ready_(counter_to_decrement_when_ready),
+        cpu_affinity_(cpu_affinity) {
     thread_.reset(new std::thread(ThreadFunc, this));
   }
 
@@ -79,6 +118,12 @@ class Thread {
     switch (new_state) {
       case State::Ready:
         if (task_) {
+          // The affinity only changes between Execute calls, and so is
+          // synchronized by state_mutex_ like task_.
+          if (applied_cpu_affinity_generation_ != cpu_affinity_->generation) {
+            ApplyCpuAffinity(cpu_affinity_->cpus);
+            applied_cpu_affinity_generation_ = cpu_affinity_->generation;
+          }
           // Doing work is part of reverting to 'ready' state.
           task_->Run();
           task_ = nullptr;
@@ -151,6 +196,11 @@ class Thread {
   // pointer to the master's thread BlockingCounter object, to notify the
   // master thread of when this thread switches to the 'Ready' state.
   BlockingCounter* const counter_to_decrement_when_ready_;
+
+  // The CPUs this thread may run on, owned by the ThreadPool, and the
+  // generation of it this thread last applied.
+  const CpuAffinity* const cpu_affinity_;
+  int applied_cpu_affinity_generation_ = 0;
 };
 
 void ThreadPool::ExecuteImpl(int task_count, int stride, Task* tasks) {
@@ -186,11 +236,20 @@ void ThreadPool::CreateThreads(int threads_count) {
   }
   counter_to_decrement_when_ready_.Reset(threads_count - threads_.size());
   while (threads_.size() < threads_count) {
-    threads_.push_back(new Thread(&counter_to_decrement_when_ready_));
+    threads_.push_back(
+        new Thread(&counter_to_decrement_when_ready_, &cpu_affinity_));
   }
   counter_to_decrement_when_ready_.Wait();
 }
 
+void ThreadPool::SetCpuAffinity(const std::vector<int>& cpus) {
+  if (cpus == cpu_affinity_.cpus) {
+    return;
+  }
+  cpu_affinity_.cpus = cpus;
+  ++cpu_affinity_.generation;
+}
+
 ThreadPool::~ThreadPool() {
   for (auto w : threads_) {
     delete w;
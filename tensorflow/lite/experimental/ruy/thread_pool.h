@@ -33,6 +33,14 @@ struct Task {
 
 class Thread;
 
+// A set of CPUs that threads are restricted to, empty if unrestricted.
+// The generation is incremented whenever the set changes so that threads
+// can tell whether they have applied the latest set.
+struct CpuAffinity {
+  std::vector<int> cpus;
+  int generation = 0;
+};
+
 // A simple pool of threads, that only allows the very
 // specific parallelization pattern that we use here:
 // One thread, which we call the 'main thread', calls Execute, distributing
@@ -76,6 +84,13 @@ class ThreadPool {
     ExecuteImpl(task_count, sizeof(TaskType), static_cast<Task*>(tasks));
   }
 
+  // Restricts the worker threads to run on the given CPUs, e.g. on the big
+  // cores of an ARM big.LITTLE CPU. An empty set lifts the restriction. The
+  // main thread is not affected. Each worker thread applies the new set before
+  // running its next task. Only supported on Linux and Android, elsewhere this
+  // has no effect. Must not be called concurrently with Execute.
+  void SetCpuAffinity(const std::vector<int>& cpus);
+
  private:
   // Ensures that the pool has at least the given count of threads.
   // If any new thread has to be created, this function waits for it to
@@ -95,6 +110,9 @@ class ThreadPool {
 
   // The BlockingCounter used to wait for the threads.
   BlockingCounter counter_to_decrement_when_ready_;
+
+  // The CPUs the worker threads may run on, see SetCpuAffinity.
+  CpuAffinity cpu_affinity_;
 };
 
 }  // namespace ruy
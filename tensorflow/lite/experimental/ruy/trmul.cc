@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/lite/experimental/ruy/trmul.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
 #include <cstring>
@@ -35,6 +36,7 @@ limitations under the License.
 #include "tensorflow/lite/experimental/ruy/thread_pool.h"
 #include "tensorflow/lite/experimental/ruy/trace.h"
 #include "tensorflow/lite/experimental/ruy/tune.h"
+#include "tensorflow/lite/experimental/ruy/tuning_cache.h"
 
 namespace ruy {
 
@@ -268,6 +270,35 @@ LoopStructure GetLoopStructure(int tentative_thread_count, int rows, int cols,
   return LoopStructure::kGeneral;
 }
 
+// Returns the choices to explore for a shape: the block sizes around the one
+// of the heuristics, and both kernel tunings if they are resolved at runtime.
+std::vector<TrMulChoice> GetCandidateChoices(int rows, int cols,
+                                             int kernel_rows, int kernel_cols,
+                                             int heuristic_block_size_log2,
+                                             Tuning explicit_tuning) {
+  int min_block_size_log2 = 0;
+  int max_block_size_log2 = 0;
+  GetBlockSizeLog2Range(rows, cols, kernel_rows, kernel_cols,
+                        &min_block_size_log2, &max_block_size_log2);
+  std::vector<Tuning> tunings = {explicit_tuning};
+#ifdef RUY_IMPLEMENT_TUNING
+  if (explicit_tuning == Tuning::kAuto) {
+    tunings = {Tuning::kOutOfOrder, Tuning::kInOrder};
+  }
+#endif
+  std::vector<TrMulChoice> candidates;
+  for (int block_size_log2 = std::max(min_block_size_log2,
+                                      heuristic_block_size_log2 - 1);
+       block_size_log2 <=
+       std::min(max_block_size_log2, heuristic_block_size_log2 + 1);
+       block_size_log2++) {
+    for (Tuning tuning : tunings) {
+      candidates.push_back({block_size_log2, tuning});
+    }
+  }
+  return candidates;
+}
+
 }  // namespace
 
 void TrMul(TrMulParams* params, Context* context) {
@@ -322,20 +353,56 @@ void TrMul(TrMulParams* params, Context* context) {
   auto* trace = NewTraceOrNull(&context->tracing, rows, depth, cols);
   TraceRecordStart(trace);
 
+  // Choose the block size and the kernel tuning: by the heuristics, or as
+  // recorded in or being measured by the tuning cache.
+  const int block_map_rows = packed_lhs.layout.cols;
+  const int block_map_cols = packed_rhs.layout.cols;
+  const int kernel_rows = packed_lhs.layout.kernel.cols;
+  const int kernel_cols = packed_rhs.layout.kernel.cols;
+  const int lhs_scalar_size = packed_lhs.data_type.size;
+  const int rhs_scalar_size = packed_rhs.data_type.size;
+  TrMulChoice choice;
+  TuningCache& tuning_cache = context->tuning_cache;
+  const TrMulShape shape = {block_map_rows, block_map_cols, depth,
+                           lhs_scalar_size, rhs_scalar_size, params->path,
+                           tentative_thread_count};
+  const bool use_tuning_cache =
+      tuning_cache.mode() != TuningCache::Mode::kDisabled;
+  bool exploring = false;
+  if (!use_tuning_cache || !tuning_cache.Find(shape, &choice)) {
+    choice.block_size_log2 = GetBlockSizeLog2(
+        block_map_rows, block_map_cols, depth, kernel_rows, kernel_cols,
+        lhs_scalar_size, rhs_scalar_size, tentative_thread_count,
+        context->thread_speed_ratio_log2, params->path);
+    choice.tuning = context->explicit_tuning;
+    if (tuning_cache.mode() == TuningCache::Mode::kExplore) {
+      choice = tuning_cache.NextCandidate(
+          shape, GetCandidateChoices(block_map_rows, block_map_cols,
+                                     kernel_rows, kernel_cols,
+                                     choice.block_size_log2,
+                                     context->explicit_tuning));
+      exploring = true;
+    }
+  }
+  // An explicit tuning always takes precedence.
+  const Tuning tuning = context->explicit_tuning == Tuning::kAuto
+                            ? choice.tuning
+                            : context->explicit_tuning;
+
   // Initialize block map.
   BlockMap block_map;
-  MakeBlockMap(packed_lhs.layout.cols, packed_rhs.layout.cols, depth,
-               packed_lhs.layout.kernel.cols, packed_rhs.layout.kernel.cols,
-               packed_lhs.data_type.size, packed_rhs.data_type.size,
-               tentative_thread_count, params->path,
-               params->cache_friendly_traversal_threshold, &block_map);
+  MakeBlockMapWithBlockSize(block_map_rows, block_map_cols, depth, kernel_rows,
+                            kernel_cols, lhs_scalar_size, rhs_scalar_size,
+                            tentative_thread_count, choice.block_size_log2,
+                            params->cache_friendly_traversal_threshold,
+                            &block_map);
 
   // Initialize per-thread state.
   const int thread_count = block_map.thread_count;
   const bool need_atomics = thread_count > 1;
   context->EnsureNPerThreadStates(thread_count);
   for (auto& per_thread_state : context->per_thread_states) {
-    per_thread_state->tuning_resolver.SetTuning(context->explicit_tuning);
+    per_thread_state->tuning_resolver.SetTuning(tuning);
   }
 
   // In the need_atomics case, allocate and initialize atomic values tracking
@@ -375,7 +442,11 @@ void TrMul(TrMulParams* params, Context* context) {
 
   // Do the computation.
   TraceRecordExecute(block_map, trace);
+  const TimePoint execute_start = exploring ? Now() : TimePoint();
   context->workers_pool.Execute(thread_count, tasks);
+  if (exploring) {
+    tuning_cache.ReportDuration(shape, Now() - execute_start);
+  }
 
   // Finish up.
   for (int i = 0; i < thread_count; i++) {
@@ -0,0 +1,175 @@
+/* Copyright 2019 Google LLC. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/ruy/tuning_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+#include <utility>
+
+#include "tensorflow/lite/experimental/ruy/check_macros.h"
+
+namespace ruy {
+
+bool operator==(const TrMulShape& a, const TrMulShape& b) {
+  return a.rows == b.rows && a.cols == b.cols && a.depth == b.depth &&
+         a.lhs_scalar_size == b.lhs_scalar_size &&
+         a.rhs_scalar_size == b.rhs_scalar_size && a.path == b.path &&
+         a.thread_count == b.thread_count;
+}
+
+std::size_t TrMulShapeHash::operator()(const TrMulShape& shape) const {
+  std::size_t hash = 0;
+  for (int value :
+       {shape.rows, shape.cols, shape.depth, shape.lhs_scalar_size,
+        shape.rhs_scalar_size, static_cast<int>(shape.path),
+        shape.thread_count}) {
+    hash = hash * 31 + static_cast<std::size_t>(value);
+  }
+  return hash;
+}
+
+bool TuningCache::Find(const TrMulShape& shape, TrMulChoice* choice) const {
+  const auto it = choices_.find(shape);
+  if (it == choices_.end()) {
+    return false;
+  }
+  *choice = it->second;
+  return true;
+}
+
+void TuningCache::Record(const TrMulShape& shape, const TrMulChoice& choice) {
+  choices_[shape] = choice;
+  explorations_.erase(shape);
+}
+
+void TuningCache::Clear() {
+  choices_.clear();
+  explorations_.clear();
+}
+
+TrMulChoice TuningCache::NextCandidate(
+    const TrMulShape& shape, const std::vector<TrMulChoice>& candidates) {
+  RUY_DCHECK(!choices_.count(shape));
+  Exploration& exploration = explorations_[shape];
+  if (exploration.candidates.empty()) {
+    RUY_DCHECK(!candidates.empty());
+    exploration.candidates = candidates;
+    exploration.best_durations.assign(candidates.size(), Duration::max());
+  }
+  return exploration.candidates[exploration.num_measurements %
+                                exploration.candidates.size()];
+}
+
+void TuningCache::ReportDuration(const TrMulShape& shape, Duration duration) {
+  const auto it = explorations_.find(shape);
+  RUY_DCHECK(it != explorations_.end());
+  Exploration& exploration = it->second;
+  const int num_candidates = exploration.candidates.size();
+  Duration& best_duration =
+      exploration.best_durations[exploration.num_measurements %
+                                 num_candidates];
+  best_duration = std::min(best_duration, duration);
+  exploration.num_measurements++;
+  if (exploration.num_measurements <
+      kMeasurementsPerCandidate * num_candidates) {
+    return;
+  }
+  int best = 0;
+  for (int i = 1; i < num_candidates; i++) {
+    if (exploration.best_durations[i] < exploration.best_durations[best]) {
+      best = i;
+    }
+  }
+  // Invalidates `exploration`.
+  Record(shape, exploration.candidates[best]);
+}
+
+std::string TuningCache::Serialize() const {
+  std::ostringstream stream;
+  for (const auto& entry : choices_) {
+    const TrMulShape& shape = entry.first;
+    const TrMulChoice& choice = entry.second;
+    stream << shape.rows << ' ' << shape.cols << ' ' << shape.depth << ' '
+           << shape.lhs_scalar_size << ' ' << shape.rhs_scalar_size << ' '
+           << static_cast<int>(shape.path) << ' ' << shape.thread_count << ' '
+           << choice.block_size_log2 << ' ' << static_cast<int>(choice.tuning)
+           << '\n';
+  }
+  return stream.str();
+}
+
+bool TuningCache::Deserialize(const std::string& serialized) {
+  std::vector<std::pair<TrMulShape, TrMulChoice>> entries;
+  std::istringstream stream(serialized);
+  std::string line;
+  while (std::getline(stream, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    std::istringstream line_stream(line);
+    TrMulShape shape;
+    TrMulChoice choice;
+    int path, tuning;
+    if (!(line_stream >> shape.rows >> shape.cols >> shape.depth >>
+          shape.lhs_scalar_size >> shape.rhs_scalar_size >> path >>
+          shape.thread_count >> choice.block_size_log2 >> tuning)) {
+      return false;
+    }
+    if (path <= 0 || path > 0xff || tuning < 0 ||
+        tuning > static_cast<int>(Tuning::kInOrder)) {
+      return false;
+    }
+    shape.path = static_cast<Path>(path);
+    choice.tuning = static_cast<Tuning>(tuning);
+    entries.emplace_back(shape, choice);
+  }
+  for (const auto& entry : entries) {
+    Record(entry.first, entry.second);
+  }
+  return true;
+}
+
+bool TuningCache::SaveToFile(const std::string& filename) const {
+  FILE* file = fopen(filename.c_str(), "w");
+  if (!file) {
+    return false;
+  }
+  const std::string serialized = Serialize();
+  const bool written =
+      fwrite(serialized.data(), 1, serialized.size(), file) ==
+      serialized.size();
+  return fclose(file) == 0 && written;
+}
+
+bool TuningCache::LoadFromFile(const std::string& filename) {
+  FILE* file = fopen(filename.c_str(), "r");
+  if (!file) {
+    return false;
+  }
+  std::string serialized;
+  char buffer[4096];
+  std::size_t size;
+  while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    serialized.append(buffer, size);
+  }
+  const bool read = !ferror(file);
+  fclose(file);
+  return read && Deserialize(serialized);
+}
+
+}  // namespace ruy
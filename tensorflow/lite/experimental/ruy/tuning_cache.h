@@ -0,0 +1,130 @@
+/* Copyright 2019 Google LLC. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Cache of the block size and kernel tuning that TrMul uses for each shape.
+//
+// By default, TrMul picks its block map by the heuristics of MakeBlockMap and
+// its kernel tuning by the nano-benchmark of TuningResolver, at each call.
+// Both are compromises: the block map heuristics were tuned on a single CPU,
+// and the tuning nano-benchmark only measures a proxy of the kernels.
+//
+// A TuningCache records, per (shape, path, thread count), the choices to
+// use instead. In Mode::kExplore, TrMul measures the candidate choices for
+// each new shape on its first calls with that shape, and records the fastest.
+// The recorded choices can be saved to a file and loaded back, so that later
+// processes skip the exploration.
+//
+// The recorded choices are only meaningful on the machine that measured them.
+// Do not ship them to different devices.
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_RUY_TUNING_CACHE_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_RUY_TUNING_CACHE_H_
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/lite/experimental/ruy/path.h"
+#include "tensorflow/lite/experimental/ruy/time.h"
+#include "tensorflow/lite/experimental/ruy/tune.h"
+
+namespace ruy {
+
+// The parameters of a TrMul that its choices depend on. rows and cols are
+// those of the destination matrix, rounded up to whole kernel blocks.
+struct TrMulShape {
+  int rows;
+  int cols;
+  int depth;
+  int lhs_scalar_size;
+  int rhs_scalar_size;
+  Path path;
+  // The tentative thread count, before MakeBlockMap caps it at the number of
+  // blocks.
+  int thread_count;
+};
+
+bool operator==(const TrMulShape& a, const TrMulShape& b);
+
+struct TrMulShapeHash {
+  std::size_t operator()(const TrMulShape& shape) const;
+};
+
+struct TrMulChoice {
+  int block_size_log2;
+  // Tuning::kAuto leaves the choice to TuningResolver.
+  Tuning tuning;
+};
+
+class TuningCache {
+ public:
+  enum class Mode {
+    // TrMul ignores the cache. This is the default.
+    kDisabled,
+    // TrMul uses the recorded choices, and its heuristics for other shapes.
+    kUseRecorded,
+    // As kUseRecorded, but TrMul explores the shapes without a recorded
+    // choice.
+    kExplore
+  };
+
+  Mode mode() const { return mode_; }
+  void set_mode(Mode mode) { mode_ = mode; }
+
+  // Looks up the recorded choice for `shape`.
+  bool Find(const TrMulShape& shape, TrMulChoice* choice) const;
+  void Record(const TrMulShape& shape, const TrMulChoice& choice);
+  int size() const { return static_cast<int>(choices_.size()); }
+  void Clear();
+
+  // Returns the choice to measure next for `shape`, which must not have a
+  // recorded choice, starting its exploration over `candidates` if needed.
+  // The caller then runs with that choice and reports how long it took to
+  // ReportDuration. Once every candidate has been measured, the fastest one
+  // gets recorded.
+  TrMulChoice NextCandidate(const TrMulShape& shape,
+                            const std::vector<TrMulChoice>& candidates);
+  void ReportDuration(const TrMulShape& shape, Duration duration);
+
+  // One line of text per recorded choice.
+  std::string Serialize() const;
+  // Adds the choices of a string returned by Serialize. Returns false, and
+  // leaves the cache unchanged, if `serialized` is malformed.
+  bool Deserialize(const std::string& serialized);
+  bool SaveToFile(const std::string& filename) const;
+  bool LoadFromFile(const std::string& filename);
+
+ private:
+  // How many times each candidate gets measured. The best of these
+  // measurements counts, which filters out interruptions.
+  static constexpr int kMeasurementsPerCandidate = 3;
+
+  struct Exploration {
+    std::vector<TrMulChoice> candidates;
+    std::vector<Duration> best_durations;
+    // The number of measurements made so far. Candidates are measured in
+    // round-robin order, so that slow phases of the process (e.g. warmup) get
+    // spread across them.
+    int num_measurements = 0;
+  };
+
+  Mode mode_ = Mode::kDisabled;
+  std::unordered_map<TrMulShape, TrMulChoice, TrMulShapeHash> choices_;
+  std::unordered_map<TrMulShape, Exploration, TrMulShapeHash> explorations_;
+};
+
+}  // namespace ruy
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_RUY_TUNING_CACHE_H_
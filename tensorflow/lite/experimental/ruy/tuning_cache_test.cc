@@ -0,0 +1,98 @@
+/* Copyright 2019 Google LLC. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/ruy/tuning_cache.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/experimental/ruy/path.h"
+#include "tensorflow/lite/experimental/ruy/time.h"
+#include "tensorflow/lite/experimental/ruy/tune.h"
+
+namespace ruy {
+namespace {
+
+constexpr TrMulShape kShape = {256, 128, 512, 1, 1, Path::kStandardCpp, 4};
+
+TEST(TuningCacheTest, FindRecorded) {
+  TuningCache cache;
+  TrMulChoice choice;
+  EXPECT_FALSE(cache.Find(kShape, &choice));
+  cache.Record(kShape, {5, Tuning::kInOrder});
+  ASSERT_TRUE(cache.Find(kShape, &choice));
+  EXPECT_EQ(choice.block_size_log2, 5);
+  EXPECT_EQ(choice.tuning, Tuning::kInOrder);
+
+  TrMulShape other_thread_count = kShape;
+  other_thread_count.thread_count = 2;
+  EXPECT_FALSE(cache.Find(other_thread_count, &choice));
+  EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(TuningCacheTest, ExploreRecordsFastestCandidate) {
+  TuningCache cache;
+  const std::vector<TrMulChoice> candidates = {{4, Tuning::kAuto},
+                                               {5, Tuning::kAuto},
+                                               {6, Tuning::kAuto}};
+  TrMulChoice choice;
+  // Candidate 5 is the fastest, except for one slow measurement.
+  bool slowed_down = false;
+  while (!cache.Find(kShape, &choice)) {
+    const TrMulChoice candidate = cache.NextCandidate(kShape, candidates);
+    int microseconds = 10 * candidate.block_size_log2;
+    if (candidate.block_size_log2 == 5) {
+      microseconds = slowed_down ? 10 : 1000;
+      slowed_down = true;
+    }
+    cache.ReportDuration(kShape, DurationFromNanoseconds(1000 * microseconds));
+  }
+  EXPECT_EQ(choice.block_size_log2, 5);
+}
+
+TEST(TuningCacheTest, SerializeRoundTrip) {
+  TuningCache cache;
+  cache.Record(kShape, {5, Tuning::kOutOfOrder});
+  TrMulShape other_shape = kShape;
+  other_shape.depth = 64;
+  cache.Record(other_shape, {3, Tuning::kAuto});
+
+  TuningCache loaded;
+  ASSERT_TRUE(loaded.Deserialize(cache.Serialize()));
+  EXPECT_EQ(loaded.size(), 2);
+  TrMulChoice choice;
+  ASSERT_TRUE(loaded.Find(kShape, &choice));
+  EXPECT_EQ(choice.block_size_log2, 5);
+  EXPECT_EQ(choice.tuning, Tuning::kOutOfOrder);
+  ASSERT_TRUE(loaded.Find(other_shape, &choice));
+  EXPECT_EQ(choice.block_size_log2, 3);
+  EXPECT_EQ(choice.tuning, Tuning::kAuto);
+}
+
+TEST(TuningCacheTest, DeserializeMalformed) {
+  TuningCache cache;
+  EXPECT_FALSE(cache.Deserialize("256 128 512 1 1 2 4 5 0\n256 128\n"));
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_FALSE(cache.Deserialize("256 128 512 1 1 2 4 5 7\n"));
+  EXPECT_EQ(cache.size(), 0);
+}
+
+}  // namespace
+}  // namespace ruy
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
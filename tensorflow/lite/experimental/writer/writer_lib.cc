@@ -195,6 +195,9 @@ flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<Buffer>>>
 InterpreterWriter::ExportBuffers(flatbuffers::FlatBufferBuilder* fbb) {
   std::vector<flatbuffers::Offset<Buffer>> buffer_vector;
   for (auto buffer : buffers_) {
+    // Honor the 'force_align' of the schema, so that the interpreter can use
+    // the data of the written model in place when it is memory-mapped.
+    fbb->ForceVectorAlignment(buffer.second, sizeof(uint8_t), 16);
     auto data_offset = fbb->CreateVector(buffer.first, buffer.second);
     buffer_vector.push_back(CreateBuffer(*fbb, data_offset));
   }
@@ -20,10 +20,13 @@ namespace {
 TfLiteStatus RefreshExternalCpuBackendContext(TfLiteContext* context) {
   auto* const external_context = static_cast<ExternalCpuBackendContext*>(
       context->GetExternalContext(context, kTfLiteCpuBackendContext));
-  if (external_context && external_context->internal_backend_context() &&
-      context->recommended_num_threads != -1) {
-    external_context->internal_backend_context()->SetMaxNumThreads(
-        context->recommended_num_threads);
+  if (external_context && external_context->internal_backend_context()) {
+    if (context->recommended_num_threads != -1) {
+      external_context->internal_backend_context()->SetMaxNumThreads(
+          context->recommended_num_threads);
+    }
+    external_context->internal_backend_context()->SetCpuAffinity(
+        external_context->cpu_affinity());
   }
   return kTfLiteOk;
 }
@@ -15,8 +15,10 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_EXTERNAL_CPU_BACKEND_CONTEXT_H_
 #define TENSORFLOW_LITE_EXTERNAL_CPU_BACKEND_CONTEXT_H_
 
+#include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/lite/c/c_api_internal.h"
 
@@ -34,6 +36,21 @@ class TfLiteInternalBackendContext {
   // Set the maximum number of threads that could be used for parallelizing
   // TfLite computation.
   virtual void SetMaxNumThreads(int max_num_threads) = 0;
+
+  // Restricts the threads used for parallelizing TfLite computation to the
+  // given CPUs, or lifts the restriction if 'cpus' is empty. The default
+  // implementation ignores it.
+  virtual void SetCpuAffinity(const std::vector<int>& cpus) {}
+
+  // Calls 'task(i)' for every i in [0, num_tasks), possibly concurrently on
+  // threads owned by this context, and returns once all calls are done. These
+  // threads are not the ones used to parallelize individual TfLite ops. The
+  // default implementation makes the calls one after the other on the calling
+  // thread.
+  virtual void ExecuteTasks(int num_tasks,
+                            const std::function<void(int)>& task) {
+    for (int i = 0; i < num_tasks; ++i) task(i);
+  }
 };
 
 // This TfLiteExternalContext-derived class is the default
@@ -82,10 +99,18 @@ class ExternalCpuBackendContext : public TfLiteExternalContext {
     return internal_backend_context_.get();
   }
 
+  // The CPUs the internal backend context's threads are restricted to, empty
+  // if unrestricted. Like the number of threads, this takes effect on the
+  // next Refresh.
+  void set_cpu_affinity(const std::vector<int>& cpus) { cpu_affinity_ = cpus; }
+  const std::vector<int>& cpu_affinity() const { return cpu_affinity_; }
+
  private:
   // Note the actual internal backend context object is lazily initialized.
   std::unique_ptr<TfLiteInternalBackendContext> internal_backend_context_;
 
+  std::vector<int> cpu_affinity_;
+
   ExternalCpuBackendContext(const ExternalCpuBackendContext&) = delete;
   ExternalCpuBackendContext& operator=(const ExternalCpuBackendContext&) =
       delete;
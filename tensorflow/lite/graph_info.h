@@ -53,6 +53,12 @@ class GraphInfo {
 
   // Returns the indices of the variable tensors.
   virtual const std::vector<int>& variables() const = 0;
+
+  // Returns the index of the last node of the group containing node 'index'.
+  // A group is a range of consecutive nodes that may run concurrently, so
+  // the tensors they use must not share memory. By default every node is a
+  // group of its own.
+  virtual size_t node_group_end(size_t index) const { return index; }
 };
 
 // Represents a subset of nodes in a TensorFlow Lite graph.
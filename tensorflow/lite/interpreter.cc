@@ -251,12 +251,27 @@ void Interpreter::SetNumThreads(int num_threads) {
   }
 }
 
+void Interpreter::SetCpuAffinity(const std::vector<int>& cpus) {
+  auto* c = static_cast<ExternalCpuBackendContext*>(
+      external_contexts_[kTfLiteCpuBackendContext]);
+  if (c) {
+    c->set_cpu_affinity(cpus);
+    c->Refresh(context_);
+  }
+}
+
 void Interpreter::SetAllowFp16PrecisionForFp32(bool allow) {
   for (auto& subgraph : subgraphs_) {
     subgraph->context()->allow_fp32_relax_to_fp16 = allow;
   }
 }
 
+void Interpreter::SetKeepConstantTensorsInPlace(bool keep) {
+  for (auto& subgraph : subgraphs_) {
+    subgraph->context()->keep_constants_in_place = keep;
+  }
+}
+
 // TODO(b/121264966): Subgraphs added after cancellation is set will not get the
 // cancellation function added to their context.
 void Interpreter::SetCancellationFunction(void* data,
@@ -266,6 +281,12 @@ void Interpreter::SetCancellationFunction(void* data,
   }
 }
 
+void Interpreter::SetAllowInterOpParallelism(bool allow) {
+  for (auto& subgraph : subgraphs_) {
+    subgraph->SetAllowInterOpParallelism(allow);
+  }
+}
+
 TfLiteStatus Interpreter::ModifyGraphWithDelegate(TfLiteDelegate* delegate) {
   for (auto& subgraph : subgraphs_) {
     TF_LITE_ENSURE_OK(context_, subgraph->ModifyGraphWithDelegate(delegate));
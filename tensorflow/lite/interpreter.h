@@ -356,6 +356,12 @@ class Interpreter {
   /// Set the number of threads available to the interpreter.
   void SetNumThreads(int num_threads);
 
+  /// Restrict the threads of the CPU backend context to the given CPUs, e.g.
+  /// tflite::GetBigCpus() to keep them off the little cores of a big.LITTLE
+  /// CPU. An empty set lifts the restriction. The thread calling Invoke() is
+  /// not affected. Only supported on Linux and Android.
+  void SetCpuAffinity(const std::vector<int>& cpus);
+
   /// Allow float16 precision for FP32 calculation when possible.
   /// default: not allow.
   /// WARNING: This is an experimental API and subject to change.
@@ -367,6 +373,21 @@ class Interpreter {
     return context_->allow_fp32_relax_to_fp16;
   }
 
+  /// Keep the data of constant tensors in the model, e.g. in the memory-mapped
+  /// flatbuffer of FlatBufferModel::BuildFromFile(), instead of letting kernels
+  /// copy it into a layout that suits them better. This reduces the memory
+  /// and the startup time of large models, possibly at the cost of slower
+  /// kernels. Must be called before AllocateTensors().
+  /// default: false.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetKeepConstantTensorsInPlace(bool keep);
+
+  /// Get the flag set by SetKeepConstantTensorsInPlace().
+  /// WARNING: This is an experimental API and subject to change.
+  bool GetKeepConstantTensorsInPlace() const {
+    return context_->keep_constants_in_place;
+  }
+
   /// Sets the cancellation function pointer in order to cancel a request in the
   /// middle of a call to Invoke(). The interpreter queries this function during
   /// inference, between op invocations; when it returns true, the interpreter
@@ -376,6 +397,13 @@ class Interpreter {
   /// WARNING: This is an experimental API and subject to change.
   void SetCancellationFunction(void* data, bool (*check_cancelled_func)(void*));
 
+  /// Allow independent ops to run concurrently, each with its own intra-op
+  /// threads, when the number of threads is at least 2. Kernels must not share
+  /// mutable state other than through their tensors. Call AllocateTensors()
+  /// again after changing this. default: not allow.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetAllowInterOpParallelism(bool allow);
+
   /// Allow a delegate to look at the graph and modify the graph to handle
   /// parts of the graph themselves. After this is called, the graph may
   /// contain new nodes that replace 1 more nodes.
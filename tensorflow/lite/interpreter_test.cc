@@ -1993,6 +1993,45 @@ TEST_F(CancellationTest, CancelDuringInvoke) {
   ASSERT_EQ(invoke_error_code, kTfLiteError);
 }
 
+TEST(BasicInterpreter, InterOpParallelism) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(5), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0, 1}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({4}), kTfLiteOk);
+  TfLiteQuantizationParams quantized;
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {3}, quantized),
+              kTfLiteOk);
+  }
+  // The first two ops are independent, the third one uses both.
+  TfLiteRegistration reg = AddOpRegistration();
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0, 1}, {2}, nullptr, 0, nullptr,
+                                              &reg),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0, 0}, {3}, nullptr, 0, nullptr,
+                                              &reg),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({2, 3}, {4}, nullptr, 0, nullptr,
+                                              &reg),
+            kTfLiteOk);
+  interpreter.SetNumThreads(2);
+  interpreter.SetAllowInterOpParallelism(true);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  // The outputs of the concurrent ops must not share memory.
+  EXPECT_NE(interpreter.tensor(2)->data.raw, interpreter.tensor(3)->data.raw);
+
+  for (int i = 0; i < 3; ++i) {
+    interpreter.typed_tensor<float>(0)[i] = i;
+    interpreter.typed_tensor<float>(1)[i] = 10 * i;
+  }
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(interpreter.typed_tensor<float>(4)[i], 13 * i);
+  }
+}
+
 }  // namespace
 }  // namespace tflite
 
@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/optimized/multithreaded_conv.h"
 #endif
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/lite/kernels/internal/optimized/sparse_ops/fully_connected.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/reference/conv.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
@@ -41,6 +42,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/op_macros.h"
 #include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/shared_constants_context.h"
 
 namespace tflite {
 namespace ops {
@@ -266,12 +268,28 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
       (input->type == kTfLiteFloat32 &&
        (filter->type == kTfLiteUInt8 || filter->type == kTfLiteInt8));
 
-  // The multi-threaded kernel supports neither dilation nor hybrid kernels.
+  // Block sparse filters are only supported for float 1x1 convolutions with
+  // unit strides, which are fully connected layers applied to every pixel.
+  if (filter->sparsity) {
+    TF_LITE_ENSURE_EQ(context, input_type, kTfLiteFloat32);
+    TF_LITE_ENSURE_EQ(context, filter->type, kTfLiteFloat32);
+    TF_LITE_ENSURE_EQ(context, filter->dims->data[1], 1);
+    TF_LITE_ENSURE_EQ(context, filter->dims->data[2], 1);
+    TF_LITE_ENSURE_EQ(context, params->stride_width, 1);
+    TF_LITE_ENSURE_EQ(context, params->stride_height, 1);
+    TF_LITE_ENSURE_EQ(context, params->dilation_width_factor, 1);
+    TF_LITE_ENSURE_EQ(context, params->dilation_height_factor, 1);
+  }
+
+  // The multi-threaded kernel supports neither dilation, hybrid kernels nor
+  // sparse filters. It also needs a transposed copy of the filter, which a
+  // constant filter must not get if the context keeps constants in place.
   data->supports_multithreaded_kernel =
       (kernel_type == kMultithreadOptimized) &&
       (context->recommended_num_threads != 1) && !is_hybrid &&
-      (params->dilation_width_factor == 1) &&
-      (params->dilation_height_factor == 1);
+      !filter->sparsity && (params->dilation_width_factor == 1) &&
+      (params->dilation_height_factor == 1) &&
+      !(context->keep_constants_in_place && IsConstantTensor(filter));
 
   TF_LITE_ENSURE_STATUS(
       AllocateTemporaryTensorsIfRequired(context, node, is_hybrid));
@@ -368,9 +386,25 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
         context->ResizeTensor(context, hwcn_weights, hwcn_weights_size);
     if (hwcn_weights_status != kTfLiteOk) return hwcn_weights_status;
 
-    // TODO(petewarden): If Resize() is called when the size hasn't actually
-    // changed, this will do extra redundant work.
-    data->have_weights_been_transposed = false;
+    // If the filter is constant and a SharedConstantsContext is available,
+    // the transposed weights are shared with the other interpreters running
+    // the same model instead of living in this interpreter's arena.
+    SharedConstantsContext* shared_constants =
+        SharedConstantsContext::Get(context);
+    if (shared_constants != nullptr && IsConstantTensor(filter)) {
+      hwcn_weights->allocation_type = kTfLiteMmapRo;
+      hwcn_weights->data.raw = const_cast<char*>(shared_constants->GetOrCreate(
+          filter->data.raw, "conv_hwcn_weights", hwcn_weights->bytes,
+          [filter, hwcn_weights](char* buffer) {
+            hwcn_weights->data.raw = buffer;
+            TransposeFloatTensor(filter, hwcn_weights);
+          }));
+      data->have_weights_been_transposed = true;
+    } else {
+      // TODO(petewarden): If Resize() is called when the size hasn't actually
+      // changed, this will do extra redundant work.
+      data->have_weights_been_transposed = false;
+    }
   }
 
   if (is_hybrid) {
@@ -450,6 +484,7 @@ void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
   op_params.output_shift = -data->output_shift;
   op_params.quantized_activation_min = data->output_activation_min;
   op_params.quantized_activation_max = data->output_activation_max;
+  op_params.lhs_cacheable = IsConstantTensor(filter);
   switch (effective_kernel_type) {
     case kReference: {
       reference_ops::Conv(
@@ -492,6 +527,7 @@ void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
   op_params.dilation_width_factor = params->dilation_width_factor;
   op_params.padding_values.height = data->padding.height;
   op_params.padding_values.width = data->padding.width;
+  op_params.lhs_cacheable = IsConstantTensor(filter);
 
   switch (kernel_type) {
     case kReference: {
@@ -545,6 +581,22 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
   op_params.dilation_height_factor = params->dilation_height_factor;
   op_params.float_activation_min = output_activation_min;
   op_params.float_activation_max = output_activation_max;
+  op_params.lhs_cacheable = IsConstantTensor(filter);
+  if (filter->sparsity) {
+    const TfLiteBlockSparsity* sparsity = filter->sparsity;
+    FullyConnectedParams fc_params;
+    fc_params.float_activation_min = output_activation_min;
+    fc_params.float_activation_max = output_activation_max;
+    optimized_ops::FullyConnectedSparseWeight(
+        fc_params, sparsity->block_shape->data[0],
+        sparsity->block_shape->data[1], sparsity->row_segments->data,
+        sparsity->col_indices->data, GetTensorShape(input),
+        GetTensorData<float>(input), GetTensorShape(filter),
+        GetTensorData<float>(filter), GetTensorShape(bias),
+        GetTensorData<float>(bias), GetTensorShape(output),
+        GetTensorData<float>(output));
+    return;
+  }
   switch (effective_kernel_type) {
     case kReference: {
       reference_ops::Conv(op_params, GetTensorShape(input),
@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/register.h"
 #include "tensorflow/lite/kernels/test_util.h"
 #include "tensorflow/lite/model.h"
+#include "tensorflow/lite/shared_constants_context.h"
 
 namespace tflite {
 
@@ -1393,5 +1394,98 @@ INSTANTIATE_TEST_SUITE_P(
     ConvolutionOpTest, ConvolutionOpTest,
     ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kKernelMap)));
 
+#ifndef TFLITE_WITH_RUY
+// Builds a 1x1 convolution over a 1x2x2x1 input whose filter and bias are
+// read-only buffers, as they would be in a memory-mapped model.
+void BuildConvolutionWithConstantFilter(const std::vector<float>& filter,
+                                        const std::vector<float>& bias,
+                                        Interpreter* interpreter) {
+  const int channels_out = filter.size();
+  ASSERT_EQ(interpreter->AddTensors(4), kTfLiteOk);
+  ASSERT_EQ(interpreter->SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter->SetOutputs({3}), kTfLiteOk);
+  TfLiteQuantizationParams quant = {0.0f, 0};
+  ASSERT_EQ(interpreter->SetTensorParametersReadWrite(
+                0, kTfLiteFloat32, "input", {1, 2, 2, 1}, quant),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter->SetTensorParametersReadOnly(
+                1, kTfLiteFloat32, "filter", {channels_out, 1, 1, 1}, quant,
+                reinterpret_cast<const char*>(filter.data()),
+                filter.size() * sizeof(float)),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter->SetTensorParametersReadOnly(
+                2, kTfLiteFloat32, "bias", {channels_out}, quant,
+                reinterpret_cast<const char*>(bias.data()),
+                bias.size() * sizeof(float)),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter->SetTensorParametersReadWrite(
+                3, kTfLiteFloat32, "output", {1, 2, 2, channels_out}, quant),
+            kTfLiteOk);
+
+  auto* params =
+      reinterpret_cast<TfLiteConvParams*>(malloc(sizeof(TfLiteConvParams)));
+  params->padding = kTfLitePaddingValid;
+  params->stride_width = 1;
+  params->stride_height = 1;
+  params->dilation_width_factor = 1;
+  params->dilation_height_factor = 1;
+  params->activation = kTfLiteActNone;
+  ASSERT_EQ(interpreter->AddNodeWithParameters(
+                {0, 1, 2}, {3}, nullptr, 0, params,
+                ops::builtin::Register_CONVOLUTION_MULTITHREADED_OPT()),
+            kTfLiteOk);
+}
+
+TEST(ConvolutionSharedConstantsTest, InterpretersShareTransposedWeights) {
+  const std::vector<float> filter = {1, 2};
+  const std::vector<float> bias = {0, 1};
+  SharedConstantsContext shared_constants;
+
+  std::vector<std::unique_ptr<Interpreter>> interpreters;
+  for (int i = 0; i < 2; ++i) {
+    interpreters.emplace_back(new Interpreter);
+    Interpreter* interpreter = interpreters.back().get();
+    BuildConvolutionWithConstantFilter(filter, bias, interpreter);
+    interpreter->SetExternalContext(kTfLiteSharedConstantsContext,
+                                    &shared_constants);
+    ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  }
+  EXPECT_EQ(shared_constants.num_buffers(), 1);
+
+  for (int i = 0; i < 2; ++i) {
+    Interpreter* interpreter = interpreters[i].get();
+    float* input = interpreter->typed_input_tensor<float>(0);
+    for (int j = 0; j < 4; ++j) input[j] = i + j;
+  }
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_EQ(interpreters[i]->Invoke(), kTfLiteOk);
+  }
+  const float* output0 = interpreters[0]->typed_output_tensor<float>(0);
+  EXPECT_THAT(std::vector<float>(output0, output0 + 8),
+              ElementsAreArray({0, 1, 1, 3, 2, 5, 3, 7}));
+  const float* output1 = interpreters[1]->typed_output_tensor<float>(0);
+  EXPECT_THAT(std::vector<float>(output1, output1 + 8),
+              ElementsAreArray({1, 3, 2, 5, 3, 7, 4, 9}));
+}
+
+TEST(ConvolutionKeepConstantsInPlaceTest, DoesNotTransposeConstantFilter) {
+  const std::vector<float> filter = {1, 2};
+  const std::vector<float> bias = {0, 1};
+  Interpreter interpreter;
+  BuildConvolutionWithConstantFilter(filter, bias, &interpreter);
+  interpreter.SetKeepConstantTensorsInPlace(true);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  // Without the transposed filter, the 1x1 convolution needs no temporaries.
+  EXPECT_EQ(interpreter.node_and_registration(0)->first.temporaries->size, 0);
+
+  float* input = interpreter.typed_input_tensor<float>(0);
+  for (int i = 0; i < 4; ++i) input[i] = i;
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  const float* output = interpreter.typed_output_tensor<float>(0);
+  EXPECT_THAT(std::vector<float>(output, output + 8),
+              ElementsAreArray({0, 1, 1, 3, 2, 5, 3, 7}));
+}
+#endif
+
 }  // namespace
 }  // namespace tflite
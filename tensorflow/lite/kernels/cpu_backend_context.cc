@@ -15,12 +15,55 @@ limitations under the License.
 
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 
+#include <cstdint>
+#include <functional>
+#include <vector>
+
 #include "public/gemmlowp.h"
+#include "tensorflow/lite/cpu_topology.h"
 #include "tensorflow/lite/experimental/ruy/context.h"
 #include "tensorflow/lite/kernels/op_macros.h"
 
 namespace tflite {
 
+namespace {
+
+// The alignment of the buffers allocated by ruy's own allocator.
+constexpr std::uintptr_t kPrepackedBufferAlignment = 64;
+
+// Runs one of the calls of CpuBackendContext::ExecuteTasks.
+class FunctionTask : public ruy::Task {
+ public:
+  FunctionTask(const std::function<void(int)>* function, int index)
+      : function_(function), index_(index) {}
+
+  void Run() override { (*function_)(index_); }
+
+ private:
+  const std::function<void(int)>* function_;
+  int index_;
+};
+
+}  // namespace
+
+ruy::PrepackedMatrix* PrepackedMatrixCache::Find(const Key& key) {
+  auto it = matrices_.find(key);
+  return it == matrices_.end() ? nullptr : &it->second;
+}
+
+ruy::PrepackedMatrix* PrepackedMatrixCache::Insert(const Key& key) {
+  return &matrices_[key];
+}
+
+void* PrepackedMatrixCache::AllocateBytes(std::size_t num_bytes) {
+  buffers_.emplace_back(new char[num_bytes + kPrepackedBufferAlignment]);
+  const std::uintptr_t address =
+      reinterpret_cast<std::uintptr_t>(buffers_.back().get());
+  return reinterpret_cast<void*>(
+      (address + kPrepackedBufferAlignment - 1) / kPrepackedBufferAlignment *
+      kPrepackedBufferAlignment);
+}
+
 CpuBackendContext* CpuBackendContext::GetFromContext(TfLiteContext* context) {
   auto* external_context = static_cast<ExternalCpuBackendContext*>(
       context->GetExternalContext(context, kTfLiteCpuBackendContext));
@@ -40,6 +83,7 @@ CpuBackendContext* CpuBackendContext::GetFromContext(TfLiteContext* context) {
     if (context->recommended_num_threads != -1) {
       cpu_backend_context->SetMaxNumThreads(context->recommended_num_threads);
     }
+    cpu_backend_context->SetCpuAffinity(external_context->cpu_affinity());
     external_context->set_internal_backend_context(
         std::unique_ptr<TfLiteInternalBackendContext>(cpu_backend_context));
   }
@@ -52,6 +96,7 @@ CpuBackendContext::CpuBackendContext()
       ruy_context_(new ruy::Context),
       gemmlowp_context_(new gemmlowp::GemmContext) {
   SetMaxNumThreads(1);
+  ruy_context_->thread_speed_ratio_log2 = GetCpuSpeedRatioLog2(cpu_affinity_);
 }
 
 CpuBackendContext::~CpuBackendContext() {}
@@ -62,4 +107,24 @@ void CpuBackendContext::SetMaxNumThreads(int max_num_threads) {
   gemmlowp_context_->set_max_num_threads(max_num_threads);
 }
 
+void CpuBackendContext::SetCpuAffinity(const std::vector<int>& cpus) {
+  if (cpus == cpu_affinity_) {
+    return;
+  }
+  cpu_affinity_ = cpus;
+  ruy_context_->workers_pool.SetCpuAffinity(cpus);
+  inter_op_pool_.SetCpuAffinity(cpus);
+  ruy_context_->thread_speed_ratio_log2 = GetCpuSpeedRatioLog2(cpus);
+}
+
+void CpuBackendContext::ExecuteTasks(int num_tasks,
+                                     const std::function<void(int)>& task) {
+  std::vector<FunctionTask> tasks;
+  tasks.reserve(num_tasks);
+  for (int i = 0; i < num_tasks; ++i) {
+    tasks.emplace_back(&task, i);
+  }
+  inter_op_pool_.Execute(num_tasks, tasks.data());
+}
+
 }  // namespace tflite
@@ -16,14 +16,50 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_KERNELS_CPU_BACKEND_CONTEXT_H_
 #define TENSORFLOW_LITE_KERNELS_CPU_BACKEND_CONTEXT_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
 #include <memory>
+#include <tuple>
+#include <vector>
 
 #include "public/gemmlowp.h"
 #include "tensorflow/lite/experimental/ruy/context.h"
+#include "tensorflow/lite/experimental/ruy/matrix.h"
+#include "tensorflow/lite/experimental/ruy/thread_pool.h"
 #include "tensorflow/lite/external_cpu_backend_context.h"
 
 namespace tflite {
 
+// Holds ruy's packed form of constant matrices, so that they are packed once
+// rather than on every Gemm call. Entries are keyed by the address of the
+// matrix data, so that data must stay alive and unchanged for as long as the
+// cache is used. See cpu_backend_gemm::MatrixParams::cacheable.
+class PrepackedMatrixCache {
+ public:
+  // The matrix data, its rows, columns, storage order and zero point, and
+  // an identifier of the way it is packed (scalar types and ruy path).
+  using Key =
+      std::tuple<const void*, int, int, int, std::int64_t, const void*, int>;
+
+  // Returns the packed matrix for 'key', or nullptr if there is none.
+  ruy::PrepackedMatrix* Find(const Key& key);
+
+  // Adds an empty packed matrix for 'key' and returns it. Its buffers are to
+  // be allocated with AllocateBytes().
+  ruy::PrepackedMatrix* Insert(const Key& key);
+
+  // Allocates a buffer owned by the cache, aligned as ruy expects.
+  void* AllocateBytes(std::size_t num_bytes);
+
+  int size() const { return matrices_.size(); }
+
+ private:
+  std::map<Key, ruy::PrepackedMatrix> matrices_;
+  std::vector<std::unique_ptr<char[]>> buffers_;
+};
+
 class CpuBackendContext final : public TfLiteInternalBackendContext {
  public:
   static CpuBackendContext* GetFromContext(TfLiteContext* context);
@@ -43,6 +79,18 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
 
   int max_num_threads() const { return max_num_threads_; }
 
+  // Restricts the worker threads of ruy and of ExecuteTasks to the given CPUs,
+  // e.g. the big cores from GetBigCpus(). The thread calling Invoke is not
+  // affected. ruy's blocking accounts for the speed differences among the
+  // allowed CPUs.
+  void SetCpuAffinity(const std::vector<int>& cpus) override;
+
+  // Runs the tasks on inter_op_pool_, one thread per task.
+  void ExecuteTasks(int num_tasks,
+                    const std::function<void(int)>& task) override;
+
+  PrepackedMatrixCache* prepacked_cache() { return &prepacked_cache_; }
+
  private:
   // To enable a smooth transition from the current direct usage
   // of the underlying gemmlowp context to going through abstractions
@@ -64,6 +112,17 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
   // information-only role.
   int max_num_threads_;
 
+  std::vector<int> cpu_affinity_;
+
+  // Packed constant matrices, shared by all the interpreters that share this
+  // context.
+  PrepackedMatrixCache prepacked_cache_;
+
+  // Runs independent TfLite ops concurrently (see ExecuteTasks). It is kept
+  // apart from the pools of the gemm contexts above, which the ops themselves
+  // use and which do not support nested Execute calls.
+  ruy::ThreadPool inter_op_pool_;
+
   CpuBackendContext(const CpuBackendContext&) = delete;
 };
 
@@ -47,6 +47,12 @@ struct MatrixParams {
   // The zero_point, i.e. which Scalar value is to be interpreted as zero.
   // When Scalar is floating-point, this must be 0.
   Scalar zero_point = 0;
+  // Whether the matrix data is constant and stays alive at the same address
+  // for as long as the CpuBackendContext is used, e.g. constant weights. The
+  // ruy back-end then packs it once and caches the packed matrix in the
+  // CpuBackendContext, instead of repacking it on every Gemm call. Only the
+  // LHS may currently be cached.
+  bool cacheable = false;
 };
 
 // Enumeration of broad categories of Gemm.
@@ -79,6 +85,10 @@ enum class QuantizationFlavor {
   kIntegerWithPerRowMultiplier
 };
 
+// Activation functions that Gemm may apply to the destination values, besides
+// clamping. Compare to ruy::Activation.
+enum class Activation { kNone, kTanh, kLogistic };
+
 // Additional parameters that Gemm needs, beyond what falls into
 // the MatrixParams that it takes. Compare to ruy::Spec.
 //
@@ -128,8 +138,34 @@ struct GemmParams {
   DstScalar clamp_max = std::is_floating_point<DstScalar>::value
                             ? std::numeric_limits<DstScalar>::infinity()
                             : std::numeric_limits<DstScalar>::max();
+  // The following fields are only for floating-point cases. They describe an
+  // epilogue that turns each destination value into
+  //   clamp(activation(channel_scale[row] * accum + channel_shift[row] +
+  //                    residual(row, col)))
+  // where accum includes the bias, without a separate pass over the
+  // destination matrix. Gemm calls with an epilogue always use ruy.
+  //
+  // Per-channel multiplier, if not nullptr. Must have as many values as there
+  // are rows in the destination matrix.
+  const DstScalar* channel_scale = nullptr;
+  // Per-channel addend, if not nullptr. Must have as many values as there are
+  // rows in the destination matrix.
+  const DstScalar* channel_shift = nullptr;
+  // Matrix to add elementwise, if not nullptr. Must have the same layout as
+  // the destination matrix.
+  const DstScalar* residual = nullptr;
+  Activation activation = Activation::kNone;
 };
 
+// Returns whether the GemmParams have any of the epilogue fields set.
+template <typename AccumScalar, typename DstScalar,
+          QuantizationFlavor quantization_flavor>
+bool HasEpilogue(
+    const GemmParams<AccumScalar, DstScalar, quantization_flavor>& params) {
+  return params.channel_scale || params.channel_shift || params.residual ||
+         params.activation != Activation::kNone;
+}
+
 /* Convenience typedefs */
 
 template <typename DstScalar>
@@ -169,6 +205,10 @@ void ValidateGemmParams(
     TFLITE_DCHECK(params.multiplier_fixedpoint_perchannel);
     TFLITE_DCHECK(params.multiplier_exponent_perchannel);
   }
+  // The epilogue is only for floating-point destinations.
+  if (!std::is_floating_point<DstScalar>::value) {
+    TFLITE_DCHECK(!HasEpilogue(params));
+  }
 }
 
 namespace detail {
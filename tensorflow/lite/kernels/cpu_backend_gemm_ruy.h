@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_LITE_KERNELS_CPU_BACKEND_GEMM_RUY_H_
 
 #include "tensorflow/lite/experimental/ruy/ruy.h"
+#include "tensorflow/lite/experimental/ruy/ruy_advanced.h"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
 
@@ -42,6 +43,17 @@ void MakeRuyMatrix(const MatrixParams<Scalar>& params, DataPointer data_ptr,
   dst->zero_point = params.zero_point;
 }
 
+inline ruy::Activation ToRuyActivation(Activation activation) {
+  switch (activation) {
+    case Activation::kTanh:
+      return ruy::Activation::kTanh;
+    case Activation::kLogistic:
+      return ruy::Activation::kLogistic;
+    default:
+      return ruy::Activation::kNone;
+  }
+}
+
 template <typename GemmParamsType, typename RuySpecType>
 void MakeRuySpec(const GemmParamsType& params, RuySpecType* ruy_spec) {
   // This validation has already been performed by the Gemm API entry point,
@@ -58,6 +70,51 @@ void MakeRuySpec(const GemmParamsType& params, RuySpecType* ruy_spec) {
   ruy_spec->bias = params.bias;
   ruy_spec->clamp_min = params.clamp_min;
   ruy_spec->clamp_max = params.clamp_max;
+  ruy_spec->channel_scale = params.channel_scale;
+  ruy_spec->channel_shift = params.channel_shift;
+  ruy_spec->residual = params.residual;
+  ruy_spec->activation = ToRuyActivation(params.activation);
+}
+
+// Returns an address unique to the given template arguments. Used to tell
+// apart packed matrices of different types without relying on RTTI.
+template <typename... Types>
+const void* TypeTag() {
+  static const char tag = 0;
+  return &tag;
+}
+
+// Returns the cached packed form of the LHS, packing it on first use, or
+// nullptr if the LHS can't be prepacked.
+template <typename LhsScalar, typename RhsScalar, typename DstScalar,
+          typename RuySpecType>
+ruy::PrepackedMatrix* GetOrCreatePrepackedLhs(
+    const ruy::Matrix<LhsScalar>& ruy_lhs,
+    const ruy::Matrix<RhsScalar>& ruy_rhs, const RuySpecType& ruy_spec,
+    CpuBackendContext* context, ruy::Matrix<DstScalar>* ruy_dst) {
+  ruy::Context* ruy_context = context->ruy_context();
+  const ruy::Path path = ruy_context->GetPathToTake<ruy::kAllPaths>();
+  // ruy's reference path doesn't support prepacking.
+  if (path == ruy::Path::kReference) {
+    return nullptr;
+  }
+  const PrepackedMatrixCache::Key key(
+      ruy_lhs.data.get(), ruy_lhs.layout.rows, ruy_lhs.layout.cols,
+      static_cast<int>(ruy_lhs.layout.order), ruy_lhs.zero_point,
+      TypeTag<LhsScalar, RhsScalar, DstScalar, RuySpecType>(),
+      static_cast<int>(path));
+  PrepackedMatrixCache* cache = context->prepacked_cache();
+  ruy::PrepackedMatrix* prepacked_lhs = cache->Find(key);
+  if (prepacked_lhs == nullptr) {
+    prepacked_lhs = cache->Insert(key);
+    auto alloc_fn = [cache](std::size_t num_bytes) {
+      return cache->AllocateBytes(num_bytes);
+    };
+    ruy::PrePackForMul<ruy::kAllPaths>(ruy_lhs, ruy_rhs, ruy_spec, ruy_context,
+                                       ruy_dst, prepacked_lhs,
+                                       /*prepacked_rhs=*/nullptr, alloc_fn);
+  }
+  return prepacked_lhs;
 }
 
 template <typename LhsScalar, typename RhsScalar, typename AccumScalar,
@@ -79,6 +136,17 @@ struct GemmImplUsingRuy {
     ruy::BasicSpec<AccumScalar, DstScalar> ruy_spec;
     MakeRuySpec(params, &ruy_spec);
 
+    if (lhs_params.cacheable) {
+      ruy::PrepackedMatrix* prepacked_lhs = GetOrCreatePrepackedLhs(
+          ruy_lhs, ruy_rhs, ruy_spec, context, &ruy_dst);
+      if (prepacked_lhs != nullptr) {
+        ruy::MulWithPrepacked<ruy::kAllPaths>(
+            ruy_lhs, ruy_rhs, ruy_spec, context->ruy_context(), &ruy_dst,
+            prepacked_lhs, /*prepacked_rhs=*/nullptr);
+        return;
+      }
+    }
+
     ruy::Mul<ruy::kAllPaths>(ruy_lhs, ruy_rhs, ruy_spec, context->ruy_context(),
                              &ruy_dst);
   }
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/cpu_backend_gemm.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstdarg>
 #include <limits>
 #include <random>
@@ -33,6 +34,7 @@ namespace tflite {
 
 namespace {
 
+using cpu_backend_gemm::Activation;
 using cpu_backend_gemm::Gemm;
 using cpu_backend_gemm::GemmParams;
 using cpu_backend_gemm::MatrixParams;
@@ -455,6 +457,15 @@ void TestSomeGemm(int rows, int depth, int cols,
       lhs_params, lhs_data, rhs_params, rhs_data, dst_params, &dst_data, params,
       expected, &cpu_backend_context);
 
+  // Again with a cacheable LHS. The ruy path packs it on the first call and
+  // reuses the packed matrix for the next ones.
+  MatrixParams<LhsScalar> cacheable_lhs_params = lhs_params;
+  cacheable_lhs_params.cacheable = true;
+  PerformGemmThenCompareResultsThenAgainWithClamping(
+      cacheable_lhs_params, lhs_data, rhs_params, rhs_data, dst_params,
+      &dst_data, params, expected, &cpu_backend_context);
+  EXPECT_LE(cpu_backend_context.prepacked_cache()->size(), 1);
+
   if (!use_golden && !std::is_floating_point<AccumScalar>::value) {
     // Try with per-channel quantized multipliers.
     std::vector<AccumScalar> multiplier_fixedpoint_perchannel(rows);
@@ -510,6 +521,82 @@ TEST(CpuBackendGemmSimpleTestAgainstGolden, Int8Int16) {
       3, 5, 4, {19, 48, 77, 48, 149, 250, 76, 249, 422, 105, 350, 595});
 }
 
+// Checks a float Gemm with an epilogue against a Gemm without one followed by
+// a separate pass applying the epilogue.
+void TestFloatEpilogue(int rows, int depth, int cols, Activation activation) {
+  CpuBackendContext cpu_backend_context;
+  std::vector<float> lhs_data;
+  std::vector<float> rhs_data;
+  std::vector<float> bias_data;
+  std::vector<float> channel_scale;
+  std::vector<float> channel_shift;
+  std::vector<float> residual;
+  MakeDeterministicPseudoRandomVector(rows * depth, &lhs_data);
+  MakeDeterministicPseudoRandomVector(depth * cols, &rhs_data);
+  MakeDeterministicPseudoRandomVector(rows, &bias_data);
+  MakeDeterministicPseudoRandomVector(rows, &channel_scale);
+  MakeDeterministicPseudoRandomVector(rows, &channel_shift);
+  MakeDeterministicPseudoRandomVector(rows * cols, &residual);
+
+  MatrixParams<float> lhs_params;
+  lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
+  lhs_params.rows = rows;
+  lhs_params.cols = depth;
+  MatrixParams<float> rhs_params;
+  rhs_params.order = cpu_backend_gemm::Order::kColMajor;
+  rhs_params.rows = depth;
+  rhs_params.cols = cols;
+  MatrixParams<float> dst_params;
+  dst_params.order = cpu_backend_gemm::Order::kColMajor;
+  dst_params.rows = rows;
+  dst_params.cols = cols;
+
+  // The unclamped accumulators, bias included.
+  GemmParams<float, float> params;
+  params.bias = bias_data.data();
+  std::vector<float> expected(rows * cols);
+  ReferenceGemm(lhs_params, lhs_data.data(), rhs_params, rhs_data.data(),
+                dst_params, expected.data(), params, &cpu_backend_context);
+  params.clamp_min = -0.5f;
+  params.clamp_max = 0.5f;
+  for (int col = 0; col < cols; col++) {
+    for (int row = 0; row < rows; row++) {
+      float& value = expected[col * rows + row];
+      value = value * channel_scale[row] + channel_shift[row] +
+              residual[col * rows + row];
+      if (activation == Activation::kTanh) {
+        value = std::tanh(value);
+      } else if (activation == Activation::kLogistic) {
+        value = 1 / (1 + std::exp(-value));
+      }
+      value = std::min(params.clamp_max, std::max(params.clamp_min, value));
+    }
+  }
+
+  params.channel_scale = channel_scale.data();
+  params.channel_shift = channel_shift.data();
+  params.residual = residual.data();
+  params.activation = activation;
+  std::vector<float> dst_data(rows * cols);
+  Gemm(lhs_params, lhs_data.data(), rhs_params, rhs_data.data(), dst_params,
+       dst_data.data(), params, &cpu_backend_context);
+  for (int i = 0; i < rows * cols; i++) {
+    EXPECT_NEAR(dst_data[i], expected[i], 1e-4f * depth);
+  }
+}
+
+TEST(CpuBackendGemmEpilogueTest, Float) {
+  TestFloatEpilogue(37, 19, 23, Activation::kNone);
+}
+
+TEST(CpuBackendGemmEpilogueTest, FloatTanh) {
+  TestFloatEpilogue(37, 19, 23, Activation::kTanh);
+}
+
+TEST(CpuBackendGemmEpilogueTest, FloatLogisticMatrixTimesVector) {
+  TestFloatEpilogue(100, 50, 1, Activation::kLogistic);
+}
+
 template <typename tLhsScalar, typename tRhsScalar, typename tAccumScalar,
           typename tDstScalar>
 struct TypesTuple {
@@ -326,6 +326,49 @@ class HybridFullyConnectedOpModel : public SingleOpModel {
   int input_size_;
 };
 
+// A float model whose weights are a constant block sparse tensor.
+class SparseFullyConnectedOpModel : public SingleOpModel {
+ public:
+  SparseFullyConnectedOpModel(TfLiteRegistration* registration, int units,
+                              int batches, const TensorData& input,
+                              std::initializer_list<float> weights_data,
+                              std::initializer_list<int> block_shape,
+                              std::initializer_list<int> row_segments,
+                              std::initializer_list<int> col_indices) {
+    int total_input_size = 1;
+    for (size_t i = 0; i < input.shape.size(); ++i) {
+      total_input_size *= input.shape[i];
+    }
+    const int input_size = total_input_size / batches;
+
+    input_ = AddInput(input);
+    weights_ = AddConstSparseInput({TensorType_FLOAT32, {units, input_size}},
+                                   weights_data, block_shape, row_segments,
+                                   col_indices);
+    bias_ = AddInput({TensorType_FLOAT32, {units}});
+    output_ = AddOutput({TensorType_FLOAT32});
+
+    SetBuiltinOp(
+        BuiltinOperator_FULLY_CONNECTED, BuiltinOptions_FullyConnectedOptions,
+        CreateFullyConnectedOptions(builder_, ActivationFunctionType_RELU)
+            .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED, registration);
+    BuildInterpreter({GetShape(input_), GetShape(weights_), GetShape(bias_)});
+  }
+
+  void SetBias(const std::vector<float>& f) { PopulateTensor(bias_, f); }
+  void SetInput(const std::vector<float>& f) { PopulateTensor(input_, f); }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+
+ protected:
+  int input_;
+  int weights_;
+  int bias_;
+  int output_;
+};
+
 const auto kKernelMap = new std::map<string, TfLiteRegistration*>({
     {"Reference", ops::builtin::Register_FULLY_CONNECTED_REF()},
     {"GenericOptimized", ops::builtin::Register_FULLY_CONNECTED_GENERIC_OPT()},
@@ -389,6 +432,37 @@ TEST_P(FloatFullyConnectedOpTest, SimpleTest) {
   EXPECT_THAT(m.GetOutput(), ElementsAre(24, 25, 26, 58, 59, 60));
 }
 
+TEST_P(FloatFullyConnectedOpTest, BlockSparseWeights) {
+  // The dense weights are
+  //   1 2 5 6
+  //   3 4 7 8
+  //   0 0 1 2
+  //   0 0 3 4
+  // stored as three nonzero 2x2 blocks.
+  SparseFullyConnectedOpModel m(GetRegistration(), /*units=*/4, /*batches=*/2,
+                                /*input=*/{TensorType_FLOAT32, {2, 4}},
+                                /*weights_data=*/
+                                {
+                                    1, 2, 3, 4,  // block (0, 0)
+                                    5, 6, 7, 8,  // block (0, 1)
+                                    1, 2, 3, 4,  // block (1, 1)
+                                },
+                                /*block_shape=*/{2, 2},
+                                /*row_segments=*/{0, 2, 3},
+                                /*col_indices=*/{0, 1, 1});
+  m.SetBias({1, 2, 3, 4});
+
+  m.SetInput({
+      1, 2, 3, 4,    // b = 0
+      1, -1, 2, -2,  // b = 1
+  });
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 4));
+  EXPECT_THAT(m.GetOutput(), ElementsAre(45, 66, 14, 29, 0, 0, 1, 2));
+}
+
 TEST_P(FloatFullyConnectedOpTest, SimpleTest2) {
   FloatFullyConnectedOpModel m(GetRegistration(), /*units=*/1, /*batches=*/2,
                                /*input=*/{TensorType_FLOAT32, {2, 2}});
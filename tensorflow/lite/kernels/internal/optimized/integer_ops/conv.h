@@ -101,6 +101,7 @@ inline void ConvPerChannel(
   lhs_params.rows = filter_rows;
   lhs_params.cols = filter_cols;
   lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
+  lhs_params.cacheable = params.lhs_cacheable;
   lhs_params.zero_point = 0;  // filter is symmetric-quantized
   cpu_backend_gemm::MatrixParams<int8> rhs_params;
   rhs_params.rows = gemm_input_rows;
@@ -63,6 +63,7 @@ inline void FullyConnected(
   lhs_params.rows = filter_rows;
   lhs_params.cols = filter_cols;
   lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
+  lhs_params.cacheable = params.lhs_cacheable;
   lhs_params.zero_point = -filter_offset;
   cpu_backend_gemm::MatrixParams<int8> rhs_params;
   rhs_params.rows = filter_cols;
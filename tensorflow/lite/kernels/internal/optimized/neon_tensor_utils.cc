@@ -1753,10 +1753,35 @@ inline int32x4_t RoundToNearest(const float32x4_t input) {
 void NeonSymmetricQuantizeFloats(const float* values, const int size,
                                  int8_t* quantized_values, float* min,
                                  float* max, float* scaling_factor) {
-  // TODO(raziel): vectorize min/max calculation.
-  auto minmax = std::minmax_element(values, values + size);
-  *min = *minmax.first;
-  *max = *minmax.second;
+  const int postamble_start =
+      RoundDownVectors<kFloatValuesPerNeonVector>(size);
+  int i = 0;
+  float min_value = size > 0 ? values[0] : 0.0f;
+  float max_value = min_value;
+  if (postamble_start > 0) {
+    float32x4_t min_f32x4 = vld1q_f32(values);
+    float32x4_t max_f32x4 = min_f32x4;
+    for (i = kFloatValuesPerNeonVector; i < postamble_start;
+         i += kFloatValuesPerNeonVector) {
+      const float32x4_t value_f32x4 = vld1q_f32(&values[i]);
+      min_f32x4 = vminq_f32(min_f32x4, value_f32x4);
+      max_f32x4 = vmaxq_f32(max_f32x4, value_f32x4);
+    }
+    float32x2_t min_f32x2 =
+        vpmin_f32(vget_low_f32(min_f32x4), vget_high_f32(min_f32x4));
+    float32x2_t max_f32x2 =
+        vpmax_f32(vget_low_f32(max_f32x4), vget_high_f32(max_f32x4));
+    min_f32x2 = vpmin_f32(min_f32x2, min_f32x2);
+    max_f32x2 = vpmax_f32(max_f32x2, max_f32x2);
+    min_value = vget_lane_f32(min_f32x2, 0);
+    max_value = vget_lane_f32(max_f32x2, 0);
+  }
+  for (; i < size; ++i) {
+    min_value = std::min(min_value, values[i]);
+    max_value = std::max(max_value, values[i]);
+  }
+  *min = min_value;
+  *max = max_value;
   NeonSymmetricQuantizeFloats(values, size, quantized_values, *min, *max,
                               scaling_factor);
 }
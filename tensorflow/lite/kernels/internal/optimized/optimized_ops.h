@@ -221,6 +221,7 @@ inline void FullyConnected(
   TFLITE_DCHECK_EQ(input_shape.FlatSize(), rhs_params.rows * rhs_params.cols);
   cpu_backend_gemm::MatrixParams<float> lhs_params;
   lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
+  lhs_params.cacheable = params.lhs_cacheable;
   lhs_params.cols = weights_shape.Dims(dims_count - 1);
   lhs_params.rows = FlatSizeSkipDim(weights_shape, dims_count - 1);
   cpu_backend_gemm::MatrixParams<float> dst_params;
@@ -232,6 +233,11 @@ inline void FullyConnected(
   gemm_params.bias = optional_bias_data;
   gemm_params.clamp_min = params.float_activation_min;
   gemm_params.clamp_max = params.float_activation_max;
+  if (params.float_activation == FloatActivation::kTanh) {
+    gemm_params.activation = cpu_backend_gemm::Activation::kTanh;
+  } else if (params.float_activation == FloatActivation::kLogistic) {
+    gemm_params.activation = cpu_backend_gemm::Activation::kLogistic;
+  }
   cpu_backend_gemm::Gemm(lhs_params, weights_data, rhs_params, input_data,
                          dst_params, output_data, gemm_params,
                          cpu_backend_context);
@@ -274,6 +280,7 @@ inline void FullyConnected(
   lhs_params.rows = filter_rows;
   lhs_params.cols = filter_cols;
   lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
+  lhs_params.cacheable = params.lhs_cacheable;
   lhs_params.zero_point = -filter_offset;
   cpu_backend_gemm::MatrixParams<uint8> rhs_params;
   rhs_params.rows = filter_cols;
@@ -331,6 +338,7 @@ inline void FullyConnected(
   lhs_params.rows = output_depth;
   lhs_params.cols = accum_depth;
   lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
+  lhs_params.cacheable = params.lhs_cacheable;
   lhs_params.zero_point = -filter_offset;
   cpu_backend_gemm::MatrixParams<uint8> rhs_params;
   rhs_params.rows = accum_depth;
@@ -1126,6 +1134,7 @@ inline void Conv(const ConvParams& params, const RuntimeShape& input_shape,
   // to using cpu_backend_gemm.
   cpu_backend_gemm::MatrixParams<float> lhs_params;
   lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
+  lhs_params.cacheable = params.lhs_cacheable;
   lhs_params.rows = n;
   lhs_params.cols = k;
   cpu_backend_gemm::MatrixParams<float> rhs_params;
@@ -1308,6 +1317,7 @@ inline void Conv(const ConvParams& params, const RuntimeShape& input_shape,
   lhs_params.rows = filter_rows;
   lhs_params.cols = filter_cols;
   lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
+  lhs_params.cacheable = params.lhs_cacheable;
   lhs_params.zero_point = -filter_offset;
   cpu_backend_gemm::MatrixParams<uint8> rhs_params;
   rhs_params.rows = gemm_input_rows;
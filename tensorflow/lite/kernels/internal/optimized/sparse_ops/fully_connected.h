@@ -0,0 +1,91 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_FULLY_CONNECTED_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_FULLY_CONNECTED_H_
+
+#include "profiling/instrumentation.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace optimized_ops {
+
+// FullyConnected with block sparse weights, of which only the nonzero blocks
+// are stored in `weights_data`, in block compressed sparse row order (see
+// TfLiteBlockSparsity). The weights are [output_depth, accum_depth] once all
+// their dimensions but the first are flattened, so this also computes 1x1
+// convolutions with unit strides. The work done is proportional to the number
+// of nonzero blocks.
+inline void FullyConnectedSparseWeight(
+    const FullyConnectedParams& params, int block_rows, int block_cols,
+    const int* row_segments, const int* col_indices,
+    const RuntimeShape& input_shape, const float* input_data,
+    const RuntimeShape& weights_shape, const float* weights_data,
+    const RuntimeShape& bias_shape, const float* bias_data,
+    const RuntimeShape& output_shape, float* output_data) {
+  gemmlowp::ScopedProfilingLabel label("FullyConnectedSparseWeight");
+  const float output_activation_min = params.float_activation_min;
+  const float output_activation_max = params.float_activation_max;
+
+  const int output_dims_count = output_shape.DimensionsCount();
+  const int output_depth = weights_shape.Dims(0);
+  const int accum_depth = weights_shape.FlatSize() / output_depth;
+  const int batches = FlatSizeSkipDim(output_shape, output_dims_count - 1);
+  TFLITE_DCHECK_EQ(output_shape.Dims(output_dims_count - 1), output_depth);
+  TFLITE_DCHECK_EQ(input_shape.FlatSize(), batches * accum_depth);
+  if (bias_data) {
+    TFLITE_DCHECK_EQ(bias_shape.FlatSize(), output_depth);
+  }
+  TFLITE_DCHECK_EQ(output_depth % block_rows, 0);
+  TFLITE_DCHECK_EQ(accum_depth % block_cols, 0);
+  const int num_block_rows = output_depth / block_rows;
+  const int block_size = block_rows * block_cols;
+
+  for (int b = 0; b < batches; ++b) {
+    const float* input = input_data + b * accum_depth;
+    float* output = output_data + b * output_depth;
+    for (int i = 0; i < output_depth; ++i) {
+      output[i] = bias_data ? bias_data[i] : 0.0f;
+    }
+    // The nonzero blocks are stored in the order they are visited, so the
+    // weights are read sequentially.
+    const float* weights_block = weights_data;
+    for (int block_row = 0; block_row < num_block_rows; ++block_row) {
+      float* output_block = output + block_row * block_rows;
+      for (int k = row_segments[block_row]; k < row_segments[block_row + 1];
+           ++k) {
+        const float* input_block = input + col_indices[k] * block_cols;
+        for (int r = 0; r < block_rows; ++r) {
+          const float* weights_row = weights_block + r * block_cols;
+          float acc = 0.0f;
+          for (int c = 0; c < block_cols; ++c) {
+            acc += weights_row[c] * input_block[c];
+          }
+          output_block[r] += acc;
+        }
+        weights_block += block_size;
+      }
+    }
+    for (int i = 0; i < output_depth; ++i) {
+      output[i] = ActivationFunctionWithMinMax(output[i], output_activation_min,
+                                               output_activation_max);
+    }
+  }
+}
+
+}  // namespace optimized_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_FULLY_CONNECTED_H_
@@ -16,11 +16,16 @@ limitations under the License.
 
 #ifdef __SSE4_1__
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 #include <emmintrin.h>  // SSE2
 #include <smmintrin.h>  // SSE4.1
 #include <tmmintrin.h>  // SSSE3
 
 #include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/kernels/internal/round.h"
 
 namespace tflite {
 namespace tensor_utils {
@@ -61,6 +66,27 @@ static inline int32_t ReduceInt32x4(__m128i acc) {
   return _mm_extract_epi32(acc, 0);
 }
 
+// Rounds to the nearest integer with halfway cases away from zero, like
+// TfLiteRound. _mm_cvtps_epi32 would round them to even.
+static inline __m128i RoundToNearest(__m128 input) {
+  const __m128 sign_mask = _mm_set1_ps(-0.0f);
+  const __m128 half = _mm_or_ps(_mm_and_ps(input, sign_mask), _mm_set1_ps(0.5f));
+  return _mm_cvttps_epi32(_mm_add_ps(input, half));  // SSE2
+}
+
+// Horizontally reduces 4 float values stored in a single XMM register.
+static inline float ReduceMinFloat32x4(__m128 v) {
+  v = _mm_min_ps(v, _mm_movehl_ps(v, v));
+  v = _mm_min_ss(v, _mm_shuffle_ps(v, v, 1));
+  return _mm_cvtss_f32(v);
+}
+
+static inline float ReduceMaxFloat32x4(__m128 v) {
+  v = _mm_max_ps(v, _mm_movehl_ps(v, v));
+  v = _mm_max_ss(v, _mm_shuffle_ps(v, v, 1));
+  return _mm_cvtss_f32(v);
+}
+
 }  // namespace
 
 void SseMatrixBatchVectorMultiplyAccumulate(
@@ -149,6 +175,78 @@ void SseSparseMatrixBatchVectorMultiplyAccumulate(
   }    // for batch
 }
 
+void SseSymmetricQuantizeFloats(const float* values, const int size,
+                                int8_t* quantized_values, float* min,
+                                float* max, float* scaling_factor) {
+  static constexpr int kBlockSize = 4;
+  const int postamble_start = size & ~(kBlockSize - 1);
+  int i = 0;
+  float min_value = size > 0 ? values[0] : 0.0f;
+  float max_value = min_value;
+  if (postamble_start > 0) {
+    __m128 min_f32x4 = _mm_loadu_ps(values);
+    __m128 max_f32x4 = min_f32x4;
+    for (i = kBlockSize; i < postamble_start; i += kBlockSize) {
+      const __m128 value_f32x4 = _mm_loadu_ps(values + i);
+      min_f32x4 = _mm_min_ps(min_f32x4, value_f32x4);
+      max_f32x4 = _mm_max_ps(max_f32x4, value_f32x4);
+    }
+    min_value = ReduceMinFloat32x4(min_f32x4);
+    max_value = ReduceMaxFloat32x4(max_f32x4);
+  }
+  for (; i < size; ++i) {
+    min_value = std::min(min_value, values[i]);
+    max_value = std::max(max_value, values[i]);
+  }
+  *min = min_value;
+  *max = max_value;
+  SseSymmetricQuantizeFloats(values, size, quantized_values, min_value,
+                             max_value, scaling_factor);
+}
+
+void SseSymmetricQuantizeFloats(const float* values, const int size,
+                                int8_t* quantized_values, float min, float max,
+                                float* scaling_factor) {
+  static constexpr int kBlockSize = 8;
+  const int kScale = 127;
+  const float range = std::max(std::abs(min), std::abs(max));
+  if (range == 0) {
+    memset(quantized_values, 0, size * sizeof(int8_t));
+    *scaling_factor = 1;
+    return;
+  }
+  *scaling_factor = range / kScale;
+  const float scaling_factor_inv = kScale / range;
+
+  const int postamble_start = size & ~(kBlockSize - 1);
+  const __m128 q_factor_f32x4 = _mm_set1_ps(scaling_factor_inv);
+  const __m128i scale_i32x4 = _mm_set1_epi32(kScale);
+  const __m128i neg_scale_i32x4 = _mm_set1_epi32(-kScale);
+  int i = 0;
+  for (; i < postamble_start; i += kBlockSize) {
+    const __m128 mul0_f32x4 =
+        _mm_mul_ps(_mm_loadu_ps(values + i), q_factor_f32x4);
+    const __m128 mul1_f32x4 =
+        _mm_mul_ps(_mm_loadu_ps(values + i + 4), q_factor_f32x4);
+    // Clamp: just in case some odd numeric offset.
+    const __m128i q0_i32x4 = _mm_min_epi32(  // SSE4.1
+        _mm_max_epi32(RoundToNearest(mul0_f32x4), neg_scale_i32x4),
+        scale_i32x4);
+    const __m128i q1_i32x4 = _mm_min_epi32(
+        _mm_max_epi32(RoundToNearest(mul1_f32x4), neg_scale_i32x4),
+        scale_i32x4);
+    const __m128i q_i16x8 = _mm_packs_epi32(q0_i32x4, q1_i32x4);  // SSE2
+    const __m128i q_i8x16 = _mm_packs_epi16(q_i16x8, q_i16x8);    // SSE2
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(quantized_values + i),
+                     q_i8x16);
+  }
+  for (; i < size; ++i) {
+    const int32_t quantized_value =
+        static_cast<int32_t>(TfLiteRound(values[i] * scaling_factor_inv));
+    quantized_values[i] = std::min(kScale, std::max(-kScale, quantized_value));
+  }
+}
+
 }  // namespace tensor_utils
 }  // namespace tflite
 
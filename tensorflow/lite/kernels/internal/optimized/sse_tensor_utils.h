@@ -16,9 +16,9 @@ limitations under the License.
 #define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SSE_TENSOR_UTILS_H_
 
 // Note: This file is a copy-paste version of neon_tensor_utils.h, only
-// difference is in MatrixBatchVectorMultiplyAccumulate and
-// SparseMatrixBatchVectorMultiplyAccumulate (other functions do not have SSE
-// implementation yet).
+// difference is in MatrixBatchVectorMultiplyAccumulate,
+// SparseMatrixBatchVectorMultiplyAccumulate and SymmetricQuantizeFloats (other
+// functions do not have SSE implementation yet).
 
 // Note: Most of the functions below use NEON_OR_PORTABLE, through the Intel
 // NEON_2_SSE translator library. If a native SSE version of a function is
@@ -229,15 +229,15 @@ void ClipVector(const float* vector, int v_size, float abs_limit,
 void SymmetricQuantizeFloats(const float* values, const int size,
                              int8_t* quantized_values, float* min_value,
                              float* max_value, float* scaling_factor) {
-  NEON_OR_PORTABLE(SymmetricQuantizeFloats, values, size, quantized_values,
-                   min_value, max_value, scaling_factor);
+  SSE_OR_PORTABLE(SymmetricQuantizeFloats, values, size, quantized_values,
+                  min_value, max_value, scaling_factor);
 }
 
 void SymmetricQuantizeFloats(const float* values, const int size,
                              int8_t* quantized_values, float min_value,
                              float max_value, float* scaling_factor) {
-  NEON_OR_PORTABLE(SymmetricQuantizeFloats, values, size, quantized_values,
-                   min_value, max_value, scaling_factor);
+  SSE_OR_PORTABLE(SymmetricQuantizeFloats, values, size, quantized_values,
+                  min_value, max_value, scaling_factor);
 }
 
 void ReductionSumVector(const float* input_vector, float* output_vector,
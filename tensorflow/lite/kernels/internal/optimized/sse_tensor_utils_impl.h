@@ -40,6 +40,16 @@ void SseSparseMatrixBatchVectorMultiplyAccumulate(
     const float* scaling_factors, int n_batch, float* __restrict__ result,
     int result_stride);
 
+// Symmetric quantizer.
+void SseSymmetricQuantizeFloats(const float* values, const int size,
+                                int8_t* quantized_values, float* min,
+                                float* max, float* scaling_factor);
+
+// Symmetric quantizer.
+void SseSymmetricQuantizeFloats(const float* values, const int size,
+                                int8_t* quantized_values, float min, float max,
+                                float* scaling_factor);
+
 #endif  // __SSE4_1__
 
 }  // namespace tensor_utils
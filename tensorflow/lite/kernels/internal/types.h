@@ -26,6 +26,8 @@ namespace tflite {
 
 enum class FusedActivationFunctionType : uint8 { kNone, kRelu6, kRelu1, kRelu };
 enum class PaddingType : uint8 { kNone, kSame, kValid };
+// Float activations that can't be expressed as a clamp of the output.
+enum class FloatActivation : uint8 { kNone, kTanh, kLogistic };
 
 struct PaddingValues {
   int16 width;
@@ -820,6 +822,9 @@ struct ConvParams {
   // float activation params.
   float float_activation_min;
   float float_activation_max;
+  // Whether the filter data is constant, so that the backend may cache it in
+  // a preprocessed form. See cpu_backend_gemm::MatrixParams::cacheable.
+  bool lhs_cacheable = false;
 };
 
 struct DepthToSpaceParams {
@@ -873,7 +878,13 @@ struct FullyConnectedParams {
   // float activation params.
   float float_activation_min;
   float float_activation_max;
+  // Applied before the clamp above. Only supported by the optimized float
+  // kernel, which fuses it into the Gemm.
+  FloatActivation float_activation = FloatActivation::kNone;
   FullyConnectedWeightsFormat weights_format;
+  // Whether the weights data is constant, so that the backend may cache it in
+  // a preprocessed form. See cpu_backend_gemm::MatrixParams::cacheable.
+  bool lhs_cacheable = false;
 };
 
 struct GatherParams {
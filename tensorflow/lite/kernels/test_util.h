@@ -178,6 +178,22 @@ class SingleOpModel {
     return AddConstInput(TensorData{type, shape}, data);
   }
 
+  // Add a constant input holding only the nonzero blocks of a block sparse
+  // tensor, in the order given by `row_segments` and `col_indices`.
+  template <typename T>
+  int AddConstSparseInput(const TensorData& t, std::initializer_list<T> data,
+                          std::initializer_list<int> block_shape,
+                          std::initializer_list<int> row_segments,
+                          std::initializer_list<int> col_indices) {
+    auto sparsity = CreateBlockSparsity(
+        builder_, builder_.CreateVector<int>(block_shape),
+        builder_.CreateVector<int>(row_segments),
+        builder_.CreateVector<int>(col_indices));
+    int id = AddTensor(t, data, /*is_variable=*/false, sparsity);
+    inputs_.push_back(id);
+    return id;
+  }
+
   // Add a null input tensor (optional input) and return kOptionalTensor.
   int AddNullInput();
 
@@ -465,7 +481,8 @@ class SingleOpModel {
 
   template <typename T>
   int AddTensor(TensorData t, std::initializer_list<T> data,
-                bool is_variable = false) {
+                bool is_variable = false,
+                flatbuffers::Offset<BlockSparsity> sparsity = 0) {
     int id = tensors_.size();
 
     // This is slightly different depending on whether we are adding a
@@ -520,7 +537,8 @@ class SingleOpModel {
     tensors_.push_back(CreateTensor(builder_,
                                     builder_.CreateVector<int>(t.shape), t.type,
                                     /*buffer=*/buffer_id,
-                                    /*name=*/0, q_params, is_variable));
+                                    /*name=*/0, q_params, is_variable,
+                                    sparsity));
 
     tensor_data_[id] = t;
 
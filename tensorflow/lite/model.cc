@@ -474,6 +474,25 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
       continue;
     }
 
+    TfLiteBlockSparsity* sparsity = nullptr;
+    if (const auto* src_sparsity = tensor->sparsity()) {
+      int num_values;
+      if (!buffer_ptr) {
+        error_reporter_->Report(
+            "Tensor %d is sparse but has no buffer. Only constant tensors "
+            "may be sparse.\n",
+            i);
+      } else {
+        ConvertBlockSparsity(*src_sparsity, dims.size(), dims.data(),
+                             &sparsity, &num_values, error_reporter_);
+      }
+      if (!sparsity) {
+        TfLiteQuantizationFree(&quantization);
+        status = kTfLiteError;
+        continue;
+      }
+    }
+
     bool is_variable = tensor->is_variable();
     if (buffer_ptr) {
       if (is_variable) {
@@ -486,7 +505,7 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
 
       if (subgraph->SetTensorParametersReadOnly(
               i, type, get_name(tensor), dims, quantization, buffer_ptr,
-              buffer_size, allocation_) != kTfLiteOk) {
+              buffer_size, allocation_, sparsity) != kTfLiteOk) {
         error_reporter_->Report("Tensor %d is invalidly specified in schema.\n",
                                 i);
         status = kTfLiteError;
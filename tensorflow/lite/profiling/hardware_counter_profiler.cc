@@ -0,0 +1,79 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/hardware_counter_profiler.h"
+
+#include "tensorflow/lite/profiling/time.h"
+
+namespace tflite {
+namespace profiling {
+
+uint32_t HardwareCounterProfiler::BeginEvent(const char* tag,
+                                             EventType event_type,
+                                             uint32_t event_metadata,
+                                             uint32_t event_subgraph_index) {
+  OpenEvent event;
+  event.next_handle =
+      next_ ? next_->BeginEvent(tag, event_type, event_metadata,
+                                event_subgraph_index)
+            : 0;
+  event.is_counted =
+      enabled_ && event_type == EventType::OPERATOR_INVOKE_EVENT;
+  event.subgraph_index = event_subgraph_index;
+  event.node_index = event_metadata;
+  // Read the counters last so that they do not include the work above.
+  if (event.is_counted) {
+    event.begin_us = time::NowMicros();
+    event.begin = counters_.Read();
+  }
+  open_events_.push_back(event);
+  return static_cast<uint32_t>(open_events_.size() - 1);
+}
+
+void HardwareCounterProfiler::EndEvent(uint32_t event_handle) {
+  if (event_handle >= open_events_.size()) return;
+  const OpenEvent& event = open_events_[event_handle];
+  if (event.is_counted) {
+    const HardwareCounterValues end = counters_.Read();
+    const uint64_t end_us = time::NowMicros();
+    OperatorCounters& totals =
+        totals_[std::make_pair(event.subgraph_index, event.node_index)];
+    totals.subgraph_index = event.subgraph_index;
+    totals.node_index = event.node_index;
+    ++totals.invocations;
+    totals.elapsed_us += end_us - event.begin_us;
+    totals.counters += end - event.begin;
+  }
+  if (next_) next_->EndEvent(event.next_handle);
+  open_events_.resize(event_handle);
+}
+
+void HardwareCounterProfiler::Reset() {
+  enabled_ = false;
+  open_events_.clear();
+  totals_.clear();
+}
+
+std::vector<OperatorCounters> HardwareCounterProfiler::GetOperatorCounters()
+    const {
+  std::vector<OperatorCounters> result;
+  result.reserve(totals_.size());
+  for (const auto& entry : totals_) {
+    result.push_back(entry.second);
+  }
+  return result;
+}
+
+}  // namespace profiling
+}  // namespace tflite
@@ -0,0 +1,90 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTER_PROFILER_H_
+#define TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTER_PROFILER_H_
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/profiling/hardware_counters.h"
+
+namespace tflite {
+namespace profiling {
+
+// The time and hardware counts accumulated over all invocations of an
+// operator.
+struct OperatorCounters {
+  uint32_t subgraph_index = 0;
+  uint32_t node_index = 0;
+  int64_t invocations = 0;
+  uint64_t elapsed_us = 0;
+  HardwareCounterValues counters;
+};
+
+// A profiler that attributes hardware counts (see HardwareCounters) to the
+// operator invoke events. Counts of nested operators, e.g. the body of a
+// control flow operator, are included in the counts of the enclosing operator.
+//
+// All events are also forwarded to `next`, if not null, so that it can be
+// combined with e.g. a BufferedProfiler. Like the other profilers, it must be
+// used from a single thread.
+class HardwareCounterProfiler : public tflite::Profiler {
+ public:
+  explicit HardwareCounterProfiler(tflite::Profiler* next = nullptr)
+      : next_(next) {}
+
+  uint32_t BeginEvent(const char* tag, EventType event_type,
+                      uint32_t event_metadata,
+                      uint32_t event_subgraph_index) override;
+
+  void EndEvent(uint32_t event_handle) override;
+
+  // Returns whether the hardware counters could be opened. When they could
+  // not, only invocations and elapsed time are collected.
+  bool HasHardwareCounters() const { return counters_.IsAvailable(); }
+
+  void StartProfiling() { enabled_ = true; }
+  void StopProfiling() { enabled_ = false; }
+  void Reset();
+
+  // Returns the counts of each operator seen while profiling was enabled,
+  // ordered by subgraph and node index.
+  std::vector<OperatorCounters> GetOperatorCounters() const;
+
+ private:
+  struct OpenEvent {
+    uint32_t next_handle;
+    bool is_counted;
+    uint32_t subgraph_index;
+    uint32_t node_index;
+    uint64_t begin_us;
+    HardwareCounterValues begin;
+  };
+
+  tflite::Profiler* const next_;
+  HardwareCounters counters_;
+  bool enabled_ = false;
+  // Events are scoped, so they end in the reverse order they began and the
+  // handle of an event is its position in this stack.
+  std::vector<OpenEvent> open_events_;
+  std::map<std::pair<uint32_t, uint32_t>, OperatorCounters> totals_;
+};
+
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTER_PROFILER_H_
@@ -0,0 +1,116 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/hardware_counter_profiler.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/profiling/buffered_profiler.h"
+#include "tensorflow/lite/testing/util.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+// Some work for the counters to count.
+float Work() {
+  volatile float sum = 0.0f;
+  for (int i = 0; i < 100000; ++i) {
+    sum = sum + static_cast<float>(i);
+  }
+  return sum;
+}
+
+void InvokeNode(tflite::Profiler* profiler, int node_index) {
+  TFLITE_SCOPED_OPERATOR_PROFILE(profiler, node_index);
+  Work();
+}
+
+TEST(HardwareCountersTest, CountsIncrease) {
+  HardwareCounters counters;
+  if (!counters.IsAvailable()) {
+    // Perf events are not accessible in this environment.
+    EXPECT_EQ(counters.Read().cycles, 0u);
+    return;
+  }
+  const HardwareCounterValues begin = counters.Read();
+  Work();
+  const HardwareCounterValues delta = counters.Read() - begin;
+  EXPECT_GT(delta.cycles, 0u);
+  EXPECT_GT(delta.instructions, 0u);
+}
+
+TEST(HardwareCounterProfilerTest, NothingIsCollectedWhenDisabled) {
+  HardwareCounterProfiler profiler;
+  InvokeNode(&profiler, 0);
+  EXPECT_TRUE(profiler.GetOperatorCounters().empty());
+}
+
+TEST(HardwareCounterProfilerTest, OperatorsAreAccumulated) {
+  HardwareCounterProfiler profiler;
+  profiler.StartProfiling();
+  for (int i = 0; i < 3; ++i) {
+    InvokeNode(&profiler, 2);
+    InvokeNode(&profiler, 1);
+  }
+  {
+    // Only operator invoke events are counted.
+    ScopedProfile profile(&profiler, "NotAnOperator");
+    Work();
+  }
+  profiler.StopProfiling();
+  InvokeNode(&profiler, 1);
+
+  auto counters = profiler.GetOperatorCounters();
+  ASSERT_EQ(counters.size(), 2);
+  EXPECT_EQ(counters[0].node_index, 1);
+  EXPECT_EQ(counters[0].invocations, 3);
+  EXPECT_EQ(counters[1].node_index, 2);
+  EXPECT_EQ(counters[1].invocations, 3);
+  if (profiler.HasHardwareCounters()) {
+    EXPECT_GT(counters[0].counters.instructions, 0u);
+    EXPECT_GT(counters[1].counters.instructions, 0u);
+  }
+
+  profiler.Reset();
+  EXPECT_TRUE(profiler.GetOperatorCounters().empty());
+}
+
+TEST(HardwareCounterProfilerTest, EventsAreForwarded) {
+  BufferedProfiler buffered_profiler(1024);
+  buffered_profiler.StartProfiling();
+  HardwareCounterProfiler profiler(&buffered_profiler);
+  profiler.StartProfiling();
+  {
+    ScopedProfile profile(&profiler, "Parent");
+    InvokeNode(&profiler, 0);
+  }
+
+  auto events = buffered_profiler.GetProfileEvents();
+  ASSERT_EQ(events.size(), 2);
+  EXPECT_STREQ(events[0]->tag, "Parent");
+  EXPECT_STREQ(events[1]->tag, "OpInvoke");
+  EXPECT_GE(events[0]->end_timestamp_us, events[1]->end_timestamp_us);
+  EXPECT_EQ(profiler.GetOperatorCounters().size(), 1);
+}
+
+}  // namespace
+}  // namespace profiling
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
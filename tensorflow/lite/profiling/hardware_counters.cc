@@ -0,0 +1,134 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/hardware_counters.h"
+
+#ifdef __linux__
+#include <asm/unistd.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
+namespace tflite {
+namespace profiling {
+
+HardwareCounterValues& HardwareCounterValues::operator+=(
+    const HardwareCounterValues& other) {
+  cycles += other.cycles;
+  instructions += other.instructions;
+  cache_references += other.cache_references;
+  cache_misses += other.cache_misses;
+  return *this;
+}
+
+HardwareCounterValues HardwareCounterValues::operator-(
+    const HardwareCounterValues& other) const {
+  HardwareCounterValues result;
+  result.cycles = cycles - other.cycles;
+  result.instructions = instructions - other.instructions;
+  result.cache_references = cache_references - other.cache_references;
+  result.cache_misses = cache_misses - other.cache_misses;
+  return result;
+}
+
+#ifdef __linux__
+
+namespace {
+
+int OpenPerfEvent(uint64_t config, int group_fd) {
+  perf_event_attr pe;
+  memset(&pe, 0, sizeof(pe));
+  pe.size = sizeof(pe);
+  pe.type = PERF_TYPE_HARDWARE;
+  pe.config = config;
+  // The group is enabled through its leader once all events are added.
+  pe.disabled = group_fd == -1 ? 1 : 0;
+  pe.exclude_kernel = 1;
+  pe.exclude_hv = 1;
+  pe.read_format = PERF_FORMAT_GROUP;
+  return syscall(__NR_perf_event_open, &pe, /*pid=*/0, /*cpu=*/-1, group_fd,
+                 /*flags=*/0);
+}
+
+}  // namespace
+
+HardwareCounters::HardwareCounters() {
+  const struct {
+    uint64_t config;
+    uint64_t HardwareCounterValues::*field;
+  } kEvents[kMaxEvents] = {
+      {PERF_COUNT_HW_CPU_CYCLES, &HardwareCounterValues::cycles},
+      {PERF_COUNT_HW_INSTRUCTIONS, &HardwareCounterValues::instructions},
+      {PERF_COUNT_HW_CACHE_REFERENCES,
+       &HardwareCounterValues::cache_references},
+      {PERF_COUNT_HW_CACHE_MISSES, &HardwareCounterValues::cache_misses},
+  };
+  for (const auto& event : kEvents) {
+    const int fd = OpenPerfEvent(event.config, group_fd_);
+    if (fd == -1) {
+      // Without cycles nothing is worth reporting; the other events are
+      // optional as not every CPU implements them.
+      if (group_fd_ == -1) return;
+      continue;
+    }
+    if (group_fd_ == -1) group_fd_ = fd;
+    fds_[num_events_] = fd;
+    fields_[num_events_] = event.field;
+    ++num_events_;
+  }
+  ioctl(group_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(group_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+HardwareCounters::~HardwareCounters() {
+  if (group_fd_ != -1) {
+    ioctl(group_fd_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+  }
+  for (int i = 0; i < num_events_; ++i) {
+    close(fds_[i]);
+  }
+}
+
+HardwareCounterValues HardwareCounters::Read() const {
+  HardwareCounterValues values;
+  if (group_fd_ == -1) return values;
+  // With PERF_FORMAT_GROUP, the leader reads the number of events followed by
+  // the value of each event.
+  uint64_t buffer[1 + kMaxEvents];
+  if (read(group_fd_, buffer, sizeof(buffer)) == -1) return values;
+  const int count = static_cast<int>(buffer[0]);
+  for (int i = 0; i < count && i < num_events_; ++i) {
+    values.*fields_[i] = buffer[1 + i];
+  }
+  return values;
+}
+
+#else
+
+HardwareCounters::HardwareCounters() {}
+
+HardwareCounters::~HardwareCounters() {}
+
+HardwareCounterValues HardwareCounters::Read() const {
+  return HardwareCounterValues();
+}
+
+#endif
+
+}  // namespace profiling
+}  // namespace tflite
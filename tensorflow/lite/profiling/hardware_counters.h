@@ -0,0 +1,78 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTERS_H_
+#define TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTERS_H_
+
+#include <cstdint>
+
+namespace tflite {
+namespace profiling {
+
+// Values of the hardware performance counters.
+struct HardwareCounterValues {
+  uint64_t cycles = 0;
+  uint64_t instructions = 0;
+  // Last level cache accesses and misses.
+  uint64_t cache_references = 0;
+  uint64_t cache_misses = 0;
+
+  HardwareCounterValues& operator+=(const HardwareCounterValues& other);
+  HardwareCounterValues operator-(const HardwareCounterValues& other) const;
+};
+
+// Counts the CPU cycles, retired instructions and last level cache accesses of
+// the calling thread using Linux perf events. Unlike ruy::PmuEvents, which
+// programs raw ARM PMU events, this uses the generic hardware events so that
+// it works on any CPU known to the kernel.
+//
+// The counters are started on construction and are read with Read(), so the
+// counts of a region of code are the difference of two reads. On other
+// platforms, or when perf events are not accessible (e.g. because of
+// /proc/sys/kernel/perf_event_paranoid), IsAvailable() returns false and all
+// values read as zero.
+//
+// Only the thread that created the object is counted, so work handed off to
+// other threads, e.g. the worker threads of a multithreaded kernel, is not
+// included.
+class HardwareCounters {
+ public:
+  HardwareCounters();
+  ~HardwareCounters();
+
+  HardwareCounters(const HardwareCounters&) = delete;
+  HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+  bool IsAvailable() const { return group_fd_ != -1; }
+
+  // Returns the counts accumulated since construction.
+  HardwareCounterValues Read() const;
+
+ private:
+  static constexpr int kMaxEvents = 4;
+
+  // The file descriptor of the group leader, or -1 if the counters could not
+  // be opened.
+  int group_fd_ = -1;
+  int fds_[kMaxEvents] = {-1, -1, -1, -1};
+  // The fields of HardwareCounterValues the opened events are read into, in
+  // the order they were added to the group.
+  uint64_t HardwareCounterValues::*fields_[kMaxEvents] = {};
+  int num_events_ = 0;
+};
+
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTERS_H_
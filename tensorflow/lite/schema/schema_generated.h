@@ -28,6 +28,9 @@ struct CustomQuantizationT;
 struct QuantizationParameters;
 struct QuantizationParametersT;
 
+struct BlockSparsity;
+struct BlockSparsityT;
+
 struct Tensor;
 struct TensorT;
 
@@ -2846,6 +2849,99 @@ inline flatbuffers::Offset<QuantizationParameters> CreateQuantizationParametersD
 
 flatbuffers::Offset<QuantizationParameters> CreateQuantizationParameters(flatbuffers::FlatBufferBuilder &_fbb, const QuantizationParametersT *_o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
 
+struct BlockSparsityT : public flatbuffers::NativeTable {
+  typedef BlockSparsity TableType;
+  std::vector<int32_t> block_shape;
+  std::vector<int32_t> row_segments;
+  std::vector<int32_t> col_indices;
+  BlockSparsityT() {
+  }
+};
+
+struct BlockSparsity FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  typedef BlockSparsityT NativeTableType;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_BLOCK_SHAPE = 4,
+    VT_ROW_SEGMENTS = 6,
+    VT_COL_INDICES = 8
+  };
+  const flatbuffers::Vector<int32_t> *block_shape() const {
+    return GetPointer<const flatbuffers::Vector<int32_t> *>(VT_BLOCK_SHAPE);
+  }
+  const flatbuffers::Vector<int32_t> *row_segments() const {
+    return GetPointer<const flatbuffers::Vector<int32_t> *>(VT_ROW_SEGMENTS);
+  }
+  const flatbuffers::Vector<int32_t> *col_indices() const {
+    return GetPointer<const flatbuffers::Vector<int32_t> *>(VT_COL_INDICES);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_BLOCK_SHAPE) &&
+           verifier.VerifyVector(block_shape()) &&
+           VerifyOffset(verifier, VT_ROW_SEGMENTS) &&
+           verifier.VerifyVector(row_segments()) &&
+           VerifyOffset(verifier, VT_COL_INDICES) &&
+           verifier.VerifyVector(col_indices()) &&
+           verifier.EndTable();
+  }
+  BlockSparsityT *UnPack(const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  void UnPackTo(BlockSparsityT *_o, const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  static flatbuffers::Offset<BlockSparsity> Pack(flatbuffers::FlatBufferBuilder &_fbb, const BlockSparsityT* _o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+};
+
+struct BlockSparsityBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_block_shape(flatbuffers::Offset<flatbuffers::Vector<int32_t>> block_shape) {
+    fbb_.AddOffset(BlockSparsity::VT_BLOCK_SHAPE, block_shape);
+  }
+  void add_row_segments(flatbuffers::Offset<flatbuffers::Vector<int32_t>> row_segments) {
+    fbb_.AddOffset(BlockSparsity::VT_ROW_SEGMENTS, row_segments);
+  }
+  void add_col_indices(flatbuffers::Offset<flatbuffers::Vector<int32_t>> col_indices) {
+    fbb_.AddOffset(BlockSparsity::VT_COL_INDICES, col_indices);
+  }
+  explicit BlockSparsityBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  BlockSparsityBuilder &operator=(const BlockSparsityBuilder &);
+  flatbuffers::Offset<BlockSparsity> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<BlockSparsity>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<BlockSparsity> CreateBlockSparsity(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::Vector<int32_t>> block_shape = 0,
+    flatbuffers::Offset<flatbuffers::Vector<int32_t>> row_segments = 0,
+    flatbuffers::Offset<flatbuffers::Vector<int32_t>> col_indices = 0) {
+  BlockSparsityBuilder builder_(_fbb);
+  builder_.add_col_indices(col_indices);
+  builder_.add_row_segments(row_segments);
+  builder_.add_block_shape(block_shape);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<BlockSparsity> CreateBlockSparsityDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<int32_t> *block_shape = nullptr,
+    const std::vector<int32_t> *row_segments = nullptr,
+    const std::vector<int32_t> *col_indices = nullptr) {
+  auto block_shape__ = block_shape ? _fbb.CreateVector<int32_t>(*block_shape) : 0;
+  auto row_segments__ = row_segments ? _fbb.CreateVector<int32_t>(*row_segments) : 0;
+  auto col_indices__ = col_indices ? _fbb.CreateVector<int32_t>(*col_indices) : 0;
+  return tflite::CreateBlockSparsity(
+      _fbb,
+      block_shape__,
+      row_segments__,
+      col_indices__);
+}
+
+flatbuffers::Offset<BlockSparsity> CreateBlockSparsity(flatbuffers::FlatBufferBuilder &_fbb, const BlockSparsityT *_o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+
 struct TensorT : public flatbuffers::NativeTable {
   typedef Tensor TableType;
   std::vector<int32_t> shape;
@@ -2854,6 +2950,7 @@ struct TensorT : public flatbuffers::NativeTable {
   std::string name;
   std::unique_ptr<QuantizationParametersT> quantization;
   bool is_variable;
+  std::unique_ptr<BlockSparsityT> sparsity;
   TensorT()
       : type(TensorType_FLOAT32),
         buffer(0),
@@ -2869,7 +2966,8 @@ struct Tensor FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
     VT_BUFFER = 8,
     VT_NAME = 10,
     VT_QUANTIZATION = 12,
-    VT_IS_VARIABLE = 14
+    VT_IS_VARIABLE = 14,
+    VT_SPARSITY = 16
   };
   const flatbuffers::Vector<int32_t> *shape() const {
     return GetPointer<const flatbuffers::Vector<int32_t> *>(VT_SHAPE);
@@ -2889,6 +2987,9 @@ struct Tensor FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   bool is_variable() const {
     return GetField<uint8_t>(VT_IS_VARIABLE, 0) != 0;
   }
+  const BlockSparsity *sparsity() const {
+    return GetPointer<const BlockSparsity *>(VT_SPARSITY);
+  }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyOffset(verifier, VT_SHAPE) &&
@@ -2900,6 +3001,8 @@ struct Tensor FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
            VerifyOffset(verifier, VT_QUANTIZATION) &&
            verifier.VerifyTable(quantization()) &&
            VerifyField<uint8_t>(verifier, VT_IS_VARIABLE) &&
+           VerifyOffset(verifier, VT_SPARSITY) &&
+           verifier.VerifyTable(sparsity()) &&
            verifier.EndTable();
   }
   TensorT *UnPack(const flatbuffers::resolver_function_t *_resolver = nullptr) const;
@@ -2928,6 +3031,9 @@ struct TensorBuilder {
   void add_is_variable(bool is_variable) {
     fbb_.AddElement<uint8_t>(Tensor::VT_IS_VARIABLE, static_cast<uint8_t>(is_variable), 0);
   }
+  void add_sparsity(flatbuffers::Offset<BlockSparsity> sparsity) {
+    fbb_.AddOffset(Tensor::VT_SPARSITY, sparsity);
+  }
   explicit TensorBuilder(flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -2947,8 +3053,10 @@ inline flatbuffers::Offset<Tensor> CreateTensor(
     uint32_t buffer = 0,
     flatbuffers::Offset<flatbuffers::String> name = 0,
     flatbuffers::Offset<QuantizationParameters> quantization = 0,
-    bool is_variable = false) {
+    bool is_variable = false,
+    flatbuffers::Offset<BlockSparsity> sparsity = 0) {
   TensorBuilder builder_(_fbb);
+  builder_.add_sparsity(sparsity);
   builder_.add_quantization(quantization);
   builder_.add_name(name);
   builder_.add_buffer(buffer);
@@ -2965,7 +3073,8 @@ inline flatbuffers::Offset<Tensor> CreateTensorDirect(
     uint32_t buffer = 0,
     const char *name = nullptr,
     flatbuffers::Offset<QuantizationParameters> quantization = 0,
-    bool is_variable = false) {
+    bool is_variable = false,
+    flatbuffers::Offset<BlockSparsity> sparsity = 0) {
   auto shape__ = shape ? _fbb.CreateVector<int32_t>(*shape) : 0;
   auto name__ = name ? _fbb.CreateString(name) : 0;
   return tflite::CreateTensor(
@@ -2975,7 +3084,8 @@ inline flatbuffers::Offset<Tensor> CreateTensorDirect(
       buffer,
       name__,
       quantization,
-      is_variable);
+      is_variable,
+      sparsity);
 }
 
 flatbuffers::Offset<Tensor> CreateTensor(flatbuffers::FlatBufferBuilder &_fbb, const TensorT *_o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
@@ -9658,6 +9768,38 @@ inline flatbuffers::Offset<QuantizationParameters> CreateQuantizationParameters(
       _quantized_dimension);
 }
 
+inline BlockSparsityT *BlockSparsity::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
+  auto _o = new BlockSparsityT();
+  UnPackTo(_o, _resolver);
+  return _o;
+}
+
+inline void BlockSparsity::UnPackTo(BlockSparsityT *_o, const flatbuffers::resolver_function_t *_resolver) const {
+  (void)_o;
+  (void)_resolver;
+  { auto _e = block_shape(); if (_e) { _o->block_shape.resize(_e->size()); for (flatbuffers::uoffset_t _i = 0; _i < _e->size(); _i++) { _o->block_shape[_i] = _e->Get(_i); } } };
+  { auto _e = row_segments(); if (_e) { _o->row_segments.resize(_e->size()); for (flatbuffers::uoffset_t _i = 0; _i < _e->size(); _i++) { _o->row_segments[_i] = _e->Get(_i); } } };
+  { auto _e = col_indices(); if (_e) { _o->col_indices.resize(_e->size()); for (flatbuffers::uoffset_t _i = 0; _i < _e->size(); _i++) { _o->col_indices[_i] = _e->Get(_i); } } };
+}
+
+inline flatbuffers::Offset<BlockSparsity> BlockSparsity::Pack(flatbuffers::FlatBufferBuilder &_fbb, const BlockSparsityT* _o, const flatbuffers::rehasher_function_t *_rehasher) {
+  return CreateBlockSparsity(_fbb, _o, _rehasher);
+}
+
+inline flatbuffers::Offset<BlockSparsity> CreateBlockSparsity(flatbuffers::FlatBufferBuilder &_fbb, const BlockSparsityT *_o, const flatbuffers::rehasher_function_t *_rehasher) {
+  (void)_rehasher;
+  (void)_o;
+  struct _VectorArgs { flatbuffers::FlatBufferBuilder *__fbb; const BlockSparsityT* __o; const flatbuffers::rehasher_function_t *__rehasher; } _va = { &_fbb, _o, _rehasher}; (void)_va;
+  auto _block_shape = _o->block_shape.size() ? _fbb.CreateVector(_o->block_shape) : 0;
+  auto _row_segments = _o->row_segments.size() ? _fbb.CreateVector(_o->row_segments) : 0;
+  auto _col_indices = _o->col_indices.size() ? _fbb.CreateVector(_o->col_indices) : 0;
+  return tflite::CreateBlockSparsity(
+      _fbb,
+      _block_shape,
+      _row_segments,
+      _col_indices);
+}
+
 inline TensorT *Tensor::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
   auto _o = new TensorT();
   UnPackTo(_o, _resolver);
@@ -9673,6 +9815,7 @@ inline void Tensor::UnPackTo(TensorT *_o, const flatbuffers::resolver_function_t
   { auto _e = name(); if (_e) _o->name = _e->str(); };
   { auto _e = quantization(); if (_e) _o->quantization = std::unique_ptr<QuantizationParametersT>(_e->UnPack(_resolver)); };
   { auto _e = is_variable(); _o->is_variable = _e; };
+  { auto _e = sparsity(); if (_e) _o->sparsity = std::unique_ptr<BlockSparsityT>(_e->UnPack(_resolver)); };
 }
 
 inline flatbuffers::Offset<Tensor> Tensor::Pack(flatbuffers::FlatBufferBuilder &_fbb, const TensorT* _o, const flatbuffers::rehasher_function_t *_rehasher) {
@@ -9689,6 +9832,7 @@ inline flatbuffers::Offset<Tensor> CreateTensor(flatbuffers::FlatBufferBuilder &
   auto _name = _o->name.empty() ? 0 : _fbb.CreateString(_o->name);
   auto _quantization = _o->quantization ? CreateQuantizationParameters(_fbb, _o->quantization.get(), _rehasher) : 0;
   auto _is_variable = _o->is_variable;
+  auto _sparsity = _o->sparsity ? CreateBlockSparsity(_fbb, _o->sparsity.get(), _rehasher) : 0;
   return tflite::CreateTensor(
       _fbb,
       _shape,
@@ -9696,7 +9840,8 @@ inline flatbuffers::Offset<Tensor> CreateTensor(flatbuffers::FlatBufferBuilder &
       _buffer,
       _name,
       _quantization,
-      _is_variable);
+      _is_variable,
+      _sparsity);
 }
 
 inline Conv2DOptionsT *Conv2DOptions::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
@@ -0,0 +1,67 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/shared_constants_context.h"
+
+#include <cstdint>
+
+namespace tflite {
+namespace {
+
+TfLiteStatus RefreshSharedConstantsContext(TfLiteContext* context) {
+  // The shared buffers don't depend on the interpreter settings.
+  return kTfLiteOk;
+}
+
+char* AlignedPointer(char* ptr) {
+  const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(ptr);
+  const std::uintptr_t alignment = SharedConstantsContext::kBufferAlignment;
+  return reinterpret_cast<char*>((address + alignment - 1) / alignment *
+                                 alignment);
+}
+
+}  // namespace
+
+constexpr size_t SharedConstantsContext::kBufferAlignment;
+
+SharedConstantsContext::SharedConstantsContext() {
+  this->type = kTfLiteSharedConstantsContext;
+  this->Refresh = RefreshSharedConstantsContext;
+}
+
+SharedConstantsContext* SharedConstantsContext::Get(TfLiteContext* context) {
+  return static_cast<SharedConstantsContext*>(
+      context->GetExternalContext(context, kTfLiteSharedConstantsContext));
+}
+
+const char* SharedConstantsContext::GetOrCreate(
+    const void* source, const std::string& tag, size_t bytes,
+    const std::function<void(char*)>& fill) {
+  // Filling is done with the lock held, so that concurrent 'prepare' calls
+  // for the same constant don't redo the work.
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::unique_ptr<char[]>& buffer = buffers_[Key(source, tag, bytes)];
+  if (buffer == nullptr) {
+    buffer.reset(new char[bytes + kBufferAlignment]);
+    fill(AlignedPointer(buffer.get()));
+  }
+  return AlignedPointer(buffer.get());
+}
+
+int SharedConstantsContext::num_buffers() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return buffers_.size();
+}
+
+}  // namespace tflite
@@ -0,0 +1,83 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_SHARED_CONSTANTS_CONTEXT_H_
+#define TENSORFLOW_LITE_SHARED_CONSTANTS_CONTEXT_H_
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <tuple>
+
+#include "tensorflow/lite/c/c_api_internal.h"
+
+namespace tflite {
+
+// This 'kTfLiteSharedConstantsContext'-typed external context holds data that
+// ops derive from constant tensors of a model during 'prepare' (e.g. filter
+// weights transposed or packed into the layout a kernel expects), so that it
+// can be shared among a set of TF Lite interpreters built from the same
+// FlatBufferModel. Together with the read-only weights that are already
+// memory-mapped from the model, this lets several interpreters serve
+// concurrent requests while only duplicating their activation arenas:
+//
+//  SharedConstantsContext shared_constants;
+//  for (auto& interpreter : interpreters) {
+//    InterpreterBuilder(*model, resolver)(&interpreter);
+//    interpreter->SetExternalContext(kTfLiteSharedConstantsContext,
+//                                    &shared_constants);
+//    interpreter->AllocateTensors();
+//  }
+//  // Each interpreter may now be invoked from its own thread.
+//
+// Unlike ExternalCpuBackendContext, this context is thread-safe, and the
+// interpreters sharing it may be invoked simultaneously. It must outlive all
+// of them, and the model must outlive it.
+class SharedConstantsContext : public TfLiteExternalContext {
+ public:
+  SharedConstantsContext();
+  ~SharedConstantsContext() {}
+
+  // Returns the context set on 'context', or nullptr if there is none.
+  static SharedConstantsContext* Get(TfLiteContext* context);
+
+  // Returns a buffer of 'bytes' bytes holding the data derived from the
+  // constant buffer 'source' by the transformation named 'tag'. The first call
+  // for a given source, tag and size allocates the buffer and calls 'fill' to
+  // initialize it; later calls return the same buffer. The returned buffer is
+  // aligned to kBufferAlignment bytes and must not be modified.
+  const char* GetOrCreate(const void* source, const std::string& tag,
+                          size_t bytes, const std::function<void(char*)>& fill);
+
+  // Returns the number of buffers currently held by this context.
+  int num_buffers() const;
+
+  static constexpr size_t kBufferAlignment = 64;
+
+ private:
+  using Key = std::tuple<const void*, std::string, size_t>;
+
+  mutable std::mutex mutex_;
+  std::map<Key, std::unique_ptr<char[]>> buffers_;
+
+  SharedConstantsContext(const SharedConstantsContext&) = delete;
+  SharedConstantsContext& operator=(const SharedConstantsContext&) = delete;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SHARED_CONSTANTS_CONTEXT_H_
@@ -0,0 +1,91 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/shared_constants_context.h"
+
+#include <cstdint>
+#include <cstring>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/testing/util.h"
+
+namespace tflite {
+namespace {
+
+TEST(SharedConstantsContextTest, BuffersAreCreatedOnce) {
+  SharedConstantsContext shared_constants;
+  const float source[] = {1, 2, 3, 4};
+  int num_fills = 0;
+  auto fill = [&source, &num_fills](char* buffer) {
+    std::memcpy(buffer, source, sizeof(source));
+    ++num_fills;
+  };
+
+  const char* buffer =
+      shared_constants.GetOrCreate(source, "copy", sizeof(source), fill);
+  EXPECT_EQ(std::memcmp(buffer, source, sizeof(source)), 0);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(buffer) %
+                SharedConstantsContext::kBufferAlignment,
+            0);
+  EXPECT_EQ(shared_constants.GetOrCreate(source, "copy", sizeof(source), fill),
+            buffer);
+  EXPECT_EQ(num_fills, 1);
+
+  // A different transformation or size of the same source gets its own buffer.
+  EXPECT_NE(shared_constants.GetOrCreate(source, "other", sizeof(source), fill),
+            buffer);
+  EXPECT_NE(shared_constants.GetOrCreate(source, "copy", sizeof(float), fill),
+            buffer);
+  EXPECT_EQ(num_fills, 3);
+  EXPECT_EQ(shared_constants.num_buffers(), 3);
+}
+
+TEST(SharedConstantsContextTest, ConcurrentCalls) {
+  SharedConstantsContext shared_constants;
+  const int source = 0;
+  int num_fills = 0;
+  std::vector<const char*> buffers(8);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&, i]() {
+      buffers[i] = shared_constants.GetOrCreate(
+          &source, "tag", 16, [&num_fills](char*) { ++num_fills; });
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(num_fills, 1);
+  for (const char* buffer : buffers) EXPECT_EQ(buffer, buffers[0]);
+}
+
+TEST(SharedConstantsContextTest, SetOnInterpreter) {
+  SharedConstantsContext shared_constants;
+  Interpreter interpreter;
+  TfLiteContext* context = interpreter.primary_subgraph().context();
+  EXPECT_EQ(SharedConstantsContext::Get(context), nullptr);
+  interpreter.SetExternalContext(kTfLiteSharedConstantsContext,
+                                 &shared_constants);
+  EXPECT_EQ(SharedConstantsContext::Get(context), &shared_constants);
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
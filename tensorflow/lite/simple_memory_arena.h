@@ -45,6 +45,14 @@ struct ArenaAlloc {
 // zero-sized allocations are explicitly allowed, and will resolve to null.
 class SimpleMemoryArena {
  public:
+  // The part of the arena's state that results from the sequence of
+  // Allocate() and Deallocate() calls. Restoring a saved layout is equivalent
+  // to replaying the calls that produced it.
+  struct Layout {
+    size_t high_water_mark;
+    std::list<ArenaAlloc> allocs;
+  };
+
   explicit SimpleMemoryArena(size_t arena_alignment)
       : committed_(false),
         arena_alignment_(arena_alignment),
@@ -71,6 +79,16 @@ class SimpleMemoryArena {
 
   TfLiteStatus Clear();
 
+  Layout GetLayout() const { return Layout{high_water_mark_, allocs_}; }
+
+  // Replaces the current allocations with the given ones. The underlying
+  // buffer is kept, so Commit() only grows it if the layout needs more memory.
+  void RestoreLayout(const Layout& layout) {
+    committed_ = false;
+    high_water_mark_ = layout.high_water_mark;
+    allocs_ = layout.allocs;
+  }
+
   std::intptr_t BasePointer() const {
     return reinterpret_cast<std::intptr_t>(underlying_buffer_aligned_ptr_);
   }
@@ -21,6 +21,16 @@ namespace tflite {
 
 namespace {
 
+// The alignment of the buffers in the schema ('force_align'), which lets the
+// interpreter use the data of a memory-mapped model in place.
+constexpr size_t kBufferAlignment = 16;
+
+DataBuffer::FlatBufferOffset CreateAlignedBuffer(
+    const uint8_t* data, size_t size, flatbuffers::FlatBufferBuilder* builder) {
+  builder->ForceVectorAlignment(size, sizeof(uint8_t), kBufferAlignment);
+  return builder->CreateVector(data, size);
+}
+
 DataBuffer::FlatBufferOffset CopyStringToBuffer(
     const Array& array, flatbuffers::FlatBufferBuilder* builder) {
   const auto& src_data = array.GetBuffer<ArrayDataType::kString>().data;
@@ -33,17 +43,17 @@ DataBuffer::FlatBufferOffset CopyStringToBuffer(
   std::vector<uint8_t> dst_data(bytes);
   memcpy(dst_data.data(), tensor_buffer, bytes);
   free(tensor_buffer);
-  return builder->CreateVector(dst_data.data(), bytes);
+  return CreateAlignedBuffer(dst_data.data(), bytes, builder);
 }
 
 // vector<bool> may be implemented using a bit-set, so we can't just
-// reinterpret_cast, accessing its data as vector<bool> and let flatbuffer
-// CreateVector handle it.
+// reinterpret_cast its data, and copy it to one byte per value instead.
 // Background: https://isocpp.org/blog/2012/11/on-vectorbool
 DataBuffer::FlatBufferOffset CopyBoolToBuffer(
     const Array& array, flatbuffers::FlatBufferBuilder* builder) {
   const auto& src_data = array.GetBuffer<ArrayDataType::kBool>().data;
-  return builder->CreateVector(src_data);
+  const std::vector<uint8_t> dst_data(src_data.begin(), src_data.end());
+  return CreateAlignedBuffer(dst_data.data(), dst_data.size(), builder);
 }
 
 template <ArrayDataType T>
@@ -53,7 +63,7 @@ DataBuffer::FlatBufferOffset CopyBuffer(
   const auto& src_data = array.GetBuffer<T>().data;
   const uint8_t* dst_data = reinterpret_cast<const uint8_t*>(src_data.data());
   auto size = src_data.size() * sizeof(NativeT);
-  return builder->CreateVector(dst_data, size);
+  return CreateAlignedBuffer(dst_data, size, builder);
 }
 
 void CopyStringFromBuffer(const ::tflite::Buffer& buffer, Array* array) {
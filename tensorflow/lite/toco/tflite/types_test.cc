@@ -182,6 +182,31 @@ TEST(DataBuffer, Complex64) {
                                      std::complex<float>(3.0f, 4.0f)));
 }
 
+TEST(DataBuffer, Alignment) {
+  // A buffer of odd size followed by another one, whose data must still be
+  // aligned as the schema requires.
+  Array odd;
+  odd.data_type = ArrayDataType::kUint8;
+  odd.GetMutableBuffer<ArrayDataType::kUint8>().data = {1, 2, 3};
+  Array floats;
+  floats.data_type = ArrayDataType::kFloat;
+  floats.GetMutableBuffer<ArrayDataType::kFloat>().data = {1.0f, 2.0f};
+
+  flatbuffers::FlatBufferBuilder builder;
+  std::vector<Offset<::tflite::Buffer>> buffers;
+  for (const Array* array : {&odd, &floats}) {
+    buffers.push_back(::tflite::CreateBuffer(
+        builder, DataBuffer::Serialize(*array, &builder)));
+  }
+  builder.Finish(builder.CreateVector(buffers));
+
+  const uint8_t* start = builder.GetBufferPointer();
+  auto* root = flatbuffers::GetRoot<Vector<Offset<::tflite::Buffer>>>(start);
+  for (const ::tflite::Buffer* buffer : *root) {
+    EXPECT_EQ((buffer->data()->data() - start) % 16, 0);
+  }
+}
+
 TEST(Padding, All) {
   EXPECT_EQ(::tflite::Padding_SAME, Padding::Serialize(PaddingType::kSame));
   EXPECT_EQ(PaddingType::kSame, Padding::Deserialize(::tflite::Padding_SAME));
@@ -0,0 +1,338 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/benchmark_load_generator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <deque>
+#include <mutex>  // NOLINT(build/c++11)
+#include <random>
+#include <sstream>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "tensorflow/lite/profiling/time.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_params.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
+#include "tensorflow/lite/tools/benchmark/logging.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+// The instances of one model and, in the open loop, its pending requests.
+struct ModelState {
+  std::vector<std::unique_ptr<BenchmarkModel>> instances;
+
+  std::mutex mu;
+  std::condition_variable cv;
+  // The arrival times of the requests not yet served.
+  std::deque<int64_t> arrivals_us;
+  // Set once no more requests arrive.
+  bool closed = false;
+  int64_t num_dropped_requests = 0;
+};
+
+// What a single instance recorded.
+struct InstanceStats {
+  std::vector<int64_t> latencies_us;
+  int64_t num_failed_runs = 0;
+};
+
+void RunClosedLoop(BenchmarkModel* instance, float run_delay, int64_t end_us,
+                   InstanceStats* stats) {
+  while (profiling::time::NowMicros() < end_us) {
+    const int64_t start_us = profiling::time::NowMicros();
+    const TfLiteStatus status = instance->RunSingle();
+    stats->latencies_us.push_back(profiling::time::NowMicros() - start_us);
+    if (status != kTfLiteOk) ++stats->num_failed_runs;
+    util::SleepForSeconds(run_delay);
+  }
+}
+
+void RunOpenLoop(BenchmarkModel* instance, ModelState* state,
+                 InstanceStats* stats) {
+  while (true) {
+    int64_t arrival_us;
+    {
+      std::unique_lock<std::mutex> lock(state->mu);
+      state->cv.wait(lock, [state] {
+        return state->closed || !state->arrivals_us.empty();
+      });
+      if (state->arrivals_us.empty()) return;
+      arrival_us = state->arrivals_us.front();
+      state->arrivals_us.pop_front();
+    }
+    const TfLiteStatus status = instance->RunSingle();
+    stats->latencies_us.push_back(profiling::time::NowMicros() - arrival_us);
+    if (status != kTfLiteOk) ++stats->num_failed_runs;
+  }
+}
+
+// Queues requests arriving as a Poisson process of 'arrival_rate' requests per
+// second until 'end_us'. The requests still queued then are dropped.
+void GenerateArrivals(float arrival_rate, int seed, int64_t start_us,
+                      int64_t end_us, ModelState* state) {
+  std::mt19937 generator(seed);
+  std::exponential_distribution<double> interarrival_secs(arrival_rate);
+  double next_us = start_us;
+  while (true) {
+    next_us += interarrival_secs(generator) * 1e6;
+    if (next_us >= end_us) break;
+    const int64_t now_us = profiling::time::NowMicros();
+    if (next_us > now_us) {
+      profiling::time::SleepForMicros(static_cast<uint64_t>(next_us - now_us));
+    }
+    {
+      std::lock_guard<std::mutex> lock(state->mu);
+      state->arrivals_us.push_back(static_cast<int64_t>(next_us));
+    }
+    state->cv.notify_one();
+  }
+  const int64_t now_us = profiling::time::NowMicros();
+  if (end_us > now_us) {
+    profiling::time::SleepForMicros(static_cast<uint64_t>(end_us - now_us));
+  }
+  {
+    std::lock_guard<std::mutex> lock(state->mu);
+    state->closed = true;
+    state->num_dropped_requests = state->arrivals_us.size();
+    state->arrivals_us.clear();
+  }
+  state->cv.notify_all();
+}
+
+// Returns the 'q'-quantile of the non-empty 'sorted_values'.
+int64_t Percentile(const std::vector<int64_t>& sorted_values, double q) {
+  const size_t rank = static_cast<size_t>(std::ceil(q * sorted_values.size()));
+  return sorted_values[std::max<size_t>(rank, 1) - 1];
+}
+
+}  // namespace
+
+BenchmarkLoadGenerator::BenchmarkLoadGenerator(ModelFactory model_factory)
+    : BenchmarkLoadGenerator(DefaultParams(), std::move(model_factory)) {}
+
+BenchmarkLoadGenerator::BenchmarkLoadGenerator(BenchmarkParams params,
+                                               ModelFactory model_factory)
+    : params_(std::move(params)),
+      model_factory_(std::move(model_factory)),
+      model_prototype_(model_factory_()) {}
+
+BenchmarkParams BenchmarkLoadGenerator::DefaultParams() {
+  BenchmarkParams params;
+  params.AddParam("load_graphs", BenchmarkParam::Create<std::string>(""));
+  params.AddParam("load_instances_per_model",
+                  BenchmarkParam::Create<int32_t>(1));
+  params.AddParam("load_arrival_rate", BenchmarkParam::Create<float>(0.0f));
+  params.AddParam("load_duration_secs", BenchmarkParam::Create<float>(10.0f));
+  return params;
+}
+
+std::vector<Flag> BenchmarkLoadGenerator::GetFlags() {
+  return {
+      CreateFlag<std::string>(
+          "load_graphs", &params_,
+          "A comma-separated list of models to run concurrently. By default, "
+          "only the model of --graph is run."),
+      CreateFlag<int32_t>(
+          "load_instances_per_model", &params_,
+          "The number of instances running each model concurrently, each with "
+          "its own interpreter and thread."),
+      CreateFlag<float>(
+          "load_arrival_rate", &params_,
+          "The rate, in requests per second, at which requests for each model "
+          "arrive (open loop). If not positive, each instance starts a run as "
+          "soon as its previous run ends (closed loop)."),
+      CreateFlag<float>("load_duration_secs", &params_,
+                        "The number of seconds to generate load for."),
+  };
+}
+
+bool BenchmarkLoadGenerator::ParseFlags(int* argc, char** argv) {
+  auto flag_list = GetFlags();
+  const bool parse_result =
+      Flags::Parse(argc, const_cast<const char**>(argv), flag_list);
+  if (!parse_result) {
+    std::string usage = Flags::Usage(argv[0], flag_list);
+    TFLITE_LOG(ERROR) << usage;
+    return false;
+  }
+  return true;
+}
+
+void BenchmarkLoadGenerator::LogParams() {
+  TFLITE_LOG(INFO) << "Load graphs: ["
+                   << params_.Get<std::string>("load_graphs") << "]";
+  TFLITE_LOG(INFO) << "Load instances per model: ["
+                   << params_.Get<int32_t>("load_instances_per_model") << "]";
+  TFLITE_LOG(INFO) << "Load arrival rate (requests per second): ["
+                   << params_.Get<float>("load_arrival_rate") << "]";
+  TFLITE_LOG(INFO) << "Load duration (seconds): ["
+                   << params_.Get<float>("load_duration_secs") << "]";
+}
+
+TfLiteStatus BenchmarkLoadGenerator::Run(int argc, char** argv) {
+  // The flags of the models go to the prototype, whose params are copied to
+  // every instance.
+  TF_LITE_ENSURE_STATUS(model_prototype_->ParseFlags(&argc, argv));
+  if (!ParseFlags(&argc, argv)) return kTfLiteError;
+
+  for (int i = 1; i < argc; ++i) {
+    TFLITE_LOG(WARN) << "WARNING: unrecognized commandline flag: " << argv[i];
+  }
+  return Run();
+}
+
+TfLiteStatus BenchmarkLoadGenerator::Run() {
+  LogParams();
+
+  const BenchmarkParams& model_params = *model_prototype_->mutable_params();
+  const bool has_graph = model_params.HasParam("graph");
+  std::vector<std::string> graphs;
+  const auto& graphs_list = params_.Get<std::string>("load_graphs");
+  if (!graphs_list.empty()) {
+    if (!has_graph || !util::SplitAndParse(graphs_list, ',', &graphs)) {
+      TFLITE_LOG(ERROR) << "Cannot parse --load_graphs: '" << graphs_list
+                        << "'. Please double-check its value.";
+      return kTfLiteError;
+    }
+  } else {
+    graphs.push_back(has_graph ? model_params.Get<std::string>("graph") : "");
+  }
+
+  const int32_t instances_per_model =
+      params_.Get<int32_t>("load_instances_per_model");
+  if (instances_per_model < 1) {
+    TFLITE_LOG(ERROR) << "--load_instances_per_model must be positive.";
+    return kTfLiteError;
+  }
+  const int32_t warmup_runs = model_params.Get<int32_t>("warmup_runs");
+
+  results_.clear();
+  results_.resize(graphs.size());
+  std::vector<std::unique_ptr<ModelState>> states;
+  for (size_t m = 0; m < graphs.size(); ++m) {
+    std::unique_ptr<ModelState> state(new ModelState);
+    const int64_t memory_before_kb = util::GetPeakMemoryKB();
+    for (int32_t i = 0; i < instances_per_model; ++i) {
+      std::unique_ptr<BenchmarkModel> instance = model_factory_();
+      instance->mutable_params()->Set(model_params);
+      if (has_graph) {
+        instance->mutable_params()->Set<std::string>("graph", graphs[m]);
+      }
+      TF_LITE_ENSURE_STATUS(instance->PrepareForSingleRuns());
+      for (int32_t run = 0; run < warmup_runs; ++run) {
+        TF_LITE_ENSURE_STATUS(instance->RunSingle());
+      }
+      state->instances.push_back(std::move(instance));
+    }
+    const int64_t memory_after_kb = util::GetPeakMemoryKB();
+    results_[m].graph = graphs[m];
+    if (memory_before_kb >= 0) {
+      results_[m].init_memory_kb = memory_after_kb - memory_before_kb;
+    }
+    states.push_back(std::move(state));
+  }
+
+  const float arrival_rate = params_.Get<float>("load_arrival_rate");
+  const float run_delay = model_params.Get<float>("run_delay");
+  std::vector<std::vector<InstanceStats>> stats(
+      graphs.size(), std::vector<InstanceStats>(instances_per_model));
+  const int64_t start_us = profiling::time::NowMicros();
+  const int64_t end_us =
+      start_us +
+      static_cast<int64_t>(params_.Get<float>("load_duration_secs") * 1e6);
+  std::vector<std::thread> threads;
+  for (size_t m = 0; m < graphs.size(); ++m) {
+    ModelState* state = states[m].get();
+    for (int32_t i = 0; i < instances_per_model; ++i) {
+      BenchmarkModel* instance = state->instances[i].get();
+      InstanceStats* instance_stats = &stats[m][i];
+      if (arrival_rate > 0.0f) {
+        threads.emplace_back(RunOpenLoop, instance, state, instance_stats);
+      } else {
+        threads.emplace_back(RunClosedLoop, instance, run_delay, end_us,
+                             instance_stats);
+      }
+    }
+    if (arrival_rate > 0.0f) {
+      threads.emplace_back(GenerateArrivals, arrival_rate, static_cast<int>(m),
+                           start_us, end_us, state);
+    }
+  }
+  for (auto& thread : threads) thread.join();
+  const double duration_secs =
+      (profiling::time::NowMicros() - start_us) / 1e6;
+
+  TfLiteStatus status = kTfLiteOk;
+  for (size_t m = 0; m < graphs.size(); ++m) {
+    ModelLoadResults* results = &results_[m];
+    std::vector<int64_t> latencies_us;
+    for (const InstanceStats& instance_stats : stats[m]) {
+      latencies_us.insert(latencies_us.end(),
+                          instance_stats.latencies_us.begin(),
+                          instance_stats.latencies_us.end());
+      results->num_failed_runs += instance_stats.num_failed_runs;
+    }
+    if (results->num_failed_runs > 0) status = kTfLiteError;
+    results->num_runs = latencies_us.size();
+    results->num_dropped_requests = states[m]->num_dropped_requests;
+    results->duration_secs = duration_secs;
+    if (latencies_us.empty()) continue;
+    std::sort(latencies_us.begin(), latencies_us.end());
+    for (const int64_t latency_us : latencies_us) {
+      results->latency_us.UpdateStat(latency_us);
+    }
+    results->p50_latency_us = Percentile(latencies_us, 0.5);
+    results->p90_latency_us = Percentile(latencies_us, 0.9);
+    results->p99_latency_us = Percentile(latencies_us, 0.99);
+  }
+
+  OutputResults();
+  return status;
+}
+
+void BenchmarkLoadGenerator::OutputResults() {
+  TFLITE_LOG(INFO) << "\n==============Summary of Load Generation"
+                      "==============";
+  for (const auto& results : results_) {
+    std::stringstream stream;
+    stream << results.graph << ": " << results.num_runs << " runs ("
+           << results.num_failed_runs << " failed) in "
+           << results.duration_secs << " s, throughput "
+           << results.throughput_runs_per_second() << " runs/s";
+    if (params_.Get<float>("load_arrival_rate") > 0.0f) {
+      stream << ", " << results.num_dropped_requests << " requests dropped";
+    }
+    TFLITE_LOG(INFO) << stream.str();
+    if (!results.latency_us.empty()) {
+      TFLITE_LOG(INFO) << "  Latency (us): avg=" << results.latency_us.avg()
+                       << " p50=" << results.p50_latency_us
+                       << " p90=" << results.p90_latency_us
+                       << " p99=" << results.p99_latency_us
+                       << " max=" << results.latency_us.max();
+    }
+    TFLITE_LOG(INFO) << "  Peak memory growth during init (KB): "
+                     << results.init_memory_kb;
+  }
+  TFLITE_LOG(INFO) << "Peak memory (KB): " << util::GetPeakMemoryKB();
+}
+
+}  // namespace benchmark
+}  // namespace tflite
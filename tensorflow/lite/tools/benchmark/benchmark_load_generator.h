@@ -0,0 +1,107 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_LOAD_GENERATOR_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_LOAD_GENERATOR_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/util/stats_calculator.h"
+#include "tensorflow/lite/c/c_api_internal.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_model.h"
+
+namespace tflite {
+namespace benchmark {
+
+// The results of one model under load.
+struct ModelLoadResults {
+  std::string graph;
+  // The number of runs completed before the load ended.
+  int64_t num_runs = 0;
+  int64_t num_failed_runs = 0;
+  // In the open loop, the number of requests that were still queued when the
+  // load ended.
+  int64_t num_dropped_requests = 0;
+  double duration_secs = 0.0;
+  // The latencies of the completed runs. In the open loop, a latency includes
+  // the time the request was queued.
+  tensorflow::Stat<int64_t> latency_us;
+  int64_t p50_latency_us = 0;
+  int64_t p90_latency_us = 0;
+  int64_t p99_latency_us = 0;
+  // The growth of the peak resident memory while initializing the instances
+  // of this model, or -1 if unknown.
+  int64_t init_memory_kb = -1;
+
+  double throughput_runs_per_second() const {
+    return duration_secs > 0.0 ? num_runs / duration_secs : 0.0;
+  }
+};
+
+// Generates concurrent load on one or more models, each run by several
+// instances (i.e. interpreters) on their own threads, and reports throughput
+// and latency percentiles per model.
+//
+// In the closed loop (--load_arrival_rate <= 0), each instance starts its next
+// run as soon as the previous one ends (after --run_delay). In the open loop,
+// requests for a model arrive as a Poisson process of the given rate and are
+// served by the first free instance of the model.
+class BenchmarkLoadGenerator {
+ public:
+  // Creates a model with default params. The params of every instance are then
+  // set from the flags of the model.
+  using ModelFactory = std::function<std::unique_ptr<BenchmarkModel>()>;
+
+  explicit BenchmarkLoadGenerator(ModelFactory model_factory);
+  BenchmarkLoadGenerator(BenchmarkParams params, ModelFactory model_factory);
+
+  virtual ~BenchmarkLoadGenerator() {}
+
+  // Parses the flags of the models and of the load generator, then runs.
+  TfLiteStatus Run(int argc, char** argv);
+  TfLiteStatus Run();
+
+  BenchmarkParams* mutable_params() { return &params_; }
+  BenchmarkParams* mutable_model_params() {
+    return model_prototype_->mutable_params();
+  }
+
+  const std::vector<ModelLoadResults>& results() const { return results_; }
+
+ protected:
+  static BenchmarkParams DefaultParams();
+
+  // Unparsable flags will remain in 'argv' in the original order and 'argc'
+  // will be updated accordingly.
+  bool ParseFlags(int* argc, char** argv);
+  virtual std::vector<Flag> GetFlags();
+  void LogParams();
+
+  virtual void OutputResults();
+
+  BenchmarkParams params_;
+  const ModelFactory model_factory_;
+  // Holds the params shared by all model instances.
+  std::unique_ptr<BenchmarkModel> model_prototype_;
+  std::vector<ModelLoadResults> results_;
+};
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_LOAD_GENERATOR_H_
@@ -149,6 +149,17 @@ Stat<int64_t> BenchmarkModel::Run(int min_num_times, float min_secs,
 
 TfLiteStatus BenchmarkModel::ValidateParams() { return kTfLiteOk; }
 
+TfLiteStatus BenchmarkModel::PrepareForSingleRuns() {
+  TF_LITE_ENSURE_STATUS(ValidateParams());
+  TF_LITE_ENSURE_STATUS(Init());
+  return PrepareInputData();
+}
+
+TfLiteStatus BenchmarkModel::RunSingle() {
+  ResetInputsAndOutputs();
+  return RunImpl();
+}
+
 TfLiteStatus BenchmarkModel::Run(int argc, char** argv) {
   TF_LITE_ENSURE_STATUS(ParseFlags(argc, argv));
   return Run();
@@ -154,6 +154,14 @@ class BenchmarkModel {
 
   BenchmarkParams* mutable_params() { return &params_; }
 
+  // Validates the params, initializes the model and prepares its input data,
+  // so that the caller can drive single runs with RunSingle(). Used by drivers
+  // that schedule the runs themselves, e.g. a load generator.
+  TfLiteStatus PrepareForSingleRuns();
+  // Performs a single run with freshly reset inputs and outputs. Listeners are
+  // not notified.
+  TfLiteStatus RunSingle();
+
   // Unparsable flags will remain in 'argv' in the original order and 'argc'
   // will be updated accordingly.
   TfLiteStatus ParseFlags(int* argc, char** argv);
@@ -21,6 +21,7 @@ limitations under the License.
 #include "absl/algorithm/algorithm.h"
 #include "tensorflow/lite/interpreter.h"
 #include "tensorflow/lite/testing/util.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_load_generator.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_tflite_model.h"
 #include "tensorflow/lite/tools/command_line_flags.h"
 
@@ -184,6 +185,54 @@ TEST(BenchmarkTest, ParametersArePopulatedWhenInputShapeIsNotSpecified) {
                            input_tensor->data.raw + input_tensor->bytes));
 }
 
+BenchmarkLoadGenerator::ModelFactory CreateFp32ModelFactory() {
+  return [] {
+    return std::unique_ptr<BenchmarkModel>(
+        new BenchmarkTfLiteModel(CreateFp32Params()));
+  };
+}
+
+TEST(BenchmarkLoadGeneratorTest, ClosedLoopRunsAllModelsConcurrently) {
+  ASSERT_THAT(g_fp32_model_path, testing::NotNull());
+  ASSERT_THAT(g_int8_model_path, testing::NotNull());
+
+  BenchmarkLoadGenerator load_generator(CreateFp32ModelFactory());
+  load_generator.mutable_params()->Set<std::string>(
+      "load_graphs", *g_fp32_model_path + "," + *g_int8_model_path);
+  load_generator.mutable_params()->Set<int32_t>("load_instances_per_model", 2);
+  load_generator.mutable_params()->Set<float>("load_duration_secs", 0.5f);
+  EXPECT_EQ(load_generator.Run(), kTfLiteOk);
+
+  const auto& results = load_generator.results();
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_EQ(results[0].graph, *g_fp32_model_path);
+  EXPECT_EQ(results[1].graph, *g_int8_model_path);
+  for (const auto& model_results : results) {
+    EXPECT_GE(model_results.num_runs, 2);
+    EXPECT_EQ(model_results.num_failed_runs, 0);
+    EXPECT_EQ(model_results.num_dropped_requests, 0);
+    EXPECT_GT(model_results.throughput_runs_per_second(), 0.0);
+    EXPECT_LE(model_results.p50_latency_us, model_results.p90_latency_us);
+    EXPECT_LE(model_results.p90_latency_us, model_results.p99_latency_us);
+    EXPECT_LE(model_results.p99_latency_us, model_results.latency_us.max());
+  }
+}
+
+TEST(BenchmarkLoadGeneratorTest, OpenLoopServesArrivingRequests) {
+  ASSERT_THAT(g_fp32_model_path, testing::NotNull());
+
+  BenchmarkLoadGenerator load_generator(CreateFp32ModelFactory());
+  load_generator.mutable_params()->Set<float>("load_arrival_rate", 100.0f);
+  load_generator.mutable_params()->Set<float>("load_duration_secs", 0.5f);
+  EXPECT_EQ(load_generator.Run(), kTfLiteOk);
+
+  const auto& results = load_generator.results();
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_EQ(results[0].graph, *g_fp32_model_path);
+  EXPECT_GE(results[0].num_runs, 1);
+  EXPECT_EQ(results[0].num_failed_runs, 0);
+}
+
 }  // namespace
 }  // namespace benchmark
 }  // namespace tflite
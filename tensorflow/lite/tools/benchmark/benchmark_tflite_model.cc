@@ -18,8 +18,10 @@ limitations under the License.
 #include <cstdarg>
 #include <cstdint>
 #include <cstdlib>
+#include <iomanip>
 #include <iostream>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -36,7 +38,9 @@ limitations under the License.
 #include "tensorflow/lite/model.h"
 #include "tensorflow/lite/op_resolver.h"
 #include "tensorflow/lite/profiling/buffered_profiler.h"
+#include "tensorflow/lite/profiling/hardware_counter_profiler.h"
 #include "tensorflow/lite/profiling/profile_summarizer.h"
+#include "tensorflow/lite/schema/schema_generated.h"
 #include "tensorflow/lite/string_util.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
 #include "tensorflow/lite/tools/benchmark/logging.h"
@@ -80,12 +84,51 @@ class ProfilingListener : public BenchmarkListener {
 
   void OnBenchmarkEnd(const BenchmarkResults& results) override;
 
+  profiling::BufferedProfiler* profiler() { return &profiler_; }
+
  private:
   Interpreter* interpreter_;
   profiling::BufferedProfiler profiler_;
   profiling::ProfileSummarizer summarizer_;
 };
 
+// Dumps per-operator hardware counters and the derived efficiency numbers if
+// hardware counter profiling is enabled. Events are forwarded to `next`, if
+// not null, so that this can be combined with the ProfilingListener.
+class HardwareCounterProfilingListener : public BenchmarkListener {
+ public:
+  HardwareCounterProfilingListener(Interpreter* interpreter,
+                                   tflite::Profiler* next,
+                                   float peak_memory_bandwidth_gbps)
+      : interpreter_(interpreter),
+        profiler_(next),
+        peak_memory_bandwidth_gbps_(peak_memory_bandwidth_gbps) {
+    TFLITE_BENCHMARK_CHECK(interpreter);
+    interpreter_->SetProfiler(&profiler_);
+    if (!profiler_.HasHardwareCounters()) {
+      TFLITE_LOG(WARN) << "Hardware counters are not available, only op "
+                          "timings will be reported.";
+    }
+  }
+
+  void OnSingleRunStart(RunType run_type) override;
+
+  void OnSingleRunEnd() override;
+
+  void OnBenchmarkEnd(const BenchmarkResults& results) override;
+
+ private:
+  // Size of the cache lines transferred on a last level cache miss.
+  static constexpr int kCacheLineBytes = 64;
+
+  std::string GetOperatorName(uint32_t subgraph_index, uint32_t node_index);
+  int64_t GetOperatorTensorBytes(uint32_t subgraph_index, uint32_t node_index);
+
+  Interpreter* interpreter_;
+  profiling::HardwareCounterProfiler profiler_;
+  const float peak_memory_bandwidth_gbps_;
+};
+
 // Dumps gemmlowp profiling events if gemmlowp profiling is enabled.
 class GemmlowpProfilingListener : public BenchmarkListener {
  public:
@@ -113,6 +156,108 @@ void ProfilingListener::OnSingleRunEnd() {
   summarizer_.ProcessProfiles(profile_events, *interpreter_);
 }
 
+void HardwareCounterProfilingListener::OnSingleRunStart(RunType run_type) {
+  if (run_type == REGULAR) {
+    profiler_.StartProfiling();
+  }
+}
+
+void HardwareCounterProfilingListener::OnSingleRunEnd() {
+  profiler_.StopProfiling();
+}
+
+std::string HardwareCounterProfilingListener::GetOperatorName(
+    uint32_t subgraph_index, uint32_t node_index) {
+  const auto* node_reg =
+      interpreter_->subgraph(subgraph_index)->node_and_registration(node_index);
+  if (node_reg->second.builtin_code == BuiltinOperator_CUSTOM) {
+    const char* custom_name = node_reg->second.custom_name;
+    return custom_name ? custom_name : "UnknownCustomOp";
+  }
+  return EnumNamesBuiltinOperator()[node_reg->second.builtin_code];
+}
+
+int64_t HardwareCounterProfilingListener::GetOperatorTensorBytes(
+    uint32_t subgraph_index, uint32_t node_index) {
+  Subgraph* subgraph = interpreter_->subgraph(subgraph_index);
+  const TfLiteNode& node = subgraph->node_and_registration(node_index)->first;
+  int64_t bytes = 0;
+  for (const TfLiteIntArray* tensors : {node.inputs, node.outputs}) {
+    for (int i = 0; i < tensors->size; ++i) {
+      if (tensors->data[i] == kOptionalTensor) continue;
+      bytes += subgraph->tensor(tensors->data[i])->bytes;
+    }
+  }
+  return bytes;
+}
+
+void HardwareCounterProfilingListener::OnBenchmarkEnd(
+    const BenchmarkResults& results) {
+  const auto operator_counters = profiler_.GetOperatorCounters();
+  if (operator_counters.empty()) return;
+
+  // All counts are averages per invocation. Bytes moved to and from memory
+  // are estimated from the last level cache misses; together with the elapsed
+  // time and instructions they place each op on a roofline: a low IPC with
+  // high bandwidth means it is memory bound, a high IPC with low bandwidth
+  // means it is compute bound.
+  std::stringstream stream;
+  stream << "============================== Hardware Counters "
+            "==============================\n";
+  stream << "\t" << std::setw(24) << "[node type]"
+         << "\t" << std::setw(8) << "[node]"
+         << "\t" << std::setw(10) << "[avg us]"
+         << "\t" << std::setw(12) << "[cycles]"
+         << "\t" << std::setw(12) << "[instrs]"
+         << "\t" << std::setw(6) << "[IPC]"
+         << "\t" << std::setw(10) << "[LLC miss]"
+         << "\t" << std::setw(8) << "[miss %]"
+         << "\t" << std::setw(12) << "[tensor KB]"
+         << "\t" << std::setw(12) << "[memory KB]"
+         << "\t" << std::setw(8) << "[GB/s]"
+         << "\t" << std::setw(12) << "[instrs/B]";
+  if (peak_memory_bandwidth_gbps_ > 0) {
+    stream << "\t" << std::setw(10) << "[% peak BW]";
+  }
+  stream << "\n";
+  stream << std::fixed;
+  for (const auto& op : operator_counters) {
+    const double invocations = static_cast<double>(op.invocations);
+    const double avg_us = op.elapsed_us / invocations;
+    const double cycles = op.counters.cycles / invocations;
+    const double instructions = op.counters.instructions / invocations;
+    const double cache_misses = op.counters.cache_misses / invocations;
+    const double memory_bytes = cache_misses * kCacheLineBytes;
+    const double bandwidth_gbps =
+        avg_us > 0 ? memory_bytes / (avg_us * 1e3) : 0.0;
+    stream << "\t" << std::setw(24)
+           << GetOperatorName(op.subgraph_index, op.node_index) << "\t"
+           << std::setw(8) << op.node_index << "\t" << std::setw(10)
+           << std::setprecision(1) << avg_us << "\t" << std::setw(12)
+           << std::setprecision(0) << cycles << "\t" << std::setw(12)
+           << instructions << "\t" << std::setw(6) << std::setprecision(2)
+           << (cycles > 0 ? instructions / cycles : 0.0) << "\t"
+           << std::setw(10) << std::setprecision(0) << cache_misses << "\t"
+           << std::setw(8) << std::setprecision(1)
+           << (op.counters.cache_references > 0
+                   ? 100.0 * op.counters.cache_misses /
+                         op.counters.cache_references
+                   : 0.0)
+           << "\t" << std::setw(12)
+           << GetOperatorTensorBytes(op.subgraph_index, op.node_index) / 1024.0
+           << "\t" << std::setw(12) << memory_bytes / 1024.0 << "\t"
+           << std::setw(8) << std::setprecision(2) << bandwidth_gbps << "\t"
+           << std::setw(12) << std::setprecision(1)
+           << (memory_bytes > 0 ? instructions / memory_bytes : 0.0);
+    if (peak_memory_bandwidth_gbps_ > 0) {
+      stream << "\t" << std::setw(10)
+             << 100.0 * bandwidth_gbps / peak_memory_bandwidth_gbps_;
+    }
+    stream << "\n";
+  }
+  TFLITE_LOG(INFO) << stream.str();
+}
+
 void GemmlowpProfilingListener::OnBenchmarkStart(
     const BenchmarkParams& params) {
 #ifdef GEMMLOWP_PROFILING
@@ -267,6 +412,10 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
       BenchmarkParam::Create<bool>(kOpProfilingEnabledDefault));
   default_params.AddParam("max_profiling_buffer_entries",
                           BenchmarkParam::Create<int32_t>(1024));
+  default_params.AddParam("enable_op_hardware_counters",
+                          BenchmarkParam::Create<bool>(false));
+  default_params.AddParam("peak_memory_bandwidth_gbps",
+                          BenchmarkParam::Create<float>(0.0f));
   return default_params;
 }
 
@@ -315,7 +464,12 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
                      "require delegate to run the entire graph"),
     CreateFlag<bool>("enable_op_profiling", &params_, "enable op profiling"),
     CreateFlag<int32_t>("max_profiling_buffer_entries", &params_,
-                        "max profiling buffer entries")
+                        "max profiling buffer entries"),
+    CreateFlag<bool>("enable_op_hardware_counters", &params_,
+                     "collect cycles, instructions and cache misses per op"),
+    CreateFlag<float>("peak_memory_bandwidth_gbps", &params_,
+                      "peak memory bandwidth of the device in GB/s, used to "
+                      "report the bandwidth efficiency of each op")
   };
 
   flags.insert(flags.end(), specific_flags.begin(), specific_flags.end());
@@ -367,6 +521,10 @@ void BenchmarkTfLiteModel::LogParams() {
   TFLITE_LOG(INFO) << "Max profiling buffer entries: ["
                    << params_.Get<int32_t>("max_profiling_buffer_entries")
                    << "]";
+  TFLITE_LOG(INFO) << "Enable op hardware counters: ["
+                   << params_.Get<bool>("enable_op_hardware_counters") << "]";
+  TFLITE_LOG(INFO) << "Peak memory bandwidth (GB/s): ["
+                   << params_.Get<float>("peak_memory_bandwidth_gbps") << "]";
 }
 
 TfLiteStatus BenchmarkTfLiteModel::ValidateParams() {
@@ -605,12 +763,24 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
   }
 
   // Install profilers if necessary.
+  tflite::Profiler* op_profiler = nullptr;
   if (params_.Get<bool>("enable_op_profiling")) {
-    profiling_listener_.reset(new ProfilingListener(
+    auto* profiling_listener = new ProfilingListener(
         interpreter_.get(),
-        params_.Get<int32_t>("max_profiling_buffer_entries")));
+        params_.Get<int32_t>("max_profiling_buffer_entries"));
+    op_profiler = profiling_listener->profiler();
+    profiling_listener_.reset(profiling_listener);
     AddListener(profiling_listener_.get());
   }
+  if (params_.Get<bool>("enable_op_hardware_counters")) {
+    // Wraps the op profiler, if any, which is installed on the interpreter
+    // above.
+    hardware_counter_profiling_listener_.reset(
+        new HardwareCounterProfilingListener(
+            interpreter_.get(), op_profiler,
+            params_.Get<float>("peak_memory_bandwidth_gbps")));
+    AddListener(hardware_counter_profiling_listener_.get());
+  }
 #ifdef GEMMLOWP_PROFILING
   gemmlowp_profiling_listener_.reset(new GemmlowpProfilingListener());
   AddListener(gemmlowp_profiling_listener_.get());
@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
 
+#if defined(__linux__) || defined(__ANDROID__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
 #include "tensorflow/lite/profiling/time.h"
 
 namespace tflite {
@@ -32,6 +36,23 @@ void SleepForSeconds(double sleep_seconds) {
       static_cast<uint64_t>(sleep_seconds * 1e6));
 }
 
+int64_t GetPeakMemoryKB() {
+#if defined(__linux__) || defined(__ANDROID__) || defined(__APPLE__)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return -1;
+  }
+#if defined(__APPLE__)
+  // macOS reports the size in bytes.
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+#else
+  return -1;
+#endif
+}
+
 }  // namespace util
 }  // namespace benchmark
 }  // namespace tflite
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_UTILS_H_
 #define TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_UTILS_H_
 
+#include <cstdint>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -28,6 +29,10 @@ namespace util {
 // simply return if 'sleep_seconds' is negative.
 void SleepForSeconds(double sleep_seconds);
 
+// Returns the peak resident set size of this process in kilobytes, or -1 if it
+// is not available on this platform.
+int64_t GetPeakMemoryKB();
+
 // Split the 'str' according to 'delim', and store each splitted element into
 // 'values'.
 template <typename T>
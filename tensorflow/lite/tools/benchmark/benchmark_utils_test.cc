@@ -46,6 +46,14 @@ TEST(BenchmarkHelpersTest, SleepForSomeSeconds) {
   EXPECT_GT(end_ts - start_ts, 1900000);
 }
 
+TEST(BenchmarkHelpersTest, GetPeakMemoryKB) {
+#if defined(__linux__) || defined(__ANDROID__) || defined(__APPLE__)
+  EXPECT_GT(util::GetPeakMemoryKB(), 0);
+#else
+  EXPECT_EQ(util::GetPeakMemoryKB(), -1);
+#endif
+}
+
 TEST(BenchmarkHelpersTest, SplitAndParseFailed) {
   std::vector<int> results;
   const bool splitted = util::SplitAndParse("hello;world", ';', &results);
@@ -235,7 +235,8 @@ class TfTrtIntegrationTestBase(test_util.TensorFlowTestCase):
         is_dynamic_op=run_params.dynamic_engine,
         maximum_cached_engines=1,
         use_calibration=run_params.use_calibration,
-        max_batch_size=min(batch_list))
+        max_batch_size=min(batch_list),
+        profile_batch_sizes=None)
     return conversion_params
 
   def ShouldRunTest(self, run_params):
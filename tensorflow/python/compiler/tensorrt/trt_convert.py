@@ -151,6 +151,16 @@ TrtConversionParams = collections.namedtuple(
         # Max size for the input batch.
         # This option is deprecated in TF 2.0.
         "max_batch_size",
+
+        # List of batch sizes that dynamic TRT ops build engines for, or None.
+        # When none of the cached engines can serve the input, the TRTEngineOp
+        # builds an engine for the smallest of these batch sizes that is at
+        # least the input batch size, and that engine then serves every batch
+        # size up to it. This avoids building an engine per distinct batch
+        # size when the batch size varies. If None, or if the input batch size
+        # is larger than all of them, engines are built for the input batch
+        # size.
+        "profile_batch_sizes",
     ])
 
 DEFAULT_TRT_CONVERSION_PARAMS = TrtConversionParams(
@@ -161,7 +171,8 @@ DEFAULT_TRT_CONVERSION_PARAMS = TrtConversionParams(
     is_dynamic_op=True,
     maximum_cached_engines=1,
     use_calibration=True,
-    max_batch_size=1)
+    max_batch_size=1,
+    profile_batch_sizes=None)
 
 _TRT_ENGINE_OP_NAME = "TRTEngineOp"
 
@@ -182,6 +193,12 @@ def _check_conversion_params(conversion_params):
         ("precision mode '{}' is not supported."
          "It should be one of {}").format(conversion_params.precision_mode,
                                           supported_precision_modes))
+  if conversion_params.profile_batch_sizes:
+    for batch_size in conversion_params.profile_batch_sizes:
+      if batch_size <= 0:
+        raise ValueError(
+            "profile_batch_sizes must be positive, got {}".format(
+                conversion_params.profile_batch_sizes))
 
 
 def _check_trt_version_compatibility():
@@ -272,6 +289,9 @@ def get_tensorrt_rewriter_config(conversion_params, is_v2=False):
       "maximum_cached_engines"].i = conversion_params.maximum_cached_engines
   optimizer.parameter_map[
       "use_calibration"].b = conversion_params.use_calibration
+  if conversion_params.profile_batch_sizes:
+    optimizer.parameter_map["profile_batch_sizes"].list.i.extend(
+        conversion_params.profile_batch_sizes)
   if is_v2:
     # Static mode (building TRT engine without executing the op) is deprecated
     # in TF 2.0. See TrtGraphConverterV2 for more details.
@@ -344,7 +364,8 @@ class TrtGraphConverter(object):
                minimum_segment_size=3,
                is_dynamic_op=False,
                maximum_cached_engines=1,
-               use_calibration=True):
+               use_calibration=True,
+               profile_batch_sizes=None):
     """Initialize the converter.
 
     Args:
@@ -383,6 +404,9 @@ class TrtGraphConverter(object):
         will occur. Please note that accuracy may be negatively affected if
         there is a mismatch between which tensors TRT quantizes and which
         tensors were trained with fake quantization.
+      profile_batch_sizes: list of batch sizes that dynamic TRT ops build
+        engines for. An engine built for one of them serves every smaller batch
+        size, so one engine covers a range of batch sizes.
 
     Raises:
       ValueError: if the combination of the parameters is invalid.
@@ -440,7 +464,8 @@ class TrtGraphConverter(object):
         is_dynamic_op=is_dynamic_op,
         maximum_cached_engines=maximum_cached_engines,
         use_calibration=use_calibration,
-        max_batch_size=max_batch_size)
+        max_batch_size=max_batch_size,
+        profile_batch_sizes=profile_batch_sizes)
     _check_conversion_params(self._conversion_params)
 
   def _run_conversion(self):
@@ -83,7 +83,8 @@ class TrtConvertTest(test_util.TensorFlowTestCase, parameterized.TestCase):
         precision_mode="INT8",
         minimum_segment_size=10,
         is_dynamic_op=True,
-        maximum_cached_engines=2)
+        maximum_cached_engines=2,
+        profile_batch_sizes=[32, 128])
     rewriter_cfg = trt_convert.get_tensorrt_rewriter_config(
         conversion_params=conversion_params)
     self.assertEqual(["constfold", "layout", "constfold"],
@@ -110,6 +111,8 @@ class TrtConvertTest(test_util.TensorFlowTestCase, parameterized.TestCase):
         trt_convert._to_bytes("INT8"),
         trt_optimizer.parameter_map["precision_mode"].s)
     self.assertEqual(2, trt_optimizer.parameter_map["maximum_cached_engines"].i)
+    self.assertEqual([32, 128],
+                     trt_optimizer.parameter_map["profile_batch_sizes"].list.i)
 
   def _GetConfigProto(self, rewriter_config=None):
     """Get ConfigProto for session creation."""
@@ -0,0 +1,116 @@
+# Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the `BucketByTokenBudgetDataset` op."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from absl.testing import parameterized
+import numpy as np
+
+from tensorflow.python.data.experimental.ops import grouping
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import errors
+from tensorflow.python.framework import test_util
+from tensorflow.python.ops import array_ops
+from tensorflow.python.platform import test
+
+
+@test_util.run_all_in_graph_and_eager_modes
+class BucketByTokenBudgetTest(test_base.DatasetTestBase,
+                              parameterized.TestCase):
+
+  def _build_ds(self, lengths, bucket_boundaries, token_budget, **kwargs):
+    # Each element is a sequence of its index, of the given length.
+    lengths = np.array(lengths, dtype=np.int64)
+    dataset = dataset_ops.Dataset.from_tensor_slices(lengths).enumerate().map(
+        lambda i, length: (array_ops.fill([length], i), length))
+    return grouping._BucketByTokenBudgetDataset(  # pylint: disable=protected-access
+        dataset,
+        lambda sequence, length: length,
+        bucket_boundaries=bucket_boundaries,
+        token_budget=token_budget,
+        **kwargs)
+
+  def _gen_batches(self, ds):
+    get_next = self.getNext(ds)
+    batches = []
+    while True:
+      try:
+        batches.append(self.evaluate(get_next()))
+      except errors.OutOfRangeError:
+        break
+    return batches
+
+  def testBatchesFillTheBudget(self):
+    ds = self._build_ds([2, 2, 2, 2, 2], [10], 8)
+    batches = self._gen_batches(ds)
+    self.assertLen(batches, 2)
+    self.assertAllEqual(batches[0][0], [[0, 0], [1, 1], [2, 2], [3, 3]])
+    self.assertAllEqual(batches[1][0], [[4, 4]])
+
+  def testPadsToLongestElementOfBatch(self):
+    ds = self._build_ds(
+        [1, 3, 2], [10], 100, padding_values=(np.int64(-1), np.int64(0)))
+    batches = self._gen_batches(ds)
+    self.assertLen(batches, 1)
+    self.assertAllEqual(batches[0][0], [[0, -1, -1], [1, 1, 1], [2, 2, -1]])
+    self.assertAllEqual(batches[0][1], [1, 3, 2])
+
+  def testElementLongerThanBudget(self):
+    ds = self._build_ds([1, 20, 1], [10], 8)
+    batches = self._gen_batches(ds)
+    self.assertAllEqual(batches[0][1], [20])
+    self.assertAllEqual(batches[1][1], [1, 1])
+
+  @parameterized.named_parameters(
+      ("Unbounded", None, False),
+      ("Bounded", 5, False),
+      ("SingleElement", 1, False),
+      ("ParallelCopy", None, True),
+  )
+  def testBatchesRespectBucketsAndBudget(self, max_buffered_elements,
+                                         parallel_copy):
+    bucket_boundaries = [4, 8, 16]
+    token_budget = 32
+    lengths = np.random.RandomState(42).randint(1, 24, size=200)
+    ds = self._build_ds(
+        lengths,
+        bucket_boundaries,
+        token_budget,
+        max_buffered_elements=max_buffered_elements,
+        parallel_copy=parallel_copy)
+    indices = []
+    for sequences, batch_lengths in self._gen_batches(ds):
+      buckets = np.searchsorted(bucket_boundaries, batch_lengths, side="right")
+      self.assertLen(set(buckets), 1)
+      self.assertEqual(sequences.shape[1], max(batch_lengths))
+      if len(batch_lengths) > 1:
+        self.assertLessEqual(sequences.size, token_budget)
+      for sequence, length in zip(sequences, batch_lengths):
+        indices.append(sequence[0])
+        self.assertAllEqual(sequence[:length], [sequence[0]] * length)
+        self.assertAllEqual(sequence[length:], [0] * (len(sequence) - length))
+    self.assertCountEqual(indices, range(len(lengths)))
+
+  def testInvalidTokenBudget(self):
+    with self.assertRaisesRegexp(errors.InvalidArgumentError,
+                                 "token_budget must be greater than zero"):
+      self.evaluate(self._build_ds([1], [10], 0)._variant_tensor)  # pylint: disable=protected-access
+
+
+if __name__ == "__main__":
+  test.main()
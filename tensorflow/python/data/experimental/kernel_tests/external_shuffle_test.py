@@ -0,0 +1,91 @@
+# Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the `ExternalShuffleDataset` op."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+
+from absl.testing import parameterized
+
+from tensorflow.python.data.experimental.ops import shuffle_ops
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import errors
+from tensorflow.python.framework import test_util
+from tensorflow.python.platform import test
+
+
+@test_util.run_all_in_graph_and_eager_modes
+class ExternalShuffleTest(test_base.DatasetTestBase, parameterized.TestCase):
+
+  def setUp(self):
+    super(ExternalShuffleTest, self).setUp()
+    self._spill_directory = os.path.join(self.get_temp_dir(), "spill")
+
+  def _build_ds(self, num_elements, buffer_size, memory_buffer_size, seed=10):
+    return shuffle_ops._ExternalShuffleDataset(  # pylint: disable=protected-access
+        dataset_ops.Dataset.range(num_elements).map(lambda x: (x, [x, 2 * x])),
+        buffer_size=buffer_size,
+        memory_buffer_size=memory_buffer_size,
+        spill_directory=self._spill_directory,
+        seed=seed)
+
+  def _gen_outputs(self, ds):
+    get_next = self.getNext(ds)
+    outputs = []
+    while True:
+      try:
+        x, y = self.evaluate(get_next())
+      except errors.OutOfRangeError:
+        break
+      self.assertAllEqual(y, [x, 2 * x])
+      outputs.append(x)
+    return outputs
+
+  @parameterized.named_parameters(
+      ("InMemory", 100, 100, 100),
+      ("Spilled", 100, 100, 7),
+      ("PartialBuffer", 100, 30, 4),
+      ("SingleElementInMemory", 50, 50, 1),
+  )
+  def testCorrectOutput(self, num_elements, buffer_size, memory_buffer_size):
+    outputs = self._gen_outputs(
+        self._build_ds(num_elements, buffer_size, memory_buffer_size))
+    self.assertCountEqual(outputs, range(num_elements))
+    self.assertNotEqual(outputs, list(range(num_elements)))
+    # All spill files are deleted once they have been read back.
+    self.assertEmpty(os.listdir(self._spill_directory))
+
+  def testSameOrderForSameSeeds(self):
+    output1 = self._gen_outputs(self._build_ds(100, 100, 10))
+    output2 = self._gen_outputs(self._build_ds(100, 100, 10))
+    self.assertEqual(output1, output2)
+
+  def testDifferentOrderForDifferentSeeds(self):
+    output1 = self._gen_outputs(self._build_ds(100, 100, 10, seed=10))
+    output2 = self._gen_outputs(self._build_ds(100, 100, 10, seed=20))
+    self.assertNotEqual(output1, output2)
+    self.assertCountEqual(output1, output2)
+
+  def testInvalidMemoryBufferSize(self):
+    with self.assertRaisesRegexp(errors.InvalidArgumentError,
+                                 "memory_buffer_size must be greater than"):
+      self.evaluate(self._build_ds(10, 10, 0)._variant_tensor)  # pylint: disable=protected-access
+
+
+if __name__ == "__main__":
+  test.main()
@@ -114,6 +114,42 @@ class ChooseFastestBranchDatasetTest(test_base.DatasetTestBase,
 
     self.assertDatasetProduces(choose_fastest, expected_output=list(range(100)))
 
+  def testWithReevaluation(self):
+    """Should maintain ordering when switching branches periodically."""
+    dataset = dataset_ops.Dataset.range(100)
+
+    def branch_0(dataset):
+      return dataset.prefetch(1)
+
+    def branch_1(dataset):
+      return dataset.batch(2).prefetch(2).unbatch()
+
+    choose_fastest = optimization._ChooseFastestBranchDataset(
+        dataset, [branch_0, branch_1],
+        num_elements_per_branch=4,
+        reevaluation_period=6)
+
+    self.assertDatasetProduces(choose_fastest, expected_output=list(range(100)))
+
+  def testWithReevaluationAndRatio(self):
+    dataset = dataset_ops.Dataset.range(100)
+
+    def branch_0(dataset):
+      return dataset.map(lambda x: x).batch(10)
+
+    def branch_1(dataset):
+      return dataset.batch(10).map(lambda x: x)
+
+    choose_fastest = optimization._ChooseFastestBranchDataset(
+        dataset, [branch_0, branch_1],
+        ratio_numerator=10,
+        num_elements_per_branch=1,
+        reevaluation_period=2)
+
+    self.assertDatasetProduces(
+        choose_fastest,
+        expected_output=[list(range(10 * x, 10 * x + 10)) for x in range(10)])
+
   def testWithMoreOutputThanInput(self):
 
     dataset = dataset_ops.Dataset.from_tensors(0).repeat(1000).batch(100)
@@ -37,9 +37,11 @@ from tensorflow.python.ops import bitwise_ops
 from tensorflow.python.ops import check_ops
 from tensorflow.python.ops import clip_ops
 from tensorflow.python.ops import control_flow_ops
+from tensorflow.python.ops import image_ops
 from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import nn
 from tensorflow.python.ops import parsing_ops
+from tensorflow.python.ops import string_ops
 from tensorflow.python.platform import test
 
 
@@ -206,6 +208,49 @@ def _generate_cwise_test_cases():
   )
 
 
+def _generate_image_test_cases():
+
+  def image_dataset_factory():
+    return dataset_ops.Dataset.from_tensors(
+        np.random.rand(4, 6, 3).astype(np.float32)).repeat(5)
+
+  def normalize_fn(image):
+    mean = math_ops.reduce_mean(image, axis=[-3, -2], keepdims=True)
+    return (image - mean) / 255.0
+
+  test_cases = [
+      ("AdjustHue", lambda x: image_ops.adjust_hue(x, 0.2)),
+      ("AdjustSaturation", lambda x: image_ops.adjust_saturation(x, 0.5)),
+      ("CentralCrop", lambda x: image_ops.central_crop(x, 0.5)),
+      ("CropToBoundingBox",
+       lambda x: image_ops.crop_to_bounding_box(x, 1, 2, 2, 3)),
+      ("FlipLeftRight", image_ops.flip_left_right),
+      ("FlipUpDown", image_ops.flip_up_down),
+      ("Normalize", normalize_fn),
+      ("ResizeBilinear", lambda x: image_ops.resize_images(x, [8, 5])),
+      ("ResizeNearestNeighbor", lambda x: image_ops.resize_images(
+          x, [8, 5], method=image_ops.ResizeMethodV1.NEAREST_NEIGHBOR)),
+      ("RGBToHSV", image_ops.rgb_to_hsv),
+  ]
+  return [(name, fn, image_dataset_factory) for name, fn in test_cases]
+
+
+def _generate_string_test_cases():
+
+  def string_dataset_factory():
+    return dataset_ops.Dataset.from_tensor_slices(
+        [" 1.5 ", "Abc", "2"]).repeat(5)
+
+  test_cases = [
+      ("RegexReplace", lambda x: string_ops.regex_replace(x, "[0-9]", "#")),
+      ("StringLength", string_ops.string_length),
+      ("StringStrip", string_ops.string_strip),
+      ("StringToHashBucketFast",
+       lambda x: string_ops.string_to_hash_bucket_fast(x, 10)),
+  ]
+  return [(name, fn, string_dataset_factory) for name, fn in test_cases]
+
+
 def _generate_csv_test_case():
 
   def csv_factory():
@@ -303,7 +348,8 @@ def _generate_optimization_test_cases():
       ("ParseSingleExample", parse_fn, parse_base),
       ("ParseSingleExampleDenseOutputOnly", dense_output_only_parse_fn,
        parse_base),
-  ] + _generate_cwise_test_cases()
+  ] + (_generate_cwise_test_cases() + _generate_image_test_cases() +
+       _generate_string_test_cases())
 
   return [{
       "testcase_name":
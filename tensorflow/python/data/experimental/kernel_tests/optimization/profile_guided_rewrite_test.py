@@ -0,0 +1,71 @@
+# Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the `ProfileGuidedRewrite` optimization."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+import tempfile
+
+from tensorflow.python.data.experimental.ops import optimization
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import test_util
+from tensorflow.python.ops import math_ops
+from tensorflow.python.platform import gfile
+from tensorflow.python.platform import test
+
+
+@test_util.run_all_in_graph_and_eager_modes
+class ProfileGuidedRewriteTest(test_base.DatasetTestBase):
+
+  def _make_dataset(self, profile_path, expected_next):
+    dataset = dataset_ops.Dataset.range(100)
+    dataset = dataset.apply(optimization.assert_next(expected_next))
+    # Spends much longer producing each element than the other
+    # transformations.
+    dataset = dataset.map(lambda x: x + math_ops.reduce_sum(
+        math_ops.range(100000, dtype=dtypes.int64)) * 0)
+    options = dataset_ops.Options()
+    options.experimental_optimization.autotune_profile_path = profile_path
+    return dataset.with_options(options)
+
+  def testParallelizesExpensiveMap(self):
+    profile_path = os.path.join(
+        tempfile.mkdtemp(dir=self.get_temp_dir()), "profile")
+
+    # The first pass over the input writes the profile.
+    dataset = self._make_dataset(profile_path, ["Map"])
+    self.assertDatasetProduces(dataset, range(100))
+    self.assertTrue(gfile.Exists(profile_path))
+
+    dataset = self._make_dataset(profile_path, ["ParallelMap"])
+    self.assertDatasetProduces(dataset, range(100))
+
+  def testNoAutotune(self):
+    profile_path = os.path.join(
+        tempfile.mkdtemp(dir=self.get_temp_dir()), "profile")
+    dataset = self._make_dataset(profile_path, ["Map"])
+    options = dataset_ops.Options()
+    options.experimental_optimization.autotune = False
+    dataset = dataset.with_options(options)
+    self.assertDatasetProduces(dataset, range(100))
+    self.assertFalse(gfile.Exists(profile_path))
+
+
+if __name__ == "__main__":
+  test.main()
@@ -102,6 +102,19 @@ class RebatchDatasetTest(test_base.DatasetTestBase, parameterized.TestCase):
     expected_output.extend([[]])  # Last replica gets an empty batch
     self.assertDatasetProduces(rebatched_dataset, expected_output)
 
+  def testUnalignedRows(self):
+    # Rows of 3 bytes, so that the slices of most replicas are not aligned.
+    pixels = np.arange(30 * 3, dtype=np.uint8).reshape([30, 3])
+    dataset = dataset_ops.Dataset.from_tensor_slices(pixels).batch(15)
+    rebatched_dataset = distribute._RebatchDataset(dataset, num_replicas=4)
+    expected_output = []
+    for i in range(0, 30, 15):
+      for j in range(4):
+        start = min(i + 4 * j, i + 15)
+        end = min(start + 4, i + 15)
+        expected_output.append(pixels[start:end])
+    self.assertDatasetProduces(rebatched_dataset, expected_output)
+
   def testTupleOutput(self):
     dataset = dataset_ops.Dataset.range(1024).map(lambda x: (x, x)).batch(32)
     rebatched_dataset = distribute._RebatchDataset(dataset, num_replicas=4)
@@ -482,6 +482,42 @@ class SqlDatasetTest(sql_dataset_test_base.SqlDatasetTestBase):
     with self.assertRaises(errors.OutOfRangeError):
       self.evaluate(get_next())
 
+  # Test that SqlDataset can read batches of rows directly.
+  def testReadResultSetBatched(self):
+    dataset = self._createSqlDataset(
+        query="SELECT first_name, last_name, motto FROM students "
+        "ORDER BY first_name DESC",
+        output_types=(dtypes.string, dtypes.string, dtypes.string),
+        num_repeats=2,
+        batch_size=3)
+    self.assertDatasetProduces(
+        dataset,
+        expected_output=[([b"John", b"Jane"], [b"Doe", b"Moe"],
+                          [b"Hi!", b"Hi again!"])] * 2,
+        num_test_iterations=2)
+
+  # Test that only the last batch of a batched SqlDataset is partial.
+  def testReadResultSetBatchedPartialBatch(self):
+    get_next = self.getNext(
+        self._createSqlDataset(
+            query="SELECT * FROM data", output_types=(dtypes.int32),
+            batch_size=2))
+    self.assertAllEqual(self.evaluate(get_next()), [0, 1])
+    self.assertAllEqual(self.evaluate(get_next()), [2])
+    with self.assertRaises(errors.OutOfRangeError):
+      self.evaluate(get_next())
+
+  # Test that a batched SqlDataset is empty if the result set is.
+  def testReadEmptyResultSetBatched(self):
+    get_next = self.getNext(
+        self._createSqlDataset(
+            query="SELECT first_name, last_name, motto FROM students "
+            "WHERE first_name = 'Nonexistent'",
+            output_types=(dtypes.string, dtypes.string, dtypes.string),
+            batch_size=2))
+    with self.assertRaises(errors.OutOfRangeError):
+      self.evaluate(get_next())
+
 
 if __name__ == "__main__":
   test.main()
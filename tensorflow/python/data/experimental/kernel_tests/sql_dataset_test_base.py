@@ -34,9 +34,11 @@ class SqlDatasetTestBase(test_base.DatasetTestBase):
                         query,
                         output_types,
                         driver_name="sqlite",
-                        num_repeats=1):
+                        num_repeats=1,
+                        batch_size=None):
     dataset = readers.SqlDataset(driver_name, self.data_source_name, query,
-                                 output_types).repeat(num_repeats)
+                                 output_types,
+                                 batch_size=batch_size).repeat(num_repeats)
     return dataset
 
   def setUp(self):
@@ -0,0 +1,57 @@
+# Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Python wrappers for reading datasets from a tf.data service worker."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.data.util import structure
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import gen_experimental_dataset_ops
+
+
+class _DataServiceDataset(dataset_ops.DatasetSource):
+  """A `Dataset` whose elements are produced by a tf.data service worker.
+
+  The worker at `address` (see `tensorflow/core/data/service/server_main.cc`)
+  runs the input pipeline of `dataset` on behalf of the consumer. All
+  `_DataServiceDataset`s created from the same pipeline share its elements, so
+  the preprocessing is done only once. Iterators of this dataset cannot be
+  checkpointed.
+  """
+
+  def __init__(self, address, dataset):
+    """Creates a `_DataServiceDataset`.
+
+    Args:
+      address: A `tf.string` scalar, the address of the worker, e.g.
+        "localhost:5000".
+      dataset: The `tf.data.Dataset` to run on the worker.
+    """
+    self._address = ops.convert_to_tensor(
+        address, dtype=dtypes.string, name="address")
+    self._element_spec = dataset.element_spec
+    variant_tensor = gen_experimental_dataset_ops.data_service_dataset(
+        address=self._address,
+        dataset_graph=dataset._as_serialized_graph(),  # pylint: disable=protected-access
+        output_types=structure.get_flat_tensor_types(self._element_spec),
+        output_shapes=structure.get_flat_tensor_shapes(self._element_spec))
+    super(_DataServiceDataset, self).__init__(variant_tensor)
+
+  @property
+  def element_spec(self):
+    return self._element_spec
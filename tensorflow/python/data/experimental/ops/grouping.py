@@ -21,6 +21,7 @@ import numpy as np
 
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.util import nest
+from tensorflow.python.data.util import sparse
 from tensorflow.python.data.util import structure
 from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
@@ -439,6 +440,117 @@ class _GroupByWindowDataset(dataset_ops.UnaryDataset):
     return "tf.data.experimental.group_by_window()"
 
 
+class _BucketByTokenBudgetDataset(dataset_ops.UnaryDataset):
+  """A `Dataset` that batches elements of similar lengths within a budget.
+
+  Each element is put in the bucket of its length, as computed by
+  `element_length_func` and delimited by `bucket_boundaries`. A bucket's
+  elements are produced as a batch once it cannot take another element without
+  exceeding `token_budget` tokens, counting every element of a batch as long as
+  its longest one. Batches are padded in every dimension to the largest size
+  among their elements, so grouping elements of similar lengths and sizing
+  batches by tokens rather than elements keeps both the padding and the work
+  per batch small.
+
+  At most `max_buffered_elements` elements are held in partial batches; beyond
+  that, the partial batch with the most tokens is produced early.
+  """
+
+  def __init__(self, input_dataset, element_length_func, bucket_boundaries,
+               token_budget, max_buffered_elements=None, padding_values=None,
+               parallel_copy=False):
+    """Creates a `_BucketByTokenBudgetDataset`.
+
+    Args:
+      input_dataset: The input `Dataset`.
+      element_length_func: A function mapping an element of `input_dataset` to
+        a `tf.int64` scalar, its length.
+      bucket_boundaries: A strictly increasing list of `int`s, the upper length
+        boundaries of the buckets.
+      token_budget: A `tf.int64` scalar `tf.Tensor`, representing the maximum
+        number of elements times the maximum length in a batch.
+      max_buffered_elements: (Optional.) A `tf.int64` scalar `tf.Tensor`,
+        representing the maximum number of elements held in partial batches.
+        Defaults to no limit.
+      padding_values: (Optional.) A nested structure of scalar-shaped
+        `tf.Tensor`, representing the padding values to use for the respective
+        components. Defaults to `0` for numeric types and the empty string for
+        string types.
+      parallel_copy: (Optional.) Whether to copy the elements of a batch into
+        it in parallel.
+
+    Raises:
+      TypeError: If `input_dataset` has sparse components.
+      ValueError: If `element_length_func` does not return a `tf.int64` scalar.
+    """
+    # pylint: disable=protected-access
+    self._input_dataset = input_dataset
+    if sparse.any_sparse(dataset_ops.get_legacy_output_classes(input_dataset)):
+      raise TypeError(
+          "Batching of padded sparse tensors is not currently supported")
+
+    def element_length_func_wrapper(*args):
+      return ops.convert_to_tensor(
+          element_length_func(*args), dtype=dtypes.int64)
+    self._element_length_func = dataset_ops.StructuredFunctionWrapper(
+        element_length_func_wrapper, self._transformation_name(),
+        dataset=input_dataset)
+    if not self._element_length_func.output_structure.is_compatible_with(
+        tensor_spec.TensorSpec([], dtypes.int64)):
+      raise ValueError(
+          "`element_length_func` must return a single tf.int64 scalar tensor.")
+
+    self._bucket_boundaries = ops.convert_to_tensor(
+        bucket_boundaries, dtype=dtypes.int64, name="bucket_boundaries")
+    self._token_budget = ops.convert_to_tensor(
+        token_budget, dtype=dtypes.int64, name="token_budget")
+    if max_buffered_elements is None:
+      max_buffered_elements = -1
+    self._max_buffered_elements = ops.convert_to_tensor(
+        max_buffered_elements, dtype=dtypes.int64,
+        name="max_buffered_elements")
+
+    input_types = dataset_ops.get_legacy_output_types(input_dataset)
+    input_shapes = dataset_ops.get_legacy_output_shapes(input_dataset)
+    if padding_values is None:
+      padding_values = dataset_ops._default_padding(input_dataset)
+    self._padding_values = nest.map_structure_up_to(
+        input_shapes, dataset_ops._padding_value_to_tensor, padding_values,
+        input_types)
+
+    def _batch_shape(s):
+      if s.ndims is None:
+        return tensor_shape.unknown_shape()
+      return tensor_shape.TensorShape([None] * (s.ndims + 1))
+
+    self._structure = structure.convert_legacy_structure(
+        input_types, nest.map_structure(_batch_shape, input_shapes),
+        dataset_ops.get_legacy_output_classes(input_dataset))
+
+    variant_tensor = ged_ops.bucket_by_token_budget_dataset(
+        input_dataset._variant_tensor,
+        self._element_length_func.function.captured_inputs,
+        bucket_boundaries=self._bucket_boundaries,
+        token_budget=self._token_budget,
+        max_buffered_elements=self._max_buffered_elements,
+        padding_values=nest.flatten(self._padding_values),
+        length_func=self._element_length_func.function,
+        parallel_copy=parallel_copy,
+        output_shapes=structure.get_flat_tensor_shapes(self._structure))
+    super(_BucketByTokenBudgetDataset, self).__init__(input_dataset,
+                                                      variant_tensor)
+
+  @property
+  def element_spec(self):
+    return self._structure
+
+  def _functions(self):
+    return [self._element_length_func]
+
+  def _transformation_name(self):
+    return "_BucketByTokenBudgetDataset"
+
+
 @tf_export("data.experimental.Reducer")
 class Reducer(object):
   """A reducer is used for reducing a set of elements.
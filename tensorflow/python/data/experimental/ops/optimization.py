@@ -180,7 +180,8 @@ class _ChooseFastestBranchDataset(dataset_ops.UnaryDataset):
                functions,
                ratio_numerator=1,
                ratio_denominator=1,
-               num_elements_per_branch=None):
+               num_elements_per_branch=None,
+               reevaluation_period=None):
     """Chooses the fastest of some dataset functions.
 
     Given dataset functions that take input_dataset as input and output
@@ -238,6 +239,11 @@ class _ChooseFastestBranchDataset(dataset_ops.UnaryDataset):
         the branches, and update its knowledge of which input is the fastest.
         Note that (num_elements_per_branch * ratio) is expected to be an
         integer.
+      reevaluation_period: (Optional.) If set, the number of elements to get
+        from the fastest branch before running the experiments again, so that
+        the choice adapts to changes in the speed of the branches. Note that
+        (reevaluation_period * ratio) is expected to be an integer. If not set,
+        the fastest branch is chosen once.
 
     Returns:
       A `Dataset` that has the same elements the inputs.
@@ -264,6 +270,13 @@ class _ChooseFastestBranchDataset(dataset_ops.UnaryDataset):
       # Pick a sensible default based on `ratio_denominator`
       num_elements_per_branch = 10 * ratio_denominator
 
+    # The `reevaluation_period` attribute is only passed when it is set, so
+    # that graphs that do not use it can still be run by servers that predate
+    # it.
+    kwargs = self._flat_structure
+    if reevaluation_period is not None:
+      kwargs = dict(kwargs, reevaluation_period=reevaluation_period)
+
     variant_tensor = (
         gen_experimental_dataset_ops.choose_fastest_branch_dataset(
             input_dataset._variant_tensor,  # pylint: disable=protected-access
@@ -273,7 +286,7 @@ class _ChooseFastestBranchDataset(dataset_ops.UnaryDataset):
             num_elements_per_branch=num_elements_per_branch,
             branches=[f.function for f in self._funcs],
             other_arguments_lengths=self._capture_lengths,
-            **self._flat_structure))
+            **kwargs))
     super(_ChooseFastestBranchDataset, self).__init__(input_dataset,
                                                       variant_tensor)
 
@@ -107,6 +107,27 @@ class OptimizationOptions(options.OptionsBase):
       "are allowed but may result in CPU contention. If None, defaults to the "
       "number of schedulable CPU cores.")
 
+  autotune_ram_budget = options.create_option(
+      name="autotune_ram_budget",
+      ty=int,
+      docstring=
+      "When autotuning is enabled (through `autotune`), determines the RAM "
+      "budget, in bytes, for the buffers of the input pipeline. The "
+      "`RAM_BUDGET` autotuning algorithm never exceeds it. If None, defaults "
+      "to half of the available RAM.")
+
+  autotune_profile_path = options.create_option(
+      name="autotune_profile_path",
+      ty=str,
+      docstring=
+      "When autotuning is enabled (through `autotune`), the path of a profile "
+      "of the input pipeline. If there is no file at the path, the profile is "
+      "written there at the end of the first pass over the input. Otherwise, "
+      "the profile is used to parallelize, prefetch and cache the expensive "
+      "transformations of the input pipeline, with caches limited by "
+      "`autotune_ram_budget`. The profile is only valid for the input "
+      "pipeline it was written by. If None, no profile is used.")
+
   filter_fusion = options.create_option(
       name="filter_fusion",
       ty=bool,
@@ -216,9 +237,18 @@ class OptimizationOptions(options.OptionsBase):
 
     if self.autotune is not False and self.autotune_buffers:  # pylint: disable=g-bool-id-comparison
       result.add("inject_prefetch")
+    if self.autotune is not False and self.autotune_profile_path:  # pylint: disable=g-bool-id-comparison
+      result.add("profile_guided_rewrite")
     return sorted(list(result))
 
   def _static_optimization_configs(self):
+    result = []
     if self.map_vectorization is not None:
-      return self.map_vectorization._static_optimization_configs()  # pylint: disable=protected-access
-    return []
+      result.extend(self.map_vectorization._static_optimization_configs())  # pylint: disable=protected-access
+    if self.autotune is not False and self.autotune_profile_path:  # pylint: disable=g-bool-id-comparison
+      result.append(
+          "profile_guided_rewrite:profile_path:" + self.autotune_profile_path)
+      if self.autotune_ram_budget is not None:
+        result.append("profile_guided_rewrite:ram_budget:%d" %
+                      self.autotune_ram_budget)
+    return result
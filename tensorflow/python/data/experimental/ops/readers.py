@@ -991,7 +991,8 @@ def _get_file_names(file_pattern, shuffle):
 class SqlDatasetV2(dataset_ops.DatasetSource):
   """A `Dataset` consisting of the results from a SQL query."""
 
-  def __init__(self, driver_name, data_source_name, query, output_types):
+  def __init__(self, driver_name, data_source_name, query, output_types,
+               batch_size=None):
     """Creates a `SqlDataset`.
 
     `SqlDataset` allows a user to read data from the result set of a SQL query.
@@ -1016,6 +1017,11 @@ class SqlDatasetV2(dataset_ops.DatasetSource):
       query: A 0-D `tf.string` tensor containing the SQL query to execute.
       output_types: A tuple of `tf.DType` objects representing the types of the
         columns returned by `query`.
+      batch_size: (Optional.) A Python integer. If set, each element of the
+        dataset is a batch of up to `batch_size` rows, in which each column is
+        a 1-D tensor. The rows are then read from the database directly into
+        the batches, which is much faster than reading rows one at a time and
+        then batching them. Only the last batch may have fewer rows.
     """
     self._driver_name = ops.convert_to_tensor(
         driver_name, dtype=dtypes.string, name="driver_name")
@@ -1023,11 +1029,23 @@ class SqlDatasetV2(dataset_ops.DatasetSource):
         data_source_name, dtype=dtypes.string, name="data_source_name")
     self._query = ops.convert_to_tensor(
         query, dtype=dtypes.string, name="query")
-    self._element_spec = nest.map_structure(
-        lambda dtype: tensor_spec.TensorSpec([], dtype), output_types)
-    variant_tensor = gen_experimental_dataset_ops.sql_dataset(
-        self._driver_name, self._data_source_name, self._query,
-        **self._flat_structure)
+    if batch_size is None:
+      self._element_spec = nest.map_structure(
+          lambda dtype: tensor_spec.TensorSpec([], dtype), output_types)
+      variant_tensor = gen_experimental_dataset_ops.sql_dataset(
+          self._driver_name, self._data_source_name, self._query,
+          **self._flat_structure)
+    else:
+      if batch_size <= 0:
+        raise ValueError("`batch_size` must be positive but is %d." %
+                         batch_size)
+      self._element_spec = nest.map_structure(
+          lambda dtype: tensor_spec.TensorSpec([None], dtype), output_types)
+      # The `batch_size` attribute is only passed when it is set, so that
+      # graphs that do not use it can still be run by servers that predate it.
+      variant_tensor = gen_experimental_dataset_ops.sql_dataset(
+          self._driver_name, self._data_source_name, self._query,
+          batch_size=batch_size, **self._flat_structure)
     super(SqlDatasetV2, self).__init__(variant_tensor)
 
   @property
@@ -1040,8 +1058,10 @@ class SqlDatasetV1(dataset_ops.DatasetV1Adapter):
   """A `Dataset` consisting of the results from a SQL query."""
 
   @functools.wraps(SqlDatasetV2.__init__)
-  def __init__(self, driver_name, data_source_name, query, output_types):
-    wrapped = SqlDatasetV2(driver_name, data_source_name, query, output_types)
+  def __init__(self, driver_name, data_source_name, query, output_types,
+               batch_size=None):
+    wrapped = SqlDatasetV2(driver_name, data_source_name, query, output_types,
+                           batch_size)
     super(SqlDatasetV1, self).__init__(wrapped)
 
 
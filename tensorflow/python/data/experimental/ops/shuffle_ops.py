@@ -23,6 +23,7 @@ from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
 from tensorflow.python.ops import gen_dataset_ops
+from tensorflow.python.ops import gen_experimental_dataset_ops as ged_ops
 from tensorflow.python.util import deprecation
 from tensorflow.python.util.tf_export import tf_export
 
@@ -51,6 +52,54 @@ class _ShuffleAndRepeatDataset(dataset_ops.UnaryUnchangedStructureDataset):
                                                    variant_tensor)
 
 
+class _ExternalShuffleDataset(dataset_ops.UnaryUnchangedStructureDataset):
+  """A `Dataset` that shuffles its input using a buffer that spills to disk.
+
+  At most `memory_buffer_size` of the `buffer_size` buffered elements are kept
+  in memory. Whenever the in-memory part of the buffer is full, it is shuffled
+  and written to a new file in `spill_directory`, which is read back in batches
+  of elements and deleted once exhausted. The order of the produced elements
+  is distributed as if all of the buffer was kept in memory.
+
+  Iterators over this dataset cannot be checkpointed.
+  """
+
+  def __init__(self, input_dataset, buffer_size, memory_buffer_size,
+               spill_directory, seed=None):
+    """Creates an `_ExternalShuffleDataset`.
+
+    Args:
+      input_dataset: The input `Dataset`.
+      buffer_size: A `tf.int64` scalar `tf.Tensor`, representing the number of
+        elements to buffer, in memory and on disk combined.
+      memory_buffer_size: A `tf.int64` scalar `tf.Tensor`, representing the
+        maximum number of buffered elements to keep in memory.
+      spill_directory: A `tf.string` scalar `tf.Tensor`, representing the local
+        directory to write the rest of the buffer to.
+      seed: (Optional.) A `tf.int64` scalar `tf.Tensor`, representing the random
+        seed that will be used to create the distribution. See
+        `tf.compat.v1.set_random_seed` for behavior.
+    """
+    self._input_dataset = input_dataset
+    self._buffer_size = ops.convert_to_tensor(
+        buffer_size, dtype=dtypes.int64, name="buffer_size")
+    self._memory_buffer_size = ops.convert_to_tensor(
+        memory_buffer_size, dtype=dtypes.int64, name="memory_buffer_size")
+    self._spill_directory = ops.convert_to_tensor(
+        spill_directory, dtype=dtypes.string, name="spill_directory")
+    self._seed, self._seed2 = random_seed.get_seed(seed)
+    variant_tensor = ged_ops.external_shuffle_dataset(
+        self._input_dataset._variant_tensor,  # pylint: disable=protected-access
+        buffer_size=self._buffer_size,
+        memory_buffer_size=self._memory_buffer_size,
+        spill_directory=self._spill_directory,
+        seed=self._seed,
+        seed2=self._seed2,
+        **self._flat_structure)
+    super(_ExternalShuffleDataset, self).__init__(input_dataset,
+                                                  variant_tensor)
+
+
 @deprecation.deprecated(
     None,
     "Use `tf.data.Dataset.shuffle(buffer_size, seed)` followed by "
@@ -124,6 +124,40 @@ class FileCacheTest(test_base.DatasetTestBase, parameterized.TestCase):
 
     self.evaluate(get_next1())  # this should continue to succeed
 
+  @combinations.generate(test_base.default_test_combinations())
+  def testSharedCache(self):
+    writer_dataset = dataset_ops.CacheDataset(
+        dataset_ops.Dataset.range(5), self.cache_prefix, shared=True)
+    # The input of the other iterators differs from the cached elements, to
+    # tell whether they read the cache.
+    other_dataset = dataset_ops.CacheDataset(
+        dataset_ops.Dataset.range(10, 15), self.cache_prefix, shared=True)
+
+    get_next1 = self.getNext(writer_dataset)
+    get_next2 = self.getNext(other_dataset)
+    self.assertEqual(0, self.evaluate(get_next1()))
+    # The cache is being written, so the second iterator passes its input
+    # through instead of failing.
+    self.assertEqual(10, self.evaluate(get_next2()))
+    for i in range(1, 5):
+      self.assertEqual(i, self.evaluate(get_next1()))
+    with self.assertRaises(errors.OutOfRangeError):
+      self.evaluate(get_next1())
+    for i in range(11, 15):
+      self.assertEqual(i, self.evaluate(get_next2()))
+    with self.assertRaises(errors.OutOfRangeError):
+      self.evaluate(get_next2())
+
+    # The cache is complete, so new iterators read it.
+    self.assertDatasetProduces(other_dataset, list(range(5)))
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testSharedCacheRequiresFilename(self):
+    with self.assertRaises(errors.InvalidArgumentError):
+      dataset = dataset_ops.CacheDataset(
+          dataset_ops.Dataset.range(5), "", shared=True)
+      self.evaluate(self.getNext(dataset)())
+
   @combinations.generate(test_base.default_test_combinations())
   def testConcurrentReaders(self):
     components = (np.array([1, 2, 3, 4]), np.array([5, 6, 7, 8]),
@@ -100,6 +100,7 @@ tf_export("data.experimental.AUTOTUNE").export_constant(__name__, "AUTOTUNE")
 class AutotuneAlgorithm(enum.Enum):
   HILL_CLIMB = 0
   GRADIENT_DESCENT = 1
+  RAM_BUDGET = 2
 
 
 class ExternalStatePolicy(enum.Enum):
@@ -336,6 +337,8 @@ class DatasetV2(tracking_base.Trackable, composite_tensor.CompositeTensor):
     autotune = True
     algorithm = AutotuneAlgorithm.HILL_CLIMB
     cpu_budget = 0  # Indicates that all CPU cores should be used.
+    ram_budget = 0  # Indicates that the default share of RAM should be used.
+    profile_path = ""
     if options.experimental_optimization is not None:
       if options.experimental_optimization.autotune is False:  # pylint: disable=g-bool-id-comparison
         autotune = False
@@ -343,9 +346,14 @@ class DatasetV2(tracking_base.Trackable, composite_tensor.CompositeTensor):
         algorithm = options.experimental_optimization.autotune_algorithm
       if options.experimental_optimization.autotune_cpu_budget is not None:
         cpu_budget = options.experimental_optimization.autotune_cpu_budget
+      if options.experimental_optimization.autotune_ram_budget is not None:
+        ram_budget = options.experimental_optimization.autotune_ram_budget
+      if options.experimental_optimization.autotune_profile_path is not None:
+        profile_path = options.experimental_optimization.autotune_profile_path
 
     if autotune:
-      dataset = _ModelDataset(dataset, algorithm, cpu_budget)
+      dataset = _ModelDataset(dataset, algorithm, cpu_budget, ram_budget,
+                              profile_path)
 
     if options.experimental_stats and options.experimental_stats.aggregator:  # pylint: disable=line-too-long
       dataset = _SetStatsAggregatorDataset(  # pylint: disable=protected-access
@@ -3215,11 +3223,27 @@ class _MemoryCache(object):
 class CacheDataset(UnaryUnchangedStructureDataset):
   """A `Dataset` that caches elements of its input."""
 
-  def __init__(self, input_dataset, filename):
-    """See `Dataset.cache()` for details."""
+  def __init__(self, input_dataset, filename, shared=False):
+    """See `Dataset.cache()` for details.
+
+    Args:
+      input_dataset: The input dataset.
+      filename: A `tf.string` scalar `tf.Tensor`, the name of the cache.
+      shared: (Optional.) If true, the processes of a host can iterate over
+        datasets caching to the same `filename` concurrently: the first one
+        writes the cache, the others pass their input through until it is
+        complete, and they then all read it. Reads alias the pages of the
+        cache files, so a `filename` on a memory-backed filesystem such as
+        /dev/shm keeps a single copy of the cache in host memory.
+    """
     self._input_dataset = input_dataset
     self._filename = ops.convert_to_tensor(
         filename, dtype=dtypes.string, name="filename")
+    # The `shared` attribute is only passed when it is set, so that graphs that
+    # do not use it can still be run by servers that predate it.
+    kwargs = self._flat_structure
+    if shared:
+      kwargs["shared"] = True
     if tf2.enabled() and (context.executing_eagerly() or
                           ops.get_default_graph()._building_function):  # pylint: disable=protected-access
       self._cache = _MemoryCache()
@@ -3227,12 +3251,12 @@ class CacheDataset(UnaryUnchangedStructureDataset):
           input_dataset._variant_tensor,  # pylint: disable=protected-access
           filename=self._filename,
           cache=self._cache.handle,
-          **self._flat_structure)
+          **kwargs)
     else:
       variant_tensor = gen_dataset_ops.cache_dataset(
           input_dataset._variant_tensor,  # pylint: disable=protected-access
           filename=self._filename,
-          **self._flat_structure)
+          **kwargs)
     super(CacheDataset, self).__init__(input_dataset, variant_tensor)
 
 
@@ -3967,12 +3991,28 @@ class _OptionsDataset(UnaryUnchangedStructureDataset):
 class _ModelDataset(UnaryUnchangedStructureDataset):
   """A `Dataset` that acts as an identity, and models performance."""
 
-  def __init__(self, input_dataset, algorithm, cpu_budget):
+  def __init__(self, input_dataset, algorithm, cpu_budget, ram_budget=0,
+               profile_path=""):
     self._input_dataset = input_dataset
+    # The `ram_budget` and `profile_path` attributes are only passed when they
+    # are set, so that graphs that do not use them can still be run by servers
+    # that predate them.
+    if ram_budget or profile_path:
+      kwargs = {}
+      if ram_budget:
+        kwargs["ram_budget"] = ram_budget
+      if profile_path:
+        kwargs["profile_path"] = profile_path
+      kwargs.update(self._flat_structure)
+      variant_tensor = gen_dataset_ops.model_dataset(
+          input_dataset._variant_tensor,  # pylint: disable=protected-access
+          algorithm=AutotuneAlgorithm(algorithm).value,
+          cpu_budget=cpu_budget,
+          **kwargs)
     # TODO(jsimsa): This check is introduced for forward compatibility and can
     # be removed after 7/24/2019. At that point, all servers are expected to
     # recognize the `algorithm` attribute.
-    if algorithm != AutotuneAlgorithm.HILL_CLIMB:
+    elif algorithm != AutotuneAlgorithm.HILL_CLIMB:
       variant_tensor = gen_dataset_ops.model_dataset(
           input_dataset._variant_tensor,  # pylint: disable=protected-access
           algorithm=algorithm,
@@ -208,7 +208,7 @@ class _TFRecordDataset(dataset_ops.DatasetSource):
     Args:
       filenames: A `tf.string` tensor containing one or more filenames.
       compression_type: (Optional.) A `tf.string` scalar evaluating to one of
-        `""` (no compression), `"ZLIB"`, or `"GZIP"`.
+        `""` (no compression), `"ZLIB"`, `"GZIP"`, or `"SNAPPY"`.
       buffer_size: (Optional.) A `tf.int64` scalar representing the number of
         bytes in the read buffer. 0 means no buffering.
     """
@@ -232,6 +232,46 @@ class _TFRecordDataset(dataset_ops.DatasetSource):
     return tensor_spec.TensorSpec([], dtypes.string)
 
 
+class _IndexedTFRecordDataset(dataset_ops.DatasetSource):
+  """A `Dataset` comprising one shard of the records of indexed TFRecord files.
+
+  Every file must be uncompressed and have a record index next to it, named
+  after the file with an `".index"` suffix, as produced by `RecordWriter` with
+  `build_index` set. The records of each file are split into `num_shards`
+  contiguous ranges, so that `num_shards` datasets reading the same file can
+  run in parallel, e.g. under `interleave`.
+  """
+
+  def __init__(self, filenames, num_shards, shard_index, buffer_size=None):
+    """Creates an `_IndexedTFRecordDataset`.
+
+    Args:
+      filenames: A `tf.string` tensor containing one or more filenames.
+      num_shards: A `tf.int64` scalar representing the number of shards each
+        file is split into.
+      shard_index: A `tf.int64` scalar representing the shard to read.
+      buffer_size: (Optional.) A `tf.int64` scalar representing the number of
+        bytes in the read buffer. 0 means no buffering.
+    """
+    self._filenames = filenames
+    self._num_shards = ops.convert_to_tensor(
+        num_shards, dtype=dtypes.int64, name="num_shards")
+    self._shard_index = ops.convert_to_tensor(
+        shard_index, dtype=dtypes.int64, name="shard_index")
+    self._buffer_size = convert.optional_param_to_tensor(
+        "buffer_size",
+        buffer_size,
+        argument_default=_DEFAULT_READER_BUFFER_SIZE_BYTES)
+    variant_tensor = ged_ops.indexed_tf_record_dataset(
+        self._filenames, self._num_shards, self._shard_index,
+        self._buffer_size)
+    super(_IndexedTFRecordDataset, self).__init__(variant_tensor)
+
+  @property
+  def element_spec(self):
+    return tensor_spec.TensorSpec([], dtypes.string)
+
+
 class ParallelInterleaveDataset(dataset_ops.UnaryDataset):
   """A `Dataset` that maps a function over its input and flattens the result."""
 
@@ -297,7 +337,7 @@ class TFRecordDatasetV2(dataset_ops.DatasetV2):
       filenames: A `tf.string` tensor or `tf.data.Dataset` containing one or
         more filenames.
       compression_type: (Optional.) A `tf.string` scalar evaluating to one of
-        `""` (no compression), `"ZLIB"`, or `"GZIP"`.
+        `""` (no compression), `"ZLIB"`, `"GZIP"`, or `"SNAPPY"`.
       buffer_size: (Optional.) A `tf.int64` scalar representing the number of
         bytes in the read buffer. If your input pipeline is I/O bottlenecked,
         consider setting this parameter to a value 1-100 MBs. If `None`, a
@@ -149,6 +149,8 @@ def set_optimizer_experimental_options(options):
         GPUs and above. Without the use of loss scaling, this can cause
         numerical underflow (see
         `keras.mixed_precision.experimental.LossScaleOptimizer`).
+      - auto_mixed_precision_cpu: Change certain float32 ops to bfloat16 on
+        CPUs with native bfloat16 dot products (AVX512_BF16 or AMX_BF16).
       - disable_meta_optimizer: Disable the entire meta optimizer.
       - min_graph_nodes: The minimum number of nodes in a graph to optimizer.
         For smaller graphs, optimization is skipped.
@@ -2786,6 +2786,30 @@ class DeepConv2DTest(test.TestCase):
   def testConv2D3x3FilterStride1x1Same(self):
     self._RunTestCases([1, 1], "SAME")
 
+  def testConv2DCpuAutotune(self):
+    x1 = np.random.rand(2, 35, 35, 288).astype(np.float32)
+    x2 = np.random.rand(3, 3, 288, 384).astype(np.float32)
+
+    def _Conv2D():
+      with self.session(graph=ops.Graph(), use_gpu=False):
+        conv = nn_ops.conv2d(
+            constant_op.constant(x1), constant_op.constant(x2),
+            strides=[1, 1, 1, 1], padding="SAME")
+        # The first run times the implementations, the second reuses the
+        # fastest.
+        return self.evaluate(conv), self.evaluate(conv)
+
+    os.environ["TF_CPU_CONV2D_AUTOTUNE"] = "0"
+    values_expect, _ = _Conv2D()
+    os.environ["TF_CPU_CONV2D_AUTOTUNE"] = "1"
+    try:
+      values_tuned, values_cached = _Conv2D()
+    finally:
+      os.environ["TF_CPU_CONV2D_AUTOTUNE"] = "0"
+
+    self.assertAllClose(values_expect, values_tuned, rtol=1e-5, atol=1e-5)
+    self.assertAllClose(values_expect, values_cached, rtol=1e-5, atol=1e-5)
+
 
 class Conv2DBenchmark(test.Benchmark):
 
@@ -18,6 +18,7 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import os
 import random
 import time
 
@@ -1486,6 +1487,23 @@ class FIFOQueueTest(test.TestCase):
         session.run([a, c])
 
 
+@test_util.run_v1_only("FIFOQueue removed from v2")
+class LockFreeFIFOQueueTest(FIFOQueueTest):
+  """Runs the FIFOQueue tests with lock-free Enqueue and Dequeue enabled."""
+
+  def setUp(self):
+    super(LockFreeFIFOQueueTest, self).setUp()
+    self._lock_free_env = os.environ.get("TF_ENABLE_LOCK_FREE_FIFO_QUEUE")
+    os.environ["TF_ENABLE_LOCK_FREE_FIFO_QUEUE"] = "true"
+
+  def tearDown(self):
+    if self._lock_free_env is None:
+      del os.environ["TF_ENABLE_LOCK_FREE_FIFO_QUEUE"]
+    else:
+      os.environ["TF_ENABLE_LOCK_FREE_FIFO_QUEUE"] = self._lock_free_env
+    super(LockFreeFIFOQueueTest, self).tearDown()
+
+
 @test_util.run_v1_only("FIFOQueue removed from v2")
 class FIFOQueueDictTest(test.TestCase):
 
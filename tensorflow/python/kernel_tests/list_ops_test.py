@@ -19,6 +19,8 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import os
+
 from absl.testing import parameterized
 import numpy as np  # pylint: disable=unused-import
 
@@ -1608,5 +1610,73 @@ class ListOpsTest(test_util.TensorFlowTestCase, parameterized.TestCase):
       self.assertAllEqual(t, [1.0, 2.0, 3.0])
 
 
+class PreallocatedListOpsTest(test_util.TensorFlowTestCase):
+  """Tests lists whose elements are kept in a preallocated buffer."""
+
+  def setUp(self):
+    super(PreallocatedListOpsTest, self).setUp()
+    self._preallocate_env = os.environ.get("TF_PREALLOCATE_TENSOR_LISTS")
+    os.environ["TF_PREALLOCATE_TENSOR_LISTS"] = "true"
+
+  def tearDown(self):
+    if self._preallocate_env is None:
+      del os.environ["TF_PREALLOCATE_TENSOR_LISTS"]
+    else:
+      os.environ["TF_PREALLOCATE_TENSOR_LISTS"] = self._preallocate_env
+    super(PreallocatedListOpsTest, self).tearDown()
+
+  # Elements of 16 floats keep every row of the buffer aligned.
+  def _element(self, value):
+    return array_ops.fill([16], math_ops.cast(value, dtypes.float32))
+
+  @test_util.run_deprecated_v1
+  def testPushBackInWhileLoopThenStackAndGather(self):
+    l = list_ops.empty_tensor_list(
+        element_dtype=dtypes.float32, element_shape=[16], max_num_elements=10)
+    _, l = control_flow_ops.while_loop(
+        lambda i, l: i < 10,
+        lambda i, l: (i + 1, list_ops.tensor_list_push_back(
+            l, self._element(i))), [0, l])
+    t = list_ops.tensor_list_stack(l, element_dtype=dtypes.float32)
+    g = list_ops.tensor_list_gather(l, [3, 4, 5], element_dtype=dtypes.float32)
+    g_unordered = list_ops.tensor_list_gather(
+        l, [5, 3], element_dtype=dtypes.float32)
+    expected = np.tile(np.arange(10, dtype=np.float32)[:, None], [1, 16])
+    self.assertAllEqual(self.evaluate(t), expected)
+    self.assertAllEqual(self.evaluate(g), expected[3:6])
+    self.assertAllEqual(self.evaluate(g_unordered), expected[[5, 3]])
+
+  @test_util.run_deprecated_v1
+  def testPushBackToSharedList(self):
+    l = list_ops.empty_tensor_list(
+        element_dtype=dtypes.float32, element_shape=[16], max_num_elements=3)
+    l = list_ops.tensor_list_push_back(l, self._element(0))
+    # Both lists share l's buffer; only one of them can use row 1.
+    l_a = list_ops.tensor_list_push_back(l, self._element(1))
+    l_b = list_ops.tensor_list_push_back(l, self._element(2))
+    l_b = list_ops.tensor_list_push_back(l_b, self._element(3))
+    t_a, t_b = self.evaluate([
+        list_ops.tensor_list_stack(l_a, element_dtype=dtypes.float32),
+        list_ops.tensor_list_stack(l_b, element_dtype=dtypes.float32)
+    ])
+    self.assertAllEqual(t_a, [[0] * 16, [1] * 16])
+    self.assertAllEqual(t_b, [[0] * 16, [2] * 16, [3] * 16])
+
+  @test_util.run_deprecated_v1
+  def testSetItemOnReservedList(self):
+    l = list_ops.tensor_list_reserve(
+        element_dtype=dtypes.float32, element_shape=[16], num_elements=3)
+    for i in range(3):
+      l = list_ops.tensor_list_set_item(l, i, self._element(i))
+    # Overwriting an element can't reuse its row.
+    l_overwritten = list_ops.tensor_list_set_item(l, 1, self._element(7))
+    t, t_overwritten = self.evaluate([
+        list_ops.tensor_list_stack(l, element_dtype=dtypes.float32),
+        list_ops.tensor_list_stack(l_overwritten, element_dtype=dtypes.float32)
+    ])
+    self.assertAllEqual(t, [[0] * 16, [1] * 16, [2] * 16])
+    self.assertAllEqual(t_overwritten, [[0] * 16, [7] * 16, [2] * 16])
+
+
 if __name__ == "__main__":
   test.main()
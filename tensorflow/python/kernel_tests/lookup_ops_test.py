@@ -36,6 +36,7 @@ from tensorflow.python.framework import ops
 from tensorflow.python.framework import sparse_tensor
 from tensorflow.python.framework import test_util
 from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import gen_lookup_ops
 from tensorflow.python.ops import lookup_ops
 from tensorflow.python.ops import map_fn
 from tensorflow.python.ops import variables
@@ -398,6 +399,66 @@ class StaticHashTableTest(BaseLookupTableTest):
     self.assertAllEqual([10, -1, 5], self.evaluate(result2))
 
 
+class MemoryMappedTableTest(test.TestCase):
+
+  def testStringKeys(self):
+    filename = os.path.join(self.get_temp_dir(), "string_keys.table")
+    keys = constant_op.constant(["brain", "salad", "surgery"])
+    values = constant_op.constant([0, 1, 2], dtypes.int64)
+    self.evaluate(lookup_ops.write_memory_mapped_table(filename, keys, values))
+
+    table = lookup_ops.MemoryMappedTable(filename, dtypes.string,
+                                         dtypes.int64, -1)
+    self.assertAllEqual(3, self.evaluate(table.size()))
+    output = table.lookup(constant_op.constant(["surgery", "tarkus", "brain"]))
+    self.assertAllEqual([2, -1, 0], self.evaluate(output))
+
+    exported_keys, exported_values = self.evaluate(table.export())
+    self.assertAllEqual([b"brain", b"salad", b"surgery"], exported_keys)
+    self.assertAllEqual([0, 1, 2], exported_values)
+
+  def testInt64Keys(self):
+    filename = os.path.join(self.get_temp_dir(), "int64_keys.table")
+    keys = constant_op.constant([42, -7, 11], dtypes.int64)
+    values = constant_op.constant(["a", "b", "c"])
+    self.evaluate(lookup_ops.write_memory_mapped_table(filename, keys, values))
+
+    table = lookup_ops.MemoryMappedTable(filename, dtypes.int64,
+                                         dtypes.string, "n/a")
+    output = table.lookup(
+        constant_op.constant([[11, 0], [-7, 42]], dtypes.int64))
+    self.assertAllEqual([[b"c", b"n/a"], [b"b", b"a"]], self.evaluate(output))
+
+  def testDuplicateKeys(self):
+    filename = os.path.join(self.get_temp_dir(), "duplicate_keys.table")
+    keys = constant_op.constant(["brain", "salad", "brain"])
+    values = constant_op.constant([0, 1, 2], dtypes.int64)
+    with self.assertRaisesOpError("Duplicate key brain"):
+      self.evaluate(
+          lookup_ops.write_memory_mapped_table(filename, keys, values))
+
+  def testWrongDtypes(self):
+    filename = os.path.join(self.get_temp_dir(), "wrong_dtypes.table")
+    keys = constant_op.constant(["brain", "salad"])
+    values = constant_op.constant([0, 1], dtypes.int64)
+    self.evaluate(lookup_ops.write_memory_mapped_table(filename, keys, values))
+
+    with self.assertRaisesOpError("maps string to int64"):
+      table = lookup_ops.MemoryMappedTable(filename, dtypes.string,
+                                           dtypes.float32, -1.0)
+      self.evaluate(table.size())
+
+  def testNotATable(self):
+    filename = os.path.join(self.get_temp_dir(), "not_a.table")
+    with open(filename, "w") as f:
+      f.write("brain\nsalad\nsurgery\n" * 4)
+
+    with self.assertRaisesOpError("is not a memory-mapped table"):
+      table = lookup_ops.MemoryMappedTable(filename, dtypes.string,
+                                           dtypes.int64, -1)
+      self.evaluate(table.size())
+
+
 class KeyValueTensorInitializerTest(BaseLookupTableTest):
 
   def test_string(self):
@@ -1291,6 +1352,62 @@ class DenseHashTableOpTest(test.TestCase):
       self.assertAllEqual([[11, 1], [13, 3], [14, 4], [100, 0], [100, 0],
                            [100, 0], [100, 0], [200, 2]], pairs)
 
+  def testSharded(self):
+    with self.cached_session():
+      keys = constant_op.constant(list(range(1, 41)), dtypes.int64)
+      values = constant_op.constant(list(range(101, 141)), dtypes.int64)
+      table = lookup_ops.DenseHashTable(
+          dtypes.int64,
+          dtypes.int64,
+          default_value=-1,
+          empty_key=0,
+          deleted_key=-1,
+          initial_num_buckets=16,
+          num_shards=4)
+      self.assertAllEqual(0, self.evaluate(table.size()))
+
+      self.evaluate(table.insert(keys, values))
+      self.assertAllEqual(40, self.evaluate(table.size()))
+
+      self.evaluate(table.remove(constant_op.constant([2, 99], dtypes.int64)))
+      self.assertAllEqual(39, self.evaluate(table.size()))
+
+      lookup_keys = constant_op.constant([1, 2, 40, 41], dtypes.int64)
+      self.assertAllEqual([101, -1, 140, -1],
+                          self.evaluate(table.lookup(lookup_keys)))
+
+      # The buckets of all the shards are exported, and can be imported by a
+      # table with a different number of shards.
+      exported_keys, exported_values = table.export()
+      self.assertGreaterEqual(len(self.evaluate(exported_keys)), 64)
+      table2 = lookup_ops.DenseHashTable(
+          dtypes.int64,
+          dtypes.int64,
+          default_value=-1,
+          empty_key=0,
+          deleted_key=-1,
+          initial_num_buckets=16,
+          num_shards=2)
+      self.evaluate(
+          gen_lookup_ops.lookup_table_import_v2(table2.resource_handle,
+                                                exported_keys, exported_values))
+      self.assertAllEqual(39, self.evaluate(table2.size()))
+      self.assertAllEqual([101, -1, 140, -1],
+                          self.evaluate(table2.lookup(lookup_keys)))
+
+  def testShardedInvalidNumShards(self):
+    with self.cached_session():
+      with self.assertRaisesOpError("num_shards must be a positive power of 2"):
+        table = lookup_ops.DenseHashTable(
+            dtypes.int64,
+            dtypes.int64,
+            default_value=-1,
+            empty_key=0,
+            deleted_key=-1,
+            initial_num_buckets=16,
+            num_shards=3)
+        self.evaluate(table.size())
+
   @test_util.run_v1_only("Saver V1 only")
   def testSaveRestore(self):
     save_dir = os.path.join(self.get_temp_dir(), "save_restore")
@@ -18,6 +18,7 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import os
 import random
 import time
 
@@ -1594,6 +1595,23 @@ class PaddingFIFOQueueTest(test.TestCase):
                                      [tensor_shape.TensorShape(None)])
 
 
+@test_util.run_v1_only("PaddingFIFOQueue removed from v2")
+class LockFreePaddingFIFOQueueTest(PaddingFIFOQueueTest):
+  """Runs the PaddingFIFOQueue tests with lock-free operations enabled."""
+
+  def setUp(self):
+    super(LockFreePaddingFIFOQueueTest, self).setUp()
+    self._lock_free_env = os.environ.get("TF_ENABLE_LOCK_FREE_FIFO_QUEUE")
+    os.environ["TF_ENABLE_LOCK_FREE_FIFO_QUEUE"] = "true"
+
+  def tearDown(self):
+    if self._lock_free_env is None:
+      del os.environ["TF_ENABLE_LOCK_FREE_FIFO_QUEUE"]
+    else:
+      os.environ["TF_ENABLE_LOCK_FREE_FIFO_QUEUE"] = self._lock_free_env
+    super(LockFreePaddingFIFOQueueTest, self).tearDown()
+
+
 class QueueFromListTest(test.TestCase):
 
   def testQueueFromListShapes(self):
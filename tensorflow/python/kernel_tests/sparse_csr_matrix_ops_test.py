@@ -762,6 +762,42 @@ class CSRSparseMatrixOpsTest(test.TestCase):
 
         self.assertAllClose(c_sm_dense_value, c_dense_t_value)
 
+  @test_util.run_in_graph_and_eager_modes
+  def testSingleBatchSparseMatrixSparseMatMul(self):
+    # A single product is split across rows rather than batches. Make a few
+    # rows of `a` much denser than the rest, like the hubs of a graph.
+    sparsify = lambda m: m * (m > 1)
+
+    for (transpose_a, adjoint_b) in ((False, False), (True, False),
+                                     (False, True), (True, True)):
+      a_dense_shape = [129, 301] if transpose_a else [301, 129]
+      a_mats = sparsify(np.random.randn(*a_dense_shape)).astype(np.complex64)
+      if transpose_a:
+        a_mats[:, ::50] = 1.0
+      else:
+        a_mats[::50, :] = 1.0
+      b_mats = (sparsify(np.random.randn(129, 97)) *
+                np.exp(1.j * np.random.randn(129, 97))).astype(np.complex64)
+      if adjoint_b:
+        b_mats = np.conj(b_mats.T)
+
+      a_sm = dense_to_csr_sparse_matrix(a_mats)
+      b_sm = dense_to_csr_sparse_matrix(b_mats)
+      c_sm = sparse_csr_matrix_ops.sparse_matrix_sparse_mat_mul(
+          a_sm,
+          b_sm,
+          type=dtypes.complex64,
+          transpose_a=transpose_a,
+          adjoint_b=adjoint_b)
+      c_sm_dense = sparse_csr_matrix_ops.csr_sparse_matrix_to_dense(
+          c_sm, dtypes.complex64)
+      c_dense_t = math_ops.matmul(
+          a_mats, b_mats, transpose_a=transpose_a, adjoint_b=adjoint_b)
+      c_dense_t_value, c_sm_dense_value = self.evaluate(
+          (c_dense_t, c_sm_dense))
+
+      self.assertAllClose(c_sm_dense_value, c_dense_t_value)
+
   @test_util.run_in_graph_and_eager_modes
   def testLargeBatchRegisteredAddN(self):
     if not self._gpu_available:
@@ -153,6 +153,47 @@ class TopKTest(test.TestCase):
     self._testMediumTopK(np.float32)
     self._testMediumTopK(np.float16)
 
+  def testMediumTopKUnsorted(self):
+    b = 5
+    n = 500
+    k = 250
+    inputs = np.random.permutation(
+        np.linspace(0, 100, b * n, dtype=np.float32)).reshape(b, n)
+    indices = np.argsort(-inputs, axis=1)[:, :k]
+    values = -np.sort(-inputs, axis=1)[:, :k]
+    self._validateTopK(inputs, k, values, indices, sorted=False)
+
+  def _testRadixSelectTopK(self,
+                           dtype,
+                           sorted):  # pylint: disable=redefined-builtin
+    b = 5
+    n = 5000
+    k = 500
+    inputs = np.random.permutation(
+        np.linspace(-100, 100, b * n, dtype=dtype)).reshape(b, n)
+    indices = np.argsort(-inputs, axis=1)[:, :k]
+    values = -np.sort(-inputs, axis=1)[:, :k]
+    self._validateTopK(inputs, k, values, indices, sorted=sorted)
+
+  def testRadixSelectTopK(self):
+    self._testRadixSelectTopK(np.float32, sorted=True)
+    self._testRadixSelectTopK(np.float16, sorted=True)
+    self._testRadixSelectTopK(np.float64, sorted=True)
+
+  def testRadixSelectTopKUnsorted(self):
+    self._testRadixSelectTopK(np.float32, sorted=False)
+    self._testRadixSelectTopK(np.float64, sorted=False)
+
+  def testRadixSelectStableSort(self):
+    b = 5
+    n = 5000
+    k = 500
+    # Few distinct values, so the k-th largest is tied with many others.
+    inputs = np.random.randint(-3, 4, size=(b, n)).astype(np.int32)
+    indices = np.argsort(-inputs, axis=1, kind="mergesort")[:, :k]
+    values = -np.sort(-inputs, axis=1)[:, :k]
+    self._validateTopK(inputs, k, values, indices)
+
   def testStableSort(self):
     b = 5
     n = 500
@@ -34,7 +34,8 @@ def batch_function(num_batch_threads,
                    batch_timeout_micros,
                    allowed_batch_sizes=None,
                    max_enqueued_batches=10,
-                   autograph=True):
+                   autograph=True,
+                   target_p99_latency_micros=0):
   """Batches the computation done by the decorated function.
 
   So, for example, in the following code
@@ -71,6 +72,10 @@ def batch_function(num_batch_threads,
     max_enqueued_batches: The maximum depth of the batch queue. Defaults to 10.
     autograph: Whether to use autograph to compile python and eager style code
      for efficient graph-mode execution.
+    target_p99_latency_micros: If positive, the 99th percentile latency to
+     target. Batch timeout and size are then tuned online from the observed
+     batch processing times, with batch_timeout_micros and max_batch_size as
+     upper bounds.
 
   Returns:
     The decorated function will return the unbatched computation output Tensors.
@@ -100,6 +105,7 @@ def batch_function(num_batch_threads,
             batch_timeout_micros=batch_timeout_micros,
             allowed_batch_sizes=allowed_batch_sizes,
             max_enqueued_batches=max_enqueued_batches,
+            target_p99_latency_micros=target_p99_latency_micros,
             shared_name=name,
             f=computation,
             in_tensors=list(args),
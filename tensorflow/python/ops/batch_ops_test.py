@@ -230,6 +230,31 @@ class BatchOpsTest(test.TestCase):
       self.assertEqual(thread_results[0], [2])
       self.assertEqual(main_results[0], [3])
 
+  def testBasicUnbatchDecoratedWithLatencyTarget(self):
+    """Tests the batch_function decorator with adaptive batching."""
+    if context.executing_eagerly():
+      return
+    with self.cached_session() as sess:
+
+      @batch_ops.batch_function(1, 10, 100000,
+                                target_p99_latency_micros=1000000)
+      def computation(in_t):
+        return in_t + 1
+
+      inp = array_ops.placeholder(dtype=dtypes.int32, shape=[1])
+      result = computation(inp)
+      thread_results = []
+
+      def worker():
+        thread_results.extend(sess.run([result], feed_dict={inp: [1]}))
+
+      worker_thread = threading.Thread(target=worker)
+      worker_thread.start()
+      main_results = sess.run([result], feed_dict={inp: [2]})
+      worker_thread.join()
+      self.assertEqual(thread_results[0], [2])
+      self.assertEqual(main_results[0], [3])
+
   def testBatchDecoratedWithCapturedInput(self):
     """Tests that the batch_function decorator works."""
     if context.executing_eagerly():
@@ -287,6 +312,40 @@ class BatchOpsTest(test.TestCase):
       self.assertEqual(thread_results[0], [2])
       self.assertEqual(main_results[0], [3])
 
+  def testBatchFunctionOpWithRaggedBatching(self):
+    """Tests that batch_function op works with ragged batching."""
+    if context.executing_eagerly():
+      return
+    with self.cached_session() as sess:
+
+      @function.Defun(dtypes.int32, dtypes.int64)
+      def computation(in_t, row_splits):
+        return in_t + 1, row_splits[1:] - row_splits[:-1]
+
+      inp = array_ops.placeholder(dtype=dtypes.int32, shape=[None])
+      result = gen_batch_ops.batch_function(
+          [inp],
+          num_batch_threads=1,
+          max_batch_size=10,
+          batch_timeout_micros=100000,
+          enable_ragged_batching=True,
+          Tout=[dtypes.int32, dtypes.int64],
+          f=computation,
+          captured_tensors=computation.captured_inputs)
+      thread_results = []
+
+      def worker():
+        thread_results.extend(sess.run(result, feed_dict={inp: [1, 2, 3]}))
+
+      worker_thread = threading.Thread(target=worker)
+      worker_thread.start()
+      main_results = sess.run(result, feed_dict={inp: [5]})
+      worker_thread.join()
+      self.assertAllEqual(thread_results[0], [2, 3, 4])
+      self.assertAllEqual(thread_results[1], [3])
+      self.assertAllEqual(main_results[0], [6])
+      self.assertAllEqual(main_results[1], [1])
+
   def testBatchFunctionOpWithCapturedInput(self):
     """Tests that batch_function op works with captured input."""
     if context.executing_eagerly():
@@ -60,6 +60,56 @@ def all_reduce(t, group_size, group_key, instance_key, merge_op, final_op,
       communication_hint=communication_hint.lower())
 
 
+def all_reduce_n(ts, group_size, group_key, instance_key, merge_op, final_op,
+                 subdiv_offsets=(0,), communication_hint='auto'):
+  """Reduces a list of tensors collectively, across devices, as one buffer.
+
+  The tensors are packed into one buffer that is reduced by a single collective
+  instance, so that many small tensors, e.g. gradients, pay the latency of one
+  all-reduce rather than one each.  To overlap communication with the
+  computation of the tensors, split them into buckets of bounded size, in the
+  order in which they are computed, and reduce each bucket with its own
+  instance_key: each bucket is reduced as soon as its tensors are ready.  Every
+  device must pass tensors of the same shapes in the same order.
+
+  Args:
+    ts: a list of tensors of the same dtype to be reduced.
+    group_size: the total number of devices collectively reducing the tensors.
+      Should be a positive integer.
+    group_key: an integer identifying the group of devices.
+    instance_key: an integer identifying the participating group of Ops.
+    merge_op: string naming the binary Op to be applied to compute each
+      partial reduction.
+    final_op: string naming the unary Op to be applied to each fully
+      reduced value.  Can be 'Id' for no operation.
+    subdiv_offsets: a list of integer offsets into the packed buffer at which
+      each independent subdivision should begin.  Use [0] if no subdivision
+      should be done.
+    communication_hint: preferred collective communication.  The implementation
+      may fall back to another mechanism.  Options include `auto`, `ring`, and
+      `nccl`.
+
+  Returns:
+    The list of reduced tensors.
+
+  Raises:
+    ValueError: if any of the input parameter constraints are not met.
+  """
+  if group_size < 1:
+    raise ValueError('Parameter group_size to all_reduce_n must be at least 1.')
+  if not ts:
+    raise ValueError('Parameter ts to all_reduce_n must not be empty.')
+  return gen_collective_ops.collective_reduce_n(
+      ts,
+      group_size=group_size,
+      group_key=group_key,
+      instance_key=instance_key,
+      merge_op=merge_op,
+      final_op=final_op,
+      subdiv_offsets=subdiv_offsets,
+      communication_hint=communication_hint.lower())
+
+
 def all_gather(t, group_size, group_key, instance_key,
                communication_hint='auto'):
   """Accumulates tensors collectively, across devices, along first dimension.
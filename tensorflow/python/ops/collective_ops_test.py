@@ -109,6 +109,26 @@ class CollectiveOpTest(test.TestCase):
         set_graph_key=True,
         fp16=True)
 
+  @test_util.run_deprecated_v1
+  def testCollectiveReduceN(self):
+    group_size = 2
+    config = config_pb2.ConfigProto(device_count={'CPU': group_size})
+    inputs = [[[1., 2., 3.], [[4., 5.], [6., 7.]], []],
+              [[3., 2., 1.], [[8., 7.], [6., 5.]], []]]
+    with self.session(config=config) as sess:
+      colred = []
+      for i in range(group_size):
+        with ops.device('/CPU:%d' % i):
+          ts = [constant_op.constant(t) for t in inputs[i]]
+          colred.append(collective_ops.all_reduce_n(
+              ts, group_size, group_key=1, instance_key=1, merge_op='Add',
+              final_op='Div'))
+      results = sess.run(colred)
+    for i in range(group_size):
+      self.assertAllClose(results[i][0], [2., 2., 2.])
+      self.assertAllClose(results[i][1], [[6., 6.], [6., 6.]])
+      self.assertAllClose(results[i][2], [])
+
   @test_util.run_deprecated_v1
   def testCollectiveMultipleConcurrentReduce(self):
     self._testMultipleConcurrentCollectiveReduce(
@@ -372,6 +372,149 @@ class HashTable(StaticHashTableV1):
     return self.initializer
 
 
+class MemoryMappedTable(LookupInterface):
+  """A read-only table that memory-maps a file of sorted keys and values.
+
+  Unlike `StaticHashTable`, the table is not built when it is loaded: keys are
+  looked up directly in the mapped file, so loading is cheap and the processes
+  serving the same file share its pages through the page cache. The file is
+  written ahead of time by `write_memory_mapped_table`.
+
+  Example usage:
+
+  ```python
+  write_memory_mapped_table("/tmp/vocab.table", keys, values)
+  table = MemoryMappedTable("/tmp/vocab.table", tf.string, tf.int64, -1)
+  out = table.lookup(query_keys)
+  ```
+  """
+
+  def __init__(self, filename, key_dtype, value_dtype, default_value,
+               name=None):
+    """Creates a `MemoryMappedTable` object.
+
+    Args:
+      filename: path of the file written by `write_memory_mapped_table`.
+      key_dtype: the type of the keys, `tf.int64` or `tf.string`.
+      value_dtype: the type of the values.
+      default_value: The value to use if a key is missing in the table.
+      name: A name for the operation (optional).
+    """
+    self._filename = filename
+    self._default_value = ops.convert_to_tensor(
+        default_value, dtype=value_dtype)
+    self._default_value.get_shape().merge_with(tensor_shape.TensorShape([]))
+    # Share the table across kernels, as for StaticHashTable.
+    self._shared_name = "memory_mapped_table_%s" % (str(uuid.uuid4()),)
+    self._name = name or "memory_mapped_table"
+    self._table_name = None
+    super(MemoryMappedTable, self).__init__(key_dtype, value_dtype)
+    with ops.init_scope():
+      self._resource_handle = self._create_resource()
+
+  def _create_resource(self):
+    table_ref = gen_lookup_ops.memory_mapped_table(
+        filename=self._filename,
+        shared_name=self._shared_name,
+        key_dtype=self._key_dtype,
+        value_dtype=self._value_dtype,
+        name=self._name)
+    if context.executing_eagerly():
+      self._table_name = None
+    else:
+      self._table_name = table_ref.op.name.split("/")[-1]
+    return table_ref
+
+  @property
+  def name(self):
+    return self._table_name
+
+  @property
+  def default_value(self):
+    """The default value of the table."""
+    return self._default_value
+
+  def size(self, name=None):
+    """Compute the number of elements in this table.
+
+    Args:
+      name: A name for the operation (optional).
+
+    Returns:
+      A scalar tensor containing the number of elements in this table.
+    """
+    with ops.name_scope(name, "%s_Size" % self.name, [self.resource_handle]):
+      return gen_lookup_ops.lookup_table_size_v2(self.resource_handle)
+
+  def lookup(self, keys, name=None):
+    """Looks up `keys` in a table, outputs the corresponding values.
+
+    The `default_value` is used for keys not present in the table.
+
+    Args:
+      keys: Keys to look up. May be either a `SparseTensor` or dense `Tensor`.
+      name: A name for the operation (optional).
+
+    Returns:
+      A `SparseTensor` if keys are sparse, otherwise a dense `Tensor`.
+
+    Raises:
+      TypeError: when `keys` doesn't match the table key type.
+    """
+    key_tensor = keys
+    if isinstance(keys, sparse_tensor.SparseTensor):
+      key_tensor = keys.values
+
+    if keys.dtype.base_dtype != self._key_dtype:
+      raise TypeError("Signature mismatch. Keys must be dtype %s, got %s." %
+                      (self._key_dtype, keys.dtype))
+
+    with ops.name_scope(
+        name, "%s_Lookup" % self.name,
+        (self.resource_handle, key_tensor, self._default_value)):
+      values = gen_lookup_ops.lookup_table_find_v2(self.resource_handle,
+                                                   key_tensor,
+                                                   self._default_value)
+
+    values.set_shape(key_tensor.get_shape())
+    if isinstance(keys, sparse_tensor.SparseTensor):
+      return sparse_tensor.SparseTensor(keys.indices, values, keys.dense_shape)
+    else:
+      return values
+
+  def export(self, name=None):
+    """Returns tensors of all keys and values in the table, sorted by key.
+
+    Args:
+      name: A name for the operation (optional).
+
+    Returns:
+      A pair of tensors with the first tensor containing all keys and the
+        second tensors containing all values in the table.
+    """
+    with ops.name_scope(name, "%s_Export" % self.name, [self.resource_handle]):
+      return gen_lookup_ops.lookup_table_export_v2(
+          self.resource_handle, self._key_dtype, self._value_dtype)
+
+
+def write_memory_mapped_table(filename, keys, values, name=None):
+  """Writes the file read by `MemoryMappedTable`.
+
+  Args:
+    filename: path of the file to write.
+    keys: vector of unique keys, of type `tf.int64` or `tf.string`.
+    values: vector of the values of the keys.
+    name: A name for the operation (optional).
+
+  Returns:
+    The created Operation.
+  """
+  with ops.name_scope(name, "write_memory_mapped_table",
+                      [filename, keys, values]) as scope:
+    return gen_lookup_ops.write_memory_mapped_table(
+        filename, keys, values, name=scope)
+
+
 class TableInitializerBase(trackable_base.Trackable):
   """Base class for lookup table initializers."""
 
@@ -1867,7 +2010,8 @@ class DenseHashTable(LookupInterface):
                deleted_key,
                initial_num_buckets=None,
                name="MutableDenseHashTable",
-               checkpoint=True):
+               checkpoint=True,
+               num_shards=None):
     """Creates an empty `DenseHashTable` object.
 
     Creates a table, the type of its keys and values are specified by key_dtype
@@ -1887,6 +2031,9 @@ class DenseHashTable(LookupInterface):
       checkpoint: if True, the contents of the table are saved to and restored
         from checkpoints. If `shared_name` is empty for a checkpointed table, it
         is shared using the table node name.
+      num_shards: the number of shards the buckets are split into, a power of 2.
+        Each shard has its own lock and grows on its own, which reduces the
+        contention between concurrent lookups and inserts. Defaults to 1.
 
     Returns:
       A `DenseHashTable` object.
@@ -1899,6 +2046,7 @@ class DenseHashTable(LookupInterface):
     self._key_dtype = key_dtype
     self._value_dtype = value_dtype
     self._initial_num_buckets = initial_num_buckets
+    self._num_shards = num_shards
     self._value_shape = self._default_value.get_shape()
     self._checkpoint = checkpoint
     self._name = name
@@ -1936,6 +2084,7 @@ class DenseHashTable(LookupInterface):
         value_dtype=self._value_dtype,
         value_shape=self._value_shape,
         initial_num_buckets=self._initial_num_buckets,
+        num_shards=self._num_shards,
         name=self._name)
     if context.executing_eagerly():
       self._table_name = None
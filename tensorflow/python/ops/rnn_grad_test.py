@@ -66,6 +66,52 @@ class RNNGradTest(test.TestCase):
     self.assertAllEqual(w_grad, w_ifco_grad)
     self.assertAllEqual(b_grad, b_ifco_grad)
 
+  @test_util.deprecated_graph_mode_only
+  def testBlockLSTMMatchesLSTMBlockCell(self):
+    num_steps = 5
+    seq_len_max = 4
+    batch_size = 3
+    input_size = 7
+    hidden_size = 5
+    w = deterministic_random_uniform(
+        [input_size + hidden_size, 4 * hidden_size]) - 0.5
+    b = deterministic_random_uniform([4 * hidden_size]) - 0.5
+    wci, wcf, wco = (
+        deterministic_random_uniform([hidden_size]) - 0.5 for _ in range(3))
+    x = deterministic_random_uniform([num_steps, batch_size, input_size])
+    cs_prev = h_prev = deterministic_random_uniform([batch_size, hidden_size])
+    attrs = dict(forget_bias=1.0, cell_clip=0.3, use_peephole=True)
+
+    _, all_cs, _, _, _, _, all_h = gen_rnn_ops.BlockLSTM(
+        seq_len_max=np.int64(seq_len_max),
+        x=x,
+        cs_prev=cs_prev,
+        h_prev=h_prev,
+        w=w,
+        wci=wci,
+        wcf=wcf,
+        wco=wco,
+        b=b,
+        **attrs)
+
+    expected_cs = []
+    expected_h = []
+    cs, h = cs_prev, h_prev
+    for t in range(seq_len_max):
+      _, cs, _, _, _, _, h = gen_rnn_ops.LSTMBlockCell(
+          x=x[t], cs_prev=cs, h_prev=h, w=w, wci=wci, wcf=wcf, wco=wco, b=b,
+          **attrs)
+      expected_cs.append(cs)
+      expected_h.append(h)
+    # Steps past seq_len_max are zeroed.
+    zeros = array_ops.zeros([batch_size, hidden_size])
+    for _ in range(seq_len_max, num_steps):
+      expected_cs.append(zeros)
+      expected_h.append(zeros)
+
+    self.assertAllClose(array_ops.stack(expected_cs), all_cs)
+    self.assertAllClose(array_ops.stack(expected_h), all_h)
+
   def _lstm_block(self, op, w, b, x, cs_prev, h_prev):
     w_peephole = array_ops.zeros(cs_prev.shape[1:], dtype=w.dtype)
     _, all_cs, _, _, _, _, all_h = op(
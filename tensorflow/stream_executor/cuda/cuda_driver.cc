@@ -1006,6 +1006,95 @@ GpuDriver::ContextGetSharedMemConfig(GpuContext* context) {
   return false;
 }
 
+/* static */ port::Status GpuDriver::StreamBeginCapture(GpuContext* context,
+                                                        CUstream stream) {
+#if CUDA_VERSION >= 10010
+  ScopedActivateContext activated{context};
+  // Only the capturing thread may make unsafe API calls (e.g. synchronous
+  // memcpys) while the capture is in progress.
+  RETURN_IF_CUDA_RES_ERROR(
+      cuStreamBeginCapture(stream, CU_STREAM_CAPTURE_MODE_THREAD_LOCAL),
+      "Failed to begin stream capture");
+  return port::Status::OK();
+#elif CUDA_VERSION >= 10000
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(cuStreamBeginCapture(stream),
+                           "Failed to begin stream capture");
+  return port::Status::OK();
+#else
+  return port::UnimplementedError("Stream capture requires CUDA 10.0");
+#endif
+}
+
+/* static */ port::Status GpuDriver::StreamEndCapture(GpuContext* context,
+                                                      CUstream stream,
+                                                      GpuGraphHandle* graph) {
+#if CUDA_VERSION >= 10000
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(cuStreamEndCapture(stream, graph),
+                           "Failed to end stream capture");
+  return port::Status::OK();
+#else
+  return port::UnimplementedError("Stream capture requires CUDA 10.0");
+#endif
+}
+
+/* static */ port::Status GpuDriver::GraphInstantiate(
+    GpuContext* context, GpuGraphHandle graph,
+    GpuGraphExecHandle* graph_exec) {
+#if CUDA_VERSION >= 10000
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(
+      cuGraphInstantiate(graph_exec, graph, /*phErrorNode=*/nullptr,
+                         /*logBuffer=*/nullptr, /*bufferSize=*/0),
+      "Failed to instantiate CUDA graph");
+  return port::Status::OK();
+#else
+  return port::UnimplementedError("CUDA graphs require CUDA 10.0");
+#endif
+}
+
+/* static */ port::Status GpuDriver::GraphLaunch(GpuContext* context,
+                                                 GpuGraphExecHandle graph_exec,
+                                                 CUstream stream) {
+#if CUDA_VERSION >= 10000
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(cuGraphLaunch(graph_exec, stream),
+                           "Failed to launch CUDA graph");
+  return port::Status::OK();
+#else
+  return port::UnimplementedError("CUDA graphs require CUDA 10.0");
+#endif
+}
+
+/* static */ void GpuDriver::DestroyGraph(GpuContext* context,
+                                          GpuGraphHandle graph) {
+#if CUDA_VERSION >= 10000
+  if (graph == nullptr) {
+    return;
+  }
+  ScopedActivateContext activated{context};
+  CUresult res = cuGraphDestroy(graph);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "failed to destroy CUDA graph: " << ToString(res);
+  }
+#endif
+}
+
+/* static */ void GpuDriver::DestroyGraphExec(GpuContext* context,
+                                              GpuGraphExecHandle graph_exec) {
+#if CUDA_VERSION >= 10000
+  if (graph_exec == nullptr) {
+    return;
+  }
+  ScopedActivateContext activated{context};
+  CUresult res = cuGraphExecDestroy(graph_exec);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "failed to destroy CUDA graph exec: " << ToString(res);
+  }
+#endif
+}
+
 /* static */ port::Status GpuDriver::SynchronousMemcpyD2H(GpuContext* context,
                                                           void* host_dst,
                                                           CUdeviceptr gpu_src,
@@ -59,6 +59,10 @@ using GpuSharedMemConfig = hipSharedMemConfig;
 using GpuComplexType = hipComplex;
 using GpuDoubleComplexType = hipDoubleComplex;
 using GpuRngHandle = hiprandGenerator_t;
+// Graph capture is not supported on ROCm; these are placeholders so that the
+// GpuDriver interface is the same on both platforms.
+using GpuGraphHandle = void*;
+using GpuGraphExecHandle = void*;
 
 #else  // CUDA
 
@@ -77,6 +81,13 @@ using GpuSharedMemConfig = CUsharedconfig;
 using GpuComplexType = cuComplex;
 using GpuDoubleComplexType = cuDoubleComplex;
 using GpuRngHandle = curandGenerator_t;
+#if CUDA_VERSION >= 10000
+using GpuGraphHandle = CUgraph;
+using GpuGraphExecHandle = CUgraphExec;
+#else
+using GpuGraphHandle = void*;
+using GpuGraphExecHandle = void*;
+#endif
 
 #endif
 